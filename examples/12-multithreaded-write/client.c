@@ -0,0 +1,297 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * client.c -- a client of the multithreaded-write example
+ *
+ * Please see README.md for a detailed description of this example.
+ */
+
+#include <inttypes.h>
+#include <librpma.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "common-conn.h"
+#include "multithreaded-write-common.h"
+
+#define USAGE_STR "usage: %s <server_address> <port> " \
+	"[<threads> [<ops> [safe|lockless]]]\n"
+
+#define THREADS_DEFAULT		4
+#define OPS_DEFAULT		100000
+
+/* the maximum number of outstanding writes of a single thread */
+#define WINDOW			16
+
+struct thread_args {
+	pthread_t thread;
+	unsigned id;
+	uint64_t ops;
+	struct rpma_conn *conn;
+	struct rpma_mr_local *src_mr;
+	struct rpma_mr_remote *dst_mr;
+	int ret;
+};
+
+/*
+ * collect_completions -- collect at least one completion of the thread's own
+ * writes (busy polling)
+ */
+static int
+collect_completions(struct thread_args *args, uint64_t *outstanding)
+{
+	struct rpma_completion cmpl;
+	int ret;
+
+	do {
+		ret = rpma_conn_completion_get(args->conn, &cmpl);
+		if (ret == RPMA_E_NO_COMPLETION)
+			continue;
+		if (ret)
+			return ret;
+
+		if (cmpl.op_status != IBV_WC_SUCCESS) {
+			fprintf(stderr, "[%u] the write failed: %s\n",
+				args->id, ibv_wc_status_str(cmpl.op_status));
+			return -1;
+		}
+
+		/* thanks to the routing only own completions can show up */
+		if (cmpl.op_context != args) {
+			fprintf(stderr,
+				"[%u] a completion of another thread\n",
+				args->id);
+			return -1;
+		}
+
+		--(*outstanding);
+	} while (ret == RPMA_E_NO_COMPLETION);
+
+	return 0;
+}
+
+/*
+ * thread_main -- perform 'ops' RDMA writes to the thread's own slot of
+ * the remote memory region via the shared connection
+ */
+static void *
+thread_main(void *arg)
+{
+	struct thread_args *args = arg;
+	size_t offset = args->id * MT_WRITE_SIZE;
+	uint64_t outstanding = 0;
+	int ret;
+
+	/* register the thread in the connection's completion routing */
+	ret = rpma_conn_thread_attach(args->conn);
+	if (ret) {
+		args->ret = ret;
+		return NULL;
+	}
+
+	for (uint64_t i = 0; i < args->ops; ++i) {
+		if (outstanding == WINDOW) {
+			ret = collect_completions(args, &outstanding);
+			if (ret)
+				goto err_drain;
+		}
+
+		ret = rpma_write(args->conn, args->dst_mr, offset,
+				args->src_mr, offset, MT_WRITE_SIZE,
+				RPMA_F_COMPLETION_ALWAYS, args);
+		if (ret)
+			goto err_drain;
+
+		++outstanding;
+	}
+
+err_drain:
+	/* all routed completions have to be collected before detaching */
+	while (outstanding > 0) {
+		int ret_cmpl = collect_completions(args, &outstanding);
+		if (ret_cmpl) {
+			if (!ret)
+				ret = ret_cmpl;
+			break;
+		}
+	}
+
+	(void) rpma_conn_thread_detach(args->conn);
+
+	args->ret = ret;
+	return NULL;
+}
+
+int
+main(int argc, char *argv[])
+{
+	/* validate parameters */
+	if (argc < 3) {
+		fprintf(stderr, USAGE_STR, argv[0]);
+		return -1;
+	}
+
+	/* configure logging thresholds to see more details */
+	rpma_log_set_threshold(RPMA_LOG_THRESHOLD, RPMA_LOG_LEVEL_INFO);
+	rpma_log_set_threshold(RPMA_LOG_THRESHOLD_AUX, RPMA_LOG_LEVEL_INFO);
+
+	/* read common parameters */
+	char *addr = argv[1];
+	char *port = argv[2];
+	unsigned threads_num = THREADS_DEFAULT;
+	uint64_t ops = OPS_DEFAULT;
+	enum rpma_conn_thread_mode mode = RPMA_CONN_THREAD_SAFE;
+
+	if (argc >= 4)
+		threads_num = (unsigned)strtoul(argv[3], NULL, 10);
+	if (argc >= 5)
+		ops = strtoull(argv[4], NULL, 10);
+	if (argc >= 6 && strcmp(argv[5], "lockless") == 0)
+		mode = RPMA_CONN_THREAD_LOCKLESS;
+
+	if (threads_num == 0 || threads_num > MT_WRITE_THREADS_MAX) {
+		fprintf(stderr, "the number of threads has to be in [1, %d]\n",
+			MT_WRITE_THREADS_MAX);
+		return -1;
+	}
+
+	/* resources - memory regions */
+	void *src_ptr = NULL;
+	struct rpma_mr_local *src_mr = NULL;
+	struct rpma_mr_remote *dst_mr = NULL;
+
+	/* RPMA resources */
+	struct rpma_peer *peer = NULL;
+	struct rpma_conn_cfg *cfg = NULL;
+	struct rpma_conn *conn = NULL;
+	struct thread_args *args = NULL;
+	int ret;
+
+	/* allocate and fill a memory - one slot per a thread */
+	src_ptr = malloc_aligned(MT_WRITE_DST_SIZE);
+	if (src_ptr == NULL)
+		return -1;
+	memset(src_ptr, 'x', MT_WRITE_DST_SIZE);
+
+	args = calloc(threads_num, sizeof(*args));
+	if (args == NULL) {
+		ret = -1;
+		goto err_free;
+	}
+
+	/*
+	 * lookup an ibv_context via the address and create a new peer using it
+	 */
+	ret = client_peer_via_address(addr, &peer);
+	if (ret)
+		goto err_free;
+
+	/* register the memory */
+	ret = rpma_mr_reg(peer, src_ptr, MT_WRITE_DST_SIZE,
+			RPMA_MR_USAGE_WRITE_SRC, &src_mr);
+	if (ret)
+		goto err_peer_delete;
+
+	/*
+	 * prepare a connection's configuration - the shared queues have to
+	 * fit the outstanding writes of all the threads
+	 */
+	ret = rpma_conn_cfg_new(&cfg);
+	if (ret)
+		goto err_mr_dereg;
+
+	uint32_t q_size = threads_num * WINDOW;
+	ret = rpma_conn_cfg_set_sq_size(cfg, q_size);
+	if (!ret)
+		ret = rpma_conn_cfg_set_cq_size(cfg, q_size);
+	if (!ret)
+		ret = rpma_conn_cfg_set_thread_mode(cfg, mode);
+	if (ret)
+		goto err_cfg_delete;
+
+	/* establish a new connection to a server listening at addr:port */
+	ret = client_connect(peer, addr, port, cfg, NULL, &conn);
+	if (ret)
+		goto err_cfg_delete;
+
+	/* get the memory region's descriptor from the private data */
+	struct rpma_conn_private_data pdata;
+	ret = rpma_conn_get_private_data(conn, &pdata);
+	if (ret)
+		goto err_conn_disconnect;
+	if (pdata.ptr == NULL) {
+		fprintf(stderr,
+			"The server has not provided the connection's private data\n");
+		ret = -1;
+		goto err_conn_disconnect;
+	}
+
+	struct common_data *dst_data = pdata.ptr;
+	ret = rpma_mr_remote_from_descriptor(&dst_data->descriptors[0],
+			dst_data->mr_desc_size, &dst_mr);
+	if (ret)
+		goto err_conn_disconnect;
+
+	struct timespec start, stop;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	/* run the threads sharing the single connection */
+	unsigned started;
+	for (started = 0; started < threads_num; ++started) {
+		struct thread_args *a = &args[started];
+		a->id = started;
+		a->ops = ops;
+		a->conn = conn;
+		a->src_mr = src_mr;
+		a->dst_mr = dst_mr;
+		if (pthread_create(&a->thread, NULL, thread_main, a)) {
+			ret = -1;
+			break;
+		}
+	}
+
+	for (unsigned i = 0; i < started; ++i) {
+		(void) pthread_join(args[i].thread, NULL);
+		if (args[i].ret && !ret)
+			ret = args[i].ret;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &stop);
+
+	if (!ret) {
+		double elapsed = (double)(stop.tv_sec - start.tv_sec) +
+			(double)(stop.tv_nsec - start.tv_nsec) / 1e9;
+		uint64_t total = ops * threads_num;
+		fprintf(stdout,
+			"%u thread(s) x %" PRIu64 " writes (%s): %.0f ops/s\n",
+			threads_num, ops,
+			mode == RPMA_CONN_THREAD_SAFE ? "safe" : "lockless",
+			(double)total / elapsed);
+	}
+
+	(void) rpma_mr_remote_delete(&dst_mr);
+
+err_conn_disconnect:
+	(void) common_disconnect_and_wait_for_conn_close(&conn);
+
+err_cfg_delete:
+	(void) rpma_conn_cfg_delete(&cfg);
+
+err_mr_dereg:
+	/* deregister the memory region */
+	(void) rpma_mr_dereg(&src_mr);
+
+err_peer_delete:
+	/* delete the peer object */
+	(void) rpma_peer_delete(&peer);
+
+err_free:
+	free(args);
+	free(src_ptr);
+
+	return ret;
+}
@@ -0,0 +1,21 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * multithreaded-write-common.h -- a common declarations for
+ * the multithreaded-write example
+ */
+
+#ifndef MULTITHREADED_WRITE_COMMON
+#define MULTITHREADED_WRITE_COMMON
+
+/* the maximum number of the client's threads */
+#define MT_WRITE_THREADS_MAX	64
+
+/* the size of a single write (and of a single thread's slot) */
+#define MT_WRITE_SIZE		64
+
+/* the size of the server's memory region */
+#define MT_WRITE_DST_SIZE	(MT_WRITE_THREADS_MAX * MT_WRITE_SIZE)
+
+#endif /* MULTITHREADED_WRITE_COMMON */
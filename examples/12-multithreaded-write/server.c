@@ -0,0 +1,119 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * server.c -- a server of the multithreaded-write example
+ *
+ * Please see README.md for a detailed description of this example.
+ */
+
+#include <librpma.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "common-conn.h"
+#include "multithreaded-write-common.h"
+
+#define USAGE_STR "usage: %s <server_address> <port>\n"
+
+int
+main(int argc, char *argv[])
+{
+	/* validate parameters */
+	if (argc < 3) {
+		fprintf(stderr, USAGE_STR, argv[0]);
+		return -1;
+	}
+
+	/* configure logging thresholds to see more details */
+	rpma_log_set_threshold(RPMA_LOG_THRESHOLD, RPMA_LOG_LEVEL_INFO);
+	rpma_log_set_threshold(RPMA_LOG_THRESHOLD_AUX, RPMA_LOG_LEVEL_INFO);
+
+	/* read common parameters */
+	char *addr = argv[1];
+	char *port = argv[2];
+
+	/* resources - memory region */
+	void *dst_ptr = NULL;
+	struct rpma_mr_local *dst_mr = NULL;
+
+	/* RPMA resources */
+	struct rpma_peer *peer = NULL;
+	struct rpma_ep *ep = NULL;
+	struct rpma_conn *conn = NULL;
+	int ret;
+
+	/* allocate a memory - one slot per a client's thread */
+	dst_ptr = malloc_aligned(MT_WRITE_DST_SIZE);
+	if (dst_ptr == NULL)
+		return -1;
+
+	/*
+	 * lookup an ibv_context via the address and create a new peer using it
+	 */
+	ret = server_peer_via_address(addr, &peer);
+	if (ret)
+		goto err_free;
+
+	/* register the memory */
+	ret = rpma_mr_reg(peer, dst_ptr, MT_WRITE_DST_SIZE,
+			RPMA_MR_USAGE_WRITE_DST, &dst_mr);
+	if (ret)
+		goto err_peer_delete;
+
+	/* get size of the memory region's descriptor */
+	size_t mr_desc_size;
+	ret = rpma_mr_get_descriptor_size(dst_mr, &mr_desc_size);
+	if (ret)
+		goto err_mr_dereg;
+
+	/* calculate data for the client write */
+	struct common_data data = {0};
+	data.data_offset = 0;
+	data.mr_desc_size = mr_desc_size;
+
+	/* get the memory region's descriptor */
+	ret = rpma_mr_get_descriptor(dst_mr, &data.descriptors[0]);
+	if (ret)
+		goto err_mr_dereg;
+
+	/* start a listening endpoint at addr:port */
+	ret = rpma_ep_listen(peer, addr, port, &ep);
+	if (ret)
+		goto err_mr_dereg;
+
+	/*
+	 * Wait for an incoming connection request, accept it and wait for its
+	 * establishment. The memory region's descriptor is sent to the client
+	 * as the connection's private data.
+	 */
+	struct rpma_conn_private_data pdata;
+	pdata.ptr = &data;
+	pdata.len = sizeof(struct common_data);
+	ret = server_accept_connection(ep, NULL, &pdata, &conn);
+	if (ret)
+		goto err_ep_shutdown;
+
+	/*
+	 * Between the connection being established and the connection being
+	 * closed the client will perform the RDMA writes from many threads.
+	 */
+	ret = common_wait_for_conn_close_and_disconnect(&conn);
+
+err_ep_shutdown:
+	/* shutdown the endpoint */
+	(void) rpma_ep_shutdown(&ep);
+
+err_mr_dereg:
+	/* deregister the memory region */
+	(void) rpma_mr_dereg(&dst_mr);
+
+err_peer_delete:
+	/* delete the peer object */
+	(void) rpma_peer_delete(&peer);
+
+err_free:
+	free(dst_ptr);
+
+	return ret;
+}
@@ -0,0 +1,15 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * bounce-buffers-common.h -- a common declarations for
+ * the bounce-buffers example
+ */
+
+#ifndef BOUNCE_BUFFERS_COMMON
+#define BOUNCE_BUFFERS_COMMON
+
+/* the size of the server's memory region and of the largest operation */
+#define BOUNCE_MAX_SIZE		(64 * KILOBYTE)
+
+#endif /* BOUNCE_BUFFERS_COMMON */
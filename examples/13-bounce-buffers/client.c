@@ -0,0 +1,300 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * client.c -- a client of the bounce-buffers example
+ *
+ * Please see README.md for a detailed description of this example.
+ */
+
+#include <inttypes.h>
+#include <librpma.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "common-conn.h"
+#include "bounce-buffers-common.h"
+
+#define USAGE_STR "usage: %s <server_address> <port> [<iterations>]\n"
+
+#define ITERATIONS_DEFAULT	1000
+
+/* the size of the data which can be posted inline */
+#define INLINE_SIZE		128
+
+/* the bounce buffers */
+#define SLOTS			16
+#define SLOT_SIZE		(8 * KILOBYTE)
+
+/* the smallest measured operation */
+#define MIN_SIZE		8
+
+enum bench_path {
+	PATH_INLINE,
+	PATH_BOUNCE,
+	PATH_CACHE,
+	PATH_NUM
+};
+
+static const char *path_names[PATH_NUM] = {"inline", "bounce", "cache"};
+
+struct bench {
+	struct rpma_conn *conn;
+	struct rpma_bounce *bounce;
+	struct rpma_mr_remote *remote_mr;
+	char *buf; /* the unregistered memory */
+	uint64_t iterations;
+
+	/* the default thresholds (the capabilities of the paths) */
+	size_t inline_max;
+	size_t copy_max;
+};
+
+/*
+ * wait_for_completion -- wait (busy polling) for the completion of
+ * the single outstanding operation
+ */
+static int
+wait_for_completion(struct bench *b)
+{
+	struct rpma_completion cmpl;
+	int ret;
+
+	do {
+		ret = rpma_conn_completion_get(b->conn, &cmpl);
+	} while (ret == RPMA_E_NO_COMPLETION);
+	if (ret)
+		return ret;
+
+	/* the inline operations are not tracked by the bounce buffers */
+	ret = rpma_bounce_process(b->bounce, &cmpl);
+	if (ret && ret != RPMA_E_INVAL)
+		return ret;
+
+	if (cmpl.op_status != IBV_WC_SUCCESS) {
+		fprintf(stderr, "the operation failed: %s\n",
+			ibv_wc_status_str(cmpl.op_status));
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * run_op -- perform a single operation and wait for its completion
+ */
+static int
+run_op(struct bench *b, enum rpma_op op, size_t size)
+{
+	int ret;
+
+	if (op == RPMA_OP_WRITE)
+		ret = rpma_bounce_write(b->bounce, b->remote_mr, 0, b->buf,
+				size, RPMA_F_COMPLETION_ALWAYS, NULL);
+	else
+		ret = rpma_bounce_read(b->bounce, b->buf, b->remote_mr, 0,
+				size, RPMA_F_COMPLETION_ALWAYS, NULL);
+	if (ret)
+		return ret;
+
+	return wait_for_completion(b);
+}
+
+/*
+ * measure -- measure the average latency [usec] of the operation of
+ * the given size forced to take the given path
+ */
+static int
+measure(struct bench *b, enum rpma_op op, size_t size, enum bench_path path,
+		double *usec)
+{
+	size_t inline_max = (path == PATH_INLINE) ? b->inline_max : 0;
+	size_t copy_max = (path == PATH_CACHE) ? 0 : b->copy_max;
+
+	int ret = rpma_bounce_set_thresholds(b->bounce, inline_max, copy_max);
+	if (ret)
+		return ret;
+
+	/* the registration of the cache path is not a part of the measure */
+	ret = run_op(b, op, size);
+	if (ret)
+		return ret;
+
+	struct timespec start, stop;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	for (uint64_t i = 0; i < b->iterations; ++i) {
+		ret = run_op(b, op, size);
+		if (ret)
+			return ret;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &stop);
+
+	double elapsed = (double)(stop.tv_sec - start.tv_sec) * 1e6 +
+		(double)(stop.tv_nsec - start.tv_nsec) / 1e3;
+	*usec = elapsed / (double)b->iterations;
+
+	return 0;
+}
+
+/*
+ * measure_op -- print the latencies of all the paths available for
+ * the operations of the consecutive sizes
+ */
+static int
+measure_op(struct bench *b, enum rpma_op op)
+{
+	const char *name = (op == RPMA_OP_WRITE) ? "write" : "read";
+	int ret;
+
+	fprintf(stdout, "\n%-6s %10s", name, "size [B]");
+	for (int p = 0; p < PATH_NUM; ++p)
+		fprintf(stdout, " %10s", path_names[p]);
+	fprintf(stdout, "   [usec]\n");
+
+	for (size_t size = MIN_SIZE; size <= BOUNCE_MAX_SIZE; size *= 2) {
+		fprintf(stdout, "%-6s %10zu", name, size);
+
+		for (int p = 0; p < PATH_NUM; ++p) {
+			/* the reads are never posted inline */
+			if ((p == PATH_INLINE && (op == RPMA_OP_READ ||
+					size > b->inline_max)) ||
+					(p == PATH_BOUNCE &&
+					size > b->copy_max)) {
+				fprintf(stdout, " %10s", "-");
+				continue;
+			}
+
+			double usec;
+			ret = measure(b, op, size, (enum bench_path)p, &usec);
+			if (ret)
+				return ret;
+
+			fprintf(stdout, " %10.2f", usec);
+		}
+
+		fprintf(stdout, "\n");
+	}
+
+	return 0;
+}
+
+int
+main(int argc, char *argv[])
+{
+	/* validate parameters */
+	if (argc < 3) {
+		fprintf(stderr, USAGE_STR, argv[0]);
+		return -1;
+	}
+
+	/* configure logging thresholds to see more details */
+	rpma_log_set_threshold(RPMA_LOG_THRESHOLD, RPMA_LOG_LEVEL_INFO);
+	rpma_log_set_threshold(RPMA_LOG_THRESHOLD_AUX, RPMA_LOG_LEVEL_INFO);
+
+	/* read common parameters */
+	char *addr = argv[1];
+	char *port = argv[2];
+	struct bench b = {0};
+	b.iterations = ITERATIONS_DEFAULT;
+
+	if (argc >= 4)
+		b.iterations = strtoull(argv[3], NULL, 10);
+	if (b.iterations == 0) {
+		fprintf(stderr, "the number of iterations has to be > 0\n");
+		return -1;
+	}
+
+	/* RPMA resources */
+	struct rpma_peer *peer = NULL;
+	struct rpma_conn_cfg *cfg = NULL;
+	int ret;
+
+	/* allocate the unregistered memory the operations work on */
+	b.buf = malloc_aligned(BOUNCE_MAX_SIZE);
+	if (b.buf == NULL)
+		return -1;
+	memset(b.buf, 'c', BOUNCE_MAX_SIZE);
+
+	/*
+	 * lookup an ibv_context via the address and create a new peer using it
+	 */
+	ret = client_peer_via_address(addr, &peer);
+	if (ret)
+		goto err_free;
+
+	/* prepare a connection's configuration allowing the inline writes */
+	ret = rpma_conn_cfg_new(&cfg);
+	if (ret)
+		goto err_peer_delete;
+
+	ret = rpma_conn_cfg_set_inline_size(cfg, INLINE_SIZE);
+	if (ret)
+		goto err_cfg_delete;
+
+	/* establish a new connection to a server listening at addr:port */
+	ret = client_connect(peer, addr, port, cfg, NULL, &b.conn);
+	if (ret)
+		goto err_cfg_delete;
+
+	/* get the memory region's descriptor from the private data */
+	struct rpma_conn_private_data pdata;
+	ret = rpma_conn_get_private_data(b.conn, &pdata);
+	if (ret)
+		goto err_conn_disconnect;
+	if (pdata.ptr == NULL) {
+		fprintf(stderr,
+			"The server has not provided the connection's private data\n");
+		ret = -1;
+		goto err_conn_disconnect;
+	}
+
+	struct common_data *dst_data = pdata.ptr;
+	ret = rpma_mr_remote_from_descriptor(&dst_data->descriptors[0],
+			dst_data->mr_desc_size, &b.remote_mr);
+	if (ret)
+		goto err_conn_disconnect;
+
+	/* prepare the bounce buffers of the connection */
+	ret = rpma_bounce_new(peer, b.conn, SLOTS, SLOT_SIZE, &b.bounce);
+	if (ret)
+		goto err_mr_remote_delete;
+
+	/* the default thresholds are the limits of the paths */
+	ret = rpma_bounce_get_thresholds(b.bounce, &b.inline_max,
+			&b.copy_max);
+	if (ret)
+		goto err_bounce_delete;
+
+	fprintf(stdout, "%" PRIu64 " iterations, inline <= %zu B, "
+			"bounce <= %zu B\n",
+			b.iterations, b.inline_max, b.copy_max);
+
+	ret = measure_op(&b, RPMA_OP_WRITE);
+	if (!ret)
+		ret = measure_op(&b, RPMA_OP_READ);
+
+err_bounce_delete:
+	(void) rpma_bounce_delete(&b.bounce);
+
+err_mr_remote_delete:
+	(void) rpma_mr_remote_delete(&b.remote_mr);
+
+err_conn_disconnect:
+	(void) common_disconnect_and_wait_for_conn_close(&b.conn);
+
+err_cfg_delete:
+	(void) rpma_conn_cfg_delete(&cfg);
+
+err_peer_delete:
+	/* delete the peer object */
+	(void) rpma_peer_delete(&peer);
+
+err_free:
+	free(b.buf);
+
+	return ret;
+}
@@ -0,0 +1,170 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * client.cpp -- a client of the C++ coroutines example
+ *
+ * The client reads the server's memory one read at a time using both the C
+ * API and the awaitable operations of librpma.hpp and prints the average
+ * latency of both of them so the overhead of the coroutines can be seen.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <memory>
+
+#include <librpma.hpp>
+
+#include "common-conn.h"
+
+#define READ_LEN	64
+#define ITERATIONS	10000
+
+using bench_clock = std::chrono::steady_clock;
+
+/*
+ * read_c_api -- post the reads and busy-poll their completions using
+ * the C API
+ */
+static void
+read_c_api(rpma::conn &conn, rpma::mr_local &dst, rpma::mr_remote &src,
+	unsigned iterations)
+{
+	struct rpma_completion cmpl;
+
+	for (unsigned i = 0; i < iterations; ++i) {
+		int ret = rpma_read(conn.get(), dst.get(), 0, src.get(), 0,
+			READ_LEN, RPMA_F_COMPLETION_ALWAYS, NULL);
+		if (ret)
+			throw rpma::error(ret);
+
+		do {
+			ret = rpma_conn_completion_get(conn.get(), &cmpl);
+		} while (ret == RPMA_E_NO_COMPLETION);
+		if (ret)
+			throw rpma::error(ret);
+		if (cmpl.op_status != IBV_WC_SUCCESS)
+			throw rpma::completion_error(cmpl);
+	}
+}
+
+/*
+ * read_coroutine -- await the reads one after another
+ */
+static rpma::task
+read_coroutine(rpma::conn &conn, rpma::mr_local &dst, rpma::mr_remote &src,
+	unsigned iterations)
+{
+	for (unsigned i = 0; i < iterations; ++i)
+		co_await conn.read(dst, 0, src, 0, READ_LEN);
+}
+
+/*
+ * read_coroutines -- run the coroutine and busy-poll its completions
+ */
+static void
+read_coroutines(rpma::conn &conn, rpma::mr_local &dst, rpma::mr_remote &src,
+	unsigned iterations)
+{
+	rpma::task task = read_coroutine(conn, dst, src, iterations);
+	while (!task.done())
+		(void) conn.dispatch();
+	task.get();
+}
+
+/*
+ * measure -- the average latency of a single read [nsec]
+ */
+template <typename F>
+static double
+measure(F func, unsigned iterations)
+{
+	auto start = bench_clock::now();
+	func(iterations);
+	std::chrono::duration<double, std::nano> elapsed =
+		bench_clock::now() - start;
+
+	return elapsed.count() / iterations;
+}
+
+int
+main(int argc, char *argv[])
+{
+	if (argc < 3) {
+		fprintf(stderr, "usage: %s <server_address> <port> "
+			"[<iterations>]\n", argv[0]);
+		exit(-1);
+	}
+
+	/* parameters */
+	char *addr = argv[1];
+	char *port = argv[2];
+	unsigned iterations = ITERATIONS;
+	if (argc >= 4)
+		iterations = (unsigned)strtoul(argv[3], NULL, 10);
+	if (iterations == 0)
+		iterations = ITERATIONS;
+
+	try {
+		/*
+		 * lookup an ibv_context via the address and create a new peer
+		 * using it
+		 */
+		rpma::peer peer = rpma::peer::from_address(addr,
+			RPMA_UTIL_IBV_CONTEXT_REMOTE);
+
+		/* allocate and register the destination memory */
+		std::unique_ptr<void, decltype(&free)> mem(
+			aligned_alloc(KILOBYTE, KILOBYTE), &free);
+		if (!mem)
+			return -1;
+		rpma::mr_local dst(peer, mem.get(), KILOBYTE,
+			RPMA_MR_USAGE_READ_DST);
+
+		/* establish a new connection to the server at addr:port */
+		rpma::conn conn = rpma::conn::connect(peer, addr, port);
+
+		/* create the remote memory region from its descriptor */
+		struct rpma_conn_private_data pdata = conn.private_data();
+		if (pdata.len < sizeof(struct common_data))
+			return -1;
+		auto *data = static_cast<struct common_data *>(pdata.ptr);
+		rpma::mr_remote src(&data->descriptors[0], data->mr_desc_size);
+		if (src.size() < READ_LEN)
+			return -1;
+
+		auto c_api = [&](unsigned n) {
+			read_c_api(conn, dst, src, n);
+		};
+		auto coroutines = [&](unsigned n) {
+			read_coroutines(conn, dst, src, n);
+		};
+
+		/* warm up */
+		c_api(iterations / 10 + 1);
+		coroutines(iterations / 10 + 1);
+
+		double c_ns = measure(c_api, iterations);
+		double cxx_ns = measure(coroutines, iterations);
+
+		printf("%u reads of %d bytes\n", iterations, READ_LEN);
+		printf("C API:          %8.0f ns/op\n", c_ns);
+		printf("C++ coroutines: %8.0f ns/op (%+.1f%%)\n", cxx_ns,
+			(cxx_ns - c_ns) * 100.0 / c_ns);
+
+		/* disconnect and wait for the connection to be closed */
+		conn.disconnect();
+		enum rpma_conn_event event = conn.next_event();
+		if (event != RPMA_CONN_CLOSED)
+			fprintf(stderr, "unexpected event: %s\n",
+				rpma_utils_conn_event_2str(event));
+	} catch (const std::exception &e) {
+		fprintf(stderr, "%s\n", e.what());
+		return -1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,84 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * server.cpp -- a server of the C++ coroutines example
+ *
+ * The server exposes its local memory to the client as a read source.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <memory>
+
+#include <librpma.hpp>
+
+#include "common-conn.h"
+
+int
+main(int argc, char *argv[])
+{
+	if (argc < 3) {
+		fprintf(stderr, "usage: %s <server_address> <port>\n",
+			argv[0]);
+		exit(-1);
+	}
+
+	/* parameters */
+	char *addr = argv[1];
+	char *port = argv[2];
+
+	try {
+		/*
+		 * lookup an ibv_context via the address and create a new peer
+		 * using it
+		 */
+		rpma::peer peer = rpma::peer::from_address(addr,
+			RPMA_UTIL_IBV_CONTEXT_LOCAL);
+
+		/* start a listening endpoint at addr:port */
+		rpma::endpoint ep(peer, addr, port);
+
+		/* allocate and register the memory */
+		std::unique_ptr<void, decltype(&free)> mem(
+			aligned_alloc(KILOBYTE, KILOBYTE), &free);
+		if (!mem)
+			return -1;
+		memset(mem.get(), 0, KILOBYTE);
+		rpma::mr_local mr(peer, mem.get(), KILOBYTE,
+			RPMA_MR_USAGE_READ_SRC);
+
+		/* the memory region's descriptor is sent as private data */
+		struct common_data data = {};
+		data.mr_desc_size = (uint8_t)mr.descriptor_size();
+		mr.get_descriptor(&data.descriptors[0]);
+
+		struct rpma_conn_private_data pdata;
+		pdata.ptr = &data;
+		pdata.len = sizeof(struct common_data);
+
+		/*
+		 * Wait for an incoming connection request, accept it and wait
+		 * for its establishment.
+		 */
+		rpma::conn conn = ep.accept(nullptr, &pdata);
+
+		/*
+		 * Between the connection being established and the connection
+		 * being closed the client performs the RDMA reads.
+		 */
+		enum rpma_conn_event event = conn.next_event();
+		if (event != RPMA_CONN_CLOSED)
+			fprintf(stderr, "unexpected event: %s\n",
+				rpma_utils_conn_event_2str(event));
+
+		conn.disconnect();
+	} catch (const std::exception &e) {
+		fprintf(stderr, "%s\n", e.what());
+		return -1;
+	}
+
+	return 0;
+}
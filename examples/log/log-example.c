@@ -66,6 +66,16 @@ main(int argc, char *argv[])
 	printf(
 		"Let's use custom log function to write messages to stderr\nNo message should be written to syslog\n");
 	log_worker_is_doing_something();
+
+	/*
+	 * log messages to be written to syslog and stderr by the background
+	 * thread of the library
+	 */
+	if (rpma_log_set_function(rpma_log_async_function) == 0) {
+		printf(
+			"Let's write messages to stderr and syslog asynchronously\n");
+		log_worker_is_doing_something();
+	}
 	rpma_log_set_function(RPMA_LOG_USE_DEFAULT_FUNCTION);
 
 	return 0;
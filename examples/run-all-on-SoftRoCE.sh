@@ -107,6 +107,13 @@ function run_example() {
 		$VLD_CCMD $DIR/client $IP_ADDRESS $PORT "1234"
 		RV=$?
 		;;
+	12-multithreaded-write)
+		THREADS=4
+		OPS=1000
+		echo "Starting the client ..."
+		$VLD_CCMD $DIR/client $IP_ADDRESS $PORT $THREADS $OPS
+		RV=$?
+		;;
 	*)
 		echo "Starting the client ..."
 		$VLD_CCMD $DIR/client $IP_ADDRESS $PORT
@@ -0,0 +1,554 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * aof.c -- librpma remote append-only log
+ *
+ * The records are staged in a registered local ring and the records
+ * appended since the last commit are written to the remote log at once
+ * (a group commit). A commit is posted as:
+ *
+ * - the write of the records (two writes if they wrap around the ring),
+ * - the flush of the records,
+ * - the atomic write of the new tail to the header of the remote log,
+ * - the flush of the tail.
+ *
+ * The atomic write is fenced after the flush of the records (see
+ * rpma_write_atomic(3)) so the tail never points past the records which
+ * have not been flushed yet. Only the last flush reports its success
+ * so every commit generates a single completion. Since every attempt
+ * to post a commit writes the same data at the same offsets a commit which
+ * has failed to be posted can be simply repeated.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "librpma.h"
+#include "log_internal.h"
+#include "mr.h"
+
+#ifdef TEST_MOCK_ALLOC
+#include "cmocka_alloc.h"
+#endif
+
+#define AOF_TAIL_SIZE		sizeof(uint64_t)
+#define AOF_ALIGN_UP(x)		(((x) + 7) & ~(size_t)7)
+
+/* the operations of a commit; each of them has its own op_context */
+enum aof_op {
+	AOF_OP_WRITE,
+	AOF_OP_WRITE_WRAPPED, /* the records wrapped around the ring */
+	AOF_OP_FLUSH,
+	AOF_OP_TAIL,
+	AOF_OP_TAIL_FLUSH, /* the only one completed on success */
+	AOF_OPS
+};
+
+struct aof_record {
+	uint32_t len; /* length of the payload */
+	uint32_t csum; /* CRC-32C of the length and the payload */
+};
+
+struct aof_commit {
+	size_t pos; /* the log offset of the records */
+	size_t len; /* length of the records */
+	size_t stage_start; /* the ring offset of the records */
+	size_t len1; /* length of the records before the end of the ring */
+	size_t stage_bytes; /* bytes of the ring used (including the skipped) */
+	size_t stage_end; /* the ring offset following the records */
+	int finished; /* the last flush has completed */
+	enum ibv_wc_status status; /* status of the first failed operation */
+	const void *op_context; /* the op_context of the caller */
+};
+
+struct rpma_aof {
+	struct rpma_conn *conn;
+	struct rpma_mr_remote *dst;
+	size_t log_size; /* size of the space for the records */
+
+	void *ring; /* the staged records followed by the tail slots */
+	size_t mmap_size; /* size of the mmap()'ed ring */
+	struct rpma_mr_local *ring_mr; /* registration of the ring */
+	size_t ring_size;
+	size_t ring_head; /* the oldest byte still used */
+	size_t ring_tail; /* the first free byte */
+	size_t ring_used; /* number of the bytes used (including the skipped) */
+
+	size_t pos; /* the log offset of the next record */
+	size_t durable; /* the log offset up to which the records are durable */
+
+	/* the records appended since the last commit */
+	size_t open_pos;
+	size_t open_len;
+	size_t open_start;
+	size_t open_len1;
+	size_t open_bytes;
+
+	struct aof_commit *commits; /* FIFO of the commits */
+	uint8_t *ctxs; /* the op_contexts of the operations of the commits */
+	uint32_t depth; /* capacity of the FIFO */
+	uint32_t head; /* the oldest commit */
+	uint32_t num; /* number of the commits */
+	uint32_t nfreed; /* number of the finished commits not reported yet */
+};
+
+/* CRC-32C (Castagnoli) computed a nibble at a time */
+static const uint32_t aof_crc32c_nibble[16] = {
+	0x00000000, 0x105ec76f, 0x20bd8ede, 0x30e349b1,
+	0x417b1dbc, 0x5125dad3, 0x61c69362, 0x7198540d,
+	0x82f63b78, 0x92a8fc17, 0xa24bb5a6, 0xb21572c9,
+	0xc38d26c4, 0xd3d3e1ab, 0xe330a81a, 0xf36e6f75,
+};
+
+/*
+ * aof_crc32c -- update the CRC-32C with the data
+ */
+static uint32_t
+aof_crc32c(uint32_t crc, const void *data, size_t len)
+{
+	const uint8_t *p = data;
+
+	crc = ~crc;
+	for (size_t i = 0; i < len; ++i) {
+		crc ^= p[i];
+		crc = (crc >> 4) ^ aof_crc32c_nibble[crc & 0xf];
+		crc = (crc >> 4) ^ aof_crc32c_nibble[crc & 0xf];
+	}
+
+	return ~crc;
+}
+
+/*
+ * aof_record_csum -- calculate the checksum of the record
+ */
+static inline uint32_t
+aof_record_csum(const struct aof_record *rec)
+{
+	uint32_t crc = aof_crc32c(0, &rec->len, sizeof(rec->len));
+
+	return aof_crc32c(crc, rec + 1, rec->len);
+}
+
+/*
+ * aof_seal -- calculate the checksums of the records of the part
+ * of the ring
+ */
+static void
+aof_seal(struct rpma_aof *aof, size_t start, size_t len)
+{
+	char *p = (char *)aof->ring + start;
+	char *end = p + len;
+
+	while (p < end) {
+		struct aof_record *rec = (struct aof_record *)p;
+		rec->csum = aof_record_csum(rec);
+		p += sizeof(*rec) + AOF_ALIGN_UP(rec->len);
+	}
+}
+
+/*
+ * aof_commit_at -- get the commit of the given position in the FIFO
+ */
+static inline struct aof_commit *
+aof_commit_at(const struct rpma_aof *aof, uint32_t pos)
+{
+	return &aof->commits[(aof->head + pos) % aof->depth];
+}
+
+/*
+ * aof_post -- post the operations of the commit
+ */
+static int
+aof_post(struct rpma_aof *aof, uint32_t slot, struct aof_commit *c)
+{
+	uint8_t *ctx = &aof->ctxs[slot * AOF_OPS];
+	size_t tail_slot = aof->ring_size + slot * AOF_TAIL_SIZE;
+	size_t len2 = c->len - c->len1;
+	int ret;
+
+	ret = rpma_write(aof->conn, aof->dst, RPMA_AOF_DATA_OFFSET + c->pos,
+			aof->ring_mr, c->stage_start, c->len1,
+			RPMA_F_COMPLETION_ON_ERROR, &ctx[AOF_OP_WRITE]);
+	if (ret)
+		return ret;
+
+	if (len2) {
+		ret = rpma_write(aof->conn, aof->dst,
+				RPMA_AOF_DATA_OFFSET + c->pos + c->len1,
+				aof->ring_mr, 0, len2,
+				RPMA_F_COMPLETION_ON_ERROR,
+				&ctx[AOF_OP_WRITE_WRAPPED]);
+		if (ret)
+			return ret;
+	}
+
+	ret = rpma_flush(aof->conn, aof->dst, RPMA_AOF_DATA_OFFSET + c->pos,
+			c->len, RPMA_FLUSH_TYPE_PERSISTENT,
+			RPMA_F_COMPLETION_ON_ERROR,
+			&ctx[AOF_OP_FLUSH]);
+	if (ret)
+		return ret;
+
+	uint64_t tail = c->pos + c->len;
+	memcpy((char *)aof->ring + tail_slot, &tail, sizeof(tail));
+	ret = rpma_write_atomic(aof->conn, aof->dst, 0, aof->ring_mr,
+			tail_slot, RPMA_F_COMPLETION_ON_ERROR,
+			&ctx[AOF_OP_TAIL]);
+	if (ret)
+		return ret;
+
+	return rpma_flush(aof->conn, aof->dst, 0, AOF_TAIL_SIZE,
+			RPMA_FLUSH_TYPE_PERSISTENT, RPMA_F_COMPLETION_ALWAYS,
+			&ctx[AOF_OP_TAIL_FLUSH]);
+}
+
+/* public librpma API */
+
+/*
+ * rpma_aof_new -- register the staging ring of the remote append-only log
+ */
+int
+rpma_aof_new(struct rpma_peer *peer, struct rpma_conn *conn,
+		struct rpma_mr_remote *dst, size_t tail, size_t buf_size,
+		uint32_t depth, struct rpma_aof **aof_ptr)
+{
+	if (peer == NULL || conn == NULL || dst == NULL ||
+			aof_ptr == NULL || depth == 0 ||
+			buf_size < 2 * sizeof(struct aof_record) ||
+			buf_size % sizeof(struct aof_record) != 0 ||
+			tail % sizeof(struct aof_record) != 0 ||
+			buf_size > SIZE_MAX / 2 - (size_t)depth * AOF_TAIL_SIZE)
+		return RPMA_E_INVAL;
+
+	size_t dst_size = 0;
+	(void) rpma_mr_remote_get_size(dst, &dst_size);
+	if (dst_size < RPMA_AOF_DATA_OFFSET ||
+			tail > dst_size - RPMA_AOF_DATA_OFFSET)
+		return RPMA_E_INVAL;
+
+	/*
+	 * a flush to visibility does not make the records durable and
+	 * the tail would be published before the remote side persists them
+	 */
+	int flush_types = 0;
+	(void) rpma_mr_remote_get_flush_type(dst, &flush_types);
+	if (!(flush_types & RPMA_MR_USAGE_FLUSH_TYPE_PERSISTENT))
+		return RPMA_E_NOSUPP;
+
+	void *ring = NULL;
+	size_t mmap_size = 0;
+	struct rpma_mr_local *ring_mr = NULL;
+	int ret = rpma_mr_slab_new(peer, buf_size + depth * AOF_TAIL_SIZE,
+			RPMA_MR_USAGE_WRITE_SRC, &ring, &mmap_size, &ring_mr);
+	if (ret)
+		return ret;
+
+	struct rpma_aof *aof = malloc(sizeof(*aof));
+	if (aof == NULL) {
+		ret = RPMA_E_NOMEM;
+		goto err_mr_dereg;
+	}
+
+	/* both the arrays share a single allocation */
+	aof->commits = malloc(depth * (sizeof(struct aof_commit) + AOF_OPS));
+	if (aof->commits == NULL) {
+		ret = RPMA_E_NOMEM;
+		goto err_free_aof;
+	}
+	aof->ctxs = (uint8_t *)(aof->commits + depth);
+
+	aof->conn = conn;
+	aof->dst = dst;
+	aof->log_size = dst_size - RPMA_AOF_DATA_OFFSET;
+	aof->ring = ring;
+	aof->mmap_size = mmap_size;
+	aof->ring_mr = ring_mr;
+	aof->ring_size = buf_size;
+	aof->ring_head = 0;
+	aof->ring_tail = 0;
+	aof->ring_used = 0;
+	aof->pos = tail;
+	aof->durable = tail;
+	aof->open_pos = tail;
+	aof->open_len = 0;
+	aof->open_start = 0;
+	aof->open_len1 = 0;
+	aof->open_bytes = 0;
+	aof->depth = depth;
+	aof->head = 0;
+	aof->num = 0;
+	aof->nfreed = 0;
+
+	*aof_ptr = aof;
+
+	return 0;
+
+err_free_aof:
+	free(aof);
+
+err_mr_dereg:
+	(void) rpma_mr_slab_delete(&ring_mr, ring, mmap_size);
+
+	return ret;
+}
+
+/*
+ * rpma_aof_delete -- deregister and free the staging ring
+ */
+int
+rpma_aof_delete(struct rpma_aof **aof_ptr)
+{
+	if (aof_ptr == NULL)
+		return RPMA_E_INVAL;
+
+	struct rpma_aof *aof = *aof_ptr;
+	if (aof == NULL)
+		return 0;
+
+	int ret = rpma_mr_slab_delete(&aof->ring_mr, aof->ring, aof->mmap_size);
+
+	free(aof->commits);
+	free(aof);
+	*aof_ptr = NULL;
+
+	return ret;
+}
+
+/*
+ * rpma_aof_get_tail -- get the tail of the records made durable so far
+ */
+int
+rpma_aof_get_tail(const struct rpma_aof *aof, size_t *tail)
+{
+	if (aof == NULL || tail == NULL)
+		return RPMA_E_INVAL;
+
+	*tail = aof->durable;
+
+	return 0;
+}
+
+/*
+ * rpma_aof_reserve -- reserve the space for the record in the staging ring
+ */
+int
+rpma_aof_reserve(struct rpma_aof *aof, size_t len, void **rec_ptr)
+{
+	if (aof == NULL || rec_ptr == NULL || len == 0 || len > UINT32_MAX)
+		return RPMA_E_INVAL;
+
+	size_t n = sizeof(struct aof_record) + AOF_ALIGN_UP(len);
+	if (n > aof->ring_size)
+		return RPMA_E_INVAL;
+
+	if (n > aof->log_size - aof->pos)
+		return RPMA_E_NOMEM;
+
+	if (aof->ring_used == 0) {
+		aof->ring_head = 0;
+		aof->ring_tail = 0;
+	}
+
+	/* a record cannot wrap around the ring so the end can be skipped */
+	size_t off = aof->ring_tail;
+	size_t skip = 0;
+	if (aof->ring_used + n > aof->ring_size)
+		return RPMA_E_AGAIN;
+	if (aof->ring_tail >= aof->ring_head) {
+		if (n > aof->ring_size - aof->ring_tail) {
+			if (n > aof->ring_head)
+				return RPMA_E_AGAIN;
+			skip = aof->ring_size - aof->ring_tail;
+			off = 0;
+		}
+	} else if (n > aof->ring_head - aof->ring_tail) {
+		return RPMA_E_AGAIN;
+	}
+
+	if (aof->open_len == 0) {
+		aof->open_start = off;
+		aof->open_len1 = 0;
+	} else if (off != aof->ring_tail && aof->open_len1 == 0) {
+		/* the records of the commit wrap around the ring */
+		aof->open_len1 = aof->open_len;
+	}
+
+	struct aof_record *rec = (struct aof_record *)((char *)aof->ring + off);
+	rec->len = (uint32_t)len;
+	rec->csum = 0;
+
+	aof->ring_tail = off + n;
+	aof->ring_used += skip + n;
+	aof->open_bytes += skip + n;
+	aof->open_len += n;
+	aof->pos += n;
+
+	*rec_ptr = rec + 1;
+
+	return 0;
+}
+
+/*
+ * rpma_aof_append -- copy the record to the staging ring
+ */
+int
+rpma_aof_append(struct rpma_aof *aof, const void *data, size_t len)
+{
+	if (data == NULL)
+		return RPMA_E_INVAL;
+
+	void *rec;
+	int ret = rpma_aof_reserve(aof, len, &rec);
+	if (ret)
+		return ret;
+
+	memcpy(rec, data, len);
+
+	return 0;
+}
+
+/*
+ * rpma_aof_commit -- post the group commit of the records appended since
+ * the last commit
+ */
+int
+rpma_aof_commit(struct rpma_aof *aof, const void *op_context)
+{
+	if (aof == NULL || aof->open_len == 0)
+		return RPMA_E_INVAL;
+
+	if (aof->num == aof->depth)
+		return RPMA_E_AGAIN;
+
+	uint32_t slot = (aof->head + aof->num) % aof->depth;
+	struct aof_commit *c = &aof->commits[slot];
+	c->pos = aof->open_pos;
+	c->len = aof->open_len;
+	c->stage_start = aof->open_start;
+	c->len1 = aof->open_len1 ? aof->open_len1 : aof->open_len;
+	c->stage_bytes = aof->open_bytes;
+	c->stage_end = aof->ring_tail;
+	c->finished = 0;
+	c->status = IBV_WC_SUCCESS;
+	c->op_context = op_context;
+
+	aof_seal(aof, c->stage_start, c->len1);
+	aof_seal(aof, 0, c->len - c->len1);
+
+	/* the records stay open so the commit can be repeated */
+	int ret = aof_post(aof, slot, c);
+	if (ret)
+		return ret;
+
+	aof->num++;
+	aof->open_pos = aof->pos;
+	aof->open_len = 0;
+	aof->open_len1 = 0;
+	aof->open_bytes = 0;
+
+	return 0;
+}
+
+/*
+ * rpma_aof_process -- consume the completion of an operation of a commit
+ */
+int
+rpma_aof_process(struct rpma_aof *aof, const struct rpma_completion *cmpl)
+{
+	if (aof == NULL || cmpl == NULL)
+		return RPMA_E_INVAL;
+
+	uintptr_t ctx = (uintptr_t)cmpl->op_context;
+	uintptr_t base = (uintptr_t)aof->ctxs;
+	if (ctx < base || ctx >= base + aof->depth * AOF_OPS)
+		return RPMA_E_INVAL;
+
+	uint32_t slot = (uint32_t)(ctx - base) / AOF_OPS;
+	uint32_t op = (uint32_t)(ctx - base) % AOF_OPS;
+	struct aof_commit *c = &aof->commits[slot];
+	uint32_t pos = (slot + aof->depth - aof->head) % aof->depth;
+	if (pos >= aof->num || c->finished)
+		return RPMA_E_INVAL;
+
+	if (cmpl->op_status != IBV_WC_SUCCESS &&
+			c->status == IBV_WC_SUCCESS)
+		c->status = cmpl->op_status;
+
+	/* the operations following the failed one will fail too */
+	if (op != AOF_OP_TAIL_FLUSH)
+		return 0;
+
+	c->finished = 1;
+
+	/* the staging ring is released in the order of the commits */
+	while (aof->nfreed < aof->num) {
+		c = aof_commit_at(aof, aof->nfreed);
+		if (!c->finished)
+			break;
+
+		aof->ring_used -= c->stage_bytes;
+		aof->ring_head = c->stage_end;
+		if (c->status == IBV_WC_SUCCESS)
+			aof->durable = c->pos + c->len;
+		aof->nfreed++;
+	}
+
+	return 0;
+}
+
+/*
+ * rpma_aof_next -- get the completion of the oldest commit if it has been
+ * finished
+ */
+int
+rpma_aof_next(struct rpma_aof *aof, struct rpma_completion *cmpl)
+{
+	if (aof == NULL || cmpl == NULL)
+		return RPMA_E_INVAL;
+
+	if (aof->nfreed == 0)
+		return RPMA_E_NO_COMPLETION;
+
+	struct aof_commit *c = aof_commit_at(aof, 0);
+	cmpl->op_context = (void *)(uintptr_t)c->op_context;
+	cmpl->op = RPMA_OP_FLUSH;
+	cmpl->byte_len = 0;
+	cmpl->op_status = c->status;
+	cmpl->flags = 0;
+	cmpl->imm = 0;
+	cmpl->qp_num = 0;
+
+	aof->head = (aof->head + 1) % aof->depth;
+	aof->num--;
+	aof->nfreed--;
+
+	return 0;
+}
+
+/*
+ * rpma_aof_verify -- find the longest run of the intact records
+ */
+int
+rpma_aof_verify(const void *log, size_t tail, size_t *valid)
+{
+	if ((log == NULL && tail != 0) || valid == NULL)
+		return RPMA_E_INVAL;
+
+	const char *p = log;
+	size_t off = 0;
+	while (tail - off >= sizeof(struct aof_record)) {
+		const struct aof_record *rec =
+				(const struct aof_record *)(p + off);
+		size_t n = sizeof(*rec) + AOF_ALIGN_UP((size_t)rec->len);
+		if (rec->len == 0 || n > tail - off ||
+				rec->csum != aof_record_csum(rec))
+			break;
+		off += n;
+	}
+
+	*valid = off;
+
+	return 0;
+}
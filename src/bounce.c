@@ -0,0 +1,617 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * bounce.c -- librpma operations on unregistered memory
+ *
+ * Every operation takes one of the slots of the engine. A slot owns
+ * a bounce buffer carved out of a single registered slab. The data of a write
+ * or a send is copied into the bounce buffer before it is posted and the data
+ * of a read is copied out of it when the read completes. The operations
+ * too small to be worth a slot are posted inline if the QP allows that
+ * and the ones too big to fit into a bounce buffer use the user's memory
+ * registered on demand and kept in a small registration cache.
+ */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "conn.h"
+#include "log_internal.h"
+#include "mr.h"
+
+#ifdef TEST_MOCK_ALLOC
+#include "cmocka_alloc.h"
+#endif
+
+/* the number of the entries of the registration cache */
+#define BOUNCE_REGS		16
+
+/*
+ * the copies shorter than that are left to memcpy(3) since the data
+ * is likely to be still in the cache when it is posted or consumed
+ */
+#define BOUNCE_NT_COPY_MIN	(32 * 1024)
+
+struct bounce_reg {
+	char *addr; /* the page-aligned beginning of the registered memory */
+	size_t len; /* the page-aligned length of the registered memory */
+	int usage; /* the usage the memory has been registered for */
+	struct rpma_mr_local *mr; /* NULL if the entry is empty */
+	uint32_t refs; /* number of the operations in flight using it */
+	uint64_t last_used; /* the tick of the last use */
+};
+
+struct bounce_op {
+	enum rpma_op op; /* RPMA_OP_READ, RPMA_OP_WRITE or RPMA_OP_SEND */
+	void *dst; /* the destination of the copy-out of a staged read */
+	size_t len;
+	int flags; /* the completion flags of the caller */
+	const void *op_context; /* the op_context of the caller */
+	struct bounce_reg *reg; /* the cached registration (NULL if staged) */
+	bool busy; /* the slot is taken by an operation in flight */
+};
+
+struct rpma_bounce {
+	struct rpma_peer *peer;
+	struct rpma_conn *conn;
+	struct ibv_qp *qp;
+
+	size_t inline_cap; /* the maximum inline data size of the QP */
+	size_t inline_max; /* the maximum size of an operation posted inline */
+	size_t copy_max; /* the maximum size of an operation staged */
+
+	void *slab; /* the bounce buffers */
+	size_t mmap_size; /* size of the mmap()'ed slab */
+	struct rpma_mr_local *slab_mr; /* registration of the slab */
+	size_t slot_size; /* size of a single bounce buffer */
+
+	struct bounce_op *ops; /* the slots */
+	uint32_t slots; /* number of the slots */
+	uint32_t *free_ops; /* stack of the free slots */
+	uint32_t nfree; /* number of the free slots */
+
+	struct bounce_reg regs[BOUNCE_REGS]; /* the registration cache */
+	size_t pagesize;
+	uint64_t tick; /* the clock of the registration cache */
+};
+
+/*
+ * bounce_copy -- copy the data between the user's memory and a bounce
+ * buffer. The long copies bypass the CPU caches so they do not evict
+ * the working set of the application with the data the CPU is not going
+ * to touch again.
+ */
+static void
+bounce_copy(void *dst, const void *src, size_t len)
+{
+#ifdef __SSE2__
+	if (len >= BOUNCE_NT_COPY_MIN) {
+		char *d = dst;
+		const char *s = src;
+
+		/* the non-temporal stores have to be aligned */
+		size_t head = (16 - ((uintptr_t)d & 15)) & 15;
+		memcpy(d, s, head);
+		d += head;
+		s += head;
+		len -= head;
+
+		for (; len >= 64; len -= 64, d += 64, s += 64) {
+			__m128i x0 = _mm_loadu_si128((const __m128i *)s);
+			__m128i x1 = _mm_loadu_si128((const __m128i *)s + 1);
+			__m128i x2 = _mm_loadu_si128((const __m128i *)s + 2);
+			__m128i x3 = _mm_loadu_si128((const __m128i *)s + 3);
+			_mm_stream_si128((__m128i *)d, x0);
+			_mm_stream_si128((__m128i *)d + 1, x1);
+			_mm_stream_si128((__m128i *)d + 2, x2);
+			_mm_stream_si128((__m128i *)d + 3, x3);
+		}
+
+		/* the non-temporal stores are weakly ordered */
+		_mm_sfence();
+		memcpy(d, s, len);
+		return;
+	}
+#endif
+	memcpy(dst, src, len);
+}
+
+/*
+ * bounce_reg_get -- get a registration covering the given memory from
+ * the cache or register the memory evicting the least recently used
+ * registration not in use
+ */
+static int
+bounce_reg_get(struct rpma_bounce *bounce, const void *ptr, size_t len,
+		int usage, struct bounce_reg **reg_ptr)
+{
+	const char *begin = ptr;
+	struct bounce_reg *victim = NULL;
+
+	for (int i = 0; i < BOUNCE_REGS; ++i) {
+		struct bounce_reg *reg = &bounce->regs[i];
+		if (reg->mr == NULL) {
+			if (victim == NULL || victim->mr != NULL)
+				victim = reg;
+			continue;
+		}
+
+		if (begin >= reg->addr && len <= reg->len &&
+				(size_t)(begin - reg->addr) <= reg->len - len &&
+				(reg->usage & usage) == usage) {
+			*reg_ptr = reg;
+			return 0;
+		}
+
+		/* an empty entry is always a better victim */
+		if (reg->refs == 0 && (victim == NULL ||
+				(victim->mr != NULL &&
+				reg->last_used < victim->last_used)))
+			victim = reg;
+	}
+
+	if (victim == NULL)
+		return RPMA_E_AGAIN;
+
+	if (victim->mr != NULL) {
+		int ret = rpma_mr_dereg(&victim->mr);
+		if (ret)
+			return ret;
+	}
+
+	/* whole pages are registered so the neighbouring buffers hit it too */
+	uintptr_t mask = (uintptr_t)bounce->pagesize - 1;
+	uintptr_t addr = (uintptr_t)begin & ~mask;
+	uintptr_t end = ((uintptr_t)begin + len + mask) & ~mask;
+
+	int ret = rpma_mr_reg(bounce->peer, (void *)addr, (size_t)(end - addr),
+			usage, &victim->mr);
+	if (ret)
+		return ret;
+
+	victim->addr = (char *)addr;
+	victim->len = (size_t)(end - addr);
+	victim->usage = usage;
+	victim->refs = 0;
+	*reg_ptr = victim;
+
+	return 0;
+}
+
+/*
+ * bounce_op_get -- take a free slot and fill in the operation
+ */
+static struct bounce_op *
+bounce_op_get(struct rpma_bounce *bounce, enum rpma_op op, size_t len,
+		int flags, const void *op_context)
+{
+	if (bounce->nfree == 0)
+		return NULL;
+
+	struct bounce_op *bop = &bounce->ops[bounce->free_ops[--bounce->nfree]];
+	bop->op = op;
+	bop->dst = NULL;
+	bop->len = len;
+	bop->flags = flags;
+	bop->op_context = op_context;
+	bop->reg = NULL;
+	bop->busy = true;
+
+	return bop;
+}
+
+/*
+ * bounce_op_put -- return the slot of the operation
+ */
+static void
+bounce_op_put(struct rpma_bounce *bounce, struct bounce_op *bop)
+{
+	if (bop->reg)
+		bop->reg->refs--;
+
+	bop->busy = false;
+	bounce->free_ops[bounce->nfree++] = (uint32_t)(bop - bounce->ops);
+}
+
+/*
+ * bounce_op_buf -- get the offset of the bounce buffer of the operation
+ * within the slab
+ */
+static inline size_t
+bounce_op_buf(const struct rpma_bounce *bounce, const struct bounce_op *bop)
+{
+	return (size_t)(bop - bounce->ops) * bounce->slot_size;
+}
+
+/*
+ * bounce_op_src -- prepare the source of a write or a send: either copy
+ * the data into the bounce buffer or find the registration of the user's
+ * memory
+ */
+static int
+bounce_op_src(struct rpma_bounce *bounce, struct bounce_op *bop,
+		const void *src, size_t len,
+		const struct rpma_mr_local **mr_ptr, size_t *offset_ptr)
+{
+	if (len <= bounce->copy_max) {
+		size_t offset = bounce_op_buf(bounce, bop);
+		bounce_copy((char *)bounce->slab + offset, src, len);
+		*mr_ptr = bounce->slab_mr;
+		*offset_ptr = offset;
+		return 0;
+	}
+
+	int usage = (bop->op == RPMA_OP_SEND) ?
+			RPMA_MR_USAGE_SEND : RPMA_MR_USAGE_WRITE_SRC;
+	int ret = bounce_reg_get(bounce, src, len, usage, &bop->reg);
+	if (ret)
+		return ret;
+
+	bop->reg->refs++;
+	bop->reg->last_used = ++bounce->tick;
+	*mr_ptr = bop->reg->mr;
+	*offset_ptr = (size_t)((const char *)src - bop->reg->addr);
+
+	return 0;
+}
+
+/* public librpma API */
+
+/*
+ * rpma_bounce_new -- create a new engine of the operations on unregistered
+ * memory
+ */
+int
+rpma_bounce_new(struct rpma_peer *peer, struct rpma_conn *conn,
+		uint32_t slots, size_t slot_size,
+		struct rpma_bounce **bounce_ptr)
+{
+	if (peer == NULL || conn == NULL || bounce_ptr == NULL ||
+			slots == 0 || slot_size == 0 ||
+			slot_size > UINT32_MAX || slot_size > SIZE_MAX / slots)
+		return RPMA_E_INVAL;
+
+	struct ibv_qp *qp;
+	int ret = rpma_conn_get_ibv_qp(conn, &qp);
+	if (ret)
+		return ret;
+
+	struct ibv_qp_attr attr;
+	struct ibv_qp_init_attr init_attr;
+	errno = ibv_query_qp(qp, &attr, IBV_QP_CAP, &init_attr);
+	if (errno) {
+		RPMA_LOG_ERROR_WITH_ERRNO(errno, "ibv_query_qp(IBV_QP_CAP)");
+		return RPMA_E_PROVIDER;
+	}
+
+	/* the granularity of the cached registrations */
+	long pagesize = sysconf(_SC_PAGESIZE);
+	if (pagesize < 0) {
+		RPMA_LOG_FATAL("sysconf(_SC_PAGESIZE) failed: %s",
+				strerror(errno));
+		return RPMA_E_PROVIDER;
+	}
+
+	void *slab = NULL;
+	size_t mmap_size = 0;
+	struct rpma_mr_local *slab_mr = NULL;
+	ret = rpma_mr_slab_new(peer, slots * slot_size,
+			RPMA_MR_USAGE_READ_DST | RPMA_MR_USAGE_WRITE_SRC |
+			RPMA_MR_USAGE_SEND, &slab, &mmap_size, &slab_mr);
+	if (ret)
+		return ret;
+
+	struct rpma_bounce *bounce = malloc(sizeof(*bounce));
+	if (bounce == NULL) {
+		ret = RPMA_E_NOMEM;
+		goto err_mr_dereg;
+	}
+
+	bounce->ops = malloc(slots * sizeof(struct bounce_op));
+	if (bounce->ops == NULL) {
+		ret = RPMA_E_NOMEM;
+		goto err_free_bounce;
+	}
+
+	bounce->free_ops = malloc(slots * sizeof(uint32_t));
+	if (bounce->free_ops == NULL) {
+		ret = RPMA_E_NOMEM;
+		goto err_free_ops;
+	}
+
+	/* the slots are taken starting from the first one */
+	for (uint32_t i = 0; i < slots; ++i) {
+		bounce->ops[i].busy = false;
+		bounce->free_ops[i] = slots - 1 - i;
+	}
+
+	bounce->peer = peer;
+	bounce->conn = conn;
+	bounce->qp = qp;
+	bounce->inline_cap = init_attr.cap.max_inline_data;
+	bounce->inline_max = bounce->inline_cap;
+	bounce->copy_max = slot_size;
+	bounce->slab = slab;
+	bounce->mmap_size = mmap_size;
+	bounce->slab_mr = slab_mr;
+	bounce->slot_size = slot_size;
+	bounce->slots = slots;
+	bounce->nfree = slots;
+	memset(bounce->regs, 0, sizeof(bounce->regs));
+	bounce->pagesize = (size_t)pagesize;
+	bounce->tick = 0;
+
+	*bounce_ptr = bounce;
+
+	return 0;
+
+err_free_ops:
+	free(bounce->ops);
+
+err_free_bounce:
+	free(bounce);
+
+err_mr_dereg:
+	(void) rpma_mr_slab_delete(&slab_mr, slab, mmap_size);
+
+	return ret;
+}
+
+/*
+ * rpma_bounce_delete -- delete the engine and release the cached
+ * registrations
+ */
+int
+rpma_bounce_delete(struct rpma_bounce **bounce_ptr)
+{
+	if (bounce_ptr == NULL)
+		return RPMA_E_INVAL;
+
+	struct rpma_bounce *bounce = *bounce_ptr;
+	if (bounce == NULL)
+		return 0;
+
+	int ret = 0;
+	for (int i = 0; i < BOUNCE_REGS; ++i) {
+		if (bounce->regs[i].mr == NULL)
+			continue;
+
+		int err = rpma_mr_dereg(&bounce->regs[i].mr);
+		if (err && ret == 0)
+			ret = err;
+	}
+
+	int err = rpma_mr_slab_delete(&bounce->slab_mr, bounce->slab,
+			bounce->mmap_size);
+	if (err && ret == 0)
+		ret = err;
+
+	free(bounce->free_ops);
+	free(bounce->ops);
+	free(bounce);
+	*bounce_ptr = NULL;
+
+	return ret;
+}
+
+/*
+ * rpma_bounce_set_thresholds -- set the maximum sizes of the operations
+ * posted inline and staged in the bounce buffers
+ */
+int
+rpma_bounce_set_thresholds(struct rpma_bounce *bounce, size_t inline_max,
+		size_t copy_max)
+{
+	if (bounce == NULL || inline_max > bounce->inline_cap ||
+			copy_max > bounce->slot_size)
+		return RPMA_E_INVAL;
+
+	bounce->inline_max = inline_max;
+	bounce->copy_max = copy_max;
+
+	return 0;
+}
+
+/*
+ * rpma_bounce_get_thresholds -- get the maximum sizes of the operations
+ * posted inline and staged in the bounce buffers
+ */
+int
+rpma_bounce_get_thresholds(const struct rpma_bounce *bounce, size_t *inline_max,
+		size_t *copy_max)
+{
+	if (bounce == NULL || inline_max == NULL || copy_max == NULL)
+		return RPMA_E_INVAL;
+
+	*inline_max = bounce->inline_max;
+	*copy_max = bounce->copy_max;
+
+	return 0;
+}
+
+/*
+ * rpma_bounce_write -- initiate the write operation from unregistered memory
+ */
+int
+rpma_bounce_write(struct rpma_bounce *bounce,
+		struct rpma_mr_remote *dst, size_t dst_offset,
+		const void *src, size_t len, int flags, const void *op_context)
+{
+	if (bounce == NULL || dst == NULL || src == NULL || len == 0 ||
+			flags == 0)
+		return RPMA_E_INVAL;
+
+	if (len <= bounce->inline_max)
+		return rpma_mr_inline(bounce->qp, dst, dst_offset, src, len,
+				flags, IBV_WR_RDMA_WRITE, op_context);
+
+	struct bounce_op *bop = bounce_op_get(bounce, RPMA_OP_WRITE, len, flags,
+			op_context);
+	if (bop == NULL)
+		return RPMA_E_AGAIN;
+
+	const struct rpma_mr_local *src_mr;
+	size_t src_offset;
+	int ret = bounce_op_src(bounce, bop, src, len, &src_mr, &src_offset);
+	if (ret == 0)
+		ret = rpma_write(bounce->conn, dst, dst_offset,
+				src_mr, src_offset, len,
+				RPMA_F_COMPLETION_ALWAYS, bop);
+	if (ret)
+		bounce_op_put(bounce, bop);
+
+	return ret;
+}
+
+/*
+ * rpma_bounce_send -- initiate the send operation from unregistered memory
+ */
+int
+rpma_bounce_send(struct rpma_bounce *bounce, const void *src, size_t len,
+		int flags, const void *op_context)
+{
+	if (bounce == NULL || src == NULL || len == 0 || flags == 0)
+		return RPMA_E_INVAL;
+
+	if (len <= bounce->inline_max)
+		return rpma_mr_inline(bounce->qp, NULL, 0, src, len, flags,
+				IBV_WR_SEND, op_context);
+
+	struct bounce_op *bop = bounce_op_get(bounce, RPMA_OP_SEND, len, flags,
+			op_context);
+	if (bop == NULL)
+		return RPMA_E_AGAIN;
+
+	const struct rpma_mr_local *src_mr;
+	size_t src_offset;
+	int ret = bounce_op_src(bounce, bop, src, len, &src_mr, &src_offset);
+	if (ret == 0)
+		ret = rpma_send(bounce->conn, src_mr, src_offset, len,
+				RPMA_F_COMPLETION_ALWAYS, bop);
+	if (ret)
+		bounce_op_put(bounce, bop);
+
+	return ret;
+}
+
+/*
+ * rpma_bounce_read -- initiate the read operation to unregistered memory
+ */
+int
+rpma_bounce_read(struct rpma_bounce *bounce, void *dst,
+		const struct rpma_mr_remote *src, size_t src_offset,
+		size_t len, int flags, const void *op_context)
+{
+	if (bounce == NULL || dst == NULL || src == NULL || len == 0 ||
+			flags == 0)
+		return RPMA_E_INVAL;
+
+	struct bounce_op *bop = bounce_op_get(bounce, RPMA_OP_READ, len, flags,
+			op_context);
+	if (bop == NULL)
+		return RPMA_E_AGAIN;
+
+	int ret;
+	if (len <= bounce->copy_max) {
+		/* the data is copied out when the read completes */
+		bop->dst = dst;
+		ret = rpma_read(bounce->conn, bounce->slab_mr,
+				bounce_op_buf(bounce, bop), src, src_offset,
+				len, RPMA_F_COMPLETION_ALWAYS, bop);
+	} else {
+		ret = bounce_reg_get(bounce, dst, len, RPMA_MR_USAGE_READ_DST,
+				&bop->reg);
+		if (ret == 0) {
+			bop->reg->refs++;
+			bop->reg->last_used = ++bounce->tick;
+			ret = rpma_read(bounce->conn, bop->reg->mr,
+					(size_t)((char *)dst - bop->reg->addr),
+					src, src_offset, len,
+					RPMA_F_COMPLETION_ALWAYS, bop);
+		}
+	}
+	if (ret)
+		bounce_op_put(bounce, bop);
+
+	return ret;
+}
+
+/*
+ * rpma_bounce_process -- finish the operation the completion comes from
+ * and translate the completion into the one of the caller
+ */
+int
+rpma_bounce_process(struct rpma_bounce *bounce, struct rpma_completion *cmpl)
+{
+	if (bounce == NULL || cmpl == NULL)
+		return RPMA_E_INVAL;
+
+	uintptr_t ctx = (uintptr_t)cmpl->op_context;
+	uintptr_t base = (uintptr_t)bounce->ops;
+	size_t op_size = sizeof(struct bounce_op);
+	if (ctx < base || ctx >= base + bounce->slots * op_size ||
+			(ctx - base) % op_size != 0)
+		return RPMA_E_INVAL;
+
+	struct bounce_op *bop = (struct bounce_op *)ctx;
+	if (!bop->busy)
+		return RPMA_E_INVAL;
+
+	if (cmpl->op_status == IBV_WC_SUCCESS && bop->dst != NULL)
+		bounce_copy(bop->dst, (char *)bounce->slab +
+				bounce_op_buf(bounce, bop), bop->len);
+
+	bool report = (cmpl->op_status != IBV_WC_SUCCESS) ||
+			(bop->flags & RPMA_F_COMPLETION_ON_SUCCESS);
+	cmpl->op_context = (void *)(uintptr_t)bop->op_context;
+	bounce_op_put(bounce, bop);
+
+	return report ? 0 : RPMA_E_NO_COMPLETION;
+}
+
+/*
+ * rpma_bounce_invalidate -- drop the cached registrations of the memory
+ * which is about to be released
+ */
+int
+rpma_bounce_invalidate(struct rpma_bounce *bounce, const void *ptr, size_t len)
+{
+	if (bounce == NULL || ptr == NULL || len == 0)
+		return RPMA_E_INVAL;
+
+	const char *begin = ptr;
+	const char *end = begin + len;
+	struct bounce_reg *overlapping[BOUNCE_REGS];
+	int n = 0;
+
+	for (int i = 0; i < BOUNCE_REGS; ++i) {
+		struct bounce_reg *reg = &bounce->regs[i];
+		if (reg->mr == NULL || end <= reg->addr ||
+				begin >= reg->addr + reg->len)
+			continue;
+
+		/* nothing is dropped while the memory is still in use */
+		if (reg->refs != 0)
+			return RPMA_E_AGAIN;
+
+		overlapping[n++] = reg;
+	}
+
+	int ret = 0;
+	for (int i = 0; i < n; ++i) {
+		int err = rpma_mr_dereg(&overlapping[i]->mr);
+		if (err && ret == 0)
+			ret = err;
+	}
+
+	return ret;
+}
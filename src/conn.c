@@ -12,9 +12,11 @@
 #include "common.h"
 #include "conn.h"
 #include "flush.h"
+#include "librpma_fast.h"
 #include "log_internal.h"
 #include "mr.h"
 #include "private_data.h"
+#include "trace.h"
 
 #ifdef TEST_MOCK_ALLOC
 #include "cmocka_alloc.h"
@@ -27,10 +29,116 @@ struct rpma_conn {
 
 	struct rpma_conn_private_data data; /* private data of the CM ID */
 	struct rpma_flush *flush; /* flushing object */
+	struct rpma_conn_mt *mt; /* thread-safe posting (if enabled) */
+	struct rpma_conn_stats *stats; /* performance statistics (if enabled) */
+
+	/*
+	 * The ordering domains which had a read or an atomic operation posted
+	 * since the last fenced work request (one bit per domain).
+	 */
+	uint32_t unfenced;
 
 	bool direct_write_to_pmem; /* direct write to pmem is supported */
 };
 
+/* the operations posted without a domain are ordered in all of them */
+#define CONN_DOMAINS_ALL	UINT32_MAX
+
+/*
+ * conn_posting -- note the operation about to be posted
+ * (if the statistics are collected)
+ */
+static inline void
+conn_posting(struct rpma_conn *conn, enum rpma_op op, int flags)
+{
+	if (conn->stats)
+		rpma_conn_stats_posting(conn->stats, op, flags);
+}
+
+/*
+ * conn_posted -- count the result of posting the operation
+ * (if the statistics are collected) and pass the result through
+ */
+static inline int
+conn_posted(struct rpma_conn *conn, enum rpma_op op, size_t len, int flags,
+		int ret)
+{
+	if (conn->stats)
+		rpma_conn_stats_posted(conn->stats, op, len, flags, ret);
+
+	return ret;
+}
+
+/*
+ * conn_read -- post the read operation in the given ordering domains
+ */
+static int
+conn_read(struct rpma_conn *conn,
+	struct rpma_mr_local *dst, size_t dst_offset,
+	const struct rpma_mr_remote *src,  size_t src_offset,
+	size_t len, int flags, uint32_t domains, const void *op_context)
+{
+	int ret;
+
+	conn_posting(conn, RPMA_OP_READ, flags);
+
+	if (conn->mt) {
+		ret = rpma_conn_mt_read(conn->mt, dst, dst_offset,
+				src, src_offset, len, flags, op_context);
+	} else {
+		ret = rpma_mr_read(conn->id->qp,
+				dst, dst_offset,
+				src, src_offset,
+				len, flags, op_context);
+		if (ret == 0)
+			conn->unfenced |= domains;
+	}
+
+	return conn_posted(conn, RPMA_OP_READ, len, flags, ret);
+}
+
+/*
+ * conn_write_atomic -- post the atomic write operation ordered after
+ * the reads and the atomic operations of the given ordering domains
+ *
+ * The fence is emitted only if any of the domains had a read or an atomic
+ * operation posted since the last fence. Since a fence holds the work
+ * request until all the earlier reads and atomic operations of the queue
+ * pair complete, it settles all the domains at once. The posting order
+ * of the threads sharing a connection is not known here so the thread-safe
+ * connections are always fenced.
+ */
+static int
+conn_write_atomic(struct rpma_conn *conn,
+	struct rpma_mr_remote *dst, size_t dst_offset,
+	const struct rpma_mr_local *src,  size_t src_offset,
+	int flags, uint32_t domains, const void *op_context)
+{
+	int ret;
+
+	conn_posting(conn, RPMA_OP_WRITE, flags);
+
+	if (conn->mt) {
+		ret = rpma_conn_mt_write(conn->mt, dst, dst_offset,
+				src, src_offset,
+				RPMA_ATOMIC_WRITE_ALIGNMENT, flags,
+				IBV_WR_RDMA_WRITE, 0, op_context, true);
+	} else {
+		bool fence = (conn->unfenced & domains) != 0;
+		ret = rpma_mr_write(conn->id->qp,
+				dst, dst_offset,
+				src, src_offset,
+				RPMA_ATOMIC_WRITE_ALIGNMENT, flags,
+				IBV_WR_RDMA_WRITE, 0,
+				op_context, fence);
+		if (ret == 0 && fence)
+			conn->unfenced = 0;
+	}
+
+	return conn_posted(conn, RPMA_OP_WRITE, RPMA_ATOMIC_WRITE_ALIGNMENT,
+			flags, ret);
+}
+
 /* internal librpma API */
 
 /*
@@ -78,8 +186,13 @@ rpma_conn_new(struct rpma_peer *peer, struct rdma_cm_id *id,
 	conn->data.ptr = NULL;
 	conn->data.len = 0;
 	conn->flush = flush;
+	conn->mt = NULL;
+	conn->stats = NULL;
+	conn->unfenced = 0;
 	conn->direct_write_to_pmem = false;
 
+	RPMA_TRACE(conn_new, conn, id);
+
 	*conn_ptr = conn;
 
 	return 0;
@@ -111,6 +224,99 @@ rpma_conn_transfer_private_data(struct rpma_conn *conn,
 	pdata->len = 0;
 }
 
+/*
+ * rpma_conn_transfer_mt -- transfer the thread-safe posting object to
+ * the connection (a take over).
+ */
+void
+rpma_conn_transfer_mt(struct rpma_conn *conn, struct rpma_conn_mt **mt_ptr)
+{
+	conn->mt = *mt_ptr;
+	*mt_ptr = NULL;
+}
+
+/*
+ * rpma_conn_transfer_stats -- transfer the statistics to the connection
+ * (a take over).
+ */
+void
+rpma_conn_transfer_stats(struct rpma_conn *conn,
+		struct rpma_conn_stats **stats_ptr)
+{
+	conn->stats = *stats_ptr;
+	*stats_ptr = NULL;
+}
+
+/*
+ * rpma_conn_get_ibv_qp -- get the QP of the connection for posting
+ * work requests directly
+ */
+int
+rpma_conn_get_ibv_qp(const struct rpma_conn *conn, struct ibv_qp **qp_ptr)
+{
+	/* the thread-safe modes have to track all posted work requests */
+	if (conn->mt)
+		return RPMA_E_NOSUPP;
+
+	/* the latencies are matched with all the posted work requests */
+	if (conn->stats && rpma_conn_stats_latency(conn->stats))
+		return RPMA_E_NOSUPP;
+
+	*qp_ptr = conn->id->qp;
+
+	return 0;
+}
+
+/*
+ * rpma_conn_get_cq -- get the CQ of the connection for collecting
+ * completions directly
+ */
+int
+rpma_conn_get_cq(const struct rpma_conn *conn, struct rpma_cq **cq_ptr)
+{
+	/* the thread-safe modes have to route all the completions */
+	if (conn->mt)
+		return RPMA_E_NOSUPP;
+
+	/* the latencies are matched with all the completions */
+	if (conn->stats && rpma_conn_stats_latency(conn->stats))
+		return RPMA_E_NOSUPP;
+
+	*cq_ptr = conn->cq;
+
+	return 0;
+}
+
+/*
+ * rpma_conn_reads_posted -- note the reads posted directly to the QP
+ * of the connection
+ */
+void
+rpma_conn_reads_posted(struct rpma_conn *conn)
+{
+	/* the reads posted directly are ordered in all the domains */
+	conn->unfenced = CONN_DOMAINS_ALL;
+}
+
+/*
+ * rpma_conn_get_max_msg_sz -- get the maximum size of a single message
+ * supported by the port of the connection
+ */
+int
+rpma_conn_get_max_msg_sz(const struct rpma_conn *conn, uint32_t *max_msg_sz)
+{
+	struct ibv_port_attr attr;
+	errno = ibv_query_port(conn->id->verbs, conn->id->port_num, &attr);
+	if (errno) {
+		RPMA_LOG_ERROR_WITH_ERRNO(errno, "ibv_query_port()");
+		return RPMA_E_PROVIDER;
+	}
+
+	*max_msg_sz = attr.max_msg_sz;
+
+	return 0;
+}
+
 /* public librpma API */
 
 /*
@@ -186,6 +392,7 @@ rpma_conn_next_event(struct rpma_conn *conn, enum rpma_conn_event *event)
 			return RPMA_E_UNKNOWN;
 	}
 
+	RPMA_TRACE(conn_event, conn, *event);
 	RPMA_LOG_NOTICE("%s", rpma_utils_conn_event_2str(*event));
 
 	return 0;
@@ -221,6 +428,8 @@ rpma_conn_disconnect(struct rpma_conn *conn)
 	if (conn == NULL)
 		return RPMA_E_INVAL;
 
+	RPMA_TRACE(conn_disconnect, conn);
+
 	if (rdma_disconnect(conn->id)) {
 		RPMA_LOG_ERROR_WITH_ERRNO(errno, "rdma_disconnect()");
 		return RPMA_E_PROVIDER;
@@ -244,8 +453,13 @@ rpma_conn_delete(struct rpma_conn **conn_ptr)
 	if (conn == NULL)
 		return 0;
 
+	RPMA_TRACE(conn_delete, conn);
+
 	int ret = 0;
 
+	(void) rpma_conn_mt_delete(&conn->mt);
+	(void) rpma_conn_stats_delete(&conn->stats);
+
 	ret = rpma_flush_delete(&conn->flush);
 	if (ret)
 		goto err_rpma_cq_delete;
@@ -292,16 +506,34 @@ rpma_read(struct rpma_conn *conn,
 	const struct rpma_mr_remote *src,  size_t src_offset,
 	size_t len, int flags, const void *op_context)
 {
-	if (conn == NULL || flags == 0 ||
+	if (conn == NULL || flags == 0 || len > UINT32_MAX ||
 	    ((src == NULL || dst == NULL) &&
 	    (src != NULL || dst != NULL || dst_offset != 0 || src_offset != 0 ||
 	    len != 0)))
 		return RPMA_E_INVAL;
 
-	return rpma_mr_read(conn->id->qp,
-			dst, dst_offset,
-			src, src_offset,
-			len, flags, op_context);
+	return conn_read(conn, dst, dst_offset, src, src_offset, len, flags,
+			CONN_DOMAINS_ALL, op_context);
+}
+
+/*
+ * rpma_read_in_domain -- initiate the read operation in the ordering domain
+ */
+int
+rpma_read_in_domain(struct rpma_conn *conn,
+	struct rpma_mr_local *dst, size_t dst_offset,
+	const struct rpma_mr_remote *src,  size_t src_offset,
+	size_t len, int flags, unsigned domain, const void *op_context)
+{
+	if (conn == NULL || flags == 0 || len > UINT32_MAX ||
+	    domain >= RPMA_ORDER_DOMAINS_MAX ||
+	    ((src == NULL || dst == NULL) &&
+	    (src != NULL || dst != NULL || dst_offset != 0 || src_offset != 0 ||
+	    len != 0)))
+		return RPMA_E_INVAL;
+
+	return conn_read(conn, dst, dst_offset, src, src_offset, len, flags,
+			(uint32_t)1 << domain, op_context);
 }
 
 /*
@@ -313,18 +545,29 @@ rpma_write(struct rpma_conn *conn,
 	const struct rpma_mr_local *src,  size_t src_offset,
 	size_t len, int flags, const void *op_context)
 {
-	if (conn == NULL || flags == 0 ||
+	if (conn == NULL || flags == 0 || len > UINT32_MAX ||
 	    ((src == NULL || dst == NULL) &&
 	    (src != NULL || dst != NULL || dst_offset != 0 || src_offset != 0 ||
 	    len != 0)))
 		return RPMA_E_INVAL;
 
-	return rpma_mr_write(conn->id->qp,
-			dst, dst_offset,
-			src, src_offset,
-			len, flags,
-			IBV_WR_RDMA_WRITE, 0,
-			op_context, false);
+	int ret;
+
+	conn_posting(conn, RPMA_OP_WRITE, flags);
+
+	if (conn->mt)
+		ret = rpma_conn_mt_write(conn->mt, dst, dst_offset,
+				src, src_offset, len, flags,
+				IBV_WR_RDMA_WRITE, 0, op_context, false);
+	else
+		ret = rpma_mr_write(conn->id->qp,
+				dst, dst_offset,
+				src, src_offset,
+				len, flags,
+				IBV_WR_RDMA_WRITE, 0,
+				op_context, false);
+
+	return conn_posted(conn, RPMA_OP_WRITE, len, flags, ret);
 }
 
 /*
@@ -336,18 +579,30 @@ rpma_write_with_imm(struct rpma_conn *conn,
 	const struct rpma_mr_local *src,  size_t src_offset,
 	size_t len, int flags, uint32_t imm, const void *op_context)
 {
-	if (conn == NULL || flags == 0 ||
+	if (conn == NULL || flags == 0 || len > UINT32_MAX ||
 	    ((src == NULL || dst == NULL) &&
 	    (src != NULL || dst != NULL || dst_offset != 0 || src_offset != 0 ||
 	    len != 0)))
 		return RPMA_E_INVAL;
 
-	return rpma_mr_write(conn->id->qp,
-			dst, dst_offset,
-			src, src_offset,
-			len, flags,
-			IBV_WR_RDMA_WRITE_WITH_IMM, imm,
-			op_context, false);
+	int ret;
+
+	conn_posting(conn, RPMA_OP_WRITE, flags);
+
+	if (conn->mt)
+		ret = rpma_conn_mt_write(conn->mt, dst, dst_offset,
+				src, src_offset, len, flags,
+				IBV_WR_RDMA_WRITE_WITH_IMM, imm,
+				op_context, false);
+	else
+		ret = rpma_mr_write(conn->id->qp,
+				dst, dst_offset,
+				src, src_offset,
+				len, flags,
+				IBV_WR_RDMA_WRITE_WITH_IMM, imm,
+				op_context, false);
+
+	return conn_posted(conn, RPMA_OP_WRITE, len, flags, ret);
 }
 
 /*
@@ -365,12 +620,103 @@ rpma_write_atomic(struct rpma_conn *conn,
 	if (dst_offset % RPMA_ATOMIC_WRITE_ALIGNMENT != 0)
 		return RPMA_E_INVAL;
 
-	return rpma_mr_write(conn->id->qp,
-			dst, dst_offset,
-			src, src_offset,
-			RPMA_ATOMIC_WRITE_ALIGNMENT, flags,
-			IBV_WR_RDMA_WRITE, 0,
-			op_context, true);
+	return conn_write_atomic(conn, dst, dst_offset, src, src_offset, flags,
+			CONN_DOMAINS_ALL, op_context);
+}
+
+/*
+ * rpma_write_atomic_in_domain -- initiate the atomic write operation ordered
+ * after the reads of the ordering domain
+ */
+int
+rpma_write_atomic_in_domain(struct rpma_conn *conn,
+	struct rpma_mr_remote *dst, size_t dst_offset,
+	const struct rpma_mr_local *src,  size_t src_offset,
+	int flags, unsigned domain, const void *op_context)
+{
+	if (conn == NULL || dst == NULL || src == NULL || flags == 0 ||
+	    domain >= RPMA_ORDER_DOMAINS_MAX)
+		return RPMA_E_INVAL;
+
+	if (dst_offset % RPMA_ATOMIC_WRITE_ALIGNMENT != 0)
+		return RPMA_E_INVAL;
+
+	return conn_write_atomic(conn, dst, dst_offset, src, src_offset, flags,
+			(uint32_t)1 << domain, op_context);
+}
+
+/*
+ * rpma_compare_and_swap -- initiate the atomic compare-and-swap operation
+ */
+int
+rpma_compare_and_swap(struct rpma_conn *conn,
+	struct rpma_mr_local *dst, size_t dst_offset,
+	const struct rpma_mr_remote *src, size_t src_offset,
+	uint64_t compare, uint64_t swap, int flags, const void *op_context)
+{
+	if (conn == NULL || dst == NULL || src == NULL || flags == 0)
+		return RPMA_E_INVAL;
+
+	if (src_offset % RPMA_ATOMIC_ALIGNMENT != 0)
+		return RPMA_E_INVAL;
+
+	int ret;
+
+	conn_posting(conn, RPMA_OP_COMPARE_AND_SWAP, flags);
+
+	if (conn->mt) {
+		ret = rpma_conn_mt_atomic(conn->mt, dst, dst_offset,
+				src, src_offset, IBV_WR_ATOMIC_CMP_AND_SWP,
+				compare, swap, flags, op_context);
+	} else {
+		ret = rpma_mr_atomic(conn->id->qp,
+				dst, dst_offset,
+				src, src_offset,
+				IBV_WR_ATOMIC_CMP_AND_SWP, compare, swap,
+				flags, op_context);
+		if (ret == 0)
+			conn->unfenced = CONN_DOMAINS_ALL;
+	}
+
+	return conn_posted(conn, RPMA_OP_COMPARE_AND_SWAP,
+			RPMA_ATOMIC_ALIGNMENT, flags, ret);
+}
+
+/*
+ * rpma_fetch_and_add -- initiate the atomic fetch-and-add operation
+ */
+int
+rpma_fetch_and_add(struct rpma_conn *conn,
+	struct rpma_mr_local *dst, size_t dst_offset,
+	const struct rpma_mr_remote *src, size_t src_offset,
+	uint64_t add, int flags, const void *op_context)
+{
+	if (conn == NULL || dst == NULL || src == NULL || flags == 0)
+		return RPMA_E_INVAL;
+
+	if (src_offset % RPMA_ATOMIC_ALIGNMENT != 0)
+		return RPMA_E_INVAL;
+
+	int ret;
+
+	conn_posting(conn, RPMA_OP_FETCH_AND_ADD, flags);
+
+	if (conn->mt) {
+		ret = rpma_conn_mt_atomic(conn->mt, dst, dst_offset,
+				src, src_offset, IBV_WR_ATOMIC_FETCH_AND_ADD,
+				add, 0, flags, op_context);
+	} else {
+		ret = rpma_mr_atomic(conn->id->qp,
+				dst, dst_offset,
+				src, src_offset,
+				IBV_WR_ATOMIC_FETCH_AND_ADD, add, 0,
+				flags, op_context);
+		if (ret == 0)
+			conn->unfenced = CONN_DOMAINS_ALL;
+	}
+
+	return conn_posted(conn, RPMA_OP_FETCH_AND_ADD,
+			RPMA_ATOMIC_ALIGNMENT, flags, ret);
 }
 
 /*
@@ -409,9 +755,23 @@ rpma_flush(struct rpma_conn *conn,
 		return RPMA_E_NOSUPP;
 	}
 
-	rpma_flush_func flush = conn->flush->func;
-	return flush(conn->id->qp, conn->flush, dst, dst_offset,
-			len, type, flags, op_context);
+	int ret;
+
+	conn_posting(conn, RPMA_OP_FLUSH, flags);
+
+	if (conn->mt) {
+		ret = rpma_conn_mt_flush(conn->mt, conn->flush, dst,
+				dst_offset, len, type, flags, op_context);
+	} else {
+		/* a flush may be implemented as a read (e.g. APM) */
+		rpma_flush_func flush = conn->flush->func;
+		ret = flush(conn->id->qp, conn->flush, dst, dst_offset,
+				len, type, flags, op_context);
+		if (ret == 0)
+			conn->unfenced = CONN_DOMAINS_ALL;
+	}
+
+	return conn_posted(conn, RPMA_OP_FLUSH, len, flags, ret);
 }
 
 /*
@@ -426,10 +786,20 @@ rpma_send(struct rpma_conn *conn,
 	    (src == NULL && (offset != 0 || len != 0)))
 		return RPMA_E_INVAL;
 
-	return rpma_mr_send(conn->id->qp,
-			src, offset, len,
-			flags, IBV_WR_SEND,
-			0, op_context);
+	int ret;
+
+	conn_posting(conn, RPMA_OP_SEND, flags);
+
+	if (conn->mt)
+		ret = rpma_conn_mt_send(conn->mt, src, offset, len, flags,
+				IBV_WR_SEND, 0, op_context);
+	else
+		ret = rpma_mr_send(conn->id->qp,
+				src, offset, len,
+				flags, IBV_WR_SEND,
+				0, op_context);
+
+	return conn_posted(conn, RPMA_OP_SEND, len, flags, ret);
 }
 
 /*
@@ -444,10 +814,20 @@ rpma_send_with_imm(struct rpma_conn *conn,
 	    (src == NULL && (offset != 0 || len != 0)))
 		return RPMA_E_INVAL;
 
-	return rpma_mr_send(conn->id->qp,
-			src, offset, len,
-			flags, IBV_WR_SEND_WITH_IMM,
-			imm, op_context);
+	int ret;
+
+	conn_posting(conn, RPMA_OP_SEND, flags);
+
+	if (conn->mt)
+		ret = rpma_conn_mt_send(conn->mt, src, offset, len, flags,
+				IBV_WR_SEND_WITH_IMM, imm, op_context);
+	else
+		ret = rpma_mr_send(conn->id->qp,
+				src, offset, len,
+				flags, IBV_WR_SEND_WITH_IMM,
+				imm, op_context);
+
+	return conn_posted(conn, RPMA_OP_SEND, len, flags, ret);
 }
 
 /*
@@ -461,9 +841,20 @@ rpma_recv(struct rpma_conn *conn,
 	if (conn == NULL || (dst == NULL && (offset != 0 || len != 0)))
 		return RPMA_E_INVAL;
 
-	return rpma_mr_recv(conn->id->qp,
-			dst, offset, len,
-			op_context);
+	int ret;
+
+	conn_posting(conn, RPMA_OP_RECV, RPMA_F_COMPLETION_ALWAYS);
+
+	if (conn->mt)
+		ret = rpma_conn_mt_recv(conn->mt, dst, offset, len,
+				op_context);
+	else
+		ret = rpma_mr_recv(conn->id->qp,
+				dst, offset, len,
+				op_context);
+
+	return conn_posted(conn, RPMA_OP_RECV, len, RPMA_F_COMPLETION_ALWAYS,
+			ret);
 }
 
 /*
@@ -479,6 +870,60 @@ rpma_conn_get_completion_fd(const struct rpma_conn *conn, int *fd)
 	return rpma_cq_get_fd(conn->cq, fd);
 }
 
+/*
+ * rpma_conn_get_qp_num -- get the number of the connection's queue pair
+ */
+int
+rpma_conn_get_qp_num(const struct rpma_conn *conn, uint32_t *qp_num)
+{
+	if (conn == NULL || qp_num == NULL)
+		return RPMA_E_INVAL;
+
+	*qp_num = conn->id->qp->qp_num;
+
+	return 0;
+}
+
+/*
+ * rpma_conn_get_fast -- get the fast handle of the connection
+ */
+int
+rpma_conn_get_fast(struct rpma_conn *conn, struct rpma_fast_conn *fconn)
+{
+	if (conn == NULL || fconn == NULL)
+		return RPMA_E_INVAL;
+
+	/* the thread-safe modes have to track all posted work requests */
+	if (conn->mt)
+		return RPMA_E_NOSUPP;
+
+	/* the latencies are matched with all the posted work requests */
+	if (conn->stats && rpma_conn_stats_latency(conn->stats))
+		return RPMA_E_NOSUPP;
+
+	fconn->qp = conn->id->qp;
+	fconn->unfenced = &conn->unfenced;
+
+	return 0;
+}
+
+/*
+ * rpma_conn_get_stats -- take a snapshot of the statistics of the connection
+ */
+int
+rpma_conn_get_stats(const struct rpma_conn *conn, struct rpma_stats *stats)
+{
+	if (conn == NULL || stats == NULL)
+		return RPMA_E_INVAL;
+
+	if (conn->stats == NULL)
+		return RPMA_E_NOSUPP;
+
+	rpma_conn_stats_get(conn->stats, stats);
+
+	return 0;
+}
+
 /*
  * rpma_conn_completion_wait -- wait for a completion
  */
@@ -488,7 +933,16 @@ rpma_conn_completion_wait(struct rpma_conn *conn)
 	if (conn == NULL)
 		return RPMA_E_INVAL;
 
-	return rpma_cq_wait(conn->cq);
+	int ret;
+	if (conn->mt)
+		ret = rpma_conn_mt_completion_wait(conn->mt);
+	else
+		ret = rpma_cq_wait(conn->cq);
+
+	if (conn->stats)
+		rpma_conn_stats_woken(conn->stats, ret);
+
+	return ret;
 }
 
 /*
@@ -501,7 +955,68 @@ rpma_conn_completion_get(struct rpma_conn *conn,
 	if (conn == NULL || cmpl == NULL)
 		return RPMA_E_INVAL;
 
-	return rpma_cq_get_completion(conn->cq, cmpl);
+	int ret;
+	if (conn->mt)
+		ret = rpma_conn_mt_completion_get(conn->mt, cmpl);
+	else
+		ret = rpma_cq_get_completion(conn->cq, cmpl);
+
+	if (conn->stats)
+		rpma_conn_stats_polled(conn->stats, cmpl, ret);
+
+	return ret;
+}
+
+/*
+ * rpma_conn_completion_get_ex -- receive a timestamped completion
+ */
+int
+rpma_conn_completion_get_ex(struct rpma_conn *conn,
+		struct rpma_completion_ex *cmpl_ex)
+{
+	if (conn == NULL || cmpl_ex == NULL)
+		return RPMA_E_INVAL;
+
+	/* the completions may be handed over between the threads */
+	if (conn->mt)
+		return RPMA_E_NOSUPP;
+
+	int ret = rpma_cq_get_completion_ex(conn->cq, cmpl_ex);
+
+	if (conn->stats)
+		rpma_conn_stats_polled(conn->stats, &cmpl_ex->cmpl, ret);
+
+	return ret;
+}
+
+/*
+ * rpma_conn_thread_attach -- attach the calling thread to the connection
+ */
+int
+rpma_conn_thread_attach(struct rpma_conn *conn)
+{
+	if (conn == NULL)
+		return RPMA_E_INVAL;
+
+	if (conn->mt == NULL)
+		return RPMA_E_NOSUPP;
+
+	return rpma_conn_mt_thread_attach(conn->mt);
+}
+
+/*
+ * rpma_conn_thread_detach -- detach the calling thread from the connection
+ */
+int
+rpma_conn_thread_detach(struct rpma_conn *conn)
+{
+	if (conn == NULL)
+		return RPMA_E_INVAL;
+
+	if (conn->mt == NULL)
+		return RPMA_E_NOSUPP;
+
+	return rpma_conn_mt_thread_detach(conn->mt);
 }
 
 /*
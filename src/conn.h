@@ -10,7 +10,9 @@
 #define LIBRPMA_CONN_H
 
 #include "librpma.h"
+#include "conn_mt.h"
 #include "cq.h"
+#include "stats.h"
 
 #include <rdma/rdma_cma.h>
 
@@ -36,4 +38,82 @@ int rpma_conn_new(struct rpma_peer *peer, struct rdma_cm_id *id,
 void rpma_conn_transfer_private_data(struct rpma_conn *conn,
 		struct rpma_conn_private_data *pdata);
 
+/*
+ * rpma_conn_transfer_mt -- transfer the thread-safe posting object to
+ * the connection (a take over).
+ *
+ * ASSUMPTIONS
+ * - conn != NULL && mt_ptr != NULL
+ */
+void rpma_conn_transfer_mt(struct rpma_conn *conn,
+		struct rpma_conn_mt **mt_ptr);
+
+/*
+ * rpma_conn_transfer_stats -- transfer the statistics to the connection
+ * (a take over).
+ *
+ * ASSUMPTIONS
+ * - conn != NULL && stats_ptr != NULL
+ */
+void rpma_conn_transfer_stats(struct rpma_conn *conn,
+		struct rpma_conn_stats **stats_ptr);
+
+/*
+ * rpma_conn_get_ibv_qp -- get the QP of the connection for posting
+ * work requests directly (bypassing the thread-safe posting path).
+ *
+ * ASSUMPTIONS
+ * - conn != NULL && qp_ptr != NULL
+ *
+ * ERRORS
+ * rpma_conn_get_ibv_qp() can fail with the following error:
+ *
+ * - RPMA_E_NOSUPP - the connection works in a thread-safe mode or collects
+ *                   the latency
+ */
+int rpma_conn_get_ibv_qp(const struct rpma_conn *conn,
+		struct ibv_qp **qp_ptr);
+
+/*
+ * rpma_conn_get_cq -- get the CQ of the connection for collecting
+ * completions directly (bypassing the completion routing).
+ *
+ * ASSUMPTIONS
+ * - conn != NULL && cq_ptr != NULL
+ *
+ * ERRORS
+ * rpma_conn_get_cq() can fail with the following error:
+ *
+ * - RPMA_E_NOSUPP - the connection works in a thread-safe mode or collects
+ *                   the latency
+ */
+int rpma_conn_get_cq(const struct rpma_conn *conn, struct rpma_cq **cq_ptr);
+
+/*
+ * rpma_conn_reads_posted -- note the reads posted directly to the QP of
+ * the connection so the next atomic write is fenced.
+ *
+ * ASSUMPTIONS
+ * - conn != NULL
+ *
+ * ERRORS
+ * rpma_conn_reads_posted() cannot fail.
+ */
+void rpma_conn_reads_posted(struct rpma_conn *conn);
+
+/*
+ * rpma_conn_get_max_msg_sz -- get the maximum size of a single message
+ * supported by the port of the connection.
+ *
+ * ASSUMPTIONS
+ * - conn != NULL && max_msg_sz != NULL
+ *
+ * ERRORS
+ * rpma_conn_get_max_msg_sz() can fail with the following error:
+ *
+ * - RPMA_E_PROVIDER - ibv_query_port() failed
+ */
+int rpma_conn_get_max_msg_sz(const struct rpma_conn *conn,
+		uint32_t *max_msg_sz);
+
 #endif /* LIBRPMA_CONN_H */
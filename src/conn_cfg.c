@@ -29,13 +29,27 @@ struct rpma_conn_cfg {
 	uint32_t cq_size;	/* CQ size */
 	uint32_t sq_size;	/* SQ size */
 	uint32_t rq_size;	/* RQ size */
+	enum rpma_conn_thread_mode thread_mode; /* posting threading mode */
+	int comp_vector;	/* CQ completion vector */
+	int numa_node;	/* NUMA node of the internal buffers and queues */
+	struct rpma_srq *srq;	/* shared receive queue */
+	uint32_t inline_size;	/* maximum size of the inline data */
+	int stats;	/* the statistics collected (RPMA_STATS_*) */
+	bool timestamps;	/* timestamp the completions by the device */
 };
 
 static struct rpma_conn_cfg Conn_cfg_default  = {
 	.timeout_ms = RPMA_DEFAULT_TIMEOUT_MS,
 	.cq_size = RPMA_DEFAULT_Q_SIZE,
 	.sq_size = RPMA_DEFAULT_Q_SIZE,
-	.rq_size = RPMA_DEFAULT_Q_SIZE
+	.rq_size = RPMA_DEFAULT_Q_SIZE,
+	.thread_mode = RPMA_CONN_THREAD_SINGLE,
+	.comp_vector = 0,
+	.numa_node = RPMA_NUMA_NODE_ANY,
+	.srq = NULL,
+	.inline_size = 0,
+	.stats = 0,
+	.timestamps = false
 };
 
 /* internal librpma API */
@@ -223,3 +237,222 @@ rpma_conn_cfg_get_rq_size(const struct rpma_conn_cfg *cfg, uint32_t *rq_size)
 
 	return 0;
 }
+
+/*
+ * rpma_conn_cfg_set_thread_mode -- set the threading mode of the connection
+ */
+int
+rpma_conn_cfg_set_thread_mode(struct rpma_conn_cfg *cfg,
+		enum rpma_conn_thread_mode mode)
+{
+	if (cfg == NULL)
+		return RPMA_E_INVAL;
+
+	switch (mode) {
+	case RPMA_CONN_THREAD_SINGLE:
+	case RPMA_CONN_THREAD_SAFE:
+	case RPMA_CONN_THREAD_LOCKLESS:
+		break;
+	default:
+		return RPMA_E_INVAL;
+	}
+
+	cfg->thread_mode = mode;
+
+	return 0;
+}
+
+/*
+ * rpma_conn_cfg_get_thread_mode -- get the threading mode of the connection
+ */
+int
+rpma_conn_cfg_get_thread_mode(const struct rpma_conn_cfg *cfg,
+		enum rpma_conn_thread_mode *mode)
+{
+	if (cfg == NULL || mode == NULL)
+		return RPMA_E_INVAL;
+
+	*mode = cfg->thread_mode;
+
+	return 0;
+}
+
+/*
+ * rpma_conn_cfg_set_comp_vector -- set the completion vector of the CQ
+ */
+int
+rpma_conn_cfg_set_comp_vector(struct rpma_conn_cfg *cfg, int comp_vector)
+{
+	if (cfg == NULL)
+		return RPMA_E_INVAL;
+
+	if (comp_vector < 0 && comp_vector != RPMA_COMP_VECTOR_AUTO)
+		return RPMA_E_INVAL;
+
+	cfg->comp_vector = comp_vector;
+
+	return 0;
+}
+
+/*
+ * rpma_conn_cfg_get_comp_vector -- get the completion vector of the CQ
+ */
+int
+rpma_conn_cfg_get_comp_vector(const struct rpma_conn_cfg *cfg,
+		int *comp_vector)
+{
+	if (cfg == NULL || comp_vector == NULL)
+		return RPMA_E_INVAL;
+
+	*comp_vector = cfg->comp_vector;
+
+	return 0;
+}
+
+/*
+ * rpma_conn_cfg_set_numa_node -- set the NUMA node of the connection's
+ * internal buffers and queues
+ */
+int
+rpma_conn_cfg_set_numa_node(struct rpma_conn_cfg *cfg, int node)
+{
+	if (cfg == NULL || (node < 0 && node != RPMA_NUMA_NODE_ANY))
+		return RPMA_E_INVAL;
+
+	cfg->numa_node = node;
+
+	return 0;
+}
+
+/*
+ * rpma_conn_cfg_get_numa_node -- get the NUMA node of the connection's
+ * internal buffers and queues
+ */
+int
+rpma_conn_cfg_get_numa_node(const struct rpma_conn_cfg *cfg, int *node)
+{
+	if (cfg == NULL || node == NULL)
+		return RPMA_E_INVAL;
+
+	*node = cfg->numa_node;
+
+	return 0;
+}
+
+/*
+ * rpma_conn_cfg_set_stats -- set the statistics collected by the connection
+ */
+int
+rpma_conn_cfg_set_stats(struct rpma_conn_cfg *cfg, int stats)
+{
+	if (cfg == NULL ||
+	    (stats & ~(RPMA_STATS_COUNTERS | RPMA_STATS_LATENCY)) != 0)
+		return RPMA_E_INVAL;
+
+	cfg->stats = stats;
+
+	return 0;
+}
+
+/*
+ * rpma_conn_cfg_get_stats -- get the statistics collected by the connection
+ */
+int
+rpma_conn_cfg_get_stats(const struct rpma_conn_cfg *cfg, int *stats)
+{
+	if (cfg == NULL || stats == NULL)
+		return RPMA_E_INVAL;
+
+	*stats = cfg->stats;
+
+	return 0;
+}
+
+/*
+ * rpma_conn_cfg_set_timestamps -- set if the completions are timestamped
+ * by the device
+ */
+int
+rpma_conn_cfg_set_timestamps(struct rpma_conn_cfg *cfg, bool timestamps)
+{
+	if (cfg == NULL)
+		return RPMA_E_INVAL;
+
+	cfg->timestamps = timestamps;
+
+	return 0;
+}
+
+/*
+ * rpma_conn_cfg_get_timestamps -- get if the completions are timestamped
+ * by the device
+ */
+int
+rpma_conn_cfg_get_timestamps(const struct rpma_conn_cfg *cfg,
+		bool *timestamps)
+{
+	if (cfg == NULL || timestamps == NULL)
+		return RPMA_E_INVAL;
+
+	*timestamps = cfg->timestamps;
+
+	return 0;
+}
+
+/*
+ * rpma_conn_cfg_set_srq -- set the shared receive queue of the connection
+ */
+int
+rpma_conn_cfg_set_srq(struct rpma_conn_cfg *cfg, struct rpma_srq *srq)
+{
+	if (cfg == NULL)
+		return RPMA_E_INVAL;
+
+	cfg->srq = srq;
+
+	return 0;
+}
+
+/*
+ * rpma_conn_cfg_get_srq -- get the shared receive queue of the connection
+ */
+int
+rpma_conn_cfg_get_srq(const struct rpma_conn_cfg *cfg,
+		struct rpma_srq **srq_ptr)
+{
+	if (cfg == NULL || srq_ptr == NULL)
+		return RPMA_E_INVAL;
+
+	*srq_ptr = cfg->srq;
+
+	return 0;
+}
+
+/*
+ * rpma_conn_cfg_set_inline_size -- set the maximum size of the inline data
+ */
+int
+rpma_conn_cfg_set_inline_size(struct rpma_conn_cfg *cfg, uint32_t inline_size)
+{
+	if (cfg == NULL)
+		return RPMA_E_INVAL;
+
+	cfg->inline_size = inline_size;
+
+	return 0;
+}
+
+/*
+ * rpma_conn_cfg_get_inline_size -- get the maximum size of the inline data
+ */
+int
+rpma_conn_cfg_get_inline_size(const struct rpma_conn_cfg *cfg,
+		uint32_t *inline_size)
+{
+	if (cfg == NULL || inline_size == NULL)
+		return RPMA_E_INVAL;
+
+	*inline_size = cfg->inline_size;
+
+	return 0;
+}
@@ -0,0 +1,957 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * conn_mt.c -- librpma thread-safe connection modes implementation
+ *
+ * In the RPMA_CONN_THREAD_SAFE mode the send work requests are placed in
+ * a lock-free submission ring. A thread which manages to take the poster role
+ * drains the ring and posts all the collected work requests as a single
+ * chain (flat combining). The other threads wait until their work requests
+ * are posted so each of them gets the actual result of ibv_post_send(3).
+ *
+ * In the RPMA_CONN_THREAD_LOCKLESS mode the work requests are posted directly
+ * by the calling threads.
+ *
+ * In both modes operations posted by attached threads and requiring
+ * a completion are tracked so their completions can be routed back to
+ * the posting thread regardless of which thread polls them from the CQ.
+ * The work request ID of a tracked operation points to its tracking slot
+ * instead of the user's op_context.
+ *
+ * Only one thread at a time waits on the completion channel. It waits in
+ * poll(2) for either the channel or an eventfd(2) signalled when a completion
+ * is routed to its route. The other waiting threads sleep until either
+ * the channel waiter wakes up or a completion is routed to them.
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "common.h"
+#include "conn_mt.h"
+#include "log_internal.h"
+#include "mpsc.h"
+#include "mr.h"
+#include "trace.h"
+
+#ifdef TEST_MOCK_ALLOC
+#include "cmocka_alloc.h"
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CPU_RELAX()	__builtin_ia32_pause()
+#else
+#define CPU_RELAX()	do {} while (0)
+#endif
+
+/* the maximum number of routes (index 0 means 'not routed') */
+#define CONN_MT_ROUTES_MAX	64
+#define CONN_MT_ROUTE_NONE	0
+
+/* a tracking slot of an operation whose completion has to be routed */
+struct conn_mt_op {
+	const void *op_context; /* the user's op_context */
+	uint32_t route; /* the route of the posting thread */
+	int used; /* the slot is in use */
+};
+
+/* an entry of the submission ring */
+struct conn_mt_sqe {
+	struct ibv_send_wr wr;
+	struct ibv_sge sge;
+	int ret; /* the result of posting the work request */
+};
+
+struct conn_mt_route {
+	uintptr_t owner; /* the token of the attached thread (0 if free) */
+	struct rpma_mpsc *mailbox; /* completions routed to the thread */
+	uint64_t pending; /* tracked operations not collected yet */
+};
+
+struct rpma_conn_mt {
+	enum rpma_conn_thread_mode mode; /* the threading mode */
+	struct ibv_qp *qp; /* the QP of the connection */
+	struct rpma_cq *cq; /* the CQ of the connection */
+
+	struct rpma_mpsc *sq_ring; /* the submission ring (SAFE mode only) */
+	int poster; /* the poster role is taken */
+
+	struct conn_mt_op *ops; /* the tracking slots */
+	uint64_t ops_mask; /* the number of the tracking slots - 1 */
+	uint64_t ops_next; /* the next tracking slot to try */
+
+	uint32_t routes_num; /* the high-water mark of the used routes */
+	struct conn_mt_route routes[CONN_MT_ROUTES_MAX];
+
+	pthread_mutex_t wait_lock; /* protects the waiting state */
+	pthread_cond_t wait_cond; /* the sleeping threads wait on it */
+	int waiter; /* a thread waits on the completion channel */
+	uint32_t waiter_route; /* the route of the channel waiter */
+	uint64_t wait_gen; /* the number of the finished channel waits */
+	uint32_t sleepers; /* the number of the sleeping threads */
+	int wakefd; /* the eventfd(2) waking the channel waiter up */
+};
+
+/*
+ * The address of a thread-local variable is unique among all the living
+ * threads so it is used as a token identifying the calling thread.
+ */
+static __thread char Conn_mt_thread_token;
+
+/* the route found recently by the calling thread */
+static __thread struct {
+	const struct rpma_conn_mt *mt;
+	uint32_t route;
+} Conn_mt_route_cache;
+
+/*
+ * conn_mt_thread_token -- get the token of the calling thread
+ */
+static inline uintptr_t
+conn_mt_thread_token(void)
+{
+	return (uintptr_t)&Conn_mt_thread_token;
+}
+
+/*
+ * conn_mt_route_of_caller -- find the route the calling thread is attached to
+ */
+static uint32_t
+conn_mt_route_of_caller(struct rpma_conn_mt *mt)
+{
+	uintptr_t token = conn_mt_thread_token();
+
+	/* the cached route is valid only if the thread still owns it */
+	if (Conn_mt_route_cache.mt == mt &&
+			__atomic_load_n(
+				&mt->routes[Conn_mt_route_cache.route].owner,
+				__ATOMIC_RELAXED) == token)
+		return Conn_mt_route_cache.route;
+
+	uint32_t routes_num = __atomic_load_n(&mt->routes_num,
+			__ATOMIC_ACQUIRE);
+	for (uint32_t i = CONN_MT_ROUTE_NONE + 1; i < routes_num; ++i) {
+		if (__atomic_load_n(&mt->routes[i].owner, __ATOMIC_RELAXED) ==
+				token) {
+			Conn_mt_route_cache.mt = mt;
+			Conn_mt_route_cache.route = i;
+			return i;
+		}
+	}
+
+	return CONN_MT_ROUTE_NONE;
+}
+
+/*
+ * conn_mt_op_track -- take a tracking slot for the operation if its completion
+ * has to be routed to the calling thread and provide the work request ID
+ * to be used for the operation
+ */
+static int
+conn_mt_op_track(struct rpma_conn_mt *mt, bool signaled,
+		const void *op_context, const void **wr_id)
+{
+	*wr_id = op_context;
+
+	if (!signaled)
+		return 0;
+
+	uint32_t route = conn_mt_route_of_caller(mt);
+	if (route == CONN_MT_ROUTE_NONE)
+		return 0;
+
+	for (uint64_t i = 0; i <= mt->ops_mask; ++i) {
+		uint64_t idx = __atomic_fetch_add(&mt->ops_next, 1,
+				__ATOMIC_RELAXED) & mt->ops_mask;
+		struct conn_mt_op *op = &mt->ops[idx];
+		int unused = 0;
+
+		if (!__atomic_compare_exchange_n(&op->used, &unused, 1,
+				false /* strong */, __ATOMIC_ACQUIRE,
+				__ATOMIC_RELAXED))
+			continue;
+
+		op->op_context = op_context;
+		__atomic_store_n(&op->route, route, __ATOMIC_RELEASE);
+		__atomic_fetch_add(&mt->routes[route].pending, 1,
+				__ATOMIC_RELAXED);
+
+		*wr_id = op;
+		return 0;
+	}
+
+	RPMA_LOG_ERROR("no free slot to track the operation");
+	return RPMA_E_AGAIN;
+}
+
+/*
+ * conn_mt_op_of -- get the tracking slot the work request ID points to
+ * or NULL if the operation is not tracked
+ */
+static inline struct conn_mt_op *
+conn_mt_op_of(struct rpma_conn_mt *mt, const void *wr_id)
+{
+	uintptr_t first = (uintptr_t)&mt->ops[0];
+	uintptr_t last = (uintptr_t)&mt->ops[mt->ops_mask];
+
+	if ((uintptr_t)wr_id < first || (uintptr_t)wr_id > last)
+		return NULL;
+
+	return (struct conn_mt_op *)wr_id;
+}
+
+/*
+ * conn_mt_op_untrack -- release the tracking slot of the operation
+ * (if tracked) and return the route the operation belongs to
+ */
+static uint32_t
+conn_mt_op_untrack(struct rpma_conn_mt *mt, const void *wr_id,
+		const void **op_context)
+{
+	struct conn_mt_op *op = conn_mt_op_of(mt, wr_id);
+	if (op == NULL) {
+		if (op_context)
+			*op_context = wr_id;
+		return CONN_MT_ROUTE_NONE;
+	}
+
+	uint32_t route = __atomic_load_n(&op->route, __ATOMIC_ACQUIRE);
+	if (op_context)
+		*op_context = op->op_context;
+
+	__atomic_store_n(&op->used, 0, __ATOMIC_RELEASE);
+
+	return route;
+}
+
+/*
+ * conn_mt_op_cancel -- release the tracking slot of an operation which
+ * has not been posted
+ */
+static void
+conn_mt_op_cancel(struct rpma_conn_mt *mt, const void *wr_id)
+{
+	uint32_t route = conn_mt_op_untrack(mt, wr_id, NULL);
+	if (route != CONN_MT_ROUTE_NONE)
+		__atomic_fetch_sub(&mt->routes[route].pending, 1,
+				__ATOMIC_RELAXED);
+}
+
+/*
+ * conn_mt_poster_trylock -- try to take the poster role
+ */
+static inline bool
+conn_mt_poster_trylock(struct rpma_conn_mt *mt)
+{
+	if (__atomic_load_n(&mt->poster, __ATOMIC_RELAXED))
+		return false;
+
+	return __atomic_exchange_n(&mt->poster, 1, __ATOMIC_ACQUIRE) == 0;
+}
+
+/*
+ * conn_mt_poster_unlock -- give the poster role up
+ */
+static inline void
+conn_mt_poster_unlock(struct rpma_conn_mt *mt)
+{
+	__atomic_store_n(&mt->poster, 0, __ATOMIC_RELEASE);
+}
+
+/*
+ * conn_mt_drain -- post all the work requests published in the submission
+ * ring as a single chain and hand the results back to their producers
+ *
+ * ASSUMPTIONS
+ * - the poster role is taken by the calling thread
+ */
+static void
+conn_mt_drain(struct rpma_conn_mt *mt)
+{
+	struct conn_mt_sqe *first = NULL;
+	struct conn_mt_sqe *prev = NULL;
+	struct conn_mt_sqe *sqe;
+	uint64_t first_pos = 0;
+	uint64_t pos;
+	uint64_t num = 0;
+
+	while ((sqe = rpma_mpsc_consume(mt->sq_ring, &pos)) != NULL) {
+		if (first == NULL) {
+			first = sqe;
+			first_pos = pos;
+		} else {
+			prev->wr.next = &sqe->wr;
+		}
+
+		sqe->wr.next = NULL;
+		prev = sqe;
+		++num;
+	}
+
+	if (num == 0)
+		return;
+
+	struct ibv_send_wr *bad_wr = NULL;
+	RPMA_TRACE(post_chain, mt->qp, first->wr.wr_id, num);
+	int ret = ibv_post_send(mt->qp, &first->wr, &bad_wr);
+	if (ret) {
+		RPMA_LOG_ERROR_WITH_ERRNO(ret,
+			"ibv_post_send(batch of %" PRIu64 " work requests)",
+			num);
+	}
+
+	/*
+	 * The work requests preceding bad_wr have been posted. The remaining
+	 * ones are reported as failed. If the provider did not point
+	 * the failed work request all of them are reported as failed.
+	 */
+	int status = (ret && bad_wr == NULL) ? RPMA_E_PROVIDER : 0;
+	for (uint64_t i = 0; i < num; ++i) {
+		sqe = rpma_mpsc_entry(mt->sq_ring, first_pos + i);
+		if (ret && &sqe->wr == bad_wr)
+			status = RPMA_E_PROVIDER;
+		sqe->ret = status;
+		rpma_mpsc_complete(mt->sq_ring, first_pos + i);
+	}
+}
+
+/*
+ * conn_mt_poster_lock -- take the poster role (spinning) and post everything
+ * which is waiting in the submission ring so the operation posted
+ * in the exclusive section keeps its order
+ */
+static void
+conn_mt_poster_lock(struct rpma_conn_mt *mt)
+{
+	while (!conn_mt_poster_trylock(mt))
+		CPU_RELAX();
+
+	conn_mt_drain(mt);
+}
+
+/*
+ * conn_mt_submit -- place the work request in the submission ring and wait
+ * until it is posted either by the calling thread or by the current poster
+ */
+static int
+conn_mt_submit(struct rpma_conn_mt *mt, const struct ibv_send_wr *wr,
+		const struct ibv_sge *sge)
+{
+	struct conn_mt_sqe *sqe;
+	uint64_t pos;
+
+	while ((sqe = rpma_mpsc_reserve(mt->sq_ring, &pos)) == NULL) {
+		/* the ring is full - help the poster to drain it */
+		if (conn_mt_poster_trylock(mt)) {
+			conn_mt_drain(mt);
+			conn_mt_poster_unlock(mt);
+		} else {
+			CPU_RELAX();
+		}
+	}
+
+	sqe->wr = *wr;
+	if (wr->num_sge) {
+		sqe->sge = *sge;
+		sqe->wr.sg_list = &sqe->sge;
+	}
+
+	rpma_mpsc_publish(mt->sq_ring, pos);
+
+	while (!rpma_mpsc_is_completed(mt->sq_ring, pos)) {
+		if (conn_mt_poster_trylock(mt)) {
+			conn_mt_drain(mt);
+			conn_mt_poster_unlock(mt);
+		} else {
+			CPU_RELAX();
+		}
+	}
+
+	int ret = sqe->ret;
+	rpma_mpsc_release(mt->sq_ring, pos);
+
+	return ret;
+}
+
+/*
+ * conn_mt_mailbox_push -- hand the completion over to the thread of the route
+ */
+static int
+conn_mt_mailbox_push(struct rpma_conn_mt *mt, uint32_t route,
+		const struct rpma_completion *cmpl)
+{
+	struct rpma_mpsc *mailbox = mt->routes[route].mailbox;
+	uint64_t pos;
+
+	struct rpma_completion *entry = rpma_mpsc_reserve(mailbox, &pos);
+	if (entry == NULL) {
+		RPMA_LOG_ERROR("the completion cannot be routed (route %u)",
+				route);
+		return RPMA_E_NOMEM;
+	}
+
+	*entry = *cmpl;
+	rpma_mpsc_publish(mailbox, pos);
+
+	/* pairs with the fences in rpma_conn_mt_completion_wait() */
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+	/* the completion is already handed over so a failure is only logged */
+	if (__atomic_load_n(&mt->waiter_route, __ATOMIC_RELAXED) == route &&
+			eventfd_write(mt->wakefd, 1))
+		RPMA_LOG_ERROR_WITH_ERRNO(errno, "eventfd_write()");
+
+	if (__atomic_load_n(&mt->sleepers, __ATOMIC_RELAXED)) {
+		pthread_mutex_lock(&mt->wait_lock);
+		pthread_cond_broadcast(&mt->wait_cond);
+		pthread_mutex_unlock(&mt->wait_lock);
+	}
+
+	return 0;
+}
+
+/*
+ * conn_mt_mailbox_pop -- collect a completion routed to the calling thread
+ */
+static int
+conn_mt_mailbox_pop(struct rpma_conn_mt *mt, uint32_t route,
+		struct rpma_completion *cmpl)
+{
+	struct rpma_mpsc *mailbox = mt->routes[route].mailbox;
+	uint64_t pos;
+
+	struct rpma_completion *entry = rpma_mpsc_consume(mailbox, &pos);
+	if (entry == NULL)
+		return RPMA_E_NO_COMPLETION;
+
+	*cmpl = *entry;
+	rpma_mpsc_release(mailbox, pos);
+
+	return 0;
+}
+
+/* internal librpma API */
+
+/*
+ * rpma_conn_mt_new -- create the thread-safe posting and completion routing
+ * machinery of the connection
+ */
+int
+rpma_conn_mt_new(struct ibv_qp *qp, struct rpma_cq *cq,
+		enum rpma_conn_thread_mode mode, uint32_t sq_size,
+		uint32_t rq_size, struct rpma_conn_mt **mt_ptr)
+{
+	if (mt_ptr == NULL || (mode != RPMA_CONN_THREAD_SAFE &&
+			mode != RPMA_CONN_THREAD_LOCKLESS))
+		return RPMA_E_INVAL;
+
+	struct rpma_conn_mt *mt = malloc(sizeof(*mt));
+	if (mt == NULL)
+		return RPMA_E_NOMEM;
+
+	memset(mt, 0, sizeof(*mt));
+
+	int ret;
+
+	if (mode == RPMA_CONN_THREAD_SAFE) {
+		ret = rpma_mpsc_new(sq_size ? sq_size : 1,
+				sizeof(struct conn_mt_sqe), &mt->sq_ring);
+		if (ret)
+			goto err_free_mt;
+	}
+
+	/*
+	 * There cannot be more outstanding tracked operations than SQ and RQ
+	 * entries. The margin makes finding a free slot a one-shot in
+	 * the common case.
+	 */
+	uint64_t ops_num = 4;
+	while (ops_num < 2 * ((uint64_t)sq_size + rq_size))
+		ops_num <<= 1;
+
+	mt->ops = malloc(ops_num * sizeof(struct conn_mt_op));
+	if (mt->ops == NULL) {
+		ret = RPMA_E_NOMEM;
+		goto err_mpsc_delete;
+	}
+
+	memset(mt->ops, 0, ops_num * sizeof(struct conn_mt_op));
+
+	mt->wakefd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (mt->wakefd < 0) {
+		RPMA_LOG_ERROR_WITH_ERRNO(errno, "eventfd()");
+		ret = RPMA_E_PROVIDER;
+		goto err_free_ops;
+	}
+
+	(void) pthread_mutex_init(&mt->wait_lock, NULL);
+	(void) pthread_cond_init(&mt->wait_cond, NULL);
+
+	mt->mode = mode;
+	mt->qp = qp;
+	mt->cq = cq;
+	mt->ops_mask = ops_num - 1;
+	mt->routes_num = CONN_MT_ROUTE_NONE + 1;
+
+	*mt_ptr = mt;
+
+	return 0;
+
+err_free_ops:
+	free(mt->ops);
+
+err_mpsc_delete:
+	(void) rpma_mpsc_delete(&mt->sq_ring);
+
+err_free_mt:
+	free(mt);
+
+	return ret;
+}
+
+/*
+ * rpma_conn_mt_delete -- delete the thread-safe posting and completion routing
+ * machinery of the connection
+ */
+int
+rpma_conn_mt_delete(struct rpma_conn_mt **mt_ptr)
+{
+	if (mt_ptr == NULL)
+		return RPMA_E_INVAL;
+
+	struct rpma_conn_mt *mt = *mt_ptr;
+	if (mt == NULL)
+		return 0;
+
+	int ret = 0;
+	if (close(mt->wakefd)) {
+		RPMA_LOG_ERROR_WITH_ERRNO(errno, "close()");
+		ret = RPMA_E_PROVIDER;
+	}
+
+	(void) pthread_cond_destroy(&mt->wait_cond);
+	(void) pthread_mutex_destroy(&mt->wait_lock);
+
+	for (uint32_t i = 0; i < CONN_MT_ROUTES_MAX; ++i)
+		(void) rpma_mpsc_delete(&mt->routes[i].mailbox);
+
+	free(mt->ops);
+	(void) rpma_mpsc_delete(&mt->sq_ring);
+	free(mt);
+	*mt_ptr = NULL;
+
+	return ret;
+}
+
+/*
+ * rpma_conn_mt_read -- post the read operation in the thread-safe way
+ */
+int
+rpma_conn_mt_read(struct rpma_conn_mt *mt,
+	struct rpma_mr_local *dst, size_t dst_offset,
+	const struct rpma_mr_remote *src,  size_t src_offset,
+	size_t len, int flags, const void *op_context)
+{
+	const void *wr_id;
+	int ret = conn_mt_op_track(mt, flags & RPMA_F_COMPLETION_ON_SUCCESS,
+			op_context, &wr_id);
+	if (ret)
+		return ret;
+
+	if (mt->mode == RPMA_CONN_THREAD_LOCKLESS) {
+		ret = rpma_mr_read(mt->qp, dst, dst_offset, src, src_offset,
+				len, flags, wr_id);
+	} else {
+		struct ibv_send_wr wr;
+		struct ibv_sge sge;
+
+		rpma_mr_read_wr(&wr, &sge, dst, dst_offset, src, src_offset,
+				len, flags, wr_id);
+		ret = conn_mt_submit(mt, &wr, &sge);
+	}
+
+	if (ret)
+		conn_mt_op_cancel(mt, wr_id);
+
+	return ret;
+}
+
+/*
+ * rpma_conn_mt_write -- post the write operation in the thread-safe way
+ */
+int
+rpma_conn_mt_write(struct rpma_conn_mt *mt,
+	struct rpma_mr_remote *dst, size_t dst_offset,
+	const struct rpma_mr_local *src,  size_t src_offset,
+	size_t len, int flags, enum ibv_wr_opcode operation,
+	uint32_t imm, const void *op_context, bool fence)
+{
+	const void *wr_id;
+	int ret = conn_mt_op_track(mt, flags & RPMA_F_COMPLETION_ON_SUCCESS,
+			op_context, &wr_id);
+	if (ret)
+		return ret;
+
+	if (mt->mode == RPMA_CONN_THREAD_LOCKLESS) {
+		ret = rpma_mr_write(mt->qp, dst, dst_offset, src, src_offset,
+				len, flags, operation, imm, wr_id, fence);
+	} else {
+		struct ibv_send_wr wr;
+		struct ibv_sge sge;
+
+		ret = rpma_mr_write_wr(&wr, &sge, dst, dst_offset,
+				src, src_offset, len, flags, operation, imm,
+				wr_id, fence);
+		if (!ret)
+			ret = conn_mt_submit(mt, &wr, &sge);
+	}
+
+	if (ret)
+		conn_mt_op_cancel(mt, wr_id);
+
+	return ret;
+}
+
+/*
+ * rpma_conn_mt_atomic -- post the atomic operation in the thread-safe way
+ */
+int
+rpma_conn_mt_atomic(struct rpma_conn_mt *mt,
+	struct rpma_mr_local *dst, size_t dst_offset,
+	const struct rpma_mr_remote *src, size_t src_offset,
+	enum ibv_wr_opcode operation, uint64_t compare_add, uint64_t swap,
+	int flags, const void *op_context)
+{
+	const void *wr_id;
+	int ret = conn_mt_op_track(mt, flags & RPMA_F_COMPLETION_ON_SUCCESS,
+			op_context, &wr_id);
+	if (ret)
+		return ret;
+
+	if (mt->mode == RPMA_CONN_THREAD_LOCKLESS) {
+		ret = rpma_mr_atomic(mt->qp, dst, dst_offset, src, src_offset,
+				operation, compare_add, swap, flags, wr_id);
+	} else {
+		struct ibv_send_wr wr;
+		struct ibv_sge sge;
+
+		ret = rpma_mr_atomic_wr(&wr, &sge, dst, dst_offset,
+				src, src_offset, operation, compare_add, swap,
+				flags, wr_id);
+		if (!ret)
+			ret = conn_mt_submit(mt, &wr, &sge);
+	}
+
+	if (ret)
+		conn_mt_op_cancel(mt, wr_id);
+
+	return ret;
+}
+
+/*
+ * rpma_conn_mt_send -- post the send operation in the thread-safe way
+ */
+int
+rpma_conn_mt_send(struct rpma_conn_mt *mt,
+	const struct rpma_mr_local *src,  size_t offset,
+	size_t len, int flags, enum ibv_wr_opcode operation,
+	uint32_t imm, const void *op_context)
+{
+	const void *wr_id;
+	int ret = conn_mt_op_track(mt, flags & RPMA_F_COMPLETION_ON_SUCCESS,
+			op_context, &wr_id);
+	if (ret)
+		return ret;
+
+	if (mt->mode == RPMA_CONN_THREAD_LOCKLESS) {
+		ret = rpma_mr_send(mt->qp, src, offset, len, flags,
+				operation, imm, wr_id);
+	} else {
+		struct ibv_send_wr wr;
+		struct ibv_sge sge;
+
+		ret = rpma_mr_send_wr(&wr, &sge, src, offset, len, flags,
+				operation, imm, wr_id);
+		if (!ret)
+			ret = conn_mt_submit(mt, &wr, &sge);
+	}
+
+	if (ret)
+		conn_mt_op_cancel(mt, wr_id);
+
+	return ret;
+}
+
+/*
+ * rpma_conn_mt_recv -- post the receive operation in the thread-safe way
+ */
+int
+rpma_conn_mt_recv(struct rpma_conn_mt *mt,
+	struct rpma_mr_local *dst,  size_t offset,
+	size_t len, const void *op_context)
+{
+	const void *wr_id;
+	/* a receive operation always generates a completion */
+	int ret = conn_mt_op_track(mt, true, op_context, &wr_id);
+	if (ret)
+		return ret;
+
+	if (mt->mode == RPMA_CONN_THREAD_LOCKLESS) {
+		ret = rpma_mr_recv(mt->qp, dst, offset, len, wr_id);
+	} else {
+		conn_mt_poster_lock(mt);
+		ret = rpma_mr_recv(mt->qp, dst, offset, len, wr_id);
+		conn_mt_poster_unlock(mt);
+	}
+
+	if (ret)
+		conn_mt_op_cancel(mt, wr_id);
+
+	return ret;
+}
+
+/*
+ * rpma_conn_mt_flush -- post the flush operation in the thread-safe way
+ */
+int
+rpma_conn_mt_flush(struct rpma_conn_mt *mt, struct rpma_flush *flush,
+	struct rpma_mr_remote *dst, size_t dst_offset, size_t len,
+	enum rpma_flush_type type, int flags, const void *op_context)
+{
+	const void *wr_id;
+	int ret = conn_mt_op_track(mt, flags & RPMA_F_COMPLETION_ON_SUCCESS,
+			op_context, &wr_id);
+	if (ret)
+		return ret;
+
+	rpma_flush_func flush_func = flush->func;
+
+	if (mt->mode == RPMA_CONN_THREAD_LOCKLESS) {
+		ret = flush_func(mt->qp, flush, dst, dst_offset, len, type,
+				flags, wr_id);
+	} else {
+		conn_mt_poster_lock(mt);
+		ret = flush_func(mt->qp, flush, dst, dst_offset, len, type,
+				flags, wr_id);
+		conn_mt_poster_unlock(mt);
+	}
+
+	if (ret)
+		conn_mt_op_cancel(mt, wr_id);
+
+	return ret;
+}
+
+/*
+ * conn_mt_wait_channel -- wait on the completion channel for either
+ * a completion event or a completion routed to the calling thread
+ *
+ * ASSUMPTIONS
+ * - the calling thread is the channel waiter
+ */
+static int
+conn_mt_wait_channel(struct rpma_conn_mt *mt, struct rpma_mpsc *mailbox)
+{
+	/* pairs with the fence in conn_mt_mailbox_push() */
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+	if (mailbox != NULL && !rpma_mpsc_is_empty(mailbox))
+		return 0;
+
+	int cfd;
+	(void) rpma_cq_get_fd(mt->cq, &cfd);
+
+	struct pollfd fds[2] = {
+		{.fd = cfd, .events = POLLIN},
+		{.fd = mt->wakefd, .events = POLLIN},
+	};
+
+	if (poll(fds, 2, -1 /* infinitely */) < 0) {
+		if (errno == EINTR)
+			return 0;
+
+		RPMA_LOG_ERROR_WITH_ERRNO(errno, "poll()");
+		return RPMA_E_PROVIDER;
+	}
+
+	if (fds[1].revents) {
+		eventfd_t unused;
+		(void) eventfd_read(mt->wakefd, &unused);
+	}
+
+	/* woken up by a routed completion */
+	if (fds[0].revents == 0)
+		return 0;
+
+	return rpma_cq_wait(mt->cq);
+}
+
+/*
+ * rpma_conn_mt_completion_wait -- wait for a completion unless there is
+ * a completion already routed to the calling thread
+ */
+int
+rpma_conn_mt_completion_wait(struct rpma_conn_mt *mt)
+{
+	uint32_t route = conn_mt_route_of_caller(mt);
+	struct rpma_mpsc *mailbox = (route == CONN_MT_ROUTE_NONE) ?
+			NULL : mt->routes[route].mailbox;
+
+	if (mailbox != NULL && !rpma_mpsc_is_empty(mailbox))
+		return 0;
+
+	pthread_mutex_lock(&mt->wait_lock);
+
+	if (!mt->waiter) {
+		mt->waiter = 1;
+		__atomic_store_n(&mt->waiter_route, route, __ATOMIC_RELAXED);
+		pthread_mutex_unlock(&mt->wait_lock);
+
+		int ret = conn_mt_wait_channel(mt, mailbox);
+
+		pthread_mutex_lock(&mt->wait_lock);
+		__atomic_store_n(&mt->waiter_route, CONN_MT_ROUTE_NONE,
+				__ATOMIC_RELAXED);
+		mt->waiter = 0;
+		++mt->wait_gen;
+		/* the sleeping threads go polling the CQ on their own */
+		pthread_cond_broadcast(&mt->wait_cond);
+		pthread_mutex_unlock(&mt->wait_lock);
+
+		return ret;
+	}
+
+	/* sleep until the channel waiter wakes up or a completion is routed */
+	uint64_t wait_gen = mt->wait_gen;
+	__atomic_fetch_add(&mt->sleepers, 1, __ATOMIC_RELAXED);
+	/* pairs with the fence in conn_mt_mailbox_push() */
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+	while (mt->wait_gen == wait_gen &&
+			(mailbox == NULL || rpma_mpsc_is_empty(mailbox)))
+		pthread_cond_wait(&mt->wait_cond, &mt->wait_lock);
+
+	__atomic_fetch_sub(&mt->sleepers, 1, __ATOMIC_RELAXED);
+	pthread_mutex_unlock(&mt->wait_lock);
+
+	return 0;
+}
+
+/*
+ * rpma_conn_mt_completion_get -- get the next completion which belongs to
+ * the calling thread. Completions of the other attached threads polled
+ * on the way are handed over to them.
+ */
+int
+rpma_conn_mt_completion_get(struct rpma_conn_mt *mt,
+		struct rpma_completion *cmpl)
+{
+	uint32_t route = conn_mt_route_of_caller(mt);
+	int ret;
+
+	if (route != CONN_MT_ROUTE_NONE) {
+		ret = conn_mt_mailbox_pop(mt, route, cmpl);
+		if (ret == 0) {
+			__atomic_fetch_sub(&mt->routes[route].pending, 1,
+					__ATOMIC_RELAXED);
+			return 0;
+		}
+	}
+
+	while (1) {
+		ret = rpma_cq_get_completion(mt->cq, cmpl);
+		if (ret)
+			return ret;
+
+		const void *op_context;
+		uint32_t owner = conn_mt_op_untrack(mt, cmpl->op_context,
+				&op_context);
+		cmpl->op_context = (void *)op_context;
+
+		if (owner == CONN_MT_ROUTE_NONE)
+			return 0;
+
+		if (owner == route) {
+			__atomic_fetch_sub(&mt->routes[route].pending, 1,
+					__ATOMIC_RELAXED);
+			return 0;
+		}
+
+		ret = conn_mt_mailbox_push(mt, owner, cmpl);
+		if (ret)
+			return ret;
+	}
+}
+
+/*
+ * rpma_conn_mt_thread_attach -- take a free route for the calling thread
+ */
+int
+rpma_conn_mt_thread_attach(struct rpma_conn_mt *mt)
+{
+	if (conn_mt_route_of_caller(mt) != CONN_MT_ROUTE_NONE)
+		return 0;
+
+	uintptr_t token = conn_mt_thread_token();
+
+	for (uint32_t i = CONN_MT_ROUTE_NONE + 1; i < CONN_MT_ROUTES_MAX; ++i) {
+		struct conn_mt_route *route = &mt->routes[i];
+		uintptr_t free_owner = 0;
+
+		if (!__atomic_compare_exchange_n(&route->owner, &free_owner,
+				token, false /* strong */, __ATOMIC_ACQ_REL,
+				__ATOMIC_RELAXED))
+			continue;
+
+		/* a mailbox is kept for the next owner after detaching */
+		if (route->mailbox == NULL) {
+			int ret = rpma_mpsc_new((uint32_t)(mt->ops_mask + 1),
+					sizeof(struct rpma_completion),
+					&route->mailbox);
+			if (ret) {
+				__atomic_store_n(&route->owner, 0,
+						__ATOMIC_RELEASE);
+				return ret;
+			}
+		}
+
+		/* make the route visible to the threads looking it up */
+		uint32_t routes_num = __atomic_load_n(&mt->routes_num,
+				__ATOMIC_RELAXED);
+		while (routes_num < i + 1 &&
+				!__atomic_compare_exchange_n(&mt->routes_num,
+					&routes_num, i + 1, true /* weak */,
+					__ATOMIC_RELEASE, __ATOMIC_RELAXED))
+			;
+
+		return 0;
+	}
+
+	RPMA_LOG_ERROR("too many threads attached to the connection (max %d)",
+			CONN_MT_ROUTES_MAX - 1);
+	return RPMA_E_NOMEM;
+}
+
+/*
+ * rpma_conn_mt_thread_detach -- give the route of the calling thread up
+ */
+int
+rpma_conn_mt_thread_detach(struct rpma_conn_mt *mt)
+{
+	uint32_t route = conn_mt_route_of_caller(mt);
+	if (route == CONN_MT_ROUTE_NONE)
+		return RPMA_E_INVAL;
+
+	if (__atomic_load_n(&mt->routes[route].pending, __ATOMIC_ACQUIRE))
+		return RPMA_E_AGAIN;
+
+	__atomic_store_n(&mt->routes[route].owner, 0, __ATOMIC_RELEASE);
+
+	return 0;
+}
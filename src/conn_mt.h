@@ -0,0 +1,203 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * conn_mt.h -- librpma thread-safe connection modes internal definitions
+ */
+
+#ifndef LIBRPMA_CONN_MT_H
+#define LIBRPMA_CONN_MT_H
+
+#include "librpma.h"
+#include "cq.h"
+#include "flush.h"
+
+#include <infiniband/verbs.h>
+
+struct rpma_conn_mt;
+
+/*
+ * ASSUMPTIONS
+ * - qp != NULL && cq != NULL
+ *
+ * ERRORS
+ * rpma_conn_mt_new() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - mt_ptr is NULL or mode is not one of
+ *                  RPMA_CONN_THREAD_SAFE or RPMA_CONN_THREAD_LOCKLESS
+ * - RPMA_E_NOMEM - out of memory
+ * - RPMA_E_PROVIDER - eventfd(2) failed
+ */
+int rpma_conn_mt_new(struct ibv_qp *qp, struct rpma_cq *cq,
+		enum rpma_conn_thread_mode mode, uint32_t sq_size,
+		uint32_t rq_size, struct rpma_conn_mt **mt_ptr);
+
+/*
+ * ERRORS
+ * rpma_conn_mt_delete() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - mt_ptr is NULL
+ * - RPMA_E_PROVIDER - close(2) failed
+ */
+int rpma_conn_mt_delete(struct rpma_conn_mt **mt_ptr);
+
+/*
+ * ASSUMPTIONS
+ * - mt != NULL && flags != 0
+ * - (src != NULL && dst != NULL) ||
+ *   (src == NULL && dst == NULL &&
+ *    dst_offset == 0 && src_offset == 0 && len == 0)
+ *
+ * ERRORS
+ * rpma_conn_mt_read() can fail with the following errors:
+ *
+ * - RPMA_E_AGAIN - no free slot to track the operation
+ * - RPMA_E_PROVIDER - ibv_post_send(3) failed
+ */
+int rpma_conn_mt_read(struct rpma_conn_mt *mt,
+	struct rpma_mr_local *dst, size_t dst_offset,
+	const struct rpma_mr_remote *src,  size_t src_offset,
+	size_t len, int flags, const void *op_context);
+
+/*
+ * ASSUMPTIONS
+ * - mt != NULL && flags != 0
+ * - (src != NULL && dst != NULL) ||
+ *   (src == NULL && dst == NULL &&
+ *    dst_offset == 0 && src_offset == 0 && len == 0)
+ *
+ * ERRORS
+ * rpma_conn_mt_write() can fail with the following errors:
+ *
+ * - RPMA_E_NOSUPP - unsupported 'operation' argument
+ * - RPMA_E_AGAIN - no free slot to track the operation
+ * - RPMA_E_PROVIDER - ibv_post_send(3) failed
+ */
+int rpma_conn_mt_write(struct rpma_conn_mt *mt,
+	struct rpma_mr_remote *dst, size_t dst_offset,
+	const struct rpma_mr_local *src,  size_t src_offset,
+	size_t len, int flags, enum ibv_wr_opcode operation,
+	uint32_t imm, const void *op_context, bool fence);
+
+/*
+ * ASSUMPTIONS
+ * - mt != NULL && flags != 0
+ * - dst != NULL && src != NULL
+ *
+ * ERRORS
+ * rpma_conn_mt_atomic() can fail with the following errors:
+ *
+ * - RPMA_E_NOSUPP - unsupported 'operation' argument
+ * - RPMA_E_AGAIN - no free slot to track the operation
+ * - RPMA_E_PROVIDER - ibv_post_send(3) failed
+ */
+int rpma_conn_mt_atomic(struct rpma_conn_mt *mt,
+	struct rpma_mr_local *dst, size_t dst_offset,
+	const struct rpma_mr_remote *src, size_t src_offset,
+	enum ibv_wr_opcode operation, uint64_t compare_add, uint64_t swap,
+	int flags, const void *op_context);
+
+/*
+ * ASSUMPTIONS
+ * - mt != NULL && flags != 0
+ * - src != NULL || (offset == 0 && len == 0)
+ *
+ * ERRORS
+ * rpma_conn_mt_send() can fail with the following errors:
+ *
+ * - RPMA_E_NOSUPP - unsupported 'operation' argument
+ * - RPMA_E_AGAIN - no free slot to track the operation
+ * - RPMA_E_PROVIDER - ibv_post_send(3) failed
+ */
+int rpma_conn_mt_send(struct rpma_conn_mt *mt,
+	const struct rpma_mr_local *src,  size_t offset,
+	size_t len, int flags, enum ibv_wr_opcode operation,
+	uint32_t imm, const void *op_context);
+
+/*
+ * ASSUMPTIONS
+ * - mt != NULL
+ * - dst != NULL || (offset == 0 && len == 0)
+ *
+ * ERRORS
+ * rpma_conn_mt_recv() can fail with the following errors:
+ *
+ * - RPMA_E_AGAIN - no free slot to track the operation
+ * - RPMA_E_PROVIDER - ibv_post_recv(3) failed
+ */
+int rpma_conn_mt_recv(struct rpma_conn_mt *mt,
+	struct rpma_mr_local *dst,  size_t offset,
+	size_t len, const void *op_context);
+
+/*
+ * ASSUMPTIONS
+ * - mt != NULL && flush != NULL && dst != NULL && flags != 0
+ *
+ * ERRORS
+ * rpma_conn_mt_flush() can fail with the following errors:
+ *
+ * - RPMA_E_AGAIN - no free slot to track the operation
+ * - any error returned by the flush function
+ */
+int rpma_conn_mt_flush(struct rpma_conn_mt *mt, struct rpma_flush *flush,
+	struct rpma_mr_remote *dst, size_t dst_offset, size_t len,
+	enum rpma_flush_type type, int flags, const void *op_context);
+
+/*
+ * ASSUMPTIONS
+ * - mt != NULL
+ *
+ * ERRORS
+ * rpma_conn_mt_completion_wait() can fail with the following errors:
+ *
+ * - RPMA_E_PROVIDER - poll(2) failed or ibv_req_notify_cq(3) failed with
+ *                     a provider error
+ * - RPMA_E_NO_COMPLETION - no completions available
+ *
+ * NOTE
+ * Only one thread at a time waits on the completion channel. The other
+ * threads return when the channel waiter wakes up or when a completion is
+ * routed to them so they may return when there is no completion for them.
+ */
+int rpma_conn_mt_completion_wait(struct rpma_conn_mt *mt);
+
+/*
+ * ASSUMPTIONS
+ * - mt != NULL && cmpl != NULL
+ *
+ * ERRORS
+ * rpma_conn_mt_completion_get() can fail with the following errors:
+ *
+ * - RPMA_E_NO_COMPLETION - no completions available
+ * - RPMA_E_PROVIDER - ibv_poll_cq(3) failed with a provider error
+ * - RPMA_E_UNKNOWN - ibv_poll_cq(3) failed but no provider error is available
+ * - RPMA_E_NOSUPP - not supported opcode
+ * - RPMA_E_NOMEM - the completion cannot be routed to its thread
+ */
+int rpma_conn_mt_completion_get(struct rpma_conn_mt *mt,
+		struct rpma_completion *cmpl);
+
+/*
+ * ASSUMPTIONS
+ * - mt != NULL
+ *
+ * ERRORS
+ * rpma_conn_mt_thread_attach() can fail with the following error:
+ *
+ * - RPMA_E_NOMEM - out of memory or too many attached threads
+ */
+int rpma_conn_mt_thread_attach(struct rpma_conn_mt *mt);
+
+/*
+ * ASSUMPTIONS
+ * - mt != NULL
+ *
+ * ERRORS
+ * rpma_conn_mt_thread_detach() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - the calling thread is not attached
+ * - RPMA_E_AGAIN - completions routed to the thread are not collected yet
+ */
+int rpma_conn_mt_thread_detach(struct rpma_conn_mt *mt);
+
+#endif /* LIBRPMA_CONN_MT_H */
@@ -12,12 +12,16 @@
 #include "common.h"
 #include "conn.h"
 #include "conn_cfg.h"
+#include "conn_mt.h"
 #include "conn_req.h"
 #include "info.h"
 #include "log_internal.h"
+#include "numa.h"
 #include "mr.h"
 #include "peer.h"
 #include "private_data.h"
+#include "stats.h"
+#include "trace.h"
 
 #ifdef TEST_MOCK_ALLOC
 #include "cmocka_alloc.h"
@@ -30,6 +34,12 @@ struct rpma_conn_req {
 	struct rdma_cm_id *id;
 	/* rpma_cq object */
 	struct rpma_cq *cq;
+	/* thread-safe posting object (if requested by the configuration) */
+	struct rpma_conn_mt *mt;
+	/* performance statistics (if requested by the configuration) */
+	struct rpma_conn_stats *stats;
+	/* NUMA node of the connection's internal buffers and queues */
+	int numa_node;
 
 	/* private data of the CM ID (incoming only) */
 	struct rpma_conn_private_data data;
@@ -51,41 +61,102 @@ rpma_conn_req_from_id(struct rpma_peer *peer, struct rdma_cm_id *id,
 {
 	int ret = 0;
 
-	/* read CQ size from the configuration */
+	/* read CQ size, placement and timestamping from the configuration */
 	int cqe;
+	int comp_vector;
+	int numa_node;
+	bool timestamps;
 	(void) rpma_conn_cfg_get_cqe(cfg, &cqe);
+	(void) rpma_conn_cfg_get_comp_vector(cfg, &comp_vector);
+	(void) rpma_conn_cfg_get_numa_node(cfg, &numa_node);
+	(void) rpma_conn_cfg_get_timestamps(cfg, &timestamps);
+
+	if (comp_vector == RPMA_COMP_VECTOR_AUTO)
+		comp_vector = rpma_numa_comp_vector_auto(id->verbs);
+
+	/* place the queues and the buffers on the requested NUMA node */
+	struct rpma_numa_policy policy;
+	rpma_numa_policy_set(numa_node, &policy);
 
 	struct rpma_cq *cq = NULL;
-	ret = rpma_cq_new(id->verbs, cqe, &cq);
+	ret = rpma_cq_new(id->verbs, cqe, comp_vector, timestamps, &cq);
 	if (ret)
-		return ret;
+		goto err_numa_policy_restore;
 
 	/* create a QP */
 	ret = rpma_peer_create_qp(peer, id, cq, cfg);
 	if (ret)
 		goto err_rpma_cq_delete;
 
+	/* prepare thread-safe posting if requested */
+	struct rpma_conn_mt *mt = NULL;
+	enum rpma_conn_thread_mode thread_mode;
+	(void) rpma_conn_cfg_get_thread_mode(cfg, &thread_mode);
+	if (thread_mode != RPMA_CONN_THREAD_SINGLE) {
+		uint32_t sq_size, rq_size;
+		(void) rpma_conn_cfg_get_sq_size(cfg, &sq_size);
+		(void) rpma_conn_cfg_get_rq_size(cfg, &rq_size);
+		ret = rpma_conn_mt_new(id->qp, cq, thread_mode,
+				sq_size, rq_size, &mt);
+		if (ret)
+			goto err_destroy_qp;
+	}
+
+	/* prepare the statistics if requested */
+	struct rpma_conn_stats *stats = NULL;
+	int stats_flags;
+	(void) rpma_conn_cfg_get_stats(cfg, &stats_flags);
+	if (stats_flags) {
+		uint32_t sq_size, rq_size;
+		(void) rpma_conn_cfg_get_sq_size(cfg, &sq_size);
+		(void) rpma_conn_cfg_get_rq_size(cfg, &rq_size);
+		/* the completions not collected yet are awaited too */
+		ret = rpma_conn_stats_new(rpma_peer_get_stats_group(peer),
+				stats_flags,
+				thread_mode != RPMA_CONN_THREAD_SINGLE,
+				sq_size + (uint32_t)cqe,
+				rq_size + (uint32_t)cqe, &stats);
+		if (ret)
+			goto err_conn_mt_delete;
+	}
+
 	*req_ptr = (struct rpma_conn_req *)malloc(sizeof(struct rpma_conn_req));
 	if (*req_ptr == NULL) {
 		ret = RPMA_E_NOMEM;
-		goto err_destroy_qp;
+		goto err_conn_stats_delete;
 	}
 
 	(*req_ptr)->edata = NULL;
 	(*req_ptr)->id = id;
 	(*req_ptr)->cq = cq;
+	(*req_ptr)->mt = mt;
+	(*req_ptr)->stats = stats;
+	(*req_ptr)->numa_node = numa_node;
 	(*req_ptr)->data.ptr = NULL;
 	(*req_ptr)->data.len = 0;
 	(*req_ptr)->peer = peer;
 
+	RPMA_TRACE(conn_req_new, *req_ptr, id);
+
+	rpma_numa_policy_restore(&policy);
+
 	return 0;
 
+err_conn_stats_delete:
+	(void) rpma_conn_stats_delete(&stats);
+
+err_conn_mt_delete:
+	(void) rpma_conn_mt_delete(&mt);
+
 err_destroy_qp:
 	rdma_destroy_qp(id);
 
 err_rpma_cq_delete:
 	(void) rpma_cq_delete(&cq);
 
+err_numa_policy_restore:
+	rpma_numa_policy_restore(&policy);
+
 	return ret;
 }
 
@@ -118,12 +189,19 @@ rpma_conn_req_accept(struct rpma_conn_req *req,
 		goto err_conn_disconnect;
 	}
 
+	struct rpma_numa_policy policy;
 	struct rpma_conn *conn = NULL;
+	rpma_numa_policy_set(req->numa_node, &policy);
 	ret = rpma_conn_new(req->peer, req->id, req->cq, &conn);
+	rpma_numa_policy_restore(&policy);
 	if (ret)
 		goto err_conn_disconnect;
 
 	rpma_conn_transfer_private_data(conn, &req->data);
+	if (req->mt)
+		rpma_conn_transfer_mt(conn, &req->mt);
+	if (req->stats)
+		rpma_conn_transfer_stats(conn, &req->stats);
 
 	*conn_ptr = conn;
 	return 0;
@@ -132,6 +210,8 @@ err_conn_disconnect:
 	(void) rdma_disconnect(req->id);
 
 err_conn_req_delete:
+	(void) rpma_conn_stats_delete(&req->stats);
+	(void) rpma_conn_mt_delete(&req->mt);
 	rdma_destroy_qp(req->id);
 	(void) rpma_cq_delete(&req->cq);
 
@@ -153,15 +233,25 @@ rpma_conn_req_connect_active(struct rpma_conn_req *req,
 {
 	int ret = 0;
 
+	struct rpma_numa_policy policy;
 	struct rpma_conn *conn = NULL;
+	rpma_numa_policy_set(req->numa_node, &policy);
 	ret = rpma_conn_new(req->peer, req->id, req->cq, &conn);
+	rpma_numa_policy_restore(&policy);
 	if (ret) {
+		(void) rpma_conn_stats_delete(&req->stats);
+		(void) rpma_conn_mt_delete(&req->mt);
 		rdma_destroy_qp(req->id);
 		(void) rpma_cq_delete(&req->cq);
 		(void) rdma_destroy_id(req->id);
 		return ret;
 	}
 
+	if (req->mt)
+		rpma_conn_transfer_mt(conn, &req->mt);
+	if (req->stats)
+		rpma_conn_transfer_stats(conn, &req->stats);
+
 	if (rdma_connect(req->id, conn_param)) {
 		RPMA_LOG_ERROR_WITH_ERRNO(errno, "rdma_connect()");
 		(void) rpma_conn_delete(&conn);
@@ -181,6 +271,8 @@ rpma_conn_req_connect_active(struct rpma_conn_req *req,
 static int
 rpma_conn_req_reject(struct rpma_conn_req *req)
 {
+	RPMA_TRACE(conn_req_reject, req, req->id);
+
 	int ret = rpma_cq_delete(&req->cq);
 
 	if (rdma_reject(req->id,
@@ -359,6 +451,8 @@ rpma_conn_req_connect(struct rpma_conn_req **req_ptr,
 
 	int ret = 0;
 
+	RPMA_TRACE(conn_req_connect, req, req->id, req->edata == NULL);
+
 	if (req->edata)
 		ret = rpma_conn_req_accept(req, &conn_param, conn_ptr);
 	else
@@ -385,6 +479,8 @@ rpma_conn_req_delete(struct rpma_conn_req **req_ptr)
 	if (req == NULL)
 		return 0;
 
+	(void) rpma_conn_stats_delete(&req->stats);
+	(void) rpma_conn_mt_delete(&req->mt);
 	rdma_destroy_qp(req->id);
 
 	int ret = 0;
@@ -413,9 +509,19 @@ rpma_conn_req_recv(struct rpma_conn_req *req,
 	if (req == NULL || dst == NULL)
 		return RPMA_E_INVAL;
 
-	return rpma_mr_recv(req->id->qp,
+	if (req->stats)
+		rpma_conn_stats_posting(req->stats, RPMA_OP_RECV,
+				RPMA_F_COMPLETION_ALWAYS);
+
+	int ret = rpma_mr_recv(req->id->qp,
 			dst, offset, len,
 			op_context);
+
+	if (req->stats)
+		rpma_conn_stats_posted(req->stats, RPMA_OP_RECV, len,
+				RPMA_F_COMPLETION_ALWAYS, ret);
+
+	return ret;
 }
 
 /*
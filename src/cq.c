@@ -8,11 +8,13 @@
 #include <errno.h>
 #include <inttypes.h>
 #include <stdlib.h>
+#include <time.h>
 #include <arpa/inet.h>
 
 #include "common.h"
 #include "cq.h"
 #include "log_internal.h"
+#include "trace.h"
 
 #ifdef TEST_MOCK_ALLOC
 #include "cmocka_alloc.h"
@@ -21,8 +23,90 @@
 struct rpma_cq {
 	struct ibv_comp_channel *channel; /* completion event channel */
 	struct ibv_cq *cq; /* completion queue */
+	struct ibv_cq_ex *cq_ex; /* the same CQ if timestamped by the device */
+	uint64_t hca_core_clock; /* the frequency of the device clock (kHz) */
+	bool wallclock; /* the device timestamps are in the wallclock domain */
 };
 
+/* the completion timestamps requested from the device */
+#define CQ_WC_FLAGS_TS \
+	(IBV_WC_STANDARD_FLAGS | IBV_WC_EX_WITH_COMPLETION_TIMESTAMP)
+
+/*
+ * cq_clock_ns -- read the software clock (comparable with the wallclock
+ * timestamps of the device)
+ */
+static inline uint64_t
+cq_clock_ns(void)
+{
+	struct timespec ts;
+	(void) clock_gettime(CLOCK_REALTIME, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * cq_create_ex -- create a CQ timestamping the completions if the device
+ * supports it (preferably in the wallclock domain) or return NULL otherwise
+ */
+static struct ibv_cq_ex *
+cq_create_ex(struct ibv_context *dev, int cqe,
+		struct ibv_comp_channel *channel, int comp_vector,
+		uint64_t *hca_core_clock, bool *wallclock)
+{
+	struct ibv_device_attr_ex attr;
+	errno = ibv_query_device_ex(dev, NULL /* input */, &attr);
+	if (errno) {
+		RPMA_LOG_WARNING(
+			"ibv_query_device_ex() failed (%s) - the completions will be timestamped by software",
+			strerror(errno));
+		return NULL;
+	}
+
+	if (attr.completion_timestamp_mask == 0 || attr.hca_core_clock == 0) {
+		RPMA_LOG_INFO(
+			"the device does not timestamp the completions - they will be timestamped by software");
+		return NULL;
+	}
+
+	struct ibv_cq_init_attr_ex cq_attr = {0};
+	cq_attr.cqe = (uint32_t)cqe;
+	cq_attr.channel = channel;
+	cq_attr.comp_vector = (uint32_t)comp_vector;
+	cq_attr.wc_flags = CQ_WC_FLAGS_TS |
+		IBV_WC_EX_WITH_COMPLETION_TIMESTAMP_WALLCLOCK;
+
+	struct ibv_cq_ex *cq_ex = ibv_create_cq_ex(dev, &cq_attr);
+	*wallclock = (cq_ex != NULL);
+	if (cq_ex == NULL) {
+		/* the wallclock timestamps may be not supported */
+		cq_attr.wc_flags = CQ_WC_FLAGS_TS;
+		cq_ex = ibv_create_cq_ex(dev, &cq_attr);
+	}
+
+	if (cq_ex == NULL) {
+		RPMA_LOG_WARNING(
+			"ibv_create_cq_ex() failed (%s) - the completions will be timestamped by software",
+			strerror(errno));
+		return NULL;
+	}
+
+	*hca_core_clock = attr.hca_core_clock;
+
+	return cq_ex;
+}
+
+/*
+ * cq_ts_to_ns -- convert the timestamp of the device clock into nanoseconds
+ */
+static inline uint64_t
+cq_ts_to_ns(uint64_t ts, uint64_t hca_core_clock)
+{
+	/* hca_core_clock is in kHz */
+	return ts / hca_core_clock * 1000000 +
+		ts % hca_core_clock * 1000000 / hca_core_clock;
+}
+
 /* internal librpma API */
 
 /*
@@ -69,8 +153,13 @@ rpma_cq_wait(struct rpma_cq *cq)
 	/* wait for the completion event */
 	struct ibv_cq *ev_cq;	/* unused */
 	void *ev_ctx;		/* unused */
-	if (ibv_get_cq_event(cq->channel, &ev_cq, &ev_ctx))
+	RPMA_TRACE(cq_wait, cq);
+	if (ibv_get_cq_event(cq->channel, &ev_cq, &ev_ctx)) {
+		RPMA_TRACE(cq_wakeup, cq, RPMA_E_NO_COMPLETION);
 		return RPMA_E_NO_COMPLETION;
+	}
+
+	RPMA_TRACE(cq_wakeup, cq, 0);
 
 	/*
 	 * ACK the collected CQ event.
@@ -91,35 +180,12 @@ rpma_cq_wait(struct rpma_cq *cq)
 }
 
 /*
- * rpma_cq_get_completion -- receive an operation completion from
- * the rpma_cq object
- *
- * ASSUMPTIONS
- * - cq != NULL && cmpl != NULL
+ * cq_wc_to_completion -- translate the work completion into the completion
  */
-int
-rpma_cq_get_completion(struct rpma_cq *cq, struct rpma_completion *cmpl)
+static int
+cq_wc_to_completion(const struct ibv_wc *wc, struct rpma_completion *cmpl)
 {
-	struct ibv_wc wc = {0};
-	int result = ibv_poll_cq(cq->cq, 1 /* num_entries */, &wc);
-	if (result == 0) {
-		/*
-		 * There may be an extra CQ event with no completion in the CQ.
-		 */
-		RPMA_LOG_DEBUG("No completion in the CQ");
-		return RPMA_E_NO_COMPLETION;
-	} else if (result < 0) {
-		/* ibv_poll_cq() may return only -1; no errno provided */
-		RPMA_LOG_ERROR("ibv_poll_cq() failed (no details available)");
-		return RPMA_E_PROVIDER;
-	} else if (result > 1) {
-		RPMA_LOG_ERROR(
-			"ibv_poll_cq() returned %d where 0 or 1 is expected",
-			result);
-		return RPMA_E_UNKNOWN;
-	}
-
-	switch (wc.opcode) {
+	switch (wc->opcode) {
 	case IBV_WC_RDMA_READ:
 		cmpl->op = RPMA_OP_READ;
 		break;
@@ -135,16 +201,26 @@ rpma_cq_get_completion(struct rpma_cq *cq, struct rpma_completion *cmpl)
 	case IBV_WC_RECV_RDMA_WITH_IMM:
 		cmpl->op = RPMA_OP_RECV_RDMA_WITH_IMM;
 		break;
+	case IBV_WC_COMP_SWAP:
+		cmpl->op = RPMA_OP_COMPARE_AND_SWAP;
+		break;
+	case IBV_WC_FETCH_ADD:
+		cmpl->op = RPMA_OP_FETCH_AND_ADD;
+		break;
 	default:
-		RPMA_LOG_ERROR("unsupported wc.opcode == %d", wc.opcode);
+		RPMA_LOG_ERROR("unsupported wc.opcode == %d", wc->opcode);
 		return RPMA_E_NOSUPP;
 	}
 
-	cmpl->op_context = (void *)wc.wr_id;
-	cmpl->byte_len = wc.byte_len;
-	cmpl->op_status = wc.status;
+	cmpl->op_context = (void *)wc->wr_id;
+	cmpl->byte_len = wc->byte_len;
+	cmpl->op_status = wc->status;
+	cmpl->qp_num = wc->qp_num;
 	/* 'wc_flags' is of 'int' type in older versions of libibverbs */
-	cmpl->flags = (unsigned)wc.wc_flags;
+	cmpl->flags = (unsigned)wc->wc_flags;
+
+	RPMA_TRACE(completion, wc->qp_num, wc->wr_id, cmpl->op, wc->byte_len,
+			wc->status);
 
 	/*
 	 * The value of imm_data can be placed only in the receive Completion
@@ -153,10 +229,10 @@ rpma_cq_get_completion(struct rpma_cq *cq, struct rpma_completion *cmpl)
 	if ((cmpl->op == RPMA_OP_RECV) ||
 			(cmpl->op == RPMA_OP_RECV_RDMA_WITH_IMM)) {
 		if (cmpl->flags & IBV_WC_WITH_IMM)
-			cmpl->imm = ntohl(wc.imm_data);
+			cmpl->imm = ntohl(wc->imm_data);
 	}
 
-	if (unlikely(wc.status != IBV_WC_SUCCESS)) {
+	if (unlikely(wc->status != IBV_WC_SUCCESS)) {
 		RPMA_LOG_WARNING("failed rpma_completion(op_context=0x%" PRIx64
 				", op_status=%s)",
 				cmpl->op_context,
@@ -167,14 +243,153 @@ rpma_cq_get_completion(struct rpma_cq *cq, struct rpma_completion *cmpl)
 }
 
 /*
- * rpma_cq_new -- create a completion channel and CQ and then
- * encapsulate them in a rpma_cq object
+ * rpma_cq_get_completion -- receive an operation completion from
+ * the rpma_cq object
+ *
+ * ASSUMPTIONS
+ * - cq != NULL && cmpl != NULL
+ */
+int
+rpma_cq_get_completion(struct rpma_cq *cq, struct rpma_completion *cmpl)
+{
+	struct ibv_wc wc = {0};
+	int result = ibv_poll_cq(cq->cq, 1 /* num_entries */, &wc);
+	if (result == 0) {
+		/*
+		 * There may be an extra CQ event with no completion in the CQ.
+		 */
+		RPMA_LOG_DEBUG("No completion in the CQ");
+		return RPMA_E_NO_COMPLETION;
+	} else if (result < 0) {
+		/* ibv_poll_cq() may return only -1; no errno provided */
+		RPMA_LOG_ERROR("ibv_poll_cq() failed (no details available)");
+		return RPMA_E_PROVIDER;
+	} else if (result > 1) {
+		RPMA_LOG_ERROR(
+			"ibv_poll_cq() returned %d where 0 or 1 is expected",
+			result);
+		return RPMA_E_UNKNOWN;
+	}
+
+	return cq_wc_to_completion(&wc, cmpl);
+}
+
+/*
+ * rpma_cq_get_completions -- receive up to num_entries operation completions
+ * from the rpma_cq object using a single ibv_poll_cq(3) call
+ *
+ * ASSUMPTIONS
+ * - cq != NULL && wcs != NULL && cmpls != NULL && num != NULL
+ * - num_entries > 0
+ */
+int
+rpma_cq_get_completions(struct rpma_cq *cq, struct ibv_wc *wcs,
+		struct rpma_completion *cmpls, int num_entries, int *num)
+{
+	*num = 0;
+
+	int result = ibv_poll_cq(cq->cq, num_entries, wcs);
+	if (result == 0) {
+		RPMA_LOG_DEBUG("No completion in the CQ");
+		return RPMA_E_NO_COMPLETION;
+	} else if (result < 0) {
+		/* ibv_poll_cq() may return only -1; no errno provided */
+		RPMA_LOG_ERROR("ibv_poll_cq() failed (no details available)");
+		return RPMA_E_PROVIDER;
+	} else if (result > num_entries) {
+		RPMA_LOG_ERROR(
+			"ibv_poll_cq() returned %d where up to %d is expected",
+			result, num_entries);
+		return RPMA_E_UNKNOWN;
+	}
+
+	/* the completions of the unsupported opcodes are dropped */
+	int ret = 0;
+	for (int i = 0; i < result; ++i) {
+		if (cq_wc_to_completion(&wcs[i], &cmpls[*num]))
+			ret = RPMA_E_NOSUPP;
+		else
+			(*num)++;
+	}
+
+	return ret;
+}
+
+/*
+ * rpma_cq_get_completion_ex -- receive an operation completion from
+ * the rpma_cq object together with its timestamp
+ *
+ * ASSUMPTIONS
+ * - cq != NULL && cmpl_ex != NULL
+ */
+int
+rpma_cq_get_completion_ex(struct rpma_cq *cq,
+		struct rpma_completion_ex *cmpl_ex)
+{
+	int ret;
+
+	if (cq->cq_ex == NULL) {
+		/* the software fallback */
+		ret = rpma_cq_get_completion(cq, &cmpl_ex->cmpl);
+		if (ret)
+			return ret;
+
+		cmpl_ex->ts_source = RPMA_COMPLETION_TS_SOFTWARE;
+		cmpl_ex->polled_ns = cq_clock_ns();
+		cmpl_ex->ts_ns = cmpl_ex->polled_ns;
+
+		return 0;
+	}
+
+	struct ibv_poll_cq_attr attr = {0};
+	ret = ibv_start_poll(cq->cq_ex, &attr);
+	if (ret == ENOENT) {
+		RPMA_LOG_DEBUG("No completion in the CQ");
+		return RPMA_E_NO_COMPLETION;
+	} else if (ret) {
+		RPMA_LOG_ERROR_WITH_ERRNO(ret, "ibv_start_poll()");
+		return RPMA_E_PROVIDER;
+	}
+
+	cmpl_ex->polled_ns = cq_clock_ns();
+
+	struct ibv_wc wc = {0};
+	wc.wr_id = cq->cq_ex->wr_id;
+	wc.status = cq->cq_ex->status;
+	wc.opcode = ibv_wc_read_opcode(cq->cq_ex);
+	wc.byte_len = ibv_wc_read_byte_len(cq->cq_ex);
+	wc.qp_num = ibv_wc_read_qp_num(cq->cq_ex);
+	wc.wc_flags = ibv_wc_read_wc_flags(cq->cq_ex);
+	if (wc.wc_flags & IBV_WC_WITH_IMM)
+		wc.imm_data = ibv_wc_read_imm_data(cq->cq_ex);
+
+	if (cq->wallclock) {
+		cmpl_ex->ts_source = RPMA_COMPLETION_TS_HW_WALLCLOCK;
+		cmpl_ex->ts_ns =
+			ibv_wc_read_completion_wallclock_ns(cq->cq_ex);
+	} else {
+		cmpl_ex->ts_source = RPMA_COMPLETION_TS_HW;
+		cmpl_ex->ts_ns = cq_ts_to_ns(
+			ibv_wc_read_completion_ts(cq->cq_ex),
+			cq->hca_core_clock);
+	}
+
+	ibv_end_poll(cq->cq_ex);
+
+	return cq_wc_to_completion(&wc, &cmpl_ex->cmpl);
+}
+
+/*
+ * rpma_cq_new -- create a completion channel and CQ (using the given
+ * completion vector and timestamping the completions by the device
+ * if requested and supported) and then encapsulate them in a rpma_cq object
  *
  * ASSUMPTIONS
  * - dev != NULL && cq_ptr != NULL
  */
 int
-rpma_cq_new(struct ibv_context *dev, int cqe, struct rpma_cq **cq_ptr)
+rpma_cq_new(struct ibv_context *dev, int cqe, int comp_vector,
+		bool timestamps, struct rpma_cq **cq_ptr)
 {
 	int ret = 0;
 
@@ -186,10 +401,23 @@ rpma_cq_new(struct ibv_context *dev, int cqe, struct rpma_cq **cq_ptr)
 	}
 
 	/* create a CQ */
-	struct ibv_cq *cq = ibv_create_cq(dev, cqe,
+	struct ibv_cq_ex *cq_ex = NULL;
+	uint64_t hca_core_clock = 0;
+	bool wallclock = false;
+	struct ibv_cq *cq;
+	if (timestamps) {
+		cq_ex = cq_create_ex(dev, cqe, channel, comp_vector,
+				&hca_core_clock, &wallclock);
+	}
+
+	if (cq_ex) {
+		cq = ibv_cq_ex_to_cq(cq_ex);
+	} else {
+		cq = ibv_create_cq(dev, cqe,
 				NULL /* cq_context */,
 				channel /* channel */,
-				0 /* comp_vector */);
+				comp_vector);
+	}
 	if (cq == NULL) {
 		RPMA_LOG_ERROR_WITH_ERRNO(errno, "ibv_create_cq()");
 		ret = RPMA_E_PROVIDER;
@@ -212,6 +440,9 @@ rpma_cq_new(struct ibv_context *dev, int cqe, struct rpma_cq **cq_ptr)
 
 	(*cq_ptr)->channel = channel;
 	(*cq_ptr)->cq = cq;
+	(*cq_ptr)->cq_ex = cq_ex;
+	(*cq_ptr)->hca_core_clock = hca_core_clock;
+	(*cq_ptr)->wallclock = wallclock;
 
 	return 0;
 
@@ -48,6 +48,36 @@ int rpma_cq_wait(struct rpma_cq *cq);
 int rpma_cq_get_completion(struct rpma_cq *cq, struct rpma_completion *cmpl);
 
 /*
+ * ERRORS
+ * rpma_cq_get_completions() can fail with the following errors:
+ *
+ * - RPMA_E_NO_COMPLETION - no completions available
+ * - RPMA_E_PROVIDER - ibv_poll_cq(3) failed with a provider error
+ * - RPMA_E_UNKNOWN - ibv_poll_cq(3) failed but no provider error is available
+ * - RPMA_E_NOSUPP - not supported opcode (*num holds the number
+ *   of the supported completions collected anyway)
+ */
+int rpma_cq_get_completions(struct rpma_cq *cq, struct ibv_wc *wcs,
+		struct rpma_completion *cmpls, int num_entries, int *num);
+
+/*
+ * ERRORS
+ * rpma_cq_get_completion_ex() can fail with the following errors:
+ *
+ * - RPMA_E_NO_COMPLETION - no completions available
+ * - RPMA_E_PROVIDER - ibv_poll_cq(3) or ibv_start_poll(3) failed with
+ * a provider error
+ * - RPMA_E_UNKNOWN - ibv_poll_cq(3) failed but no provider error is available
+ * - RPMA_E_NOSUPP - not supported opcode
+ */
+int rpma_cq_get_completion_ex(struct rpma_cq *cq,
+		struct rpma_completion_ex *cmpl_ex);
+
+/*
+ * If the timestamps are requested but the device does not support them
+ * a regular CQ is created and the completions are timestamped by software
+ * (see rpma_cq_get_completion_ex()).
+ *
  * ERRORS
  * rpma_cq_new() can fail with the following errors:
  *
@@ -55,7 +85,8 @@ int rpma_cq_get_completion(struct rpma_cq *cq, struct rpma_completion *cmpl);
  * ibv_req_notify_cq(3) failed with a provider error
  * - RPMA_E_NOMEM - out of memory
  */
-int rpma_cq_new(struct ibv_context *dev, int cqe, struct rpma_cq **cq_ptr);
+int rpma_cq_new(struct ibv_context *dev, int cqe, int comp_vector,
+		bool timestamps, struct rpma_cq **cq_ptr);
 
 /*
  * ERRORS
@@ -13,6 +13,7 @@
 #include "info.h"
 #include "librpma.h"
 #include "log_internal.h"
+#include "trace.h"
 
 struct rpma_ep {
 	/* parent peer object */
@@ -89,6 +90,7 @@ rpma_ep_listen(struct rpma_peer *peer, const char *addr, const char *port,
 	/* an error at this step should not affect the final result */
 	(void) rpma_info_delete(&info);
 
+	RPMA_TRACE(ep_listen, ep, id);
 	RPMA_LOG_NOTICE("Waiting for incoming connection on %s:%s", addr,
 			port);
 
@@ -185,6 +187,8 @@ rpma_ep_next_conn_req(struct rpma_ep *ep, const struct rpma_conn_cfg *cfg,
 	if (ret)
 		goto err_ack;
 
+	RPMA_TRACE(ep_conn_req, ep, *req_ptr);
+
 	return 0;
 
 err_ack:
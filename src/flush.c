@@ -18,6 +18,7 @@
 #include "flush.h"
 #include "log_internal.h"
 #include "mr.h"
+#include "trace.h"
 
 static int rpma_flush_apm_new(struct rpma_peer *peer,
 		struct rpma_flush *flush);
@@ -136,6 +137,8 @@ rpma_flush_apm_do(struct ibv_qp *qp, struct rpma_flush *flush,
 	struct flush_apm *flush_apm =
 			(struct flush_apm *)flush_internal->context;
 
+	RPMA_TRACE(flush, qp, dst, dst_offset, len, type, op_context);
+
 	return rpma_mr_read(qp, flush_apm->raw_mr, 0, dst, dst_offset,
 			RAW_SIZE, flags, op_context);
 }
@@ -69,6 +69,55 @@ extern "C" {
  * All of these operations are considered as finished
  * when the respective completion is generated.
  *
+ * The remote atomic operations rpma_compare_and_swap() and rpma_fetch_and_add()
+ * modify an 8-byte value (RPMA_ATOMIC_ALIGNMENT) in the remote memory
+ * registered with the RPMA_MR_USAGE_ATOMIC usage and return its original value
+ * to the local memory. They allow building e.g. sequence numbers, locks
+ * or leases shared by many clients without involving the remote CPU.
+ *
+ * A single read or write operation cannot transfer more than UINT32_MAX bytes
+ * and the library does not split it. rpma_read(), rpma_write() and
+ * rpma_write_with_imm() reject longer ones with RPMA_E_INVAL and the RDMA
+ * device may reject anything longer than the maximum message size of its port
+ * (max_msg_sz). Larger transfers can be split into chunks posted
+ * in a pipelined manner by the segmented transfer engine
+ * (see rpma_xfer_new(3)) which reports a single completion for each transfer.
+ *
+ * The data which has not been registered can be written, sent or read
+ * via the engine of bounce buffers (see rpma_bounce_new(3)). Depending
+ * on its size the data is either posted inline, copied through one of
+ * the pre-registered bounce buffers or registered on demand and kept
+ * in a small registration cache.
+ *
+ * Long runs of small writes to the neighbouring offsets of a remote memory
+ * region can be gathered in the staging buffers of the write-combining
+ * layer (see rpma_wcomb_new(3)) so a single RDMA write carries many of them.
+ *
+ * The ranges of a remote memory region which are read over and over again
+ * can be kept in the read cache (see rpma_rcache_new(3)). The cached data
+ * is validated by reading a single version word the remote side updates
+ * whenever it modifies the region and only the misses are read.
+ *
+ * The data mirrored to several remote replicas can be written using
+ * a replication group (see rpma_repl_new(3)). It posts the write and
+ * the flush to all the replicas and reports a single completion as soon
+ * as a quorum of them have flushed the data.
+ *
+ * The records of a remote append-only log (see rpma_aof_new(3)) are staged
+ * locally and made durable by group commits. A commit writes and flushes
+ * all the records appended since the last one and then publishes the new
+ * tail of the log using an atomic write. Every record carries a checksum
+ * so the torn records can be detected on recovery (see rpma_aof_verify(3)).
+ *
+ * An atomic write operation has to be ordered after the earlier read,
+ * atomic and flush operations of the connection so the library fences it
+ * whenever any of them has been posted since the last fenced operation.
+ * The applications which run independent sequences of operations over
+ * a single connection may split them into ordering domains using
+ * rpma_read_in_domain() and rpma_write_atomic_in_domain() so an atomic write
+ * operation is fenced only when a read operation is outstanding
+ * in its own domain.
+ *
  * DIRECT WRITE TO PMEM
  *
  * \f[B]Direct Write to PMem\f[R] is a feature of a platform and
@@ -208,6 +257,8 @@ extern "C" {
  * - RPMA_OP_FLUSH - RMA flush operation
  * - RPMA_OP_SEND - messaging send operation
  * - RPMA_OP_RECV - messaging receive operation
+ * - RPMA_OP_COMPARE_AND_SWAP - RMA atomic compare-and-swap operation
+ * - RPMA_OP_FETCH_AND_ADD - RMA atomic fetch-and-add operation
  *
  * All operations generate completion on error. The operations posted
  * with the \f[B]RPMA_F_COMPLETION_ALWAYS\f[R] flag also generate a completion
@@ -265,6 +316,29 @@ extern "C" {
  * The provided file descriptors can also be used for scalable I/O handling like
  * epoll(7).
  *
+ * Instead of watching all the file descriptors of all the connections
+ * and endpoints separately they can be registered in an event reactor
+ * (see rpma_reactor_new(3)). It waits for all of them using a single
+ * epoll(7) instance, calls the registered callbacks of the ready ones
+ * and drains the completion queues in batches. The file descriptor
+ * of the reactor (see rpma_reactor_get_fd(3)) can be integrated into
+ * an external event loop.
+ *
+ * An application which does not want to run its own polling loop at all
+ * can start a progress thread of a connection (see rpma_progress_new(3)).
+ * It collects the completions in batches, either busy-polling or waiting
+ * for the completion events, and calls the callbacks attached to
+ * the operations via their op_context. The completions are then handled
+ * on the progress thread while the other threads keep posting.
+ *
+ * C++ applications can use the header-only C++20 wrapper <librpma.hpp>
+ * (installed when librpma is configured with -DBUILD_CXX=ON). It provides
+ * RAII owners of the peer, the memory regions, the endpoint and
+ * the connection and co_await-able operations resumed by
+ * rpma::conn::dispatch() which collects the completions in batches.
+ * The awaited operation itself is used as the op_context so the wrapper
+ * does not allocate anything per operation.
+ *
  * Please see the example showing how to make use of RPMA file descriptors:
  * https://github.com/pmem/rpma/tree/master/examples/06-multiple-connections
  *
@@ -307,6 +381,75 @@ extern "C" {
  * - rpma_conn_cfg_set_sq_size() - set length of \f[B]SQ\f[R]
  * - rpma_conn_cfg_set_rq_size() - set length of \f[B]RQ\f[R]
  *
+ * The placement of the connection's resources can be configured as well:
+ *
+ * - rpma_conn_cfg_set_comp_vector() - set the completion vector which
+ * the \f[B]CQ\f[R] is bound to (so the completion events are signalled
+ * to the CPU core consuming them)
+ * - rpma_conn_cfg_set_numa_node() - set the NUMA node the connection's
+ * queues and internal buffers are allocated on (see also
+ * rpma_peer_get_numa_node())
+ *
+ * Many connections can also share a single pool of receive buffers.
+ * A shared receive queue \f[B](SRQ)\f[R] created by rpma_srq_new() replaces
+ * the \f[B]RQ\f[R] of every connection attached to it via
+ * rpma_conn_cfg_set_srq(). It saves the RNIC's resources when there are many
+ * mostly idle connections. Receive buffers are posted using rpma_srq_recv()
+ * and their completions are collected using rpma_srq_completion_get().
+ * A receive buffer ring created by rpma_recv_ring_new() keeps a registered
+ * slab of fixed-size buffers posted either to a connection or
+ * to an \f[B]SRQ\f[R] and re-posts the buffers released by the application
+ * in batches.
+ *
+ * Applications built around submission and completion rings can use
+ * the rings created by rpma_ring_new() instead of calling a function per
+ * operation. The operation descriptors filled directly in the submission
+ * ring are posted as a single chain of work requests by rpma_ring_submit()
+ * and the completions are collected into the completion ring in batches.
+ *
+ * Hot loops repeating the same read or write with only the offsets and
+ * op_context changing can prepare the operation once using
+ * rpma_op_template_new(). The queue pair, the keys, the base addresses and
+ * the flags are resolved when the template is created and
+ * rpma_op_template_start() only patches the offsets, the length and
+ * the op_context before posting the operation.
+ *
+ * The per-operation library overhead can be avoided altogether using
+ * the static inline rpma_fast_read() and rpma_fast_write() declared in
+ * \f[B]<librpma_fast.h>\f[R]. They build the work request on the stack
+ * using the fast handles filled once by rpma_conn_get_fast(),
+ * rpma_mr_get_fast() and rpma_mr_remote_get_fast() and validate their
+ * arguments only if RPMA_FAST_DEBUG is defined. The rpma:post_chain
+ * tracepoint is compiled into them only if RPMA_FAST_USDT is defined.
+ *
+ * Applications exchanging small requests and responses can use a messenger
+ * created by rpma_msgr_new() instead of the raw rpma_send() and rpma_recv().
+ * The messenger never sends a message the peer has no receive buffer posted
+ * for (the receive buffers are granted to the peer as credits), batches
+ * small messages into a single send and matches the responses with
+ * the requests using correlation IDs.
+ *
+ * The lowest-latency messaging does not involve the receiver's RNIC at all.
+ * A message queue created by rpma_mq_new() carries the messages written
+ * by rpma_write() directly to a ring on the receiver's side which polls
+ * the ring for the new messages and writes its progress back to the sender.
+ *
+ * A connection can collect the performance statistics if it is configured
+ * using rpma_conn_cfg_set_stats(): the operations and the bytes posted by
+ * type, the completions collected, the empty polls, the wake-ups of
+ * the completion channel, the failed completions and optionally
+ * the histograms of the latencies of the operations measured using the TSC.
+ * Snapshots of the statistics of a connection and of all the connections of
+ * a peer are taken using rpma_conn_get_stats() and rpma_peer_get_stats().
+ * A connection not configured to collect the statistics does not pay
+ * anything for them.
+ *
+ * The completions of a connection configured using
+ * rpma_conn_cfg_set_timestamps() are timestamped by the device if it is
+ * capable of it. rpma_conn_completion_get_ex() returns the timestamp of
+ * the completion together with the time it has been collected so the time
+ * spent in the network can be told apart from the delay of polling.
+ *
  * When the connection configuration object is ready it has to be used for
  * either rpma_conn_req_new() or rpma_ep_next_conn_req() for the settings
  * to take effect.
@@ -318,15 +461,46 @@ extern "C" {
  * establishment and tear-down. Here you can find a complete list of
  * NOT thread-safe API calls:
  *
+ * - rpma_aof_append()
+ * - rpma_aof_commit()
+ * - rpma_aof_delete()
+ * - rpma_aof_get_tail()
+ * - rpma_aof_new()
+ * - rpma_aof_next()
+ * - rpma_aof_process()
+ * - rpma_aof_reserve()
+ * - rpma_bounce_delete()
+ * - rpma_bounce_get_thresholds()
+ * - rpma_bounce_invalidate()
+ * - rpma_bounce_new()
+ * - rpma_bounce_process()
+ * - rpma_bounce_read()
+ * - rpma_bounce_send()
+ * - rpma_bounce_set_thresholds()
+ * - rpma_bounce_write()
  * - rpma_conn_apply_remote_peer_cfg()
+ * - rpma_conn_cfg_get_comp_vector()
  * - rpma_conn_cfg_get_cq_size()
+ * - rpma_conn_cfg_get_inline_size()
+ * - rpma_conn_cfg_get_numa_node()
  * - rpma_conn_cfg_get_rq_size()
  * - rpma_conn_cfg_get_sq_size()
+ * - rpma_conn_cfg_get_srq()
+ * - rpma_conn_cfg_get_stats()
+ * - rpma_conn_cfg_get_thread_mode()
  * - rpma_conn_cfg_get_timeout()
+ * - rpma_conn_cfg_get_timestamps()
+ * - rpma_conn_cfg_set_comp_vector()
  * - rpma_conn_cfg_set_cq_size()
+ * - rpma_conn_cfg_set_inline_size()
+ * - rpma_conn_cfg_set_numa_node()
  * - rpma_conn_cfg_set_rq_size()
  * - rpma_conn_cfg_set_sq_size()
+ * - rpma_conn_cfg_set_srq()
+ * - rpma_conn_cfg_set_stats()
+ * - rpma_conn_cfg_set_thread_mode()
  * - rpma_conn_cfg_set_timeout()
+ * - rpma_conn_cfg_set_timestamps()
  * - rpma_conn_delete()
  * - rpma_conn_disconnect()
  * - rpma_conn_get_private_data()
@@ -338,11 +512,82 @@ extern "C" {
  * - rpma_ep_listen()
  * - rpma_ep_next_conn_req()
  * - rpma_ep_shutdown()
+ * - rpma_fast_read()
+ * - rpma_fast_write()
+ * - rpma_mq_connect()
+ * - rpma_mq_delete()
+ * - rpma_mq_flush()
+ * - rpma_mq_get_descriptor()
+ * - rpma_mq_get_descriptor_size()
+ * - rpma_mq_new()
+ * - rpma_mq_next()
+ * - rpma_mq_publish()
+ * - rpma_mq_send()
+ * - rpma_msgr_delete()
+ * - rpma_msgr_flush()
+ * - rpma_msgr_get_credits()
+ * - rpma_msgr_new()
+ * - rpma_msgr_next()
+ * - rpma_msgr_process()
+ * - rpma_msgr_request()
+ * - rpma_msgr_respond()
+ * - rpma_op_template_delete()
+ * - rpma_op_template_new()
+ * - rpma_op_template_start()
  * - rpma_peer_cfg_get_descriptor()
  * - rpma_peer_cfg_get_descriptor_size()
  * - rpma_peer_cfg_get_direct_write_to_pmem()
  * - rpma_peer_cfg_set_direct_write_to_pmem()
+ * - rpma_progress_delete()
+ * - rpma_progress_new()
+ * - rpma_rcache_delete()
+ * - rpma_rcache_invalidate()
+ * - rpma_rcache_new()
+ * - rpma_rcache_next()
+ * - rpma_rcache_process()
+ * - rpma_rcache_read()
+ * - rpma_rcache_submit()
+ * - rpma_rcache_validate()
+ * - rpma_reactor_add_conn()
+ * - rpma_reactor_add_ep()
+ * - rpma_reactor_delete()
+ * - rpma_reactor_dispatch()
+ * - rpma_reactor_get_fd()
+ * - rpma_reactor_new()
+ * - rpma_reactor_remove_conn()
+ * - rpma_reactor_remove_ep()
+ * - rpma_recv_ring_delete()
+ * - rpma_recv_ring_get_msg()
+ * - rpma_recv_ring_new()
+ * - rpma_recv_ring_release()
+ * - rpma_recv_ring_repost()
+ * - rpma_repl_delete()
+ * - rpma_repl_get_slowest()
+ * - rpma_repl_new()
+ * - rpma_repl_next()
+ * - rpma_repl_process()
+ * - rpma_repl_write()
+ * - rpma_ring_cq_advance()
+ * - rpma_ring_delete()
+ * - rpma_ring_get_sqe()
+ * - rpma_ring_new()
+ * - rpma_ring_peek_cqes()
+ * - rpma_ring_submit()
  * - rpma_utils_get_ibv_context()
+ * - rpma_wcomb_delete()
+ * - rpma_wcomb_flush()
+ * - rpma_wcomb_new()
+ * - rpma_wcomb_post()
+ * - rpma_wcomb_process()
+ * - rpma_wcomb_progress()
+ * - rpma_wcomb_set_timeout()
+ * - rpma_wcomb_write()
+ * - rpma_xfer_delete()
+ * - rpma_xfer_new()
+ * - rpma_xfer_next()
+ * - rpma_xfer_process()
+ * - rpma_xfer_read()
+ * - rpma_xfer_write()
  *
  * Other librpma API calls are thread-safe. However, creating RPMA library
  * resources usually involves dynamic memory allocation and destroying
@@ -352,6 +597,21 @@ extern "C" {
  * rules and not doing so may result in a segmentation fault or undefined
  * behaviour.
  *
+ * By default a connection is meant to be used by a single thread at a time
+ * (RPMA_CONN_THREAD_SINGLE). A connection can be shared by many threads
+ * posting operations concurrently when it is created with a thread mode set
+ * via rpma_conn_cfg_set_thread_mode():
+ *
+ * - RPMA_CONN_THREAD_SAFE - the send-side operations of all the threads are
+ * gathered in a lock-free submission ring and posted in batches by whichever
+ * thread happens to be the poster at the moment
+ * - RPMA_CONN_THREAD_LOCKLESS - each thread posts directly to the queue pair
+ * which is valid only if the RDMA provider is thread-safe itself
+ *
+ * In both modes each thread may call rpma_conn_thread_attach() so
+ * the completions of the operations it has posted are routed back to it
+ * no matter which thread polls them from the shared completion queue.
+ *
  * .SH ON-DEMAND PAGING SUPPORT
  *
  * On-Demand-Paging (ODP) is a technique that simplifies the memory
@@ -807,6 +1067,40 @@ int rpma_peer_new(struct ibv_context *ibv_ctx, struct rpma_peer **peer_ptr);
  */
 int rpma_peer_delete(struct rpma_peer **peer_ptr);
 
+/** 3
+ * rpma_peer_get_numa_node - get the NUMA node of the peer's device
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_peer;
+ *	int rpma_peer_get_numa_node(const struct rpma_peer *peer, int *node);
+ *
+ * DESCRIPTION
+ * rpma_peer_get_numa_node() gets the NUMA node the RDMA-capable network
+ * interface of the peer is attached to. It allows placing the threads
+ * and the memory using the peer close to the device
+ * (see rpma_conn_cfg_set_numa_node(3)). If the NUMA node of the device
+ * is not known (e.g. the platform is not a NUMA one) *node is set to
+ * RPMA_NUMA_NODE_ANY.
+ *
+ * RETURN VALUE
+ * The rpma_peer_get_numa_node() function returns 0 on success or a negative
+ * error code on failure. rpma_peer_get_numa_node() does not set *node value
+ * on failure.
+ *
+ * ERRORS
+ * rpma_peer_get_numa_node() can fail with the following error:
+ *
+ * - RPMA_E_INVAL - peer or node is NULL
+ *
+ * SEE ALSO
+ * rpma_conn_cfg_set_numa_node(3), rpma_peer_new(3), librpma(7) and
+ * https://pmem.io/rpma/
+ */
+int rpma_peer_get_numa_node(const struct rpma_peer *peer, int *node);
+
 /* memory-related structures */
 
 struct rpma_mr_local;
@@ -820,6 +1114,7 @@ struct rpma_mr_remote;
 #define RPMA_MR_USAGE_FLUSH_TYPE_PERSISTENT	(1 << 5)
 #define RPMA_MR_USAGE_SEND			(1 << 6)
 #define RPMA_MR_USAGE_RECV			(1 << 7)
+#define RPMA_MR_USAGE_ATOMIC			(1 << 8)
 
 /** 3
  * rpma_mr_reg - create a local memory registration object
@@ -849,6 +1144,8 @@ struct rpma_mr_remote;
  * persistent flush operation
  * - RPMA_MR_USAGE_SEND - memory used for send operation
  * - RPMA_MR_USAGE_RECV - memory used for receive operation
+ * - RPMA_MR_USAGE_ATOMIC - memory used as a target of the remote atomic
+ * operations (rpma_compare_and_swap(3) and rpma_fetch_and_add(3))
  *
  * RETURN VALUE
  * The rpma_mr_reg() function returns 0 on success or a negative error code
@@ -863,10 +1160,10 @@ struct rpma_mr_remote;
  * - RPMA_E_PROVIDER - memory registration failed
  *
  * SEE ALSO
- * rpma_conn_req_recv(3), rpma_mr_dereg(3), rpma_mr_get_descriptor(3),
- * rpma_mr_get_descriptor_size(3), rpma_peer_new(3), rpma_read(3), rpma_recv(3),
- * rpma_send(3), rpma_write(3), rpma_write_atomic(3), librpma(7) and
- * https://pmem.io/rpma/
+ * rpma_compare_and_swap(3), rpma_conn_req_recv(3), rpma_fetch_and_add(3),
+ * rpma_mr_dereg(3), rpma_mr_get_descriptor(3), rpma_mr_get_descriptor_size(3),
+ * rpma_peer_new(3), rpma_read(3), rpma_recv(3), rpma_send(3), rpma_write(3),
+ * rpma_write_atomic(3), librpma(7) and https://pmem.io/rpma/
  */
 int rpma_mr_reg(struct rpma_peer *peer, void *ptr, size_t size,
 		int usage, struct rpma_mr_local **mr_ptr);
@@ -1451,947 +1748,5832 @@ int rpma_conn_cfg_set_rq_size(struct rpma_conn_cfg *cfg, uint32_t rq_size);
 int rpma_conn_cfg_get_rq_size(const struct rpma_conn_cfg *cfg,
 		uint32_t *rq_size);
 
-/* connection */
-
-struct rpma_conn;
+enum rpma_conn_thread_mode {
+	RPMA_CONN_THREAD_SINGLE,	/* posting serialized by the user */
+	RPMA_CONN_THREAD_SAFE,		/* posting via a submission ring */
+	RPMA_CONN_THREAD_LOCKLESS	/* direct posting from all threads */
+};
 
 /** 3
- * rpma_conn_get_event_fd - get an event file descriptor of the connection
+ * rpma_conn_cfg_set_thread_mode - set the threading mode of the connection
  *
  * SYNOPSIS
  *
  *	#include <librpma.h>
  *
- *	struct rpma_conn;
- *	int rpma_conn_get_event_fd(const struct rpma_conn *conn, int *fd);
+ *	struct rpma_conn_cfg;
+ *	enum rpma_conn_thread_mode {
+ *		RPMA_CONN_THREAD_SINGLE,
+ *		RPMA_CONN_THREAD_SAFE,
+ *		RPMA_CONN_THREAD_LOCKLESS
+ *	};
+ *
+ *	int rpma_conn_cfg_set_thread_mode(struct rpma_conn_cfg *cfg,
+ *			enum rpma_conn_thread_mode mode);
  *
  * DESCRIPTION
- * rpma_conn_get_event_fd() gets an event file descriptor of the connection.
+ * rpma_conn_cfg_set_thread_mode() sets the threading mode of the connection
+ * which determines how operations posted concurrently from many threads
+ * are handed over to the RDMA-capable network interface:
+ *
+ * - RPMA_CONN_THREAD_SINGLE - posting to the connection is not synchronized
+ * by the library. Each operation is posted directly by the calling thread.
+ * This is the default mode.
+ * - RPMA_CONN_THREAD_SAFE - all operations except rpma_flush(3) and
+ * rpma_recv(3) are placed in a lock-free multi-producer submission ring
+ * of the connection. One of the posting threads at a time takes the role
+ * of the poster and posts all the operations collected in the ring
+ * as a single batch. The posting thread returns only after its operation
+ * has been actually posted so the returned value reflects the result
+ * of the posting. rpma_flush(3) and rpma_recv(3) are posted by the poster
+ * after the submission ring is drained.
+ * - RPMA_CONN_THREAD_LOCKLESS - each operation is posted directly by
+ * the calling thread without any synchronization on the library side.
+ * This mode is intended for providers which are thread-safe on their own.
+ *
+ * In both RPMA_CONN_THREAD_SAFE and RPMA_CONN_THREAD_LOCKLESS modes
+ * completions can be routed to the threads which have posted the respective
+ * operations (see rpma_conn_thread_attach(3)).
+ *
+ * The size of the submission ring is equal to the SQ size of
+ * the connection rounded up to the nearest power of 2.
  *
  * RETURN VALUE
- * The rpma_conn_get_event_fd() function returns 0 on success or a negative
- * error code on failure. rpma_conn_get_event_fd() does not set
- * *fd value on failure.
+ * The rpma_conn_cfg_set_thread_mode() function returns 0 on success
+ * or a negative error code on failure.
  *
  * ERRORS
- * rpma_conn_get_event_fd() can fail with the following error:
+ * rpma_conn_cfg_set_thread_mode() can fail with the following error:
  *
- * - RPMA_E_INVAL - conn or fd is NULL
+ * - RPMA_E_INVAL - cfg is NULL or mode is unknown
  *
  * SEE ALSO
- * rpma_conn_next_event(3), rpma_conn_req_connect(3), librpma(7) and
- * https://pmem.io/rpma/
+ * rpma_conn_cfg_get_thread_mode(3), rpma_conn_cfg_new(3),
+ * rpma_conn_thread_attach(3), librpma(7) and https://pmem.io/rpma/
  */
-int rpma_conn_get_event_fd(const struct rpma_conn *conn, int *fd);
-
-enum rpma_conn_event {
-	RPMA_CONN_UNDEFINED = -1,	/* Undefined connection event */
-	RPMA_CONN_ESTABLISHED,		/* Connection established */
-	RPMA_CONN_CLOSED,			/* Connection closed */
-	RPMA_CONN_LOST,				/* Connection lost */
-	RPMA_CONN_REJECTED			/* Connection rejected */
-};
+int rpma_conn_cfg_set_thread_mode(struct rpma_conn_cfg *cfg,
+		enum rpma_conn_thread_mode mode);
 
 /** 3
- * rpma_conn_next_event - obtain a connection status
+ * rpma_conn_cfg_get_thread_mode - get the threading mode of the connection
  *
  * SYNOPSIS
  *
  *	#include <librpma.h>
  *
- *	struct rpma_conn;
- *	enum rpma_conn_event {
- *		RPMA_CONN_UNDEFINED = -1,
- *		RPMA_CONN_ESTABLISHED,
- *		RPMA_CONN_CLOSED,
- *		RPMA_CONN_LOST,
- *		RPMA_CONN_REJECTED,
+ *	struct rpma_conn_cfg;
+ *	enum rpma_conn_thread_mode {
+ *		RPMA_CONN_THREAD_SINGLE,
+ *		RPMA_CONN_THREAD_SAFE,
+ *		RPMA_CONN_THREAD_LOCKLESS
  *	};
  *
- *	int rpma_conn_next_event(struct rpma_conn *conn,
- *			enum rpma_conn_event *event);
+ *	int rpma_conn_cfg_get_thread_mode(const struct rpma_conn_cfg *cfg,
+ *			enum rpma_conn_thread_mode *mode);
  *
  * DESCRIPTION
- * rpma_conn_next_event() obtains the next event from the connection.
- * Types of events:
- * - RPMA_CONN_UNDEFINED - undefined connection event
- * - RPMA_CONN_ESTABLISHED - connection established
- * - RPMA_CONN_CLOSED - connection closed
- * - RPMA_CONN_LOST - connection lost
- * - RPMA_CONN_REJECTED - connection rejected
+ * rpma_conn_cfg_get_thread_mode() gets the threading mode of the connection.
  *
  * RETURN VALUE
- * The rpma_conn_next_event() function returns 0 on success or a negative
- * error code on failure.
+ * The rpma_conn_cfg_get_thread_mode() function returns 0 on success
+ * or a negative error code on failure. rpma_conn_cfg_get_thread_mode() does
+ * not set *mode value on failure.
  *
  * ERRORS
- * rpma_conn_next_event() can fail with the following errors:
+ * rpma_conn_cfg_get_thread_mode() can fail with the following error:
  *
- * - RPMA_E_INVAL - conn or event is NULL
- * - RPMA_E_UNKNOWN - unexpected event
- * - RPMA_E_PROVIDER - rdma_get_cm_event() or rdma_ack_cm_event() failed
- * - RPMA_E_NOMEM - out of memory
+ * - RPMA_E_INVAL - cfg or mode is NULL
  *
  * SEE ALSO
- * rpma_conn_req_connect(3), rpma_conn_disconnect(3), librpma(7) and
+ * rpma_conn_cfg_new(3), rpma_conn_cfg_set_thread_mode(3), librpma(7) and
  * https://pmem.io/rpma/
  */
-int rpma_conn_next_event(struct rpma_conn *conn, enum rpma_conn_event *event);
+int rpma_conn_cfg_get_thread_mode(const struct rpma_conn_cfg *cfg,
+		enum rpma_conn_thread_mode *mode);
+
+/* use the completion vector derived from the CPU of the calling thread */
+#define RPMA_COMP_VECTOR_AUTO	(-1)
 
 /** 3
- * rpma_utils_conn_event_2str - convert RPMA_CONN_* enum to a string
+ * rpma_conn_cfg_set_comp_vector - set the completion vector of the CQ
  *
  * SYNOPSIS
  *
  *	#include <librpma.h>
  *
- *	const char *rpma_utils_conn_event_2str(enum rpma_conn_event conn_event);
- *
- *	enum rpma_conn_event{
- *		RPMA_CONN_UNDEFINED = -1,
- *		RPMA_CONN_ESTABLISHED,
- *		RPMA_CONN_CLOSED,
- *		RPMA_CONN_LOST
- *	};
+ *	struct rpma_conn_cfg;
+ *	int rpma_conn_cfg_set_comp_vector(struct rpma_conn_cfg *cfg,
+ *			int comp_vector);
  *
  * DESCRIPTION
- * rpma_utils_conn_event_2str() converts RPMA_CONN_* enum to the const string
- * representation.
+ * rpma_conn_cfg_set_comp_vector() sets the completion vector the connection's
+ * completion queue (CQ) is bound to. The completion vector determines which
+ * interrupt (and thus which CPU core) signals the completion events
+ * the rpma_conn_completion_wait(3) waits for. The valid values are from
+ * 0 to the number of completion vectors of the device minus 1
+ * (see ibv_create_cq(3)). The special value RPMA_COMP_VECTOR_AUTO selects
+ * the completion vector derived from the CPU the thread creating
+ * the connection runs on. The default value is 0.
  *
  * RETURN VALUE
- * The rpma_utils_conn_event_2str() function returns the const string
- * representation of RPMA_CONN_* enums.
+ * The rpma_conn_cfg_set_comp_vector() function returns 0 on success
+ * or a negative error code on failure.
  *
  * ERRORS
- * rpma_utils_conn_event_2str() can not fail.
+ * rpma_conn_cfg_set_comp_vector() can fail with the following error:
+ *
+ * - RPMA_E_INVAL - cfg is NULL or comp_vector is negative and it is not
+ *   RPMA_COMP_VECTOR_AUTO
  *
  * SEE ALSO
- * rpma_conn_next_event(3), librpma(7) and https://pmem.io/rpma/
+ * rpma_conn_cfg_get_comp_vector(3), rpma_conn_cfg_new(3),
+ * rpma_conn_cfg_set_numa_node(3), librpma(7) and https://pmem.io/rpma/
  */
-const char *rpma_utils_conn_event_2str(enum rpma_conn_event conn_event);
-
-struct rpma_conn_private_data {
-	void *ptr;
-	uint8_t len;
-};
+int rpma_conn_cfg_set_comp_vector(struct rpma_conn_cfg *cfg, int comp_vector);
 
 /** 3
- * rpma_conn_get_private_data - get a pointer to the connection's private data
+ * rpma_conn_cfg_get_comp_vector - get the completion vector of the CQ
  *
  * SYNOPSIS
  *
  *	#include <librpma.h>
  *
- *	struct rpma_conn;
- *	struct rpma_conn_private_data;
- *	int rpma_conn_get_private_data(const struct rpma_conn *conn,
- *			struct rpma_conn_private_data *pdata);
+ *	struct rpma_conn_cfg;
+ *	int rpma_conn_cfg_get_comp_vector(const struct rpma_conn_cfg *cfg,
+ *			int *comp_vector);
  *
  * DESCRIPTION
- * rpma_conn_get_private_data() obtains the pointer to the private data
- * given by the other side of the connection.
+ * rpma_conn_cfg_get_comp_vector() gets the completion vector of
+ * the connection's completion queue (CQ). It may be RPMA_COMP_VECTOR_AUTO.
  *
  * RETURN VALUE
- * The rpma_conn_get_private_data() function returns 0 on success or a negative
- * error code on failure. rpma_conn_get_private_data() does not set
- * *pdata value on failure.
+ * The rpma_conn_cfg_get_comp_vector() function returns 0 on success
+ * or a negative error code on failure. rpma_conn_cfg_get_comp_vector() does
+ * not set *comp_vector value on failure.
  *
  * ERRORS
- * rpma_conn_get_private_data() can fail with the following error:
+ * rpma_conn_cfg_get_comp_vector() can fail with the following error:
  *
- * - RPMA_E_INVAL - conn or pdata is NULL
+ * - RPMA_E_INVAL - cfg or comp_vector is NULL
  *
  * SEE ALSO
- * rpma_conn_req_connect(3), librpma(7) and https://pmem.io/rpma/
+ * rpma_conn_cfg_new(3), rpma_conn_cfg_set_comp_vector(3), librpma(7) and
+ * https://pmem.io/rpma/
  */
-int rpma_conn_get_private_data(const struct rpma_conn *conn,
-		struct rpma_conn_private_data *pdata);
+int rpma_conn_cfg_get_comp_vector(const struct rpma_conn_cfg *cfg,
+		int *comp_vector);
+
+/* no NUMA node preferred */
+#define RPMA_NUMA_NODE_ANY	(-1)
 
 /** 3
- * rpma_conn_apply_remote_peer_cfg - apply remote peer cfg to the connection
+ * rpma_conn_cfg_set_numa_node - set the NUMA node of the connection's
+ * resources
  *
  * SYNOPSIS
  *
  *	#include <librpma.h>
  *
- *	struct rpma_conn;
- *	struct rpma_peer_cfg;
- *	int rpma_conn_apply_remote_peer_cfg(struct rpma_conn *conn,
- *			const struct rpma_peer_cfg *pcfg);
+ *	struct rpma_conn_cfg;
+ *	int rpma_conn_cfg_set_numa_node(struct rpma_conn_cfg *cfg, int node);
  *
  * DESCRIPTION
- * rpma_conn_apply_remote_peer_cfg() applies the remote peer configuration
- * to the connection.
+ * rpma_conn_cfg_set_numa_node() sets the NUMA node the memory of
+ * the connection's internal buffers and queues (CQ, QP and the buffers
+ * allocated by the library for the connection) is preferably allocated on.
+ * Usually it is the NUMA node local to the RDMA-capable network interface
+ * (see rpma_peer_get_numa_node(3)) or the one the consuming threads run on.
+ * The placement is a best-effort one: if the memory policy of the calling
+ * thread cannot be changed the memory is allocated according to the current
+ * policy. The default value RPMA_NUMA_NODE_ANY means no preference.
  *
  * RETURN VALUE
- * The rpma_conn_apply_remote_peer_cfg() function returns 0 on success
- * or a negative error code on failure. rpma_conn_apply_remote_peer_cfg()
- * does not set *pcfg value on failure.
+ * The rpma_conn_cfg_set_numa_node() function returns 0 on success
+ * or a negative error code on failure.
  *
  * ERRORS
- * rpma_conn_apply_remote_peer_cfg() can fail with the following error:
+ * rpma_conn_cfg_set_numa_node() can fail with the following error:
  *
- * - RPMA_E_INVAL - conn or pcfg are NULL
+ * - RPMA_E_INVAL - cfg is NULL or node is negative and it is not
+ *   RPMA_NUMA_NODE_ANY
  *
  * SEE ALSO
- * rpma_conn_req_connect(3), rpma_peer_cfg_new(3), librpma(7) and
- * https://pmem.io/rpma/
+ * rpma_conn_cfg_get_numa_node(3), rpma_conn_cfg_new(3),
+ * rpma_peer_get_numa_node(3), librpma(7) and https://pmem.io/rpma/
  */
-int rpma_conn_apply_remote_peer_cfg(struct rpma_conn *conn,
-		const struct rpma_peer_cfg *pcfg);
+int rpma_conn_cfg_set_numa_node(struct rpma_conn_cfg *cfg, int node);
 
 /** 3
- * rpma_conn_disconnect - tear the connection down
+ * rpma_conn_cfg_get_numa_node - get the NUMA node of the connection's
+ * resources
  *
  * SYNOPSIS
  *
  *	#include <librpma.h>
  *
- *	struct rpma_conn;
- *	int rpma_conn_disconnect(struct rpma_conn *conn);
+ *	struct rpma_conn_cfg;
+ *	int rpma_conn_cfg_get_numa_node(const struct rpma_conn_cfg *cfg,
+ *			int *node);
  *
  * DESCRIPTION
- * rpma_conn_disconnect() tears the connection down.
- *
- * - It may initiate disconnecting the connection. In this case,
- * the end of disconnecting is signalled by the RPMA_CONN_CLOSED event via
- * rpma_conn_next_event() or
- * - It may be called after receiving the RPMA_CONN_CLOSED event. In this case,
- * the disconnection is done when rpma_conn_disconnect() returns with success.
+ * rpma_conn_cfg_get_numa_node() gets the NUMA node the connection's
+ * internal buffers and queues are preferably allocated on.
  *
  * RETURN VALUE
- * The rpma_conn_disconnect() function returns 0 on success or a negative
- * error code on failure.
+ * The rpma_conn_cfg_get_numa_node() function returns 0 on success
+ * or a negative error code on failure. rpma_conn_cfg_get_numa_node() does
+ * not set *node value on failure.
  *
  * ERRORS
- * rpma_conn_disconnect() can fail with the following errors:
+ * rpma_conn_cfg_get_numa_node() can fail with the following error:
  *
- * - RPMA_E_INVAL - conn is NULL
- * - RPMA_E_PROVIDER - rdma_disconnect() failed
+ * - RPMA_E_INVAL - cfg or node is NULL
  *
  * SEE ALSO
- * rpma_conn_delete(3), rpma_conn_next_event(3), rpma_conn_req_connect(3),
- * librpma(7) and https://pmem.io/rpma/
+ * rpma_conn_cfg_new(3), rpma_conn_cfg_set_numa_node(3), librpma(7) and
+ * https://pmem.io/rpma/
  */
-int rpma_conn_disconnect(struct rpma_conn *conn);
+int rpma_conn_cfg_get_numa_node(const struct rpma_conn_cfg *cfg, int *node);
+
+/* the statistics collected by a connection */
+#define RPMA_STATS_COUNTERS	(1 << 0)
+#define RPMA_STATS_LATENCY	(1 << 1)
 
 /** 3
- * rpma_conn_delete - delete already closed connection
+ * rpma_conn_cfg_set_stats - set the statistics collected by the connection
  *
  * SYNOPSIS
  *
  *	#include <librpma.h>
  *
- *	struct rpma_conn;
- *	int rpma_conn_delete(struct rpma_conn **conn_ptr);
+ *	struct rpma_conn_cfg;
+ *	int rpma_conn_cfg_set_stats(struct rpma_conn_cfg *cfg, int stats);
  *
  * DESCRIPTION
- * rpma_conn_delete() deletes already closed connection.
+ * rpma_conn_cfg_set_stats() sets the performance statistics collected by
+ * the connection created using the configuration. The stats is a bitmask of:
+ *
+ * - RPMA_STATS_COUNTERS - count the operations and the bytes posted by type,
+ *   the posting calls, the completions collected, the empty polls,
+ *   the wake-ups of the completion channel and the failed completions
+ * - RPMA_STATS_LATENCY - collect also the histograms of the latencies of
+ *   the operations by type (see rpma_conn_get_stats(3))
+ *
+ * The latency is measured only for the operations posted and collected via
+ * the connection's API. The queue pair and the completion queue of such
+ * a connection cannot be used directly (e.g. by rpma_ring_new(3),
+ * rpma_op_template_new(3) or rpma_conn_get_fast(3)). The latency is not
+ * collected by a connection working in a thread-safe mode (see
+ * rpma_conn_cfg_set_thread_mode(3)). The default value 0 means no statistics
+ * are collected and collecting them does not cost anything.
  *
  * RETURN VALUE
- * The rpma_conn_delete() function returns 0 on success or a negative error code
- * on failure. rpma_conn_delete() sets *conn_ptr value to NULL on success and on
- * failure.
+ * The rpma_conn_cfg_set_stats() function returns 0 on success
+ * or a negative error code on failure.
  *
  * ERRORS
- * rpma_conn_delete() can fail with the following errors:
- * - RPMA_E_INVAL - conn_ptr is NULL or munmap() failed
- * - RPMA_E_PROVIDER - ibv_destroy_cq() or rdma_destroy_id() failed
+ * rpma_conn_cfg_set_stats() can fail with the following error:
+ *
+ * - RPMA_E_INVAL - cfg is NULL or stats has an unknown bit set
  *
  * SEE ALSO
- * rpma_conn_disconnect(3), rpma_conn_req_connect(3), librpma(7) and
- * https://pmem.io/rpma/
+ * rpma_conn_cfg_get_stats(3), rpma_conn_cfg_new(3), rpma_conn_get_stats(3),
+ * rpma_peer_get_stats(3), librpma(7) and https://pmem.io/rpma/
  */
-int rpma_conn_delete(struct rpma_conn **conn_ptr);
-
-/* incoming / outgoing connection request */
-
-struct rpma_conn_req;
+int rpma_conn_cfg_set_stats(struct rpma_conn_cfg *cfg, int stats);
 
 /** 3
- * rpma_conn_req_new - create a new outgoing connection request object
+ * rpma_conn_cfg_get_stats - get the statistics collected by the connection
  *
  * SYNOPSIS
  *
  *	#include <librpma.h>
  *
- *	struct rpma_peer;
  *	struct rpma_conn_cfg;
- *	struct rpma_conn_req;
- *	int rpma_conn_req_new(struct rpma_peer *peer, const char *addr,
- *			const char *port, const struct rpma_conn_cfg *cfg,
- *			struct rpma_conn_req **req_ptr);
+ *	int rpma_conn_cfg_get_stats(const struct rpma_conn_cfg *cfg,
+ *			int *stats);
  *
  * DESCRIPTION
- * rpma_conn_req_new() creates a new outgoing connection request object
- * using reliable, connection-oriented
- * and message-based (RDMA_PS_TCP) QP communication.
+ * rpma_conn_cfg_get_stats() gets the bitmask of the performance statistics
+ * collected by the connection created using the configuration.
  *
  * RETURN VALUE
- * The rpma_conn_req_new() function returns 0 on success or a negative
- * error code on failure. rpma_conn_req_new() does not set
- * *req_ptr value on failure.
+ * The rpma_conn_cfg_get_stats() function returns 0 on success
+ * or a negative error code on failure. rpma_conn_cfg_get_stats() does
+ * not set *stats value on failure.
  *
  * ERRORS
- * rpma_conn_req_new() can fail with the following errors:
+ * rpma_conn_cfg_get_stats() can fail with the following error:
  *
- * - RPMA_E_INVAL - peer, addr, port or req_ptr is NULL
- * - RPMA_E_NOMEM - out of memory
- * - RPMA_E_PROVIDER - rdma_create_id(3), rdma_resolve_addr(3),
- *   rdma_resolve_route(3) or ibv_create_cq(3) failed
+ * - RPMA_E_INVAL - cfg or stats is NULL
  *
  * SEE ALSO
- * rpma_conn_cfg_new(3), rpma_conn_req_connect(3), rpma_conn_req_delete(3),
- * rpma_conn_req_recv(3), rpma_ep_next_conn_req(3), rpma_peer_new(3), librpma(7)
- * and https://pmem.io/rpma/
+ * rpma_conn_cfg_new(3), rpma_conn_cfg_set_stats(3), librpma(7) and
+ * https://pmem.io/rpma/
  */
-int rpma_conn_req_new(struct rpma_peer *peer, const char *addr,
-		const char *port, const struct rpma_conn_cfg *cfg,
-		struct rpma_conn_req **req_ptr);
+int rpma_conn_cfg_get_stats(const struct rpma_conn_cfg *cfg, int *stats);
 
 /** 3
- * rpma_conn_req_delete - delete the connection requests
+ * rpma_conn_cfg_set_timestamps - set if the completions are timestamped
+ * by the device
  *
  * SYNOPSIS
  *
  *	#include <librpma.h>
  *
- *	struct rpma_conn_req;
- *	int rpma_conn_req_delete(struct rpma_conn_req **req_ptr);
+ *	struct rpma_conn_cfg;
+ *	int rpma_conn_cfg_set_timestamps(struct rpma_conn_cfg *cfg,
+ *			bool timestamps);
  *
  * DESCRIPTION
- * rpma_conn_req_delete() deletes the connection requests both
- * incoming and outgoing.
+ * rpma_conn_cfg_set_timestamps() sets if the completion queue of
+ * the connection created using the configuration is asked to timestamp
+ * the completions by the device (see ibv_create_cq_ex(3)). The timestamps
+ * are in the wallclock domain if the device supports it. If the device does
+ * not timestamp the completions at all the connection is created anyway and
+ * the completions are timestamped by software when they are collected.
+ * The timestamps are returned by rpma_conn_completion_get_ex(3).
+ * The default value is false.
  *
  * RETURN VALUE
- * The rpma_conn_req_delete() function returns 0 on success or a negative
- * error code on failure. rpma_conn_req_delete() sets *req_ptr value to NULL
- * on success and on failure.
+ * The rpma_conn_cfg_set_timestamps() function returns 0 on success
+ * or a negative error code on failure.
  *
  * ERRORS
- * rpma_conn_req_delete() can fail with the following errors:
+ * rpma_conn_cfg_set_timestamps() can fail with the following error:
  *
- * - RPMA_E_INVAL - req_ptr is NULL
- * - RPMA_E_PROVIDER
- *	- rdma_destroy_qp(3) or ibv_destroy_cq(3) failed
- *	- rdma_reject(3) or rdma_ack_cm_event(3) failed (passive side only)
- *	- rdma_destroy_id(3) failed (active side only)
+ * - RPMA_E_INVAL - cfg is NULL
  *
  * SEE ALSO
- * rpma_conn_req_new(3), librpma(7) and https://pmem.io/rpma/
+ * rpma_conn_cfg_get_timestamps(3), rpma_conn_cfg_new(3),
+ * rpma_conn_completion_get_ex(3), librpma(7) and https://pmem.io/rpma/
  */
-int rpma_conn_req_delete(struct rpma_conn_req **req_ptr);
+int rpma_conn_cfg_set_timestamps(struct rpma_conn_cfg *cfg, bool timestamps);
 
 /** 3
- * rpma_conn_req_connect - initiate processing the connection request
+ * rpma_conn_cfg_get_timestamps - get if the completions are timestamped
+ * by the device
  *
  * SYNOPSIS
  *
  *	#include <librpma.h>
  *
- *	struct rpma_conn_req;
- *	struct rpma_conn_private_data;
- *	struct rpma_conn;
- *	int rpma_conn_req_connect(struct rpma_conn_req **req_ptr,
- *			const struct rpma_conn_private_data *pdata,
- *			struct rpma_conn **conn_ptr);
+ *	struct rpma_conn_cfg;
+ *	int rpma_conn_cfg_get_timestamps(const struct rpma_conn_cfg *cfg,
+ *			bool *timestamps);
  *
  * DESCRIPTION
- * rpma_conn_req_connect() initiates processing the connection requests both
- * incoming and outgoing. The end of processing is signalled by
- * the RPMA_CONN_ESTABLISHED event via rpma_conn_next_event().
+ * rpma_conn_cfg_get_timestamps() gets if the completion queue of
+ * the connection created using the configuration is asked to timestamp
+ * the completions by the device.
  *
  * RETURN VALUE
- * The rpma_conn_req_connect() function returns 0 on success or a negative error
- * code on failure. On success, the newly created connection object is stored in
- * *conn_ptr whereas *req_ptr is consumed and set to NULL. On failure,
- * rpma_conn_req_connect() does not set *conn_ptr whereas *req_ptr is consumed
- * and set to NULL.
+ * The rpma_conn_cfg_get_timestamps() function returns 0 on success
+ * or a negative error code on failure. rpma_conn_cfg_get_timestamps() does
+ * not set *timestamps value on failure.
  *
  * ERRORS
- * rpma_conn_req_connect() can fail with the following errors:
+ * rpma_conn_cfg_get_timestamps() can fail with the following error:
  *
- * - RPMA_E_INVAL - req_ptr, *req_ptr or conn_ptr is NULL
- * - RPMA_E_INVAL - pdata is not NULL whereas pdata->len == 0
- * - RPMA_E_NOMEM - out of memory
- * - RPMA_E_PROVIDER - initiating a connection request failed (active side only)
- * - RPMA_E_PROVIDER - accepting the connection request failed
- * (passive side only)
- * - RPMA_E_PROVIDER - freeing a communication event failed (passive side only)
+ * - RPMA_E_INVAL - cfg or timestamps is NULL
  *
  * SEE ALSO
- * rpma_conn_apply_remote_peer_cfg(3), rpma_conn_delete(3),
- * rpma_conn_disconnect(3), rpma_conn_get_completion_fd(3),
- * rpma_conn_get_event_fd(3), rpma_conn_get_private_data(3),
+ * rpma_conn_cfg_new(3), rpma_conn_cfg_set_timestamps(3), librpma(7) and
+ * https://pmem.io/rpma/
+ */
+int rpma_conn_cfg_get_timestamps(const struct rpma_conn_cfg *cfg,
+		bool *timestamps);
+
+struct rpma_srq;
+
+/** 3
+ * rpma_conn_cfg_set_srq - attach the connection to a shared receive queue
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_conn_cfg;
+ *	struct rpma_srq;
+ *	int rpma_conn_cfg_set_srq(struct rpma_conn_cfg *cfg,
+ *			struct rpma_srq *srq);
+ *
+ * DESCRIPTION
+ * rpma_conn_cfg_set_srq() sets the shared receive queue (SRQ) the connection
+ * created using the configuration will take its receive buffers from.
+ * A connection attached to an SRQ has no receive queue of its own so
+ * the RQ size of the configuration is ignored, rpma_recv(3) cannot be used
+ * and the completions of the receives are collected via
+ * rpma_srq_completion_get(3) instead of rpma_conn_completion_get(3).
+ * The SRQ has to outlive all the connections attached to it.
+ * The default value NULL means the connection uses its own receive queue.
+ *
+ * RETURN VALUE
+ * The rpma_conn_cfg_set_srq() function returns 0 on success
+ * or a negative error code on failure.
+ *
+ * ERRORS
+ * rpma_conn_cfg_set_srq() can fail with the following error:
+ *
+ * - RPMA_E_INVAL - cfg is NULL
+ *
+ * SEE ALSO
+ * rpma_conn_cfg_get_srq(3), rpma_conn_cfg_new(3), rpma_srq_new(3),
+ * librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_conn_cfg_set_srq(struct rpma_conn_cfg *cfg, struct rpma_srq *srq);
+
+/** 3
+ * rpma_conn_cfg_get_srq - get the shared receive queue of the connection
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_conn_cfg;
+ *	struct rpma_srq;
+ *	int rpma_conn_cfg_get_srq(const struct rpma_conn_cfg *cfg,
+ *			struct rpma_srq **srq_ptr);
+ *
+ * DESCRIPTION
+ * rpma_conn_cfg_get_srq() gets the shared receive queue the connection
+ * will be attached to. NULL means the connection uses its own receive queue.
+ *
+ * RETURN VALUE
+ * The rpma_conn_cfg_get_srq() function returns 0 on success
+ * or a negative error code on failure. rpma_conn_cfg_get_srq() does not set
+ * *srq_ptr value on failure.
+ *
+ * ERRORS
+ * rpma_conn_cfg_get_srq() can fail with the following error:
+ *
+ * - RPMA_E_INVAL - cfg or srq_ptr is NULL
+ *
+ * SEE ALSO
+ * rpma_conn_cfg_new(3), rpma_conn_cfg_set_srq(3), librpma(7) and
+ * https://pmem.io/rpma/
+ */
+int rpma_conn_cfg_get_srq(const struct rpma_conn_cfg *cfg,
+		struct rpma_srq **srq_ptr);
+
+/** 3
+ * rpma_conn_cfg_set_inline_size - set the maximum size of the inline data
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_conn_cfg;
+ *	int rpma_conn_cfg_set_inline_size(struct rpma_conn_cfg *cfg,
+ *			uint32_t inline_size);
+ *
+ * DESCRIPTION
+ * rpma_conn_cfg_set_inline_size() sets the maximum size of the data
+ * the connection created using the configuration is requested to be able
+ * to post inline, i.e. copied into the work request instead of being read
+ * from a registered memory region by the RDMA-capable network interface.
+ * The RDMA-capable network interface may provide more than requested and
+ * it may fail to create the connection if it is not capable of providing
+ * the requested size. Only rpma_bounce_write(3) and rpma_bounce_send(3)
+ * make use of the inline data. The default value 0 means the connection
+ * does not post any data inline.
+ *
+ * RETURN VALUE
+ * The rpma_conn_cfg_set_inline_size() function returns 0 on success
+ * or a negative error code on failure.
+ *
+ * ERRORS
+ * rpma_conn_cfg_set_inline_size() can fail with the following error:
+ *
+ * - RPMA_E_INVAL - cfg is NULL
+ *
+ * SEE ALSO
+ * rpma_bounce_new(3), rpma_conn_cfg_get_inline_size(3),
+ * rpma_conn_cfg_new(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_conn_cfg_set_inline_size(struct rpma_conn_cfg *cfg,
+		uint32_t inline_size);
+
+/** 3
+ * rpma_conn_cfg_get_inline_size - get the maximum size of the inline data
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_conn_cfg;
+ *	int rpma_conn_cfg_get_inline_size(const struct rpma_conn_cfg *cfg,
+ *			uint32_t *inline_size);
+ *
+ * DESCRIPTION
+ * rpma_conn_cfg_get_inline_size() gets the maximum size of the data
+ * the connection is requested to be able to post inline.
+ *
+ * RETURN VALUE
+ * The rpma_conn_cfg_get_inline_size() function returns 0 on success
+ * or a negative error code on failure. rpma_conn_cfg_get_inline_size() does
+ * not set *inline_size value on failure.
+ *
+ * ERRORS
+ * rpma_conn_cfg_get_inline_size() can fail with the following error:
+ *
+ * - RPMA_E_INVAL - cfg or inline_size is NULL
+ *
+ * SEE ALSO
+ * rpma_conn_cfg_new(3), rpma_conn_cfg_set_inline_size(3), librpma(7) and
+ * https://pmem.io/rpma/
+ */
+int rpma_conn_cfg_get_inline_size(const struct rpma_conn_cfg *cfg,
+		uint32_t *inline_size);
+
+/* connection */
+
+struct rpma_conn;
+
+/** 3
+ * rpma_conn_get_event_fd - get an event file descriptor of the connection
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_conn;
+ *	int rpma_conn_get_event_fd(const struct rpma_conn *conn, int *fd);
+ *
+ * DESCRIPTION
+ * rpma_conn_get_event_fd() gets an event file descriptor of the connection.
+ *
+ * RETURN VALUE
+ * The rpma_conn_get_event_fd() function returns 0 on success or a negative
+ * error code on failure. rpma_conn_get_event_fd() does not set
+ * *fd value on failure.
+ *
+ * ERRORS
+ * rpma_conn_get_event_fd() can fail with the following error:
+ *
+ * - RPMA_E_INVAL - conn or fd is NULL
+ *
+ * SEE ALSO
+ * rpma_conn_next_event(3), rpma_conn_req_connect(3), librpma(7) and
+ * https://pmem.io/rpma/
+ */
+int rpma_conn_get_event_fd(const struct rpma_conn *conn, int *fd);
+
+enum rpma_conn_event {
+	RPMA_CONN_UNDEFINED = -1,	/* Undefined connection event */
+	RPMA_CONN_ESTABLISHED,		/* Connection established */
+	RPMA_CONN_CLOSED,			/* Connection closed */
+	RPMA_CONN_LOST,				/* Connection lost */
+	RPMA_CONN_REJECTED			/* Connection rejected */
+};
+
+/** 3
+ * rpma_conn_next_event - obtain a connection status
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_conn;
+ *	enum rpma_conn_event {
+ *		RPMA_CONN_UNDEFINED = -1,
+ *		RPMA_CONN_ESTABLISHED,
+ *		RPMA_CONN_CLOSED,
+ *		RPMA_CONN_LOST,
+ *		RPMA_CONN_REJECTED,
+ *	};
+ *
+ *	int rpma_conn_next_event(struct rpma_conn *conn,
+ *			enum rpma_conn_event *event);
+ *
+ * DESCRIPTION
+ * rpma_conn_next_event() obtains the next event from the connection.
+ * Types of events:
+ * - RPMA_CONN_UNDEFINED - undefined connection event
+ * - RPMA_CONN_ESTABLISHED - connection established
+ * - RPMA_CONN_CLOSED - connection closed
+ * - RPMA_CONN_LOST - connection lost
+ * - RPMA_CONN_REJECTED - connection rejected
+ *
+ * RETURN VALUE
+ * The rpma_conn_next_event() function returns 0 on success or a negative
+ * error code on failure.
+ *
+ * ERRORS
+ * rpma_conn_next_event() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - conn or event is NULL
+ * - RPMA_E_UNKNOWN - unexpected event
+ * - RPMA_E_PROVIDER - rdma_get_cm_event() or rdma_ack_cm_event() failed
+ * - RPMA_E_NOMEM - out of memory
+ *
+ * SEE ALSO
+ * rpma_conn_req_connect(3), rpma_conn_disconnect(3), librpma(7) and
+ * https://pmem.io/rpma/
+ */
+int rpma_conn_next_event(struct rpma_conn *conn, enum rpma_conn_event *event);
+
+/** 3
+ * rpma_utils_conn_event_2str - convert RPMA_CONN_* enum to a string
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	const char *rpma_utils_conn_event_2str(enum rpma_conn_event conn_event);
+ *
+ *	enum rpma_conn_event{
+ *		RPMA_CONN_UNDEFINED = -1,
+ *		RPMA_CONN_ESTABLISHED,
+ *		RPMA_CONN_CLOSED,
+ *		RPMA_CONN_LOST
+ *	};
+ *
+ * DESCRIPTION
+ * rpma_utils_conn_event_2str() converts RPMA_CONN_* enum to the const string
+ * representation.
+ *
+ * RETURN VALUE
+ * The rpma_utils_conn_event_2str() function returns the const string
+ * representation of RPMA_CONN_* enums.
+ *
+ * ERRORS
+ * rpma_utils_conn_event_2str() can not fail.
+ *
+ * SEE ALSO
+ * rpma_conn_next_event(3), librpma(7) and https://pmem.io/rpma/
+ */
+const char *rpma_utils_conn_event_2str(enum rpma_conn_event conn_event);
+
+struct rpma_conn_private_data {
+	void *ptr;
+	uint8_t len;
+};
+
+/** 3
+ * rpma_conn_get_private_data - get a pointer to the connection's private data
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_conn;
+ *	struct rpma_conn_private_data;
+ *	int rpma_conn_get_private_data(const struct rpma_conn *conn,
+ *			struct rpma_conn_private_data *pdata);
+ *
+ * DESCRIPTION
+ * rpma_conn_get_private_data() obtains the pointer to the private data
+ * given by the other side of the connection.
+ *
+ * RETURN VALUE
+ * The rpma_conn_get_private_data() function returns 0 on success or a negative
+ * error code on failure. rpma_conn_get_private_data() does not set
+ * *pdata value on failure.
+ *
+ * ERRORS
+ * rpma_conn_get_private_data() can fail with the following error:
+ *
+ * - RPMA_E_INVAL - conn or pdata is NULL
+ *
+ * SEE ALSO
+ * rpma_conn_req_connect(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_conn_get_private_data(const struct rpma_conn *conn,
+		struct rpma_conn_private_data *pdata);
+
+/** 3
+ * rpma_conn_apply_remote_peer_cfg - apply remote peer cfg to the connection
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_conn;
+ *	struct rpma_peer_cfg;
+ *	int rpma_conn_apply_remote_peer_cfg(struct rpma_conn *conn,
+ *			const struct rpma_peer_cfg *pcfg);
+ *
+ * DESCRIPTION
+ * rpma_conn_apply_remote_peer_cfg() applies the remote peer configuration
+ * to the connection.
+ *
+ * RETURN VALUE
+ * The rpma_conn_apply_remote_peer_cfg() function returns 0 on success
+ * or a negative error code on failure. rpma_conn_apply_remote_peer_cfg()
+ * does not set *pcfg value on failure.
+ *
+ * ERRORS
+ * rpma_conn_apply_remote_peer_cfg() can fail with the following error:
+ *
+ * - RPMA_E_INVAL - conn or pcfg are NULL
+ *
+ * SEE ALSO
+ * rpma_conn_req_connect(3), rpma_peer_cfg_new(3), librpma(7) and
+ * https://pmem.io/rpma/
+ */
+int rpma_conn_apply_remote_peer_cfg(struct rpma_conn *conn,
+		const struct rpma_peer_cfg *pcfg);
+
+/** 3
+ * rpma_conn_disconnect - tear the connection down
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_conn;
+ *	int rpma_conn_disconnect(struct rpma_conn *conn);
+ *
+ * DESCRIPTION
+ * rpma_conn_disconnect() tears the connection down.
+ *
+ * - It may initiate disconnecting the connection. In this case,
+ * the end of disconnecting is signalled by the RPMA_CONN_CLOSED event via
+ * rpma_conn_next_event() or
+ * - It may be called after receiving the RPMA_CONN_CLOSED event. In this case,
+ * the disconnection is done when rpma_conn_disconnect() returns with success.
+ *
+ * RETURN VALUE
+ * The rpma_conn_disconnect() function returns 0 on success or a negative
+ * error code on failure.
+ *
+ * ERRORS
+ * rpma_conn_disconnect() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - conn is NULL
+ * - RPMA_E_PROVIDER - rdma_disconnect() failed
+ *
+ * SEE ALSO
+ * rpma_conn_delete(3), rpma_conn_next_event(3), rpma_conn_req_connect(3),
+ * librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_conn_disconnect(struct rpma_conn *conn);
+
+/** 3
+ * rpma_conn_delete - delete already closed connection
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_conn;
+ *	int rpma_conn_delete(struct rpma_conn **conn_ptr);
+ *
+ * DESCRIPTION
+ * rpma_conn_delete() deletes already closed connection.
+ *
+ * RETURN VALUE
+ * The rpma_conn_delete() function returns 0 on success or a negative error code
+ * on failure. rpma_conn_delete() sets *conn_ptr value to NULL on success and on
+ * failure.
+ *
+ * ERRORS
+ * rpma_conn_delete() can fail with the following errors:
+ * - RPMA_E_INVAL - conn_ptr is NULL or munmap() failed
+ * - RPMA_E_PROVIDER - ibv_destroy_cq() or rdma_destroy_id() failed
+ *
+ * SEE ALSO
+ * rpma_conn_disconnect(3), rpma_conn_req_connect(3), librpma(7) and
+ * https://pmem.io/rpma/
+ */
+int rpma_conn_delete(struct rpma_conn **conn_ptr);
+
+/* incoming / outgoing connection request */
+
+struct rpma_conn_req;
+
+/** 3
+ * rpma_conn_req_new - create a new outgoing connection request object
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_peer;
+ *	struct rpma_conn_cfg;
+ *	struct rpma_conn_req;
+ *	int rpma_conn_req_new(struct rpma_peer *peer, const char *addr,
+ *			const char *port, const struct rpma_conn_cfg *cfg,
+ *			struct rpma_conn_req **req_ptr);
+ *
+ * DESCRIPTION
+ * rpma_conn_req_new() creates a new outgoing connection request object
+ * using reliable, connection-oriented
+ * and message-based (RDMA_PS_TCP) QP communication.
+ *
+ * RETURN VALUE
+ * The rpma_conn_req_new() function returns 0 on success or a negative
+ * error code on failure. rpma_conn_req_new() does not set
+ * *req_ptr value on failure.
+ *
+ * ERRORS
+ * rpma_conn_req_new() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - peer, addr, port or req_ptr is NULL
+ * - RPMA_E_NOMEM - out of memory
+ * - RPMA_E_PROVIDER - rdma_create_id(3), rdma_resolve_addr(3),
+ *   rdma_resolve_route(3) or ibv_create_cq(3) failed
+ *
+ * SEE ALSO
+ * rpma_conn_cfg_new(3), rpma_conn_req_connect(3), rpma_conn_req_delete(3),
+ * rpma_conn_req_recv(3), rpma_ep_next_conn_req(3), rpma_peer_new(3), librpma(7)
+ * and https://pmem.io/rpma/
+ */
+int rpma_conn_req_new(struct rpma_peer *peer, const char *addr,
+		const char *port, const struct rpma_conn_cfg *cfg,
+		struct rpma_conn_req **req_ptr);
+
+/** 3
+ * rpma_conn_req_delete - delete the connection requests
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_conn_req;
+ *	int rpma_conn_req_delete(struct rpma_conn_req **req_ptr);
+ *
+ * DESCRIPTION
+ * rpma_conn_req_delete() deletes the connection requests both
+ * incoming and outgoing.
+ *
+ * RETURN VALUE
+ * The rpma_conn_req_delete() function returns 0 on success or a negative
+ * error code on failure. rpma_conn_req_delete() sets *req_ptr value to NULL
+ * on success and on failure.
+ *
+ * ERRORS
+ * rpma_conn_req_delete() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - req_ptr is NULL
+ * - RPMA_E_PROVIDER
+ *	- rdma_destroy_qp(3) or ibv_destroy_cq(3) failed
+ *	- rdma_reject(3) or rdma_ack_cm_event(3) failed (passive side only)
+ *	- rdma_destroy_id(3) failed (active side only)
+ *
+ * SEE ALSO
+ * rpma_conn_req_new(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_conn_req_delete(struct rpma_conn_req **req_ptr);
+
+/** 3
+ * rpma_conn_req_connect - initiate processing the connection request
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_conn_req;
+ *	struct rpma_conn_private_data;
+ *	struct rpma_conn;
+ *	int rpma_conn_req_connect(struct rpma_conn_req **req_ptr,
+ *			const struct rpma_conn_private_data *pdata,
+ *			struct rpma_conn **conn_ptr);
+ *
+ * DESCRIPTION
+ * rpma_conn_req_connect() initiates processing the connection requests both
+ * incoming and outgoing. The end of processing is signalled by
+ * the RPMA_CONN_ESTABLISHED event via rpma_conn_next_event().
+ *
+ * RETURN VALUE
+ * The rpma_conn_req_connect() function returns 0 on success or a negative error
+ * code on failure. On success, the newly created connection object is stored in
+ * *conn_ptr whereas *req_ptr is consumed and set to NULL. On failure,
+ * rpma_conn_req_connect() does not set *conn_ptr whereas *req_ptr is consumed
+ * and set to NULL.
+ *
+ * ERRORS
+ * rpma_conn_req_connect() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - req_ptr, *req_ptr or conn_ptr is NULL
+ * - RPMA_E_INVAL - pdata is not NULL whereas pdata->len == 0
+ * - RPMA_E_NOMEM - out of memory
+ * - RPMA_E_PROVIDER - initiating a connection request failed (active side only)
+ * - RPMA_E_PROVIDER - accepting the connection request failed
+ * (passive side only)
+ * - RPMA_E_PROVIDER - freeing a communication event failed (passive side only)
+ *
+ * SEE ALSO
+ * rpma_conn_apply_remote_peer_cfg(3), rpma_conn_delete(3),
+ * rpma_conn_disconnect(3), rpma_conn_get_completion_fd(3),
+ * rpma_conn_get_event_fd(3), rpma_conn_get_private_data(3),
  * rpma_conn_completion_get(3), rpma_conn_next_event(3),
  * rpma_conn_completion_wait(3), rpma_conn_req_new(3),
  * rpma_ep_next_conn_req(3), rpma_flush(3), rpma_read(3), rpma_recv(3),
  * rpma_send(3), rpma_write(3), rpma_write_atomic(3), librpma(7) and
  * https://pmem.io/rpma/
  */
-int rpma_conn_req_connect(struct rpma_conn_req **req_ptr,
-		const struct rpma_conn_private_data *pdata,
-		struct rpma_conn **conn_ptr);
+int rpma_conn_req_connect(struct rpma_conn_req **req_ptr,
+		const struct rpma_conn_private_data *pdata,
+		struct rpma_conn **conn_ptr);
+
+/** 3
+ * rpma_conn_req_recv - initiate the receive operation
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_conn_req;
+ *	struct rpma_mr_local;
+ *	int rpma_conn_req_recv(struct rpma_conn_req *req,
+ *			struct rpma_mr_local *dst, size_t offset,
+ *			size_t len, const void *op_context);
+ *
+ * DESCRIPTION
+ * rpma_conn_req_recv() initiates the receive operation. It prepares a buffer
+ * for a message sent from other side of the connection.
+ * Please see rpma_send(3). This is a variant of rpma_recv(3) which may be used
+ * before the connection is established.
+ *
+ * RETURN VALUE
+ * The rpma_conn_req_recv() function returns 0 on success or a negative
+ * error code on failure.
+ *
+ * ERRORS
+ * rpma_conn_req_recv() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - req or src or op_context is NULL
+ * - RPMA_E_PROVIDER - ibv_post_recv(3) failed
+ *
+ * SEE ALSO
+ * rpma_conn_req_new(3), rpma_mr_reg(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_conn_req_recv(struct rpma_conn_req *req,
+		struct rpma_mr_local *dst, size_t offset,
+		size_t len, const void *op_context);
+
+/* server-side setup */
+
+struct rpma_ep;
+
+/** 3
+ * rpma_ep_listen - create a listening endpoint
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_peer;
+ *	struct rpma_ep;
+ *	int rpma_ep_listen(struct rpma_peer *peer, const char *addr,
+ *			const char *port, struct rpma_ep **ep_ptr);
+ *
+ * DESCRIPTION
+ * rpma_ep_listen() creates an endpoint and initiates listening for incoming
+ * connections using reliable, connection-oriented and message-based
+ * (RDMA_PS_TCP) QP communication.
+ *
+ * RETURN VALUE
+ * The rpma_ep_listen() function returns 0 on success or a negative
+ * error code on failure. rpma_ep_listen() does not set
+ * *ep_ptr value on failure.
+ *
+ * ERRORS
+ * rpma_ep_listen() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - peer, addr, port or ep_ptr is NULL
+ * - RPMA_E_PROVIDER - rdma_create_event_channel(3), rdma_create_id(3),
+ *   rdma_getaddrinfo(3), rdma_listen(3) failed
+ * - RPMA_E_NOMEM - out of memory
+ *
+ * SEE ALSO
+ * rpma_ep_get_fd(3), rpma_ep_next_conn_req(3), rpma_ep_shutdown(3),
+ * rpma_peer_new(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_ep_listen(struct rpma_peer *peer, const char *addr,
+		const char *port, struct rpma_ep **ep_ptr);
+
+/** 3
+ * rpma_ep_shutdown - stop listening and delete the endpoint
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_ep;
+ *	int rpma_ep_shutdown(struct rpma_ep **ep_ptr);
+ *
+ * DESCRIPTION
+ * rpma_ep_shutdown() stops listening for incoming connections
+ * and deletes the endpoint. The connections established using the endpoint
+ * will still exist after deleting the endpoint.
+ *
+ * RETURN VALUE
+ * The rpma_ep_shutdown() function returns 0 on success or a negative
+ * error code on failure. rpma_ep_shutdown() does not set
+ * *ep_ptr value to NULL on failure.
+ *
+ * ERRORS
+ * rpma_ep_shutdown() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - ep_ptr is NULL
+ * - RPMA_E_PROVIDER - rdma_destroy_id(3) failed
+ *
+ * SEE ALSO
+ * rpma_ep_listen(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_ep_shutdown(struct rpma_ep **ep_ptr);
+
+/** 3
+ * rpma_ep_get_fd - get a file descriptor of the endpoint
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_ep;
+ *	int rpma_ep_get_fd(const struct rpma_ep *ep, int *fd);
+ *
+ * DESCRIPTION
+ * rpma_ep_get_fd() gets the file descriptor of the endpoint.
+ *
+ * RETURN VALUE
+ * The rpma_ep_get_fd() function returns 0 on success or a negative
+ * error code on failure. rpma_ep_get_fd() does not set
+ * *fd value on failure.
+ *
+ * ERRORS
+ * rpma_ep_get_fd() can fail with the following error:
+ *
+ * - RPMA_E_INVAL - ep or fd is NULL
+ *
+ * SEE ALSO
+ * rpma_ep_listen(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_ep_get_fd(const struct rpma_ep *ep, int *fd);
+
+/** 3
+ * rpma_ep_next_conn_req - obtain an incoming connection request
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_ep;
+ *	struct rpma_conn_cfg;
+ *	struct rpma_conn_req;
+ *	int rpma_ep_next_conn_req(struct rpma_ep *ep,
+ *			const struct rpma_conn_cfg *cfg,
+ *			struct rpma_conn_req **req_ptr);
+ *
+ * DESCRIPTION
+ * rpma_ep_next_conn_req() obtains the next connection request
+ * from the endpoint.
+ *
+ * RETURN VALUE
+ * The rpma_ep_next_conn_req() function returns 0 on success or a negative
+ * error code on failure. rpma_ep_next_conn_req() does not set
+ * *req_ptr value on failure.
+ *
+ * ERRORS
+ * rpma_ep_next_conn_req() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - ep or req_ptr is NULL
+ * - RPMA_E_INVAL - obtained an event different than a connection request
+ * - RPMA_E_PROVIDER - rdma_get_cm_event(3) failed
+ * - RPMA_E_NOMEM - out of memory
+ * - RPMA_E_NO_EVENT - no next connection request available
+ *
+ * SEE ALSO
+ * rpma_conn_cfg_new(3), rpma_conn_req_delete(3), rpma_conn_req_connect(3),
+ * rpma_ep_listen(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_ep_next_conn_req(struct rpma_ep *ep,
+		const struct rpma_conn_cfg *cfg,
+		struct rpma_conn_req **req_ptr);
+
+/** 3
+ * rpma_conn_req_get_private_data - get a pointer to the request's private data
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_conn_req;
+ *	struct rpma_conn_private_data;
+ *	int rpma_conn_req_get_private_data(const struct rpma_conn_req *req,
+ *			struct rpma_conn_private_data *pdata);
+ *
+ * DESCRIPTION
+ * rpma_conn_req_get_private_data() obtains the pointer to the connection's
+ * private data given by the other side of the connection before the connection
+ * is established.
+ *
+ * RETURN VALUE
+ * The rpma_conn_req_get_private_data() function returns 0 on success or
+ * a negative error code on failure. rpma_conn_req_get_private_data() does not
+ * set *pdata value on failure.
+ *
+ * ERRORS
+ * rpma_conn_req_get_private_data() can fail with the following error:
+ *
+ * - RPMA_E_INVAL - req or pdata is NULL
+ *
+ * SEE ALSO
+ * rpma_conn_get_private_data(3), rpma_ep_next_conn_req(3), librpma(7)
+ * and https://pmem.io/rpma/
+ */
+int rpma_conn_req_get_private_data(const struct rpma_conn_req *req,
+		struct rpma_conn_private_data *pdata);
+
+/* remote memory access functions */
+
+/* generate operation completion on error */
+#define RPMA_F_COMPLETION_ON_ERROR	(1 << 0)
+/* generate operation completion regardless of its result */
+#define RPMA_F_COMPLETION_ALWAYS	(1 << 1 | RPMA_F_COMPLETION_ON_ERROR)
+
+/** 3
+ * rpma_read - initiate the read operation
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_conn;
+ *	struct rpma_mr_local;
+ *	struct rpma_mr_remote;
+ *	int rpma_read(struct rpma_conn *conn,
+ *			struct rpma_mr_local *dst, size_t dst_offset,
+ *			const struct rpma_mr_remote *src,  size_t src_offset,
+ *			size_t len, int flags, const void *op_context);
+ *
+ * DESCRIPTION
+ * rpma_read() initiates transferring data from the remote memory
+ * to the local memory. The data is transferred by a single work request
+ * which is not split by the library so len cannot exceed UINT32_MAX.
+ * Longer reads can be initiated using rpma_xfer_read(3).
+ * To read a 0 bytes message, set src and dst to NULL
+ * and src_offset, dst_offset and len to 0.
+ * The attribute flags set the completion notification indicator:
+ * - RPMA_F_COMPLETION_ON_ERROR - generate the completion on error
+ * - RPMA_F_COMPLETION_ALWAYS - generate the completion regardless of result of
+ * the operation
+ *
+ * RETURN VALUE
+ * The rpma_read() function returns 0 on success or a negative
+ * error code on failure.
+ *
+ * ERRORS
+ * rpma_read() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - conn == NULL || flags == 0
+ * - RPMA_E_INVAL - len > UINT32_MAX (see rpma_xfer_new(3))
+ * - RPMA_E_INVAL - dst == NULL && (src != NULL || src_offset != 0
+ *                  || dst_offset != 0 || len != 0)
+ * - RPMA_E_INVAL - src == NULL && (dst != NULL || src_offset != 0
+ *                  || dst_offset != 0 || len != 0)
+ * - RPMA_E_PROVIDER - ibv_post_send(3) failed
+ *
+ * SEE ALSO
+ * rpma_conn_req_connect(3), rpma_mr_reg(3), rpma_mr_remote_from_descriptor(3),
+ * rpma_xfer_read(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_read(struct rpma_conn *conn,
+		struct rpma_mr_local *dst, size_t dst_offset,
+		const struct rpma_mr_remote *src,  size_t src_offset,
+		size_t len, int flags, const void *op_context);
+
+/* the number of the ordering domains of a connection */
+#define RPMA_ORDER_DOMAINS_MAX	32
+
+/** 3
+ * rpma_read_in_domain - initiate the read operation in the ordering domain
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_conn;
+ *	struct rpma_mr_local;
+ *	struct rpma_mr_remote;
+ *	int rpma_read_in_domain(struct rpma_conn *conn,
+ *			struct rpma_mr_local *dst, size_t dst_offset,
+ *			const struct rpma_mr_remote *src,  size_t src_offset,
+ *			size_t len, int flags, unsigned domain,
+ *			const void *op_context);
+ *
+ * DESCRIPTION
+ * rpma_read_in_domain() works like rpma_read(3) but the read operation
+ * is accounted only to the given ordering domain of the connection.
+ * Only the atomic write operations posted to the same ordering domain
+ * (see rpma_write_atomic_in_domain(3)) are ordered after it.
+ * The ordering domains are numbered from 0 to RPMA_ORDER_DOMAINS_MAX - 1.
+ * A read operation posted using rpma_read(3) belongs to all the ordering
+ * domains of the connection.
+ *
+ * RETURN VALUE
+ * The rpma_read_in_domain() function returns 0 on success or a negative
+ * error code on failure.
+ *
+ * ERRORS
+ * rpma_read_in_domain() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - conn == NULL || flags == 0
+ * - RPMA_E_INVAL - len > UINT32_MAX (see rpma_xfer_new(3))
+ * - RPMA_E_INVAL - domain >= RPMA_ORDER_DOMAINS_MAX
+ * - RPMA_E_INVAL - dst == NULL && (src != NULL || src_offset != 0
+ *                  || dst_offset != 0 || len != 0)
+ * - RPMA_E_INVAL - src == NULL && (dst != NULL || src_offset != 0
+ *                  || dst_offset != 0 || len != 0)
+ * - RPMA_E_PROVIDER - ibv_post_send(3) failed
+ *
+ * SEE ALSO
+ * rpma_read(3), rpma_write_atomic_in_domain(3), librpma(7) and
+ * https://pmem.io/rpma/
+ */
+int rpma_read_in_domain(struct rpma_conn *conn,
+		struct rpma_mr_local *dst, size_t dst_offset,
+		const struct rpma_mr_remote *src,  size_t src_offset,
+		size_t len, int flags, unsigned domain, const void *op_context);
+
+/** 3
+ * rpma_write - initiate the write operation
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_conn;
+ *	struct rpma_mr_local;
+ *	struct rpma_mr_remote;
+ *	int rpma_write(struct rpma_conn *conn,
+ *			struct rpma_mr_remote *dst, size_t dst_offset,
+ *			const struct rpma_mr_local *src,  size_t src_offset,
+ *			size_t len, int flags, const void *op_context);
+ *
+ * DESCRIPTION
+ * rpma_write() initiates transferring data from the local memory
+ * to the remote memory. The data is transferred by a single work request
+ * which is not split by the library so len cannot exceed UINT32_MAX.
+ * Longer writes can be initiated using rpma_xfer_write(3).
+ * To write a 0 bytes message, set src and dst to NULL
+ * and src_offset, dst_offset and len to 0.
+ * The attribute flags set the completion notification indicator:
+ * - RPMA_F_COMPLETION_ON_ERROR - generate the completion on error
+ * - RPMA_F_COMPLETION_ALWAYS - generate the completion regardless of result of
+ * the operation
+ *
+ * RETURN VALUE
+ * The rpma_write() function returns 0 on success or a negative
+ * error code on failure.
+ *
+ * ERRORS
+ * rpma_write() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - conn == NULL || flags == 0
+ * - RPMA_E_INVAL - len > UINT32_MAX (see rpma_xfer_new(3))
+ * - RPMA_E_INVAL - dst == NULL && (src != NULL || src_offset != 0
+ *                  || dst_offset != 0 || len != 0)
+ * - RPMA_E_INVAL - src == NULL && (dst != NULL || src_offset != 0
+ *                  || dst_offset != 0 || len != 0)
+ * - RPMA_E_PROVIDER - ibv_post_send(3) failed
+ *
+ * SEE ALSO
+ * rpma_conn_req_connect(3), rpma_mr_reg(3),
+ * rpma_mr_remote_from_descriptor(3), rpma_xfer_write(3), librpma(7)
+ * and https://pmem.io/rpma/
+ */
+int rpma_write(struct rpma_conn *conn,
+		struct rpma_mr_remote *dst, size_t dst_offset,
+		const struct rpma_mr_local *src,  size_t src_offset,
+		size_t len, int flags, const void *op_context);
+
+/** 3
+ * rpma_write_with_imm - initiate the write operation with immediate data
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_conn;
+ *	struct rpma_mr_local;
+ *	struct rpma_mr_remote;
+ *	int rpma_write_with_imm(struct rpma_conn *conn,
+ *			struct rpma_mr_remote *dst, size_t dst_offset,
+ *			const struct rpma_mr_local *src,  size_t src_offset,
+ *			size_t len, int flags, uint32_t imm,
+ *			const void *op_context);
+ *
+ * DESCRIPTION
+ * rpma_write_with_imm() initiates the write operation with immediate data
+ * (transferring data from the local memory to the remote memory.
+ * The immediate data comes with a single completion on the remote side
+ * so the write is never split by the library and len cannot exceed
+ * UINT32_MAX.
+ * To write a 0 bytes message, set src and dst to NULL
+ * and src_offset, dst_offset and len to 0.
+ * The attribute flags set the completion notification indicator:
+ * - RPMA_F_COMPLETION_ON_ERROR - generate the completion on error
+ * - RPMA_F_COMPLETION_ALWAYS - generate the completion regardless of result of
+ * the operation
+ *
+ * RETURN VALUE
+ * The rpma_write_with_imm() function returns 0 on success or a negative
+ * error code on failure.
+ *
+ * ERRORS
+ * rpma_write_with_imm() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - conn == NULL || flags == 0
+ * - RPMA_E_INVAL - len > UINT32_MAX (see rpma_xfer_new(3))
+ * - RPMA_E_INVAL - dst == NULL && (src != NULL || src_offset != 0
+ *                  || dst_offset != 0 || len != 0)
+ * - RPMA_E_INVAL - src == NULL && (dst != NULL || src_offset != 0
+ *                  || dst_offset != 0 || len != 0)
+ * - RPMA_E_PROVIDER - ibv_post_send(3) failed
+ *
+ * SEE ALSO
+ * rpma_conn_req_connect(3), rpma_mr_reg(3),
+ * rpma_mr_remote_from_descriptor(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_write_with_imm(struct rpma_conn *conn,
+		struct rpma_mr_remote *dst, size_t dst_offset,
+		const struct rpma_mr_local *src,  size_t src_offset,
+		size_t len, int flags, uint32_t imm, const void *op_context);
+
+#define RPMA_ATOMIC_WRITE_ALIGNMENT 8
+
+/** 3
+ * rpma_write_atomic - initiate the atomic write operation
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_conn;
+ *	struct rpma_mr_local;
+ *	struct rpma_mr_remote;
+ *	int rpma_write_atomic(struct rpma_conn *conn,
+ *			struct rpma_mr_remote *dst, size_t dst_offset,
+ *			const struct rpma_mr_local *src,  size_t src_offset,
+ *			int flags, const void *op_context);
+ *
+ * DESCRIPTION
+ * rpma_write_atomic() initiates the atomic write operation (transferring
+ * data from the local memory to the remote memory). The atomic write operation
+ * allows transferring 8 bytes of data (RPMA_ATOMIC_WRITE_ALIGNMENT) and storing
+ * them atomically in the remote memory.
+ * The atomic write operation is ordered after all the read, atomic
+ * and flush operations posted earlier to the connection. The library fences
+ * the atomic write operation only if any of them has been posted since
+ * the last fenced operation. The operations posted to a connection
+ * in the RPMA_CONN_THREAD_SAFE or RPMA_CONN_THREAD_LOCKLESS mode
+ * are always fenced (see rpma_conn_cfg_set_thread_mode(3)).
+ * The attribute flags set the completion notification indicator:
+ * - RPMA_F_COMPLETION_ON_ERROR - generate the completion on error
+ * - RPMA_F_COMPLETION_ALWAYS - generate the completion regardless of result of
+ * the operation
+ *
+ * RETURN VALUE
+ * The rpma_write_atomic() function returns 0 on success or a negative
+ * error code on failure.
+ *
+ * ERRORS
+ * rpma_write_atomic() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - conn, dst or src is NULL
+ * - RPMA_E_INVAL - dst_offset is not aligned to 8 bytes
+ * - RPMA_E_INVAL - flags are not set
+ * - RPMA_E_PROVIDER - ibv_post_send(3) failed
+ *
+ * SEE ALSO
+ * rpma_conn_req_connect(3), rpma_mr_reg(3),
+ * rpma_mr_remote_from_descriptor(3), rpma_write_atomic_in_domain(3),
+ * librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_write_atomic(struct rpma_conn *conn,
+		struct rpma_mr_remote *dst, size_t dst_offset,
+		const struct rpma_mr_local *src,  size_t src_offset,
+		int flags, const void *op_context);
+
+/** 3
+ * rpma_write_atomic_in_domain - initiate the atomic write operation
+ * ordered within the ordering domain
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_conn;
+ *	struct rpma_mr_local;
+ *	struct rpma_mr_remote;
+ *	int rpma_write_atomic_in_domain(struct rpma_conn *conn,
+ *			struct rpma_mr_remote *dst, size_t dst_offset,
+ *			const struct rpma_mr_local *src,  size_t src_offset,
+ *			int flags, unsigned domain, const void *op_context);
+ *
+ * DESCRIPTION
+ * rpma_write_atomic_in_domain() works like rpma_write_atomic(3) but
+ * the atomic write operation is ordered only after the read operations
+ * posted to the given ordering domain (see rpma_read_in_domain(3)) and after
+ * the read, atomic and flush operations posted without an ordering domain.
+ * The atomic write operation is fenced only if any of these operations has
+ * been posted since the last fenced operation. Since a fence orders
+ * the operation after all the earlier read and atomic operations
+ * of the connection, a fenced atomic write operation settles all
+ * the ordering domains at once.
+ * The ordering domains are numbered from 0 to RPMA_ORDER_DOMAINS_MAX - 1.
+ *
+ * RETURN VALUE
+ * The rpma_write_atomic_in_domain() function returns 0 on success
+ * or a negative error code on failure.
+ *
+ * ERRORS
+ * rpma_write_atomic_in_domain() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - conn, dst or src is NULL
+ * - RPMA_E_INVAL - dst_offset is not aligned to 8 bytes
+ * - RPMA_E_INVAL - flags are not set
+ * - RPMA_E_INVAL - domain >= RPMA_ORDER_DOMAINS_MAX
+ * - RPMA_E_PROVIDER - ibv_post_send(3) failed
+ *
+ * SEE ALSO
+ * rpma_read_in_domain(3), rpma_write_atomic(3), librpma(7) and
+ * https://pmem.io/rpma/
+ */
+int rpma_write_atomic_in_domain(struct rpma_conn *conn,
+		struct rpma_mr_remote *dst, size_t dst_offset,
+		const struct rpma_mr_local *src,  size_t src_offset,
+		int flags, unsigned domain, const void *op_context);
+
+#define RPMA_ATOMIC_ALIGNMENT 8
+
+/** 3
+ * rpma_compare_and_swap - initiate the atomic compare-and-swap operation
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_conn;
+ *	struct rpma_mr_local;
+ *	struct rpma_mr_remote;
+ *	int rpma_compare_and_swap(struct rpma_conn *conn,
+ *			struct rpma_mr_local *dst, size_t dst_offset,
+ *			const struct rpma_mr_remote *src, size_t src_offset,
+ *			uint64_t compare, uint64_t swap, int flags,
+ *			const void *op_context);
+ *
+ * DESCRIPTION
+ * rpma_compare_and_swap() initiates the atomic compare-and-swap operation on
+ * the 8-byte value (RPMA_ATOMIC_ALIGNMENT) stored in the remote memory at
+ * src_offset. If the remote value equals compare it is replaced with swap.
+ * The original remote value is transferred to the local memory at dst_offset
+ * regardless of whether the swap took place, so comparing it with compare
+ * tells if the operation succeeded. The value is in the byte order of
+ * the remote host.
+ *
+ * The remote memory has to be registered with the RPMA_MR_USAGE_ATOMIC
+ * usage and the local memory with the RPMA_MR_USAGE_READ_DST usage.
+ * The attribute flags set the completion notification indicator:
+ * - RPMA_F_COMPLETION_ON_ERROR - generate the completion on error
+ * - RPMA_F_COMPLETION_ALWAYS - generate the completion regardless of result of
+ * the operation
+ *
+ * The value in the local memory is valid only after the completion
+ * of the operation (RPMA_OP_COMPARE_AND_SWAP) is collected.
+ *
+ * RETURN VALUE
+ * The rpma_compare_and_swap() function returns 0 on success or a negative
+ * error code on failure.
+ *
+ * ERRORS
+ * rpma_compare_and_swap() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - conn, dst or src is NULL
+ * - RPMA_E_INVAL - src_offset is not aligned to 8 bytes
+ * - RPMA_E_INVAL - flags are not set
+ * - RPMA_E_PROVIDER - ibv_post_send(3) failed
+ *
+ * SEE ALSO
+ * rpma_conn_completion_get(3), rpma_conn_req_connect(3),
+ * rpma_fetch_and_add(3), rpma_mr_reg(3), rpma_mr_remote_from_descriptor(3),
+ * librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_compare_and_swap(struct rpma_conn *conn,
+		struct rpma_mr_local *dst, size_t dst_offset,
+		const struct rpma_mr_remote *src, size_t src_offset,
+		uint64_t compare, uint64_t swap, int flags,
+		const void *op_context);
+
+/** 3
+ * rpma_fetch_and_add - initiate the atomic fetch-and-add operation
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_conn;
+ *	struct rpma_mr_local;
+ *	struct rpma_mr_remote;
+ *	int rpma_fetch_and_add(struct rpma_conn *conn,
+ *			struct rpma_mr_local *dst, size_t dst_offset,
+ *			const struct rpma_mr_remote *src, size_t src_offset,
+ *			uint64_t add, int flags, const void *op_context);
+ *
+ * DESCRIPTION
+ * rpma_fetch_and_add() initiates the atomic fetch-and-add operation on
+ * the 8-byte value (RPMA_ATOMIC_ALIGNMENT) stored in the remote memory at
+ * src_offset. The add value is added to the remote value and the original
+ * remote value is transferred to the local memory at dst_offset.
+ * The value is in the byte order of the remote host.
+ *
+ * The remote memory has to be registered with the RPMA_MR_USAGE_ATOMIC
+ * usage and the local memory with the RPMA_MR_USAGE_READ_DST usage.
+ * The attribute flags set the completion notification indicator:
+ * - RPMA_F_COMPLETION_ON_ERROR - generate the completion on error
+ * - RPMA_F_COMPLETION_ALWAYS - generate the completion regardless of result of
+ * the operation
+ *
+ * The value in the local memory is valid only after the completion
+ * of the operation (RPMA_OP_FETCH_AND_ADD) is collected.
+ *
+ * RETURN VALUE
+ * The rpma_fetch_and_add() function returns 0 on success or a negative
+ * error code on failure.
+ *
+ * ERRORS
+ * rpma_fetch_and_add() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - conn, dst or src is NULL
+ * - RPMA_E_INVAL - src_offset is not aligned to 8 bytes
+ * - RPMA_E_INVAL - flags are not set
+ * - RPMA_E_PROVIDER - ibv_post_send(3) failed
+ *
+ * SEE ALSO
+ * rpma_compare_and_swap(3), rpma_conn_completion_get(3),
+ * rpma_conn_req_connect(3), rpma_mr_reg(3), rpma_mr_remote_from_descriptor(3),
+ * librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_fetch_and_add(struct rpma_conn *conn,
+		struct rpma_mr_local *dst, size_t dst_offset,
+		const struct rpma_mr_remote *src, size_t src_offset,
+		uint64_t add, int flags, const void *op_context);
+
+/*
+ * possible types of rpma_flush() operation
+ */
+enum rpma_flush_type {
+	/* flush data down to the persistent domain */
+	RPMA_FLUSH_TYPE_PERSISTENT,
+	/* flush data deep enough to make it visible on the remote node */
+	RPMA_FLUSH_TYPE_VISIBILITY,
+};
+
+/** 3
+ * rpma_flush - initiate the flush operation
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_conn;
+ *	struct rpma_mr_remote;
+ *	enum rpma_flush_type {
+ *		RPMA_FLUSH_TYPE_PERSISTENT,
+ *		RPMA_FLUSH_TYPE_VISIBILITY,
+ *	};
+ *
+ *	int rpma_flush(struct rpma_conn *conn,
+ *			struct rpma_mr_remote *dst, size_t dst_offset,
+ *			size_t len, enum rpma_flush_type type, int flags,
+ *			const void *op_context);
+ *
+ * DESCRIPTION
+ * rpma_flush() initiates the flush operation (finalizing a transfer of data
+ * to the remote memory).
+ * Possible types of rpma_flush() operation:
+ * - RPMA_FLUSH_TYPE_PERSISTENT - flush data down to the persistent domain
+ * - RPMA_FLUSH_TYPE_VISIBILITY - flush data deep enough to make it visible
+ * on the remote node
+ *
+ * The attribute flags set the completion notification indicator:
+ * - RPMA_F_COMPLETION_ON_ERROR - generate the completion on error
+ * - RPMA_F_COMPLETION_ALWAYS - generate the completion regardless of result of
+ * the operation
+ *
+ * RETURN VALUE
+ * The rpma_flush() function returns 0 on success or a negative
+ * error code on failure.
+ *
+ * ERRORS
+ * rpma_flush() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - conn or dst is NULL
+ * - RPMA_E_INVAL - unknown type value
+ * - RPMA_E_INVAL - flags are not set
+ * - RPMA_E_PROVIDER - ibv_post_send(3) failed
+ * - RPMA_E_NOSUPP - type is RPMA_FLUSH_TYPE_PERSISTENT and
+ * the direct write to pmem is not supported
+ *
+ * SEE ALSO
+ * rpma_conn_req_connect(3), rpma_mr_remote_from_descriptor(3), librpma(7)
+ * and https://pmem.io/rpma/
+ */
+int rpma_flush(struct rpma_conn *conn,
+		struct rpma_mr_remote *dst, size_t dst_offset, size_t len,
+		enum rpma_flush_type type, int flags, const void *op_context);
+
+/** 3
+ * rpma_send - initiate the send operation
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_conn;
+ *	struct rpma_mr_local;
+ *	int rpma_send(struct rpma_conn *conn,
+ *			const struct rpma_mr_local *src, size_t offset,
+ *			size_t len, int flags, const void *op_context);
+ *
+ * DESCRIPTION
+ * rpma_send() initiates the send operation which transfers a message from
+ * the local memory to other side of the connection.
+ * To send a 0 byte message, set src to NULL and both offset and len to 0.
+ * The attribute flags set the completion notification indicator:
+ * - RPMA_F_COMPLETION_ON_ERROR - generate the completion on error
+ * - RPMA_F_COMPLETION_ALWAYS - generate the completion regardless of result of
+ * the operation
+ *
+ * RETURN VALUE
+ * The rpma_send() function returns 0 on success or a negative
+ * error code on failure.
+ *
+ * ERRORS
+ * rpma_send() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - conn == NULL || flags == 0
+ * - RPMA_E_INVAL - src == NULL && (offset != 0 || len != 0)
+ * - RPMA_E_PROVIDER - ibv_post_send(3) failed
+ *
+ * SEE ALSO
+ * rpma_conn_req_connect(3), rpma_mr_reg(3), librpma(7) and
+ * https://pmem.io/rpma/
+ */
+int rpma_send(struct rpma_conn *conn,
+		const struct rpma_mr_local *src, size_t offset, size_t len,
+		int flags, const void *op_context);
+
+/** 3
+ * rpma_send_with_imm - initiate the send operation with immediate data
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_conn;
+ *	struct rpma_mr_local;
+ *	int rpma_send_with_imm(struct rpma_conn *conn,
+ *			const struct rpma_mr_local *src, size_t offset,
+ *			size_t len, int flags, uint32_t imm,
+ *			const void *op_context);
+ *
+ * DESCRIPTION
+ * rpma_send_with_imm() initiates the send operation with immediate data which
+ * transfers a message from the local memory to other side of the connection.
+ * To send a 0 byte message, set src to NULL and both offset and len to 0.
+ * The attribute flags set the completion notification indicator:
+ * - RPMA_F_COMPLETION_ON_ERROR - generate the completion on error
+ * - RPMA_F_COMPLETION_ALWAYS - generate the completion regardless of result of
+ * the operation
+ *
+ * RETURN VALUE
+ * The rpma_send_with_imm() function returns 0 on success or a negative
+ * error code on failure.
+ *
+ * ERRORS
+ * rpma_send_with_imm() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - conn == NULL || flags == 0
+ * - RPMA_E_INVAL - src == NULL && (offset != 0 || len != 0)
+ * - RPMA_E_PROVIDER - ibv_post_send(3) failed
+ *
+ * SEE ALSO
+ * rpma_conn_req_connect(3), rpma_mr_reg(3), librpma(7) and
+ * https://pmem.io/rpma/
+ */
+int rpma_send_with_imm(struct rpma_conn *conn,
+	const struct rpma_mr_local *src, size_t offset, size_t len,
+	int flags, uint32_t imm, const void *op_context);
+
+/** 3
+ * rpma_recv - initiate the receive operation
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_conn;
+ *	struct rpma_mr_local;
+ *	int rpma_recv(struct rpma_conn *conn,
+ *			struct rpma_mr_local *dst, size_t offset,
+ *			size_t len, const void *op_context);
+ *
+ * DESCRIPTION
+ * rpma_recv() initiates the receive operation which prepares a buffer for
+ * a message sent from other side of the connection. Please see rpma_send(3).
+ *
+ * All buffers prepared via rpma_recv(3) form an unordered set. When a message
+ * arrives it is placed in one of the buffers awaitaning and a completion for
+ * the receive operation is generated.
+ *
+ * A buffer for an incoming message have to be prepared beforehand.
+ *
+ * The order of buffers in the set does not affect the order of completions of
+ * receive operations get via rpma_conn_completion_get(3).
+ *
+ * NOTE
+ * In the RDMA standard, receive requests form an ordered queue.
+ * The RPMA does NOT inherit this guarantee.
+ *
+ * RETURN VALUE
+ * The rpma_recv() function returns 0 on success or a negative
+ * error code on failure.
+ *
+ * ERRORS
+ * rpma_recv() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - conn == NULL
+ * - RPMA_E_INVAL - dst == NULL && (offset != 0 || len != 0)
+ * - RPMA_E_PROVIDER - ibv_post_recv(3) failed
+ *
+ * SEE ALSO
+ * rpma_conn_req_connect(3), rpma_mr_reg(3), librpma(7) and
+ * https://pmem.io/rpma/
+ */
+int rpma_recv(struct rpma_conn *conn,
+		struct rpma_mr_local *dst, size_t offset, size_t len,
+		const void *op_context);
+
+/* completion handling */
+
+/** 3
+ * rpma_conn_get_completion_fd - get the completion file descriptor
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_conn;
+ *	int rpma_conn_get_completion_fd(const struct rpma_conn *conn, int *fd);
+ *
+ * DESCRIPTION
+ * rpma_conn_get_completion_fd() gets the completion file descriptor
+ * of the connection.
+ *
+ * RETURN VALUE
+ * The rpma_conn_get_completion_fd() function returns 0 on success
+ * or a negative error code on failure. rpma_conn_get_completion_fd()
+ * does not set *fd value on failure.
+ *
+ * ERRORS
+ * rpma_conn_get_completion_fd() can fail with the following error:
+ *
+ * - RPMA_E_INVAL - conn or fd is NULL
+ *
+ * SEE ALSO
+ * rpma_conn_completion_get(3), rpma_conn_completion_wait(3),
+ * rpma_conn_req_connect(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_conn_get_completion_fd(const struct rpma_conn *conn, int *fd);
+
+/** 3
+ * rpma_conn_get_qp_num - get the queue pair number of the connection
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_conn;
+ *	int rpma_conn_get_qp_num(const struct rpma_conn *conn,
+ *			uint32_t *qp_num);
+ *
+ * DESCRIPTION
+ * rpma_conn_get_qp_num() gets the number of the queue pair of
+ * the connection. It allows matching the completions collected from
+ * a shared receive queue (see rpma_srq_completion_get(3)) with
+ * the connections they came from.
+ *
+ * RETURN VALUE
+ * The rpma_conn_get_qp_num() function returns 0 on success
+ * or a negative error code on failure. rpma_conn_get_qp_num()
+ * does not set *qp_num value on failure.
+ *
+ * ERRORS
+ * rpma_conn_get_qp_num() can fail with the following error:
+ *
+ * - RPMA_E_INVAL - conn or qp_num is NULL
+ *
+ * SEE ALSO
+ * rpma_conn_req_connect(3), rpma_srq_completion_get(3), librpma(7) and
+ * https://pmem.io/rpma/
+ */
+int rpma_conn_get_qp_num(const struct rpma_conn *conn, uint32_t *qp_num);
+
+enum rpma_op {
+	RPMA_OP_READ,
+	RPMA_OP_WRITE,
+	RPMA_OP_FLUSH,
+	RPMA_OP_SEND,
+	RPMA_OP_RECV,
+	RPMA_OP_RECV_RDMA_WITH_IMM,
+	RPMA_OP_COMPARE_AND_SWAP,
+	RPMA_OP_FETCH_AND_ADD,
+};
+
+struct rpma_completion {
+	void *op_context;
+	enum rpma_op op;
+	uint32_t byte_len;
+	enum ibv_wc_status op_status;
+	unsigned flags;
+	uint32_t imm;
+	uint32_t qp_num;
+};
+
+enum rpma_completion_ts_source {
+	RPMA_COMPLETION_TS_SOFTWARE,
+	RPMA_COMPLETION_TS_HW,
+	RPMA_COMPLETION_TS_HW_WALLCLOCK,
+};
+
+struct rpma_completion_ex {
+	struct rpma_completion cmpl;
+	enum rpma_completion_ts_source ts_source;
+	uint64_t ts_ns;
+	uint64_t polled_ns;
+};
+
+/** 3
+ * rpma_conn_completion_wait - wait for a completion
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_conn;
+ *	int rpma_conn_completion_wait(struct rpma_conn *conn);
+ *
+ * DESCRIPTION
+ * rpma_conn_completion_wait() waits for an incoming completion. If it
+ * succeeds the completion can be collected using rpma_conn_completion_get().
+ *
+ * If the connection works in the RPMA_CONN_THREAD_SAFE or
+ * RPMA_CONN_THREAD_LOCKLESS mode (see rpma_conn_cfg_set_thread_mode(3))
+ * many threads may wait at the same time. Only one of them waits
+ * for the completion channel. The others return either when it wakes up
+ * or when a completion is routed to them (see rpma_conn_thread_attach(3))
+ * so rpma_conn_completion_get() may find no completion for the calling
+ * thread afterwards.
+ *
+ * RETURN VALUE
+ * The rpma_conn_completion_wait() function returns 0 on success
+ * or a negative error code on failure.
+ *
+ * ERRORS
+ * rpma_conn_completion_wait() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - conn is NULL
+ * - RPMA_E_PROVIDER - poll(2) failed (RPMA_CONN_THREAD_SAFE and
+ * RPMA_CONN_THREAD_LOCKLESS modes only) or ibv_req_notify_cq(3) failed
+ * with a provider error
+ * - RPMA_E_NO_COMPLETION - no completions available
+ *
+ * SEE ALSO
+ * rpma_conn_get_completion_fd(3), rpma_conn_completion_get(3),
+ * rpma_conn_req_connect(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_conn_completion_wait(struct rpma_conn *conn);
+
+/** 3
+ * rpma_conn_completion_get - receive a completion of an operation
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_conn;
+ *	struct rpma_completion;
+ *	enum rpma_op {
+ *		RPMA_OP_READ,
+ *		RPMA_OP_WRITE,
+ *		RPMA_OP_FLUSH,
+ *		RPMA_OP_SEND,
+ *		RPMA_OP_RECV,
+ *		RPMA_OP_RECV_RDMA_WITH_IMM,
+ *		RPMA_OP_COMPARE_AND_SWAP,
+ *		RPMA_OP_FETCH_AND_ADD,
+ *	};
+ *
+ *	int rpma_conn_completion_get(struct rpma_conn *conn,
+ *			struct rpma_completion *cmpl);
+ *
+ * DESCRIPTION
+ * rpma_conn_completion_get() receives the next available completion
+ * of an already posted operation. All operations generate completion on
+ * error. The operations posted with the **RPMA_F_COMPLETION_ALWAYS** flag
+ * also generate a completion on success.
+ * The following operations are available:
+ * - RPMA_OP_READ - RMA read operation
+ * - RPMA_OP_WRITE - RMA write operation
+ * - RPMA_OP_FLUSH - RMA flush operation
+ * - RPMA_OP_SEND - messaging send operation
+ * - RPMA_OP_RECV - messaging receive operation
+ * - RPMA_OP_RECV_RDMA_WITH_IMM - messaging receive operation for
+ *   RMA write operation with immediate data
+ * - RPMA_OP_COMPARE_AND_SWAP - RMA atomic compare-and-swap operation
+ * - RPMA_OP_FETCH_AND_ADD - RMA atomic fetch-and-add operation
+ *
+ * The qp_num field holds the number of the queue pair the completion
+ * came from (see rpma_conn_get_qp_num(3)).
+ *
+ * RETURN VALUE
+ * The rpma_conn_completion_get() function returns 0 on success
+ * or a negative error code on failure.
+ *
+ * ERRORS
+ * rpma_conn_completion_get() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - conn or cmpl is NULL
+ * - RPMA_E_NO_COMPLETION - no completions available
+ * - RPMA_E_PROVIDER - ibv_poll_cq(3) failed with a provider error
+ * - RPMA_E_UNKNOWN - ibv_poll_cq(3) failed but no provider error is available
+ * - RPMA_E_NOSUPP - not supported opcode
+ *
+ * SEE ALSO
+ * rpma_conn_get_completion_fd(3), rpma_conn_completion_wait(3),
+ * rpma_conn_req_connect(3), rpma_flush(3), rpma_read(3), rpma_recv(3),
+ * rpma_send(3), rpma_write(3), rpma_write_atomic(3), librpma(7) and
+ * https://pmem.io/rpma/
+ */
+int rpma_conn_completion_get(struct rpma_conn *conn,
+		struct rpma_completion *cmpl);
+
+/** 3
+ * rpma_conn_completion_get_ex - receive a timestamped completion
+ * of an operation
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_conn;
+ *	struct rpma_completion;
+ *	enum rpma_completion_ts_source {
+ *		RPMA_COMPLETION_TS_SOFTWARE,
+ *		RPMA_COMPLETION_TS_HW,
+ *		RPMA_COMPLETION_TS_HW_WALLCLOCK,
+ *	};
+ *
+ *	struct rpma_completion_ex {
+ *		struct rpma_completion cmpl;
+ *		enum rpma_completion_ts_source ts_source;
+ *		uint64_t ts_ns;
+ *		uint64_t polled_ns;
+ *	};
+ *
+ *	int rpma_conn_completion_get_ex(struct rpma_conn *conn,
+ *			struct rpma_completion_ex *cmpl_ex);
+ *
+ * DESCRIPTION
+ * rpma_conn_completion_get_ex() receives the next available completion
+ * exactly as rpma_conn_completion_get(3) does and stores it in cmpl_ex->cmpl.
+ * Additionally, it stores the time the completion has been collected
+ * (polled_ns, CLOCK_REALTIME in nanoseconds) and the time the completion has
+ * been generated (ts_ns, in nanoseconds) which comes from one of
+ * the following sources:
+ *
+ * - RPMA_COMPLETION_TS_HW_WALLCLOCK - the device clock in the wallclock
+ *   domain; polled_ns - ts_ns is the delay of collecting the completion
+ * - RPMA_COMPLETION_TS_HW - the free-running device clock which can be
+ *   compared only with the other timestamps of the same device
+ * - RPMA_COMPLETION_TS_SOFTWARE - the device does not timestamp
+ *   the completions (or it has not been asked to do so,
+ *   see rpma_conn_cfg_set_timestamps(3)); ts_ns is equal to polled_ns
+ *
+ * RETURN VALUE
+ * The rpma_conn_completion_get_ex() function returns 0 on success
+ * or a negative error code on failure.
+ *
+ * ERRORS
+ * rpma_conn_completion_get_ex() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - conn or cmpl_ex is NULL
+ * - RPMA_E_NO_COMPLETION - no completions available
+ * - RPMA_E_PROVIDER - ibv_poll_cq(3) or ibv_start_poll(3) failed with
+ *   a provider error
+ * - RPMA_E_UNKNOWN - ibv_poll_cq(3) failed but no provider error is available
+ * - RPMA_E_NOSUPP - not supported opcode or the connection works in
+ *   a thread-safe mode (see rpma_conn_cfg_set_thread_mode(3))
+ *
+ * SEE ALSO
+ * rpma_conn_cfg_set_timestamps(3), rpma_conn_completion_get(3),
+ * rpma_conn_completion_wait(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_conn_completion_get_ex(struct rpma_conn *conn,
+		struct rpma_completion_ex *cmpl_ex);
+
+/** 3
+ * rpma_conn_thread_attach - route completions to the calling thread
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_conn;
+ *	int rpma_conn_thread_attach(struct rpma_conn *conn);
+ *
+ * DESCRIPTION
+ * rpma_conn_thread_attach() attaches the calling thread to the connection
+ * which works either in the RPMA_CONN_THREAD_SAFE or
+ * the RPMA_CONN_THREAD_LOCKLESS mode (see rpma_conn_cfg_set_thread_mode(3)).
+ * Completions of operations posted by an attached thread with
+ * the RPMA_F_COMPLETION_ALWAYS flag (and completions of all receive
+ * operations posted by the thread) are returned only by
+ * rpma_conn_completion_get(3) called by the very same thread. Completions
+ * polled by other threads are handed over to the attached thread
+ * via its private completion queue.
+ *
+ * Completions which cannot be routed (e.g. completions of operations posted
+ * by not attached threads or error completions of operations posted with
+ * the RPMA_F_COMPLETION_ON_ERROR flag) are returned to any thread calling
+ * rpma_conn_completion_get(3).
+ *
+ * Up to 63 threads can be attached to a single connection at the same time.
+ * Attaching an already attached thread has no effect.
+ *
+ * Note that rpma_conn_completion_wait(3) called by an attached thread
+ * returns immediately if a completion is waiting in the thread's private
+ * completion queue. Otherwise it returns as soon as a completion is routed
+ * to the thread or the completion channel of the connection notifies
+ * a completion. Waiting for the completion file descriptor of
+ * the connection (see rpma_conn_get_completion_fd(3)) directly is not
+ * notified about the routed completions.
+ *
+ * RETURN VALUE
+ * The rpma_conn_thread_attach() function returns 0 on success or a negative
+ * error code on failure.
+ *
+ * ERRORS
+ * rpma_conn_thread_attach() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - conn is NULL
+ * - RPMA_E_NOSUPP - the connection works in the RPMA_CONN_THREAD_SINGLE mode
+ * - RPMA_E_NOMEM - out of memory or too many attached threads
+ *
+ * SEE ALSO
+ * rpma_conn_cfg_set_thread_mode(3), rpma_conn_completion_get(3),
+ * rpma_conn_thread_detach(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_conn_thread_attach(struct rpma_conn *conn);
+
+/** 3
+ * rpma_conn_thread_detach - stop routing completions to the calling thread
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_conn;
+ *	int rpma_conn_thread_detach(struct rpma_conn *conn);
+ *
+ * DESCRIPTION
+ * rpma_conn_thread_detach() detaches the calling thread from the connection.
+ * All completions routed to the thread have to be collected before
+ * the thread can be detached.
+ *
+ * RETURN VALUE
+ * The rpma_conn_thread_detach() function returns 0 on success or a negative
+ * error code on failure.
+ *
+ * ERRORS
+ * rpma_conn_thread_detach() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - conn is NULL or the calling thread is not attached
+ * - RPMA_E_NOSUPP - the connection works in the RPMA_CONN_THREAD_SINGLE mode
+ * - RPMA_E_AGAIN - completions routed to the thread are not collected yet
+ *
+ * SEE ALSO
+ * rpma_conn_thread_attach(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_conn_thread_detach(struct rpma_conn *conn);
+
+/* shared receive queue */
+
+/** 3
+ * rpma_srq_new - create a new shared receive queue
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_peer;
+ *	struct rpma_srq;
+ *	int rpma_srq_new(struct rpma_peer *peer, uint32_t size,
+ *			struct rpma_srq **srq_ptr);
+ *
+ * DESCRIPTION
+ * rpma_srq_new() creates a new shared receive queue (SRQ) able to hold
+ * up to size receive buffers together with the completion queue collecting
+ * completions of the receives consumed by all the connections attached
+ * to the SRQ. Attaching many connections to one SRQ lets them share
+ * a single pool of receive buffers instead of provisioning a receive queue
+ * per connection. A connection is attached to the SRQ using
+ * rpma_conn_cfg_set_srq(3).
+ *
+ * RETURN VALUE
+ * The rpma_srq_new() function returns 0 on success or a negative error code
+ * on failure. rpma_srq_new() does not set *srq_ptr value on failure.
+ *
+ * ERRORS
+ * rpma_srq_new() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - peer or srq_ptr is NULL or size is 0
+ * - RPMA_E_PROVIDER - ibv_create_srq(3), ibv_create_comp_channel(3) or
+ *   ibv_create_cq(3) failed
+ * - RPMA_E_NOMEM - out of memory
+ *
+ * SEE ALSO
+ * rpma_conn_cfg_set_srq(3), rpma_peer_new(3), rpma_srq_delete(3),
+ * rpma_srq_recv(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_srq_new(struct rpma_peer *peer, uint32_t size,
+		struct rpma_srq **srq_ptr);
+
+/** 3
+ * rpma_srq_delete - delete the shared receive queue
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_srq;
+ *	int rpma_srq_delete(struct rpma_srq **srq_ptr);
+ *
+ * DESCRIPTION
+ * rpma_srq_delete() deletes the shared receive queue and its completion
+ * queue. All the connections attached to the SRQ have to be deleted before.
+ *
+ * RETURN VALUE
+ * The rpma_srq_delete() function returns 0 on success or a negative error
+ * code on failure. rpma_srq_delete() sets *srq_ptr value to NULL
+ * on success and on failure.
+ *
+ * ERRORS
+ * rpma_srq_delete() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - srq_ptr is NULL
+ * - RPMA_E_PROVIDER - ibv_destroy_srq(3), ibv_destroy_cq(3) or
+ *   ibv_destroy_comp_channel(3) failed
+ *
+ * SEE ALSO
+ * rpma_srq_new(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_srq_delete(struct rpma_srq **srq_ptr);
+
+/** 3
+ * rpma_srq_recv - post a receive buffer to the shared receive queue
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_srq;
+ *	struct rpma_mr_local;
+ *	int rpma_srq_recv(struct rpma_srq *srq,
+ *			struct rpma_mr_local *dst, size_t offset,
+ *			size_t len, const void *op_context);
+ *
+ * DESCRIPTION
+ * rpma_srq_recv() posts a buffer to the shared receive queue. The buffer
+ * is consumed by a message sent over any of the connections attached
+ * to the SRQ. The completion of the receive is collected using
+ * rpma_srq_completion_get(3) and its qp_num field tells which connection
+ * the message came from.
+ *
+ * RETURN VALUE
+ * The rpma_srq_recv() function returns 0 on success or a negative error
+ * code on failure.
+ *
+ * ERRORS
+ * rpma_srq_recv() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - srq == NULL
+ * - RPMA_E_INVAL - dst == NULL && (offset != 0 || len != 0)
+ * - RPMA_E_PROVIDER - ibv_post_srq_recv(3) failed
+ *
+ * SEE ALSO
+ * rpma_mr_reg(3), rpma_srq_completion_get(3), rpma_srq_new(3), librpma(7)
+ * and https://pmem.io/rpma/
+ */
+int rpma_srq_recv(struct rpma_srq *srq,
+		struct rpma_mr_local *dst, size_t offset, size_t len,
+		const void *op_context);
+
+/** 3
+ * rpma_srq_get_completion_fd - get the completion file descriptor of
+ * the shared receive queue
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_srq;
+ *	int rpma_srq_get_completion_fd(const struct rpma_srq *srq, int *fd);
+ *
+ * DESCRIPTION
+ * rpma_srq_get_completion_fd() gets the file descriptor of the completion
+ * channel of the shared receive queue.
+ *
+ * RETURN VALUE
+ * The rpma_srq_get_completion_fd() function returns 0 on success
+ * or a negative error code on failure. rpma_srq_get_completion_fd()
+ * does not set *fd value on failure.
+ *
+ * ERRORS
+ * rpma_srq_get_completion_fd() can fail with the following error:
+ *
+ * - RPMA_E_INVAL - srq or fd is NULL
+ *
+ * SEE ALSO
+ * rpma_srq_completion_get(3), rpma_srq_completion_wait(3), rpma_srq_new(3),
+ * librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_srq_get_completion_fd(const struct rpma_srq *srq, int *fd);
+
+/** 3
+ * rpma_srq_completion_wait - wait for a completion of the shared receive
+ * queue
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_srq;
+ *	int rpma_srq_completion_wait(struct rpma_srq *srq);
+ *
+ * DESCRIPTION
+ * rpma_srq_completion_wait() waits for an incoming completion of a receive
+ * posted to the shared receive queue. If it succeeds the completion can be
+ * collected using rpma_srq_completion_get().
+ *
+ * RETURN VALUE
+ * The rpma_srq_completion_wait() function returns 0 on success
+ * or a negative error code on failure.
+ *
+ * ERRORS
+ * rpma_srq_completion_wait() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - srq is NULL
+ * - RPMA_E_PROVIDER - ibv_req_notify_cq(3) failed with a provider error
+ * - RPMA_E_NO_COMPLETION - no completions available
+ *
+ * SEE ALSO
+ * rpma_srq_completion_get(3), rpma_srq_get_completion_fd(3), librpma(7)
+ * and https://pmem.io/rpma/
+ */
+int rpma_srq_completion_wait(struct rpma_srq *srq);
+
+/** 3
+ * rpma_srq_completion_get - receive a completion of the shared receive queue
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_srq;
+ *	struct rpma_completion;
+ *	int rpma_srq_completion_get(struct rpma_srq *srq,
+ *			struct rpma_completion *cmpl);
+ *
+ * DESCRIPTION
+ * rpma_srq_completion_get() receives the next available completion
+ * of a receive posted to the shared receive queue. The op field is either
+ * RPMA_OP_RECV or RPMA_OP_RECV_RDMA_WITH_IMM and the qp_num field holds
+ * the number of the queue pair of the connection the message came from
+ * (see rpma_conn_get_qp_num(3)).
+ *
+ * RETURN VALUE
+ * The rpma_srq_completion_get() function returns 0 on success
+ * or a negative error code on failure.
+ *
+ * ERRORS
+ * rpma_srq_completion_get() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - srq or cmpl is NULL
+ * - RPMA_E_NO_COMPLETION - no completions available
+ * - RPMA_E_PROVIDER - ibv_poll_cq(3) failed with a provider error
+ * - RPMA_E_UNKNOWN - ibv_poll_cq(3) failed but no provider error is available
+ * - RPMA_E_NOSUPP - not supported opcode
+ *
+ * SEE ALSO
+ * rpma_conn_get_qp_num(3), rpma_srq_completion_wait(3), rpma_srq_recv(3),
+ * librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_srq_completion_get(struct rpma_srq *srq,
+		struct rpma_completion *cmpl);
+
+/* receive buffer ring */
+
+struct rpma_recv_ring;
+
+struct rpma_recv_msg {
+	void *ptr;
+	uint32_t len;
+	uint32_t imm;
+	unsigned flags;
+	uint32_t qp_num;
+	uint32_t slot;
+};
+
+/** 3
+ * rpma_recv_ring_new - create a self-replenishing ring of receive buffers
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_peer;
+ *	struct rpma_conn;
+ *	struct rpma_srq;
+ *	struct rpma_recv_ring;
+ *	int rpma_recv_ring_new(struct rpma_peer *peer, struct rpma_conn *conn,
+ *			struct rpma_srq *srq, uint32_t slots, size_t slot_size,
+ *			uint32_t batch, struct rpma_recv_ring **ring_ptr);
+ *
+ * DESCRIPTION
+ * rpma_recv_ring_new() allocates a single memory slab split into slots
+ * of slot_size bytes each, registers it and posts all the slots as
+ * receives either to the connection (conn) or to the shared receive queue
+ * (srq). Exactly one of conn and srq has to be provided.
+ *
+ * Completions of the receives are collected as usual, using
+ * rpma_conn_completion_get(3) or rpma_srq_completion_get(3), and are
+ * translated into views of the received messages using
+ * rpma_recv_ring_get_msg(3). When the application is done with a message
+ * it gives the slot back using rpma_recv_ring_release(3). The released slots
+ * are re-posted in batches of batch slots which takes a single post call
+ * per batch off the critical path of every message.
+ *
+ * The ring is not thread-safe. A connection working in a thread-safe mode
+ * (see rpma_conn_cfg_set_thread_mode(3)) is not supported - use a shared
+ * receive queue instead.
+ *
+ * If the provider accepts only a part of the initial receives the ring is
+ * created anyway since the posted receives point into its slab. The slots
+ * which have not been posted stay released and they can be posted again
+ * using rpma_recv_ring_repost(3).
+ *
+ * RETURN VALUE
+ * The rpma_recv_ring_new() function returns 0 on success or a negative
+ * error code on failure. rpma_recv_ring_new() does not set *ring_ptr value
+ * on failure.
+ *
+ * ERRORS
+ * rpma_recv_ring_new() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - peer or ring_ptr is NULL, both or none of conn and srq
+ *   are provided, slots, slot_size or batch is 0, batch > slots,
+ *   slot_size > UINT32_MAX or the slab size overflows
+ * - RPMA_E_NOSUPP - the connection works in a thread-safe mode or collects
+ *   the latency (see rpma_conn_cfg_set_stats(3))
+ * - RPMA_E_NOMEM - out of memory
+ * - RPMA_E_PROVIDER - sysconf(3) failed, registering the slab failed or
+ *   ibv_post_recv(3)/ibv_post_srq_recv(3) failed for all of the slots
+ *
+ * SEE ALSO
+ * rpma_recv_ring_delete(3), rpma_recv_ring_get_msg(3),
+ * rpma_recv_ring_release(3), rpma_recv_ring_repost(3), rpma_srq_new(3),
+ * librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_recv_ring_new(struct rpma_peer *peer, struct rpma_conn *conn,
+		struct rpma_srq *srq, uint32_t slots, size_t slot_size,
+		uint32_t batch, struct rpma_recv_ring **ring_ptr);
+
+/** 3
+ * rpma_recv_ring_delete - delete the ring of receive buffers
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_recv_ring;
+ *	int rpma_recv_ring_delete(struct rpma_recv_ring **ring_ptr);
+ *
+ * DESCRIPTION
+ * rpma_recv_ring_delete() deregisters and frees the receive buffers.
+ * The connection or the shared receive queue the buffers were posted to
+ * has to be deleted before.
+ *
+ * RETURN VALUE
+ * The rpma_recv_ring_delete() function returns 0 on success or a negative
+ * error code on failure. rpma_recv_ring_delete() sets *ring_ptr value
+ * to NULL on success and on failure.
+ *
+ * ERRORS
+ * rpma_recv_ring_delete() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - ring_ptr is NULL
+ * - RPMA_E_PROVIDER - deregistering the slab or munmap(2) failed
+ *
+ * SEE ALSO
+ * rpma_recv_ring_new(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_recv_ring_delete(struct rpma_recv_ring **ring_ptr);
+
+/** 3
+ * rpma_recv_ring_get_msg - get a view of the received message
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_recv_ring;
+ *	struct rpma_completion;
+ *	struct rpma_recv_msg {
+ *		void *ptr;
+ *		uint32_t len;
+ *		uint32_t imm;
+ *		unsigned flags;
+ *		uint32_t qp_num;
+ *		uint32_t slot;
+ *	};
+ *
+ *	int rpma_recv_ring_get_msg(struct rpma_recv_ring *ring,
+ *			const struct rpma_completion *cmpl,
+ *			struct rpma_recv_msg *msg);
+ *
+ * DESCRIPTION
+ * rpma_recv_ring_get_msg() translates the completion of a receive posted
+ * by the ring into a view of the received message without copying it:
+ * - ptr - the beginning of the message inside the slot
+ * - len - the length of the message
+ * - imm - the immediate data (valid if flags contain IBV_WC_WITH_IMM)
+ * - flags - the flags of the completion
+ * - qp_num - the queue pair number of the connection the message came from
+ * - slot - the slot index of the message
+ *
+ * The view stays valid until the message is released using
+ * rpma_recv_ring_release(3). A completion which does not come from the ring
+ * is rejected so completions of other operations collected from the same
+ * queue can be told apart.
+ *
+ * RETURN VALUE
+ * The rpma_recv_ring_get_msg() function returns 0 on success or a negative
+ * error code on failure.
+ *
+ * ERRORS
+ * rpma_recv_ring_get_msg() can fail with the following error:
+ *
+ * - RPMA_E_INVAL - ring, cmpl or msg is NULL or the completion does not
+ *   come from the ring
+ *
+ * SEE ALSO
+ * rpma_conn_completion_get(3), rpma_recv_ring_new(3),
+ * rpma_recv_ring_release(3), rpma_srq_completion_get(3), librpma(7) and
+ * https://pmem.io/rpma/
+ */
+int rpma_recv_ring_get_msg(struct rpma_recv_ring *ring,
+		const struct rpma_completion *cmpl, struct rpma_recv_msg *msg);
+
+/** 3
+ * rpma_recv_ring_release - give the slot of the message back to the ring
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_recv_ring;
+ *	struct rpma_recv_msg;
+ *	int rpma_recv_ring_release(struct rpma_recv_ring *ring,
+ *			const struct rpma_recv_msg *msg);
+ *
+ * DESCRIPTION
+ * rpma_recv_ring_release() gives the slot of the message back to the ring.
+ * The slot is not re-posted immediately. Once batch slots are released
+ * all of them are re-posted at once. The message cannot be accessed after
+ * it is released.
+ *
+ * RETURN VALUE
+ * The rpma_recv_ring_release() function returns 0 on success or a negative
+ * error code on failure.
+ *
+ * ERRORS
+ * rpma_recv_ring_release() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - ring or msg is NULL or the slot of the message is not
+ *   held by the application
+ * - RPMA_E_PROVIDER - ibv_post_recv(3)/ibv_post_srq_recv(3) failed;
+ *   the slots which have not been posted stay released
+ *
+ * SEE ALSO
+ * rpma_recv_ring_get_msg(3), rpma_recv_ring_repost(3), librpma(7) and
+ * https://pmem.io/rpma/
+ */
+int rpma_recv_ring_release(struct rpma_recv_ring *ring,
+		const struct rpma_recv_msg *msg);
+
+/** 3
+ * rpma_recv_ring_repost - re-post all the released slots
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_recv_ring;
+ *	int rpma_recv_ring_repost(struct rpma_recv_ring *ring);
+ *
+ * DESCRIPTION
+ * rpma_recv_ring_repost() re-posts all the released slots regardless
+ * of the batch size e.g. when the application is about to wait for
+ * the next message.
+ *
+ * RETURN VALUE
+ * The rpma_recv_ring_repost() function returns 0 on success or a negative
+ * error code on failure.
+ *
+ * ERRORS
+ * rpma_recv_ring_repost() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - ring is NULL
+ * - RPMA_E_PROVIDER - ibv_post_recv(3)/ibv_post_srq_recv(3) failed;
+ *   the slots which have not been posted stay released
+ *
+ * SEE ALSO
+ * rpma_recv_ring_release(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_recv_ring_repost(struct rpma_recv_ring *ring);
+
+/* credit-based messenger */
+
+struct rpma_msgr;
+
+enum rpma_msgr_type {
+	RPMA_MSGR_REQUEST,
+	RPMA_MSGR_RESPONSE
+};
+
+struct rpma_msgr_msg {
+	const void *ptr;
+	uint32_t len;
+	enum rpma_msgr_type type;
+	uint64_t corr_id;
+};
+
+/** 3
+ * rpma_msgr_new - create a new credit-based messenger
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_peer;
+ *	struct rpma_conn;
+ *	struct rpma_msgr;
+ *	int rpma_msgr_new(struct rpma_peer *peer, struct rpma_conn *conn,
+ *			uint32_t credits, size_t buf_size,
+ *			struct rpma_msgr **msgr_ptr);
+ *
+ * DESCRIPTION
+ * rpma_msgr_new() creates a messenger exchanging requests and responses
+ * over the connection using send and receive operations. The messenger
+ * posts credits receive buffers of buf_size bytes each (see
+ * rpma_recv_ring_new(3)) and registers the same number of send buffers.
+ *
+ * A send is never issued unless the peer has a receive buffer posted
+ * for it so the connection does not suffer from the receiver-not-ready
+ * retries. Every send carries a batch of messages together with the number
+ * of receive buffers re-posted since the previous send (the credits)
+ * so the flow control comes for free as long as both sides keep sending.
+ * A side which only receives returns the credits with a message-less send
+ * once half of them is waiting. The last credit of every side is reserved
+ * for such sends.
+ *
+ * Both sides of the connection have to create their messengers with
+ * the same credits and buf_size values before any of them sends anything.
+ * The completion queue of the connection has to be able to hold
+ * 2 * credits completions (see rpma_conn_cfg_set_cq_size(3)).
+ *
+ * All completions of the connection have to be passed to
+ * rpma_msgr_process(3). The messenger does not work with a connection
+ * working in a thread-safe mode (see rpma_conn_cfg_set_thread_mode(3)).
+ *
+ * RETURN VALUE
+ * The rpma_msgr_new() function returns 0 on success or a negative error
+ * code on failure. rpma_msgr_new() does not set *msgr_ptr value on failure.
+ *
+ * ERRORS
+ * rpma_msgr_new() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - peer, conn or msgr_ptr is NULL, credits < 2, buf_size
+ *   cannot hold a single empty message or the buffers size overflows
+ * - RPMA_E_NOSUPP - the connection works in a thread-safe mode or collects
+ *   the latency (see rpma_conn_cfg_set_stats(3))
+ * - RPMA_E_NOMEM - out of memory
+ * - RPMA_E_PROVIDER - sysconf(3) failed, registering the buffers failed or
+ *   ibv_post_recv(3) failed
+ *
+ * SEE ALSO
+ * rpma_conn_req_connect(3), rpma_msgr_delete(3), rpma_msgr_flush(3),
+ * rpma_msgr_next(3), rpma_msgr_process(3), rpma_msgr_request(3),
+ * rpma_msgr_respond(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_msgr_new(struct rpma_peer *peer, struct rpma_conn *conn,
+		uint32_t credits, size_t buf_size, struct rpma_msgr **msgr_ptr);
+
+/** 3
+ * rpma_msgr_delete - delete the messenger
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_msgr;
+ *	int rpma_msgr_delete(struct rpma_msgr **msgr_ptr);
+ *
+ * DESCRIPTION
+ * rpma_msgr_delete() deregisters and frees the send and receive buffers
+ * of the messenger. The connection has to be deleted before.
+ *
+ * RETURN VALUE
+ * The rpma_msgr_delete() function returns 0 on success or a negative error
+ * code on failure. rpma_msgr_delete() sets *msgr_ptr value to NULL
+ * on success and on failure.
+ *
+ * ERRORS
+ * rpma_msgr_delete() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - msgr_ptr is NULL
+ * - RPMA_E_PROVIDER - deregistering the buffers or munmap(2) failed
+ *
+ * SEE ALSO
+ * rpma_msgr_new(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_msgr_delete(struct rpma_msgr **msgr_ptr);
+
+/** 3
+ * rpma_msgr_request - append a request to the batch being sent
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_msgr;
+ *	int rpma_msgr_request(struct rpma_msgr *msgr, const void *data,
+ *			size_t len, uint64_t *corr_id);
+ *
+ * DESCRIPTION
+ * rpma_msgr_request() copies the request into the batch being filled
+ * and assigns it a new correlation ID. The peer passes the correlation ID
+ * to rpma_msgr_respond(3) so the response can be matched with the request.
+ * The batch is sent when the next message does not fit in it or when
+ * rpma_msgr_flush(3) is called.
+ *
+ * RETURN VALUE
+ * The rpma_msgr_request() function returns 0 on success or a negative error
+ * code on failure.
+ *
+ * ERRORS
+ * rpma_msgr_request() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - msgr or corr_id is NULL, data is NULL and len is not 0
+ *   or the request does not fit in a single buffer
+ * - RPMA_E_AGAIN - the batch is full and the peer has no credits or there is
+ *   no free send buffer; completions have to be processed first
+ * - RPMA_E_PROVIDER - sending the full batch failed
+ *
+ * SEE ALSO
+ * rpma_msgr_flush(3), rpma_msgr_new(3), rpma_msgr_next(3),
+ * rpma_msgr_respond(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_msgr_request(struct rpma_msgr *msgr, const void *data, size_t len,
+		uint64_t *corr_id);
+
+/** 3
+ * rpma_msgr_respond - append a response to the batch being sent
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_msgr;
+ *	int rpma_msgr_respond(struct rpma_msgr *msgr, uint64_t corr_id,
+ *			const void *data, size_t len);
+ *
+ * DESCRIPTION
+ * rpma_msgr_respond() copies the response to the request of the given
+ * correlation ID into the batch being filled. The batch is sent when
+ * the next message does not fit in it or when rpma_msgr_flush(3) is called.
+ *
+ * RETURN VALUE
+ * The rpma_msgr_respond() function returns 0 on success or a negative error
+ * code on failure.
+ *
+ * ERRORS
+ * rpma_msgr_respond() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - msgr is NULL, data is NULL and len is not 0
+ *   or the response does not fit in a single buffer
+ * - RPMA_E_AGAIN - the batch is full and the peer has no credits or there is
+ *   no free send buffer; completions have to be processed first
+ * - RPMA_E_PROVIDER - sending the full batch failed
+ *
+ * SEE ALSO
+ * rpma_msgr_flush(3), rpma_msgr_new(3), rpma_msgr_next(3),
+ * rpma_msgr_request(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_msgr_respond(struct rpma_msgr *msgr, uint64_t corr_id,
+		const void *data, size_t len);
+
+/** 3
+ * rpma_msgr_flush - send the batch being filled
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_msgr;
+ *	int rpma_msgr_flush(struct rpma_msgr *msgr);
+ *
+ * DESCRIPTION
+ * rpma_msgr_flush() sends the batch of the messages appended so far along
+ * with the credits waiting to be returned to the peer. Nothing is sent
+ * if there is no message waiting. Appending many messages before a single
+ * call to rpma_msgr_flush() amortizes the cost of a send over all of them.
+ *
+ * RETURN VALUE
+ * The rpma_msgr_flush() function returns 0 on success or a negative error
+ * code on failure.
+ *
+ * ERRORS
+ * rpma_msgr_flush() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - msgr is NULL
+ * - RPMA_E_AGAIN - the peer has no credits left; completions have to be
+ *   processed first
+ * - RPMA_E_PROVIDER - ibv_post_send(3) or ibv_post_recv(3) failed
+ *
+ * SEE ALSO
+ * rpma_msgr_new(3), rpma_msgr_process(3), rpma_msgr_request(3),
+ * rpma_msgr_respond(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_msgr_flush(struct rpma_msgr *msgr);
+
+/** 3
+ * rpma_msgr_process - process a completion of the connection
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_msgr;
+ *	struct rpma_completion;
+ *	int rpma_msgr_process(struct rpma_msgr *msgr,
+ *			const struct rpma_completion *cmpl);
+ *
+ * DESCRIPTION
+ * rpma_msgr_process() consumes a completion collected using
+ * rpma_conn_completion_get(3). A send completion frees the send buffer.
+ * A receive completion queues the received batch for rpma_msgr_next(3)
+ * and takes the credits it carries. If enough credits are waiting to be
+ * returned to the peer and no batch is being filled a message-less send
+ * returning them is issued.
+ *
+ * RETURN VALUE
+ * The rpma_msgr_process() function returns 0 on success or a negative error
+ * code on failure.
+ *
+ * ERRORS
+ * rpma_msgr_process() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - msgr or cmpl is NULL, the completion does not come from
+ *   the messenger or the received batch is malformed (e.g. it returns more
+ *   credits than the peer has been given)
+ * - RPMA_E_PROVIDER - the operation completed with an error or
+ *   ibv_post_send(3) or ibv_post_recv(3) failed
+ *
+ * SEE ALSO
+ * rpma_conn_completion_get(3), rpma_msgr_new(3), rpma_msgr_next(3),
+ * librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_msgr_process(struct rpma_msgr *msgr,
+		const struct rpma_completion *cmpl);
+
+/** 3
+ * rpma_msgr_next - get the next received message
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_msgr;
+ *	enum rpma_msgr_type {
+ *		RPMA_MSGR_REQUEST,
+ *		RPMA_MSGR_RESPONSE
+ *	};
+ *
+ *	struct rpma_msgr_msg {
+ *		const void *ptr;
+ *		uint32_t len;
+ *		enum rpma_msgr_type type;
+ *		uint64_t corr_id;
+ *	};
+ *
+ *	int rpma_msgr_next(struct rpma_msgr *msgr, struct rpma_msgr_msg *msg);
+ *
+ * DESCRIPTION
+ * rpma_msgr_next() gets a view of the next received message in the order
+ * the messages were sent:
+ * - ptr - the payload of the message
+ * - len - the length of the payload
+ * - type - RPMA_MSGR_REQUEST or RPMA_MSGR_RESPONSE
+ * - corr_id - the correlation ID of the request
+ *
+ * The view stays valid until the next call to rpma_msgr_next(). The receive
+ * buffer is given back to the peer as a credit once all the messages
+ * it holds are read.
+ *
+ * RETURN VALUE
+ * The rpma_msgr_next() function returns 0 on success or a negative error
+ * code on failure.
+ *
+ * ERRORS
+ * rpma_msgr_next() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - msgr or msg is NULL
+ * - RPMA_E_NO_COMPLETION - no message is available
+ * - RPMA_E_PROVIDER - ibv_post_send(3) or ibv_post_recv(3) failed
+ *
+ * SEE ALSO
+ * rpma_msgr_new(3), rpma_msgr_process(3), librpma(7) and
+ * https://pmem.io/rpma/
+ */
+int rpma_msgr_next(struct rpma_msgr *msgr, struct rpma_msgr_msg *msg);
+
+/** 3
+ * rpma_msgr_get_credits - get the number of the peer's credits
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_msgr;
+ *	int rpma_msgr_get_credits(const struct rpma_msgr *msgr,
+ *			uint32_t *credits);
+ *
+ * DESCRIPTION
+ * rpma_msgr_get_credits() gets the number of receive buffers the peer has
+ * posted for the messenger and which have not been used yet.
+ *
+ * RETURN VALUE
+ * The rpma_msgr_get_credits() function returns 0 on success or a negative
+ * error code on failure.
+ *
+ * ERRORS
+ * rpma_msgr_get_credits() can fail with the following error:
+ *
+ * - RPMA_E_INVAL - msgr or credits is NULL
+ *
+ * SEE ALSO
+ * rpma_msgr_new(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_msgr_get_credits(const struct rpma_msgr *msgr, uint32_t *credits);
+
+/* one-sided message queue */
+
+struct rpma_mq;
+
+enum rpma_mq_role {
+	RPMA_MQ_PRODUCER,
+	RPMA_MQ_CONSUMER
+};
+
+/** 3
+ * rpma_mq_new - create one side of a one-sided message queue
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_peer;
+ *	struct rpma_conn;
+ *	struct rpma_mq;
+ *	enum rpma_mq_role {
+ *		RPMA_MQ_PRODUCER,
+ *		RPMA_MQ_CONSUMER
+ *	};
+ *
+ *	int rpma_mq_new(struct rpma_peer *peer, struct rpma_conn *conn,
+ *			enum rpma_mq_role role, uint32_t slots,
+ *			size_t slot_size, struct rpma_mq **mq_ptr);
+ *
+ * DESCRIPTION
+ * rpma_mq_new() creates the producer's or the consumer's side of a message
+ * queue carried only by RDMA writes over the connection. Each side
+ * registers a ring of slots slots of slot_size bytes each. A message
+ * occupies a single slot and can be up to slot_size - 12 bytes long.
+ *
+ * The producer builds the messages in its copy of the ring using
+ * rpma_mq_send(3) and writes all of them to the consumer's ring at once
+ * using rpma_mq_flush(3). The consumer detects the new messages by polling
+ * its ring using rpma_mq_next(3) so it does not post any receive and
+ * does not collect any completion. The consumer returns its progress
+ * to the producer by writing its head to the producer's ring using
+ * rpma_mq_publish(3).
+ *
+ * Both sides have to use the same slots and slot_size values and have
+ * to exchange their descriptors (see rpma_mq_get_descriptor(3)) before
+ * they are connected using rpma_mq_connect(3). A message queue carries
+ * messages in one direction. Two queues are needed for two-way messaging.
+ *
+ * The consumer relies on the RNIC placing the data of an RDMA write
+ * in the increasing order of addresses which holds for all the RNICs
+ * the library is used with.
+ *
+ * RETURN VALUE
+ * The rpma_mq_new() function returns 0 on success or a negative error code
+ * on failure. rpma_mq_new() does not set *mq_ptr value on failure.
+ *
+ * ERRORS
+ * rpma_mq_new() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - peer, conn or mq_ptr is NULL, role is invalid, slots
+ *   is 0, slot_size is not a multiple of 4, is not greater than 12 or
+ *   is greater than UINT32_MAX or the size of the ring overflows
+ * - RPMA_E_NOMEM - out of memory
+ * - RPMA_E_PROVIDER - sysconf(3) failed or registering the ring failed
+ *
+ * SEE ALSO
+ * rpma_mq_connect(3), rpma_mq_delete(3), rpma_mq_flush(3),
+ * rpma_mq_get_descriptor(3), rpma_mq_next(3), rpma_mq_publish(3),
+ * rpma_mq_send(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_mq_new(struct rpma_peer *peer, struct rpma_conn *conn,
+		enum rpma_mq_role role, uint32_t slots, size_t slot_size,
+		struct rpma_mq **mq_ptr);
+
+/** 3
+ * rpma_mq_delete - delete the side of the message queue
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_mq;
+ *	int rpma_mq_delete(struct rpma_mq **mq_ptr);
+ *
+ * DESCRIPTION
+ * rpma_mq_delete() deregisters and frees the ring. The connection has to
+ * be deleted before.
+ *
+ * RETURN VALUE
+ * The rpma_mq_delete() function returns 0 on success or a negative error
+ * code on failure. rpma_mq_delete() sets *mq_ptr value to NULL on success
+ * and on failure.
+ *
+ * ERRORS
+ * rpma_mq_delete() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - mq_ptr is NULL
+ * - RPMA_E_PROVIDER - deregistering the ring or munmap(2) failed
+ *
+ * SEE ALSO
+ * rpma_mq_new(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_mq_delete(struct rpma_mq **mq_ptr);
+
+/** 3
+ * rpma_mq_get_descriptor_size - get the size of the queue descriptor
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_mq;
+ *	int rpma_mq_get_descriptor_size(const struct rpma_mq *mq,
+ *			size_t *desc_size);
+ *
+ * DESCRIPTION
+ * rpma_mq_get_descriptor_size() gets the size of the descriptor written
+ * by rpma_mq_get_descriptor(3).
+ *
+ * RETURN VALUE
+ * The rpma_mq_get_descriptor_size() function returns 0 on success
+ * or a negative error code on failure.
+ *
+ * ERRORS
+ * rpma_mq_get_descriptor_size() can fail with the following error:
+ *
+ * - RPMA_E_INVAL - mq or desc_size is NULL
+ *
+ * SEE ALSO
+ * rpma_mq_get_descriptor(3), rpma_mq_new(3), librpma(7) and
+ * https://pmem.io/rpma/
+ */
+int rpma_mq_get_descriptor_size(const struct rpma_mq *mq, size_t *desc_size);
+
+/** 3
+ * rpma_mq_get_descriptor - get the descriptor of the side of the queue
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_mq;
+ *	int rpma_mq_get_descriptor(const struct rpma_mq *mq, void *desc);
+ *
+ * DESCRIPTION
+ * rpma_mq_get_descriptor() writes a network-transferable description
+ * of the ring and its layout. The descriptor has to be transferred
+ * to the other side of the queue (e.g. as the connection's private data)
+ * and passed to rpma_mq_connect(3) there. The buffer has to be at least
+ * rpma_mq_get_descriptor_size(3) bytes long.
+ *
+ * RETURN VALUE
+ * The rpma_mq_get_descriptor() function returns 0 on success or a negative
+ * error code on failure.
+ *
+ * ERRORS
+ * rpma_mq_get_descriptor() can fail with the following error:
+ *
+ * - RPMA_E_INVAL - mq or desc is NULL
+ *
+ * SEE ALSO
+ * rpma_mq_connect(3), rpma_mq_get_descriptor_size(3), rpma_mq_new(3),
+ * librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_mq_get_descriptor(const struct rpma_mq *mq, void *desc);
+
+/** 3
+ * rpma_mq_connect - connect the side of the queue with the peer's side
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_mq;
+ *	int rpma_mq_connect(struct rpma_mq *mq, const void *desc,
+ *			size_t desc_size);
+ *
+ * DESCRIPTION
+ * rpma_mq_connect() decodes the descriptor of the peer's side of the queue
+ * and checks if the layouts of both rings match. The producer writes
+ * the messages to the consumer's ring described by the descriptor and
+ * the consumer writes its head to the producer's ring.
+ *
+ * RETURN VALUE
+ * The rpma_mq_connect() function returns 0 on success or a negative error
+ * code on failure.
+ *
+ * ERRORS
+ * rpma_mq_connect() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - mq or desc is NULL, the side is already connected,
+ *   the descriptor is too short or the layouts of the rings do not match
+ * - RPMA_E_NOSUPP - the descriptor does not describe a valid memory region
+ * - RPMA_E_NOMEM - out of memory
+ *
+ * SEE ALSO
+ * rpma_mq_get_descriptor(3), rpma_mq_new(3), librpma(7) and
+ * https://pmem.io/rpma/
+ */
+int rpma_mq_connect(struct rpma_mq *mq, const void *desc, size_t desc_size);
+
+/** 3
+ * rpma_mq_send - stage a message in the producer's ring
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_mq;
+ *	int rpma_mq_send(struct rpma_mq *mq, const void *data, size_t len);
+ *
+ * DESCRIPTION
+ * rpma_mq_send() copies the message into the next free slot of
+ * the producer's ring. The message is written to the consumer by the next
+ * rpma_mq_flush(3). A slot is free when the consumer has published
+ * (see rpma_mq_publish(3)) that it has consumed the message the slot held
+ * in the previous lap of the ring.
+ *
+ * RETURN VALUE
+ * The rpma_mq_send() function returns 0 on success or a negative error
+ * code on failure.
+ *
+ * ERRORS
+ * rpma_mq_send() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - mq is NULL, mq is not a producer, data is NULL and len
+ *   is not 0 or the message does not fit in a slot
+ * - RPMA_E_AGAIN - the ring is full
+ *
+ * SEE ALSO
+ * rpma_mq_flush(3), rpma_mq_new(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_mq_send(struct rpma_mq *mq, const void *data, size_t len);
+
+/** 3
+ * rpma_mq_flush - write the staged messages to the consumer
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_mq;
+ *	int rpma_mq_flush(struct rpma_mq *mq, int flags,
+ *			const void *op_context);
+ *
+ * DESCRIPTION
+ * rpma_mq_flush() writes all the messages staged since the previous call
+ * to the consumer's ring with a single RDMA write or with two of them if
+ * the messages wrap around the end of the ring. The flags and op_context
+ * apply to the last write as for rpma_write(3). If there is no message
+ * staged nothing is written and no completion is generated.
+ *
+ * RETURN VALUE
+ * The rpma_mq_flush() function returns 0 on success or a negative error
+ * code on failure.
+ *
+ * ERRORS
+ * rpma_mq_flush() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - mq is NULL, mq is not a producer, mq is not connected
+ *   or flags are not set
+ * - RPMA_E_PROVIDER - ibv_post_send(3) failed
+ *
+ * SEE ALSO
+ * rpma_mq_connect(3), rpma_mq_send(3), rpma_write(3), librpma(7) and
+ * https://pmem.io/rpma/
+ */
+int rpma_mq_flush(struct rpma_mq *mq, int flags, const void *op_context);
+
+/** 3
+ * rpma_mq_next - get the next message written by the producer
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_mq;
+ *	int rpma_mq_next(struct rpma_mq *mq, const void **ptr, size_t *len);
+ *
+ * DESCRIPTION
+ * rpma_mq_next() checks if the next message has been written to
+ * the consumer's ring and if so it gets a view of it. The view stays valid
+ * until the next call to rpma_mq_next(). The function does not block so
+ * the consumer is expected to poll it.
+ *
+ * RETURN VALUE
+ * The rpma_mq_next() function returns 0 on success or a negative error
+ * code on failure.
+ *
+ * ERRORS
+ * rpma_mq_next() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - mq, ptr or len is NULL or mq is not a consumer
+ * - RPMA_E_NO_COMPLETION - the next message has not arrived (yet)
+ *
+ * SEE ALSO
+ * rpma_mq_new(3), rpma_mq_publish(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_mq_next(struct rpma_mq *mq, const void **ptr, size_t *len);
+
+/** 3
+ * rpma_mq_publish - return the consumer's progress to the producer
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_mq;
+ *	int rpma_mq_publish(struct rpma_mq *mq, int flags,
+ *			const void *op_context);
+ *
+ * DESCRIPTION
+ * rpma_mq_publish() writes the number of the messages consumed so far
+ * to the producer so it can reuse their slots. The message currently held
+ * by the application (see rpma_mq_next(3)) is not counted as consumed.
+ * Publishing once per many messages amortizes the cost of the write.
+ * The flags and op_context apply to the write as for rpma_write(3).
+ * If nothing has been consumed since the previous call nothing is written
+ * and no completion is generated.
+ *
+ * RETURN VALUE
+ * The rpma_mq_publish() function returns 0 on success or a negative error
+ * code on failure.
+ *
+ * ERRORS
+ * rpma_mq_publish() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - mq is NULL, mq is not a consumer, mq is not connected
+ *   or flags are not set
+ * - RPMA_E_PROVIDER - ibv_post_send(3) failed
+ *
+ * SEE ALSO
+ * rpma_mq_connect(3), rpma_mq_next(3), rpma_write(3), librpma(7) and
+ * https://pmem.io/rpma/
+ */
+int rpma_mq_publish(struct rpma_mq *mq, int flags, const void *op_context);
+
+/* segmented transfers */
+
+struct rpma_xfer;
+
+/* the default size of a single chunk of a segmented transfer */
+#define RPMA_XFER_CHUNK_SIZE_DEFAULT	(1 << 20)
+/* the maximum size of a single chunk of a segmented transfer */
+#define RPMA_XFER_CHUNK_SIZE_MAX	(1 << 30)
+
+/** 3
+ * rpma_xfer_new - create a new segmented transfer engine
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_conn;
+ *	struct rpma_xfer;
+ *	int rpma_xfer_new(struct rpma_conn *conn, size_t chunk_size,
+ *			uint32_t inflight, struct rpma_xfer **xfer_ptr);
+ *
+ * DESCRIPTION
+ * rpma_xfer_new() creates an engine splitting the read and write operations
+ * of any length into chunks of chunk_size bytes. A single read or write
+ * operation cannot transfer more than UINT32_MAX bytes and the RDMA device
+ * may limit it even further.
+ *
+ * If chunk_size is 0 RPMA_XFER_CHUNK_SIZE_DEFAULT is used. The chunk_size
+ * cannot exceed RPMA_XFER_CHUNK_SIZE_MAX and it is lowered to the maximum
+ * message size of the port of the connection (max_msg_sz, see
+ * ibv_query_port(3)) if the port does not support chunks that large.
+ * At most inflight chunks are posted to the connection at a time
+ * and the engine posts the next chunks as the previous ones complete,
+ * so the SQ and the CQ of the connection have to be able to hold inflight
+ * work requests and completions on top of the ones posted directly
+ * (see rpma_conn_cfg_set_sq_size(3) and rpma_conn_cfg_set_cq_size(3)).
+ * The engine can queue up to inflight transfers at a time.
+ *
+ * RETURN VALUE
+ * The rpma_xfer_new() function returns 0 on success or a negative error
+ * code on failure. rpma_xfer_new() does not set *xfer_ptr value on failure.
+ *
+ * ERRORS
+ * rpma_xfer_new() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - conn or xfer_ptr is NULL, inflight is 0 or chunk_size
+ *   is greater than RPMA_XFER_CHUNK_SIZE_MAX
+ * - RPMA_E_PROVIDER - ibv_query_port(3) failed
+ * - RPMA_E_NOMEM - out of memory
+ *
+ * SEE ALSO
+ * rpma_xfer_delete(3), rpma_xfer_next(3), rpma_xfer_process(3),
+ * rpma_xfer_read(3), rpma_xfer_write(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_xfer_new(struct rpma_conn *conn, size_t chunk_size,
+		uint32_t inflight, struct rpma_xfer **xfer_ptr);
+
+/** 3
+ * rpma_xfer_delete - delete the segmented transfer engine
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_xfer;
+ *	int rpma_xfer_delete(struct rpma_xfer **xfer_ptr);
+ *
+ * DESCRIPTION
+ * rpma_xfer_delete() deletes the segmented transfer engine. The transfers
+ * which have not been completed yet are abandoned.
+ *
+ * RETURN VALUE
+ * The rpma_xfer_delete() function returns 0 on success or a negative error
+ * code on failure. rpma_xfer_delete() does not set *xfer_ptr value to NULL
+ * on failure.
+ *
+ * ERRORS
+ * rpma_xfer_delete() can fail with the following error:
+ *
+ * - RPMA_E_INVAL - xfer_ptr is NULL
+ *
+ * SEE ALSO
+ * rpma_xfer_new(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_xfer_delete(struct rpma_xfer **xfer_ptr);
+
+/** 3
+ * rpma_xfer_read - initiate the segmented read operation
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_xfer;
+ *	struct rpma_mr_local;
+ *	struct rpma_mr_remote;
+ *	int rpma_xfer_read(struct rpma_xfer *xfer,
+ *			struct rpma_mr_local *dst, size_t dst_offset,
+ *			const struct rpma_mr_remote *src, size_t src_offset,
+ *			size_t len, const void *op_context);
+ *
+ * DESCRIPTION
+ * rpma_xfer_read() queues transferring len bytes from the remote memory
+ * to the local memory and posts as many of its chunks as the limit
+ * of the chunks in flight allows (see rpma_xfer_new(3)). The remaining
+ * chunks are posted by rpma_xfer_process(3). When all the chunks are
+ * completed a single completion carrying op_context is returned
+ * by rpma_xfer_next(3).
+ *
+ * RETURN VALUE
+ * The rpma_xfer_read() function returns 0 on success or a negative error
+ * code on failure. No completion is generated for a transfer which failed
+ * to be initiated.
+ *
+ * ERRORS
+ * rpma_xfer_read() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - xfer, dst or src is NULL or len is 0
+ * - RPMA_E_AGAIN - the transfer queue is full
+ * - RPMA_E_PROVIDER - ibv_post_send(3) failed
+ *
+ * SEE ALSO
+ * rpma_read(3), rpma_xfer_new(3), rpma_xfer_next(3), rpma_xfer_process(3),
+ * librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_xfer_read(struct rpma_xfer *xfer,
+		struct rpma_mr_local *dst, size_t dst_offset,
+		const struct rpma_mr_remote *src, size_t src_offset,
+		size_t len, const void *op_context);
+
+/** 3
+ * rpma_xfer_write - initiate the segmented write operation
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_xfer;
+ *	struct rpma_mr_local;
+ *	struct rpma_mr_remote;
+ *	int rpma_xfer_write(struct rpma_xfer *xfer,
+ *			struct rpma_mr_remote *dst, size_t dst_offset,
+ *			const struct rpma_mr_local *src, size_t src_offset,
+ *			size_t len, const void *op_context);
+ *
+ * DESCRIPTION
+ * rpma_xfer_write() works like rpma_xfer_read(3) but it transfers len bytes
+ * from the local memory to the remote memory.
+ *
+ * RETURN VALUE
+ * The rpma_xfer_write() function returns 0 on success or a negative error
+ * code on failure. No completion is generated for a transfer which failed
+ * to be initiated.
+ *
+ * ERRORS
+ * rpma_xfer_write() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - xfer, dst or src is NULL or len is 0
+ * - RPMA_E_AGAIN - the transfer queue is full
+ * - RPMA_E_PROVIDER - ibv_post_send(3) failed
+ *
+ * SEE ALSO
+ * rpma_write(3), rpma_xfer_new(3), rpma_xfer_next(3), rpma_xfer_process(3),
+ * librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_xfer_write(struct rpma_xfer *xfer,
+		struct rpma_mr_remote *dst, size_t dst_offset,
+		const struct rpma_mr_local *src, size_t src_offset,
+		size_t len, const void *op_context);
+
+/** 3
+ * rpma_xfer_process - process a completion of a chunk
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_xfer;
+ *	struct rpma_completion;
+ *	int rpma_xfer_process(struct rpma_xfer *xfer,
+ *			const struct rpma_completion *cmpl);
+ *
+ * DESCRIPTION
+ * rpma_xfer_process() consumes a completion of a chunk collected using
+ * rpma_conn_completion_get(3) and posts the next chunks waiting for a free
+ * slot. A failed chunk fails the whole transfer and its chunks which
+ * have not been posted yet are dropped.
+ *
+ * RETURN VALUE
+ * The rpma_xfer_process() function returns 0 on success or a negative error
+ * code on failure.
+ *
+ * ERRORS
+ * rpma_xfer_process() can fail with the following error:
+ *
+ * - RPMA_E_INVAL - xfer or cmpl is NULL or the completion does not come
+ *   from the engine
+ *
+ * SEE ALSO
+ * rpma_conn_completion_get(3), rpma_xfer_new(3), rpma_xfer_next(3),
+ * librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_xfer_process(struct rpma_xfer *xfer,
+		const struct rpma_completion *cmpl);
+
+/** 3
+ * rpma_xfer_next - get the completion of the next finished transfer
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_xfer;
+ *	struct rpma_completion;
+ *	int rpma_xfer_next(struct rpma_xfer *xfer,
+ *			struct rpma_completion *cmpl);
+ *
+ * DESCRIPTION
+ * rpma_xfer_next() returns the completion of the oldest transfer if all
+ * its chunks have been completed. The transfers are completed in the order
+ * they have been initiated. The op_context of the completion is the one
+ * given to rpma_xfer_read(3) or rpma_xfer_write(3), the op is either
+ * RPMA_OP_READ or RPMA_OP_WRITE and the op_status is IBV_WC_SUCCESS or
+ * the status of the first chunk which failed. The byte_len of the completion
+ * is set to 0.
+ *
+ * RETURN VALUE
+ * The rpma_xfer_next() function returns 0 on success or a negative error
+ * code on failure.
+ *
+ * ERRORS
+ * rpma_xfer_next() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - xfer or cmpl is NULL
+ * - RPMA_E_NO_COMPLETION - no transfer has been finished
+ *
+ * SEE ALSO
+ * rpma_xfer_new(3), rpma_xfer_process(3), librpma(7) and
+ * https://pmem.io/rpma/
+ */
+int rpma_xfer_next(struct rpma_xfer *xfer, struct rpma_completion *cmpl);
+
+/* operations on unregistered memory */
+
+struct rpma_bounce;
+
+/** 3
+ * rpma_bounce_new - create a new engine of bounce buffers
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_peer;
+ *	struct rpma_conn;
+ *	struct rpma_bounce;
+ *	int rpma_bounce_new(struct rpma_peer *peer, struct rpma_conn *conn,
+ *			uint32_t slots, size_t slot_size,
+ *			struct rpma_bounce **bounce_ptr);
+ *
+ * DESCRIPTION
+ * rpma_bounce_new() creates an engine allowing the data which has not been
+ * registered to be written, sent or read over the connection. The engine
+ * allocates and registers slots bounce buffers of slot_size bytes each.
+ * Every operation posted by the engine which is not posted inline takes
+ * one of the slots until its completion is processed by
+ * rpma_bounce_process(3), so at most slots such operations can be
+ * in flight at a time.
+ *
+ * The path of an operation is chosen by its size:
+ *
+ * - the writes and the sends not longer than the maximum inline data size
+ *   of the connection (see rpma_conn_cfg_set_inline_size(3)) are posted
+ *   inline,
+ * - the operations not longer than slot_size are copied through a bounce
+ *   buffer; the copies of at least several kilobytes use non-temporal
+ *   stores where available so they do not pollute the CPU caches,
+ * - the longer operations use the memory of the caller registered on demand.
+ *   The registrations are kept in a small cache and the least recently used
+ *   one which is not in use is replaced when a new one is needed.
+ *
+ * The limits can be lowered using rpma_bounce_set_thresholds(3).
+ * The engine does not work with a connection working in a thread-safe mode
+ * (see rpma_conn_cfg_set_thread_mode(3)).
+ *
+ * RETURN VALUE
+ * The rpma_bounce_new() function returns 0 on success or a negative error
+ * code on failure. rpma_bounce_new() does not set *bounce_ptr value
+ * on failure.
+ *
+ * ERRORS
+ * rpma_bounce_new() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - peer, conn or bounce_ptr is NULL, slots or slot_size is 0,
+ *   slot_size > UINT32_MAX or the size of the bounce buffers overflows
+ * - RPMA_E_NOSUPP - the connection works in a thread-safe mode or collects
+ *   the latency (see rpma_conn_cfg_set_stats(3))
+ * - RPMA_E_NOMEM - out of memory
+ * - RPMA_E_PROVIDER - ibv_query_qp(3) or ibv_reg_mr(3) failed
+ *
+ * SEE ALSO
+ * rpma_bounce_delete(3), rpma_bounce_process(3), rpma_bounce_read(3),
+ * rpma_bounce_send(3), rpma_bounce_set_thresholds(3), rpma_bounce_write(3),
+ * librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_bounce_new(struct rpma_peer *peer, struct rpma_conn *conn,
+		uint32_t slots, size_t slot_size,
+		struct rpma_bounce **bounce_ptr);
+
+/** 3
+ * rpma_bounce_delete - delete the engine of bounce buffers
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_bounce;
+ *	int rpma_bounce_delete(struct rpma_bounce **bounce_ptr);
+ *
+ * DESCRIPTION
+ * rpma_bounce_delete() deregisters and releases the bounce buffers
+ * and the cached registrations of the engine. All the operations posted
+ * by the engine have to be completed before it is deleted.
+ *
+ * RETURN VALUE
+ * The rpma_bounce_delete() function returns 0 on success or a negative error
+ * code on failure. rpma_bounce_delete() sets *bounce_ptr value to NULL
+ * on success and on failure.
+ *
+ * ERRORS
+ * rpma_bounce_delete() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - bounce_ptr is NULL
+ * - RPMA_E_PROVIDER - ibv_dereg_mr(3) or munmap(2) failed
+ *
+ * SEE ALSO
+ * rpma_bounce_new(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_bounce_delete(struct rpma_bounce **bounce_ptr);
+
+/** 3
+ * rpma_bounce_set_thresholds - set the size limits of the paths
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_bounce;
+ *	int rpma_bounce_set_thresholds(struct rpma_bounce *bounce,
+ *			size_t inline_max, size_t copy_max);
+ *
+ * DESCRIPTION
+ * rpma_bounce_set_thresholds() sets the maximum size of a write or a send
+ * posted inline (inline_max) and the maximum size of an operation copied
+ * through a bounce buffer (copy_max). The longer operations use the memory
+ * of the caller registered on demand. By default the limits are the maximum
+ * inline data size of the connection and the size of a bounce buffer
+ * respectively and they cannot be raised above them. Setting both limits
+ * to 0 makes all the operations use the registration cache.
+ *
+ * RETURN VALUE
+ * The rpma_bounce_set_thresholds() function returns 0 on success
+ * or a negative error code on failure.
+ *
+ * ERRORS
+ * rpma_bounce_set_thresholds() can fail with the following error:
+ *
+ * - RPMA_E_INVAL - bounce is NULL, inline_max exceeds the maximum inline
+ *   data size of the connection or copy_max exceeds the size of a bounce
+ *   buffer
+ *
+ * SEE ALSO
+ * rpma_bounce_get_thresholds(3), rpma_bounce_new(3), librpma(7) and
+ * https://pmem.io/rpma/
+ */
+int rpma_bounce_set_thresholds(struct rpma_bounce *bounce, size_t inline_max,
+		size_t copy_max);
+
+/** 3
+ * rpma_bounce_get_thresholds - get the size limits of the paths
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_bounce;
+ *	int rpma_bounce_get_thresholds(const struct rpma_bounce *bounce,
+ *			size_t *inline_max, size_t *copy_max);
+ *
+ * DESCRIPTION
+ * rpma_bounce_get_thresholds() gets the maximum size of a write or a send
+ * posted inline and the maximum size of an operation copied through
+ * a bounce buffer.
+ *
+ * RETURN VALUE
+ * The rpma_bounce_get_thresholds() function returns 0 on success
+ * or a negative error code on failure.
+ *
+ * ERRORS
+ * rpma_bounce_get_thresholds() can fail with the following error:
+ *
+ * - RPMA_E_INVAL - bounce, inline_max or copy_max is NULL
+ *
+ * SEE ALSO
+ * rpma_bounce_new(3), rpma_bounce_set_thresholds(3), librpma(7) and
+ * https://pmem.io/rpma/
+ */
+int rpma_bounce_get_thresholds(const struct rpma_bounce *bounce,
+		size_t *inline_max, size_t *copy_max);
+
+/** 3
+ * rpma_bounce_write - initiate the write operation from unregistered memory
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_bounce;
+ *	struct rpma_mr_remote;
+ *	int rpma_bounce_write(struct rpma_bounce *bounce,
+ *			struct rpma_mr_remote *dst, size_t dst_offset,
+ *			const void *src, size_t len, int flags,
+ *			const void *op_context);
+ *
+ * DESCRIPTION
+ * rpma_bounce_write() initiates transferring len bytes from the local memory
+ * pointed by src to the remote memory. The flags and the op_context have
+ * the same meaning as for rpma_write(3). The memory pointed by src can be
+ * reused as soon as rpma_bounce_write() returns if the write is posted
+ * inline or copied through a bounce buffer. Otherwise it cannot be modified
+ * until the operation is completed.
+ *
+ * The completion of a write posted inline carries the op_context directly.
+ * The completions of the other writes are generated always and they have
+ * to be passed to rpma_bounce_process(3) which translates them.
+ *
+ * RETURN VALUE
+ * The rpma_bounce_write() function returns 0 on success or a negative error
+ * code on failure.
+ *
+ * ERRORS
+ * rpma_bounce_write() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - bounce, dst or src is NULL, len is 0 or flags are not set
+ * - RPMA_E_AGAIN - all the slots are in use or all the cached registrations
+ *   are in use
+ * - RPMA_E_PROVIDER - ibv_post_send(3) or ibv_reg_mr(3) failed
+ *
+ * SEE ALSO
+ * rpma_bounce_new(3), rpma_bounce_process(3), rpma_write(3), librpma(7)
+ * and https://pmem.io/rpma/
+ */
+int rpma_bounce_write(struct rpma_bounce *bounce,
+		struct rpma_mr_remote *dst, size_t dst_offset,
+		const void *src, size_t len, int flags, const void *op_context);
+
+/** 3
+ * rpma_bounce_send - initiate the send operation from unregistered memory
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_bounce;
+ *	int rpma_bounce_send(struct rpma_bounce *bounce, const void *src,
+ *			size_t len, int flags, const void *op_context);
+ *
+ * DESCRIPTION
+ * rpma_bounce_send() works like rpma_bounce_write(3) but it initiates
+ * the send operation (see rpma_send(3)) of len bytes pointed by src.
+ *
+ * RETURN VALUE
+ * The rpma_bounce_send() function returns 0 on success or a negative error
+ * code on failure.
+ *
+ * ERRORS
+ * rpma_bounce_send() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - bounce or src is NULL, len is 0 or flags are not set
+ * - RPMA_E_AGAIN - all the slots are in use or all the cached registrations
+ *   are in use
+ * - RPMA_E_PROVIDER - ibv_post_send(3) or ibv_reg_mr(3) failed
+ *
+ * SEE ALSO
+ * rpma_bounce_new(3), rpma_bounce_process(3), rpma_send(3), librpma(7)
+ * and https://pmem.io/rpma/
+ */
+int rpma_bounce_send(struct rpma_bounce *bounce, const void *src,
+		size_t len, int flags, const void *op_context);
+
+/** 3
+ * rpma_bounce_read - initiate the read operation to unregistered memory
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_bounce;
+ *	struct rpma_mr_remote;
+ *	int rpma_bounce_read(struct rpma_bounce *bounce, void *dst,
+ *			const struct rpma_mr_remote *src, size_t src_offset,
+ *			size_t len, int flags, const void *op_context);
+ *
+ * DESCRIPTION
+ * rpma_bounce_read() initiates transferring len bytes from the remote memory
+ * to the local memory pointed by dst. The flags and the op_context have
+ * the same meaning as for rpma_read(3). A read which is not longer than
+ * a bounce buffer lands in the bounce buffer and it is copied to dst
+ * by rpma_bounce_process(3). The completions of the reads are generated
+ * always and they have to be passed to rpma_bounce_process(3) which
+ * translates them. The content of dst is undefined until then.
+ *
+ * RETURN VALUE
+ * The rpma_bounce_read() function returns 0 on success or a negative error
+ * code on failure.
+ *
+ * ERRORS
+ * rpma_bounce_read() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - bounce, dst or src is NULL, len is 0 or flags are not set
+ * - RPMA_E_AGAIN - all the slots are in use or all the cached registrations
+ *   are in use
+ * - RPMA_E_PROVIDER - ibv_post_send(3) or ibv_reg_mr(3) failed
+ *
+ * SEE ALSO
+ * rpma_bounce_new(3), rpma_bounce_process(3), rpma_read(3), librpma(7)
+ * and https://pmem.io/rpma/
+ */
+int rpma_bounce_read(struct rpma_bounce *bounce, void *dst,
+		const struct rpma_mr_remote *src, size_t src_offset,
+		size_t len, int flags, const void *op_context);
+
+/** 3
+ * rpma_bounce_process - process a completion of an operation of the engine
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_bounce;
+ *	struct rpma_completion;
+ *	int rpma_bounce_process(struct rpma_bounce *bounce,
+ *			struct rpma_completion *cmpl);
+ *
+ * DESCRIPTION
+ * rpma_bounce_process() consumes a completion collected using
+ * rpma_conn_completion_get(3) of an operation posted by the engine through
+ * a bounce buffer or the registration cache. It copies the data of
+ * a successful read out of its bounce buffer, releases the slot
+ * of the operation and replaces the op_context of the completion with
+ * the one given by the caller when the operation was initiated.
+ * The completions of the operations posted inline do not belong
+ * to the engine.
+ *
+ * RETURN VALUE
+ * The rpma_bounce_process() function returns 0 on success or a negative error
+ * code on failure.
+ *
+ * ERRORS
+ * rpma_bounce_process() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - bounce or cmpl is NULL or the completion does not come
+ *   from the engine
+ * - RPMA_E_NO_COMPLETION - the operation succeeded and its completion
+ *   has not been requested (RPMA_F_COMPLETION_ON_ERROR)
+ *
+ * SEE ALSO
+ * rpma_bounce_new(3), rpma_conn_completion_get(3), librpma(7) and
+ * https://pmem.io/rpma/
+ */
+int rpma_bounce_process(struct rpma_bounce *bounce,
+		struct rpma_completion *cmpl);
+
+/** 3
+ * rpma_bounce_invalidate - drop the cached registrations of the memory
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_bounce;
+ *	int rpma_bounce_invalidate(struct rpma_bounce *bounce, const void *ptr,
+ *			size_t len);
+ *
+ * DESCRIPTION
+ * rpma_bounce_invalidate() deregisters all the cached registrations
+ * overlapping the len bytes of memory pointed by ptr. It has to be called
+ * before the memory is released or remapped since a registration keeps
+ * referring to the pages the memory was backed by when it was registered.
+ *
+ * RETURN VALUE
+ * The rpma_bounce_invalidate() function returns 0 on success or a negative
+ * error code on failure.
+ *
+ * ERRORS
+ * rpma_bounce_invalidate() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - bounce or ptr is NULL or len is 0
+ * - RPMA_E_AGAIN - an operation using the memory is still in flight;
+ *   no registration is dropped in such a case
+ * - RPMA_E_PROVIDER - ibv_dereg_mr(3) failed
+ *
+ * SEE ALSO
+ * rpma_bounce_new(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_bounce_invalidate(struct rpma_bounce *bounce, const void *ptr,
+		size_t len);
+
+/* write-combining buffers */
+
+struct rpma_wcomb;
+
+/** 3
+ * rpma_wcomb_new - create a new write-combining layer
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_peer;
+ *	struct rpma_conn;
+ *	struct rpma_mr_remote;
+ *	struct rpma_wcomb;
+ *	int rpma_wcomb_new(struct rpma_peer *peer, struct rpma_conn *conn,
+ *			struct rpma_mr_remote *dst, uint32_t bufs,
+ *			size_t buf_size, struct rpma_wcomb **wcomb_ptr);
+ *
+ * DESCRIPTION
+ * rpma_wcomb_new() creates a write-combining layer for the small writes
+ * to the dst remote memory region over the conn connection. It allocates
+ * and registers bufs staging buffers of buf_size bytes each.
+ *
+ * The writes initiated by rpma_wcomb_write(3) are copied to the open
+ * staging buffer as long as each of them overlaps or adjoins the data
+ * gathered so far and all of them fit in buf_size bytes starting
+ * at the offset of the first one. The open buffer is posted as a single
+ * RDMA write when:
+ *
+ * - a write does not fit in it or would leave a hole in it (the RDMA write
+ *   of the whole range would overwrite the remote data in the hole),
+ * - it gets full,
+ * - it is older than the timeout (see rpma_wcomb_set_timeout(3)),
+ * - rpma_wcomb_flush(3) or rpma_wcomb_post(3) is called.
+ *
+ * The buffers are posted in the order of the writes they gather so
+ * the ordering of the writes is kept. The other operations touching
+ * the remote memory region have to be posted after rpma_wcomb_post(3)
+ * and the region has to be flushed using rpma_wcomb_flush(3) instead of
+ * rpma_flush(3) so they are not overtaken by the writes still gathered.
+ *
+ * RETURN VALUE
+ * The rpma_wcomb_new() function returns 0 on success or a negative error
+ * code on failure. rpma_wcomb_new() does not set *wcomb_ptr value
+ * on failure.
+ *
+ * ERRORS
+ * rpma_wcomb_new() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - peer, conn, dst or wcomb_ptr is NULL, bufs or buf_size
+ *   is 0 or the size of the staging buffers overflows
+ * - RPMA_E_NOMEM - out of memory
+ * - RPMA_E_PROVIDER - sysconf(3) or ibv_reg_mr(3) failed
+ *
+ * SEE ALSO
+ * rpma_conn_req_connect(3), rpma_mr_remote_from_descriptor(3),
+ * rpma_wcomb_delete(3), rpma_wcomb_flush(3), rpma_wcomb_process(3),
+ * rpma_wcomb_write(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_wcomb_new(struct rpma_peer *peer, struct rpma_conn *conn,
+		struct rpma_mr_remote *dst, uint32_t bufs, size_t buf_size,
+		struct rpma_wcomb **wcomb_ptr);
+
+/** 3
+ * rpma_wcomb_delete - delete the write-combining layer
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_wcomb;
+ *	int rpma_wcomb_delete(struct rpma_wcomb **wcomb_ptr);
+ *
+ * DESCRIPTION
+ * rpma_wcomb_delete() deregisters and releases the staging buffers.
+ * The data gathered in the open buffer is dropped. All the posted buffers
+ * have to be completed before the layer is deleted.
+ *
+ * RETURN VALUE
+ * The rpma_wcomb_delete() function returns 0 on success or a negative error
+ * code on failure. rpma_wcomb_delete() sets *wcomb_ptr value to NULL
+ * on success and on failure.
+ *
+ * ERRORS
+ * rpma_wcomb_delete() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - wcomb_ptr is NULL
+ * - RPMA_E_PROVIDER - ibv_dereg_mr(3) or munmap(2) failed
+ *
+ * SEE ALSO
+ * rpma_wcomb_new(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_wcomb_delete(struct rpma_wcomb **wcomb_ptr);
+
+/** 3
+ * rpma_wcomb_set_timeout - set the maximum age of the open buffer
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_wcomb;
+ *	int rpma_wcomb_set_timeout(struct rpma_wcomb *wcomb,
+ *			uint64_t timeout_us);
+ *
+ * DESCRIPTION
+ * rpma_wcomb_set_timeout() sets the time in microseconds after which
+ * the open buffer is posted regardless of how much data it has gathered.
+ * The age is checked by rpma_wcomb_write(3) and rpma_wcomb_progress(3)
+ * so the latter has to be called periodically (e.g. whenever the completions
+ * are polled) for the timeout to take effect while no writes are issued.
+ * The timeout of 0 (the default) turns it off.
+ *
+ * RETURN VALUE
+ * The rpma_wcomb_set_timeout() function returns 0 on success or a negative
+ * error code on failure.
+ *
+ * ERRORS
+ * rpma_wcomb_set_timeout() can fail with the following error:
+ *
+ * - RPMA_E_INVAL - wcomb is NULL
+ *
+ * SEE ALSO
+ * rpma_wcomb_new(3), rpma_wcomb_progress(3), librpma(7) and
+ * https://pmem.io/rpma/
+ */
+int rpma_wcomb_set_timeout(struct rpma_wcomb *wcomb, uint64_t timeout_us);
+
+/** 3
+ * rpma_wcomb_write - gather the write in the open buffer
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_wcomb;
+ *	int rpma_wcomb_write(struct rpma_wcomb *wcomb, size_t dst_offset,
+ *			const void *src, size_t len);
+ *
+ * DESCRIPTION
+ * rpma_wcomb_write() copies len bytes pointed by src to the open buffer
+ * of the layer so they are written to the remote memory region at
+ * dst_offset. If the write cannot be gathered in the open buffer the open
+ * buffer is posted and the write starts a new one. The src memory can be
+ * reused as soon as the function returns.
+ *
+ * RETURN VALUE
+ * The rpma_wcomb_write() function returns 0 on success or a negative error
+ * code on failure.
+ *
+ * ERRORS
+ * rpma_wcomb_write() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - wcomb or src is NULL, len is 0 or len is greater than
+ *   the size of the staging buffer
+ * - RPMA_E_AGAIN - no staging buffer is free; the write is not gathered
+ *   and it has to be repeated after processing the completions
+ *   of the posted buffers
+ * - RPMA_E_PROVIDER - ibv_post_send(3) failed; if the open buffer has been
+ *   posted because it got full or too old the write has been gathered
+ *   and posting can be repeated using rpma_wcomb_post(3)
+ *
+ * SEE ALSO
+ * rpma_wcomb_new(3), rpma_wcomb_process(3), librpma(7) and
+ * https://pmem.io/rpma/
+ */
+int rpma_wcomb_write(struct rpma_wcomb *wcomb, size_t dst_offset,
+		const void *src, size_t len);
+
+/** 3
+ * rpma_wcomb_progress - post the open buffer if it is too old
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_wcomb;
+ *	int rpma_wcomb_progress(struct rpma_wcomb *wcomb);
+ *
+ * DESCRIPTION
+ * rpma_wcomb_progress() posts the open buffer if it has gathered its first
+ * write earlier than the timeout ago (see rpma_wcomb_set_timeout(3)).
+ *
+ * RETURN VALUE
+ * The rpma_wcomb_progress() function returns 0 on success or a negative
+ * error code on failure.
+ *
+ * ERRORS
+ * rpma_wcomb_progress() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - wcomb is NULL
+ * - RPMA_E_PROVIDER - ibv_post_send(3) failed
+ *
+ * SEE ALSO
+ * rpma_wcomb_new(3), rpma_wcomb_set_timeout(3), librpma(7) and
+ * https://pmem.io/rpma/
+ */
+int rpma_wcomb_progress(struct rpma_wcomb *wcomb);
+
+/** 3
+ * rpma_wcomb_post - post the open buffer
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_wcomb;
+ *	int rpma_wcomb_post(struct rpma_wcomb *wcomb);
+ *
+ * DESCRIPTION
+ * rpma_wcomb_post() posts the open buffer (if any) as a single RDMA write.
+ * It has to be called before any other operation touching the remote
+ * memory region is posted so the operation is ordered after all the writes
+ * initiated so far.
+ *
+ * RETURN VALUE
+ * The rpma_wcomb_post() function returns 0 on success or a negative error
+ * code on failure.
+ *
+ * ERRORS
+ * rpma_wcomb_post() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - wcomb is NULL
+ * - RPMA_E_PROVIDER - ibv_post_send(3) failed
+ *
+ * SEE ALSO
+ * rpma_wcomb_new(3), rpma_wcomb_flush(3), librpma(7) and
+ * https://pmem.io/rpma/
+ */
+int rpma_wcomb_post(struct rpma_wcomb *wcomb);
+
+/** 3
+ * rpma_wcomb_flush - post the open buffer and flush the remote memory
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_wcomb;
+ *	int rpma_wcomb_flush(struct rpma_wcomb *wcomb, size_t dst_offset,
+ *			size_t len, enum rpma_flush_type type, int flags,
+ *			const void *op_context);
+ *
+ * DESCRIPTION
+ * rpma_wcomb_flush() posts the open buffer (if any) and then initiates
+ * the flush of len bytes of the remote memory region starting
+ * at dst_offset (see rpma_flush(3)). The flush is posted after all
+ * the writes gathered so far so its completion guarantees they have
+ * reached the requested domain. Its completion is delivered with
+ * the given op_context and it does not belong to the layer.
+ *
+ * RETURN VALUE
+ * The rpma_wcomb_flush() function returns 0 on success or a negative error
+ * code on failure.
+ *
+ * ERRORS
+ * rpma_wcomb_flush() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - wcomb is NULL, flags are not set or unknown type value
+ * - RPMA_E_NOSUPP - type is RPMA_FLUSH_TYPE_PERSISTENT and
+ *   the direct write to pmem is not supported
+ * - RPMA_E_PROVIDER - ibv_post_send(3) failed
+ *
+ * SEE ALSO
+ * rpma_flush(3), rpma_wcomb_new(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_wcomb_flush(struct rpma_wcomb *wcomb, size_t dst_offset, size_t len,
+		enum rpma_flush_type type, int flags, const void *op_context);
+
+/** 3
+ * rpma_wcomb_process - process a completion of a posted buffer
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_wcomb;
+ *	struct rpma_completion;
+ *	int rpma_wcomb_process(struct rpma_wcomb *wcomb,
+ *			const struct rpma_completion *cmpl);
+ *
+ * DESCRIPTION
+ * rpma_wcomb_process() consumes a completion collected using
+ * rpma_conn_completion_get(3) of an RDMA write posted by the layer.
+ * The staging buffer of the write can be reused afterwards.
+ *
+ * RETURN VALUE
+ * The rpma_wcomb_process() function returns 0 on success or a negative error
+ * code on failure.
+ *
+ * ERRORS
+ * rpma_wcomb_process() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - wcomb or cmpl is NULL or the completion does not come
+ *   from the layer
+ * - RPMA_E_PROVIDER - the write completed with an error
+ *
+ * SEE ALSO
+ * rpma_conn_completion_get(3), rpma_wcomb_new(3), librpma(7) and
+ * https://pmem.io/rpma/
+ */
+int rpma_wcomb_process(struct rpma_wcomb *wcomb,
+		const struct rpma_completion *cmpl);
+
+/* read cache */
+
+struct rpma_rcache;
+
+/** 3
+ * rpma_rcache_new - create a new read cache
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_peer;
+ *	struct rpma_conn;
+ *	struct rpma_mr_remote;
+ *	struct rpma_rcache;
+ *	int rpma_rcache_new(struct rpma_peer *peer, struct rpma_conn *conn,
+ *			const struct rpma_mr_remote *src,
+ *			size_t version_offset, size_t block_size,
+ *			uint32_t blocks, uint32_t depth,
+ *			struct rpma_rcache **rcache_ptr);
+ *
+ * DESCRIPTION
+ * rpma_rcache_new() creates a cache of the src remote memory region read
+ * over the conn connection. It allocates and registers an arena of blocks
+ * blocks of block_size bytes each. The region is split into blocks
+ * of the same size and every block of the region can be kept in one of
+ * the few blocks of the arena (the arena is 4-way set-associative).
+ * The least recently used block is evicted when needed. Up to depth reads
+ * (see rpma_rcache_read(3)) can be in progress at a time.
+ *
+ * The remote side has to keep an 8-byte version word at version_offset
+ * of the region and change it (e.g. using rpma_write_atomic(3)) whenever
+ * it modifies the cached data. The version word is read by
+ * rpma_rcache_validate(3) and all the cached blocks are dropped when it
+ * changes. The blocks cached before the first validation are dropped too.
+ *
+ * RETURN VALUE
+ * The rpma_rcache_new() function returns 0 on success or a negative error
+ * code on failure. rpma_rcache_new() does not set *rcache_ptr value
+ * on failure.
+ *
+ * ERRORS
+ * rpma_rcache_new() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - peer, conn, src or rcache_ptr is NULL, block_size,
+ *   blocks or depth is 0, version_offset is not aligned
+ *   to RPMA_ATOMIC_ALIGNMENT or the version word does not fit in the region
+ *   or the size of the arena overflows
+ * - RPMA_E_NOMEM - out of memory
+ * - RPMA_E_PROVIDER - sysconf(3) or ibv_reg_mr(3) failed
+ *
+ * SEE ALSO
+ * rpma_conn_req_connect(3), rpma_mr_remote_from_descriptor(3),
+ * rpma_rcache_delete(3), rpma_rcache_next(3), rpma_rcache_process(3),
+ * rpma_rcache_read(3), rpma_rcache_submit(3), rpma_rcache_validate(3),
+ * librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_rcache_new(struct rpma_peer *peer, struct rpma_conn *conn,
+		const struct rpma_mr_remote *src, size_t version_offset,
+		size_t block_size, uint32_t blocks, uint32_t depth,
+		struct rpma_rcache **rcache_ptr);
+
+/** 3
+ * rpma_rcache_delete - delete the read cache
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_rcache;
+ *	int rpma_rcache_delete(struct rpma_rcache **rcache_ptr);
+ *
+ * DESCRIPTION
+ * rpma_rcache_delete() deregisters and releases the arena of the cache.
+ * All the posted reads have to be completed before the cache is deleted.
+ *
+ * RETURN VALUE
+ * The rpma_rcache_delete() function returns 0 on success or a negative
+ * error code on failure. rpma_rcache_delete() sets *rcache_ptr value
+ * to NULL on success and on failure.
+ *
+ * ERRORS
+ * rpma_rcache_delete() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - rcache_ptr is NULL
+ * - RPMA_E_PROVIDER - ibv_dereg_mr(3) or munmap(2) failed
+ *
+ * SEE ALSO
+ * rpma_rcache_new(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_rcache_delete(struct rpma_rcache **rcache_ptr);
+
+/** 3
+ * rpma_rcache_read - read the data through the cache
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_rcache;
+ *	int rpma_rcache_read(struct rpma_rcache *rcache, void *dst,
+ *			size_t src_offset, size_t len,
+ *			const void *op_context);
+ *
+ * DESCRIPTION
+ * rpma_rcache_read() initiates copying len bytes of the remote memory region
+ * starting at src_offset to the local memory pointed by dst. The cached
+ * blocks are copied immediately. The missing ones are queued and read
+ * by rpma_rcache_submit(3) so the misses of many reads can be gathered
+ * and the adjacent ones are read at once. The dst memory does not have
+ * to be registered.
+ *
+ * When all the data is copied the read is completed and its completion
+ * with the given op_context can be collected by rpma_rcache_next(3).
+ * The read served entirely from the cache is completed immediately.
+ *
+ * RETURN VALUE
+ * The rpma_rcache_read() function returns 0 on success or a negative error
+ * code on failure.
+ *
+ * ERRORS
+ * rpma_rcache_read() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - rcache or dst is NULL, len is 0, the data does not fit
+ *   in the region or it spans more blocks than the number of sets
+ *   of the arena (blocks / 4)
+ * - RPMA_E_AGAIN - depth reads are in progress or all the blocks the data
+ *   could be cached in are being read; nothing is changed and the read
+ *   has to be repeated after processing the completions
+ *
+ * SEE ALSO
+ * rpma_rcache_new(3), rpma_rcache_next(3), rpma_rcache_submit(3),
+ * librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_rcache_read(struct rpma_rcache *rcache, void *dst,
+		size_t src_offset, size_t len, const void *op_context);
+
+/** 3
+ * rpma_rcache_submit - read the queued misses
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_rcache;
+ *	int rpma_rcache_submit(struct rpma_rcache *rcache);
+ *
+ * DESCRIPTION
+ * rpma_rcache_submit() posts the reads of the blocks queued by
+ * rpma_rcache_read(3). The misses of the consecutive blocks of the region
+ * which are placed next to each other in the arena are read using a single
+ * rpma_read(3). The completions of the posted reads have to be passed
+ * to rpma_rcache_process(3).
+ *
+ * RETURN VALUE
+ * The rpma_rcache_submit() function returns 0 on success or a negative
+ * error code on failure.
+ *
+ * ERRORS
+ * rpma_rcache_submit() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - rcache is NULL
+ * - RPMA_E_PROVIDER - ibv_post_send(3) failed; the reads waiting for
+ *   the blocks which have not been posted are completed with an error
+ *
+ * SEE ALSO
+ * rpma_rcache_new(3), rpma_rcache_process(3), rpma_rcache_read(3),
+ * librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_rcache_submit(struct rpma_rcache *rcache);
+
+/** 3
+ * rpma_rcache_validate - read the version word of the region
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_rcache;
+ *	int rpma_rcache_validate(struct rpma_rcache *rcache);
+ *
+ * DESCRIPTION
+ * rpma_rcache_validate() posts the read of the version word of the remote
+ * memory region. When its completion is processed by
+ * rpma_rcache_process(3) and the version has changed all the cached blocks
+ * are dropped. The completions of a connection come in the order of posting
+ * so the blocks which have been read before the version word are dropped
+ * too while the ones still being read are newer than the version word.
+ *
+ * How often the cache is validated is up to the application. The data
+ * read from the cache can be as old as the last validation.
+ *
+ * RETURN VALUE
+ * The rpma_rcache_validate() function returns 0 on success or a negative
+ * error code on failure.
+ *
+ * ERRORS
+ * rpma_rcache_validate() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - rcache is NULL
+ * - RPMA_E_AGAIN - the version word is being read already
+ * - RPMA_E_PROVIDER - ibv_post_send(3) failed
+ *
+ * SEE ALSO
+ * rpma_rcache_invalidate(3), rpma_rcache_new(3), rpma_rcache_process(3),
+ * librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_rcache_validate(struct rpma_rcache *rcache);
+
+/** 3
+ * rpma_rcache_invalidate - drop the cached blocks of the range
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_rcache;
+ *	int rpma_rcache_invalidate(struct rpma_rcache *rcache,
+ *			size_t src_offset, size_t len);
+ *
+ * DESCRIPTION
+ * rpma_rcache_invalidate() drops the cached blocks holding any of len bytes
+ * of the remote memory region starting at src_offset e.g. when the client
+ * has modified them itself. The blocks being read are not affected.
+ *
+ * RETURN VALUE
+ * The rpma_rcache_invalidate() function returns 0 on success or a negative
+ * error code on failure.
+ *
+ * ERRORS
+ * rpma_rcache_invalidate() can fail with the following error:
+ *
+ * - RPMA_E_INVAL - rcache is NULL, len is 0 or the range does not fit
+ *   in the region
+ *
+ * SEE ALSO
+ * rpma_rcache_new(3), rpma_rcache_validate(3), librpma(7) and
+ * https://pmem.io/rpma/
+ */
+int rpma_rcache_invalidate(struct rpma_rcache *rcache, size_t src_offset,
+		size_t len);
+
+/** 3
+ * rpma_rcache_process - process a completion of a read of the cache
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_rcache;
+ *	struct rpma_completion;
+ *	int rpma_rcache_process(struct rpma_rcache *rcache,
+ *			const struct rpma_completion *cmpl);
+ *
+ * DESCRIPTION
+ * rpma_rcache_process() consumes a completion collected using
+ * rpma_conn_completion_get(3) of a read posted by rpma_rcache_submit(3)
+ * or rpma_rcache_validate(3). The data of the blocks read is copied
+ * to the reads waiting for it and the reads which get all their data
+ * are completed (see rpma_rcache_next(3)). A failed read of the blocks
+ * is reported by the completions of the reads waiting for them.
+ *
+ * RETURN VALUE
+ * The rpma_rcache_process() function returns 0 on success or a negative
+ * error code on failure.
+ *
+ * ERRORS
+ * rpma_rcache_process() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - rcache or cmpl is NULL or the completion does not come
+ *   from the cache
+ * - RPMA_E_PROVIDER - the read of the version word completed with an error
+ *
+ * SEE ALSO
+ * rpma_conn_completion_get(3), rpma_rcache_new(3), rpma_rcache_next(3),
+ * librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_rcache_process(struct rpma_rcache *rcache,
+		const struct rpma_completion *cmpl);
+
+/** 3
+ * rpma_rcache_next - get a completion of a finished read
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_rcache;
+ *	struct rpma_completion;
+ *	int rpma_rcache_next(struct rpma_rcache *rcache,
+ *			struct rpma_completion *cmpl);
+ *
+ * DESCRIPTION
+ * rpma_rcache_next() fills cmpl with the completion of the read initiated
+ * by rpma_rcache_read(3) which has been finished first. The op_context
+ * of the completion is the one of the read and its op is RPMA_OP_READ.
+ * The op_status is IBV_WC_SUCCESS if all the data has been copied to dst
+ * or the status of the first failed read of its blocks otherwise.
+ *
+ * RETURN VALUE
+ * The rpma_rcache_next() function returns 0 on success or a negative error
+ * code on failure.
+ *
+ * ERRORS
+ * rpma_rcache_next() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - rcache or cmpl is NULL
+ * - RPMA_E_NO_COMPLETION - no read has been finished
+ *
+ * SEE ALSO
+ * rpma_rcache_new(3), rpma_rcache_process(3), rpma_rcache_read(3),
+ * librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_rcache_next(struct rpma_rcache *rcache,
+		struct rpma_completion *cmpl);
+
+/* replication groups */
+
+struct rpma_repl;
+
+/** 3
+ * rpma_repl_new - create a new replication group
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_conn;
+ *	struct rpma_mr_remote;
+ *	struct rpma_repl;
+ *	int rpma_repl_new(struct rpma_conn *const *conns,
+ *			struct rpma_mr_remote *const *dsts, uint32_t members,
+ *			uint32_t quorum, uint32_t depth,
+ *			struct rpma_repl **repl_ptr);
+ *
+ * DESCRIPTION
+ * rpma_repl_new() creates a group of members replicas. The i-th replica
+ * is the dsts[i] remote memory region reached over the conns[i] connection.
+ * All the regions have to be able to hold the replicated data at the same
+ * offsets. A replicated write (see rpma_repl_write(3)) is finished when
+ * quorum of the replicas have flushed it. Up to depth replicated writes
+ * can be in progress at a time.
+ *
+ * The connections may use separate completion queues. The completions
+ * of the replicated writes collected from any of them have to be passed
+ * to rpma_repl_process(3).
+ *
+ * RETURN VALUE
+ * The rpma_repl_new() function returns 0 on success or a negative error
+ * code on failure. rpma_repl_new() does not set *repl_ptr value on failure.
+ *
+ * ERRORS
+ * rpma_repl_new() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - conns, dsts, any of their elements or repl_ptr is NULL,
+ *   members, quorum or depth is 0, quorum is greater than members
+ *   or members * depth is too big
+ * - RPMA_E_NOMEM - out of memory
+ *
+ * SEE ALSO
+ * rpma_conn_req_connect(3), rpma_mr_remote_from_descriptor(3),
+ * rpma_repl_delete(3), rpma_repl_get_slowest(3), rpma_repl_next(3),
+ * rpma_repl_process(3), rpma_repl_write(3), librpma(7) and
+ * https://pmem.io/rpma/
+ */
+int rpma_repl_new(struct rpma_conn *const *conns,
+		struct rpma_mr_remote *const *dsts, uint32_t members,
+		uint32_t quorum, uint32_t depth, struct rpma_repl **repl_ptr);
+
+/** 3
+ * rpma_repl_delete - delete the replication group
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_repl;
+ *	int rpma_repl_delete(struct rpma_repl **repl_ptr);
+ *
+ * DESCRIPTION
+ * rpma_repl_delete() deletes the replication group. The connections and
+ * the remote memory regions of the replicas are not affected. All
+ * the replicated writes have to be completed by all the replicas before
+ * the group is deleted.
+ *
+ * RETURN VALUE
+ * The rpma_repl_delete() function returns 0 on success or a negative error
+ * code on failure. rpma_repl_delete() does not set *repl_ptr value to NULL
+ * on failure.
+ *
+ * ERRORS
+ * rpma_repl_delete() can fail with the following error:
+ *
+ * - RPMA_E_INVAL - repl_ptr is NULL
+ *
+ * SEE ALSO
+ * rpma_repl_new(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_repl_delete(struct rpma_repl **repl_ptr);
+
+/** 3
+ * rpma_repl_write - initiate the replicated write operation
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_repl;
+ *	struct rpma_mr_local;
+ *	enum rpma_flush_type {
+ *		RPMA_FLUSH_TYPE_PERSISTENT,
+ *		RPMA_FLUSH_TYPE_VISIBILITY,
+ *	};
+ *	int rpma_repl_write(struct rpma_repl *repl, size_t dst_offset,
+ *			const struct rpma_mr_local *src, size_t src_offset,
+ *			size_t len, enum rpma_flush_type type,
+ *			const void *op_context);
+ *
+ * DESCRIPTION
+ * rpma_repl_write() posts to every replica of the group the write of len
+ * bytes of the src local memory region starting at src_offset to its remote
+ * memory region at dst_offset followed by the flush of the type
+ * (see rpma_flush(3)) of the written range. Only the failed writes
+ * generate completions so every replica acknowledges the replicated write
+ * by the completion of its flush.
+ *
+ * When quorum of the replicas have flushed the data or so many of them
+ * have failed that the quorum cannot be reached the replicated write
+ * is finished and its completion with the given op_context can be
+ * collected by rpma_repl_next(3). The src memory cannot be modified until
+ * all the replicas have completed the replicated write.
+ *
+ * If the flush cannot be posted to a replica after its write has been
+ * posted the replica fails the replicated write at once but the slot of
+ * the replicated write is kept until the write of the replica is known to
+ * be completed: either by its error completion or by any later completion
+ * of the replica passed to rpma_repl_process(3). It holds also when posting
+ * has failed for all the replicas and the replicated write is not
+ * reported by rpma_repl_next(3).
+ *
+ * RETURN VALUE
+ * The rpma_repl_write() function returns 0 on success or a negative error
+ * code on failure.
+ *
+ * ERRORS
+ * rpma_repl_write() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - repl or src is NULL or len is 0
+ * - RPMA_E_AGAIN - depth replicated writes are in progress
+ * - RPMA_E_INVAL, RPMA_E_NOSUPP, RPMA_E_PROVIDER - posting the write
+ *   or the flush failed for all the replicas (see rpma_write(3) and
+ *   rpma_flush(3)); if it has failed only for some of them the replicated
+ *   write is initiated and the failure counts against the quorum
+ *
+ * SEE ALSO
+ * rpma_flush(3), rpma_repl_new(3), rpma_repl_next(3),
+ * rpma_repl_process(3), rpma_write(3), librpma(7) and
+ * https://pmem.io/rpma/
+ */
+int rpma_repl_write(struct rpma_repl *repl, size_t dst_offset,
+		const struct rpma_mr_local *src, size_t src_offset, size_t len,
+		enum rpma_flush_type type, const void *op_context);
+
+/** 3
+ * rpma_repl_process - process a completion of a replica
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_repl;
+ *	struct rpma_completion;
+ *	int rpma_repl_process(struct rpma_repl *repl,
+ *			const struct rpma_completion *cmpl);
+ *
+ * DESCRIPTION
+ * rpma_repl_process() consumes a completion collected using
+ * rpma_conn_completion_get(3) from the connection of any of the replicas
+ * of the group. A failed replica counts against the quorum of the write.
+ *
+ * RETURN VALUE
+ * The rpma_repl_process() function returns 0 on success or a negative
+ * error code on failure.
+ *
+ * ERRORS
+ * rpma_repl_process() can fail with the following error:
+ *
+ * - RPMA_E_INVAL - repl or cmpl is NULL or the completion does not come
+ *   from the group
+ *
+ * SEE ALSO
+ * rpma_conn_completion_get(3), rpma_repl_new(3), rpma_repl_next(3),
+ * librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_repl_process(struct rpma_repl *repl,
+		const struct rpma_completion *cmpl);
+
+/** 3
+ * rpma_repl_next - get a completion of the oldest replicated write
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_repl;
+ *	struct rpma_completion;
+ *	int rpma_repl_next(struct rpma_repl *repl,
+ *			struct rpma_completion *cmpl);
+ *
+ * DESCRIPTION
+ * rpma_repl_next() fills cmpl with the completion of the oldest replicated
+ * write not reported yet if it has been finished. The replicated writes
+ * are reported in the order they have been initiated. The op_context
+ * of the completion is the one of the write and its op is RPMA_OP_FLUSH.
+ * The op_status is IBV_WC_SUCCESS if the quorum of the replicas have
+ * flushed the data or the status of the first failed replica otherwise.
+ *
+ * RETURN VALUE
+ * The rpma_repl_next() function returns 0 on success or a negative error
+ * code on failure.
+ *
+ * ERRORS
+ * rpma_repl_next() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - repl or cmpl is NULL
+ * - RPMA_E_NO_COMPLETION - the oldest replicated write has not been
+ *   finished yet or there are no replicated writes to report
+ *
+ * SEE ALSO
+ * rpma_repl_new(3), rpma_repl_process(3), rpma_repl_write(3), librpma(7)
+ * and https://pmem.io/rpma/
+ */
+int rpma_repl_next(struct rpma_repl *repl, struct rpma_completion *cmpl);
+
+/** 3
+ * rpma_repl_get_slowest - get the replica falling behind the most
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_repl;
+ *	int rpma_repl_get_slowest(const struct rpma_repl *repl,
+ *			uint32_t *member, uint32_t *behind);
+ *
+ * DESCRIPTION
+ * rpma_repl_get_slowest() stores in member the index of the replica
+ * with the most replicated writes it has not completed yet and their
+ * number in behind. A replica which keeps falling behind is a candidate
+ * for replacement since the quorum hides its latency only as long as
+ * the other replicas are fast.
+ *
+ * RETURN VALUE
+ * The rpma_repl_get_slowest() function returns 0 on success or a negative
+ * error code on failure.
+ *
+ * ERRORS
+ * rpma_repl_get_slowest() can fail with the following error:
+ *
+ * - RPMA_E_INVAL - repl, member or behind is NULL
+ *
+ * SEE ALSO
+ * rpma_repl_new(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_repl_get_slowest(const struct rpma_repl *repl, uint32_t *member,
+		uint32_t *behind);
+
+/* append-only log */
+
+/*
+ * The remote append-only log begins with the 8-byte tail followed by
+ * the records starting at RPMA_AOF_DATA_OFFSET.
+ */
+#define RPMA_AOF_DATA_OFFSET	64
+
+struct rpma_aof;
+
+/** 3
+ * rpma_aof_new - create a new remote append-only log
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_peer;
+ *	struct rpma_conn;
+ *	struct rpma_mr_remote;
+ *	struct rpma_aof;
+ *	int rpma_aof_new(struct rpma_peer *peer, struct rpma_conn *conn,
+ *			struct rpma_mr_remote *dst, size_t tail,
+ *			size_t buf_size, uint32_t depth,
+ *			struct rpma_aof **aof_ptr);
+ *
+ * DESCRIPTION
+ * rpma_aof_new() creates an append-only log stored in the dst remote memory
+ * region reached over the conn connection. The first 8 bytes of the region
+ * hold the tail of the log i.e. the number of bytes of the records made
+ * durable so far. The records start at RPMA_AOF_DATA_OFFSET. Every record
+ * consists of the 32-bit length of the payload, the 32-bit CRC-32C checksum
+ * of the length and the payload and the payload itself padded to 8 bytes.
+ * New records are appended after the tail bytes of the records already
+ * stored in the log.
+ *
+ * The records are staged in a buf_size bytes ring registered with the peer
+ * until they are committed (see rpma_aof_commit(3)). Up to depth commits can
+ * be in progress at a time.
+ *
+ * The records are flushed using RPMA_FLUSH_TYPE_PERSISTENT so the region
+ * has to be accessible for the direct write to pmem (see
+ * rpma_mr_remote_get_flush_type(3)). A flush to visibility does not make
+ * the records durable so such a region is not supported. The log does not
+ * ask the remote CPU to persist the records (the general-purpose server
+ * persistency method) either.
+ *
+ * RETURN VALUE
+ * The rpma_aof_new() function returns 0 on success or a negative error
+ * code on failure. rpma_aof_new() does not set *aof_ptr value on failure.
+ *
+ * ERRORS
+ * rpma_aof_new() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - peer, conn, dst or aof_ptr is NULL, depth is 0, tail
+ *   or buf_size is not a multiple of 8, buf_size is too small or too big
+ *   or the region is too small to hold the tail bytes of the records
+ * - RPMA_E_NOSUPP - the region cannot be flushed to persistence
+ * - RPMA_E_NOMEM - out of memory
+ * - RPMA_E_PROVIDER - sysconf(3) failed
+ * - RPMA_E_PROVIDER - registering the ring failed (see rpma_mr_reg(3))
+ *
+ * SEE ALSO
+ * rpma_aof_append(3), rpma_aof_commit(3), rpma_aof_delete(3),
+ * rpma_aof_get_tail(3), rpma_aof_next(3),
+ * rpma_aof_process(3), rpma_aof_reserve(3), rpma_aof_verify(3),
+ * rpma_mr_remote_get_flush_type(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_aof_new(struct rpma_peer *peer, struct rpma_conn *conn,
+		struct rpma_mr_remote *dst, size_t tail, size_t buf_size,
+		uint32_t depth, struct rpma_aof **aof_ptr);
+
+/** 3
+ * rpma_aof_delete - delete the remote append-only log
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_aof;
+ *	int rpma_aof_delete(struct rpma_aof **aof_ptr);
+ *
+ * DESCRIPTION
+ * rpma_aof_delete() deregisters and releases the staging ring of the log.
+ * The remote memory region is not affected. All the commits have to be
+ * completed before the log is deleted. The records not committed are lost.
+ *
+ * RETURN VALUE
+ * The rpma_aof_delete() function returns 0 on success or a negative error
+ * code on failure. rpma_aof_delete() sets *aof_ptr value to NULL
+ * on success and on failure.
+ *
+ * ERRORS
+ * rpma_aof_delete() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - aof_ptr is NULL
+ * - RPMA_E_PROVIDER - deregistering the ring failed (see rpma_mr_dereg(3))
+ *   or munmap(2) failed
+ *
+ * SEE ALSO
+ * rpma_aof_new(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_aof_delete(struct rpma_aof **aof_ptr);
+
+/** 3
+ * rpma_aof_reserve - reserve the space for a record
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_aof;
+ *	int rpma_aof_reserve(struct rpma_aof *aof, size_t len,
+ *			void **rec_ptr);
+ *
+ * DESCRIPTION
+ * rpma_aof_reserve() appends a record of len bytes to the log and stores
+ * in *rec_ptr the address of its payload in the staging ring. The payload
+ * has to be filled in before the record is committed (see
+ * rpma_aof_commit(3)) so the data can be produced directly in the ring
+ * without any copying.
+ *
+ * RETURN VALUE
+ * The rpma_aof_reserve() function returns 0 on success or a negative error
+ * code on failure.
+ *
+ * ERRORS
+ * rpma_aof_reserve() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - aof or rec_ptr is NULL, len is 0 or the record does
+ *   not fit into the staging ring
+ * - RPMA_E_AGAIN - the staging ring is full; the records have to be
+ *   committed and the commits have to be completed to free it
+ * - RPMA_E_NOMEM - the remote log is full
+ *
+ * SEE ALSO
+ * rpma_aof_append(3), rpma_aof_commit(3), rpma_aof_new(3), librpma(7)
+ * and https://pmem.io/rpma/
+ */
+int rpma_aof_reserve(struct rpma_aof *aof, size_t len, void **rec_ptr);
+
+/** 3
+ * rpma_aof_append - append a record
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_aof;
+ *	int rpma_aof_append(struct rpma_aof *aof, const void *data,
+ *			size_t len);
+ *
+ * DESCRIPTION
+ * rpma_aof_append() appends a record of len bytes and copies the data
+ * to its payload (see rpma_aof_reserve(3)). The record is written
+ * to the remote log by the following rpma_aof_commit(3).
+ *
+ * RETURN VALUE
+ * The rpma_aof_append() function returns 0 on success or a negative error
+ * code on failure.
+ *
+ * ERRORS
+ * rpma_aof_append() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - aof or data is NULL, len is 0 or the record does not fit
+ *   into the staging ring
+ * - RPMA_E_AGAIN - the staging ring is full
+ * - RPMA_E_NOMEM - the remote log is full
+ *
+ * SEE ALSO
+ * rpma_aof_commit(3), rpma_aof_new(3), rpma_aof_reserve(3), librpma(7)
+ * and https://pmem.io/rpma/
+ */
+int rpma_aof_append(struct rpma_aof *aof, const void *data, size_t len);
+
+/** 3
+ * rpma_aof_commit - make the appended records durable
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_aof;
+ *	int rpma_aof_commit(struct rpma_aof *aof, const void *op_context);
+ *
+ * DESCRIPTION
+ * rpma_aof_commit() calculates the checksums of all the records appended
+ * since the last commit and initiates a group commit of them. The commit
+ * writes the records to the remote log and flushes them. Then it publishes
+ * the new tail of the log using rpma_write_atomic(3) and flushes it. The tail
+ * is ordered after the flush of the records so the remote log never holds
+ * a tail covering the records which are not durable.
+ *
+ * All the operations of the commit generate completions only on error
+ * except the last one. Its completion has to be passed
+ * to rpma_aof_process(3) and the completion of the commit with the given
+ * op_context can be collected by rpma_aof_next(3).
+ *
+ * RETURN VALUE
+ * The rpma_aof_commit() function returns 0 on success or a negative error
+ * code on failure. If posting the operations fails the records stay
+ * appended and the commit can be repeated.
+ *
+ * ERRORS
+ * rpma_aof_commit() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - aof is NULL or no records have been appended since
+ *   the last commit
+ * - RPMA_E_AGAIN - depth commits are in progress
+ * - RPMA_E_INVAL, RPMA_E_NOSUPP, RPMA_E_PROVIDER - posting the operations
+ *   failed (see rpma_write(3), rpma_flush(3) and rpma_write_atomic(3))
+ *
+ * SEE ALSO
+ * rpma_aof_append(3), rpma_aof_new(3), rpma_aof_next(3),
+ * rpma_aof_process(3), rpma_aof_reserve(3), librpma(7) and
+ * https://pmem.io/rpma/
+ */
+int rpma_aof_commit(struct rpma_aof *aof, const void *op_context);
 
 /** 3
- * rpma_conn_req_recv - initiate the receive operation
+ * rpma_aof_process - process a completion of a commit
  *
  * SYNOPSIS
  *
  *	#include <librpma.h>
  *
- *	struct rpma_conn_req;
- *	struct rpma_mr_local;
- *	int rpma_conn_req_recv(struct rpma_conn_req *req,
- *			struct rpma_mr_local *dst, size_t offset,
- *			size_t len, const void *op_context);
+ *	struct rpma_aof;
+ *	struct rpma_completion;
+ *	int rpma_aof_process(struct rpma_aof *aof,
+ *			const struct rpma_completion *cmpl);
  *
  * DESCRIPTION
- * rpma_conn_req_recv() initiates the receive operation. It prepares a buffer
- * for a message sent from other side of the connection.
- * Please see rpma_send(3). This is a variant of rpma_recv(3) which may be used
- * before the connection is established.
+ * rpma_aof_process() consumes a completion collected using
+ * rpma_conn_completion_get(3) which belongs to a commit of the log.
+ * When the commit is finished the part of the staging ring it has used
+ * is released and if it has succeeded the tail of the log is advanced
+ * (see rpma_aof_get_tail(3)).
  *
  * RETURN VALUE
- * The rpma_conn_req_recv() function returns 0 on success or a negative
+ * The rpma_aof_process() function returns 0 on success or a negative
  * error code on failure.
  *
  * ERRORS
- * rpma_conn_req_recv() can fail with the following errors:
+ * rpma_aof_process() can fail with the following error:
  *
- * - RPMA_E_INVAL - req or src or op_context is NULL
- * - RPMA_E_PROVIDER - ibv_post_recv(3) failed
+ * - RPMA_E_INVAL - aof or cmpl is NULL or the completion does not belong
+ *   to a commit in progress
  *
  * SEE ALSO
- * rpma_conn_req_new(3), rpma_mr_reg(3), librpma(7) and https://pmem.io/rpma/
+ * rpma_aof_commit(3), rpma_aof_new(3), rpma_aof_next(3),
+ * rpma_conn_completion_get(3), librpma(7) and https://pmem.io/rpma/
  */
-int rpma_conn_req_recv(struct rpma_conn_req *req,
-		struct rpma_mr_local *dst, size_t offset,
-		size_t len, const void *op_context);
+int rpma_aof_process(struct rpma_aof *aof,
+		const struct rpma_completion *cmpl);
 
-/* server-side setup */
+/** 3
+ * rpma_aof_next - get a completion of the oldest commit
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_aof;
+ *	struct rpma_completion;
+ *	int rpma_aof_next(struct rpma_aof *aof, struct rpma_completion *cmpl);
+ *
+ * DESCRIPTION
+ * rpma_aof_next() fills cmpl with the completion of the oldest commit
+ * not reported yet if it has been finished. The commits are reported
+ * in the order they have been initiated. The op_context of the completion
+ * is the one of the commit and its op is RPMA_OP_FLUSH. The op_status
+ * is the status of the first failed operation of the commit or
+ * IBV_WC_SUCCESS if all of them have succeeded.
+ *
+ * RETURN VALUE
+ * The rpma_aof_next() function returns 0 on success or a negative error
+ * code on failure.
+ *
+ * ERRORS
+ * rpma_aof_next() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - aof or cmpl is NULL
+ * - RPMA_E_NO_COMPLETION - the oldest commit has not been finished yet
+ *   or there are no commits to report
+ *
+ * SEE ALSO
+ * rpma_aof_commit(3), rpma_aof_new(3), rpma_aof_process(3), librpma(7)
+ * and https://pmem.io/rpma/
+ */
+int rpma_aof_next(struct rpma_aof *aof, struct rpma_completion *cmpl);
 
-struct rpma_ep;
+/** 3
+ * rpma_aof_get_tail - get the tail of the durable records
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_aof;
+ *	int rpma_aof_get_tail(const struct rpma_aof *aof, size_t *tail);
+ *
+ * DESCRIPTION
+ * rpma_aof_get_tail() stores in tail the number of bytes of the records
+ * of the log made durable by the successful commits so far. The records
+ * of a commit are counted when its completion is processed
+ * by rpma_aof_process(3).
+ *
+ * RETURN VALUE
+ * The rpma_aof_get_tail() function returns 0 on success or a negative
+ * error code on failure.
+ *
+ * ERRORS
+ * rpma_aof_get_tail() can fail with the following error:
+ *
+ * - RPMA_E_INVAL - aof or tail is NULL
+ *
+ * SEE ALSO
+ * rpma_aof_new(3), rpma_aof_process(3), librpma(7) and
+ * https://pmem.io/rpma/
+ */
+int rpma_aof_get_tail(const struct rpma_aof *aof, size_t *tail);
 
 /** 3
- * rpma_ep_listen - create a listening endpoint
+ * rpma_aof_verify - find the intact records of the log
  *
  * SYNOPSIS
  *
  *	#include <librpma.h>
  *
- *	struct rpma_peer;
- *	struct rpma_ep;
- *	int rpma_ep_listen(struct rpma_peer *peer, const char *addr,
- *			const char *port, struct rpma_ep **ep_ptr);
+ *	int rpma_aof_verify(const void *log, size_t tail, size_t *valid);
+ *
+ * DESCRIPTION
+ * rpma_aof_verify() scans the tail bytes of the records of a log (starting
+ * at RPMA_AOF_DATA_OFFSET of the log) and stores in valid the number
+ * of bytes of the records preceding the first torn one i.e. a record with
+ * the length of 0, a record overrunning the tail or a record with
+ * an invalid checksum. It is meant to be used on recovery e.g. with
+ * the records following the tail to find the records written by a commit
+ * interrupted before the tail has been published.
+ *
+ * RETURN VALUE
+ * The rpma_aof_verify() function returns 0 on success or a negative error
+ * code on failure.
+ *
+ * ERRORS
+ * rpma_aof_verify() can fail with the following error:
+ *
+ * - RPMA_E_INVAL - valid is NULL or log is NULL and tail is not 0
+ *
+ * SEE ALSO
+ * rpma_aof_new(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_aof_verify(const void *log, size_t tail, size_t *valid);
+
+/* event reactor */
+
+struct rpma_reactor;
+
+/*
+ * the types of the callbacks of the event reactor
+ */
+typedef void rpma_reactor_conn_event_func(
+	/* the connection the event has occurred on */
+	struct rpma_conn *conn,
+	/* the connection's event */
+	enum rpma_conn_event event,
+	/* the argument provided at registration */
+	void *arg);
+
+typedef void rpma_reactor_completion_func(
+	/* the connection the completion has been collected from */
+	struct rpma_conn *conn,
+	/* the completion */
+	const struct rpma_completion *cmpl,
+	/* the argument provided at registration */
+	void *arg);
+
+typedef void rpma_reactor_conn_req_func(
+	/* the endpoint the connection request has arrived at */
+	struct rpma_ep *ep,
+	/* the incoming connection request */
+	struct rpma_conn_req *req,
+	/* the argument provided at registration */
+	void *arg);
+
+#define RPMA_REACTOR_BATCH_DEFAULT	32
+
+/** 3
+ * rpma_reactor_new - create a new event reactor
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_reactor;
+ *	int rpma_reactor_new(uint32_t batch,
+ *			struct rpma_reactor **reactor_ptr);
+ *
+ * DESCRIPTION
+ * rpma_reactor_new() creates an event reactor. The connections and
+ * the endpoints registered in the reactor (see rpma_reactor_add_conn(3)
+ * and rpma_reactor_add_ep(3)) are watched using a single epoll(7) instance
+ * so a single rpma_reactor_dispatch(3) call handles the events of all
+ * of them. At most batch completions are collected from the completion
+ * queue of a connection per dispatch so a busy connection cannot starve
+ * the others. RPMA_REACTOR_BATCH_DEFAULT is a reasonable batch for most
+ * of the applications.
+ *
+ * RETURN VALUE
+ * The rpma_reactor_new() function returns 0 on success or a negative error
+ * code on failure. rpma_reactor_new() does not set *reactor_ptr value
+ * on failure.
+ *
+ * ERRORS
+ * rpma_reactor_new() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - reactor_ptr is NULL or batch is 0
+ * - RPMA_E_PROVIDER - epoll_create1(2) failed
+ * - RPMA_E_NOMEM - out of memory
+ *
+ * SEE ALSO
+ * rpma_reactor_add_conn(3), rpma_reactor_add_ep(3),
+ * rpma_reactor_delete(3), rpma_reactor_dispatch(3),
+ * rpma_reactor_get_fd(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_reactor_new(uint32_t batch, struct rpma_reactor **reactor_ptr);
+
+/** 3
+ * rpma_reactor_delete - delete the event reactor
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_reactor;
+ *	int rpma_reactor_delete(struct rpma_reactor **reactor_ptr);
+ *
+ * DESCRIPTION
+ * rpma_reactor_delete() unregisters all the connections and the endpoints
+ * and deletes the reactor. The connections and the endpoints themselves
+ * are not affected. The reactor cannot be deleted from its own callback.
+ *
+ * RETURN VALUE
+ * The rpma_reactor_delete() function returns 0 on success or a negative
+ * error code on failure. rpma_reactor_delete() sets *reactor_ptr value
+ * to NULL unless the reactor is dispatching.
+ *
+ * ERRORS
+ * rpma_reactor_delete() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - reactor_ptr is NULL or the reactor is dispatching
+ * - RPMA_E_PROVIDER - close(2) failed
+ *
+ * SEE ALSO
+ * rpma_reactor_new(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_reactor_delete(struct rpma_reactor **reactor_ptr);
+
+/** 3
+ * rpma_reactor_get_fd - get the file descriptor of the event reactor
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_reactor;
+ *	int rpma_reactor_get_fd(const struct rpma_reactor *reactor, int *fd);
+ *
+ * DESCRIPTION
+ * rpma_reactor_get_fd() gets the file descriptor of the epoll(7) instance
+ * of the reactor. It becomes readable when any of the registered
+ * connections or endpoints is ready so it can be integrated into
+ * an external event loop which calls rpma_reactor_dispatch(3) with
+ * the timeout of 0 whenever the file descriptor is readable.
+ *
+ * Note that a reactor holding undrained completions (see
+ * rpma_reactor_dispatch(3)) does not make the file descriptor readable
+ * again. The external event loop should call rpma_reactor_dispatch(3)
+ * again as long as it reports any dispatched callbacks.
+ *
+ * RETURN VALUE
+ * The rpma_reactor_get_fd() function returns 0 on success or a negative
+ * error code on failure. rpma_reactor_get_fd() does not set *fd value
+ * on failure.
+ *
+ * ERRORS
+ * rpma_reactor_get_fd() can fail with the following error:
+ *
+ * - RPMA_E_INVAL - reactor or fd is NULL
+ *
+ * SEE ALSO
+ * rpma_reactor_dispatch(3), rpma_reactor_new(3), librpma(7) and
+ * https://pmem.io/rpma/
+ */
+int rpma_reactor_get_fd(const struct rpma_reactor *reactor, int *fd);
+
+/** 3
+ * rpma_reactor_add_conn - register the connection in the event reactor
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_reactor;
+ *	struct rpma_conn;
+ *	typedef void rpma_reactor_conn_event_func(struct rpma_conn *conn,
+ *			enum rpma_conn_event event, void *arg);
+ *	typedef void rpma_reactor_completion_func(struct rpma_conn *conn,
+ *			const struct rpma_completion *cmpl, void *arg);
+ *	int rpma_reactor_add_conn(struct rpma_reactor *reactor,
+ *			struct rpma_conn *conn,
+ *			rpma_reactor_conn_event_func *event_func,
+ *			rpma_reactor_completion_func *completion_func,
+ *			void *arg);
  *
  * DESCRIPTION
- * rpma_ep_listen() creates an endpoint and initiates listening for incoming
- * connections using reliable, connection-oriented and message-based
- * (RDMA_PS_TCP) QP communication.
+ * rpma_reactor_add_conn() registers the connection in the reactor.
+ * If event_func is not NULL it is called with every event of the connection
+ * (see rpma_conn_next_event(3)). If completion_func is not NULL it is called
+ * with every completion collected from the connection's completion queue
+ * (see rpma_conn_completion_get(3)). The callbacks get the arg as their
+ * last argument.
+ *
+ * The callbacks may register and unregister the connections and
+ * the endpoints including their own connection.
  *
  * RETURN VALUE
- * The rpma_ep_listen() function returns 0 on success or a negative
- * error code on failure. rpma_ep_listen() does not set
- * *ep_ptr value on failure.
+ * The rpma_reactor_add_conn() function returns 0 on success or a negative
+ * error code on failure.
  *
  * ERRORS
- * rpma_ep_listen() can fail with the following errors:
+ * rpma_reactor_add_conn() can fail with the following errors:
  *
- * - RPMA_E_INVAL - peer, addr, port or ep_ptr is NULL
- * - RPMA_E_PROVIDER - rdma_create_event_channel(3), rdma_create_id(3),
- *   rdma_getaddrinfo(3), rdma_listen(3) failed
+ * - RPMA_E_INVAL - reactor or conn is NULL, both event_func
+ *   and completion_func are NULL or conn is already registered
  * - RPMA_E_NOMEM - out of memory
+ * - RPMA_E_PROVIDER - epoll_ctl(2) failed
  *
  * SEE ALSO
- * rpma_ep_get_fd(3), rpma_ep_next_conn_req(3), rpma_ep_shutdown(3),
- * rpma_peer_new(3), librpma(7) and https://pmem.io/rpma/
+ * rpma_conn_completion_get(3), rpma_conn_next_event(3),
+ * rpma_reactor_dispatch(3), rpma_reactor_new(3),
+ * rpma_reactor_remove_conn(3), librpma(7) and https://pmem.io/rpma/
  */
-int rpma_ep_listen(struct rpma_peer *peer, const char *addr,
-		const char *port, struct rpma_ep **ep_ptr);
+int rpma_reactor_add_conn(struct rpma_reactor *reactor, struct rpma_conn *conn,
+		rpma_reactor_conn_event_func *event_func,
+		rpma_reactor_completion_func *completion_func, void *arg);
 
 /** 3
- * rpma_ep_shutdown - stop listening and delete the endpoint
+ * rpma_reactor_remove_conn - unregister the connection
  *
  * SYNOPSIS
  *
  *	#include <librpma.h>
  *
- *	struct rpma_ep;
- *	int rpma_ep_shutdown(struct rpma_ep **ep_ptr);
+ *	struct rpma_reactor;
+ *	struct rpma_conn;
+ *	int rpma_reactor_remove_conn(struct rpma_reactor *reactor,
+ *			const struct rpma_conn *conn);
  *
  * DESCRIPTION
- * rpma_ep_shutdown() stops listening for incoming connections
- * and deletes the endpoint. The connections established using the endpoint
- * will still exist after deleting the endpoint.
+ * rpma_reactor_remove_conn() unregisters the connection from the reactor.
+ * No callbacks are called for the connection afterwards. A connection has
+ * to be unregistered before it is deleted.
  *
  * RETURN VALUE
- * The rpma_ep_shutdown() function returns 0 on success or a negative
- * error code on failure. rpma_ep_shutdown() does not set
- * *ep_ptr value to NULL on failure.
+ * The rpma_reactor_remove_conn() function returns 0 on success
+ * or a negative error code on failure.
  *
  * ERRORS
- * rpma_ep_shutdown() can fail with the following errors:
+ * rpma_reactor_remove_conn() can fail with the following error:
  *
- * - RPMA_E_INVAL - ep_ptr is NULL
- * - RPMA_E_PROVIDER - rdma_destroy_id(3) failed
+ * - RPMA_E_INVAL - reactor or conn is NULL or conn is not registered
  *
  * SEE ALSO
- * rpma_ep_listen(3), librpma(7) and https://pmem.io/rpma/
+ * rpma_reactor_add_conn(3), librpma(7) and https://pmem.io/rpma/
  */
-int rpma_ep_shutdown(struct rpma_ep **ep_ptr);
+int rpma_reactor_remove_conn(struct rpma_reactor *reactor,
+		const struct rpma_conn *conn);
 
 /** 3
- * rpma_ep_get_fd - get a file descriptor of the endpoint
+ * rpma_reactor_add_ep - register the endpoint in the event reactor
  *
  * SYNOPSIS
  *
  *	#include <librpma.h>
  *
+ *	struct rpma_reactor;
  *	struct rpma_ep;
- *	int rpma_ep_get_fd(const struct rpma_ep *ep, int *fd);
+ *	struct rpma_conn_cfg;
+ *	typedef void rpma_reactor_conn_req_func(struct rpma_ep *ep,
+ *			struct rpma_conn_req *req, void *arg);
+ *	int rpma_reactor_add_ep(struct rpma_reactor *reactor,
+ *			struct rpma_ep *ep, const struct rpma_conn_cfg *cfg,
+ *			rpma_reactor_conn_req_func *func, void *arg);
  *
  * DESCRIPTION
- * rpma_ep_get_fd() gets the file descriptor of the endpoint.
+ * rpma_reactor_add_ep() registers the listening endpoint in the reactor.
+ * The func is called with every incoming connection request obtained
+ * using rpma_ep_next_conn_req(3) with the cfg connection configuration
+ * and with the arg as its last argument. The callback takes over
+ * the connection request.
  *
  * RETURN VALUE
- * The rpma_ep_get_fd() function returns 0 on success or a negative
- * error code on failure. rpma_ep_get_fd() does not set
- * *fd value on failure.
+ * The rpma_reactor_add_ep() function returns 0 on success or a negative
+ * error code on failure.
  *
  * ERRORS
- * rpma_ep_get_fd() can fail with the following error:
+ * rpma_reactor_add_ep() can fail with the following errors:
  *
- * - RPMA_E_INVAL - ep or fd is NULL
+ * - RPMA_E_INVAL - reactor, ep or func is NULL or ep is already registered
+ * - RPMA_E_NOMEM - out of memory
+ * - RPMA_E_PROVIDER - epoll_ctl(2) failed
  *
  * SEE ALSO
- * rpma_ep_listen(3), librpma(7) and https://pmem.io/rpma/
+ * rpma_ep_listen(3), rpma_ep_next_conn_req(3), rpma_reactor_dispatch(3),
+ * rpma_reactor_new(3), rpma_reactor_remove_ep(3), librpma(7) and
+ * https://pmem.io/rpma/
  */
-int rpma_ep_get_fd(const struct rpma_ep *ep, int *fd);
+int rpma_reactor_add_ep(struct rpma_reactor *reactor, struct rpma_ep *ep,
+		const struct rpma_conn_cfg *cfg,
+		rpma_reactor_conn_req_func *func, void *arg);
 
 /** 3
- * rpma_ep_next_conn_req - obtain an incoming connection request
+ * rpma_reactor_remove_ep - unregister the endpoint
  *
  * SYNOPSIS
  *
  *	#include <librpma.h>
  *
+ *	struct rpma_reactor;
  *	struct rpma_ep;
- *	struct rpma_conn_cfg;
- *	struct rpma_conn_req;
- *	int rpma_ep_next_conn_req(struct rpma_ep *ep,
- *			const struct rpma_conn_cfg *cfg,
- *			struct rpma_conn_req **req_ptr);
+ *	int rpma_reactor_remove_ep(struct rpma_reactor *reactor,
+ *			const struct rpma_ep *ep);
  *
  * DESCRIPTION
- * rpma_ep_next_conn_req() obtains the next connection request
- * from the endpoint.
+ * rpma_reactor_remove_ep() unregisters the endpoint from the reactor.
+ * An endpoint has to be unregistered before it is shut down.
  *
  * RETURN VALUE
- * The rpma_ep_next_conn_req() function returns 0 on success or a negative
- * error code on failure. rpma_ep_next_conn_req() does not set
- * *req_ptr value on failure.
+ * The rpma_reactor_remove_ep() function returns 0 on success or a negative
+ * error code on failure.
  *
  * ERRORS
- * rpma_ep_next_conn_req() can fail with the following errors:
+ * rpma_reactor_remove_ep() can fail with the following error:
  *
- * - RPMA_E_INVAL - ep or req_ptr is NULL
- * - RPMA_E_INVAL - obtained an event different than a connection request
- * - RPMA_E_PROVIDER - rdma_get_cm_event(3) failed
- * - RPMA_E_NOMEM - out of memory
- * - RPMA_E_NO_EVENT - no next connection request available
+ * - RPMA_E_INVAL - reactor or ep is NULL or ep is not registered
  *
  * SEE ALSO
- * rpma_conn_cfg_new(3), rpma_conn_req_delete(3), rpma_conn_req_connect(3),
- * rpma_ep_listen(3), librpma(7) and https://pmem.io/rpma/
+ * rpma_reactor_add_ep(3), librpma(7) and https://pmem.io/rpma/
  */
-int rpma_ep_next_conn_req(struct rpma_ep *ep,
-		const struct rpma_conn_cfg *cfg,
-		struct rpma_conn_req **req_ptr);
+int rpma_reactor_remove_ep(struct rpma_reactor *reactor,
+		const struct rpma_ep *ep);
 
 /** 3
- * rpma_conn_req_get_private_data - get a pointer to the request's private data
+ * rpma_reactor_dispatch - wait for the events and call the callbacks
  *
  * SYNOPSIS
  *
  *	#include <librpma.h>
  *
- *	struct rpma_conn_req;
- *	struct rpma_conn_private_data;
- *	int rpma_conn_req_get_private_data(const struct rpma_conn_req *req,
- *			struct rpma_conn_private_data *pdata);
+ *	struct rpma_reactor;
+ *	int rpma_reactor_dispatch(struct rpma_reactor *reactor, int timeout_ms,
+ *			uint32_t *dispatched);
  *
  * DESCRIPTION
- * rpma_conn_req_get_private_data() obtains the pointer to the connection's
- * private data given by the other side of the connection before the connection
- * is established.
+ * rpma_reactor_dispatch() waits up to timeout_ms milliseconds (-1 means
+ * infinitely) until any of the registered connections or endpoints is
+ * ready and calls the callbacks of all the ready ones. The completion
+ * queue of a connection is drained up to the batch of the reactor
+ * (see rpma_reactor_new(3)) per call. If the batch is exhausted
+ * the connection may still hold completions so the next call does not
+ * wait for any events before it drains the connection further.
+ * If dispatched is not NULL the number of the callbacks called is stored
+ * in it.
  *
  * RETURN VALUE
- * The rpma_conn_req_get_private_data() function returns 0 on success or
- * a negative error code on failure. rpma_conn_req_get_private_data() does not
- * set *pdata value on failure.
+ * The rpma_reactor_dispatch() function returns 0 on success or a negative
+ * error code on failure. All the ready sources are handled even if some
+ * of them have failed and the first error is returned.
  *
  * ERRORS
- * rpma_conn_req_get_private_data() can fail with the following error:
+ * rpma_reactor_dispatch() can fail with the following errors:
  *
- * - RPMA_E_INVAL - req or pdata is NULL
+ * - RPMA_E_INVAL - reactor is NULL or the reactor is already dispatching
+ * - RPMA_E_PROVIDER - epoll_wait(2) failed
+ * - RPMA_E_INVAL, RPMA_E_NOMEM, RPMA_E_PROVIDER, RPMA_E_UNKNOWN - handling
+ *   any of the sources failed (see rpma_conn_next_event(3),
+ *   rpma_conn_completion_wait(3), rpma_conn_completion_get(3) and
+ *   rpma_ep_next_conn_req(3))
  *
  * SEE ALSO
- * rpma_conn_get_private_data(3), rpma_ep_next_conn_req(3), librpma(7)
- * and https://pmem.io/rpma/
+ * rpma_reactor_add_conn(3), rpma_reactor_add_ep(3), rpma_reactor_get_fd(3),
+ * rpma_reactor_new(3), librpma(7) and https://pmem.io/rpma/
  */
-int rpma_conn_req_get_private_data(const struct rpma_conn_req *req,
-		struct rpma_conn_private_data *pdata);
+int rpma_reactor_dispatch(struct rpma_reactor *reactor, int timeout_ms,
+		uint32_t *dispatched);
 
-/* remote memory access functions */
+/* progress threads */
 
-/* generate operation completion on error */
-#define RPMA_F_COMPLETION_ON_ERROR	(1 << 0)
-/* generate operation completion regardless of its result */
-#define RPMA_F_COMPLETION_ALWAYS	(1 << 1 | RPMA_F_COMPLETION_ON_ERROR)
+struct rpma_progress;
+
+enum rpma_progress_mode {
+	RPMA_PROGRESS_BUSY_POLL,
+	RPMA_PROGRESS_EVENT_DRIVEN,
+};
+
+/*
+ * the type of the callback attached to an operation
+ */
+typedef void rpma_progress_func(
+	/* the completion of the operation */
+	const struct rpma_completion *cmpl,
+	/* the argument attached together with the callback */
+	void *arg);
+
+struct rpma_progress_cb {
+	rpma_progress_func *func;
+	void *arg;
+};
+
+#define RPMA_PROGRESS_BATCH_DEFAULT	32
 
 /** 3
- * rpma_read - initiate the read operation
+ * rpma_progress_new - start a progress thread of the connection
  *
  * SYNOPSIS
  *
  *	#include <librpma.h>
  *
  *	struct rpma_conn;
- *	struct rpma_mr_local;
- *	struct rpma_mr_remote;
- *	int rpma_read(struct rpma_conn *conn,
- *			struct rpma_mr_local *dst, size_t dst_offset,
- *			const struct rpma_mr_remote *src,  size_t src_offset,
- *			size_t len, int flags, const void *op_context);
+ *	struct rpma_progress;
+ *	enum rpma_progress_mode {
+ *		RPMA_PROGRESS_BUSY_POLL,
+ *		RPMA_PROGRESS_EVENT_DRIVEN,
+ *	};
+ *	typedef void rpma_progress_func(const struct rpma_completion *cmpl,
+ *			void *arg);
+ *	struct rpma_progress_cb {
+ *		rpma_progress_func *func;
+ *		void *arg;
+ *	};
+ *	int rpma_progress_new(struct rpma_conn *conn,
+ *			enum rpma_progress_mode mode, uint32_t batch,
+ *			struct rpma_progress **progress_ptr);
  *
  * DESCRIPTION
- * rpma_read() initiates transferring data from the remote memory
- * to the local memory.
- * To read a 0 bytes message, set src and dst to NULL
- * and src_offset, dst_offset and len to 0.
- * The attribute flags set the completion notification indicator:
- * - RPMA_F_COMPLETION_ON_ERROR - generate the completion on error
- * - RPMA_F_COMPLETION_ALWAYS - generate the completion regardless of result of
- * the operation
+ * rpma_progress_new() starts a thread owned by the library which collects
+ * the completions of the connection (see rpma_conn_completion_get(3))
+ * and calls the callbacks attached to the operations. A callback is
+ * attached to an operation by passing a pointer to struct rpma_progress_cb
+ * as the operation's op_context. The structure has to stay valid until
+ * the callback is called. The completions with a NULL op_context are
+ * dropped.
+ *
+ * Up to batch completions are collected at once and then their callbacks
+ * are called one after another in the order of the completions.
+ * RPMA_PROGRESS_BATCH_DEFAULT is a reasonable batch for most of
+ * the applications. The supported modes are:
+ * - RPMA_PROGRESS_BUSY_POLL - the thread polls the completion queue
+ *   continuously which gives the lowest latency at the cost of a CPU core
+ * - RPMA_PROGRESS_EVENT_DRIVEN - the thread sleeps until a completion
+ *   arrives (see rpma_conn_completion_wait(3))
+ *
+ * The callbacks are called on the progress thread so they must not block
+ * for long. The application may keep posting the operations from other
+ * threads but it must not collect the completions of the connection
+ * on its own as long as the progress thread is running.
  *
  * RETURN VALUE
- * The rpma_read() function returns 0 on success or a negative
- * error code on failure.
+ * The rpma_progress_new() function returns 0 on success or a negative error
+ * code on failure. rpma_progress_new() does not set *progress_ptr value
+ * on failure.
  *
  * ERRORS
- * rpma_read() can fail with the following errors:
+ * rpma_progress_new() can fail with the following errors:
  *
- * - RPMA_E_INVAL - conn == NULL || flags == 0
- * - RPMA_E_INVAL - dst == NULL && (src != NULL || src_offset != 0
- *                  || dst_offset != 0 || len != 0)
- * - RPMA_E_INVAL - src == NULL && (dst != NULL || src_offset != 0
- *                  || dst_offset != 0 || len != 0)
- * - RPMA_E_PROVIDER - ibv_post_send(3) failed
+ * - RPMA_E_INVAL - conn or progress_ptr is NULL, batch is 0 or mode is
+ *   not supported
+ * - RPMA_E_NOMEM - out of memory
+ * - RPMA_E_PROVIDER - eventfd(2) or pthread_create(3) failed
  *
  * SEE ALSO
- * rpma_conn_req_connect(3), rpma_mr_reg(3), rpma_mr_remote_from_descriptor(3),
- * librpma(7) and https://pmem.io/rpma/
+ * rpma_conn_completion_get(3), rpma_conn_req_connect(3),
+ * rpma_progress_delete(3), librpma(7) and https://pmem.io/rpma/
  */
-int rpma_read(struct rpma_conn *conn,
-		struct rpma_mr_local *dst, size_t dst_offset,
-		const struct rpma_mr_remote *src,  size_t src_offset,
-		size_t len, int flags, const void *op_context);
+int rpma_progress_new(struct rpma_conn *conn, enum rpma_progress_mode mode,
+		uint32_t batch, struct rpma_progress **progress_ptr);
 
 /** 3
- * rpma_write - initiate the write operation
+ * rpma_progress_delete - stop the progress thread of the connection
  *
  * SYNOPSIS
  *
  *	#include <librpma.h>
  *
- *	struct rpma_conn;
- *	struct rpma_mr_local;
- *	struct rpma_mr_remote;
- *	int rpma_write(struct rpma_conn *conn,
- *			struct rpma_mr_remote *dst, size_t dst_offset,
- *			const struct rpma_mr_local *src,  size_t src_offset,
- *			size_t len, int flags, const void *op_context);
+ *	struct rpma_progress;
+ *	int rpma_progress_delete(struct rpma_progress **progress_ptr);
  *
  * DESCRIPTION
- * rpma_write() initiates transferring data from the local memory
- * to the remote memory.
- * To write a 0 bytes message, set src and dst to NULL
- * and src_offset, dst_offset and len to 0.
- * The attribute flags set the completion notification indicator:
- * - RPMA_F_COMPLETION_ON_ERROR - generate the completion on error
- * - RPMA_F_COMPLETION_ALWAYS - generate the completion regardless of result of
- * the operation
+ * rpma_progress_delete() stops the progress thread and waits until it exits.
+ * The callbacks of all the completions which are already in the completion
+ * queue are called before the thread exits so the application should stop
+ * posting the operations first. No callbacks are called after
+ * rpma_progress_delete() returns. The progress thread has to be deleted
+ * before the connection is deleted and it cannot be deleted from its own
+ * callback.
  *
  * RETURN VALUE
- * The rpma_write() function returns 0 on success or a negative
- * error code on failure.
+ * The rpma_progress_delete() function returns 0 on success or a negative
+ * error code on failure. If the thread has stopped on its own because
+ * collecting the completions has failed this error is returned after
+ * the thread is deleted. rpma_progress_delete() sets *progress_ptr value
+ * to NULL on success and when the thread has failed.
  *
  * ERRORS
- * rpma_write() can fail with the following errors:
+ * rpma_progress_delete() can fail with the following errors:
  *
- * - RPMA_E_INVAL - conn == NULL || flags == 0
- * - RPMA_E_INVAL - dst == NULL && (src != NULL || src_offset != 0
- *                  || dst_offset != 0 || len != 0)
- * - RPMA_E_INVAL - src == NULL && (dst != NULL || src_offset != 0
- *                  || dst_offset != 0 || len != 0)
- * - RPMA_E_PROVIDER - ibv_post_send(3) failed
+ * - RPMA_E_INVAL - progress_ptr is NULL or called from a callback
+ * - RPMA_E_PROVIDER - eventfd_write(3), pthread_join(3) or close(2) failed
+ * - RPMA_E_PROVIDER, RPMA_E_UNKNOWN, RPMA_E_NOSUPP - the thread has failed
+ *   (see rpma_conn_completion_get(3) and rpma_conn_completion_wait(3))
  *
  * SEE ALSO
- * rpma_conn_req_connect(3), rpma_mr_reg(3),
- * rpma_mr_remote_from_descriptor(3), librpma(7) and https://pmem.io/rpma/
+ * rpma_progress_new(3), librpma(7) and https://pmem.io/rpma/
  */
-int rpma_write(struct rpma_conn *conn,
-		struct rpma_mr_remote *dst, size_t dst_offset,
-		const struct rpma_mr_local *src,  size_t src_offset,
-		size_t len, int flags, const void *op_context);
+int rpma_progress_delete(struct rpma_progress **progress_ptr);
+
+/* submission and completion rings */
+
+struct rpma_ring;
+
+enum rpma_ring_opcode {
+	RPMA_RING_OP_READ,
+	RPMA_RING_OP_WRITE,
+	RPMA_RING_OP_WRITE_WITH_IMM,
+	RPMA_RING_OP_SEND,
+	RPMA_RING_OP_SEND_WITH_IMM,
+};
+
+/*
+ * the operation descriptor of the submission ring
+ */
+struct rpma_ring_sqe {
+	enum rpma_ring_opcode opcode;
+	int flags; /* RPMA_F_COMPLETION_* */
+	struct rpma_mr_local *local; /* the source or the destination */
+	size_t local_offset;
+	struct rpma_mr_remote *remote; /* unused by the sends */
+	size_t remote_offset;
+	size_t len;
+	uint32_t imm; /* the immediate data of the *_WITH_IMM opcodes */
+	void *user_data; /* the op_context of the completion */
+};
 
 /** 3
- * rpma_write_with_imm - initiate the write operation with immediate data
+ * rpma_ring_new - create the submission and completion rings
  *
  * SYNOPSIS
  *
  *	#include <librpma.h>
  *
  *	struct rpma_conn;
- *	struct rpma_mr_local;
- *	struct rpma_mr_remote;
- *	int rpma_write_with_imm(struct rpma_conn *conn,
- *			struct rpma_mr_remote *dst, size_t dst_offset,
- *			const struct rpma_mr_local *src,  size_t src_offset,
- *			size_t len, int flags, uint32_t imm,
- *			const void *op_context);
+ *	struct rpma_ring;
+ *	int rpma_ring_new(struct rpma_conn *conn, uint32_t sq_entries,
+ *			uint32_t cq_entries, struct rpma_ring **ring_ptr);
  *
  * DESCRIPTION
- * rpma_write_with_imm() initiates the write operation with immediate data
- * (transferring data from the local memory to the remote memory.
- * To write a 0 bytes message, set src and dst to NULL
- * and src_offset, dst_offset and len to 0.
- * The attribute flags set the completion notification indicator:
- * - RPMA_F_COMPLETION_ON_ERROR - generate the completion on error
- * - RPMA_F_COMPLETION_ALWAYS - generate the completion regardless of result of
- * the operation
+ * rpma_ring_new() creates a submission ring of at least sq_entries
+ * operation descriptors (rounded up to a power of two) and a completion
+ * ring of cq_entries completions for the connection. Both of them can hold
+ * up to 65536 entries.
+ *
+ * The application fills the descriptors obtained using
+ * rpma_ring_get_sqe(3) and posts all of them at once using
+ * rpma_ring_submit(3). The completions are collected in batches and
+ * handed over using rpma_ring_peek_cqes(3) and rpma_ring_cq_advance(3).
+ * The rings take over the completion queue of the connection so
+ * the completions must not be collected using rpma_conn_completion_get(3)
+ * while the rings are in use.
  *
  * RETURN VALUE
- * The rpma_write_with_imm() function returns 0 on success or a negative
- * error code on failure.
+ * The rpma_ring_new() function returns 0 on success or a negative error
+ * code on failure. rpma_ring_new() does not set *ring_ptr value on failure.
  *
  * ERRORS
- * rpma_write_with_imm() can fail with the following errors:
+ * rpma_ring_new() can fail with the following errors:
  *
- * - RPMA_E_INVAL - conn == NULL || flags == 0
- * - RPMA_E_INVAL - dst == NULL && (src != NULL || src_offset != 0
- *                  || dst_offset != 0 || len != 0)
- * - RPMA_E_INVAL - src == NULL && (dst != NULL || src_offset != 0
- *                  || dst_offset != 0 || len != 0)
- * - RPMA_E_PROVIDER - ibv_post_send(3) failed
+ * - RPMA_E_INVAL - conn or ring_ptr is NULL or sq_entries or cq_entries
+ *   is 0 or greater than 65536
+ * - RPMA_E_NOSUPP - the connection works in a thread-safe mode (see
+ *   rpma_conn_cfg_set_thread_mode(3)) or collects the latency (see
+ *   rpma_conn_cfg_set_stats(3))
+ * - RPMA_E_NOMEM - out of memory
  *
  * SEE ALSO
- * rpma_conn_req_connect(3), rpma_mr_reg(3),
- * rpma_mr_remote_from_descriptor(3), librpma(7) and https://pmem.io/rpma/
+ * rpma_conn_req_connect(3), rpma_ring_cq_advance(3), rpma_ring_delete(3),
+ * rpma_ring_get_sqe(3), rpma_ring_peek_cqes(3), rpma_ring_submit(3),
+ * librpma(7) and https://pmem.io/rpma/
  */
-int rpma_write_with_imm(struct rpma_conn *conn,
-		struct rpma_mr_remote *dst, size_t dst_offset,
-		const struct rpma_mr_local *src,  size_t src_offset,
-		size_t len, int flags, uint32_t imm, const void *op_context);
-
-#define RPMA_ATOMIC_WRITE_ALIGNMENT 8
+int rpma_ring_new(struct rpma_conn *conn, uint32_t sq_entries,
+		uint32_t cq_entries, struct rpma_ring **ring_ptr);
 
 /** 3
- * rpma_write_atomic - initiate the atomic write operation
+ * rpma_ring_delete - delete the submission and completion rings
  *
  * SYNOPSIS
  *
  *	#include <librpma.h>
  *
- *	struct rpma_conn;
- *	struct rpma_mr_local;
- *	struct rpma_mr_remote;
- *	int rpma_write_atomic(struct rpma_conn *conn,
- *			struct rpma_mr_remote *dst, size_t dst_offset,
- *			const struct rpma_mr_local *src,  size_t src_offset,
- *			int flags, const void *op_context);
+ *	struct rpma_ring;
+ *	int rpma_ring_delete(struct rpma_ring **ring_ptr);
  *
  * DESCRIPTION
- * rpma_write_atomic() initiates the atomic write operation (transferring
- * data from the local memory to the remote memory). The atomic write operation
- * allows transferring 8 bytes of data (RPMA_ATOMIC_WRITE_ALIGNMENT) and storing
- * them atomically in the remote memory.
- * The attribute flags set the completion notification indicator:
- * - RPMA_F_COMPLETION_ON_ERROR - generate the completion on error
- * - RPMA_F_COMPLETION_ALWAYS - generate the completion regardless of result of
- * the operation
+ * rpma_ring_delete() deletes the rings. The descriptors which have not been
+ * submitted and the completions which have not been consumed are dropped.
  *
  * RETURN VALUE
- * The rpma_write_atomic() function returns 0 on success or a negative
- * error code on failure.
+ * The rpma_ring_delete() function returns 0 on success or a negative error
+ * code on failure. rpma_ring_delete() sets *ring_ptr value to NULL
+ * on success.
  *
  * ERRORS
- * rpma_write_atomic() can fail with the following errors:
+ * rpma_ring_delete() can fail with the following error:
  *
- * - RPMA_E_INVAL - conn, dst or src is NULL
- * - RPMA_E_INVAL - dst_offset is not aligned to 8 bytes
- * - RPMA_E_INVAL - flags are not set
- * - RPMA_E_PROVIDER - ibv_post_send(3) failed
+ * - RPMA_E_INVAL - ring_ptr is NULL
  *
  * SEE ALSO
- * rpma_conn_req_connect(3), rpma_mr_reg(3),
- * rpma_mr_remote_from_descriptor(3), librpma(7) and https://pmem.io/rpma/
+ * rpma_ring_new(3), librpma(7) and https://pmem.io/rpma/
  */
-int rpma_write_atomic(struct rpma_conn *conn,
-		struct rpma_mr_remote *dst, size_t dst_offset,
-		const struct rpma_mr_local *src,  size_t src_offset,
-		int flags, const void *op_context);
+int rpma_ring_delete(struct rpma_ring **ring_ptr);
 
-/*
- * possible types of rpma_flush() operation
+/** 3
+ * rpma_ring_get_sqe - get the next free operation descriptor
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_ring;
+ *	enum rpma_ring_opcode {
+ *		RPMA_RING_OP_READ,
+ *		RPMA_RING_OP_WRITE,
+ *		RPMA_RING_OP_WRITE_WITH_IMM,
+ *		RPMA_RING_OP_SEND,
+ *		RPMA_RING_OP_SEND_WITH_IMM,
+ *	};
+ *	struct rpma_ring_sqe {
+ *		enum rpma_ring_opcode opcode;
+ *		int flags;
+ *		struct rpma_mr_local *local;
+ *		size_t local_offset;
+ *		struct rpma_mr_remote *remote;
+ *		size_t remote_offset;
+ *		size_t len;
+ *		uint32_t imm;
+ *		void *user_data;
+ *	};
+ *	int rpma_ring_get_sqe(struct rpma_ring *ring,
+ *			struct rpma_ring_sqe **sqe_ptr);
+ *
+ * DESCRIPTION
+ * rpma_ring_get_sqe() hands out the next free descriptor of the submission
+ * ring. The application has to fill all of its fields before the next
+ * rpma_ring_submit(3) call:
+ * - RPMA_RING_OP_READ - reads len bytes from the remote memory region
+ *   at remote_offset to the local one at local_offset (see rpma_read(3))
+ * - RPMA_RING_OP_WRITE, RPMA_RING_OP_WRITE_WITH_IMM - writes len bytes
+ *   from the local memory region to the remote one (see rpma_write(3)
+ *   and rpma_write_with_imm(3))
+ * - RPMA_RING_OP_SEND, RPMA_RING_OP_SEND_WITH_IMM - sends len bytes
+ *   from the local memory region (see rpma_send(3) and
+ *   rpma_send_with_imm(3))
+ *
+ * The flags are RPMA_F_COMPLETION_ALWAYS or RPMA_F_COMPLETION_ON_ERROR
+ * and the user_data becomes the op_context of the completion of
+ * the operation.
+ *
+ * RETURN VALUE
+ * The rpma_ring_get_sqe() function returns 0 on success or a negative error
+ * code on failure. rpma_ring_get_sqe() does not set *sqe_ptr value
+ * on failure.
+ *
+ * ERRORS
+ * rpma_ring_get_sqe() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - ring or sqe_ptr is NULL
+ * - RPMA_E_AGAIN - the submission ring is full
+ *
+ * SEE ALSO
+ * rpma_ring_new(3), rpma_ring_submit(3), librpma(7) and
+ * https://pmem.io/rpma/
  */
-enum rpma_flush_type {
-	/* flush data down to the persistent domain */
-	RPMA_FLUSH_TYPE_PERSISTENT,
-	/* flush data deep enough to make it visible on the remote node */
-	RPMA_FLUSH_TYPE_VISIBILITY,
-};
+int rpma_ring_get_sqe(struct rpma_ring *ring, struct rpma_ring_sqe **sqe_ptr);
 
 /** 3
- * rpma_flush - initiate the flush operation
+ * rpma_ring_submit - post the filled operation descriptors
  *
  * SYNOPSIS
  *
  *	#include <librpma.h>
  *
- *	struct rpma_conn;
- *	struct rpma_mr_remote;
- *	enum rpma_flush_type {
- *		RPMA_FLUSH_TYPE_PERSISTENT,
- *		RPMA_FLUSH_TYPE_VISIBILITY,
- *	};
- *
- *	int rpma_flush(struct rpma_conn *conn,
- *			struct rpma_mr_remote *dst, size_t dst_offset,
- *			size_t len, enum rpma_flush_type type, int flags,
- *			const void *op_context);
+ *	struct rpma_ring;
+ *	int rpma_ring_submit(struct rpma_ring *ring, uint32_t *submitted);
  *
  * DESCRIPTION
- * rpma_flush() initiates the flush operation (finalizing a transfer of data
- * to the remote memory).
- * Possible types of rpma_flush() operation:
- * - RPMA_FLUSH_TYPE_PERSISTENT - flush data down to the persistent domain
- * - RPMA_FLUSH_TYPE_VISIBILITY - flush data deep enough to make it visible
- * on the remote node
- *
- * The attribute flags set the completion notification indicator:
- * - RPMA_F_COMPLETION_ON_ERROR - generate the completion on error
- * - RPMA_F_COMPLETION_ALWAYS - generate the completion regardless of result of
- * the operation
+ * rpma_ring_submit() translates all the descriptors handed out by
+ * rpma_ring_get_sqe(3) since the last submission into a chain of work
+ * requests and posts the whole chain using a single ibv_post_send(3) call.
+ * If submitted is not NULL the number of the posted descriptors is stored
+ * in it.
+ *
+ * The descriptors are validated during the translation. The translation
+ * stops at the first invalid descriptor. The preceding descriptors are
+ * posted and the invalid one is dropped. If posting fails the descriptors
+ * which have not been posted stay in the ring and they are posted again
+ * by the next rpma_ring_submit() call.
  *
  * RETURN VALUE
- * The rpma_flush() function returns 0 on success or a negative
- * error code on failure.
+ * The rpma_ring_submit() function returns 0 on success or a negative error
+ * code on failure.
  *
  * ERRORS
- * rpma_flush() can fail with the following errors:
+ * rpma_ring_submit() can fail with the following errors:
  *
- * - RPMA_E_INVAL - conn or dst is NULL
- * - RPMA_E_INVAL - unknown type value
- * - RPMA_E_INVAL - flags are not set
+ * - RPMA_E_INVAL - ring is NULL or an invalid descriptor has been dropped
  * - RPMA_E_PROVIDER - ibv_post_send(3) failed
- * - RPMA_E_NOSUPP - type is RPMA_FLUSH_TYPE_PERSISTENT and
- * the direct write to pmem is not supported
  *
  * SEE ALSO
- * rpma_conn_req_connect(3), rpma_mr_remote_from_descriptor(3), librpma(7)
- * and https://pmem.io/rpma/
+ * rpma_ring_get_sqe(3), rpma_ring_new(3), librpma(7) and
+ * https://pmem.io/rpma/
  */
-int rpma_flush(struct rpma_conn *conn,
-		struct rpma_mr_remote *dst, size_t dst_offset, size_t len,
-		enum rpma_flush_type type, int flags, const void *op_context);
+int rpma_ring_submit(struct rpma_ring *ring, uint32_t *submitted);
 
 /** 3
- * rpma_send - initiate the send operation
+ * rpma_ring_peek_cqes - get the collected completions
  *
  * SYNOPSIS
  *
  *	#include <librpma.h>
  *
- *	struct rpma_conn;
- *	struct rpma_mr_local;
- *	int rpma_send(struct rpma_conn *conn,
- *			const struct rpma_mr_local *src, size_t offset,
- *			size_t len, int flags, const void *op_context);
+ *	struct rpma_ring;
+ *	struct rpma_completion;
+ *	int rpma_ring_peek_cqes(struct rpma_ring *ring,
+ *			struct rpma_completion **cqes_ptr, uint32_t *num);
  *
  * DESCRIPTION
- * rpma_send() initiates the send operation which transfers a message from
- * the local memory to other side of the connection.
- * To send a 0 byte message, set src to NULL and both offset and len to 0.
- * The attribute flags set the completion notification indicator:
- * - RPMA_F_COMPLETION_ON_ERROR - generate the completion on error
- * - RPMA_F_COMPLETION_ALWAYS - generate the completion regardless of result of
- * the operation
+ * rpma_ring_peek_cqes() stores in *cqes_ptr an array of *num completions
+ * which have not been consumed yet. The completions stay in the ring until
+ * they are consumed using rpma_ring_cq_advance(3). If all of them have
+ * been consumed the completion ring is refilled with up to its size
+ * of completions using a single ibv_poll_cq(3) call. The completions
+ * are described in rpma_conn_completion_get(3).
  *
  * RETURN VALUE
- * The rpma_send() function returns 0 on success or a negative
- * error code on failure.
+ * The rpma_ring_peek_cqes() function returns 0 on success or a negative
+ * error code on failure. rpma_ring_peek_cqes() does not set *cqes_ptr
+ * and *num values on failure.
  *
  * ERRORS
- * rpma_send() can fail with the following errors:
+ * rpma_ring_peek_cqes() can fail with the following errors:
  *
- * - RPMA_E_INVAL - conn == NULL || flags == 0
- * - RPMA_E_INVAL - src == NULL && (offset != 0 || len != 0)
- * - RPMA_E_PROVIDER - ibv_post_send(3) failed
+ * - RPMA_E_INVAL - ring, cqes_ptr or num is NULL
+ * - RPMA_E_NO_COMPLETION - no completions available
+ * - RPMA_E_PROVIDER - ibv_poll_cq(3) failed with a provider error
+ * - RPMA_E_UNKNOWN - ibv_poll_cq(3) failed but no provider error is available
+ * - RPMA_E_NOSUPP - only completions of not supported opcodes were
+ *   collected
  *
  * SEE ALSO
- * rpma_conn_req_connect(3), rpma_mr_reg(3), librpma(7) and
+ * rpma_ring_cq_advance(3), rpma_ring_new(3), librpma(7) and
  * https://pmem.io/rpma/
  */
-int rpma_send(struct rpma_conn *conn,
-		const struct rpma_mr_local *src, size_t offset, size_t len,
-		int flags, const void *op_context);
+int rpma_ring_peek_cqes(struct rpma_ring *ring,
+		struct rpma_completion **cqes_ptr, uint32_t *num);
 
 /** 3
- * rpma_send_with_imm - initiate the send operation with immediate data
+ * rpma_ring_cq_advance - consume the completions
  *
  * SYNOPSIS
  *
  *	#include <librpma.h>
  *
- *	struct rpma_conn;
- *	struct rpma_mr_local;
- *	int rpma_send_with_imm(struct rpma_conn *conn,
- *			const struct rpma_mr_local *src, size_t offset,
- *			size_t len, int flags, uint32_t imm,
- *			const void *op_context);
+ *	struct rpma_ring;
+ *	int rpma_ring_cq_advance(struct rpma_ring *ring, uint32_t num);
  *
  * DESCRIPTION
- * rpma_send_with_imm() initiates the send operation with immediate data which
- * transfers a message from the local memory to other side of the connection.
- * To send a 0 byte message, set src to NULL and both offset and len to 0.
- * The attribute flags set the completion notification indicator:
- * - RPMA_F_COMPLETION_ON_ERROR - generate the completion on error
- * - RPMA_F_COMPLETION_ALWAYS - generate the completion regardless of result of
- * the operation
+ * rpma_ring_cq_advance() marks the num oldest completions obtained using
+ * rpma_ring_peek_cqes(3) as consumed.
  *
  * RETURN VALUE
- * The rpma_send_with_imm() function returns 0 on success or a negative
+ * The rpma_ring_cq_advance() function returns 0 on success or a negative
  * error code on failure.
  *
  * ERRORS
- * rpma_send_with_imm() can fail with the following errors:
+ * rpma_ring_cq_advance() can fail with the following error:
  *
- * - RPMA_E_INVAL - conn == NULL || flags == 0
- * - RPMA_E_INVAL - src == NULL && (offset != 0 || len != 0)
- * - RPMA_E_PROVIDER - ibv_post_send(3) failed
+ * - RPMA_E_INVAL - ring is NULL or num is greater than the number
+ *   of the completions not consumed yet
  *
  * SEE ALSO
- * rpma_conn_req_connect(3), rpma_mr_reg(3), librpma(7) and
- * https://pmem.io/rpma/
+ * rpma_ring_peek_cqes(3), librpma(7) and https://pmem.io/rpma/
  */
-int rpma_send_with_imm(struct rpma_conn *conn,
-	const struct rpma_mr_local *src, size_t offset, size_t len,
-	int flags, uint32_t imm, const void *op_context);
+int rpma_ring_cq_advance(struct rpma_ring *ring, uint32_t num);
+
+/* persistent operation templates */
+
+struct rpma_op_template;
+
+enum rpma_op_template_type {
+	RPMA_OP_TEMPLATE_READ,
+	RPMA_OP_TEMPLATE_WRITE,
+};
 
 /** 3
- * rpma_recv - initiate the receive operation
+ * rpma_op_template_new - prepare a template of the operation
  *
  * SYNOPSIS
  *
@@ -2399,183 +7581,249 @@ int rpma_send_with_imm(struct rpma_conn *conn,
  *
  *	struct rpma_conn;
  *	struct rpma_mr_local;
- *	int rpma_recv(struct rpma_conn *conn,
- *			struct rpma_mr_local *dst, size_t offset,
- *			size_t len, const void *op_context);
+ *	struct rpma_mr_remote;
+ *	struct rpma_op_template;
+ *	enum rpma_op_template_type {
+ *		RPMA_OP_TEMPLATE_READ,
+ *		RPMA_OP_TEMPLATE_WRITE,
+ *	};
+ *	int rpma_op_template_new(struct rpma_conn *conn,
+ *			enum rpma_op_template_type type,
+ *			struct rpma_mr_local *local,
+ *			struct rpma_mr_remote *remote, int flags,
+ *			struct rpma_op_template **tmpl_ptr);
  *
  * DESCRIPTION
- * rpma_recv() initiates the receive operation which prepares a buffer for
- * a message sent from other side of the connection. Please see rpma_send(3).
+ * rpma_op_template_new() prepares a template of the operation which can be
+ * started many times (in the spirit of the MPI persistent requests):
+ * - RPMA_OP_TEMPLATE_READ - reads from the remote memory region to the local
+ *   one (see rpma_read(3))
+ * - RPMA_OP_TEMPLATE_WRITE - writes from the local memory region to
+ *   the remote one (see rpma_write(3))
+ *
+ * The queue pair of the connection, the keys and the base addresses of
+ * the memory regions and the flags (RPMA_F_COMPLETION_ALWAYS or
+ * RPMA_F_COMPLETION_ON_ERROR) are resolved once when the template is
+ * prepared. The connection and both of the memory regions have to outlive
+ * the template.
  *
- * All buffers prepared via rpma_recv(3) form an unordered set. When a message
- * arrives it is placed in one of the buffers awaitaning and a completion for
- * the receive operation is generated.
+ * RETURN VALUE
+ * The rpma_op_template_new() function returns 0 on success or a negative
+ * error code on failure. rpma_op_template_new() does not set *tmpl_ptr value
+ * on failure.
  *
- * A buffer for an incoming message have to be prepared beforehand.
+ * ERRORS
+ * rpma_op_template_new() can fail with the following errors:
  *
- * The order of buffers in the set does not affect the order of completions of
- * receive operations get via rpma_conn_completion_get(3).
+ * - RPMA_E_INVAL - conn, local, remote or tmpl_ptr is NULL, flags == 0
+ *   or type is unknown
+ * - RPMA_E_NOSUPP - the connection works in a thread-safe mode (see
+ *   rpma_conn_cfg_set_thread_mode(3)) or collects the latency (see
+ *   rpma_conn_cfg_set_stats(3))
+ * - RPMA_E_NOMEM - out of memory
  *
- * NOTE
- * In the RDMA standard, receive requests form an ordered queue.
- * The RPMA does NOT inherit this guarantee.
+ * SEE ALSO
+ * rpma_conn_req_connect(3), rpma_mr_reg(3),
+ * rpma_mr_remote_from_descriptor(3), rpma_op_template_delete(3),
+ * rpma_op_template_start(3), librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_op_template_new(struct rpma_conn *conn,
+		enum rpma_op_template_type type, struct rpma_mr_local *local,
+		struct rpma_mr_remote *remote, int flags,
+		struct rpma_op_template **tmpl_ptr);
+
+/** 3
+ * rpma_op_template_delete - delete the template of the operation
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	struct rpma_op_template;
+ *	int rpma_op_template_delete(struct rpma_op_template **tmpl_ptr);
+ *
+ * DESCRIPTION
+ * rpma_op_template_delete() deletes the template. The operations started
+ * using the template are not affected.
  *
  * RETURN VALUE
- * The rpma_recv() function returns 0 on success or a negative
- * error code on failure.
+ * The rpma_op_template_delete() function returns 0 on success or a negative
+ * error code on failure. rpma_op_template_delete() sets *tmpl_ptr value
+ * to NULL on success.
  *
  * ERRORS
- * rpma_recv() can fail with the following errors:
+ * rpma_op_template_delete() can fail with the following error:
  *
- * - RPMA_E_INVAL - conn == NULL
- * - RPMA_E_INVAL - dst == NULL && (offset != 0 || len != 0)
- * - RPMA_E_PROVIDER - ibv_post_recv(3) failed
+ * - RPMA_E_INVAL - tmpl_ptr is NULL
  *
  * SEE ALSO
- * rpma_conn_req_connect(3), rpma_mr_reg(3), librpma(7) and
- * https://pmem.io/rpma/
+ * rpma_op_template_new(3), librpma(7) and https://pmem.io/rpma/
  */
-int rpma_recv(struct rpma_conn *conn,
-		struct rpma_mr_local *dst, size_t offset, size_t len,
-		const void *op_context);
-
-/* completion handling */
+int rpma_op_template_delete(struct rpma_op_template **tmpl_ptr);
 
 /** 3
- * rpma_conn_get_completion_fd - get the completion file descriptor
+ * rpma_op_template_start - post the operation prepared by the template
  *
  * SYNOPSIS
  *
  *	#include <librpma.h>
  *
- *	struct rpma_conn;
- *	int rpma_conn_get_completion_fd(const struct rpma_conn *conn, int *fd);
+ *	struct rpma_op_template;
+ *	int rpma_op_template_start(struct rpma_op_template *tmpl,
+ *			size_t local_offset, size_t remote_offset, size_t len,
+ *			const void *op_context);
  *
  * DESCRIPTION
- * rpma_conn_get_completion_fd() gets the completion file descriptor
- * of the connection.
+ * rpma_op_template_start() posts the operation prepared by the template
+ * for len bytes at local_offset of the local memory region and
+ * at remote_offset of the remote one. The op_context is returned
+ * in the completion of the operation. The offsets are not validated
+ * against the sizes of the memory regions.
  *
  * RETURN VALUE
- * The rpma_conn_get_completion_fd() function returns 0 on success
- * or a negative error code on failure. rpma_conn_get_completion_fd()
- * does not set *fd value on failure.
+ * The rpma_op_template_start() function returns 0 on success or a negative
+ * error code on failure.
  *
  * ERRORS
- * rpma_conn_get_completion_fd() can fail with the following error:
+ * rpma_op_template_start() can fail with the following errors:
  *
- * - RPMA_E_INVAL - conn or fd is NULL
+ * - RPMA_E_INVAL - tmpl is NULL or len is 0 or greater than UINT32_MAX
+ * - RPMA_E_PROVIDER - ibv_post_send(3) failed
  *
  * SEE ALSO
- * rpma_conn_completion_get(3), rpma_conn_completion_wait(3),
- * rpma_conn_req_connect(3), librpma(7) and https://pmem.io/rpma/
+ * rpma_conn_completion_get(3), rpma_op_template_new(3), librpma(7) and
+ * https://pmem.io/rpma/
  */
-int rpma_conn_get_completion_fd(const struct rpma_conn *conn, int *fd);
+int rpma_op_template_start(struct rpma_op_template *tmpl, size_t local_offset,
+		size_t remote_offset, size_t len, const void *op_context);
 
-enum rpma_op {
-	RPMA_OP_READ,
-	RPMA_OP_WRITE,
-	RPMA_OP_FLUSH,
-	RPMA_OP_SEND,
-	RPMA_OP_RECV,
-	RPMA_OP_RECV_RDMA_WITH_IMM,
-};
+/* performance statistics */
 
-struct rpma_completion {
-	void *op_context;
-	enum rpma_op op;
-	uint32_t byte_len;
-	enum ibv_wc_status op_status;
-	unsigned flags;
-	uint32_t imm;
+/* the number of the operation types (enum rpma_op) */
+#define RPMA_STATS_OPS	(RPMA_OP_FETCH_AND_ADD + 1)
+
+/* the number of the buckets of a latency histogram */
+#define RPMA_STATS_HIST_BUCKETS	32
+
+struct rpma_stats {
+	/* the operations posted successfully by type */
+	uint64_t ops[RPMA_STATS_OPS];
+	/* the bytes of the operations posted successfully by type */
+	uint64_t bytes[RPMA_STATS_OPS];
+	/* the posting calls (including the failed ones) */
+	uint64_t posts;
+	/* the completions collected */
+	uint64_t cqes;
+	/* the polls which have not found any completion */
+	uint64_t empty_polls;
+	/* the wake-ups of the completion channel */
+	uint64_t cq_wakeups;
+	/* the completions of the failed operations */
+	uint64_t error_cqes;
+	/* the failed completions of the flushed operations */
+	uint64_t flushed_cqes;
+	/*
+	 * the latency histograms by type
+	 * (the bucket i: [2^i, 2^(i+1)) ticks)
+	 */
+	uint64_t latency[RPMA_STATS_OPS][RPMA_STATS_HIST_BUCKETS];
+	/* the frequency of the clock of the latency histograms */
+	uint64_t ticks_per_sec;
 };
 
 /** 3
- * rpma_conn_completion_wait - wait for a completion
+ * rpma_conn_get_stats - take a snapshot of the statistics of the connection
  *
  * SYNOPSIS
  *
  *	#include <librpma.h>
  *
  *	struct rpma_conn;
- *	int rpma_conn_completion_wait(struct rpma_conn *conn);
+ *	struct rpma_stats {
+ *		uint64_t ops[RPMA_STATS_OPS];
+ *		uint64_t bytes[RPMA_STATS_OPS];
+ *		uint64_t posts;
+ *		uint64_t cqes;
+ *		uint64_t empty_polls;
+ *		uint64_t cq_wakeups;
+ *		uint64_t error_cqes;
+ *		uint64_t flushed_cqes;
+ *		uint64_t latency[RPMA_STATS_OPS][RPMA_STATS_HIST_BUCKETS];
+ *		uint64_t ticks_per_sec;
+ *	};
+ *	int rpma_conn_get_stats(const struct rpma_conn *conn,
+ *			struct rpma_stats *stats);
  *
  * DESCRIPTION
- * rpma_conn_completion_wait() waits for an incoming completion. If it
- * succeeds the completion can be collected using rpma_conn_completion_get().
+ * rpma_conn_get_stats() takes a snapshot of the performance statistics
+ * collected by the connection (see rpma_conn_cfg_set_stats(3)). The arrays
+ * are indexed by the type of the operation (enum rpma_op). A flush is
+ * counted as RPMA_OP_FLUSH, a write with immediate data and an atomic write
+ * as RPMA_OP_WRITE and a send with immediate data as RPMA_OP_SEND.
+ * The operations posted bypassing the connection's API (e.g. via
+ * rpma_ring_submit(3), rpma_op_template_start(3) or rpma_fast_write(3)) are
+ * not counted.
+ *
+ * The latency is measured from posting a signaled operation until
+ * collecting its completion. The bucket i of a histogram counts
+ * the latencies of [2^i, 2^(i+1)) ticks of the clock (the last bucket counts
+ * also all the longer ones). The ticks_per_sec is the frequency of the clock
+ * (the TSC on x86). The latency is not collected any longer after the first
+ * failed completion.
+ *
+ * The counters are updated without any lock so the snapshot can be taken at
+ * any time but it is not atomic as a whole.
  *
  * RETURN VALUE
- * The rpma_conn_completion_wait() function returns 0 on success
- * or a negative error code on failure.
+ * The rpma_conn_get_stats() function returns 0 on success or a negative
+ * error code on failure. rpma_conn_get_stats() does not set *stats value
+ * on failure.
  *
  * ERRORS
- * rpma_conn_completion_wait() can fail with the following errors:
+ * rpma_conn_get_stats() can fail with the following errors:
  *
- * - RPMA_E_INVAL - conn is NULL
- * - RPMA_E_PROVIDER - ibv_req_notify_cq(3) failed with a provider error
- * - RPMA_E_NO_COMPLETION - no completions available
+ * - RPMA_E_INVAL - conn or stats is NULL
+ * - RPMA_E_NOSUPP - the connection does not collect any statistics
  *
  * SEE ALSO
- * rpma_conn_get_completion_fd(3), rpma_conn_completion_get(3),
- * rpma_conn_req_connect(3), librpma(7) and https://pmem.io/rpma/
+ * rpma_conn_cfg_set_stats(3), rpma_peer_get_stats(3), librpma(7) and
+ * https://pmem.io/rpma/
  */
-int rpma_conn_completion_wait(struct rpma_conn *conn);
+int rpma_conn_get_stats(const struct rpma_conn *conn, struct rpma_stats *stats);
 
 /** 3
- * rpma_conn_completion_get - receive a completion of an operation
+ * rpma_peer_get_stats - take a snapshot of the statistics of the peer
  *
  * SYNOPSIS
  *
  *	#include <librpma.h>
  *
- *	struct rpma_conn;
- *	struct rpma_completion;
- *	enum rpma_op {
- *		RPMA_OP_READ,
- *		RPMA_OP_WRITE,
- *		RPMA_OP_FLUSH,
- *		RPMA_OP_SEND,
- *		RPMA_OP_RECV,
- *		RPMA_OP_RECV_RDMA_WITH_IMM,
- *	};
- *
- *	int rpma_conn_completion_get(struct rpma_conn *conn,
- *			struct rpma_completion *cmpl);
+ *	struct rpma_peer;
+ *	struct rpma_stats;
+ *	int rpma_peer_get_stats(struct rpma_peer *peer,
+ *			struct rpma_stats *stats);
  *
  * DESCRIPTION
- * rpma_conn_completion_get() receives the next available completion
- * of an already posted operation. All operations generate completion on
- * error. The operations posted with the **RPMA_F_COMPLETION_ALWAYS** flag
- * also generate a completion on success.
- * The following operations are available:
- * - RPMA_OP_READ - RMA read operation
- * - RPMA_OP_WRITE - RMA write operation
- * - RPMA_OP_FLUSH - RMA flush operation
- * - RPMA_OP_SEND - messaging send operation
- * - RPMA_OP_RECV - messaging receive operation
- * - RPMA_OP_RECV_RDMA_WITH_IMM - messaging receive operation for
- *   RMA write operation with immediate data
+ * rpma_peer_get_stats() sums up the statistics of all the connections of
+ * the peer collecting them (see rpma_conn_cfg_set_stats(3)) including
+ * the connections already deleted. The fields are described in
+ * rpma_conn_get_stats(3).
  *
  * RETURN VALUE
- * The rpma_conn_completion_get() function returns 0 on success
- * or a negative error code on failure.
+ * The rpma_peer_get_stats() function returns 0 on success or a negative
+ * error code on failure. rpma_peer_get_stats() does not set *stats value
+ * on failure.
  *
  * ERRORS
- * rpma_conn_completion_get() can fail with the following errors:
+ * rpma_peer_get_stats() can fail with the following error:
  *
- * - RPMA_E_INVAL - conn or cmpl is NULL
- * - RPMA_E_NO_COMPLETION - no completions available
- * - RPMA_E_PROVIDER - ibv_poll_cq(3) failed with a provider error
- * - RPMA_E_UNKNOWN - ibv_poll_cq(3) failed but no provider error is available
- * - RPMA_E_NOSUPP - not supported opcode
+ * - RPMA_E_INVAL - peer or stats is NULL
  *
  * SEE ALSO
- * rpma_conn_get_completion_fd(3), rpma_conn_completion_wait(3),
- * rpma_conn_req_connect(3), rpma_flush(3), rpma_read(3), rpma_recv(3),
- * rpma_send(3), rpma_write(3), rpma_write_atomic(3), librpma(7) and
+ * rpma_conn_get_stats(3), rpma_peer_new(3), librpma(7) and
  * https://pmem.io/rpma/
  */
-int rpma_conn_completion_get(struct rpma_conn *conn,
-		struct rpma_completion *cmpl);
+int rpma_peer_get_stats(struct rpma_peer *peer, struct rpma_stats *stats);
 
 /* error handling */
 
@@ -2786,7 +8034,9 @@ typedef void rpma_log_function(
  * rpma_log_set_function() allows choosing the function which will get all
  * the generated logging messages. The log_function can be either
  * RPMA_LOG_USE_DEFAULT_FUNCTION which will use the default logging function
- * (built into the library) or a pointer to a user-defined function.
+ * (built into the library), rpma_log_async_function which will use
+ * the asynchronous logging function (built into the library, see
+ * rpma_log_async_function(3)) or a pointer to a user-defined function.
  *
  * Parameters of a user-defined log function are as follow:
  * - level - the log level of the message
@@ -2809,6 +8059,8 @@ typedef void rpma_log_function(
  *
  * ERRORS
  * - RPMA_E_AGAIN - a temporary error occurred, the retry may fix the problem
+ * - RPMA_E_PROVIDER - starting the formatter thread of the asynchronous
+ *   logging function failed
  *
  * NOTE
  * The logging messages on the levels above the RPMA_LOG_THRESHOLD
@@ -2817,11 +8069,59 @@ typedef void rpma_log_function(
  * The user defined function must be thread-safe.
  *
  * SEE ALSO
- * rpma_log_get_threshold(3), rpma_log_set_threshold(3), librpma(7) and
- * https://pmem.io/rpma/
+ * rpma_log_async_function(3), rpma_log_get_threshold(3),
+ * rpma_log_set_threshold(3), librpma(7) and https://pmem.io/rpma/
  */
 int rpma_log_set_function(rpma_log_function *log_function);
 
+/** 3
+ * rpma_log_async_function - the asynchronous logging function
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma.h>
+ *
+ *	void rpma_log_async_function(enum rpma_log_level level,
+ *		const char *file_name, const int line_no,
+ *		const char *function_name, const char *message_format, ...);
+ *
+ * DESCRIPTION
+ * rpma_log_async_function() is the logging function built into the library
+ * which can be selected with rpma_log_set_function(3) instead of the default
+ * one. It writes the messages to the same destinations in the same format
+ * as the default logging function does but not on the calling thread:
+ *
+ * - the message is formatted into a record of a lock-free ring owned by
+ *   the calling thread (created on the first use) together with its level,
+ *   source location and the time it was logged at
+ * - a background formatter thread (started by rpma_log_set_function(3))
+ *   collects the records of all of the threads and writes them to syslog(3)
+ *   and stderr(3)
+ * - if the ring of the thread is full the message is dropped and the number
+ *   of the dropped messages is logged as soon as possible
+ * - at most 10 messages coming from the same place of the source code are
+ *   written every second and the number of the suppressed ones is logged
+ *   when the second passes
+ *
+ * The messages on the RPMA_LOG_LEVEL_FATAL level, the messages logged in
+ * a child process after fork(2) and the messages logged after the library is
+ * unloaded are written directly. The pending messages are written and
+ * the formatter thread is stopped when another logging function is set
+ * with rpma_log_set_function(3) or when the library is unloaded.
+ *
+ * NOTE
+ * file_name and function_name have to be string literals (e.g. __FILE__ and
+ * __func__) since they are accessed after the function returns. A message
+ * longer than 255 characters is truncated.
+ *
+ * SEE ALSO
+ * rpma_log_set_function(3), rpma_log_set_threshold(3), librpma(7) and
+ * https://pmem.io/rpma/
+ */
+void rpma_log_async_function(enum rpma_log_level level,
+	const char *file_name, const int line_no,
+	const char *function_name, const char *message_format, ...);
+
 #ifdef __cplusplus
 }
 #endif
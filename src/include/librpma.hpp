@@ -0,0 +1,534 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * librpma.hpp -- C++20 header-only wrapper of librpma
+ *
+ * The wrapper does not add any state to the library objects. It provides:
+ *
+ * - move-only RAII handles of the peer, the memory regions, the endpoint
+ *   and the connection (the C *_delete() functions are called from
+ *   the destructors, their errors are ignored there),
+ * - co_await-able operations (read, write, flush, send and recv) resumed
+ *   by rpma::conn::dispatch() which collects the completions in batches.
+ *
+ * An awaited operation lives in the frame of the suspended coroutine and
+ * its address is used as the op_context of the posted operation so
+ * no allocation takes place per operation. All the operations posted via
+ * a connection whose completions are collected by rpma::conn::dispatch()
+ * have to be posted via the awaitables.
+ *
+ * Failures are reported as exceptions: rpma::error carries the RPMA_E_*
+ * code of the failed call and rpma::completion_error carries the failed
+ * completion.
+ */
+
+#ifndef LIBRPMA_HPP
+#define LIBRPMA_HPP 1
+
+#include <algorithm>
+#include <array>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <stdexcept>
+#include <utility>
+
+#include <librpma.h>
+
+namespace rpma
+{
+
+/*
+ * error -- a librpma call has failed with the RPMA_E_* code
+ */
+class error : public std::runtime_error {
+public:
+	explicit error(int code) :
+		std::runtime_error(rpma_err_2str(code)), code_(code)
+	{
+	}
+
+	int code() const noexcept { return code_; }
+
+private:
+	int code_;
+};
+
+/*
+ * completion_error -- an operation has completed with an error status
+ */
+class completion_error : public std::runtime_error {
+public:
+	explicit completion_error(const rpma_completion &cmpl) :
+		std::runtime_error("the operation completed with an error"),
+		cmpl_(cmpl)
+	{
+	}
+
+	enum ibv_wc_status status() const noexcept { return cmpl_.op_status; }
+	const rpma_completion &completion() const noexcept { return cmpl_; }
+
+private:
+	rpma_completion cmpl_;
+};
+
+namespace detail
+{
+
+/*
+ * check -- throw rpma::error if the librpma call has failed
+ */
+inline void
+check(int ret)
+{
+	if (ret)
+		throw error(ret);
+}
+
+/*
+ * handle -- a move-only owner of a librpma object
+ */
+template <typename T, int (*Delete)(T **)>
+class handle {
+public:
+	handle() noexcept = default;
+	explicit handle(T *ptr) noexcept : ptr_(ptr) {}
+	handle(handle &&other) noexcept :
+		ptr_(std::exchange(other.ptr_, nullptr))
+	{
+	}
+
+	handle &
+	operator=(handle &&other) noexcept
+	{
+		if (this != &other) {
+			reset();
+			ptr_ = std::exchange(other.ptr_, nullptr);
+		}
+		return *this;
+	}
+
+	handle(const handle &) = delete;
+	handle &operator=(const handle &) = delete;
+
+	~handle() { reset(); }
+
+	T *get() const noexcept { return ptr_; }
+	explicit operator bool() const noexcept { return ptr_ != nullptr; }
+
+	/* release the ownership of the object */
+	T *release() noexcept { return std::exchange(ptr_, nullptr); }
+
+	/* delete the object (errors are ignored) */
+	void
+	reset() noexcept
+	{
+		if (ptr_ != nullptr)
+			(void) Delete(&ptr_);
+		ptr_ = nullptr;
+	}
+
+protected:
+	T *ptr_ = nullptr;
+};
+
+/*
+ * op_state -- the part of an awaitable operation the completion is
+ * delivered to (its address is the op_context of the operation)
+ */
+struct op_state {
+	std::coroutine_handle<> waiter;
+	rpma_completion cmpl;
+};
+
+} /* namespace detail */
+
+/*
+ * operation -- an awaitable operation; Post is a callable posting
+ * the operation with the provided op_context
+ */
+template <typename Post>
+class operation : private detail::op_state {
+public:
+	explicit operation(Post post) noexcept : post_(std::move(post)) {}
+
+	operation(const operation &) = delete;
+	operation &operator=(const operation &) = delete;
+
+	bool await_ready() const noexcept { return false; }
+
+	/* post the operation; do not suspend if the posting fails */
+	bool
+	await_suspend(std::coroutine_handle<> waiter) noexcept
+	{
+		this->waiter = waiter;
+		ret_ = post_(static_cast<const void *>(
+			static_cast<detail::op_state *>(this)));
+		return ret_ == 0;
+	}
+
+	rpma_completion
+	await_resume() const
+	{
+		detail::check(ret_);
+		if (cmpl.op_status != IBV_WC_SUCCESS)
+			throw completion_error(cmpl);
+		return cmpl;
+	}
+
+private:
+	Post post_;
+	int ret_ = 0;
+};
+
+/*
+ * task -- an eagerly started coroutine which does not return a value;
+ * the exception it has finished with is rethrown by get()
+ */
+class task {
+public:
+	struct promise_type {
+		std::exception_ptr exception;
+
+		task
+		get_return_object() noexcept
+		{
+			return task(std::coroutine_handle<
+				promise_type>::from_promise(*this));
+		}
+
+		std::suspend_never
+		initial_suspend() const noexcept
+		{
+			return {};
+		}
+
+		std::suspend_always
+		final_suspend() const noexcept
+		{
+			return {};
+		}
+
+		void return_void() const noexcept {}
+
+		void
+		unhandled_exception() noexcept
+		{
+			exception = std::current_exception();
+		}
+	};
+
+	task(task &&other) noexcept :
+		coro_(std::exchange(other.coro_, nullptr))
+	{
+	}
+
+	task(const task &) = delete;
+	task &operator=(const task &) = delete;
+	task &operator=(task &&) = delete;
+
+	~task()
+	{
+		if (coro_)
+			coro_.destroy();
+	}
+
+	bool done() const noexcept { return coro_.done(); }
+
+	/* rethrow the exception the finished coroutine has ended with */
+	void
+	get() const
+	{
+		if (coro_.promise().exception)
+			std::rethrow_exception(coro_.promise().exception);
+	}
+
+private:
+	explicit task(std::coroutine_handle<promise_type> coro) noexcept :
+		coro_(coro)
+	{
+	}
+
+	std::coroutine_handle<promise_type> coro_;
+};
+
+/*
+ * peer -- an owner of struct rpma_peer
+ */
+class peer : public detail::handle<rpma_peer, rpma_peer_delete> {
+public:
+	explicit peer(struct ibv_context *ibv_ctx)
+	{
+		detail::check(rpma_peer_new(ibv_ctx, &ptr_));
+	}
+
+	/* create a peer using the ibv_context looked up via the address */
+	static peer
+	from_address(const char *addr, enum rpma_util_ibv_context_type type)
+	{
+		struct ibv_context *ibv_ctx = nullptr;
+		detail::check(rpma_utils_get_ibv_context(addr, type, &ibv_ctx));
+		return peer(ibv_ctx);
+	}
+};
+
+/*
+ * mr_local -- an owner of a registered local memory region
+ */
+class mr_local : public detail::handle<rpma_mr_local, rpma_mr_dereg> {
+public:
+	mr_local(peer &p, void *ptr, size_t size, int usage)
+	{
+		detail::check(rpma_mr_reg(p.get(), ptr, size, usage, &ptr_));
+	}
+
+	size_t
+	descriptor_size() const
+	{
+		size_t desc_size = 0;
+		detail::check(rpma_mr_get_descriptor_size(ptr_, &desc_size));
+		return desc_size;
+	}
+
+	void
+	get_descriptor(void *desc) const
+	{
+		detail::check(rpma_mr_get_descriptor(ptr_, desc));
+	}
+};
+
+/*
+ * mr_remote -- an owner of a remote memory region structure
+ */
+class mr_remote : public detail::handle<rpma_mr_remote,
+		rpma_mr_remote_delete> {
+public:
+	mr_remote(const void *desc, size_t desc_size)
+	{
+		detail::check(rpma_mr_remote_from_descriptor(desc, desc_size,
+			&ptr_));
+	}
+
+	size_t
+	size() const
+	{
+		size_t size = 0;
+		detail::check(rpma_mr_remote_get_size(ptr_, &size));
+		return size;
+	}
+
+	int
+	flush_type() const
+	{
+		int flush_type = 0;
+		detail::check(rpma_mr_remote_get_flush_type(ptr_, &flush_type));
+		return flush_type;
+	}
+};
+
+class endpoint;
+
+/*
+ * conn -- an owner of an established connection
+ */
+class conn : public detail::handle<rpma_conn, rpma_conn_delete> {
+public:
+	/* take over the ownership of the connection */
+	explicit conn(rpma_conn *c) noexcept : handle(c) {}
+
+	/* connect to the server listening at addr:port */
+	static conn
+	connect(peer &p, const char *addr, const char *port,
+		const rpma_conn_cfg *cfg = nullptr,
+		const rpma_conn_private_data *pdata = nullptr)
+	{
+		rpma_conn_req *req = nullptr;
+		detail::check(rpma_conn_req_new(p.get(), addr, port, cfg,
+			&req));
+		return establish(req, pdata);
+	}
+
+	enum rpma_conn_event
+	next_event()
+	{
+		enum rpma_conn_event event = RPMA_CONN_UNDEFINED;
+		detail::check(rpma_conn_next_event(ptr_, &event));
+		return event;
+	}
+
+	rpma_conn_private_data
+	private_data() const
+	{
+		rpma_conn_private_data pdata{};
+		detail::check(rpma_conn_get_private_data(ptr_, &pdata));
+		return pdata;
+	}
+
+	void disconnect() { detail::check(rpma_conn_disconnect(ptr_)); }
+
+	int
+	completion_fd() const
+	{
+		int fd = -1;
+		detail::check(rpma_conn_get_completion_fd(ptr_, &fd));
+		return fd;
+	}
+
+	auto
+	read(mr_local &dst, size_t dst_offset, const mr_remote &src,
+		size_t src_offset, size_t len)
+	{
+		return operation([=, c = ptr_, d = dst.get(), s = src.get()](
+				const void *op_context) {
+			return rpma_read(c, d, dst_offset, s, src_offset, len,
+				RPMA_F_COMPLETION_ALWAYS, op_context);
+		});
+	}
+
+	auto
+	write(mr_remote &dst, size_t dst_offset, const mr_local &src,
+		size_t src_offset, size_t len)
+	{
+		return operation([=, c = ptr_, d = dst.get(), s = src.get()](
+				const void *op_context) {
+			return rpma_write(c, d, dst_offset, s, src_offset, len,
+				RPMA_F_COMPLETION_ALWAYS, op_context);
+		});
+	}
+
+	auto
+	flush(mr_remote &dst, size_t dst_offset, size_t len,
+		enum rpma_flush_type type)
+	{
+		return operation([=, c = ptr_, d = dst.get()](
+				const void *op_context) {
+			return rpma_flush(c, d, dst_offset, len, type,
+				RPMA_F_COMPLETION_ALWAYS, op_context);
+		});
+	}
+
+	auto
+	send(const mr_local &src, size_t offset, size_t len)
+	{
+		return operation([=, c = ptr_, s = src.get()](
+				const void *op_context) {
+			return rpma_send(c, s, offset, len,
+				RPMA_F_COMPLETION_ALWAYS, op_context);
+		});
+	}
+
+	auto
+	recv(mr_local &dst, size_t offset, size_t len)
+	{
+		return operation([=, c = ptr_, d = dst.get()](
+				const void *op_context) {
+			return rpma_recv(c, d, offset, len, op_context);
+		});
+	}
+
+	/*
+	 * dispatch -- collect up to max_num completions in batches and resume
+	 * the coroutines awaiting them; returns the number of the collected
+	 * completions
+	 */
+	size_t
+	dispatch(size_t max_num = RPMA_PROGRESS_BATCH_DEFAULT)
+	{
+		std::array<rpma_completion, RPMA_PROGRESS_BATCH_DEFAULT> batch;
+		size_t total = 0;
+
+		while (total < max_num) {
+			size_t want = std::min(max_num - total, batch.size());
+			size_t n = 0;
+			int ret = 0;
+			for (; n < want; ++n) {
+				ret = rpma_conn_completion_get(ptr_, &batch[n]);
+				if (ret)
+					break;
+			}
+
+			/* the collected completions are dispatched anyway */
+			for (size_t i = 0; i < n; ++i)
+				resume(batch[i]);
+			total += n;
+
+			if (ret == RPMA_E_NO_COMPLETION)
+				break;
+			detail::check(ret);
+		}
+
+		return total;
+	}
+
+	/*
+	 * wait -- wait for the completion event; returns false if there is
+	 * no completion to be collected
+	 */
+	bool
+	wait()
+	{
+		int ret = rpma_conn_completion_wait(ptr_);
+		if (ret == RPMA_E_NO_COMPLETION)
+			return false;
+		detail::check(ret);
+		return true;
+	}
+
+private:
+	friend class endpoint;
+
+	/* connect the request and wait for the connection establishment */
+	static conn
+	establish(rpma_conn_req *req, const rpma_conn_private_data *pdata)
+	{
+		rpma_conn *c = nullptr;
+		int ret = rpma_conn_req_connect(&req, pdata, &c);
+		if (ret) {
+			(void) rpma_conn_req_delete(&req);
+			throw error(ret);
+		}
+
+		conn established(c);
+		if (established.next_event() != RPMA_CONN_ESTABLISHED)
+			throw error(RPMA_E_UNKNOWN);
+
+		return established;
+	}
+
+	static void
+	resume(const rpma_completion &cmpl)
+	{
+		auto *op = static_cast<detail::op_state *>(cmpl.op_context);
+		if (op == nullptr)
+			return;
+
+		op->cmpl = cmpl;
+		op->waiter.resume();
+	}
+};
+
+/*
+ * endpoint -- an owner of a listening endpoint
+ */
+class endpoint : public detail::handle<rpma_ep, rpma_ep_shutdown> {
+public:
+	endpoint(peer &p, const char *addr, const char *port)
+	{
+		detail::check(rpma_ep_listen(p.get(), addr, port, &ptr_));
+	}
+
+	/* accept the next incoming connection request */
+	conn
+	accept(const rpma_conn_cfg *cfg = nullptr,
+		const rpma_conn_private_data *pdata = nullptr)
+	{
+		rpma_conn_req *req = nullptr;
+		detail::check(rpma_ep_next_conn_req(ptr_, cfg, &req));
+		return conn::establish(req, pdata);
+	}
+};
+
+} /* namespace rpma */
+
+#endif /* LIBRPMA_HPP */
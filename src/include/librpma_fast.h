@@ -0,0 +1,332 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * librpma_fast.h -- the fast-path posting functions of librpma
+ *
+ * rpma_fast_read() and rpma_fast_write() are static inline functions which
+ * build the work request on the stack and post it with ibv_post_send(3)
+ * without calling into the library. Everything they need is resolved once
+ * into the fast handles (struct rpma_fast_conn and struct rpma_fast_mr).
+ * The layout of the handles is a part of the ABI of the library but their
+ * members are private and must not be accessed directly.
+ *
+ * The arguments are validated only if RPMA_FAST_DEBUG is defined before
+ * this header is included. A failed post is logged out of line by
+ * rpma_fast_post_failed() so the inlined code stays small.
+ *
+ * The inlined code lives in the application so the rpma:post_chain
+ * tracepoint of the library (see trace.h) is compiled into it only if
+ * RPMA_FAST_USDT is defined before this header is included.
+ */
+
+#ifndef LIBRPMA_FAST_H
+#define LIBRPMA_FAST_H 1
+
+#include <librpma.h>
+
+#ifdef RPMA_FAST_USDT
+#include <sys/sdt.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* the fast handles */
+
+struct rpma_fast_conn {
+	struct ibv_qp *qp; /* the QP of the connection */
+	uint32_t *unfenced; /* the unfenced domains of the connection */
+};
+
+struct rpma_fast_mr {
+	uint64_t addr; /* the base address of the memory region */
+	uint64_t size; /* the size of the memory region */
+	uint32_t key; /* lkey (local) or rkey (remote) of the memory region */
+	uint32_t reserved;
+};
+
+/** 3
+ * rpma_conn_get_fast - get the fast handle of the connection
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma_fast.h>
+ *
+ *	struct rpma_conn;
+ *	struct rpma_fast_conn;
+ *	int rpma_conn_get_fast(struct rpma_conn *conn,
+ *			struct rpma_fast_conn *fconn);
+ *
+ * DESCRIPTION
+ * rpma_conn_get_fast() fills the fast handle of the connection used by
+ * rpma_fast_read(3) and rpma_fast_write(3). The handle is valid until
+ * the connection is deleted.
+ *
+ * RETURN VALUE
+ * The rpma_conn_get_fast() function returns 0 on success or a negative error
+ * code on failure. rpma_conn_get_fast() does not set *fconn value on failure.
+ *
+ * ERRORS
+ * rpma_conn_get_fast() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - conn or fconn is NULL
+ * - RPMA_E_NOSUPP - the connection works in a thread-safe mode (see
+ *   rpma_conn_cfg_set_thread_mode(3)) or collects the latency (see
+ *   rpma_conn_cfg_set_stats(3))
+ *
+ * SEE ALSO
+ * rpma_conn_req_connect(3), rpma_fast_read(3), rpma_fast_write(3),
+ * librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_conn_get_fast(struct rpma_conn *conn, struct rpma_fast_conn *fconn);
+
+/** 3
+ * rpma_mr_get_fast - get the fast handle of the local memory region
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma_fast.h>
+ *
+ *	struct rpma_mr_local;
+ *	struct rpma_fast_mr;
+ *	int rpma_mr_get_fast(const struct rpma_mr_local *mr,
+ *			struct rpma_fast_mr *fmr);
+ *
+ * DESCRIPTION
+ * rpma_mr_get_fast() fills the fast handle of the local memory region used
+ * by rpma_fast_read(3) and rpma_fast_write(3). The handle is valid until
+ * the memory region is deregistered.
+ *
+ * RETURN VALUE
+ * The rpma_mr_get_fast() function returns 0 on success or a negative error
+ * code on failure. rpma_mr_get_fast() does not set *fmr value on failure.
+ *
+ * ERRORS
+ * rpma_mr_get_fast() can fail with the following error:
+ *
+ * - RPMA_E_INVAL - mr or fmr is NULL
+ *
+ * SEE ALSO
+ * rpma_mr_reg(3), rpma_fast_read(3), rpma_fast_write(3), librpma(7) and
+ * https://pmem.io/rpma/
+ */
+int rpma_mr_get_fast(const struct rpma_mr_local *mr, struct rpma_fast_mr *fmr);
+
+/** 3
+ * rpma_mr_remote_get_fast - get the fast handle of the remote memory region
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma_fast.h>
+ *
+ *	struct rpma_mr_remote;
+ *	struct rpma_fast_mr;
+ *	int rpma_mr_remote_get_fast(const struct rpma_mr_remote *mr,
+ *			struct rpma_fast_mr *fmr);
+ *
+ * DESCRIPTION
+ * rpma_mr_remote_get_fast() fills the fast handle of the remote memory region
+ * used by rpma_fast_read(3) and rpma_fast_write(3). The handle stays valid
+ * after the remote memory region structure is deleted.
+ *
+ * RETURN VALUE
+ * The rpma_mr_remote_get_fast() function returns 0 on success or a negative
+ * error code on failure. rpma_mr_remote_get_fast() does not set *fmr value
+ * on failure.
+ *
+ * ERRORS
+ * rpma_mr_remote_get_fast() can fail with the following error:
+ *
+ * - RPMA_E_INVAL - mr or fmr is NULL
+ *
+ * SEE ALSO
+ * rpma_mr_remote_from_descriptor(3), rpma_fast_read(3), rpma_fast_write(3),
+ * librpma(7) and https://pmem.io/rpma/
+ */
+int rpma_mr_remote_get_fast(const struct rpma_mr_remote *mr,
+		struct rpma_fast_mr *fmr);
+
+/*
+ * rpma_fast_post_failed -- log the failed post of the work request and
+ * return RPMA_E_PROVIDER (called only by the fast-path posting functions)
+ */
+int
+rpma_fast_post_failed(const struct ibv_send_wr *wr, int err)
+	__attribute__((cold));
+
+#ifdef RPMA_FAST_DEBUG
+/*
+ * rpma_fast_args_invalid -- validate the arguments of the fast-path posting
+ * functions (compiled in only if RPMA_FAST_DEBUG is defined)
+ */
+static inline int
+rpma_fast_args_invalid(const struct rpma_fast_conn *fconn,
+	const struct rpma_fast_mr *local, size_t local_offset,
+	const struct rpma_fast_mr *remote, size_t remote_offset,
+	size_t len, int flags)
+{
+	if (fconn == NULL || local == NULL || remote == NULL || flags == 0 ||
+			len > UINT32_MAX)
+		return 1;
+
+	return len > local->size || local_offset > local->size - len ||
+		len > remote->size || remote_offset > remote->size - len;
+}
+#endif
+
+/*
+ * rpma_fast_post -- post the work request built on the stack
+ */
+static inline int
+rpma_fast_post(const struct rpma_fast_conn *fconn, enum ibv_wr_opcode opcode,
+	const struct rpma_fast_mr *local, size_t local_offset,
+	const struct rpma_fast_mr *remote, size_t remote_offset,
+	size_t len, int flags, const void *op_context)
+{
+	struct ibv_sge sge;
+	sge.addr = local->addr + local_offset;
+	sge.length = (uint32_t)len;
+	sge.lkey = local->key;
+
+	struct ibv_send_wr wr;
+	wr.wr_id = (uint64_t)(uintptr_t)op_context;
+	wr.next = NULL;
+	wr.sg_list = &sge;
+	wr.num_sge = 1;
+	wr.opcode = opcode;
+	wr.send_flags = (flags & RPMA_F_COMPLETION_ALWAYS &
+		~RPMA_F_COMPLETION_ON_ERROR) ? IBV_SEND_SIGNALED : 0;
+	wr.wr.rdma.remote_addr = remote->addr + remote_offset;
+	wr.wr.rdma.rkey = remote->key;
+
+	struct ibv_send_wr *bad_wr;
+#ifdef RPMA_FAST_USDT
+	STAP_PROBE3(rpma, post_chain, fconn->qp, wr.wr_id, 1);
+#endif
+	int ret = ibv_post_send(fconn->qp, &wr, &bad_wr);
+	if (__builtin_expect(ret != 0, 0))
+		return rpma_fast_post_failed(&wr, ret);
+
+	return 0;
+}
+
+/** 3
+ * rpma_fast_read - initiate the read operation on the fast path
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma_fast.h>
+ *
+ *	struct rpma_fast_conn;
+ *	struct rpma_fast_mr;
+ *	static inline int rpma_fast_read(const struct rpma_fast_conn *fconn,
+ *			const struct rpma_fast_mr *dst, size_t dst_offset,
+ *			const struct rpma_fast_mr *src, size_t src_offset,
+ *			size_t len, int flags, const void *op_context);
+ *
+ * DESCRIPTION
+ * rpma_fast_read() initiates transferring data from the remote memory
+ * to the local memory exactly as rpma_read(3) does but it is inlined into
+ * the caller and takes the fast handles of the connection and of the memory
+ * regions (see rpma_conn_get_fast(3), rpma_mr_get_fast(3) and
+ * rpma_mr_remote_get_fast(3)). The flags are the same as of rpma_read(3).
+ *
+ * RETURN VALUE
+ * The rpma_fast_read() function returns 0 on success or a negative error
+ * code on failure.
+ *
+ * ERRORS
+ * rpma_fast_read() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - (only if RPMA_FAST_DEBUG is defined) fconn, dst or src
+ *   is NULL, flags == 0, len > UINT32_MAX or the transfer does not fit in
+ *   any of the memory regions
+ * - RPMA_E_PROVIDER - ibv_post_send(3) failed
+ *
+ * SEE ALSO
+ * rpma_conn_completion_get(3), rpma_fast_write(3), rpma_read(3), librpma(7)
+ * and https://pmem.io/rpma/
+ */
+static inline int
+rpma_fast_read(const struct rpma_fast_conn *fconn,
+	const struct rpma_fast_mr *dst, size_t dst_offset,
+	const struct rpma_fast_mr *src, size_t src_offset,
+	size_t len, int flags, const void *op_context)
+{
+#ifdef RPMA_FAST_DEBUG
+	if (rpma_fast_args_invalid(fconn, dst, dst_offset, src, src_offset,
+			len, flags))
+		return RPMA_E_INVAL;
+#endif
+
+	int ret = rpma_fast_post(fconn, IBV_WR_RDMA_READ, dst, dst_offset,
+			src, src_offset, len, flags, op_context);
+	if (ret)
+		return ret;
+
+	/* the next atomic write has to be fenced after the read */
+	*fconn->unfenced = UINT32_MAX;
+
+	return 0;
+}
+
+/** 3
+ * rpma_fast_write - initiate the write operation on the fast path
+ *
+ * SYNOPSIS
+ *
+ *	#include <librpma_fast.h>
+ *
+ *	struct rpma_fast_conn;
+ *	struct rpma_fast_mr;
+ *	static inline int rpma_fast_write(const struct rpma_fast_conn *fconn,
+ *			const struct rpma_fast_mr *dst, size_t dst_offset,
+ *			const struct rpma_fast_mr *src, size_t src_offset,
+ *			size_t len, int flags, const void *op_context);
+ *
+ * DESCRIPTION
+ * rpma_fast_write() initiates transferring data from the local memory
+ * to the remote memory exactly as rpma_write(3) does but it is inlined into
+ * the caller and takes the fast handles of the connection and of the memory
+ * regions (see rpma_conn_get_fast(3), rpma_mr_get_fast(3) and
+ * rpma_mr_remote_get_fast(3)). The flags are the same as of rpma_write(3).
+ *
+ * RETURN VALUE
+ * The rpma_fast_write() function returns 0 on success or a negative error
+ * code on failure.
+ *
+ * ERRORS
+ * rpma_fast_write() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - (only if RPMA_FAST_DEBUG is defined) fconn, dst or src
+ *   is NULL, flags == 0, len > UINT32_MAX or the transfer does not fit in
+ *   any of the memory regions
+ * - RPMA_E_PROVIDER - ibv_post_send(3) failed
+ *
+ * SEE ALSO
+ * rpma_conn_completion_get(3), rpma_fast_read(3), rpma_write(3), librpma(7)
+ * and https://pmem.io/rpma/
+ */
+static inline int
+rpma_fast_write(const struct rpma_fast_conn *fconn,
+	const struct rpma_fast_mr *dst, size_t dst_offset,
+	const struct rpma_fast_mr *src, size_t src_offset,
+	size_t len, int flags, const void *op_context)
+{
+#ifdef RPMA_FAST_DEBUG
+	if (rpma_fast_args_invalid(fconn, src, src_offset, dst, dst_offset,
+			len, flags))
+		return RPMA_E_INVAL;
+#endif
+
+	return rpma_fast_post(fconn, IBV_WR_RDMA_WRITE, src, src_offset,
+			dst, dst_offset, len, flags, op_context);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LIBRPMA_FAST_H */
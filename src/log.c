@@ -12,6 +12,7 @@
 #include <string.h>
 
 #include "librpma.h"
+#include "log_async.h"
 #include "log_default.h"
 #include "log_internal.h"
 
@@ -63,6 +64,9 @@ rpma_log_fini()
 	 */
 	Rpma_log_function = NULL;
 
+	/* write the pending messages and stop the asynchronous logging */
+	rpma_log_async_fini();
+
 	/* cleanup the default logging function */
 	rpma_log_default_fini();
 }
@@ -82,12 +86,31 @@ rpma_log_set_function(rpma_log_function *log_function)
 
 	rpma_log_function *log_function_old = Rpma_log_function;
 
-	if (__sync_bool_compare_and_swap(&Rpma_log_function,
+	if (!__sync_bool_compare_and_swap(&Rpma_log_function,
 			log_function_old, log_function))
-		return 0;
-	else
 		return RPMA_E_AGAIN;
 
+	if (log_function_old == log_function)
+		return 0;
+
+	/*
+	 * The asynchronous logging function writes the messages directly
+	 * until the formatter thread is started.
+	 */
+	if (log_function == rpma_log_async_function) {
+		int ret = rpma_log_async_start();
+		if (ret) {
+			(void) __sync_bool_compare_and_swap(&Rpma_log_function,
+					log_function, log_function_old);
+			return ret;
+		}
+	} else if (log_function_old == rpma_log_async_function) {
+		/* write the pending messages and stop the formatter thread */
+		rpma_log_async_fini();
+	}
+
+	return 0;
+
 }
 
 /*
@@ -0,0 +1,527 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * log_async.c -- the asynchronous logging function
+ *
+ * rpma_log_async_function() does not write anything on the calling thread.
+ * It formats the message into a record of the ring owned by the calling
+ * thread (the rings are created on the first use and are lock-free) and
+ * returns. The formatter thread collects the records from all of the rings
+ * and writes them using the default logging function's output path so
+ * the costly localtime(3), syslog(3) and fprintf(3) calls are taken off
+ * the hot paths.
+ *
+ * If the ring is full the record is dropped and the number of the dropped
+ * records is logged later on. The formatter thread also limits the rate of
+ * messages coming from a single call site (see RPMA_LOG_ASYNC_RATE_BURST)
+ * so a burst of the same warnings e.g. for the flushed-in-error completions
+ * does not flood the logs. The fatal messages are always written directly.
+ *
+ * A logging thread holds a reference (Log_async.active) while it uses its
+ * ring and rpma_log_async_fini() waits for all of the references to be
+ * dropped before the rings are drained for the last time. Then all of
+ * the rings are freed and the key of the thread-specific data pointing to
+ * them is deleted so no destructor of an unloaded library is called when
+ * a thread exits. The threads still running get new rings after the next
+ * rpma_log_async_start() since a new key is created.
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "librpma.h"
+#include "log_async.h"
+#include "log_default.h"
+#include "log_internal.h"
+#include "mpsc.h"
+
+#ifdef TEST_MOCK_ALLOC
+#include "cmocka_alloc.h"
+#endif
+
+/* the number of call sites the rate of which can be limited */
+#define LOG_ASYNC_SITES		64
+
+struct log_record {
+	enum rpma_log_level level; /* RPMA_LOG_DISABLED - nothing to write */
+	int line_no;
+	const char *file_name; /* a string literal (__FILE__) */
+	const char *function_name; /* a string literal (__func__) */
+	struct timespec ts; /* the time the message was logged at */
+	char message[RPMA_LOG_ASYNC_MESSAGE_MAX];
+};
+
+struct log_ring {
+	struct rpma_mpsc *records; /* filled in only by the owning thread */
+	uint64_t dropped; /* the records dropped because the ring was full */
+	int orphaned; /* the owning thread has exited */
+	struct log_ring *next;
+};
+
+struct log_site {
+	const char *file_name; /* NULL - the site is not used */
+	int line_no;
+	const char *function_name;
+	enum rpma_log_level level;
+	time_t window; /* the beginning of the current window */
+	uint32_t logged; /* the messages logged in the current window */
+	uint32_t suppressed; /* the messages suppressed in the current window */
+};
+
+struct log_async {
+	pthread_mutex_t lock; /* serializes starting and stopping */
+	int atfork; /* the fork handler has been registered */
+	int key_created; /* the key has been created */
+	int running; /* the formatter thread is running */
+	int stop; /* the formatter thread has to stop */
+	unsigned active; /* the threads using their rings at the moment */
+	pthread_t thread;
+	pthread_key_t key; /* the ring of the calling thread */
+	struct log_ring *rings; /* the list of all of the rings */
+	struct log_site sites[LOG_ASYNC_SITES]; /* owned by the formatter */
+};
+
+static struct log_async Log_async = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+/*
+ * log_ring_orphan -- mark the ring of the exiting thread as orphaned so
+ * the formatter thread (or rpma_log_async_fini()) frees it after it is
+ * drained
+ */
+static void
+log_ring_orphan(void *arg)
+{
+	struct log_ring *ring = arg;
+
+	__atomic_store_n(&ring->orphaned, 1, __ATOMIC_RELEASE);
+}
+
+/*
+ * log_ring_get -- get the ring of the calling thread (create and register
+ * it on the first use)
+ */
+static struct log_ring *
+log_ring_get(void)
+{
+	struct log_ring *ring = pthread_getspecific(Log_async.key);
+	if (ring)
+		return ring;
+
+	ring = malloc(sizeof(*ring));
+	if (ring == NULL)
+		return NULL;
+
+	if (rpma_mpsc_new(RPMA_LOG_ASYNC_RING_SIZE, sizeof(struct log_record),
+			&ring->records))
+		goto err_free_ring;
+
+	ring->dropped = 0;
+	ring->orphaned = 0;
+
+	if (pthread_setspecific(Log_async.key, ring))
+		goto err_delete_records;
+
+	/*
+	 * the rings are unlinked only by the formatter thread and
+	 * by rpma_log_async_fini() when there are no active threads
+	 * so pushing is enough
+	 */
+	ring->next = __atomic_load_n(&Log_async.rings, __ATOMIC_RELAXED);
+	while (!__atomic_compare_exchange_n(&Log_async.rings, &ring->next,
+			ring, true /* weak */, __ATOMIC_RELEASE,
+			__ATOMIC_RELAXED))
+		;
+
+	return ring;
+
+err_delete_records:
+	(void) rpma_mpsc_delete(&ring->records);
+
+err_free_ring:
+	free(ring);
+
+	return NULL;
+}
+
+/*
+ * log_site_flush -- write how many messages have been suppressed
+ * at the call site
+ */
+static void
+log_site_flush(struct log_site *site)
+{
+	char message[64];
+
+	if (site->suppressed == 0)
+		return;
+
+	(void) snprintf(message, sizeof(message),
+		"%" PRIu32 " similar message(s) suppressed\n",
+		site->suppressed);
+	rpma_log_default_write(site->level, site->file_name, site->line_no,
+		site->function_name, message, NULL /* now */);
+
+	site->suppressed = 0;
+}
+
+/*
+ * log_sites_flush -- write how many messages have been suppressed at all of
+ * the call sites (all == true) or only at those the window of which has
+ * already passed
+ */
+static void
+log_sites_flush(bool all)
+{
+	struct timespec now = {0};
+
+	if (!all)
+		(void) clock_gettime(CLOCK_REALTIME, &now);
+
+	for (int i = 0; i < LOG_ASYNC_SITES; ++i) {
+		struct log_site *site = &Log_async.sites[i];
+		if (all || now.tv_sec >=
+				site->window + RPMA_LOG_ASYNC_RATE_WINDOW_S)
+			log_site_flush(site);
+	}
+}
+
+/*
+ * log_site_get -- find the call site of the record (or take a free one)
+ *
+ * If all of the sites are taken the rate of the record is not limited.
+ */
+static struct log_site *
+log_site_get(const struct log_record *record)
+{
+	uintptr_t hash = ((uintptr_t)record->file_name >> 3) ^
+			((uintptr_t)record->line_no * 31);
+
+	for (uintptr_t i = 0; i < LOG_ASYNC_SITES; ++i) {
+		struct log_site *site =
+			&Log_async.sites[(hash + i) % LOG_ASYNC_SITES];
+
+		if (site->file_name == NULL) {
+			site->file_name = record->file_name;
+			site->line_no = record->line_no;
+			site->function_name = record->function_name;
+			site->window = record->ts.tv_sec;
+			site->logged = 0;
+			site->suppressed = 0;
+			return site;
+		}
+
+		if (site->file_name == record->file_name &&
+				site->line_no == record->line_no)
+			return site;
+	}
+
+	return NULL;
+}
+
+/*
+ * log_record_write -- write the record unless the rate of messages coming
+ * from its call site is exceeded
+ */
+static void
+log_record_write(const struct log_record *record)
+{
+	/* the message could not be formatted */
+	if (record->level == RPMA_LOG_DISABLED)
+		return;
+
+	struct log_site *site = NULL;
+	if (record->file_name)
+		site = log_site_get(record);
+
+	if (site) {
+		if (record->ts.tv_sec >=
+				site->window + RPMA_LOG_ASYNC_RATE_WINDOW_S) {
+			log_site_flush(site);
+			site->window = record->ts.tv_sec;
+			site->logged = 0;
+		}
+
+		site->level = record->level;
+		if (site->logged == RPMA_LOG_ASYNC_RATE_BURST) {
+			site->suppressed++;
+			return;
+		}
+		site->logged++;
+	}
+
+	rpma_log_default_write(record->level, record->file_name,
+		record->line_no, record->function_name, record->message,
+		&record->ts);
+}
+
+/*
+ * log_rings_drain -- write all of the records published so far and free
+ * the drained rings of the exited threads
+ */
+static unsigned
+log_rings_drain(void)
+{
+	struct log_ring *prev = NULL;
+	struct log_ring *ring =
+		__atomic_load_n(&Log_async.rings, __ATOMIC_ACQUIRE);
+	struct log_record *record;
+	unsigned n = 0;
+	uint64_t pos;
+
+	while (ring) {
+		/* the records published before the thread exited are drained */
+		int orphaned = __atomic_load_n(&ring->orphaned,
+				__ATOMIC_ACQUIRE);
+
+		while ((record = rpma_mpsc_consume(ring->records, &pos))) {
+			log_record_write(record);
+			rpma_mpsc_release(ring->records, pos);
+			++n;
+		}
+
+		uint64_t dropped = __atomic_exchange_n(&ring->dropped, 0,
+				__ATOMIC_RELAXED);
+		if (dropped) {
+			char message[64];
+			(void) snprintf(message, sizeof(message),
+				"%" PRIu64 " message(s) dropped\n", dropped);
+			rpma_log_default_write(RPMA_LOG_LEVEL_WARNING, NULL, 0,
+				NULL, message, NULL /* now */);
+		}
+
+		struct log_ring *next = ring->next;
+
+		/* the head of the list may be replaced by a producer */
+		if (orphaned && prev != NULL) {
+			prev->next = next;
+			(void) rpma_mpsc_delete(&ring->records);
+			free(ring);
+		} else {
+			prev = ring;
+		}
+
+		ring = next;
+	}
+
+	return n;
+}
+
+/*
+ * log_async_thread -- the main loop of the formatter thread
+ */
+static void *
+log_async_thread(void *arg)
+{
+	struct timespec idle = {0, RPMA_LOG_ASYNC_IDLE_NS};
+
+	while (!__atomic_load_n(&Log_async.stop, __ATOMIC_ACQUIRE)) {
+		if (log_rings_drain())
+			continue;
+
+		log_sites_flush(false /* only the passed windows */);
+		(void) nanosleep(&idle, NULL);
+	}
+
+	/* write everything logged before the stop request */
+	(void) log_rings_drain();
+	log_sites_flush(true /* all */);
+
+	return NULL;
+}
+
+/*
+ * log_async_atfork_child -- the formatter thread does not exist in the child
+ * process so the messages are written directly there
+ */
+static void
+log_async_atfork_child(void)
+{
+	/* the rings of the parent's threads are left behind */
+	if (Log_async.key_created)
+		(void) pthread_setspecific(Log_async.key, NULL);
+
+	Log_async.running = 0;
+	Log_async.active = 0;
+	Log_async.rings = NULL;
+	memset(Log_async.sites, 0, sizeof(Log_async.sites));
+	(void) pthread_mutex_init(&Log_async.lock, NULL);
+}
+
+/* internal librpma API */
+
+/*
+ * rpma_log_async_start -- start the formatter thread
+ */
+int
+rpma_log_async_start(void)
+{
+	int ret = 0;
+
+	(void) pthread_mutex_lock(&Log_async.lock);
+
+	if (Log_async.running)
+		goto unlock;
+
+	if (!Log_async.atfork) {
+		errno = pthread_atfork(NULL, NULL, log_async_atfork_child);
+		if (errno) {
+			RPMA_LOG_ERROR_WITH_ERRNO(errno, "pthread_atfork()");
+			ret = RPMA_E_PROVIDER;
+			goto unlock;
+		}
+		Log_async.atfork = 1;
+	}
+
+	if (!Log_async.key_created) {
+		errno = pthread_key_create(&Log_async.key, log_ring_orphan);
+		if (errno) {
+			RPMA_LOG_ERROR_WITH_ERRNO(errno,
+				"pthread_key_create()");
+			ret = RPMA_E_PROVIDER;
+			goto unlock;
+		}
+		Log_async.key_created = 1;
+	}
+
+	Log_async.stop = 0;
+	errno = pthread_create(&Log_async.thread, NULL, log_async_thread,
+			NULL);
+	if (errno) {
+		RPMA_LOG_ERROR_WITH_ERRNO(errno, "pthread_create()");
+		ret = RPMA_E_PROVIDER;
+		goto unlock;
+	}
+
+	__atomic_store_n(&Log_async.running, 1, __ATOMIC_SEQ_CST);
+
+unlock:
+	(void) pthread_mutex_unlock(&Log_async.lock);
+
+	return ret;
+}
+
+/*
+ * rpma_log_async_fini -- stop the formatter thread, free all of the rings
+ * and delete the key of the thread-specific data
+ */
+void
+rpma_log_async_fini(void)
+{
+	(void) pthread_mutex_lock(&Log_async.lock);
+
+	if (!Log_async.running)
+		goto unlock;
+
+	/* the messages logged from now on are written directly */
+	__atomic_store_n(&Log_async.running, 0, __ATOMIC_SEQ_CST);
+
+	/* wait for the threads which have not noticed it yet */
+	while (__atomic_load_n(&Log_async.active, __ATOMIC_SEQ_CST))
+		(void) sched_yield();
+
+	/* the formatter thread drains all of the rings before it exits */
+	__atomic_store_n(&Log_async.stop, 1, __ATOMIC_RELEASE);
+	(void) pthread_join(Log_async.thread, NULL);
+
+	/* no thread can reach its ring when the key is deleted */
+	struct log_ring *ring;
+	while ((ring = Log_async.rings)) {
+		Log_async.rings = ring->next;
+		(void) rpma_mpsc_delete(&ring->records);
+		free(ring);
+	}
+
+	errno = pthread_key_delete(Log_async.key);
+	if (errno)
+		RPMA_LOG_ERROR_WITH_ERRNO(errno, "pthread_key_delete()");
+	Log_async.key_created = 0;
+
+	memset(Log_async.sites, 0, sizeof(Log_async.sites));
+
+unlock:
+	(void) pthread_mutex_unlock(&Log_async.lock);
+}
+
+/* public librpma API */
+
+/*
+ * rpma_log_async_function -- put the message into the ring of the calling
+ * thread to be written by the formatter thread
+ *
+ * ASSUMPTIONS:
+ * - level >= RPMA_LOG_LEVEL_FATAL && level <= RPMA_LOG_LEVEL_DEBUG
+ * - level <= Rpma_log_threshold[RPMA_LOG_THRESHOLD]
+ * - file == NULL || (file != NULL && function != NULL)
+ */
+void
+rpma_log_async_function(enum rpma_log_level level, const char *file_name,
+	const int line_no, const char *function_name,
+	const char *message_format, ...)
+{
+	struct log_record direct;
+	struct log_record *record = &direct;
+	struct log_ring *ring = NULL;
+	uint64_t pos = 0;
+
+	/*
+	 * the fatal messages are neither delayed nor dropped
+	 *
+	 * The reference is taken before checking if the formatter thread is
+	 * running so rpma_log_async_fini() either waits for it or the message
+	 * is written directly.
+	 */
+	if (level != RPMA_LOG_LEVEL_FATAL) {
+		__atomic_fetch_add(&Log_async.active, 1, __ATOMIC_SEQ_CST);
+		if (__atomic_load_n(&Log_async.running, __ATOMIC_SEQ_CST))
+			ring = log_ring_get();
+		if (ring == NULL)
+			__atomic_fetch_sub(&Log_async.active, 1,
+					__ATOMIC_RELEASE);
+	}
+
+	if (ring) {
+		record = rpma_mpsc_reserve(ring->records, &pos);
+		if (record == NULL) {
+			__atomic_fetch_add(&ring->dropped, 1,
+					__ATOMIC_RELAXED);
+			__atomic_fetch_sub(&Log_async.active, 1,
+					__ATOMIC_RELEASE);
+			return;
+		}
+	}
+
+	record->level = level;
+	record->file_name = file_name;
+	record->line_no = line_no;
+	record->function_name = function_name;
+
+	va_list arg;
+	va_start(arg, message_format);
+	if (vsnprintf(record->message, sizeof(record->message),
+			message_format, arg) < 0)
+		record->level = RPMA_LOG_DISABLED;
+	va_end(arg);
+
+	if (ring == NULL) {
+		if (record->level != RPMA_LOG_DISABLED)
+			rpma_log_default_write(level, file_name, line_no,
+				function_name, record->message, NULL /* now */);
+		return;
+	}
+
+	if (clock_gettime(CLOCK_REALTIME, &record->ts))
+		memset(&record->ts, 0, sizeof(record->ts));
+
+	rpma_mpsc_publish(ring->records, pos);
+	__atomic_fetch_sub(&Log_async.active, 1, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,49 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * log_async.h -- the asynchronous logging function definitions
+ */
+
+#ifndef LIBRPMA_LOG_ASYNC_H
+#define LIBRPMA_LOG_ASYNC_H
+
+#include "librpma.h"
+
+/* the number of records of a per-thread ring */
+#define RPMA_LOG_ASYNC_RING_SIZE	128
+
+/* the maximum length of a message (including the terminating '\0') */
+#define RPMA_LOG_ASYNC_MESSAGE_MAX	256
+
+/* the formatter thread sleeps for this long if there is nothing to log */
+#define RPMA_LOG_ASYNC_IDLE_NS		10000000 /* 10 ms */
+
+/* at most RATE_BURST messages per call site are logged every RATE_WINDOW */
+#define RPMA_LOG_ASYNC_RATE_BURST	10
+#define RPMA_LOG_ASYNC_RATE_WINDOW_S	1
+
+/*
+ * ERRORS
+ * rpma_log_async_start() can fail with the following errors:
+ *
+ * - RPMA_E_PROVIDER - pthread_key_create(3) or pthread_create(3) failed
+ *
+ * NOTE
+ * The formatter thread is started only once. The subsequent calls do nothing
+ * until rpma_log_async_fini() is called.
+ */
+int rpma_log_async_start(void);
+
+/*
+ * rpma_log_async_fini -- stop the formatter thread (if it is running), write
+ * all of the pending messages, free all of the rings and delete the key
+ * of the thread-specific data
+ *
+ * NOTE
+ * It waits for the threads logging at the moment. The threads still running
+ * get new rings after the next rpma_log_async_start().
+ */
+void rpma_log_async_fini(void);
+
+#endif /* LIBRPMA_LOG_ASYNC_H */
@@ -34,7 +34,8 @@ static const int rpma_log_level_syslog_severity[] = {
 };
 
 /*
- * get_timestamp_prefix -- provide actual time in a readable string
+ * get_timestamp_prefix -- provide the time (the actual one if ts == NULL)
+ * in a readable string
  *
  * NOTE
  * This function is static now, so we know all possible calls of snprintf()
@@ -44,22 +45,29 @@ static const int rpma_log_level_syslog_severity[] = {
  * - buf != NULL && buf_size >= 16
  */
 static void
-get_timestamp_prefix(char *buf, size_t buf_size)
+get_timestamp_prefix(char *buf, size_t buf_size, const struct timespec *ts)
 {
 	struct tm *info;
 	char date[24];
-	struct timespec ts;
+	struct timespec now;
 	long usec;
 
 	const char error_message[] = "[time error] ";
 
-	if (clock_gettime(CLOCK_REALTIME, &ts) ||
-	    (NULL == (info = localtime(&ts.tv_sec)))) {
+	if (ts == NULL) {
+		if (clock_gettime(CLOCK_REALTIME, &now)) {
+			memcpy(buf, error_message, sizeof(error_message));
+			return;
+		}
+		ts = &now;
+	}
+
+	if (NULL == (info = localtime(&ts->tv_sec))) {
 		memcpy(buf, error_message, sizeof(error_message));
 		return;
 	}
 
-	usec = ts.tv_nsec / 1000;
+	usec = ts->tv_nsec / 1000;
 	if (!strftime(date, sizeof(date), "%b %d %H:%M:%S", info)) {
 		memcpy(buf, error_message, sizeof(error_message));
 		return;
@@ -72,37 +80,27 @@ get_timestamp_prefix(char *buf, size_t buf_size)
 }
 
 /*
- * rpma_log_default_function -- default logging function used to log a message
- * to syslog and/or stderr
+ * rpma_log_default_write -- write the already formatted message to syslog
+ * and/or stderr
  *
- * The message is started with prefix composed from file, line, func parameters
- * followed by string pointed by format. If format includes format specifiers
- * (subsequences beginning with %), the additional arguments following format
- * are formatted and inserted in the message.
+ * The message is started with prefix composed from file, line, func
+ * parameters. The message written to stderr is stamped with the provided
+ * time or with the actual one if ts == NULL.
  *
  * ASSUMPTIONS:
  * - level >= RPMA_LOG_LEVEL_FATAL && level <= RPMA_LOG_LEVEL_DEBUG
- * - level <= Rpma_log_threshold[RPMA_LOG_THRESHOLD]
  * - file == NULL || (file != NULL && function != NULL)
+ * - message != NULL
  */
 void
-rpma_log_default_function(enum rpma_log_level level, const char *file_name,
-	const int line_no, const char *function_name,
-	const char *message_format, ...)
+rpma_log_default_write(enum rpma_log_level level, const char *file_name,
+	const int line_no, const char *function_name, const char *message,
+	const struct timespec *ts)
 {
 	char file_info_buffer[256] = "";
 	const char *file_info = file_info_buffer;
-	char message[1024] = "";
 	const char file_info_error[] = "[file info error]: ";
 
-	va_list arg;
-	va_start(arg, message_format);
-	if (vsnprintf(message, sizeof(message), message_format, arg) < 0) {
-		va_end(arg);
-		return;
-	}
-	va_end(arg);
-
 	if (file_name) {
 		/* extract base_file_name */
 		const char *base_file_name = strrchr(file_name, '/');
@@ -119,18 +117,51 @@ rpma_log_default_function(enum rpma_log_level level, const char *file_name,
 		}
 	}
 
-	/* assumed: level <= Rpma_log_threshold[RPMA_LOG_THRESHOLD] */
 	syslog(rpma_log_level_syslog_severity[level], "%s%s%s",
 		rpma_log_level_names[level], file_info, message);
 
 	if (level <= Rpma_log_threshold[RPMA_LOG_THRESHOLD_AUX]) {
 		char times_tamp[45] = "";
-		get_timestamp_prefix(times_tamp, sizeof(times_tamp));
+		get_timestamp_prefix(times_tamp, sizeof(times_tamp), ts);
 		(void) fprintf(stderr, "%s[%d] %s%s%s", times_tamp, getpid(),
 			rpma_log_level_names[level], file_info, message);
 	}
 }
 
+/*
+ * rpma_log_default_function -- default logging function used to log a message
+ * to syslog and/or stderr
+ *
+ * The message is started with prefix composed from file, line, func parameters
+ * followed by string pointed by format. If format includes format specifiers
+ * (subsequences beginning with %), the additional arguments following format
+ * are formatted and inserted in the message.
+ *
+ * ASSUMPTIONS:
+ * - level >= RPMA_LOG_LEVEL_FATAL && level <= RPMA_LOG_LEVEL_DEBUG
+ * - level <= Rpma_log_threshold[RPMA_LOG_THRESHOLD]
+ * - file == NULL || (file != NULL && function != NULL)
+ */
+void
+rpma_log_default_function(enum rpma_log_level level, const char *file_name,
+	const int line_no, const char *function_name,
+	const char *message_format, ...)
+{
+	char message[1024] = "";
+
+	va_list arg;
+	va_start(arg, message_format);
+	if (vsnprintf(message, sizeof(message), message_format, arg) < 0) {
+		va_end(arg);
+		return;
+	}
+	va_end(arg);
+
+	/* assumed: level <= Rpma_log_threshold[RPMA_LOG_THRESHOLD] */
+	rpma_log_default_write(level, file_name, line_no, function_name,
+		message, NULL /* now */);
+}
+
 /*
  * rpma_log_default_init -- open a connection to the system logger
  */
@@ -8,12 +8,25 @@
 #ifndef LIBRPMA_LOG_DEFAULT_H
 #define LIBRPMA_LOG_DEFAULT_H
 
+#include <time.h>
+
 #include "librpma.h"
 
 void rpma_log_default_function(enum rpma_log_level level, const char *file_name,
 	const int line_no, const char *function_name,
 	const char *message_format, ...);
 
+/*
+ * ASSUMPTIONS
+ * - level >= RPMA_LOG_LEVEL_FATAL && level <= RPMA_LOG_LEVEL_DEBUG
+ * - file_name == NULL || function_name != NULL
+ * - message != NULL
+ * - ts == NULL stands for the actual time
+ */
+void rpma_log_default_write(enum rpma_log_level level, const char *file_name,
+	const int line_no, const char *function_name, const char *message,
+	const struct timespec *ts);
+
 void rpma_log_default_init(void);
 
 void rpma_log_default_fini(void);
@@ -0,0 +1,245 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * mpsc.c -- librpma bounded multi-producer single-consumer ring
+ * implementation
+ *
+ * The implementation follows the well-known bounded queue design where
+ * each slot carries a sequence number telling in which lap and in which
+ * state the slot is. Producers compete only on the 'head' counter while
+ * the consumer owns the 'tail' counter exclusively.
+ */
+
+#include <stdlib.h>
+
+#include "librpma.h"
+#include "mpsc.h"
+
+#ifdef TEST_MOCK_ALLOC
+#include "cmocka_alloc.h"
+#endif
+
+/* the minimal size of the ring required by the slot state encoding */
+#define MPSC_SIZE_MIN	4
+
+#define CACHELINE_SIZE	64
+
+struct rpma_mpsc {
+	/* the next position to be reserved (shared by producers) */
+	uint64_t head;
+	char pad_head[CACHELINE_SIZE - sizeof(uint64_t)];
+
+	/* the next position to be consumed (owned by the consumer) */
+	uint64_t tail;
+	char pad_tail[CACHELINE_SIZE - sizeof(uint64_t)];
+
+	uint64_t size; /* number of slots (a power of 2) */
+	uint64_t mask; /* size - 1 */
+	size_t entry_size; /* size of a single entry */
+	uint64_t *seq; /* per-slot sequence numbers */
+	char *entries; /* the entries */
+};
+
+/*
+ * mpsc_slot -- get the slot's index of the position
+ */
+static inline uint64_t
+mpsc_slot(const struct rpma_mpsc *ring, uint64_t pos)
+{
+	return pos & ring->mask;
+}
+
+/* internal librpma API */
+
+/*
+ * rpma_mpsc_new -- allocate a new ring of at least 'size' entries (rounded up
+ * to the nearest power of 2) 'entry_size' bytes each
+ */
+int
+rpma_mpsc_new(uint32_t size, size_t entry_size, struct rpma_mpsc **ring_ptr)
+{
+	if (size == 0 || entry_size == 0 || ring_ptr == NULL)
+		return RPMA_E_INVAL;
+
+	uint64_t size_pow2 = MPSC_SIZE_MIN;
+	while (size_pow2 < size)
+		size_pow2 <<= 1;
+
+	struct rpma_mpsc *ring = malloc(sizeof(*ring));
+	if (ring == NULL)
+		return RPMA_E_NOMEM;
+
+	ring->seq = malloc(size_pow2 * sizeof(uint64_t));
+	if (ring->seq == NULL)
+		goto err_free_ring;
+
+	ring->entries = malloc(size_pow2 * entry_size);
+	if (ring->entries == NULL)
+		goto err_free_seq;
+
+	for (uint64_t i = 0; i < size_pow2; ++i)
+		ring->seq[i] = i;
+
+	ring->head = 0;
+	ring->tail = 0;
+	ring->size = size_pow2;
+	ring->mask = size_pow2 - 1;
+	ring->entry_size = entry_size;
+
+	*ring_ptr = ring;
+
+	return 0;
+
+err_free_seq:
+	free(ring->seq);
+
+err_free_ring:
+	free(ring);
+
+	return RPMA_E_NOMEM;
+}
+
+/*
+ * rpma_mpsc_delete -- free the ring
+ */
+int
+rpma_mpsc_delete(struct rpma_mpsc **ring_ptr)
+{
+	if (ring_ptr == NULL)
+		return RPMA_E_INVAL;
+
+	struct rpma_mpsc *ring = *ring_ptr;
+	if (ring == NULL)
+		return 0;
+
+	free(ring->entries);
+	free(ring->seq);
+	free(ring);
+	*ring_ptr = NULL;
+
+	return 0;
+}
+
+/*
+ * rpma_mpsc_get_size -- get the actual number of slots of the ring
+ */
+uint32_t
+rpma_mpsc_get_size(const struct rpma_mpsc *ring)
+{
+	return (uint32_t)ring->size;
+}
+
+/*
+ * rpma_mpsc_entry -- get the entry at the given position
+ */
+void *
+rpma_mpsc_entry(const struct rpma_mpsc *ring, uint64_t pos)
+{
+	return ring->entries + mpsc_slot(ring, pos) * ring->entry_size;
+}
+
+/*
+ * rpma_mpsc_reserve -- reserve the next free slot of the ring (lock-free)
+ */
+void *
+rpma_mpsc_reserve(struct rpma_mpsc *ring, uint64_t *pos)
+{
+	uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+
+	while (1) {
+		uint64_t seq = __atomic_load_n(
+				&ring->seq[mpsc_slot(ring, head)],
+				__ATOMIC_ACQUIRE);
+		int64_t diff = (int64_t)(seq - head);
+
+		if (diff == 0) {
+			/* the slot is free - try to take it */
+			if (__atomic_compare_exchange_n(&ring->head, &head,
+					head + 1, true /* weak */,
+					__ATOMIC_RELAXED, __ATOMIC_RELAXED))
+				break;
+			/* 'head' has been reloaded by the failed CAS */
+		} else if (diff < 0) {
+			/* the slot is still in use in the previous lap */
+			return NULL;
+		} else {
+			/* another producer has just taken the slot */
+			head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+		}
+	}
+
+	*pos = head;
+	return rpma_mpsc_entry(ring, head);
+}
+
+/*
+ * rpma_mpsc_publish -- make the reserved slot visible to the consumer
+ */
+void
+rpma_mpsc_publish(struct rpma_mpsc *ring, uint64_t pos)
+{
+	__atomic_store_n(&ring->seq[mpsc_slot(ring, pos)], pos + 1,
+			__ATOMIC_RELEASE);
+}
+
+/*
+ * rpma_mpsc_consume -- take the next published entry in the FIFO order
+ */
+void *
+rpma_mpsc_consume(struct rpma_mpsc *ring, uint64_t *pos)
+{
+	uint64_t tail = ring->tail;
+	uint64_t seq = __atomic_load_n(&ring->seq[mpsc_slot(ring, tail)],
+			__ATOMIC_ACQUIRE);
+
+	if (seq != tail + 1)
+		return NULL;
+
+	ring->tail = tail + 1;
+
+	*pos = tail;
+	return rpma_mpsc_entry(ring, tail);
+}
+
+/*
+ * rpma_mpsc_is_empty -- check if there is no published entry to consume
+ */
+bool
+rpma_mpsc_is_empty(const struct rpma_mpsc *ring)
+{
+	uint64_t tail = ring->tail;
+
+	return __atomic_load_n(&ring->seq[mpsc_slot(ring, tail)],
+			__ATOMIC_ACQUIRE) != tail + 1;
+}
+
+/*
+ * rpma_mpsc_complete -- hand the consumed slot back to its producer
+ */
+void
+rpma_mpsc_complete(struct rpma_mpsc *ring, uint64_t pos)
+{
+	__atomic_store_n(&ring->seq[mpsc_slot(ring, pos)], pos + 2,
+			__ATOMIC_RELEASE);
+}
+
+/*
+ * rpma_mpsc_is_completed -- check if the consumer has completed the slot
+ */
+bool
+rpma_mpsc_is_completed(const struct rpma_mpsc *ring, uint64_t pos)
+{
+	return __atomic_load_n(&ring->seq[mpsc_slot(ring, pos)],
+			__ATOMIC_ACQUIRE) == pos + 2;
+}
+
+/*
+ * rpma_mpsc_release -- make the slot available for the next lap
+ */
+void
+rpma_mpsc_release(struct rpma_mpsc *ring, uint64_t pos)
+{
+	__atomic_store_n(&ring->seq[mpsc_slot(ring, pos)], pos + ring->size,
+			__ATOMIC_RELEASE);
+}
@@ -0,0 +1,123 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * mpsc.h -- librpma bounded multi-producer single-consumer ring
+ * internal definitions
+ */
+
+#ifndef LIBRPMA_MPSC_H
+#define LIBRPMA_MPSC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * The ring is an array of fixed-size entries guarded by per-slot sequence
+ * numbers. A slot at position 'pos' goes through the following states:
+ *
+ * - free      - available for reservation by a producer
+ * - published - filled in by a producer and ready for the consumer
+ * - completed - (optional) processed by the consumer but still owned by
+ *               the producer which has to release it
+ *
+ * A slot returns to the free state when it is released either by
+ * the consumer (right after consuming it) or by the producer (after it has
+ * been completed by the consumer).
+ */
+struct rpma_mpsc;
+
+/*
+ * ERRORS
+ * rpma_mpsc_new() can fail with the following errors:
+ *
+ * - RPMA_E_INVAL - size == 0, entry_size == 0 or ring_ptr == NULL
+ * - RPMA_E_NOMEM - out of memory
+ */
+int rpma_mpsc_new(uint32_t size, size_t entry_size,
+		struct rpma_mpsc **ring_ptr);
+
+/*
+ * ERRORS
+ * rpma_mpsc_delete() cannot fail.
+ */
+int rpma_mpsc_delete(struct rpma_mpsc **ring_ptr);
+
+/*
+ * ASSUMPTIONS
+ * - ring != NULL
+ *
+ * ERRORS
+ * rpma_mpsc_get_size() cannot fail.
+ */
+uint32_t rpma_mpsc_get_size(const struct rpma_mpsc *ring);
+
+/*
+ * ASSUMPTIONS
+ * - ring != NULL && pos != NULL
+ *
+ * ERRORS
+ * rpma_mpsc_reserve() returns NULL if the ring is full.
+ */
+void *rpma_mpsc_reserve(struct rpma_mpsc *ring, uint64_t *pos);
+
+/*
+ * ASSUMPTIONS
+ * - ring != NULL
+ * - pos was returned by rpma_mpsc_reserve()
+ */
+void rpma_mpsc_publish(struct rpma_mpsc *ring, uint64_t pos);
+
+/*
+ * ASSUMPTIONS
+ * - ring != NULL && pos != NULL
+ * - it is called by a single consumer at a time
+ *
+ * ERRORS
+ * rpma_mpsc_consume() returns NULL if there is no published entry.
+ */
+void *rpma_mpsc_consume(struct rpma_mpsc *ring, uint64_t *pos);
+
+/*
+ * ASSUMPTIONS
+ * - ring != NULL
+ * - it is called by the consumer
+ *
+ * ERRORS
+ * rpma_mpsc_is_empty() cannot fail.
+ */
+bool rpma_mpsc_is_empty(const struct rpma_mpsc *ring);
+
+/*
+ * ASSUMPTIONS
+ * - ring != NULL
+ * - pos was returned by rpma_mpsc_consume()
+ */
+void rpma_mpsc_complete(struct rpma_mpsc *ring, uint64_t pos);
+
+/*
+ * ASSUMPTIONS
+ * - ring != NULL
+ * - pos was returned by rpma_mpsc_reserve() and the slot was published
+ */
+bool rpma_mpsc_is_completed(const struct rpma_mpsc *ring, uint64_t pos);
+
+/*
+ * ASSUMPTIONS
+ * - ring != NULL
+ * - pos was returned by rpma_mpsc_consume() (the consumer releases)
+ *   or the slot was completed (the producer releases)
+ */
+void rpma_mpsc_release(struct rpma_mpsc *ring, uint64_t pos);
+
+/*
+ * ASSUMPTIONS
+ * - ring != NULL
+ *
+ * ERRORS
+ * rpma_mpsc_entry() cannot fail.
+ */
+void *rpma_mpsc_entry(const struct rpma_mpsc *ring, uint64_t pos);
+
+#endif /* LIBRPMA_MPSC_H */
@@ -0,0 +1,440 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * mq.c -- librpma one-sided message queue
+ *
+ * Both sides of the queue register a slab of the same layout:
+ *
+ *	slot[0] ... slot[slots - 1] | padding | head
+ *
+ * The producer builds the messages in its own copy of the ring and writes
+ * the range of slots staged since the previous flush to the consumer's ring
+ * with a single RDMA write (or two if the range wraps around). The consumer
+ * detects a new message by polling the sequence number of the next slot
+ * stored both in front of and right after the payload, so a message whose
+ * header has already landed but whose payload is still being written
+ * is not taken. The consumer returns its progress by writing its head
+ * to the producer's head.
+ */
+
+#include <endian.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "librpma.h"
+#include "log_internal.h"
+#include "mr.h"
+
+#ifdef TEST_MOCK_ALLOC
+#include "cmocka_alloc.h"
+#endif
+
+#define MQ_HEAD_ALIGN		64
+
+#define MQ_ALIGN_UP(x, a)	(((x) + (a) - 1) & ~(size_t)((a) - 1))
+
+/* the header of a slot */
+struct mq_slot_hdr {
+	uint32_t seq; /* the sequence number of the message */
+	uint32_t len; /* length of the payload */
+};
+
+/* the sequence number stored after the payload */
+typedef uint32_t mq_slot_trailer;
+
+/* the queue parameters in front of the memory region descriptor */
+#define MQ_DESC_PARAMS_SIZE	(2 * sizeof(uint32_t))
+
+struct rpma_mq {
+	struct rpma_conn *conn;
+	enum rpma_mq_role role;
+
+	void *slab; /* the ring followed by the head */
+	size_t mmap_size; /* size of the mmap()'ed slab */
+	struct rpma_mr_local *mr; /* registration of the slab */
+	struct rpma_mr_remote *remote; /* the peer's slab */
+
+	uint32_t slots; /* number of slots */
+	size_t slot_size; /* size of a single slot */
+	size_t head_off; /* offset of the head */
+
+	/*
+	 * The consumer: the position of the next message to read.
+	 * The producer: not used (the head is written by the consumer).
+	 */
+	uint64_t head;
+
+	/*
+	 * The consumer: the head written to the producer most recently.
+	 * The producer: the position of the first slot not flushed yet.
+	 */
+	uint64_t published;
+
+	/* the producer: the position of the next slot to be staged */
+	uint64_t tail;
+	size_t last_len; /* the producer: length used of the last staged slot */
+
+	bool delivered; /* the consumer: a message is held by the application */
+};
+
+/*
+ * mq_seq -- the sequence number of the message at the given position
+ * (never 0 so the zeroed memory does not look like a message)
+ */
+static inline uint32_t
+mq_seq(uint64_t pos)
+{
+	return (uint32_t)(pos + 1);
+}
+
+/*
+ * mq_slot -- get the slot of the given position
+ */
+static inline char *
+mq_slot(const struct rpma_mq *mq, uint64_t pos)
+{
+	return (char *)mq->slab + (pos % mq->slots) * mq->slot_size;
+}
+
+/*
+ * mq_head -- get the head stored in the slab
+ */
+static inline uint64_t *
+mq_head(const struct rpma_mq *mq)
+{
+	return (uint64_t *)((char *)mq->slab + mq->head_off);
+}
+
+/*
+ * mq_msg_len_max -- the maximum length of a message
+ */
+static inline size_t
+mq_msg_len_max(const struct rpma_mq *mq)
+{
+	return mq->slot_size - sizeof(struct mq_slot_hdr) -
+			sizeof(mq_slot_trailer);
+}
+
+/*
+ * mq_trailer_off -- offset of the trailer of the message of the given length
+ */
+static inline size_t
+mq_trailer_off(size_t len)
+{
+	return sizeof(struct mq_slot_hdr) +
+			MQ_ALIGN_UP(len, sizeof(mq_slot_trailer));
+}
+
+/*
+ * mq_write -- write the slots [first, first + n) of the ring to the peer;
+ * the last of them only up to 'last_len' bytes
+ */
+static int
+mq_write(struct rpma_mq *mq, uint64_t first, uint64_t n, size_t last_len,
+		int flags, const void *op_context)
+{
+	size_t off = (first % mq->slots) * mq->slot_size;
+	size_t len = (n - 1) * mq->slot_size + last_len;
+
+	return rpma_write(mq->conn, mq->remote, off, mq->mr, off, len, flags,
+			op_context);
+}
+
+/* public librpma API */
+
+/*
+ * rpma_mq_new -- allocate and register the ring of the given role
+ */
+int
+rpma_mq_new(struct rpma_peer *peer, struct rpma_conn *conn,
+		enum rpma_mq_role role, uint32_t slots, size_t slot_size,
+		struct rpma_mq **mq_ptr)
+{
+	if (peer == NULL || conn == NULL || mq_ptr == NULL ||
+			(role != RPMA_MQ_PRODUCER &&
+				role != RPMA_MQ_CONSUMER) ||
+			slots == 0 || slot_size > UINT32_MAX ||
+			slot_size % sizeof(mq_slot_trailer) != 0 ||
+			slot_size <= sizeof(struct mq_slot_hdr) +
+				sizeof(mq_slot_trailer) ||
+			slot_size > (SIZE_MAX - MQ_HEAD_ALIGN) / slots)
+		return RPMA_E_INVAL;
+
+	size_t head_off = MQ_ALIGN_UP(slots * slot_size, MQ_HEAD_ALIGN);
+	size_t slab_size = head_off + sizeof(uint64_t);
+
+	/* the slab is zeroed so no slot looks like a message */
+	void *slab = NULL;
+	size_t mmap_size = 0;
+	struct rpma_mr_local *mr = NULL;
+	int ret = rpma_mr_slab_new(peer, slab_size,
+			RPMA_MR_USAGE_WRITE_SRC | RPMA_MR_USAGE_WRITE_DST,
+			&slab, &mmap_size, &mr);
+	if (ret)
+		return ret;
+
+	struct rpma_mq *mq = malloc(sizeof(*mq));
+	if (mq == NULL) {
+		ret = RPMA_E_NOMEM;
+		goto err_mr_dereg;
+	}
+
+	mq->conn = conn;
+	mq->role = role;
+	mq->slab = slab;
+	mq->mmap_size = mmap_size;
+	mq->mr = mr;
+	mq->remote = NULL;
+	mq->slots = slots;
+	mq->slot_size = slot_size;
+	mq->head_off = head_off;
+	mq->head = 0;
+	mq->published = 0;
+	mq->tail = 0;
+	mq->last_len = 0;
+	mq->delivered = false;
+
+	*mq_ptr = mq;
+
+	return 0;
+
+err_mr_dereg:
+	(void) rpma_mr_slab_delete(&mr, slab, mmap_size);
+
+	return ret;
+}
+
+/*
+ * rpma_mq_delete -- deregister and free the ring
+ */
+int
+rpma_mq_delete(struct rpma_mq **mq_ptr)
+{
+	if (mq_ptr == NULL)
+		return RPMA_E_INVAL;
+
+	struct rpma_mq *mq = *mq_ptr;
+	if (mq == NULL)
+		return 0;
+
+	int ret = 0;
+	if (mq->remote)
+		ret = rpma_mr_remote_delete(&mq->remote);
+
+	int ret2 = rpma_mr_slab_delete(&mq->mr, mq->slab, mq->mmap_size);
+	if (ret == 0)
+		ret = ret2;
+
+	free(mq);
+	*mq_ptr = NULL;
+
+	return ret;
+}
+
+/*
+ * rpma_mq_get_descriptor_size -- get the size of the queue descriptor
+ */
+int
+rpma_mq_get_descriptor_size(const struct rpma_mq *mq, size_t *desc_size)
+{
+	if (mq == NULL || desc_size == NULL)
+		return RPMA_E_INVAL;
+
+	size_t mr_desc_size;
+	int ret = rpma_mr_get_descriptor_size(mq->mr, &mr_desc_size);
+	if (ret)
+		return ret;
+
+	*desc_size = MQ_DESC_PARAMS_SIZE + mr_desc_size;
+
+	return 0;
+}
+
+/*
+ * rpma_mq_get_descriptor -- describe the slab and the layout of the ring
+ */
+int
+rpma_mq_get_descriptor(const struct rpma_mq *mq, void *desc)
+{
+	if (mq == NULL || desc == NULL)
+		return RPMA_E_INVAL;
+
+	char *buff = desc;
+
+	uint32_t slots = htole32(mq->slots);
+	memcpy(buff, &slots, sizeof(slots));
+	buff += sizeof(slots);
+
+	uint32_t slot_size = htole32((uint32_t)mq->slot_size);
+	memcpy(buff, &slot_size, sizeof(slot_size));
+	buff += sizeof(slot_size);
+
+	return rpma_mr_get_descriptor(mq->mr, buff);
+}
+
+/*
+ * rpma_mq_connect -- decode the peer's descriptor and check if the layouts
+ * of the rings match
+ */
+int
+rpma_mq_connect(struct rpma_mq *mq, const void *desc, size_t desc_size)
+{
+	if (mq == NULL || desc == NULL || mq->remote != NULL ||
+			desc_size <= MQ_DESC_PARAMS_SIZE)
+		return RPMA_E_INVAL;
+
+	const char *buff = desc;
+	uint32_t slots;
+	uint32_t slot_size;
+	memcpy(&slots, buff, sizeof(slots));
+	memcpy(&slot_size, buff + sizeof(slots), sizeof(slot_size));
+
+	if (le32toh(slots) != mq->slots ||
+			le32toh(slot_size) != mq->slot_size) {
+		RPMA_LOG_ERROR("the layouts of the rings do not match");
+		return RPMA_E_INVAL;
+	}
+
+	return rpma_mr_remote_from_descriptor(buff + MQ_DESC_PARAMS_SIZE,
+			desc_size - MQ_DESC_PARAMS_SIZE, &mq->remote);
+}
+
+/*
+ * rpma_mq_send -- build the message in the next free slot of the ring
+ */
+int
+rpma_mq_send(struct rpma_mq *mq, const void *data, size_t len)
+{
+	if (mq == NULL || mq->role != RPMA_MQ_PRODUCER ||
+			(data == NULL && len != 0) || len > mq_msg_len_max(mq))
+		return RPMA_E_INVAL;
+
+	/* the head is written by the consumer */
+	uint64_t head = __atomic_load_n(mq_head(mq), __ATOMIC_ACQUIRE);
+	if (mq->tail - head >= mq->slots)
+		return RPMA_E_AGAIN;
+
+	char *slot = mq_slot(mq, mq->tail);
+	uint32_t seq = mq_seq(mq->tail);
+
+	struct mq_slot_hdr *hdr = (struct mq_slot_hdr *)slot;
+	hdr->seq = seq;
+	hdr->len = (uint32_t)len;
+	if (len)
+		memcpy(hdr + 1, data, len);
+
+	size_t trailer_off = mq_trailer_off(len);
+	memcpy(slot + trailer_off, &seq, sizeof(seq));
+
+	mq->last_len = trailer_off + sizeof(seq);
+	mq->tail++;
+
+	return 0;
+}
+
+/*
+ * rpma_mq_flush -- write all the staged messages to the consumer's ring
+ */
+int
+rpma_mq_flush(struct rpma_mq *mq, int flags, const void *op_context)
+{
+	if (mq == NULL || mq->role != RPMA_MQ_PRODUCER || mq->remote == NULL ||
+			flags == 0)
+		return RPMA_E_INVAL;
+
+	uint64_t first = mq->published;
+	uint64_t n = mq->tail - first;
+	if (n == 0)
+		return 0;
+
+	/* the range wraps around the end of the ring */
+	uint64_t n_to_end = mq->slots - first % mq->slots;
+	if (n > n_to_end) {
+		int ret = mq_write(mq, first, n_to_end, mq->slot_size,
+				RPMA_F_COMPLETION_ON_ERROR, NULL);
+		if (ret)
+			return ret;
+
+		first += n_to_end;
+		n -= n_to_end;
+		mq->published = first;
+	}
+
+	int ret = mq_write(mq, first, n, mq->last_len, flags, op_context);
+	if (ret)
+		return ret;
+
+	mq->published = mq->tail;
+
+	return 0;
+}
+
+/*
+ * rpma_mq_next -- get a view of the next message if it has arrived
+ */
+int
+rpma_mq_next(struct rpma_mq *mq, const void **ptr, size_t *len)
+{
+	if (mq == NULL || mq->role != RPMA_MQ_CONSUMER || ptr == NULL ||
+			len == NULL)
+		return RPMA_E_INVAL;
+
+	/* the previous message is consumed */
+	if (mq->delivered) {
+		mq->head++;
+		mq->delivered = false;
+	}
+
+	char *slot = mq_slot(mq, mq->head);
+	uint32_t seq = mq_seq(mq->head);
+
+	/* the slot is written by the producer */
+	struct mq_slot_hdr *hdr = (struct mq_slot_hdr *)slot;
+	if (__atomic_load_n(&hdr->seq, __ATOMIC_ACQUIRE) != seq)
+		return RPMA_E_NO_COMPLETION;
+
+	size_t msg_len = __atomic_load_n(&hdr->len, __ATOMIC_RELAXED);
+	if (msg_len > mq_msg_len_max(mq))
+		return RPMA_E_NO_COMPLETION;
+
+	/* the payload is complete once the trailer has landed */
+	mq_slot_trailer *trailer =
+		(mq_slot_trailer *)(slot + mq_trailer_off(msg_len));
+	if (__atomic_load_n(trailer, __ATOMIC_ACQUIRE) != seq)
+		return RPMA_E_NO_COMPLETION;
+
+	*ptr = hdr + 1;
+	*len = msg_len;
+	mq->delivered = true;
+
+	return 0;
+}
+
+/*
+ * rpma_mq_publish -- write the consumer's head to the producer
+ */
+int
+rpma_mq_publish(struct rpma_mq *mq, int flags, const void *op_context)
+{
+	if (mq == NULL || mq->role != RPMA_MQ_CONSUMER || mq->remote == NULL ||
+			flags == 0)
+		return RPMA_E_INVAL;
+
+	/* nothing has been consumed since the previous call */
+	if (mq->head == mq->published)
+		return 0;
+
+	uint64_t *head = mq_head(mq);
+	__atomic_store_n(head, mq->head, __ATOMIC_RELEASE);
+
+	int ret = rpma_write(mq->conn, mq->remote, mq->head_off, mq->mr,
+			mq->head_off, sizeof(*head), flags, op_context);
+	if (ret)
+		return ret;
+
+	mq->published = mq->head;
+
+	return 0;
+}
@@ -11,9 +11,11 @@
 #include <stdlib.h>
 
 #include "librpma.h"
+#include "librpma_fast.h"
 #include "log_internal.h"
 #include "mr.h"
 #include "peer.h"
+#include "trace.h"
 
 #ifdef TEST_MOCK_ALLOC
 #include "cmocka_alloc.h"
@@ -26,25 +28,22 @@
 #define MAX_VALUE_OF(type)	((1 << SIZEOF_IN_BITS(type)) - 1)
 
 #define RPMA_MR_DESC_SIZE (2 * sizeof(uint64_t) + sizeof(uint32_t) \
-			+ sizeof(uint8_t))
+			+ sizeof(uint16_t))
 
 /* a bit-wise OR of all allowed values */
 #define USAGE_ALL_ALLOWED (RPMA_MR_USAGE_READ_SRC | RPMA_MR_USAGE_READ_DST |\
 		RPMA_MR_USAGE_WRITE_SRC | RPMA_MR_USAGE_WRITE_DST |\
 		RPMA_MR_USAGE_SEND | RPMA_MR_USAGE_RECV |\
 		RPMA_MR_USAGE_FLUSH_TYPE_VISIBILITY |\
-		RPMA_MR_USAGE_FLUSH_TYPE_PERSISTENT)
+		RPMA_MR_USAGE_FLUSH_TYPE_PERSISTENT |\
+		RPMA_MR_USAGE_ATOMIC)
 
 /*
  * Make sure the size of the usage field in the rpma_mr_get_descriptor()
- * and rpma_mr_remote_from_descriptor() functions ('uint8_t' as for now)
+ * and rpma_mr_remote_from_descriptor() functions ('uint16_t' as for now)
  * is big enough to store all possible 'RPMA_MR_USAGE_*' values.
  */
-STATIC_ASSERT(USAGE_ALL_ALLOWED <= MAX_VALUE_OF(uint8_t), usage_too_small);
-
-/* generate operation completion on success */
-#define RPMA_F_COMPLETION_ON_SUCCESS \
-	(RPMA_F_COMPLETION_ALWAYS & ~RPMA_F_COMPLETION_ON_ERROR)
+STATIC_ASSERT(USAGE_ALL_ALLOWED <= MAX_VALUE_OF(uint16_t), usage_too_small);
 
 struct rpma_mr_local {
 	struct ibv_mr *ibv_mr; /* an IBV memory registration object */
@@ -61,45 +60,61 @@ struct rpma_mr_remote {
 /* internal librpma API */
 
 /*
- * rpma_mr_read -- post an RDMA read from src to dst
+ * rpma_mr_read_wr -- prepare an RDMA read work request from src to dst
  */
-int
-rpma_mr_read(struct ibv_qp *qp,
+void
+rpma_mr_read_wr(struct ibv_send_wr *wr, struct ibv_sge *sge,
 	struct rpma_mr_local *dst, size_t dst_offset,
 	const struct rpma_mr_remote *src,  size_t src_offset,
 	size_t len, int flags, const void *op_context)
 {
-	struct ibv_send_wr wr;
-	struct ibv_sge sge;
-
 	if (src == NULL) {
 		/* source */
-		wr.wr.rdma.remote_addr = 0;
-		wr.wr.rdma.rkey = 0;
+		wr->wr.rdma.remote_addr = 0;
+		wr->wr.rdma.rkey = 0;
 
 		/* destination */
-		wr.sg_list = NULL;
-		wr.num_sge = 0;
+		wr->sg_list = NULL;
+		wr->num_sge = 0;
 	} else {
 		/* source */
-		wr.wr.rdma.remote_addr = src->raddr + src_offset;
-		wr.wr.rdma.rkey = src->rkey;
+		wr->wr.rdma.remote_addr = src->raddr + src_offset;
+		wr->wr.rdma.rkey = src->rkey;
 
 		/* destination */
-		sge.addr = (uint64_t)((uintptr_t)dst->ibv_mr->addr +
+		sge->addr = (uint64_t)((uintptr_t)dst->ibv_mr->addr +
 				dst_offset);
-		sge.length = (uint32_t)len;
-		sge.lkey = dst->ibv_mr->lkey;
+		sge->length = (uint32_t)len;
+		sge->lkey = dst->ibv_mr->lkey;
 
-		wr.sg_list = &sge;
-		wr.num_sge = 1;
+		wr->sg_list = sge;
+		wr->num_sge = 1;
 	}
 
-	wr.wr_id = (uint64_t)op_context;
-	wr.next = NULL;
-	wr.opcode = IBV_WR_RDMA_READ;
-	wr.send_flags = (flags & RPMA_F_COMPLETION_ON_SUCCESS) ?
+	wr->wr_id = (uint64_t)op_context;
+	wr->next = NULL;
+	wr->opcode = IBV_WR_RDMA_READ;
+	wr->send_flags = (flags & RPMA_F_COMPLETION_ON_SUCCESS) ?
 		IBV_SEND_SIGNALED : 0;
+}
+
+/*
+ * rpma_mr_read -- post an RDMA read from src to dst
+ */
+int
+rpma_mr_read(struct ibv_qp *qp,
+	struct rpma_mr_local *dst, size_t dst_offset,
+	const struct rpma_mr_remote *src,  size_t src_offset,
+	size_t len, int flags, const void *op_context)
+{
+	struct ibv_send_wr wr;
+	struct ibv_sge sge;
+
+	rpma_mr_read_wr(&wr, &sge, dst, dst_offset, src, src_offset,
+			len, flags, op_context);
+
+	RPMA_TRACE(post, qp, wr.wr_id, wr.opcode, len,
+			wr.wr.rdma.remote_addr, wr.send_flags);
 
 	struct ibv_send_wr *bad_wr;
 	int ret = ibv_post_send(qp, &wr, &bad_wr);
@@ -117,62 +132,84 @@ rpma_mr_read(struct ibv_qp *qp,
 }
 
 /*
- * rpma_mr_write -- post an RDMA write from src to dst
+ * rpma_mr_write_wr -- prepare an RDMA write work request from src to dst
  */
 int
-rpma_mr_write(struct ibv_qp *qp,
+rpma_mr_write_wr(struct ibv_send_wr *wr, struct ibv_sge *sge,
 	struct rpma_mr_remote *dst, size_t dst_offset,
 	const struct rpma_mr_local *src, size_t src_offset,
 	size_t len, int flags, enum ibv_wr_opcode operation,
 	uint32_t imm, const void *op_context, bool fence)
 {
-	struct ibv_send_wr wr;
-	struct ibv_sge sge;
-
 	if (src == NULL) {
 		/* source */
-		wr.sg_list = NULL;
-		wr.num_sge = 0;
+		wr->sg_list = NULL;
+		wr->num_sge = 0;
 
 		/* destination */
-		wr.wr.rdma.remote_addr = 0;
-		wr.wr.rdma.rkey = 0;
+		wr->wr.rdma.remote_addr = 0;
+		wr->wr.rdma.rkey = 0;
 	} else {
 		/* source */
-		sge.addr = (uint64_t)((uintptr_t)src->ibv_mr->addr +
+		sge->addr = (uint64_t)((uintptr_t)src->ibv_mr->addr +
 				src_offset);
-		sge.length = (uint32_t)len;
-		sge.lkey = src->ibv_mr->lkey;
+		sge->length = (uint32_t)len;
+		sge->lkey = src->ibv_mr->lkey;
 
-		wr.sg_list = &sge;
-		wr.num_sge = 1;
+		wr->sg_list = sge;
+		wr->num_sge = 1;
 
 		/* destination */
-		wr.wr.rdma.remote_addr = dst->raddr + dst_offset;
-		wr.wr.rdma.rkey = dst->rkey;
+		wr->wr.rdma.remote_addr = dst->raddr + dst_offset;
+		wr->wr.rdma.rkey = dst->rkey;
 	}
 
-	wr.wr_id = (uint64_t)op_context;
-	wr.next = NULL;
+	wr->wr_id = (uint64_t)op_context;
+	wr->next = NULL;
 
-	wr.opcode = operation;
-	switch (wr.opcode) {
+	wr->opcode = operation;
+	switch (wr->opcode) {
 	case IBV_WR_RDMA_WRITE:
 		break;
 	case IBV_WR_RDMA_WRITE_WITH_IMM:
-		wr.imm_data = htonl(imm);
+		wr->imm_data = htonl(imm);
 		break;
 	default:
-		RPMA_LOG_ERROR("unsupported wr.opcode == %d", wr.opcode);
+		RPMA_LOG_ERROR("unsupported wr.opcode == %d", wr->opcode);
 		return RPMA_E_NOSUPP;
 	}
 
-	wr.send_flags = (flags & RPMA_F_COMPLETION_ON_SUCCESS) ?
+	wr->send_flags = (flags & RPMA_F_COMPLETION_ON_SUCCESS) ?
 		IBV_SEND_SIGNALED : 0;
-	wr.send_flags |= fence ? IBV_SEND_FENCE : 0;
+	wr->send_flags |= fence ? IBV_SEND_FENCE : 0;
+
+	return 0;
+}
+
+/*
+ * rpma_mr_write -- post an RDMA write from src to dst
+ */
+int
+rpma_mr_write(struct ibv_qp *qp,
+	struct rpma_mr_remote *dst, size_t dst_offset,
+	const struct rpma_mr_local *src, size_t src_offset,
+	size_t len, int flags, enum ibv_wr_opcode operation,
+	uint32_t imm, const void *op_context, bool fence)
+{
+	struct ibv_send_wr wr;
+	struct ibv_sge sge;
+
+	int ret = rpma_mr_write_wr(&wr, &sge, dst, dst_offset,
+			src, src_offset, len, flags, operation, imm,
+			op_context, fence);
+	if (ret)
+		return ret;
+
+	RPMA_TRACE(post, qp, wr.wr_id, wr.opcode, len,
+			wr.wr.rdma.remote_addr, wr.send_flags);
 
 	struct ibv_send_wr *bad_wr;
-	int ret = ibv_post_send(qp, &wr, &bad_wr);
+	ret = ibv_post_send(qp, &wr, &bad_wr);
 	if (ret) {
 		RPMA_LOG_ERROR_WITH_ERRNO(ret,
 			"ibv_post_send(dst_addr=0x%x, rkey=0x%x, src_addr=0x%x, length=%u, lkey=0x%x, wr_id=0x%x, opcode=IBV_WR_RDMA_WRITE, send_flags=%s)",
@@ -186,6 +223,134 @@ rpma_mr_write(struct ibv_qp *qp,
 	return 0;
 }
 
+/*
+ * rpma_mr_atomic_wr -- prepare an RDMA atomic work request on src fetching
+ * the original value to dst
+ */
+int
+rpma_mr_atomic_wr(struct ibv_send_wr *wr, struct ibv_sge *sge,
+	struct rpma_mr_local *dst, size_t dst_offset,
+	const struct rpma_mr_remote *src, size_t src_offset,
+	enum ibv_wr_opcode operation, uint64_t compare_add, uint64_t swap,
+	int flags, const void *op_context)
+{
+	wr->opcode = operation;
+	switch (wr->opcode) {
+	case IBV_WR_ATOMIC_CMP_AND_SWP:
+		wr->wr.atomic.swap = swap;
+		break;
+	case IBV_WR_ATOMIC_FETCH_AND_ADD:
+		wr->wr.atomic.swap = 0;
+		break;
+	default:
+		RPMA_LOG_ERROR("unsupported wr.opcode == %d", wr->opcode);
+		return RPMA_E_NOSUPP;
+	}
+
+	/* source */
+	wr->wr.atomic.remote_addr = src->raddr + src_offset;
+	wr->wr.atomic.rkey = src->rkey;
+	wr->wr.atomic.compare_add = compare_add;
+
+	/* destination */
+	sge->addr = (uint64_t)((uintptr_t)dst->ibv_mr->addr + dst_offset);
+	sge->length = RPMA_ATOMIC_ALIGNMENT;
+	sge->lkey = dst->ibv_mr->lkey;
+
+	wr->sg_list = sge;
+	wr->num_sge = 1;
+
+	wr->wr_id = (uint64_t)op_context;
+	wr->next = NULL;
+	wr->send_flags = (flags & RPMA_F_COMPLETION_ON_SUCCESS) ?
+		IBV_SEND_SIGNALED : 0;
+
+	return 0;
+}
+
+/*
+ * rpma_mr_atomic -- post an RDMA atomic operation on src fetching
+ * the original value to dst
+ */
+int
+rpma_mr_atomic(struct ibv_qp *qp,
+	struct rpma_mr_local *dst, size_t dst_offset,
+	const struct rpma_mr_remote *src, size_t src_offset,
+	enum ibv_wr_opcode operation, uint64_t compare_add, uint64_t swap,
+	int flags, const void *op_context)
+{
+	struct ibv_send_wr wr;
+	struct ibv_sge sge;
+
+	int ret = rpma_mr_atomic_wr(&wr, &sge, dst, dst_offset,
+			src, src_offset, operation, compare_add, swap,
+			flags, op_context);
+	if (ret)
+		return ret;
+
+	RPMA_TRACE(post, qp, wr.wr_id, wr.opcode, sizeof(uint64_t),
+			wr.wr.atomic.remote_addr, wr.send_flags);
+
+	struct ibv_send_wr *bad_wr;
+	ret = ibv_post_send(qp, &wr, &bad_wr);
+	if (ret) {
+		RPMA_LOG_ERROR_WITH_ERRNO(ret,
+			"ibv_post_send(src_addr=0x%x, rkey=0x%x, dst_addr=0x%x, lkey=0x%x, wr_id=0x%x, opcode=%s, send_flags=%s)",
+			wr.wr.atomic.remote_addr, wr.wr.atomic.rkey,
+			sge.addr, sge.lkey, wr.wr_id,
+			(operation == IBV_WR_ATOMIC_CMP_AND_SWP) ?
+				"IBV_WR_ATOMIC_CMP_AND_SWP" :
+				"IBV_WR_ATOMIC_FETCH_AND_ADD",
+			(flags & RPMA_F_COMPLETION_ON_SUCCESS) ?
+				"IBV_SEND_SIGNALED" : "0");
+		return RPMA_E_PROVIDER;
+	}
+
+	return 0;
+}
+
+/*
+ * rpma_mr_send_wr -- prepare an RDMA send work request from src
+ */
+int
+rpma_mr_send_wr(struct ibv_send_wr *wr, struct ibv_sge *sge,
+	const struct rpma_mr_local *src,  size_t offset,
+	size_t len, int flags, enum ibv_wr_opcode operation,
+	uint32_t imm, const void *op_context)
+{
+	/* source */
+	if (src == NULL) {
+		wr->sg_list = NULL;
+		wr->num_sge = 0;
+	} else {
+		sge->addr = (uint64_t)((uintptr_t)src->ibv_mr->addr + offset);
+		sge->length = (uint32_t)len;
+		sge->lkey = src->ibv_mr->lkey;
+
+		wr->sg_list = sge;
+		wr->num_sge = 1;
+	}
+
+	wr->next = NULL;
+	wr->opcode = operation;
+	switch (wr->opcode) {
+	case IBV_WR_SEND:
+		break;
+	case IBV_WR_SEND_WITH_IMM:
+		wr->imm_data = htonl(imm);
+		break;
+	default:
+		RPMA_LOG_ERROR("unsupported wr.opcode == %d", wr->opcode);
+		return RPMA_E_NOSUPP;
+	}
+
+	wr->wr_id = (uint64_t)op_context;
+	wr->send_flags = (flags & RPMA_F_COMPLETION_ON_SUCCESS) ?
+		IBV_SEND_SIGNALED : 0;
+
+	return 0;
+}
+
 /*
  * rpma_mr_send -- post an RDMA send from src
  */
@@ -198,46 +363,108 @@ rpma_mr_send(struct ibv_qp *qp,
 	struct ibv_send_wr wr;
 	struct ibv_sge sge;
 
-	/* source */
-	if (src == NULL) {
-		wr.sg_list = NULL;
-		wr.num_sge = 0;
-	} else {
-		sge.addr = (uint64_t)((uintptr_t)src->ibv_mr->addr + offset);
-		sge.length = (uint32_t)len;
-		sge.lkey = src->ibv_mr->lkey;
+	int ret = rpma_mr_send_wr(&wr, &sge, src, offset, len, flags,
+			operation, imm, op_context);
+	if (ret)
+		return ret;
+
+	RPMA_TRACE(post, qp, wr.wr_id, wr.opcode, len, 0, wr.send_flags);
 
-		wr.sg_list = &sge;
-		wr.num_sge = 1;
+	struct ibv_send_wr *bad_wr;
+	ret = ibv_post_send(qp, &wr, &bad_wr);
+	if (ret) {
+		RPMA_LOG_ERROR_WITH_ERRNO(ret, "ibv_post_send");
+		return RPMA_E_PROVIDER;
 	}
 
-	wr.next = NULL;
+	return 0;
+}
+
+/*
+ * rpma_mr_inline -- post an RDMA write to dst or an RDMA send carrying
+ * the data copied from src into the work request
+ */
+int
+rpma_mr_inline(struct ibv_qp *qp,
+	struct rpma_mr_remote *dst, size_t dst_offset,
+	const void *src, size_t len, int flags,
+	enum ibv_wr_opcode operation, const void *op_context)
+{
+	struct ibv_send_wr wr;
+	struct ibv_sge sge;
+
 	wr.opcode = operation;
 	switch (wr.opcode) {
-	case IBV_WR_SEND:
+	case IBV_WR_RDMA_WRITE:
+		wr.wr.rdma.remote_addr = dst->raddr + dst_offset;
+		wr.wr.rdma.rkey = dst->rkey;
 		break;
-	case IBV_WR_SEND_WITH_IMM:
-		wr.imm_data = htonl(imm);
+	case IBV_WR_SEND:
 		break;
 	default:
 		RPMA_LOG_ERROR("unsupported wr.opcode == %d", wr.opcode);
 		return RPMA_E_NOSUPP;
 	}
 
+	/* the inline data does not need any local key */
+	sge.addr = (uint64_t)(uintptr_t)src;
+	sge.length = (uint32_t)len;
+	sge.lkey = 0;
+
+	wr.sg_list = &sge;
+	wr.num_sge = 1;
 	wr.wr_id = (uint64_t)op_context;
-	wr.send_flags = (flags & RPMA_F_COMPLETION_ON_SUCCESS) ?
+	wr.next = NULL;
+	wr.send_flags = IBV_SEND_INLINE;
+	wr.send_flags |= (flags & RPMA_F_COMPLETION_ON_SUCCESS) ?
 		IBV_SEND_SIGNALED : 0;
 
+	RPMA_TRACE(post, qp, wr.wr_id, wr.opcode, len,
+			(wr.opcode == IBV_WR_RDMA_WRITE) ?
+				wr.wr.rdma.remote_addr : 0,
+			wr.send_flags);
+
 	struct ibv_send_wr *bad_wr;
 	int ret = ibv_post_send(qp, &wr, &bad_wr);
 	if (ret) {
-		RPMA_LOG_ERROR_WITH_ERRNO(ret, "ibv_post_send");
+		RPMA_LOG_ERROR_WITH_ERRNO(ret,
+			"ibv_post_send(src_addr=0x%x, length=%u, wr_id=0x%x, opcode=%s, send_flags=IBV_SEND_INLINE%s)",
+			sge.addr, sge.length, wr.wr_id,
+			(operation == IBV_WR_RDMA_WRITE) ?
+				"IBV_WR_RDMA_WRITE" : "IBV_WR_SEND",
+			(flags & RPMA_F_COMPLETION_ON_SUCCESS) ?
+				"|IBV_SEND_SIGNALED" : "");
 		return RPMA_E_PROVIDER;
 	}
 
 	return 0;
 }
 
+/*
+ * rpma_mr_recv_wr -- prepare an RDMA recv work request (dst)
+ */
+void
+rpma_mr_recv_wr(struct ibv_recv_wr *wr, struct ibv_sge *sge,
+	struct rpma_mr_local *dst,  size_t offset,
+	size_t len, const void *op_context)
+{
+	/* source */
+	if (dst == NULL) {
+		wr->sg_list = NULL;
+		wr->num_sge = 0;
+	} else {
+		sge->addr = (uint64_t)((uintptr_t)dst->ibv_mr->addr + offset);
+		sge->length = (uint32_t)len;
+		sge->lkey = dst->ibv_mr->lkey;
+
+		wr->sg_list = sge;
+		wr->num_sge = 1;
+	}
+
+	wr->next = NULL;
+	wr->wr_id = (uint64_t)op_context;
+}
+
 /*
  * rpma_mr_recv -- post an RDMA recv from dst
  */
@@ -249,21 +476,9 @@ rpma_mr_recv(struct ibv_qp *qp,
 	struct ibv_recv_wr wr;
 	struct ibv_sge sge;
 
-	/* source */
-	if (dst == NULL) {
-		wr.sg_list = NULL;
-		wr.num_sge = 0;
-	} else {
-		sge.addr = (uint64_t)((uintptr_t)dst->ibv_mr->addr + offset);
-		sge.length = (uint32_t)len;
-		sge.lkey = dst->ibv_mr->lkey;
-
-		wr.sg_list = &sge;
-		wr.num_sge = 1;
-	}
+	rpma_mr_recv_wr(&wr, &sge, dst, offset, len, op_context);
 
-	wr.next = NULL;
-	wr.wr_id = (uint64_t)op_context;
+	RPMA_TRACE(recv, qp, wr.wr_id, len);
 
 	struct ibv_recv_wr *bad_wr;
 	int ret = ibv_post_recv(qp, &wr, &bad_wr);
@@ -275,6 +490,31 @@ rpma_mr_recv(struct ibv_qp *qp,
 	return 0;
 }
 
+/*
+ * rpma_mr_srq_recv -- post an RDMA recv from dst to the shared receive queue
+ */
+int
+rpma_mr_srq_recv(struct ibv_srq *srq,
+	struct rpma_mr_local *dst,  size_t offset,
+	size_t len, const void *op_context)
+{
+	struct ibv_recv_wr wr;
+	struct ibv_sge sge;
+
+	rpma_mr_recv_wr(&wr, &sge, dst, offset, len, op_context);
+
+	RPMA_TRACE(srq_recv, srq, wr.wr_id, len);
+
+	struct ibv_recv_wr *bad_wr;
+	int ret = ibv_post_srq_recv(srq, &wr, &bad_wr);
+	if (ret) {
+		RPMA_LOG_ERROR_WITH_ERRNO(ret, "ibv_post_srq_recv");
+		return RPMA_E_PROVIDER;
+	}
+
+	return 0;
+}
+
 /* public librpma API */
 
 /*
@@ -359,7 +599,8 @@ rpma_mr_get_descriptor(const struct rpma_mr_local *mr, void *desc)
 	memcpy(buff, &rkey, sizeof(uint32_t));
 	buff += sizeof(uint32_t);
 
-	*((uint8_t *)buff) = (uint8_t)mr->usage;
+	uint16_t usage = htole16((uint16_t)mr->usage);
+	memcpy(buff, &usage, sizeof(uint16_t));
 
 	return 0;
 }
@@ -397,7 +638,9 @@ rpma_mr_remote_from_descriptor(const void *desc,
 	memcpy(&rkey, buff, sizeof(uint32_t));
 	buff += sizeof(uint32_t);
 
-	uint8_t usage = *(uint8_t *)buff;
+	uint16_t usage;
+	memcpy(&usage, buff, sizeof(uint16_t));
+	usage = le16toh(usage);
 
 	if (usage == 0) {
 		RPMA_LOG_ERROR("usage type of memory is not set");
@@ -415,7 +658,7 @@ rpma_mr_remote_from_descriptor(const void *desc,
 	*mr_ptr = mr;
 
 	RPMA_LOG_INFO("new rpma_mr_remote(raddr=0x%" PRIx64 ", size=%" PRIu64
-			", rkey=0x%" PRIx32 ", usage=0x%" PRIx8 ")",
+			", rkey=0x%" PRIx32 ", usage=0x%" PRIx16 ")",
 			raddr, size, rkey, usage);
 
 	return 0;
@@ -477,6 +720,62 @@ rpma_mr_remote_get_size(const struct rpma_mr_remote *mr, size_t *size)
 	return 0;
 }
 
+/*
+ * rpma_mr_get_fast -- get the fast handle of the local memory region
+ */
+int
+rpma_mr_get_fast(const struct rpma_mr_local *mr, struct rpma_fast_mr *fmr)
+{
+	if (mr == NULL || fmr == NULL)
+		return RPMA_E_INVAL;
+
+	fmr->addr = (uint64_t)((uintptr_t)mr->ibv_mr->addr);
+	fmr->size = mr->ibv_mr->length;
+	fmr->key = mr->ibv_mr->lkey;
+	fmr->reserved = 0;
+
+	return 0;
+}
+
+/*
+ * rpma_mr_remote_get_fast -- get the fast handle of the remote memory region
+ */
+int
+rpma_mr_remote_get_fast(const struct rpma_mr_remote *mr,
+		struct rpma_fast_mr *fmr)
+{
+	if (mr == NULL || fmr == NULL)
+		return RPMA_E_INVAL;
+
+	fmr->addr = mr->raddr;
+	fmr->size = mr->size;
+	fmr->key = mr->rkey;
+	fmr->reserved = 0;
+
+	return 0;
+}
+
+/*
+ * rpma_fast_post_failed -- log the failed post of the fast path
+ */
+int
+rpma_fast_post_failed(const struct ibv_send_wr *wr, int err)
+{
+	RPMA_LOG_ERROR_WITH_ERRNO(err,
+		"ibv_post_send(remote_addr=0x%" PRIx64 ", rkey=0x%x, "
+		"local_addr=0x%" PRIx64 ", length=%u, lkey=0x%x, "
+		"wr_id=0x%" PRIx64 ", opcode=%s, send_flags=%s)",
+		wr->wr.rdma.remote_addr, wr->wr.rdma.rkey,
+		wr->sg_list->addr, wr->sg_list->length, wr->sg_list->lkey,
+		wr->wr_id,
+		wr->opcode == IBV_WR_RDMA_READ ?
+			"IBV_WR_RDMA_READ" : "IBV_WR_RDMA_WRITE",
+		(wr->send_flags & IBV_SEND_SIGNALED) ?
+			"IBV_SEND_SIGNALED" : "0");
+
+	return RPMA_E_PROVIDER;
+}
+
 /*
  * rpma_mr_remote_delete -- delete a remote memory region's structure
  */
@@ -12,6 +12,70 @@
 
 #include <infiniband/verbs.h>
 
+/* generate operation completion on success */
+#define RPMA_F_COMPLETION_ON_SUCCESS \
+	(RPMA_F_COMPLETION_ALWAYS & ~RPMA_F_COMPLETION_ON_ERROR)
+
+/*
+ * ASSUMPTIONS
+ * - wr != NULL && sge != NULL && flags != 0
+ * - (src != NULL && dst != NULL) ||
+ *   (src == NULL && dst == NULL &&
+ *    dst_offset == 0 && src_offset == 0 && len == 0)
+ *
+ * ERRORS
+ * rpma_mr_read_wr() cannot fail.
+ */
+void rpma_mr_read_wr(struct ibv_send_wr *wr, struct ibv_sge *sge,
+	struct rpma_mr_local *dst, size_t dst_offset,
+	const struct rpma_mr_remote *src,  size_t src_offset,
+	size_t len, int flags, const void *op_context);
+
+/*
+ * ASSUMPTIONS
+ * - wr != NULL && sge != NULL && flags != 0
+ * - (src != NULL && dst != NULL) ||
+ *   (src == NULL && dst == NULL &&
+ *    dst_offset == 0 && src_offset == 0 && len == 0)
+ *
+ * ERRORS
+ * rpma_mr_write_wr() can fail with the following error:
+ *
+ * - RPMA_E_NOSUPP - unsupported 'operation' argument
+ */
+int rpma_mr_write_wr(struct ibv_send_wr *wr, struct ibv_sge *sge,
+	struct rpma_mr_remote *dst, size_t dst_offset,
+	const struct rpma_mr_local *src,  size_t src_offset,
+	size_t len, int flags, enum ibv_wr_opcode operation,
+	uint32_t imm, const void *op_context, bool fence);
+
+/*
+ * ASSUMPTIONS
+ * - wr != NULL && sge != NULL && flags != 0
+ * - src != NULL || (offset == 0 && len == 0)
+ *
+ * ERRORS
+ * rpma_mr_send_wr() can fail with the following error:
+ *
+ * - RPMA_E_NOSUPP - unsupported 'operation' argument
+ */
+int rpma_mr_send_wr(struct ibv_send_wr *wr, struct ibv_sge *sge,
+	const struct rpma_mr_local *src,  size_t offset,
+	size_t len, int flags, enum ibv_wr_opcode operation,
+	uint32_t imm, const void *op_context);
+
+/*
+ * ASSUMPTIONS
+ * - wr != NULL && sge != NULL
+ * - dst != NULL || (offset == 0 && len == 0)
+ *
+ * ERRORS
+ * rpma_mr_recv_wr() cannot fail.
+ */
+void rpma_mr_recv_wr(struct ibv_recv_wr *wr, struct ibv_sge *sge,
+	struct rpma_mr_local *dst,  size_t offset,
+	size_t len, const void *op_context);
+
 /*
  * ASSUMPTIONS
  * - qp != NULL && flags != 0
@@ -48,6 +112,38 @@ int rpma_mr_write(struct ibv_qp *qp,
 	size_t len, int flags, enum ibv_wr_opcode operation,
 	uint32_t imm, const void *op_context, bool fence);
 
+/*
+ * ASSUMPTIONS
+ * - wr != NULL && sge != NULL && dst != NULL && src != NULL
+ *
+ * ERRORS
+ * rpma_mr_atomic_wr() can fail with the following error:
+ *
+ * - RPMA_E_NOSUPP - unsupported 'operation' argument
+ */
+int rpma_mr_atomic_wr(struct ibv_send_wr *wr, struct ibv_sge *sge,
+	struct rpma_mr_local *dst, size_t dst_offset,
+	const struct rpma_mr_remote *src, size_t src_offset,
+	enum ibv_wr_opcode operation, uint64_t compare_add, uint64_t swap,
+	int flags, const void *op_context);
+
+/*
+ * ASSUMPTIONS
+ * - qp != NULL && flags != 0
+ * - dst != NULL && src != NULL
+ *
+ * ERRORS
+ * rpma_mr_atomic() can fail with the following errors:
+ *
+ * - RPMA_E_NOSUPP   - unsupported 'operation' argument
+ * - RPMA_E_PROVIDER - ibv_post_send(3) failed
+ */
+int rpma_mr_atomic(struct ibv_qp *qp,
+	struct rpma_mr_local *dst, size_t dst_offset,
+	const struct rpma_mr_remote *src, size_t src_offset,
+	enum ibv_wr_opcode operation, uint64_t compare_add, uint64_t swap,
+	int flags, const void *op_context);
+
 /*
  * ASSUMPTIONS
  * - qp != NULL && flags != 0
@@ -64,6 +160,23 @@ int rpma_mr_send(struct ibv_qp *qp,
 	size_t len, int flags, enum ibv_wr_opcode operation,
 	uint32_t imm, const void *op_context);
 
+/*
+ * ASSUMPTIONS
+ * - qp != NULL && flags != 0 && src != NULL
+ * - dst != NULL if operation == IBV_WR_RDMA_WRITE
+ * - len does not exceed the maximum inline data size of the QP
+ *
+ * ERRORS
+ * rpma_mr_inline() can fail with the following error:
+ *
+ * - RPMA_E_NOSUPP   - unsupported 'operation' argument
+ * - RPMA_E_PROVIDER - ibv_post_send(3) failed
+ */
+int rpma_mr_inline(struct ibv_qp *qp,
+	struct rpma_mr_remote *dst, size_t dst_offset,
+	const void *src, size_t len, int flags,
+	enum ibv_wr_opcode operation, const void *op_context);
+
 /*
  * ASSUMPTIONS
  * - qp != NULL
@@ -78,4 +191,56 @@ int rpma_mr_recv(struct ibv_qp *qp,
 	struct rpma_mr_local *dst,  size_t offset,
 	size_t len, const void *op_context);
 
+/*
+ * ASSUMPTIONS
+ * - srq != NULL
+ * - dst != NULL || (offset == 0 && len == 0)
+ *
+ * ERRORS
+ * rpma_mr_srq_recv() can fail with the following error:
+ *
+ * - RPMA_E_PROVIDER - ibv_post_srq_recv(3) failed
+ */
+int rpma_mr_srq_recv(struct ibv_srq *srq,
+	struct rpma_mr_local *dst,  size_t offset,
+	size_t len, const void *op_context);
+
+/*
+ * ASSUMPTIONS
+ * - peer != NULL && size != 0
+ * - addr_ptr != NULL && mmap_size_ptr != NULL && mr_ptr != NULL
+ *
+ * ERRORS
+ * rpma_mr_slab_new() can fail with the following errors:
+ *
+ * - RPMA_E_NOMEM    - out of memory (mmap(2) failed)
+ * - RPMA_E_PROVIDER - sysconf(3) failed
+ * - RPMA_E_PROVIDER - registering the memory failed (see rpma_mr_reg(3))
+ *
+ * NOTE
+ * The memory is mmap()'ed so it is page-aligned and zeroed. It takes
+ * *mmap_size_ptr bytes (size rounded up to the page size) of which only
+ * the size bytes are registered.
+ */
+int rpma_mr_slab_new(struct rpma_peer *peer, size_t size, int usage,
+	void **addr_ptr, size_t *mmap_size_ptr,
+	struct rpma_mr_local **mr_ptr);
+
+/*
+ * ASSUMPTIONS
+ * - mr_ptr != NULL
+ * - addr and mmap_size come from rpma_mr_slab_new()
+ *
+ * ERRORS
+ * rpma_mr_slab_delete() can fail with the following errors:
+ *
+ * - RPMA_E_PROVIDER - deregistering the memory failed
+ *   (see rpma_mr_dereg(3)) or munmap(2) failed
+ *
+ * NOTE
+ * The memory is released even if deregistering it fails.
+ */
+int rpma_mr_slab_delete(struct rpma_mr_local **mr_ptr, void *addr,
+	size_t mmap_size);
+
 #endif /* LIBRPMA_MR_H */
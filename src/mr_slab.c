@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * mr_slab.c -- librpma registered slab implementation
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "log_internal.h"
+#include "mr.h"
+
+/*
+ * rpma_mr_slab_new -- allocate the anonymous memory and register it
+ */
+int
+rpma_mr_slab_new(struct rpma_peer *peer, size_t size, int usage,
+		void **addr_ptr, size_t *mmap_size_ptr,
+		struct rpma_mr_local **mr_ptr)
+{
+	/* mmap(2) allocates whole pages */
+	long pagesize = sysconf(_SC_PAGESIZE);
+	if (pagesize < 0) {
+		RPMA_LOG_FATAL("sysconf(_SC_PAGESIZE) failed: %s",
+				strerror(errno));
+		return RPMA_E_PROVIDER;
+	}
+
+	size_t mmap_size = (size + (size_t)pagesize - 1) &
+			~((size_t)pagesize - 1);
+
+	void *addr = mmap(NULL, mmap_size, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (addr == MAP_FAILED)
+		return RPMA_E_NOMEM;
+
+	/* only the requested size is registered */
+	int ret = rpma_mr_reg(peer, addr, size, usage, mr_ptr);
+	if (ret) {
+		(void) munmap(addr, mmap_size);
+		return ret;
+	}
+
+	*addr_ptr = addr;
+	*mmap_size_ptr = mmap_size;
+
+	return 0;
+}
+
+/*
+ * rpma_mr_slab_delete -- deregister the slab and release its memory
+ */
+int
+rpma_mr_slab_delete(struct rpma_mr_local **mr_ptr, void *addr,
+		size_t mmap_size)
+{
+	int ret = rpma_mr_dereg(mr_ptr);
+
+	if (munmap(addr, mmap_size)) {
+		RPMA_LOG_ERROR_WITH_ERRNO(errno, "munmap()");
+		if (ret == 0)
+			ret = RPMA_E_PROVIDER;
+	}
+
+	return ret;
+}
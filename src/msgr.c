@@ -0,0 +1,564 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * msgr.c -- librpma credit-based messenger
+ *
+ * Every send carries a batch of messages preceded by a batch header.
+ * The header also returns to the peer the credits, i.e. the number of
+ * receive buffers re-posted since the previous send, so the flow control
+ * does not need any additional traffic as long as both sides keep sending.
+ * A side which only receives announces the credits with a header-only
+ * batch once half of them is waiting to be returned. The last credit is
+ * reserved for such announcements so two sides sending at the same time
+ * cannot starve each other.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "log_internal.h"
+#include "msgr.h"
+#include "mr.h"
+
+#ifdef TEST_MOCK_ALLOC
+#include "cmocka_alloc.h"
+#endif
+
+/* the credit reserved for announcing the returned credits */
+#define MSGR_CREDITS_RESERVED	1
+
+#define MSGR_ALIGN		8
+#define MSGR_ALIGN_UP(x)	\
+	(((x) + MSGR_ALIGN - 1) & ~(size_t)(MSGR_ALIGN - 1))
+
+#define MSGR_NO_BATCH		UINT32_MAX
+
+struct rpma_msgr {
+	struct rpma_conn *conn;
+	struct rpma_recv_ring *ring; /* the receive buffers */
+
+	void *send_slab; /* the send buffers */
+	size_t mmap_size; /* size of the mmap()'ed send slab */
+	struct rpma_mr_local *send_mr; /* registration of the send slab */
+	size_t buf_size; /* size of a single send or receive buffer */
+
+	uint32_t credits_max; /* number of the receive buffers on both sides */
+	uint32_t credits; /* number of the peer's receive buffers available */
+	uint32_t released; /* released receive buffers not re-posted yet */
+	uint32_t grant; /* re-posted receive buffers not announced yet */
+
+	uint32_t *free_bufs; /* stack of the free send buffers */
+	uint32_t nfree; /* number of the free send buffers */
+
+	uint32_t batch; /* the send buffer being filled (or MSGR_NO_BATCH) */
+	size_t batch_len; /* number of bytes of the batch used */
+
+	struct rpma_recv_msg *rcvd; /* FIFO of the received batches */
+	uint32_t rcvd_head; /* the batch being read */
+	uint32_t rcvd_num; /* number of the received batches */
+	size_t rcvd_off; /* offset of the next message in the head batch */
+	uint32_t rcvd_left; /* number of the messages left in the head batch */
+
+	uint64_t next_corr_id; /* correlation ID of the next request */
+};
+
+/*
+ * msgr_send_buf -- get the send buffer of the given index
+ */
+static inline struct rpma_msgr_hdr *
+msgr_send_buf(const struct rpma_msgr *msgr, uint32_t buf)
+{
+	return (struct rpma_msgr_hdr *)((char *)msgr->send_slab +
+			buf * msgr->buf_size);
+}
+
+/*
+ * msgr_post -- send the batch carrying all the credits granted so far
+ */
+static int
+msgr_post(struct rpma_msgr *msgr, uint32_t buf, size_t len, uint32_t nmsgs)
+{
+	/* re-post the released receive buffers so they can be granted too */
+	if (msgr->released) {
+		int ret = rpma_recv_ring_repost(msgr->ring);
+		if (ret)
+			return ret;
+		msgr->grant += msgr->released;
+		msgr->released = 0;
+	}
+
+	struct rpma_msgr_hdr *hdr = msgr_send_buf(msgr, buf);
+	hdr->credits = msgr->grant;
+	hdr->nmsgs = nmsgs;
+
+	int ret = rpma_send(msgr->conn, msgr->send_mr, buf * msgr->buf_size,
+			len, RPMA_F_COMPLETION_ALWAYS, hdr);
+	if (ret)
+		return ret;
+
+	msgr->grant = 0;
+	msgr->credits--;
+
+	return 0;
+}
+
+/*
+ * msgr_announce_credits -- send a header-only batch returning the credits
+ * if enough of them is waiting and there is nothing else to carry them
+ */
+static int
+msgr_announce_credits(struct rpma_msgr *msgr)
+{
+	uint32_t waiting = msgr->grant + msgr->released;
+	if (msgr->batch != MSGR_NO_BATCH || waiting * 2 < msgr->credits_max ||
+			msgr->credits == 0 || msgr->nfree == 0)
+		return 0;
+
+	uint32_t buf = msgr->free_bufs[msgr->nfree - 1];
+	int ret = msgr_post(msgr, buf, sizeof(struct rpma_msgr_hdr), 0);
+	if (ret)
+		return ret;
+
+	msgr->nfree--;
+
+	return 0;
+}
+
+/*
+ * msgr_release -- give the receive buffer back to the ring so it can be
+ * granted to the peer again
+ */
+static int
+msgr_release(struct rpma_msgr *msgr, const struct rpma_recv_msg *rmsg)
+{
+	int ret = rpma_recv_ring_release(msgr->ring, rmsg);
+	if (ret == RPMA_E_INVAL)
+		return ret;
+
+	/*
+	 * The ring re-posts the buffers once all of them are released.
+	 * If it fails the buffers are re-posted before the next send.
+	 */
+	if (++msgr->released == msgr->credits_max && ret == 0) {
+		msgr->grant += msgr->released;
+		msgr->released = 0;
+	}
+
+	return ret;
+}
+
+/*
+ * msgr_release_head -- give the head receive buffer back to the ring
+ */
+static int
+msgr_release_head(struct rpma_msgr *msgr)
+{
+	int ret = msgr_release(msgr, &msgr->rcvd[msgr->rcvd_head]);
+	if (ret == RPMA_E_INVAL)
+		return ret;
+
+	msgr->rcvd_head = (msgr->rcvd_head + 1) % msgr->credits_max;
+	msgr->rcvd_num--;
+
+	/* prepare reading the next batch */
+	if (msgr->rcvd_num) {
+		struct rpma_msgr_hdr *hdr = msgr->rcvd[msgr->rcvd_head].ptr;
+		msgr->rcvd_off = sizeof(*hdr);
+		msgr->rcvd_left = hdr->nmsgs;
+	}
+
+	return ret;
+}
+
+/*
+ * msgr_batch_verify -- check if the batch does not return more credits
+ * than the peer has been given and all of its messages fit in the received
+ * length
+ */
+static int
+msgr_batch_verify(const struct rpma_msgr *msgr,
+		const struct rpma_recv_msg *rmsg)
+{
+	if (rmsg->len < sizeof(struct rpma_msgr_hdr))
+		return RPMA_E_INVAL;
+
+	const struct rpma_msgr_hdr *hdr = rmsg->ptr;
+	if (hdr->credits > msgr->credits_max - msgr->credits)
+		return RPMA_E_INVAL;
+
+	size_t off = sizeof(*hdr);
+	for (uint32_t i = 0; i < hdr->nmsgs; ++i) {
+		if (rmsg->len - off < sizeof(struct rpma_msgr_msg_hdr))
+			return RPMA_E_INVAL;
+
+		const struct rpma_msgr_msg_hdr *mhdr =
+			(const struct rpma_msgr_msg_hdr *)
+			((const char *)rmsg->ptr + off);
+		off += sizeof(*mhdr);
+
+		/* the messages are sent along with their padding */
+		size_t len = MSGR_ALIGN_UP((size_t)mhdr->len);
+		if (rmsg->len - off < len)
+			return RPMA_E_INVAL;
+
+		off += len;
+	}
+
+	return 0;
+}
+
+/*
+ * msgr_append -- append the message to the batch being filled
+ */
+static int
+msgr_append(struct rpma_msgr *msgr, uint32_t type, uint64_t corr_id,
+		const void *data, size_t len)
+{
+	if (data == NULL && len != 0)
+		return RPMA_E_INVAL;
+
+	size_t need = sizeof(struct rpma_msgr_msg_hdr) + MSGR_ALIGN_UP(len);
+	if (len > UINT32_MAX ||
+			need > msgr->buf_size - sizeof(struct rpma_msgr_hdr))
+		return RPMA_E_INVAL;
+
+	/* send the batch if the message does not fit in it */
+	if (msgr->batch != MSGR_NO_BATCH &&
+			msgr->batch_len + need > msgr->buf_size) {
+		int ret = rpma_msgr_flush(msgr);
+		if (ret)
+			return ret;
+	}
+
+	if (msgr->batch == MSGR_NO_BATCH) {
+		if (msgr->nfree == 0)
+			return RPMA_E_AGAIN;
+
+		msgr->batch = msgr->free_bufs[--msgr->nfree];
+		msgr->batch_len = sizeof(struct rpma_msgr_hdr);
+		msgr_send_buf(msgr, msgr->batch)->nmsgs = 0;
+	}
+
+	/* the credits are filled in when the batch is sent */
+	struct rpma_msgr_hdr *hdr = msgr_send_buf(msgr, msgr->batch);
+	struct rpma_msgr_msg_hdr *mhdr = (struct rpma_msgr_msg_hdr *)
+			((char *)hdr + msgr->batch_len);
+	mhdr->corr_id = corr_id;
+	mhdr->len = (uint32_t)len;
+	mhdr->type = type;
+	if (len)
+		memcpy(mhdr + 1, data, len);
+
+	hdr->nmsgs++;
+	msgr->batch_len += need;
+
+	return 0;
+}
+
+/* public librpma API */
+
+/*
+ * rpma_msgr_new -- create the receive buffers, register the send buffers
+ * and grant the peer all the credits
+ */
+int
+rpma_msgr_new(struct rpma_peer *peer, struct rpma_conn *conn,
+		uint32_t credits, size_t buf_size, struct rpma_msgr **msgr_ptr)
+{
+	if (peer == NULL || conn == NULL || msgr_ptr == NULL ||
+			credits <= MSGR_CREDITS_RESERVED ||
+			buf_size < sizeof(struct rpma_msgr_hdr) +
+				sizeof(struct rpma_msgr_msg_hdr) ||
+			buf_size > UINT32_MAX - MSGR_ALIGN ||
+			buf_size > SIZE_MAX / credits)
+		return RPMA_E_INVAL;
+
+	/* keep all the send buffers aligned */
+	buf_size = MSGR_ALIGN_UP(buf_size);
+
+	struct rpma_recv_ring *ring = NULL;
+	int ret = rpma_recv_ring_new(peer, conn, NULL, credits, buf_size,
+			credits, &ring);
+	if (ret)
+		return ret;
+
+	void *send_slab = NULL;
+	size_t mmap_size = 0;
+	struct rpma_mr_local *send_mr = NULL;
+	ret = rpma_mr_slab_new(peer, credits * buf_size, RPMA_MR_USAGE_SEND,
+			&send_slab, &mmap_size, &send_mr);
+	if (ret)
+		goto err_ring_delete;
+
+	struct rpma_msgr *msgr = malloc(sizeof(*msgr));
+	if (msgr == NULL) {
+		ret = RPMA_E_NOMEM;
+		goto err_mr_dereg;
+	}
+
+	msgr->free_bufs = malloc(credits * sizeof(uint32_t));
+	if (msgr->free_bufs == NULL) {
+		ret = RPMA_E_NOMEM;
+		goto err_free_msgr;
+	}
+
+	msgr->rcvd = malloc(credits * sizeof(struct rpma_recv_msg));
+	if (msgr->rcvd == NULL) {
+		ret = RPMA_E_NOMEM;
+		goto err_free_bufs;
+	}
+
+	for (uint32_t i = 0; i < credits; ++i)
+		msgr->free_bufs[i] = credits - 1 - i;
+
+	msgr->conn = conn;
+	msgr->ring = ring;
+	msgr->send_slab = send_slab;
+	msgr->mmap_size = mmap_size;
+	msgr->send_mr = send_mr;
+	msgr->buf_size = buf_size;
+	/* both sides start with all the receive buffers posted */
+	msgr->credits_max = credits;
+	msgr->credits = credits;
+	msgr->released = 0;
+	msgr->grant = 0;
+	msgr->nfree = credits;
+	msgr->batch = MSGR_NO_BATCH;
+	msgr->batch_len = 0;
+	msgr->rcvd_head = 0;
+	msgr->rcvd_num = 0;
+	msgr->rcvd_off = 0;
+	msgr->rcvd_left = 0;
+	msgr->next_corr_id = 1;
+
+	*msgr_ptr = msgr;
+
+	return 0;
+
+err_free_bufs:
+	free(msgr->free_bufs);
+
+err_free_msgr:
+	free(msgr);
+
+err_mr_dereg:
+	(void) rpma_mr_slab_delete(&send_mr, send_slab, mmap_size);
+
+err_ring_delete:
+	(void) rpma_recv_ring_delete(&ring);
+
+	return ret;
+}
+
+/*
+ * rpma_msgr_delete -- deregister and free the send and receive buffers
+ */
+int
+rpma_msgr_delete(struct rpma_msgr **msgr_ptr)
+{
+	if (msgr_ptr == NULL)
+		return RPMA_E_INVAL;
+
+	struct rpma_msgr *msgr = *msgr_ptr;
+	if (msgr == NULL)
+		return 0;
+
+	int ret = rpma_mr_slab_delete(&msgr->send_mr, msgr->send_slab,
+			msgr->mmap_size);
+
+	int ret2 = rpma_recv_ring_delete(&msgr->ring);
+	if (ret == 0)
+		ret = ret2;
+
+	free(msgr->rcvd);
+	free(msgr->free_bufs);
+	free(msgr);
+	*msgr_ptr = NULL;
+
+	return ret;
+}
+
+/*
+ * rpma_msgr_request -- append a request to the batch and assign it
+ * a new correlation ID
+ */
+int
+rpma_msgr_request(struct rpma_msgr *msgr, const void *data, size_t len,
+		uint64_t *corr_id)
+{
+	if (msgr == NULL || corr_id == NULL)
+		return RPMA_E_INVAL;
+
+	int ret = msgr_append(msgr, RPMA_MSGR_REQUEST, msgr->next_corr_id,
+			data, len);
+	if (ret)
+		return ret;
+
+	*corr_id = msgr->next_corr_id++;
+
+	return 0;
+}
+
+/*
+ * rpma_msgr_respond -- append a response to the request of the given
+ * correlation ID to the batch
+ */
+int
+rpma_msgr_respond(struct rpma_msgr *msgr, uint64_t corr_id,
+		const void *data, size_t len)
+{
+	if (msgr == NULL)
+		return RPMA_E_INVAL;
+
+	return msgr_append(msgr, RPMA_MSGR_RESPONSE, corr_id, data, len);
+}
+
+/*
+ * rpma_msgr_flush -- send the batch if the peer has a receive buffer
+ * available for it
+ */
+int
+rpma_msgr_flush(struct rpma_msgr *msgr)
+{
+	if (msgr == NULL)
+		return RPMA_E_INVAL;
+
+	if (msgr->batch == MSGR_NO_BATCH)
+		return 0;
+
+	if (msgr->credits <= MSGR_CREDITS_RESERVED)
+		return RPMA_E_AGAIN;
+
+	struct rpma_msgr_hdr *hdr = msgr_send_buf(msgr, msgr->batch);
+	int ret = msgr_post(msgr, msgr->batch, msgr->batch_len, hdr->nmsgs);
+	if (ret)
+		return ret;
+
+	msgr->batch = MSGR_NO_BATCH;
+	msgr->batch_len = 0;
+
+	return 0;
+}
+
+/*
+ * rpma_msgr_process -- consume the completion of a send or a receive
+ * posted by the messenger
+ */
+int
+rpma_msgr_process(struct rpma_msgr *msgr, const struct rpma_completion *cmpl)
+{
+	if (msgr == NULL || cmpl == NULL)
+		return RPMA_E_INVAL;
+
+	if (cmpl->op == RPMA_OP_SEND) {
+		uintptr_t ctx = (uintptr_t)cmpl->op_context;
+		uintptr_t base = (uintptr_t)msgr->send_slab;
+		if (ctx < base || ctx >= base + msgr->credits_max *
+					msgr->buf_size ||
+				(ctx - base) % msgr->buf_size != 0)
+			return RPMA_E_INVAL;
+
+		/* the send buffer can be reused */
+		msgr->free_bufs[msgr->nfree++] =
+				(uint32_t)((ctx - base) / msgr->buf_size);
+
+		if (cmpl->op_status != IBV_WC_SUCCESS)
+			return RPMA_E_PROVIDER;
+
+		return 0;
+	}
+
+	if (cmpl->op != RPMA_OP_RECV)
+		return RPMA_E_INVAL;
+
+	struct rpma_recv_msg rmsg;
+	int ret = rpma_recv_ring_get_msg(msgr->ring, cmpl, &rmsg);
+	if (ret)
+		return ret;
+
+	if (cmpl->op_status != IBV_WC_SUCCESS) {
+		(void) msgr_release(msgr, &rmsg);
+		return RPMA_E_PROVIDER;
+	}
+
+	ret = msgr_batch_verify(msgr, &rmsg);
+	if (ret) {
+		RPMA_LOG_ERROR("malformed batch of messages received");
+		(void) msgr_release(msgr, &rmsg);
+		return ret;
+	}
+
+	struct rpma_msgr_hdr *hdr = rmsg.ptr;
+	msgr->credits += hdr->credits;
+
+	uint32_t tail = (msgr->rcvd_head + msgr->rcvd_num) % msgr->credits_max;
+	msgr->rcvd[tail] = rmsg;
+	if (msgr->rcvd_num++ == 0) {
+		msgr->rcvd_off = sizeof(*hdr);
+		msgr->rcvd_left = hdr->nmsgs;
+
+		/* a header-only batch carries nothing to read */
+		if (hdr->nmsgs == 0) {
+			ret = msgr_release_head(msgr);
+			if (ret)
+				return ret;
+		}
+	}
+
+	return msgr_announce_credits(msgr);
+}
+
+/*
+ * rpma_msgr_next -- get a view of the next received message
+ */
+int
+rpma_msgr_next(struct rpma_msgr *msgr, struct rpma_msgr_msg *msg)
+{
+	if (msgr == NULL || msg == NULL)
+		return RPMA_E_INVAL;
+
+	/* the messages of the head batch have been read already */
+	while (msgr->rcvd_num && msgr->rcvd_left == 0) {
+		int ret = msgr_release_head(msgr);
+		if (ret)
+			return ret;
+	}
+
+	int ret = msgr_announce_credits(msgr);
+	if (ret)
+		return ret;
+
+	if (msgr->rcvd_num == 0)
+		return RPMA_E_NO_COMPLETION;
+
+	char *batch = msgr->rcvd[msgr->rcvd_head].ptr;
+	struct rpma_msgr_msg_hdr *mhdr =
+		(struct rpma_msgr_msg_hdr *)(batch + msgr->rcvd_off);
+
+	msg->ptr = mhdr + 1;
+	msg->len = mhdr->len;
+	msg->type = (enum rpma_msgr_type)mhdr->type;
+	msg->corr_id = mhdr->corr_id;
+
+	msgr->rcvd_off += sizeof(*mhdr) + MSGR_ALIGN_UP((size_t)mhdr->len);
+	msgr->rcvd_left--;
+
+	return 0;
+}
+
+/*
+ * rpma_msgr_get_credits -- get the number of the peer's receive buffers
+ * available for sending
+ */
+int
+rpma_msgr_get_credits(const struct rpma_msgr *msgr, uint32_t *credits)
+{
+	if (msgr == NULL || credits == NULL)
+		return RPMA_E_INVAL;
+
+	*credits = msgr->credits;
+
+	return 0;
+}
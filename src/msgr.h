@@ -0,0 +1,39 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * msgr.h -- librpma credit-based messenger internal definitions
+ */
+
+#ifndef LIBRPMA_MSGR_H
+#define LIBRPMA_MSGR_H
+
+#include <stdint.h>
+
+#include "librpma.h"
+
+/*
+ * The layout of a batch on the wire:
+ *
+ *	struct rpma_msgr_hdr
+ *	struct rpma_msgr_msg_hdr + payload padded to 8 bytes
+ *	...
+ *	struct rpma_msgr_msg_hdr + payload padded to 8 bytes
+ *
+ * Both sides are expected to share the byte order.
+ */
+
+/* the header of a batch of messages */
+struct rpma_msgr_hdr {
+	uint32_t credits; /* credits returned to the receiver of the batch */
+	uint32_t nmsgs; /* number of messages in the batch */
+};
+
+/* the header of a single message */
+struct rpma_msgr_msg_hdr {
+	uint64_t corr_id; /* correlation ID of the request */
+	uint32_t len; /* length of the payload */
+	uint32_t type; /* enum rpma_msgr_type */
+};
+
+#endif /* LIBRPMA_MSGR_H */
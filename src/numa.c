@@ -0,0 +1,152 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * numa.c -- librpma NUMA placement implementation
+ *
+ * The memory policy is changed via raw system calls so librpma does not
+ * depend on libnuma.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <errno.h>
+#include <limits.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+#include "log_internal.h"
+#include "numa.h"
+
+/* from linux/mempolicy.h */
+#define RPMA_MPOL_PREFERRED	1
+
+/*
+ * The kernel takes maxnode as the number of bits of the mask plus one
+ * (the same way libnuma passes it), so all RPMA_NUMA_NODES_MAX nodes
+ * fit in the mask.
+ */
+#define RPMA_NUMA_MAXNODE	((unsigned long)RPMA_NUMA_NODES_MAX + 1)
+
+/*
+ * numa_get_mempolicy -- get_mempolicy(2) of the calling thread
+ */
+static inline long
+numa_get_mempolicy(int *mode, unsigned long *nodemask)
+{
+	return syscall(SYS_get_mempolicy, mode, nodemask, RPMA_NUMA_MAXNODE,
+			NULL, 0UL);
+}
+
+/*
+ * numa_set_mempolicy -- set_mempolicy(2) of the calling thread
+ */
+static inline long
+numa_set_mempolicy(int mode, const unsigned long *nodemask)
+{
+	return syscall(SYS_set_mempolicy, mode, nodemask, RPMA_NUMA_MAXNODE);
+}
+
+/* internal librpma API */
+
+/*
+ * rpma_numa_node_of_device -- read the NUMA node the device is attached to
+ * from sysfs
+ */
+void
+rpma_numa_node_of_device(struct ibv_context *dev, int *node)
+{
+	char path[PATH_MAX];
+
+	*node = RPMA_NUMA_NODE_ANY;
+
+	if (snprintf(path, sizeof(path), "%s/device/numa_node",
+			dev->device->ibdev_path) >= (int)sizeof(path))
+		return;
+
+	FILE *file = fopen(path, "r");
+	if (file == NULL) {
+		RPMA_LOG_INFO("cannot open %s", path);
+		return;
+	}
+
+	int value;
+	if (fscanf(file, "%d", &value) == 1 && value >= 0)
+		*node = value;
+
+	(void) fclose(file);
+}
+
+/*
+ * rpma_numa_comp_vector_auto -- pick the completion vector derived from
+ * the CPU the calling thread runs on
+ */
+int
+rpma_numa_comp_vector_auto(struct ibv_context *dev)
+{
+	int cpu = sched_getcpu();
+	if (cpu < 0 || dev->num_comp_vectors <= 0)
+		return 0;
+
+	return cpu % dev->num_comp_vectors;
+}
+
+/*
+ * rpma_numa_policy_set -- prefer allocations on the given NUMA node
+ * for the calling thread and save its previous memory policy
+ */
+void
+rpma_numa_policy_set(int node, struct rpma_numa_policy *policy)
+{
+	policy->changed = 0;
+
+	if (node == RPMA_NUMA_NODE_ANY)
+		return;
+
+	if (node < 0 || node >= RPMA_NUMA_NODES_MAX) {
+		RPMA_LOG_WARNING("NUMA node out of range: %d", node);
+		return;
+	}
+
+	if (numa_get_mempolicy(&policy->mode, policy->nodemask)) {
+		RPMA_LOG_WARNING("get_mempolicy() failed: %s",
+				strerror(errno));
+		return;
+	}
+
+	unsigned long nodemask[RPMA_NUMA_MASK_LEN];
+	const unsigned bits = 8 * sizeof(unsigned long);
+	memset(nodemask, 0, sizeof(nodemask));
+	nodemask[(unsigned)node / bits] = 1UL << ((unsigned)node % bits);
+
+	if (numa_set_mempolicy(RPMA_MPOL_PREFERRED, nodemask)) {
+		RPMA_LOG_WARNING("set_mempolicy(node=%d) failed: %s", node,
+				strerror(errno));
+		return;
+	}
+
+	policy->changed = 1;
+}
+
+/*
+ * rpma_numa_policy_restore -- restore the saved memory policy of the calling
+ * thread
+ */
+void
+rpma_numa_policy_restore(struct rpma_numa_policy *policy)
+{
+	if (!policy->changed)
+		return;
+
+	if (numa_set_mempolicy(policy->mode, policy->nodemask))
+		RPMA_LOG_WARNING("set_mempolicy() restore failed: %s",
+				strerror(errno));
+
+	policy->changed = 0;
+}
@@ -0,0 +1,67 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * numa.h -- librpma NUMA placement internal definitions
+ */
+
+#ifndef LIBRPMA_NUMA_H
+#define LIBRPMA_NUMA_H
+
+#include "librpma.h"
+
+#include <infiniband/verbs.h>
+
+/* the maximum number of NUMA nodes a memory policy can be saved for */
+#define RPMA_NUMA_NODES_MAX	1024
+
+#define RPMA_NUMA_MASK_LEN \
+	(RPMA_NUMA_NODES_MAX / (8 * sizeof(unsigned long)))
+
+/* a memory policy of the calling thread saved to be restored later */
+struct rpma_numa_policy {
+	int changed; /* the policy has been changed */
+	int mode; /* the saved policy mode */
+	unsigned long nodemask[RPMA_NUMA_MASK_LEN]; /* the saved node mask */
+};
+
+/*
+ * ASSUMPTIONS
+ * - dev != NULL && node != NULL
+ *
+ * ERRORS
+ * rpma_numa_node_of_device() cannot fail. If the NUMA node of the device
+ * cannot be determined *node is set to RPMA_NUMA_NODE_ANY.
+ */
+void rpma_numa_node_of_device(struct ibv_context *dev, int *node);
+
+/*
+ * ASSUMPTIONS
+ * - dev != NULL
+ *
+ * ERRORS
+ * rpma_numa_comp_vector_auto() cannot fail.
+ */
+int rpma_numa_comp_vector_auto(struct ibv_context *dev);
+
+/*
+ * ASSUMPTIONS
+ * - policy != NULL
+ *
+ * ERRORS
+ * rpma_numa_policy_set() cannot fail. The placement is a best-effort one:
+ * if the memory policy cannot be changed a warning is logged and
+ * the allocations are placed according to the current policy.
+ */
+void rpma_numa_policy_set(int node, struct rpma_numa_policy *policy);
+
+/*
+ * ASSUMPTIONS
+ * - policy != NULL
+ *
+ * ERRORS
+ * rpma_numa_policy_restore() cannot fail.
+ */
+void rpma_numa_policy_restore(struct rpma_numa_policy *policy);
+
+#endif /* LIBRPMA_NUMA_H */
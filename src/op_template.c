@@ -0,0 +1,147 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * op_template.c -- librpma persistent operation templates
+ *
+ * A template keeps a work request prepared once for the given connection,
+ * opcode, memory regions and flags. Starting the template patches only
+ * the addresses, the length and the op_context of the work request and posts
+ * it so the per-operation path neither validates nor resolves the memory
+ * regions again.
+ */
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "conn.h"
+#include "log_internal.h"
+#include "mr.h"
+#include "trace.h"
+
+#ifdef TEST_MOCK_ALLOC
+#include "cmocka_alloc.h"
+#endif
+
+struct rpma_op_template {
+	struct ibv_send_wr wr; /* the prepared work request */
+	struct ibv_sge sge;
+	uint64_t local_addr; /* the base address of the local memory region */
+	uint64_t remote_addr; /* the base address of the remote one */
+	struct ibv_qp *qp;
+	struct rpma_conn *conn;
+	bool read;
+};
+
+/*
+ * op_template_post_failed -- log the failed post (kept out of the start
+ * path)
+ */
+static int __attribute__((noinline, cold))
+op_template_post_failed(const struct rpma_op_template *tmpl, int err)
+{
+	RPMA_LOG_ERROR_WITH_ERRNO(err,
+		"ibv_post_send(remote_addr=0x%" PRIx64 ", rkey=0x%x, "
+		"local_addr=0x%" PRIx64 ", length=%u, lkey=0x%x, "
+		"wr_id=0x%" PRIx64 ", opcode=%s)",
+		tmpl->wr.wr.rdma.remote_addr, tmpl->wr.wr.rdma.rkey,
+		tmpl->sge.addr, tmpl->sge.length, tmpl->sge.lkey,
+		tmpl->wr.wr_id,
+		tmpl->read ? "IBV_WR_RDMA_READ" : "IBV_WR_RDMA_WRITE");
+
+	return RPMA_E_PROVIDER;
+}
+
+/* public librpma API */
+
+/*
+ * rpma_op_template_new -- prepare a template of the operation
+ */
+int
+rpma_op_template_new(struct rpma_conn *conn, enum rpma_op_template_type type,
+		struct rpma_mr_local *local, struct rpma_mr_remote *remote,
+		int flags, struct rpma_op_template **tmpl_ptr)
+{
+	if (conn == NULL || local == NULL || remote == NULL || flags == 0 ||
+			tmpl_ptr == NULL)
+		return RPMA_E_INVAL;
+
+	if (type != RPMA_OP_TEMPLATE_READ && type != RPMA_OP_TEMPLATE_WRITE)
+		return RPMA_E_INVAL;
+
+	struct ibv_qp *qp;
+	int ret = rpma_conn_get_ibv_qp(conn, &qp);
+	if (ret)
+		return ret;
+
+	struct rpma_op_template *tmpl = malloc(sizeof(*tmpl));
+	if (tmpl == NULL)
+		return RPMA_E_NOMEM;
+
+	/* resolve the fixed parts of the work request once */
+	if (type == RPMA_OP_TEMPLATE_READ) {
+		rpma_mr_read_wr(&tmpl->wr, &tmpl->sge, local, 0, remote, 0, 0,
+				flags, NULL);
+	} else {
+		ret = rpma_mr_write_wr(&tmpl->wr, &tmpl->sge, remote, 0, local,
+				0, 0, flags, IBV_WR_RDMA_WRITE, 0, NULL, false);
+		if (ret) {
+			free(tmpl);
+			return ret;
+		}
+	}
+
+	tmpl->local_addr = tmpl->sge.addr;
+	tmpl->remote_addr = tmpl->wr.wr.rdma.remote_addr;
+	tmpl->qp = qp;
+	tmpl->conn = conn;
+	tmpl->read = (type == RPMA_OP_TEMPLATE_READ);
+
+	*tmpl_ptr = tmpl;
+
+	return 0;
+}
+
+/*
+ * rpma_op_template_delete -- delete the template
+ */
+int
+rpma_op_template_delete(struct rpma_op_template **tmpl_ptr)
+{
+	if (tmpl_ptr == NULL)
+		return RPMA_E_INVAL;
+
+	free(*tmpl_ptr);
+	*tmpl_ptr = NULL;
+
+	return 0;
+}
+
+/*
+ * rpma_op_template_start -- post the operation prepared by the template
+ */
+int
+rpma_op_template_start(struct rpma_op_template *tmpl, size_t local_offset,
+		size_t remote_offset, size_t len, const void *op_context)
+{
+	if (tmpl == NULL || len == 0 || len > UINT32_MAX)
+		return RPMA_E_INVAL;
+
+	tmpl->sge.addr = tmpl->local_addr + local_offset;
+	tmpl->sge.length = (uint32_t)len;
+	tmpl->wr.wr.rdma.remote_addr = tmpl->remote_addr + remote_offset;
+	tmpl->wr.wr_id = (uint64_t)op_context;
+
+	struct ibv_send_wr *bad_wr;
+	RPMA_TRACE(post_chain, tmpl->qp, tmpl->wr.wr_id, 1);
+	int ret = ibv_post_send(tmpl->qp, &tmpl->wr, &bad_wr);
+	if (ret)
+		return op_template_post_failed(tmpl, ret);
+
+	/* the next atomic write has to be fenced after the read */
+	if (tmpl->read)
+		rpma_conn_reads_posted(tmpl->conn);
+
+	return 0;
+}
@@ -12,7 +12,9 @@
 
 #include "conn_req.h"
 #include "log_internal.h"
+#include "numa.h"
 #include "peer.h"
+#include "srq.h"
 
 #ifdef TEST_MOCK_ALLOC
 #include "cmocka_alloc.h"
@@ -21,13 +23,12 @@
 /* the maximum number of scatter/gather elements in any Work Request */
 #define RPMA_MAX_SGE 1
 
-/* the maximum message size (in bytes) that can be posted inline */
-#define RPMA_MAX_INLINE_DATA 0
-
 struct rpma_peer {
 	struct ibv_pd *pd; /* a protection domain */
 
 	int is_odp_supported; /* is On-Demand Paging supported */
+
+	struct rpma_stats_group stats; /* statistics of the connections */
 };
 
 /* internal librpma API */
@@ -73,6 +74,13 @@ rpma_peer_usage_to_access(struct rpma_peer *peer, int usage)
 	if (usage & RPMA_MR_USAGE_RECV)
 		access |= IBV_ACCESS_LOCAL_WRITE;
 
+	if (usage & RPMA_MR_USAGE_ATOMIC)
+		/*
+		 * If IBV_ACCESS_REMOTE_ATOMIC is set, then
+		 * IBV_ACCESS_LOCAL_WRITE must be set too.
+		 */
+		access |= IBV_ACCESS_REMOTE_ATOMIC | IBV_ACCESS_LOCAL_WRITE;
+
 	/*
 	 * There is no IBV_ACCESS_* value to be set for RPMA_MR_USAGE_SEND.
 	 */
@@ -93,24 +101,40 @@ rpma_peer_create_qp(struct rpma_peer *peer, struct rdma_cm_id *id,
 	if (peer == NULL || id == NULL || cq == NULL)
 		return RPMA_E_INVAL;
 
-	/* read SQ and RQ sizes from the configuration */
+	/* read SQ, RQ and inline sizes from the configuration */
 	uint32_t sq_size = 0;
 	uint32_t rq_size = 0;
+	uint32_t inline_size = 0;
+	struct rpma_srq *srq = NULL;
 	(void) rpma_conn_cfg_get_sq_size(cfg, &sq_size);
 	(void) rpma_conn_cfg_get_rq_size(cfg, &rq_size);
+	(void) rpma_conn_cfg_get_inline_size(cfg, &inline_size);
+	(void) rpma_conn_cfg_get_srq(cfg, &srq);
 
 	struct ibv_cq *ibv_cq = rpma_cq_get_ibv_cq(cq);
+	struct ibv_cq *ibv_recv_cq = ibv_cq;
+	struct ibv_srq *ibv_srq = NULL;
+
+	/*
+	 * A QP attached to a shared receive queue has no receive queue
+	 * of its own and its receive completions land in the SRQ's CQ.
+	 */
+	if (srq != NULL) {
+		ibv_srq = rpma_srq_get_ibv_srq(srq);
+		ibv_recv_cq = rpma_cq_get_ibv_cq(rpma_srq_get_rcq(srq));
+		rq_size = 0;
+	}
 
 	struct ibv_qp_init_attr qp_init_attr;
 	qp_init_attr.qp_context = NULL;
 	qp_init_attr.send_cq = ibv_cq;
-	qp_init_attr.recv_cq = ibv_cq;
-	qp_init_attr.srq = NULL;
+	qp_init_attr.recv_cq = ibv_recv_cq;
+	qp_init_attr.srq = ibv_srq;
 	qp_init_attr.cap.max_send_wr = sq_size;
 	qp_init_attr.cap.max_recv_wr = rq_size;
 	qp_init_attr.cap.max_send_sge = RPMA_MAX_SGE;
 	qp_init_attr.cap.max_recv_sge = RPMA_MAX_SGE;
-	qp_init_attr.cap.max_inline_data = RPMA_MAX_INLINE_DATA;
+	qp_init_attr.cap.max_inline_data = inline_size;
 	/*
 	 * Reliable Connection - since we are using e.g. IBV_WR_RDMA_READ.
 	 * For details please see ibv_post_send(3).
@@ -131,12 +155,38 @@ rpma_peer_create_qp(struct rpma_peer *peer, struct rdma_cm_id *id,
 		RPMA_LOG_ERROR_WITH_ERRNO(errno,
 			"rdma_create_qp(max_send_wr=%" PRIu32
 			", max_recv_wr=%" PRIu32
-			", max_send/recv_sge=%i, max_inline_data=%i, qp_type=IBV_QPT_RC, sq_sig_all=0)",
-			sq_size, rq_size, RPMA_MAX_SGE,
-			RPMA_MAX_INLINE_DATA);
+			", max_send/recv_sge=%i, max_inline_data=%" PRIu32
+			", qp_type=IBV_QPT_RC, sq_sig_all=0)",
+			sq_size, rq_size, RPMA_MAX_SGE, inline_size);
+		return RPMA_E_PROVIDER;
+	}
+
+	return 0;
+}
+
+/*
+ * rpma_peer_create_srq -- allocate a shared receive queue of the given size
+ */
+int
+rpma_peer_create_srq(struct rpma_peer *peer, uint32_t size,
+		struct ibv_srq **ibv_srq_ptr)
+{
+	struct ibv_srq_init_attr srq_init_attr;
+	srq_init_attr.srq_context = NULL;
+	srq_init_attr.attr.max_wr = size;
+	srq_init_attr.attr.max_sge = RPMA_MAX_SGE;
+	srq_init_attr.attr.srq_limit = 0;
+
+	struct ibv_srq *ibv_srq = ibv_create_srq(peer->pd, &srq_init_attr);
+	if (ibv_srq == NULL) {
+		RPMA_LOG_ERROR_WITH_ERRNO(errno,
+			"ibv_create_srq(max_wr=%" PRIu32 ", max_sge=%i)",
+			size, RPMA_MAX_SGE);
 		return RPMA_E_PROVIDER;
 	}
 
+	*ibv_srq_ptr = ibv_srq;
+
 	return 0;
 }
 
@@ -204,6 +254,16 @@ rpma_peer_mr_reg(struct rpma_peer *peer, struct ibv_mr **ibv_mr_ptr,
 #endif
 }
 
+/*
+ * rpma_peer_get_stats_group -- get the statistics of all the connections
+ * of the peer
+ */
+struct rpma_stats_group *
+rpma_peer_get_stats_group(struct rpma_peer *peer)
+{
+	return &peer->stats;
+}
+
 /* public librpma API */
 
 /*
@@ -251,6 +311,7 @@ rpma_peer_new(struct ibv_context *ibv_ctx, struct rpma_peer **peer_ptr)
 
 	peer->pd = pd;
 	peer->is_odp_supported = is_odp_supported;
+	rpma_stats_group_init(&peer->stats);
 	*peer_ptr = peer;
 
 	return 0;
@@ -280,8 +341,38 @@ rpma_peer_delete(struct rpma_peer **peer_ptr)
 		return RPMA_E_PROVIDER;
 	}
 
+	rpma_stats_group_fini(&peer->stats);
 	free(peer);
 	*peer_ptr = NULL;
 
 	return 0;
 }
+
+/*
+ * rpma_peer_get_numa_node -- get the NUMA node of the peer's device
+ */
+int
+rpma_peer_get_numa_node(const struct rpma_peer *peer, int *node)
+{
+	if (peer == NULL || node == NULL)
+		return RPMA_E_INVAL;
+
+	rpma_numa_node_of_device(peer->pd->context, node);
+
+	return 0;
+}
+
+/*
+ * rpma_peer_get_stats -- sum up the statistics of all the connections of
+ * the peer
+ */
+int
+rpma_peer_get_stats(struct rpma_peer *peer, struct rpma_stats *stats)
+{
+	if (peer == NULL || stats == NULL)
+		return RPMA_E_INVAL;
+
+	rpma_stats_group_get(&peer->stats, stats);
+
+	return 0;
+}
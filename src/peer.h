@@ -11,6 +11,7 @@
 
 #include "librpma.h"
 #include "cq.h"
+#include "stats.h"
 
 #include <rdma/rdma_cma.h>
 
@@ -37,4 +38,25 @@ int rpma_peer_create_qp(struct rpma_peer *peer, struct rdma_cm_id *id,
 int rpma_peer_mr_reg(struct rpma_peer *peer, struct ibv_mr **ibv_mr_ptr,
 		void *addr, size_t length, int usage);
 
+/*
+ * ASSUMPTIONS
+ * - peer != NULL && size > 0 && ibv_srq_ptr != NULL
+ *
+ * ERRORS
+ * rpma_peer_create_srq() can fail with the following error:
+ *
+ * - RPMA_E_PROVIDER - allocating an SRQ failed
+ */
+int rpma_peer_create_srq(struct rpma_peer *peer, uint32_t size,
+		struct ibv_srq **ibv_srq_ptr);
+
+/*
+ * rpma_peer_get_stats_group -- get the statistics of all the connections
+ * of the peer
+ *
+ * ASSUMPTIONS
+ * - peer != NULL
+ */
+struct rpma_stats_group *rpma_peer_get_stats_group(struct rpma_peer *peer);
+
 #endif /* LIBRPMA_PEER_H */
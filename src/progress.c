@@ -0,0 +1,266 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * progress.c -- librpma progress threads
+ *
+ * A progress thread owns the completion queue of a single connection.
+ * It collects up to batch completions at once and then calls the callbacks
+ * attached to the operations (struct rpma_progress_cb used as the operations'
+ * op_context) one after another.
+ *
+ * An event-driven thread waits in poll(2) for either the completion file
+ * descriptor of the connection or an eventfd(2) which is signalled when
+ * the thread has to stop. The completion channel is rearmed before the CQ is
+ * drained (see rpma_conn_completion_wait()) so no completion can be missed.
+ * A busy-polling thread checks the stop flag after every batch.
+ */
+
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "librpma.h"
+#include "log_internal.h"
+
+#ifdef TEST_MOCK_ALLOC
+#include "cmocka_alloc.h"
+#endif
+
+struct rpma_progress {
+	struct rpma_conn *conn;
+	enum rpma_progress_mode mode;
+	uint32_t batch; /* completions collected before the callbacks run */
+	struct rpma_completion *cmpls; /* the collected batch */
+	int cfd; /* the completion fd of the connection (event-driven only) */
+	int wakefd; /* the eventfd(2) stopping the thread (event-driven only) */
+	int stop; /* the thread has to stop */
+	int error; /* the error the thread has stopped with */
+	pthread_t thread;
+};
+
+/*
+ * progress_batch -- collect up to batch completions and call the callbacks
+ * of all of them
+ */
+static int
+progress_batch(struct rpma_progress *progress, uint32_t *collected)
+{
+	int ret = 0;
+	uint32_t n;
+
+	for (n = 0; n < progress->batch; ++n) {
+		ret = rpma_conn_completion_get(progress->conn,
+				&progress->cmpls[n]);
+		if (ret)
+			break;
+	}
+
+	if (ret == RPMA_E_NO_COMPLETION)
+		ret = 0;
+
+	/* the completions collected before a failure are dispatched too */
+	for (uint32_t i = 0; i < n; ++i) {
+		const struct rpma_completion *cmpl = &progress->cmpls[i];
+		const struct rpma_progress_cb *cb = cmpl->op_context;
+		if (cb == NULL || cb->func == NULL)
+			continue;
+
+		cb->func(cmpl, cb->arg);
+	}
+
+	*collected = n;
+
+	return ret;
+}
+
+/*
+ * progress_wait -- wait for either a completion or the stop request
+ */
+static int
+progress_wait(struct rpma_progress *progress)
+{
+	struct pollfd fds[2] = {
+		{.fd = progress->cfd, .events = POLLIN},
+		{.fd = progress->wakefd, .events = POLLIN},
+	};
+
+	if (poll(fds, 2, -1 /* infinitely */) < 0) {
+		if (errno == EINTR)
+			return 0;
+
+		RPMA_LOG_ERROR_WITH_ERRNO(errno, "poll()");
+		return RPMA_E_PROVIDER;
+	}
+
+	/* woken up to stop */
+	if (fds[0].revents == 0)
+		return 0;
+
+	int ret = rpma_conn_completion_wait(progress->conn);
+	if (ret == RPMA_E_NO_COMPLETION)
+		ret = 0;
+
+	return ret;
+}
+
+/*
+ * progress_thread -- the main loop of the progress thread
+ */
+static void *
+progress_thread(void *arg)
+{
+	struct rpma_progress *progress = arg;
+	uint32_t n = 0;
+	int ret = 0;
+
+	while (!__atomic_load_n(&progress->stop, __ATOMIC_ACQUIRE)) {
+		ret = progress_batch(progress, &n);
+		if (ret)
+			break;
+
+		/* a partial batch means the CQ has been drained */
+		if (n < progress->batch &&
+				progress->mode == RPMA_PROGRESS_EVENT_DRIVEN) {
+			ret = progress_wait(progress);
+			if (ret)
+				break;
+		}
+	}
+
+	/* dispatch the completions which are already in the CQ */
+	while (ret == 0) {
+		ret = progress_batch(progress, &n);
+		if (n < progress->batch)
+			break;
+	}
+
+	progress->error = ret;
+
+	return NULL;
+}
+
+/* public librpma API */
+
+/*
+ * rpma_progress_new -- create a progress thread dispatching the completions
+ * of the connection
+ */
+int
+rpma_progress_new(struct rpma_conn *conn, enum rpma_progress_mode mode,
+		uint32_t batch, struct rpma_progress **progress_ptr)
+{
+	if (conn == NULL || batch == 0 || progress_ptr == NULL)
+		return RPMA_E_INVAL;
+
+	if (mode != RPMA_PROGRESS_BUSY_POLL &&
+			mode != RPMA_PROGRESS_EVENT_DRIVEN)
+		return RPMA_E_INVAL;
+
+	int cfd = -1;
+	int ret;
+	if (mode == RPMA_PROGRESS_EVENT_DRIVEN) {
+		ret = rpma_conn_get_completion_fd(conn, &cfd);
+		if (ret)
+			return ret;
+	}
+
+	struct rpma_progress *progress = malloc(sizeof(*progress));
+	if (progress == NULL)
+		return RPMA_E_NOMEM;
+
+	progress->cmpls = malloc(batch * sizeof(*progress->cmpls));
+	if (progress->cmpls == NULL) {
+		ret = RPMA_E_NOMEM;
+		goto err_free_progress;
+	}
+
+	progress->wakefd = -1;
+	if (mode == RPMA_PROGRESS_EVENT_DRIVEN) {
+		progress->wakefd = eventfd(0, EFD_CLOEXEC);
+		if (progress->wakefd < 0) {
+			RPMA_LOG_ERROR_WITH_ERRNO(errno, "eventfd()");
+			ret = RPMA_E_PROVIDER;
+			goto err_free_cmpls;
+		}
+	}
+
+	progress->conn = conn;
+	progress->mode = mode;
+	progress->batch = batch;
+	progress->cfd = cfd;
+	progress->stop = 0;
+	progress->error = 0;
+
+	errno = pthread_create(&progress->thread, NULL, progress_thread,
+			progress);
+	if (errno) {
+		RPMA_LOG_ERROR_WITH_ERRNO(errno, "pthread_create()");
+		ret = RPMA_E_PROVIDER;
+		goto err_close_wakefd;
+	}
+
+	*progress_ptr = progress;
+
+	return 0;
+
+err_close_wakefd:
+	if (progress->wakefd >= 0)
+		(void) close(progress->wakefd);
+
+err_free_cmpls:
+	free(progress->cmpls);
+
+err_free_progress:
+	free(progress);
+
+	return ret;
+}
+
+/*
+ * rpma_progress_delete -- stop the progress thread and wait for it
+ */
+int
+rpma_progress_delete(struct rpma_progress **progress_ptr)
+{
+	if (progress_ptr == NULL)
+		return RPMA_E_INVAL;
+
+	struct rpma_progress *progress = *progress_ptr;
+	if (progress == NULL)
+		return 0;
+
+	/* the thread cannot wait for itself */
+	if (pthread_equal(pthread_self(), progress->thread))
+		return RPMA_E_INVAL;
+
+	__atomic_store_n(&progress->stop, 1, __ATOMIC_RELEASE);
+
+	if (progress->wakefd >= 0 && eventfd_write(progress->wakefd, 1)) {
+		RPMA_LOG_ERROR_WITH_ERRNO(errno, "eventfd_write()");
+		return RPMA_E_PROVIDER;
+	}
+
+	errno = pthread_join(progress->thread, NULL);
+	if (errno) {
+		RPMA_LOG_ERROR_WITH_ERRNO(errno, "pthread_join()");
+		return RPMA_E_PROVIDER;
+	}
+
+	int ret = progress->error;
+
+	if (progress->wakefd >= 0 && close(progress->wakefd)) {
+		RPMA_LOG_ERROR_WITH_ERRNO(errno, "close()");
+		if (ret == 0)
+			ret = RPMA_E_PROVIDER;
+	}
+
+	free(progress->cmpls);
+	free(progress);
+	*progress_ptr = NULL;
+
+	return ret;
+}
@@ -0,0 +1,645 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * rcache.c -- librpma read cache
+ *
+ * The remote memory region is split into blocks of the same size which are
+ * cached in a registered local arena. The arena is set-associative:
+ * the block of a tag (the index of the remote block) can be kept only
+ * in one of the RCACHE_WAYS ways of its set and the least recently used
+ * block of the set is evicted when needed. The arena is laid out way by way
+ * so the consecutive tags fetched to the same way are adjacent in the arena
+ * and the consecutive misses are coalesced into a single read.
+ *
+ * The remote side publishes its updates by changing an 8-byte version word.
+ * The read of the version word is posted after all of the fetches initiated
+ * so far. The completions of a connection come in order, so any fetch still
+ * in flight when the version's completion is processed was posted after
+ * the version read and already sees the new data. Hence, when the version
+ * has changed, only the blocks which are already valid have to be dropped.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "librpma.h"
+#include "log_internal.h"
+#include "mr.h"
+
+#ifdef TEST_MOCK_ALLOC
+#include "cmocka_alloc.h"
+#endif
+
+#define RCACHE_WAYS		4
+#define RCACHE_VERSION_SIZE	sizeof(uint64_t)
+#define RCACHE_ALIGN_UP(x)	\
+	(((x) + RCACHE_VERSION_SIZE - 1) & ~(RCACHE_VERSION_SIZE - 1))
+
+enum rcache_state {
+	RCACHE_EMPTY,
+	RCACHE_QUEUED, /* a miss waiting for rpma_rcache_submit() */
+	RCACHE_FETCHING, /* a miss being read */
+	RCACHE_VALID,
+};
+
+struct rcache_block {
+	size_t tag; /* the index of the remote block */
+	uint64_t last_used; /* the tick of the last use */
+	uint64_t queued_seq; /* the request which has queued the miss */
+	uint32_t run; /* number of blocks read along with this one */
+	uint32_t state; /* enum rcache_state */
+};
+
+struct rcache_miss {
+	size_t tag;
+	uint32_t block; /* the index of the block in the arena */
+};
+
+struct rcache_req {
+	void *dst;
+	size_t offset; /* the remote offset of the data */
+	size_t len;
+	size_t first_tag; /* the first block of the data */
+	size_t ntags; /* number of blocks of the data */
+	uint64_t seq; /* the sequence number of the request */
+	uint32_t waiting; /* number of the misses still being read */
+	enum ibv_wc_status status; /* status of the first failed miss */
+	const void *op_context; /* the op_context of the caller */
+};
+
+struct rpma_rcache {
+	struct rpma_conn *conn;
+	const struct rpma_mr_remote *src; /* the cached remote memory region */
+	size_t src_size;
+	size_t version_offset; /* the remote offset of the version word */
+
+	void *arena; /* the cached blocks followed by the version word */
+	size_t mmap_size; /* size of the mmap()'ed arena */
+	struct rpma_mr_local *arena_mr; /* registration of the arena */
+	size_t block_size;
+	uint32_t nsets;
+	uint32_t ways;
+	size_t version_slot; /* offset of the version word in the arena */
+
+	struct rcache_block *blocks; /* descriptors of the cached blocks */
+	struct rcache_miss *misses; /* the misses to be read */
+	uint32_t nmisses;
+
+	struct rcache_req *reqs;
+	uint32_t depth; /* number of the requests */
+	uint32_t *free_reqs; /* stack of the free requests */
+	uint32_t nfree;
+	uint32_t *done; /* FIFO of the finished requests */
+	uint32_t done_head;
+	uint32_t ndone;
+
+	uint64_t version; /* the version the valid blocks belong to */
+	bool have_version; /* the version has been read at least once */
+	bool validating; /* the version word is being read */
+
+	uint64_t seq; /* the sequence number of the last request */
+	uint64_t tick; /* the clock of the LRU policy */
+};
+
+/*
+ * rcache_block_of -- get the index of the block of the given set and way
+ */
+static inline uint32_t
+rcache_block_of(const struct rpma_rcache *rcache, uint32_t set, uint32_t way)
+{
+	return way * rcache->nsets + set;
+}
+
+/*
+ * rcache_lookup -- find the block holding the given tag or return NULL
+ */
+static struct rcache_block *
+rcache_lookup(struct rpma_rcache *rcache, size_t tag)
+{
+	uint32_t set = (uint32_t)(tag % rcache->nsets);
+
+	for (uint32_t way = 0; way < rcache->ways; ++way) {
+		struct rcache_block *b =
+			&rcache->blocks[rcache_block_of(rcache, set, way)];
+		if (b->state != RCACHE_EMPTY && b->tag == tag)
+			return b;
+	}
+
+	return NULL;
+}
+
+/*
+ * rcache_victim -- choose the block the given tag will be fetched to:
+ * the empty one next to the block of the preceding tag so both of them can
+ * be read at once, any empty one or the least recently used valid one.
+ * Return -1 if all the blocks of the set are being read.
+ */
+static int64_t
+rcache_victim(struct rpma_rcache *rcache, size_t tag)
+{
+	uint32_t set = (uint32_t)(tag % rcache->nsets);
+	struct rcache_block *prev = tag ? rcache_lookup(rcache, tag - 1) : NULL;
+	if (prev) {
+		uint32_t way = (uint32_t)(prev - rcache->blocks) /
+				rcache->nsets;
+		uint32_t idx = rcache_block_of(rcache, set, way);
+		if (rcache->blocks[idx].state == RCACHE_EMPTY)
+			return idx;
+	}
+
+	int64_t victim = -1;
+	for (uint32_t way = 0; way < rcache->ways; ++way) {
+		uint32_t idx = rcache_block_of(rcache, set, way);
+		struct rcache_block *b = &rcache->blocks[idx];
+		if (b->state == RCACHE_EMPTY)
+			return idx;
+		if (b->state == RCACHE_VALID && (victim < 0 ||
+				b->last_used <
+				rcache->blocks[victim].last_used))
+			victim = idx;
+	}
+
+	return victim;
+}
+
+/*
+ * rcache_copy -- copy the part of the requested data the block holds
+ */
+static void
+rcache_copy(const struct rpma_rcache *rcache, const struct rcache_req *req,
+		size_t tag, uint32_t block)
+{
+	size_t lo = tag * rcache->block_size;
+	size_t hi = lo + rcache->block_size;
+	size_t from = req->offset > lo ? req->offset : lo;
+	size_t to = req->offset + req->len < hi ? req->offset + req->len : hi;
+
+	memcpy((char *)req->dst + (from - req->offset),
+			(char *)rcache->arena + block * rcache->block_size +
+			(from - lo), to - from);
+}
+
+/*
+ * rcache_done -- queue the finished request for rpma_rcache_next()
+ */
+static inline void
+rcache_done(struct rpma_rcache *rcache, const struct rcache_req *req)
+{
+	uint32_t tail = (rcache->done_head + rcache->ndone) % rcache->depth;
+	rcache->done[tail] = (uint32_t)(req - rcache->reqs);
+	rcache->ndone++;
+}
+
+/*
+ * rcache_complete -- pass the blocks read at once to the requests waiting
+ * for them
+ */
+static void
+rcache_complete(struct rpma_rcache *rcache, uint32_t first,
+		enum ibv_wc_status status)
+{
+	uint32_t n = rcache->blocks[first].run;
+	size_t tag0 = rcache->blocks[first].tag;
+	rcache->blocks[first].run = 0;
+
+	for (uint32_t i = 0; i < rcache->depth; ++i) {
+		struct rcache_req *req = &rcache->reqs[i];
+		if (req->waiting == 0)
+			continue;
+
+		size_t lo = req->first_tag > tag0 ? req->first_tag : tag0;
+		size_t hi = req->first_tag + req->ntags < tag0 + n ?
+				req->first_tag + req->ntags : tag0 + n;
+		for (size_t tag = lo; tag < hi; ++tag) {
+			uint32_t block = first + (uint32_t)(tag - tag0);
+
+			/* the block has been valid when the request came */
+			if (rcache->blocks[block].queued_seq > req->seq)
+				continue;
+
+			if (status == IBV_WC_SUCCESS)
+				rcache_copy(rcache, req, tag, block);
+			else if (req->status == IBV_WC_SUCCESS)
+				req->status = status;
+			req->waiting--;
+		}
+
+		if (req->waiting == 0)
+			rcache_done(rcache, req);
+	}
+
+	for (uint32_t i = 0; i < n; ++i) {
+		struct rcache_block *b = &rcache->blocks[first + i];
+		b->state = (status == IBV_WC_SUCCESS) ?
+				RCACHE_VALID : RCACHE_EMPTY;
+		b->last_used = ++rcache->tick;
+	}
+}
+
+/*
+ * rcache_drop -- drop the valid blocks of the given range of tags
+ */
+static void
+rcache_drop(struct rpma_rcache *rcache, size_t first_tag, size_t last_tag)
+{
+	uint32_t nblocks = rcache->nsets * rcache->ways;
+	for (uint32_t i = 0; i < nblocks; ++i) {
+		struct rcache_block *b = &rcache->blocks[i];
+		if (b->state == RCACHE_VALID && b->tag >= first_tag &&
+				b->tag <= last_tag)
+			b->state = RCACHE_EMPTY;
+	}
+}
+
+/*
+ * rcache_miss_cmp -- order the misses by their tags
+ */
+static int
+rcache_miss_cmp(const void *m1, const void *m2)
+{
+	size_t tag1 = ((const struct rcache_miss *)m1)->tag;
+	size_t tag2 = ((const struct rcache_miss *)m2)->tag;
+
+	return (tag1 > tag2) - (tag1 < tag2);
+}
+
+/* public librpma API */
+
+/*
+ * rpma_rcache_new -- register the arena of the read cache of the remote
+ * memory region
+ */
+int
+rpma_rcache_new(struct rpma_peer *peer, struct rpma_conn *conn,
+		const struct rpma_mr_remote *src, size_t version_offset,
+		size_t block_size, uint32_t blocks, uint32_t depth,
+		struct rpma_rcache **rcache_ptr)
+{
+	if (peer == NULL || conn == NULL || src == NULL ||
+			rcache_ptr == NULL || block_size == 0 || blocks == 0 ||
+			depth == 0 ||
+			version_offset % RPMA_ATOMIC_ALIGNMENT != 0)
+		return RPMA_E_INVAL;
+
+	size_t src_size = 0;
+	(void) rpma_mr_remote_get_size(src, &src_size);
+	if (src_size < RCACHE_VERSION_SIZE ||
+			version_offset > src_size - RCACHE_VERSION_SIZE)
+		return RPMA_E_INVAL;
+
+	uint32_t ways = blocks < RCACHE_WAYS ? blocks : RCACHE_WAYS;
+	uint32_t nsets = blocks / ways;
+	uint32_t nblocks = nsets * ways;
+	if (block_size > (SIZE_MAX - 2 * RCACHE_VERSION_SIZE) / nblocks)
+		return RPMA_E_INVAL;
+
+	size_t version_slot = RCACHE_ALIGN_UP(nblocks * block_size);
+	void *arena = NULL;
+	size_t mmap_size = 0;
+	struct rpma_mr_local *arena_mr = NULL;
+	int ret = rpma_mr_slab_new(peer, version_slot + RCACHE_VERSION_SIZE,
+			RPMA_MR_USAGE_READ_DST, &arena, &mmap_size, &arena_mr);
+	if (ret)
+		return ret;
+
+	struct rpma_rcache *rcache = malloc(sizeof(*rcache));
+	if (rcache == NULL) {
+		ret = RPMA_E_NOMEM;
+		goto err_mr_dereg;
+	}
+
+	/* all the arrays share a single allocation */
+	size_t per_block = sizeof(struct rcache_block) +
+			sizeof(struct rcache_miss);
+	size_t per_req = sizeof(struct rcache_req) + 2 * sizeof(uint32_t);
+	char *arrays = malloc(nblocks * per_block + depth * per_req);
+	if (arrays == NULL) {
+		ret = RPMA_E_NOMEM;
+		goto err_free_rcache;
+	}
+
+	rcache->blocks = (struct rcache_block *)arrays;
+	rcache->misses = (struct rcache_miss *)(rcache->blocks + nblocks);
+	rcache->reqs = (struct rcache_req *)(rcache->misses + nblocks);
+	rcache->free_reqs = (uint32_t *)(rcache->reqs + depth);
+	rcache->done = rcache->free_reqs + depth;
+
+	for (uint32_t i = 0; i < nblocks; ++i) {
+		rcache->blocks[i].tag = 0;
+		rcache->blocks[i].last_used = 0;
+		rcache->blocks[i].queued_seq = 0;
+		rcache->blocks[i].run = 0;
+		rcache->blocks[i].state = RCACHE_EMPTY;
+	}
+
+	for (uint32_t i = 0; i < depth; ++i) {
+		rcache->reqs[i].waiting = 0;
+		rcache->free_reqs[i] = depth - 1 - i;
+	}
+
+	rcache->conn = conn;
+	rcache->src = src;
+	rcache->src_size = src_size;
+	rcache->version_offset = version_offset;
+	rcache->arena = arena;
+	rcache->mmap_size = mmap_size;
+	rcache->arena_mr = arena_mr;
+	rcache->block_size = block_size;
+	rcache->nsets = nsets;
+	rcache->ways = ways;
+	rcache->version_slot = version_slot;
+	rcache->nmisses = 0;
+	rcache->depth = depth;
+	rcache->nfree = depth;
+	rcache->done_head = 0;
+	rcache->ndone = 0;
+	rcache->version = 0;
+	rcache->have_version = false;
+	rcache->validating = false;
+	rcache->seq = 0;
+	rcache->tick = 0;
+
+	*rcache_ptr = rcache;
+
+	return 0;
+
+err_free_rcache:
+	free(rcache);
+
+err_mr_dereg:
+	(void) rpma_mr_slab_delete(&arena_mr, arena, mmap_size);
+
+	return ret;
+}
+
+/*
+ * rpma_rcache_delete -- deregister and free the arena of the read cache
+ */
+int
+rpma_rcache_delete(struct rpma_rcache **rcache_ptr)
+{
+	if (rcache_ptr == NULL)
+		return RPMA_E_INVAL;
+
+	struct rpma_rcache *rcache = *rcache_ptr;
+	if (rcache == NULL)
+		return 0;
+
+	int ret = rpma_mr_slab_delete(&rcache->arena_mr, rcache->arena,
+			rcache->mmap_size);
+
+	free(rcache->blocks);
+	free(rcache);
+	*rcache_ptr = NULL;
+
+	return ret;
+}
+
+/*
+ * rpma_rcache_read -- copy the cached part of the data and queue
+ * the misses
+ */
+int
+rpma_rcache_read(struct rpma_rcache *rcache, void *dst, size_t src_offset,
+		size_t len, const void *op_context)
+{
+	if (rcache == NULL || dst == NULL || len == 0 ||
+			src_offset > rcache->src_size ||
+			len > rcache->src_size - src_offset)
+		return RPMA_E_INVAL;
+
+	size_t first_tag = src_offset / rcache->block_size;
+	size_t ntags = (src_offset + len - 1) / rcache->block_size -
+			first_tag + 1;
+
+	/* every block of the request belongs to another set */
+	if (ntags > rcache->nsets)
+		return RPMA_E_INVAL;
+
+	if (rcache->nfree == 0)
+		return RPMA_E_AGAIN;
+
+	/* nothing is changed if any of the misses cannot be cached */
+	for (size_t tag = first_tag; tag < first_tag + ntags; ++tag) {
+		if (rcache_lookup(rcache, tag) == NULL &&
+				rcache_victim(rcache, tag) < 0)
+			return RPMA_E_AGAIN;
+	}
+
+	uint32_t r = rcache->free_reqs[--rcache->nfree];
+	struct rcache_req *req = &rcache->reqs[r];
+	req->dst = dst;
+	req->offset = src_offset;
+	req->len = len;
+	req->first_tag = first_tag;
+	req->ntags = ntags;
+	req->seq = ++rcache->seq;
+	req->waiting = 0;
+	req->status = IBV_WC_SUCCESS;
+	req->op_context = op_context;
+
+	for (size_t tag = first_tag; tag < first_tag + ntags; ++tag) {
+		struct rcache_block *b = rcache_lookup(rcache, tag);
+		if (b && b->state == RCACHE_VALID) {
+			rcache_copy(rcache, req, tag,
+					(uint32_t)(b - rcache->blocks));
+			b->last_used = ++rcache->tick;
+			continue;
+		}
+
+		if (b == NULL) {
+			uint32_t idx = (uint32_t)rcache_victim(rcache, tag);
+			b = &rcache->blocks[idx];
+			b->tag = tag;
+			b->state = RCACHE_QUEUED;
+			b->queued_seq = req->seq;
+			rcache->misses[rcache->nmisses].tag = tag;
+			rcache->misses[rcache->nmisses].block = idx;
+			rcache->nmisses++;
+		}
+
+		/* the miss is queued or being read already */
+		req->waiting++;
+	}
+
+	if (req->waiting == 0)
+		rcache_done(rcache, req);
+
+	return 0;
+}
+
+/*
+ * rpma_rcache_submit -- read the queued misses coalescing the adjacent ones
+ */
+int
+rpma_rcache_submit(struct rpma_rcache *rcache)
+{
+	if (rcache == NULL)
+		return RPMA_E_INVAL;
+
+	qsort(rcache->misses, rcache->nmisses, sizeof(struct rcache_miss),
+			rcache_miss_cmp);
+
+	int ret = 0;
+	uint32_t i = 0;
+	while (i < rcache->nmisses) {
+		struct rcache_miss *m = &rcache->misses[i];
+		uint32_t n = 1;
+		while (i + n < rcache->nmisses &&
+				m[n].tag == m->tag + n &&
+				m[n].block == m->block + n &&
+				(n + 1) * rcache->block_size <= UINT32_MAX)
+			++n;
+
+		for (uint32_t j = 0; j < n; ++j)
+			rcache->blocks[m->block + j].state = RCACHE_FETCHING;
+		rcache->blocks[m->block].run = n;
+
+		/* the last block of the region may be shorter */
+		size_t offset = m->tag * rcache->block_size;
+		size_t len = n * rcache->block_size;
+		if (len > rcache->src_size - offset)
+			len = rcache->src_size - offset;
+
+		int err = rpma_read(rcache->conn, rcache->arena_mr,
+				m->block * rcache->block_size, rcache->src,
+				offset, len, RPMA_F_COMPLETION_ALWAYS,
+				&rcache->blocks[m->block]);
+		if (err) {
+			/* the requests waiting for the blocks fail */
+			rcache_complete(rcache, m->block, IBV_WC_GENERAL_ERR);
+			ret = err;
+		}
+
+		i += n;
+	}
+
+	rcache->nmisses = 0;
+
+	return ret;
+}
+
+/*
+ * rpma_rcache_validate -- read the version word of the remote memory region
+ */
+int
+rpma_rcache_validate(struct rpma_rcache *rcache)
+{
+	if (rcache == NULL)
+		return RPMA_E_INVAL;
+
+	if (rcache->validating)
+		return RPMA_E_AGAIN;
+
+	int ret = rpma_read(rcache->conn, rcache->arena_mr,
+			rcache->version_slot, rcache->src,
+			rcache->version_offset, RCACHE_VERSION_SIZE,
+			RPMA_F_COMPLETION_ALWAYS, rcache);
+	if (ret)
+		return ret;
+
+	rcache->validating = true;
+
+	return 0;
+}
+
+/*
+ * rpma_rcache_invalidate -- drop the valid blocks of the range of the remote
+ * memory region
+ */
+int
+rpma_rcache_invalidate(struct rpma_rcache *rcache, size_t src_offset,
+		size_t len)
+{
+	if (rcache == NULL || len == 0 || src_offset > rcache->src_size ||
+			len > rcache->src_size - src_offset)
+		return RPMA_E_INVAL;
+
+	rcache_drop(rcache, src_offset / rcache->block_size,
+			(src_offset + len - 1) / rcache->block_size);
+
+	return 0;
+}
+
+/*
+ * rpma_rcache_process -- consume the completion of a read of the misses
+ * or of the version word
+ */
+int
+rpma_rcache_process(struct rpma_rcache *rcache,
+		const struct rpma_completion *cmpl)
+{
+	if (rcache == NULL || cmpl == NULL)
+		return RPMA_E_INVAL;
+
+	if (cmpl->op_context == rcache) {
+		if (!rcache->validating)
+			return RPMA_E_INVAL;
+
+		rcache->validating = false;
+		if (cmpl->op_status != IBV_WC_SUCCESS)
+			return RPMA_E_PROVIDER;
+
+		uint64_t version;
+		memcpy(&version, (char *)rcache->arena + rcache->version_slot,
+				sizeof(version));
+		if (!rcache->have_version || version != rcache->version)
+			rcache_drop(rcache, 0, SIZE_MAX);
+
+		rcache->version = version;
+		rcache->have_version = true;
+
+		return 0;
+	}
+
+	uintptr_t ctx = (uintptr_t)cmpl->op_context;
+	uintptr_t base = (uintptr_t)rcache->blocks;
+	size_t block_size = sizeof(struct rcache_block);
+	uint32_t nblocks = rcache->nsets * rcache->ways;
+	if (ctx < base || ctx >= base + nblocks * block_size ||
+			(ctx - base) % block_size != 0)
+		return RPMA_E_INVAL;
+
+	uint32_t first = (uint32_t)((ctx - base) / block_size);
+	struct rcache_block *b = &rcache->blocks[first];
+	if (b->state != RCACHE_FETCHING || b->run == 0)
+		return RPMA_E_INVAL;
+
+	/* a failed read is reported by the requests waiting for it */
+	rcache_complete(rcache, first, cmpl->op_status);
+
+	return 0;
+}
+
+/*
+ * rpma_rcache_next -- get the completion of the next finished request
+ */
+int
+rpma_rcache_next(struct rpma_rcache *rcache, struct rpma_completion *cmpl)
+{
+	if (rcache == NULL || cmpl == NULL)
+		return RPMA_E_INVAL;
+
+	if (rcache->ndone == 0)
+		return RPMA_E_NO_COMPLETION;
+
+	uint32_t r = rcache->done[rcache->done_head];
+	rcache->done_head = (rcache->done_head + 1) % rcache->depth;
+	rcache->ndone--;
+
+	struct rcache_req *req = &rcache->reqs[r];
+	cmpl->op_context = (void *)(uintptr_t)req->op_context;
+	cmpl->op = RPMA_OP_READ;
+	cmpl->byte_len = 0;
+	cmpl->op_status = req->status;
+	cmpl->flags = 0;
+	cmpl->imm = 0;
+	cmpl->qp_num = 0;
+
+	rcache->free_reqs[rcache->nfree++] = r;
+
+	return 0;
+}
@@ -0,0 +1,486 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * reactor.c -- librpma event reactor
+ *
+ * The event file descriptors of the connections and the endpoints and
+ * the completion file descriptors of the connections are registered
+ * in a single epoll(7) instance. A single rpma_reactor_dispatch() call
+ * waits for all of them at once and calls the callbacks of all the sources
+ * which are ready.
+ *
+ * A completion event rearms the completion channel before the CQ is drained
+ * so no new completion can be missed. Since at most batch completions are
+ * drained from a CQ per dispatch a CQ which still may hold completions
+ * stays hot and the next dispatch drains it without waiting.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include "librpma.h"
+#include "log_internal.h"
+
+#ifdef TEST_MOCK_ALLOC
+#include "cmocka_alloc.h"
+#endif
+
+/* the maximum number of the ready sources collected by a single dispatch */
+#define REACTOR_EVENTS_MAX	16
+
+enum reactor_source_type {
+	REACTOR_CONN_EVENT,
+	REACTOR_CONN_COMPLETION,
+	REACTOR_EP,
+};
+
+struct reactor_source {
+	enum reactor_source_type type;
+	int fd;
+	void *obj; /* the connection or the endpoint */
+	union {
+		rpma_reactor_conn_event_func *conn_event;
+		rpma_reactor_completion_func *completion;
+		rpma_reactor_conn_req_func *conn_req;
+	} func;
+	void *arg;
+	const struct rpma_conn_cfg *cfg; /* for the incoming connections */
+	int hot; /* the CQ may still hold completions */
+	int removed; /* freed at the end of the dispatch */
+	struct reactor_source *next;
+};
+
+struct rpma_reactor {
+	int epfd;
+	uint32_t batch; /* completions drained from a CQ per dispatch */
+	struct reactor_source *sources;
+	uint32_t nhot; /* number of the hot sources */
+	int dispatching; /* a dispatch is in progress */
+};
+
+/*
+ * reactor_find -- find a source of the object
+ */
+static struct reactor_source *
+reactor_find(const struct rpma_reactor *reactor, const void *obj)
+{
+	for (struct reactor_source *s = reactor->sources; s; s = s->next) {
+		if (s->obj == obj && !s->removed)
+			return s;
+	}
+
+	return NULL;
+}
+
+/*
+ * reactor_add -- create a source and register its fd
+ */
+static int
+reactor_add(struct rpma_reactor *reactor, enum reactor_source_type type,
+		int fd, void *obj, void *arg)
+{
+	struct reactor_source *s = malloc(sizeof(*s));
+	if (s == NULL)
+		return RPMA_E_NOMEM;
+
+	s->type = type;
+	s->fd = fd;
+	s->obj = obj;
+	s->arg = arg;
+	s->cfg = NULL;
+	s->hot = 0;
+	s->removed = 0;
+
+	struct epoll_event event;
+	event.events = EPOLLIN;
+	event.data.ptr = s;
+	if (epoll_ctl(reactor->epfd, EPOLL_CTL_ADD, fd, &event)) {
+		RPMA_LOG_ERROR_WITH_ERRNO(errno, "epoll_ctl(EPOLL_CTL_ADD)");
+		free(s);
+		return RPMA_E_PROVIDER;
+	}
+
+	s->next = reactor->sources;
+	reactor->sources = s;
+
+	return 0;
+}
+
+/*
+ * reactor_remove -- unregister all the sources of the object
+ */
+static int
+reactor_remove(struct rpma_reactor *reactor, const void *obj)
+{
+	int found = 0;
+
+	for (struct reactor_source *s = reactor->sources; s; s = s->next) {
+		if (s->obj != obj || s->removed)
+			continue;
+
+		(void) epoll_ctl(reactor->epfd, EPOLL_CTL_DEL, s->fd, NULL);
+		if (s->hot)
+			reactor->nhot--;
+		s->hot = 0;
+		s->removed = 1;
+		found = 1;
+	}
+
+	return found ? 0 : RPMA_E_INVAL;
+}
+
+/*
+ * reactor_collect -- free the removed sources
+ */
+static void
+reactor_collect(struct rpma_reactor *reactor)
+{
+	struct reactor_source **sp = &reactor->sources;
+
+	while (*sp) {
+		struct reactor_source *s = *sp;
+		if (s->removed) {
+			*sp = s->next;
+			free(s);
+		} else {
+			sp = &s->next;
+		}
+	}
+}
+
+/*
+ * reactor_set_hot -- mark the CQ of the source as (not) holding completions
+ */
+static inline void
+reactor_set_hot(struct rpma_reactor *reactor, struct reactor_source *s,
+		int hot)
+{
+	if (s->hot == hot)
+		return;
+
+	s->hot = hot;
+	if (hot)
+		reactor->nhot++;
+	else
+		reactor->nhot--;
+}
+
+/*
+ * reactor_ready -- handle the source reported by epoll(7)
+ */
+static int
+reactor_ready(struct rpma_reactor *reactor, struct reactor_source *s,
+		uint32_t *dispatched)
+{
+	struct rpma_conn *conn = s->obj;
+	int ret;
+
+	switch (s->type) {
+	case REACTOR_CONN_EVENT: {
+		enum rpma_conn_event event;
+		ret = rpma_conn_next_event(conn, &event);
+		if (ret)
+			break;
+		s->func.conn_event(conn, event, s->arg);
+		(*dispatched)++;
+		break;
+	}
+	case REACTOR_EP: {
+		struct rpma_ep *ep = s->obj;
+		struct rpma_conn_req *req = NULL;
+		ret = rpma_ep_next_conn_req(ep, s->cfg, &req);
+		if (ret)
+			break;
+		s->func.conn_req(ep, req, s->arg);
+		(*dispatched)++;
+		break;
+	}
+	case REACTOR_CONN_COMPLETION:
+		/* collect the event and rearm the channel */
+		ret = rpma_conn_completion_wait(conn);
+		if (ret)
+			break;
+		reactor_set_hot(reactor, s, 1);
+		break;
+	default:
+		ret = RPMA_E_UNKNOWN;
+	}
+
+	/* a spurious wakeup is not an error */
+	if (ret == RPMA_E_NO_EVENT || ret == RPMA_E_NO_COMPLETION)
+		ret = 0;
+
+	return ret;
+}
+
+/*
+ * reactor_drain -- pass up to batch completions of the CQ to the callback
+ */
+static int
+reactor_drain(struct rpma_reactor *reactor, struct reactor_source *s,
+		uint32_t *dispatched)
+{
+	struct rpma_conn *conn = s->obj;
+	struct rpma_completion cmpl;
+
+	for (uint32_t i = 0; i < reactor->batch; ++i) {
+		int ret = rpma_conn_completion_get(conn, &cmpl);
+		if (ret) {
+			reactor_set_hot(reactor, s, 0);
+			return ret == RPMA_E_NO_COMPLETION ? 0 : ret;
+		}
+
+		s->func.completion(conn, &cmpl, s->arg);
+		(*dispatched)++;
+
+		/* the callback may have removed the connection */
+		if (s->removed)
+			return 0;
+	}
+
+	return 0;
+}
+
+/* public librpma API */
+
+/*
+ * rpma_reactor_new -- create an epoll(7) instance for the sources
+ */
+int
+rpma_reactor_new(uint32_t batch, struct rpma_reactor **reactor_ptr)
+{
+	if (batch == 0 || reactor_ptr == NULL)
+		return RPMA_E_INVAL;
+
+	int epfd = epoll_create1(EPOLL_CLOEXEC);
+	if (epfd < 0) {
+		RPMA_LOG_ERROR_WITH_ERRNO(errno, "epoll_create1()");
+		return RPMA_E_PROVIDER;
+	}
+
+	struct rpma_reactor *reactor = malloc(sizeof(*reactor));
+	if (reactor == NULL) {
+		(void) close(epfd);
+		return RPMA_E_NOMEM;
+	}
+
+	reactor->epfd = epfd;
+	reactor->batch = batch;
+	reactor->sources = NULL;
+	reactor->nhot = 0;
+	reactor->dispatching = 0;
+
+	*reactor_ptr = reactor;
+
+	return 0;
+}
+
+/*
+ * rpma_reactor_delete -- unregister all the sources and close the epoll(7)
+ * instance
+ */
+int
+rpma_reactor_delete(struct rpma_reactor **reactor_ptr)
+{
+	if (reactor_ptr == NULL)
+		return RPMA_E_INVAL;
+
+	struct rpma_reactor *reactor = *reactor_ptr;
+	if (reactor == NULL)
+		return 0;
+
+	if (reactor->dispatching)
+		return RPMA_E_INVAL;
+
+	/* the sources are unregistered by closing the epoll(7) instance */
+	for (struct reactor_source *s = reactor->sources; s; s = s->next)
+		s->removed = 1;
+	reactor_collect(reactor);
+
+	int ret = 0;
+	if (close(reactor->epfd)) {
+		RPMA_LOG_ERROR_WITH_ERRNO(errno, "close()");
+		ret = RPMA_E_PROVIDER;
+	}
+
+	free(reactor);
+	*reactor_ptr = NULL;
+
+	return ret;
+}
+
+/*
+ * rpma_reactor_get_fd -- get the file descriptor of the epoll(7) instance
+ */
+int
+rpma_reactor_get_fd(const struct rpma_reactor *reactor, int *fd)
+{
+	if (reactor == NULL || fd == NULL)
+		return RPMA_E_INVAL;
+
+	*fd = reactor->epfd;
+
+	return 0;
+}
+
+/*
+ * rpma_reactor_add_conn -- register the connection's event and completion
+ * file descriptors
+ */
+int
+rpma_reactor_add_conn(struct rpma_reactor *reactor, struct rpma_conn *conn,
+		rpma_reactor_conn_event_func *event_func,
+		rpma_reactor_completion_func *completion_func, void *arg)
+{
+	if (reactor == NULL || conn == NULL ||
+			(event_func == NULL && completion_func == NULL) ||
+			reactor_find(reactor, conn) != NULL)
+		return RPMA_E_INVAL;
+
+	int ret;
+	int fd;
+
+	if (event_func) {
+		(void) rpma_conn_get_event_fd(conn, &fd);
+		ret = reactor_add(reactor, REACTOR_CONN_EVENT, fd, conn, arg);
+		if (ret)
+			return ret;
+		reactor->sources->func.conn_event = event_func;
+	}
+
+	if (completion_func) {
+		(void) rpma_conn_get_completion_fd(conn, &fd);
+		ret = reactor_add(reactor, REACTOR_CONN_COMPLETION, fd, conn,
+				arg);
+		if (ret)
+			goto err_remove;
+		reactor->sources->func.completion = completion_func;
+	}
+
+	return 0;
+
+err_remove:
+	if (event_func) {
+		(void) reactor_remove(reactor, conn);
+		if (!reactor->dispatching)
+			reactor_collect(reactor);
+	}
+
+	return ret;
+}
+
+/*
+ * rpma_reactor_remove_conn -- unregister the connection
+ */
+int
+rpma_reactor_remove_conn(struct rpma_reactor *reactor,
+		const struct rpma_conn *conn)
+{
+	if (reactor == NULL || conn == NULL)
+		return RPMA_E_INVAL;
+
+	int ret = reactor_remove(reactor, conn);
+	if (ret == 0 && !reactor->dispatching)
+		reactor_collect(reactor);
+
+	return ret;
+}
+
+/*
+ * rpma_reactor_add_ep -- register the endpoint's file descriptor
+ */
+int
+rpma_reactor_add_ep(struct rpma_reactor *reactor, struct rpma_ep *ep,
+		const struct rpma_conn_cfg *cfg,
+		rpma_reactor_conn_req_func *func, void *arg)
+{
+	if (reactor == NULL || ep == NULL || func == NULL ||
+			reactor_find(reactor, ep) != NULL)
+		return RPMA_E_INVAL;
+
+	int fd;
+	(void) rpma_ep_get_fd(ep, &fd);
+	int ret = reactor_add(reactor, REACTOR_EP, fd, ep, arg);
+	if (ret)
+		return ret;
+
+	reactor->sources->func.conn_req = func;
+	reactor->sources->cfg = cfg;
+
+	return 0;
+}
+
+/*
+ * rpma_reactor_remove_ep -- unregister the endpoint
+ */
+int
+rpma_reactor_remove_ep(struct rpma_reactor *reactor,
+		const struct rpma_ep *ep)
+{
+	if (reactor == NULL || ep == NULL)
+		return RPMA_E_INVAL;
+
+	int ret = reactor_remove(reactor, ep);
+	if (ret == 0 && !reactor->dispatching)
+		reactor_collect(reactor);
+
+	return ret;
+}
+
+/*
+ * rpma_reactor_dispatch -- wait for the sources and call their callbacks
+ */
+int
+rpma_reactor_dispatch(struct rpma_reactor *reactor, int timeout_ms,
+		uint32_t *dispatched)
+{
+	if (reactor == NULL || reactor->dispatching)
+		return RPMA_E_INVAL;
+
+	struct epoll_event events[REACTOR_EVENTS_MAX];
+	uint32_t count = 0;
+
+	/* the hot CQs have to be drained without waiting */
+	int n = epoll_wait(reactor->epfd, events, REACTOR_EVENTS_MAX,
+			reactor->nhot ? 0 : timeout_ms);
+	if (n < 0) {
+		if (errno != EINTR) {
+			RPMA_LOG_ERROR_WITH_ERRNO(errno, "epoll_wait()");
+			return RPMA_E_PROVIDER;
+		}
+		n = 0;
+	}
+
+	reactor->dispatching = 1;
+
+	int ret = 0;
+	for (int i = 0; i < n; ++i) {
+		struct reactor_source *s = events[i].data.ptr;
+		if (s->removed)
+			continue;
+
+		int r = reactor_ready(reactor, s, &count);
+		if (r && ret == 0)
+			ret = r;
+	}
+
+	for (struct reactor_source *s = reactor->sources; s; s = s->next) {
+		if (!s->hot || s->removed)
+			continue;
+
+		int r = reactor_drain(reactor, s, &count);
+		if (r && ret == 0)
+			ret = r;
+	}
+
+	reactor->dispatching = 0;
+	reactor_collect(reactor);
+
+	if (dispatched)
+		*dispatched = count;
+
+	return ret;
+}
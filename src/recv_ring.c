@@ -0,0 +1,291 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * recv_ring.c -- librpma self-replenishing receive buffer ring
+ *
+ * The ring registers a single slab split into fixed-size slots and keeps
+ * all the slots posted as receives. The work requests are prepared once
+ * when the ring is created so re-posting the released slots comes down to
+ * linking them into a chain posted with a single ibv_post_recv(3) or
+ * ibv_post_srq_recv(3) call.
+ */
+
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "conn.h"
+#include "log_internal.h"
+#include "mr.h"
+#include "srq.h"
+#include "trace.h"
+
+#ifdef TEST_MOCK_ALLOC
+#include "cmocka_alloc.h"
+#endif
+
+struct rpma_recv_ring {
+	struct ibv_qp *qp; /* QP of the connection (or NULL) */
+	struct ibv_srq *srq; /* shared receive queue (or NULL) */
+
+	void *slab; /* the receive buffers */
+	size_t mmap_size; /* size of the mmap()'ed slab */
+	struct rpma_mr_local *mr; /* registration of the slab */
+
+	uint32_t slots; /* number of slots */
+	size_t slot_size; /* size of a single slot */
+	uint32_t batch; /* number of released slots re-posted at once */
+
+	struct ibv_recv_wr *wrs; /* prepared work requests (one per slot) */
+	struct ibv_sge *sges; /* prepared SGEs (one per slot) */
+	uint32_t *released; /* slots waiting to be re-posted */
+	uint32_t nreleased; /* number of slots waiting to be re-posted */
+	bool *delivered; /* the slot is held by the application */
+};
+
+/*
+ * recv_ring_post -- post the chain of the released slots. If the provider
+ * rejects a part of the chain the rejected slots stay released so posting
+ * them can be retried. If the provider does not point out the first
+ * rejected work request none of the slots stays released since posting
+ * any of them twice is worse than losing them.
+ */
+static int
+recv_ring_post(struct rpma_recv_ring *ring)
+{
+	uint32_t n = ring->nreleased;
+	if (n == 0)
+		return 0;
+
+	for (uint32_t i = 0; i < n; ++i) {
+		struct ibv_recv_wr *wr = &ring->wrs[ring->released[i]];
+		wr->next = (i + 1 < n) ? &ring->wrs[ring->released[i + 1]] :
+				NULL;
+	}
+
+	struct ibv_recv_wr *first = &ring->wrs[ring->released[0]];
+	struct ibv_recv_wr *bad_wr = NULL;
+	int ret;
+	RPMA_TRACE(recv_chain, ring->qp, ring->srq, first->wr_id, n);
+	if (ring->srq)
+		ret = ibv_post_srq_recv(ring->srq, first, &bad_wr);
+	else
+		ret = ibv_post_recv(ring->qp, first, &bad_wr);
+
+	if (ret == 0) {
+		ring->nreleased = 0;
+		return 0;
+	}
+
+	RPMA_LOG_ERROR_WITH_ERRNO(ret, ring->srq ?
+			"ibv_post_srq_recv" : "ibv_post_recv");
+
+	/* keep the slots which have not been posted */
+	uint32_t posted = 0;
+	while (posted < n && &ring->wrs[ring->released[posted]] != bad_wr)
+		++posted;
+
+	if (posted == n) {
+		RPMA_LOG_ERROR("bad_wr does not point to any of the %" PRIu32
+			" posted receives - assuming all of them are posted",
+			n);
+		ring->nreleased = 0;
+	} else if (posted > 0) {
+		memmove(ring->released, ring->released + posted,
+			(n - posted) * sizeof(uint32_t));
+		ring->nreleased = n - posted;
+	}
+
+	return RPMA_E_PROVIDER;
+}
+
+/* public librpma API */
+
+/*
+ * rpma_recv_ring_new -- allocate and register a slab of receive buffers
+ * and post all of them to the connection or to the shared receive queue
+ */
+int
+rpma_recv_ring_new(struct rpma_peer *peer, struct rpma_conn *conn,
+		struct rpma_srq *srq, uint32_t slots, size_t slot_size,
+		uint32_t batch, struct rpma_recv_ring **ring_ptr)
+{
+	if (peer == NULL || (conn == NULL) == (srq == NULL) || slots == 0 ||
+			slot_size == 0 || slot_size > UINT32_MAX ||
+			batch == 0 || batch > slots || ring_ptr == NULL)
+		return RPMA_E_INVAL;
+
+	if (slot_size > SIZE_MAX / slots)
+		return RPMA_E_INVAL;
+
+	struct ibv_qp *qp = NULL;
+	struct ibv_srq *ibv_srq = NULL;
+	int ret;
+	if (conn) {
+		ret = rpma_conn_get_ibv_qp(conn, &qp);
+		if (ret)
+			return ret;
+	} else {
+		ibv_srq = rpma_srq_get_ibv_srq(srq);
+	}
+
+	void *slab = NULL;
+	size_t mmap_size = 0;
+	struct rpma_mr_local *mr = NULL;
+	ret = rpma_mr_slab_new(peer, slots * slot_size, RPMA_MR_USAGE_RECV,
+			&slab, &mmap_size, &mr);
+	if (ret)
+		return ret;
+
+	struct rpma_recv_ring *ring = malloc(sizeof(*ring));
+	if (ring == NULL) {
+		ret = RPMA_E_NOMEM;
+		goto err_mr_dereg;
+	}
+
+	/* all the per-slot arrays share a single allocation */
+	size_t per_slot = sizeof(struct ibv_recv_wr) + sizeof(struct ibv_sge) +
+			sizeof(uint32_t) + sizeof(bool);
+	char *arrays = malloc(slots * per_slot);
+	if (arrays == NULL) {
+		ret = RPMA_E_NOMEM;
+		goto err_free_ring;
+	}
+
+	ring->qp = qp;
+	ring->srq = ibv_srq;
+	ring->slab = slab;
+	ring->mmap_size = mmap_size;
+	ring->mr = mr;
+	ring->slots = slots;
+	ring->slot_size = slot_size;
+	ring->batch = batch;
+	ring->wrs = (struct ibv_recv_wr *)arrays;
+	ring->sges = (struct ibv_sge *)(ring->wrs + slots);
+	ring->released = (uint32_t *)(ring->sges + slots);
+	ring->delivered = (bool *)(ring->released + slots);
+
+	for (uint32_t i = 0; i < slots; ++i) {
+		rpma_mr_recv_wr(&ring->wrs[i], &ring->sges[i], mr,
+				i * slot_size, slot_size, &ring->wrs[i]);
+		ring->released[i] = i;
+		ring->delivered[i] = false;
+	}
+	ring->nreleased = slots;
+
+	/*
+	 * the initial post of all the slots
+	 *
+	 * The ring can be released only if none of the slots has been
+	 * posted. Otherwise the posted receives point to it so the ring
+	 * is kept and the rest of the slots stays released.
+	 */
+	ret = recv_ring_post(ring);
+	if (ret && ring->nreleased == slots)
+		goto err_free_arrays;
+
+	*ring_ptr = ring;
+
+	return 0;
+
+err_free_arrays:
+	free(arrays);
+
+err_free_ring:
+	free(ring);
+
+err_mr_dereg:
+	(void) rpma_mr_slab_delete(&mr, slab, mmap_size);
+
+	return ret;
+}
+
+/*
+ * rpma_recv_ring_delete -- deregister and free the receive buffers
+ */
+int
+rpma_recv_ring_delete(struct rpma_recv_ring **ring_ptr)
+{
+	if (ring_ptr == NULL)
+		return RPMA_E_INVAL;
+
+	struct rpma_recv_ring *ring = *ring_ptr;
+	if (ring == NULL)
+		return 0;
+
+	int ret = rpma_mr_slab_delete(&ring->mr, ring->slab, ring->mmap_size);
+
+	free(ring->wrs);
+	free(ring);
+	*ring_ptr = NULL;
+
+	return ret;
+}
+
+/*
+ * rpma_recv_ring_get_msg -- translate the receive completion into a view
+ * of the received message
+ */
+int
+rpma_recv_ring_get_msg(struct rpma_recv_ring *ring,
+		const struct rpma_completion *cmpl, struct rpma_recv_msg *msg)
+{
+	if (ring == NULL || cmpl == NULL || msg == NULL)
+		return RPMA_E_INVAL;
+
+	/* the op_context of every slot points to its work request */
+	uintptr_t ctx = (uintptr_t)cmpl->op_context;
+	uintptr_t base = (uintptr_t)ring->wrs;
+	size_t wr_size = sizeof(struct ibv_recv_wr);
+	if (ctx < base || ctx >= base + ring->slots * wr_size ||
+			(ctx - base) % wr_size != 0)
+		return RPMA_E_INVAL;
+
+	uint32_t slot = (uint32_t)((ctx - base) / wr_size);
+	ring->delivered[slot] = true;
+
+	msg->ptr = (char *)ring->slab + slot * ring->slot_size;
+	msg->len = cmpl->byte_len;
+	msg->imm = cmpl->imm;
+	msg->flags = cmpl->flags;
+	msg->qp_num = cmpl->qp_num;
+	msg->slot = slot;
+
+	return 0;
+}
+
+/*
+ * rpma_recv_ring_release -- give the slot of the message back to the ring
+ * and re-post the released slots if there are enough of them
+ */
+int
+rpma_recv_ring_release(struct rpma_recv_ring *ring,
+		const struct rpma_recv_msg *msg)
+{
+	if (ring == NULL || msg == NULL || msg->slot >= ring->slots ||
+			!ring->delivered[msg->slot])
+		return RPMA_E_INVAL;
+
+	ring->delivered[msg->slot] = false;
+	ring->released[ring->nreleased++] = msg->slot;
+
+	if (ring->nreleased < ring->batch)
+		return 0;
+
+	return recv_ring_post(ring);
+}
+
+/*
+ * rpma_recv_ring_repost -- re-post all the released slots regardless
+ * of the batch size
+ */
+int
+rpma_recv_ring_repost(struct rpma_recv_ring *ring)
+{
+	if (ring == NULL)
+		return RPMA_E_INVAL;
+
+	return recv_ring_post(ring);
+}
@@ -0,0 +1,429 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * repl.c -- librpma replication groups
+ *
+ * A replicated write is posted as a write followed by a flush to each member
+ * of the group. Only the flushes report their success so every member
+ * acknowledges the write by a single completion. The write is finished
+ * as soon as the quorum of the members have flushed it (or so many of them
+ * have failed that the quorum cannot be reached) but its slot is kept until
+ * all the members have completed it since the completions of the slower
+ * members still point to it. The writes are finished in the order they have
+ * been initiated.
+ *
+ * If the flush cannot be posted after the write has been posted the member
+ * fails the replicated write at once but its slot is kept until the write
+ * is known to be completed: either by its own error completion or by any
+ * later completion of the member since the completions of a connection come
+ * in the order of posting.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "librpma.h"
+
+#ifdef TEST_MOCK_ALLOC
+#include "cmocka_alloc.h"
+#endif
+
+enum repl_ack_state {
+	REPL_ACK_IDLE,
+	REPL_ACK_PENDING, /* the flush of the member is in flight */
+	REPL_ACK_WRITE_FAILED, /* the write of the member has failed */
+	REPL_ACK_UNFLUSHED, /* the write has been posted without its flush */
+};
+
+/* the write and the flush of a member point to its state */
+#define REPL_ACK_SIZE	2
+
+struct repl_member {
+	struct rpma_conn *conn;
+	struct rpma_mr_remote *dst;
+	uint32_t pending; /* number of the writes the member has not flushed */
+	uint32_t unflushed; /* number of the writes posted without flushes */
+};
+
+struct repl_op {
+	uint32_t acked; /* number of the members which have flushed the write */
+	uint32_t failed; /* number of the members which have failed */
+	uint32_t pending; /* number of the members still completing the write */
+	enum ibv_wc_status status; /* status of the first failed member */
+	const void *op_context; /* the op_context of the caller */
+	int withdrawn; /* the write has failed to be initiated */
+};
+
+struct rpma_repl {
+	struct repl_member *members;
+	uint32_t nmembers;
+	uint32_t quorum; /* number of the members which have to flush */
+
+	struct repl_op *ops; /* FIFO of the replicated writes */
+	uint8_t *acks; /* the states of the members of each write */
+	uint32_t depth; /* capacity of the FIFO */
+	uint32_t head; /* the oldest write */
+	uint32_t num; /* number of the writes */
+	uint32_t reported; /* number of the writes reported by next() */
+};
+
+/*
+ * repl_op_at -- get the write of the given position in the FIFO
+ */
+static inline struct repl_op *
+repl_op_at(const struct rpma_repl *repl, uint32_t pos)
+{
+	return &repl->ops[(repl->head + pos) % repl->depth];
+}
+
+/*
+ * repl_finished -- check if the write has got its quorum or it cannot get it
+ * anymore
+ */
+static inline int
+repl_finished(const struct rpma_repl *repl, const struct repl_op *op)
+{
+	return op->acked >= repl->quorum ||
+		op->failed > repl->nmembers - repl->quorum;
+}
+
+/*
+ * repl_fail -- note the failure of the member
+ */
+static inline void
+repl_fail(struct repl_op *op, enum ibv_wc_status status)
+{
+	if (op->status == IBV_WC_SUCCESS)
+		op->status = status;
+	op->failed++;
+}
+
+/*
+ * repl_ack_of -- get the state of the member of the write in the slot
+ */
+static inline uint8_t *
+repl_ack_of(const struct rpma_repl *repl, uint32_t slot, uint32_t member)
+{
+	return &repl->acks[(slot * repl->nmembers + member) * REPL_ACK_SIZE];
+}
+
+/*
+ * repl_release_unflushed -- release the writes of the member posted without
+ * their flushes before the given position of the FIFO
+ */
+static void
+repl_release_unflushed(struct rpma_repl *repl, uint32_t member, uint32_t pos)
+{
+	struct repl_member *m = &repl->members[member];
+
+	for (uint32_t p = 0; p < pos && m->unflushed > 0; ++p) {
+		uint32_t slot = (repl->head + p) % repl->depth;
+		uint8_t *ack = repl_ack_of(repl, slot, member);
+		if (*ack != REPL_ACK_UNFLUSHED)
+			continue;
+
+		*ack = REPL_ACK_IDLE;
+		m->unflushed--;
+		m->pending--;
+		repl->ops[slot].pending--;
+	}
+}
+
+/*
+ * repl_reclaim -- release the slots of the reported writes completed
+ * by all the members
+ */
+static void
+repl_reclaim(struct rpma_repl *repl)
+{
+	/* the withdrawn writes are never reported */
+	while (repl->reported < repl->num &&
+			repl_op_at(repl, repl->reported)->withdrawn)
+		repl->reported++;
+
+	while (repl->reported > 0 && repl_op_at(repl, 0)->pending == 0) {
+		repl->head = (repl->head + 1) % repl->depth;
+		repl->num--;
+		repl->reported--;
+	}
+}
+
+/* public librpma API */
+
+/*
+ * rpma_repl_new -- create a new replication group
+ */
+int
+rpma_repl_new(struct rpma_conn *const *conns,
+		struct rpma_mr_remote *const *dsts, uint32_t members,
+		uint32_t quorum, uint32_t depth, struct rpma_repl **repl_ptr)
+{
+	if (conns == NULL || dsts == NULL || repl_ptr == NULL ||
+			members == 0 || quorum == 0 || quorum > members ||
+			depth == 0 ||
+			members > UINT32_MAX / REPL_ACK_SIZE / depth)
+		return RPMA_E_INVAL;
+
+	for (uint32_t i = 0; i < members; ++i) {
+		if (conns[i] == NULL || dsts[i] == NULL)
+			return RPMA_E_INVAL;
+	}
+
+	struct rpma_repl *repl = malloc(sizeof(*repl));
+	if (repl == NULL)
+		return RPMA_E_NOMEM;
+
+	/* all the arrays share a single allocation */
+	char *arrays = malloc(members * sizeof(struct repl_member) +
+			depth * sizeof(struct repl_op) +
+			(size_t)depth * members * REPL_ACK_SIZE);
+	if (arrays == NULL) {
+		free(repl);
+		return RPMA_E_NOMEM;
+	}
+
+	repl->members = (struct repl_member *)arrays;
+	repl->ops = (struct repl_op *)(repl->members + members);
+	repl->acks = (uint8_t *)(repl->ops + depth);
+
+	for (uint32_t i = 0; i < members; ++i) {
+		repl->members[i].conn = conns[i];
+		repl->members[i].dst = dsts[i];
+		repl->members[i].pending = 0;
+		repl->members[i].unflushed = 0;
+	}
+
+	for (uint32_t i = 0; i < depth * members; ++i)
+		repl->acks[i * REPL_ACK_SIZE] = REPL_ACK_IDLE;
+
+	repl->nmembers = members;
+	repl->quorum = quorum;
+	repl->depth = depth;
+	repl->head = 0;
+	repl->num = 0;
+	repl->reported = 0;
+
+	*repl_ptr = repl;
+
+	return 0;
+}
+
+/*
+ * rpma_repl_delete -- delete the replication group
+ */
+int
+rpma_repl_delete(struct rpma_repl **repl_ptr)
+{
+	if (repl_ptr == NULL)
+		return RPMA_E_INVAL;
+
+	struct rpma_repl *repl = *repl_ptr;
+	if (repl == NULL)
+		return 0;
+
+	free(repl->members);
+	free(repl);
+	*repl_ptr = NULL;
+
+	return 0;
+}
+
+/*
+ * rpma_repl_write -- post the write and the flush to all the members
+ * of the group
+ */
+int
+rpma_repl_write(struct rpma_repl *repl, size_t dst_offset,
+		const struct rpma_mr_local *src, size_t src_offset, size_t len,
+		enum rpma_flush_type type, const void *op_context)
+{
+	if (repl == NULL || src == NULL || len == 0)
+		return RPMA_E_INVAL;
+
+	if (repl->num == repl->depth)
+		return RPMA_E_AGAIN;
+
+	uint32_t slot = (repl->head + repl->num) % repl->depth;
+	struct repl_op *op = &repl->ops[slot];
+	op->acked = 0;
+	op->failed = 0;
+	op->pending = 0;
+	op->status = IBV_WC_SUCCESS;
+	op->op_context = op_context;
+	op->withdrawn = 0;
+
+	/*
+	 * the completions of the write and the flush point to the first
+	 * and the second byte of the state of the member respectively
+	 */
+	uint32_t flushing = 0;
+	int ret = 0;
+	for (uint32_t i = 0; i < repl->nmembers; ++i) {
+		struct repl_member *m = &repl->members[i];
+		uint8_t *ack = repl_ack_of(repl, slot, i);
+		int err = rpma_write(m->conn, m->dst, dst_offset, src,
+				src_offset, len, RPMA_F_COMPLETION_ON_ERROR,
+				ack);
+		if (err) {
+			repl_fail(op, IBV_WC_GENERAL_ERR);
+			ret = err;
+			continue;
+		}
+
+		err = rpma_flush(m->conn, m->dst, dst_offset, len, type,
+				RPMA_F_COMPLETION_ALWAYS, ack + 1);
+		if (err) {
+			/* the write may still complete pointing to its state */
+			repl_fail(op, IBV_WC_GENERAL_ERR);
+			ret = err;
+			*ack = REPL_ACK_UNFLUSHED;
+			m->unflushed++;
+		} else {
+			*ack = REPL_ACK_PENDING;
+			flushing++;
+		}
+
+		m->pending++;
+		op->pending++;
+	}
+
+	/* the write which has not been flushed by any member is withdrawn */
+	if (flushing == 0) {
+		/* its slot is kept until its writes are completed */
+		if (op->pending > 0) {
+			op->withdrawn = 1;
+			repl->num++;
+		}
+
+		return ret;
+	}
+
+	/* the failures will be reported via the completion of the write */
+	repl->num++;
+
+	return 0;
+}
+
+/*
+ * rpma_repl_process -- consume the completion of a member
+ */
+int
+rpma_repl_process(struct rpma_repl *repl, const struct rpma_completion *cmpl)
+{
+	if (repl == NULL || cmpl == NULL)
+		return RPMA_E_INVAL;
+
+	uintptr_t ctx = (uintptr_t)cmpl->op_context;
+	uintptr_t base = (uintptr_t)repl->acks;
+	if (ctx < base || ctx >= base +
+			repl->depth * repl->nmembers * REPL_ACK_SIZE)
+		return RPMA_E_INVAL;
+
+	uint32_t idx = (uint32_t)(ctx - base) / REPL_ACK_SIZE;
+	uint8_t *ack = &repl->acks[idx * REPL_ACK_SIZE];
+	if (*ack == REPL_ACK_IDLE ||
+			(*ack == REPL_ACK_UNFLUSHED && (uint8_t *)ctx != ack))
+		return RPMA_E_INVAL;
+
+	uint32_t slot = idx / repl->nmembers;
+	uint32_t member = idx % repl->nmembers;
+	struct repl_op *op = &repl->ops[slot];
+
+	uint32_t pos = (slot + repl->depth - repl->head) % repl->depth;
+
+	/* the failure of the write without its flush is already counted */
+	if (*ack == REPL_ACK_UNFLUSHED) {
+		repl_release_unflushed(repl, member, pos + 1);
+		repl_reclaim(repl);
+		return 0;
+	}
+
+	/* the writes of the member posted earlier have been completed */
+	repl_release_unflushed(repl, member, pos);
+
+	/*
+	 * only the failed write completes; the flush following it will fail
+	 * too so the member is done when its flush completes
+	 */
+	if ((uint8_t *)ctx == ack) {
+		if (*ack == REPL_ACK_PENDING) {
+			*ack = REPL_ACK_WRITE_FAILED;
+			if (op->status == IBV_WC_SUCCESS)
+				op->status = cmpl->op_status;
+		}
+		return 0;
+	}
+
+	if (*ack == REPL_ACK_WRITE_FAILED)
+		op->failed++;
+	else if (cmpl->op_status != IBV_WC_SUCCESS)
+		repl_fail(op, cmpl->op_status);
+	else
+		op->acked++;
+
+	*ack = REPL_ACK_IDLE;
+	repl->members[member].pending--;
+	op->pending--;
+
+	repl_reclaim(repl);
+
+	return 0;
+}
+
+/*
+ * rpma_repl_next -- get the completion of the oldest write if it has been
+ * finished
+ */
+int
+rpma_repl_next(struct rpma_repl *repl, struct rpma_completion *cmpl)
+{
+	if (repl == NULL || cmpl == NULL)
+		return RPMA_E_INVAL;
+
+	/* skip the withdrawn writes */
+	repl_reclaim(repl);
+
+	if (repl->reported == repl->num)
+		return RPMA_E_NO_COMPLETION;
+
+	struct repl_op *op = repl_op_at(repl, repl->reported);
+	if (!repl_finished(repl, op))
+		return RPMA_E_NO_COMPLETION;
+
+	cmpl->op_context = (void *)(uintptr_t)op->op_context;
+	cmpl->op = RPMA_OP_FLUSH;
+	cmpl->byte_len = 0;
+	cmpl->op_status = op->acked >= repl->quorum ?
+			IBV_WC_SUCCESS : op->status;
+	cmpl->flags = 0;
+	cmpl->imm = 0;
+	cmpl->qp_num = 0;
+
+	repl->reported++;
+	repl_reclaim(repl);
+
+	return 0;
+}
+
+/*
+ * rpma_repl_get_slowest -- get the member with the most writes not flushed
+ */
+int
+rpma_repl_get_slowest(const struct rpma_repl *repl, uint32_t *member,
+		uint32_t *behind)
+{
+	if (repl == NULL || member == NULL || behind == NULL)
+		return RPMA_E_INVAL;
+
+	uint32_t slowest = 0;
+	for (uint32_t i = 1; i < repl->nmembers; ++i) {
+		if (repl->members[i].pending > repl->members[slowest].pending)
+			slowest = i;
+	}
+
+	*member = slowest;
+	*behind = repl->members[slowest].pending;
+
+	return 0;
+}
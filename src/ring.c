@@ -0,0 +1,360 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * ring.c -- librpma submission and completion rings
+ *
+ * The application fills the operation descriptors directly in the submission
+ * ring. rpma_ring_submit() translates all the descriptors filled so far into
+ * a chain of work requests and posts the chain with a single ibv_post_send(3)
+ * call. The work requests and their scatter-gather elements are allocated
+ * once for the whole ring so a submission does not allocate anything.
+ *
+ * The completion ring is refilled only when it is empty using a single
+ * ibv_poll_cq(3) call collecting up to the size of the ring so the completions
+ * handed over to the application are always contiguous.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "conn.h"
+#include "cq.h"
+#include "log_internal.h"
+#include "mr.h"
+#include "trace.h"
+
+#ifdef TEST_MOCK_ALLOC
+#include "cmocka_alloc.h"
+#endif
+
+/* the maximum number of the entries of each of the rings */
+#define RING_ENTRIES_MAX	(1U << 16)
+
+struct rpma_ring {
+	struct rpma_conn *conn;
+	struct ibv_qp *qp;
+	struct rpma_cq *cq;
+
+	/* the submission ring */
+	struct rpma_ring_sqe *sqes;
+	uint32_t sq_mask; /* the size of the submission ring - 1 */
+	uint32_t sq_head; /* the oldest descriptor not submitted yet */
+	uint32_t sq_tail; /* the next descriptor to be handed out */
+	struct ibv_send_wr *wrs; /* the chain being posted */
+	struct ibv_sge *sges;
+
+	/* the completion ring */
+	struct rpma_completion *cqes;
+	struct ibv_wc *wcs;
+	uint32_t cq_size;
+	uint32_t cq_head; /* the oldest completion not consumed yet */
+	uint32_t cq_num; /* number of the completions not consumed yet */
+};
+
+/*
+ * ring_sqe_to_wr -- validate the descriptor and translate it into
+ * the work request
+ */
+static int
+ring_sqe_to_wr(const struct rpma_ring_sqe *sqe, struct ibv_send_wr *wr,
+		struct ibv_sge *sge)
+{
+	if (sqe->flags == 0 || sqe->len > UINT32_MAX)
+		return RPMA_E_INVAL;
+
+	switch (sqe->opcode) {
+	case RPMA_RING_OP_READ:
+	case RPMA_RING_OP_WRITE:
+	case RPMA_RING_OP_WRITE_WITH_IMM:
+		if ((sqe->local == NULL || sqe->remote == NULL) &&
+				(sqe->local != NULL || sqe->remote != NULL ||
+				sqe->local_offset != 0 ||
+				sqe->remote_offset != 0 || sqe->len != 0))
+			return RPMA_E_INVAL;
+		break;
+	case RPMA_RING_OP_SEND:
+	case RPMA_RING_OP_SEND_WITH_IMM:
+		if (sqe->local == NULL &&
+				(sqe->local_offset != 0 || sqe->len != 0))
+			return RPMA_E_INVAL;
+		break;
+	default:
+		return RPMA_E_INVAL;
+	}
+
+	switch (sqe->opcode) {
+	case RPMA_RING_OP_READ:
+		rpma_mr_read_wr(wr, sge, sqe->local, sqe->local_offset,
+				sqe->remote, sqe->remote_offset, sqe->len,
+				sqe->flags, sqe->user_data);
+		return 0;
+	case RPMA_RING_OP_WRITE:
+		return rpma_mr_write_wr(wr, sge, sqe->remote,
+				sqe->remote_offset, sqe->local,
+				sqe->local_offset, sqe->len, sqe->flags,
+				IBV_WR_RDMA_WRITE, 0, sqe->user_data, false);
+	case RPMA_RING_OP_WRITE_WITH_IMM:
+		return rpma_mr_write_wr(wr, sge, sqe->remote,
+				sqe->remote_offset, sqe->local,
+				sqe->local_offset, sqe->len, sqe->flags,
+				IBV_WR_RDMA_WRITE_WITH_IMM, sqe->imm,
+				sqe->user_data, false);
+	case RPMA_RING_OP_SEND:
+		return rpma_mr_send_wr(wr, sge, sqe->local, sqe->local_offset,
+				sqe->len, sqe->flags, IBV_WR_SEND, 0,
+				sqe->user_data);
+	default:
+		return rpma_mr_send_wr(wr, sge, sqe->local, sqe->local_offset,
+				sqe->len, sqe->flags, IBV_WR_SEND_WITH_IMM,
+				sqe->imm, sqe->user_data);
+	}
+}
+
+/* public librpma API */
+
+/*
+ * rpma_ring_new -- create the submission and completion rings of
+ * the connection
+ */
+int
+rpma_ring_new(struct rpma_conn *conn, uint32_t sq_entries,
+		uint32_t cq_entries, struct rpma_ring **ring_ptr)
+{
+	if (conn == NULL || ring_ptr == NULL || sq_entries == 0 ||
+			sq_entries > RING_ENTRIES_MAX ||
+			cq_entries == 0 || cq_entries > RING_ENTRIES_MAX)
+		return RPMA_E_INVAL;
+
+	struct ibv_qp *qp;
+	int ret = rpma_conn_get_ibv_qp(conn, &qp);
+	if (ret)
+		return ret;
+
+	struct rpma_cq *cq;
+	ret = rpma_conn_get_cq(conn, &cq);
+	if (ret)
+		return ret;
+
+	/* the submission ring is indexed using a mask */
+	uint32_t sq_size = 1;
+	while (sq_size < sq_entries)
+		sq_size <<= 1;
+
+	struct rpma_ring *ring = malloc(sizeof(*ring));
+	if (ring == NULL)
+		return RPMA_E_NOMEM;
+
+	ring->sqes = malloc(sq_size * sizeof(*ring->sqes));
+	if (ring->sqes == NULL) {
+		ret = RPMA_E_NOMEM;
+		goto err_free_ring;
+	}
+
+	ring->wrs = malloc(sq_size * sizeof(*ring->wrs));
+	if (ring->wrs == NULL) {
+		ret = RPMA_E_NOMEM;
+		goto err_free_sqes;
+	}
+
+	ring->sges = malloc(sq_size * sizeof(*ring->sges));
+	if (ring->sges == NULL) {
+		ret = RPMA_E_NOMEM;
+		goto err_free_wrs;
+	}
+
+	ring->cqes = malloc(cq_entries * sizeof(*ring->cqes));
+	if (ring->cqes == NULL) {
+		ret = RPMA_E_NOMEM;
+		goto err_free_sges;
+	}
+
+	ring->wcs = malloc(cq_entries * sizeof(*ring->wcs));
+	if (ring->wcs == NULL) {
+		ret = RPMA_E_NOMEM;
+		goto err_free_cqes;
+	}
+
+	ring->conn = conn;
+	ring->qp = qp;
+	ring->cq = cq;
+	ring->sq_mask = sq_size - 1;
+	ring->sq_head = 0;
+	ring->sq_tail = 0;
+	ring->cq_size = cq_entries;
+	ring->cq_head = 0;
+	ring->cq_num = 0;
+
+	*ring_ptr = ring;
+
+	return 0;
+
+err_free_cqes:
+	free(ring->cqes);
+
+err_free_sges:
+	free(ring->sges);
+
+err_free_wrs:
+	free(ring->wrs);
+
+err_free_sqes:
+	free(ring->sqes);
+
+err_free_ring:
+	free(ring);
+
+	return ret;
+}
+
+/*
+ * rpma_ring_delete -- delete the rings
+ */
+int
+rpma_ring_delete(struct rpma_ring **ring_ptr)
+{
+	if (ring_ptr == NULL)
+		return RPMA_E_INVAL;
+
+	struct rpma_ring *ring = *ring_ptr;
+	if (ring == NULL)
+		return 0;
+
+	free(ring->wcs);
+	free(ring->cqes);
+	free(ring->sges);
+	free(ring->wrs);
+	free(ring->sqes);
+	free(ring);
+	*ring_ptr = NULL;
+
+	return 0;
+}
+
+/*
+ * rpma_ring_get_sqe -- hand out the next free descriptor of the submission
+ * ring
+ */
+int
+rpma_ring_get_sqe(struct rpma_ring *ring, struct rpma_ring_sqe **sqe_ptr)
+{
+	if (ring == NULL || sqe_ptr == NULL)
+		return RPMA_E_INVAL;
+
+	if (ring->sq_tail - ring->sq_head > ring->sq_mask)
+		return RPMA_E_AGAIN;
+
+	*sqe_ptr = &ring->sqes[ring->sq_tail++ & ring->sq_mask];
+
+	return 0;
+}
+
+/*
+ * rpma_ring_submit -- post all the descriptors handed out so far as
+ * a single chain of work requests
+ */
+int
+rpma_ring_submit(struct rpma_ring *ring, uint32_t *submitted)
+{
+	if (ring == NULL)
+		return RPMA_E_INVAL;
+
+	uint32_t num = ring->sq_tail - ring->sq_head;
+	uint32_t first_read = UINT32_MAX;
+	uint32_t n;
+	int ret = 0;
+
+	for (n = 0; n < num; ++n) {
+		const struct rpma_ring_sqe *sqe =
+			&ring->sqes[(ring->sq_head + n) & ring->sq_mask];
+		ret = ring_sqe_to_wr(sqe, &ring->wrs[n], &ring->sges[n]);
+		if (ret)
+			break;
+
+		if (sqe->opcode == RPMA_RING_OP_READ && first_read > n)
+			first_read = n;
+
+		if (n > 0)
+			ring->wrs[n - 1].next = &ring->wrs[n];
+	}
+
+	uint32_t posted = n;
+	if (n > 0) {
+		ring->wrs[n - 1].next = NULL;
+
+		struct ibv_send_wr *bad_wr = NULL;
+		RPMA_TRACE(post_chain, ring->qp, ring->wrs[0].wr_id, n);
+		int err = ibv_post_send(ring->qp, &ring->wrs[0], &bad_wr);
+		if (err) {
+			RPMA_LOG_ERROR_WITH_ERRNO(err,
+				"ibv_post_send(chain of %u work requests)", n);
+			/*
+			 * The work requests preceding bad_wr have been posted.
+			 * The remaining descriptors stay in the ring.
+			 */
+			posted = bad_wr ? (uint32_t)(bad_wr - ring->wrs) : 0;
+			ret = RPMA_E_PROVIDER;
+		}
+	}
+
+	/* the next atomic write has to be fenced after the posted reads */
+	if (first_read < posted)
+		rpma_conn_reads_posted(ring->conn);
+
+	ring->sq_head += posted;
+
+	/* an invalid descriptor is dropped */
+	if (ret == RPMA_E_INVAL)
+		ring->sq_head++;
+
+	if (submitted)
+		*submitted = posted;
+
+	return ret;
+}
+
+/*
+ * rpma_ring_peek_cqes -- get the completions collected in the completion
+ * ring refilling it if it is empty
+ */
+int
+rpma_ring_peek_cqes(struct rpma_ring *ring, struct rpma_completion **cqes_ptr,
+		uint32_t *num)
+{
+	if (ring == NULL || cqes_ptr == NULL || num == NULL)
+		return RPMA_E_INVAL;
+
+	int ret = 0;
+	if (ring->cq_num == 0) {
+		int n = 0;
+		ret = rpma_cq_get_completions(ring->cq, ring->wcs, ring->cqes,
+				(int)ring->cq_size, &n);
+		ring->cq_head = 0;
+		ring->cq_num = (uint32_t)n;
+		/* the supported completions are handed over anyway */
+		if (ret == RPMA_E_NOSUPP && n > 0)
+			ret = 0;
+		if (ret)
+			return ret;
+	}
+
+	*cqes_ptr = &ring->cqes[ring->cq_head];
+	*num = ring->cq_num;
+
+	return 0;
+}
+
+/*
+ * rpma_ring_cq_advance -- mark the completions as consumed
+ */
+int
+rpma_ring_cq_advance(struct rpma_ring *ring, uint32_t num)
+{
+	if (ring == NULL || num > ring->cq_num)
+		return RPMA_E_INVAL;
+
+	ring->cq_head += num;
+	ring->cq_num -= num;
+
+	return 0;
+}
@@ -0,0 +1,174 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * srq.c -- librpma shared-receive-queue-related implementations
+ */
+
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+
+#include "cq.h"
+#include "log_internal.h"
+#include "mr.h"
+#include "peer.h"
+#include "srq.h"
+
+#ifdef TEST_MOCK_ALLOC
+#include "cmocka_alloc.h"
+#endif
+
+struct rpma_srq {
+	struct ibv_srq *srq; /* shared receive queue */
+	struct rpma_cq *rcq; /* CQ of the receives of all attached QPs */
+};
+
+/* internal librpma API */
+
+/*
+ * rpma_srq_get_ibv_srq -- get the SRQ member from the rpma_srq object
+ */
+struct ibv_srq *
+rpma_srq_get_ibv_srq(const struct rpma_srq *srq)
+{
+	return srq->srq;
+}
+
+/*
+ * rpma_srq_get_rcq -- get the receive CQ from the rpma_srq object
+ */
+struct rpma_cq *
+rpma_srq_get_rcq(const struct rpma_srq *srq)
+{
+	return srq->rcq;
+}
+
+/* public librpma API */
+
+/*
+ * rpma_srq_new -- create a new shared receive queue object together with
+ * the CQ collecting completions of the receives posted to it
+ */
+int
+rpma_srq_new(struct rpma_peer *peer, uint32_t size,
+		struct rpma_srq **srq_ptr)
+{
+	if (peer == NULL || size == 0 || srq_ptr == NULL)
+		return RPMA_E_INVAL;
+
+	struct ibv_srq *ibv_srq = NULL;
+	int ret = rpma_peer_create_srq(peer, size, &ibv_srq);
+	if (ret)
+		return ret;
+
+	/* the receive CQ has to fit all the receives posted to the SRQ */
+	int cqe = size > INT_MAX ? INT_MAX : (int)size;
+	struct rpma_cq *rcq = NULL;
+	ret = rpma_cq_new(ibv_srq->context, cqe, 0 /* comp_vector */,
+			false /* timestamps */, &rcq);
+	if (ret)
+		goto err_destroy_srq;
+
+	struct rpma_srq *srq = malloc(sizeof(*srq));
+	if (srq == NULL) {
+		ret = RPMA_E_NOMEM;
+		goto err_cq_delete;
+	}
+
+	srq->srq = ibv_srq;
+	srq->rcq = rcq;
+	*srq_ptr = srq;
+
+	return 0;
+
+err_cq_delete:
+	(void) rpma_cq_delete(&rcq);
+
+err_destroy_srq:
+	(void) ibv_destroy_srq(ibv_srq);
+
+	return ret;
+}
+
+/*
+ * rpma_srq_delete -- delete the shared receive queue object
+ */
+int
+rpma_srq_delete(struct rpma_srq **srq_ptr)
+{
+	if (srq_ptr == NULL)
+		return RPMA_E_INVAL;
+
+	struct rpma_srq *srq = *srq_ptr;
+	if (srq == NULL)
+		return 0;
+
+	int ret = 0;
+
+	errno = ibv_destroy_srq(srq->srq);
+	if (errno) {
+		RPMA_LOG_ERROR_WITH_ERRNO(errno, "ibv_destroy_srq()");
+		ret = RPMA_E_PROVIDER;
+	}
+
+	int ret_cq = rpma_cq_delete(&srq->rcq);
+	if (!ret)
+		ret = ret_cq;
+
+	free(srq);
+	*srq_ptr = NULL;
+
+	return ret;
+}
+
+/*
+ * rpma_srq_recv -- post a buffer to the shared receive queue
+ */
+int
+rpma_srq_recv(struct rpma_srq *srq,
+	struct rpma_mr_local *dst, size_t offset, size_t len,
+	const void *op_context)
+{
+	if (srq == NULL || (dst == NULL && (offset != 0 || len != 0)))
+		return RPMA_E_INVAL;
+
+	return rpma_mr_srq_recv(srq->srq, dst, offset, len, op_context);
+}
+
+/*
+ * rpma_srq_get_completion_fd -- get a file descriptor of the completion event
+ * channel of the shared receive queue
+ */
+int
+rpma_srq_get_completion_fd(const struct rpma_srq *srq, int *fd)
+{
+	if (srq == NULL || fd == NULL)
+		return RPMA_E_INVAL;
+
+	return rpma_cq_get_fd(srq->rcq, fd);
+}
+
+/*
+ * rpma_srq_completion_wait -- wait for a completion of a receive
+ */
+int
+rpma_srq_completion_wait(struct rpma_srq *srq)
+{
+	if (srq == NULL)
+		return RPMA_E_INVAL;
+
+	return rpma_cq_wait(srq->rcq);
+}
+
+/*
+ * rpma_srq_completion_get -- receive a completion of a receive
+ */
+int
+rpma_srq_completion_get(struct rpma_srq *srq, struct rpma_completion *cmpl)
+{
+	if (srq == NULL || cmpl == NULL)
+		return RPMA_E_INVAL;
+
+	return rpma_cq_get_completion(srq->rcq, cmpl);
+}
@@ -0,0 +1,34 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * srq.h -- librpma shared-receive-queue-related internal definitions
+ */
+
+#ifndef LIBRPMA_SRQ_H
+#define LIBRPMA_SRQ_H
+
+#include "librpma.h"
+#include "cq.h"
+
+#include <infiniband/verbs.h>
+
+/*
+ * ASSUMPTIONS
+ * - srq != NULL
+ *
+ * ERRORS
+ * rpma_srq_get_ibv_srq() cannot fail.
+ */
+struct ibv_srq *rpma_srq_get_ibv_srq(const struct rpma_srq *srq);
+
+/*
+ * ASSUMPTIONS
+ * - srq != NULL
+ *
+ * ERRORS
+ * rpma_srq_get_rcq() cannot fail.
+ */
+struct rpma_cq *rpma_srq_get_rcq(const struct rpma_srq *srq);
+
+#endif /* LIBRPMA_SRQ_H */
@@ -0,0 +1,489 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * stats.c -- librpma performance statistics
+ *
+ * Every counter of a connection has a single writer unless the connection
+ * is shared between threads: the posting thread updates the posting
+ * counters and the thread collecting the completions updates the rest of
+ * them. The counters are bumped using relaxed atomic loads and stores
+ * (relaxed atomic additions for the shared connections) so a snapshot can be
+ * taken at any time from any thread without a lock. The peer keeps the list of
+ * its connections and sums them up when asked (the mutex protects only
+ * the list) so the counters of the peer do not cost anything on the hot path.
+ *
+ * The latency of an operation is measured between the moment it is posted
+ * and the moment its completion is collected. Every signaled operation is
+ * timestamped right before it is posted into a per-queue FIFO. Since
+ * the completions of a reliable connection are generated in the posting
+ * order, the completion of an operation always matches the oldest
+ * timestamp of the respective queue. The FIFOs are single-producer and
+ * single-consumer rings so the completions can be collected by a different
+ * thread than the one posting the operations (e.g. a progress thread).
+ * The matching is lost for good if a completion has failed (the QP moves to
+ * the error state and the opcode of the failed completion is not known) and
+ * the latency is not collected any longer then.
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "mr.h"
+#include "stats.h"
+
+#ifdef TEST_MOCK_ALLOC
+#include "cmocka_alloc.h"
+#endif
+
+#define NSEC_IN_SEC 1000000000ULL
+
+/* the timestamp of a signaled operation */
+struct stats_sample {
+	uint64_t ticks;
+	enum rpma_op op;
+};
+
+/* the timestamps of the posted operations awaiting their completions */
+struct stats_fifo {
+	struct stats_sample *samples;
+	uint32_t mask; /* the size of the FIFO - 1 */
+	uint32_t head; /* the oldest sample (the consumer's index) */
+	uint32_t tail; /* the next free slot (the producer's index) */
+};
+
+struct rpma_conn_stats {
+	struct rpma_stats counters;
+
+	struct rpma_stats_group *group;
+	struct rpma_conn_stats *prev; /* the list of the connections */
+	struct rpma_conn_stats *next; /* of the group */
+
+	bool shared; /* the connection is shared between threads */
+	bool latency; /* the latency is collected */
+	int lost; /* the matching of the completions has been lost */
+	struct stats_fifo sq; /* the signaled send-side operations */
+	struct stats_fifo rq; /* the receives */
+	struct stats_fifo *pending; /* the FIFO of the operation being posted */
+};
+
+/*
+ * stats_clock -- read the cheapest monotonic clock available
+ * (the TSC on x86)
+ */
+static inline uint64_t
+stats_clock(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __rdtsc();
+#else
+	struct timespec ts;
+	(void) clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * NSEC_IN_SEC + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/*
+ * stats_clock_ns -- read the monotonic clock in nanoseconds
+ */
+static uint64_t
+stats_clock_ns(void)
+{
+	struct timespec ts;
+	(void) clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * NSEC_IN_SEC + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * stats_ticks_per_sec -- calculate the frequency of stats_clock() comparing
+ * it with the nanosecond clock since the given moment
+ */
+static uint64_t
+stats_ticks_per_sec(uint64_t since_ticks, uint64_t since_ns)
+{
+	uint64_t ns = stats_clock_ns() - since_ns;
+	uint64_t ticks = stats_clock() - since_ticks;
+	if (ns == 0)
+		return 0;
+
+	return (uint64_t)((double)ticks * (double)NSEC_IN_SEC / (double)ns);
+}
+
+/*
+ * stats_add -- bump the counter
+ */
+static inline void
+stats_add(const struct rpma_conn_stats *stats, uint64_t *counter,
+		uint64_t value)
+{
+	if (stats->shared) {
+		(void) __atomic_fetch_add(counter, value, __ATOMIC_RELAXED);
+	} else {
+		uint64_t old = __atomic_load_n(counter, __ATOMIC_RELAXED);
+		__atomic_store_n(counter, old + value, __ATOMIC_RELAXED);
+	}
+}
+
+/*
+ * stats_sum -- add the counters up
+ */
+static void
+stats_sum(struct rpma_stats *dst, const struct rpma_stats *src)
+{
+	const uint64_t *s = (const uint64_t *)src;
+	uint64_t *d = (uint64_t *)dst;
+	size_t num = offsetof(struct rpma_stats, ticks_per_sec) /
+			sizeof(uint64_t);
+
+	for (size_t i = 0; i < num; ++i)
+		d[i] += __atomic_load_n(&s[i], __ATOMIC_RELAXED);
+}
+
+/*
+ * stats_hist_bucket -- the bucket of the latency histogram
+ * (the bucket i holds the latencies of [2^i, 2^(i+1)) ticks)
+ */
+static inline unsigned
+stats_hist_bucket(uint64_t ticks)
+{
+	unsigned bucket = 63U - (unsigned)__builtin_clzll(ticks | 1);
+	if (bucket >= RPMA_STATS_HIST_BUCKETS)
+		bucket = RPMA_STATS_HIST_BUCKETS - 1;
+
+	return bucket;
+}
+
+/*
+ * stats_fifo_new -- allocate the FIFO of at least the given size
+ */
+static int
+stats_fifo_new(struct stats_fifo *fifo, uint32_t entries)
+{
+	uint32_t size = 1;
+	while (size < entries)
+		size <<= 1;
+
+	fifo->samples = malloc(size * sizeof(*fifo->samples));
+	if (fifo->samples == NULL)
+		return RPMA_E_NOMEM;
+
+	fifo->mask = size - 1;
+	fifo->head = 0;
+	fifo->tail = 0;
+
+	return 0;
+}
+
+/*
+ * stats_fifo_push -- timestamp the operation (the producer's side)
+ */
+static inline int
+stats_fifo_push(struct stats_fifo *fifo, enum rpma_op op)
+{
+	uint32_t head = __atomic_load_n(&fifo->head, __ATOMIC_ACQUIRE);
+	if (fifo->tail - head > fifo->mask)
+		return -1;
+
+	struct stats_sample *sample = &fifo->samples[fifo->tail & fifo->mask];
+	sample->op = op;
+	sample->ticks = stats_clock();
+	__atomic_store_n(&fifo->tail, fifo->tail + 1, __ATOMIC_RELEASE);
+
+	return 0;
+}
+
+/*
+ * stats_fifo_pop -- get the oldest timestamp (the consumer's side)
+ */
+static inline int
+stats_fifo_pop(struct stats_fifo *fifo, struct stats_sample *sample)
+{
+	uint32_t tail = __atomic_load_n(&fifo->tail, __ATOMIC_ACQUIRE);
+	if (fifo->head == tail)
+		return -1;
+
+	*sample = fifo->samples[fifo->head & fifo->mask];
+	__atomic_store_n(&fifo->head, fifo->head + 1, __ATOMIC_RELEASE);
+
+	return 0;
+}
+
+/*
+ * stats_lose -- stop collecting the latency
+ */
+static inline void
+stats_lose(struct rpma_conn_stats *stats)
+{
+	__atomic_store_n(&stats->lost, 1, __ATOMIC_RELAXED);
+}
+
+/*
+ * stats_lost -- has the matching of the completions been lost?
+ */
+static inline int
+stats_lost(const struct rpma_conn_stats *stats)
+{
+	return __atomic_load_n(&stats->lost, __ATOMIC_RELAXED);
+}
+
+/* internal librpma API */
+
+/*
+ * rpma_stats_group_init -- initialize the statistics of a peer
+ */
+void
+rpma_stats_group_init(struct rpma_stats_group *group)
+{
+	(void) pthread_mutex_init(&group->lock, NULL);
+	memset(&group->retired, 0, sizeof(group->retired));
+	group->conns = NULL;
+	group->clock_ticks = stats_clock();
+	group->clock_ns = stats_clock_ns();
+}
+
+/*
+ * rpma_stats_group_fini -- release the statistics of a peer
+ */
+void
+rpma_stats_group_fini(struct rpma_stats_group *group)
+{
+	(void) pthread_mutex_destroy(&group->lock);
+}
+
+/*
+ * rpma_stats_group_get -- sum up the statistics of all the connections
+ * of a peer
+ */
+void
+rpma_stats_group_get(struct rpma_stats_group *group, struct rpma_stats *stats)
+{
+	memset(stats, 0, sizeof(*stats));
+
+	(void) pthread_mutex_lock(&group->lock);
+	stats_sum(stats, &group->retired);
+	for (struct rpma_conn_stats *s = group->conns; s; s = s->next)
+		stats_sum(stats, &s->counters);
+	(void) pthread_mutex_unlock(&group->lock);
+
+	stats->ticks_per_sec = stats_ticks_per_sec(group->clock_ticks,
+			group->clock_ns);
+}
+
+/*
+ * rpma_conn_stats_new -- create the statistics of a connection
+ */
+int
+rpma_conn_stats_new(struct rpma_stats_group *group, int flags,
+		bool shared, uint32_t sq_entries, uint32_t rq_entries,
+		struct rpma_conn_stats **stats_ptr)
+{
+	struct rpma_conn_stats *stats = malloc(sizeof(*stats));
+	if (stats == NULL)
+		return RPMA_E_NOMEM;
+
+	memset(stats, 0, sizeof(*stats));
+
+	/* the threads sharing the connection post in an unknown order */
+	stats->latency = (flags & RPMA_STATS_LATENCY) && !shared;
+	stats->shared = shared;
+
+	if (stats->latency) {
+		if (stats_fifo_new(&stats->sq, sq_entries))
+			goto err_free_stats;
+
+		if (stats_fifo_new(&stats->rq, rq_entries))
+			goto err_free_sq;
+	}
+
+	stats->group = group;
+
+	(void) pthread_mutex_lock(&group->lock);
+	stats->next = group->conns;
+	if (group->conns)
+		group->conns->prev = stats;
+	group->conns = stats;
+	(void) pthread_mutex_unlock(&group->lock);
+
+	*stats_ptr = stats;
+
+	return 0;
+
+err_free_sq:
+	free(stats->sq.samples);
+
+err_free_stats:
+	free(stats);
+
+	return RPMA_E_NOMEM;
+}
+
+/*
+ * rpma_conn_stats_delete -- delete the statistics of a connection
+ * (their counters are kept by the peer)
+ */
+int
+rpma_conn_stats_delete(struct rpma_conn_stats **stats_ptr)
+{
+	if (stats_ptr == NULL)
+		return RPMA_E_INVAL;
+
+	struct rpma_conn_stats *stats = *stats_ptr;
+	if (stats == NULL)
+		return 0;
+
+	struct rpma_stats_group *group = stats->group;
+
+	(void) pthread_mutex_lock(&group->lock);
+	stats_sum(&group->retired, &stats->counters);
+	if (stats->prev)
+		stats->prev->next = stats->next;
+	else
+		group->conns = stats->next;
+	if (stats->next)
+		stats->next->prev = stats->prev;
+	(void) pthread_mutex_unlock(&group->lock);
+
+	free(stats->rq.samples);
+	free(stats->sq.samples);
+	free(stats);
+	*stats_ptr = NULL;
+
+	return 0;
+}
+
+/*
+ * rpma_conn_stats_latency -- are the latencies collected?
+ */
+bool
+rpma_conn_stats_latency(const struct rpma_conn_stats *stats)
+{
+	return stats->latency;
+}
+
+/*
+ * rpma_conn_stats_posting -- timestamp the operation about to be posted
+ */
+void
+rpma_conn_stats_posting(struct rpma_conn_stats *stats, enum rpma_op op,
+		int flags)
+{
+	stats->pending = NULL;
+
+	if (!stats->latency || stats_lost(stats))
+		return;
+
+	struct stats_fifo *fifo;
+	if (op == RPMA_OP_RECV)
+		fifo = &stats->rq;
+	else if (flags & RPMA_F_COMPLETION_ON_SUCCESS)
+		fifo = &stats->sq;
+	else
+		return;
+
+	if (stats_fifo_push(fifo, op)) {
+		/* more operations in flight than the queues can hold */
+		stats_lose(stats);
+		return;
+	}
+
+	stats->pending = fifo;
+}
+
+/*
+ * rpma_conn_stats_posted -- count the posted operation
+ */
+void
+rpma_conn_stats_posted(struct rpma_conn_stats *stats, enum rpma_op op,
+		size_t len, int flags, int ret)
+{
+	stats_add(stats, &stats->counters.posts, 1);
+
+	if (ret) {
+		/* the operation will not complete - drop its timestamp */
+		struct stats_fifo *fifo = stats->pending;
+		if (fifo)
+			__atomic_store_n(&fifo->tail, fifo->tail - 1,
+					__ATOMIC_RELEASE);
+		return;
+	}
+
+	stats_add(stats, &stats->counters.ops[op], 1);
+	stats_add(stats, &stats->counters.bytes[op], len);
+}
+
+/*
+ * rpma_conn_stats_polled -- count the result of the completion polling
+ */
+void
+rpma_conn_stats_polled(struct rpma_conn_stats *stats,
+		const struct rpma_completion *cmpl, int ret)
+{
+	struct rpma_stats *counters = &stats->counters;
+
+	if (ret == RPMA_E_NO_COMPLETION) {
+		stats_add(stats, &counters->empty_polls, 1);
+		return;
+	}
+
+	/* a completion of an unsupported opcode */
+	if (ret == RPMA_E_NOSUPP) {
+		stats_add(stats, &counters->cqes, 1);
+		stats_lose(stats);
+		return;
+	}
+
+	if (ret)
+		return;
+
+	stats_add(stats, &counters->cqes, 1);
+
+	if (cmpl->op_status != IBV_WC_SUCCESS) {
+		stats_add(stats, &counters->error_cqes, 1);
+		if (cmpl->op_status == IBV_WC_WR_FLUSH_ERR)
+			stats_add(stats, &counters->flushed_cqes, 1);
+		stats_lose(stats);
+		return;
+	}
+
+	if (!stats->latency || stats_lost(stats))
+		return;
+
+	struct stats_fifo *fifo = (cmpl->op == RPMA_OP_RECV ||
+			cmpl->op == RPMA_OP_RECV_RDMA_WITH_IMM) ?
+			&stats->rq : &stats->sq;
+	struct stats_sample sample;
+	if (stats_fifo_pop(fifo, &sample))
+		return;
+
+	unsigned bucket = stats_hist_bucket(stats_clock() - sample.ticks);
+	stats_add(stats, &counters->latency[sample.op][bucket], 1);
+}
+
+/*
+ * rpma_conn_stats_woken -- count the result of the wait for a completion
+ */
+void
+rpma_conn_stats_woken(struct rpma_conn_stats *stats, int ret)
+{
+	if (ret == 0)
+		stats_add(stats, &stats->counters.cq_wakeups, 1);
+}
+
+/*
+ * rpma_conn_stats_get -- take a snapshot of the statistics of a connection
+ */
+void
+rpma_conn_stats_get(const struct rpma_conn_stats *stats,
+		struct rpma_stats *snapshot)
+{
+	memset(snapshot, 0, sizeof(*snapshot));
+	stats_sum(snapshot, &stats->counters);
+	snapshot->ticks_per_sec = stats_ticks_per_sec(
+			stats->group->clock_ticks, stats->group->clock_ns);
+}
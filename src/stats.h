@@ -0,0 +1,147 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * stats.h -- librpma performance statistics internal definitions
+ */
+
+#ifndef LIBRPMA_STATS_H
+#define LIBRPMA_STATS_H
+
+#include <pthread.h>
+#include <stdbool.h>
+
+#include "librpma.h"
+
+struct rpma_conn_stats;
+
+/*
+ * the statistics of all the connections of a peer
+ * (embedded in the peer object)
+ */
+struct rpma_stats_group {
+	pthread_mutex_t lock; /* protects the list and the retired counters */
+	struct rpma_stats retired; /* of the connections already deleted */
+	struct rpma_conn_stats *conns; /* the list of the live connections */
+	uint64_t clock_ticks; /* the clock at the initialization (ticks) */
+	uint64_t clock_ns; /* the clock at the initialization (ns) */
+};
+
+/*
+ * ASSUMPTIONS
+ * - group != NULL
+ *
+ * ERRORS
+ * rpma_stats_group_init() cannot fail.
+ */
+void rpma_stats_group_init(struct rpma_stats_group *group);
+
+/*
+ * ASSUMPTIONS
+ * - group != NULL
+ * - all the connections of the group have been deleted
+ *
+ * ERRORS
+ * rpma_stats_group_fini() cannot fail.
+ */
+void rpma_stats_group_fini(struct rpma_stats_group *group);
+
+/*
+ * rpma_stats_group_get -- sum up the statistics of all the connections of
+ * the group (both the live and the deleted ones)
+ *
+ * ASSUMPTIONS
+ * - group != NULL && stats != NULL
+ *
+ * ERRORS
+ * rpma_stats_group_get() cannot fail.
+ */
+void rpma_stats_group_get(struct rpma_stats_group *group,
+		struct rpma_stats *stats);
+
+/*
+ * rpma_conn_stats_new -- create the statistics of a connection and add them
+ * to the group; the latency is not collected if the connection is shared
+ * between threads (shared == true)
+ *
+ * ASSUMPTIONS
+ * - group != NULL && stats_ptr != NULL
+ * - flags != 0
+ *
+ * ERRORS
+ * rpma_conn_stats_new() can fail with the following error:
+ *
+ * - RPMA_E_NOMEM - out of memory
+ */
+int rpma_conn_stats_new(struct rpma_stats_group *group, int flags,
+		bool shared, uint32_t sq_entries, uint32_t rq_entries,
+		struct rpma_conn_stats **stats_ptr);
+
+/*
+ * rpma_conn_stats_delete -- remove the statistics of a connection from
+ * the group (their counters are kept by the group) and delete them
+ *
+ * ERRORS
+ * rpma_conn_stats_delete() can fail with the following error:
+ *
+ * - RPMA_E_INVAL - stats_ptr is NULL
+ */
+int rpma_conn_stats_delete(struct rpma_conn_stats **stats_ptr);
+
+/*
+ * rpma_conn_stats_latency -- are the latencies collected?
+ * (all the operations have to be posted and collected via the connection)
+ *
+ * ASSUMPTIONS
+ * - stats != NULL
+ */
+bool rpma_conn_stats_latency(const struct rpma_conn_stats *stats);
+
+/*
+ * rpma_conn_stats_posting -- timestamp the operation about to be posted
+ *
+ * ASSUMPTIONS
+ * - stats != NULL
+ */
+void rpma_conn_stats_posting(struct rpma_conn_stats *stats, enum rpma_op op,
+		int flags);
+
+/*
+ * rpma_conn_stats_posted -- count the operation if it has been posted
+ * successfully (ret == 0) or drop its timestamp otherwise
+ *
+ * ASSUMPTIONS
+ * - stats != NULL
+ * - rpma_conn_stats_posting() has been called for the operation
+ */
+void rpma_conn_stats_posted(struct rpma_conn_stats *stats, enum rpma_op op,
+		size_t len, int flags, int ret);
+
+/*
+ * rpma_conn_stats_polled -- count the result of the completion polling and
+ * record the latency of the completed operation
+ *
+ * ASSUMPTIONS
+ * - stats != NULL && cmpl != NULL
+ */
+void rpma_conn_stats_polled(struct rpma_conn_stats *stats,
+		const struct rpma_completion *cmpl, int ret);
+
+/*
+ * rpma_conn_stats_woken -- count the result of the wait for a completion
+ *
+ * ASSUMPTIONS
+ * - stats != NULL
+ */
+void rpma_conn_stats_woken(struct rpma_conn_stats *stats, int ret);
+
+/*
+ * rpma_conn_stats_get -- take a snapshot of the statistics of a connection
+ *
+ * ASSUMPTIONS
+ * - stats != NULL && snapshot != NULL
+ */
+void rpma_conn_stats_get(const struct rpma_conn_stats *stats,
+		struct rpma_stats *snapshot);
+
+#endif /* LIBRPMA_STATS_H */
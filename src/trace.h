@@ -0,0 +1,61 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * trace.h -- librpma static tracepoints (USDT)
+ *
+ * The tracepoints are compiled in only if sys/sdt.h is found at build time
+ * (see the USE_USDT CMake option). A tracepoint which is not attached is
+ * a single NOP instruction and its arguments are only the values already
+ * at hand so the library does not have to be rebuilt to be traced e.g.:
+ *
+ *	bpftrace -l 'usdt:/usr/lib64/librpma.so.0:rpma:*'
+ *
+ * All the tracepoints belong to the 'rpma' provider:
+ *
+ * - post(qp, op_context, opcode, length, remote_addr, send_flags) -
+ *   the work request is about to be posted to the send queue
+ *   (opcode is enum ibv_wr_opcode, send_flags are IBV_SEND_*)
+ * - post_chain(qp, wr_id, num) - the chain of num work requests starting
+ *   with the wr_id one is about to be posted to the send queue with a single
+ *   ibv_post_send(3) call
+ * - recv(qp, op_context, length) - the receive buffer is about to be posted
+ *   to the receive queue
+ * - srq_recv(srq, op_context, length) - the receive buffer is about to be
+ *   posted to the shared receive queue
+ * - recv_chain(qp, srq, wr_id, num) - the chain of num receive buffers
+ *   starting with the wr_id one is about to be posted either to the receive
+ *   queue (srq == NULL) or to the shared receive queue (qp == NULL)
+ * - flush(qp, mr, offset, length, type, op_context) - the flush is about to
+ *   be posted (type is enum rpma_flush_type)
+ * - completion(qp_num, op_context, op, byte_len, status) - the completion
+ *   has been collected (op is enum rpma_op, status is enum ibv_wc_status)
+ * - cq_wait(cq) - the thread is about to wait for a completion event
+ * - cq_wakeup(cq, ret) - the thread has stopped waiting for a completion
+ *   event (ret is 0 if the event has been received)
+ * - ep_listen(ep, id) - the endpoint is listening for incoming connections
+ * - ep_conn_req(ep, req) - the incoming connection request has been received
+ * - conn_req_new(req, id) - the connection request has been created
+ * - conn_req_connect(req, id, active) - the connection request is about to
+ *   be accepted (active == 0) or connected (active == 1)
+ * - conn_req_reject(req, id) - the incoming connection request is about to
+ *   be rejected
+ * - conn_new(conn, id) - the connection has been created
+ * - conn_event(conn, event) - the connection event has been obtained
+ *   (event is enum rpma_conn_event)
+ * - conn_disconnect(conn) - the connection is about to be disconnected
+ * - conn_delete(conn) - the connection is about to be deleted
+ */
+
+#ifndef LIBRPMA_TRACE_H
+#define LIBRPMA_TRACE_H
+
+#ifdef RPMA_USDT_ENABLED
+#include <sys/sdt.h>
+
+#define RPMA_TRACE(name, ...) STAP_PROBEV(rpma, name, __VA_ARGS__)
+#else
+#define RPMA_TRACE(name, ...) do {} while (0)
+#endif
+
+#endif /* LIBRPMA_TRACE_H */
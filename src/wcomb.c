@@ -0,0 +1,329 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * wcomb.c -- librpma write-combining buffers
+ *
+ * The small writes to the remote memory region are copied to an open
+ * staging buffer which covers a window of the region starting at the offset
+ * of the first write. The following writes are merged as long as they
+ * overlap or adjoin the data already gathered and fit in the window. A write
+ * which would leave a hole closes the buffer since the single RDMA write
+ * of the whole range would overwrite the remote data in the hole. A closed
+ * buffer is posted as a single RDMA write so the writes reach the remote
+ * side in the order they have been issued.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "librpma.h"
+#include "log_internal.h"
+#include "mr.h"
+
+#ifdef TEST_MOCK_ALLOC
+#include "cmocka_alloc.h"
+#endif
+
+#define WCOMB_NO_BUF		UINT32_MAX
+
+struct rpma_wcomb {
+	struct rpma_conn *conn;
+	struct rpma_mr_remote *dst; /* the remote memory region written to */
+
+	void *slab; /* the staging buffers */
+	size_t mmap_size; /* size of the mmap()'ed slab */
+	struct rpma_mr_local *slab_mr; /* registration of the slab */
+	size_t buf_size; /* size of a single staging buffer */
+	uint32_t bufs; /* number of the staging buffers */
+
+	uint32_t *free_bufs; /* stack of the free staging buffers */
+	uint32_t nfree; /* number of the free staging buffers */
+
+	uint32_t open; /* the buffer being filled (or WCOMB_NO_BUF) */
+	size_t win; /* the remote offset the open buffer starts at */
+	size_t len; /* number of bytes gathered in the open buffer */
+	struct timespec opened; /* when the open buffer got its first write */
+
+	uint64_t timeout_us; /* the age the open buffer is posted at */
+};
+
+/*
+ * wcomb_buf -- get the staging buffer of the given index
+ */
+static inline char *
+wcomb_buf(const struct rpma_wcomb *wcomb, uint32_t buf)
+{
+	return (char *)wcomb->slab + buf * wcomb->buf_size;
+}
+
+/*
+ * wcomb_post -- post the open buffer as a single RDMA write
+ */
+static int
+wcomb_post(struct rpma_wcomb *wcomb)
+{
+	if (wcomb->open == WCOMB_NO_BUF)
+		return 0;
+
+	int ret = rpma_write(wcomb->conn, wcomb->dst, wcomb->win,
+			wcomb->slab_mr, wcomb->open * wcomb->buf_size,
+			wcomb->len, RPMA_F_COMPLETION_ALWAYS,
+			wcomb_buf(wcomb, wcomb->open));
+	if (ret)
+		return ret;
+
+	wcomb->open = WCOMB_NO_BUF;
+	wcomb->len = 0;
+
+	return 0;
+}
+
+/*
+ * wcomb_expired -- check if the open buffer has been waiting for longer
+ * than the timeout
+ */
+static int
+wcomb_expired(const struct rpma_wcomb *wcomb)
+{
+	if (wcomb->open == WCOMB_NO_BUF || wcomb->timeout_us == 0)
+		return 0;
+
+	struct timespec now;
+	if (clock_gettime(CLOCK_MONOTONIC, &now))
+		return 0;
+
+	int64_t age_us = (int64_t)(now.tv_sec - wcomb->opened.tv_sec) *
+			1000000 +
+			(int64_t)(now.tv_nsec - wcomb->opened.tv_nsec) / 1000;
+
+	return age_us >= 0 && (uint64_t)age_us >= wcomb->timeout_us;
+}
+
+/* public librpma API */
+
+/*
+ * rpma_wcomb_new -- register the staging buffers of the write-combining
+ * layer of the connection and the remote memory region
+ */
+int
+rpma_wcomb_new(struct rpma_peer *peer, struct rpma_conn *conn,
+		struct rpma_mr_remote *dst, uint32_t bufs, size_t buf_size,
+		struct rpma_wcomb **wcomb_ptr)
+{
+	if (peer == NULL || conn == NULL || dst == NULL ||
+			wcomb_ptr == NULL || bufs == 0 || buf_size == 0 ||
+			buf_size > SIZE_MAX / bufs)
+		return RPMA_E_INVAL;
+
+	void *slab = NULL;
+	size_t mmap_size = 0;
+	struct rpma_mr_local *slab_mr = NULL;
+	int ret = rpma_mr_slab_new(peer, bufs * buf_size,
+			RPMA_MR_USAGE_WRITE_SRC, &slab, &mmap_size, &slab_mr);
+	if (ret)
+		return ret;
+
+	struct rpma_wcomb *wcomb = malloc(sizeof(*wcomb));
+	if (wcomb == NULL) {
+		ret = RPMA_E_NOMEM;
+		goto err_mr_dereg;
+	}
+
+	wcomb->free_bufs = malloc(bufs * sizeof(uint32_t));
+	if (wcomb->free_bufs == NULL) {
+		ret = RPMA_E_NOMEM;
+		goto err_free_wcomb;
+	}
+
+	for (uint32_t i = 0; i < bufs; ++i)
+		wcomb->free_bufs[i] = bufs - 1 - i;
+
+	wcomb->conn = conn;
+	wcomb->dst = dst;
+	wcomb->slab = slab;
+	wcomb->mmap_size = mmap_size;
+	wcomb->slab_mr = slab_mr;
+	wcomb->buf_size = buf_size;
+	wcomb->bufs = bufs;
+	wcomb->nfree = bufs;
+	wcomb->open = WCOMB_NO_BUF;
+	wcomb->win = 0;
+	wcomb->len = 0;
+	wcomb->opened.tv_sec = 0;
+	wcomb->opened.tv_nsec = 0;
+	wcomb->timeout_us = 0;
+
+	*wcomb_ptr = wcomb;
+
+	return 0;
+
+err_free_wcomb:
+	free(wcomb);
+
+err_mr_dereg:
+	(void) rpma_mr_slab_delete(&slab_mr, slab, mmap_size);
+
+	return ret;
+}
+
+/*
+ * rpma_wcomb_delete -- deregister and free the staging buffers
+ */
+int
+rpma_wcomb_delete(struct rpma_wcomb **wcomb_ptr)
+{
+	if (wcomb_ptr == NULL)
+		return RPMA_E_INVAL;
+
+	struct rpma_wcomb *wcomb = *wcomb_ptr;
+	if (wcomb == NULL)
+		return 0;
+
+	int ret = rpma_mr_slab_delete(&wcomb->slab_mr, wcomb->slab,
+			wcomb->mmap_size);
+
+	free(wcomb->free_bufs);
+	free(wcomb);
+	*wcomb_ptr = NULL;
+
+	return ret;
+}
+
+/*
+ * rpma_wcomb_set_timeout -- set the age of the open buffer it is posted at
+ */
+int
+rpma_wcomb_set_timeout(struct rpma_wcomb *wcomb, uint64_t timeout_us)
+{
+	if (wcomb == NULL)
+		return RPMA_E_INVAL;
+
+	wcomb->timeout_us = timeout_us;
+
+	return 0;
+}
+
+/*
+ * rpma_wcomb_write -- gather the write in the open buffer or post the open
+ * buffer and start a new one
+ */
+int
+rpma_wcomb_write(struct rpma_wcomb *wcomb, size_t dst_offset,
+		const void *src, size_t len)
+{
+	if (wcomb == NULL || src == NULL || len == 0 ||
+			len > wcomb->buf_size)
+		return RPMA_E_INVAL;
+
+	int ret;
+
+	/* the write has to overlap or adjoin the data gathered so far */
+	if (wcomb->open != WCOMB_NO_BUF && (dst_offset < wcomb->win ||
+			dst_offset > wcomb->win + wcomb->len ||
+			dst_offset - wcomb->win > wcomb->buf_size - len)) {
+		ret = wcomb_post(wcomb);
+		if (ret)
+			return ret;
+	}
+
+	if (wcomb->open == WCOMB_NO_BUF) {
+		if (wcomb->nfree == 0)
+			return RPMA_E_AGAIN;
+
+		wcomb->open = wcomb->free_bufs[--wcomb->nfree];
+		wcomb->win = dst_offset;
+		wcomb->len = 0;
+		if (wcomb->timeout_us)
+			(void) clock_gettime(CLOCK_MONOTONIC, &wcomb->opened);
+	}
+
+	size_t off = dst_offset - wcomb->win;
+	memcpy(wcomb_buf(wcomb, wcomb->open) + off, src, len);
+	if (off + len > wcomb->len)
+		wcomb->len = off + len;
+
+	/* a full buffer cannot gather anything more */
+	if (wcomb->len == wcomb->buf_size || wcomb_expired(wcomb))
+		return wcomb_post(wcomb);
+
+	return 0;
+}
+
+/*
+ * rpma_wcomb_progress -- post the open buffer if it has been waiting for
+ * longer than the timeout
+ */
+int
+rpma_wcomb_progress(struct rpma_wcomb *wcomb)
+{
+	if (wcomb == NULL)
+		return RPMA_E_INVAL;
+
+	if (!wcomb_expired(wcomb))
+		return 0;
+
+	return wcomb_post(wcomb);
+}
+
+/*
+ * rpma_wcomb_post -- post the open buffer regardless of its age
+ */
+int
+rpma_wcomb_post(struct rpma_wcomb *wcomb)
+{
+	if (wcomb == NULL)
+		return RPMA_E_INVAL;
+
+	return wcomb_post(wcomb);
+}
+
+/*
+ * rpma_wcomb_flush -- post the open buffer and the flush of the remote
+ * memory region after it
+ */
+int
+rpma_wcomb_flush(struct rpma_wcomb *wcomb, size_t dst_offset, size_t len,
+		enum rpma_flush_type type, int flags, const void *op_context)
+{
+	if (wcomb == NULL || flags == 0)
+		return RPMA_E_INVAL;
+
+	int ret = wcomb_post(wcomb);
+	if (ret)
+		return ret;
+
+	return rpma_flush(wcomb->conn, wcomb->dst, dst_offset, len, type,
+			flags, op_context);
+}
+
+/*
+ * rpma_wcomb_process -- consume the completion of the posted buffer
+ */
+int
+rpma_wcomb_process(struct rpma_wcomb *wcomb,
+		const struct rpma_completion *cmpl)
+{
+	if (wcomb == NULL || cmpl == NULL)
+		return RPMA_E_INVAL;
+
+	uintptr_t ctx = (uintptr_t)cmpl->op_context;
+	uintptr_t base = (uintptr_t)wcomb->slab;
+	if (ctx < base || ctx >= base + wcomb->bufs * wcomb->buf_size ||
+			(ctx - base) % wcomb->buf_size != 0)
+		return RPMA_E_INVAL;
+
+	uint32_t buf = (uint32_t)((ctx - base) / wcomb->buf_size);
+	if (buf == wcomb->open || wcomb->nfree == wcomb->bufs)
+		return RPMA_E_INVAL;
+
+	/* the staging buffer can be reused */
+	wcomb->free_bufs[wcomb->nfree++] = buf;
+
+	if (cmpl->op_status != IBV_WC_SUCCESS)
+		return RPMA_E_PROVIDER;
+
+	return 0;
+}
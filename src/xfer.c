@@ -0,0 +1,353 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * xfer.c -- librpma segmented transfers
+ *
+ * The transfers are kept in a FIFO and split into chunks which are posted
+ * in the order of the transfers. Up to inflight chunks are posted at a time
+ * and every completed chunk makes room for the next one so the link stays
+ * busy without overflowing the SQ. The completions of an RC connection
+ * come in the order of posting so the transfers are finished in the order
+ * they have been initiated.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "conn.h"
+#include "librpma.h"
+
+#ifdef TEST_MOCK_ALLOC
+#include "cmocka_alloc.h"
+#endif
+
+struct xfer_op {
+	enum rpma_op op; /* RPMA_OP_READ or RPMA_OP_WRITE */
+	union {
+		struct {
+			struct rpma_mr_local *dst;
+			const struct rpma_mr_remote *src;
+		} read;
+		struct {
+			struct rpma_mr_remote *dst;
+			const struct rpma_mr_local *src;
+		} write;
+	};
+	size_t dst_offset;
+	size_t src_offset;
+	size_t len;
+
+	size_t posted; /* number of bytes posted so far */
+	uint32_t pending; /* number of chunks in flight */
+	enum ibv_wc_status status; /* status of the first failed chunk */
+	const void *op_context; /* the op_context of the caller */
+};
+
+struct rpma_xfer {
+	struct rpma_conn *conn;
+	size_t chunk_size; /* size of a single chunk */
+	uint32_t inflight_max; /* maximum number of chunks in flight */
+	uint32_t inflight; /* number of chunks in flight */
+
+	struct xfer_op *ops; /* FIFO of the transfers */
+	uint32_t ops_max; /* capacity of the FIFO */
+	uint32_t head; /* the oldest transfer */
+	uint32_t num; /* number of the transfers */
+	uint32_t posting; /* number of the transfers posted entirely */
+
+	uint32_t qp_num; /* the QP number of the chunk completions */
+};
+
+/*
+ * xfer_op_at -- get the transfer of the given position in the FIFO
+ */
+static inline struct xfer_op *
+xfer_op_at(const struct rpma_xfer *xfer, uint32_t pos)
+{
+	return &xfer->ops[(xfer->head + pos) % xfer->ops_max];
+}
+
+/*
+ * xfer_post_chunk -- post the next chunk of the transfer
+ */
+static int
+xfer_post_chunk(struct rpma_xfer *xfer, struct xfer_op *op)
+{
+	size_t len = op->len - op->posted;
+	if (len > xfer->chunk_size)
+		len = xfer->chunk_size;
+
+	/* the completion points to the transfer the chunk belongs to */
+	int ret;
+	if (op->op == RPMA_OP_READ)
+		ret = rpma_read(xfer->conn,
+				op->read.dst, op->dst_offset + op->posted,
+				op->read.src, op->src_offset + op->posted,
+				len, RPMA_F_COMPLETION_ALWAYS, op);
+	else
+		ret = rpma_write(xfer->conn,
+				op->write.dst, op->dst_offset + op->posted,
+				op->write.src, op->src_offset + op->posted,
+				len, RPMA_F_COMPLETION_ALWAYS, op);
+	if (ret)
+		return ret;
+
+	op->posted += len;
+	op->pending++;
+	xfer->inflight++;
+
+	return 0;
+}
+
+/*
+ * xfer_pump -- post the chunks of the queued transfers while there is room
+ * for them. A transfer whose chunk cannot be posted fails and its remaining
+ * chunks are dropped. The error of the last transfer failed this way
+ * is returned.
+ */
+static int
+xfer_pump(struct rpma_xfer *xfer)
+{
+	int ret = 0;
+
+	while (xfer->posting < xfer->num &&
+			xfer->inflight < xfer->inflight_max) {
+		struct xfer_op *op = xfer_op_at(xfer, xfer->posting);
+		int err = xfer_post_chunk(xfer, op);
+		if (err) {
+			if (op->status == IBV_WC_SUCCESS)
+				op->status = IBV_WC_GENERAL_ERR;
+			op->posted = op->len;
+			ret = err;
+		}
+
+		if (op->posted == op->len)
+			xfer->posting++;
+	}
+
+	return ret;
+}
+
+/*
+ * xfer_queue -- queue the transfer and post as many of its chunks
+ * as possible
+ */
+static int
+xfer_queue(struct rpma_xfer *xfer, struct xfer_op *op)
+{
+	if (xfer->num == xfer->ops_max)
+		return RPMA_E_AGAIN;
+
+	uint32_t pos = xfer->num++;
+	struct xfer_op *queued = xfer_op_at(xfer, pos);
+	*queued = *op;
+
+	int ret = xfer_pump(xfer);
+	if (ret == 0)
+		return 0;
+
+	/* the transfer which failed to start is withdrawn */
+	if (queued->posted == queued->len && queued->pending == 0) {
+		xfer->num--;
+		xfer->posting--;
+		return ret;
+	}
+
+	/* the failure will be reported via the completion of the transfer */
+	return 0;
+}
+
+/* public librpma API */
+
+/*
+ * rpma_xfer_new -- create a new segmented transfer engine
+ */
+int
+rpma_xfer_new(struct rpma_conn *conn, size_t chunk_size, uint32_t inflight,
+		struct rpma_xfer **xfer_ptr)
+{
+	if (conn == NULL || xfer_ptr == NULL || inflight == 0 ||
+			chunk_size > RPMA_XFER_CHUNK_SIZE_MAX)
+		return RPMA_E_INVAL;
+
+	if (chunk_size == 0)
+		chunk_size = RPMA_XFER_CHUNK_SIZE_DEFAULT;
+
+	/* a chunk cannot exceed the maximum message size of the port */
+	uint32_t max_msg_sz;
+	int ret = rpma_conn_get_max_msg_sz(conn, &max_msg_sz);
+	if (ret)
+		return ret;
+
+	if (chunk_size > max_msg_sz)
+		chunk_size = max_msg_sz;
+
+	struct rpma_xfer *xfer = malloc(sizeof(*xfer));
+	if (xfer == NULL)
+		return RPMA_E_NOMEM;
+
+	xfer->ops = malloc(inflight * sizeof(struct xfer_op));
+	if (xfer->ops == NULL) {
+		free(xfer);
+		return RPMA_E_NOMEM;
+	}
+
+	xfer->conn = conn;
+	xfer->chunk_size = chunk_size;
+	xfer->inflight_max = inflight;
+	xfer->inflight = 0;
+	xfer->ops_max = inflight;
+	xfer->head = 0;
+	xfer->num = 0;
+	xfer->posting = 0;
+	xfer->qp_num = 0;
+
+	*xfer_ptr = xfer;
+
+	return 0;
+}
+
+/*
+ * rpma_xfer_delete -- delete the segmented transfer engine
+ */
+int
+rpma_xfer_delete(struct rpma_xfer **xfer_ptr)
+{
+	if (xfer_ptr == NULL)
+		return RPMA_E_INVAL;
+
+	struct rpma_xfer *xfer = *xfer_ptr;
+	if (xfer == NULL)
+		return 0;
+
+	free(xfer->ops);
+	free(xfer);
+	*xfer_ptr = NULL;
+
+	return 0;
+}
+
+/*
+ * rpma_xfer_read -- queue the segmented read operation
+ */
+int
+rpma_xfer_read(struct rpma_xfer *xfer,
+		struct rpma_mr_local *dst, size_t dst_offset,
+		const struct rpma_mr_remote *src, size_t src_offset,
+		size_t len, const void *op_context)
+{
+	if (xfer == NULL || dst == NULL || src == NULL || len == 0)
+		return RPMA_E_INVAL;
+
+	struct xfer_op op = {0};
+	op.op = RPMA_OP_READ;
+	op.read.dst = dst;
+	op.read.src = src;
+	op.dst_offset = dst_offset;
+	op.src_offset = src_offset;
+	op.len = len;
+	op.status = IBV_WC_SUCCESS;
+	op.op_context = op_context;
+
+	return xfer_queue(xfer, &op);
+}
+
+/*
+ * rpma_xfer_write -- queue the segmented write operation
+ */
+int
+rpma_xfer_write(struct rpma_xfer *xfer,
+		struct rpma_mr_remote *dst, size_t dst_offset,
+		const struct rpma_mr_local *src, size_t src_offset,
+		size_t len, const void *op_context)
+{
+	if (xfer == NULL || dst == NULL || src == NULL || len == 0)
+		return RPMA_E_INVAL;
+
+	struct xfer_op op = {0};
+	op.op = RPMA_OP_WRITE;
+	op.write.dst = dst;
+	op.write.src = src;
+	op.dst_offset = dst_offset;
+	op.src_offset = src_offset;
+	op.len = len;
+	op.status = IBV_WC_SUCCESS;
+	op.op_context = op_context;
+
+	return xfer_queue(xfer, &op);
+}
+
+/*
+ * rpma_xfer_process -- consume the completion of a chunk and post
+ * the next chunks
+ */
+int
+rpma_xfer_process(struct rpma_xfer *xfer, const struct rpma_completion *cmpl)
+{
+	if (xfer == NULL || cmpl == NULL)
+		return RPMA_E_INVAL;
+
+	uintptr_t ctx = (uintptr_t)cmpl->op_context;
+	uintptr_t base = (uintptr_t)xfer->ops;
+	size_t op_size = sizeof(struct xfer_op);
+	if (ctx < base || ctx >= base + xfer->ops_max * op_size ||
+			(ctx - base) % op_size != 0)
+		return RPMA_E_INVAL;
+
+	struct xfer_op *op = (struct xfer_op *)ctx;
+	if (op->pending == 0)
+		return RPMA_E_INVAL;
+
+	op->pending--;
+	xfer->inflight--;
+	xfer->qp_num = cmpl->qp_num;
+
+	if (cmpl->op_status != IBV_WC_SUCCESS) {
+		if (op->status == IBV_WC_SUCCESS)
+			op->status = cmpl->op_status;
+
+		/* drop the chunks of the failed transfer */
+		if (op->posted != op->len) {
+			op->posted = op->len;
+			xfer->posting++;
+		}
+	}
+
+	/* the failures of posting are reported by the transfers */
+	(void) xfer_pump(xfer);
+
+	return 0;
+}
+
+/*
+ * rpma_xfer_next -- get the completion of the oldest transfer if it has
+ * been finished
+ */
+int
+rpma_xfer_next(struct rpma_xfer *xfer, struct rpma_completion *cmpl)
+{
+	if (xfer == NULL || cmpl == NULL)
+		return RPMA_E_INVAL;
+
+	if (xfer->num == 0)
+		return RPMA_E_NO_COMPLETION;
+
+	struct xfer_op *op = xfer_op_at(xfer, 0);
+	if (op->posted != op->len || op->pending != 0)
+		return RPMA_E_NO_COMPLETION;
+
+	cmpl->op_context = (void *)(uintptr_t)op->op_context;
+	cmpl->op = op->op;
+	cmpl->byte_len = 0;
+	cmpl->op_status = op->status;
+	cmpl->flags = 0;
+	cmpl->imm = 0;
+	cmpl->qp_num = xfer->qp_num;
+
+	xfer->head = (xfer->head + 1) % xfer->ops_max;
+	xfer->num--;
+	xfer->posting--;
+
+	return 0;
+}
@@ -0,0 +1,290 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * post_overhead.c -- the per-operation CPU cost of the posting paths
+ *
+ * The benchmark posts RDMA reads and writes to a QP whose ibv_post_send(3)
+ * is mocked (it only touches the work request and returns) so what is
+ * measured is the library overhead only and no RDMA hardware is needed.
+ * The paths compared are:
+ * - rpma_mr_read()/rpma_mr_write() - the generic path taken by rpma_read()
+ *   and rpma_write() after the connection is looked up (the arguments are
+ *   not validated here),
+ * - rpma_op_template_start() - the operation templates,
+ * - rpma_fast_read()/rpma_fast_write() - the inlined fast path.
+ *
+ * The best of a few rounds is reported in the CPU cycles (the TSC ticks
+ * on x86_64, nanoseconds elsewhere) per operation. The benchmark is always
+ * built with -O2 so the fast path is inlined as it would be in an optimized
+ * application.
+ *
+ * usage: post_overhead [<iterations>]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "librpma_fast.h"
+#include "mr.h"
+
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#define UNIT "cycles"
+#define now() __rdtsc()
+#else
+#define UNIT "ns"
+static inline uint64_t
+now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+#endif
+
+#define ITERATIONS_DEFAULT	10000000
+#define ROUNDS			5
+#define BUF_SIZE		4096
+#define OP_SIZE			64
+
+static struct ibv_context Bench_context;
+static struct ibv_qp Bench_qp = {.context = &Bench_context};
+static struct ibv_mr Bench_mr;
+static char Buf[BUF_SIZE];
+
+/* keeps the mocked post from being optimized out */
+static volatile uint64_t Sink;
+
+/*
+ * bench_post_send -- the mocked ibv_post_send(3)
+ */
+static int __attribute__((noinline))
+bench_post_send(struct ibv_qp *qp, struct ibv_send_wr *wr,
+		struct ibv_send_wr **bad_wr)
+{
+	Sink = wr->wr_id + wr->sg_list->addr + wr->wr.rdma.remote_addr;
+
+	return 0;
+}
+
+/*
+ * rpma_peer_mr_reg -- the registration of the benchmark buffer
+ */
+int
+rpma_peer_mr_reg(struct rpma_peer *peer, struct ibv_mr **ibv_mr_ptr,
+		void *addr, size_t length, int usage)
+{
+	Bench_mr.addr = addr;
+	Bench_mr.length = length;
+	Bench_mr.lkey = 0x1234;
+	Bench_mr.rkey = 0x5678;
+	*ibv_mr_ptr = &Bench_mr;
+
+	return 0;
+}
+
+/*
+ * ibv_dereg_mr -- nothing to deregister
+ */
+int
+ibv_dereg_mr(struct ibv_mr *mr)
+{
+	return 0;
+}
+
+/*
+ * rpma_conn_get_ibv_qp -- the connection of the templates
+ */
+int
+rpma_conn_get_ibv_qp(const struct rpma_conn *conn, struct ibv_qp **qp_ptr)
+{
+	*qp_ptr = &Bench_qp;
+
+	return 0;
+}
+
+/*
+ * rpma_conn_reads_posted -- the reads posted by the templates
+ */
+void
+rpma_conn_reads_posted(struct rpma_conn *conn)
+{
+	Sink = 0;
+}
+
+/* the objects used by all the paths */
+struct bench {
+	struct rpma_mr_local *local;
+	struct rpma_mr_remote *remote;
+	struct rpma_op_template *tmpl_read;
+	struct rpma_op_template *tmpl_write;
+	struct rpma_fast_conn fconn;
+	struct rpma_fast_mr flocal;
+	struct rpma_fast_mr fremote;
+	uint32_t unfenced;
+};
+
+enum path {
+	PATH_MR_READ,
+	PATH_MR_WRITE,
+	PATH_TEMPLATE_READ,
+	PATH_TEMPLATE_WRITE,
+	PATH_FAST_READ,
+	PATH_FAST_WRITE,
+	PATH_MAX
+};
+
+static const char *Path_names[PATH_MAX] = {
+	"rpma_mr_read()",
+	"rpma_mr_write()",
+	"rpma_op_template_start(READ)",
+	"rpma_op_template_start(WRITE)",
+	"rpma_fast_read()",
+	"rpma_fast_write()",
+};
+
+/*
+ * post -- post a single operation using the given path
+ */
+static inline int
+post(struct bench *b, enum path path, size_t offset, void *op_context)
+{
+	switch (path) {
+	case PATH_MR_READ:
+		return rpma_mr_read(&Bench_qp, b->local, offset, b->remote,
+				offset, OP_SIZE, RPMA_F_COMPLETION_ALWAYS,
+				op_context);
+	case PATH_MR_WRITE:
+		return rpma_mr_write(&Bench_qp, b->remote, offset, b->local,
+				offset, OP_SIZE, RPMA_F_COMPLETION_ALWAYS,
+				IBV_WR_RDMA_WRITE, 0, op_context, false);
+	case PATH_TEMPLATE_READ:
+		return rpma_op_template_start(b->tmpl_read, offset, offset,
+				OP_SIZE, op_context);
+	case PATH_TEMPLATE_WRITE:
+		return rpma_op_template_start(b->tmpl_write, offset, offset,
+				OP_SIZE, op_context);
+	case PATH_FAST_READ:
+		return rpma_fast_read(&b->fconn, &b->flocal, offset,
+				&b->fremote, offset, OP_SIZE,
+				RPMA_F_COMPLETION_ALWAYS, op_context);
+	default:
+		return rpma_fast_write(&b->fconn, &b->fremote, offset,
+				&b->flocal, offset, OP_SIZE,
+				RPMA_F_COMPLETION_ALWAYS, op_context);
+	}
+}
+
+/*
+ * run -- measure the best cost of a single operation of the path
+ */
+static int
+run(struct bench *b, enum path path, uint64_t iterations, double *best)
+{
+	*best = 0.0;
+
+	for (int r = 0; r < ROUNDS; ++r) {
+		uint64_t start = now();
+		for (uint64_t i = 0; i < iterations; ++i) {
+			size_t offset = (i * OP_SIZE) % BUF_SIZE;
+			if (post(b, path, offset, (void *)(uintptr_t)i))
+				return -1;
+		}
+		double cost = (double)(now() - start) / (double)iterations;
+
+		if (r == 0 || cost < *best)
+			*best = cost;
+	}
+
+	return 0;
+}
+
+int
+main(int argc, char *argv[])
+{
+	uint64_t iterations = ITERATIONS_DEFAULT;
+	if (argc > 1)
+		iterations = strtoull(argv[1], NULL, 10);
+	if (iterations == 0) {
+		fprintf(stderr, "usage: %s [<iterations>]\n", argv[0]);
+		return -1;
+	}
+
+	Bench_context.ops.post_send = bench_post_send;
+
+	struct bench b = {0};
+	struct rpma_conn *conn = (struct rpma_conn *)&b;
+	struct rpma_peer *peer = (struct rpma_peer *)&b;
+	char desc[64];
+	size_t desc_size;
+	int ret;
+
+	ret = rpma_mr_reg(peer, Buf, BUF_SIZE,
+			RPMA_MR_USAGE_READ_SRC | RPMA_MR_USAGE_READ_DST |
+			RPMA_MR_USAGE_WRITE_SRC | RPMA_MR_USAGE_WRITE_DST |
+			RPMA_MR_USAGE_FLUSH_TYPE_VISIBILITY, &b.local);
+	if (ret)
+		goto err_exit;
+
+	ret = rpma_mr_get_descriptor_size(b.local, &desc_size);
+	if (ret || desc_size > sizeof(desc))
+		goto err_mr_dereg;
+
+	ret = rpma_mr_get_descriptor(b.local, desc);
+	if (ret)
+		goto err_mr_dereg;
+
+	ret = rpma_mr_remote_from_descriptor(desc, desc_size, &b.remote);
+	if (ret)
+		goto err_mr_dereg;
+
+	ret = rpma_op_template_new(conn, RPMA_OP_TEMPLATE_READ, b.local,
+			b.remote, RPMA_F_COMPLETION_ALWAYS, &b.tmpl_read);
+	if (ret)
+		goto err_mr_remote_delete;
+
+	ret = rpma_op_template_new(conn, RPMA_OP_TEMPLATE_WRITE, b.local,
+			b.remote, RPMA_F_COMPLETION_ALWAYS, &b.tmpl_write);
+	if (ret)
+		goto err_template_delete;
+
+	/* rpma_conn_get_fast() needs a real connection */
+	b.fconn.qp = &Bench_qp;
+	b.fconn.unfenced = &b.unfenced;
+	ret = rpma_mr_get_fast(b.local, &b.flocal);
+	if (ret)
+		goto err_template_delete;
+
+	ret = rpma_mr_remote_get_fast(b.remote, &b.fremote);
+	if (ret)
+		goto err_template_delete;
+
+	printf("%-32s%s/op\n", "path", UNIT);
+	for (int p = 0; p < PATH_MAX; ++p) {
+		double cost;
+		ret = run(&b, (enum path)p, iterations, &cost);
+		if (ret)
+			break;
+
+		printf("%-32s%.2f\n", Path_names[p], cost);
+	}
+
+err_template_delete:
+	(void) rpma_op_template_delete(&b.tmpl_write);
+	(void) rpma_op_template_delete(&b.tmpl_read);
+
+err_mr_remote_delete:
+	(void) rpma_mr_remote_delete(&b.remote);
+
+err_mr_dereg:
+	(void) rpma_mr_dereg(&b.local);
+
+err_exit:
+	if (ret)
+		fprintf(stderr, "the benchmark has failed: %s\n",
+				rpma_err_2str(ret));
+
+	return ret ? -1 : 0;
+}
@@ -101,7 +101,8 @@ function(build_test_src)
 			${TEST_UNIT_COMMON_DIR})
 	endif()
 	# do not link with the rpma library
-	target_link_libraries(${TEST_NAME} cmocka test_backtrace)
+	target_link_libraries(${TEST_NAME} cmocka test_backtrace
+		${CMAKE_THREAD_LIBS_INIT})
 	if(LIBUNWIND_FOUND)
 		target_link_libraries(${TEST_NAME} ${LIBUNWIND_LIBRARIES} ${CMAKE_DL_LIBS})
 	endif()
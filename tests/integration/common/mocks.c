@@ -58,6 +58,52 @@ ibv_query_device(struct ibv_context *context,
 	return 0;
 }
 
+/*
+ * ibv_query_qp -- ibv_query_qp() mock
+ */
+int
+ibv_query_qp(struct ibv_qp *qp, struct ibv_qp_attr *attr, int attr_mask,
+		struct ibv_qp_init_attr *init_attr)
+{
+	assert_ptr_equal(qp, MOCK_QP);
+	assert_non_null(attr);
+	assert_int_equal(attr_mask, IBV_QP_CAP);
+	assert_non_null(init_attr);
+
+	int ret = mock_type(int);
+	if (ret)
+		return ret;
+
+	memset(init_attr, 0, sizeof(struct ibv_qp_init_attr));
+	init_attr->cap.max_inline_data = mock_type(uint32_t);
+
+	return 0;
+}
+
+/*
+ * ibv_query_port -- ibv_query_port() mock
+ *
+ * The ibv_query_port() macro falls back to this symbol when the context
+ * does not provide the query_port operation.
+ */
+#undef ibv_query_port
+int
+ibv_query_port(struct ibv_context *context, uint8_t port_num,
+		struct _compat_ibv_port_attr *port_attr)
+{
+	assert_ptr_equal(context, MOCK_VERBS);
+	assert_non_null(port_attr);
+
+	int ret = mock_type(int);
+	if (ret)
+		return ret;
+
+	struct ibv_port_attr *attr = (struct ibv_port_attr *)port_attr;
+	attr->max_msg_sz = mock_type(uint32_t);
+
+	return 0;
+}
+
 #ifdef ON_DEMAND_PAGING_SUPPORTED
 /*
  * ibv_query_device_ex_mock -- ibv_query_device_ex() mock
@@ -300,6 +346,30 @@ ibv_destroy_cq(struct ibv_cq *cq)
 	return mock_type(int);
 }
 
+/*
+ * ibv_create_srq -- ibv_create_srq() mock
+ * (the examples do not use shared receive queues)
+ */
+struct ibv_srq *
+ibv_create_srq(struct ibv_pd *pd, struct ibv_srq_init_attr *srq_init_attr)
+{
+	fail();
+
+	return NULL;
+}
+
+/*
+ * ibv_destroy_srq -- ibv_destroy_srq() mock
+ * (the examples do not use shared receive queues)
+ */
+int
+ibv_destroy_srq(struct ibv_srq *srq)
+{
+	fail();
+
+	return 0;
+}
+
 /*
  * ibv_create_comp_channel -- ibv_create_comp_channel() mock
  */
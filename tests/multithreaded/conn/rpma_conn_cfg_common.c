@@ -13,7 +13,8 @@
 
 /*
  * rpma_conn_cfg_common_prestate_init -- create a new connection
- * configuration object, set all queue sizes and timeout value
+ * configuration object, set all queue sizes, thread mode and
+ * timeout value
  */
 void
 rpma_conn_cfg_common_prestate_init(void *prestate, struct mtt_result *tr)
@@ -45,6 +46,30 @@ rpma_conn_cfg_common_prestate_init(void *prestate, struct mtt_result *tr)
 		return;
 	}
 
+	if ((ret = rpma_conn_cfg_set_thread_mode(pr->cfg_ptr,
+				RPMA_CONN_CFG_COMMON_THREAD_MODE_EXP))) {
+		MTT_RPMA_ERR(tr, "rpma_conn_cfg_set_thread_mode", ret);
+		return;
+	}
+
+	if ((ret = rpma_conn_cfg_set_comp_vector(pr->cfg_ptr,
+				RPMA_CONN_CFG_COMMON_COMP_VECTOR_EXP))) {
+		MTT_RPMA_ERR(tr, "rpma_conn_cfg_set_comp_vector", ret);
+		return;
+	}
+
+	if ((ret = rpma_conn_cfg_set_numa_node(pr->cfg_ptr,
+				RPMA_CONN_CFG_COMMON_NUMA_NODE_EXP))) {
+		MTT_RPMA_ERR(tr, "rpma_conn_cfg_set_numa_node", ret);
+		return;
+	}
+
+	if ((ret = rpma_conn_cfg_set_inline_size(pr->cfg_ptr,
+				RPMA_CONN_CFG_COMMON_INLINE_SIZE_EXP))) {
+		MTT_RPMA_ERR(tr, "rpma_conn_cfg_set_inline_size", ret);
+		return;
+	}
+
 	if ((ret = rpma_conn_cfg_set_timeout(pr->cfg_ptr,
 				RPMA_CONN_CFG_COMMON_TIMEOUT_MS_EXP)))
 		MTT_RPMA_ERR(tr, "rpma_conn_cfg_set_timeout", ret);
@@ -9,9 +9,21 @@
 #ifndef MTT_RPMA_CONN_CFG_COMMON
 #define MTT_RPMA_CONN_CFG_COMMON
 
+/* the expected completion vector */
+#define RPMA_CONN_CFG_COMMON_COMP_VECTOR_EXP RPMA_COMP_VECTOR_AUTO
+
+/* the expected inline size */
+#define RPMA_CONN_CFG_COMMON_INLINE_SIZE_EXP 64
+
+/* the expected NUMA node */
+#define RPMA_CONN_CFG_COMMON_NUMA_NODE_EXP 0
+
 /* the expected queue size */
 #define RPMA_CONN_CFG_COMMON_Q_SIZE_EXP 20
 
+/* the expected thread mode */
+#define RPMA_CONN_CFG_COMMON_THREAD_MODE_EXP RPMA_CONN_THREAD_SAFE
+
 /* the expected timeout */
 #define RPMA_CONN_CFG_COMMON_TIMEOUT_MS_EXP 2000
 
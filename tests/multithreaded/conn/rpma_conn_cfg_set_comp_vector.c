@@ -0,0 +1,64 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * rpma_conn_cfg_set_comp_vector.c -- rpma_conn_cfg_set_comp_vector
+ * multithreaded test
+ */
+
+#include <stdlib.h>
+#include <librpma.h>
+
+#include "mtt.h"
+#include "rpma_conn_cfg_common.h"
+
+/*
+ * thread -- set connection completion vector and check if its value is
+ * as expected
+ */
+static void
+thread(unsigned id, void *prestate, void *state, struct mtt_result *tr)
+{
+	struct rpma_conn_cfg_common_state *st =
+		(struct rpma_conn_cfg_common_state *)state;
+	int comp_vector;
+	int ret;
+
+	if ((ret = rpma_conn_cfg_set_comp_vector(st->cfg_ptr,
+				RPMA_CONN_CFG_COMMON_COMP_VECTOR_EXP))) {
+		MTT_RPMA_ERR(tr, "rpma_conn_cfg_set_comp_vector", ret);
+		return;
+	}
+
+	if ((ret = rpma_conn_cfg_get_comp_vector(st->cfg_ptr, &comp_vector))) {
+		MTT_RPMA_ERR(tr, "rpma_conn_cfg_get_comp_vector", ret);
+		return;
+	}
+
+	if (comp_vector != RPMA_CONN_CFG_COMMON_COMP_VECTOR_EXP)
+		MTT_ERR(tr,
+			"comp_vector != RPMA_CONN_CFG_COMMON_COMP_VECTOR_EXP",
+			EINVAL);
+}
+
+int
+main(int argc, char *argv[])
+{
+	struct mtt_args args = {0};
+
+	if (mtt_parse_args(argc, argv, &args))
+		return -1;
+
+	struct mtt_test test = {
+			NULL,
+			NULL,
+			NULL,
+			rpma_conn_cfg_common_init,
+			thread,
+			rpma_conn_cfg_common_fini,
+			NULL,
+			NULL
+	};
+
+	return mtt_run(&test, args.threads_num);
+}
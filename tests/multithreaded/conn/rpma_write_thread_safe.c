@@ -0,0 +1,336 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * rpma_write_thread_safe.c -- rpma_write multithreaded test using
+ * a connection in the RPMA_CONN_THREAD_SAFE mode
+ *
+ * All the threads share a single connection. Each of them attaches to it,
+ * posts a write and collects the completion of its own write.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <librpma.h>
+
+#include "mtt.h"
+#include "rpma_write_thread_safe.h"
+
+/* the client's part */
+
+struct prestate {
+	char *addr;
+	unsigned port;
+	struct rpma_peer *peer;
+	struct rpma_conn *conn;
+	struct rpma_mr_remote *dst_mr;
+};
+
+struct state {
+	char *src;
+	struct rpma_mr_local *src_mr;
+};
+
+/*
+ * prestate_init -- connect with the server in the thread-safe mode
+ * and get the remote memory region
+ */
+static void
+prestate_init(void *prestate, struct mtt_result *tr)
+{
+	struct prestate *pr = (struct prestate *)prestate;
+	struct ibv_context *dev;
+	struct rpma_conn_cfg *cfg = NULL;
+	struct rpma_conn_req *req = NULL;
+	struct rpma_conn_private_data pdata;
+	enum rpma_conn_event conn_event = RPMA_CONN_UNDEFINED;
+	int ret;
+
+	if ((ret = rpma_utils_get_ibv_context(pr->addr,
+			RPMA_UTIL_IBV_CONTEXT_REMOTE, &dev))) {
+		MTT_RPMA_ERR(tr, "rpma_utils_get_ibv_context", ret);
+		return;
+	}
+
+	if ((ret = rpma_peer_new(dev, &pr->peer))) {
+		MTT_RPMA_ERR(tr, "rpma_peer_new", ret);
+		return;
+	}
+
+	if ((ret = rpma_conn_cfg_new(&cfg))) {
+		MTT_RPMA_ERR(tr, "rpma_conn_cfg_new", ret);
+		goto err_peer_delete;
+	}
+
+	(void) rpma_conn_cfg_set_sq_size(cfg, WRITE_TS_Q_SIZE);
+	(void) rpma_conn_cfg_set_cq_size(cfg, WRITE_TS_Q_SIZE);
+	if ((ret = rpma_conn_cfg_set_thread_mode(cfg,
+			RPMA_CONN_THREAD_SAFE))) {
+		MTT_RPMA_ERR(tr, "rpma_conn_cfg_set_thread_mode", ret);
+		goto err_cfg_delete;
+	}
+
+	MTT_PORT_INIT;
+	MTT_PORT_SET(pr->port, 0);
+
+	/* create a connection request */
+	ret = rpma_conn_req_new(pr->peer, pr->addr, MTT_PORT_STR, cfg, &req);
+	if (ret) {
+		MTT_RPMA_ERR(tr, "rpma_conn_req_new", ret);
+		goto err_cfg_delete;
+	}
+
+	/* connect the connection request and obtain the connection object */
+	ret = rpma_conn_req_connect(&req, NULL, &pr->conn);
+	if (ret) {
+		(void) rpma_conn_req_delete(&req);
+		MTT_RPMA_ERR(tr, "rpma_conn_req_connect", ret);
+		goto err_cfg_delete;
+	}
+
+	/* wait for the connection to establish */
+	ret = rpma_conn_next_event(pr->conn, &conn_event);
+	if (ret) {
+		MTT_RPMA_ERR(tr, "rpma_conn_next_event", ret);
+		goto err_conn_delete;
+	} else if (conn_event != RPMA_CONN_ESTABLISHED) {
+		MTT_ERR_MSG(tr,
+			"rpma_conn_next_event returned an unexpected event",
+			-1);
+		goto err_conn_delete;
+	}
+
+	/* get the remote memory region's descriptor */
+	ret = rpma_conn_get_private_data(pr->conn, &pdata);
+	if (ret) {
+		MTT_RPMA_ERR(tr, "rpma_conn_get_private_data", ret);
+		goto err_conn_delete;
+	} else if (pdata.ptr == NULL) {
+		MTT_ERR_MSG(tr,
+			"The server has not provided the connection's private data",
+			-1);
+		goto err_conn_delete;
+	}
+
+	struct write_ts_pdata *wpd = pdata.ptr;
+	ret = rpma_mr_remote_from_descriptor(wpd->descriptor,
+			wpd->mr_desc_size, &pr->dst_mr);
+	if (ret) {
+		MTT_RPMA_ERR(tr, "rpma_mr_remote_from_descriptor", ret);
+		goto err_conn_delete;
+	}
+
+	(void) rpma_conn_cfg_delete(&cfg);
+
+	return;
+
+err_conn_delete:
+	(void) rpma_conn_disconnect(pr->conn);
+	(void) rpma_conn_delete(&pr->conn);
+
+err_cfg_delete:
+	(void) rpma_conn_cfg_delete(&cfg);
+
+err_peer_delete:
+	(void) rpma_peer_delete(&pr->peer);
+}
+
+/*
+ * thread_init -- attach the thread to the connection and prepare
+ * the source memory region
+ */
+static void
+thread_init(unsigned id, void *prestate, void **state_ptr,
+		struct mtt_result *tr)
+{
+	struct prestate *pr = (struct prestate *)prestate;
+	int ret;
+
+	struct state *st = (struct state *)calloc(1, sizeof(*st));
+	if (!st) {
+		MTT_ERR(tr, "calloc", errno);
+		return;
+	}
+
+	st->src = malloc(WRITE_TS_LEN);
+	if (!st->src) {
+		MTT_ERR(tr, "malloc", errno);
+		goto err_free_st;
+	}
+
+	memset(st->src, (int)('a' + id % 26), WRITE_TS_LEN);
+
+	if ((ret = rpma_mr_reg(pr->peer, st->src, WRITE_TS_LEN,
+			RPMA_MR_USAGE_WRITE_SRC, &st->src_mr))) {
+		MTT_RPMA_ERR(tr, "rpma_mr_reg", ret);
+		goto err_free_src;
+	}
+
+	if ((ret = rpma_conn_thread_attach(pr->conn))) {
+		MTT_RPMA_ERR(tr, "rpma_conn_thread_attach", ret);
+		goto err_mr_dereg;
+	}
+
+	*state_ptr = st;
+
+	return;
+
+err_mr_dereg:
+	(void) rpma_mr_dereg(&st->src_mr);
+
+err_free_src:
+	free(st->src);
+
+err_free_st:
+	free(st);
+}
+
+/*
+ * thread -- write and collect the completion of the own write
+ */
+static void
+thread(unsigned id, void *prestate, void *state, struct mtt_result *tr)
+{
+	struct prestate *pr = (struct prestate *)prestate;
+	struct state *st = (struct state *)state;
+	struct rpma_completion cmpl;
+	int ret;
+
+	size_t dst_offset = (id % WRITE_TS_SLOTS) * WRITE_TS_LEN;
+
+	for (int i = 0; i < WRITE_TS_OPS_PER_THREAD; ++i) {
+		ret = rpma_write(pr->conn, pr->dst_mr, dst_offset,
+				st->src_mr, 0, WRITE_TS_LEN,
+				RPMA_F_COMPLETION_ALWAYS, st);
+		if (ret) {
+			MTT_RPMA_ERR(tr, "rpma_write", ret);
+			return;
+		}
+
+		/* the completions of the other threads are not returned */
+		do {
+			ret = rpma_conn_completion_get(pr->conn, &cmpl);
+		} while (ret == RPMA_E_NO_COMPLETION);
+
+		if (ret) {
+			MTT_RPMA_ERR(tr, "rpma_conn_completion_get", ret);
+			return;
+		}
+
+		if (cmpl.op_context != st) {
+			MTT_ERR_MSG(tr,
+				"a completion of another thread has been returned",
+				-1);
+			return;
+		}
+
+		if (cmpl.op_status != IBV_WC_SUCCESS) {
+			MTT_ERR_MSG(tr, ibv_wc_status_str(cmpl.op_status),
+				-1);
+			return;
+		}
+	}
+}
+
+/*
+ * thread_fini -- detach the thread and release the source memory region
+ */
+static void
+thread_fini(unsigned id, void *prestate, void **state_ptr,
+		struct mtt_result *tr)
+{
+	struct prestate *pr = (struct prestate *)prestate;
+	struct state *st = (struct state *)*state_ptr;
+	int ret;
+
+	if ((ret = rpma_conn_thread_detach(pr->conn)))
+		MTT_RPMA_ERR(tr, "rpma_conn_thread_detach", ret);
+
+	if ((ret = rpma_mr_dereg(&st->src_mr)))
+		MTT_RPMA_ERR(tr, "rpma_mr_dereg", ret);
+
+	free(st->src);
+	free(st);
+	*state_ptr = NULL;
+}
+
+/*
+ * prestate_fini -- disconnect and delete the peer object
+ */
+static void
+prestate_fini(void *prestate, struct mtt_result *tr)
+{
+	struct prestate *pr = (struct prestate *)prestate;
+	enum rpma_conn_event conn_event = RPMA_CONN_UNDEFINED;
+	int ret;
+
+	if ((ret = rpma_mr_remote_delete(&pr->dst_mr)))
+		MTT_RPMA_ERR(tr, "rpma_mr_remote_delete", ret);
+
+	if ((ret = rpma_conn_disconnect(pr->conn))) {
+		MTT_RPMA_ERR(tr, "rpma_conn_disconnect", ret);
+	} else {
+		/* wait for the connection to be closed */
+		if ((ret = rpma_conn_next_event(pr->conn, &conn_event)))
+			MTT_RPMA_ERR(tr, "rpma_conn_next_event", ret);
+		else if (conn_event != RPMA_CONN_CLOSED)
+			MTT_ERR_MSG(tr,
+				"rpma_conn_next_event returned an unexpected event",
+				-1);
+	}
+
+	if ((ret = rpma_conn_delete(&pr->conn)))
+		MTT_RPMA_ERR(tr, "rpma_conn_delete", ret);
+
+	if ((ret = rpma_peer_delete(&pr->peer)))
+		MTT_RPMA_ERR(tr, "rpma_peer_delete", ret);
+}
+
+/* the server's part */
+
+struct server_prestate {
+	char *addr;
+	unsigned port;
+};
+
+/*
+ * server_main -- the main function of the server
+ */
+int server_main(char *addr, unsigned port);
+
+/*
+ * server_func -- the server function of this test
+ */
+int
+server_func(void *prestate)
+{
+	struct server_prestate *pst = prestate;
+	return server_main(pst->addr, pst->port);
+}
+
+int
+main(int argc, char *argv[])
+{
+	struct mtt_args args = {0};
+
+	if (mtt_parse_args(argc, argv, &args))
+		return -1;
+
+	struct prestate client_prestate = {args.addr, args.port};
+	struct server_prestate server_prestate = {args.addr, args.port};
+
+	struct mtt_test test = {
+			&client_prestate,
+			prestate_init,
+			NULL,
+			thread_init,
+			thread,
+			thread_fini,
+			NULL,
+			prestate_fini,
+			server_func,
+			&server_prestate
+	};
+
+	return mtt_run(&test, args.threads_num);
+}
@@ -0,0 +1,36 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * rpma_write_thread_safe.h -- common definitions of the rpma_write
+ * thread-safe multithreaded test
+ */
+
+#ifndef MTT_RPMA_WRITE_THREAD_SAFE
+#define MTT_RPMA_WRITE_THREAD_SAFE
+
+#include <stdint.h>
+
+/* the size of a single write */
+#define WRITE_TS_LEN		64
+
+/* the number of WRITE_TS_LEN-sized slots of the remote memory region */
+#define WRITE_TS_SLOTS		64
+
+#define WRITE_TS_OPS_PER_THREAD	16
+
+/* SQ and CQ sizes - big enough for a few dozens of threads */
+#define WRITE_TS_Q_SIZE		128
+
+/*
+ * Limited by the maximum length of the private data
+ * for rdma_connect() in case of RDMA_PS_TCP (56 bytes).
+ */
+#define WRITE_TS_DESC_MAX	24
+
+struct write_ts_pdata {
+	uint8_t mr_desc_size; /* size of the descriptor */
+	char descriptor[WRITE_TS_DESC_MAX];
+};
+
+#endif /* MTT_RPMA_WRITE_THREAD_SAFE */
@@ -0,0 +1,140 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * server_rpma_write_thread_safe.c -- a server of the rpma_write thread-safe
+ * MT test
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <librpma.h>
+
+#include "mtt.h"
+#include "rpma_write_thread_safe.h"
+
+int
+server_main(char *addr, unsigned port)
+{
+	struct ibv_context *dev = NULL;
+	struct rpma_peer *peer = NULL;
+	struct rpma_ep *ep = NULL;
+	struct rpma_mr_local *mr = NULL;
+	struct rpma_conn_req *req = NULL;
+	struct rpma_conn *conn = NULL;
+	enum rpma_conn_event conn_event = RPMA_CONN_UNDEFINED;
+	struct write_ts_pdata data;
+	size_t mr_desc_size;
+	int ret;
+
+	/* lookup an ibv_context via the address */
+	if ((ret = rpma_utils_get_ibv_context(addr,
+			RPMA_UTIL_IBV_CONTEXT_LOCAL, &dev))) {
+		SERVER_RPMA_ERR("rpma_utils_get_ibv_context", ret);
+		return ret;
+	}
+
+	/* create a new peer object */
+	if ((ret = rpma_peer_new(dev, &peer))) {
+		SERVER_RPMA_ERR("rpma_peer_new", ret);
+		return ret;
+	}
+
+	/* allocate and register the memory to be written to */
+	size_t size = WRITE_TS_LEN * WRITE_TS_SLOTS;
+	void *dst = calloc(1, size);
+	if (dst == NULL) {
+		ret = -1;
+		SERVER_ERR_MSG("calloc");
+		goto err_peer_delete;
+	}
+
+	if ((ret = rpma_mr_reg(peer, dst, size, RPMA_MR_USAGE_WRITE_DST,
+			&mr))) {
+		SERVER_RPMA_ERR("rpma_mr_reg", ret);
+		goto err_free;
+	}
+
+	/* prepare the descriptor of the memory region for the client */
+	if ((ret = rpma_mr_get_descriptor_size(mr, &mr_desc_size))) {
+		SERVER_RPMA_ERR("rpma_mr_get_descriptor_size", ret);
+		goto err_mr_dereg;
+	}
+
+	if (mr_desc_size > WRITE_TS_DESC_MAX) {
+		ret = -1;
+		SERVER_ERR_MSG("the memory region descriptor is too big");
+		goto err_mr_dereg;
+	}
+
+	data.mr_desc_size = (uint8_t)mr_desc_size;
+	if ((ret = rpma_mr_get_descriptor(mr, data.descriptor))) {
+		SERVER_RPMA_ERR("rpma_mr_get_descriptor", ret);
+		goto err_mr_dereg;
+	}
+
+	MTT_PORT_INIT;
+	MTT_PORT_SET(port, 0);
+
+	/* start a listening endpoint at addr:port */
+	if ((ret = rpma_ep_listen(peer, addr, MTT_PORT_STR, &ep))) {
+		SERVER_RPMA_ERR("rpma_ep_listen", ret);
+		goto err_mr_dereg;
+	}
+
+	/* receive an incoming connection request */
+	if ((ret = rpma_ep_next_conn_req(ep, NULL, &req))) {
+		SERVER_RPMA_ERR("rpma_ep_next_conn_req", ret);
+		goto err_ep_shutdown;
+	}
+
+	struct rpma_conn_private_data pdata;
+	pdata.ptr = &data;
+	pdata.len = sizeof(data);
+
+	/* accept the connection request and obtain the connection object */
+	if ((ret = rpma_conn_req_connect(&req, &pdata, &conn))) {
+		SERVER_RPMA_ERR("rpma_conn_req_connect", ret);
+		(void) rpma_conn_req_delete(&req);
+		goto err_ep_shutdown;
+	}
+
+	/* wait for the connection to be established */
+	if ((ret = rpma_conn_next_event(conn, &conn_event))) {
+		SERVER_RPMA_ERR("rpma_conn_next_event", ret);
+		goto err_conn_delete;
+	} else if (conn_event != RPMA_CONN_ESTABLISHED) {
+		SERVER_ERR_MSG(
+			"rpma_conn_next_event returned an unexpected event");
+		goto err_conn_delete;
+	}
+
+	/* wait for the connection to be closed */
+	if ((ret = rpma_conn_next_event(conn, &conn_event)))
+		SERVER_RPMA_ERR("rpma_conn_next_event", ret);
+	else if (conn_event != RPMA_CONN_CLOSED)
+		SERVER_ERR_MSG(
+			"rpma_conn_next_event returned an unexpected event");
+
+	if ((ret = rpma_conn_disconnect(conn)))
+		SERVER_RPMA_ERR("rpma_conn_disconnect", ret);
+
+err_conn_delete:
+	(void) rpma_conn_delete(&conn);
+
+err_ep_shutdown:
+	(void) rpma_ep_shutdown(&ep);
+
+err_mr_dereg:
+	(void) rpma_mr_dereg(&mr);
+
+err_free:
+	free(dst);
+
+err_peer_delete:
+	(void) rpma_peer_delete(&peer);
+
+	return ret;
+}
@@ -0,0 +1,354 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * aof-append_commit.c -- the rpma_aof_append/reserve/commit() unit tests
+ *
+ * APIs covered:
+ * - rpma_aof_append()
+ * - rpma_aof_reserve()
+ * - rpma_aof_commit()
+ */
+
+#include <string.h>
+
+#include "aof-common.h"
+#include "mocks-unistd.h"
+
+/*
+ * verify_remote -- verify the records of the remote log
+ */
+static void
+verify_remote(size_t tail)
+{
+	uint64_t remote_tail;
+	memcpy(&remote_tail, Remote, sizeof(remote_tail));
+	assert_int_equal(remote_tail, tail);
+
+	size_t valid = 0;
+	int ret = rpma_aof_verify(Remote + RPMA_AOF_DATA_OFFSET, tail, &valid);
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(valid, tail);
+}
+
+/*
+ * append__invalid_args -- invalid combinations of the arguments
+ */
+static void
+append__invalid_args(void **astate_ptr)
+{
+	struct aof_test_state *astate = *astate_ptr;
+	char data[MOCK_BUF_SIZE] = {0};
+
+	/* run test */
+	int ret1 = rpma_aof_append(NULL, data, MOCK_REC_LEN);
+	int ret2 = rpma_aof_append(astate->aof, NULL, MOCK_REC_LEN);
+	int ret3 = rpma_aof_append(astate->aof, data, 0);
+	/* the record does not fit into the ring */
+	int ret4 = rpma_aof_append(astate->aof, data, MOCK_BUF_SIZE);
+
+	/* verify the results */
+	assert_int_equal(ret1, RPMA_E_INVAL);
+	assert_int_equal(ret2, RPMA_E_INVAL);
+	assert_int_equal(ret3, RPMA_E_INVAL);
+	assert_int_equal(ret4, RPMA_E_INVAL);
+
+	/* nothing has been appended */
+	assert_int_equal(rpma_aof_commit(astate->aof, MOCK_OP_CONTEXT),
+			RPMA_E_INVAL);
+}
+
+/*
+ * reserve__invalid_args -- invalid combinations of the arguments
+ */
+static void
+reserve__invalid_args(void **astate_ptr)
+{
+	struct aof_test_state *astate = *astate_ptr;
+	void *rec = NULL;
+
+	/* run test */
+	int ret1 = rpma_aof_reserve(NULL, MOCK_REC_LEN, &rec);
+	int ret2 = rpma_aof_reserve(astate->aof, MOCK_REC_LEN, NULL);
+	int ret3 = rpma_aof_reserve(astate->aof, 0, &rec);
+
+	/* verify the results */
+	assert_int_equal(ret1, RPMA_E_INVAL);
+	assert_int_equal(ret2, RPMA_E_INVAL);
+	assert_int_equal(ret3, RPMA_E_INVAL);
+	assert_null(rec);
+}
+
+/*
+ * reserve__success -- the payload is produced directly in the ring
+ */
+static void
+reserve__success(void **astate_ptr)
+{
+	struct aof_test_state *astate = *astate_ptr;
+
+	/* run test */
+	void *rec = NULL;
+	int ret = rpma_aof_reserve(astate->aof, MOCK_REC_LEN, &rec);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(rec, (char *)astate->allocated_ring.addr + 8);
+	memset(rec, 0xAB, MOCK_REC_LEN);
+
+	aof_expect_commit(0, 0, MOCK_REC_SIZE, 0);
+	ret = rpma_aof_commit(astate->aof, MOCK_OP_CONTEXT);
+	assert_int_equal(ret, MOCK_OK);
+	verify_remote(MOCK_REC_SIZE);
+
+	uint32_t len;
+	memcpy(&len, Remote + RPMA_AOF_DATA_OFFSET, sizeof(len));
+	assert_int_equal(len, MOCK_REC_LEN);
+	assert_memory_equal(Remote + RPMA_AOF_DATA_OFFSET + 8, rec,
+			MOCK_REC_LEN);
+}
+
+/*
+ * commit__invalid_args -- NULL aof is invalid
+ */
+static void
+commit__invalid_args(void **unused)
+{
+	/* run test */
+	int ret = rpma_aof_commit(NULL, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * commit__success -- all the appended records are committed at once
+ */
+static void
+commit__success(void **astate_ptr)
+{
+	struct aof_test_state *astate = *astate_ptr;
+
+	/* configure mocks */
+	assert_int_equal(aof_append_n(astate->aof, 3), MOCK_OK);
+	aof_expect_commit(0, 0, 3 * MOCK_REC_SIZE, 0);
+
+	/* run test */
+	int ret = rpma_aof_commit(astate->aof, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_non_null(Commit_ctx);
+	verify_remote(3 * MOCK_REC_SIZE);
+
+	/* the records are not durable until the commit completes */
+	size_t tail = 1;
+	assert_int_equal(rpma_aof_get_tail(astate->aof, &tail), MOCK_OK);
+	assert_int_equal(tail, 0);
+
+	/* all the records have been committed */
+	ret = rpma_aof_commit(astate->aof, MOCK_OP_CONTEXT);
+	assert_int_equal(ret, RPMA_E_INVAL);
+
+	assert_int_equal(aof_complete(astate->aof, Commit_ctx,
+			IBV_WC_SUCCESS), MOCK_OK);
+}
+
+/*
+ * commit__post_failed -- posting one of the operations fails so
+ * the records stay appended and the commit can be repeated
+ */
+static void
+commit__post_failed(void **astate_ptr)
+{
+	struct aof_test_state *astate = *astate_ptr;
+
+	/* configure mocks */
+	assert_int_equal(aof_append_n(astate->aof, 2), MOCK_OK);
+	expect_value(rpma_write, dst_offset, RPMA_AOF_DATA_OFFSET);
+	expect_value(rpma_write, src_offset, 0);
+	expect_value(rpma_write, len, 2 * MOCK_REC_SIZE);
+	will_return(rpma_write, MOCK_OK);
+	expect_value(rpma_flush, dst_offset, RPMA_AOF_DATA_OFFSET);
+	expect_value(rpma_flush, len, 2 * MOCK_REC_SIZE);
+	expect_value(rpma_flush, flags, RPMA_F_COMPLETION_ON_ERROR);
+	will_return(rpma_flush, RPMA_E_PROVIDER);
+
+	/* run test */
+	int ret = rpma_aof_commit(astate->aof, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(Commit_ctx);
+
+	/* one more record joins the repeated commit */
+	assert_int_equal(aof_append_n(astate->aof, 1), MOCK_OK);
+	aof_expect_commit(0, 0, 3 * MOCK_REC_SIZE, 0);
+	ret = rpma_aof_commit(astate->aof, MOCK_OP_CONTEXT);
+	assert_int_equal(ret, MOCK_OK);
+	verify_remote(3 * MOCK_REC_SIZE);
+
+	assert_int_equal(aof_complete(astate->aof, Commit_ctx,
+			IBV_WC_SUCCESS), MOCK_OK);
+}
+
+/*
+ * commit__depth_E_AGAIN -- no more than depth commits can be in progress
+ */
+static void
+commit__depth_E_AGAIN(void **astate_ptr)
+{
+	struct aof_test_state *astate = *astate_ptr;
+	void *commit_ctx[MOCK_DEPTH];
+
+	/* configure mocks */
+	for (size_t i = 0; i < MOCK_DEPTH; ++i) {
+		assert_int_equal(aof_append_n(astate->aof, 1), MOCK_OK);
+		aof_expect_commit(i * MOCK_REC_SIZE, i * MOCK_REC_SIZE,
+				MOCK_REC_SIZE, 0);
+		assert_int_equal(rpma_aof_commit(astate->aof,
+				MOCK_OP_CONTEXT), MOCK_OK);
+		commit_ctx[i] = Commit_ctx;
+	}
+	assert_int_equal(aof_append_n(astate->aof, 1), MOCK_OK);
+
+	/* run test */
+	int ret = rpma_aof_commit(astate->aof, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_AGAIN);
+	assert_ptr_not_equal(commit_ctx[0], commit_ctx[1]);
+
+	for (size_t i = 0; i < MOCK_DEPTH; ++i)
+		assert_int_equal(aof_complete(astate->aof, commit_ctx[i],
+				IBV_WC_SUCCESS), MOCK_OK);
+}
+
+/*
+ * append__ring_full_E_AGAIN -- the ring is full until the commit completes
+ */
+static void
+append__ring_full_E_AGAIN(void **astate_ptr)
+{
+	struct aof_test_state *astate = *astate_ptr;
+
+	/* configure mocks */
+	assert_int_equal(aof_append_n(astate->aof, MOCK_RECS_PER_RING),
+			MOCK_OK);
+
+	/* run test */
+	int ret = aof_append_n(astate->aof, 1);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_AGAIN);
+
+	aof_expect_commit(0, 0, MOCK_BUF_SIZE, 0);
+	assert_int_equal(rpma_aof_commit(astate->aof, MOCK_OP_CONTEXT),
+			MOCK_OK);
+	assert_int_equal(aof_append_n(astate->aof, 1), RPMA_E_AGAIN);
+
+	/* the ring is released when the commit completes */
+	assert_int_equal(aof_complete(astate->aof, Commit_ctx,
+			IBV_WC_SUCCESS), MOCK_OK);
+	assert_int_equal(aof_append_n(astate->aof, MOCK_RECS_PER_RING),
+			MOCK_OK);
+}
+
+/*
+ * append__wrap -- the records wrap around the ring so the commit writes
+ * them in two pieces
+ */
+static void
+append__wrap(void **astate_ptr)
+{
+	struct aof_test_state *astate = *astate_ptr;
+	char data[2 * MOCK_REC_LEN + 10];
+	memset(data, 0xCD, sizeof(data));
+
+	/* configure mocks */
+	assert_int_equal(aof_append_n(astate->aof, 5), MOCK_OK);
+	aof_expect_commit(0, 0, 5 * MOCK_REC_SIZE, 0);
+	assert_int_equal(rpma_aof_commit(astate->aof, MOCK_OP_CONTEXT),
+			MOCK_OK);
+	void *commit_ctx = Commit_ctx;
+	assert_int_equal(aof_append_n(astate->aof, 2), MOCK_OK);
+
+	/* the end of the ring is too small so the record is staged at 0 */
+	assert_int_equal(rpma_aof_append(astate->aof, data, sizeof(data)),
+			RPMA_E_AGAIN);
+	assert_int_equal(aof_complete(astate->aof, commit_ctx,
+			IBV_WC_SUCCESS), MOCK_OK);
+	assert_int_equal(rpma_aof_append(astate->aof, data, sizeof(data)),
+			MOCK_OK);
+	aof_expect_commit(5 * MOCK_REC_SIZE, 5 * MOCK_REC_SIZE,
+			2 * MOCK_REC_SIZE, 2 * MOCK_REC_SIZE);
+
+	/* run test */
+	int ret = rpma_aof_commit(astate->aof, MOCK_OP_CONTEXT_2);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	verify_remote(9 * MOCK_REC_SIZE);
+	assert_memory_equal(Remote + RPMA_AOF_DATA_OFFSET +
+			7 * MOCK_REC_SIZE + 8, data, sizeof(data));
+
+	/* the skipped end of the ring is released too */
+	assert_int_equal(aof_complete(astate->aof, Commit_ctx,
+			IBV_WC_SUCCESS), MOCK_OK);
+	assert_int_equal(aof_append_n(astate->aof, MOCK_RECS_PER_RING),
+			MOCK_OK);
+}
+
+/*
+ * append__log_full_E_NOMEM -- the remote log is full
+ */
+static void
+append__log_full_E_NOMEM(void **unused)
+{
+	struct aof_test_state astate = {0};
+	assert_int_equal(aof_new(&astate, MOCK_LOG_SIZE - MOCK_REC_SIZE), 0);
+
+	/* configure mocks */
+	assert_int_equal(aof_append_n(astate.aof, 1), MOCK_OK);
+
+	/* run test */
+	int ret = aof_append_n(astate.aof, 1);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NOMEM);
+
+	void *astate_ptr = &astate;
+	assert_int_equal(teardown__aof_delete(&astate_ptr), 0);
+}
+
+static const struct CMUnitTest tests_append_commit[] = {
+	/* rpma_aof_append()/reserve() unit tests */
+	cmocka_unit_test_setup_teardown(append__invalid_args,
+		setup__aof_new, teardown__aof_delete),
+	cmocka_unit_test_setup_teardown(reserve__invalid_args,
+		setup__aof_new, teardown__aof_delete),
+	cmocka_unit_test_setup_teardown(reserve__success,
+		setup__aof_new, teardown__aof_delete),
+	cmocka_unit_test_setup_teardown(append__ring_full_E_AGAIN,
+		setup__aof_new, teardown__aof_delete),
+	cmocka_unit_test_setup_teardown(append__wrap,
+		setup__aof_new, teardown__aof_delete),
+	cmocka_unit_test(append__log_full_E_NOMEM),
+
+	/* rpma_aof_commit() unit tests */
+	cmocka_unit_test(commit__invalid_args),
+	cmocka_unit_test_setup_teardown(commit__success,
+		setup__aof_new, teardown__aof_delete),
+	cmocka_unit_test_setup_teardown(commit__post_failed,
+		setup__aof_new, teardown__aof_delete),
+	cmocka_unit_test_setup_teardown(commit__depth_E_AGAIN,
+		setup__aof_new, teardown__aof_delete),
+
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_append_commit, NULL, NULL);
+}
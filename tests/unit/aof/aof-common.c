@@ -0,0 +1,266 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * aof-common.c -- the rpma_aof unit tests common functions
+ */
+
+#include <string.h>
+
+#include "aof-common.h"
+#include "mocks-unistd.h"
+
+char Remote[MOCK_DST_SIZE];
+
+void *Write_ctx;
+void *Commit_ctx;
+
+/* the staging ring of the most recently created log */
+static struct mmap_args *Ring;
+
+/*
+ * rpma_mr_remote_get_size -- rpma_mr_remote_get_size() mock
+ */
+int
+rpma_mr_remote_get_size(const struct rpma_mr_remote *mr, size_t *size)
+{
+	assert_ptr_equal(mr, MOCK_RPMA_MR_REMOTE);
+	assert_non_null(size);
+
+	*size = MOCK_DST_SIZE;
+
+	return 0;
+}
+
+/*
+ * rpma_write -- rpma_write() mock
+ */
+int
+rpma_write(struct rpma_conn *conn,
+		struct rpma_mr_remote *dst, size_t dst_offset,
+		const struct rpma_mr_local *src,  size_t src_offset,
+		size_t len, int flags, const void *op_context)
+{
+	assert_ptr_equal(conn, MOCK_CONN);
+	assert_ptr_equal(dst, MOCK_RPMA_MR_REMOTE);
+	assert_ptr_equal(src, MOCK_RPMA_MR_LOCAL);
+	assert_int_equal(flags, RPMA_F_COMPLETION_ON_ERROR);
+	assert_non_null(op_context);
+	check_expected(dst_offset);
+	check_expected(src_offset);
+	check_expected(len);
+
+	Write_ctx = (void *)op_context;
+
+	int ret = mock_type(int);
+	if (ret == MOCK_OK)
+		memcpy(Remote + dst_offset, (char *)Ring->addr + src_offset,
+				len);
+
+	return ret;
+}
+
+/*
+ * rpma_write_atomic -- rpma_write_atomic() mock
+ */
+int
+rpma_write_atomic(struct rpma_conn *conn,
+		struct rpma_mr_remote *dst, size_t dst_offset,
+		const struct rpma_mr_local *src,  size_t src_offset,
+		int flags, const void *op_context)
+{
+	assert_ptr_equal(conn, MOCK_CONN);
+	assert_ptr_equal(dst, MOCK_RPMA_MR_REMOTE);
+	assert_int_equal(dst_offset, 0);
+	assert_ptr_equal(src, MOCK_RPMA_MR_LOCAL);
+	assert_true(src_offset >= MOCK_BUF_SIZE);
+	assert_true(src_offset + 8 <= MOCK_RING_SIZE);
+	assert_int_equal(flags, RPMA_F_COMPLETION_ON_ERROR);
+	assert_non_null(op_context);
+
+	uint64_t tail;
+	memcpy(&tail, (char *)Ring->addr + src_offset, sizeof(tail));
+	check_expected(tail);
+
+	int ret = mock_type(int);
+	if (ret == MOCK_OK)
+		memcpy(Remote, &tail, sizeof(tail));
+
+	return ret;
+}
+
+/*
+ * rpma_flush -- rpma_flush() mock
+ */
+int
+rpma_flush(struct rpma_conn *conn,
+		struct rpma_mr_remote *dst, size_t dst_offset, size_t len,
+		enum rpma_flush_type type, int flags, const void *op_context)
+{
+	assert_ptr_equal(conn, MOCK_CONN);
+	assert_ptr_equal(dst, MOCK_RPMA_MR_REMOTE);
+	assert_int_equal(type, RPMA_FLUSH_TYPE_PERSISTENT);
+	assert_non_null(op_context);
+	check_expected(dst_offset);
+	check_expected(len);
+	check_expected(flags);
+
+	if (flags == RPMA_F_COMPLETION_ALWAYS)
+		Commit_ctx = (void *)op_context;
+
+	return mock_type(int);
+}
+
+/*
+ * aof_expect_new -- configure the mocks of creating the log up to
+ * the registration of the staging ring
+ */
+void
+aof_expect_new(struct mmap_args *allocated_ring, int flush_types)
+{
+	Ring = allocated_ring;
+
+	expect_value(rpma_mr_remote_get_flush_type, mr, MOCK_RPMA_MR_REMOTE);
+	will_return(rpma_mr_remote_get_flush_type, flush_types);
+	will_return(__wrap_sysconf, MOCK_OK);
+	will_return(__wrap_mmap, MOCK_OK);
+	will_return(__wrap_mmap, allocated_ring);
+	expect_value(rpma_mr_reg, peer, MOCK_PEER);
+	expect_value(rpma_mr_reg, size, MOCK_RING_SIZE);
+	expect_value(rpma_mr_reg, usage, RPMA_MR_USAGE_WRITE_SRC);
+	will_return(rpma_mr_reg, &allocated_ring->addr);
+}
+
+/*
+ * aof_new -- create a valid log starting at the tail
+ */
+int
+aof_new(struct aof_test_state *astate, size_t tail)
+{
+	/* configure mocks */
+	aof_expect_new(&astate->allocated_ring, MOCK_FLUSH_TYPES);
+	will_return(rpma_mr_reg, MOCK_RPMA_MR_LOCAL);
+	will_return_count(__wrap__test_malloc, MOCK_OK, 2);
+
+	/* run test */
+	astate->aof = NULL;
+	int ret = rpma_aof_new(MOCK_PEER, MOCK_CONN, MOCK_RPMA_MR_REMOTE,
+			tail, MOCK_BUF_SIZE, MOCK_DEPTH, &astate->aof);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_non_null(astate->aof);
+	assert_int_equal(astate->allocated_ring.len, PAGESIZE);
+
+	memset(Remote, 0, sizeof(Remote));
+	Write_ctx = NULL;
+	Commit_ctx = NULL;
+
+	return 0;
+}
+
+/*
+ * setup__aof_new -- prepare a valid empty log
+ */
+int
+setup__aof_new(void **astate_ptr)
+{
+	static struct aof_test_state astate = {0};
+
+	int ret = aof_new(&astate, 0);
+	*astate_ptr = &astate;
+
+	return ret;
+}
+
+/*
+ * teardown__aof_delete -- delete the log
+ */
+int
+teardown__aof_delete(void **astate_ptr)
+{
+	struct aof_test_state *astate = *astate_ptr;
+
+	/* configure mocks */
+	expect_value(rpma_mr_dereg, *mr_ptr, MOCK_RPMA_MR_LOCAL);
+	will_return(rpma_mr_dereg, MOCK_OK);
+	will_return(__wrap_munmap, &astate->allocated_ring);
+	will_return(__wrap_munmap, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_aof_delete(&astate->aof);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_null(astate->aof);
+
+	return 0;
+}
+
+/*
+ * aof_expect_commit -- expect all the operations of a commit of the records
+ * at the pos of the log staged at the start of the ring (len2 bytes
+ * of them wrapped around the ring) to be posted successfully
+ */
+void
+aof_expect_commit(size_t pos, size_t start, size_t len1, size_t len2)
+{
+	expect_value(rpma_write, dst_offset, RPMA_AOF_DATA_OFFSET + pos);
+	expect_value(rpma_write, src_offset, start);
+	expect_value(rpma_write, len, len1);
+	will_return(rpma_write, MOCK_OK);
+	if (len2) {
+		expect_value(rpma_write, dst_offset,
+				RPMA_AOF_DATA_OFFSET + pos + len1);
+		expect_value(rpma_write, src_offset, 0);
+		expect_value(rpma_write, len, len2);
+		will_return(rpma_write, MOCK_OK);
+	}
+
+	expect_value(rpma_flush, dst_offset, RPMA_AOF_DATA_OFFSET + pos);
+	expect_value(rpma_flush, len, len1 + len2);
+	expect_value(rpma_flush, flags, RPMA_F_COMPLETION_ON_ERROR);
+	will_return(rpma_flush, MOCK_OK);
+
+	expect_value(rpma_write_atomic, tail, pos + len1 + len2);
+	will_return(rpma_write_atomic, MOCK_OK);
+
+	expect_value(rpma_flush, dst_offset, 0);
+	expect_value(rpma_flush, len, 8);
+	expect_value(rpma_flush, flags, RPMA_F_COMPLETION_ALWAYS);
+	will_return(rpma_flush, MOCK_OK);
+}
+
+/*
+ * aof_append_n -- append n records of MOCK_REC_LEN bytes filled with
+ * their sequence numbers
+ */
+int
+aof_append_n(struct rpma_aof *aof, int n)
+{
+	static char seq;
+	char data[MOCK_REC_LEN];
+
+	for (int i = 0; i < n; ++i) {
+		memset(data, ++seq, sizeof(data));
+		int ret = rpma_aof_append(aof, data, sizeof(data));
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+/*
+ * aof_complete -- pass the completion of an operation to the log
+ */
+int
+aof_complete(struct rpma_aof *aof, void *ctx, enum ibv_wc_status status)
+{
+	struct rpma_completion cmpl = {0};
+	cmpl.op_context = ctx;
+	cmpl.op = RPMA_OP_FLUSH;
+	cmpl.op_status = status;
+
+	return rpma_aof_process(aof, &cmpl);
+}
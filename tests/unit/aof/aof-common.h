@@ -0,0 +1,55 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * aof-common.h -- the rpma_aof unit tests common definitions
+ */
+
+#ifndef AOF_COMMON_H
+#define AOF_COMMON_H
+
+#include "cmocka_headers.h"
+#include "librpma.h"
+#include "mocks-stdlib.h"
+#include "test-common.h"
+
+#define MOCK_RPMA_MR_REMOTE	((struct rpma_mr_remote *)0xC412)
+#define MOCK_DST_SIZE		(size_t)4096
+#define MOCK_LOG_SIZE		(MOCK_DST_SIZE - RPMA_AOF_DATA_OFFSET)
+#define MOCK_FLUSH_TYPES	(RPMA_MR_USAGE_FLUSH_TYPE_PERSISTENT | \
+				RPMA_MR_USAGE_FLUSH_TYPE_VISIBILITY)
+
+#define MOCK_BUF_SIZE		256
+#define MOCK_DEPTH		2
+#define MOCK_RING_SIZE		(MOCK_BUF_SIZE + MOCK_DEPTH * 8)
+
+/* a record of MOCK_REC_LEN bytes takes MOCK_REC_SIZE bytes of the log */
+#define MOCK_REC_LEN		20
+#define MOCK_REC_SIZE		32
+#define MOCK_RECS_PER_RING	(MOCK_BUF_SIZE / MOCK_REC_SIZE)
+
+#define MOCK_OP_CONTEXT_2	(void *)0xC418
+
+struct aof_test_state {
+	struct rpma_aof *aof;
+	struct mmap_args allocated_ring;
+};
+
+/* the contents of the remote memory region written by the mocks */
+extern char Remote[MOCK_DST_SIZE];
+
+/* the op_contexts of the most recently posted write and the last flush */
+extern void *Write_ctx;
+extern void *Commit_ctx;
+
+void aof_expect_new(struct mmap_args *allocated_ring, int flush_types);
+int aof_new(struct aof_test_state *astate, size_t tail);
+int setup__aof_new(void **astate_ptr);
+int teardown__aof_delete(void **astate_ptr);
+
+void aof_expect_commit(size_t pos, size_t start, size_t len1, size_t len2);
+int aof_append_n(struct rpma_aof *aof, int n);
+int aof_complete(struct rpma_aof *aof, void *ctx,
+		enum ibv_wc_status status);
+
+#endif /* AOF_COMMON_H */
@@ -0,0 +1,329 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * aof-new_delete.c -- the rpma_aof_new/delete() unit tests
+ *
+ * APIs covered:
+ * - rpma_aof_new()
+ * - rpma_aof_delete()
+ */
+
+#include "aof-common.h"
+#include "mocks-unistd.h"
+
+/*
+ * new__invalid_args -- invalid combinations of the arguments
+ */
+static void
+new__invalid_args(void **unused)
+{
+	struct rpma_aof *aof = NULL;
+	struct {
+		struct rpma_peer *peer;
+		struct rpma_conn *conn;
+		struct rpma_mr_remote *dst;
+		size_t tail;
+		size_t buf_size;
+		uint32_t depth;
+		struct rpma_aof **aof_ptr;
+	} args[] = {
+		{NULL, MOCK_CONN, MOCK_RPMA_MR_REMOTE, 0, MOCK_BUF_SIZE,
+			MOCK_DEPTH, &aof},
+		{MOCK_PEER, NULL, MOCK_RPMA_MR_REMOTE, 0, MOCK_BUF_SIZE,
+			MOCK_DEPTH, &aof},
+		{MOCK_PEER, MOCK_CONN, NULL, 0, MOCK_BUF_SIZE, MOCK_DEPTH,
+			&aof},
+		{MOCK_PEER, MOCK_CONN, MOCK_RPMA_MR_REMOTE, 0, MOCK_BUF_SIZE,
+			0, &aof},
+		/* the ring cannot hold a single record */
+		{MOCK_PEER, MOCK_CONN, MOCK_RPMA_MR_REMOTE, 0, 8, MOCK_DEPTH,
+			&aof},
+		/* the size of the ring is not aligned */
+		{MOCK_PEER, MOCK_CONN, MOCK_RPMA_MR_REMOTE, 0,
+			MOCK_BUF_SIZE + 4, MOCK_DEPTH, &aof},
+		/* the size of the ring overflows */
+		{MOCK_PEER, MOCK_CONN, MOCK_RPMA_MR_REMOTE, 0, SIZE_MAX - 7,
+			MOCK_DEPTH, &aof},
+		/* the tail is not aligned */
+		{MOCK_PEER, MOCK_CONN, MOCK_RPMA_MR_REMOTE, 4, MOCK_BUF_SIZE,
+			MOCK_DEPTH, &aof},
+		/* the tail is beyond the end of the region */
+		{MOCK_PEER, MOCK_CONN, MOCK_RPMA_MR_REMOTE, MOCK_LOG_SIZE + 8,
+			MOCK_BUF_SIZE, MOCK_DEPTH, &aof},
+		{MOCK_PEER, MOCK_CONN, MOCK_RPMA_MR_REMOTE, 0, MOCK_BUF_SIZE,
+			MOCK_DEPTH, NULL},
+	};
+
+	for (size_t i = 0; i < sizeof(args) / sizeof(args[0]); ++i) {
+		/* run test */
+		int ret = rpma_aof_new(args[i].peer, args[i].conn,
+				args[i].dst, args[i].tail, args[i].buf_size,
+				args[i].depth, args[i].aof_ptr);
+
+		/* verify the results */
+		assert_int_equal(ret, RPMA_E_INVAL);
+		assert_null(aof);
+	}
+}
+
+/*
+ * new__no_flush_E_NOSUPP -- the region cannot be flushed
+ */
+static void
+new__no_flush_E_NOSUPP(void **unused)
+{
+	/* configure mocks */
+	expect_value(rpma_mr_remote_get_flush_type, mr, MOCK_RPMA_MR_REMOTE);
+	will_return(rpma_mr_remote_get_flush_type, 0);
+
+	/* run test */
+	struct rpma_aof *aof = NULL;
+	int ret = rpma_aof_new(MOCK_PEER, MOCK_CONN, MOCK_RPMA_MR_REMOTE, 0,
+			MOCK_BUF_SIZE, MOCK_DEPTH, &aof);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NOSUPP);
+	assert_null(aof);
+}
+
+/*
+ * new__sysconf_ERRNO -- sysconf() fails with MOCK_ERRNO
+ */
+static void
+new__sysconf_ERRNO(void **unused)
+{
+	/* configure mocks */
+	expect_value(rpma_mr_remote_get_flush_type, mr, MOCK_RPMA_MR_REMOTE);
+	will_return(rpma_mr_remote_get_flush_type, MOCK_FLUSH_TYPES);
+	will_return(__wrap_sysconf, MOCK_ERRNO);
+
+	/* run test */
+	struct rpma_aof *aof = NULL;
+	int ret = rpma_aof_new(MOCK_PEER, MOCK_CONN, MOCK_RPMA_MR_REMOTE, 0,
+			MOCK_BUF_SIZE, MOCK_DEPTH, &aof);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(aof);
+}
+
+/*
+ * new__mmap_ERRNO -- mmap() fails with MOCK_ERRNO
+ */
+static void
+new__mmap_ERRNO(void **unused)
+{
+	/* configure mocks */
+	expect_value(rpma_mr_remote_get_flush_type, mr, MOCK_RPMA_MR_REMOTE);
+	will_return(rpma_mr_remote_get_flush_type, MOCK_FLUSH_TYPES);
+	will_return(__wrap_sysconf, MOCK_OK);
+	will_return(__wrap_mmap, MOCK_ERRNO);
+
+	/* run test */
+	struct rpma_aof *aof = NULL;
+	int ret = rpma_aof_new(MOCK_PEER, MOCK_CONN, MOCK_RPMA_MR_REMOTE, 0,
+			MOCK_BUF_SIZE, MOCK_DEPTH, &aof);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NOMEM);
+	assert_null(aof);
+}
+
+/*
+ * new__mr_reg_E_PROVIDER -- rpma_mr_reg() fails with RPMA_E_PROVIDER
+ */
+static void
+new__mr_reg_E_PROVIDER(void **unused)
+{
+	struct mmap_args allocated_ring = {0};
+
+	/* configure mocks */
+	aof_expect_new(&allocated_ring, MOCK_FLUSH_TYPES);
+	will_return(rpma_mr_reg, NULL);
+	will_return(rpma_mr_reg, RPMA_E_PROVIDER);
+	will_return(__wrap_munmap, &allocated_ring);
+	will_return(__wrap_munmap, MOCK_OK);
+
+	/* run test */
+	struct rpma_aof *aof = NULL;
+	int ret = rpma_aof_new(MOCK_PEER, MOCK_CONN, MOCK_RPMA_MR_REMOTE, 0,
+			MOCK_BUF_SIZE, MOCK_DEPTH, &aof);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(aof);
+}
+
+/*
+ * new__malloc_ERRNO -- malloc() fails with MOCK_ERRNO
+ */
+static void
+new__malloc_ERRNO(void **unused)
+{
+	/* each of the two malloc() calls fails in turn */
+	for (int i = 0; i < 2; ++i) {
+		struct mmap_args allocated_ring = {0};
+
+		/* configure mocks */
+		aof_expect_new(&allocated_ring, MOCK_FLUSH_TYPES);
+		will_return(rpma_mr_reg, MOCK_RPMA_MR_LOCAL);
+		for (int j = 0; j < i; ++j)
+			will_return(__wrap__test_malloc, MOCK_OK);
+		will_return(__wrap__test_malloc, MOCK_ERRNO);
+		expect_value(rpma_mr_dereg, *mr_ptr, MOCK_RPMA_MR_LOCAL);
+		will_return(rpma_mr_dereg, MOCK_OK);
+		will_return(__wrap_munmap, &allocated_ring);
+		will_return(__wrap_munmap, MOCK_OK);
+
+		/* run test */
+		struct rpma_aof *aof = NULL;
+		int ret = rpma_aof_new(MOCK_PEER, MOCK_CONN,
+				MOCK_RPMA_MR_REMOTE, 0, MOCK_BUF_SIZE,
+				MOCK_DEPTH, &aof);
+
+		/* verify the results */
+		assert_int_equal(ret, RPMA_E_NOMEM);
+		assert_null(aof);
+	}
+}
+
+/*
+ * new__visibility_E_NOSUPP -- the region can be flushed only to visibility
+ */
+static void
+new__visibility_E_NOSUPP(void **unused)
+{
+	/* configure mocks */
+	expect_value(rpma_mr_remote_get_flush_type, mr, MOCK_RPMA_MR_REMOTE);
+	will_return(rpma_mr_remote_get_flush_type,
+			RPMA_MR_USAGE_FLUSH_TYPE_VISIBILITY);
+
+	/* run test */
+	struct rpma_aof *aof = NULL;
+	int ret = rpma_aof_new(MOCK_PEER, MOCK_CONN, MOCK_RPMA_MR_REMOTE, 0,
+			MOCK_BUF_SIZE, MOCK_DEPTH, &aof);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NOSUPP);
+	assert_null(aof);
+}
+
+/*
+ * test_lifecycle -- happy day scenario
+ */
+static void
+test_lifecycle(void **unused)
+{
+	/*
+	 * the thing is done by setup__aof_new() and teardown__aof_delete()
+	 */
+}
+
+/*
+ * delete__aof_ptr_NULL -- NULL aof_ptr is invalid
+ */
+static void
+delete__aof_ptr_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_aof_delete(NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * delete__aof_NULL -- NULL aof is valid - quick exit
+ */
+static void
+delete__aof_NULL(void **unused)
+{
+	/* run test */
+	struct rpma_aof *aof = NULL;
+	int ret = rpma_aof_delete(&aof);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * delete__mr_dereg_E_PROVIDER -- rpma_mr_dereg() fails with
+ * RPMA_E_PROVIDER
+ */
+static void
+delete__mr_dereg_E_PROVIDER(void **unused)
+{
+	struct aof_test_state *astate;
+
+	/* WA for cmocka/issues#47 */
+	assert_int_equal(setup__aof_new((void **)&astate), 0);
+
+	/* configure mocks */
+	expect_value(rpma_mr_dereg, *mr_ptr, MOCK_RPMA_MR_LOCAL);
+	will_return(rpma_mr_dereg, RPMA_E_PROVIDER);
+	will_return(rpma_mr_dereg, MOCK_ERRNO);
+	will_return(__wrap_munmap, &astate->allocated_ring);
+	will_return(__wrap_munmap, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_aof_delete(&astate->aof);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(astate->aof);
+}
+
+/*
+ * delete__munmap_ERRNO -- munmap() fails with MOCK_ERRNO
+ */
+static void
+delete__munmap_ERRNO(void **unused)
+{
+	struct aof_test_state *astate;
+
+	/* WA for cmocka/issues#47 */
+	assert_int_equal(setup__aof_new((void **)&astate), 0);
+
+	/* configure mocks */
+	expect_value(rpma_mr_dereg, *mr_ptr, MOCK_RPMA_MR_LOCAL);
+	will_return(rpma_mr_dereg, MOCK_OK);
+	will_return(__wrap_munmap, &astate->allocated_ring);
+	will_return(__wrap_munmap, MOCK_ERRNO);
+
+	/* run test */
+	int ret = rpma_aof_delete(&astate->aof);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(astate->aof);
+}
+
+static const struct CMUnitTest tests_new_delete[] = {
+	/* rpma_aof_new() unit tests */
+	cmocka_unit_test(new__invalid_args),
+	cmocka_unit_test(new__no_flush_E_NOSUPP),
+	cmocka_unit_test(new__sysconf_ERRNO),
+	cmocka_unit_test(new__mmap_ERRNO),
+	cmocka_unit_test(new__mr_reg_E_PROVIDER),
+	cmocka_unit_test(new__malloc_ERRNO),
+	cmocka_unit_test(new__visibility_E_NOSUPP),
+
+	/* rpma_aof_new()/delete() lifecycle */
+	cmocka_unit_test_setup_teardown(test_lifecycle,
+		setup__aof_new, teardown__aof_delete),
+
+	/* rpma_aof_delete() unit tests */
+	cmocka_unit_test(delete__aof_ptr_NULL),
+	cmocka_unit_test(delete__aof_NULL),
+	cmocka_unit_test(delete__mr_dereg_E_PROVIDER),
+	cmocka_unit_test(delete__munmap_ERRNO),
+
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_new_delete, NULL, NULL);
+}
@@ -0,0 +1,267 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * aof-process_next.c -- the rpma_aof_process/next/get_tail() unit tests
+ *
+ * APIs covered:
+ * - rpma_aof_process()
+ * - rpma_aof_next()
+ * - rpma_aof_get_tail()
+ */
+
+#include "aof-common.h"
+#include "mocks-unistd.h"
+
+/*
+ * commit_n -- append and commit n records at the pos of the log staged
+ * at the start of the ring
+ */
+static void *
+commit_n(struct rpma_aof *aof, size_t pos, size_t start, int n,
+		const void *op_context)
+{
+	assert_int_equal(aof_append_n(aof, n), MOCK_OK);
+	aof_expect_commit(pos, start, (size_t)n * MOCK_REC_SIZE, 0);
+	assert_int_equal(rpma_aof_commit(aof, op_context), MOCK_OK);
+
+	return Commit_ctx;
+}
+
+/*
+ * process__invalid_args -- invalid combinations of the arguments
+ */
+static void
+process__invalid_args(void **astate_ptr)
+{
+	struct aof_test_state *astate = *astate_ptr;
+	struct rpma_completion cmpl = {0};
+
+	/* run test */
+	int ret1 = rpma_aof_process(NULL, &cmpl);
+	int ret2 = rpma_aof_process(astate->aof, NULL);
+	/* the completion does not come from the log */
+	int ret3 = aof_complete(astate->aof, MOCK_OP_CONTEXT, IBV_WC_SUCCESS);
+
+	/* verify the results */
+	assert_int_equal(ret1, RPMA_E_INVAL);
+	assert_int_equal(ret2, RPMA_E_INVAL);
+	assert_int_equal(ret3, RPMA_E_INVAL);
+}
+
+/*
+ * process__not_pending -- the completion of a commit which is not
+ * in progress is invalid
+ */
+static void
+process__not_pending(void **astate_ptr)
+{
+	struct aof_test_state *astate = *astate_ptr;
+	void *commit_ctx = commit_n(astate->aof, 0, 0, 1, MOCK_OP_CONTEXT);
+	assert_int_equal(aof_complete(astate->aof, commit_ctx,
+			IBV_WC_SUCCESS), MOCK_OK);
+
+	/* run test */
+	int ret = aof_complete(astate->aof, commit_ctx, IBV_WC_SUCCESS);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * process__success -- the commit completes and advances the tail
+ */
+static void
+process__success(void **astate_ptr)
+{
+	struct aof_test_state *astate = *astate_ptr;
+	void *commit_ctx = commit_n(astate->aof, 0, 0, 3, MOCK_OP_CONTEXT);
+
+	/* run test */
+	int ret = aof_complete(astate->aof, commit_ctx, IBV_WC_SUCCESS);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	size_t tail = 0;
+	assert_int_equal(rpma_aof_get_tail(astate->aof, &tail), MOCK_OK);
+	assert_int_equal(tail, 3 * MOCK_REC_SIZE);
+
+	struct rpma_completion cmpl = {0};
+	ret = rpma_aof_next(astate->aof, &cmpl);
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(cmpl.op_context, MOCK_OP_CONTEXT);
+	assert_int_equal(cmpl.op, RPMA_OP_FLUSH);
+	assert_int_equal(cmpl.op_status, IBV_WC_SUCCESS);
+
+	ret = rpma_aof_next(astate->aof, &cmpl);
+	assert_int_equal(ret, RPMA_E_NO_COMPLETION);
+}
+
+/*
+ * process__write_failed -- a failed operation fails the commit and
+ * the tail is not advanced
+ */
+static void
+process__write_failed(void **astate_ptr)
+{
+	struct aof_test_state *astate = *astate_ptr;
+	void *commit_ctx = commit_n(astate->aof, 0, 0, 2, MOCK_OP_CONTEXT);
+
+	/* run test */
+	int ret = aof_complete(astate->aof, Write_ctx, IBV_WC_REM_ACCESS_ERR);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	struct rpma_completion cmpl = {0};
+	ret = rpma_aof_next(astate->aof, &cmpl);
+	assert_int_equal(ret, RPMA_E_NO_COMPLETION);
+
+	/* the following operations are flushed with an error */
+	ret = aof_complete(astate->aof, commit_ctx, IBV_WC_WR_FLUSH_ERR);
+	assert_int_equal(ret, MOCK_OK);
+	ret = rpma_aof_next(astate->aof, &cmpl);
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(cmpl.op_context, MOCK_OP_CONTEXT);
+	assert_int_equal(cmpl.op_status, IBV_WC_REM_ACCESS_ERR);
+
+	size_t tail = 1;
+	assert_int_equal(rpma_aof_get_tail(astate->aof, &tail), MOCK_OK);
+	assert_int_equal(tail, 0);
+}
+
+/*
+ * process__in_order -- the commits are reported in the order they have
+ * been initiated
+ */
+static void
+process__in_order(void **astate_ptr)
+{
+	struct aof_test_state *astate = *astate_ptr;
+	void *commit_ctx1 = commit_n(astate->aof, 0, 0, 1, MOCK_OP_CONTEXT);
+	void *commit_ctx2 = commit_n(astate->aof, MOCK_REC_SIZE,
+			MOCK_REC_SIZE, 2, MOCK_OP_CONTEXT_2);
+
+	/* run test */
+	int ret = aof_complete(astate->aof, commit_ctx2, IBV_WC_SUCCESS);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	struct rpma_completion cmpl = {0};
+	ret = rpma_aof_next(astate->aof, &cmpl);
+	assert_int_equal(ret, RPMA_E_NO_COMPLETION);
+	size_t tail = 1;
+	assert_int_equal(rpma_aof_get_tail(astate->aof, &tail), MOCK_OK);
+	assert_int_equal(tail, 0);
+
+	ret = aof_complete(astate->aof, commit_ctx1, IBV_WC_SUCCESS);
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(rpma_aof_get_tail(astate->aof, &tail), MOCK_OK);
+	assert_int_equal(tail, 3 * MOCK_REC_SIZE);
+
+	ret = rpma_aof_next(astate->aof, &cmpl);
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(cmpl.op_context, MOCK_OP_CONTEXT);
+	ret = rpma_aof_next(astate->aof, &cmpl);
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(cmpl.op_context, MOCK_OP_CONTEXT_2);
+	ret = rpma_aof_next(astate->aof, &cmpl);
+	assert_int_equal(ret, RPMA_E_NO_COMPLETION);
+}
+
+/*
+ * next__invalid_args -- invalid combinations of the arguments
+ */
+static void
+next__invalid_args(void **astate_ptr)
+{
+	struct aof_test_state *astate = *astate_ptr;
+	struct rpma_completion cmpl = {0};
+
+	/* run test */
+	int ret1 = rpma_aof_next(NULL, &cmpl);
+	int ret2 = rpma_aof_next(astate->aof, NULL);
+	int ret3 = rpma_aof_next(astate->aof, &cmpl);
+
+	/* verify the results */
+	assert_int_equal(ret1, RPMA_E_INVAL);
+	assert_int_equal(ret2, RPMA_E_INVAL);
+	assert_int_equal(ret3, RPMA_E_NO_COMPLETION);
+}
+
+/*
+ * get_tail__invalid_args -- invalid combinations of the arguments
+ */
+static void
+get_tail__invalid_args(void **astate_ptr)
+{
+	struct aof_test_state *astate = *astate_ptr;
+	size_t tail = 0;
+
+	/* run test */
+	int ret1 = rpma_aof_get_tail(NULL, &tail);
+	int ret2 = rpma_aof_get_tail(astate->aof, NULL);
+
+	/* verify the results */
+	assert_int_equal(ret1, RPMA_E_INVAL);
+	assert_int_equal(ret2, RPMA_E_INVAL);
+}
+
+/*
+ * get_tail__initial -- the log starts at the given tail
+ */
+static void
+get_tail__initial(void **unused)
+{
+	struct aof_test_state astate = {0};
+	assert_int_equal(aof_new(&astate, 2 * MOCK_REC_SIZE), 0);
+
+	/* run test */
+	size_t tail = 0;
+	int ret = rpma_aof_get_tail(astate.aof, &tail);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(tail, 2 * MOCK_REC_SIZE);
+
+	/* the new records follow the existing ones */
+	void *commit_ctx = commit_n(astate.aof, 2 * MOCK_REC_SIZE, 0, 1,
+			MOCK_OP_CONTEXT);
+	assert_int_equal(aof_complete(astate.aof, commit_ctx,
+			IBV_WC_SUCCESS), MOCK_OK);
+	assert_int_equal(rpma_aof_get_tail(astate.aof, &tail), MOCK_OK);
+	assert_int_equal(tail, 3 * MOCK_REC_SIZE);
+
+	void *astate_ptr = &astate;
+	assert_int_equal(teardown__aof_delete(&astate_ptr), 0);
+}
+
+static const struct CMUnitTest tests_process_next[] = {
+	/* rpma_aof_process() unit tests */
+	cmocka_unit_test_setup_teardown(process__invalid_args,
+		setup__aof_new, teardown__aof_delete),
+	cmocka_unit_test_setup_teardown(process__not_pending,
+		setup__aof_new, teardown__aof_delete),
+	cmocka_unit_test_setup_teardown(process__success,
+		setup__aof_new, teardown__aof_delete),
+	cmocka_unit_test_setup_teardown(process__write_failed,
+		setup__aof_new, teardown__aof_delete),
+	cmocka_unit_test_setup_teardown(process__in_order,
+		setup__aof_new, teardown__aof_delete),
+
+	/* rpma_aof_next() unit tests */
+	cmocka_unit_test_setup_teardown(next__invalid_args,
+		setup__aof_new, teardown__aof_delete),
+
+	/* rpma_aof_get_tail() unit tests */
+	cmocka_unit_test_setup_teardown(get_tail__invalid_args,
+		setup__aof_new, teardown__aof_delete),
+	cmocka_unit_test(get_tail__initial),
+
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_process_next, NULL, NULL);
+}
@@ -0,0 +1,170 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * aof-verify.c -- the rpma_aof_verify() unit tests
+ *
+ * API covered:
+ * - rpma_aof_verify()
+ */
+
+#include <string.h>
+
+#include "aof-common.h"
+#include "mocks-unistd.h"
+
+#define LOG	(Remote + RPMA_AOF_DATA_OFFSET)
+
+/*
+ * setup__committed -- commit three records to the remote log
+ */
+static int
+setup__committed(void **astate_ptr)
+{
+	assert_int_equal(setup__aof_new(astate_ptr), 0);
+	struct aof_test_state *astate = *astate_ptr;
+
+	assert_int_equal(aof_append_n(astate->aof, 3), MOCK_OK);
+	aof_expect_commit(0, 0, 3 * MOCK_REC_SIZE, 0);
+	assert_int_equal(rpma_aof_commit(astate->aof, MOCK_OP_CONTEXT),
+			MOCK_OK);
+	assert_int_equal(aof_complete(astate->aof, Commit_ctx,
+			IBV_WC_SUCCESS), MOCK_OK);
+
+	return 0;
+}
+
+/*
+ * verify__invalid_args -- invalid combinations of the arguments
+ */
+static void
+verify__invalid_args(void **unused)
+{
+	size_t valid = 0;
+
+	/* run test */
+	int ret1 = rpma_aof_verify(NULL, MOCK_REC_SIZE, &valid);
+	int ret2 = rpma_aof_verify(LOG, MOCK_REC_SIZE, NULL);
+
+	/* verify the results */
+	assert_int_equal(ret1, RPMA_E_INVAL);
+	assert_int_equal(ret2, RPMA_E_INVAL);
+}
+
+/*
+ * verify__empty -- an empty log is valid
+ */
+static void
+verify__empty(void **unused)
+{
+	/* run test */
+	size_t valid = 1;
+	int ret = rpma_aof_verify(NULL, 0, &valid);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(valid, 0);
+}
+
+/*
+ * verify__intact -- all the committed records are intact
+ */
+static void
+verify__intact(void **unused)
+{
+	/* run test */
+	size_t valid = 0;
+	int ret = rpma_aof_verify(LOG, 3 * MOCK_REC_SIZE, &valid);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(valid, 3 * MOCK_REC_SIZE);
+}
+
+/*
+ * verify__torn_payload -- the payload of the second record is torn
+ */
+static void
+verify__torn_payload(void **unused)
+{
+	LOG[MOCK_REC_SIZE + 8 + MOCK_REC_LEN - 1] ^= 1;
+
+	/* run test */
+	size_t valid = 0;
+	int ret = rpma_aof_verify(LOG, 3 * MOCK_REC_SIZE, &valid);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(valid, MOCK_REC_SIZE);
+}
+
+/*
+ * verify__torn_len -- the length of the third record is torn
+ */
+static void
+verify__torn_len(void **unused)
+{
+	LOG[2 * MOCK_REC_SIZE] ^= 8;
+
+	/* run test */
+	size_t valid = 0;
+	int ret = rpma_aof_verify(LOG, 3 * MOCK_REC_SIZE, &valid);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(valid, 2 * MOCK_REC_SIZE);
+}
+
+/*
+ * verify__beyond_records -- the scan stops at the first empty record
+ */
+static void
+verify__beyond_records(void **unused)
+{
+	/* run test */
+	size_t valid = 0;
+	int ret = rpma_aof_verify(LOG, MOCK_LOG_SIZE, &valid);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(valid, 3 * MOCK_REC_SIZE);
+}
+
+/*
+ * verify__overrun -- the last record overruns the tail
+ */
+static void
+verify__overrun(void **unused)
+{
+	/* run test */
+	size_t valid = 0;
+	int ret = rpma_aof_verify(LOG, 3 * MOCK_REC_SIZE - 8, &valid);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(valid, 2 * MOCK_REC_SIZE);
+}
+
+static const struct CMUnitTest tests_verify[] = {
+	/* rpma_aof_verify() unit tests */
+	cmocka_unit_test(verify__invalid_args),
+	cmocka_unit_test(verify__empty),
+	cmocka_unit_test_setup_teardown(verify__intact,
+		setup__committed, teardown__aof_delete),
+	cmocka_unit_test_setup_teardown(verify__torn_payload,
+		setup__committed, teardown__aof_delete),
+	cmocka_unit_test_setup_teardown(verify__torn_len,
+		setup__committed, teardown__aof_delete),
+	cmocka_unit_test_setup_teardown(verify__beyond_records,
+		setup__committed, teardown__aof_delete),
+	cmocka_unit_test_setup_teardown(verify__overrun,
+		setup__committed, teardown__aof_delete),
+
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_verify, NULL, NULL);
+}
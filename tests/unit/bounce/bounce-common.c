@@ -0,0 +1,244 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * bounce-common.c -- the rpma_bounce unit tests common functions
+ */
+
+#include <string.h>
+
+#include "bounce-common.h"
+#include "mocks-ibverbs.h"
+
+char User_mem[MOCK_USER_PAGES * PAGESIZE] __attribute__((aligned(PAGESIZE)));
+void *User_mem_page[MOCK_USER_PAGES] = {
+	User_mem, User_mem + PAGESIZE, User_mem + 2 * PAGESIZE
+};
+
+const void *Posted_ctx;
+
+/*
+ * rpma_conn_get_ibv_qp -- rpma_conn_get_ibv_qp() mock
+ */
+int
+rpma_conn_get_ibv_qp(const struct rpma_conn *conn, struct ibv_qp **qp_ptr)
+{
+	assert_ptr_equal(conn, MOCK_CONN);
+	assert_non_null(qp_ptr);
+
+	int result = mock_type(int);
+	if (result == MOCK_OK)
+		*qp_ptr = MOCK_QP;
+
+	return result;
+}
+
+/*
+ * rpma_write -- rpma_write() mock recording the op_context
+ */
+int
+rpma_write(struct rpma_conn *conn,
+		struct rpma_mr_remote *dst, size_t dst_offset,
+		const struct rpma_mr_local *src, size_t src_offset,
+		size_t len, int flags, const void *op_context)
+{
+	assert_ptr_equal(conn, MOCK_CONN);
+	assert_ptr_equal(dst, MOCK_RPMA_MR_REMOTE);
+	assert_int_equal(dst_offset, MOCK_REMOTE_OFFSET);
+	check_expected_ptr(src);
+	check_expected(src_offset);
+	check_expected(len);
+	assert_int_equal(flags, RPMA_F_COMPLETION_ALWAYS);
+	assert_non_null(op_context);
+
+	Posted_ctx = op_context;
+
+	return mock_type(int);
+}
+
+/*
+ * rpma_send -- rpma_send() mock recording the op_context
+ */
+int
+rpma_send(struct rpma_conn *conn,
+		const struct rpma_mr_local *src, size_t offset, size_t len,
+		int flags, const void *op_context)
+{
+	assert_ptr_equal(conn, MOCK_CONN);
+	check_expected_ptr(src);
+	check_expected(offset);
+	check_expected(len);
+	assert_int_equal(flags, RPMA_F_COMPLETION_ALWAYS);
+	assert_non_null(op_context);
+
+	Posted_ctx = op_context;
+
+	return mock_type(int);
+}
+
+/*
+ * rpma_read -- rpma_read() mock recording the op_context
+ */
+int
+rpma_read(struct rpma_conn *conn,
+		struct rpma_mr_local *dst, size_t dst_offset,
+		const struct rpma_mr_remote *src, size_t src_offset,
+		size_t len, int flags, const void *op_context)
+{
+	assert_ptr_equal(conn, MOCK_CONN);
+	check_expected_ptr(dst);
+	check_expected(dst_offset);
+	assert_ptr_equal(src, MOCK_RPMA_MR_REMOTE);
+	assert_int_equal(src_offset, MOCK_REMOTE_OFFSET);
+	check_expected(len);
+	assert_int_equal(flags, RPMA_F_COMPLETION_ALWAYS);
+	assert_non_null(op_context);
+
+	Posted_ctx = op_context;
+
+	return mock_type(int);
+}
+
+/*
+ * setup__bounce_new -- prepare a valid engine
+ */
+int
+setup__bounce_new(void **bstate_ptr)
+{
+	static struct bounce_test_state bstate = {0};
+
+	/* configure mocks */
+	will_return(rpma_conn_get_ibv_qp, MOCK_OK);
+	will_return(ibv_query_qp, MOCK_OK);
+	will_return(ibv_query_qp, MOCK_INLINE_SIZE);
+	will_return_count(__wrap_sysconf, MOCK_OK, 2);
+	will_return(__wrap_mmap, MOCK_OK);
+	will_return(__wrap_mmap, &bstate.allocated_slab);
+	expect_value(rpma_mr_reg, peer, MOCK_PEER);
+	expect_value(rpma_mr_reg, size, MOCK_SLAB_SIZE);
+	expect_value(rpma_mr_reg, usage, MOCK_SLAB_USAGE);
+	will_return(rpma_mr_reg, &bstate.allocated_slab.addr);
+	will_return(rpma_mr_reg, MOCK_RPMA_MR_LOCAL);
+	will_return_count(__wrap__test_malloc, MOCK_OK, 3);
+
+	/* run test */
+	bstate.bounce = NULL;
+	int ret = rpma_bounce_new(MOCK_PEER, MOCK_CONN, MOCK_SLOTS,
+			MOCK_SLOT_SIZE, &bstate.bounce);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_non_null(bstate.bounce);
+	assert_int_equal(bstate.allocated_slab.len, PAGESIZE);
+
+	size_t inline_max = 0;
+	size_t copy_max = 0;
+	assert_int_equal(rpma_bounce_get_thresholds(bstate.bounce,
+			&inline_max, &copy_max), MOCK_OK);
+	assert_int_equal(inline_max, MOCK_INLINE_SIZE);
+	assert_int_equal(copy_max, MOCK_SLOT_SIZE);
+
+	*bstate_ptr = &bstate;
+
+	return 0;
+}
+
+/*
+ * teardown__bounce_delete -- delete the engine
+ */
+int
+teardown__bounce_delete(void **bstate_ptr)
+{
+	struct bounce_test_state *bstate = *bstate_ptr;
+
+	/* configure mocks */
+	bounce_expect_dereg(MOCK_RPMA_MR_LOCAL);
+	will_return(__wrap_munmap, &bstate->allocated_slab);
+	will_return(__wrap_munmap, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_bounce_delete(&bstate->bounce);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_null(bstate->bounce);
+
+	return 0;
+}
+
+/*
+ * bounce_expect_write -- expect a write from the given source
+ */
+void
+bounce_expect_write(const struct rpma_mr_local *src, size_t src_offset,
+		size_t len, int ret)
+{
+	expect_value(rpma_write, src, src);
+	expect_value(rpma_write, src_offset, src_offset);
+	expect_value(rpma_write, len, len);
+	will_return(rpma_write, ret);
+}
+
+/*
+ * bounce_expect_send -- expect a send from the given source
+ */
+void
+bounce_expect_send(const struct rpma_mr_local *src, size_t offset,
+		size_t len, int ret)
+{
+	expect_value(rpma_send, src, src);
+	expect_value(rpma_send, offset, offset);
+	expect_value(rpma_send, len, len);
+	will_return(rpma_send, ret);
+}
+
+/*
+ * bounce_expect_read -- expect a read to the given destination
+ */
+void
+bounce_expect_read(struct rpma_mr_local *dst, size_t dst_offset,
+		size_t len, int ret)
+{
+	expect_value(rpma_read, dst, dst);
+	expect_value(rpma_read, dst_offset, dst_offset);
+	expect_value(rpma_read, len, len);
+	will_return(rpma_read, ret);
+}
+
+/*
+ * bounce_expect_reg -- expect a registration of the user's memory starting
+ * at the given page
+ */
+void
+bounce_expect_reg(uint32_t page, size_t size, int usage)
+{
+	expect_value(rpma_mr_reg, peer, MOCK_PEER);
+	expect_value(rpma_mr_reg, size, size);
+	expect_value(rpma_mr_reg, usage, usage);
+	will_return(rpma_mr_reg, &User_mem_page[page]);
+	will_return(rpma_mr_reg, MOCK_RPMA_MR_CACHED);
+}
+
+/*
+ * bounce_expect_dereg -- expect a successful deregistration
+ */
+void
+bounce_expect_dereg(struct rpma_mr_local *mr)
+{
+	expect_value(rpma_mr_dereg, *mr_ptr, mr);
+	will_return(rpma_mr_dereg, MOCK_OK);
+}
+
+/*
+ * bounce_complete -- pass the completion of the operation to the engine
+ */
+int
+bounce_complete(struct bounce_test_state *bstate, const void *op_context,
+		enum ibv_wc_status status, struct rpma_completion *cmpl)
+{
+	memset(cmpl, 0, sizeof(*cmpl));
+	cmpl->op_context = (void *)op_context;
+	cmpl->op_status = status;
+
+	return rpma_bounce_process(bstate->bounce, cmpl);
+}
@@ -0,0 +1,66 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * bounce-common.h -- the rpma_bounce unit tests common definitions
+ */
+
+#ifndef BOUNCE_COMMON_H
+#define BOUNCE_COMMON_H
+
+#include "cmocka_headers.h"
+#include "librpma.h"
+#include "mocks-stdlib.h"
+#include "mocks-unistd.h"
+#include "test-common.h"
+
+#define MOCK_RPMA_MR_REMOTE	((struct rpma_mr_remote *)0xC412)
+#define MOCK_REMOTE_OFFSET	(size_t)0xC414
+#define MOCK_RPMA_MR_CACHED	((struct rpma_mr_local *)0xC418)
+
+#define MOCK_SLOTS		2
+#define MOCK_SLOT_SIZE		64
+#define MOCK_SLAB_SIZE		(MOCK_SLOTS * MOCK_SLOT_SIZE)
+#define MOCK_INLINE_SIZE	16
+
+/* the usage of the registration of the bounce buffers */
+#define MOCK_SLAB_USAGE		(RPMA_MR_USAGE_READ_DST | \
+		RPMA_MR_USAGE_WRITE_SRC | RPMA_MR_USAGE_SEND)
+
+/* the lengths of the data taking each of the paths */
+#define MOCK_LEN_INLINE		MOCK_INLINE_SIZE
+#define MOCK_LEN_STAGED		MOCK_SLOT_SIZE
+#define MOCK_LEN_CACHED		(MOCK_SLOT_SIZE + 1)
+
+/* the user's memory (not registered) */
+#define MOCK_USER_PAGES		3
+extern char User_mem[MOCK_USER_PAGES * PAGESIZE];
+extern void *User_mem_page[MOCK_USER_PAGES];
+
+/* the op_context of the last operation posted via the connection */
+extern const void *Posted_ctx;
+
+struct bounce_test_state {
+	struct rpma_bounce *bounce;
+	struct mmap_args allocated_slab;
+};
+
+/* get the bounce buffer of the given slot */
+#define SLOT_BUF(bstate, slot) \
+	((char *)(bstate)->allocated_slab.addr + (slot) * MOCK_SLOT_SIZE)
+
+int setup__bounce_new(void **bstate_ptr);
+int teardown__bounce_delete(void **bstate_ptr);
+
+void bounce_expect_write(const struct rpma_mr_local *src, size_t src_offset,
+		size_t len, int ret);
+void bounce_expect_send(const struct rpma_mr_local *src, size_t offset,
+		size_t len, int ret);
+void bounce_expect_read(struct rpma_mr_local *dst, size_t dst_offset,
+		size_t len, int ret);
+void bounce_expect_reg(uint32_t page, size_t size, int usage);
+void bounce_expect_dereg(struct rpma_mr_local *mr);
+int bounce_complete(struct bounce_test_state *bstate, const void *op_context,
+		enum ibv_wc_status status, struct rpma_completion *cmpl);
+
+#endif /* BOUNCE_COMMON_H */
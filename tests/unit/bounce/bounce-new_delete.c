@@ -0,0 +1,345 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * bounce-new_delete.c -- the rpma_bounce_new/delete() unit tests
+ *
+ * APIs covered:
+ * - rpma_bounce_new()
+ * - rpma_bounce_delete()
+ */
+
+#include "bounce-common.h"
+#include "mocks-ibverbs.h"
+
+/*
+ * new__invalid_args -- invalid combinations of the arguments
+ */
+static void
+new__invalid_args(void **unused)
+{
+	struct rpma_bounce *bounce = NULL;
+	struct {
+		struct rpma_peer *peer;
+		struct rpma_conn *conn;
+		uint32_t slots;
+		size_t slot_size;
+		struct rpma_bounce **bounce_ptr;
+	} args[] = {
+		/* peer == NULL */
+		{NULL, MOCK_CONN, MOCK_SLOTS, MOCK_SLOT_SIZE, &bounce},
+		/* conn == NULL */
+		{MOCK_PEER, NULL, MOCK_SLOTS, MOCK_SLOT_SIZE, &bounce},
+		/* slots == 0 */
+		{MOCK_PEER, MOCK_CONN, 0, MOCK_SLOT_SIZE, &bounce},
+		/* slot_size == 0 */
+		{MOCK_PEER, MOCK_CONN, MOCK_SLOTS, 0, &bounce},
+		/* slot_size too big */
+		{MOCK_PEER, MOCK_CONN, MOCK_SLOTS, (size_t)UINT32_MAX + 1,
+			&bounce},
+		/* bounce_ptr == NULL */
+		{MOCK_PEER, MOCK_CONN, MOCK_SLOTS, MOCK_SLOT_SIZE, NULL},
+	};
+
+	for (size_t i = 0; i < sizeof(args) / sizeof(args[0]); ++i) {
+		/* run test */
+		int ret = rpma_bounce_new(args[i].peer, args[i].conn,
+				args[i].slots, args[i].slot_size,
+				args[i].bounce_ptr);
+
+		/* verify the results */
+		assert_int_equal(ret, RPMA_E_INVAL);
+		assert_null(bounce);
+	}
+}
+
+/*
+ * new__conn_get_ibv_qp_E_NOSUPP -- rpma_conn_get_ibv_qp() fails with
+ * RPMA_E_NOSUPP
+ */
+static void
+new__conn_get_ibv_qp_E_NOSUPP(void **unused)
+{
+	/* configure mocks */
+	will_return(rpma_conn_get_ibv_qp, RPMA_E_NOSUPP);
+
+	/* run test */
+	struct rpma_bounce *bounce = NULL;
+	int ret = rpma_bounce_new(MOCK_PEER, MOCK_CONN, MOCK_SLOTS,
+			MOCK_SLOT_SIZE, &bounce);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NOSUPP);
+	assert_null(bounce);
+}
+
+/*
+ * new__query_qp_ERRNO -- ibv_query_qp() fails with MOCK_ERRNO
+ */
+static void
+new__query_qp_ERRNO(void **unused)
+{
+	/* configure mocks */
+	will_return(rpma_conn_get_ibv_qp, MOCK_OK);
+	will_return(ibv_query_qp, MOCK_ERRNO);
+
+	/* run test */
+	struct rpma_bounce *bounce = NULL;
+	int ret = rpma_bounce_new(MOCK_PEER, MOCK_CONN, MOCK_SLOTS,
+			MOCK_SLOT_SIZE, &bounce);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(bounce);
+}
+
+/*
+ * new__sysconf_ERRNO -- sysconf() fails with MOCK_ERRNO
+ */
+static void
+new__sysconf_ERRNO(void **unused)
+{
+	/* configure mocks */
+	will_return(rpma_conn_get_ibv_qp, MOCK_OK);
+	will_return(ibv_query_qp, MOCK_OK);
+	will_return(ibv_query_qp, MOCK_INLINE_SIZE);
+	will_return(__wrap_sysconf, MOCK_ERRNO);
+
+	/* run test */
+	struct rpma_bounce *bounce = NULL;
+	int ret = rpma_bounce_new(MOCK_PEER, MOCK_CONN, MOCK_SLOTS,
+			MOCK_SLOT_SIZE, &bounce);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(bounce);
+}
+
+/*
+ * new__mmap_ERRNO -- mmap() fails with MOCK_ERRNO
+ */
+static void
+new__mmap_ERRNO(void **unused)
+{
+	/* configure mocks */
+	will_return(rpma_conn_get_ibv_qp, MOCK_OK);
+	will_return(ibv_query_qp, MOCK_OK);
+	will_return(ibv_query_qp, MOCK_INLINE_SIZE);
+	will_return_count(__wrap_sysconf, MOCK_OK, 2);
+	will_return(__wrap_mmap, MOCK_ERRNO);
+
+	/* run test */
+	struct rpma_bounce *bounce = NULL;
+	int ret = rpma_bounce_new(MOCK_PEER, MOCK_CONN, MOCK_SLOTS,
+			MOCK_SLOT_SIZE, &bounce);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NOMEM);
+	assert_null(bounce);
+}
+
+/*
+ * new__mr_reg_E_PROVIDER -- rpma_mr_reg() fails with RPMA_E_PROVIDER
+ */
+static void
+new__mr_reg_E_PROVIDER(void **unused)
+{
+	struct mmap_args allocated_slab = {0};
+
+	/* configure mocks */
+	will_return(rpma_conn_get_ibv_qp, MOCK_OK);
+	will_return(ibv_query_qp, MOCK_OK);
+	will_return(ibv_query_qp, MOCK_INLINE_SIZE);
+	will_return_count(__wrap_sysconf, MOCK_OK, 2);
+	will_return(__wrap_mmap, MOCK_OK);
+	will_return(__wrap_mmap, &allocated_slab);
+	expect_value(rpma_mr_reg, peer, MOCK_PEER);
+	expect_value(rpma_mr_reg, size, MOCK_SLAB_SIZE);
+	expect_value(rpma_mr_reg, usage, MOCK_SLAB_USAGE);
+	will_return(rpma_mr_reg, &allocated_slab.addr);
+	will_return(rpma_mr_reg, NULL);
+	will_return(rpma_mr_reg, RPMA_E_PROVIDER);
+	will_return(__wrap_munmap, &allocated_slab);
+	will_return(__wrap_munmap, MOCK_OK);
+
+	/* run test */
+	struct rpma_bounce *bounce = NULL;
+	int ret = rpma_bounce_new(MOCK_PEER, MOCK_CONN, MOCK_SLOTS,
+			MOCK_SLOT_SIZE, &bounce);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(bounce);
+}
+
+/*
+ * new__malloc_ERRNO -- malloc() fails with MOCK_ERRNO
+ */
+static void
+new__malloc_ERRNO(void **unused)
+{
+	/* each of the three malloc() calls fails in turn */
+	for (int i = 0; i < 3; ++i) {
+		struct mmap_args allocated_slab = {0};
+
+		/* configure mocks */
+		will_return(rpma_conn_get_ibv_qp, MOCK_OK);
+		will_return(ibv_query_qp, MOCK_OK);
+		will_return(ibv_query_qp, MOCK_INLINE_SIZE);
+		will_return_count(__wrap_sysconf, MOCK_OK, 2);
+		will_return(__wrap_mmap, MOCK_OK);
+		will_return(__wrap_mmap, &allocated_slab);
+		expect_value(rpma_mr_reg, peer, MOCK_PEER);
+		expect_value(rpma_mr_reg, size, MOCK_SLAB_SIZE);
+		expect_value(rpma_mr_reg, usage, MOCK_SLAB_USAGE);
+		will_return(rpma_mr_reg, &allocated_slab.addr);
+		will_return(rpma_mr_reg, MOCK_RPMA_MR_LOCAL);
+		for (int j = 0; j < i; ++j)
+			will_return(__wrap__test_malloc, MOCK_OK);
+		will_return(__wrap__test_malloc, MOCK_ERRNO);
+		bounce_expect_dereg(MOCK_RPMA_MR_LOCAL);
+		will_return(__wrap_munmap, &allocated_slab);
+		will_return(__wrap_munmap, MOCK_OK);
+
+		/* run test */
+		struct rpma_bounce *bounce = NULL;
+		int ret = rpma_bounce_new(MOCK_PEER, MOCK_CONN, MOCK_SLOTS,
+				MOCK_SLOT_SIZE, &bounce);
+
+		/* verify the results */
+		assert_int_equal(ret, RPMA_E_NOMEM);
+		assert_null(bounce);
+	}
+}
+
+/*
+ * test_lifecycle -- happy day scenario
+ */
+static void
+test_lifecycle(void **unused)
+{
+	/*
+	 * the thing is done by setup__bounce_new() and
+	 * teardown__bounce_delete()
+	 */
+}
+
+/*
+ * delete__bounce_ptr_NULL -- NULL bounce_ptr is invalid
+ */
+static void
+delete__bounce_ptr_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_bounce_delete(NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * delete__bounce_NULL -- NULL bounce is valid - quick exit
+ */
+static void
+delete__bounce_NULL(void **unused)
+{
+	/* run test */
+	struct rpma_bounce *bounce = NULL;
+	int ret = rpma_bounce_delete(&bounce);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * delete__mr_dereg_E_PROVIDER -- rpma_mr_dereg() fails with
+ * RPMA_E_PROVIDER
+ */
+static void
+delete__mr_dereg_E_PROVIDER(void **unused)
+{
+	struct bounce_test_state *bstate;
+
+	/* WA for cmocka/issues#47 */
+	assert_int_equal(setup__bounce_new((void **)&bstate), 0);
+
+	/* configure mocks */
+	expect_value(rpma_mr_dereg, *mr_ptr, MOCK_RPMA_MR_LOCAL);
+	will_return(rpma_mr_dereg, RPMA_E_PROVIDER);
+	will_return(rpma_mr_dereg, MOCK_ERRNO);
+	will_return(__wrap_munmap, &bstate->allocated_slab);
+	will_return(__wrap_munmap, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_bounce_delete(&bstate->bounce);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(bstate->bounce);
+}
+
+/*
+ * delete__cached_registrations -- the cached registrations are released
+ * together with the engine
+ */
+static void
+delete__cached_registrations(void **unused)
+{
+	struct bounce_test_state *bstate;
+
+	/* WA for cmocka/issues#47 */
+	assert_int_equal(setup__bounce_new((void **)&bstate), 0);
+
+	/* register the user's memory via a write */
+	bounce_expect_reg(0, PAGESIZE, RPMA_MR_USAGE_WRITE_SRC);
+	bounce_expect_write(MOCK_RPMA_MR_CACHED, 0, MOCK_LEN_CACHED, MOCK_OK);
+	int ret = rpma_bounce_write(bstate->bounce, MOCK_RPMA_MR_REMOTE,
+			MOCK_REMOTE_OFFSET, User_mem, MOCK_LEN_CACHED,
+			RPMA_F_COMPLETION_ALWAYS, MOCK_OP_CONTEXT);
+	assert_int_equal(ret, MOCK_OK);
+	struct rpma_completion cmpl;
+	ret = bounce_complete(bstate, Posted_ctx, IBV_WC_SUCCESS, &cmpl);
+	assert_int_equal(ret, MOCK_OK);
+
+	/* configure mocks */
+	bounce_expect_dereg(MOCK_RPMA_MR_CACHED);
+	bounce_expect_dereg(MOCK_RPMA_MR_LOCAL);
+	will_return(__wrap_munmap, &bstate->allocated_slab);
+	will_return(__wrap_munmap, MOCK_OK);
+
+	/* run test */
+	ret = rpma_bounce_delete(&bstate->bounce);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_null(bstate->bounce);
+}
+
+static const struct CMUnitTest tests_new_delete[] = {
+	/* rpma_bounce_new() unit tests */
+	cmocka_unit_test(new__invalid_args),
+	cmocka_unit_test(new__conn_get_ibv_qp_E_NOSUPP),
+	cmocka_unit_test(new__query_qp_ERRNO),
+	cmocka_unit_test(new__sysconf_ERRNO),
+	cmocka_unit_test(new__mmap_ERRNO),
+	cmocka_unit_test(new__mr_reg_E_PROVIDER),
+	cmocka_unit_test(new__malloc_ERRNO),
+
+	/* rpma_bounce_new()/delete() lifecycle */
+	cmocka_unit_test_setup_teardown(test_lifecycle,
+		setup__bounce_new, teardown__bounce_delete),
+
+	/* rpma_bounce_delete() unit tests */
+	cmocka_unit_test(delete__bounce_ptr_NULL),
+	cmocka_unit_test(delete__bounce_NULL),
+	cmocka_unit_test(delete__mr_dereg_E_PROVIDER),
+	cmocka_unit_test(delete__cached_registrations),
+
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_new_delete, NULL, NULL);
+}
@@ -0,0 +1,332 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * bounce-process.c -- the rpma_bounce_process/invalidate() and thresholds
+ * unit tests
+ *
+ * APIs covered:
+ * - rpma_bounce_process()
+ * - rpma_bounce_invalidate()
+ * - rpma_bounce_set_thresholds()
+ * - rpma_bounce_get_thresholds()
+ */
+
+#include "bounce-common.h"
+
+/*
+ * write_staged -- post a staged write with the given flags
+ */
+static void
+write_staged(struct bounce_test_state *bstate, size_t offset, int flags)
+{
+	bounce_expect_write(MOCK_RPMA_MR_LOCAL, offset, MOCK_LEN_STAGED,
+			MOCK_OK);
+	int ret = rpma_bounce_write(bstate->bounce, MOCK_RPMA_MR_REMOTE,
+			MOCK_REMOTE_OFFSET, User_mem, MOCK_LEN_STAGED, flags,
+			MOCK_OP_CONTEXT);
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * write_cached -- post a write using the registration cache
+ */
+static void
+write_cached(struct bounce_test_state *bstate)
+{
+	bounce_expect_reg(0, PAGESIZE, RPMA_MR_USAGE_WRITE_SRC);
+	bounce_expect_write(MOCK_RPMA_MR_CACHED, 0, MOCK_LEN_CACHED, MOCK_OK);
+	int ret = rpma_bounce_write(bstate->bounce, MOCK_RPMA_MR_REMOTE,
+			MOCK_REMOTE_OFFSET, User_mem, MOCK_LEN_CACHED,
+			RPMA_F_COMPLETION_ALWAYS, MOCK_OP_CONTEXT);
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * process__invalid_args -- NULL bounce or cmpl is invalid
+ */
+static void
+process__invalid_args(void **bstate_ptr)
+{
+	struct bounce_test_state *bstate = *bstate_ptr;
+	struct rpma_completion cmpl = {0};
+
+	/* run test */
+	int ret1 = rpma_bounce_process(NULL, &cmpl);
+	int ret2 = rpma_bounce_process(bstate->bounce, NULL);
+
+	/* verify the results */
+	assert_int_equal(ret1, RPMA_E_INVAL);
+	assert_int_equal(ret2, RPMA_E_INVAL);
+}
+
+/*
+ * process__foreign -- a completion which does not come from the engine
+ * is rejected
+ */
+static void
+process__foreign(void **bstate_ptr)
+{
+	struct bounce_test_state *bstate = *bstate_ptr;
+
+	/* run test */
+	struct rpma_completion cmpl;
+	int ret = bounce_complete(bstate, MOCK_OP_CONTEXT, IBV_WC_SUCCESS,
+			&cmpl);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+	assert_ptr_equal(cmpl.op_context, MOCK_OP_CONTEXT);
+}
+
+/*
+ * process__twice -- a completion cannot be processed twice
+ */
+static void
+process__twice(void **bstate_ptr)
+{
+	struct bounce_test_state *bstate = *bstate_ptr;
+	write_staged(bstate, 0, RPMA_F_COMPLETION_ALWAYS);
+	const void *posted = Posted_ctx;
+
+	/* run test */
+	struct rpma_completion cmpl;
+	int ret1 = bounce_complete(bstate, posted, IBV_WC_SUCCESS, &cmpl);
+	int ret2 = bounce_complete(bstate, posted, IBV_WC_SUCCESS, &cmpl);
+
+	/* verify the results */
+	assert_int_equal(ret1, MOCK_OK);
+	assert_int_equal(ret2, RPMA_E_INVAL);
+}
+
+/*
+ * process__completion_on_error -- the successful completion is consumed
+ * if it has not been requested but the failed one is reported
+ */
+static void
+process__completion_on_error(void **bstate_ptr)
+{
+	struct bounce_test_state *bstate = *bstate_ptr;
+	struct rpma_completion cmpl;
+
+	/* the slot of the consumed completion is released */
+	for (int i = 0; i < MOCK_SLOTS + 1; ++i) {
+		write_staged(bstate, 0, RPMA_F_COMPLETION_ON_ERROR);
+
+		/* run test */
+		int ret = bounce_complete(bstate, Posted_ctx, IBV_WC_SUCCESS,
+				&cmpl);
+
+		/* verify the results */
+		assert_int_equal(ret, RPMA_E_NO_COMPLETION);
+	}
+
+	write_staged(bstate, 0, RPMA_F_COMPLETION_ON_ERROR);
+
+	/* run test */
+	int ret = bounce_complete(bstate, Posted_ctx, IBV_WC_RETRY_EXC_ERR,
+			&cmpl);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(cmpl.op_context, MOCK_OP_CONTEXT);
+	assert_int_equal(cmpl.op_status, IBV_WC_RETRY_EXC_ERR);
+}
+
+/*
+ * thresholds__invalid_args -- invalid combinations of the arguments
+ */
+static void
+thresholds__invalid_args(void **bstate_ptr)
+{
+	struct bounce_test_state *bstate = *bstate_ptr;
+	size_t inline_max;
+	size_t copy_max;
+
+	/* run test & verify the results */
+	assert_int_equal(rpma_bounce_set_thresholds(NULL, 0, 0),
+			RPMA_E_INVAL);
+	assert_int_equal(rpma_bounce_set_thresholds(bstate->bounce,
+			MOCK_INLINE_SIZE + 1, MOCK_SLOT_SIZE), RPMA_E_INVAL);
+	assert_int_equal(rpma_bounce_set_thresholds(bstate->bounce,
+			MOCK_INLINE_SIZE, MOCK_SLOT_SIZE + 1), RPMA_E_INVAL);
+	assert_int_equal(rpma_bounce_get_thresholds(NULL, &inline_max,
+			&copy_max), RPMA_E_INVAL);
+	assert_int_equal(rpma_bounce_get_thresholds(bstate->bounce, NULL,
+			&copy_max), RPMA_E_INVAL);
+	assert_int_equal(rpma_bounce_get_thresholds(bstate->bounce,
+			&inline_max, NULL), RPMA_E_INVAL);
+}
+
+/*
+ * thresholds__lowered -- the lowered thresholds move the operations
+ * to the following paths
+ */
+static void
+thresholds__lowered(void **bstate_ptr)
+{
+	struct bounce_test_state *bstate = *bstate_ptr;
+
+	/* an inline-sized write is staged */
+	int ret = rpma_bounce_set_thresholds(bstate->bounce, 0,
+			MOCK_SLOT_SIZE);
+	assert_int_equal(ret, MOCK_OK);
+	bounce_expect_write(MOCK_RPMA_MR_LOCAL, 0, MOCK_LEN_INLINE, MOCK_OK);
+	ret = rpma_bounce_write(bstate->bounce, MOCK_RPMA_MR_REMOTE,
+			MOCK_REMOTE_OFFSET, User_mem, MOCK_LEN_INLINE,
+			RPMA_F_COMPLETION_ALWAYS, MOCK_OP_CONTEXT);
+	assert_int_equal(ret, MOCK_OK);
+	struct rpma_completion cmpl;
+	assert_int_equal(bounce_complete(bstate, Posted_ctx, IBV_WC_SUCCESS,
+			&cmpl), MOCK_OK);
+
+	/* an inline-sized write uses the registration cache */
+	ret = rpma_bounce_set_thresholds(bstate->bounce, 0, 0);
+	assert_int_equal(ret, MOCK_OK);
+	size_t inline_max = 1;
+	size_t copy_max = 1;
+	ret = rpma_bounce_get_thresholds(bstate->bounce, &inline_max,
+			&copy_max);
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(inline_max, 0);
+	assert_int_equal(copy_max, 0);
+
+	bounce_expect_reg(0, PAGESIZE, RPMA_MR_USAGE_WRITE_SRC);
+	bounce_expect_write(MOCK_RPMA_MR_CACHED, 0, MOCK_LEN_INLINE, MOCK_OK);
+	ret = rpma_bounce_write(bstate->bounce, MOCK_RPMA_MR_REMOTE,
+			MOCK_REMOTE_OFFSET, User_mem, MOCK_LEN_INLINE,
+			RPMA_F_COMPLETION_ALWAYS, MOCK_OP_CONTEXT);
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(bounce_complete(bstate, Posted_ctx, IBV_WC_SUCCESS,
+			&cmpl), MOCK_OK);
+
+	bounce_expect_dereg(MOCK_RPMA_MR_CACHED);
+	assert_int_equal(rpma_bounce_invalidate(bstate->bounce, User_mem,
+			PAGESIZE), MOCK_OK);
+}
+
+/*
+ * invalidate__invalid_args -- invalid combinations of the arguments
+ */
+static void
+invalidate__invalid_args(void **bstate_ptr)
+{
+	struct bounce_test_state *bstate = *bstate_ptr;
+
+	/* run test & verify the results */
+	assert_int_equal(rpma_bounce_invalidate(NULL, User_mem, PAGESIZE),
+			RPMA_E_INVAL);
+	assert_int_equal(rpma_bounce_invalidate(bstate->bounce, NULL,
+			PAGESIZE), RPMA_E_INVAL);
+	assert_int_equal(rpma_bounce_invalidate(bstate->bounce, User_mem, 0),
+			RPMA_E_INVAL);
+}
+
+/*
+ * invalidate__in_use -- the registration of the memory in use is not
+ * dropped
+ */
+static void
+invalidate__in_use(void **bstate_ptr)
+{
+	struct bounce_test_state *bstate = *bstate_ptr;
+	write_cached(bstate);
+
+	/* run test */
+	int ret = rpma_bounce_invalidate(bstate->bounce, User_mem, PAGESIZE);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_AGAIN);
+
+	struct rpma_completion cmpl;
+	assert_int_equal(bounce_complete(bstate, Posted_ctx, IBV_WC_SUCCESS,
+			&cmpl), MOCK_OK);
+	bounce_expect_dereg(MOCK_RPMA_MR_CACHED);
+	assert_int_equal(rpma_bounce_invalidate(bstate->bounce, User_mem,
+			PAGESIZE), MOCK_OK);
+}
+
+/*
+ * invalidate__no_overlap -- the registrations not overlapping the memory
+ * are kept
+ */
+static void
+invalidate__no_overlap(void **bstate_ptr)
+{
+	struct bounce_test_state *bstate = *bstate_ptr;
+	write_cached(bstate);
+	struct rpma_completion cmpl;
+	assert_int_equal(bounce_complete(bstate, Posted_ctx, IBV_WC_SUCCESS,
+			&cmpl), MOCK_OK);
+
+	/* run test */
+	int ret = rpma_bounce_invalidate(bstate->bounce,
+			User_mem + PAGESIZE, PAGESIZE);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+
+	/* the registration is dropped together with the engine */
+	bounce_expect_dereg(MOCK_RPMA_MR_CACHED);
+}
+
+/*
+ * invalidate__mr_dereg_E_PROVIDER -- rpma_mr_dereg() fails with
+ * RPMA_E_PROVIDER
+ */
+static void
+invalidate__mr_dereg_E_PROVIDER(void **bstate_ptr)
+{
+	struct bounce_test_state *bstate = *bstate_ptr;
+	write_cached(bstate);
+	struct rpma_completion cmpl;
+	assert_int_equal(bounce_complete(bstate, Posted_ctx, IBV_WC_SUCCESS,
+			&cmpl), MOCK_OK);
+
+	/* configure mocks */
+	expect_value(rpma_mr_dereg, *mr_ptr, MOCK_RPMA_MR_CACHED);
+	will_return(rpma_mr_dereg, RPMA_E_PROVIDER);
+	will_return(rpma_mr_dereg, MOCK_ERRNO);
+
+	/* run test */
+	int ret = rpma_bounce_invalidate(bstate->bounce, User_mem, PAGESIZE);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+}
+
+static const struct CMUnitTest tests_process[] = {
+	/* rpma_bounce_process() unit tests */
+	cmocka_unit_test_setup_teardown(process__invalid_args,
+		setup__bounce_new, teardown__bounce_delete),
+	cmocka_unit_test_setup_teardown(process__foreign,
+		setup__bounce_new, teardown__bounce_delete),
+	cmocka_unit_test_setup_teardown(process__twice,
+		setup__bounce_new, teardown__bounce_delete),
+	cmocka_unit_test_setup_teardown(process__completion_on_error,
+		setup__bounce_new, teardown__bounce_delete),
+
+	/* rpma_bounce_set/get_thresholds() unit tests */
+	cmocka_unit_test_setup_teardown(thresholds__invalid_args,
+		setup__bounce_new, teardown__bounce_delete),
+	cmocka_unit_test_setup_teardown(thresholds__lowered,
+		setup__bounce_new, teardown__bounce_delete),
+
+	/* rpma_bounce_invalidate() unit tests */
+	cmocka_unit_test_setup_teardown(invalidate__invalid_args,
+		setup__bounce_new, teardown__bounce_delete),
+	cmocka_unit_test_setup_teardown(invalidate__in_use,
+		setup__bounce_new, teardown__bounce_delete),
+	cmocka_unit_test_setup_teardown(invalidate__no_overlap,
+		setup__bounce_new, teardown__bounce_delete),
+	cmocka_unit_test_setup_teardown(invalidate__mr_dereg_E_PROVIDER,
+		setup__bounce_new, teardown__bounce_delete),
+
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_process, NULL, NULL);
+}
@@ -0,0 +1,230 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * bounce-read.c -- the rpma_bounce_read() unit tests
+ *
+ * API covered:
+ * - rpma_bounce_read()
+ */
+
+#include <string.h>
+
+#include "bounce-common.h"
+
+/*
+ * read_user_mem -- read into the user's memory at the given offset
+ */
+static int
+read_user_mem(struct bounce_test_state *bstate, size_t offset, size_t len)
+{
+	return rpma_bounce_read(bstate->bounce, User_mem + offset,
+			MOCK_RPMA_MR_REMOTE, MOCK_REMOTE_OFFSET, len,
+			RPMA_F_COMPLETION_ALWAYS, MOCK_OP_CONTEXT);
+}
+
+/*
+ * read__invalid_args -- invalid combinations of the arguments
+ */
+static void
+read__invalid_args(void **bstate_ptr)
+{
+	struct bounce_test_state *bstate = *bstate_ptr;
+	struct rpma_bounce *bounce = bstate->bounce;
+	struct {
+		struct rpma_bounce *bounce;
+		void *dst;
+		struct rpma_mr_remote *src;
+		size_t len;
+		int flags;
+	} args[] = {
+		{NULL, User_mem, MOCK_RPMA_MR_REMOTE, MOCK_LEN_STAGED,
+			RPMA_F_COMPLETION_ALWAYS},
+		{bounce, NULL, MOCK_RPMA_MR_REMOTE, MOCK_LEN_STAGED,
+			RPMA_F_COMPLETION_ALWAYS},
+		{bounce, User_mem, NULL, MOCK_LEN_STAGED,
+			RPMA_F_COMPLETION_ALWAYS},
+		{bounce, User_mem, MOCK_RPMA_MR_REMOTE, 0,
+			RPMA_F_COMPLETION_ALWAYS},
+		{bounce, User_mem, MOCK_RPMA_MR_REMOTE, MOCK_LEN_STAGED, 0},
+	};
+
+	for (size_t i = 0; i < sizeof(args) / sizeof(args[0]); ++i) {
+		/* run test */
+		int ret = rpma_bounce_read(args[i].bounce, args[i].dst,
+				args[i].src, MOCK_REMOTE_OFFSET, args[i].len,
+				args[i].flags, MOCK_OP_CONTEXT);
+
+		/* verify the results */
+		assert_int_equal(ret, RPMA_E_INVAL);
+	}
+}
+
+/*
+ * read__staged -- the data lands in the bounce buffer and it is copied
+ * out when the read completes
+ */
+static void
+read__staged(void **bstate_ptr)
+{
+	struct bounce_test_state *bstate = *bstate_ptr;
+	memset(User_mem, 0, MOCK_LEN_STAGED);
+
+	/* configure mocks */
+	bounce_expect_read(MOCK_RPMA_MR_LOCAL, 0, MOCK_LEN_STAGED, MOCK_OK);
+
+	/* run test */
+	int ret = read_user_mem(bstate, 0, MOCK_LEN_STAGED);
+	assert_int_equal(ret, MOCK_OK);
+	memset(SLOT_BUF(bstate, 0), 'z', MOCK_LEN_STAGED);
+	struct rpma_completion cmpl;
+	ret = bounce_complete(bstate, Posted_ctx, IBV_WC_SUCCESS, &cmpl);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(cmpl.op_context, MOCK_OP_CONTEXT);
+	assert_memory_equal(User_mem, SLOT_BUF(bstate, 0), MOCK_LEN_STAGED);
+}
+
+/*
+ * read__staged_failed -- the data of a failed read is not copied out
+ */
+static void
+read__staged_failed(void **bstate_ptr)
+{
+	struct bounce_test_state *bstate = *bstate_ptr;
+	memset(User_mem, 0, MOCK_LEN_STAGED);
+
+	/* configure mocks */
+	bounce_expect_read(MOCK_RPMA_MR_LOCAL, 0, MOCK_LEN_STAGED, MOCK_OK);
+
+	/* run test */
+	int ret = read_user_mem(bstate, 0, MOCK_LEN_STAGED);
+	assert_int_equal(ret, MOCK_OK);
+	memset(SLOT_BUF(bstate, 0), 'z', MOCK_LEN_STAGED);
+	struct rpma_completion cmpl;
+	ret = bounce_complete(bstate, Posted_ctx, IBV_WC_REM_ACCESS_ERR,
+			&cmpl);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(cmpl.op_context, MOCK_OP_CONTEXT);
+	assert_int_equal(cmpl.op_status, IBV_WC_REM_ACCESS_ERR);
+	assert_int_equal(User_mem[0], 0);
+}
+
+/*
+ * read__E_PROVIDER -- the slot of the read which failed to be posted
+ * is released
+ */
+static void
+read__E_PROVIDER(void **bstate_ptr)
+{
+	struct bounce_test_state *bstate = *bstate_ptr;
+
+	/* configure mocks */
+	bounce_expect_read(MOCK_RPMA_MR_LOCAL, 0, MOCK_LEN_STAGED,
+			RPMA_E_PROVIDER);
+	bounce_expect_read(MOCK_RPMA_MR_LOCAL, 0, MOCK_LEN_STAGED, MOCK_OK);
+
+	/* run test */
+	int ret = read_user_mem(bstate, 0, MOCK_LEN_STAGED);
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	ret = read_user_mem(bstate, 0, MOCK_LEN_STAGED);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	struct rpma_completion cmpl;
+	assert_int_equal(bounce_complete(bstate, Posted_ctx, IBV_WC_SUCCESS,
+			&cmpl), MOCK_OK);
+}
+
+/*
+ * read__cached -- a long read lands directly in the user's memory
+ * registered on demand
+ */
+static void
+read__cached(void **bstate_ptr)
+{
+	struct bounce_test_state *bstate = *bstate_ptr;
+
+	/* configure mocks */
+	bounce_expect_reg(0, PAGESIZE, RPMA_MR_USAGE_READ_DST);
+	bounce_expect_read(MOCK_RPMA_MR_CACHED, 100, MOCK_LEN_CACHED,
+			MOCK_OK);
+
+	/* run test */
+	int ret = read_user_mem(bstate, 100, MOCK_LEN_CACHED);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	struct rpma_completion cmpl;
+	assert_int_equal(bounce_complete(bstate, Posted_ctx, IBV_WC_SUCCESS,
+			&cmpl), MOCK_OK);
+	assert_ptr_equal(cmpl.op_context, MOCK_OP_CONTEXT);
+
+	bounce_expect_dereg(MOCK_RPMA_MR_CACHED);
+	assert_int_equal(rpma_bounce_invalidate(bstate->bounce, User_mem,
+			PAGESIZE), MOCK_OK);
+}
+
+/*
+ * read__cached_usage -- a registration made for reading is not used
+ * for writing
+ */
+static void
+read__cached_usage(void **bstate_ptr)
+{
+	struct bounce_test_state *bstate = *bstate_ptr;
+
+	/* configure mocks */
+	bounce_expect_reg(0, PAGESIZE, RPMA_MR_USAGE_READ_DST);
+	bounce_expect_read(MOCK_RPMA_MR_CACHED, 0, MOCK_LEN_CACHED, MOCK_OK);
+	bounce_expect_reg(0, PAGESIZE, RPMA_MR_USAGE_WRITE_SRC);
+	bounce_expect_write(MOCK_RPMA_MR_CACHED, 0, MOCK_LEN_CACHED, MOCK_OK);
+
+	/* run test */
+	int ret = read_user_mem(bstate, 0, MOCK_LEN_CACHED);
+	assert_int_equal(ret, MOCK_OK);
+	const void *read_ctx = Posted_ctx;
+	ret = rpma_bounce_write(bstate->bounce, MOCK_RPMA_MR_REMOTE,
+			MOCK_REMOTE_OFFSET, User_mem, MOCK_LEN_CACHED,
+			RPMA_F_COMPLETION_ALWAYS, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	struct rpma_completion cmpl;
+	assert_int_equal(bounce_complete(bstate, read_ctx, IBV_WC_SUCCESS,
+			&cmpl), MOCK_OK);
+	assert_int_equal(bounce_complete(bstate, Posted_ctx, IBV_WC_SUCCESS,
+			&cmpl), MOCK_OK);
+
+	bounce_expect_dereg(MOCK_RPMA_MR_CACHED);
+	bounce_expect_dereg(MOCK_RPMA_MR_CACHED);
+	assert_int_equal(rpma_bounce_invalidate(bstate->bounce, User_mem,
+			PAGESIZE), MOCK_OK);
+}
+
+static const struct CMUnitTest tests_read[] = {
+	/* rpma_bounce_read() unit tests */
+	cmocka_unit_test_setup_teardown(read__invalid_args,
+		setup__bounce_new, teardown__bounce_delete),
+	cmocka_unit_test_setup_teardown(read__staged,
+		setup__bounce_new, teardown__bounce_delete),
+	cmocka_unit_test_setup_teardown(read__staged_failed,
+		setup__bounce_new, teardown__bounce_delete),
+	cmocka_unit_test_setup_teardown(read__E_PROVIDER,
+		setup__bounce_new, teardown__bounce_delete),
+	cmocka_unit_test_setup_teardown(read__cached,
+		setup__bounce_new, teardown__bounce_delete),
+	cmocka_unit_test_setup_teardown(read__cached_usage,
+		setup__bounce_new, teardown__bounce_delete),
+
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_read, NULL, NULL);
+}
@@ -0,0 +1,376 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * bounce-write_send.c -- the rpma_bounce_write/send() unit tests
+ *
+ * APIs covered:
+ * - rpma_bounce_write()
+ * - rpma_bounce_send()
+ */
+
+#include <string.h>
+
+#include "bounce-common.h"
+#include "mocks-ibverbs.h"
+
+/*
+ * expect_inline -- expect an inline write or send of the user's memory
+ */
+static void
+expect_inline(struct rpma_mr_remote *dst, size_t dst_offset, size_t len,
+		enum ibv_wr_opcode operation, int ret)
+{
+	expect_value(rpma_mr_inline, qp, MOCK_QP);
+	expect_value(rpma_mr_inline, dst, dst);
+	expect_value(rpma_mr_inline, dst_offset, dst_offset);
+	expect_value(rpma_mr_inline, src, User_mem);
+	expect_value(rpma_mr_inline, len, len);
+	expect_value(rpma_mr_inline, flags, RPMA_F_COMPLETION_ALWAYS);
+	expect_value(rpma_mr_inline, operation, operation);
+	expect_value(rpma_mr_inline, op_context, MOCK_OP_CONTEXT);
+	will_return(rpma_mr_inline, ret);
+}
+
+/*
+ * write_user_mem -- write the user's memory at the given offset
+ */
+static int
+write_user_mem(struct bounce_test_state *bstate, size_t offset, size_t len)
+{
+	return rpma_bounce_write(bstate->bounce, MOCK_RPMA_MR_REMOTE,
+			MOCK_REMOTE_OFFSET, User_mem + offset, len,
+			RPMA_F_COMPLETION_ALWAYS, MOCK_OP_CONTEXT);
+}
+
+/*
+ * complete_posted -- complete the last operation posted
+ */
+static void
+complete_posted(struct bounce_test_state *bstate)
+{
+	struct rpma_completion cmpl;
+	int ret = bounce_complete(bstate, Posted_ctx, IBV_WC_SUCCESS, &cmpl);
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(cmpl.op_context, MOCK_OP_CONTEXT);
+}
+
+/*
+ * write__invalid_args -- invalid combinations of the arguments
+ */
+static void
+write__invalid_args(void **bstate_ptr)
+{
+	struct bounce_test_state *bstate = *bstate_ptr;
+	struct rpma_bounce *bounce = bstate->bounce;
+	struct {
+		struct rpma_bounce *bounce;
+		struct rpma_mr_remote *dst;
+		const void *src;
+		size_t len;
+		int flags;
+	} args[] = {
+		{NULL, MOCK_RPMA_MR_REMOTE, User_mem, MOCK_LEN_STAGED,
+			RPMA_F_COMPLETION_ALWAYS},
+		{bounce, NULL, User_mem, MOCK_LEN_STAGED,
+			RPMA_F_COMPLETION_ALWAYS},
+		{bounce, MOCK_RPMA_MR_REMOTE, NULL, MOCK_LEN_STAGED,
+			RPMA_F_COMPLETION_ALWAYS},
+		{bounce, MOCK_RPMA_MR_REMOTE, User_mem, 0,
+			RPMA_F_COMPLETION_ALWAYS},
+		{bounce, MOCK_RPMA_MR_REMOTE, User_mem, MOCK_LEN_STAGED, 0},
+	};
+
+	for (size_t i = 0; i < sizeof(args) / sizeof(args[0]); ++i) {
+		/* run test */
+		int ret = rpma_bounce_write(args[i].bounce, args[i].dst,
+				MOCK_REMOTE_OFFSET, args[i].src, args[i].len,
+				args[i].flags, MOCK_OP_CONTEXT);
+
+		/* verify the results */
+		assert_int_equal(ret, RPMA_E_INVAL);
+	}
+}
+
+/*
+ * write__inline -- a short write is posted inline
+ */
+static void
+write__inline(void **bstate_ptr)
+{
+	struct bounce_test_state *bstate = *bstate_ptr;
+
+	int rets[] = {MOCK_OK, RPMA_E_PROVIDER};
+	for (int i = 0; i < 2; ++i) {
+		/* configure mocks */
+		expect_inline(MOCK_RPMA_MR_REMOTE, MOCK_REMOTE_OFFSET,
+				MOCK_LEN_INLINE, IBV_WR_RDMA_WRITE, rets[i]);
+
+		/* run test */
+		int ret = write_user_mem(bstate, 0, MOCK_LEN_INLINE);
+
+		/* verify the results */
+		assert_int_equal(ret, rets[i]);
+	}
+}
+
+/*
+ * write__staged -- the data is copied into the bounce buffer
+ */
+static void
+write__staged(void **bstate_ptr)
+{
+	struct bounce_test_state *bstate = *bstate_ptr;
+	memset(User_mem, 'x', MOCK_LEN_STAGED);
+
+	/* configure mocks */
+	bounce_expect_write(MOCK_RPMA_MR_LOCAL, 0, MOCK_LEN_STAGED, MOCK_OK);
+
+	/* run test */
+	int ret = write_user_mem(bstate, 0, MOCK_LEN_STAGED);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_memory_equal(SLOT_BUF(bstate, 0), User_mem, MOCK_LEN_STAGED);
+	complete_posted(bstate);
+}
+
+/*
+ * write__staged_E_PROVIDER -- the slot of the write which failed to be
+ * posted is released
+ */
+static void
+write__staged_E_PROVIDER(void **bstate_ptr)
+{
+	struct bounce_test_state *bstate = *bstate_ptr;
+
+	/* configure mocks */
+	bounce_expect_write(MOCK_RPMA_MR_LOCAL, 0, MOCK_LEN_STAGED,
+			RPMA_E_PROVIDER);
+	bounce_expect_write(MOCK_RPMA_MR_LOCAL, 0, MOCK_LEN_STAGED, MOCK_OK);
+
+	/* run test */
+	int ret = write_user_mem(bstate, 0, MOCK_LEN_STAGED);
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	ret = write_user_mem(bstate, 0, MOCK_LEN_STAGED);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	complete_posted(bstate);
+}
+
+/*
+ * write__no_free_slot -- RPMA_E_AGAIN is returned when all the slots
+ * are in use
+ */
+static void
+write__no_free_slot(void **bstate_ptr)
+{
+	struct bounce_test_state *bstate = *bstate_ptr;
+	const void *posted[MOCK_SLOTS];
+
+	for (int i = 0; i < MOCK_SLOTS; ++i) {
+		bounce_expect_write(MOCK_RPMA_MR_LOCAL,
+				(size_t)i * MOCK_SLOT_SIZE, MOCK_LEN_STAGED,
+				MOCK_OK);
+		int ret = write_user_mem(bstate, 0, MOCK_LEN_STAGED);
+		assert_int_equal(ret, MOCK_OK);
+		posted[i] = Posted_ctx;
+	}
+
+	/* run test */
+	int ret = write_user_mem(bstate, 0, MOCK_LEN_STAGED);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_AGAIN);
+
+	struct rpma_completion cmpl;
+	for (int i = 0; i < MOCK_SLOTS; ++i)
+		assert_int_equal(bounce_complete(bstate, posted[i],
+				IBV_WC_SUCCESS, &cmpl), MOCK_OK);
+}
+
+/*
+ * write__cached -- a long write uses the user's memory registered
+ * on demand and the registration is reused by the following writes
+ */
+static void
+write__cached(void **bstate_ptr)
+{
+	struct bounce_test_state *bstate = *bstate_ptr;
+
+	/* configure mocks */
+	bounce_expect_reg(0, PAGESIZE, RPMA_MR_USAGE_WRITE_SRC);
+	bounce_expect_write(MOCK_RPMA_MR_CACHED, 100, MOCK_LEN_CACHED,
+			MOCK_OK);
+	bounce_expect_write(MOCK_RPMA_MR_CACHED, 200, MOCK_LEN_CACHED,
+			MOCK_OK);
+
+	/* run test */
+	int ret = write_user_mem(bstate, 100, MOCK_LEN_CACHED);
+	assert_int_equal(ret, MOCK_OK);
+	complete_posted(bstate);
+	ret = write_user_mem(bstate, 200, MOCK_LEN_CACHED);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	complete_posted(bstate);
+
+	bounce_expect_dereg(MOCK_RPMA_MR_CACHED);
+	assert_int_equal(rpma_bounce_invalidate(bstate->bounce, User_mem,
+			PAGESIZE), MOCK_OK);
+}
+
+/*
+ * write__cached_across_pages -- the registration covers all the pages
+ * the data spans
+ */
+static void
+write__cached_across_pages(void **bstate_ptr)
+{
+	struct bounce_test_state *bstate = *bstate_ptr;
+
+	/* configure mocks */
+	bounce_expect_reg(0, 2 * PAGESIZE, RPMA_MR_USAGE_WRITE_SRC);
+	bounce_expect_write(MOCK_RPMA_MR_CACHED, PAGESIZE - 1,
+			MOCK_LEN_CACHED, MOCK_OK);
+
+	/* run test */
+	int ret = write_user_mem(bstate, PAGESIZE - 1, MOCK_LEN_CACHED);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	complete_posted(bstate);
+
+	bounce_expect_dereg(MOCK_RPMA_MR_CACHED);
+	assert_int_equal(rpma_bounce_invalidate(bstate->bounce,
+			User_mem + PAGESIZE, 1), MOCK_OK);
+}
+
+/*
+ * write__mr_reg_E_PROVIDER -- rpma_mr_reg() fails with RPMA_E_PROVIDER
+ * and the slot is released
+ */
+static void
+write__mr_reg_E_PROVIDER(void **bstate_ptr)
+{
+	struct bounce_test_state *bstate = *bstate_ptr;
+
+	/* configure mocks */
+	for (int i = 0; i < MOCK_SLOTS + 1; ++i) {
+		expect_value(rpma_mr_reg, peer, MOCK_PEER);
+		expect_value(rpma_mr_reg, size, PAGESIZE);
+		expect_value(rpma_mr_reg, usage, RPMA_MR_USAGE_WRITE_SRC);
+		will_return(rpma_mr_reg, &User_mem_page[0]);
+		will_return(rpma_mr_reg, NULL);
+		will_return(rpma_mr_reg, RPMA_E_PROVIDER);
+	}
+
+	for (int i = 0; i < MOCK_SLOTS + 1; ++i) {
+		/* run test */
+		int ret = write_user_mem(bstate, 0, MOCK_LEN_CACHED);
+
+		/* verify the results */
+		assert_int_equal(ret, RPMA_E_PROVIDER);
+	}
+}
+
+/*
+ * send__invalid_args -- invalid combinations of the arguments
+ */
+static void
+send__invalid_args(void **bstate_ptr)
+{
+	struct bounce_test_state *bstate = *bstate_ptr;
+	struct rpma_bounce *bounce = bstate->bounce;
+	struct {
+		struct rpma_bounce *bounce;
+		const void *src;
+		size_t len;
+		int flags;
+	} args[] = {
+		{NULL, User_mem, MOCK_LEN_STAGED, RPMA_F_COMPLETION_ALWAYS},
+		{bounce, NULL, MOCK_LEN_STAGED, RPMA_F_COMPLETION_ALWAYS},
+		{bounce, User_mem, 0, RPMA_F_COMPLETION_ALWAYS},
+		{bounce, User_mem, MOCK_LEN_STAGED, 0},
+	};
+
+	for (size_t i = 0; i < sizeof(args) / sizeof(args[0]); ++i) {
+		/* run test */
+		int ret = rpma_bounce_send(args[i].bounce, args[i].src,
+				args[i].len, args[i].flags, MOCK_OP_CONTEXT);
+
+		/* verify the results */
+		assert_int_equal(ret, RPMA_E_INVAL);
+	}
+}
+
+/*
+ * send__paths -- the send takes the path matching its size
+ */
+static void
+send__paths(void **bstate_ptr)
+{
+	struct bounce_test_state *bstate = *bstate_ptr;
+	memset(User_mem, 'y', MOCK_LEN_STAGED);
+
+	/* configure mocks */
+	expect_inline(NULL, 0, MOCK_LEN_INLINE, IBV_WR_SEND, MOCK_OK);
+	bounce_expect_send(MOCK_RPMA_MR_LOCAL, 0, MOCK_LEN_STAGED, MOCK_OK);
+	bounce_expect_reg(0, PAGESIZE, RPMA_MR_USAGE_SEND);
+	bounce_expect_send(MOCK_RPMA_MR_CACHED, 0, MOCK_LEN_CACHED, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_bounce_send(bstate->bounce, User_mem, MOCK_LEN_INLINE,
+			RPMA_F_COMPLETION_ALWAYS, MOCK_OP_CONTEXT);
+	assert_int_equal(ret, MOCK_OK);
+	ret = rpma_bounce_send(bstate->bounce, User_mem, MOCK_LEN_STAGED,
+			RPMA_F_COMPLETION_ALWAYS, MOCK_OP_CONTEXT);
+	assert_int_equal(ret, MOCK_OK);
+	assert_memory_equal(SLOT_BUF(bstate, 0), User_mem, MOCK_LEN_STAGED);
+	complete_posted(bstate);
+	ret = rpma_bounce_send(bstate->bounce, User_mem, MOCK_LEN_CACHED,
+			RPMA_F_COMPLETION_ALWAYS, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	complete_posted(bstate);
+
+	bounce_expect_dereg(MOCK_RPMA_MR_CACHED);
+	assert_int_equal(rpma_bounce_invalidate(bstate->bounce, User_mem,
+			PAGESIZE), MOCK_OK);
+}
+
+static const struct CMUnitTest tests_write_send[] = {
+	/* rpma_bounce_write() unit tests */
+	cmocka_unit_test_setup_teardown(write__invalid_args,
+		setup__bounce_new, teardown__bounce_delete),
+	cmocka_unit_test_setup_teardown(write__inline,
+		setup__bounce_new, teardown__bounce_delete),
+	cmocka_unit_test_setup_teardown(write__staged,
+		setup__bounce_new, teardown__bounce_delete),
+	cmocka_unit_test_setup_teardown(write__staged_E_PROVIDER,
+		setup__bounce_new, teardown__bounce_delete),
+	cmocka_unit_test_setup_teardown(write__no_free_slot,
+		setup__bounce_new, teardown__bounce_delete),
+	cmocka_unit_test_setup_teardown(write__cached,
+		setup__bounce_new, teardown__bounce_delete),
+	cmocka_unit_test_setup_teardown(write__cached_across_pages,
+		setup__bounce_new, teardown__bounce_delete),
+	cmocka_unit_test_setup_teardown(write__mr_reg_E_PROVIDER,
+		setup__bounce_new, teardown__bounce_delete),
+
+	/* rpma_bounce_send() unit tests */
+	cmocka_unit_test_setup_teardown(send__invalid_args,
+		setup__bounce_new, teardown__bounce_delete),
+	cmocka_unit_test_setup_teardown(send__paths,
+		setup__bounce_new, teardown__bounce_delete),
+
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_write_send, NULL, NULL);
+}
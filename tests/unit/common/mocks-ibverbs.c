@@ -19,7 +19,9 @@ struct ibv_device Ibv_device;
 struct ibv_context Ibv_context = {&Ibv_device};
 struct ibv_pd Ibv_pd = {&Ibv_context, 0};
 struct ibv_cq Ibv_cq;
+struct ibv_cq_ex Ibv_cq_ex;
 struct ibv_qp Ibv_qp;
+struct ibv_srq Ibv_srq = {&Ibv_context};
 struct ibv_mr Ibv_mr;
 
 /*
@@ -41,6 +43,53 @@ ibv_query_device(struct ibv_context *context,
 	return 0;
 }
 
+/*
+ * ibv_query_qp -- ibv_query_qp() mock
+ */
+int
+ibv_query_qp(struct ibv_qp *qp, struct ibv_qp_attr *attr, int attr_mask,
+		struct ibv_qp_init_attr *init_attr)
+{
+	assert_ptr_equal(qp, MOCK_QP);
+	assert_non_null(attr);
+	assert_int_equal(attr_mask, IBV_QP_CAP);
+	assert_non_null(init_attr);
+
+	int ret = mock_type(int);
+	if (ret)
+		return ret;
+
+	memset(init_attr, 0, sizeof(struct ibv_qp_init_attr));
+	init_attr->cap.max_inline_data = mock_type(uint32_t);
+
+	return 0;
+}
+
+/*
+ * ibv_query_port -- ibv_query_port() mock
+ *
+ * The ibv_query_port() macro falls back to this symbol when the context
+ * does not provide the query_port operation.
+ */
+#undef ibv_query_port
+int
+ibv_query_port(struct ibv_context *context, uint8_t port_num,
+		struct _compat_ibv_port_attr *port_attr)
+{
+	assert_ptr_equal(context, MOCK_VERBS);
+	assert_int_equal(port_num, MOCK_PORT_NUM);
+	assert_non_null(port_attr);
+
+	int ret = mock_type(int);
+	if (ret)
+		return ret;
+
+	struct ibv_port_attr *attr = (struct ibv_port_attr *)port_attr;
+	attr->max_msg_sz = mock_type(uint32_t);
+
+	return 0;
+}
+
 #ifdef ON_DEMAND_PAGING_SUPPORTED
 /*
  * ibv_query_device_ex_mock -- ibv_query_device_ex() mock
@@ -76,7 +125,7 @@ ibv_create_cq(struct ibv_context *context, int cqe, void *cq_context,
 	assert_ptr_equal(context, MOCK_VERBS);
 	check_expected(cqe);
 	assert_ptr_equal(channel, MOCK_COMP_CHANNEL);
-	assert_int_equal(comp_vector, 0);
+	assert_int_equal(comp_vector, MOCK_COMP_VECTOR);
 
 	struct ibv_cq *cq = mock_type(struct ibv_cq *);
 	if (!cq) {
@@ -89,13 +138,41 @@ ibv_create_cq(struct ibv_context *context, int cqe, void *cq_context,
 	return cq;
 }
 
+/*
+ * ibv_create_cq_ex_mock -- ibv_create_cq_ex() mock
+ */
+struct ibv_cq_ex *
+ibv_create_cq_ex_mock(struct ibv_context *context,
+		struct ibv_cq_init_attr_ex *cq_attr)
+{
+	assert_ptr_equal(context, MOCK_VERBS);
+	assert_non_null(cq_attr);
+	assert_int_equal(cq_attr->cqe, MOCK_CQ_SIZE_DEFAULT);
+	assert_ptr_equal(cq_attr->channel, MOCK_COMP_CHANNEL);
+	assert_int_equal(cq_attr->comp_vector, MOCK_COMP_VECTOR);
+	uint64_t wc_flags = cq_attr->wc_flags;
+	check_expected(wc_flags);
+
+	struct ibv_cq_ex *cq = mock_type(struct ibv_cq_ex *);
+	if (!cq) {
+		errno = mock_type(int);
+		return NULL;
+	}
+
+	cq->channel = cq_attr->channel;
+
+	return cq;
+}
+
 /*
  * ibv_destroy_cq -- ibv_destroy_cq() mock
  */
 int
 ibv_destroy_cq(struct ibv_cq *cq)
 {
-	assert_int_equal(cq, MOCK_IBV_CQ);
+	/* either the regular or the extended CQ */
+	if (cq != ibv_cq_ex_to_cq(MOCK_IBV_CQ_EX))
+		assert_int_equal(cq, MOCK_IBV_CQ);
 
 	return mock_type(int);
 }
@@ -181,7 +258,9 @@ ibv_reg_mr(struct ibv_pd *pd, void *addr, size_t length, int access)
 int
 ibv_req_notify_cq_mock(struct ibv_cq *cq, int solicited_only)
 {
-	assert_ptr_equal(cq, MOCK_IBV_CQ);
+	/* either the regular or the extended CQ */
+	if (cq != ibv_cq_ex_to_cq(MOCK_IBV_CQ_EX))
+		assert_ptr_equal(cq, MOCK_IBV_CQ);
 	assert_int_equal(solicited_only, 0);
 
 	return mock_type(int);
@@ -264,7 +343,13 @@ ibv_post_send_mock(struct ibv_qp *qp, struct ibv_send_wr *wr,
 	assert_int_equal(wr->opcode, args->opcode);
 	assert_int_equal(wr->send_flags, args->send_flags);
 	assert_int_equal(wr->wr_id, args->wr_id);
-	if (args->opcode != IBV_WR_SEND &&
+	if (args->opcode == IBV_WR_ATOMIC_CMP_AND_SWP ||
+	    args->opcode == IBV_WR_ATOMIC_FETCH_AND_ADD) {
+		assert_int_equal(wr->wr.atomic.remote_addr, args->remote_addr);
+		assert_int_equal(wr->wr.atomic.rkey, args->rkey);
+		assert_int_equal(wr->wr.atomic.compare_add, args->compare_add);
+		assert_int_equal(wr->wr.atomic.swap, args->swap);
+	} else if (args->opcode != IBV_WR_SEND &&
 	    args->opcode != IBV_WR_SEND_WITH_IMM) {
 		assert_int_equal(wr->wr.rdma.remote_addr, args->remote_addr);
 		assert_int_equal(wr->wr.rdma.rkey, args->rkey);
@@ -298,6 +383,60 @@ ibv_post_recv_mock(struct ibv_qp *qp, struct ibv_recv_wr *wr,
 	return args->ret;
 }
 
+/*
+ * ibv_post_srq_recv_mock -- mock of ibv_post_srq_recv()
+ */
+int
+ibv_post_srq_recv_mock(struct ibv_srq *srq, struct ibv_recv_wr *wr,
+			struct ibv_recv_wr **bad_wr)
+{
+	struct ibv_post_srq_recv_mock_args *args =
+		mock_type(struct ibv_post_srq_recv_mock_args *);
+
+	assert_non_null(srq);
+	assert_non_null(wr);
+	assert_non_null(bad_wr);
+
+	assert_ptr_equal(srq, args->srq);
+	assert_int_equal(wr->wr_id, args->wr_id);
+	assert_null(wr->next);
+
+	return args->ret;
+}
+
+/*
+ * ibv_create_srq -- ibv_create_srq() mock
+ */
+struct ibv_srq *
+ibv_create_srq(struct ibv_pd *pd, struct ibv_srq_init_attr *srq_init_attr)
+{
+	assert_ptr_equal(pd, MOCK_IBV_PD);
+	assert_non_null(srq_init_attr);
+	assert_null(srq_init_attr->srq_context);
+	check_expected(srq_init_attr->attr.max_wr);
+	assert_int_equal(srq_init_attr->attr.max_sge, RPMA_MAX_SGE);
+	assert_int_equal(srq_init_attr->attr.srq_limit, 0);
+
+	struct ibv_srq *srq = mock_type(struct ibv_srq *);
+	if (!srq) {
+		errno = mock_type(int);
+		return NULL;
+	}
+
+	return srq;
+}
+
+/*
+ * ibv_destroy_srq -- ibv_destroy_srq() mock
+ */
+int
+ibv_destroy_srq(struct ibv_srq *srq)
+{
+	assert_ptr_equal(srq, MOCK_IBV_SRQ);
+
+	return mock_type(int);
+}
+
 /*
  * ibv_alloc_pd -- ibv_alloc_pd() mock
  */
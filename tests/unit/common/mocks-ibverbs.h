@@ -17,16 +17,21 @@ extern struct ibv_context Ibv_context;
 extern struct ibv_device Ibv_device;
 extern struct ibv_pd Ibv_pd;
 extern struct ibv_cq Ibv_cq;
+extern struct ibv_cq_ex Ibv_cq_ex;
 extern struct ibv_qp Ibv_qp;
+extern struct ibv_srq Ibv_srq;
 extern struct ibv_mr Ibv_mr;
 
 /* random values or pointers to mocked IBV entities */
 #define MOCK_VERBS		(&Verbs_context.context)
 #define MOCK_COMP_CHANNEL	(struct ibv_comp_channel *)&Ibv_comp_channel
 #define MOCK_IBV_CQ		(struct ibv_cq *)&Ibv_cq
+#define MOCK_IBV_CQ_EX		(struct ibv_cq_ex *)&Ibv_cq_ex
 #define MOCK_IBV_PD		(struct ibv_pd *)&Ibv_pd
 #define MOCK_QP			(struct ibv_qp *)&Ibv_qp
+#define MOCK_IBV_SRQ		(struct ibv_srq *)&Ibv_srq
 #define MOCK_MR			(struct ibv_mr *)&Ibv_mr
+#define MOCK_PORT_NUM		(uint8_t)2
 
 struct ibv_alloc_pd_mock_args {
 	int validate_params;
@@ -46,6 +51,8 @@ struct ibv_post_send_mock_args {
 	uint64_t remote_addr;
 	uint32_t rkey;
 	uint32_t imm_data;
+	uint64_t compare_add;
+	uint64_t swap;
 	int ret;
 };
 
@@ -55,6 +62,12 @@ struct ibv_post_recv_mock_args {
 	int ret;
 };
 
+struct ibv_post_srq_recv_mock_args {
+	struct ibv_srq *srq;
+	uint64_t wr_id;
+	int ret;
+};
+
 #ifdef ON_DEMAND_PAGING_SUPPORTED
 int ibv_query_device_ex_mock(struct ibv_context *context,
 		const struct ibv_query_device_ex_input *input,
@@ -68,6 +81,12 @@ int ibv_post_send_mock(struct ibv_qp *qp, struct ibv_send_wr *wr,
 int ibv_post_recv_mock(struct ibv_qp *qp, struct ibv_recv_wr *wr,
 			struct ibv_recv_wr **bad_wr);
 
+int ibv_post_srq_recv_mock(struct ibv_srq *srq, struct ibv_recv_wr *wr,
+			struct ibv_recv_wr **bad_wr);
+
 int ibv_req_notify_cq_mock(struct ibv_cq *cq, int solicited_only);
 
+struct ibv_cq_ex *ibv_create_cq_ex_mock(struct ibv_context *context,
+		struct ibv_cq_init_attr_ex *cq_attr);
+
 #endif /* MOCKS_IBVERBS_H */
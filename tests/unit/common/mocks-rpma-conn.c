@@ -10,6 +10,8 @@
 #include <librpma.h>
 
 #include "cmocka_headers.h"
+#include "conn_mt.h"
+#include "stats.h"
 #include "mocks-ibverbs.h"
 #include "mocks-rpma-cq.h"
 
@@ -77,3 +79,85 @@ rpma_conn_transfer_private_data(struct rpma_conn *conn,
 	check_expected(pdata->ptr);
 	check_expected(pdata->len);
 }
+
+/*
+ * rpma_conn_transfer_mt -- rpma_conn_transfer_mt() mock
+ */
+void
+rpma_conn_transfer_mt(struct rpma_conn *conn, struct rpma_conn_mt **mt_ptr)
+{
+	assert_non_null(conn);
+	assert_non_null(mt_ptr);
+	check_expected(conn);
+
+	*mt_ptr = NULL;
+}
+
+/*
+ * rpma_conn_transfer_stats -- rpma_conn_transfer_stats() mock
+ */
+void
+rpma_conn_transfer_stats(struct rpma_conn *conn,
+		struct rpma_conn_stats **stats_ptr)
+{
+	assert_non_null(conn);
+	assert_non_null(stats_ptr);
+	check_expected(conn);
+
+	*stats_ptr = NULL;
+}
+
+/*
+ * rpma_conn_get_ibv_qp -- rpma_conn_get_ibv_qp() mock
+ */
+int
+rpma_conn_get_ibv_qp(const struct rpma_conn *conn, struct ibv_qp **qp_ptr)
+{
+	assert_ptr_equal(conn, MOCK_CONN);
+	assert_non_null(qp_ptr);
+
+	int result = mock_type(int);
+	if (result == MOCK_OK)
+		*qp_ptr = MOCK_QP;
+
+	return result;
+}
+
+/*
+ * rpma_send -- rpma_send() mock
+ */
+int
+rpma_send(struct rpma_conn *conn,
+		const struct rpma_mr_local *src, size_t offset, size_t len,
+		int flags, const void *op_context)
+{
+	assert_ptr_equal(conn, MOCK_CONN);
+	check_expected_ptr(src);
+	check_expected(offset);
+	check_expected(len);
+	check_expected(flags);
+	check_expected_ptr(op_context);
+
+	return mock_type(int);
+}
+
+/*
+ * rpma_write -- rpma_write() mock
+ */
+int
+rpma_write(struct rpma_conn *conn,
+		struct rpma_mr_remote *dst, size_t dst_offset,
+		const struct rpma_mr_local *src,  size_t src_offset,
+		size_t len, int flags, const void *op_context)
+{
+	assert_ptr_equal(conn, MOCK_CONN);
+	check_expected_ptr(dst);
+	check_expected(dst_offset);
+	check_expected_ptr(src);
+	check_expected(src_offset);
+	check_expected(len);
+	check_expected(flags);
+	check_expected_ptr(op_context);
+
+	return mock_type(int);
+}
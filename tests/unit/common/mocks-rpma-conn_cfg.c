@@ -88,3 +88,111 @@ rpma_conn_cfg_get_rq_size(const struct rpma_conn_cfg *cfg, uint32_t *rq_size)
 
 	return 0;
 }
+
+/*
+ * rpma_conn_cfg_get_thread_mode -- rpma_conn_cfg_get_thread_mode() mock
+ * (the single-threaded mode is always reported)
+ */
+int
+rpma_conn_cfg_get_thread_mode(const struct rpma_conn_cfg *cfg,
+		enum rpma_conn_thread_mode *mode)
+{
+	assert_non_null(cfg);
+	assert_non_null(mode);
+
+	*mode = RPMA_CONN_THREAD_SINGLE;
+
+	return 0;
+}
+
+/*
+ * rpma_conn_cfg_get_stats -- rpma_conn_cfg_get_stats() mock
+ * (no statistics are always reported)
+ */
+int
+rpma_conn_cfg_get_stats(const struct rpma_conn_cfg *cfg, int *stats)
+{
+	assert_non_null(cfg);
+	assert_non_null(stats);
+
+	*stats = 0;
+
+	return 0;
+}
+
+/*
+ * rpma_conn_cfg_get_timestamps -- rpma_conn_cfg_get_timestamps() mock
+ * (no timestamps are always reported)
+ */
+int
+rpma_conn_cfg_get_timestamps(const struct rpma_conn_cfg *cfg,
+		bool *timestamps)
+{
+	assert_non_null(cfg);
+	assert_non_null(timestamps);
+
+	*timestamps = false;
+
+	return 0;
+}
+
+/*
+ * rpma_conn_cfg_get_comp_vector -- rpma_conn_cfg_get_comp_vector() mock
+ */
+int
+rpma_conn_cfg_get_comp_vector(const struct rpma_conn_cfg *cfg,
+		int *comp_vector)
+{
+	assert_non_null(cfg);
+	assert_non_null(comp_vector);
+
+	*comp_vector = MOCK_COMP_VECTOR;
+
+	return 0;
+}
+
+/*
+ * rpma_conn_cfg_get_numa_node -- rpma_conn_cfg_get_numa_node() mock
+ * (no NUMA node is ever preferred)
+ */
+int
+rpma_conn_cfg_get_numa_node(const struct rpma_conn_cfg *cfg, int *node)
+{
+	assert_non_null(cfg);
+	assert_non_null(node);
+
+	*node = RPMA_NUMA_NODE_ANY;
+
+	return 0;
+}
+
+/*
+ * rpma_conn_cfg_get_srq -- rpma_conn_cfg_get_srq() mock
+ */
+int
+rpma_conn_cfg_get_srq(const struct rpma_conn_cfg *cfg,
+		struct rpma_srq **srq_ptr)
+{
+	assert_non_null(cfg);
+	assert_non_null(srq_ptr);
+
+	*srq_ptr = mock_type(struct rpma_srq *);
+
+	return 0;
+}
+
+/*
+ * rpma_conn_cfg_get_inline_size -- rpma_conn_cfg_get_inline_size() mock
+ * (the hardcoded inline size is always reported)
+ */
+int
+rpma_conn_cfg_get_inline_size(const struct rpma_conn_cfg *cfg,
+		uint32_t *inline_size)
+{
+	assert_non_null(cfg);
+	assert_non_null(inline_size);
+
+	*inline_size = RPMA_MAX_INLINE_DATA;
+
+	return 0;
+}
@@ -0,0 +1,191 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * mocks-rpma-conn_mt.c -- librpma conn_mt.c module mocks
+ */
+
+#include "cmocka_headers.h"
+#include "mocks-rpma-conn_mt.h"
+
+/*
+ * rpma_conn_mt_new -- rpma_conn_mt_new() mock
+ */
+int
+rpma_conn_mt_new(struct ibv_qp *qp, struct rpma_cq *cq,
+		enum rpma_conn_thread_mode mode, uint32_t sq_size,
+		uint32_t rq_size, struct rpma_conn_mt **mt_ptr)
+{
+	assert_non_null(qp);
+	assert_non_null(cq);
+	assert_non_null(mt_ptr);
+	check_expected(mode);
+
+	int ret = mock_type(int);
+	if (ret)
+		return ret;
+
+	*mt_ptr = MOCK_CONN_MT;
+
+	return 0;
+}
+
+/*
+ * rpma_conn_mt_delete -- rpma_conn_mt_delete() mock
+ * (deleting a NULL object does not require any mock configuration)
+ */
+int
+rpma_conn_mt_delete(struct rpma_conn_mt **mt_ptr)
+{
+	assert_non_null(mt_ptr);
+
+	if (*mt_ptr == NULL)
+		return 0;
+
+	struct rpma_conn_mt *mt = *mt_ptr;
+	check_expected(mt);
+
+	*mt_ptr = NULL;
+
+	return 0;
+}
+
+/*
+ * rpma_conn_mt_read -- rpma_conn_mt_read() mock
+ */
+int
+rpma_conn_mt_read(struct rpma_conn_mt *mt,
+	struct rpma_mr_local *dst, size_t dst_offset,
+	const struct rpma_mr_remote *src,  size_t src_offset,
+	size_t len, int flags, const void *op_context)
+{
+	check_expected(mt);
+	check_expected(op_context);
+
+	return mock_type(int);
+}
+
+/*
+ * rpma_conn_mt_atomic -- rpma_conn_mt_atomic() mock
+ */
+int
+rpma_conn_mt_atomic(struct rpma_conn_mt *mt,
+	struct rpma_mr_local *dst, size_t dst_offset,
+	const struct rpma_mr_remote *src, size_t src_offset,
+	enum ibv_wr_opcode operation, uint64_t compare_add, uint64_t swap,
+	int flags, const void *op_context)
+{
+	check_expected(mt);
+	check_expected(operation);
+	check_expected(op_context);
+
+	return mock_type(int);
+}
+
+/*
+ * rpma_conn_mt_write -- rpma_conn_mt_write() mock
+ */
+int
+rpma_conn_mt_write(struct rpma_conn_mt *mt,
+	struct rpma_mr_remote *dst, size_t dst_offset,
+	const struct rpma_mr_local *src,  size_t src_offset,
+	size_t len, int flags, enum ibv_wr_opcode operation,
+	uint32_t imm, const void *op_context, bool fence)
+{
+	check_expected(mt);
+	check_expected(operation);
+	check_expected(op_context);
+	check_expected(fence);
+
+	return mock_type(int);
+}
+
+/*
+ * rpma_conn_mt_send -- rpma_conn_mt_send() mock
+ */
+int
+rpma_conn_mt_send(struct rpma_conn_mt *mt,
+	const struct rpma_mr_local *src,  size_t offset,
+	size_t len, int flags, enum ibv_wr_opcode operation,
+	uint32_t imm, const void *op_context)
+{
+	check_expected(mt);
+	check_expected(operation);
+	check_expected(op_context);
+
+	return mock_type(int);
+}
+
+/*
+ * rpma_conn_mt_recv -- rpma_conn_mt_recv() mock
+ */
+int
+rpma_conn_mt_recv(struct rpma_conn_mt *mt,
+	struct rpma_mr_local *dst,  size_t offset,
+	size_t len, const void *op_context)
+{
+	check_expected(mt);
+	check_expected(op_context);
+
+	return mock_type(int);
+}
+
+/*
+ * rpma_conn_mt_flush -- rpma_conn_mt_flush() mock
+ */
+int
+rpma_conn_mt_flush(struct rpma_conn_mt *mt, struct rpma_flush *flush,
+	struct rpma_mr_remote *dst, size_t dst_offset, size_t len,
+	enum rpma_flush_type type, int flags, const void *op_context)
+{
+	check_expected(mt);
+	check_expected(op_context);
+
+	return mock_type(int);
+}
+
+/*
+ * rpma_conn_mt_completion_wait -- rpma_conn_mt_completion_wait() mock
+ */
+int
+rpma_conn_mt_completion_wait(struct rpma_conn_mt *mt)
+{
+	check_expected(mt);
+
+	return mock_type(int);
+}
+
+/*
+ * rpma_conn_mt_completion_get -- rpma_conn_mt_completion_get() mock
+ */
+int
+rpma_conn_mt_completion_get(struct rpma_conn_mt *mt,
+		struct rpma_completion *cmpl)
+{
+	check_expected(mt);
+	assert_non_null(cmpl);
+
+	return mock_type(int);
+}
+
+/*
+ * rpma_conn_mt_thread_attach -- rpma_conn_mt_thread_attach() mock
+ */
+int
+rpma_conn_mt_thread_attach(struct rpma_conn_mt *mt)
+{
+	check_expected(mt);
+
+	return mock_type(int);
+}
+
+/*
+ * rpma_conn_mt_thread_detach -- rpma_conn_mt_thread_detach() mock
+ */
+int
+rpma_conn_mt_thread_detach(struct rpma_conn_mt *mt)
+{
+	check_expected(mt);
+
+	return mock_type(int);
+}
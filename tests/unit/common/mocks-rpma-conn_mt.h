@@ -0,0 +1,16 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * mocks-rpma-conn_mt.h -- librpma conn_mt.c module mocks
+ */
+
+#ifndef MOCKS_RPMA_CONN_MT_H
+#define MOCKS_RPMA_CONN_MT_H
+
+#include "test-common.h"
+#include "conn_mt.h"
+
+#define MOCK_CONN_MT		(struct rpma_conn_mt *)0xC0F7
+
+#endif /* MOCKS_RPMA_CONN_MT_H */
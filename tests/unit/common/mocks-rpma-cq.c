@@ -55,14 +55,40 @@ rpma_cq_get_completion(struct rpma_cq *cq, struct rpma_completion *cmpl)
 	return result;
 }
 
+/*
+ * rpma_cq_get_completion_ex -- rpma_cq_get_completion_ex() mock
+ */
+int
+rpma_cq_get_completion_ex(struct rpma_cq *cq,
+		struct rpma_completion_ex *cmpl_ex)
+{
+	assert_ptr_equal(cq, MOCK_RPMA_CQ);
+	assert_non_null(cmpl_ex);
+
+	int result = mock_type(int);
+	if (result == MOCK_OK) {
+		memcpy(&cmpl_ex->cmpl, MOCK_COMPLETION,
+			sizeof(struct rpma_completion));
+		cmpl_ex->ts_source = RPMA_COMPLETION_TS_HW_WALLCLOCK;
+		cmpl_ex->ts_ns = MOCK_TS_NS;
+		cmpl_ex->polled_ns = MOCK_POLLED_NS;
+	}
+
+	return result;
+}
+
 /*
  * rpma_cq_new -- rpma_cq_new() mock
  */
 int
-rpma_cq_new(struct ibv_context *dev, int cqe, struct rpma_cq **cq_ptr)
+rpma_cq_new(struct ibv_context *dev, int cqe, int comp_vector,
+		bool timestamps, struct rpma_cq **cq_ptr)
 {
 	assert_non_null(dev);
 	check_expected(cqe);
+	check_expected(comp_vector);
+	/* rpma_conn_cfg_get_timestamps() mock always reports false */
+	assert_false(timestamps);
 	assert_non_null(cq_ptr);
 
 	struct rpma_cq *cq = mock_type(struct rpma_cq *);
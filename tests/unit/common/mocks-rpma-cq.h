@@ -23,5 +23,7 @@ static const struct rpma_completion Completion = {
 };
 
 #define MOCK_COMPLETION		&Completion
+#define MOCK_TS_NS		0x16B1A5E0C0FFEE00
+#define MOCK_POLLED_NS		0x16B1A5E0C0FFF000
 
 #endif /* MOCKS_RPMA_CQ_H */
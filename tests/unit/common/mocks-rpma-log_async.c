@@ -0,0 +1,40 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * mocks-rpma-log_async.c -- librpma log_async.c module mocks
+ */
+
+#include "cmocka_headers.h"
+#include "log_async.h"
+
+/*
+ * rpma_log_async_function -- rpma_log_async_function() mock
+ */
+void
+rpma_log_async_function(enum rpma_log_level level, const char *file_name,
+	const int line_no, const char *function_name,
+	const char *message_format, ...)
+{
+
+}
+
+/*
+ * rpma_log_async_start -- rpma_log_async_start() mock
+ */
+int
+rpma_log_async_start(void)
+{
+	function_called();
+
+	return mock_type(int);
+}
+
+/*
+ * rpma_log_async_fini -- rpma_log_async_fini() mock
+ */
+void
+rpma_log_async_fini(void)
+{
+	function_called();
+}
@@ -39,6 +39,35 @@ rpma_mr_read(struct ibv_qp *qp,
 	return mock_type(int);
 }
 
+/*
+ * rpma_mr_atomic -- rpma_mr_atomic() mock
+ */
+int
+rpma_mr_atomic(struct ibv_qp *qp,
+	struct rpma_mr_local *dst, size_t dst_offset,
+	const struct rpma_mr_remote *src, size_t src_offset,
+	enum ibv_wr_opcode operation, uint64_t compare_add, uint64_t swap,
+	int flags, const void *op_context)
+{
+	assert_non_null(qp);
+	assert_non_null(dst);
+	assert_non_null(src);
+	assert_int_not_equal(flags, 0);
+
+	check_expected_ptr(qp);
+	check_expected_ptr(dst);
+	check_expected(dst_offset);
+	check_expected_ptr(src);
+	check_expected(src_offset);
+	check_expected(operation);
+	check_expected(compare_add);
+	check_expected(swap);
+	check_expected(flags);
+	check_expected_ptr(op_context);
+
+	return mock_type(int);
+}
+
 /*
  * rpma_mr_write -- rpma_mr_write() mock
  */
@@ -136,6 +165,31 @@ rpma_mr_send(struct ibv_qp *qp,
 	return mock_type(int);
 }
 
+/*
+ * rpma_mr_inline -- mock of rpma_mr_inline
+ */
+int
+rpma_mr_inline(struct ibv_qp *qp,
+	struct rpma_mr_remote *dst, size_t dst_offset,
+	const void *src, size_t len, int flags,
+	enum ibv_wr_opcode operation, const void *op_context)
+{
+	assert_non_null(qp);
+	assert_int_not_equal(flags, 0);
+	assert_non_null(src);
+
+	check_expected_ptr(qp);
+	check_expected_ptr(dst);
+	check_expected(dst_offset);
+	check_expected_ptr(src);
+	check_expected(len);
+	check_expected(flags);
+	check_expected(operation);
+	check_expected_ptr(op_context);
+
+	return mock_type(int);
+}
+
 /*
  * rpma_mr_recv -- mock of rpma_mr_recv
  */
@@ -156,6 +210,47 @@ rpma_mr_recv(struct ibv_qp *qp,
 	return mock_type(int);
 }
 
+/*
+ * rpma_mr_recv_wr -- mock of rpma_mr_recv_wr (fills in the work request
+ * with the offset as the address so the layout can be verified)
+ */
+void
+rpma_mr_recv_wr(struct ibv_recv_wr *wr, struct ibv_sge *sge,
+	struct rpma_mr_local *dst,  size_t offset,
+	size_t len, const void *op_context)
+{
+	assert_non_null(wr);
+	assert_non_null(sge);
+	assert_ptr_equal(dst, MOCK_RPMA_MR_LOCAL);
+
+	sge->addr = (uint64_t)offset;
+	sge->length = (uint32_t)len;
+	wr->sg_list = sge;
+	wr->num_sge = 1;
+	wr->next = NULL;
+	wr->wr_id = (uint64_t)op_context;
+}
+
+/*
+ * rpma_mr_srq_recv -- mock of rpma_mr_srq_recv
+ */
+int
+rpma_mr_srq_recv(struct ibv_srq *srq,
+	struct rpma_mr_local *dst,  size_t offset,
+	size_t len, const void *op_context)
+{
+	assert_non_null(srq);
+	assert_true(dst != NULL || (offset == 0 && len == 0));
+
+	check_expected_ptr(srq);
+	check_expected_ptr(dst);
+	check_expected(offset);
+	check_expected(len);
+	check_expected_ptr(op_context);
+
+	return mock_type(int);
+}
+
 /*
  * rpma_mr_remote_get_flush_type -- mock of rpma_mr_remote_get_flush_type
  */
@@ -169,3 +264,64 @@ rpma_mr_remote_get_flush_type(const struct rpma_mr_remote *mr, int *flush_type)
 
 	return 0;
 }
+
+/*
+ * rpma_mr_get_descriptor -- rpma_mr_get_descriptor() mock
+ */
+int
+rpma_mr_get_descriptor(const struct rpma_mr_local *mr, void *desc)
+{
+	check_expected_ptr(mr);
+	check_expected_ptr(desc);
+
+	return mock_type(int);
+}
+
+/*
+ * rpma_mr_get_descriptor_size -- rpma_mr_get_descriptor_size() mock
+ */
+int
+rpma_mr_get_descriptor_size(const struct rpma_mr_local *mr,
+		size_t *desc_size)
+{
+	check_expected_ptr(mr);
+	assert_non_null(desc_size);
+
+	*desc_size = mock_type(size_t);
+
+	return 0;
+}
+
+/*
+ * rpma_mr_remote_from_descriptor -- rpma_mr_remote_from_descriptor() mock
+ */
+int
+rpma_mr_remote_from_descriptor(const void *desc,
+		size_t desc_size, struct rpma_mr_remote **mr_ptr)
+{
+	check_expected_ptr(desc);
+	check_expected(desc_size);
+	assert_non_null(mr_ptr);
+
+	struct rpma_mr_remote *mr = mock_type(struct rpma_mr_remote *);
+	if (mr == NULL)
+		return mock_type(int);
+
+	*mr_ptr = mr;
+
+	return 0;
+}
+
+/*
+ * rpma_mr_remote_delete -- rpma_mr_remote_delete() mock
+ */
+int
+rpma_mr_remote_delete(struct rpma_mr_remote **mr_ptr)
+{
+	assert_non_null(mr_ptr);
+	check_expected_ptr(*mr_ptr);
+
+	*mr_ptr = NULL;
+
+	return mock_type(int);
+}
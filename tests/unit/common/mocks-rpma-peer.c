@@ -13,6 +13,7 @@
 #include "mocks-ibverbs.h"
 #include "mocks-rpma-peer.h"
 #include "mocks-rpma-cq.h"
+#include "mocks-rpma-stats.h"
 
 /*
  * rpma_peer_create_qp -- rpma_peer_create_qp() mock
@@ -34,6 +35,26 @@ rpma_peer_create_qp(struct rpma_peer *peer, struct rdma_cm_id *id,
 	return result;
 }
 
+/*
+ * rpma_peer_create_srq -- rpma_peer_create_srq() mock
+ */
+int
+rpma_peer_create_srq(struct rpma_peer *peer, uint32_t size,
+		struct ibv_srq **ibv_srq_ptr)
+{
+	assert_ptr_equal(peer, MOCK_PEER);
+	check_expected(size);
+	assert_non_null(ibv_srq_ptr);
+
+	struct ibv_srq *ibv_srq = mock_type(struct ibv_srq *);
+	if (ibv_srq == NULL)
+		return mock_type(int);
+
+	*ibv_srq_ptr = ibv_srq;
+
+	return 0;
+}
+
 /*
  * rpma_peer_mr_reg -- a mock of rpma_peer_mr_reg()
  */
@@ -67,3 +88,14 @@ rpma_peer_mr_reg(struct rpma_peer *peer, struct ibv_mr **ibv_mr_ptr,
 
 	return 0;
 }
+
+/*
+ * rpma_peer_get_stats_group -- rpma_peer_get_stats_group() mock
+ */
+struct rpma_stats_group *
+rpma_peer_get_stats_group(struct rpma_peer *peer)
+{
+	assert_non_null(peer);
+
+	return MOCK_STATS_GROUP;
+}
@@ -0,0 +1,96 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * mocks-rpma-recv_ring.c -- librpma recv_ring.c module mocks
+ */
+
+#include <librpma.h>
+
+#include "cmocka_headers.h"
+#include "mocks-rpma-recv_ring.h"
+#include "test-common.h"
+
+/*
+ * rpma_recv_ring_new -- rpma_recv_ring_new() mock
+ */
+int
+rpma_recv_ring_new(struct rpma_peer *peer, struct rpma_conn *conn,
+		struct rpma_srq *srq, uint32_t slots, size_t slot_size,
+		uint32_t batch, struct rpma_recv_ring **ring_ptr)
+{
+	assert_ptr_equal(peer, MOCK_PEER);
+	assert_ptr_equal(conn, MOCK_CONN);
+	assert_null(srq);
+	check_expected(slots);
+	check_expected(slot_size);
+	check_expected(batch);
+	assert_non_null(ring_ptr);
+
+	struct rpma_recv_ring *ring = mock_type(struct rpma_recv_ring *);
+	if (ring == NULL)
+		return mock_type(int);
+
+	*ring_ptr = ring;
+
+	return 0;
+}
+
+/*
+ * rpma_recv_ring_delete -- rpma_recv_ring_delete() mock
+ */
+int
+rpma_recv_ring_delete(struct rpma_recv_ring **ring_ptr)
+{
+	assert_non_null(ring_ptr);
+	assert_ptr_equal(*ring_ptr, MOCK_RPMA_RECV_RING);
+
+	*ring_ptr = NULL;
+
+	return mock_type(int);
+}
+
+/*
+ * rpma_recv_ring_get_msg -- rpma_recv_ring_get_msg() mock
+ */
+int
+rpma_recv_ring_get_msg(struct rpma_recv_ring *ring,
+		const struct rpma_completion *cmpl, struct rpma_recv_msg *msg)
+{
+	assert_ptr_equal(ring, MOCK_RPMA_RECV_RING);
+	assert_non_null(cmpl);
+	assert_non_null(msg);
+
+	struct rpma_recv_msg *rmsg = mock_type(struct rpma_recv_msg *);
+	if (rmsg == NULL)
+		return mock_type(int);
+
+	*msg = *rmsg;
+
+	return 0;
+}
+
+/*
+ * rpma_recv_ring_release -- rpma_recv_ring_release() mock
+ */
+int
+rpma_recv_ring_release(struct rpma_recv_ring *ring,
+		const struct rpma_recv_msg *msg)
+{
+	assert_ptr_equal(ring, MOCK_RPMA_RECV_RING);
+	assert_non_null(msg);
+	check_expected(msg->slot);
+
+	return mock_type(int);
+}
+
+/*
+ * rpma_recv_ring_repost -- rpma_recv_ring_repost() mock
+ */
+int
+rpma_recv_ring_repost(struct rpma_recv_ring *ring)
+{
+	assert_ptr_equal(ring, MOCK_RPMA_RECV_RING);
+
+	return mock_type(int);
+}
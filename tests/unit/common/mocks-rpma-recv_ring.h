@@ -0,0 +1,15 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * mocks-rpma-recv_ring.h -- librpma recv_ring.c module mocks
+ */
+
+#ifndef MOCKS_RPMA_RECV_RING_H
+#define MOCKS_RPMA_RECV_RING_H
+
+#include "librpma.h"
+
+#define MOCK_RPMA_RECV_RING	(struct rpma_recv_ring *)0x4EC4
+
+#endif /* MOCKS_RPMA_RECV_RING_H */
@@ -0,0 +1,35 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * mocks-rpma-srq.c -- librpma srq.c module mocks
+ */
+
+#include "librpma.h"
+
+#include "cmocka_headers.h"
+#include "mocks-ibverbs.h"
+#include "mocks-rpma-cq.h"
+#include "mocks-rpma-srq.h"
+
+/*
+ * rpma_srq_get_ibv_srq -- rpma_srq_get_ibv_srq() mock
+ */
+struct ibv_srq *
+rpma_srq_get_ibv_srq(const struct rpma_srq *srq)
+{
+	assert_ptr_equal(srq, MOCK_RPMA_SRQ);
+
+	return MOCK_IBV_SRQ;
+}
+
+/*
+ * rpma_srq_get_rcq -- rpma_srq_get_rcq() mock
+ */
+struct rpma_cq *
+rpma_srq_get_rcq(const struct rpma_srq *srq)
+{
+	assert_ptr_equal(srq, MOCK_RPMA_SRQ);
+
+	return MOCK_RPMA_CQ;
+}
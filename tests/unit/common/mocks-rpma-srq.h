@@ -0,0 +1,15 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * mocks-rpma-srq.h -- librpma srq.c module mocks
+ */
+
+#ifndef MOCKS_RPMA_SRQ_H
+#define MOCKS_RPMA_SRQ_H
+
+#include "srq.h"
+
+#define MOCK_RPMA_SRQ		(struct rpma_srq *)0x5A9C
+
+#endif /* MOCKS_RPMA_SRQ_H */
@@ -0,0 +1,151 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * mocks-rpma-stats.c -- librpma stats.c module mocks
+ */
+
+#include <string.h>
+
+#include "cmocka_headers.h"
+#include "mocks-rpma-stats.h"
+
+/*
+ * rpma_stats_group_init -- rpma_stats_group_init() mock
+ */
+void
+rpma_stats_group_init(struct rpma_stats_group *group)
+{
+	assert_non_null(group);
+}
+
+/*
+ * rpma_stats_group_fini -- rpma_stats_group_fini() mock
+ */
+void
+rpma_stats_group_fini(struct rpma_stats_group *group)
+{
+	assert_non_null(group);
+}
+
+/*
+ * rpma_stats_group_get -- rpma_stats_group_get() mock
+ */
+void
+rpma_stats_group_get(struct rpma_stats_group *group,
+		struct rpma_stats *stats)
+{
+	assert_non_null(group);
+	check_expected(stats);
+
+	memset(stats, 0, sizeof(*stats));
+}
+
+/*
+ * rpma_conn_stats_new -- rpma_conn_stats_new() mock
+ */
+int
+rpma_conn_stats_new(struct rpma_stats_group *group, int flags,
+		bool shared, uint32_t sq_entries, uint32_t rq_entries,
+		struct rpma_conn_stats **stats_ptr)
+{
+	assert_non_null(group);
+	assert_non_null(stats_ptr);
+	check_expected(flags);
+
+	int ret = mock_type(int);
+	if (ret)
+		return ret;
+
+	*stats_ptr = MOCK_CONN_STATS;
+
+	return 0;
+}
+
+/*
+ * rpma_conn_stats_delete -- rpma_conn_stats_delete() mock
+ * (deleting a NULL object does not require any mock configuration)
+ */
+int
+rpma_conn_stats_delete(struct rpma_conn_stats **stats_ptr)
+{
+	assert_non_null(stats_ptr);
+
+	if (*stats_ptr == NULL)
+		return 0;
+
+	struct rpma_conn_stats *stats = *stats_ptr;
+	check_expected(stats);
+
+	*stats_ptr = NULL;
+
+	return 0;
+}
+
+/*
+ * rpma_conn_stats_latency -- rpma_conn_stats_latency() mock
+ */
+bool
+rpma_conn_stats_latency(const struct rpma_conn_stats *stats)
+{
+	check_expected(stats);
+
+	return mock_type(bool);
+}
+
+/*
+ * rpma_conn_stats_posting -- rpma_conn_stats_posting() mock
+ */
+void
+rpma_conn_stats_posting(struct rpma_conn_stats *stats, enum rpma_op op,
+		int flags)
+{
+	check_expected(stats);
+	check_expected(op);
+}
+
+/*
+ * rpma_conn_stats_posted -- rpma_conn_stats_posted() mock
+ */
+void
+rpma_conn_stats_posted(struct rpma_conn_stats *stats, enum rpma_op op,
+		size_t len, int flags, int ret)
+{
+	check_expected(stats);
+	check_expected(op);
+	check_expected(len);
+	check_expected(ret);
+}
+
+/*
+ * rpma_conn_stats_polled -- rpma_conn_stats_polled() mock
+ */
+void
+rpma_conn_stats_polled(struct rpma_conn_stats *stats,
+		const struct rpma_completion *cmpl, int ret)
+{
+	assert_non_null(cmpl);
+	check_expected(stats);
+	check_expected(ret);
+}
+
+/*
+ * rpma_conn_stats_woken -- rpma_conn_stats_woken() mock
+ */
+void
+rpma_conn_stats_woken(struct rpma_conn_stats *stats, int ret)
+{
+	check_expected(stats);
+	check_expected(ret);
+}
+
+/*
+ * rpma_conn_stats_get -- rpma_conn_stats_get() mock
+ */
+void
+rpma_conn_stats_get(const struct rpma_conn_stats *stats,
+		struct rpma_stats *snapshot)
+{
+	check_expected(stats);
+	check_expected(snapshot);
+}
@@ -0,0 +1,17 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * mocks-rpma-stats.h -- librpma stats.c module mocks
+ */
+
+#ifndef MOCKS_RPMA_STATS_H
+#define MOCKS_RPMA_STATS_H
+
+#include "test-common.h"
+#include "stats.h"
+
+#define MOCK_CONN_STATS		(struct rpma_conn_stats *)0xC057
+#define MOCK_STATS_GROUP	(struct rpma_stats_group *)0xC058
+
+#endif /* MOCKS_RPMA_STATS_H */
@@ -16,6 +16,7 @@
 #define MOCK_TIMEOUT_MS		5678
 #define MOCK_Q_SIZE		123
 #define MOCK_IMM_DATA		0x87654321
+#define MOCK_COMP_VECTOR	3
 
 /* random values */
 #define MOCK_RPMA_MR_LOCAL	(struct rpma_mr_local *)0xC411
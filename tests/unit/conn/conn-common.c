@@ -118,3 +118,40 @@ teardown__conn_delete(void **cstate_ptr)
 
 	return 0;
 }
+
+/*
+ * conn_expect_read -- configure mocks for a successful read
+ */
+void
+conn_expect_read(void)
+{
+	expect_value(rpma_mr_read, qp, MOCK_QP);
+	expect_value(rpma_mr_read, dst, MOCK_RPMA_MR_LOCAL);
+	expect_value(rpma_mr_read, dst_offset, MOCK_LOCAL_OFFSET);
+	expect_value(rpma_mr_read, src, MOCK_RPMA_MR_REMOTE);
+	expect_value(rpma_mr_read, src_offset, MOCK_REMOTE_OFFSET);
+	expect_value(rpma_mr_read, len, MOCK_LEN);
+	expect_value(rpma_mr_read, flags, MOCK_FLAGS);
+	expect_value(rpma_mr_read, op_context, MOCK_OP_CONTEXT);
+	will_return(rpma_mr_read, MOCK_OK);
+}
+
+/*
+ * conn_expect_write_atomic -- configure mocks for a successful atomic write
+ */
+void
+conn_expect_write_atomic(bool fence)
+{
+	expect_value(rpma_mr_write, qp, MOCK_QP);
+	expect_value(rpma_mr_write, dst, MOCK_RPMA_MR_REMOTE);
+	expect_value(rpma_mr_write, dst_offset, MOCK_OFFSET_ALIGNED);
+	expect_value(rpma_mr_write, src, MOCK_RPMA_MR_LOCAL);
+	expect_value(rpma_mr_write, src_offset, MOCK_LOCAL_OFFSET);
+	expect_value(rpma_mr_write, len, RPMA_ATOMIC_WRITE_ALIGNMENT);
+	expect_value(rpma_mr_write, flags, MOCK_FLAGS);
+	expect_value(rpma_mr_write, operation, IBV_WR_RDMA_WRITE);
+	expect_value(rpma_mr_write, imm, 0);
+	expect_value(rpma_mr_write, op_context, MOCK_OP_CONTEXT);
+	expect_value(rpma_mr_write, fence, fence);
+	will_return(rpma_mr_write, MOCK_OK);
+}
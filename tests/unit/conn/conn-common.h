@@ -17,6 +17,9 @@
 #define MOCK_REMOTE_OFFSET	(size_t)0xC414
 #define MOCK_OFFSET_ALIGNED	(size_t)((MOCK_REMOTE_OFFSET / \
 		RPMA_ATOMIC_WRITE_ALIGNMENT) * RPMA_ATOMIC_WRITE_ALIGNMENT)
+#define MOCK_COMPARE		(uint64_t)0xC441
+#define MOCK_SWAP		(uint64_t)0xC442
+#define MOCK_ADD		(uint64_t)0xC443
 #define MOCK_FD			0x00FD
 
 /* all the resources used between setup__conn_new and teardown__conn_delete */
@@ -28,4 +31,7 @@ struct conn_test_state {
 int setup__conn_new(void **cstate_ptr);
 int teardown__conn_delete(void **cstate_ptr);
 
+void conn_expect_read(void);
+void conn_expect_write_atomic(bool fence);
+
 #endif /* CONN_COMMON_H */
@@ -0,0 +1,188 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * conn-compare_and_swap.c -- the rpma_compare_and_swap() unit tests
+ *
+ * APIs covered:
+ * - rpma_compare_and_swap()
+ */
+
+#include "conn-common.h"
+#include "mocks-ibverbs.h"
+#include "mocks-rdma_cm.h"
+
+/*
+ * compare_and_swap__conn_NULL -- NULL conn is invalid
+ */
+static void
+compare_and_swap__conn_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_compare_and_swap(NULL,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_RPMA_MR_REMOTE, MOCK_OFFSET_ALIGNED,
+			MOCK_COMPARE, MOCK_SWAP, MOCK_FLAGS, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * compare_and_swap__dst_NULL -- NULL dst is invalid
+ */
+static void
+compare_and_swap__dst_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_compare_and_swap(MOCK_CONN,
+			NULL, MOCK_LOCAL_OFFSET,
+			MOCK_RPMA_MR_REMOTE, MOCK_OFFSET_ALIGNED,
+			MOCK_COMPARE, MOCK_SWAP, MOCK_FLAGS, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * compare_and_swap__src_NULL -- NULL src is invalid
+ */
+static void
+compare_and_swap__src_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_compare_and_swap(MOCK_CONN,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			NULL, MOCK_OFFSET_ALIGNED,
+			MOCK_COMPARE, MOCK_SWAP, MOCK_FLAGS, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * compare_and_swap__flags_0 -- flags == 0 is invalid
+ */
+static void
+compare_and_swap__flags_0(void **unused)
+{
+	/* run test */
+	int ret = rpma_compare_and_swap(MOCK_CONN,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_RPMA_MR_REMOTE, MOCK_OFFSET_ALIGNED,
+			MOCK_COMPARE, MOCK_SWAP, 0, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * compare_and_swap__src_offset_unaligned -- the unaligned src_offset is invalid
+ */
+static void
+compare_and_swap__src_offset_unaligned(void **unused)
+{
+	/* run test */
+	int ret = rpma_compare_and_swap(MOCK_CONN,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_RPMA_MR_REMOTE, MOCK_REMOTE_OFFSET,
+			MOCK_COMPARE, MOCK_SWAP, MOCK_FLAGS, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * compare_and_swap__E_PROVIDER -- rpma_mr_atomic() fails with RPMA_E_PROVIDER
+ */
+static void
+compare_and_swap__E_PROVIDER(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	/* configure mocks */
+	expect_value(rpma_mr_atomic, qp, MOCK_QP);
+	expect_value(rpma_mr_atomic, dst, MOCK_RPMA_MR_LOCAL);
+	expect_value(rpma_mr_atomic, dst_offset, MOCK_LOCAL_OFFSET);
+	expect_value(rpma_mr_atomic, src, MOCK_RPMA_MR_REMOTE);
+	expect_value(rpma_mr_atomic, src_offset, MOCK_OFFSET_ALIGNED);
+	expect_value(rpma_mr_atomic, operation, IBV_WR_ATOMIC_CMP_AND_SWP);
+	expect_value(rpma_mr_atomic, compare_add, MOCK_COMPARE);
+	expect_value(rpma_mr_atomic, swap, MOCK_SWAP);
+	expect_value(rpma_mr_atomic, flags, MOCK_FLAGS);
+	expect_value(rpma_mr_atomic, op_context, MOCK_OP_CONTEXT);
+	will_return(rpma_mr_atomic, RPMA_E_PROVIDER);
+
+	/* run test */
+	int ret = rpma_compare_and_swap(cstate->conn,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_RPMA_MR_REMOTE, MOCK_OFFSET_ALIGNED,
+			MOCK_COMPARE, MOCK_SWAP, MOCK_FLAGS, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+}
+
+/*
+ * compare_and_swap__success -- happy day scenario
+ */
+static void
+compare_and_swap__success(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	/* configure mocks */
+	expect_value(rpma_mr_atomic, qp, MOCK_QP);
+	expect_value(rpma_mr_atomic, dst, MOCK_RPMA_MR_LOCAL);
+	expect_value(rpma_mr_atomic, dst_offset, MOCK_LOCAL_OFFSET);
+	expect_value(rpma_mr_atomic, src, MOCK_RPMA_MR_REMOTE);
+	expect_value(rpma_mr_atomic, src_offset, MOCK_OFFSET_ALIGNED);
+	expect_value(rpma_mr_atomic, operation, IBV_WR_ATOMIC_CMP_AND_SWP);
+	expect_value(rpma_mr_atomic, compare_add, MOCK_COMPARE);
+	expect_value(rpma_mr_atomic, swap, MOCK_SWAP);
+	expect_value(rpma_mr_atomic, flags, MOCK_FLAGS);
+	expect_value(rpma_mr_atomic, op_context, MOCK_OP_CONTEXT);
+	will_return(rpma_mr_atomic, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_compare_and_swap(cstate->conn,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_RPMA_MR_REMOTE, MOCK_OFFSET_ALIGNED,
+			MOCK_COMPARE, MOCK_SWAP, MOCK_FLAGS, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * group_setup_compare_and_swap -- prepare resources for all tests in the group
+ */
+int
+group_setup_compare_and_swap(void **unused)
+{
+	/* set value of QP in mock of CM ID */
+	Cm_id.qp = MOCK_QP;
+
+	return 0;
+}
+
+static const struct CMUnitTest tests_compare_and_swap[] = {
+	/* rpma_compare_and_swap() unit tests */
+	cmocka_unit_test(compare_and_swap__conn_NULL),
+	cmocka_unit_test(compare_and_swap__dst_NULL),
+	cmocka_unit_test(compare_and_swap__src_NULL),
+	cmocka_unit_test(compare_and_swap__flags_0),
+	cmocka_unit_test(compare_and_swap__src_offset_unaligned),
+	cmocka_unit_test_setup_teardown(compare_and_swap__E_PROVIDER,
+		setup__conn_new, teardown__conn_delete),
+	cmocka_unit_test_setup_teardown(compare_and_swap__success,
+		setup__conn_new, teardown__conn_delete),
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_compare_and_swap,
+			group_setup_compare_and_swap, NULL);
+}
@@ -0,0 +1,109 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * conn-completion_get_ex.c -- the rpma_conn_completion_get_ex() unit tests
+ *
+ * API covered:
+ * - rpma_conn_completion_get_ex()
+ */
+
+#include <string.h>
+
+#include "conn-common.h"
+#include "mocks-ibverbs.h"
+#include "mocks-rpma-cq.h"
+#include "test-common.h"
+
+/*
+ * completion_get_ex__conn_NULL - NULL conn is invalid
+ */
+static void
+completion_get_ex__conn_NULL(void **unused)
+{
+	/* run test */
+	struct rpma_completion_ex cmpl_ex = {0};
+	int ret = rpma_conn_completion_get_ex(NULL, &cmpl_ex);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * completion_get_ex__cmpl_ex_NULL - NULL cmpl_ex is invalid
+ */
+static void
+completion_get_ex__cmpl_ex_NULL(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	/* run test */
+	int ret = rpma_conn_completion_get_ex(cstate->conn, NULL);
+
+	/* verify the result */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * completion_get_ex__cq_get_completion_ex_E_PROVIDER -
+ * rpma_cq_get_completion_ex() fails with RPMA_E_PROVIDER
+ */
+static void
+completion_get_ex__cq_get_completion_ex_E_PROVIDER(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	will_return(rpma_cq_get_completion_ex, RPMA_E_PROVIDER);
+
+	/* run test */
+	struct rpma_completion_ex cmpl_ex = {0};
+	int ret = rpma_conn_completion_get_ex(cstate->conn, &cmpl_ex);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+}
+
+/*
+ * completion_get_ex__success - happy day scenario
+ */
+static void
+completion_get_ex__success(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	will_return(rpma_cq_get_completion_ex, MOCK_OK);
+
+	/* run test */
+	struct rpma_completion_ex cmpl_ex = {0};
+	int ret = rpma_conn_completion_get_ex(cstate->conn, &cmpl_ex);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(memcmp(&cmpl_ex.cmpl, MOCK_COMPLETION,
+			sizeof(struct rpma_completion)), 0);
+	assert_int_equal(cmpl_ex.ts_source, RPMA_COMPLETION_TS_HW_WALLCLOCK);
+	assert_int_equal(cmpl_ex.ts_ns, MOCK_TS_NS);
+	assert_int_equal(cmpl_ex.polled_ns, MOCK_POLLED_NS);
+}
+
+static const struct CMUnitTest tests_completion_get_ex[] = {
+	/* rpma_conn_completion_get_ex() unit tests */
+	cmocka_unit_test(completion_get_ex__conn_NULL),
+	cmocka_unit_test_setup_teardown(
+		completion_get_ex__cmpl_ex_NULL,
+		setup__conn_new, teardown__conn_delete),
+	cmocka_unit_test_setup_teardown(
+		completion_get_ex__cq_get_completion_ex_E_PROVIDER,
+		setup__conn_new, teardown__conn_delete),
+	cmocka_unit_test_setup_teardown(
+		completion_get_ex__success,
+		setup__conn_new, teardown__conn_delete),
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_completion_get_ex,
+			NULL, NULL);
+}
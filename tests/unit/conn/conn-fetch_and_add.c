@@ -0,0 +1,188 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * conn-fetch_and_add.c -- the rpma_fetch_and_add() unit tests
+ *
+ * APIs covered:
+ * - rpma_fetch_and_add()
+ */
+
+#include "conn-common.h"
+#include "mocks-ibverbs.h"
+#include "mocks-rdma_cm.h"
+
+/*
+ * fetch_and_add__conn_NULL -- NULL conn is invalid
+ */
+static void
+fetch_and_add__conn_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_fetch_and_add(NULL,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_RPMA_MR_REMOTE, MOCK_OFFSET_ALIGNED,
+			MOCK_ADD, MOCK_FLAGS, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * fetch_and_add__dst_NULL -- NULL dst is invalid
+ */
+static void
+fetch_and_add__dst_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_fetch_and_add(MOCK_CONN,
+			NULL, MOCK_LOCAL_OFFSET,
+			MOCK_RPMA_MR_REMOTE, MOCK_OFFSET_ALIGNED,
+			MOCK_ADD, MOCK_FLAGS, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * fetch_and_add__src_NULL -- NULL src is invalid
+ */
+static void
+fetch_and_add__src_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_fetch_and_add(MOCK_CONN,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			NULL, MOCK_OFFSET_ALIGNED,
+			MOCK_ADD, MOCK_FLAGS, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * fetch_and_add__flags_0 -- flags == 0 is invalid
+ */
+static void
+fetch_and_add__flags_0(void **unused)
+{
+	/* run test */
+	int ret = rpma_fetch_and_add(MOCK_CONN,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_RPMA_MR_REMOTE, MOCK_OFFSET_ALIGNED,
+			MOCK_ADD, 0, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * fetch_and_add__src_offset_unaligned -- the unaligned src_offset is invalid
+ */
+static void
+fetch_and_add__src_offset_unaligned(void **unused)
+{
+	/* run test */
+	int ret = rpma_fetch_and_add(MOCK_CONN,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_RPMA_MR_REMOTE, MOCK_REMOTE_OFFSET,
+			MOCK_ADD, MOCK_FLAGS, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * fetch_and_add__E_PROVIDER -- rpma_mr_atomic() fails with RPMA_E_PROVIDER
+ */
+static void
+fetch_and_add__E_PROVIDER(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	/* configure mocks */
+	expect_value(rpma_mr_atomic, qp, MOCK_QP);
+	expect_value(rpma_mr_atomic, dst, MOCK_RPMA_MR_LOCAL);
+	expect_value(rpma_mr_atomic, dst_offset, MOCK_LOCAL_OFFSET);
+	expect_value(rpma_mr_atomic, src, MOCK_RPMA_MR_REMOTE);
+	expect_value(rpma_mr_atomic, src_offset, MOCK_OFFSET_ALIGNED);
+	expect_value(rpma_mr_atomic, operation, IBV_WR_ATOMIC_FETCH_AND_ADD);
+	expect_value(rpma_mr_atomic, compare_add, MOCK_ADD);
+	expect_value(rpma_mr_atomic, swap, 0);
+	expect_value(rpma_mr_atomic, flags, MOCK_FLAGS);
+	expect_value(rpma_mr_atomic, op_context, MOCK_OP_CONTEXT);
+	will_return(rpma_mr_atomic, RPMA_E_PROVIDER);
+
+	/* run test */
+	int ret = rpma_fetch_and_add(cstate->conn,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_RPMA_MR_REMOTE, MOCK_OFFSET_ALIGNED,
+			MOCK_ADD, MOCK_FLAGS, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+}
+
+/*
+ * fetch_and_add__success -- happy day scenario
+ */
+static void
+fetch_and_add__success(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	/* configure mocks */
+	expect_value(rpma_mr_atomic, qp, MOCK_QP);
+	expect_value(rpma_mr_atomic, dst, MOCK_RPMA_MR_LOCAL);
+	expect_value(rpma_mr_atomic, dst_offset, MOCK_LOCAL_OFFSET);
+	expect_value(rpma_mr_atomic, src, MOCK_RPMA_MR_REMOTE);
+	expect_value(rpma_mr_atomic, src_offset, MOCK_OFFSET_ALIGNED);
+	expect_value(rpma_mr_atomic, operation, IBV_WR_ATOMIC_FETCH_AND_ADD);
+	expect_value(rpma_mr_atomic, compare_add, MOCK_ADD);
+	expect_value(rpma_mr_atomic, swap, 0);
+	expect_value(rpma_mr_atomic, flags, MOCK_FLAGS);
+	expect_value(rpma_mr_atomic, op_context, MOCK_OP_CONTEXT);
+	will_return(rpma_mr_atomic, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_fetch_and_add(cstate->conn,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_RPMA_MR_REMOTE, MOCK_OFFSET_ALIGNED,
+			MOCK_ADD, MOCK_FLAGS, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * group_setup_fetch_and_add -- prepare resources for all tests in the group
+ */
+int
+group_setup_fetch_and_add(void **unused)
+{
+	/* set value of QP in mock of CM ID */
+	Cm_id.qp = MOCK_QP;
+
+	return 0;
+}
+
+static const struct CMUnitTest tests_fetch_and_add[] = {
+	/* rpma_fetch_and_add() unit tests */
+	cmocka_unit_test(fetch_and_add__conn_NULL),
+	cmocka_unit_test(fetch_and_add__dst_NULL),
+	cmocka_unit_test(fetch_and_add__src_NULL),
+	cmocka_unit_test(fetch_and_add__flags_0),
+	cmocka_unit_test(fetch_and_add__src_offset_unaligned),
+	cmocka_unit_test_setup_teardown(fetch_and_add__E_PROVIDER,
+		setup__conn_new, teardown__conn_delete),
+	cmocka_unit_test_setup_teardown(fetch_and_add__success,
+		setup__conn_new, teardown__conn_delete),
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_fetch_and_add,
+			group_setup_fetch_and_add, NULL);
+}
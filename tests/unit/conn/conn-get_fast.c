@@ -0,0 +1,148 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * conn-get_fast.c -- the connection get_fast unit tests
+ *
+ * API covered:
+ * - rpma_conn_get_fast()
+ */
+
+#include "conn-common.h"
+#include "librpma_fast.h"
+#include "mocks-ibverbs.h"
+#include "mocks-rdma_cm.h"
+#include "mocks-rpma-conn_mt.h"
+
+/*
+ * setup__conn_new_mt -- prepare a valid rpma_conn object equipped with
+ * the thread-safe posting object
+ */
+static int
+setup__conn_new_mt(void **cstate_ptr)
+{
+	setup__conn_new(cstate_ptr);
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	struct rpma_conn_mt *mt = MOCK_CONN_MT;
+	rpma_conn_transfer_mt(cstate->conn, &mt);
+	assert_null(mt);
+
+	return 0;
+}
+
+/*
+ * teardown__conn_delete_mt -- delete the rpma_conn object equipped with
+ * the thread-safe posting object
+ */
+static int
+teardown__conn_delete_mt(void **cstate_ptr)
+{
+	expect_value(rpma_conn_mt_delete, mt, MOCK_CONN_MT);
+
+	return teardown__conn_delete(cstate_ptr);
+}
+
+/*
+ * get_fast__conn_NULL -- conn NULL is invalid
+ */
+static void
+get_fast__conn_NULL(void **unused)
+{
+	/* run test */
+	struct rpma_fast_conn fconn = {0};
+	int ret = rpma_conn_get_fast(NULL, &fconn);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+	assert_null(fconn.qp);
+}
+
+/*
+ * get_fast__fconn_NULL -- fconn NULL is invalid
+ */
+static void
+get_fast__fconn_NULL(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	/* run test */
+	int ret = rpma_conn_get_fast(cstate->conn, NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * get_fast__mt -- the thread-safe connection cannot be posted to directly
+ */
+static void
+get_fast__mt(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	/* run test */
+	struct rpma_fast_conn fconn = {0};
+	int ret = rpma_conn_get_fast(cstate->conn, &fconn);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NOSUPP);
+	assert_null(fconn.qp);
+}
+
+/*
+ * get_fast__success -- happy day scenario
+ */
+static void
+get_fast__success(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	/* run test */
+	struct rpma_fast_conn fconn = {0};
+	int ret = rpma_conn_get_fast(cstate->conn, &fconn);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(fconn.qp, MOCK_QP);
+	assert_non_null(fconn.unfenced);
+	assert_int_equal(*fconn.unfenced, 0);
+
+	/* the handle tracks the unfenced domains of the connection */
+	rpma_conn_reads_posted(cstate->conn);
+	assert_int_equal(*fconn.unfenced, UINT32_MAX);
+}
+
+/*
+ * group_setup_get_fast -- prepare resources for all tests in the group
+ */
+static int
+group_setup_get_fast(void **unused)
+{
+	/* configure global mocks */
+	Cm_id.qp = MOCK_QP;
+
+	return 0;
+}
+
+static const struct CMUnitTest tests_get_fast[] = {
+	/* rpma_conn_get_fast() unit tests */
+	cmocka_unit_test(get_fast__conn_NULL),
+	cmocka_unit_test_setup_teardown(
+		get_fast__fconn_NULL,
+		setup__conn_new, teardown__conn_delete),
+	cmocka_unit_test_setup_teardown(
+		get_fast__mt,
+		setup__conn_new_mt, teardown__conn_delete_mt),
+	cmocka_unit_test_setup_teardown(
+		get_fast__success,
+		setup__conn_new, teardown__conn_delete),
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_get_fast,
+			group_setup_get_fast, NULL);
+}
@@ -0,0 +1,87 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * conn-get_max_msg_sz.c -- the connection get_max_msg_sz unit tests
+ *
+ * API covered:
+ * - rpma_conn_get_max_msg_sz()
+ */
+
+#include "conn-common.h"
+#include "mocks-ibverbs.h"
+#include "mocks-rdma_cm.h"
+
+#define MOCK_MAX_MSG_SZ		(uint32_t)0x800000
+
+/*
+ * get_max_msg_sz__query_port_ERRNO -- ibv_query_port() fails with MOCK_ERRNO
+ */
+static void
+get_max_msg_sz__query_port_ERRNO(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	/* configure mocks */
+	will_return(ibv_query_port, MOCK_ERRNO);
+
+	/* run test */
+	uint32_t max_msg_sz = 0;
+	int ret = rpma_conn_get_max_msg_sz(cstate->conn, &max_msg_sz);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_int_equal(max_msg_sz, 0);
+}
+
+/*
+ * get_max_msg_sz__success -- happy day scenario
+ */
+static void
+get_max_msg_sz__success(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	/* configure mocks */
+	will_return(ibv_query_port, MOCK_OK);
+	will_return(ibv_query_port, MOCK_MAX_MSG_SZ);
+
+	/* run test */
+	uint32_t max_msg_sz = 0;
+	int ret = rpma_conn_get_max_msg_sz(cstate->conn, &max_msg_sz);
+
+	/* verify the results */
+	assert_int_equal(ret, 0);
+	assert_int_equal(max_msg_sz, MOCK_MAX_MSG_SZ);
+}
+
+/*
+ * group_setup_get_max_msg_sz -- prepare resources for all tests in the group
+ */
+static int
+group_setup_get_max_msg_sz(void **unused)
+{
+	/* configure global mocks */
+	Cm_id.verbs = MOCK_VERBS;
+	Cm_id.port_num = MOCK_PORT_NUM;
+
+	return 0;
+}
+
+static const struct CMUnitTest tests_get_max_msg_sz[] = {
+	/* rpma_conn_get_max_msg_sz() unit tests */
+	cmocka_unit_test_setup_teardown(
+		get_max_msg_sz__query_port_ERRNO,
+		setup__conn_new, teardown__conn_delete),
+	cmocka_unit_test_setup_teardown(
+		get_max_msg_sz__success,
+		setup__conn_new, teardown__conn_delete),
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_get_max_msg_sz,
+			group_setup_get_max_msg_sz, NULL);
+}
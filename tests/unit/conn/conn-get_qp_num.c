@@ -0,0 +1,94 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * conn-get_qp_num.c -- the connection get_qp_num unit tests
+ *
+ * API covered:
+ * - rpma_conn_get_qp_num()
+ */
+
+#include "conn-common.h"
+#include "mocks-ibverbs.h"
+#include "mocks-rdma_cm.h"
+
+#define MOCK_QP_NUM		(uint32_t)0x0D1C
+
+/*
+ * get_qp_num__conn_NULL -- conn NULL is invalid
+ */
+static void
+get_qp_num__conn_NULL(void **unused)
+{
+	/* run test */
+	uint32_t qp_num = 0;
+	int ret = rpma_conn_get_qp_num(NULL, &qp_num);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+	assert_int_equal(qp_num, 0);
+}
+
+/*
+ * get_qp_num__qp_num_NULL -- qp_num NULL is invalid
+ */
+static void
+get_qp_num__qp_num_NULL(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	/* run test */
+	int ret = rpma_conn_get_qp_num(cstate->conn, NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * get_qp_num__success -- happy day scenario
+ */
+static void
+get_qp_num__success(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	/* run test */
+	uint32_t qp_num = 0;
+	int ret = rpma_conn_get_qp_num(cstate->conn, &qp_num);
+
+	/* verify the results */
+	assert_int_equal(ret, 0);
+	assert_int_equal(qp_num, MOCK_QP_NUM);
+}
+
+/*
+ * group_setup_get_qp_num -- prepare resources for all tests in the group
+ */
+static int
+group_setup_get_qp_num(void **unused)
+{
+	/* configure global mocks */
+	Ibv_qp.qp_num = MOCK_QP_NUM;
+	Cm_id.qp = MOCK_QP;
+
+	return 0;
+}
+
+static const struct CMUnitTest tests_get_qp_num[] = {
+	/* rpma_conn_get_qp_num() unit tests */
+	cmocka_unit_test(get_qp_num__conn_NULL),
+	cmocka_unit_test_setup_teardown(
+		get_qp_num__qp_num_NULL,
+		setup__conn_new, teardown__conn_delete),
+	cmocka_unit_test_setup_teardown(
+		get_qp_num__success,
+		setup__conn_new, teardown__conn_delete),
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_get_qp_num,
+			group_setup_get_qp_num, NULL);
+}
@@ -116,6 +116,22 @@ read__src_NULL_dst_offsets_len_not_NULL(void **unused)
 	assert_int_equal(ret, RPMA_E_INVAL);
 }
 
+/*
+ * read__len_too_big -- len > UINT32_MAX is invalid
+ */
+static void
+read__len_too_big(void **unused)
+{
+	/* run test */
+	int ret = rpma_read(MOCK_CONN, MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+				MOCK_RPMA_MR_REMOTE, MOCK_REMOTE_OFFSET,
+				(size_t)UINT32_MAX + 1, MOCK_FLAGS,
+				MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
 /*
  * read__flags_0 - flags == 0 is invalid
  */
@@ -196,6 +212,7 @@ static const struct CMUnitTest tests_read[] = {
 	cmocka_unit_test(read__src_NULL_src_offset_not_NULL),
 	cmocka_unit_test(read__src_NULL_len_not_NULL),
 	cmocka_unit_test(read__src_NULL_dst_offsets_len_not_NULL),
+	cmocka_unit_test(read__len_too_big),
 	cmocka_unit_test(read__flags_0),
 	cmocka_unit_test(read__conn_dst_NULL_flags_0),
 	cmocka_unit_test_setup_teardown(read__success,
@@ -0,0 +1,164 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * conn-read_in_domain.c -- the rpma_read_in_domain() unit tests
+ *
+ * APIs covered:
+ * - rpma_read_in_domain()
+ */
+
+#include "conn-common.h"
+#include "mocks-ibverbs.h"
+#include "mocks-rdma_cm.h"
+
+#define MOCK_DOMAIN	3
+
+/*
+ * read_in_domain__conn_NULL - NULL conn is invalid
+ */
+static void
+read_in_domain__conn_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_read_in_domain(NULL,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_RPMA_MR_REMOTE, MOCK_REMOTE_OFFSET,
+			MOCK_LEN, MOCK_FLAGS, MOCK_DOMAIN, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * read_in_domain__dst_NULL - NULL dst with non-zero len is invalid
+ */
+static void
+read_in_domain__dst_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_read_in_domain(MOCK_CONN,
+			NULL, MOCK_LOCAL_OFFSET,
+			MOCK_RPMA_MR_REMOTE, MOCK_REMOTE_OFFSET,
+			MOCK_LEN, MOCK_FLAGS, MOCK_DOMAIN, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * read_in_domain__flags_0 - flags == 0 is invalid
+ */
+static void
+read_in_domain__flags_0(void **unused)
+{
+	/* run test */
+	int ret = rpma_read_in_domain(MOCK_CONN,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_RPMA_MR_REMOTE, MOCK_REMOTE_OFFSET,
+			MOCK_LEN, 0, MOCK_DOMAIN, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * read_in_domain__domain_too_big - domain >= RPMA_ORDER_DOMAINS_MAX
+ * is invalid
+ */
+static void
+read_in_domain__domain_too_big(void **unused)
+{
+	/* run test */
+	int ret = rpma_read_in_domain(MOCK_CONN,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_RPMA_MR_REMOTE, MOCK_REMOTE_OFFSET,
+			MOCK_LEN, MOCK_FLAGS, RPMA_ORDER_DOMAINS_MAX,
+			MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * read_in_domain__failed_E_PROVIDER - rpma_mr_read() fails
+ * with RPMA_E_PROVIDER
+ */
+static void
+read_in_domain__failed_E_PROVIDER(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	/* configure mocks */
+	expect_value(rpma_mr_read, qp, MOCK_QP);
+	expect_value(rpma_mr_read, dst, MOCK_RPMA_MR_LOCAL);
+	expect_value(rpma_mr_read, dst_offset, MOCK_LOCAL_OFFSET);
+	expect_value(rpma_mr_read, src, MOCK_RPMA_MR_REMOTE);
+	expect_value(rpma_mr_read, src_offset, MOCK_REMOTE_OFFSET);
+	expect_value(rpma_mr_read, len, MOCK_LEN);
+	expect_value(rpma_mr_read, flags, MOCK_FLAGS);
+	expect_value(rpma_mr_read, op_context, MOCK_OP_CONTEXT);
+	will_return(rpma_mr_read, RPMA_E_PROVIDER);
+
+	/* run test */
+	int ret = rpma_read_in_domain(cstate->conn,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_RPMA_MR_REMOTE, MOCK_REMOTE_OFFSET,
+			MOCK_LEN, MOCK_FLAGS, MOCK_DOMAIN, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+}
+
+/*
+ * read_in_domain__success - happy day scenario
+ */
+static void
+read_in_domain__success(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	/* configure mocks */
+	conn_expect_read();
+
+	/* run test */
+	int ret = rpma_read_in_domain(cstate->conn,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_RPMA_MR_REMOTE, MOCK_REMOTE_OFFSET,
+			MOCK_LEN, MOCK_FLAGS, MOCK_DOMAIN, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * group_setup_read_in_domain -- prepare resources for all tests in the group
+ */
+static int
+group_setup_read_in_domain(void **unused)
+{
+	/* set value of QP in mock of CM ID */
+	Cm_id.qp = MOCK_QP;
+
+	return 0;
+}
+
+static const struct CMUnitTest tests_read_in_domain[] = {
+	/* rpma_read_in_domain() unit tests */
+	cmocka_unit_test(read_in_domain__conn_NULL),
+	cmocka_unit_test(read_in_domain__dst_NULL),
+	cmocka_unit_test(read_in_domain__flags_0),
+	cmocka_unit_test(read_in_domain__domain_too_big),
+	cmocka_unit_test_setup_teardown(read_in_domain__failed_E_PROVIDER,
+		setup__conn_new, teardown__conn_delete),
+	cmocka_unit_test_setup_teardown(read_in_domain__success,
+		setup__conn_new, teardown__conn_delete),
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_read_in_domain,
+			group_setup_read_in_domain, NULL);
+}
@@ -0,0 +1,281 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * conn-stats.c -- the connection statistics unit tests
+ *
+ * APIs covered:
+ * - rpma_conn_get_stats()
+ * - rpma_conn_transfer_stats()
+ * - rpma_read(), rpma_conn_completion_get() and
+ *   rpma_conn_completion_wait() (the statistics collected)
+ * - rpma_conn_get_fast() (the statistics of the latency collected)
+ */
+
+#include "conn-common.h"
+#include "librpma_fast.h"
+#include "mocks-ibverbs.h"
+#include "mocks-rdma_cm.h"
+#include "mocks-rpma-stats.h"
+
+/*
+ * setup__conn_new_stats -- prepare a valid rpma_conn object collecting
+ * the statistics
+ */
+static int
+setup__conn_new_stats(void **cstate_ptr)
+{
+	setup__conn_new(cstate_ptr);
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	struct rpma_conn_stats *stats = MOCK_CONN_STATS;
+	rpma_conn_transfer_stats(cstate->conn, &stats);
+	assert_null(stats);
+
+	return 0;
+}
+
+/*
+ * teardown__conn_delete_stats -- delete the rpma_conn object collecting
+ * the statistics
+ */
+static int
+teardown__conn_delete_stats(void **cstate_ptr)
+{
+	expect_value(rpma_conn_stats_delete, stats, MOCK_CONN_STATS);
+
+	return teardown__conn_delete(cstate_ptr);
+}
+
+/*
+ * get_stats__conn_NULL -- conn NULL is invalid
+ */
+static void
+get_stats__conn_NULL(void **unused)
+{
+	/* run test */
+	struct rpma_stats stats;
+	int ret = rpma_conn_get_stats(NULL, &stats);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * get_stats__stats_NULL -- stats NULL is invalid
+ */
+static void
+get_stats__stats_NULL(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	/* run test */
+	int ret = rpma_conn_get_stats(cstate->conn, NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * get_stats__disabled -- the connection does not collect any statistics
+ */
+static void
+get_stats__disabled(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	/* run test */
+	struct rpma_stats stats;
+	int ret = rpma_conn_get_stats(cstate->conn, &stats);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NOSUPP);
+}
+
+/*
+ * get_stats__success -- happy day scenario
+ */
+static void
+get_stats__success(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+	struct rpma_stats stats;
+
+	/* configure mocks */
+	expect_value(rpma_conn_stats_get, stats, MOCK_CONN_STATS);
+	expect_value(rpma_conn_stats_get, snapshot, &stats);
+
+	/* run test */
+	int ret = rpma_conn_get_stats(cstate->conn, &stats);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * read__stats -- the read is counted
+ */
+static void
+read__stats(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	/* configure mocks */
+	expect_value(rpma_conn_stats_posting, stats, MOCK_CONN_STATS);
+	expect_value(rpma_conn_stats_posting, op, RPMA_OP_READ);
+	conn_expect_read();
+	expect_value(rpma_conn_stats_posted, stats, MOCK_CONN_STATS);
+	expect_value(rpma_conn_stats_posted, op, RPMA_OP_READ);
+	expect_value(rpma_conn_stats_posted, len, MOCK_LEN);
+	expect_value(rpma_conn_stats_posted, ret, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_read(cstate->conn, MOCK_RPMA_MR_LOCAL,
+			MOCK_LOCAL_OFFSET, MOCK_RPMA_MR_REMOTE,
+			MOCK_REMOTE_OFFSET, MOCK_LEN, MOCK_FLAGS,
+			MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * completion_get__stats -- the polling is counted regardless of its result
+ */
+static void
+completion_get__stats(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+	int results[] = {MOCK_OK, RPMA_E_NO_COMPLETION, RPMA_E_PROVIDER};
+
+	for (int i = 0; i < 3; ++i) {
+		/* configure mocks */
+		will_return(rpma_cq_get_completion, results[i]);
+		expect_value(rpma_conn_stats_polled, stats, MOCK_CONN_STATS);
+		expect_value(rpma_conn_stats_polled, ret, results[i]);
+
+		/* run test */
+		struct rpma_completion cmpl;
+		int ret = rpma_conn_completion_get(cstate->conn, &cmpl);
+
+		/* verify the results */
+		assert_int_equal(ret, results[i]);
+	}
+}
+
+/*
+ * completion_wait__stats -- the wait is counted regardless of its result
+ */
+static void
+completion_wait__stats(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+	int results[] = {MOCK_OK, RPMA_E_PROVIDER};
+
+	for (int i = 0; i < 2; ++i) {
+		/* configure mocks */
+		will_return(rpma_cq_wait, results[i]);
+		expect_value(rpma_conn_stats_woken, stats, MOCK_CONN_STATS);
+		expect_value(rpma_conn_stats_woken, ret, results[i]);
+
+		/* run test */
+		int ret = rpma_conn_completion_wait(cstate->conn);
+
+		/* verify the results */
+		assert_int_equal(ret, results[i]);
+	}
+}
+
+/*
+ * get_fast__latency -- the connection collecting the latency cannot be
+ * posted to directly
+ */
+static void
+get_fast__latency(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	/* configure mocks */
+	expect_value(rpma_conn_stats_latency, stats, MOCK_CONN_STATS);
+	will_return(rpma_conn_stats_latency, true);
+
+	/* run test */
+	struct rpma_fast_conn fconn = {0};
+	int ret = rpma_conn_get_fast(cstate->conn, &fconn);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NOSUPP);
+	assert_null(fconn.qp);
+}
+
+/*
+ * get_fast__counters -- the connection collecting only the counters can be
+ * posted to directly
+ */
+static void
+get_fast__counters(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	/* configure mocks */
+	expect_value(rpma_conn_stats_latency, stats, MOCK_CONN_STATS);
+	will_return(rpma_conn_stats_latency, false);
+
+	/* run test */
+	struct rpma_fast_conn fconn = {0};
+	int ret = rpma_conn_get_fast(cstate->conn, &fconn);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(fconn.qp, MOCK_QP);
+}
+
+/*
+ * group_setup_stats -- prepare resources for all tests in the group
+ */
+static int
+group_setup_stats(void **unused)
+{
+	/* configure global mocks */
+	Cm_id.qp = MOCK_QP;
+
+	return 0;
+}
+
+static const struct CMUnitTest tests_stats[] = {
+	/* rpma_conn_get_stats() unit tests */
+	cmocka_unit_test(get_stats__conn_NULL),
+	cmocka_unit_test_setup_teardown(
+		get_stats__stats_NULL,
+		setup__conn_new, teardown__conn_delete),
+	cmocka_unit_test_setup_teardown(
+		get_stats__disabled,
+		setup__conn_new, teardown__conn_delete),
+	cmocka_unit_test_setup_teardown(
+		get_stats__success,
+		setup__conn_new_stats, teardown__conn_delete_stats),
+
+	/* collecting the statistics */
+	cmocka_unit_test_setup_teardown(
+		read__stats,
+		setup__conn_new_stats, teardown__conn_delete_stats),
+	cmocka_unit_test_setup_teardown(
+		completion_get__stats,
+		setup__conn_new_stats, teardown__conn_delete_stats),
+	cmocka_unit_test_setup_teardown(
+		completion_wait__stats,
+		setup__conn_new_stats, teardown__conn_delete_stats),
+	cmocka_unit_test_setup_teardown(
+		get_fast__latency,
+		setup__conn_new_stats, teardown__conn_delete_stats),
+	cmocka_unit_test_setup_teardown(
+		get_fast__counters,
+		setup__conn_new_stats, teardown__conn_delete_stats),
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_stats, group_setup_stats, NULL);
+}
@@ -0,0 +1,447 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * conn-thread.c -- the thread-safe posting mode unit tests
+ *
+ * APIs covered:
+ * - rpma_conn_thread_attach()
+ * - rpma_conn_thread_detach()
+ * - rpma_conn_transfer_mt()
+ * - rpma_conn_get_ibv_qp()
+ * - rpma_conn_completion_get_ex() (not supported in the thread-safe mode)
+ * - rpma_read(), rpma_write(), rpma_send(), rpma_recv(),
+ *   rpma_conn_completion_wait(), rpma_conn_completion_get()
+ *   (dispatching to the thread-safe posting object)
+ */
+
+#include "conn-common.h"
+#include "mocks-ibverbs.h"
+#include "mocks-rdma_cm.h"
+#include "mocks-rpma-conn_mt.h"
+
+/*
+ * setup__conn_new_mt -- prepare a valid rpma_conn object equipped with
+ * the thread-safe posting object
+ */
+static int
+setup__conn_new_mt(void **cstate_ptr)
+{
+	setup__conn_new(cstate_ptr);
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	struct rpma_conn_mt *mt = MOCK_CONN_MT;
+	rpma_conn_transfer_mt(cstate->conn, &mt);
+	assert_null(mt);
+
+	return 0;
+}
+
+/*
+ * teardown__conn_delete_mt -- delete the rpma_conn object equipped with
+ * the thread-safe posting object
+ */
+static int
+teardown__conn_delete_mt(void **cstate_ptr)
+{
+	expect_value(rpma_conn_mt_delete, mt, MOCK_CONN_MT);
+
+	return teardown__conn_delete(cstate_ptr);
+}
+
+/*
+ * thread_attach__conn_NULL -- NULL conn is invalid
+ */
+static void
+thread_attach__conn_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_conn_thread_attach(NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * thread_attach__single -- attaching to a single-threaded connection
+ * is not supported
+ */
+static void
+thread_attach__single(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	/* run test */
+	int ret = rpma_conn_thread_attach(cstate->conn);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NOSUPP);
+}
+
+/*
+ * thread_attach__success -- happy day scenario
+ */
+static void
+thread_attach__success(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	/* configure mocks */
+	expect_value(rpma_conn_mt_thread_attach, mt, MOCK_CONN_MT);
+	will_return(rpma_conn_mt_thread_attach, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_conn_thread_attach(cstate->conn);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * thread_detach__conn_NULL -- NULL conn is invalid
+ */
+static void
+thread_detach__conn_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_conn_thread_detach(NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * thread_detach__single -- detaching from a single-threaded connection
+ * is not supported
+ */
+static void
+thread_detach__single(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	/* run test */
+	int ret = rpma_conn_thread_detach(cstate->conn);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NOSUPP);
+}
+
+/*
+ * thread_detach__pending -- detaching fails when completions of the thread
+ * are not collected yet
+ */
+static void
+thread_detach__pending(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	/* configure mocks */
+	expect_value(rpma_conn_mt_thread_detach, mt, MOCK_CONN_MT);
+	will_return(rpma_conn_mt_thread_detach, RPMA_E_AGAIN);
+
+	/* run test */
+	int ret = rpma_conn_thread_detach(cstate->conn);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_AGAIN);
+}
+
+/*
+ * read__mt -- the read operation is dispatched to the thread-safe object
+ */
+static void
+read__mt(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	/* configure mocks */
+	expect_value(rpma_conn_mt_read, mt, MOCK_CONN_MT);
+	expect_value(rpma_conn_mt_read, op_context, MOCK_OP_CONTEXT);
+	will_return(rpma_conn_mt_read, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_read(cstate->conn,
+				MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+				MOCK_RPMA_MR_REMOTE, MOCK_REMOTE_OFFSET,
+				MOCK_LEN, MOCK_FLAGS, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * write__mt -- the write operation is dispatched to the thread-safe object
+ */
+static void
+write__mt(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	/* configure mocks */
+	expect_value(rpma_conn_mt_write, mt, MOCK_CONN_MT);
+	expect_value(rpma_conn_mt_write, operation, IBV_WR_RDMA_WRITE);
+	expect_value(rpma_conn_mt_write, op_context, MOCK_OP_CONTEXT);
+	expect_value(rpma_conn_mt_write, fence, MOCK_NOFENCE);
+	will_return(rpma_conn_mt_write, RPMA_E_PROVIDER);
+
+	/* run test */
+	int ret = rpma_write(cstate->conn,
+				MOCK_RPMA_MR_REMOTE, MOCK_REMOTE_OFFSET,
+				MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+				MOCK_LEN, MOCK_FLAGS, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+}
+
+/*
+ * write_atomic__mt -- the atomic write operation is always fenced
+ * on the thread-safe connection
+ */
+static void
+write_atomic__mt(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	/* configure mocks */
+	expect_value(rpma_conn_mt_write, mt, MOCK_CONN_MT);
+	expect_value(rpma_conn_mt_write, operation, IBV_WR_RDMA_WRITE);
+	expect_value(rpma_conn_mt_write, op_context, MOCK_OP_CONTEXT);
+	expect_value(rpma_conn_mt_write, fence, MOCK_FENCE);
+	will_return(rpma_conn_mt_write, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_write_atomic_in_domain(cstate->conn,
+				MOCK_RPMA_MR_REMOTE, MOCK_OFFSET_ALIGNED,
+				MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+				MOCK_FLAGS, 0, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * atomic__mt -- the atomic operations are dispatched to the thread-safe object
+ */
+static void
+atomic__mt(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	/* configure mocks */
+	expect_value(rpma_conn_mt_atomic, mt, MOCK_CONN_MT);
+	expect_value(rpma_conn_mt_atomic, operation, IBV_WR_ATOMIC_CMP_AND_SWP);
+	expect_value(rpma_conn_mt_atomic, op_context, MOCK_OP_CONTEXT);
+	will_return(rpma_conn_mt_atomic, MOCK_OK);
+	expect_value(rpma_conn_mt_atomic, mt, MOCK_CONN_MT);
+	expect_value(rpma_conn_mt_atomic, operation,
+			IBV_WR_ATOMIC_FETCH_AND_ADD);
+	expect_value(rpma_conn_mt_atomic, op_context, MOCK_OP_CONTEXT);
+	will_return(rpma_conn_mt_atomic, RPMA_E_AGAIN);
+
+	/* run test */
+	int ret = rpma_compare_and_swap(cstate->conn,
+				MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+				MOCK_RPMA_MR_REMOTE, MOCK_OFFSET_ALIGNED,
+				MOCK_COMPARE, MOCK_SWAP, MOCK_FLAGS,
+				MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+
+	/* run test */
+	ret = rpma_fetch_and_add(cstate->conn,
+				MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+				MOCK_RPMA_MR_REMOTE, MOCK_OFFSET_ALIGNED,
+				MOCK_ADD, MOCK_FLAGS, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_AGAIN);
+}
+
+/*
+ * send__mt -- the send operation is dispatched to the thread-safe object
+ */
+static void
+send__mt(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	/* configure mocks */
+	expect_value(rpma_conn_mt_send, mt, MOCK_CONN_MT);
+	expect_value(rpma_conn_mt_send, operation, IBV_WR_SEND);
+	expect_value(rpma_conn_mt_send, op_context, MOCK_OP_CONTEXT);
+	will_return(rpma_conn_mt_send, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_send(cstate->conn, MOCK_RPMA_MR_LOCAL,
+				MOCK_LOCAL_OFFSET, MOCK_LEN, MOCK_FLAGS,
+				MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * recv__mt -- the receive operation is dispatched to the thread-safe object
+ */
+static void
+recv__mt(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	/* configure mocks */
+	expect_value(rpma_conn_mt_recv, mt, MOCK_CONN_MT);
+	expect_value(rpma_conn_mt_recv, op_context, MOCK_OP_CONTEXT);
+	will_return(rpma_conn_mt_recv, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_recv(cstate->conn, MOCK_RPMA_MR_LOCAL,
+				MOCK_LOCAL_OFFSET, MOCK_LEN, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * completion_wait__mt -- waiting is dispatched to the thread-safe object
+ */
+static void
+completion_wait__mt(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	/* configure mocks */
+	expect_value(rpma_conn_mt_completion_wait, mt, MOCK_CONN_MT);
+	will_return(rpma_conn_mt_completion_wait, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_conn_completion_wait(cstate->conn);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * completion_get__mt -- getting a completion is dispatched to the thread-safe
+ * object
+ */
+static void
+completion_get__mt(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+	struct rpma_completion cmpl;
+
+	/* configure mocks */
+	expect_value(rpma_conn_mt_completion_get, mt, MOCK_CONN_MT);
+	will_return(rpma_conn_mt_completion_get, RPMA_E_NO_COMPLETION);
+
+	/* run test */
+	int ret = rpma_conn_completion_get(cstate->conn, &cmpl);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NO_COMPLETION);
+}
+
+/*
+ * completion_get_ex__mt -- the timestamped completions are not available
+ * in the thread-safe mode
+ */
+static void
+completion_get_ex__mt(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+	struct rpma_completion_ex cmpl_ex;
+
+	/* run test */
+	int ret = rpma_conn_completion_get_ex(cstate->conn, &cmpl_ex);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NOSUPP);
+}
+
+/*
+ * get_ibv_qp__single -- the QP of a single-threaded connection is available
+ * for posting directly
+ */
+static void
+get_ibv_qp__single(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+	Cm_id.qp = MOCK_QP;
+
+	/* run test */
+	struct ibv_qp *qp = NULL;
+	int ret = rpma_conn_get_ibv_qp(cstate->conn, &qp);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(qp, MOCK_QP);
+}
+
+/*
+ * get_ibv_qp__mt -- the QP of a thread-safe connection cannot be used
+ * for posting directly
+ */
+static void
+get_ibv_qp__mt(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	/* run test */
+	struct ibv_qp *qp = NULL;
+	int ret = rpma_conn_get_ibv_qp(cstate->conn, &qp);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NOSUPP);
+	assert_null(qp);
+}
+
+static const struct CMUnitTest tests_thread[] = {
+	/* rpma_conn_thread_attach() unit tests */
+	cmocka_unit_test(thread_attach__conn_NULL),
+	cmocka_unit_test_setup_teardown(thread_attach__single,
+		setup__conn_new, teardown__conn_delete),
+	cmocka_unit_test_setup_teardown(thread_attach__success,
+		setup__conn_new_mt, teardown__conn_delete_mt),
+
+	/* rpma_conn_thread_detach() unit tests */
+	cmocka_unit_test(thread_detach__conn_NULL),
+	cmocka_unit_test_setup_teardown(thread_detach__single,
+		setup__conn_new, teardown__conn_delete),
+	cmocka_unit_test_setup_teardown(thread_detach__pending,
+		setup__conn_new_mt, teardown__conn_delete_mt),
+
+	/* dispatching to the thread-safe posting object */
+	cmocka_unit_test_setup_teardown(read__mt,
+		setup__conn_new_mt, teardown__conn_delete_mt),
+	cmocka_unit_test_setup_teardown(write__mt,
+		setup__conn_new_mt, teardown__conn_delete_mt),
+	cmocka_unit_test_setup_teardown(write_atomic__mt,
+		setup__conn_new_mt, teardown__conn_delete_mt),
+	cmocka_unit_test_setup_teardown(atomic__mt,
+		setup__conn_new_mt, teardown__conn_delete_mt),
+	cmocka_unit_test_setup_teardown(send__mt,
+		setup__conn_new_mt, teardown__conn_delete_mt),
+	cmocka_unit_test_setup_teardown(recv__mt,
+		setup__conn_new_mt, teardown__conn_delete_mt),
+	cmocka_unit_test_setup_teardown(completion_wait__mt,
+		setup__conn_new_mt, teardown__conn_delete_mt),
+	cmocka_unit_test_setup_teardown(completion_get__mt,
+		setup__conn_new_mt, teardown__conn_delete_mt),
+	cmocka_unit_test_setup_teardown(completion_get_ex__mt,
+		setup__conn_new_mt, teardown__conn_delete_mt),
+
+	/* rpma_conn_get_ibv_qp() unit tests */
+	cmocka_unit_test_setup_teardown(get_ibv_qp__single,
+		setup__conn_new, teardown__conn_delete),
+	cmocka_unit_test_setup_teardown(get_ibv_qp__mt,
+		setup__conn_new_mt, teardown__conn_delete_mt),
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_thread, NULL, NULL);
+}
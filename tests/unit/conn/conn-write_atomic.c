@@ -105,6 +105,7 @@ write_atomic__conn_dst_src_NULL_flags_0_dst_offset_unaligned(void **unused)
 
 /*
  * write_atomic__success -- happy day scenario
+ * (no fence since nothing has been read)
  */
 static void
 write_atomic__success(void **cstate_ptr)
@@ -112,18 +113,7 @@ write_atomic__success(void **cstate_ptr)
 	struct conn_test_state *cstate = *cstate_ptr;
 
 	/* configure mocks */
-	expect_value(rpma_mr_write, qp, MOCK_QP);
-	expect_value(rpma_mr_write, dst, MOCK_RPMA_MR_REMOTE);
-	expect_value(rpma_mr_write, dst_offset, MOCK_OFFSET_ALIGNED);
-	expect_value(rpma_mr_write, src, MOCK_RPMA_MR_LOCAL);
-	expect_value(rpma_mr_write, src_offset, MOCK_LOCAL_OFFSET);
-	expect_value(rpma_mr_write, len, RPMA_ATOMIC_WRITE_ALIGNMENT);
-	expect_value(rpma_mr_write, flags, MOCK_FLAGS);
-	expect_value(rpma_mr_write, operation, IBV_WR_RDMA_WRITE);
-	expect_value(rpma_mr_write, imm, 0);
-	expect_value(rpma_mr_write, op_context, MOCK_OP_CONTEXT);
-	expect_value(rpma_mr_write, fence, MOCK_FENCE);
-	will_return(rpma_mr_write, MOCK_OK);
+	conn_expect_write_atomic(MOCK_NOFENCE);
 
 	/* run test */
 	int ret = rpma_write_atomic(cstate->conn,
@@ -135,6 +125,114 @@ write_atomic__success(void **cstate_ptr)
 	assert_int_equal(ret, MOCK_OK);
 }
 
+/*
+ * write_atomic__after_read -- the atomic write following a read is fenced
+ * and the next one is not
+ */
+static void
+write_atomic__after_read(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	/* configure mocks */
+	conn_expect_read();
+	conn_expect_write_atomic(MOCK_FENCE);
+	conn_expect_write_atomic(MOCK_NOFENCE);
+
+	/* run test */
+	int ret = rpma_read(cstate->conn,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_RPMA_MR_REMOTE, MOCK_REMOTE_OFFSET,
+			MOCK_LEN, MOCK_FLAGS, MOCK_OP_CONTEXT);
+	assert_int_equal(ret, MOCK_OK);
+
+	for (int i = 0; i < 2; ++i) {
+		ret = rpma_write_atomic(cstate->conn,
+				MOCK_RPMA_MR_REMOTE, MOCK_OFFSET_ALIGNED,
+				MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+				MOCK_FLAGS, MOCK_OP_CONTEXT);
+
+		/* verify the results */
+		assert_int_equal(ret, MOCK_OK);
+	}
+}
+
+/*
+ * write_atomic__after_failed_read -- a read which failed to be posted
+ * does not require a fence
+ */
+static void
+write_atomic__after_failed_read(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	/* configure mocks */
+	expect_value(rpma_mr_read, qp, MOCK_QP);
+	expect_value(rpma_mr_read, dst, MOCK_RPMA_MR_LOCAL);
+	expect_value(rpma_mr_read, dst_offset, MOCK_LOCAL_OFFSET);
+	expect_value(rpma_mr_read, src, MOCK_RPMA_MR_REMOTE);
+	expect_value(rpma_mr_read, src_offset, MOCK_REMOTE_OFFSET);
+	expect_value(rpma_mr_read, len, MOCK_LEN);
+	expect_value(rpma_mr_read, flags, MOCK_FLAGS);
+	expect_value(rpma_mr_read, op_context, MOCK_OP_CONTEXT);
+	will_return(rpma_mr_read, RPMA_E_PROVIDER);
+	conn_expect_write_atomic(MOCK_NOFENCE);
+
+	/* run test */
+	int ret = rpma_read(cstate->conn,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_RPMA_MR_REMOTE, MOCK_REMOTE_OFFSET,
+			MOCK_LEN, MOCK_FLAGS, MOCK_OP_CONTEXT);
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+
+	ret = rpma_write_atomic(cstate->conn,
+			MOCK_RPMA_MR_REMOTE, MOCK_OFFSET_ALIGNED,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_FLAGS, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * write_atomic__after_fetch_and_add -- the atomic write following
+ * an atomic operation is fenced
+ */
+static void
+write_atomic__after_fetch_and_add(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	/* configure mocks */
+	expect_value(rpma_mr_atomic, qp, MOCK_QP);
+	expect_value(rpma_mr_atomic, dst, MOCK_RPMA_MR_LOCAL);
+	expect_value(rpma_mr_atomic, dst_offset, MOCK_LOCAL_OFFSET);
+	expect_value(rpma_mr_atomic, src, MOCK_RPMA_MR_REMOTE);
+	expect_value(rpma_mr_atomic, src_offset, MOCK_OFFSET_ALIGNED);
+	expect_value(rpma_mr_atomic, operation, IBV_WR_ATOMIC_FETCH_AND_ADD);
+	expect_value(rpma_mr_atomic, compare_add, MOCK_ADD);
+	expect_value(rpma_mr_atomic, swap, 0);
+	expect_value(rpma_mr_atomic, flags, MOCK_FLAGS);
+	expect_value(rpma_mr_atomic, op_context, MOCK_OP_CONTEXT);
+	will_return(rpma_mr_atomic, MOCK_OK);
+	conn_expect_write_atomic(MOCK_FENCE);
+
+	/* run test */
+	int ret = rpma_fetch_and_add(cstate->conn,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_RPMA_MR_REMOTE, MOCK_OFFSET_ALIGNED,
+			MOCK_ADD, MOCK_FLAGS, MOCK_OP_CONTEXT);
+	assert_int_equal(ret, MOCK_OK);
+
+	ret = rpma_write_atomic(cstate->conn,
+			MOCK_RPMA_MR_REMOTE, MOCK_OFFSET_ALIGNED,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_FLAGS, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
 /*
  * group_setup_write_atomic -- prepare resources for all tests in the group
  */
@@ -158,6 +256,12 @@ static const struct CMUnitTest tests_write_atomic[] = {
 		write_atomic__conn_dst_src_NULL_flags_0_dst_offset_unaligned),
 	cmocka_unit_test_setup_teardown(write_atomic__success,
 		setup__conn_new, teardown__conn_delete),
+	cmocka_unit_test_setup_teardown(write_atomic__after_read,
+		setup__conn_new, teardown__conn_delete),
+	cmocka_unit_test_setup_teardown(write_atomic__after_failed_read,
+		setup__conn_new, teardown__conn_delete),
+	cmocka_unit_test_setup_teardown(write_atomic__after_fetch_and_add,
+		setup__conn_new, teardown__conn_delete),
 	cmocka_unit_test(NULL)
 };
 
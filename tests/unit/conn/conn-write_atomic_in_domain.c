@@ -0,0 +1,351 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * conn-write_atomic_in_domain.c -- the rpma_write_atomic_in_domain()
+ * unit tests
+ *
+ * APIs covered:
+ * - rpma_write_atomic_in_domain()
+ * - rpma_conn_reads_posted()
+ */
+
+#include "conn-common.h"
+#include "mocks-ibverbs.h"
+#include "mocks-rdma_cm.h"
+#include "mocks-rpma-flush.h"
+
+#define MOCK_DOMAIN		3
+#define MOCK_DOMAIN_OTHER	7
+
+/*
+ * write_atomic_in_domain__conn_NULL -- NULL conn is invalid
+ */
+static void
+write_atomic_in_domain__conn_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_write_atomic_in_domain(NULL,
+			MOCK_RPMA_MR_REMOTE, MOCK_OFFSET_ALIGNED,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_FLAGS, MOCK_DOMAIN, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * write_atomic_in_domain__dst_NULL -- NULL dst is invalid
+ */
+static void
+write_atomic_in_domain__dst_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_write_atomic_in_domain(MOCK_CONN,
+			NULL, MOCK_OFFSET_ALIGNED,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_FLAGS, MOCK_DOMAIN, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * write_atomic_in_domain__src_NULL -- NULL src is invalid
+ */
+static void
+write_atomic_in_domain__src_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_write_atomic_in_domain(MOCK_CONN,
+			MOCK_RPMA_MR_REMOTE, MOCK_OFFSET_ALIGNED,
+			NULL, MOCK_LOCAL_OFFSET,
+			MOCK_FLAGS, MOCK_DOMAIN, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * write_atomic_in_domain__flags_0 -- flags == 0 is invalid
+ */
+static void
+write_atomic_in_domain__flags_0(void **unused)
+{
+	/* run test */
+	int ret = rpma_write_atomic_in_domain(MOCK_CONN,
+			MOCK_RPMA_MR_REMOTE, MOCK_OFFSET_ALIGNED,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			0, MOCK_DOMAIN, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * write_atomic_in_domain__dst_offset_unaligned -- the unaligned dst_offset
+ * is invalid
+ */
+static void
+write_atomic_in_domain__dst_offset_unaligned(void **unused)
+{
+	/* run test */
+	int ret = rpma_write_atomic_in_domain(MOCK_CONN,
+			MOCK_RPMA_MR_REMOTE, MOCK_REMOTE_OFFSET,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_FLAGS, MOCK_DOMAIN, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * write_atomic_in_domain__domain_too_big -- domain >= RPMA_ORDER_DOMAINS_MAX
+ * is invalid
+ */
+static void
+write_atomic_in_domain__domain_too_big(void **unused)
+{
+	/* run test */
+	int ret = rpma_write_atomic_in_domain(MOCK_CONN,
+			MOCK_RPMA_MR_REMOTE, MOCK_OFFSET_ALIGNED,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_FLAGS, RPMA_ORDER_DOMAINS_MAX, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * write_atomic_in_domain__success -- happy day scenario
+ * (no fence since nothing has been read)
+ */
+static void
+write_atomic_in_domain__success(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	/* configure mocks */
+	conn_expect_write_atomic(MOCK_NOFENCE);
+
+	/* run test */
+	int ret = rpma_write_atomic_in_domain(cstate->conn,
+			MOCK_RPMA_MR_REMOTE, MOCK_OFFSET_ALIGNED,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_FLAGS, MOCK_DOMAIN, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * write_atomic_in_domain__read_other_domain -- a read posted to another
+ * ordering domain does not require a fence
+ */
+static void
+write_atomic_in_domain__read_other_domain(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	/* configure mocks */
+	conn_expect_read();
+	conn_expect_write_atomic(MOCK_NOFENCE);
+
+	/* run test */
+	int ret = rpma_read_in_domain(cstate->conn,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_RPMA_MR_REMOTE, MOCK_REMOTE_OFFSET,
+			MOCK_LEN, MOCK_FLAGS, MOCK_DOMAIN_OTHER,
+			MOCK_OP_CONTEXT);
+	assert_int_equal(ret, MOCK_OK);
+
+	ret = rpma_write_atomic_in_domain(cstate->conn,
+			MOCK_RPMA_MR_REMOTE, MOCK_OFFSET_ALIGNED,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_FLAGS, MOCK_DOMAIN, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * write_atomic_in_domain__read_same_domain -- a read posted to the same
+ * ordering domain requires a fence which settles all the domains
+ */
+static void
+write_atomic_in_domain__read_same_domain(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	/* configure mocks */
+	conn_expect_read();
+	conn_expect_read();
+	conn_expect_write_atomic(MOCK_FENCE);
+	conn_expect_write_atomic(MOCK_NOFENCE);
+
+	/* run test */
+	int ret = rpma_read_in_domain(cstate->conn,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_RPMA_MR_REMOTE, MOCK_REMOTE_OFFSET,
+			MOCK_LEN, MOCK_FLAGS, MOCK_DOMAIN, MOCK_OP_CONTEXT);
+	assert_int_equal(ret, MOCK_OK);
+
+	ret = rpma_read_in_domain(cstate->conn,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_RPMA_MR_REMOTE, MOCK_REMOTE_OFFSET,
+			MOCK_LEN, MOCK_FLAGS, MOCK_DOMAIN_OTHER,
+			MOCK_OP_CONTEXT);
+	assert_int_equal(ret, MOCK_OK);
+
+	ret = rpma_write_atomic_in_domain(cstate->conn,
+			MOCK_RPMA_MR_REMOTE, MOCK_OFFSET_ALIGNED,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_FLAGS, MOCK_DOMAIN, MOCK_OP_CONTEXT);
+	assert_int_equal(ret, MOCK_OK);
+
+	/* the read of the other domain has been settled by the fence */
+	ret = rpma_write_atomic_in_domain(cstate->conn,
+			MOCK_RPMA_MR_REMOTE, MOCK_OFFSET_ALIGNED,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_FLAGS, MOCK_DOMAIN_OTHER, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * write_atomic_in_domain__read_no_domain -- a read posted without
+ * an ordering domain requires a fence in every domain
+ */
+static void
+write_atomic_in_domain__read_no_domain(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	/* configure mocks */
+	conn_expect_read();
+	conn_expect_write_atomic(MOCK_FENCE);
+
+	/* run test */
+	int ret = rpma_read(cstate->conn,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_RPMA_MR_REMOTE, MOCK_REMOTE_OFFSET,
+			MOCK_LEN, MOCK_FLAGS, MOCK_OP_CONTEXT);
+	assert_int_equal(ret, MOCK_OK);
+
+	ret = rpma_write_atomic_in_domain(cstate->conn,
+			MOCK_RPMA_MR_REMOTE, MOCK_OFFSET_ALIGNED,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_FLAGS, MOCK_DOMAIN, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * write_atomic_in_domain__reads_posted -- the reads posted directly to
+ * the QP require a fence in every domain
+ */
+static void
+write_atomic_in_domain__reads_posted(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	/* configure mocks */
+	conn_expect_write_atomic(MOCK_FENCE);
+
+	/* run test */
+	rpma_conn_reads_posted(cstate->conn);
+
+	int ret = rpma_write_atomic_in_domain(cstate->conn,
+			MOCK_RPMA_MR_REMOTE, MOCK_OFFSET_ALIGNED,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_FLAGS, MOCK_DOMAIN, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * write_atomic_in_domain__flush -- a flush requires a fence in every domain
+ */
+static void
+write_atomic_in_domain__flush(void **cstate_ptr)
+{
+	struct conn_test_state *cstate = *cstate_ptr;
+
+	/* configure mocks */
+	expect_value(rpma_mr_remote_get_flush_type, mr, MOCK_RPMA_MR_REMOTE);
+	will_return(rpma_mr_remote_get_flush_type,
+			RPMA_MR_USAGE_FLUSH_TYPE_VISIBILITY);
+	expect_value(rpma_flush_mock_do, qp, MOCK_QP);
+	expect_value(rpma_flush_mock_do, flush, MOCK_FLUSH);
+	expect_value(rpma_flush_mock_do, dst, MOCK_RPMA_MR_REMOTE);
+	expect_value(rpma_flush_mock_do, dst_offset, MOCK_REMOTE_OFFSET);
+	expect_value(rpma_flush_mock_do, len, MOCK_LEN);
+	expect_value(rpma_flush_mock_do, flags, MOCK_FLAGS);
+	expect_value(rpma_flush_mock_do, op_context, MOCK_OP_CONTEXT);
+	conn_expect_write_atomic(MOCK_FENCE);
+
+	/* run test */
+	int ret = rpma_flush(cstate->conn, MOCK_RPMA_MR_REMOTE,
+			MOCK_REMOTE_OFFSET, MOCK_LEN,
+			RPMA_FLUSH_TYPE_VISIBILITY,
+			MOCK_FLAGS, MOCK_OP_CONTEXT);
+	assert_int_equal(ret, MOCK_OK);
+
+	ret = rpma_write_atomic_in_domain(cstate->conn,
+			MOCK_RPMA_MR_REMOTE, MOCK_OFFSET_ALIGNED,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_FLAGS, MOCK_DOMAIN, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * group_setup_write_atomic_in_domain -- prepare resources for all tests
+ * in the group
+ */
+static int
+group_setup_write_atomic_in_domain(void **unused)
+{
+	/* set value of QP in mock of CM ID */
+	Cm_id.qp = MOCK_QP;
+
+	return 0;
+}
+
+static const struct CMUnitTest tests_write_atomic_in_domain[] = {
+	/* rpma_write_atomic_in_domain() unit tests */
+	cmocka_unit_test(write_atomic_in_domain__conn_NULL),
+	cmocka_unit_test(write_atomic_in_domain__dst_NULL),
+	cmocka_unit_test(write_atomic_in_domain__src_NULL),
+	cmocka_unit_test(write_atomic_in_domain__flags_0),
+	cmocka_unit_test(write_atomic_in_domain__dst_offset_unaligned),
+	cmocka_unit_test(write_atomic_in_domain__domain_too_big),
+	cmocka_unit_test_setup_teardown(write_atomic_in_domain__success,
+		setup__conn_new, teardown__conn_delete),
+	cmocka_unit_test_setup_teardown(
+		write_atomic_in_domain__read_other_domain,
+		setup__conn_new, teardown__conn_delete),
+	cmocka_unit_test_setup_teardown(
+		write_atomic_in_domain__read_same_domain,
+		setup__conn_new, teardown__conn_delete),
+	cmocka_unit_test_setup_teardown(
+		write_atomic_in_domain__read_no_domain,
+		setup__conn_new, teardown__conn_delete),
+	cmocka_unit_test_setup_teardown(
+		write_atomic_in_domain__reads_posted,
+		setup__conn_new, teardown__conn_delete),
+	cmocka_unit_test_setup_teardown(write_atomic_in_domain__flush,
+		setup__conn_new, teardown__conn_delete),
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_write_atomic_in_domain,
+			group_setup_write_atomic_in_domain, NULL);
+}
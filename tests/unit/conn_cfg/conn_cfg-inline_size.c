@@ -0,0 +1,119 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * conn_cfg-inline_size.c -- the rpma_conn_cfg_set/get_inline_size() unit tests
+ *
+ * APIs covered:
+ * - rpma_conn_cfg_set_inline_size()
+ * - rpma_conn_cfg_get_inline_size()
+ */
+
+#include "conn_cfg-common.h"
+#include "test-common.h"
+
+#define MOCK_INLINE_SIZE_CUSTOM	64
+
+/*
+ * set__cfg_NULL -- NULL cfg is invalid
+ */
+static void
+set__cfg_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_conn_cfg_set_inline_size(NULL, MOCK_INLINE_SIZE_CUSTOM);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * get__cfg_NULL -- NULL cfg is invalid
+ */
+static void
+get__cfg_NULL(void **unused)
+{
+	/* run test */
+	uint32_t inline_size;
+	int ret = rpma_conn_cfg_get_inline_size(NULL, &inline_size);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * get__inline_size_NULL -- NULL inline_size is invalid
+ */
+static void
+get__inline_size_NULL(void **cstate_ptr)
+{
+	struct conn_cfg_test_state *cstate = *cstate_ptr;
+
+	/* run test */
+	int ret = rpma_conn_cfg_get_inline_size(cstate->cfg, NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * get__default -- no inline data is the default
+ */
+static void
+get__default(void **cstate_ptr)
+{
+	struct conn_cfg_test_state *cstate = *cstate_ptr;
+
+	/* run test */
+	uint32_t inline_size;
+	int ret = rpma_conn_cfg_get_inline_size(cstate->cfg, &inline_size);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(inline_size, 0);
+}
+
+/*
+ * inline_size__lifecycle -- happy day scenario
+ */
+static void
+inline_size__lifecycle(void **cstate_ptr)
+{
+	struct conn_cfg_test_state *cstate = *cstate_ptr;
+	uint32_t values[] = {MOCK_INLINE_SIZE_CUSTOM, UINT32_MAX, 0};
+
+	for (int i = 0; i < 3; ++i) {
+		/* run test */
+		int ret = rpma_conn_cfg_set_inline_size(cstate->cfg,
+				values[i]);
+
+		/* verify the results */
+		assert_int_equal(ret, MOCK_OK);
+		uint32_t inline_size;
+		ret = rpma_conn_cfg_get_inline_size(cstate->cfg, &inline_size);
+		assert_int_equal(ret, MOCK_OK);
+		assert_int_equal(inline_size, values[i]);
+	}
+}
+
+static const struct CMUnitTest test_inline_size[] = {
+	/* rpma_conn_cfg_set_inline_size() unit tests */
+	cmocka_unit_test(set__cfg_NULL),
+
+	/* rpma_conn_cfg_get_inline_size() unit tests */
+	cmocka_unit_test(get__cfg_NULL),
+	cmocka_unit_test_setup_teardown(get__inline_size_NULL,
+		setup__conn_cfg, teardown__conn_cfg),
+	cmocka_unit_test_setup_teardown(get__default,
+		setup__conn_cfg, teardown__conn_cfg),
+
+	/* rpma_conn_cfg_set/get_inline_size() lifecycle */
+	cmocka_unit_test_setup_teardown(inline_size__lifecycle,
+		setup__conn_cfg, teardown__conn_cfg),
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(test_inline_size, NULL, NULL);
+}
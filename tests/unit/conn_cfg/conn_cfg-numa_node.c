@@ -0,0 +1,136 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * conn_cfg-numa_node.c -- the rpma_conn_cfg_set/get_numa_node() unit tests
+ *
+ * APIs covered:
+ * - rpma_conn_cfg_set_numa_node()
+ * - rpma_conn_cfg_get_numa_node()
+ */
+
+#include "conn_cfg-common.h"
+#include "test-common.h"
+
+#define MOCK_NUMA_NODE_CUSTOM	1
+
+/*
+ * set__cfg_NULL -- NULL cfg is invalid
+ */
+static void
+set__cfg_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_conn_cfg_set_numa_node(NULL, MOCK_NUMA_NODE_CUSTOM);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * set__node_invalid -- a negative value other than RPMA_NUMA_NODE_ANY
+ * is invalid
+ */
+static void
+set__node_invalid(void **cstate_ptr)
+{
+	struct conn_cfg_test_state *cstate = *cstate_ptr;
+
+	/* run test */
+	int ret = rpma_conn_cfg_set_numa_node(cstate->cfg, -2);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * get__cfg_NULL -- NULL cfg is invalid
+ */
+static void
+get__cfg_NULL(void **unused)
+{
+	/* run test */
+	int node;
+	int ret = rpma_conn_cfg_get_numa_node(NULL, &node);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * get__node_NULL -- NULL node is invalid
+ */
+static void
+get__node_NULL(void **cstate_ptr)
+{
+	struct conn_cfg_test_state *cstate = *cstate_ptr;
+
+	/* run test */
+	int ret = rpma_conn_cfg_get_numa_node(cstate->cfg, NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * get__default -- RPMA_NUMA_NODE_ANY is the default value
+ */
+static void
+get__default(void **cstate_ptr)
+{
+	struct conn_cfg_test_state *cstate = *cstate_ptr;
+
+	/* run test */
+	int node;
+	int ret = rpma_conn_cfg_get_numa_node(cstate->cfg, &node);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(node, RPMA_NUMA_NODE_ANY);
+}
+
+/*
+ * numa_node__lifecycle -- happy day scenario
+ */
+static void
+numa_node__lifecycle(void **cstate_ptr)
+{
+	struct conn_cfg_test_state *cstate = *cstate_ptr;
+	int values[] = {MOCK_NUMA_NODE_CUSTOM, RPMA_NUMA_NODE_ANY, 0};
+
+	for (int i = 0; i < 3; ++i) {
+		/* run test */
+		int ret = rpma_conn_cfg_set_numa_node(cstate->cfg, values[i]);
+
+		/* verify the results */
+		assert_int_equal(ret, MOCK_OK);
+		int node;
+		ret = rpma_conn_cfg_get_numa_node(cstate->cfg, &node);
+		assert_int_equal(ret, MOCK_OK);
+		assert_int_equal(node, values[i]);
+	}
+}
+
+static const struct CMUnitTest test_numa_node[] = {
+	/* rpma_conn_cfg_set_numa_node() unit tests */
+	cmocka_unit_test(set__cfg_NULL),
+	cmocka_unit_test_setup_teardown(set__node_invalid,
+		setup__conn_cfg, teardown__conn_cfg),
+
+	/* rpma_conn_cfg_get_numa_node() unit tests */
+	cmocka_unit_test(get__cfg_NULL),
+	cmocka_unit_test_setup_teardown(get__node_NULL,
+		setup__conn_cfg, teardown__conn_cfg),
+	cmocka_unit_test_setup_teardown(get__default,
+		setup__conn_cfg, teardown__conn_cfg),
+
+	/* rpma_conn_cfg_set/get_numa_node() lifecycle */
+	cmocka_unit_test_setup_teardown(numa_node__lifecycle,
+		setup__conn_cfg, teardown__conn_cfg),
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(test_numa_node, NULL, NULL);
+}
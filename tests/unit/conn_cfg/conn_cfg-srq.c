@@ -0,0 +1,119 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * conn_cfg-srq.c -- the rpma_conn_cfg_set/get_srq() unit tests
+ *
+ * APIs covered:
+ * - rpma_conn_cfg_set_srq()
+ * - rpma_conn_cfg_get_srq()
+ */
+
+#include "conn_cfg-common.h"
+#include "test-common.h"
+
+#define MOCK_SRQ		(struct rpma_srq *)0x5A9C
+
+/*
+ * set__cfg_NULL -- NULL cfg is invalid
+ */
+static void
+set__cfg_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_conn_cfg_set_srq(NULL, MOCK_SRQ);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * get__cfg_NULL -- NULL cfg is invalid
+ */
+static void
+get__cfg_NULL(void **unused)
+{
+	/* run test */
+	struct rpma_srq *srq = NULL;
+	int ret = rpma_conn_cfg_get_srq(NULL, &srq);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+	assert_null(srq);
+}
+
+/*
+ * get__srq_ptr_NULL -- NULL srq_ptr is invalid
+ */
+static void
+get__srq_ptr_NULL(void **cstate_ptr)
+{
+	struct conn_cfg_test_state *cstate = *cstate_ptr;
+
+	/* run test */
+	int ret = rpma_conn_cfg_get_srq(cstate->cfg, NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * get__default -- no SRQ is the default value
+ */
+static void
+get__default(void **cstate_ptr)
+{
+	struct conn_cfg_test_state *cstate = *cstate_ptr;
+
+	/* run test */
+	struct rpma_srq *srq = MOCK_SRQ;
+	int ret = rpma_conn_cfg_get_srq(cstate->cfg, &srq);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_null(srq);
+}
+
+/*
+ * srq__lifecycle -- happy day scenario
+ */
+static void
+srq__lifecycle(void **cstate_ptr)
+{
+	struct conn_cfg_test_state *cstate = *cstate_ptr;
+	struct rpma_srq *values[] = {MOCK_SRQ, NULL};
+
+	for (int i = 0; i < 2; ++i) {
+		/* run test */
+		int ret = rpma_conn_cfg_set_srq(cstate->cfg, values[i]);
+
+		/* verify the results */
+		assert_int_equal(ret, MOCK_OK);
+		struct rpma_srq *srq;
+		ret = rpma_conn_cfg_get_srq(cstate->cfg, &srq);
+		assert_int_equal(ret, MOCK_OK);
+		assert_ptr_equal(srq, values[i]);
+	}
+}
+
+static const struct CMUnitTest test_srq[] = {
+	/* rpma_conn_cfg_set_srq() unit tests */
+	cmocka_unit_test(set__cfg_NULL),
+
+	/* rpma_conn_cfg_get_srq() unit tests */
+	cmocka_unit_test(get__cfg_NULL),
+	cmocka_unit_test_setup_teardown(get__srq_ptr_NULL,
+		setup__conn_cfg, teardown__conn_cfg),
+	cmocka_unit_test_setup_teardown(get__default,
+		setup__conn_cfg, teardown__conn_cfg),
+
+	/* rpma_conn_cfg_set/get_srq() lifecycle */
+	cmocka_unit_test_setup_teardown(srq__lifecycle,
+		setup__conn_cfg, teardown__conn_cfg),
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(test_srq, NULL, NULL);
+}
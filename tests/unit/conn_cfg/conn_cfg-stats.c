@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * conn_cfg-stats.c -- the rpma_conn_cfg_set/get_stats() unit tests
+ *
+ * APIs covered:
+ * - rpma_conn_cfg_set_stats()
+ * - rpma_conn_cfg_get_stats()
+ */
+
+#include "conn_cfg-common.h"
+#include "test-common.h"
+
+/*
+ * set__cfg_NULL -- NULL cfg is invalid
+ */
+static void
+set__cfg_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_conn_cfg_set_stats(NULL, RPMA_STATS_COUNTERS);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * set__stats_invalid -- an unknown bit of stats is invalid
+ */
+static void
+set__stats_invalid(void **cstate_ptr)
+{
+	struct conn_cfg_test_state *cstate = *cstate_ptr;
+
+	/* run test */
+	int ret = rpma_conn_cfg_set_stats(cstate->cfg,
+			RPMA_STATS_COUNTERS | (1 << 2));
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * get__cfg_NULL -- NULL cfg is invalid
+ */
+static void
+get__cfg_NULL(void **unused)
+{
+	/* run test */
+	int stats;
+	int ret = rpma_conn_cfg_get_stats(NULL, &stats);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * get__stats_NULL -- NULL stats is invalid
+ */
+static void
+get__stats_NULL(void **cstate_ptr)
+{
+	struct conn_cfg_test_state *cstate = *cstate_ptr;
+
+	/* run test */
+	int ret = rpma_conn_cfg_get_stats(cstate->cfg, NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * get__default -- no statistics are collected by default
+ */
+static void
+get__default(void **cstate_ptr)
+{
+	struct conn_cfg_test_state *cstate = *cstate_ptr;
+
+	/* run test */
+	int stats = -1;
+	int ret = rpma_conn_cfg_get_stats(cstate->cfg, &stats);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(stats, 0);
+}
+
+/*
+ * stats__lifecycle -- happy day scenario
+ */
+static void
+stats__lifecycle(void **cstate_ptr)
+{
+	struct conn_cfg_test_state *cstate = *cstate_ptr;
+	int values[] = {RPMA_STATS_COUNTERS,
+			RPMA_STATS_COUNTERS | RPMA_STATS_LATENCY, 0};
+
+	for (int i = 0; i < 3; ++i) {
+		/* run test */
+		int ret = rpma_conn_cfg_set_stats(cstate->cfg, values[i]);
+
+		/* verify the results */
+		assert_int_equal(ret, MOCK_OK);
+		int stats;
+		ret = rpma_conn_cfg_get_stats(cstate->cfg, &stats);
+		assert_int_equal(ret, MOCK_OK);
+		assert_int_equal(stats, values[i]);
+	}
+}
+
+static const struct CMUnitTest test_stats[] = {
+	/* rpma_conn_cfg_set_stats() unit tests */
+	cmocka_unit_test(set__cfg_NULL),
+	cmocka_unit_test_setup_teardown(set__stats_invalid,
+		setup__conn_cfg, teardown__conn_cfg),
+
+	/* rpma_conn_cfg_get_stats() unit tests */
+	cmocka_unit_test(get__cfg_NULL),
+	cmocka_unit_test_setup_teardown(get__stats_NULL,
+		setup__conn_cfg, teardown__conn_cfg),
+	cmocka_unit_test_setup_teardown(get__default,
+		setup__conn_cfg, teardown__conn_cfg),
+
+	/* rpma_conn_cfg_set/get_stats() lifecycle */
+	cmocka_unit_test_setup_teardown(stats__lifecycle,
+		setup__conn_cfg, teardown__conn_cfg),
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(test_stats, NULL, NULL);
+}
@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * conn_cfg-thread_mode.c -- the rpma_conn_cfg_set/get_thread_mode() unit tests
+ *
+ * APIs covered:
+ * - rpma_conn_cfg_set_thread_mode()
+ * - rpma_conn_cfg_get_thread_mode()
+ */
+
+#include "conn_cfg-common.h"
+#include "test-common.h"
+
+/*
+ * set__cfg_NULL -- NULL cfg is invalid
+ */
+static void
+set__cfg_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_conn_cfg_set_thread_mode(NULL, RPMA_CONN_THREAD_SAFE);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * set__mode_invalid -- an unknown mode is invalid
+ */
+static void
+set__mode_invalid(void **cstate_ptr)
+{
+	struct conn_cfg_test_state *cstate = *cstate_ptr;
+
+	/* run test */
+	enum rpma_conn_thread_mode mode =
+		(enum rpma_conn_thread_mode)(RPMA_CONN_THREAD_LOCKLESS + 1);
+	int ret = rpma_conn_cfg_set_thread_mode(cstate->cfg, mode);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * get__cfg_NULL -- NULL cfg is invalid
+ */
+static void
+get__cfg_NULL(void **unused)
+{
+	/* run test */
+	enum rpma_conn_thread_mode mode;
+	int ret = rpma_conn_cfg_get_thread_mode(NULL, &mode);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * get__mode_NULL -- NULL mode is invalid
+ */
+static void
+get__mode_NULL(void **cstate_ptr)
+{
+	struct conn_cfg_test_state *cstate = *cstate_ptr;
+
+	/* run test */
+	int ret = rpma_conn_cfg_get_thread_mode(cstate->cfg, NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * get__default -- the single-threaded mode is the default one
+ */
+static void
+get__default(void **cstate_ptr)
+{
+	struct conn_cfg_test_state *cstate = *cstate_ptr;
+
+	/* run test */
+	enum rpma_conn_thread_mode mode;
+	int ret = rpma_conn_cfg_get_thread_mode(cstate->cfg, &mode);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(mode, RPMA_CONN_THREAD_SINGLE);
+}
+
+/*
+ * thread_mode__lifecycle -- happy day scenario
+ */
+static void
+thread_mode__lifecycle(void **cstate_ptr)
+{
+	struct conn_cfg_test_state *cstate = *cstate_ptr;
+	enum rpma_conn_thread_mode modes[] = {
+		RPMA_CONN_THREAD_SAFE,
+		RPMA_CONN_THREAD_LOCKLESS,
+		RPMA_CONN_THREAD_SINGLE
+	};
+
+	for (int i = 0; i < 3; ++i) {
+		/* run test */
+		int ret = rpma_conn_cfg_set_thread_mode(cstate->cfg, modes[i]);
+
+		/* verify the results */
+		assert_int_equal(ret, MOCK_OK);
+		enum rpma_conn_thread_mode mode;
+		ret = rpma_conn_cfg_get_thread_mode(cstate->cfg, &mode);
+		assert_int_equal(ret, MOCK_OK);
+		assert_int_equal(mode, modes[i]);
+	}
+}
+
+static const struct CMUnitTest test_thread_mode[] = {
+	/* rpma_conn_cfg_set_thread_mode() unit tests */
+	cmocka_unit_test(set__cfg_NULL),
+	cmocka_unit_test_setup_teardown(set__mode_invalid,
+		setup__conn_cfg, teardown__conn_cfg),
+
+	/* rpma_conn_cfg_get_thread_mode() unit tests */
+	cmocka_unit_test(get__cfg_NULL),
+	cmocka_unit_test_setup_teardown(get__mode_NULL,
+		setup__conn_cfg, teardown__conn_cfg),
+	cmocka_unit_test_setup_teardown(get__default,
+		setup__conn_cfg, teardown__conn_cfg),
+
+	/* rpma_conn_cfg_set/get_thread_mode() lifecycle */
+	cmocka_unit_test_setup_teardown(thread_mode__lifecycle,
+		setup__conn_cfg, teardown__conn_cfg),
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(test_thread_mode, NULL, NULL);
+}
@@ -0,0 +1,116 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * conn_cfg-timestamps.c -- the rpma_conn_cfg_set/get_timestamps() unit tests
+ *
+ * APIs covered:
+ * - rpma_conn_cfg_set_timestamps()
+ * - rpma_conn_cfg_get_timestamps()
+ */
+
+#include "conn_cfg-common.h"
+#include "test-common.h"
+
+/*
+ * set__cfg_NULL -- NULL cfg is invalid
+ */
+static void
+set__cfg_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_conn_cfg_set_timestamps(NULL, true);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * get__cfg_NULL -- NULL cfg is invalid
+ */
+static void
+get__cfg_NULL(void **unused)
+{
+	/* run test */
+	bool timestamps;
+	int ret = rpma_conn_cfg_get_timestamps(NULL, &timestamps);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * get__timestamps_NULL -- NULL timestamps is invalid
+ */
+static void
+get__timestamps_NULL(void **cstate_ptr)
+{
+	struct conn_cfg_test_state *cstate = *cstate_ptr;
+
+	/* run test */
+	int ret = rpma_conn_cfg_get_timestamps(cstate->cfg, NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * get__default -- the completions are not timestamped by default
+ */
+static void
+get__default(void **cstate_ptr)
+{
+	struct conn_cfg_test_state *cstate = *cstate_ptr;
+
+	/* run test */
+	bool timestamps = true;
+	int ret = rpma_conn_cfg_get_timestamps(cstate->cfg, &timestamps);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_false(timestamps);
+}
+
+/*
+ * timestamps__lifecycle -- happy day scenario
+ */
+static void
+timestamps__lifecycle(void **cstate_ptr)
+{
+	struct conn_cfg_test_state *cstate = *cstate_ptr;
+	bool values[] = {true, false};
+
+	for (int i = 0; i < 2; ++i) {
+		/* run test */
+		int ret = rpma_conn_cfg_set_timestamps(cstate->cfg, values[i]);
+
+		/* verify the results */
+		assert_int_equal(ret, MOCK_OK);
+		bool timestamps;
+		ret = rpma_conn_cfg_get_timestamps(cstate->cfg, &timestamps);
+		assert_int_equal(ret, MOCK_OK);
+		assert_int_equal(timestamps, values[i]);
+	}
+}
+
+static const struct CMUnitTest test_timestamps[] = {
+	/* rpma_conn_cfg_set_timestamps() unit tests */
+	cmocka_unit_test(set__cfg_NULL),
+
+	/* rpma_conn_cfg_get_timestamps() unit tests */
+	cmocka_unit_test(get__cfg_NULL),
+	cmocka_unit_test_setup_teardown(get__timestamps_NULL,
+		setup__conn_cfg, teardown__conn_cfg),
+	cmocka_unit_test_setup_teardown(get__default,
+		setup__conn_cfg, teardown__conn_cfg),
+
+	/* rpma_conn_cfg_set/get_timestamps() lifecycle */
+	cmocka_unit_test_setup_teardown(timestamps__lifecycle,
+		setup__conn_cfg, teardown__conn_cfg),
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(test_timestamps, NULL, NULL);
+}
@@ -0,0 +1,345 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * conn_mt-common.c -- the thread-safe posting unit tests common functions
+ *
+ * The mocks below do not use cmocka's mocking facilities since they are
+ * called concurrently by many threads.
+ */
+
+#include <pthread.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "conn_mt-common.h"
+#include "mr.h"
+
+static struct ibv_context Mt_context;
+struct ibv_qp Mt_qp = {.context = &Mt_context};
+struct rpma_cq *const Mt_cq = (struct rpma_cq *)0xD418;
+
+struct mt_posted Mt_posted;
+
+/* the completion channel (an event is generated by eventfd_write()) */
+int Mt_cq_fd = -1;
+
+static pthread_mutex_t Mt_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* the completion queue */
+static struct {
+	uint64_t wr_id[POSTED_MAX];
+	uint64_t head;
+	uint64_t tail;
+} Mt_cq_queue;
+
+/*
+ * mt_posted_reset -- forget all the posted work requests and completions
+ */
+void
+mt_posted_reset(void)
+{
+	memset(&Mt_posted, 0, sizeof(Mt_posted));
+	memset(&Mt_cq_queue, 0, sizeof(Mt_cq_queue));
+}
+
+/*
+ * mt_cq_push -- generate a completion of the work request
+ */
+void
+mt_cq_push(uint64_t wr_id)
+{
+	pthread_mutex_lock(&Mt_lock);
+	Mt_cq_queue.wr_id[Mt_cq_queue.tail++ % POSTED_MAX] = wr_id;
+	pthread_mutex_unlock(&Mt_lock);
+}
+
+/*
+ * mt_post -- note the posted work request
+ */
+static int
+mt_post(uint64_t wr_id)
+{
+	if (Mt_posted.ret)
+		return Mt_posted.ret;
+
+	pthread_mutex_lock(&Mt_lock);
+	Mt_posted.wr_id[Mt_posted.num++ % POSTED_MAX] = wr_id;
+	pthread_mutex_unlock(&Mt_lock);
+
+	if (Mt_posted.complete)
+		mt_cq_push(wr_id);
+
+	return 0;
+}
+
+/*
+ * mt_post_send -- ibv_post_send() mock collecting the chain of work requests
+ */
+static int
+mt_post_send(struct ibv_qp *qp, struct ibv_send_wr *wr,
+		struct ibv_send_wr **bad_wr)
+{
+	__atomic_fetch_add(&Mt_posted.batches, 1, __ATOMIC_RELAXED);
+
+	for (; wr != NULL; wr = wr->next) {
+		int ret = mt_post(wr->wr_id);
+		if (ret) {
+			*bad_wr = wr;
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * rpma_mr_read_wr -- rpma_mr_read_wr() mock
+ */
+void
+rpma_mr_read_wr(struct ibv_send_wr *wr, struct ibv_sge *sge,
+	struct rpma_mr_local *dst, size_t dst_offset,
+	const struct rpma_mr_remote *src,  size_t src_offset,
+	size_t len, int flags, const void *op_context)
+{
+	memset(wr, 0, sizeof(*wr));
+	wr->wr_id = (uint64_t)op_context;
+	wr->opcode = IBV_WR_RDMA_READ;
+	wr->sg_list = sge;
+	wr->num_sge = 1;
+}
+
+/*
+ * rpma_mr_write_wr -- rpma_mr_write_wr() mock
+ */
+int
+rpma_mr_write_wr(struct ibv_send_wr *wr, struct ibv_sge *sge,
+	struct rpma_mr_remote *dst, size_t dst_offset,
+	const struct rpma_mr_local *src,  size_t src_offset,
+	size_t len, int flags, enum ibv_wr_opcode operation,
+	uint32_t imm, const void *op_context, bool fence)
+{
+	memset(wr, 0, sizeof(*wr));
+	wr->wr_id = (uint64_t)op_context;
+	wr->opcode = operation;
+	wr->sg_list = sge;
+	wr->num_sge = 1;
+
+	return 0;
+}
+
+/*
+ * rpma_mr_atomic_wr -- rpma_mr_atomic_wr() mock
+ */
+int
+rpma_mr_atomic_wr(struct ibv_send_wr *wr, struct ibv_sge *sge,
+	struct rpma_mr_local *dst, size_t dst_offset,
+	const struct rpma_mr_remote *src, size_t src_offset,
+	enum ibv_wr_opcode operation, uint64_t compare_add, uint64_t swap,
+	int flags, const void *op_context)
+{
+	memset(wr, 0, sizeof(*wr));
+	wr->wr_id = (uint64_t)op_context;
+	wr->opcode = operation;
+	wr->sg_list = sge;
+	wr->num_sge = 1;
+
+	return 0;
+}
+
+/*
+ * rpma_mr_send_wr -- rpma_mr_send_wr() mock
+ */
+int
+rpma_mr_send_wr(struct ibv_send_wr *wr, struct ibv_sge *sge,
+	const struct rpma_mr_local *src,  size_t offset,
+	size_t len, int flags, enum ibv_wr_opcode operation,
+	uint32_t imm, const void *op_context)
+{
+	memset(wr, 0, sizeof(*wr));
+	wr->wr_id = (uint64_t)op_context;
+	wr->opcode = operation;
+
+	return 0;
+}
+
+/*
+ * rpma_mr_read -- rpma_mr_read() mock
+ */
+int
+rpma_mr_read(struct ibv_qp *qp,
+	struct rpma_mr_local *dst, size_t dst_offset,
+	const struct rpma_mr_remote *src,  size_t src_offset,
+	size_t len, int flags, const void *op_context)
+{
+	return mt_post((uint64_t)op_context);
+}
+
+/*
+ * rpma_mr_write -- rpma_mr_write() mock
+ */
+int
+rpma_mr_write(struct ibv_qp *qp,
+	struct rpma_mr_remote *dst, size_t dst_offset,
+	const struct rpma_mr_local *src,  size_t src_offset,
+	size_t len, int flags, enum ibv_wr_opcode operation,
+	uint32_t imm, const void *op_context, bool fence)
+{
+	return mt_post((uint64_t)op_context);
+}
+
+/*
+ * rpma_mr_atomic -- rpma_mr_atomic() mock
+ */
+int
+rpma_mr_atomic(struct ibv_qp *qp,
+	struct rpma_mr_local *dst, size_t dst_offset,
+	const struct rpma_mr_remote *src, size_t src_offset,
+	enum ibv_wr_opcode operation, uint64_t compare_add, uint64_t swap,
+	int flags, const void *op_context)
+{
+	return mt_post((uint64_t)op_context);
+}
+
+/*
+ * rpma_mr_send -- rpma_mr_send() mock
+ */
+int
+rpma_mr_send(struct ibv_qp *qp,
+	const struct rpma_mr_local *src,  size_t offset,
+	size_t len, int flags, enum ibv_wr_opcode operation,
+	uint32_t imm, const void *op_context)
+{
+	return mt_post((uint64_t)op_context);
+}
+
+/*
+ * rpma_mr_recv -- rpma_mr_recv() mock
+ */
+int
+rpma_mr_recv(struct ibv_qp *qp,
+	struct rpma_mr_local *dst,  size_t offset,
+	size_t len, const void *op_context)
+{
+	return mt_post((uint64_t)op_context);
+}
+
+/*
+ * rpma_cq_get_fd -- rpma_cq_get_fd() mock
+ */
+int
+rpma_cq_get_fd(const struct rpma_cq *cq, int *fd)
+{
+	*fd = Mt_cq_fd;
+
+	return 0;
+}
+
+/*
+ * rpma_cq_wait -- rpma_cq_wait() mock collecting the completion event
+ */
+int
+rpma_cq_wait(struct rpma_cq *cq)
+{
+	eventfd_t events;
+
+	if (eventfd_read(Mt_cq_fd, &events))
+		return RPMA_E_NO_COMPLETION;
+
+	return 0;
+}
+
+/*
+ * rpma_cq_get_completion -- rpma_cq_get_completion() mock
+ */
+int
+rpma_cq_get_completion(struct rpma_cq *cq, struct rpma_completion *cmpl)
+{
+	int ret = RPMA_E_NO_COMPLETION;
+
+	pthread_mutex_lock(&Mt_lock);
+	if (Mt_cq_queue.head != Mt_cq_queue.tail) {
+		memset(cmpl, 0, sizeof(*cmpl));
+		cmpl->op_context = (void *)
+			Mt_cq_queue.wr_id[Mt_cq_queue.head++ % POSTED_MAX];
+		cmpl->op = RPMA_OP_WRITE;
+		cmpl->op_status = IBV_WC_SUCCESS;
+		ret = 0;
+	}
+	pthread_mutex_unlock(&Mt_lock);
+
+	return ret;
+}
+
+/*
+ * setup__conn_mt -- prepare a valid rpma_conn_mt object
+ */
+static int
+setup__conn_mt(void **cstate_ptr, enum rpma_conn_thread_mode mode,
+		int allocs)
+{
+	static struct conn_mt_test_state cstate;
+
+	Mt_context.ops.post_send = mt_post_send;
+	mt_posted_reset();
+
+	Mt_cq_fd = eventfd(0, EFD_NONBLOCK);
+	assert_true(Mt_cq_fd >= 0);
+
+	/* configure mocks */
+	will_return_count(__wrap__test_malloc, MOCK_OK, allocs);
+
+	/* prepare an object */
+	int ret = rpma_conn_mt_new(&Mt_qp, Mt_cq, mode, MOCK_SQ_SIZE,
+			MOCK_RQ_SIZE, &cstate.mt);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_non_null(cstate.mt);
+
+	*cstate_ptr = &cstate;
+
+	return 0;
+}
+
+/*
+ * setup__conn_mt_safe -- prepare an object in the thread-safe mode
+ */
+int
+setup__conn_mt_safe(void **cstate_ptr)
+{
+	return setup__conn_mt(cstate_ptr, RPMA_CONN_THREAD_SAFE,
+			CONN_MT_NEW_ALLOCS_SAFE);
+}
+
+/*
+ * setup__conn_mt_lockless -- prepare an object in the lockless mode
+ */
+int
+setup__conn_mt_lockless(void **cstate_ptr)
+{
+	return setup__conn_mt(cstate_ptr, RPMA_CONN_THREAD_LOCKLESS,
+			CONN_MT_NEW_ALLOCS_LOCKLESS);
+}
+
+/*
+ * teardown__conn_mt -- delete the rpma_conn_mt object
+ */
+int
+teardown__conn_mt(void **cstate_ptr)
+{
+	struct conn_mt_test_state *cstate = *cstate_ptr;
+
+	int ret = rpma_conn_mt_delete(&cstate->mt);
+
+	assert_int_equal(ret, MOCK_OK);
+	assert_null(cstate->mt);
+
+	assert_int_equal(close(Mt_cq_fd), 0);
+	Mt_cq_fd = -1;
+
+	*cstate_ptr = NULL;
+
+	return 0;
+}
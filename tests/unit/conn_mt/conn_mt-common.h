@@ -0,0 +1,57 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * conn_mt-common.h -- the thread-safe posting unit tests common definitions
+ */
+
+#ifndef CONN_MT_COMMON_H
+#define CONN_MT_COMMON_H
+
+#include <stdint.h>
+
+#include "cmocka_headers.h"
+#include "conn_mt.h"
+#include "test-common.h"
+
+#define MOCK_SQ_SIZE		8
+#define MOCK_RQ_SIZE		8
+#define MOCK_RPMA_MR_REMOTE	((struct rpma_mr_remote *)0xC412)
+#define MOCK_REMOTE_OFFSET	(size_t)0xC414
+
+/* the number of allocations made by rpma_conn_mt_new() */
+#define CONN_MT_NEW_ALLOCS_SAFE		5
+#define CONN_MT_NEW_ALLOCS_LOCKLESS	2
+/* the number of allocations made by the first rpma_conn_mt_thread_attach() */
+#define CONN_MT_ATTACH_ALLOCS		3
+
+#define POSTED_MAX		256
+
+extern struct ibv_qp Mt_qp;
+extern struct rpma_cq *const Mt_cq;
+extern int Mt_cq_fd;
+
+/* the work requests posted so far (shared by all the threads) */
+struct mt_posted {
+	uint64_t wr_id[POSTED_MAX];
+	uint64_t num; /* the number of posted work requests */
+	uint64_t batches; /* the number of ibv_post_send() calls */
+	int ret; /* the value to be returned by the posting functions */
+	int complete; /* completions are generated as soon as posted */
+};
+
+extern struct mt_posted Mt_posted;
+
+/* all the resources used between setup__conn_mt_* and teardown__conn_mt */
+struct conn_mt_test_state {
+	struct rpma_conn_mt *mt;
+};
+
+void mt_posted_reset(void);
+void mt_cq_push(uint64_t wr_id);
+
+int setup__conn_mt_safe(void **cstate_ptr);
+int setup__conn_mt_lockless(void **cstate_ptr);
+int teardown__conn_mt(void **cstate_ptr);
+
+#endif /* CONN_MT_COMMON_H */
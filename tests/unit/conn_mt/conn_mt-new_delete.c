@@ -0,0 +1,134 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * conn_mt-new_delete.c -- the thread-safe posting object new/delete unit tests
+ *
+ * APIs covered:
+ * - rpma_conn_mt_new()
+ * - rpma_conn_mt_delete()
+ */
+
+#include "conn_mt-common.h"
+
+/*
+ * new__mt_ptr_NULL -- NULL mt_ptr is invalid
+ */
+static void
+new__mt_ptr_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_conn_mt_new(&Mt_qp, Mt_cq, RPMA_CONN_THREAD_SAFE,
+			MOCK_SQ_SIZE, MOCK_RQ_SIZE, NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * new__mode_single -- the single-threaded mode does not need the object
+ */
+static void
+new__mode_single(void **unused)
+{
+	/* run test */
+	struct rpma_conn_mt *mt = NULL;
+	int ret = rpma_conn_mt_new(&Mt_qp, Mt_cq, RPMA_CONN_THREAD_SINGLE,
+			MOCK_SQ_SIZE, MOCK_RQ_SIZE, &mt);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+	assert_null(mt);
+}
+
+/*
+ * new__malloc_ERRNO -- malloc() fails at each of the allocations
+ */
+static void
+new__malloc_ERRNO(void **unused)
+{
+	for (int failing = 0; failing < CONN_MT_NEW_ALLOCS_SAFE; ++failing) {
+		/* configure mocks */
+		for (int i = 0; i < failing; ++i)
+			will_return(__wrap__test_malloc, MOCK_OK);
+		will_return(__wrap__test_malloc, ENOMEM);
+
+		/* run test */
+		struct rpma_conn_mt *mt = NULL;
+		int ret = rpma_conn_mt_new(&Mt_qp, Mt_cq,
+				RPMA_CONN_THREAD_SAFE, MOCK_SQ_SIZE,
+				MOCK_RQ_SIZE, &mt);
+
+		/* verify the results */
+		assert_int_equal(ret, RPMA_E_NOMEM);
+		assert_null(mt);
+	}
+}
+
+/*
+ * delete__mt_ptr_NULL -- NULL mt_ptr is invalid
+ */
+static void
+delete__mt_ptr_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_conn_mt_delete(NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * delete__mt_NULL -- NULL mt is valid - quick exit
+ */
+static void
+delete__mt_NULL(void **unused)
+{
+	/* run test */
+	struct rpma_conn_mt *mt = NULL;
+	int ret = rpma_conn_mt_delete(&mt);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * new_delete__lifecycle -- happy day scenario
+ */
+static void
+new_delete__lifecycle(void **unused)
+{
+	/*
+	 * The common setup and teardown are the lifecycle.
+	 * The attached thread's mailbox has to be released as well.
+	 */
+	void *cstate_ptr = NULL;
+	setup__conn_mt_lockless(&cstate_ptr);
+	struct conn_mt_test_state *cstate = cstate_ptr;
+
+	will_return_count(__wrap__test_malloc, MOCK_OK, CONN_MT_ATTACH_ALLOCS);
+	assert_int_equal(rpma_conn_mt_thread_attach(cstate->mt), MOCK_OK);
+
+	teardown__conn_mt(&cstate_ptr);
+}
+
+static const struct CMUnitTest tests_new_delete[] = {
+	/* rpma_conn_mt_new() unit tests */
+	cmocka_unit_test(new__mt_ptr_NULL),
+	cmocka_unit_test(new__mode_single),
+	cmocka_unit_test(new__malloc_ERRNO),
+
+	/* rpma_conn_mt_delete() unit tests */
+	cmocka_unit_test(delete__mt_ptr_NULL),
+	cmocka_unit_test(delete__mt_NULL),
+
+	/* rpma_conn_mt_new()/_delete() lifecycle */
+	cmocka_unit_test(new_delete__lifecycle),
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_new_delete, NULL, NULL);
+}
@@ -0,0 +1,239 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * conn_mt-post.c -- the thread-safe posting unit tests
+ *
+ * APIs covered:
+ * - rpma_conn_mt_read()
+ * - rpma_conn_mt_write()
+ * - rpma_conn_mt_atomic()
+ * - rpma_conn_mt_send()
+ * - rpma_conn_mt_recv()
+ * - rpma_conn_mt_flush()
+ */
+
+#include "conn_mt-common.h"
+#include "mr.h"
+
+#define MOCK_FLAGS_SIGNALED	RPMA_F_COMPLETION_ALWAYS
+#define MOCK_FLAGS_UNSIGNALED	RPMA_F_COMPLETION_ON_ERROR
+
+/*
+ * flush_mock -- the flush function mock
+ */
+static int
+flush_mock(struct ibv_qp *qp, struct rpma_flush *flush,
+	struct rpma_mr_remote *dst, size_t dst_offset, size_t len,
+	enum rpma_flush_type type, int flags, const void *op_context)
+{
+	assert_ptr_equal(qp, &Mt_qp);
+
+	return rpma_mr_read(qp, NULL, 0, NULL, 0, 0, flags, op_context);
+}
+
+static struct rpma_flush Flush = {flush_mock};
+
+/*
+ * post__all_ops -- all the operations are posted with the op_context
+ * untouched when the calling thread is not attached
+ */
+static void
+post__all_ops(void **cstate_ptr)
+{
+	struct conn_mt_test_state *cstate = *cstate_ptr;
+	const void *ctx[] = {(void *)0x1, (void *)0x2, (void *)0x3,
+			(void *)0x4, (void *)0x5, (void *)0x6, (void *)0x7};
+
+	/* run test */
+	assert_int_equal(rpma_conn_mt_read(cstate->mt, MOCK_RPMA_MR_LOCAL,
+			MOCK_LOCAL_OFFSET, MOCK_RPMA_MR_REMOTE,
+			MOCK_REMOTE_OFFSET, MOCK_LEN, MOCK_FLAGS_SIGNALED,
+			ctx[0]), MOCK_OK);
+	assert_int_equal(rpma_conn_mt_write(cstate->mt, MOCK_RPMA_MR_REMOTE,
+			MOCK_REMOTE_OFFSET, MOCK_RPMA_MR_LOCAL,
+			MOCK_LOCAL_OFFSET, MOCK_LEN, MOCK_FLAGS_SIGNALED,
+			IBV_WR_RDMA_WRITE, 0, ctx[1], MOCK_NOFENCE), MOCK_OK);
+	assert_int_equal(rpma_conn_mt_write(cstate->mt, MOCK_RPMA_MR_REMOTE,
+			MOCK_REMOTE_OFFSET, MOCK_RPMA_MR_LOCAL,
+			MOCK_LOCAL_OFFSET, MOCK_LEN, MOCK_FLAGS_SIGNALED,
+			IBV_WR_RDMA_WRITE_WITH_IMM, MOCK_IMM_DATA, ctx[2],
+			MOCK_FENCE), MOCK_OK);
+	assert_int_equal(rpma_conn_mt_send(cstate->mt, MOCK_RPMA_MR_LOCAL,
+			MOCK_LOCAL_OFFSET, MOCK_LEN, MOCK_FLAGS_SIGNALED,
+			IBV_WR_SEND, 0, ctx[3]), MOCK_OK);
+	assert_int_equal(rpma_conn_mt_recv(cstate->mt, MOCK_RPMA_MR_LOCAL,
+			MOCK_LOCAL_OFFSET, MOCK_LEN, ctx[4]), MOCK_OK);
+	assert_int_equal(rpma_conn_mt_flush(cstate->mt, &Flush,
+			MOCK_RPMA_MR_REMOTE, MOCK_REMOTE_OFFSET, MOCK_LEN,
+			RPMA_FLUSH_TYPE_VISIBILITY, MOCK_FLAGS_SIGNALED,
+			ctx[5]), MOCK_OK);
+	assert_int_equal(rpma_conn_mt_atomic(cstate->mt, MOCK_RPMA_MR_LOCAL,
+			MOCK_LOCAL_OFFSET, MOCK_RPMA_MR_REMOTE, 0,
+			IBV_WR_ATOMIC_FETCH_AND_ADD, 1, 0, MOCK_FLAGS_SIGNALED,
+			ctx[6]), MOCK_OK);
+
+	/* verify the results */
+	assert_int_equal(Mt_posted.num, 7);
+	for (int i = 0; i < 7; ++i)
+		assert_int_equal(Mt_posted.wr_id[i], (uint64_t)ctx[i]);
+}
+
+/*
+ * post__failed -- a failure of the posting is reported to the caller
+ */
+static void
+post__failed(void **cstate_ptr)
+{
+	struct conn_mt_test_state *cstate = *cstate_ptr;
+
+	/* configure mocks */
+	Mt_posted.ret = MOCK_ERRNO;
+
+	/* run test */
+	int ret = rpma_conn_mt_write(cstate->mt, MOCK_RPMA_MR_REMOTE,
+			MOCK_REMOTE_OFFSET, MOCK_RPMA_MR_LOCAL,
+			MOCK_LOCAL_OFFSET, MOCK_LEN, MOCK_FLAGS_SIGNALED,
+			IBV_WR_RDMA_WRITE, 0, MOCK_OP_CONTEXT, MOCK_NOFENCE);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_int_equal(Mt_posted.num, 0);
+}
+
+/*
+ * post__attached_tracked -- a signaled operation of an attached thread
+ * is tracked and its completion carries the original op_context
+ */
+static void
+post__attached_tracked(void **cstate_ptr)
+{
+	struct conn_mt_test_state *cstate = *cstate_ptr;
+	struct rpma_completion cmpl;
+
+	/* configure mocks */
+	will_return_count(__wrap__test_malloc, MOCK_OK, CONN_MT_ATTACH_ALLOCS);
+	assert_int_equal(rpma_conn_mt_thread_attach(cstate->mt), MOCK_OK);
+	/* attaching again is a no-op */
+	assert_int_equal(rpma_conn_mt_thread_attach(cstate->mt), MOCK_OK);
+
+	/* run test */
+	int ret = rpma_conn_mt_write(cstate->mt, MOCK_RPMA_MR_REMOTE,
+			MOCK_REMOTE_OFFSET, MOCK_RPMA_MR_LOCAL,
+			MOCK_LOCAL_OFFSET, MOCK_LEN, MOCK_FLAGS_SIGNALED,
+			IBV_WR_RDMA_WRITE, 0, MOCK_OP_CONTEXT, MOCK_NOFENCE);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(Mt_posted.num, 1);
+	assert_int_not_equal(Mt_posted.wr_id[0], (uint64_t)MOCK_OP_CONTEXT);
+
+	/* the completion has not been collected yet */
+	assert_int_equal(rpma_conn_mt_thread_detach(cstate->mt),
+			RPMA_E_AGAIN);
+
+	mt_cq_push(Mt_posted.wr_id[0]);
+	ret = rpma_conn_mt_completion_get(cstate->mt, &cmpl);
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(cmpl.op_context, MOCK_OP_CONTEXT);
+
+	ret = rpma_conn_mt_completion_get(cstate->mt, &cmpl);
+	assert_int_equal(ret, RPMA_E_NO_COMPLETION);
+
+	assert_int_equal(rpma_conn_mt_thread_detach(cstate->mt), MOCK_OK);
+	assert_int_equal(rpma_conn_mt_thread_detach(cstate->mt),
+			RPMA_E_INVAL);
+}
+
+/*
+ * post__attached_unsignaled -- an unsignaled operation is not tracked
+ */
+static void
+post__attached_unsignaled(void **cstate_ptr)
+{
+	struct conn_mt_test_state *cstate = *cstate_ptr;
+
+	/* configure mocks */
+	will_return_count(__wrap__test_malloc, MOCK_OK, CONN_MT_ATTACH_ALLOCS);
+	assert_int_equal(rpma_conn_mt_thread_attach(cstate->mt), MOCK_OK);
+
+	/* run test */
+	int ret = rpma_conn_mt_send(cstate->mt, MOCK_RPMA_MR_LOCAL,
+			MOCK_LOCAL_OFFSET, MOCK_LEN, MOCK_FLAGS_UNSIGNALED,
+			IBV_WR_SEND, 0, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(Mt_posted.wr_id[0], (uint64_t)MOCK_OP_CONTEXT);
+	assert_int_equal(rpma_conn_mt_thread_detach(cstate->mt), MOCK_OK);
+}
+
+/*
+ * post__attached_failed -- the tracking slot of a failed operation is
+ * released so the thread can detach
+ */
+static void
+post__attached_failed(void **cstate_ptr)
+{
+	struct conn_mt_test_state *cstate = *cstate_ptr;
+
+	/* configure mocks */
+	will_return_count(__wrap__test_malloc, MOCK_OK, CONN_MT_ATTACH_ALLOCS);
+	assert_int_equal(rpma_conn_mt_thread_attach(cstate->mt), MOCK_OK);
+	Mt_posted.ret = MOCK_ERRNO;
+
+	/* run test */
+	int ret = rpma_conn_mt_recv(cstate->mt, MOCK_RPMA_MR_LOCAL,
+			MOCK_LOCAL_OFFSET, MOCK_LEN, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_ERRNO);
+	assert_int_equal(rpma_conn_mt_thread_detach(cstate->mt), MOCK_OK);
+}
+
+/*
+ * completion_get__unrouted -- a completion of an untracked operation is
+ * returned to any caller
+ */
+static void
+completion_get__unrouted(void **cstate_ptr)
+{
+	struct conn_mt_test_state *cstate = *cstate_ptr;
+	struct rpma_completion cmpl;
+
+	/* configure mocks */
+	mt_cq_push((uint64_t)MOCK_OP_CONTEXT);
+
+	/* run test */
+	int ret = rpma_conn_mt_completion_get(cstate->mt, &cmpl);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(cmpl.op_context, MOCK_OP_CONTEXT);
+}
+
+static const struct CMUnitTest tests_post[] = {
+	cmocka_unit_test_setup_teardown(post__all_ops,
+		setup__conn_mt_safe, teardown__conn_mt),
+	cmocka_unit_test_setup_teardown(post__all_ops,
+		setup__conn_mt_lockless, teardown__conn_mt),
+	cmocka_unit_test_setup_teardown(post__failed,
+		setup__conn_mt_safe, teardown__conn_mt),
+	cmocka_unit_test_setup_teardown(post__attached_tracked,
+		setup__conn_mt_safe, teardown__conn_mt),
+	cmocka_unit_test_setup_teardown(post__attached_tracked,
+		setup__conn_mt_lockless, teardown__conn_mt),
+	cmocka_unit_test_setup_teardown(post__attached_unsignaled,
+		setup__conn_mt_safe, teardown__conn_mt),
+	cmocka_unit_test_setup_teardown(post__attached_failed,
+		setup__conn_mt_safe, teardown__conn_mt),
+	cmocka_unit_test_setup_teardown(completion_get__unrouted,
+		setup__conn_mt_safe, teardown__conn_mt),
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_post, NULL, NULL);
+}
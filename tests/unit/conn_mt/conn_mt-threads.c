@@ -0,0 +1,314 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * conn_mt-threads.c -- the thread-safe posting concurrency unit tests
+ *
+ * APIs covered:
+ * - rpma_conn_mt_write()
+ * - rpma_conn_mt_completion_wait()
+ * - rpma_conn_mt_completion_get()
+ * - rpma_conn_mt_thread_attach()
+ * - rpma_conn_mt_thread_detach()
+ */
+
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "conn_mt-common.h"
+
+#define THREADS_NUM	4
+#define OPS_PER_THREAD	(2 * (MOCK_SQ_SIZE + MOCK_RQ_SIZE) / THREADS_NUM)
+
+/* the time given to a thread to block in rpma_conn_mt_completion_wait() */
+#define WAIT_BLOCK_US	10000
+
+/* cmocka's mocks are not thread-safe so the attaching is serialized */
+static pthread_mutex_t Attach_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/*
+ * all the threads are attached before any of them detaches so each of them
+ * gets a route of its own
+ */
+static pthread_barrier_t Attached;
+
+struct thread_args {
+	struct rpma_conn_mt *mt;
+	uintptr_t id;
+	int attach;
+	int posted; /* the number of successfully posted operations */
+	int collected; /* the number of collected completions */
+	int foreign; /* the number of completions of the other threads */
+	int detached; /* the result of rpma_conn_mt_thread_detach() */
+};
+
+/*
+ * thread_main -- post the operations and collect their completions
+ */
+static void *
+thread_main(void *arg)
+{
+	struct thread_args *ta = arg;
+	struct rpma_completion cmpl;
+
+	if (ta->attach) {
+		pthread_mutex_lock(&Attach_lock);
+		int ret = rpma_conn_mt_thread_attach(ta->mt);
+		pthread_mutex_unlock(&Attach_lock);
+		(void) pthread_barrier_wait(&Attached);
+		if (ret)
+			return NULL;
+	}
+
+	for (int i = 0; i < OPS_PER_THREAD; ++i) {
+		const void *op_context =
+			(void *)((ta->id << 16) | (uintptr_t)i);
+		if (rpma_conn_mt_write(ta->mt, MOCK_RPMA_MR_REMOTE,
+				MOCK_REMOTE_OFFSET, MOCK_RPMA_MR_LOCAL,
+				MOCK_LOCAL_OFFSET, MOCK_LEN,
+				RPMA_F_COMPLETION_ALWAYS, IBV_WR_RDMA_WRITE, 0,
+				op_context, MOCK_NOFENCE) == 0)
+			++ta->posted;
+	}
+
+	if (!ta->attach)
+		return NULL;
+
+	while (ta->collected < ta->posted) {
+		int ret = rpma_conn_mt_completion_get(ta->mt, &cmpl);
+		if (ret == RPMA_E_NO_COMPLETION)
+			continue;
+		if (ret)
+			break;
+
+		if (((uintptr_t)cmpl.op_context >> 16) != ta->id)
+			++ta->foreign;
+		++ta->collected;
+	}
+
+	ta->detached = rpma_conn_mt_thread_detach(ta->mt);
+
+	return NULL;
+}
+
+/*
+ * run_threads -- run THREADS_NUM threads posting concurrently
+ */
+static void
+run_threads(struct rpma_conn_mt *mt, int attach, struct thread_args *ta)
+{
+	pthread_t threads[THREADS_NUM];
+
+	if (attach) {
+		will_return_count(__wrap__test_malloc, MOCK_OK,
+				THREADS_NUM * CONN_MT_ATTACH_ALLOCS);
+		assert_int_equal(pthread_barrier_init(&Attached, NULL,
+				THREADS_NUM), 0);
+	}
+
+	for (int i = 0; i < THREADS_NUM; ++i) {
+		ta[i].mt = mt;
+		ta[i].id = (uintptr_t)i + 1;
+		ta[i].attach = attach;
+		ta[i].posted = 0;
+		ta[i].collected = 0;
+		ta[i].foreign = 0;
+		ta[i].detached = -1;
+		assert_int_equal(pthread_create(&threads[i], NULL,
+				thread_main, &ta[i]), 0);
+	}
+
+	for (int i = 0; i < THREADS_NUM; ++i)
+		assert_int_equal(pthread_join(threads[i], NULL), 0);
+
+	if (attach)
+		(void) pthread_barrier_destroy(&Attached);
+}
+
+/*
+ * threads__post -- all the operations posted concurrently are posted once
+ */
+static void
+threads__post(void **cstate_ptr)
+{
+	struct conn_mt_test_state *cstate = *cstate_ptr;
+	struct thread_args ta[THREADS_NUM];
+
+	/* run test */
+	run_threads(cstate->mt, 0 /* attach */, ta);
+
+	/* verify the results */
+	assert_int_equal(Mt_posted.num, THREADS_NUM * OPS_PER_THREAD);
+	assert_true(Mt_posted.batches <= Mt_posted.num);
+	for (int i = 0; i < THREADS_NUM; ++i) {
+		assert_int_equal(ta[i].posted, OPS_PER_THREAD);
+
+		/* each of the operations has been posted exactly once */
+		for (int op = 0; op < OPS_PER_THREAD; ++op) {
+			uint64_t wr_id = (ta[i].id << 16) | (uint64_t)op;
+			int found = 0;
+			for (uint64_t n = 0; n < Mt_posted.num; ++n)
+				found += (Mt_posted.wr_id[n] == wr_id);
+			assert_int_equal(found, 1);
+		}
+	}
+}
+
+/*
+ * threads__route -- each of the attached threads collects the completions
+ * of its own operations only
+ */
+static void
+threads__route(void **cstate_ptr)
+{
+	struct conn_mt_test_state *cstate = *cstate_ptr;
+	struct thread_args ta[THREADS_NUM];
+
+	/* configure mocks */
+	Mt_posted.complete = 1;
+
+	/* run test */
+	run_threads(cstate->mt, 1 /* attach */, ta);
+
+	/* verify the results */
+	for (int i = 0; i < THREADS_NUM; ++i) {
+		assert_int_equal(ta[i].posted, OPS_PER_THREAD);
+		assert_int_equal(ta[i].collected, OPS_PER_THREAD);
+		assert_int_equal(ta[i].foreign, 0);
+		assert_int_equal(ta[i].detached, MOCK_OK);
+	}
+}
+
+/* the arguments of a waiting thread */
+struct wait_args {
+	struct rpma_conn_mt *mt;
+	int attach;
+	int waited; /* the result of rpma_conn_mt_completion_wait() */
+	int collected; /* the result of rpma_conn_mt_completion_get() */
+	struct rpma_completion cmpl;
+};
+
+/*
+ * wait_main -- post an operation and wait for its completion
+ */
+static void *
+wait_main(void *arg)
+{
+	struct wait_args *wa = arg;
+
+	if (wa->attach) {
+		(void) rpma_conn_mt_thread_attach(wa->mt);
+		(void) rpma_conn_mt_write(wa->mt, MOCK_RPMA_MR_REMOTE,
+				MOCK_REMOTE_OFFSET, MOCK_RPMA_MR_LOCAL,
+				MOCK_LOCAL_OFFSET, MOCK_LEN,
+				RPMA_F_COMPLETION_ALWAYS, IBV_WR_RDMA_WRITE, 0,
+				MOCK_OP_CONTEXT, MOCK_NOFENCE);
+	}
+
+	(void) pthread_barrier_wait(&Attached);
+
+	wa->waited = rpma_conn_mt_completion_wait(wa->mt);
+
+	if (wa->attach) {
+		wa->collected = rpma_conn_mt_completion_get(wa->mt, &wa->cmpl);
+		(void) rpma_conn_mt_thread_detach(wa->mt);
+	}
+
+	return NULL;
+}
+
+/*
+ * threads__wait_routed -- a thread waiting on the completion channel is woken
+ * up when its completion is polled and routed by another thread
+ */
+static void
+threads__wait_routed(void **cstate_ptr)
+{
+	struct conn_mt_test_state *cstate = *cstate_ptr;
+	struct wait_args wa = {cstate->mt, 1 /* attach */, -1, -1};
+	struct rpma_completion cmpl;
+	pthread_t thread;
+
+	/* configure mocks */
+	Mt_posted.complete = 1;
+	will_return_count(__wrap__test_malloc, MOCK_OK, CONN_MT_ATTACH_ALLOCS);
+	assert_int_equal(pthread_barrier_init(&Attached, NULL, 2), 0);
+
+	/* run test */
+	assert_int_equal(pthread_create(&thread, NULL, wait_main, &wa), 0);
+	(void) pthread_barrier_wait(&Attached);
+	(void) usleep(WAIT_BLOCK_US);
+	int ret = rpma_conn_mt_completion_get(cstate->mt, &cmpl);
+	assert_int_equal(pthread_join(thread, NULL), 0);
+	(void) pthread_barrier_destroy(&Attached);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NO_COMPLETION);
+	assert_int_equal(wa.waited, MOCK_OK);
+	assert_int_equal(wa.collected, MOCK_OK);
+	assert_ptr_equal(wa.cmpl.op_context, MOCK_OP_CONTEXT);
+}
+
+/*
+ * threads__wait_many -- all the threads waiting at the same time are woken up
+ * by a single completion event
+ */
+static void
+threads__wait_many(void **cstate_ptr)
+{
+	struct conn_mt_test_state *cstate = *cstate_ptr;
+	struct wait_args wa[THREADS_NUM];
+	pthread_t threads[THREADS_NUM];
+
+	/* configure mocks */
+	assert_int_equal(pthread_barrier_init(&Attached, NULL,
+			THREADS_NUM + 1), 0);
+
+	/* run test */
+	for (int i = 0; i < THREADS_NUM; ++i) {
+		wa[i].mt = cstate->mt;
+		wa[i].attach = 0;
+		wa[i].waited = -1;
+		assert_int_equal(pthread_create(&threads[i], NULL, wait_main,
+				&wa[i]), 0);
+	}
+
+	(void) pthread_barrier_wait(&Attached);
+	(void) usleep(WAIT_BLOCK_US);
+	assert_int_equal(eventfd_write(Mt_cq_fd, 1), 0);
+
+	for (int i = 0; i < THREADS_NUM; ++i)
+		assert_int_equal(pthread_join(threads[i], NULL), 0);
+	(void) pthread_barrier_destroy(&Attached);
+
+	/* verify the results */
+	for (int i = 0; i < THREADS_NUM; ++i)
+		assert_int_equal(wa[i].waited, MOCK_OK);
+}
+
+static const struct CMUnitTest tests_threads[] = {
+	cmocka_unit_test_setup_teardown(threads__post,
+		setup__conn_mt_safe, teardown__conn_mt),
+	cmocka_unit_test_setup_teardown(threads__post,
+		setup__conn_mt_lockless, teardown__conn_mt),
+	cmocka_unit_test_setup_teardown(threads__route,
+		setup__conn_mt_safe, teardown__conn_mt),
+	cmocka_unit_test_setup_teardown(threads__route,
+		setup__conn_mt_lockless, teardown__conn_mt),
+	cmocka_unit_test_setup_teardown(threads__wait_routed,
+		setup__conn_mt_safe, teardown__conn_mt),
+	cmocka_unit_test_setup_teardown(threads__wait_routed,
+		setup__conn_mt_lockless, teardown__conn_mt),
+	cmocka_unit_test_setup_teardown(threads__wait_many,
+		setup__conn_mt_safe, teardown__conn_mt),
+	cmocka_unit_test_setup_teardown(threads__wait_many,
+		setup__conn_mt_lockless, teardown__conn_mt),
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_threads, NULL, NULL);
+}
@@ -49,6 +49,7 @@ setup__conn_req_from_cm_event(void **cstate_ptr)
 	/* configure mocks */
 	will_return(rpma_conn_cfg_get_cqe, &get_cqe);
 	expect_value(rpma_cq_new, cqe, MOCK_CQ_SIZE_DEFAULT);
+	expect_value(rpma_cq_new, comp_vector, MOCK_COMP_VECTOR);
 	will_return(rpma_cq_new, MOCK_RPMA_CQ);
 	expect_value(rpma_peer_create_qp, id, &cstate.id);
 	expect_value(rpma_peer_create_qp, cfg, MOCK_CONN_CFG_DEFAULT);
@@ -120,6 +121,7 @@ setup__conn_req_new(void **cstate_ptr)
 	will_return(rdma_resolve_route, MOCK_OK);
 	will_return(rpma_conn_cfg_get_cqe, &cstate->get_cqe);
 	expect_value(rpma_cq_new, cqe, cstate->get_cqe.q_size);
+	expect_value(rpma_cq_new, comp_vector, MOCK_COMP_VECTOR);
 	will_return(rpma_cq_new, MOCK_RPMA_CQ);
 	expect_value(rpma_peer_create_qp, id, &cstate->id);
 	expect_value(rpma_peer_create_qp, cfg, cstate->get_cqe.cfg);
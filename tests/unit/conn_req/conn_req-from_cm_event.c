@@ -113,6 +113,7 @@ from_cm_event__cq_new_ERRNO(void **unused)
 	event.id = &id;
 	will_return_maybe(rpma_conn_cfg_get_cqe, &Get_cqe);
 	expect_value(rpma_cq_new, cqe, MOCK_CQ_SIZE_DEFAULT);
+	expect_value(rpma_cq_new, comp_vector, MOCK_COMP_VECTOR);
 	will_return(rpma_cq_new, NULL);
 	will_return(rpma_cq_new, RPMA_E_PROVIDER);
 	will_return(rpma_cq_new, MOCK_ERRNO);
@@ -141,6 +142,7 @@ from_cm_event__peer_create_qp_ERRNO(void **unused)
 	event.id = &id;
 	will_return(rpma_conn_cfg_get_cqe, &Get_cqe);
 	expect_value(rpma_cq_new, cqe, MOCK_CQ_SIZE_DEFAULT);
+	expect_value(rpma_cq_new, comp_vector, MOCK_COMP_VECTOR);
 	will_return(rpma_cq_new, MOCK_RPMA_CQ);
 	expect_value(rpma_peer_create_qp, id, &id);
 	expect_value(rpma_peer_create_qp, cfg, MOCK_CONN_CFG_DEFAULT);
@@ -172,6 +174,7 @@ from_cm_event__create_qp_ERRNO_subsequent_ERRNO2(void **unused)
 	event.id = &id;
 	will_return(rpma_conn_cfg_get_cqe, &Get_cqe);
 	expect_value(rpma_cq_new, cqe, MOCK_CQ_SIZE_DEFAULT);
+	expect_value(rpma_cq_new, comp_vector, MOCK_COMP_VECTOR);
 	will_return(rpma_cq_new, MOCK_RPMA_CQ);
 	expect_value(rpma_peer_create_qp, id, &id);
 	expect_value(rpma_peer_create_qp, cfg, MOCK_CONN_CFG_DEFAULT);
@@ -203,6 +206,7 @@ from_cm_event__malloc_ERRNO(void **unused)
 	event.id = &id;
 	will_return(rpma_conn_cfg_get_cqe, &Get_cqe);
 	expect_value(rpma_cq_new, cqe, MOCK_CQ_SIZE_DEFAULT);
+	expect_value(rpma_cq_new, comp_vector, MOCK_COMP_VECTOR);
 	will_return(rpma_cq_new, MOCK_RPMA_CQ);
 	expect_value(rpma_peer_create_qp, id, &id);
 	expect_value(rpma_peer_create_qp, cfg, MOCK_CONN_CFG_DEFAULT);
@@ -235,6 +239,7 @@ from_cm_event__malloc_ERRNO_subsequent_ERRNO2(void **unused)
 	event.id = &id;
 	will_return(rpma_conn_cfg_get_cqe, &Get_cqe);
 	expect_value(rpma_cq_new, cqe, MOCK_CQ_SIZE_DEFAULT);
+	expect_value(rpma_cq_new, comp_vector, MOCK_COMP_VECTOR);
 	will_return(rpma_cq_new, MOCK_RPMA_CQ);
 	expect_value(rpma_peer_create_qp, id, &id);
 	expect_value(rpma_peer_create_qp, cfg, MOCK_CONN_CFG_DEFAULT);
@@ -268,6 +273,7 @@ from_cm_event__private_data_store_E_NOMEM(void **unused)
 	event.id = &id;
 	will_return(rpma_conn_cfg_get_cqe, &Get_cqe);
 	expect_value(rpma_cq_new, cqe, MOCK_CQ_SIZE_DEFAULT);
+	expect_value(rpma_cq_new, comp_vector, MOCK_COMP_VECTOR);
 	will_return(rpma_cq_new, MOCK_RPMA_CQ);
 	expect_value(rpma_peer_create_qp, id, &id);
 	expect_value(rpma_peer_create_qp, cfg, MOCK_CONN_CFG_DEFAULT);
@@ -236,6 +236,7 @@ new__cq_new_ERRNO(void **unused)
 	will_return(rdma_resolve_route, MOCK_OK);
 	will_return(rpma_conn_cfg_get_cqe, &Get_cqe);
 	expect_value(rpma_cq_new, cqe, MOCK_CQ_SIZE_DEFAULT);
+	expect_value(rpma_cq_new, comp_vector, MOCK_COMP_VECTOR);
 	will_return(rpma_cq_new, NULL);
 	will_return(rpma_cq_new, RPMA_E_PROVIDER);
 	will_return(rpma_cq_new, MOCK_ERRNO);
@@ -278,6 +279,7 @@ new__peer_create_qp_ERRNO(void **unused)
 	will_return(rdma_resolve_route, MOCK_OK);
 	will_return(rpma_conn_cfg_get_cqe, &Get_cqe);
 	expect_value(rpma_cq_new, cqe, MOCK_CQ_SIZE_DEFAULT);
+	expect_value(rpma_cq_new, comp_vector, MOCK_COMP_VECTOR);
 	will_return(rpma_cq_new, MOCK_RPMA_CQ);
 	expect_value(rpma_peer_create_qp, id, &id);
 	expect_value(rpma_peer_create_qp, cfg, MOCK_CONN_CFG_DEFAULT);
@@ -321,6 +323,7 @@ new__malloc_ERRNO(void **unused)
 	will_return(rdma_resolve_route, MOCK_OK);
 	will_return(rpma_conn_cfg_get_cqe, &Get_cqe);
 	expect_value(rpma_cq_new, cqe, MOCK_CQ_SIZE_DEFAULT);
+	expect_value(rpma_cq_new, comp_vector, MOCK_COMP_VECTOR);
 	will_return(rpma_cq_new, MOCK_RPMA_CQ);
 	expect_value(rpma_peer_create_qp, id, &id);
 	expect_value(rpma_peer_create_qp, cfg, MOCK_CONN_CFG_DEFAULT);
@@ -367,6 +370,7 @@ new__malloc_ERRNO_subsequent_ERRNO2(void **unused)
 	will_return(rdma_resolve_route, MOCK_OK);
 	will_return(rpma_conn_cfg_get_cqe, &Get_cqe);
 	expect_value(rpma_cq_new, cqe, MOCK_CQ_SIZE_DEFAULT);
+	expect_value(rpma_cq_new, comp_vector, MOCK_COMP_VECTOR);
 	will_return(rpma_cq_new, MOCK_RPMA_CQ);
 	expect_value(rpma_peer_create_qp, id, &id);
 	expect_value(rpma_peer_create_qp, cfg, MOCK_CONN_CFG_DEFAULT);
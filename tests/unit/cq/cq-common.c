@@ -29,7 +29,8 @@ setup__cq_new(void **cq_ptr)
 	will_return(__wrap__test_malloc, MOCK_OK);
 
 	/* run test */
-	int ret = rpma_cq_new(MOCK_VERBS, MOCK_CQ_SIZE_DEFAULT, &cq);
+	int ret = rpma_cq_new(MOCK_VERBS, MOCK_CQ_SIZE_DEFAULT,
+			MOCK_COMP_VECTOR, false /* timestamps */, &cq);
 
 	/* verify the result */
 	assert_int_equal(ret, MOCK_OK);
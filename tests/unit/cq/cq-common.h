@@ -12,6 +12,7 @@
 #include "cq.h"
 
 #define MOCK_WC_STATUS		(int)0x51A5
+#define MOCK_QP_NUM		(uint32_t)0x0D1C
 
 int setup__cq_new(void **cq_ptr);
 int teardown__cq_delete(void **cq_ptr);
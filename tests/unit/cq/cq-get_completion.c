@@ -135,7 +135,9 @@ get_completion__success(void **cq_ptr)
 			IBV_WC_SEND,
 			IBV_WC_RECV,
 			IBV_WC_RECV,
-			IBV_WC_RECV_RDMA_WITH_IMM
+			IBV_WC_RECV_RDMA_WITH_IMM,
+			IBV_WC_COMP_SWAP,
+			IBV_WC_FETCH_ADD
 	};
 	enum rpma_op ops[] = {
 			RPMA_OP_READ,
@@ -143,7 +145,9 @@ get_completion__success(void **cq_ptr)
 			RPMA_OP_SEND,
 			RPMA_OP_RECV,
 			RPMA_OP_RECV,
-			RPMA_OP_RECV_RDMA_WITH_IMM
+			RPMA_OP_RECV_RDMA_WITH_IMM,
+			RPMA_OP_COMPARE_AND_SWAP,
+			RPMA_OP_FETCH_AND_ADD
 	};
 	unsigned flags[] = {
 		0,
@@ -151,7 +155,9 @@ get_completion__success(void **cq_ptr)
 		0,
 		0,
 		IBV_WC_WITH_IMM,
-		IBV_WC_WITH_IMM
+		IBV_WC_WITH_IMM,
+		0,
+		0
 	};
 
 	int n_values = sizeof(opcodes) / sizeof(opcodes[0]);
@@ -166,6 +172,7 @@ get_completion__success(void **cq_ptr)
 		wc.wr_id = (uint64_t)MOCK_OP_CONTEXT;
 		wc.byte_len = MOCK_LEN;
 		wc.status = MOCK_WC_STATUS;
+		wc.qp_num = MOCK_QP_NUM;
 		if (flags[i] == IBV_WC_WITH_IMM) {
 			/*
 			 * 'wc_flags' is of 'int' type
@@ -186,6 +193,7 @@ get_completion__success(void **cq_ptr)
 		assert_int_equal(cmpl.op_context, MOCK_OP_CONTEXT);
 		assert_int_equal(cmpl.byte_len, MOCK_LEN);
 		assert_int_equal(cmpl.op_status, MOCK_WC_STATUS);
+		assert_int_equal(cmpl.qp_num, MOCK_QP_NUM);
 		if (flags[i] == IBV_WC_WITH_IMM) {
 			assert_int_equal(cmpl.flags, IBV_WC_WITH_IMM);
 			assert_int_equal(cmpl.imm, MOCK_IMM_DATA);
@@ -0,0 +1,572 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * cq-get_completion_ex.c -- the rpma_cq_get_completion_ex() unit tests
+ *
+ * APIs covered:
+ * - rpma_cq_new() (the timestamps requested)
+ * - rpma_cq_get_completion_ex()
+ */
+
+#include <string.h>
+
+#include "cmocka_headers.h"
+#include "mocks-ibverbs.h"
+#include "mocks-rpma-conn_cfg.h"
+#include "cq-common.h"
+
+#define MOCK_TS_MASK		UINT64_MAX
+#define MOCK_HCA_CORE_CLOCK	2000000 /* kHz */
+#define MOCK_HW_TS		(uint64_t)0x1000
+#define MOCK_HW_TS_NS		(uint64_t)0x800 /* at MOCK_HCA_CORE_CLOCK */
+#define MOCK_WALLCLOCK_NS	(uint64_t)0x16B1A5E0C0FFEE00
+
+#define WC_FLAGS_TS \
+	(IBV_WC_STANDARD_FLAGS | IBV_WC_EX_WITH_COMPLETION_TIMESTAMP)
+#define WC_FLAGS_TS_WALLCLOCK \
+	(WC_FLAGS_TS | IBV_WC_EX_WITH_COMPLETION_TIMESTAMP_WALLCLOCK)
+
+/* the work completion returned by the extended CQ */
+static struct ibv_wc *Wc;
+
+/*
+ * query_device_ex -- ibv_query_device_ex() mock
+ */
+static int
+query_device_ex(struct ibv_context *context,
+		const struct ibv_query_device_ex_input *input,
+		struct ibv_device_attr_ex *attr, size_t attr_size)
+{
+	assert_ptr_equal(context, MOCK_VERBS);
+	assert_null(input);
+	assert_non_null(attr);
+
+	int ret = mock_type(int);
+	if (ret)
+		return ret;
+
+	memset(attr, 0, sizeof(*attr));
+	attr->completion_timestamp_mask = mock_type(uint64_t);
+	attr->hca_core_clock = mock_type(uint64_t);
+
+	return 0;
+}
+
+/*
+ * start_poll -- ibv_start_poll() mock
+ */
+static int
+start_poll(struct ibv_cq_ex *cq, struct ibv_poll_cq_attr *attr)
+{
+	assert_ptr_equal(cq, MOCK_IBV_CQ_EX);
+	assert_non_null(attr);
+
+	int ret = mock_type(int);
+	if (ret)
+		return ret;
+
+	Wc = mock_type(struct ibv_wc *);
+	cq->wr_id = Wc->wr_id;
+	cq->status = Wc->status;
+
+	return 0;
+}
+
+/*
+ * end_poll -- ibv_end_poll() mock
+ */
+static void
+end_poll(struct ibv_cq_ex *cq)
+{
+	assert_ptr_equal(cq, MOCK_IBV_CQ_EX);
+	function_called();
+}
+
+/*
+ * read_opcode -- ibv_wc_read_opcode() mock
+ */
+static enum ibv_wc_opcode
+read_opcode(struct ibv_cq_ex *cq)
+{
+	return Wc->opcode;
+}
+
+/*
+ * read_byte_len -- ibv_wc_read_byte_len() mock
+ */
+static uint32_t
+read_byte_len(struct ibv_cq_ex *cq)
+{
+	return Wc->byte_len;
+}
+
+/*
+ * read_qp_num -- ibv_wc_read_qp_num() mock
+ */
+static uint32_t
+read_qp_num(struct ibv_cq_ex *cq)
+{
+	return Wc->qp_num;
+}
+
+/*
+ * read_wc_flags -- ibv_wc_read_wc_flags() mock
+ */
+static unsigned
+read_wc_flags(struct ibv_cq_ex *cq)
+{
+	return (unsigned)Wc->wc_flags;
+}
+
+/*
+ * read_imm_data -- ibv_wc_read_imm_data() mock
+ */
+static __be32
+read_imm_data(struct ibv_cq_ex *cq)
+{
+	return Wc->imm_data;
+}
+
+/*
+ * read_completion_ts -- ibv_wc_read_completion_ts() mock
+ */
+static uint64_t
+read_completion_ts(struct ibv_cq_ex *cq)
+{
+	return MOCK_HW_TS;
+}
+
+/*
+ * read_completion_wallclock_ns -- ibv_wc_read_completion_wallclock_ns() mock
+ */
+static uint64_t
+read_completion_wallclock_ns(struct ibv_cq_ex *cq)
+{
+	return MOCK_WALLCLOCK_NS;
+}
+
+/*
+ * cq_new_ts -- create a cq object with the timestamps requested
+ */
+static struct rpma_cq *
+cq_new_ts(void)
+{
+	/* configure the rest of the mocks */
+	will_return(ibv_req_notify_cq_mock, MOCK_OK);
+	will_return(__wrap__test_malloc, MOCK_OK);
+
+	/* run test */
+	struct rpma_cq *cq = NULL;
+	int ret = rpma_cq_new(MOCK_VERBS, MOCK_CQ_SIZE_DEFAULT,
+			MOCK_COMP_VECTOR, true /* timestamps */, &cq);
+
+	/* verify the result */
+	assert_int_equal(ret, MOCK_OK);
+	assert_non_null(cq);
+
+	return cq;
+}
+
+/*
+ * setup__cq_new_wallclock -- prepare a cq object timestamping
+ * the completions in the wallclock domain
+ */
+static int
+setup__cq_new_wallclock(void **cq_ptr)
+{
+	/* configure mocks */
+	will_return(ibv_create_comp_channel, MOCK_COMP_CHANNEL);
+	will_return(query_device_ex, MOCK_OK);
+	will_return(query_device_ex, MOCK_TS_MASK);
+	will_return(query_device_ex, MOCK_HCA_CORE_CLOCK);
+	expect_value(ibv_create_cq_ex_mock, wc_flags, WC_FLAGS_TS_WALLCLOCK);
+	will_return(ibv_create_cq_ex_mock, MOCK_IBV_CQ_EX);
+
+	*cq_ptr = cq_new_ts();
+
+	return 0;
+}
+
+/*
+ * setup__cq_new_hw -- prepare a cq object timestamping the completions
+ * using the free-running device clock (no wallclock support)
+ */
+static int
+setup__cq_new_hw(void **cq_ptr)
+{
+	/* configure mocks */
+	will_return(ibv_create_comp_channel, MOCK_COMP_CHANNEL);
+	will_return(query_device_ex, MOCK_OK);
+	will_return(query_device_ex, MOCK_TS_MASK);
+	will_return(query_device_ex, MOCK_HCA_CORE_CLOCK);
+	expect_value(ibv_create_cq_ex_mock, wc_flags, WC_FLAGS_TS_WALLCLOCK);
+	will_return(ibv_create_cq_ex_mock, NULL);
+	will_return(ibv_create_cq_ex_mock, EOPNOTSUPP);
+	expect_value(ibv_create_cq_ex_mock, wc_flags, WC_FLAGS_TS);
+	will_return(ibv_create_cq_ex_mock, MOCK_IBV_CQ_EX);
+
+	*cq_ptr = cq_new_ts();
+
+	return 0;
+}
+
+/*
+ * new__query_device_ex_ERRNO -- ibv_query_device_ex() fails with MOCK_ERRNO
+ * so the completions are timestamped by software
+ */
+static void
+new__query_device_ex_ERRNO(void **unused)
+{
+	/* configure mocks */
+	will_return(ibv_create_comp_channel, MOCK_COMP_CHANNEL);
+	will_return(query_device_ex, MOCK_ERRNO);
+	expect_value(ibv_create_cq, cqe, MOCK_CQ_SIZE_DEFAULT);
+	will_return(ibv_create_cq, MOCK_IBV_CQ);
+
+	/* run test */
+	struct rpma_cq *cq = cq_new_ts();
+
+	/* verify the results */
+	assert_ptr_equal(rpma_cq_get_ibv_cq(cq), MOCK_IBV_CQ);
+
+	/* cleanup */
+	assert_int_equal(teardown__cq_delete((void **)&cq), 0);
+}
+
+/*
+ * new__timestamps_not_supported -- the device does not timestamp
+ * the completions so they are timestamped by software
+ */
+static void
+new__timestamps_not_supported(void **unused)
+{
+	/* configure mocks */
+	will_return(ibv_create_comp_channel, MOCK_COMP_CHANNEL);
+	will_return(query_device_ex, MOCK_OK);
+	will_return(query_device_ex, 0); /* completion_timestamp_mask */
+	will_return(query_device_ex, MOCK_HCA_CORE_CLOCK);
+	expect_value(ibv_create_cq, cqe, MOCK_CQ_SIZE_DEFAULT);
+	will_return(ibv_create_cq, MOCK_IBV_CQ);
+
+	/* run test */
+	struct rpma_cq *cq = cq_new_ts();
+
+	/* verify the results */
+	assert_ptr_equal(rpma_cq_get_ibv_cq(cq), MOCK_IBV_CQ);
+
+	/* cleanup */
+	assert_int_equal(teardown__cq_delete((void **)&cq), 0);
+}
+
+/*
+ * new__create_cq_ex_ERRNO -- ibv_create_cq_ex() fails with MOCK_ERRNO
+ * so the completions are timestamped by software
+ */
+static void
+new__create_cq_ex_ERRNO(void **unused)
+{
+	/* configure mocks */
+	will_return(ibv_create_comp_channel, MOCK_COMP_CHANNEL);
+	will_return(query_device_ex, MOCK_OK);
+	will_return(query_device_ex, MOCK_TS_MASK);
+	will_return(query_device_ex, MOCK_HCA_CORE_CLOCK);
+	expect_value(ibv_create_cq_ex_mock, wc_flags, WC_FLAGS_TS_WALLCLOCK);
+	will_return(ibv_create_cq_ex_mock, NULL);
+	will_return(ibv_create_cq_ex_mock, MOCK_ERRNO);
+	expect_value(ibv_create_cq_ex_mock, wc_flags, WC_FLAGS_TS);
+	will_return(ibv_create_cq_ex_mock, NULL);
+	will_return(ibv_create_cq_ex_mock, MOCK_ERRNO);
+	expect_value(ibv_create_cq, cqe, MOCK_CQ_SIZE_DEFAULT);
+	will_return(ibv_create_cq, MOCK_IBV_CQ);
+
+	/* run test */
+	struct rpma_cq *cq = cq_new_ts();
+
+	/* verify the results */
+	assert_ptr_equal(rpma_cq_get_ibv_cq(cq), MOCK_IBV_CQ);
+
+	/* cleanup */
+	assert_int_equal(teardown__cq_delete((void **)&cq), 0);
+}
+
+/*
+ * new__cq_ex -- the extended CQ is used as the regular one too
+ */
+static void
+new__cq_ex(void **cq_ptr)
+{
+	struct rpma_cq *cq = *cq_ptr;
+
+	/* run test */
+	struct ibv_cq *ibv_cq = rpma_cq_get_ibv_cq(cq);
+
+	/* verify the results */
+	assert_ptr_equal(ibv_cq, ibv_cq_ex_to_cq(MOCK_IBV_CQ_EX));
+}
+
+/*
+ * get_completion_ex__software -- the completion is timestamped by software
+ */
+static void
+get_completion_ex__software(void **cq_ptr)
+{
+	struct rpma_cq *cq = *cq_ptr;
+	struct ibv_wc wc = {0};
+	wc.opcode = IBV_WC_RDMA_READ;
+	wc.wr_id = (uint64_t)MOCK_OP_CONTEXT;
+	wc.byte_len = MOCK_LEN;
+
+	/* configure mocks */
+	expect_value(poll_cq, cq, MOCK_IBV_CQ);
+	will_return(poll_cq, 1);
+	will_return(poll_cq, &wc);
+
+	/* run test */
+	struct rpma_completion_ex cmpl_ex = {0};
+	int ret = rpma_cq_get_completion_ex(cq, &cmpl_ex);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(cmpl_ex.cmpl.op, RPMA_OP_READ);
+	assert_ptr_equal(cmpl_ex.cmpl.op_context, MOCK_OP_CONTEXT);
+	assert_int_equal(cmpl_ex.ts_source, RPMA_COMPLETION_TS_SOFTWARE);
+	assert_int_not_equal(cmpl_ex.polled_ns, 0);
+	assert_int_equal(cmpl_ex.ts_ns, cmpl_ex.polled_ns);
+}
+
+/*
+ * get_completion_ex__software_no_completion -- no completion in the CQ
+ */
+static void
+get_completion_ex__software_no_completion(void **cq_ptr)
+{
+	struct rpma_cq *cq = *cq_ptr;
+
+	/* configure mocks */
+	expect_value(poll_cq, cq, MOCK_IBV_CQ);
+	will_return(poll_cq, 0);
+
+	/* run test */
+	struct rpma_completion_ex cmpl_ex = {0};
+	int ret = rpma_cq_get_completion_ex(cq, &cmpl_ex);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NO_COMPLETION);
+}
+
+/*
+ * get_completion_ex__start_poll_ENOENT -- no completion in the CQ
+ */
+static void
+get_completion_ex__start_poll_ENOENT(void **cq_ptr)
+{
+	struct rpma_cq *cq = *cq_ptr;
+
+	/* configure mocks */
+	will_return(start_poll, ENOENT);
+
+	/* run test */
+	struct rpma_completion_ex cmpl_ex = {0};
+	int ret = rpma_cq_get_completion_ex(cq, &cmpl_ex);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NO_COMPLETION);
+}
+
+/*
+ * get_completion_ex__start_poll_ERRNO -- ibv_start_poll() fails
+ * with MOCK_ERRNO
+ */
+static void
+get_completion_ex__start_poll_ERRNO(void **cq_ptr)
+{
+	struct rpma_cq *cq = *cq_ptr;
+
+	/* configure mocks */
+	will_return(start_poll, MOCK_ERRNO);
+
+	/* run test */
+	struct rpma_completion_ex cmpl_ex = {0};
+	int ret = rpma_cq_get_completion_ex(cq, &cmpl_ex);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+}
+
+/*
+ * get_completion_ex__opcode_IBV_WC_BIND_MW -- the extended CQ returns
+ * IBV_WC_BIND_MW (an unexpected opcode)
+ */
+static void
+get_completion_ex__opcode_IBV_WC_BIND_MW(void **cq_ptr)
+{
+	struct rpma_cq *cq = *cq_ptr;
+	struct ibv_wc wc = {0};
+	wc.opcode = IBV_WC_BIND_MW;
+
+	/* configure mocks */
+	will_return(start_poll, MOCK_OK);
+	will_return(start_poll, &wc);
+	expect_function_call(end_poll);
+
+	/* run test */
+	struct rpma_completion_ex cmpl_ex = {0};
+	int ret = rpma_cq_get_completion_ex(cq, &cmpl_ex);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NOSUPP);
+}
+
+/*
+ * get_completion_ex__wallclock -- the completion is timestamped by
+ * the device in the wallclock domain
+ */
+static void
+get_completion_ex__wallclock(void **cq_ptr)
+{
+	struct rpma_cq *cq = *cq_ptr;
+	struct ibv_wc wc = {0};
+	wc.opcode = IBV_WC_RECV;
+	wc.wr_id = (uint64_t)MOCK_OP_CONTEXT;
+	wc.byte_len = MOCK_LEN;
+	wc.status = MOCK_WC_STATUS;
+	wc.qp_num = MOCK_QP_NUM;
+	/* 'wc_flags' is of 'int' type in older versions of libibverbs. */
+	wc.wc_flags = (typeof(wc.wc_flags))IBV_WC_WITH_IMM;
+	wc.imm_data = htonl(MOCK_IMM_DATA);
+
+	/* configure mocks */
+	will_return(start_poll, MOCK_OK);
+	will_return(start_poll, &wc);
+	expect_function_call(end_poll);
+
+	/* run test */
+	struct rpma_completion_ex cmpl_ex = {0};
+	int ret = rpma_cq_get_completion_ex(cq, &cmpl_ex);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(cmpl_ex.cmpl.op, RPMA_OP_RECV);
+	assert_ptr_equal(cmpl_ex.cmpl.op_context, MOCK_OP_CONTEXT);
+	assert_int_equal(cmpl_ex.cmpl.byte_len, MOCK_LEN);
+	assert_int_equal(cmpl_ex.cmpl.op_status, MOCK_WC_STATUS);
+	assert_int_equal(cmpl_ex.cmpl.qp_num, MOCK_QP_NUM);
+	assert_int_equal(cmpl_ex.cmpl.flags, IBV_WC_WITH_IMM);
+	assert_int_equal(cmpl_ex.cmpl.imm, MOCK_IMM_DATA);
+	assert_int_equal(cmpl_ex.ts_source, RPMA_COMPLETION_TS_HW_WALLCLOCK);
+	assert_int_equal(cmpl_ex.ts_ns, MOCK_WALLCLOCK_NS);
+	assert_int_not_equal(cmpl_ex.polled_ns, 0);
+}
+
+/*
+ * get_completion_ex__hw -- the completion is timestamped using
+ * the free-running device clock
+ */
+static void
+get_completion_ex__hw(void **cq_ptr)
+{
+	struct rpma_cq *cq = *cq_ptr;
+	struct ibv_wc wc = {0};
+	wc.opcode = IBV_WC_RDMA_WRITE;
+	wc.wr_id = (uint64_t)MOCK_OP_CONTEXT;
+
+	/* configure mocks */
+	will_return(start_poll, MOCK_OK);
+	will_return(start_poll, &wc);
+	expect_function_call(end_poll);
+
+	/* run test */
+	struct rpma_completion_ex cmpl_ex = {0};
+	int ret = rpma_cq_get_completion_ex(cq, &cmpl_ex);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(cmpl_ex.cmpl.op, RPMA_OP_WRITE);
+	assert_int_equal(cmpl_ex.ts_source, RPMA_COMPLETION_TS_HW);
+	assert_int_equal(cmpl_ex.ts_ns, MOCK_HW_TS_NS);
+}
+
+/*
+ * poll_cq -- poll_cq() mock
+ */
+static int
+poll_cq(struct ibv_cq *cq, int num_entries, struct ibv_wc *wc)
+{
+	check_expected_ptr(cq);
+	assert_int_equal(num_entries, 1);
+	assert_non_null(wc);
+
+	int result = mock_type(int);
+	if (result != 1)
+		return result;
+
+	struct ibv_wc *wc_ret = mock_type(struct ibv_wc *);
+	memcpy(wc, wc_ret, sizeof(struct ibv_wc));
+
+	return 1;
+}
+
+/*
+ * group_setup_get_completion_ex -- prepare resources for all tests
+ * in the group
+ */
+static int
+group_setup_get_completion_ex(void **unused)
+{
+	/* the extended verbs */
+	MOCK_VERBS->abi_compat = __VERBS_ABI_IS_EXTENDED;
+	Verbs_context.sz = sizeof(struct verbs_context);
+	Verbs_context.query_device_ex = query_device_ex;
+	Verbs_context.create_cq_ex = ibv_create_cq_ex_mock;
+	MOCK_VERBS->ops.poll_cq = poll_cq;
+
+	/* the extended CQ */
+	Ibv_cq_ex.context = MOCK_VERBS;
+	Ibv_cq_ex.start_poll = start_poll;
+	Ibv_cq_ex.end_poll = end_poll;
+	Ibv_cq_ex.read_opcode = read_opcode;
+	Ibv_cq_ex.read_byte_len = read_byte_len;
+	Ibv_cq_ex.read_qp_num = read_qp_num;
+	Ibv_cq_ex.read_wc_flags = read_wc_flags;
+	Ibv_cq_ex.read_imm_data = read_imm_data;
+	Ibv_cq_ex.read_completion_ts = read_completion_ts;
+	Ibv_cq_ex.read_completion_wallclock_ns = read_completion_wallclock_ns;
+
+	return group_setup_common_cq(NULL);
+}
+
+static const struct CMUnitTest tests_get_completion_ex[] = {
+	/* rpma_cq_new() unit tests */
+	cmocka_unit_test(new__query_device_ex_ERRNO),
+	cmocka_unit_test(new__timestamps_not_supported),
+	cmocka_unit_test(new__create_cq_ex_ERRNO),
+	cmocka_unit_test_setup_teardown(new__cq_ex,
+		setup__cq_new_wallclock, teardown__cq_delete),
+
+	/* rpma_cq_get_completion_ex() unit tests */
+	cmocka_unit_test_setup_teardown(get_completion_ex__software,
+		setup__cq_new, teardown__cq_delete),
+	cmocka_unit_test_setup_teardown(
+		get_completion_ex__software_no_completion,
+		setup__cq_new, teardown__cq_delete),
+	cmocka_unit_test_setup_teardown(get_completion_ex__start_poll_ENOENT,
+		setup__cq_new_wallclock, teardown__cq_delete),
+	cmocka_unit_test_setup_teardown(get_completion_ex__start_poll_ERRNO,
+		setup__cq_new_wallclock, teardown__cq_delete),
+	cmocka_unit_test_setup_teardown(
+		get_completion_ex__opcode_IBV_WC_BIND_MW,
+		setup__cq_new_wallclock, teardown__cq_delete),
+	cmocka_unit_test_setup_teardown(get_completion_ex__wallclock,
+		setup__cq_new_wallclock, teardown__cq_delete),
+	cmocka_unit_test_setup_teardown(get_completion_ex__hw,
+		setup__cq_new_hw, teardown__cq_delete),
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_get_completion_ex,
+			group_setup_get_completion_ex, NULL);
+}
@@ -0,0 +1,226 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * cq-get_completions.c -- the rpma_cq_get_completions() unit tests
+ *
+ * API covered:
+ * - rpma_cq_get_completions()
+ */
+
+#include <string.h>
+
+#include "cmocka_headers.h"
+#include "mocks-ibverbs.h"
+#include "cq-common.h"
+
+#define MOCK_NUM_ENTRIES	4
+#define MOCK_OP_CONTEXT_2	(void *)0xC418
+
+/*
+ * poll_cq -- poll_cq() mock
+ */
+static int
+poll_cq(struct ibv_cq *cq, int num_entries, struct ibv_wc *wc)
+{
+	check_expected_ptr(cq);
+	assert_int_equal(num_entries, MOCK_NUM_ENTRIES);
+	assert_non_null(wc);
+
+	int result = mock_type(int);
+	if (result <= 0 || result > num_entries)
+		return result;
+
+	struct ibv_wc *wc_ret = mock_type(struct ibv_wc *);
+	memcpy(wc, wc_ret, (size_t)result * sizeof(struct ibv_wc));
+
+	return result;
+}
+
+/*
+ * get_completions__poll_cq_fail - ibv_poll_cq() returns -1
+ */
+static void
+get_completions__poll_cq_fail(void **cq_ptr)
+{
+	struct rpma_cq *cq = *cq_ptr;
+
+	/* configure mock */
+	expect_value(poll_cq, cq, MOCK_IBV_CQ);
+	will_return(poll_cq, -1);
+
+	/* run test */
+	struct ibv_wc wcs[MOCK_NUM_ENTRIES];
+	struct rpma_completion cmpls[MOCK_NUM_ENTRIES];
+	int num = -1;
+	int ret = rpma_cq_get_completions(cq, wcs, cmpls, MOCK_NUM_ENTRIES,
+			&num);
+
+	/* verify the result */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_int_equal(num, 0);
+}
+
+/*
+ * get_completions__poll_cq_0 - ibv_poll_cq() returns 0 (no data)
+ */
+static void
+get_completions__poll_cq_0(void **cq_ptr)
+{
+	struct rpma_cq *cq = *cq_ptr;
+
+	/* configure mock */
+	expect_value(poll_cq, cq, MOCK_IBV_CQ);
+	will_return(poll_cq, 0);
+
+	/* run test */
+	struct ibv_wc wcs[MOCK_NUM_ENTRIES];
+	struct rpma_completion cmpls[MOCK_NUM_ENTRIES];
+	int num = -1;
+	int ret = rpma_cq_get_completions(cq, wcs, cmpls, MOCK_NUM_ENTRIES,
+			&num);
+
+	/* verify the result */
+	assert_int_equal(ret, RPMA_E_NO_COMPLETION);
+	assert_int_equal(num, 0);
+}
+
+/*
+ * get_completions__poll_cq_too_many - ibv_poll_cq() returns more than
+ * num_entries which is an abnormal situation
+ */
+static void
+get_completions__poll_cq_too_many(void **cq_ptr)
+{
+	struct rpma_cq *cq = *cq_ptr;
+
+	/* configure mock */
+	expect_value(poll_cq, cq, MOCK_IBV_CQ);
+	will_return(poll_cq, MOCK_NUM_ENTRIES + 1);
+
+	/* run test */
+	struct ibv_wc wcs[MOCK_NUM_ENTRIES];
+	struct rpma_completion cmpls[MOCK_NUM_ENTRIES];
+	int num = -1;
+	int ret = rpma_cq_get_completions(cq, wcs, cmpls, MOCK_NUM_ENTRIES,
+			&num);
+
+	/* verify the result */
+	assert_int_equal(ret, RPMA_E_UNKNOWN);
+	assert_int_equal(num, 0);
+}
+
+/*
+ * get_completions__opcode_IBV_WC_BIND_MW - the completion of
+ * an unexpected opcode is dropped from the batch
+ */
+static void
+get_completions__opcode_IBV_WC_BIND_MW(void **cq_ptr)
+{
+	struct rpma_cq *cq = *cq_ptr;
+	struct ibv_wc wcs_ret[3] = {{0}};
+	wcs_ret[0].opcode = IBV_WC_RDMA_READ;
+	wcs_ret[0].wr_id = (uint64_t)MOCK_OP_CONTEXT;
+	wcs_ret[1].opcode = IBV_WC_BIND_MW;
+	wcs_ret[2].opcode = IBV_WC_RDMA_WRITE;
+	wcs_ret[2].wr_id = (uint64_t)MOCK_OP_CONTEXT_2;
+
+	/* configure mock */
+	expect_value(poll_cq, cq, MOCK_IBV_CQ);
+	will_return(poll_cq, 3);
+	will_return(poll_cq, wcs_ret);
+
+	/* run test */
+	struct ibv_wc wcs[MOCK_NUM_ENTRIES];
+	struct rpma_completion cmpls[MOCK_NUM_ENTRIES];
+	int num = -1;
+	int ret = rpma_cq_get_completions(cq, wcs, cmpls, MOCK_NUM_ENTRIES,
+			&num);
+
+	/* verify the result */
+	assert_int_equal(ret, RPMA_E_NOSUPP);
+	assert_int_equal(num, 2);
+	assert_int_equal(cmpls[0].op, RPMA_OP_READ);
+	assert_ptr_equal(cmpls[0].op_context, MOCK_OP_CONTEXT);
+	assert_int_equal(cmpls[1].op, RPMA_OP_WRITE);
+	assert_ptr_equal(cmpls[1].op_context, MOCK_OP_CONTEXT_2);
+}
+
+/*
+ * get_completions__success - a batch of completions is collected
+ * using a single ibv_poll_cq() call
+ */
+static void
+get_completions__success(void **cq_ptr)
+{
+	struct rpma_cq *cq = *cq_ptr;
+	struct ibv_wc wcs_ret[2] = {{0}};
+	wcs_ret[0].opcode = IBV_WC_SEND;
+	wcs_ret[0].wr_id = (uint64_t)MOCK_OP_CONTEXT;
+	wcs_ret[0].status = MOCK_WC_STATUS;
+	wcs_ret[0].qp_num = MOCK_QP_NUM;
+	wcs_ret[1].opcode = IBV_WC_RDMA_READ;
+	wcs_ret[1].wr_id = (uint64_t)MOCK_OP_CONTEXT_2;
+	wcs_ret[1].byte_len = MOCK_LEN;
+	wcs_ret[1].qp_num = MOCK_QP_NUM;
+
+	/* configure mock */
+	expect_value(poll_cq, cq, MOCK_IBV_CQ);
+	will_return(poll_cq, 2);
+	will_return(poll_cq, wcs_ret);
+
+	/* run test */
+	struct ibv_wc wcs[MOCK_NUM_ENTRIES];
+	struct rpma_completion cmpls[MOCK_NUM_ENTRIES];
+	int num = -1;
+	int ret = rpma_cq_get_completions(cq, wcs, cmpls, MOCK_NUM_ENTRIES,
+			&num);
+
+	/* verify the result */
+	assert_int_equal(ret, 0);
+	assert_int_equal(num, 2);
+	assert_int_equal(cmpls[0].op, RPMA_OP_SEND);
+	assert_ptr_equal(cmpls[0].op_context, MOCK_OP_CONTEXT);
+	assert_int_equal(cmpls[0].op_status, MOCK_WC_STATUS);
+	assert_int_equal(cmpls[0].qp_num, MOCK_QP_NUM);
+	assert_int_equal(cmpls[1].op, RPMA_OP_READ);
+	assert_ptr_equal(cmpls[1].op_context, MOCK_OP_CONTEXT_2);
+	assert_int_equal(cmpls[1].byte_len, MOCK_LEN);
+	assert_int_equal(cmpls[1].op_status, IBV_WC_SUCCESS);
+}
+
+/*
+ * group_setup_get_completions -- prepare resources for all tests
+ * in the group
+ */
+static int
+group_setup_get_completions(void **unused)
+{
+	/* set the poll_cq callback in mock of IBV CQ */
+	MOCK_VERBS->ops.poll_cq = poll_cq;
+
+	return group_setup_common_cq(NULL);
+}
+
+static const struct CMUnitTest tests_get_completions[] = {
+	/* rpma_cq_get_completions() unit tests */
+	cmocka_unit_test_setup_teardown(get_completions__poll_cq_fail,
+		setup__cq_new, teardown__cq_delete),
+	cmocka_unit_test_setup_teardown(get_completions__poll_cq_0,
+		setup__cq_new, teardown__cq_delete),
+	cmocka_unit_test_setup_teardown(get_completions__poll_cq_too_many,
+		setup__cq_new, teardown__cq_delete),
+	cmocka_unit_test_setup_teardown(
+		get_completions__opcode_IBV_WC_BIND_MW,
+		setup__cq_new, teardown__cq_delete),
+	cmocka_unit_test_setup_teardown(get_completions__success,
+		setup__cq_new, teardown__cq_delete),
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_get_completions,
+			group_setup_get_completions, NULL);
+}
@@ -31,7 +31,8 @@ new__create_comp_channel_ERRNO(void **unused)
 	will_return(ibv_create_comp_channel, MOCK_ERRNO);
 
 	/* run test */
-	int ret = rpma_cq_new(MOCK_VERBS, MOCK_CQ_SIZE_DEFAULT, &cq);
+	int ret = rpma_cq_new(MOCK_VERBS, MOCK_CQ_SIZE_DEFAULT,
+			MOCK_COMP_VECTOR, false /* timestamps */, &cq);
 
 	/* verify the result */
 	assert_int_equal(ret, RPMA_E_PROVIDER);
@@ -53,7 +54,8 @@ new__create_cq_ERRNO(void **unused)
 	will_return(ibv_destroy_comp_channel, MOCK_OK);
 
 	/* run test */
-	int ret = rpma_cq_new(MOCK_VERBS, MOCK_CQ_SIZE_DEFAULT, &cq);
+	int ret = rpma_cq_new(MOCK_VERBS, MOCK_CQ_SIZE_DEFAULT,
+			MOCK_COMP_VECTOR, false /* timestamps */, &cq);
 
 	/* verify the result */
 	assert_int_equal(ret, RPMA_E_PROVIDER);
@@ -76,7 +78,8 @@ new__create_cq_ERRNO_subsequent_ERRNO2(void **unused)
 	will_return(ibv_destroy_comp_channel, MOCK_ERRNO2);
 
 	/* run test */
-	int ret = rpma_cq_new(MOCK_VERBS, MOCK_CQ_SIZE_DEFAULT, &cq);
+	int ret = rpma_cq_new(MOCK_VERBS, MOCK_CQ_SIZE_DEFAULT,
+			MOCK_COMP_VECTOR, false /* timestamps */, &cq);
 
 	/* verify the result */
 	assert_int_equal(ret, RPMA_E_PROVIDER);
@@ -99,7 +102,8 @@ new__req_notify_cq_ERRNO(void **unused)
 	will_return(ibv_destroy_comp_channel, MOCK_OK);
 
 	/* run test */
-	int ret = rpma_cq_new(MOCK_VERBS, MOCK_CQ_SIZE_DEFAULT, &cq);
+	int ret = rpma_cq_new(MOCK_VERBS, MOCK_CQ_SIZE_DEFAULT,
+			MOCK_COMP_VECTOR, false /* timestamps */, &cq);
 
 	/* verify the result */
 	assert_int_equal(ret, RPMA_E_PROVIDER);
@@ -124,7 +128,8 @@ new__req_notify_cq_ERRNO_subsequent_ERRNO2(void **unused)
 	will_return(ibv_destroy_comp_channel, MOCK_ERRNO2);
 
 	/* run test */
-	int ret = rpma_cq_new(MOCK_VERBS, MOCK_CQ_SIZE_DEFAULT, &cq);
+	int ret = rpma_cq_new(MOCK_VERBS, MOCK_CQ_SIZE_DEFAULT,
+			MOCK_COMP_VECTOR, false /* timestamps */, &cq);
 
 	/* verify the result */
 	assert_int_equal(ret, RPMA_E_PROVIDER);
@@ -148,7 +153,8 @@ new__malloc_ERRNO(void **unused)
 	will_return(ibv_destroy_comp_channel, MOCK_OK);
 
 	/* run test */
-	int ret = rpma_cq_new(MOCK_VERBS, MOCK_CQ_SIZE_DEFAULT, &cq);
+	int ret = rpma_cq_new(MOCK_VERBS, MOCK_CQ_SIZE_DEFAULT,
+			MOCK_COMP_VECTOR, false /* timestamps */, &cq);
 
 	/* verify the result */
 	assert_int_equal(ret, RPMA_E_NOMEM);
@@ -174,7 +180,8 @@ new__malloc_ERRNO_subsequent_ERRNO2(void **unused)
 	will_return(ibv_destroy_comp_channel, MOCK_ERRNO2);
 
 	/* run test */
-	int ret = rpma_cq_new(MOCK_VERBS, MOCK_CQ_SIZE_DEFAULT, &cq);
+	int ret = rpma_cq_new(MOCK_VERBS, MOCK_CQ_SIZE_DEFAULT,
+			MOCK_COMP_VECTOR, false /* timestamps */, &cq);
 
 	/* verify the result */
 	assert_int_equal(ret, RPMA_E_NOMEM);
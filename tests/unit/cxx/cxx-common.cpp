@@ -0,0 +1,368 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * cxx-common.cpp -- the librpma.hpp unit tests' common functions and mocks
+ * of the C API
+ */
+
+#include "cxx-common.hpp"
+
+std::vector<const void *> Posted;
+
+extern "C" {
+
+/*
+ * rpma_peer_new -- rpma_peer_new() mock
+ */
+int
+rpma_peer_new(struct ibv_context *ibv_ctx, struct rpma_peer **peer_ptr)
+{
+	check_expected(ibv_ctx);
+
+	int ret = mock_type(int);
+	if (ret == MOCK_OK)
+		*peer_ptr = MOCK_PEER;
+
+	return ret;
+}
+
+/*
+ * rpma_peer_delete -- rpma_peer_delete() mock
+ */
+int
+rpma_peer_delete(struct rpma_peer **peer_ptr)
+{
+	check_expected(*peer_ptr);
+	*peer_ptr = NULL;
+
+	return MOCK_OK;
+}
+
+/*
+ * rpma_ep_listen -- rpma_ep_listen() mock
+ */
+int
+rpma_ep_listen(struct rpma_peer *peer, const char *addr, const char *port,
+		struct rpma_ep **ep_ptr)
+{
+	assert_ptr_equal(peer, MOCK_PEER);
+	assert_string_equal(addr, MOCK_ADDR);
+	assert_string_equal(port, MOCK_PORT);
+	*ep_ptr = MOCK_EP;
+
+	return MOCK_OK;
+}
+
+/*
+ * rpma_ep_shutdown -- rpma_ep_shutdown() mock
+ */
+int
+rpma_ep_shutdown(struct rpma_ep **ep_ptr)
+{
+	assert_ptr_equal(*ep_ptr, MOCK_EP);
+	*ep_ptr = NULL;
+
+	return MOCK_OK;
+}
+
+/*
+ * rpma_ep_next_conn_req -- rpma_ep_next_conn_req() mock
+ */
+int
+rpma_ep_next_conn_req(struct rpma_ep *ep, const struct rpma_conn_cfg *cfg,
+		struct rpma_conn_req **req_ptr)
+{
+	assert_ptr_equal(ep, MOCK_EP);
+	assert_null(cfg);
+	*req_ptr = MOCK_REQ;
+
+	return MOCK_OK;
+}
+
+/*
+ * rpma_conn_req_new -- rpma_conn_req_new() mock
+ */
+int
+rpma_conn_req_new(struct rpma_peer *peer, const char *addr, const char *port,
+		const struct rpma_conn_cfg *cfg, struct rpma_conn_req **req_ptr)
+{
+	assert_ptr_equal(peer, MOCK_PEER);
+	assert_string_equal(addr, MOCK_ADDR);
+	assert_string_equal(port, MOCK_PORT);
+	assert_null(cfg);
+	*req_ptr = MOCK_REQ;
+
+	return MOCK_OK;
+}
+
+/*
+ * rpma_conn_req_connect -- rpma_conn_req_connect() mock
+ */
+int
+rpma_conn_req_connect(struct rpma_conn_req **req_ptr,
+		const struct rpma_conn_private_data *pdata,
+		struct rpma_conn **conn_ptr)
+{
+	assert_ptr_equal(*req_ptr, MOCK_REQ);
+	assert_null(pdata);
+
+	int ret = mock_type(int);
+	if (ret == MOCK_OK) {
+		*req_ptr = NULL;
+		*conn_ptr = MOCK_CONN;
+	}
+
+	return ret;
+}
+
+/*
+ * rpma_conn_req_delete -- rpma_conn_req_delete() mock
+ */
+int
+rpma_conn_req_delete(struct rpma_conn_req **req_ptr)
+{
+	check_expected(*req_ptr);
+	*req_ptr = NULL;
+
+	return MOCK_OK;
+}
+
+/*
+ * rpma_conn_next_event -- rpma_conn_next_event() mock
+ */
+int
+rpma_conn_next_event(struct rpma_conn *conn, enum rpma_conn_event *event)
+{
+	assert_ptr_equal(conn, MOCK_CONN);
+	*event = mock_type(enum rpma_conn_event);
+
+	return MOCK_OK;
+}
+
+/*
+ * rpma_conn_delete -- rpma_conn_delete() mock
+ */
+int
+rpma_conn_delete(struct rpma_conn **conn_ptr)
+{
+	check_expected(*conn_ptr);
+	*conn_ptr = NULL;
+
+	return MOCK_OK;
+}
+
+/*
+ * rpma_mr_reg -- rpma_mr_reg() mock
+ */
+int
+rpma_mr_reg(struct rpma_peer *peer, void *ptr, size_t size, int usage,
+		struct rpma_mr_local **mr_ptr)
+{
+	assert_ptr_equal(peer, MOCK_PEER);
+	*mr_ptr = MOCK_RPMA_MR_LOCAL;
+
+	return MOCK_OK;
+}
+
+/*
+ * rpma_mr_dereg -- rpma_mr_dereg() mock
+ */
+int
+rpma_mr_dereg(struct rpma_mr_local **mr_ptr)
+{
+	assert_ptr_equal(*mr_ptr, MOCK_RPMA_MR_LOCAL);
+	*mr_ptr = NULL;
+
+	return MOCK_OK;
+}
+
+/*
+ * rpma_mr_remote_from_descriptor -- rpma_mr_remote_from_descriptor() mock
+ */
+int
+rpma_mr_remote_from_descriptor(const void *desc, size_t desc_size,
+		struct rpma_mr_remote **mr_ptr)
+{
+	assert_ptr_equal(desc, MOCK_DESC);
+	assert_int_equal(desc_size, MOCK_DESC_SIZE);
+	*mr_ptr = MOCK_RPMA_MR_REMOTE;
+
+	return MOCK_OK;
+}
+
+/*
+ * rpma_mr_remote_delete -- rpma_mr_remote_delete() mock
+ */
+int
+rpma_mr_remote_delete(struct rpma_mr_remote **mr_ptr)
+{
+	assert_ptr_equal(*mr_ptr, MOCK_RPMA_MR_REMOTE);
+	*mr_ptr = NULL;
+
+	return MOCK_OK;
+}
+
+/*
+ * rpma_read -- rpma_read() mock
+ */
+int
+rpma_read(struct rpma_conn *conn, struct rpma_mr_local *dst,
+		size_t dst_offset, const struct rpma_mr_remote *src,
+		size_t src_offset, size_t len, int flags,
+		const void *op_context)
+{
+	assert_ptr_equal(conn, MOCK_CONN);
+	assert_ptr_equal(dst, MOCK_RPMA_MR_LOCAL);
+	assert_int_equal(dst_offset, MOCK_LOCAL_OFFSET);
+	assert_ptr_equal(src, MOCK_RPMA_MR_REMOTE);
+	assert_int_equal(src_offset, MOCK_REMOTE_OFFSET);
+	assert_int_equal(len, MOCK_LEN);
+	assert_int_equal(flags, RPMA_F_COMPLETION_ALWAYS);
+	assert_non_null(op_context);
+
+	int ret = mock_type(int);
+	if (ret == MOCK_OK)
+		Posted.push_back(op_context);
+
+	return ret;
+}
+
+/*
+ * rpma_write -- rpma_write() mock
+ */
+int
+rpma_write(struct rpma_conn *conn, struct rpma_mr_remote *dst,
+		size_t dst_offset, const struct rpma_mr_local *src,
+		size_t src_offset, size_t len, int flags,
+		const void *op_context)
+{
+	assert_ptr_equal(conn, MOCK_CONN);
+	assert_ptr_equal(dst, MOCK_RPMA_MR_REMOTE);
+	assert_int_equal(dst_offset, MOCK_REMOTE_OFFSET);
+	assert_ptr_equal(src, MOCK_RPMA_MR_LOCAL);
+	assert_int_equal(src_offset, MOCK_LOCAL_OFFSET);
+	assert_int_equal(len, MOCK_LEN);
+	assert_int_equal(flags, RPMA_F_COMPLETION_ALWAYS);
+	Posted.push_back(op_context);
+
+	return MOCK_OK;
+}
+
+/*
+ * rpma_flush -- rpma_flush() mock
+ */
+int
+rpma_flush(struct rpma_conn *conn, struct rpma_mr_remote *dst,
+		size_t dst_offset, size_t len, enum rpma_flush_type type,
+		int flags, const void *op_context)
+{
+	assert_ptr_equal(conn, MOCK_CONN);
+	assert_ptr_equal(dst, MOCK_RPMA_MR_REMOTE);
+	assert_int_equal(dst_offset, MOCK_REMOTE_OFFSET);
+	assert_int_equal(len, MOCK_LEN);
+	assert_int_equal(type, MOCK_FLUSH_TYPE);
+	assert_int_equal(flags, RPMA_F_COMPLETION_ALWAYS);
+	Posted.push_back(op_context);
+
+	return MOCK_OK;
+}
+
+/*
+ * rpma_send -- rpma_send() mock
+ */
+int
+rpma_send(struct rpma_conn *conn, const struct rpma_mr_local *src,
+		size_t offset, size_t len, int flags, const void *op_context)
+{
+	assert_ptr_equal(conn, MOCK_CONN);
+	assert_ptr_equal(src, MOCK_RPMA_MR_LOCAL);
+	assert_int_equal(offset, MOCK_LOCAL_OFFSET);
+	assert_int_equal(len, MOCK_LEN);
+	assert_int_equal(flags, RPMA_F_COMPLETION_ALWAYS);
+	Posted.push_back(op_context);
+
+	return MOCK_OK;
+}
+
+/*
+ * rpma_recv -- rpma_recv() mock
+ */
+int
+rpma_recv(struct rpma_conn *conn, struct rpma_mr_local *dst, size_t offset,
+		size_t len, const void *op_context)
+{
+	assert_ptr_equal(conn, MOCK_CONN);
+	assert_ptr_equal(dst, MOCK_RPMA_MR_LOCAL);
+	assert_int_equal(offset, MOCK_LOCAL_OFFSET);
+	assert_int_equal(len, MOCK_LEN);
+	Posted.push_back(op_context);
+
+	return MOCK_OK;
+}
+
+/*
+ * rpma_conn_completion_get -- rpma_conn_completion_get() mock
+ */
+int
+rpma_conn_completion_get(struct rpma_conn *conn,
+		struct rpma_completion *cmpl)
+{
+	assert_ptr_equal(conn, MOCK_CONN);
+
+	int ret = mock_type(int);
+	if (ret)
+		return ret;
+
+	*cmpl = {};
+	cmpl->op_context = mock_ptr_type(void *);
+	cmpl->op_status = mock_type(enum ibv_wc_status);
+	cmpl->byte_len = MOCK_LEN;
+
+	return MOCK_OK;
+}
+
+/*
+ * rpma_conn_completion_wait -- rpma_conn_completion_wait() mock
+ */
+int
+rpma_conn_completion_wait(struct rpma_conn *conn)
+{
+	assert_ptr_equal(conn, MOCK_CONN);
+
+	return mock_type(int);
+}
+
+} /* extern "C" */
+
+/*
+ * expect_peer_new -- expect rpma_peer_new() returning ret
+ */
+void
+expect_peer_new(int ret)
+{
+	expect_value(rpma_peer_new, ibv_ctx, MOCK_IBV_CTX);
+	will_return(rpma_peer_new, ret);
+}
+
+/*
+ * expect_conn_established -- expect the connection to be connected
+ * and the event to be received
+ */
+void
+expect_conn_established(enum rpma_conn_event event)
+{
+	will_return(rpma_conn_req_connect, MOCK_OK);
+	will_return(rpma_conn_next_event, event);
+}
+
+/*
+ * expect_completion -- expect a completion of the operation
+ */
+void
+expect_completion(const void *op_context, enum ibv_wc_status status)
+{
+	will_return(rpma_conn_completion_get, MOCK_OK);
+	will_return(rpma_conn_completion_get, op_context);
+	will_return(rpma_conn_completion_get, status);
+}
@@ -0,0 +1,34 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * cxx-common.hpp -- the librpma.hpp unit tests' common definitions
+ */
+
+#ifndef CXX_COMMON_HPP
+#define CXX_COMMON_HPP
+
+#include <vector>
+
+#include "cmocka_headers.h"
+#include "test-common.h"
+#include "librpma.hpp"
+
+#define MOCK_IBV_CTX		(struct ibv_context *)0xABC1
+#define MOCK_EP			(struct rpma_ep *)0xAEEF
+#define MOCK_REQ		(struct rpma_conn_req *)0xCFEF
+#define MOCK_RPMA_MR_REMOTE	(struct rpma_mr_remote *)0xC412
+#define MOCK_DESC		(const void *)0xDE5C
+#define MOCK_DESC_SIZE		(size_t)0xDE5D
+#define MOCK_REMOTE_OFFSET	(size_t)0xC414
+#define MOCK_FLUSH_TYPE		RPMA_FLUSH_TYPE_PERSISTENT
+#define MOCK_ADDR		MOCK_IP_ADDRESS
+
+/* the op_contexts of all the posted operations */
+extern std::vector<const void *> Posted;
+
+void expect_peer_new(int ret);
+void expect_conn_established(enum rpma_conn_event event);
+void expect_completion(const void *op_context, enum ibv_wc_status status);
+
+#endif /* CXX_COMMON_HPP */
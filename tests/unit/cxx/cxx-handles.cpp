@@ -0,0 +1,210 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * cxx-handles.cpp -- the librpma.hpp RAII handles unit tests
+ *
+ * APIs covered:
+ * - rpma::peer
+ * - rpma::endpoint
+ * - rpma::conn::connect()
+ */
+
+#include "cxx-common.hpp"
+
+/*
+ * peer__new_ERRNO -- rpma_peer_new() fails with RPMA_E_PROVIDER
+ */
+static void
+peer__new_ERRNO(void **unused)
+{
+	/* configure mocks */
+	expect_peer_new(RPMA_E_PROVIDER);
+
+	/* run test */
+	int ret = MOCK_OK;
+	try {
+		rpma::peer peer(MOCK_IBV_CTX);
+	} catch (const rpma::error &e) {
+		ret = e.code();
+	}
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+}
+
+/*
+ * peer__lifecycle -- the peer is deleted by the destructor
+ */
+static void
+peer__lifecycle(void **unused)
+{
+	/* configure mocks */
+	expect_peer_new(MOCK_OK);
+	expect_value(rpma_peer_delete, *peer_ptr, MOCK_PEER);
+
+	/* run test */
+	rpma::peer peer(MOCK_IBV_CTX);
+
+	/* verify the results */
+	assert_ptr_equal(peer.get(), MOCK_PEER);
+	assert_true(static_cast<bool>(peer));
+}
+
+/*
+ * peer__move -- the peer is deleted only once after being moved
+ */
+static void
+peer__move(void **unused)
+{
+	/* configure mocks */
+	expect_peer_new(MOCK_OK);
+	expect_value(rpma_peer_delete, *peer_ptr, MOCK_PEER);
+
+	/* run test */
+	rpma::peer peer(MOCK_IBV_CTX);
+	rpma::peer moved(std::move(peer));
+	rpma::peer assigned = std::move(moved);
+
+	/* verify the results */
+	assert_false(static_cast<bool>(peer));
+	assert_false(static_cast<bool>(moved));
+	assert_ptr_equal(assigned.get(), MOCK_PEER);
+}
+
+/*
+ * peer__release -- the released peer is not deleted
+ */
+static void
+peer__release(void **unused)
+{
+	/* configure mocks */
+	expect_peer_new(MOCK_OK);
+
+	/* run test */
+	rpma::peer peer(MOCK_IBV_CTX);
+	struct rpma_peer *released = peer.release();
+
+	/* verify the results */
+	assert_ptr_equal(released, MOCK_PEER);
+	assert_null(peer.get());
+}
+
+/*
+ * endpoint__accept -- the connection is accepted and established
+ */
+static void
+endpoint__accept(void **unused)
+{
+	/* configure mocks */
+	expect_peer_new(MOCK_OK);
+	expect_conn_established(RPMA_CONN_ESTABLISHED);
+	expect_value(rpma_conn_delete, *conn_ptr, MOCK_CONN);
+	expect_value(rpma_peer_delete, *peer_ptr, MOCK_PEER);
+
+	/* run test */
+	rpma::peer peer(MOCK_IBV_CTX);
+	rpma::endpoint ep(peer, MOCK_ADDR, MOCK_PORT);
+	rpma::conn conn = ep.accept();
+
+	/* verify the results */
+	assert_ptr_equal(ep.get(), MOCK_EP);
+	assert_ptr_equal(conn.get(), MOCK_CONN);
+}
+
+/*
+ * endpoint__accept_unexpected_event -- the connection is deleted if it
+ * has not been established
+ */
+static void
+endpoint__accept_unexpected_event(void **unused)
+{
+	/* configure mocks */
+	expect_peer_new(MOCK_OK);
+	expect_conn_established(RPMA_CONN_LOST);
+	expect_value(rpma_conn_delete, *conn_ptr, MOCK_CONN);
+	expect_value(rpma_peer_delete, *peer_ptr, MOCK_PEER);
+
+	/* run test */
+	rpma::peer peer(MOCK_IBV_CTX);
+	rpma::endpoint ep(peer, MOCK_ADDR, MOCK_PORT);
+	int ret = MOCK_OK;
+	try {
+		(void) ep.accept();
+	} catch (const rpma::error &e) {
+		ret = e.code();
+	}
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_UNKNOWN);
+}
+
+/*
+ * connect__req_connect_ERRNO -- rpma_conn_req_connect() fails with
+ * RPMA_E_PROVIDER and the request is deleted
+ */
+static void
+connect__req_connect_ERRNO(void **unused)
+{
+	/* configure mocks */
+	expect_peer_new(MOCK_OK);
+	will_return(rpma_conn_req_connect, RPMA_E_PROVIDER);
+	expect_value(rpma_conn_req_delete, *req_ptr, MOCK_REQ);
+	expect_value(rpma_peer_delete, *peer_ptr, MOCK_PEER);
+
+	/* run test */
+	rpma::peer peer(MOCK_IBV_CTX);
+	int ret = MOCK_OK;
+	try {
+		(void) rpma::conn::connect(peer, MOCK_ADDR, MOCK_PORT);
+	} catch (const rpma::error &e) {
+		ret = e.code();
+	}
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+}
+
+/*
+ * connect__success -- the connection is connected and established
+ */
+static void
+connect__success(void **unused)
+{
+	/* configure mocks */
+	expect_peer_new(MOCK_OK);
+	expect_conn_established(RPMA_CONN_ESTABLISHED);
+	expect_value(rpma_conn_delete, *conn_ptr, MOCK_CONN);
+	expect_value(rpma_peer_delete, *peer_ptr, MOCK_PEER);
+
+	/* run test */
+	rpma::peer peer(MOCK_IBV_CTX);
+	rpma::conn conn = rpma::conn::connect(peer, MOCK_ADDR, MOCK_PORT);
+
+	/* verify the results */
+	assert_ptr_equal(conn.get(), MOCK_CONN);
+}
+
+static const struct CMUnitTest tests_handles[] = {
+	/* rpma::peer unit tests */
+	cmocka_unit_test(peer__new_ERRNO),
+	cmocka_unit_test(peer__lifecycle),
+	cmocka_unit_test(peer__move),
+	cmocka_unit_test(peer__release),
+
+	/* rpma::endpoint unit tests */
+	cmocka_unit_test(endpoint__accept),
+	cmocka_unit_test(endpoint__accept_unexpected_event),
+
+	/* rpma::conn::connect() unit tests */
+	cmocka_unit_test(connect__req_connect_ERRNO),
+	cmocka_unit_test(connect__success),
+
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_handles, NULL, NULL);
+}
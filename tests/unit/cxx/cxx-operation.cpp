@@ -0,0 +1,358 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * cxx-operation.cpp -- the librpma.hpp awaitable operations unit tests
+ *
+ * APIs covered:
+ * - rpma::conn::read(), write(), flush(), send() and recv()
+ * - rpma::conn::dispatch()
+ * - rpma::conn::wait()
+ */
+
+#include "cxx-common.hpp"
+
+#define MOCK_TASKS	40 /* more than a single batch */
+
+struct op_test_state {
+	rpma::peer peer{MOCK_IBV_CTX};
+	rpma::mr_local local{peer, nullptr, MOCK_LEN, RPMA_MR_USAGE_READ_DST};
+	rpma::mr_remote remote{MOCK_DESC, MOCK_DESC_SIZE};
+	rpma::conn conn{MOCK_CONN};
+};
+
+/*
+ * setup__ops -- prepare the connection and the memory regions
+ */
+static int
+setup__ops(void **ostate_ptr)
+{
+	/* configure mocks */
+	expect_peer_new(MOCK_OK);
+
+	Posted.clear();
+	*ostate_ptr = new op_test_state;
+
+	return 0;
+}
+
+/*
+ * teardown__ops -- delete the connection and the memory regions
+ */
+static int
+teardown__ops(void **ostate_ptr)
+{
+	/* configure mocks */
+	expect_value(rpma_conn_delete, *conn_ptr, MOCK_CONN);
+	expect_value(rpma_peer_delete, *peer_ptr, MOCK_PEER);
+
+	delete static_cast<op_test_state *>(*ostate_ptr);
+	*ostate_ptr = nullptr;
+
+	return 0;
+}
+
+/*
+ * read_once -- await a single read
+ */
+static rpma::task
+read_once(op_test_state *ostate, struct rpma_completion *cmpl)
+{
+	*cmpl = co_await ostate->conn.read(ostate->local, MOCK_LOCAL_OFFSET,
+		ostate->remote, MOCK_REMOTE_OFFSET, MOCK_LEN);
+}
+
+/*
+ * read__post_ERRNO -- rpma_read() fails with RPMA_E_PROVIDER so
+ * the coroutine is not suspended
+ */
+static void
+read__post_ERRNO(void **ostate_ptr)
+{
+	auto *ostate = static_cast<op_test_state *>(*ostate_ptr);
+
+	/* configure mocks */
+	will_return(rpma_read, RPMA_E_PROVIDER);
+
+	/* run test */
+	struct rpma_completion cmpl = {};
+	rpma::task task = read_once(ostate, &cmpl);
+
+	/* verify the results */
+	assert_true(task.done());
+	int ret = MOCK_OK;
+	try {
+		task.get();
+	} catch (const rpma::error &e) {
+		ret = e.code();
+	}
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_true(Posted.empty());
+}
+
+/*
+ * read__success -- the coroutine is resumed with the completion
+ */
+static void
+read__success(void **ostate_ptr)
+{
+	auto *ostate = static_cast<op_test_state *>(*ostate_ptr);
+
+	/* configure mocks */
+	will_return(rpma_read, MOCK_OK);
+
+	/* run test */
+	struct rpma_completion cmpl = {};
+	rpma::task task = read_once(ostate, &cmpl);
+
+	/* verify the results */
+	assert_false(task.done());
+	assert_int_equal(Posted.size(), 1);
+
+	/* configure mocks */
+	expect_completion(Posted[0], IBV_WC_SUCCESS);
+	will_return(rpma_conn_completion_get, RPMA_E_NO_COMPLETION);
+
+	/* run test */
+	size_t num = ostate->conn.dispatch();
+
+	/* verify the results */
+	assert_int_equal(num, 1);
+	assert_true(task.done());
+	task.get();
+	assert_ptr_equal(cmpl.op_context, Posted[0]);
+	assert_int_equal(cmpl.byte_len, MOCK_LEN);
+}
+
+/*
+ * read__completion_error -- the operation completes with an error status
+ */
+static void
+read__completion_error(void **ostate_ptr)
+{
+	auto *ostate = static_cast<op_test_state *>(*ostate_ptr);
+
+	/* configure mocks */
+	will_return(rpma_read, MOCK_OK);
+	struct rpma_completion cmpl = {};
+	rpma::task task = read_once(ostate, &cmpl);
+	expect_completion(Posted[0], IBV_WC_REM_ACCESS_ERR);
+	will_return(rpma_conn_completion_get, RPMA_E_NO_COMPLETION);
+
+	/* run test */
+	size_t num = ostate->conn.dispatch();
+
+	/* verify the results */
+	assert_int_equal(num, 1);
+	assert_true(task.done());
+	enum ibv_wc_status status = IBV_WC_SUCCESS;
+	try {
+		task.get();
+	} catch (const rpma::completion_error &e) {
+		status = e.status();
+	}
+	assert_int_equal(status, IBV_WC_REM_ACCESS_ERR);
+}
+
+/*
+ * ops_sequence -- await all the other operations one after another
+ */
+static rpma::task
+ops_sequence(op_test_state *ostate)
+{
+	rpma::conn &conn = ostate->conn;
+
+	co_await conn.write(ostate->remote, MOCK_REMOTE_OFFSET, ostate->local,
+		MOCK_LOCAL_OFFSET, MOCK_LEN);
+	co_await conn.flush(ostate->remote, MOCK_REMOTE_OFFSET, MOCK_LEN,
+		MOCK_FLUSH_TYPE);
+	co_await conn.send(ostate->local, MOCK_LOCAL_OFFSET, MOCK_LEN);
+	co_await conn.recv(ostate->local, MOCK_LOCAL_OFFSET, MOCK_LEN);
+}
+
+/*
+ * ops__sequence -- each operation is posted after the previous one
+ * has completed
+ */
+static void
+ops__sequence(void **ostate_ptr)
+{
+	auto *ostate = static_cast<op_test_state *>(*ostate_ptr);
+
+	/* run test */
+	rpma::task task = ops_sequence(ostate);
+
+	for (size_t i = 0; i < 4; ++i) {
+		/* verify the results */
+		assert_false(task.done());
+		assert_int_equal(Posted.size(), i + 1);
+
+		/* configure mocks */
+		expect_completion(Posted[i], IBV_WC_SUCCESS);
+		will_return(rpma_conn_completion_get, RPMA_E_NO_COMPLETION);
+
+		/* run test */
+		assert_int_equal(ostate->conn.dispatch(), 1);
+	}
+
+	/* verify the results */
+	assert_true(task.done());
+	task.get();
+}
+
+/*
+ * dispatch__batches -- the completions are collected up to the limit
+ */
+static void
+dispatch__batches(void **ostate_ptr)
+{
+	auto *ostate = static_cast<op_test_state *>(*ostate_ptr);
+	struct rpma_completion cmpls[MOCK_TASKS];
+	std::vector<rpma::task> tasks;
+
+	/* configure mocks */
+	for (int i = 0; i < MOCK_TASKS; ++i) {
+		will_return(rpma_read, MOCK_OK);
+		tasks.push_back(read_once(ostate, &cmpls[i]));
+	}
+	for (int i = 0; i < RPMA_PROGRESS_BATCH_DEFAULT; ++i)
+		expect_completion(Posted[i], IBV_WC_SUCCESS);
+
+	/* run test */
+	size_t num = ostate->conn.dispatch();
+
+	/* verify the results */
+	assert_int_equal(num, RPMA_PROGRESS_BATCH_DEFAULT);
+	for (int i = 0; i < MOCK_TASKS; ++i)
+		assert_int_equal(tasks[i].done(),
+			i < RPMA_PROGRESS_BATCH_DEFAULT);
+
+	/* configure mocks */
+	for (int i = RPMA_PROGRESS_BATCH_DEFAULT; i < MOCK_TASKS; ++i)
+		expect_completion(Posted[i], IBV_WC_SUCCESS);
+	will_return(rpma_conn_completion_get, RPMA_E_NO_COMPLETION);
+
+	/* run test */
+	num = ostate->conn.dispatch(MOCK_TASKS);
+
+	/* verify the results */
+	assert_int_equal(num, MOCK_TASKS - RPMA_PROGRESS_BATCH_DEFAULT);
+	for (int i = 0; i < MOCK_TASKS; ++i) {
+		assert_true(tasks[i].done());
+		assert_ptr_equal(cmpls[i].op_context, Posted[i]);
+	}
+}
+
+/*
+ * dispatch__completion_get_ERRNO -- rpma_conn_completion_get() fails
+ * after a completion has been collected
+ */
+static void
+dispatch__completion_get_ERRNO(void **ostate_ptr)
+{
+	auto *ostate = static_cast<op_test_state *>(*ostate_ptr);
+	struct rpma_completion cmpls[2];
+
+	/* configure mocks */
+	will_return_count(rpma_read, MOCK_OK, 2);
+	rpma::task task0 = read_once(ostate, &cmpls[0]);
+	rpma::task task1 = read_once(ostate, &cmpls[1]);
+	expect_completion(Posted[0], IBV_WC_SUCCESS);
+	will_return(rpma_conn_completion_get, RPMA_E_PROVIDER);
+
+	/* run test */
+	int ret = MOCK_OK;
+	try {
+		(void) ostate->conn.dispatch();
+	} catch (const rpma::error &e) {
+		ret = e.code();
+	}
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_true(task0.done());
+	assert_false(task1.done());
+}
+
+/*
+ * dispatch__op_context_NULL -- a completion without op_context is skipped
+ */
+static void
+dispatch__op_context_NULL(void **ostate_ptr)
+{
+	auto *ostate = static_cast<op_test_state *>(*ostate_ptr);
+
+	/* configure mocks */
+	expect_completion(NULL, IBV_WC_SUCCESS);
+	will_return(rpma_conn_completion_get, RPMA_E_NO_COMPLETION);
+
+	/* run test */
+	size_t num = ostate->conn.dispatch();
+
+	/* verify the results */
+	assert_int_equal(num, 1);
+}
+
+/*
+ * wait__results -- rpma::conn::wait() reports the availability of
+ * the completions and throws on failure
+ */
+static void
+wait__results(void **ostate_ptr)
+{
+	auto *ostate = static_cast<op_test_state *>(*ostate_ptr);
+
+	/* configure mocks */
+	will_return(rpma_conn_completion_wait, MOCK_OK);
+	will_return(rpma_conn_completion_wait, RPMA_E_NO_COMPLETION);
+	will_return(rpma_conn_completion_wait, RPMA_E_PROVIDER);
+
+	/* run test */
+	bool ret1 = ostate->conn.wait();
+	bool ret2 = ostate->conn.wait();
+	int ret3 = MOCK_OK;
+	try {
+		(void) ostate->conn.wait();
+	} catch (const rpma::error &e) {
+		ret3 = e.code();
+	}
+
+	/* verify the results */
+	assert_true(ret1);
+	assert_false(ret2);
+	assert_int_equal(ret3, RPMA_E_PROVIDER);
+}
+
+static const struct CMUnitTest tests_operation[] = {
+	/* rpma::conn::read() unit tests */
+	cmocka_unit_test_setup_teardown(read__post_ERRNO,
+		setup__ops, teardown__ops),
+	cmocka_unit_test_setup_teardown(read__success,
+		setup__ops, teardown__ops),
+	cmocka_unit_test_setup_teardown(read__completion_error,
+		setup__ops, teardown__ops),
+
+	/* rpma::conn::write(), flush(), send() and recv() unit tests */
+	cmocka_unit_test_setup_teardown(ops__sequence,
+		setup__ops, teardown__ops),
+
+	/* rpma::conn::dispatch() unit tests */
+	cmocka_unit_test_setup_teardown(dispatch__batches,
+		setup__ops, teardown__ops),
+	cmocka_unit_test_setup_teardown(dispatch__completion_get_ERRNO,
+		setup__ops, teardown__ops),
+	cmocka_unit_test_setup_teardown(dispatch__op_context_NULL,
+		setup__ops, teardown__ops),
+
+	/* rpma::conn::wait() unit tests */
+	cmocka_unit_test_setup_teardown(wait__results,
+		setup__ops, teardown__ops),
+
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_operation, NULL, NULL);
+}
@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * fast-common.c -- the fast-path posting unit tests common functions
+ */
+
+#include "fast-common.h"
+
+/*
+ * rpma_fast_post_failed -- rpma_fast_post_failed() mock
+ */
+int
+rpma_fast_post_failed(const struct ibv_send_wr *wr, int err)
+{
+	assert_non_null(wr);
+	check_expected(err);
+
+	return RPMA_E_PROVIDER;
+}
+
+/*
+ * fast_post_send -- ibv_post_send() mock checking also the scatter-gather
+ * element of the operation
+ */
+static int
+fast_post_send(struct ibv_qp *qp, struct ibv_send_wr *wr,
+		struct ibv_send_wr **bad_wr)
+{
+	assert_int_equal(wr->num_sge, 1);
+	assert_int_equal(wr->sg_list->addr,
+			MOCK_LOCAL_ADDR + MOCK_LOCAL_OFFSET);
+	assert_int_equal(wr->sg_list->length, MOCK_LEN);
+	assert_int_equal(wr->sg_list->lkey, MOCK_LKEY);
+
+	return ibv_post_send_mock(qp, wr, bad_wr);
+}
+
+/*
+ * setup__fast -- prepare the fast handles
+ */
+int
+setup__fast(void **fstate_ptr)
+{
+	static struct fast_test_state fstate;
+
+	MOCK_VERBS->ops.post_send = fast_post_send;
+	Ibv_qp.context = MOCK_VERBS;
+
+	fstate.unfenced = 0;
+	fstate.fconn.qp = MOCK_QP;
+	fstate.fconn.unfenced = &fstate.unfenced;
+
+	fstate.local.addr = MOCK_LOCAL_ADDR;
+	fstate.local.size = MOCK_MR_SIZE;
+	fstate.local.key = MOCK_LKEY;
+	fstate.local.reserved = 0;
+
+	fstate.remote.addr = MOCK_REMOTE_ADDR;
+	fstate.remote.size = MOCK_MR_SIZE;
+	fstate.remote.key = MOCK_RKEY;
+	fstate.remote.reserved = 0;
+
+	*fstate_ptr = &fstate;
+
+	return 0;
+}
+
+/*
+ * configure_post_send -- expect the operation between the offsets
+ * MOCK_LOCAL_OFFSET and MOCK_REMOTE_OFFSET to be posted
+ */
+void
+configure_post_send(struct ibv_post_send_mock_args *args,
+		enum ibv_wr_opcode opcode, int ret)
+{
+	args->qp = MOCK_QP;
+	args->opcode = opcode;
+	args->send_flags = IBV_SEND_SIGNALED; /* for RPMA_F_COMPLETION_ALWAYS */
+	args->wr_id = (uint64_t)MOCK_OP_CONTEXT;
+	args->remote_addr = MOCK_REMOTE_ADDR + MOCK_REMOTE_OFFSET;
+	args->rkey = MOCK_RKEY;
+	args->ret = ret;
+	will_return(ibv_post_send_mock, args);
+}
@@ -0,0 +1,36 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * fast-common.h -- the fast-path posting unit tests common definitions
+ */
+
+#ifndef FAST_COMMON_H
+#define FAST_COMMON_H
+
+#include "cmocka_headers.h"
+#include "librpma_fast.h"
+#include "mocks-ibverbs.h"
+#include "test-common.h"
+
+#define MOCK_LOCAL_ADDR		(uint64_t)0x0001020304050607
+#define MOCK_REMOTE_ADDR	(uint64_t)0x0706050403020100
+#define MOCK_MR_SIZE		(uint64_t)0x100000
+#define MOCK_LKEY		(uint32_t)0x10111213
+#define MOCK_RKEY		(uint32_t)0x20212223
+#define MOCK_REMOTE_OFFSET	(size_t)0xC414
+
+/* the fast handles used by all the tests */
+struct fast_test_state {
+	struct rpma_fast_conn fconn;
+	struct rpma_fast_mr local;
+	struct rpma_fast_mr remote;
+	uint32_t unfenced; /* the unfenced domains of the mocked connection */
+};
+
+int setup__fast(void **fstate_ptr);
+
+void configure_post_send(struct ibv_post_send_mock_args *args,
+		enum ibv_wr_opcode opcode, int ret);
+
+#endif /* FAST_COMMON_H */
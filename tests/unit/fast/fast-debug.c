@@ -0,0 +1,134 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * fast-debug.c -- the validation of the fast-path posting functions
+ * compiled in by RPMA_FAST_DEBUG
+ *
+ * APIs covered:
+ * - rpma_fast_read()
+ * - rpma_fast_write()
+ */
+
+#define RPMA_FAST_DEBUG
+
+#include "fast-common.h"
+
+/*
+ * read__invalid_args -- invalid combinations of the arguments
+ */
+static void
+read__invalid_args(void **fstate_ptr)
+{
+	struct fast_test_state *fstate = *fstate_ptr;
+	struct rpma_fast_conn *fc = &fstate->fconn;
+	struct rpma_fast_mr *dst = &fstate->local;
+	struct rpma_fast_mr *src = &fstate->remote;
+
+	/* run test */
+	int ret1 = rpma_fast_read(NULL, dst, 0, src, 0, MOCK_LEN,
+			MOCK_FLAGS, MOCK_OP_CONTEXT);
+	int ret2 = rpma_fast_read(fc, NULL, 0, src, 0, MOCK_LEN,
+			MOCK_FLAGS, MOCK_OP_CONTEXT);
+	int ret3 = rpma_fast_read(fc, dst, 0, NULL, 0, MOCK_LEN,
+			MOCK_FLAGS, MOCK_OP_CONTEXT);
+	int ret4 = rpma_fast_read(fc, dst, 0, src, 0, MOCK_LEN, 0,
+			MOCK_OP_CONTEXT);
+	int ret5 = rpma_fast_read(fc, dst, 0, src, 0,
+			(size_t)UINT32_MAX + 1, MOCK_FLAGS, MOCK_OP_CONTEXT);
+	int ret6 = rpma_fast_read(fc, dst, MOCK_MR_SIZE, src, 0, 1,
+			MOCK_FLAGS, MOCK_OP_CONTEXT);
+	int ret7 = rpma_fast_read(fc, dst, 0, src, MOCK_MR_SIZE, 1,
+			MOCK_FLAGS, MOCK_OP_CONTEXT);
+	int ret8 = rpma_fast_read(fc, dst, 0, src, 0, MOCK_MR_SIZE + 1,
+			MOCK_FLAGS, MOCK_OP_CONTEXT);
+	int ret9 = rpma_fast_read(fc, dst, 0, src, SIZE_MAX, 2,
+			MOCK_FLAGS, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret1, RPMA_E_INVAL);
+	assert_int_equal(ret2, RPMA_E_INVAL);
+	assert_int_equal(ret3, RPMA_E_INVAL);
+	assert_int_equal(ret4, RPMA_E_INVAL);
+	assert_int_equal(ret5, RPMA_E_INVAL);
+	assert_int_equal(ret6, RPMA_E_INVAL);
+	assert_int_equal(ret7, RPMA_E_INVAL);
+	assert_int_equal(ret8, RPMA_E_INVAL);
+	assert_int_equal(ret9, RPMA_E_INVAL);
+	assert_int_equal(fstate->unfenced, 0);
+}
+
+/*
+ * write__invalid_args -- invalid combinations of the arguments
+ */
+static void
+write__invalid_args(void **fstate_ptr)
+{
+	struct fast_test_state *fstate = *fstate_ptr;
+	struct rpma_fast_conn *fc = &fstate->fconn;
+	struct rpma_fast_mr *dst = &fstate->remote;
+	struct rpma_fast_mr *src = &fstate->local;
+
+	/* run test */
+	int ret1 = rpma_fast_write(NULL, dst, 0, src, 0, MOCK_LEN,
+			MOCK_FLAGS, MOCK_OP_CONTEXT);
+	int ret2 = rpma_fast_write(fc, NULL, 0, src, 0, MOCK_LEN,
+			MOCK_FLAGS, MOCK_OP_CONTEXT);
+	int ret3 = rpma_fast_write(fc, dst, 0, NULL, 0, MOCK_LEN,
+			MOCK_FLAGS, MOCK_OP_CONTEXT);
+	int ret4 = rpma_fast_write(fc, dst, 0, src, 0, MOCK_LEN, 0,
+			MOCK_OP_CONTEXT);
+	int ret5 = rpma_fast_write(fc, dst, 0, src, 0,
+			(size_t)UINT32_MAX + 1, MOCK_FLAGS, MOCK_OP_CONTEXT);
+	int ret6 = rpma_fast_write(fc, dst, MOCK_MR_SIZE, src, 0, 1,
+			MOCK_FLAGS, MOCK_OP_CONTEXT);
+	int ret7 = rpma_fast_write(fc, dst, 0, src, MOCK_MR_SIZE, 1,
+			MOCK_FLAGS, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret1, RPMA_E_INVAL);
+	assert_int_equal(ret2, RPMA_E_INVAL);
+	assert_int_equal(ret3, RPMA_E_INVAL);
+	assert_int_equal(ret4, RPMA_E_INVAL);
+	assert_int_equal(ret5, RPMA_E_INVAL);
+	assert_int_equal(ret6, RPMA_E_INVAL);
+	assert_int_equal(ret7, RPMA_E_INVAL);
+}
+
+/*
+ * read__success -- the valid arguments are posted as usual
+ */
+static void
+read__success(void **fstate_ptr)
+{
+	struct fast_test_state *fstate = *fstate_ptr;
+
+	/* configure mocks */
+	struct ibv_post_send_mock_args args;
+	configure_post_send(&args, IBV_WR_RDMA_READ, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_fast_read(&fstate->fconn, &fstate->local,
+			MOCK_LOCAL_OFFSET, &fstate->remote, MOCK_REMOTE_OFFSET,
+			MOCK_LEN, RPMA_F_COMPLETION_ALWAYS, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(fstate->unfenced, UINT32_MAX);
+}
+
+static const struct CMUnitTest tests_debug[] = {
+	/* rpma_fast_read() unit tests */
+	cmocka_unit_test_setup(read__invalid_args, setup__fast),
+	cmocka_unit_test_setup(read__success, setup__fast),
+
+	/* rpma_fast_write() unit tests */
+	cmocka_unit_test_setup(write__invalid_args, setup__fast),
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_debug, NULL, NULL);
+}
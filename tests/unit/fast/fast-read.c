@@ -0,0 +1,93 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * fast-read.c -- rpma_fast_read() unit tests
+ *
+ * API covered:
+ * - rpma_fast_read()
+ */
+
+#include "fast-common.h"
+
+/*
+ * read__post_send_ERRNO -- ibv_post_send() fails with MOCK_ERRNO
+ */
+static void
+read__post_send_ERRNO(void **fstate_ptr)
+{
+	struct fast_test_state *fstate = *fstate_ptr;
+
+	/* configure mocks */
+	struct ibv_post_send_mock_args args;
+	configure_post_send(&args, IBV_WR_RDMA_READ, MOCK_ERRNO);
+	expect_value(rpma_fast_post_failed, err, MOCK_ERRNO);
+
+	/* run test */
+	int ret = rpma_fast_read(&fstate->fconn, &fstate->local,
+			MOCK_LOCAL_OFFSET, &fstate->remote, MOCK_REMOTE_OFFSET,
+			MOCK_LEN, RPMA_F_COMPLETION_ALWAYS, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_int_equal(fstate->unfenced, 0);
+}
+
+/*
+ * read__success -- happy day scenario
+ */
+static void
+read__success(void **fstate_ptr)
+{
+	struct fast_test_state *fstate = *fstate_ptr;
+
+	/* configure mocks */
+	struct ibv_post_send_mock_args args;
+	configure_post_send(&args, IBV_WR_RDMA_READ, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_fast_read(&fstate->fconn, &fstate->local,
+			MOCK_LOCAL_OFFSET, &fstate->remote, MOCK_REMOTE_OFFSET,
+			MOCK_LEN, RPMA_F_COMPLETION_ALWAYS, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	/* the next atomic write has to be fenced in all the domains */
+	assert_int_equal(fstate->unfenced, UINT32_MAX);
+}
+
+/*
+ * read__COMPL_ON_ERROR -- the unsignaled read
+ */
+static void
+read__COMPL_ON_ERROR(void **fstate_ptr)
+{
+	struct fast_test_state *fstate = *fstate_ptr;
+
+	/* configure mocks */
+	struct ibv_post_send_mock_args args;
+	configure_post_send(&args, IBV_WR_RDMA_READ, MOCK_OK);
+	args.send_flags = 0;
+
+	/* run test */
+	int ret = rpma_fast_read(&fstate->fconn, &fstate->local,
+			MOCK_LOCAL_OFFSET, &fstate->remote, MOCK_REMOTE_OFFSET,
+			MOCK_LEN, RPMA_F_COMPLETION_ON_ERROR, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+static const struct CMUnitTest tests_read[] = {
+	/* rpma_fast_read() unit tests */
+	cmocka_unit_test_setup(read__post_send_ERRNO, setup__fast),
+	cmocka_unit_test_setup(read__success, setup__fast),
+	cmocka_unit_test_setup(read__COMPL_ON_ERROR, setup__fast),
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_read, NULL, NULL);
+}
@@ -0,0 +1,92 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * fast-write.c -- rpma_fast_write() unit tests
+ *
+ * API covered:
+ * - rpma_fast_write()
+ */
+
+#include "fast-common.h"
+
+/*
+ * write__post_send_ERRNO -- ibv_post_send() fails with MOCK_ERRNO
+ */
+static void
+write__post_send_ERRNO(void **fstate_ptr)
+{
+	struct fast_test_state *fstate = *fstate_ptr;
+
+	/* configure mocks */
+	struct ibv_post_send_mock_args args;
+	configure_post_send(&args, IBV_WR_RDMA_WRITE, MOCK_ERRNO);
+	expect_value(rpma_fast_post_failed, err, MOCK_ERRNO);
+
+	/* run test */
+	int ret = rpma_fast_write(&fstate->fconn, &fstate->remote,
+			MOCK_REMOTE_OFFSET, &fstate->local, MOCK_LOCAL_OFFSET,
+			MOCK_LEN, RPMA_F_COMPLETION_ALWAYS, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+}
+
+/*
+ * write__success -- happy day scenario
+ */
+static void
+write__success(void **fstate_ptr)
+{
+	struct fast_test_state *fstate = *fstate_ptr;
+
+	/* configure mocks */
+	struct ibv_post_send_mock_args args;
+	configure_post_send(&args, IBV_WR_RDMA_WRITE, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_fast_write(&fstate->fconn, &fstate->remote,
+			MOCK_REMOTE_OFFSET, &fstate->local, MOCK_LOCAL_OFFSET,
+			MOCK_LEN, RPMA_F_COMPLETION_ALWAYS, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	/* a write does not have to be fenced */
+	assert_int_equal(fstate->unfenced, 0);
+}
+
+/*
+ * write__COMPL_ON_ERROR -- the unsignaled write
+ */
+static void
+write__COMPL_ON_ERROR(void **fstate_ptr)
+{
+	struct fast_test_state *fstate = *fstate_ptr;
+
+	/* configure mocks */
+	struct ibv_post_send_mock_args args;
+	configure_post_send(&args, IBV_WR_RDMA_WRITE, MOCK_OK);
+	args.send_flags = 0;
+
+	/* run test */
+	int ret = rpma_fast_write(&fstate->fconn, &fstate->remote,
+			MOCK_REMOTE_OFFSET, &fstate->local, MOCK_LOCAL_OFFSET,
+			MOCK_LEN, RPMA_F_COMPLETION_ON_ERROR, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+static const struct CMUnitTest tests_write[] = {
+	/* rpma_fast_write() unit tests */
+	cmocka_unit_test_setup(write__post_send_ERRNO, setup__fast),
+	cmocka_unit_test_setup(write__success, setup__fast),
+	cmocka_unit_test_setup(write__COMPL_ON_ERROR, setup__fast),
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_write, NULL, NULL);
+}
@@ -39,6 +39,7 @@ init_fini__lifecycle(void **unused)
 	assert_ptr_equal(Rpma_log_function, rpma_log_default_function);
 
 	/* configure mocks, run test & verify the results */
+	expect_function_call(rpma_log_async_fini);
 	expect_function_call(rpma_log_default_fini);
 	rpma_log_fini();
 	assert_ptr_equal(Rpma_log_function, NULL);
@@ -0,0 +1,141 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * set_function.c -- rpma_log_set_function() unit tests
+ */
+
+#include "cmocka_headers.h"
+#include "log_internal.h"
+#include "log_default.h"
+#include "librpma.h"
+#include "test-common.h"
+
+/*
+ * user_function -- a user-defined logging function
+ */
+static void
+user_function(enum rpma_log_level level, const char *file_name,
+	const int line_no, const char *function_name,
+	const char *message_format, ...)
+{
+}
+
+/*
+ * set_function__default -- the default logging function is used
+ */
+static void
+set_function__default(void **unused)
+{
+	/* run test */
+	int ret = rpma_log_set_function(RPMA_LOG_USE_DEFAULT_FUNCTION);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(Rpma_log_function, rpma_log_default_function);
+}
+
+/*
+ * set_function__user -- a user-defined logging function is used
+ */
+static void
+set_function__user(void **unused)
+{
+	/* run test */
+	int ret = rpma_log_set_function(user_function);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(Rpma_log_function, user_function);
+}
+
+/*
+ * set_function__async_start_E_PROVIDER -- rpma_log_async_start() fails
+ * with RPMA_E_PROVIDER
+ */
+static void
+set_function__async_start_E_PROVIDER(void **unused)
+{
+	Rpma_log_function = user_function;
+
+	/* configure mocks */
+	expect_function_call(rpma_log_async_start);
+	will_return(rpma_log_async_start, RPMA_E_PROVIDER);
+
+	/* run test */
+	int ret = rpma_log_set_function(rpma_log_async_function);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_ptr_equal(Rpma_log_function, user_function);
+}
+
+/*
+ * set_function__async -- the asynchronous logging function is used
+ */
+static void
+set_function__async(void **unused)
+{
+	/* configure mocks */
+	expect_function_call(rpma_log_async_start);
+	will_return(rpma_log_async_start, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_log_set_function(rpma_log_async_function);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(Rpma_log_function, rpma_log_async_function);
+}
+
+/*
+ * set_function__async_again -- the formatter thread is not started again
+ * when the asynchronous logging function is already used
+ */
+static void
+set_function__async_again(void **unused)
+{
+	Rpma_log_function = rpma_log_async_function;
+
+	/* run test */
+	int ret = rpma_log_set_function(rpma_log_async_function);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(Rpma_log_function, rpma_log_async_function);
+}
+
+/*
+ * set_function__async_stop -- the formatter thread is stopped when
+ * the asynchronous logging function is replaced
+ */
+static void
+set_function__async_stop(void **unused)
+{
+	Rpma_log_function = rpma_log_async_function;
+
+	/* configure mocks */
+	expect_function_call(rpma_log_async_fini);
+
+	/* run test */
+	int ret = rpma_log_set_function(user_function);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(Rpma_log_function, user_function);
+}
+
+int
+main(int argc, char *argv[])
+{
+	const struct CMUnitTest tests[] = {
+		cmocka_unit_test(set_function__default),
+		cmocka_unit_test(set_function__user),
+		cmocka_unit_test(set_function__async_start_E_PROVIDER),
+		cmocka_unit_test(set_function__async),
+		cmocka_unit_test(set_function__async_again),
+		cmocka_unit_test(set_function__async_stop),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,549 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * log_async-function.c -- the asynchronous logging function unit tests
+ *
+ * APIs covered:
+ * - rpma_log_async_start()
+ * - rpma_log_async_fini()
+ * - rpma_log_async_function()
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "cmocka_headers.h"
+#include "log_async.h"
+#include "log_default.h"
+#include "test-common.h"
+
+#define MOCK_LOG_LEVEL		RPMA_LOG_LEVEL_WARNING
+#define MOCK_FILE_NAME		"foo_bar.c"
+#define MOCK_LINE_NUMBER	199
+#define MOCK_FUNCTION_NAME	"foo_bar()"
+#define MOCK_MESSAGE		"Message"
+#define MOCK_TIME_S		1000
+
+#define WRITES_MAX		64
+#define RING_OVERFLOW		200
+
+struct write {
+	enum rpma_log_level level;
+	const char *file_name;
+	int line_no;
+	const char *function_name;
+	char message[RPMA_LOG_ASYNC_MESSAGE_MAX];
+	int ts_now; /* the time was not provided */
+	time_t ts_sec;
+};
+
+/* the messages written by rpma_log_default_write() */
+static struct {
+	pthread_mutex_t lock;
+	struct write writes[WRITES_MAX];
+	unsigned n;
+	int gate_closed; /* the formatter thread blocks on writing */
+	int entered; /* the formatter thread is blocked on the gate */
+} Written = {.lock = PTHREAD_MUTEX_INITIALIZER};
+
+/* the time returned by clock_gettime() */
+static time_t Mock_time_s = MOCK_TIME_S;
+
+/* the logging thread blocks on taking the time of its message */
+static struct {
+	int closed;
+	int entered;
+} Clock_gate;
+
+/* the thread is stopped by Clock_gate */
+static __thread int Gated;
+
+/*
+ * __wrap_clock_gettime -- clock_gettime() mock
+ */
+int
+__wrap_clock_gettime(clockid_t clk_id, struct timespec *tp)
+{
+	if (Gated && __atomic_load_n(&Clock_gate.closed, __ATOMIC_ACQUIRE)) {
+		__atomic_store_n(&Clock_gate.entered, 1, __ATOMIC_RELEASE);
+		while (__atomic_load_n(&Clock_gate.closed, __ATOMIC_ACQUIRE))
+			;
+	}
+
+	tp->tv_sec = __atomic_load_n(&Mock_time_s, __ATOMIC_ACQUIRE);
+	tp->tv_nsec = 0;
+
+	return 0;
+}
+
+/*
+ * rpma_log_default_write -- rpma_log_default_write() mock
+ */
+void
+rpma_log_default_write(enum rpma_log_level level, const char *file_name,
+	const int line_no, const char *function_name, const char *message,
+	const struct timespec *ts)
+{
+	if (ts && __atomic_load_n(&Written.gate_closed, __ATOMIC_ACQUIRE)) {
+		__atomic_store_n(&Written.entered, 1, __ATOMIC_RELEASE);
+		while (__atomic_load_n(&Written.gate_closed, __ATOMIC_ACQUIRE))
+			;
+	}
+
+	pthread_mutex_lock(&Written.lock);
+	if (Written.n < WRITES_MAX) {
+		struct write *w = &Written.writes[Written.n];
+		w->level = level;
+		w->file_name = file_name;
+		w->line_no = line_no;
+		w->function_name = function_name;
+		(void) snprintf(w->message, sizeof(w->message), "%s", message);
+		w->ts_now = (ts == NULL);
+		w->ts_sec = ts ? ts->tv_sec : 0;
+	}
+	Written.n++;
+	pthread_mutex_unlock(&Written.lock);
+}
+
+/*
+ * written_n -- get the number of the written messages
+ */
+static unsigned
+written_n(void)
+{
+	pthread_mutex_lock(&Written.lock);
+	unsigned n = Written.n;
+	pthread_mutex_unlock(&Written.lock);
+
+	return n;
+}
+
+/*
+ * log_at_site -- log the message always from the same call site
+ */
+static void
+log_at_site(const char *message)
+{
+	rpma_log_async_function(MOCK_LOG_LEVEL, MOCK_FILE_NAME,
+		MOCK_LINE_NUMBER, MOCK_FUNCTION_NAME, "%s\n", message);
+}
+
+/*
+ * setup__written -- reset the written messages and the time
+ */
+static int
+setup__written(void **unused)
+{
+	Written.n = 0;
+	Written.gate_closed = 0;
+	Written.entered = 0;
+	Mock_time_s = MOCK_TIME_S;
+	Clock_gate.closed = 0;
+	Clock_gate.entered = 0;
+
+	return 0;
+}
+
+/*
+ * setup__start -- start the formatter thread
+ */
+static int
+setup__start(void **unused)
+{
+	setup__written(NULL);
+
+	assert_int_equal(rpma_log_async_start(), MOCK_OK);
+
+	return 0;
+}
+
+/*
+ * function__not_started -- the message is written directly if the formatter
+ * thread is not running
+ */
+static void
+function__not_started(void **unused)
+{
+	/* run test */
+	log_at_site(MOCK_MESSAGE);
+
+	/* verify the results */
+	assert_int_equal(written_n(), 1);
+	struct write *w = &Written.writes[0];
+	assert_int_equal(w->level, MOCK_LOG_LEVEL);
+	assert_string_equal(w->file_name, MOCK_FILE_NAME);
+	assert_int_equal(w->line_no, MOCK_LINE_NUMBER);
+	assert_string_equal(w->function_name, MOCK_FUNCTION_NAME);
+	assert_string_equal(w->message, MOCK_MESSAGE "\n");
+	assert_true(w->ts_now);
+}
+
+/*
+ * start__twice -- the formatter thread is started only once
+ */
+static void
+start__twice(void **unused)
+{
+	/* run test */
+	int ret = rpma_log_async_start();
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+
+	/* cleanup */
+	rpma_log_async_fini();
+	rpma_log_async_fini();
+}
+
+/*
+ * function__async -- the message is written by the formatter thread with
+ * the time it was logged at
+ */
+static void
+function__async(void **unused)
+{
+	/* run test */
+	log_at_site(MOCK_MESSAGE);
+	Mock_time_s = MOCK_TIME_S + 100;
+	rpma_log_async_fini();
+
+	/* verify the results */
+	assert_int_equal(written_n(), 1);
+	struct write *w = &Written.writes[0];
+	assert_int_equal(w->level, MOCK_LOG_LEVEL);
+	assert_string_equal(w->file_name, MOCK_FILE_NAME);
+	assert_int_equal(w->line_no, MOCK_LINE_NUMBER);
+	assert_string_equal(w->function_name, MOCK_FUNCTION_NAME);
+	assert_string_equal(w->message, MOCK_MESSAGE "\n");
+	assert_false(w->ts_now);
+	assert_int_equal(w->ts_sec, MOCK_TIME_S);
+}
+
+/*
+ * function__fatal -- the fatal message is written directly
+ */
+static void
+function__fatal(void **unused)
+{
+	/* run test */
+	rpma_log_async_function(RPMA_LOG_LEVEL_FATAL, MOCK_FILE_NAME,
+		MOCK_LINE_NUMBER, MOCK_FUNCTION_NAME, MOCK_MESSAGE);
+
+	/* verify the results */
+	assert_int_equal(written_n(), 1);
+	assert_int_equal(Written.writes[0].level, RPMA_LOG_LEVEL_FATAL);
+	assert_true(Written.writes[0].ts_now);
+
+	/* cleanup */
+	rpma_log_async_fini();
+}
+
+/*
+ * function__ring_full -- the messages which do not fit in the ring are
+ * dropped and counted
+ */
+static void
+function__ring_full(void **unused)
+{
+	char expected[64];
+
+	/* block the formatter thread on writing the first message */
+	__atomic_store_n(&Written.gate_closed, 1, __ATOMIC_RELEASE);
+	log_at_site(MOCK_MESSAGE);
+	while (!__atomic_load_n(&Written.entered, __ATOMIC_ACQUIRE))
+		;
+
+	/* run test */
+	for (int i = 0; i < RING_OVERFLOW; ++i)
+		log_at_site(MOCK_MESSAGE);
+
+	__atomic_store_n(&Written.gate_closed, 0, __ATOMIC_RELEASE);
+	rpma_log_async_fini();
+
+	/* verify the results */
+	(void) snprintf(expected, sizeof(expected), "%d message(s) dropped\n",
+		RING_OVERFLOW - (RPMA_LOG_ASYNC_RING_SIZE - 1));
+
+	unsigned n = written_n();
+	int found = 0;
+	for (unsigned i = 0; i < n && i < WRITES_MAX; ++i) {
+		if (strcmp(Written.writes[i].message, expected) == 0) {
+			assert_int_equal(Written.writes[i].level,
+				RPMA_LOG_LEVEL_WARNING);
+			found = 1;
+		}
+	}
+	assert_true(found);
+}
+
+/*
+ * function__rate_limited -- only RPMA_LOG_ASYNC_RATE_BURST messages coming
+ * from the same call site are written in a single window
+ */
+static void
+function__rate_limited(void **unused)
+{
+	char expected[64];
+
+	/* run test */
+	for (int i = 0; i < RPMA_LOG_ASYNC_RATE_BURST + 5; ++i)
+		log_at_site(MOCK_MESSAGE);
+
+	/* all of the above are processed when the marker is written */
+	rpma_log_async_function(MOCK_LOG_LEVEL, MOCK_FILE_NAME,
+		MOCK_LINE_NUMBER + 1, MOCK_FUNCTION_NAME, "Marker\n");
+	while (written_n() < RPMA_LOG_ASYNC_RATE_BURST + 1)
+		;
+
+	/* the next window */
+	Mock_time_s = MOCK_TIME_S + RPMA_LOG_ASYNC_RATE_WINDOW_S;
+	log_at_site("Last");
+
+	rpma_log_async_fini();
+
+	/* verify the results */
+	assert_int_equal(written_n(), RPMA_LOG_ASYNC_RATE_BURST + 3);
+	for (int i = 0; i < RPMA_LOG_ASYNC_RATE_BURST; ++i)
+		assert_string_equal(Written.writes[i].message,
+			MOCK_MESSAGE "\n");
+
+	struct write *w = &Written.writes[RPMA_LOG_ASYNC_RATE_BURST];
+	assert_string_equal(w->message, "Marker\n");
+
+	w = &Written.writes[RPMA_LOG_ASYNC_RATE_BURST + 1];
+	(void) snprintf(expected, sizeof(expected),
+		"%d similar message(s) suppressed\n", 5);
+	assert_string_equal(w->message, expected);
+	assert_string_equal(w->file_name, MOCK_FILE_NAME);
+	assert_int_equal(w->line_no, MOCK_LINE_NUMBER);
+
+	w = &Written.writes[RPMA_LOG_ASYNC_RATE_BURST + 2];
+	assert_string_equal(w->message, "Last\n");
+}
+
+/*
+ * function__suppressed_at_fini -- the number of the suppressed messages is
+ * written when the formatter thread stops
+ */
+static void
+function__suppressed_at_fini(void **unused)
+{
+	/* run test */
+	for (int i = 0; i < RPMA_LOG_ASYNC_RATE_BURST + 1; ++i)
+		log_at_site(MOCK_MESSAGE);
+
+	rpma_log_async_fini();
+
+	/* verify the results */
+	assert_int_equal(written_n(), RPMA_LOG_ASYNC_RATE_BURST + 1);
+	assert_string_equal(Written.writes[RPMA_LOG_ASYNC_RATE_BURST].message,
+		"1 similar message(s) suppressed\n");
+}
+
+/*
+ * thread_log -- log a single message and exit
+ */
+static void *
+thread_log(void *arg)
+{
+	log_at_site(MOCK_MESSAGE);
+
+	return NULL;
+}
+
+/*
+ * function__thread_exited -- the message logged by a thread which has
+ * already exited is written
+ */
+static void
+function__thread_exited(void **unused)
+{
+	pthread_t thread;
+
+	/* run test */
+	assert_int_equal(pthread_create(&thread, NULL, thread_log, NULL), 0);
+	assert_int_equal(pthread_join(thread, NULL), 0);
+	rpma_log_async_fini();
+
+	/* verify the results */
+	assert_int_equal(written_n(), 1);
+	assert_false(Written.writes[0].ts_now);
+}
+
+/*
+ * thread_log_gated -- log a single message stopped by Clock_gate
+ */
+static void *
+thread_log_gated(void *arg)
+{
+	Gated = 1;
+	log_at_site(MOCK_MESSAGE);
+
+	return NULL;
+}
+
+/*
+ * thread_fini -- stop the asynchronous logging
+ */
+static void *
+thread_fini(void *arg)
+{
+	int *done = arg;
+
+	rpma_log_async_fini();
+	__atomic_store_n(done, 1, __ATOMIC_RELEASE);
+
+	return NULL;
+}
+
+/*
+ * fini__waits_for_logging -- rpma_log_async_fini() waits for the thread
+ * which is putting its message into the ring and writes the message
+ */
+static void
+fini__waits_for_logging(void **unused)
+{
+	struct timespec delay = {0, RPMA_LOG_ASYNC_IDLE_NS};
+	pthread_t logging;
+	pthread_t stopping;
+	int done = 0;
+
+	/* stop the logging thread in the middle of logging */
+	__atomic_store_n(&Clock_gate.closed, 1, __ATOMIC_RELEASE);
+	assert_int_equal(pthread_create(&logging, NULL, thread_log_gated,
+		NULL), 0);
+	while (!__atomic_load_n(&Clock_gate.entered, __ATOMIC_ACQUIRE))
+		;
+
+	/* run test */
+	assert_int_equal(pthread_create(&stopping, NULL, thread_fini, &done),
+		0);
+	(void) nanosleep(&delay, NULL);
+	assert_false(__atomic_load_n(&done, __ATOMIC_ACQUIRE));
+
+	__atomic_store_n(&Clock_gate.closed, 0, __ATOMIC_RELEASE);
+	assert_int_equal(pthread_join(stopping, NULL), 0);
+	assert_int_equal(pthread_join(logging, NULL), 0);
+
+	/* verify the results */
+	assert_true(done);
+	assert_int_equal(written_n(), 1);
+	assert_string_equal(Written.writes[0].message, MOCK_MESSAGE "\n");
+	assert_false(Written.writes[0].ts_now);
+}
+
+/*
+ * thread_log_twice -- log a message before and after the restart
+ */
+static void *
+thread_log_twice(void *arg)
+{
+	int *step = arg;
+
+	log_at_site("First");
+	__atomic_store_n(step, 1, __ATOMIC_RELEASE);
+	while (__atomic_load_n(step, __ATOMIC_ACQUIRE) != 2)
+		;
+	log_at_site("Second");
+
+	return NULL;
+}
+
+/*
+ * fini__ring_renewed -- the ring of a thread still running is freed by
+ * rpma_log_async_fini() and the thread gets a new one after the restart
+ */
+static void
+fini__ring_renewed(void **unused)
+{
+	pthread_t thread;
+	int step = 0;
+
+	assert_int_equal(pthread_create(&thread, NULL, thread_log_twice,
+		&step), 0);
+	while (__atomic_load_n(&step, __ATOMIC_ACQUIRE) != 1)
+		;
+
+	/* run test */
+	rpma_log_async_fini();
+	assert_int_equal(written_n(), 1);
+	assert_int_equal(rpma_log_async_start(), MOCK_OK);
+	__atomic_store_n(&step, 2, __ATOMIC_RELEASE);
+	assert_int_equal(pthread_join(thread, NULL), 0);
+	rpma_log_async_fini();
+
+	/* verify the results */
+	assert_int_equal(written_n(), 2);
+	assert_string_equal(Written.writes[0].message, "First\n");
+	assert_string_equal(Written.writes[1].message, "Second\n");
+	assert_false(Written.writes[1].ts_now);
+}
+
+/*
+ * thread_log_and_wait -- log a message and exit when it is allowed to
+ */
+static void *
+thread_log_and_wait(void *arg)
+{
+	int *step = arg;
+
+	log_at_site(MOCK_MESSAGE);
+	__atomic_store_n(step, 1, __ATOMIC_RELEASE);
+	while (__atomic_load_n(step, __ATOMIC_ACQUIRE) != 2)
+		;
+
+	return NULL;
+}
+
+/*
+ * fini__thread_exits_after -- a thread which has logged exits after
+ * rpma_log_async_fini() without touching its already freed ring
+ */
+static void
+fini__thread_exits_after(void **unused)
+{
+	pthread_t thread;
+	int step = 0;
+
+	assert_int_equal(pthread_create(&thread, NULL, thread_log_and_wait,
+		&step), 0);
+	while (__atomic_load_n(&step, __ATOMIC_ACQUIRE) != 1)
+		;
+
+	/* run test */
+	rpma_log_async_fini();
+	__atomic_store_n(&step, 2, __ATOMIC_RELEASE);
+	assert_int_equal(pthread_join(thread, NULL), 0);
+
+	/* the restarted formatter does not find any orphaned ring */
+	assert_int_equal(rpma_log_async_start(), MOCK_OK);
+	rpma_log_async_fini();
+
+	/* verify the results */
+	assert_int_equal(written_n(), 1);
+	assert_string_equal(Written.writes[0].message, MOCK_MESSAGE "\n");
+}
+
+static const struct CMUnitTest tests_function[] = {
+	cmocka_unit_test_setup(function__not_started, setup__written),
+	cmocka_unit_test_setup(start__twice, setup__start),
+	cmocka_unit_test_setup(function__async, setup__start),
+	cmocka_unit_test_setup(function__fatal, setup__start),
+	cmocka_unit_test_setup(function__ring_full, setup__start),
+	cmocka_unit_test_setup(function__rate_limited, setup__start),
+	cmocka_unit_test_setup(function__suppressed_at_fini, setup__start),
+	cmocka_unit_test_setup(function__thread_exited, setup__start),
+	cmocka_unit_test_setup(fini__waits_for_logging, setup__start),
+	cmocka_unit_test_setup(fini__ring_renewed, setup__start),
+	cmocka_unit_test_setup(fini__thread_exits_after, setup__start),
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_function, NULL, NULL);
+}
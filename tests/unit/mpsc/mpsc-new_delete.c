@@ -0,0 +1,160 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * mpsc-new_delete.c -- the ring new/delete unit tests
+ *
+ * APIs covered:
+ * - rpma_mpsc_new()
+ * - rpma_mpsc_delete()
+ * - rpma_mpsc_get_size()
+ */
+
+#include "cmocka_headers.h"
+#include "librpma.h"
+#include "mpsc.h"
+#include "test-common.h"
+
+#define MOCK_RING_SIZE		5
+#define MOCK_ENTRY_SIZE		24
+
+/*
+ * new__size_0 -- size == 0 is invalid
+ */
+static void
+new__size_0(void **unused)
+{
+	/* run test */
+	struct rpma_mpsc *ring = NULL;
+	int ret = rpma_mpsc_new(0, MOCK_ENTRY_SIZE, &ring);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+	assert_null(ring);
+}
+
+/*
+ * new__entry_size_0 -- entry_size == 0 is invalid
+ */
+static void
+new__entry_size_0(void **unused)
+{
+	/* run test */
+	struct rpma_mpsc *ring = NULL;
+	int ret = rpma_mpsc_new(MOCK_RING_SIZE, 0, &ring);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+	assert_null(ring);
+}
+
+/*
+ * new__ring_ptr_NULL -- NULL ring_ptr is invalid
+ */
+static void
+new__ring_ptr_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_mpsc_new(MOCK_RING_SIZE, MOCK_ENTRY_SIZE, NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * new__malloc_ERRNO -- malloc() fails at each of the allocations
+ */
+static void
+new__malloc_ERRNO(void **unused)
+{
+	for (int failing = 0; failing < 3; ++failing) {
+		/* configure mocks */
+		for (int i = 0; i < failing; ++i)
+			will_return(__wrap__test_malloc, MOCK_OK);
+		will_return(__wrap__test_malloc, ENOMEM);
+
+		/* run test */
+		struct rpma_mpsc *ring = NULL;
+		int ret = rpma_mpsc_new(MOCK_RING_SIZE, MOCK_ENTRY_SIZE, &ring);
+
+		/* verify the results */
+		assert_int_equal(ret, RPMA_E_NOMEM);
+		assert_null(ring);
+	}
+}
+
+/*
+ * delete__ring_ptr_NULL -- NULL ring_ptr is invalid
+ */
+static void
+delete__ring_ptr_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_mpsc_delete(NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * delete__ring_NULL -- NULL ring is valid - quick exit
+ */
+static void
+delete__ring_NULL(void **unused)
+{
+	/* run test */
+	struct rpma_mpsc *ring = NULL;
+	int ret = rpma_mpsc_delete(&ring);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * new_delete__lifecycle -- happy day scenario (the size is rounded up to
+ * the power of 2)
+ */
+static void
+new_delete__lifecycle(void **unused)
+{
+	/* configure mocks */
+	will_return_count(__wrap__test_malloc, MOCK_OK, 3);
+
+	/* run test */
+	struct rpma_mpsc *ring = NULL;
+	int ret = rpma_mpsc_new(MOCK_RING_SIZE, MOCK_ENTRY_SIZE, &ring);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_non_null(ring);
+	assert_int_equal(rpma_mpsc_get_size(ring), 8);
+
+	/* run test */
+	ret = rpma_mpsc_delete(&ring);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_null(ring);
+}
+
+static const struct CMUnitTest tests_new_delete[] = {
+	/* rpma_mpsc_new() unit tests */
+	cmocka_unit_test(new__size_0),
+	cmocka_unit_test(new__entry_size_0),
+	cmocka_unit_test(new__ring_ptr_NULL),
+	cmocka_unit_test(new__malloc_ERRNO),
+
+	/* rpma_mpsc_delete() unit tests */
+	cmocka_unit_test(delete__ring_ptr_NULL),
+	cmocka_unit_test(delete__ring_NULL),
+
+	/* rpma_mpsc_new()/_delete() lifecycle */
+	cmocka_unit_test(new_delete__lifecycle),
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_new_delete, NULL, NULL);
+}
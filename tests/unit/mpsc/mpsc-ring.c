@@ -0,0 +1,219 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * mpsc-ring.c -- the ring operations unit tests
+ *
+ * APIs covered:
+ * - rpma_mpsc_reserve()
+ * - rpma_mpsc_publish()
+ * - rpma_mpsc_consume()
+ * - rpma_mpsc_is_empty()
+ * - rpma_mpsc_complete()
+ * - rpma_mpsc_is_completed()
+ * - rpma_mpsc_release()
+ */
+
+#include "cmocka_headers.h"
+#include "librpma.h"
+#include "mpsc.h"
+#include "test-common.h"
+
+#define RING_SIZE	4
+
+/*
+ * setup__mpsc_new -- create a ring of RING_SIZE integers
+ */
+static int
+setup__mpsc_new(void **ring_ptr)
+{
+	will_return_count(__wrap__test_malloc, MOCK_OK, 3);
+
+	struct rpma_mpsc *ring = NULL;
+	int ret = rpma_mpsc_new(RING_SIZE, sizeof(int), &ring);
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(rpma_mpsc_get_size(ring), RING_SIZE);
+
+	*ring_ptr = ring;
+
+	return 0;
+}
+
+/*
+ * teardown__mpsc_delete -- delete the ring
+ */
+static int
+teardown__mpsc_delete(void **ring_ptr)
+{
+	struct rpma_mpsc *ring = *ring_ptr;
+
+	int ret = rpma_mpsc_delete(&ring);
+	assert_int_equal(ret, MOCK_OK);
+
+	return 0;
+}
+
+/*
+ * consume__empty -- nothing to consume from the new ring
+ */
+static void
+consume__empty(void **ring_ptr)
+{
+	struct rpma_mpsc *ring = *ring_ptr;
+	uint64_t pos;
+
+	/* run test */
+	assert_true(rpma_mpsc_is_empty(ring));
+	void *entry = rpma_mpsc_consume(ring, &pos);
+
+	/* verify the results */
+	assert_null(entry);
+}
+
+/*
+ * consume__not_published -- a reserved but not published entry cannot be
+ * consumed
+ */
+static void
+consume__not_published(void **ring_ptr)
+{
+	struct rpma_mpsc *ring = *ring_ptr;
+	uint64_t pos, pos_c;
+
+	/* run test */
+	int *entry = rpma_mpsc_reserve(ring, &pos);
+	assert_non_null(entry);
+	assert_true(rpma_mpsc_is_empty(ring));
+	assert_null(rpma_mpsc_consume(ring, &pos_c));
+
+	/* publishing makes it visible */
+	*entry = 1;
+	rpma_mpsc_publish(ring, pos);
+	assert_false(rpma_mpsc_is_empty(ring));
+	entry = rpma_mpsc_consume(ring, &pos_c);
+
+	/* verify the results */
+	assert_non_null(entry);
+	assert_int_equal(pos_c, pos);
+	assert_int_equal(*entry, 1);
+	rpma_mpsc_release(ring, pos_c);
+}
+
+/*
+ * reserve__full -- no entry can be reserved when all of them are in use
+ */
+static void
+reserve__full(void **ring_ptr)
+{
+	struct rpma_mpsc *ring = *ring_ptr;
+	uint64_t pos[RING_SIZE];
+	uint64_t pos_x;
+
+	for (int i = 0; i < RING_SIZE; ++i) {
+		assert_non_null(rpma_mpsc_reserve(ring, &pos[i]));
+		assert_int_equal(pos[i], i);
+	}
+
+	/* run test */
+	void *entry = rpma_mpsc_reserve(ring, &pos_x);
+
+	/* verify the results */
+	assert_null(entry);
+
+	/* releasing one entry makes room for the next one */
+	rpma_mpsc_publish(ring, pos[0]);
+	assert_non_null(rpma_mpsc_consume(ring, &pos_x));
+	rpma_mpsc_release(ring, pos_x);
+	assert_non_null(rpma_mpsc_reserve(ring, &pos_x));
+	assert_int_equal(pos_x, RING_SIZE);
+}
+
+/*
+ * ring__fifo -- entries are consumed in the order of reservation
+ * regardless of the order of publishing over a few laps
+ */
+static void
+ring__fifo(void **ring_ptr)
+{
+	struct rpma_mpsc *ring = *ring_ptr;
+	uint64_t pos[2];
+	uint64_t pos_c;
+
+	for (int lap = 0; lap < 3 * RING_SIZE; ++lap) {
+		int *e0 = rpma_mpsc_reserve(ring, &pos[0]);
+		int *e1 = rpma_mpsc_reserve(ring, &pos[1]);
+		assert_non_null(e0);
+		assert_non_null(e1);
+		*e0 = 2 * lap;
+		*e1 = 2 * lap + 1;
+
+		/* the second one is published first */
+		rpma_mpsc_publish(ring, pos[1]);
+		assert_null(rpma_mpsc_consume(ring, &pos_c));
+		rpma_mpsc_publish(ring, pos[0]);
+
+		int *c = rpma_mpsc_consume(ring, &pos_c);
+		assert_non_null(c);
+		assert_int_equal(*c, 2 * lap);
+		rpma_mpsc_release(ring, pos_c);
+
+		c = rpma_mpsc_consume(ring, &pos_c);
+		assert_non_null(c);
+		assert_int_equal(*c, 2 * lap + 1);
+		rpma_mpsc_release(ring, pos_c);
+
+		assert_true(rpma_mpsc_is_empty(ring));
+	}
+}
+
+/*
+ * ring__complete -- the consumer hands the entry back to the producer which
+ * releases it
+ */
+static void
+ring__complete(void **ring_ptr)
+{
+	struct rpma_mpsc *ring = *ring_ptr;
+	uint64_t pos, pos_c;
+
+	for (int lap = 0; lap < 2 * RING_SIZE; ++lap) {
+		int *entry = rpma_mpsc_reserve(ring, &pos);
+		assert_non_null(entry);
+		*entry = lap;
+		rpma_mpsc_publish(ring, pos);
+		assert_false(rpma_mpsc_is_completed(ring, pos));
+
+		int *c = rpma_mpsc_consume(ring, &pos_c);
+		assert_ptr_equal(c, entry);
+		*c = -lap;
+		assert_false(rpma_mpsc_is_completed(ring, pos));
+		rpma_mpsc_complete(ring, pos_c);
+
+		/* run test */
+		assert_true(rpma_mpsc_is_completed(ring, pos));
+
+		/* verify the results */
+		assert_int_equal(*entry, -lap);
+		rpma_mpsc_release(ring, pos);
+	}
+}
+
+static const struct CMUnitTest tests_ring[] = {
+	cmocka_unit_test_setup_teardown(consume__empty,
+		setup__mpsc_new, teardown__mpsc_delete),
+	cmocka_unit_test_setup_teardown(consume__not_published,
+		setup__mpsc_new, teardown__mpsc_delete),
+	cmocka_unit_test_setup_teardown(reserve__full,
+		setup__mpsc_new, teardown__mpsc_delete),
+	cmocka_unit_test_setup_teardown(ring__fifo,
+		setup__mpsc_new, teardown__mpsc_delete),
+	cmocka_unit_test_setup_teardown(ring__complete,
+		setup__mpsc_new, teardown__mpsc_delete),
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_ring, NULL, NULL);
+}
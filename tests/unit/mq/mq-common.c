@@ -0,0 +1,164 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * mq-common.c -- the rpma_mq unit tests common functions
+ */
+
+#include <endian.h>
+#include <string.h>
+
+#include "mocks-unistd.h"
+#include "mq-common.h"
+
+/*
+ * mq_new -- create a side of the queue of the given role
+ */
+static int
+mq_new(void **mstate_ptr, enum rpma_mq_role role)
+{
+	static struct mq_test_state mstate = {0};
+
+	/* configure mocks */
+	will_return(__wrap_sysconf, MOCK_OK);
+	will_return(__wrap_mmap, MOCK_OK);
+	will_return(__wrap_mmap, &mstate.allocated_slab);
+	expect_value(rpma_mr_reg, peer, MOCK_PEER);
+	expect_value(rpma_mr_reg, size, MOCK_SLAB_SIZE);
+	expect_value(rpma_mr_reg, usage,
+			RPMA_MR_USAGE_WRITE_SRC | RPMA_MR_USAGE_WRITE_DST);
+	will_return(rpma_mr_reg, &mstate.allocated_slab.addr);
+	will_return(rpma_mr_reg, MOCK_RPMA_MR_LOCAL);
+	will_return(__wrap__test_malloc, MOCK_OK);
+
+	/* run test */
+	mstate.mq = NULL;
+	mstate.connected = false;
+	int ret = rpma_mq_new(MOCK_PEER, MOCK_CONN, role, MOCK_SLOTS,
+			MOCK_SLOT_SIZE, &mstate.mq);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_non_null(mstate.mq);
+	assert_int_equal(mstate.allocated_slab.len, PAGESIZE);
+
+	/* the mmap() mock does not zero the memory */
+	memset(mstate.allocated_slab.addr, 0, MOCK_SLAB_SIZE);
+
+	*mstate_ptr = &mstate;
+
+	return 0;
+}
+
+/*
+ * mq_connect -- connect the side of the queue with the peer's side
+ */
+static int
+mq_connect(struct mq_test_state *mstate)
+{
+	char desc[MOCK_DESC_SIZE] = {0};
+	uint32_t params[2] = {htole32(MOCK_SLOTS), htole32(MOCK_SLOT_SIZE)};
+	memcpy(desc, params, sizeof(params));
+
+	/* configure mocks */
+	expect_value(rpma_mr_remote_from_descriptor, desc,
+			desc + sizeof(params));
+	expect_value(rpma_mr_remote_from_descriptor, desc_size,
+			MOCK_MR_DESC_SIZE);
+	will_return(rpma_mr_remote_from_descriptor, MOCK_RPMA_MR_REMOTE);
+
+	/* run test */
+	int ret = rpma_mq_connect(mstate->mq, desc, sizeof(desc));
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	mstate->connected = true;
+
+	return 0;
+}
+
+/*
+ * setup__mq_new_producer -- prepare a valid producer not connected yet
+ */
+int
+setup__mq_new_producer(void **mstate_ptr)
+{
+	return mq_new(mstate_ptr, RPMA_MQ_PRODUCER);
+}
+
+/*
+ * setup__mq_new_consumer -- prepare a valid consumer not connected yet
+ */
+int
+setup__mq_new_consumer(void **mstate_ptr)
+{
+	return mq_new(mstate_ptr, RPMA_MQ_CONSUMER);
+}
+
+/*
+ * setup__mq_producer -- prepare a valid connected producer
+ */
+int
+setup__mq_producer(void **mstate_ptr)
+{
+	mq_new(mstate_ptr, RPMA_MQ_PRODUCER);
+
+	return mq_connect(*mstate_ptr);
+}
+
+/*
+ * setup__mq_consumer -- prepare a valid connected consumer
+ */
+int
+setup__mq_consumer(void **mstate_ptr)
+{
+	mq_new(mstate_ptr, RPMA_MQ_CONSUMER);
+
+	return mq_connect(*mstate_ptr);
+}
+
+/*
+ * teardown__mq_delete -- delete the side of the queue
+ */
+int
+teardown__mq_delete(void **mstate_ptr)
+{
+	struct mq_test_state *mstate = *mstate_ptr;
+
+	/* configure mocks */
+	if (mstate->connected) {
+		expect_value(rpma_mr_remote_delete, *mr_ptr,
+				MOCK_RPMA_MR_REMOTE);
+		will_return(rpma_mr_remote_delete, MOCK_OK);
+	}
+	expect_value(rpma_mr_dereg, *mr_ptr, MOCK_RPMA_MR_LOCAL);
+	will_return(rpma_mr_dereg, MOCK_OK);
+	will_return(__wrap_munmap, &mstate->allocated_slab);
+	will_return(__wrap_munmap, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_mq_delete(&mstate->mq);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_null(mstate->mq);
+
+	return 0;
+}
+
+/*
+ * mq_expect_write -- expect a write of the given range of the slab
+ */
+void
+mq_expect_write(size_t dst_offset, size_t len, int flags,
+		const void *op_context)
+{
+	expect_value(rpma_write, dst, MOCK_RPMA_MR_REMOTE);
+	expect_value(rpma_write, dst_offset, dst_offset);
+	expect_value(rpma_write, src, MOCK_RPMA_MR_LOCAL);
+	expect_value(rpma_write, src_offset, dst_offset);
+	expect_value(rpma_write, len, len);
+	expect_value(rpma_write, flags, flags);
+	expect_value(rpma_write, op_context, op_context);
+	will_return(rpma_write, MOCK_OK);
+}
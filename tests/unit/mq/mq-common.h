@@ -0,0 +1,56 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * mq-common.h -- the rpma_mq unit tests common definitions
+ */
+
+#ifndef MQ_COMMON_H
+#define MQ_COMMON_H
+
+#include "cmocka_headers.h"
+#include "librpma.h"
+#include "mocks-stdlib.h"
+#include "test-common.h"
+
+#define MOCK_RPMA_MR_REMOTE	(struct rpma_mr_remote *)0xC412
+
+#define MOCK_SLOTS		4
+#define MOCK_SLOT_SIZE		32
+/* the ring (128 bytes) is followed by the head */
+#define MOCK_HEAD_OFF		128
+#define MOCK_SLAB_SIZE		(MOCK_HEAD_OFF + sizeof(uint64_t))
+
+#define MOCK_MR_DESC_SIZE	21
+/* the number of slots and the slot size followed by the mr descriptor */
+#define MOCK_DESC_SIZE		(2 * sizeof(uint32_t) + MOCK_MR_DESC_SIZE)
+
+#define MOCK_MSG		"msg"
+#define MOCK_MSG_LEN		(sizeof(MOCK_MSG))
+/* the header, the payload and the trailer of MOCK_MSG */
+#define MOCK_MSG_SLOT_LEN	(8 + 4 + 4)
+
+struct mq_test_state {
+	struct rpma_mq *mq;
+	struct mmap_args allocated_slab;
+	bool connected;
+};
+
+/* get the slot of the given position */
+#define SLOT(mstate, pos) ((char *)(mstate)->allocated_slab.addr + \
+		((pos) % MOCK_SLOTS) * MOCK_SLOT_SIZE)
+
+/* get the head */
+#define HEAD(mstate) \
+	((uint64_t *)((char *)(mstate)->allocated_slab.addr + MOCK_HEAD_OFF))
+
+int setup__mq_new_producer(void **mstate_ptr);
+int setup__mq_new_consumer(void **mstate_ptr);
+int setup__mq_producer(void **mstate_ptr);
+int setup__mq_consumer(void **mstate_ptr);
+int teardown__mq_delete(void **mstate_ptr);
+
+void mq_expect_write(size_t dst_offset, size_t len, int flags,
+		const void *op_context);
+
+#endif /* MQ_COMMON_H */
@@ -0,0 +1,259 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * mq-descriptor.c -- the rpma_mq descriptor unit tests
+ *
+ * APIs covered:
+ * - rpma_mq_get_descriptor_size()
+ * - rpma_mq_get_descriptor()
+ * - rpma_mq_connect()
+ */
+
+#include <endian.h>
+#include <string.h>
+
+#include "mq-common.h"
+
+/*
+ * get_descriptor_size__invalid_args -- NULL mq or desc_size is invalid
+ */
+static void
+get_descriptor_size__invalid_args(void **mstate_ptr)
+{
+	struct mq_test_state *mstate = *mstate_ptr;
+	size_t desc_size = 0;
+
+	/* run test */
+	int ret = rpma_mq_get_descriptor_size(NULL, &desc_size);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+
+	/* run test */
+	ret = rpma_mq_get_descriptor_size(mstate->mq, NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * get_descriptor_size__success -- the parameters of the ring followed
+ * by the memory region descriptor
+ */
+static void
+get_descriptor_size__success(void **mstate_ptr)
+{
+	struct mq_test_state *mstate = *mstate_ptr;
+
+	/* configure mocks */
+	expect_value(rpma_mr_get_descriptor_size, mr, MOCK_RPMA_MR_LOCAL);
+	will_return(rpma_mr_get_descriptor_size, MOCK_MR_DESC_SIZE);
+
+	/* run test */
+	size_t desc_size = 0;
+	int ret = rpma_mq_get_descriptor_size(mstate->mq, &desc_size);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(desc_size, MOCK_DESC_SIZE);
+}
+
+/*
+ * get_descriptor__invalid_args -- NULL mq or desc is invalid
+ */
+static void
+get_descriptor__invalid_args(void **mstate_ptr)
+{
+	struct mq_test_state *mstate = *mstate_ptr;
+	char desc[MOCK_DESC_SIZE];
+
+	/* run test */
+	int ret = rpma_mq_get_descriptor(NULL, desc);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+
+	/* run test */
+	ret = rpma_mq_get_descriptor(mstate->mq, NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * get_descriptor__success -- the parameters of the ring are stored
+ * in front of the memory region descriptor
+ */
+static void
+get_descriptor__success(void **mstate_ptr)
+{
+	struct mq_test_state *mstate = *mstate_ptr;
+	char desc[MOCK_DESC_SIZE];
+
+	/* configure mocks */
+	expect_value(rpma_mr_get_descriptor, mr, MOCK_RPMA_MR_LOCAL);
+	expect_value(rpma_mr_get_descriptor, desc, desc + 2 * sizeof(uint32_t));
+	will_return(rpma_mr_get_descriptor, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_mq_get_descriptor(mstate->mq, desc);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+
+	uint32_t params[2];
+	memcpy(params, desc, sizeof(params));
+	assert_int_equal(le32toh(params[0]), MOCK_SLOTS);
+	assert_int_equal(le32toh(params[1]), MOCK_SLOT_SIZE);
+}
+
+/*
+ * connect__invalid_args -- NULL mq or desc or a too short descriptor
+ * is invalid
+ */
+static void
+connect__invalid_args(void **mstate_ptr)
+{
+	struct mq_test_state *mstate = *mstate_ptr;
+	char desc[MOCK_DESC_SIZE] = {0};
+
+	/* run test */
+	int ret = rpma_mq_connect(NULL, desc, sizeof(desc));
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+
+	/* run test */
+	ret = rpma_mq_connect(mstate->mq, NULL, sizeof(desc));
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+
+	/* run test */
+	ret = rpma_mq_connect(mstate->mq, desc, 2 * sizeof(uint32_t));
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * connect__layout_mismatch -- the peer's ring of a different layout
+ * is rejected
+ */
+static void
+connect__layout_mismatch(void **mstate_ptr)
+{
+	struct mq_test_state *mstate = *mstate_ptr;
+	uint32_t layouts[][2] = {
+		{MOCK_SLOTS + 1, MOCK_SLOT_SIZE},
+		{MOCK_SLOTS, MOCK_SLOT_SIZE * 2},
+	};
+
+	for (size_t i = 0; i < sizeof(layouts) / sizeof(layouts[0]); ++i) {
+		char desc[MOCK_DESC_SIZE] = {0};
+		uint32_t params[2] = {htole32(layouts[i][0]),
+				htole32(layouts[i][1])};
+		memcpy(desc, params, sizeof(params));
+
+		/* run test */
+		int ret = rpma_mq_connect(mstate->mq, desc, sizeof(desc));
+
+		/* verify the results */
+		assert_int_equal(ret, RPMA_E_INVAL);
+	}
+}
+
+/*
+ * connect__remote_from_descriptor_E_INVAL -- rpma_mr_remote_from_descriptor()
+ * fails with RPMA_E_INVAL
+ */
+static void
+connect__remote_from_descriptor_E_INVAL(void **mstate_ptr)
+{
+	struct mq_test_state *mstate = *mstate_ptr;
+	char desc[MOCK_DESC_SIZE] = {0};
+	uint32_t params[2] = {htole32(MOCK_SLOTS), htole32(MOCK_SLOT_SIZE)};
+	memcpy(desc, params, sizeof(params));
+
+	/* configure mocks */
+	expect_value(rpma_mr_remote_from_descriptor, desc,
+			desc + sizeof(params));
+	expect_value(rpma_mr_remote_from_descriptor, desc_size,
+			MOCK_MR_DESC_SIZE);
+	will_return(rpma_mr_remote_from_descriptor, NULL);
+	will_return(rpma_mr_remote_from_descriptor, RPMA_E_INVAL);
+
+	/* run test */
+	int ret = rpma_mq_connect(mstate->mq, desc, sizeof(desc));
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * connect__already_connected -- the queue can be connected only once
+ */
+static void
+connect__already_connected(void **mstate_ptr)
+{
+	struct mq_test_state *mstate = *mstate_ptr;
+	char desc[MOCK_DESC_SIZE] = {0};
+	uint32_t params[2] = {htole32(MOCK_SLOTS), htole32(MOCK_SLOT_SIZE)};
+	memcpy(desc, params, sizeof(params));
+
+	/* run test */
+	int ret = rpma_mq_connect(mstate->mq, desc, sizeof(desc));
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * test_connect -- both sides of the queue can be connected
+ */
+static void
+test_connect(void **unused)
+{
+	/*
+	 * the thing is done by setup__mq_producer() and
+	 * setup__mq_consumer()
+	 */
+}
+
+static const struct CMUnitTest tests_descriptor[] = {
+	/* rpma_mq_get_descriptor_size() unit tests */
+	cmocka_unit_test_setup_teardown(get_descriptor_size__invalid_args,
+		setup__mq_new_producer, teardown__mq_delete),
+	cmocka_unit_test_setup_teardown(get_descriptor_size__success,
+		setup__mq_new_producer, teardown__mq_delete),
+
+	/* rpma_mq_get_descriptor() unit tests */
+	cmocka_unit_test_setup_teardown(get_descriptor__invalid_args,
+		setup__mq_new_producer, teardown__mq_delete),
+	cmocka_unit_test_setup_teardown(get_descriptor__success,
+		setup__mq_new_consumer, teardown__mq_delete),
+
+	/* rpma_mq_connect() unit tests */
+	cmocka_unit_test_setup_teardown(connect__invalid_args,
+		setup__mq_new_producer, teardown__mq_delete),
+	cmocka_unit_test_setup_teardown(connect__layout_mismatch,
+		setup__mq_new_producer, teardown__mq_delete),
+	cmocka_unit_test_setup_teardown(
+		connect__remote_from_descriptor_E_INVAL,
+		setup__mq_new_consumer, teardown__mq_delete),
+	cmocka_unit_test_setup_teardown(connect__already_connected,
+		setup__mq_producer, teardown__mq_delete),
+	cmocka_unit_test_setup_teardown(test_connect,
+		setup__mq_producer, teardown__mq_delete),
+	cmocka_unit_test_setup_teardown(test_connect,
+		setup__mq_consumer, teardown__mq_delete),
+
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_descriptor, NULL, NULL);
+}
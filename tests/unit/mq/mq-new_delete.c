@@ -0,0 +1,322 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * mq-new_delete.c -- the rpma_mq_new/delete() unit tests
+ *
+ * APIs covered:
+ * - rpma_mq_new()
+ * - rpma_mq_delete()
+ */
+
+#include "mocks-unistd.h"
+#include "mq-common.h"
+
+/*
+ * new__invalid_args -- invalid combinations of the arguments
+ */
+static void
+new__invalid_args(void **unused)
+{
+	struct rpma_mq *mq = NULL;
+	struct {
+		struct rpma_peer *peer;
+		struct rpma_conn *conn;
+		enum rpma_mq_role role;
+		uint32_t slots;
+		size_t slot_size;
+		struct rpma_mq **mq_ptr;
+	} args[] = {
+		/* peer == NULL */
+		{NULL, MOCK_CONN, RPMA_MQ_PRODUCER, MOCK_SLOTS,
+			MOCK_SLOT_SIZE, &mq},
+		/* conn == NULL */
+		{MOCK_PEER, NULL, RPMA_MQ_PRODUCER, MOCK_SLOTS,
+			MOCK_SLOT_SIZE, &mq},
+		/* an unknown role */
+		{MOCK_PEER, MOCK_CONN, (enum rpma_mq_role)2, MOCK_SLOTS,
+			MOCK_SLOT_SIZE, &mq},
+		/* slots == 0 */
+		{MOCK_PEER, MOCK_CONN, RPMA_MQ_PRODUCER, 0,
+			MOCK_SLOT_SIZE, &mq},
+		/* slot_size too small for an empty message */
+		{MOCK_PEER, MOCK_CONN, RPMA_MQ_PRODUCER, MOCK_SLOTS,
+			12, &mq},
+		/* slot_size not a multiple of 4 */
+		{MOCK_PEER, MOCK_CONN, RPMA_MQ_PRODUCER, MOCK_SLOTS,
+			MOCK_SLOT_SIZE + 1, &mq},
+		/* slot_size too big */
+		{MOCK_PEER, MOCK_CONN, RPMA_MQ_PRODUCER, MOCK_SLOTS,
+			(size_t)UINT32_MAX + 1, &mq},
+		/* mq_ptr == NULL */
+		{MOCK_PEER, MOCK_CONN, RPMA_MQ_PRODUCER, MOCK_SLOTS,
+			MOCK_SLOT_SIZE, NULL},
+	};
+
+	for (size_t i = 0; i < sizeof(args) / sizeof(args[0]); ++i) {
+		/* run test */
+		int ret = rpma_mq_new(args[i].peer, args[i].conn,
+				args[i].role, args[i].slots,
+				args[i].slot_size, args[i].mq_ptr);
+
+		/* verify the results */
+		assert_int_equal(ret, RPMA_E_INVAL);
+		assert_null(mq);
+	}
+}
+
+/*
+ * new__sysconf_ERRNO -- sysconf() fails with MOCK_ERRNO
+ */
+static void
+new__sysconf_ERRNO(void **unused)
+{
+	/* configure mocks */
+	will_return(__wrap_sysconf, MOCK_ERRNO);
+
+	/* run test */
+	struct rpma_mq *mq = NULL;
+	int ret = rpma_mq_new(MOCK_PEER, MOCK_CONN, RPMA_MQ_PRODUCER,
+			MOCK_SLOTS, MOCK_SLOT_SIZE, &mq);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(mq);
+}
+
+/*
+ * new__mmap_ERRNO -- mmap() fails with MOCK_ERRNO
+ */
+static void
+new__mmap_ERRNO(void **unused)
+{
+	/* configure mocks */
+	will_return(__wrap_sysconf, MOCK_OK);
+	will_return(__wrap_mmap, MOCK_ERRNO);
+
+	/* run test */
+	struct rpma_mq *mq = NULL;
+	int ret = rpma_mq_new(MOCK_PEER, MOCK_CONN, RPMA_MQ_PRODUCER,
+			MOCK_SLOTS, MOCK_SLOT_SIZE, &mq);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NOMEM);
+	assert_null(mq);
+}
+
+/*
+ * new__mr_reg_E_PROVIDER -- rpma_mr_reg() fails with RPMA_E_PROVIDER
+ */
+static void
+new__mr_reg_E_PROVIDER(void **unused)
+{
+	struct mmap_args allocated_slab = {0};
+
+	/* configure mocks */
+	will_return(__wrap_sysconf, MOCK_OK);
+	will_return(__wrap_mmap, MOCK_OK);
+	will_return(__wrap_mmap, &allocated_slab);
+	expect_value(rpma_mr_reg, peer, MOCK_PEER);
+	expect_value(rpma_mr_reg, size, MOCK_SLAB_SIZE);
+	expect_value(rpma_mr_reg, usage,
+			RPMA_MR_USAGE_WRITE_SRC | RPMA_MR_USAGE_WRITE_DST);
+	will_return(rpma_mr_reg, &allocated_slab.addr);
+	will_return(rpma_mr_reg, NULL);
+	will_return(rpma_mr_reg, RPMA_E_PROVIDER);
+	will_return(__wrap_munmap, &allocated_slab);
+	will_return(__wrap_munmap, MOCK_OK);
+
+	/* run test */
+	struct rpma_mq *mq = NULL;
+	int ret = rpma_mq_new(MOCK_PEER, MOCK_CONN, RPMA_MQ_PRODUCER,
+			MOCK_SLOTS, MOCK_SLOT_SIZE, &mq);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(mq);
+}
+
+/*
+ * new__malloc_ERRNO -- malloc() fails with MOCK_ERRNO
+ */
+static void
+new__malloc_ERRNO(void **unused)
+{
+	struct mmap_args allocated_slab = {0};
+
+	/* configure mocks */
+	will_return(__wrap_sysconf, MOCK_OK);
+	will_return(__wrap_mmap, MOCK_OK);
+	will_return(__wrap_mmap, &allocated_slab);
+	expect_value(rpma_mr_reg, peer, MOCK_PEER);
+	expect_value(rpma_mr_reg, size, MOCK_SLAB_SIZE);
+	expect_value(rpma_mr_reg, usage,
+			RPMA_MR_USAGE_WRITE_SRC | RPMA_MR_USAGE_WRITE_DST);
+	will_return(rpma_mr_reg, &allocated_slab.addr);
+	will_return(rpma_mr_reg, MOCK_RPMA_MR_LOCAL);
+	will_return(__wrap__test_malloc, MOCK_ERRNO);
+	expect_value(rpma_mr_dereg, *mr_ptr, MOCK_RPMA_MR_LOCAL);
+	will_return(rpma_mr_dereg, MOCK_OK);
+	will_return(__wrap_munmap, &allocated_slab);
+	will_return(__wrap_munmap, MOCK_OK);
+
+	/* run test */
+	struct rpma_mq *mq = NULL;
+	int ret = rpma_mq_new(MOCK_PEER, MOCK_CONN, RPMA_MQ_PRODUCER,
+			MOCK_SLOTS, MOCK_SLOT_SIZE, &mq);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NOMEM);
+	assert_null(mq);
+}
+
+/*
+ * test_lifecycle -- happy day scenario
+ */
+static void
+test_lifecycle(void **unused)
+{
+	/*
+	 * the thing is done by setup__mq_new_*() and
+	 * teardown__mq_delete()
+	 */
+}
+
+/*
+ * delete__mq_ptr_NULL -- NULL mq_ptr is invalid
+ */
+static void
+delete__mq_ptr_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_mq_delete(NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * delete__mq_NULL -- NULL mq is valid - quick exit
+ */
+static void
+delete__mq_NULL(void **unused)
+{
+	/* run test */
+	struct rpma_mq *mq = NULL;
+	int ret = rpma_mq_delete(&mq);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * delete__mr_dereg_E_PROVIDER -- rpma_mr_dereg() fails with
+ * RPMA_E_PROVIDER
+ */
+static void
+delete__mr_dereg_E_PROVIDER(void **unused)
+{
+	struct mq_test_state *mstate;
+
+	/* WA for cmocka/issues#47 */
+	assert_int_equal(setup__mq_new_producer((void **)&mstate), 0);
+
+	/* configure mocks */
+	expect_value(rpma_mr_dereg, *mr_ptr, MOCK_RPMA_MR_LOCAL);
+	will_return(rpma_mr_dereg, RPMA_E_PROVIDER);
+	will_return(rpma_mr_dereg, MOCK_ERRNO);
+	will_return(__wrap_munmap, &mstate->allocated_slab);
+	will_return(__wrap_munmap, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_mq_delete(&mstate->mq);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(mstate->mq);
+}
+
+/*
+ * delete__munmap_ERRNO -- munmap() fails with MOCK_ERRNO
+ */
+static void
+delete__munmap_ERRNO(void **unused)
+{
+	struct mq_test_state *mstate;
+
+	/* WA for cmocka/issues#47 */
+	assert_int_equal(setup__mq_new_producer((void **)&mstate), 0);
+
+	/* configure mocks */
+	expect_value(rpma_mr_dereg, *mr_ptr, MOCK_RPMA_MR_LOCAL);
+	will_return(rpma_mr_dereg, MOCK_OK);
+	will_return(__wrap_munmap, &mstate->allocated_slab);
+	will_return(__wrap_munmap, MOCK_ERRNO);
+
+	/* run test */
+	int ret = rpma_mq_delete(&mstate->mq);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(mstate->mq);
+}
+
+/*
+ * delete__remote_delete_E_PROVIDER -- rpma_mr_remote_delete() fails with
+ * RPMA_E_PROVIDER
+ */
+static void
+delete__remote_delete_E_PROVIDER(void **unused)
+{
+	struct mq_test_state *mstate;
+
+	/* WA for cmocka/issues#47 */
+	assert_int_equal(setup__mq_producer((void **)&mstate), 0);
+
+	/* configure mocks */
+	expect_value(rpma_mr_remote_delete, *mr_ptr, MOCK_RPMA_MR_REMOTE);
+	will_return(rpma_mr_remote_delete, RPMA_E_PROVIDER);
+	expect_value(rpma_mr_dereg, *mr_ptr, MOCK_RPMA_MR_LOCAL);
+	will_return(rpma_mr_dereg, MOCK_OK);
+	will_return(__wrap_munmap, &mstate->allocated_slab);
+	will_return(__wrap_munmap, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_mq_delete(&mstate->mq);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(mstate->mq);
+}
+
+static const struct CMUnitTest tests_new_delete[] = {
+	/* rpma_mq_new() unit tests */
+	cmocka_unit_test(new__invalid_args),
+	cmocka_unit_test(new__sysconf_ERRNO),
+	cmocka_unit_test(new__mmap_ERRNO),
+	cmocka_unit_test(new__mr_reg_E_PROVIDER),
+	cmocka_unit_test(new__malloc_ERRNO),
+
+	/* rpma_mq_new()/delete() lifecycle */
+	cmocka_unit_test_setup_teardown(test_lifecycle,
+		setup__mq_new_producer, teardown__mq_delete),
+	cmocka_unit_test_setup_teardown(test_lifecycle,
+		setup__mq_new_consumer, teardown__mq_delete),
+	cmocka_unit_test_setup_teardown(test_lifecycle,
+		setup__mq_producer, teardown__mq_delete),
+
+	/* rpma_mq_delete() unit tests */
+	cmocka_unit_test(delete__mq_ptr_NULL),
+	cmocka_unit_test(delete__mq_NULL),
+	cmocka_unit_test(delete__mr_dereg_E_PROVIDER),
+	cmocka_unit_test(delete__munmap_ERRNO),
+	cmocka_unit_test(delete__remote_delete_E_PROVIDER),
+
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_new_delete, NULL, NULL);
+}
@@ -0,0 +1,351 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * mq-next_publish.c -- the rpma_mq_next/publish() unit tests
+ *
+ * APIs covered:
+ * - rpma_mq_next()
+ * - rpma_mq_publish()
+ */
+
+#include <string.h>
+
+#include "mq-common.h"
+
+/*
+ * put_msg -- put the message into the slot of the given position as if it
+ * has been written by the producer; the trailer is written only if requested
+ */
+static void
+put_msg(struct mq_test_state *mstate, uint64_t pos, uint32_t seq,
+		const char *msg, uint32_t len, bool trailer)
+{
+	char *slot = SLOT(mstate, pos);
+	uint32_t hdr[2] = {seq, len};
+
+	memcpy(slot, hdr, sizeof(hdr));
+	memcpy(slot + sizeof(hdr), msg, len);
+	if (trailer)
+		memcpy(slot + sizeof(hdr) + ((len + 3) & ~(uint32_t)3), &seq,
+				sizeof(seq));
+}
+
+/*
+ * next__invalid_args -- invalid combinations of the arguments
+ */
+static void
+next__invalid_args(void **mstate_ptr)
+{
+	struct mq_test_state *mstate = *mstate_ptr;
+	const void *ptr;
+	size_t len;
+
+	assert_int_equal(rpma_mq_next(NULL, &ptr, &len), RPMA_E_INVAL);
+	assert_int_equal(rpma_mq_next(mstate->mq, NULL, &len), RPMA_E_INVAL);
+	assert_int_equal(rpma_mq_next(mstate->mq, &ptr, NULL), RPMA_E_INVAL);
+}
+
+/*
+ * next__producer -- only the consumer can receive messages
+ */
+static void
+next__producer(void **mstate_ptr)
+{
+	struct mq_test_state *mstate = *mstate_ptr;
+	const void *ptr;
+	size_t len;
+
+	/* run test */
+	int ret = rpma_mq_next(mstate->mq, &ptr, &len);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * next__empty -- no message has arrived yet
+ */
+static void
+next__empty(void **mstate_ptr)
+{
+	struct mq_test_state *mstate = *mstate_ptr;
+	const void *ptr;
+	size_t len;
+
+	/* run test */
+	int ret = rpma_mq_next(mstate->mq, &ptr, &len);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NO_COMPLETION);
+}
+
+/*
+ * next__incomplete -- the message whose trailer has not arrived yet
+ * is not taken
+ */
+static void
+next__incomplete(void **mstate_ptr)
+{
+	struct mq_test_state *mstate = *mstate_ptr;
+	const void *ptr;
+	size_t len;
+
+	put_msg(mstate, 0, 1, MOCK_MSG, MOCK_MSG_LEN, false);
+
+	/* run test */
+	int ret = rpma_mq_next(mstate->mq, &ptr, &len);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NO_COMPLETION);
+}
+
+/*
+ * next__stale -- the message from the previous lap of the ring
+ * is not taken
+ */
+static void
+next__stale(void **mstate_ptr)
+{
+	struct mq_test_state *mstate = *mstate_ptr;
+	const void *ptr;
+	size_t len;
+
+	put_msg(mstate, 0, MOCK_SLOTS + 1, MOCK_MSG, MOCK_MSG_LEN, true);
+
+	/* run test */
+	int ret = rpma_mq_next(mstate->mq, &ptr, &len);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NO_COMPLETION);
+}
+
+/*
+ * next__len_too_big -- the length not fitting into a slot means
+ * the header is not complete yet
+ */
+static void
+next__len_too_big(void **mstate_ptr)
+{
+	struct mq_test_state *mstate = *mstate_ptr;
+	const void *ptr;
+	size_t len;
+
+	uint32_t hdr[2] = {1, MOCK_SLOT_SIZE};
+	memcpy(SLOT(mstate, 0), hdr, sizeof(hdr));
+
+	/* run test */
+	int ret = rpma_mq_next(mstate->mq, &ptr, &len);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NO_COMPLETION);
+}
+
+/*
+ * next__success -- the messages are taken one by one
+ */
+static void
+next__success(void **mstate_ptr)
+{
+	struct mq_test_state *mstate = *mstate_ptr;
+	const void *ptr = NULL;
+	size_t len = 0;
+
+	put_msg(mstate, 0, 1, MOCK_MSG, MOCK_MSG_LEN, true);
+	put_msg(mstate, 1, 2, MOCK_MSG, 0, true);
+
+	/* run test */
+	int ret = rpma_mq_next(mstate->mq, &ptr, &len);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(ptr, SLOT(mstate, 0) + 2 * sizeof(uint32_t));
+	assert_int_equal(len, MOCK_MSG_LEN);
+	assert_string_equal(ptr, MOCK_MSG);
+
+	/* the message is held until the next call */
+	ret = rpma_mq_next(mstate->mq, &ptr, &len);
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(ptr, SLOT(mstate, 1) + 2 * sizeof(uint32_t));
+	assert_int_equal(len, 0);
+
+	ret = rpma_mq_next(mstate->mq, &ptr, &len);
+	assert_int_equal(ret, RPMA_E_NO_COMPLETION);
+}
+
+/*
+ * publish__invalid_args -- invalid combinations of the arguments
+ */
+static void
+publish__invalid_args(void **mstate_ptr)
+{
+	struct mq_test_state *mstate = *mstate_ptr;
+
+	/* mq == NULL */
+	assert_int_equal(rpma_mq_publish(NULL, RPMA_F_COMPLETION_ALWAYS,
+			MOCK_OP_CONTEXT), RPMA_E_INVAL);
+	/* flags == 0 */
+	assert_int_equal(rpma_mq_publish(mstate->mq, 0, MOCK_OP_CONTEXT),
+			RPMA_E_INVAL);
+}
+
+/*
+ * publish__producer -- only the consumer can publish its head
+ */
+static void
+publish__producer(void **mstate_ptr)
+{
+	struct mq_test_state *mstate = *mstate_ptr;
+
+	/* run test */
+	int ret = rpma_mq_publish(mstate->mq, RPMA_F_COMPLETION_ALWAYS,
+			MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * publish__not_connected -- the queue has to be connected to publish
+ * the head
+ */
+static void
+publish__not_connected(void **mstate_ptr)
+{
+	struct mq_test_state *mstate = *mstate_ptr;
+
+	/* run test */
+	int ret = rpma_mq_publish(mstate->mq, RPMA_F_COMPLETION_ALWAYS,
+			MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * publish__nothing -- no write is posted if nothing has been consumed
+ */
+static void
+publish__nothing(void **mstate_ptr)
+{
+	struct mq_test_state *mstate = *mstate_ptr;
+	const void *ptr;
+	size_t len;
+
+	/* the message is still held by the application */
+	put_msg(mstate, 0, 1, MOCK_MSG, MOCK_MSG_LEN, true);
+	assert_int_equal(rpma_mq_next(mstate->mq, &ptr, &len), MOCK_OK);
+
+	/* run test */
+	int ret = rpma_mq_publish(mstate->mq, RPMA_F_COMPLETION_ALWAYS,
+			MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * publish__write_E_PROVIDER -- rpma_write() fails with RPMA_E_PROVIDER
+ */
+static void
+publish__write_E_PROVIDER(void **mstate_ptr)
+{
+	struct mq_test_state *mstate = *mstate_ptr;
+	const void *ptr;
+	size_t len;
+
+	put_msg(mstate, 0, 1, MOCK_MSG, MOCK_MSG_LEN, true);
+	assert_int_equal(rpma_mq_next(mstate->mq, &ptr, &len), MOCK_OK);
+	assert_int_equal(rpma_mq_next(mstate->mq, &ptr, &len),
+			RPMA_E_NO_COMPLETION);
+
+	/* configure mocks */
+	expect_value(rpma_write, dst, MOCK_RPMA_MR_REMOTE);
+	expect_value(rpma_write, dst_offset, MOCK_HEAD_OFF);
+	expect_value(rpma_write, src, MOCK_RPMA_MR_LOCAL);
+	expect_value(rpma_write, src_offset, MOCK_HEAD_OFF);
+	expect_value(rpma_write, len, sizeof(uint64_t));
+	expect_value(rpma_write, flags, RPMA_F_COMPLETION_ALWAYS);
+	expect_value(rpma_write, op_context, MOCK_OP_CONTEXT);
+	will_return(rpma_write, RPMA_E_PROVIDER);
+
+	/* run test */
+	int ret = rpma_mq_publish(mstate->mq, RPMA_F_COMPLETION_ALWAYS,
+			MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+}
+
+/*
+ * publish__success -- the head is written to the producer
+ */
+static void
+publish__success(void **mstate_ptr)
+{
+	struct mq_test_state *mstate = *mstate_ptr;
+	const void *ptr;
+	size_t len;
+
+	put_msg(mstate, 0, 1, MOCK_MSG, MOCK_MSG_LEN, true);
+	assert_int_equal(rpma_mq_next(mstate->mq, &ptr, &len), MOCK_OK);
+	assert_int_equal(rpma_mq_next(mstate->mq, &ptr, &len),
+			RPMA_E_NO_COMPLETION);
+
+	/* configure mocks */
+	mq_expect_write(MOCK_HEAD_OFF, sizeof(uint64_t),
+			RPMA_F_COMPLETION_ALWAYS, MOCK_OP_CONTEXT);
+
+	/* run test */
+	int ret = rpma_mq_publish(mstate->mq, RPMA_F_COMPLETION_ALWAYS,
+			MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(*HEAD(mstate), 1);
+
+	/* the head has been published already */
+	ret = rpma_mq_publish(mstate->mq, RPMA_F_COMPLETION_ALWAYS,
+			MOCK_OP_CONTEXT);
+	assert_int_equal(ret, MOCK_OK);
+}
+
+static const struct CMUnitTest tests_next_publish[] = {
+	/* rpma_mq_next() unit tests */
+	cmocka_unit_test_setup_teardown(next__invalid_args,
+		setup__mq_consumer, teardown__mq_delete),
+	cmocka_unit_test_setup_teardown(next__producer,
+		setup__mq_producer, teardown__mq_delete),
+	cmocka_unit_test_setup_teardown(next__empty,
+		setup__mq_consumer, teardown__mq_delete),
+	cmocka_unit_test_setup_teardown(next__incomplete,
+		setup__mq_consumer, teardown__mq_delete),
+	cmocka_unit_test_setup_teardown(next__stale,
+		setup__mq_consumer, teardown__mq_delete),
+	cmocka_unit_test_setup_teardown(next__len_too_big,
+		setup__mq_consumer, teardown__mq_delete),
+	cmocka_unit_test_setup_teardown(next__success,
+		setup__mq_consumer, teardown__mq_delete),
+
+	/* rpma_mq_publish() unit tests */
+	cmocka_unit_test_setup_teardown(publish__invalid_args,
+		setup__mq_consumer, teardown__mq_delete),
+	cmocka_unit_test_setup_teardown(publish__producer,
+		setup__mq_producer, teardown__mq_delete),
+	cmocka_unit_test_setup_teardown(publish__not_connected,
+		setup__mq_new_consumer, teardown__mq_delete),
+	cmocka_unit_test_setup_teardown(publish__nothing,
+		setup__mq_consumer, teardown__mq_delete),
+	cmocka_unit_test_setup_teardown(publish__write_E_PROVIDER,
+		setup__mq_consumer, teardown__mq_delete),
+	cmocka_unit_test_setup_teardown(publish__success,
+		setup__mq_consumer, teardown__mq_delete),
+
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_next_publish, NULL, NULL);
+}
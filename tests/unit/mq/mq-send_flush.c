@@ -0,0 +1,371 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * mq-send_flush.c -- the rpma_mq_send/flush() unit tests
+ *
+ * APIs covered:
+ * - rpma_mq_send()
+ * - rpma_mq_flush()
+ */
+
+#include <string.h>
+
+#include "mq-common.h"
+
+/*
+ * verify_slot -- verify the message built in the slot of the given position
+ */
+static void
+verify_slot(struct mq_test_state *mstate, uint64_t pos, const char *msg,
+		size_t len)
+{
+	char *slot = SLOT(mstate, pos);
+	uint32_t seq = (uint32_t)(pos + 1);
+	uint32_t hdr[2];
+	uint32_t trailer;
+
+	memcpy(hdr, slot, sizeof(hdr));
+	assert_int_equal(hdr[0], seq);
+	assert_int_equal(hdr[1], len);
+	if (len)
+		assert_memory_equal(slot + sizeof(hdr), msg, len);
+	memcpy(&trailer, slot + sizeof(hdr) + ((len + 3) & ~(size_t)3),
+			sizeof(trailer));
+	assert_int_equal(trailer, seq);
+}
+
+/*
+ * send__invalid_args -- invalid combinations of the arguments
+ */
+static void
+send__invalid_args(void **mstate_ptr)
+{
+	struct mq_test_state *mstate = *mstate_ptr;
+	char msg[MOCK_SLOT_SIZE] = {0};
+
+	/* mq == NULL */
+	assert_int_equal(rpma_mq_send(NULL, MOCK_MSG, MOCK_MSG_LEN),
+			RPMA_E_INVAL);
+	/* data == NULL && len != 0 */
+	assert_int_equal(rpma_mq_send(mstate->mq, NULL, MOCK_MSG_LEN),
+			RPMA_E_INVAL);
+	/* the message does not fit into a slot */
+	assert_int_equal(rpma_mq_send(mstate->mq, msg, MOCK_SLOT_SIZE - 11),
+			RPMA_E_INVAL);
+}
+
+/*
+ * send__consumer -- only the producer can send messages
+ */
+static void
+send__consumer(void **mstate_ptr)
+{
+	struct mq_test_state *mstate = *mstate_ptr;
+
+	/* run test */
+	int ret = rpma_mq_send(mstate->mq, MOCK_MSG, MOCK_MSG_LEN);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * send__max_len -- the longest message fills the whole slot
+ */
+static void
+send__max_len(void **mstate_ptr)
+{
+	struct mq_test_state *mstate = *mstate_ptr;
+	char msg[MOCK_SLOT_SIZE - 12];
+	memset(msg, 'x', sizeof(msg));
+
+	/* run test */
+	int ret = rpma_mq_send(mstate->mq, msg, sizeof(msg));
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	verify_slot(mstate, 0, msg, sizeof(msg));
+
+	/* configure mocks */
+	mq_expect_write(0, MOCK_SLOT_SIZE, RPMA_F_COMPLETION_ALWAYS,
+			MOCK_OP_CONTEXT);
+
+	/* run test */
+	ret = rpma_mq_flush(mstate->mq, RPMA_F_COMPLETION_ALWAYS,
+			MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * send__ring_full -- the producer cannot overwrite the slots
+ * not consumed yet
+ */
+static void
+send__ring_full(void **mstate_ptr)
+{
+	struct mq_test_state *mstate = *mstate_ptr;
+
+	for (int i = 0; i < MOCK_SLOTS; ++i)
+		assert_int_equal(rpma_mq_send(mstate->mq, MOCK_MSG,
+				MOCK_MSG_LEN), MOCK_OK);
+
+	/* run test */
+	int ret = rpma_mq_send(mstate->mq, MOCK_MSG, MOCK_MSG_LEN);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_AGAIN);
+
+	/* the consumer has consumed a single message */
+	*HEAD(mstate) = 1;
+
+	/* run test */
+	ret = rpma_mq_send(mstate->mq, MOCK_MSG, MOCK_MSG_LEN);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	verify_slot(mstate, MOCK_SLOTS, MOCK_MSG, MOCK_MSG_LEN);
+}
+
+/*
+ * flush__invalid_args -- invalid combinations of the arguments
+ */
+static void
+flush__invalid_args(void **mstate_ptr)
+{
+	struct mq_test_state *mstate = *mstate_ptr;
+
+	/* mq == NULL */
+	assert_int_equal(rpma_mq_flush(NULL, RPMA_F_COMPLETION_ALWAYS,
+			MOCK_OP_CONTEXT), RPMA_E_INVAL);
+	/* flags == 0 */
+	assert_int_equal(rpma_mq_flush(mstate->mq, 0, MOCK_OP_CONTEXT),
+			RPMA_E_INVAL);
+}
+
+/*
+ * flush__not_connected -- the queue has to be connected to be flushed
+ */
+static void
+flush__not_connected(void **mstate_ptr)
+{
+	struct mq_test_state *mstate = *mstate_ptr;
+
+	assert_int_equal(rpma_mq_send(mstate->mq, MOCK_MSG, MOCK_MSG_LEN),
+			MOCK_OK);
+
+	/* run test */
+	int ret = rpma_mq_flush(mstate->mq, RPMA_F_COMPLETION_ALWAYS,
+			MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * flush__consumer -- only the producer can flush messages
+ */
+static void
+flush__consumer(void **mstate_ptr)
+{
+	struct mq_test_state *mstate = *mstate_ptr;
+
+	/* run test */
+	int ret = rpma_mq_flush(mstate->mq, RPMA_F_COMPLETION_ALWAYS,
+			MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * flush__nothing -- no write is posted if nothing has been staged
+ */
+static void
+flush__nothing(void **mstate_ptr)
+{
+	struct mq_test_state *mstate = *mstate_ptr;
+
+	/* run test */
+	int ret = rpma_mq_flush(mstate->mq, RPMA_F_COMPLETION_ALWAYS,
+			MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * flush__write_E_PROVIDER -- rpma_write() fails with RPMA_E_PROVIDER
+ * and the staged messages can be flushed again
+ */
+static void
+flush__write_E_PROVIDER(void **mstate_ptr)
+{
+	struct mq_test_state *mstate = *mstate_ptr;
+
+	assert_int_equal(rpma_mq_send(mstate->mq, MOCK_MSG, MOCK_MSG_LEN),
+			MOCK_OK);
+
+	/* configure mocks */
+	expect_value(rpma_write, dst, MOCK_RPMA_MR_REMOTE);
+	expect_value(rpma_write, dst_offset, 0);
+	expect_value(rpma_write, src, MOCK_RPMA_MR_LOCAL);
+	expect_value(rpma_write, src_offset, 0);
+	expect_value(rpma_write, len, MOCK_MSG_SLOT_LEN);
+	expect_value(rpma_write, flags, RPMA_F_COMPLETION_ALWAYS);
+	expect_value(rpma_write, op_context, MOCK_OP_CONTEXT);
+	will_return(rpma_write, RPMA_E_PROVIDER);
+
+	/* run test */
+	int ret = rpma_mq_flush(mstate->mq, RPMA_F_COMPLETION_ALWAYS,
+			MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+
+	/* configure mocks */
+	mq_expect_write(0, MOCK_MSG_SLOT_LEN, RPMA_F_COMPLETION_ALWAYS,
+			MOCK_OP_CONTEXT);
+
+	/* run test */
+	ret = rpma_mq_flush(mstate->mq, RPMA_F_COMPLETION_ALWAYS,
+			MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * flush__single -- a single message is written up to its trailer
+ */
+static void
+flush__single(void **mstate_ptr)
+{
+	struct mq_test_state *mstate = *mstate_ptr;
+
+	assert_int_equal(rpma_mq_send(mstate->mq, MOCK_MSG, MOCK_MSG_LEN),
+			MOCK_OK);
+	verify_slot(mstate, 0, MOCK_MSG, MOCK_MSG_LEN);
+
+	/* configure mocks */
+	mq_expect_write(0, MOCK_MSG_SLOT_LEN, RPMA_F_COMPLETION_ALWAYS,
+			MOCK_OP_CONTEXT);
+
+	/* run test */
+	int ret = rpma_mq_flush(mstate->mq, RPMA_F_COMPLETION_ALWAYS,
+			MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+
+	/* the message has been flushed already */
+	ret = rpma_mq_flush(mstate->mq, RPMA_F_COMPLETION_ALWAYS,
+			MOCK_OP_CONTEXT);
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * flush__batch -- all the staged messages are written at once
+ */
+static void
+flush__batch(void **mstate_ptr)
+{
+	struct mq_test_state *mstate = *mstate_ptr;
+
+	assert_int_equal(rpma_mq_send(mstate->mq, MOCK_MSG, MOCK_MSG_LEN),
+			MOCK_OK);
+	assert_int_equal(rpma_mq_send(mstate->mq, NULL, 0), MOCK_OK);
+	verify_slot(mstate, 0, MOCK_MSG, MOCK_MSG_LEN);
+	verify_slot(mstate, 1, NULL, 0);
+
+	/* configure mocks */
+	mq_expect_write(0, MOCK_SLOT_SIZE + 8 + 4, RPMA_F_COMPLETION_ALWAYS,
+			MOCK_OP_CONTEXT);
+
+	/* run test */
+	int ret = rpma_mq_flush(mstate->mq, RPMA_F_COMPLETION_ALWAYS,
+			MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * flush__wrap -- the staged range wrapping around the end of the ring
+ * is written with two writes
+ */
+static void
+flush__wrap(void **mstate_ptr)
+{
+	struct mq_test_state *mstate = *mstate_ptr;
+
+	/* move the producer to the last but one slot */
+	for (int i = 0; i < MOCK_SLOTS - 2; ++i)
+		assert_int_equal(rpma_mq_send(mstate->mq, MOCK_MSG,
+				MOCK_MSG_LEN), MOCK_OK);
+	mq_expect_write(0, (MOCK_SLOTS - 3) * MOCK_SLOT_SIZE +
+			MOCK_MSG_SLOT_LEN, RPMA_F_COMPLETION_ALWAYS,
+			MOCK_OP_CONTEXT);
+	assert_int_equal(rpma_mq_flush(mstate->mq, RPMA_F_COMPLETION_ALWAYS,
+			MOCK_OP_CONTEXT), MOCK_OK);
+	*HEAD(mstate) = MOCK_SLOTS - 2;
+
+	/* stage the last two slots and the first one */
+	for (int i = 0; i < 3; ++i)
+		assert_int_equal(rpma_mq_send(mstate->mq, MOCK_MSG,
+				MOCK_MSG_LEN), MOCK_OK);
+	verify_slot(mstate, MOCK_SLOTS, MOCK_MSG, MOCK_MSG_LEN);
+
+	/* configure mocks */
+	mq_expect_write((MOCK_SLOTS - 2) * MOCK_SLOT_SIZE, 2 * MOCK_SLOT_SIZE,
+			RPMA_F_COMPLETION_ON_ERROR, NULL);
+	mq_expect_write(0, MOCK_MSG_SLOT_LEN, RPMA_F_COMPLETION_ALWAYS,
+			MOCK_OP_CONTEXT);
+
+	/* run test */
+	int ret = rpma_mq_flush(mstate->mq, RPMA_F_COMPLETION_ALWAYS,
+			MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+static const struct CMUnitTest tests_send_flush[] = {
+	/* rpma_mq_send() unit tests */
+	cmocka_unit_test_setup_teardown(send__invalid_args,
+		setup__mq_producer, teardown__mq_delete),
+	cmocka_unit_test_setup_teardown(send__consumer,
+		setup__mq_consumer, teardown__mq_delete),
+	cmocka_unit_test_setup_teardown(send__max_len,
+		setup__mq_producer, teardown__mq_delete),
+	cmocka_unit_test_setup_teardown(send__ring_full,
+		setup__mq_producer, teardown__mq_delete),
+
+	/* rpma_mq_flush() unit tests */
+	cmocka_unit_test_setup_teardown(flush__invalid_args,
+		setup__mq_producer, teardown__mq_delete),
+	cmocka_unit_test_setup_teardown(flush__not_connected,
+		setup__mq_new_producer, teardown__mq_delete),
+	cmocka_unit_test_setup_teardown(flush__consumer,
+		setup__mq_consumer, teardown__mq_delete),
+	cmocka_unit_test_setup_teardown(flush__nothing,
+		setup__mq_producer, teardown__mq_delete),
+	cmocka_unit_test_setup_teardown(flush__write_E_PROVIDER,
+		setup__mq_producer, teardown__mq_delete),
+	cmocka_unit_test_setup_teardown(flush__single,
+		setup__mq_producer, teardown__mq_delete),
+	cmocka_unit_test_setup_teardown(flush__batch,
+		setup__mq_producer, teardown__mq_delete),
+	cmocka_unit_test_setup_teardown(flush__wrap,
+		setup__mq_producer, teardown__mq_delete),
+
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_send_flush, NULL, NULL);
+}
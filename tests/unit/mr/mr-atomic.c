@@ -0,0 +1,185 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * mr-atomic.c -- rpma_mr_atomic() unit tests
+ */
+
+#include <infiniband/verbs.h>
+#include <stdlib.h>
+
+#include "cmocka_headers.h"
+#include "mr.h"
+#include "librpma.h"
+
+#include "mr-common.h"
+#include "mocks-ibverbs.h"
+#include "test-common.h"
+
+#define MOCK_SRC_OFFSET_ALIGNED	(size_t)0xC418
+#define MOCK_COMPARE_ADD	(uint64_t)0xC441
+#define MOCK_SWAP		(uint64_t)0xC442
+
+/*
+ * atomic__unknown_operation -- an unknown operation is not supported
+ */
+static void
+atomic__unknown_operation(void **mrs_ptr)
+{
+	struct mrs *mrs = (struct mrs *)*mrs_ptr;
+
+	/* run test */
+	int ret = rpma_mr_atomic(MOCK_QP, mrs->local, MOCK_DST_OFFSET,
+				mrs->remote, MOCK_SRC_OFFSET_ALIGNED,
+				IBV_WR_RDMA_WRITE, MOCK_COMPARE_ADD, MOCK_SWAP,
+				RPMA_F_COMPLETION_ALWAYS, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NOSUPP);
+}
+
+/*
+ * atomic__COMPL_ON_ERROR_failed_E_PROVIDER -- rpma_mr_atomic failed
+ * with RPMA_E_PROVIDER when send_flags == 0 for RPMA_F_COMPLETION_ON_ERROR
+ */
+static void
+atomic__COMPL_ON_ERROR_failed_E_PROVIDER(void **mrs_ptr)
+{
+	struct mrs *mrs = (struct mrs *)*mrs_ptr;
+
+	/* configure mocks */
+	struct ibv_post_send_mock_args args;
+	args.qp = MOCK_QP;
+	args.opcode = IBV_WR_ATOMIC_FETCH_AND_ADD;
+	args.send_flags = 0; /* for RPMA_F_COMPLETION_ON_ERROR */
+	args.wr_id = (uint64_t)MOCK_OP_CONTEXT;
+	args.remote_addr = MOCK_RADDR + MOCK_SRC_OFFSET_ALIGNED;
+	args.rkey = MOCK_RKEY;
+	args.compare_add = MOCK_COMPARE_ADD;
+	args.swap = 0;
+	args.ret = MOCK_ERRNO;
+	will_return(ibv_post_send_mock, &args);
+
+	/* run test */
+	int ret = rpma_mr_atomic(MOCK_QP, mrs->local, MOCK_DST_OFFSET,
+				mrs->remote, MOCK_SRC_OFFSET_ALIGNED,
+				IBV_WR_ATOMIC_FETCH_AND_ADD, MOCK_COMPARE_ADD,
+				MOCK_SWAP, RPMA_F_COMPLETION_ON_ERROR,
+				MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+}
+
+/*
+ * atomic__CMP_AND_SWP_success -- happy day scenario of the compare-and-swap
+ */
+static void
+atomic__CMP_AND_SWP_success(void **mrs_ptr)
+{
+	struct mrs *mrs = (struct mrs *)*mrs_ptr;
+
+	/* configure mocks */
+	struct ibv_post_send_mock_args args;
+	args.qp = MOCK_QP;
+	args.opcode = IBV_WR_ATOMIC_CMP_AND_SWP;
+	args.send_flags = IBV_SEND_SIGNALED; /* for RPMA_F_COMPLETION_ALWAYS */
+	args.wr_id = (uint64_t)MOCK_OP_CONTEXT;
+	args.remote_addr = MOCK_RADDR + MOCK_SRC_OFFSET_ALIGNED;
+	args.rkey = MOCK_RKEY;
+	args.compare_add = MOCK_COMPARE_ADD;
+	args.swap = MOCK_SWAP;
+	args.ret = MOCK_OK;
+	will_return(ibv_post_send_mock, &args);
+
+	/* run test */
+	int ret = rpma_mr_atomic(MOCK_QP, mrs->local, MOCK_DST_OFFSET,
+				mrs->remote, MOCK_SRC_OFFSET_ALIGNED,
+				IBV_WR_ATOMIC_CMP_AND_SWP, MOCK_COMPARE_ADD,
+				MOCK_SWAP, RPMA_F_COMPLETION_ALWAYS,
+				MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * atomic__FETCH_AND_ADD_success -- happy day scenario of the fetch-and-add
+ */
+static void
+atomic__FETCH_AND_ADD_success(void **mrs_ptr)
+{
+	struct mrs *mrs = (struct mrs *)*mrs_ptr;
+
+	/* configure mocks */
+	struct ibv_post_send_mock_args args;
+	args.qp = MOCK_QP;
+	args.opcode = IBV_WR_ATOMIC_FETCH_AND_ADD;
+	args.send_flags = IBV_SEND_SIGNALED; /* for RPMA_F_COMPLETION_ALWAYS */
+	args.wr_id = (uint64_t)MOCK_OP_CONTEXT;
+	args.remote_addr = MOCK_RADDR + MOCK_SRC_OFFSET_ALIGNED;
+	args.rkey = MOCK_RKEY;
+	args.compare_add = MOCK_COMPARE_ADD;
+	args.swap = 0; /* the swap argument is ignored */
+	args.ret = MOCK_OK;
+	will_return(ibv_post_send_mock, &args);
+
+	/* run test */
+	int ret = rpma_mr_atomic(MOCK_QP, mrs->local, MOCK_DST_OFFSET,
+				mrs->remote, MOCK_SRC_OFFSET_ALIGNED,
+				IBV_WR_ATOMIC_FETCH_AND_ADD, MOCK_COMPARE_ADD,
+				MOCK_SWAP, RPMA_F_COMPLETION_ALWAYS,
+				MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * group_setup_mr_atomic -- prepare resources for all tests in the group
+ */
+static int
+group_setup_mr_atomic(void **unused)
+{
+	/* configure global mocks */
+
+	/*
+	 * ibv_post_send() is defined as a static inline function
+	 * in the included header <infiniband/verbs.h>,
+	 * so we cannot define it again. It is defined as:
+	 * {
+	 *     return qp->context->ops.post_send(qp, wr, bad_wr);
+	 * }
+	 * so we can set the 'qp->context->ops.post_send' function pointer
+	 * to our mock function.
+	 */
+	MOCK_VERBS->ops.post_send = ibv_post_send_mock;
+	Ibv_qp.context = MOCK_VERBS;
+
+	return 0;
+}
+
+static const struct CMUnitTest tests_mr_atomic[] = {
+	/* rpma_mr_atomic() unit tests */
+	cmocka_unit_test_setup_teardown(atomic__unknown_operation,
+			setup__mr_local_and_remote,
+			teardown__mr_local_and_remote),
+	cmocka_unit_test_setup_teardown(
+			atomic__COMPL_ON_ERROR_failed_E_PROVIDER,
+			setup__mr_local_and_remote,
+			teardown__mr_local_and_remote),
+	cmocka_unit_test_setup_teardown(atomic__CMP_AND_SWP_success,
+			setup__mr_local_and_remote,
+			teardown__mr_local_and_remote),
+	cmocka_unit_test_setup_teardown(atomic__FETCH_AND_ADD_success,
+			setup__mr_local_and_remote,
+			teardown__mr_local_and_remote),
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_mr_atomic, group_setup_mr_atomic,
+			NULL);
+}
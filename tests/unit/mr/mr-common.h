@@ -26,15 +26,15 @@
 #define DESC_EXP_PMEM	{0x07, 0x06, 0x05, 0x04, 0x03, 0x02, 0x01, 0x00, \
 			0x0f, 0x0e, 0x0d, 0x0c, 0x0b, 0x0a, 0x09, 0x08, \
 			0x13, 0x12, 0x11, 0x10, \
-			0x21}
+			0x21, 0x00}
 #define DESC_EXP_DRAM	{0x07, 0x06, 0x05, 0x04, 0x03, 0x02, 0x01, 0x00, \
 			0x0f, 0x0e, 0x0d, 0x0c, 0x0b, 0x0a, 0x09, 0x08, \
 			0x13, 0x12, 0x11, 0x10, \
-			0x11}
+			0x11, 0x00}
 
 #define MOCK_FLUSH_TYPE RPMA_MR_USAGE_FLUSH_TYPE_PERSISTENT
 
-#define MR_DESC_SIZE	21 /* sizeof(DESC_EXP_PMEM) */
+#define MR_DESC_SIZE	22 /* sizeof(DESC_EXP_PMEM) */
 #define INVALID_MR_DESC_SIZE	1
 
 #define MOCK_DST_OFFSET		(size_t)0xC413
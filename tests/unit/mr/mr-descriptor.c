@@ -215,9 +215,10 @@ static void
 remote_from_descriptor__buff_usage_equal_zero(void **unused)
 {
 	char desc_invalid[MR_DESC_SIZE];
-	memset(desc_invalid, 0xff, MR_DESC_SIZE - 1);
+	memset(desc_invalid, 0xff, MR_DESC_SIZE - 2);
 
 	/* set usage to 0 */
+	desc_invalid[MR_DESC_SIZE - 2] = 0;
 	desc_invalid[MR_DESC_SIZE - 1] = 0;
 
 	/* configure mock */
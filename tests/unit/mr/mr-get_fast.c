@@ -0,0 +1,191 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * mr-get_fast.c -- the memory region fast handles unit tests
+ *
+ * APIs covered:
+ * - rpma_mr_get_fast()
+ * - rpma_mr_remote_get_fast()
+ * - rpma_fast_post_failed()
+ */
+
+#include "librpma_fast.h"
+#include "mocks-ibverbs.h"
+#include "mocks-rpma-peer.h"
+#include "mr-common.h"
+#include "test-common.h"
+
+#define MOCK_LKEY		(uint32_t)0x20212223
+
+/* rpma_mr_get_fast() unit tests */
+
+/*
+ * get_fast__mr_NULL - NULL mr is invalid
+ */
+static void
+get_fast__mr_NULL(void **unused)
+{
+	/* run test */
+	struct rpma_fast_mr fmr = {0};
+	int ret = rpma_mr_get_fast(NULL, &fmr);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+	assert_int_equal(fmr.addr, 0);
+}
+
+/*
+ * get_fast__fmr_NULL - NULL fmr is invalid
+ */
+static void
+get_fast__fmr_NULL(void **pprestate)
+{
+	struct prestate *prestate = *pprestate;
+
+	/* run test */
+	int ret = rpma_mr_get_fast(prestate->mr, NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * get_fast__success - happy day scenario
+ */
+static void
+get_fast__success(void **pprestate)
+{
+	struct prestate *prestate = *pprestate;
+
+	/* run test */
+	struct rpma_fast_mr fmr = {0};
+	int ret = rpma_mr_get_fast(prestate->mr, &fmr);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(fmr.addr, (uint64_t)MOCK_PTR);
+	assert_int_equal(fmr.size, MOCK_SIZE);
+	assert_int_equal(fmr.key, MOCK_LKEY);
+}
+
+/* rpma_mr_remote_get_fast() unit tests */
+
+/*
+ * remote_get_fast__mr_NULL - NULL mr is invalid
+ */
+static void
+remote_get_fast__mr_NULL(void **unused)
+{
+	/* run test */
+	struct rpma_fast_mr fmr = {0};
+	int ret = rpma_mr_remote_get_fast(NULL, &fmr);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+	assert_int_equal(fmr.addr, 0);
+}
+
+/*
+ * remote_get_fast__fmr_NULL - NULL fmr is invalid
+ */
+static void
+remote_get_fast__fmr_NULL(void **mr_ptr)
+{
+	struct rpma_mr_remote *mr = *mr_ptr;
+
+	/* run test */
+	int ret = rpma_mr_remote_get_fast(mr, NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * remote_get_fast__success - happy day scenario
+ */
+static void
+remote_get_fast__success(void **mr_ptr)
+{
+	struct rpma_mr_remote *mr = *mr_ptr;
+
+	/* run test */
+	struct rpma_fast_mr fmr = {0};
+	int ret = rpma_mr_remote_get_fast(mr, &fmr);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(fmr.addr, MOCK_RADDR);
+	assert_int_equal(fmr.size, MOCK_SIZE);
+	assert_int_equal(fmr.key, MOCK_RKEY);
+}
+
+/* rpma_fast_post_failed() unit tests */
+
+/*
+ * post_failed__E_PROVIDER - the failed post is reported as RPMA_E_PROVIDER
+ */
+static void
+post_failed__E_PROVIDER(void **unused)
+{
+	struct ibv_sge sge = {0};
+	struct ibv_send_wr wr = {0};
+	wr.sg_list = &sge;
+	wr.num_sge = 1;
+	wr.opcode = IBV_WR_RDMA_READ;
+
+	/* run test */
+	int ret = rpma_fast_post_failed(&wr, MOCK_ERRNO);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+}
+
+/*
+ * group_setup_get_fast -- prepare resources for all tests in the group
+ */
+static int
+group_setup_get_fast(void **unused)
+{
+	/* configure global mocks */
+	Ibv_mr.lkey = MOCK_LKEY;
+
+	return 0;
+}
+
+static struct prestate prestate =
+		{RPMA_MR_USAGE_READ_SRC | RPMA_MR_USAGE_READ_DST,
+		IBV_ACCESS_REMOTE_READ | IBV_ACCESS_LOCAL_WRITE, NULL};
+
+static const struct CMUnitTest tests_get_fast[] = {
+	/* rpma_mr_get_fast() unit tests */
+	cmocka_unit_test(get_fast__mr_NULL),
+	cmocka_unit_test_prestate_setup_teardown(
+		get_fast__fmr_NULL,
+		setup__reg_success,
+		teardown__dereg_success,
+		&prestate),
+	cmocka_unit_test_prestate_setup_teardown(
+		get_fast__success,
+		setup__reg_success,
+		teardown__dereg_success,
+		&prestate),
+
+	/* rpma_mr_remote_get_fast() unit tests */
+	cmocka_unit_test(remote_get_fast__mr_NULL),
+	cmocka_unit_test_setup_teardown(remote_get_fast__fmr_NULL,
+		setup__mr_remote, teardown__mr_remote),
+	cmocka_unit_test_setup_teardown(remote_get_fast__success,
+		setup__mr_remote, teardown__mr_remote),
+
+	/* rpma_fast_post_failed() unit tests */
+	cmocka_unit_test(post_failed__E_PROVIDER),
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_get_fast,
+			group_setup_get_fast, NULL);
+}
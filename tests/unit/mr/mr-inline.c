@@ -0,0 +1,168 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * mr-inline.c -- rpma_mr_inline() unit tests
+ */
+
+#include <infiniband/verbs.h>
+#include <stdlib.h>
+
+#include "cmocka_headers.h"
+#include "mr.h"
+#include "librpma.h"
+
+#include "mocks-ibverbs.h"
+#include "mr-common.h"
+#include "test-common.h"
+
+static const char Mock_inline_data[] = "inline data";
+
+/*
+ * inline__failed_E_NOSUPP - rpma_mr_inline failed with RPMA_E_NOSUPP
+ */
+static void
+inline__failed_E_NOSUPP(void **mrs_ptr)
+{
+	struct mrs *mrs = (struct mrs *)*mrs_ptr;
+
+	/* run test */
+	int ret = rpma_mr_inline(MOCK_QP, mrs->remote, MOCK_DST_OFFSET,
+			Mock_inline_data, sizeof(Mock_inline_data),
+			RPMA_F_COMPLETION_ALWAYS, MOCK_UNKNOWN_OP,
+			MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NOSUPP);
+}
+
+/*
+ * inline__failed_E_PROVIDER - rpma_mr_inline failed with RPMA_E_PROVIDER
+ */
+static void
+inline__failed_E_PROVIDER(void **mrs_ptr)
+{
+	struct mrs *mrs = (struct mrs *)*mrs_ptr;
+
+	/* configure mocks */
+	struct ibv_post_send_mock_args args;
+	args.qp = MOCK_QP;
+	args.opcode = IBV_WR_RDMA_WRITE;
+	args.send_flags = IBV_SEND_INLINE; /* for RPMA_F_COMPLETION_ON_ERROR */
+	args.wr_id = (uint64_t)MOCK_OP_CONTEXT;
+	args.remote_addr = MOCK_RADDR + MOCK_DST_OFFSET;
+	args.rkey = MOCK_RKEY;
+	args.ret = MOCK_ERRNO;
+	will_return(ibv_post_send_mock, &args);
+
+	/* run test */
+	int ret = rpma_mr_inline(MOCK_QP, mrs->remote, MOCK_DST_OFFSET,
+			Mock_inline_data, sizeof(Mock_inline_data),
+			RPMA_F_COMPLETION_ON_ERROR, IBV_WR_RDMA_WRITE,
+			MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+}
+
+/*
+ * inline__write_success - happy day scenario of an inline write
+ */
+static void
+inline__write_success(void **mrs_ptr)
+{
+	struct mrs *mrs = (struct mrs *)*mrs_ptr;
+
+	/* configure mocks */
+	struct ibv_post_send_mock_args args;
+	args.qp = MOCK_QP;
+	args.opcode = IBV_WR_RDMA_WRITE;
+	/* for RPMA_F_COMPLETION_ALWAYS */
+	args.send_flags = IBV_SEND_INLINE | IBV_SEND_SIGNALED;
+	args.wr_id = (uint64_t)MOCK_OP_CONTEXT;
+	args.remote_addr = MOCK_RADDR + MOCK_DST_OFFSET;
+	args.rkey = MOCK_RKEY;
+	args.ret = MOCK_OK;
+	will_return(ibv_post_send_mock, &args);
+
+	/* run test */
+	int ret = rpma_mr_inline(MOCK_QP, mrs->remote, MOCK_DST_OFFSET,
+			Mock_inline_data, sizeof(Mock_inline_data),
+			RPMA_F_COMPLETION_ALWAYS, IBV_WR_RDMA_WRITE,
+			MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * inline__send_success - happy day scenario of an inline send
+ */
+static void
+inline__send_success(void **unused)
+{
+	/* configure mocks */
+	struct ibv_post_send_mock_args args;
+	args.qp = MOCK_QP;
+	args.opcode = IBV_WR_SEND;
+	/* for RPMA_F_COMPLETION_ALWAYS */
+	args.send_flags = IBV_SEND_INLINE | IBV_SEND_SIGNALED;
+	args.wr_id = (uint64_t)MOCK_OP_CONTEXT;
+	args.ret = MOCK_OK;
+	will_return(ibv_post_send_mock, &args);
+
+	/* run test */
+	int ret = rpma_mr_inline(MOCK_QP, NULL, 0,
+			Mock_inline_data, sizeof(Mock_inline_data),
+			RPMA_F_COMPLETION_ALWAYS, IBV_WR_SEND,
+			MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * group_setup_mr_inline -- prepare resources for all tests in the group
+ */
+static int
+group_setup_mr_inline(void **unused)
+{
+	/* configure global mocks */
+
+	/*
+	 * ibv_post_send() is defined as a static inline function
+	 * in the included header <infiniband/verbs.h>,
+	 * so we cannot define it again. It is defined as:
+	 * {
+	 *     return qp->context->ops.post_send(qp, wr, bad_wr);
+	 * }
+	 * so we can set the 'qp->context->ops.post_send' function pointer
+	 * to our mock function.
+	 */
+	MOCK_VERBS->ops.post_send = ibv_post_send_mock;
+	Ibv_qp.context = MOCK_VERBS;
+
+	return 0;
+}
+
+static const struct CMUnitTest tests_mr_inline[] = {
+	/* rpma_mr_inline() unit tests */
+	cmocka_unit_test_setup_teardown(inline__failed_E_NOSUPP,
+			setup__mr_local_and_remote,
+			teardown__mr_local_and_remote),
+	cmocka_unit_test_setup_teardown(inline__failed_E_PROVIDER,
+			setup__mr_local_and_remote,
+			teardown__mr_local_and_remote),
+	cmocka_unit_test_setup_teardown(inline__write_success,
+			setup__mr_local_and_remote,
+			teardown__mr_local_and_remote),
+	cmocka_unit_test(inline__send_success),
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_mr_inline,
+			group_setup_mr_inline, NULL);
+}
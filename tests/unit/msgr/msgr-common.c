@@ -0,0 +1,150 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * msgr-common.c -- the rpma_msgr unit tests common functions
+ */
+
+#include <string.h>
+
+#include "mocks-rpma-recv_ring.h"
+#include "mocks-unistd.h"
+#include "msgr-common.h"
+
+/*
+ * setup__msgr_new -- prepare a valid messenger
+ */
+int
+setup__msgr_new(void **rstate_ptr)
+{
+	static struct msgr_test_state rstate = {0};
+
+	/* configure mocks */
+	expect_value(rpma_recv_ring_new, slots, MOCK_CREDITS);
+	expect_value(rpma_recv_ring_new, slot_size, MOCK_BUF_SIZE);
+	expect_value(rpma_recv_ring_new, batch, MOCK_CREDITS);
+	will_return(rpma_recv_ring_new, MOCK_RPMA_RECV_RING);
+	will_return(__wrap_sysconf, MOCK_OK);
+	will_return(__wrap_mmap, MOCK_OK);
+	will_return(__wrap_mmap, &rstate.allocated_slab);
+	expect_value(rpma_mr_reg, peer, MOCK_PEER);
+	expect_value(rpma_mr_reg, size, MOCK_SLAB_SIZE);
+	expect_value(rpma_mr_reg, usage, RPMA_MR_USAGE_SEND);
+	will_return(rpma_mr_reg, &rstate.allocated_slab.addr);
+	will_return(rpma_mr_reg, MOCK_RPMA_MR_LOCAL);
+	will_return_count(__wrap__test_malloc, MOCK_OK, 3);
+
+	/* run test */
+	rstate.msgr = NULL;
+	int ret = rpma_msgr_new(MOCK_PEER, MOCK_CONN, MOCK_CREDITS,
+			MOCK_BUF_SIZE, &rstate.msgr);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_non_null(rstate.msgr);
+	assert_int_equal(rstate.allocated_slab.len, PAGESIZE);
+
+	uint32_t credits = 0;
+	assert_int_equal(rpma_msgr_get_credits(rstate.msgr, &credits),
+			MOCK_OK);
+	assert_int_equal(credits, MOCK_CREDITS);
+
+	*rstate_ptr = &rstate;
+
+	return 0;
+}
+
+/*
+ * teardown__msgr_delete -- delete the messenger
+ */
+int
+teardown__msgr_delete(void **rstate_ptr)
+{
+	struct msgr_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	expect_value(rpma_mr_dereg, *mr_ptr, MOCK_RPMA_MR_LOCAL);
+	will_return(rpma_mr_dereg, MOCK_OK);
+	will_return(__wrap_munmap, &rstate->allocated_slab);
+	will_return(__wrap_munmap, MOCK_OK);
+	will_return(rpma_recv_ring_delete, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_msgr_delete(&rstate->msgr);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_null(rstate->msgr);
+
+	return 0;
+}
+
+/*
+ * msgr_expect_send -- expect a send of the batch from the given buffer
+ */
+void
+msgr_expect_send(struct msgr_test_state *rstate, uint32_t buf, size_t len)
+{
+	expect_value(rpma_send, src, MOCK_RPMA_MR_LOCAL);
+	expect_value(rpma_send, offset, buf * MOCK_BUF_SIZE);
+	expect_value(rpma_send, len, len);
+	expect_value(rpma_send, flags, RPMA_F_COMPLETION_ALWAYS);
+	expect_value(rpma_send, op_context, SEND_BUF(rstate, buf));
+	will_return(rpma_send, MOCK_OK);
+}
+
+/*
+ * msgr_batch -- start a batch in the given receive buffer
+ */
+void
+msgr_batch(struct msgr_test_state *rstate, uint32_t slot, uint32_t credits)
+{
+	struct rpma_msgr_hdr *hdr = (struct rpma_msgr_hdr *)rstate->rcvd[slot];
+	hdr->credits = credits;
+	hdr->nmsgs = 0;
+	rstate->rcvd_len[slot] = sizeof(*hdr);
+}
+
+/*
+ * msgr_batch_add -- append a message to the batch in the given receive
+ * buffer
+ */
+void
+msgr_batch_add(struct msgr_test_state *rstate, uint32_t slot,
+		enum rpma_msgr_type type, uint64_t corr_id, const char *payload)
+{
+	struct rpma_msgr_hdr *hdr = (struct rpma_msgr_hdr *)rstate->rcvd[slot];
+	struct rpma_msgr_msg_hdr *mhdr = (struct rpma_msgr_msg_hdr *)
+			(rstate->rcvd[slot] + rstate->rcvd_len[slot]);
+	size_t len = strlen(payload) + 1;
+
+	mhdr->corr_id = corr_id;
+	mhdr->len = (uint32_t)len;
+	mhdr->type = type;
+	memcpy(mhdr + 1, payload, len);
+
+	hdr->nmsgs++;
+	rstate->rcvd_len[slot] += sizeof(*mhdr) + ((len + 7) & ~(size_t)7);
+}
+
+/*
+ * msgr_receive -- process a receive completion of the given receive buffer
+ */
+int
+msgr_receive(struct msgr_test_state *rstate, uint32_t slot)
+{
+	struct rpma_recv_msg rmsg = {0};
+	rmsg.ptr = rstate->rcvd[slot];
+	rmsg.len = (uint32_t)rstate->rcvd_len[slot];
+	rmsg.slot = slot;
+
+	/* configure mocks */
+	will_return(rpma_recv_ring_get_msg, &rmsg);
+
+	struct rpma_completion cmpl = {0};
+	cmpl.op = RPMA_OP_RECV;
+	cmpl.op_status = IBV_WC_SUCCESS;
+	cmpl.byte_len = rmsg.len;
+
+	return rpma_msgr_process(rstate->msgr, &cmpl);
+}
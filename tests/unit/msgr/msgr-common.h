@@ -0,0 +1,52 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * msgr-common.h -- the rpma_msgr unit tests common definitions
+ */
+
+#ifndef MSGR_COMMON_H
+#define MSGR_COMMON_H
+
+#include "cmocka_headers.h"
+#include "librpma.h"
+#include "mocks-stdlib.h"
+#include "msgr.h"
+#include "test-common.h"
+
+#define MOCK_CREDITS		4
+#define MOCK_BUF_SIZE		64
+#define MOCK_SLAB_SIZE		(MOCK_CREDITS * MOCK_BUF_SIZE)
+
+#define MOCK_MSG		"msg"
+#define MOCK_MSG_LEN		(sizeof(MOCK_MSG))
+/* a batch header and a message header followed by the padded payload */
+#define MOCK_MSG_BATCH_LEN	(sizeof(struct rpma_msgr_hdr) + \
+		sizeof(struct rpma_msgr_msg_hdr) + 8)
+
+struct msgr_test_state {
+	struct rpma_msgr *msgr;
+	struct mmap_args allocated_slab;
+
+	/* the receive buffers and the lengths of the batches they hold */
+	char rcvd[MOCK_CREDITS][MOCK_BUF_SIZE];
+	size_t rcvd_len[MOCK_CREDITS];
+};
+
+/* get the send buffer of the given index */
+#define SEND_BUF(rstate, buf) \
+	((char *)(rstate)->allocated_slab.addr + (buf) * MOCK_BUF_SIZE)
+
+int setup__msgr_new(void **rstate_ptr);
+int teardown__msgr_delete(void **rstate_ptr);
+
+void msgr_expect_send(struct msgr_test_state *rstate, uint32_t buf,
+		size_t len);
+void msgr_batch(struct msgr_test_state *rstate, uint32_t slot,
+		uint32_t credits);
+void msgr_batch_add(struct msgr_test_state *rstate, uint32_t slot,
+		enum rpma_msgr_type type, uint64_t corr_id,
+		const char *payload);
+int msgr_receive(struct msgr_test_state *rstate, uint32_t slot);
+
+#endif /* MSGR_COMMON_H */
@@ -0,0 +1,357 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * msgr-new_delete.c -- the rpma_msgr_new/delete() unit tests
+ *
+ * APIs covered:
+ * - rpma_msgr_new()
+ * - rpma_msgr_delete()
+ */
+
+#include "mocks-rpma-recv_ring.h"
+#include "mocks-unistd.h"
+#include "msgr-common.h"
+
+/*
+ * configure_recv_ring_new -- configure the mocks of rpma_recv_ring_new()
+ */
+static void
+configure_recv_ring_new(void)
+{
+	expect_value(rpma_recv_ring_new, slots, MOCK_CREDITS);
+	expect_value(rpma_recv_ring_new, slot_size, MOCK_BUF_SIZE);
+	expect_value(rpma_recv_ring_new, batch, MOCK_CREDITS);
+	will_return(rpma_recv_ring_new, MOCK_RPMA_RECV_RING);
+}
+
+/*
+ * new__invalid_args -- invalid combinations of the arguments
+ */
+static void
+new__invalid_args(void **unused)
+{
+	struct rpma_msgr *msgr = NULL;
+	struct {
+		struct rpma_peer *peer;
+		struct rpma_conn *conn;
+		uint32_t credits;
+		size_t buf_size;
+		struct rpma_msgr **msgr_ptr;
+	} args[] = {
+		/* peer == NULL */
+		{NULL, MOCK_CONN, MOCK_CREDITS, MOCK_BUF_SIZE, &msgr},
+		/* conn == NULL */
+		{MOCK_PEER, NULL, MOCK_CREDITS, MOCK_BUF_SIZE, &msgr},
+		/* credits < 2 */
+		{MOCK_PEER, MOCK_CONN, 1, MOCK_BUF_SIZE, &msgr},
+		/* buf_size too small for a single empty message */
+		{MOCK_PEER, MOCK_CONN, MOCK_CREDITS,
+			sizeof(struct rpma_msgr_hdr) +
+			sizeof(struct rpma_msgr_msg_hdr) - 1, &msgr},
+		/* buf_size too big */
+		{MOCK_PEER, MOCK_CONN, MOCK_CREDITS, UINT32_MAX, &msgr},
+		/* msgr_ptr == NULL */
+		{MOCK_PEER, MOCK_CONN, MOCK_CREDITS, MOCK_BUF_SIZE, NULL},
+	};
+
+	for (size_t i = 0; i < sizeof(args) / sizeof(args[0]); ++i) {
+		/* run test */
+		int ret = rpma_msgr_new(args[i].peer, args[i].conn,
+				args[i].credits, args[i].buf_size,
+				args[i].msgr_ptr);
+
+		/* verify the results */
+		assert_int_equal(ret, RPMA_E_INVAL);
+		assert_null(msgr);
+	}
+}
+
+/*
+ * new__recv_ring_new_E_NOSUPP -- rpma_recv_ring_new() fails with
+ * RPMA_E_NOSUPP
+ */
+static void
+new__recv_ring_new_E_NOSUPP(void **unused)
+{
+	/* configure mocks */
+	expect_value(rpma_recv_ring_new, slots, MOCK_CREDITS);
+	expect_value(rpma_recv_ring_new, slot_size, MOCK_BUF_SIZE);
+	expect_value(rpma_recv_ring_new, batch, MOCK_CREDITS);
+	will_return(rpma_recv_ring_new, NULL);
+	will_return(rpma_recv_ring_new, RPMA_E_NOSUPP);
+
+	/* run test */
+	struct rpma_msgr *msgr = NULL;
+	int ret = rpma_msgr_new(MOCK_PEER, MOCK_CONN, MOCK_CREDITS,
+			MOCK_BUF_SIZE, &msgr);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NOSUPP);
+	assert_null(msgr);
+}
+
+/*
+ * new__sysconf_ERRNO -- sysconf() fails with MOCK_ERRNO
+ */
+static void
+new__sysconf_ERRNO(void **unused)
+{
+	/* configure mocks */
+	configure_recv_ring_new();
+	will_return(__wrap_sysconf, MOCK_ERRNO);
+	will_return(rpma_recv_ring_delete, MOCK_OK);
+
+	/* run test */
+	struct rpma_msgr *msgr = NULL;
+	int ret = rpma_msgr_new(MOCK_PEER, MOCK_CONN, MOCK_CREDITS,
+			MOCK_BUF_SIZE, &msgr);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(msgr);
+}
+
+/*
+ * new__mmap_ERRNO -- mmap() fails with MOCK_ERRNO
+ */
+static void
+new__mmap_ERRNO(void **unused)
+{
+	/* configure mocks */
+	configure_recv_ring_new();
+	will_return(__wrap_sysconf, MOCK_OK);
+	will_return(__wrap_mmap, MOCK_ERRNO);
+	will_return(rpma_recv_ring_delete, MOCK_OK);
+
+	/* run test */
+	struct rpma_msgr *msgr = NULL;
+	int ret = rpma_msgr_new(MOCK_PEER, MOCK_CONN, MOCK_CREDITS,
+			MOCK_BUF_SIZE, &msgr);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NOMEM);
+	assert_null(msgr);
+}
+
+/*
+ * new__mr_reg_E_PROVIDER -- rpma_mr_reg() fails with RPMA_E_PROVIDER
+ */
+static void
+new__mr_reg_E_PROVIDER(void **unused)
+{
+	struct mmap_args allocated_slab = {0};
+
+	/* configure mocks */
+	configure_recv_ring_new();
+	will_return(__wrap_sysconf, MOCK_OK);
+	will_return(__wrap_mmap, MOCK_OK);
+	will_return(__wrap_mmap, &allocated_slab);
+	expect_value(rpma_mr_reg, peer, MOCK_PEER);
+	expect_value(rpma_mr_reg, size, MOCK_SLAB_SIZE);
+	expect_value(rpma_mr_reg, usage, RPMA_MR_USAGE_SEND);
+	will_return(rpma_mr_reg, &allocated_slab.addr);
+	will_return(rpma_mr_reg, NULL);
+	will_return(rpma_mr_reg, RPMA_E_PROVIDER);
+	will_return(__wrap_munmap, &allocated_slab);
+	will_return(__wrap_munmap, MOCK_OK);
+	will_return(rpma_recv_ring_delete, MOCK_OK);
+
+	/* run test */
+	struct rpma_msgr *msgr = NULL;
+	int ret = rpma_msgr_new(MOCK_PEER, MOCK_CONN, MOCK_CREDITS,
+			MOCK_BUF_SIZE, &msgr);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(msgr);
+}
+
+/*
+ * new__malloc_ERRNO -- malloc() fails with MOCK_ERRNO
+ */
+static void
+new__malloc_ERRNO(void **unused)
+{
+	/* each of the three malloc() calls fails in turn */
+	for (int i = 0; i < 3; ++i) {
+		struct mmap_args allocated_slab = {0};
+
+		/* configure mocks */
+		configure_recv_ring_new();
+		will_return(__wrap_sysconf, MOCK_OK);
+		will_return(__wrap_mmap, MOCK_OK);
+		will_return(__wrap_mmap, &allocated_slab);
+		expect_value(rpma_mr_reg, peer, MOCK_PEER);
+		expect_value(rpma_mr_reg, size, MOCK_SLAB_SIZE);
+		expect_value(rpma_mr_reg, usage, RPMA_MR_USAGE_SEND);
+		will_return(rpma_mr_reg, &allocated_slab.addr);
+		will_return(rpma_mr_reg, MOCK_RPMA_MR_LOCAL);
+		for (int j = 0; j < i; ++j)
+			will_return(__wrap__test_malloc, MOCK_OK);
+		will_return(__wrap__test_malloc, MOCK_ERRNO);
+		expect_value(rpma_mr_dereg, *mr_ptr, MOCK_RPMA_MR_LOCAL);
+		will_return(rpma_mr_dereg, MOCK_OK);
+		will_return(__wrap_munmap, &allocated_slab);
+		will_return(__wrap_munmap, MOCK_OK);
+		will_return(rpma_recv_ring_delete, MOCK_OK);
+
+		/* run test */
+		struct rpma_msgr *msgr = NULL;
+		int ret = rpma_msgr_new(MOCK_PEER, MOCK_CONN, MOCK_CREDITS,
+				MOCK_BUF_SIZE, &msgr);
+
+		/* verify the results */
+		assert_int_equal(ret, RPMA_E_NOMEM);
+		assert_null(msgr);
+	}
+}
+
+/*
+ * test_lifecycle -- happy day scenario
+ */
+static void
+test_lifecycle(void **unused)
+{
+	/*
+	 * the thing is done by setup__msgr_new() and
+	 * teardown__msgr_delete()
+	 */
+}
+
+/*
+ * delete__msgr_ptr_NULL -- NULL msgr_ptr is invalid
+ */
+static void
+delete__msgr_ptr_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_msgr_delete(NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * delete__msgr_NULL -- NULL msgr is valid - quick exit
+ */
+static void
+delete__msgr_NULL(void **unused)
+{
+	/* run test */
+	struct rpma_msgr *msgr = NULL;
+	int ret = rpma_msgr_delete(&msgr);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * delete__mr_dereg_E_PROVIDER -- rpma_mr_dereg() fails with
+ * RPMA_E_PROVIDER
+ */
+static void
+delete__mr_dereg_E_PROVIDER(void **unused)
+{
+	struct msgr_test_state *rstate;
+
+	/* WA for cmocka/issues#47 */
+	assert_int_equal(setup__msgr_new((void **)&rstate), 0);
+
+	/* configure mocks */
+	expect_value(rpma_mr_dereg, *mr_ptr, MOCK_RPMA_MR_LOCAL);
+	will_return(rpma_mr_dereg, RPMA_E_PROVIDER);
+	will_return(rpma_mr_dereg, MOCK_ERRNO);
+	will_return(__wrap_munmap, &rstate->allocated_slab);
+	will_return(__wrap_munmap, MOCK_OK);
+	will_return(rpma_recv_ring_delete, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_msgr_delete(&rstate->msgr);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(rstate->msgr);
+}
+
+/*
+ * delete__munmap_ERRNO -- munmap() fails with MOCK_ERRNO
+ */
+static void
+delete__munmap_ERRNO(void **unused)
+{
+	struct msgr_test_state *rstate;
+
+	/* WA for cmocka/issues#47 */
+	assert_int_equal(setup__msgr_new((void **)&rstate), 0);
+
+	/* configure mocks */
+	expect_value(rpma_mr_dereg, *mr_ptr, MOCK_RPMA_MR_LOCAL);
+	will_return(rpma_mr_dereg, MOCK_OK);
+	will_return(__wrap_munmap, &rstate->allocated_slab);
+	will_return(__wrap_munmap, MOCK_ERRNO);
+	will_return(rpma_recv_ring_delete, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_msgr_delete(&rstate->msgr);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(rstate->msgr);
+}
+
+/*
+ * delete__recv_ring_delete_E_PROVIDER -- rpma_recv_ring_delete() fails
+ * with RPMA_E_PROVIDER
+ */
+static void
+delete__recv_ring_delete_E_PROVIDER(void **unused)
+{
+	struct msgr_test_state *rstate;
+
+	/* WA for cmocka/issues#47 */
+	assert_int_equal(setup__msgr_new((void **)&rstate), 0);
+
+	/* configure mocks */
+	expect_value(rpma_mr_dereg, *mr_ptr, MOCK_RPMA_MR_LOCAL);
+	will_return(rpma_mr_dereg, MOCK_OK);
+	will_return(__wrap_munmap, &rstate->allocated_slab);
+	will_return(__wrap_munmap, MOCK_OK);
+	will_return(rpma_recv_ring_delete, RPMA_E_PROVIDER);
+
+	/* run test */
+	int ret = rpma_msgr_delete(&rstate->msgr);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(rstate->msgr);
+}
+
+static const struct CMUnitTest tests_new_delete[] = {
+	/* rpma_msgr_new() unit tests */
+	cmocka_unit_test(new__invalid_args),
+	cmocka_unit_test(new__recv_ring_new_E_NOSUPP),
+	cmocka_unit_test(new__sysconf_ERRNO),
+	cmocka_unit_test(new__mmap_ERRNO),
+	cmocka_unit_test(new__mr_reg_E_PROVIDER),
+	cmocka_unit_test(new__malloc_ERRNO),
+
+	/* rpma_msgr_new()/delete() lifecycle */
+	cmocka_unit_test_setup_teardown(test_lifecycle,
+		setup__msgr_new, teardown__msgr_delete),
+
+	/* rpma_msgr_delete() unit tests */
+	cmocka_unit_test(delete__msgr_ptr_NULL),
+	cmocka_unit_test(delete__msgr_NULL),
+	cmocka_unit_test(delete__mr_dereg_E_PROVIDER),
+	cmocka_unit_test(delete__munmap_ERRNO),
+	cmocka_unit_test(delete__recv_ring_delete_E_PROVIDER),
+
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_new_delete, NULL, NULL);
+}
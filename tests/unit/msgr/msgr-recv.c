@@ -0,0 +1,473 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * msgr-recv.c -- the rpma_msgr_process/next() unit tests
+ *
+ * APIs covered:
+ * - rpma_msgr_process()
+ * - rpma_msgr_next()
+ */
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "mocks-rpma-recv_ring.h"
+#include "msgr-common.h"
+
+#define MOCK_CORR_ID		(uint64_t)0xC022
+#define MOCK_MSG_2		"msg-2"
+
+/*
+ * get_credits -- get the number of the peer's credits
+ */
+static uint32_t
+get_credits(struct msgr_test_state *rstate)
+{
+	uint32_t credits = 0;
+	assert_int_equal(rpma_msgr_get_credits(rstate->msgr, &credits),
+			MOCK_OK);
+
+	return credits;
+}
+
+/*
+ * msgr_flush_credits -- send a single request and get the number
+ * of the credits it returns to the peer; repost tells if any released
+ * receive buffers are waiting to be re-posted before the send
+ */
+static uint32_t
+msgr_flush_credits(struct msgr_test_state *rstate, bool repost)
+{
+	uint64_t corr_id;
+	assert_int_equal(rpma_msgr_request(rstate->msgr, MOCK_MSG,
+			MOCK_MSG_LEN, &corr_id), MOCK_OK);
+
+	/* configure mocks */
+	if (repost)
+		will_return(rpma_recv_ring_repost, MOCK_OK);
+	msgr_expect_send(rstate, 0, MOCK_MSG_BATCH_LEN);
+	assert_int_equal(rpma_msgr_flush(rstate->msgr), MOCK_OK);
+
+	struct rpma_msgr_hdr *hdr = (struct rpma_msgr_hdr *)SEND_BUF(rstate, 0);
+
+	return hdr->credits;
+}
+
+/*
+ * process__invalid_args -- NULL msgr or cmpl is invalid
+ */
+static void
+process__invalid_args(void **rstate_ptr)
+{
+	struct msgr_test_state *rstate = *rstate_ptr;
+	struct rpma_completion cmpl = {0};
+
+	assert_int_equal(rpma_msgr_process(NULL, &cmpl), RPMA_E_INVAL);
+	assert_int_equal(rpma_msgr_process(rstate->msgr, NULL),
+			RPMA_E_INVAL);
+}
+
+/*
+ * process__foreign_cmpl -- the completion does not come from
+ * the messenger
+ */
+static void
+process__foreign_cmpl(void **rstate_ptr)
+{
+	struct msgr_test_state *rstate = *rstate_ptr;
+	struct rpma_completion cmpl = {0};
+
+	/* not a send nor a receive */
+	cmpl.op = RPMA_OP_READ;
+	assert_int_equal(rpma_msgr_process(rstate->msgr, &cmpl),
+			RPMA_E_INVAL);
+
+	/* a send of another buffer */
+	cmpl.op = RPMA_OP_SEND;
+	cmpl.op_context = MOCK_OP_CONTEXT;
+	assert_int_equal(rpma_msgr_process(rstate->msgr, &cmpl),
+			RPMA_E_INVAL);
+
+	/* a misaligned send buffer */
+	cmpl.op_context = SEND_BUF(rstate, 0) + 1;
+	assert_int_equal(rpma_msgr_process(rstate->msgr, &cmpl),
+			RPMA_E_INVAL);
+
+	/* a receive of another buffer */
+	cmpl.op = RPMA_OP_RECV;
+	will_return(rpma_recv_ring_get_msg, NULL);
+	will_return(rpma_recv_ring_get_msg, RPMA_E_INVAL);
+	assert_int_equal(rpma_msgr_process(rstate->msgr, &cmpl),
+			RPMA_E_INVAL);
+}
+
+/*
+ * process__send -- the send buffer is reused after the send completes
+ */
+static void
+process__send(void **rstate_ptr)
+{
+	struct msgr_test_state *rstate = *rstate_ptr;
+	uint64_t corr_id;
+
+	assert_int_equal(rpma_msgr_request(rstate->msgr, MOCK_MSG,
+			MOCK_MSG_LEN, &corr_id), MOCK_OK);
+	msgr_expect_send(rstate, 0, MOCK_MSG_BATCH_LEN);
+	assert_int_equal(rpma_msgr_flush(rstate->msgr), MOCK_OK);
+
+	/* run test */
+	struct rpma_completion cmpl = {0};
+	cmpl.op = RPMA_OP_SEND;
+	cmpl.op_context = SEND_BUF(rstate, 0);
+	cmpl.op_status = IBV_WC_SUCCESS;
+	int ret = rpma_msgr_process(rstate->msgr, &cmpl);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+
+	/* the same buffer is used for the next batch */
+	assert_int_equal(rpma_msgr_request(rstate->msgr, MOCK_MSG,
+			MOCK_MSG_LEN, &corr_id), MOCK_OK);
+	msgr_expect_send(rstate, 0, MOCK_MSG_BATCH_LEN);
+	assert_int_equal(rpma_msgr_flush(rstate->msgr), MOCK_OK);
+}
+
+/*
+ * process__send_failed -- the send completes with an error
+ */
+static void
+process__send_failed(void **rstate_ptr)
+{
+	struct msgr_test_state *rstate = *rstate_ptr;
+	uint64_t corr_id;
+
+	assert_int_equal(rpma_msgr_request(rstate->msgr, MOCK_MSG,
+			MOCK_MSG_LEN, &corr_id), MOCK_OK);
+	msgr_expect_send(rstate, 0, MOCK_MSG_BATCH_LEN);
+	assert_int_equal(rpma_msgr_flush(rstate->msgr), MOCK_OK);
+
+	/* run test */
+	struct rpma_completion cmpl = {0};
+	cmpl.op = RPMA_OP_SEND;
+	cmpl.op_context = SEND_BUF(rstate, 0);
+	cmpl.op_status = IBV_WC_RETRY_EXC_ERR;
+	int ret = rpma_msgr_process(rstate->msgr, &cmpl);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+}
+
+/*
+ * process__recv_failed -- the receive completes with an error
+ */
+static void
+process__recv_failed(void **rstate_ptr)
+{
+	struct msgr_test_state *rstate = *rstate_ptr;
+	struct rpma_recv_msg rmsg = {0};
+	rmsg.ptr = rstate->rcvd[0];
+	rmsg.slot = 0;
+
+	/* configure mocks */
+	will_return(rpma_recv_ring_get_msg, &rmsg);
+	expect_value(rpma_recv_ring_release, msg->slot, 0);
+	will_return(rpma_recv_ring_release, MOCK_OK);
+
+	/* run test */
+	struct rpma_completion cmpl = {0};
+	cmpl.op = RPMA_OP_RECV;
+	cmpl.op_status = IBV_WC_WR_FLUSH_ERR;
+	int ret = rpma_msgr_process(rstate->msgr, &cmpl);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+
+	/* the released receive buffer is granted with the next batch */
+	assert_int_equal(msgr_flush_credits(rstate, true), 1);
+}
+
+/*
+ * process__recv_malformed -- the received batch is malformed
+ */
+static void
+process__recv_malformed(void **rstate_ptr)
+{
+	struct msgr_test_state *rstate = *rstate_ptr;
+
+	/* the batch header is truncated */
+	msgr_batch(rstate, 0, 0);
+	rstate->rcvd_len[0] = sizeof(struct rpma_msgr_hdr) - 1;
+	expect_value(rpma_recv_ring_release, msg->slot, 0);
+	will_return(rpma_recv_ring_release, MOCK_OK);
+	assert_int_equal(msgr_receive(rstate, 0), RPMA_E_INVAL);
+
+	/* the message header is truncated */
+	msgr_batch(rstate, 0, 0);
+	msgr_batch_add(rstate, 0, RPMA_MSGR_REQUEST, MOCK_CORR_ID, MOCK_MSG);
+	rstate->rcvd_len[0] = sizeof(struct rpma_msgr_hdr) +
+			sizeof(struct rpma_msgr_msg_hdr) - 1;
+	expect_value(rpma_recv_ring_release, msg->slot, 0);
+	will_return(rpma_recv_ring_release, MOCK_OK);
+	assert_int_equal(msgr_receive(rstate, 0), RPMA_E_INVAL);
+
+	/* the payload is truncated */
+	rstate->rcvd_len[0] = MOCK_MSG_BATCH_LEN - 1;
+	expect_value(rpma_recv_ring_release, msg->slot, 0);
+	will_return(rpma_recv_ring_release, MOCK_OK);
+	assert_int_equal(msgr_receive(rstate, 0), RPMA_E_INVAL);
+
+	/* the batch returns more credits than the peer has been given */
+	msgr_batch(rstate, 0, 1);
+	expect_value(rpma_recv_ring_release, msg->slot, 0);
+	will_return(rpma_recv_ring_release, MOCK_OK);
+	assert_int_equal(msgr_receive(rstate, 0), RPMA_E_INVAL);
+	assert_int_equal(get_credits(rstate), MOCK_CREDITS);
+
+	/*
+	 * All of the receive buffers have been released so the ring has
+	 * re-posted them already and they are granted with the next batch.
+	 */
+	assert_int_equal(msgr_flush_credits(rstate, false), MOCK_CREDITS);
+
+	/* nothing has been queued */
+	struct rpma_msgr_msg msg;
+	assert_int_equal(rpma_msgr_next(rstate->msgr, &msg),
+			RPMA_E_NO_COMPLETION);
+}
+
+/*
+ * next__invalid_args -- NULL msgr or msg is invalid
+ */
+static void
+next__invalid_args(void **rstate_ptr)
+{
+	struct msgr_test_state *rstate = *rstate_ptr;
+	struct rpma_msgr_msg msg;
+
+	assert_int_equal(rpma_msgr_next(NULL, &msg), RPMA_E_INVAL);
+	assert_int_equal(rpma_msgr_next(rstate->msgr, NULL), RPMA_E_INVAL);
+}
+
+/*
+ * next__empty -- no message has been received
+ */
+static void
+next__empty(void **rstate_ptr)
+{
+	struct msgr_test_state *rstate = *rstate_ptr;
+
+	/* run test */
+	struct rpma_msgr_msg msg;
+	int ret = rpma_msgr_next(rstate->msgr, &msg);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NO_COMPLETION);
+}
+
+/*
+ * next__batch -- all messages of the received batch are read in order
+ * and the receive buffer is released afterwards
+ */
+static void
+next__batch(void **rstate_ptr)
+{
+	struct msgr_test_state *rstate = *rstate_ptr;
+	struct rpma_msgr_msg msg;
+
+	msgr_batch(rstate, 0, 0);
+	msgr_batch_add(rstate, 0, RPMA_MSGR_REQUEST, MOCK_CORR_ID, MOCK_MSG);
+	msgr_batch_add(rstate, 0, RPMA_MSGR_RESPONSE, MOCK_CORR_ID + 1,
+			MOCK_MSG_2);
+	assert_int_equal(msgr_receive(rstate, 0), MOCK_OK);
+
+	/* run test */
+	int ret = rpma_msgr_next(rstate->msgr, &msg);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(msg.type, RPMA_MSGR_REQUEST);
+	assert_int_equal(msg.corr_id, MOCK_CORR_ID);
+	assert_int_equal(msg.len, sizeof(MOCK_MSG));
+	assert_string_equal(msg.ptr, MOCK_MSG);
+
+	/* run test */
+	ret = rpma_msgr_next(rstate->msgr, &msg);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(msg.type, RPMA_MSGR_RESPONSE);
+	assert_int_equal(msg.corr_id, MOCK_CORR_ID + 1);
+	assert_int_equal(msg.len, sizeof(MOCK_MSG_2));
+	assert_string_equal(msg.ptr, MOCK_MSG_2);
+
+	/* configure mocks */
+	expect_value(rpma_recv_ring_release, msg->slot, 0);
+	will_return(rpma_recv_ring_release, MOCK_OK);
+
+	/* run test */
+	ret = rpma_msgr_next(rstate->msgr, &msg);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NO_COMPLETION);
+}
+
+/*
+ * recv__credits -- the credits carried by a header-only batch are taken
+ * and its receive buffer is released at once
+ */
+static void
+recv__credits(void **rstate_ptr)
+{
+	struct msgr_test_state *rstate = *rstate_ptr;
+	uint64_t corr_id;
+
+	assert_int_equal(rpma_msgr_request(rstate->msgr, MOCK_MSG,
+			MOCK_MSG_LEN, &corr_id), MOCK_OK);
+	msgr_expect_send(rstate, 0, MOCK_MSG_BATCH_LEN);
+	assert_int_equal(rpma_msgr_flush(rstate->msgr), MOCK_OK);
+	assert_int_equal(get_credits(rstate), MOCK_CREDITS - 1);
+
+	/* configure mocks */
+	msgr_batch(rstate, 0, 1);
+	expect_value(rpma_recv_ring_release, msg->slot, 0);
+	will_return(rpma_recv_ring_release, MOCK_OK);
+
+	/* run test */
+	int ret = msgr_receive(rstate, 0);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(get_credits(rstate), MOCK_CREDITS);
+}
+
+/*
+ * recv__credits_announced -- the credits are returned with a header-only
+ * batch when half of them is waiting
+ */
+static void
+recv__credits_announced(void **rstate_ptr)
+{
+	struct msgr_test_state *rstate = *rstate_ptr;
+	struct rpma_msgr_msg msg;
+
+	for (uint32_t i = 0; i < MOCK_CREDITS / 2; ++i) {
+		msgr_batch(rstate, i, 0);
+		msgr_batch_add(rstate, i, RPMA_MSGR_REQUEST, i, MOCK_MSG);
+		assert_int_equal(msgr_receive(rstate, i), MOCK_OK);
+	}
+
+	for (uint32_t i = 0; i < MOCK_CREDITS / 2; ++i) {
+		if (i > 0) {
+			expect_value(rpma_recv_ring_release, msg->slot, i - 1);
+			will_return(rpma_recv_ring_release, MOCK_OK);
+		}
+		assert_int_equal(rpma_msgr_next(rstate->msgr, &msg), MOCK_OK);
+		assert_int_equal(msg.corr_id, i);
+	}
+
+	/* configure mocks */
+	expect_value(rpma_recv_ring_release, msg->slot, MOCK_CREDITS / 2 - 1);
+	will_return(rpma_recv_ring_release, MOCK_OK);
+	will_return(rpma_recv_ring_repost, MOCK_OK);
+	msgr_expect_send(rstate, 0, sizeof(struct rpma_msgr_hdr));
+
+	/* run test */
+	int ret = rpma_msgr_next(rstate->msgr, &msg);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NO_COMPLETION);
+	assert_int_equal(get_credits(rstate), MOCK_CREDITS - 1);
+
+	struct rpma_msgr_hdr *hdr = (struct rpma_msgr_hdr *)SEND_BUF(rstate, 0);
+	assert_int_equal(hdr->credits, MOCK_CREDITS / 2);
+	assert_int_equal(hdr->nmsgs, 0);
+}
+
+/*
+ * recv__credits_piggybacked -- the credits are returned along with
+ * the next batch
+ */
+static void
+recv__credits_piggybacked(void **rstate_ptr)
+{
+	struct msgr_test_state *rstate = *rstate_ptr;
+	struct rpma_msgr_msg msg;
+	uint64_t corr_id;
+
+	msgr_batch(rstate, 0, 0);
+	msgr_batch_add(rstate, 0, RPMA_MSGR_REQUEST, MOCK_CORR_ID, MOCK_MSG);
+	assert_int_equal(msgr_receive(rstate, 0), MOCK_OK);
+	assert_int_equal(rpma_msgr_next(rstate->msgr, &msg), MOCK_OK);
+	assert_int_equal(rpma_msgr_respond(rstate->msgr, msg.corr_id,
+			MOCK_MSG, MOCK_MSG_LEN), MOCK_OK);
+
+	/* the response is not read anymore so the buffer is released */
+	expect_value(rpma_recv_ring_release, msg->slot, 0);
+	will_return(rpma_recv_ring_release, MOCK_OK);
+	assert_int_equal(rpma_msgr_next(rstate->msgr, &msg),
+			RPMA_E_NO_COMPLETION);
+
+	/* configure mocks */
+	will_return(rpma_recv_ring_repost, MOCK_OK);
+	msgr_expect_send(rstate, 0, MOCK_MSG_BATCH_LEN);
+
+	/* run test */
+	int ret = rpma_msgr_flush(rstate->msgr);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+
+	struct rpma_msgr_hdr *hdr = (struct rpma_msgr_hdr *)SEND_BUF(rstate, 0);
+	assert_int_equal(hdr->credits, 1);
+	assert_int_equal(hdr->nmsgs, 1);
+
+	/* nothing is waiting anymore */
+	assert_int_equal(rpma_msgr_request(rstate->msgr, MOCK_MSG,
+			MOCK_MSG_LEN, &corr_id), MOCK_OK);
+	msgr_expect_send(rstate, 1, MOCK_MSG_BATCH_LEN);
+	assert_int_equal(rpma_msgr_flush(rstate->msgr), MOCK_OK);
+
+	hdr = (struct rpma_msgr_hdr *)SEND_BUF(rstate, 1);
+	assert_int_equal(hdr->credits, 0);
+}
+
+static const struct CMUnitTest tests_recv[] = {
+	/* rpma_msgr_process() unit tests */
+	cmocka_unit_test_setup_teardown(process__invalid_args,
+		setup__msgr_new, teardown__msgr_delete),
+	cmocka_unit_test_setup_teardown(process__foreign_cmpl,
+		setup__msgr_new, teardown__msgr_delete),
+	cmocka_unit_test_setup_teardown(process__send,
+		setup__msgr_new, teardown__msgr_delete),
+	cmocka_unit_test_setup_teardown(process__send_failed,
+		setup__msgr_new, teardown__msgr_delete),
+	cmocka_unit_test_setup_teardown(process__recv_failed,
+		setup__msgr_new, teardown__msgr_delete),
+	cmocka_unit_test_setup_teardown(process__recv_malformed,
+		setup__msgr_new, teardown__msgr_delete),
+
+	/* rpma_msgr_next() unit tests */
+	cmocka_unit_test_setup_teardown(next__invalid_args,
+		setup__msgr_new, teardown__msgr_delete),
+	cmocka_unit_test_setup_teardown(next__empty,
+		setup__msgr_new, teardown__msgr_delete),
+	cmocka_unit_test_setup_teardown(next__batch,
+		setup__msgr_new, teardown__msgr_delete),
+
+	/* the flow control */
+	cmocka_unit_test_setup_teardown(recv__credits,
+		setup__msgr_new, teardown__msgr_delete),
+	cmocka_unit_test_setup_teardown(recv__credits_announced,
+		setup__msgr_new, teardown__msgr_delete),
+	cmocka_unit_test_setup_teardown(recv__credits_piggybacked,
+		setup__msgr_new, teardown__msgr_delete),
+
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_recv, NULL, NULL);
+}
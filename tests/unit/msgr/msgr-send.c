@@ -0,0 +1,339 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * msgr-send.c -- the rpma_msgr_request/respond/flush() unit tests
+ *
+ * APIs covered:
+ * - rpma_msgr_request()
+ * - rpma_msgr_respond()
+ * - rpma_msgr_flush()
+ * - rpma_msgr_get_credits()
+ */
+
+#include <string.h>
+
+#include "msgr-common.h"
+
+#define MOCK_CORR_ID		(uint64_t)0xC022
+
+/* a batch header and two messages */
+#define MOCK_MSG2_BATCH_LEN	(MOCK_MSG_BATCH_LEN + \
+		sizeof(struct rpma_msgr_msg_hdr) + 8)
+
+/*
+ * get_credits -- get the number of the peer's credits
+ */
+static uint32_t
+get_credits(struct msgr_test_state *rstate)
+{
+	uint32_t credits = 0;
+	assert_int_equal(rpma_msgr_get_credits(rstate->msgr, &credits),
+			MOCK_OK);
+
+	return credits;
+}
+
+/*
+ * request__invalid_args -- invalid combinations of the arguments
+ */
+static void
+request__invalid_args(void **rstate_ptr)
+{
+	struct msgr_test_state *rstate = *rstate_ptr;
+	uint64_t corr_id;
+	char big[MOCK_BUF_SIZE] = {0};
+
+	/* msgr == NULL */
+	assert_int_equal(rpma_msgr_request(NULL, MOCK_MSG, MOCK_MSG_LEN,
+			&corr_id), RPMA_E_INVAL);
+	/* corr_id == NULL */
+	assert_int_equal(rpma_msgr_request(rstate->msgr, MOCK_MSG,
+			MOCK_MSG_LEN, NULL), RPMA_E_INVAL);
+	/* data == NULL && len != 0 */
+	assert_int_equal(rpma_msgr_request(rstate->msgr, NULL, MOCK_MSG_LEN,
+			&corr_id), RPMA_E_INVAL);
+	/* the message does not fit in a single buffer */
+	assert_int_equal(rpma_msgr_request(rstate->msgr, big, sizeof(big),
+			&corr_id), RPMA_E_INVAL);
+}
+
+/*
+ * respond__invalid_args -- invalid combinations of the arguments
+ */
+static void
+respond__invalid_args(void **rstate_ptr)
+{
+	struct msgr_test_state *rstate = *rstate_ptr;
+	char big[MOCK_BUF_SIZE] = {0};
+
+	/* msgr == NULL */
+	assert_int_equal(rpma_msgr_respond(NULL, MOCK_CORR_ID, MOCK_MSG,
+			MOCK_MSG_LEN), RPMA_E_INVAL);
+	/* data == NULL && len != 0 */
+	assert_int_equal(rpma_msgr_respond(rstate->msgr, MOCK_CORR_ID, NULL,
+			MOCK_MSG_LEN), RPMA_E_INVAL);
+	/* the message does not fit in a single buffer */
+	assert_int_equal(rpma_msgr_respond(rstate->msgr, MOCK_CORR_ID, big,
+			sizeof(big)), RPMA_E_INVAL);
+}
+
+/*
+ * flush__msgr_NULL -- NULL msgr is invalid
+ */
+static void
+flush__msgr_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_msgr_flush(NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * flush__no_batch -- there is nothing to send - quick exit
+ */
+static void
+flush__no_batch(void **rstate_ptr)
+{
+	struct msgr_test_state *rstate = *rstate_ptr;
+
+	/* run test */
+	int ret = rpma_msgr_flush(rstate->msgr);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(get_credits(rstate), MOCK_CREDITS);
+}
+
+/*
+ * get_credits__invalid_args -- NULL msgr or credits is invalid
+ */
+static void
+get_credits__invalid_args(void **rstate_ptr)
+{
+	struct msgr_test_state *rstate = *rstate_ptr;
+	uint32_t credits;
+
+	assert_int_equal(rpma_msgr_get_credits(NULL, &credits),
+			RPMA_E_INVAL);
+	assert_int_equal(rpma_msgr_get_credits(rstate->msgr, NULL),
+			RPMA_E_INVAL);
+}
+
+/*
+ * request_respond__batch -- a request and a response are sent
+ * in a single batch
+ */
+static void
+request_respond__batch(void **rstate_ptr)
+{
+	struct msgr_test_state *rstate = *rstate_ptr;
+
+	/* run test */
+	uint64_t corr_id = 0;
+	assert_int_equal(rpma_msgr_request(rstate->msgr, MOCK_MSG,
+			MOCK_MSG_LEN, &corr_id), MOCK_OK);
+	assert_int_equal(rpma_msgr_respond(rstate->msgr, MOCK_CORR_ID,
+			MOCK_MSG, MOCK_MSG_LEN), MOCK_OK);
+
+	/* configure mocks */
+	msgr_expect_send(rstate, 0, MOCK_MSG2_BATCH_LEN);
+
+	/* run test */
+	int ret = rpma_msgr_flush(rstate->msgr);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(corr_id, 1);
+	assert_int_equal(get_credits(rstate), MOCK_CREDITS - 1);
+
+	struct rpma_msgr_hdr *hdr = (struct rpma_msgr_hdr *)SEND_BUF(rstate, 0);
+	assert_int_equal(hdr->credits, 0);
+	assert_int_equal(hdr->nmsgs, 2);
+
+	struct rpma_msgr_msg_hdr *mhdr = (struct rpma_msgr_msg_hdr *)(hdr + 1);
+	assert_int_equal(mhdr->type, RPMA_MSGR_REQUEST);
+	assert_int_equal(mhdr->corr_id, corr_id);
+	assert_int_equal(mhdr->len, MOCK_MSG_LEN);
+	assert_memory_equal(mhdr + 1, MOCK_MSG, MOCK_MSG_LEN);
+
+	mhdr = (struct rpma_msgr_msg_hdr *)((char *)(mhdr + 1) + 8);
+	assert_int_equal(mhdr->type, RPMA_MSGR_RESPONSE);
+	assert_int_equal(mhdr->corr_id, MOCK_CORR_ID);
+	assert_int_equal(mhdr->len, MOCK_MSG_LEN);
+	assert_memory_equal(mhdr + 1, MOCK_MSG, MOCK_MSG_LEN);
+}
+
+/*
+ * request__corr_id -- every request gets a new correlation ID
+ */
+static void
+request__corr_id(void **rstate_ptr)
+{
+	struct msgr_test_state *rstate = *rstate_ptr;
+	uint64_t corr_id1 = 0;
+	uint64_t corr_id2 = 0;
+
+	/* run test */
+	assert_int_equal(rpma_msgr_request(rstate->msgr, NULL, 0, &corr_id1),
+			MOCK_OK);
+	assert_int_equal(rpma_msgr_request(rstate->msgr, NULL, 0, &corr_id2),
+			MOCK_OK);
+
+	/* verify the results */
+	assert_int_not_equal(corr_id1, corr_id2);
+
+	/* configure mocks */
+	msgr_expect_send(rstate, 0, sizeof(struct rpma_msgr_hdr) +
+			2 * sizeof(struct rpma_msgr_msg_hdr));
+
+	/* send the batch so the teardown finds the messenger clean */
+	assert_int_equal(rpma_msgr_flush(rstate->msgr), MOCK_OK);
+}
+
+/*
+ * request__batch_full -- the batch is sent when the next message does
+ * not fit in it
+ */
+static void
+request__batch_full(void **rstate_ptr)
+{
+	struct msgr_test_state *rstate = *rstate_ptr;
+	uint64_t corr_id;
+
+	assert_int_equal(rpma_msgr_request(rstate->msgr, MOCK_MSG,
+			MOCK_MSG_LEN, &corr_id), MOCK_OK);
+	assert_int_equal(rpma_msgr_request(rstate->msgr, MOCK_MSG,
+			MOCK_MSG_LEN, &corr_id), MOCK_OK);
+
+	/* configure mocks */
+	msgr_expect_send(rstate, 0, MOCK_MSG2_BATCH_LEN);
+
+	/* run test */
+	int ret = rpma_msgr_request(rstate->msgr, MOCK_MSG, MOCK_MSG_LEN,
+			&corr_id);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(corr_id, 3);
+
+	/* configure mocks */
+	msgr_expect_send(rstate, 1, MOCK_MSG_BATCH_LEN);
+
+	/* run test */
+	ret = rpma_msgr_flush(rstate->msgr);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(get_credits(rstate), MOCK_CREDITS - 2);
+}
+
+/*
+ * flush__reserved_credit -- the last credit is reserved for returning
+ * the credits
+ */
+static void
+flush__reserved_credit(void **rstate_ptr)
+{
+	struct msgr_test_state *rstate = *rstate_ptr;
+	uint64_t corr_id;
+
+	for (uint32_t i = 0; i < MOCK_CREDITS - 1; ++i) {
+		assert_int_equal(rpma_msgr_request(rstate->msgr, MOCK_MSG,
+				MOCK_MSG_LEN, &corr_id), MOCK_OK);
+
+		/* configure mocks */
+		msgr_expect_send(rstate, i, MOCK_MSG_BATCH_LEN);
+
+		assert_int_equal(rpma_msgr_flush(rstate->msgr), MOCK_OK);
+	}
+
+	assert_int_equal(get_credits(rstate), 1);
+
+	/* run test */
+	assert_int_equal(rpma_msgr_request(rstate->msgr, MOCK_MSG,
+			MOCK_MSG_LEN, &corr_id), MOCK_OK);
+	int ret = rpma_msgr_flush(rstate->msgr);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_AGAIN);
+
+	/* the batch cannot grow beyond a single buffer */
+	assert_int_equal(rpma_msgr_request(rstate->msgr, MOCK_MSG,
+			MOCK_MSG_LEN, &corr_id), MOCK_OK);
+	ret = rpma_msgr_request(rstate->msgr, MOCK_MSG, MOCK_MSG_LEN,
+			&corr_id);
+	assert_int_equal(ret, RPMA_E_AGAIN);
+	assert_int_equal(get_credits(rstate), 1);
+}
+
+/*
+ * flush__send_E_PROVIDER -- rpma_send() fails with RPMA_E_PROVIDER
+ */
+static void
+flush__send_E_PROVIDER(void **rstate_ptr)
+{
+	struct msgr_test_state *rstate = *rstate_ptr;
+	uint64_t corr_id;
+
+	assert_int_equal(rpma_msgr_request(rstate->msgr, MOCK_MSG,
+			MOCK_MSG_LEN, &corr_id), MOCK_OK);
+
+	/* configure mocks */
+	expect_value(rpma_send, src, MOCK_RPMA_MR_LOCAL);
+	expect_value(rpma_send, offset, 0);
+	expect_value(rpma_send, len, MOCK_MSG_BATCH_LEN);
+	expect_value(rpma_send, flags, RPMA_F_COMPLETION_ALWAYS);
+	expect_value(rpma_send, op_context, SEND_BUF(rstate, 0));
+	will_return(rpma_send, RPMA_E_PROVIDER);
+
+	/* run test */
+	int ret = rpma_msgr_flush(rstate->msgr);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_int_equal(get_credits(rstate), MOCK_CREDITS);
+
+	/* configure mocks */
+	msgr_expect_send(rstate, 0, MOCK_MSG_BATCH_LEN);
+
+	/* the batch is kept so the send can be retried */
+	assert_int_equal(rpma_msgr_flush(rstate->msgr), MOCK_OK);
+}
+
+static const struct CMUnitTest tests_send[] = {
+	/* rpma_msgr_request/respond() unit tests */
+	cmocka_unit_test_setup_teardown(request__invalid_args,
+		setup__msgr_new, teardown__msgr_delete),
+	cmocka_unit_test_setup_teardown(respond__invalid_args,
+		setup__msgr_new, teardown__msgr_delete),
+	cmocka_unit_test_setup_teardown(request_respond__batch,
+		setup__msgr_new, teardown__msgr_delete),
+	cmocka_unit_test_setup_teardown(request__corr_id,
+		setup__msgr_new, teardown__msgr_delete),
+	cmocka_unit_test_setup_teardown(request__batch_full,
+		setup__msgr_new, teardown__msgr_delete),
+
+	/* rpma_msgr_flush() unit tests */
+	cmocka_unit_test(flush__msgr_NULL),
+	cmocka_unit_test_setup_teardown(flush__no_batch,
+		setup__msgr_new, teardown__msgr_delete),
+	cmocka_unit_test_setup_teardown(flush__reserved_credit,
+		setup__msgr_new, teardown__msgr_delete),
+	cmocka_unit_test_setup_teardown(flush__send_E_PROVIDER,
+		setup__msgr_new, teardown__msgr_delete),
+
+	/* rpma_msgr_get_credits() unit tests */
+	cmocka_unit_test_setup_teardown(get_credits__invalid_args,
+		setup__msgr_new, teardown__msgr_delete),
+
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_send, NULL, NULL);
+}
@@ -0,0 +1,61 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * numa-comp_vector_auto.c -- the rpma_numa_comp_vector_auto() unit tests
+ *
+ * API covered:
+ * - rpma_numa_comp_vector_auto()
+ */
+
+#include "cmocka_headers.h"
+#include "numa.h"
+#include "test-common.h"
+
+#define MOCK_NUM_COMP_VECTORS	3
+
+/*
+ * comp_vector_auto__no_vectors -- a device reporting no completion vectors
+ * gets the completion vector 0
+ */
+static void
+comp_vector_auto__no_vectors(void **unused)
+{
+	struct ibv_context context = {0};
+	context.num_comp_vectors = 0;
+
+	/* run test */
+	int comp_vector = rpma_numa_comp_vector_auto(&context);
+
+	/* verify the results */
+	assert_int_equal(comp_vector, 0);
+}
+
+/*
+ * comp_vector_auto__success -- the selected completion vector is a valid one
+ */
+static void
+comp_vector_auto__success(void **unused)
+{
+	struct ibv_context context = {0};
+	context.num_comp_vectors = MOCK_NUM_COMP_VECTORS;
+
+	/* run test */
+	int comp_vector = rpma_numa_comp_vector_auto(&context);
+
+	/* verify the results */
+	assert_true(comp_vector >= 0);
+	assert_true(comp_vector < MOCK_NUM_COMP_VECTORS);
+}
+
+int
+main(int argc, char *argv[])
+{
+	const struct CMUnitTest tests[] = {
+		/* rpma_numa_comp_vector_auto() unit tests */
+		cmocka_unit_test(comp_vector_auto__no_vectors),
+		cmocka_unit_test(comp_vector_auto__success),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,162 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * numa-node_of_device.c -- the rpma_numa_node_of_device() unit tests
+ *
+ * API covered:
+ * - rpma_numa_node_of_device()
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "cmocka_headers.h"
+#include "numa.h"
+#include "test-common.h"
+
+#define MOCK_NUMA_NODE		(-2) /* an impossible value */
+
+static struct ibv_device Device;
+static struct ibv_context Context = {&Device};
+
+struct sysfs_state {
+	char ibdev_path[64]; /* a fake /sys/class/infiniband/<dev> */
+	char device_dir[128];
+	char numa_node[192];
+};
+
+/*
+ * setup__sysfs -- prepare a fake sysfs directory of the device
+ */
+static int
+setup__sysfs(void **sstate_ptr)
+{
+	static struct sysfs_state sstate;
+
+	strcpy(sstate.ibdev_path, "/tmp/rpma-numa-XXXXXX");
+	assert_non_null(mkdtemp(sstate.ibdev_path));
+
+	snprintf(sstate.device_dir, sizeof(sstate.device_dir), "%s/device",
+			sstate.ibdev_path);
+	assert_int_equal(mkdir(sstate.device_dir, 0700), 0);
+
+	snprintf(sstate.numa_node, sizeof(sstate.numa_node), "%s/numa_node",
+			sstate.device_dir);
+
+	strcpy(Device.ibdev_path, sstate.ibdev_path);
+
+	*sstate_ptr = &sstate;
+	return 0;
+}
+
+/*
+ * teardown__sysfs -- remove the fake sysfs directory of the device
+ */
+static int
+teardown__sysfs(void **sstate_ptr)
+{
+	struct sysfs_state *sstate = *sstate_ptr;
+
+	(void) unlink(sstate->numa_node);
+	assert_int_equal(rmdir(sstate->device_dir), 0);
+	assert_int_equal(rmdir(sstate->ibdev_path), 0);
+
+	return 0;
+}
+
+/*
+ * write_numa_node -- write the content of the numa_node file
+ */
+static void
+write_numa_node(struct sysfs_state *sstate, const char *content)
+{
+	FILE *file = fopen(sstate->numa_node, "w");
+	assert_non_null(file);
+	assert_int_equal(fputs(content, file) >= 0, 1);
+	assert_int_equal(fclose(file), 0);
+}
+
+/*
+ * node_of_device__no_file -- no numa_node file means the node is unknown
+ */
+static void
+node_of_device__no_file(void **sstate_ptr)
+{
+	/* run test */
+	int node = MOCK_NUMA_NODE;
+	rpma_numa_node_of_device(&Context, &node);
+
+	/* verify the results */
+	assert_int_equal(node, RPMA_NUMA_NODE_ANY);
+}
+
+/*
+ * node_of_device__no_affinity -- -1 in the numa_node file means the device
+ * has no NUMA affinity
+ */
+static void
+node_of_device__no_affinity(void **sstate_ptr)
+{
+	write_numa_node(*sstate_ptr, "-1\n");
+
+	/* run test */
+	int node = MOCK_NUMA_NODE;
+	rpma_numa_node_of_device(&Context, &node);
+
+	/* verify the results */
+	assert_int_equal(node, RPMA_NUMA_NODE_ANY);
+}
+
+/*
+ * node_of_device__garbage -- an unparsable numa_node file means the node
+ * is unknown
+ */
+static void
+node_of_device__garbage(void **sstate_ptr)
+{
+	write_numa_node(*sstate_ptr, "garbage\n");
+
+	/* run test */
+	int node = MOCK_NUMA_NODE;
+	rpma_numa_node_of_device(&Context, &node);
+
+	/* verify the results */
+	assert_int_equal(node, RPMA_NUMA_NODE_ANY);
+}
+
+/*
+ * node_of_device__success -- the NUMA node is read from the numa_node file
+ */
+static void
+node_of_device__success(void **sstate_ptr)
+{
+	write_numa_node(*sstate_ptr, "1\n");
+
+	/* run test */
+	int node = MOCK_NUMA_NODE;
+	rpma_numa_node_of_device(&Context, &node);
+
+	/* verify the results */
+	assert_int_equal(node, 1);
+}
+
+int
+main(int argc, char *argv[])
+{
+	const struct CMUnitTest tests[] = {
+		/* rpma_numa_node_of_device() unit tests */
+		cmocka_unit_test_setup_teardown(node_of_device__no_file,
+				setup__sysfs, teardown__sysfs),
+		cmocka_unit_test_setup_teardown(node_of_device__no_affinity,
+				setup__sysfs, teardown__sysfs),
+		cmocka_unit_test_setup_teardown(node_of_device__garbage,
+				setup__sysfs, teardown__sysfs),
+		cmocka_unit_test_setup_teardown(node_of_device__success,
+				setup__sysfs, teardown__sysfs),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
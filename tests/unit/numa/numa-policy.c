@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * numa-policy.c -- the rpma_numa_policy_set/restore() unit tests
+ *
+ * APIs covered:
+ * - rpma_numa_policy_set()
+ * - rpma_numa_policy_restore()
+ */
+
+#include "cmocka_headers.h"
+#include "numa.h"
+#include "test-common.h"
+
+/*
+ * policy__node_any -- RPMA_NUMA_NODE_ANY does not change the memory policy
+ */
+static void
+policy__node_any(void **unused)
+{
+	struct rpma_numa_policy policy;
+	policy.changed = 1;
+
+	/* run test */
+	rpma_numa_policy_set(RPMA_NUMA_NODE_ANY, &policy);
+
+	/* verify the results */
+	assert_int_equal(policy.changed, 0);
+
+	/* restoring an unchanged policy is a no-op */
+	rpma_numa_policy_restore(&policy);
+	assert_int_equal(policy.changed, 0);
+}
+
+/*
+ * policy__node_out_of_range -- a node out of the supported range does not
+ * change the memory policy
+ */
+static void
+policy__node_out_of_range(void **unused)
+{
+	struct rpma_numa_policy policy;
+	policy.changed = 1;
+
+	/* run test */
+	rpma_numa_policy_set(RPMA_NUMA_NODES_MAX, &policy);
+
+	/* verify the results */
+	assert_int_equal(policy.changed, 0);
+}
+
+/*
+ * policy__lifecycle -- prefer the node 0 (present on every platform) and
+ * restore the previous policy (it may be not permitted in a container)
+ */
+static void
+policy__lifecycle(void **unused)
+{
+	struct rpma_numa_policy policy;
+
+	/* run test */
+	rpma_numa_policy_set(0, &policy);
+	rpma_numa_policy_restore(&policy);
+
+	/* verify the results */
+	assert_int_equal(policy.changed, 0);
+}
+
+int
+main(int argc, char *argv[])
+{
+	const struct CMUnitTest tests[] = {
+		/* rpma_numa_policy_set/restore() unit tests */
+		cmocka_unit_test(policy__node_any),
+		cmocka_unit_test(policy__node_out_of_range),
+		cmocka_unit_test(policy__lifecycle),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
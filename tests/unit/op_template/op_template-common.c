@@ -0,0 +1,217 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * op_template-common.c -- the rpma_op_template unit tests common functions
+ */
+
+#include <string.h>
+
+#include "op_template-common.h"
+#include "conn.h"
+#include "mr.h"
+
+static struct ibv_context Tmpl_context;
+static struct ibv_qp Tmpl_qp = {.context = &Tmpl_context};
+
+/*
+ * tmpl_post_send -- ibv_post_send() mock checking the patched work request
+ */
+static int
+tmpl_post_send(struct ibv_qp *qp, struct ibv_send_wr *wr,
+		struct ibv_send_wr **bad_wr)
+{
+	assert_ptr_equal(qp, &Tmpl_qp);
+	assert_non_null(wr);
+	assert_non_null(bad_wr);
+	assert_null(wr->next);
+	assert_int_equal(wr->num_sge, 1);
+
+	check_expected(wr->opcode);
+	check_expected(wr->wr_id);
+	check_expected(wr->wr.rdma.remote_addr);
+	assert_int_equal(wr->wr.rdma.rkey, MOCK_RKEY);
+	check_expected(wr->sg_list->addr);
+	check_expected(wr->sg_list->length);
+	assert_int_equal(wr->sg_list->lkey, MOCK_LKEY);
+
+	return mock_type(int);
+}
+
+/*
+ * rpma_conn_get_ibv_qp -- rpma_conn_get_ibv_qp() mock
+ */
+int
+rpma_conn_get_ibv_qp(const struct rpma_conn *conn, struct ibv_qp **qp_ptr)
+{
+	assert_ptr_equal(conn, MOCK_CONN);
+	assert_non_null(qp_ptr);
+
+	int ret = mock_type(int);
+	if (ret == MOCK_OK)
+		*qp_ptr = &Tmpl_qp;
+
+	return ret;
+}
+
+/*
+ * rpma_conn_reads_posted -- rpma_conn_reads_posted() mock
+ */
+void
+rpma_conn_reads_posted(struct rpma_conn *conn)
+{
+	check_expected(conn);
+}
+
+/*
+ * tmpl_fill_wr -- fill the work request the way the memory regions would
+ */
+static void
+tmpl_fill_wr(struct ibv_send_wr *wr, struct ibv_sge *sge,
+		enum ibv_wr_opcode opcode, int flags)
+{
+	memset(wr, 0, sizeof(*wr));
+	wr->opcode = opcode;
+	wr->wr.rdma.remote_addr = MOCK_REMOTE_ADDR;
+	wr->wr.rdma.rkey = MOCK_RKEY;
+	wr->sg_list = sge;
+	wr->num_sge = 1;
+	wr->send_flags = (flags & RPMA_F_COMPLETION_ON_SUCCESS) ?
+		IBV_SEND_SIGNALED : 0;
+
+	sge->addr = MOCK_LOCAL_ADDR;
+	sge->length = 0;
+	sge->lkey = MOCK_LKEY;
+}
+
+/*
+ * rpma_mr_read_wr -- rpma_mr_read_wr() mock
+ */
+void
+rpma_mr_read_wr(struct ibv_send_wr *wr, struct ibv_sge *sge,
+	struct rpma_mr_local *dst, size_t dst_offset,
+	const struct rpma_mr_remote *src,  size_t src_offset,
+	size_t len, int flags, const void *op_context)
+{
+	assert_ptr_equal(dst, MOCK_RPMA_MR_LOCAL);
+	assert_int_equal(dst_offset, 0);
+	assert_ptr_equal(src, MOCK_RPMA_MR_REMOTE);
+	assert_int_equal(src_offset, 0);
+	assert_int_equal(len, 0);
+	assert_int_equal(flags, RPMA_F_COMPLETION_ALWAYS);
+	assert_null(op_context);
+
+	tmpl_fill_wr(wr, sge, IBV_WR_RDMA_READ, flags);
+}
+
+/*
+ * rpma_mr_write_wr -- rpma_mr_write_wr() mock
+ */
+int
+rpma_mr_write_wr(struct ibv_send_wr *wr, struct ibv_sge *sge,
+	struct rpma_mr_remote *dst, size_t dst_offset,
+	const struct rpma_mr_local *src,  size_t src_offset,
+	size_t len, int flags, enum ibv_wr_opcode operation,
+	uint32_t imm, const void *op_context, bool fence)
+{
+	assert_ptr_equal(dst, MOCK_RPMA_MR_REMOTE);
+	assert_int_equal(dst_offset, 0);
+	assert_ptr_equal(src, MOCK_RPMA_MR_LOCAL);
+	assert_int_equal(src_offset, 0);
+	assert_int_equal(len, 0);
+	assert_int_equal(flags, RPMA_F_COMPLETION_ALWAYS);
+	assert_int_equal(operation, IBV_WR_RDMA_WRITE);
+	assert_int_equal(imm, 0);
+	assert_null(op_context);
+	assert_false(fence);
+
+	tmpl_fill_wr(wr, sge, operation, flags);
+
+	return 0;
+}
+
+/*
+ * expect_post -- expect the work request patched with the given values
+ * to be posted
+ */
+void
+expect_post(enum ibv_wr_opcode opcode, size_t local_offset,
+		size_t remote_offset, size_t len, void *op_context, int ret)
+{
+	expect_value(tmpl_post_send, wr->opcode, opcode);
+	expect_value(tmpl_post_send, wr->wr_id, (uint64_t)op_context);
+	expect_value(tmpl_post_send, wr->wr.rdma.remote_addr,
+			MOCK_REMOTE_ADDR + remote_offset);
+	expect_value(tmpl_post_send, wr->sg_list->addr,
+			MOCK_LOCAL_ADDR + local_offset);
+	expect_value(tmpl_post_send, wr->sg_list->length, len);
+	will_return(tmpl_post_send, ret);
+}
+
+/*
+ * setup__op_template_new -- prepare a valid template of the given type
+ */
+static int
+setup__op_template_new(void **tstate_ptr, enum rpma_op_template_type type)
+{
+	static struct op_template_test_state tstate = {0};
+
+	Tmpl_context.ops.post_send = tmpl_post_send;
+
+	/* configure mocks */
+	will_return(rpma_conn_get_ibv_qp, MOCK_OK);
+	will_return(__wrap__test_malloc, MOCK_OK);
+
+	/* run test */
+	tstate.type = type;
+	tstate.tmpl = NULL;
+	int ret = rpma_op_template_new(MOCK_CONN, type, MOCK_RPMA_MR_LOCAL,
+			MOCK_RPMA_MR_REMOTE, RPMA_F_COMPLETION_ALWAYS,
+			&tstate.tmpl);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_non_null(tstate.tmpl);
+
+	*tstate_ptr = &tstate;
+
+	return 0;
+}
+
+/*
+ * setup__op_template_read -- prepare a valid template of a read
+ */
+int
+setup__op_template_read(void **tstate_ptr)
+{
+	return setup__op_template_new(tstate_ptr, RPMA_OP_TEMPLATE_READ);
+}
+
+/*
+ * setup__op_template_write -- prepare a valid template of a write
+ */
+int
+setup__op_template_write(void **tstate_ptr)
+{
+	return setup__op_template_new(tstate_ptr, RPMA_OP_TEMPLATE_WRITE);
+}
+
+/*
+ * teardown__op_template_delete -- delete the template
+ */
+int
+teardown__op_template_delete(void **tstate_ptr)
+{
+	struct op_template_test_state *tstate = *tstate_ptr;
+
+	/* run test */
+	int ret = rpma_op_template_delete(&tstate->tmpl);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_null(tstate->tmpl);
+
+	*tstate_ptr = NULL;
+
+	return 0;
+}
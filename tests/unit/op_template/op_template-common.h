@@ -0,0 +1,35 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * op_template-common.h -- the rpma_op_template unit tests common definitions
+ */
+
+#ifndef OP_TEMPLATE_COMMON_H
+#define OP_TEMPLATE_COMMON_H
+
+#include "cmocka_headers.h"
+#include "librpma.h"
+#include "test-common.h"
+
+#define MOCK_RPMA_MR_REMOTE	(struct rpma_mr_remote *)0xC412
+#define MOCK_REMOTE_OFFSET	(size_t)0xC414
+#define MOCK_LOCAL_ADDR		(uint64_t)0x10000
+#define MOCK_REMOTE_ADDR	(uint64_t)0x20000
+#define MOCK_LKEY		(uint32_t)0x1111
+#define MOCK_RKEY		(uint32_t)0x2222
+#define MOCK_OP_CONTEXT_2	(void *)0xC418
+
+struct op_template_test_state {
+	enum rpma_op_template_type type;
+	struct rpma_op_template *tmpl;
+};
+
+int setup__op_template_read(void **tstate_ptr);
+int setup__op_template_write(void **tstate_ptr);
+int teardown__op_template_delete(void **tstate_ptr);
+
+void expect_post(enum ibv_wr_opcode opcode, size_t local_offset,
+		size_t remote_offset, size_t len, void *op_context, int ret);
+
+#endif /* OP_TEMPLATE_COMMON_H */
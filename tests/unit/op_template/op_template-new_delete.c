@@ -0,0 +1,151 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * op_template-new_delete.c -- the rpma_op_template_new/delete() unit tests
+ *
+ * APIs covered:
+ * - rpma_op_template_new()
+ * - rpma_op_template_delete()
+ */
+
+#include "op_template-common.h"
+
+/*
+ * new__invalid_args -- invalid combinations of the arguments
+ */
+static void
+new__invalid_args(void **unused)
+{
+	/* run test */
+	struct rpma_op_template *tmpl = NULL;
+	int ret1 = rpma_op_template_new(NULL, RPMA_OP_TEMPLATE_READ,
+			MOCK_RPMA_MR_LOCAL, MOCK_RPMA_MR_REMOTE, MOCK_FLAGS,
+			&tmpl);
+	int ret2 = rpma_op_template_new(MOCK_CONN, RPMA_OP_TEMPLATE_READ,
+			NULL, MOCK_RPMA_MR_REMOTE, MOCK_FLAGS, &tmpl);
+	int ret3 = rpma_op_template_new(MOCK_CONN, RPMA_OP_TEMPLATE_READ,
+			MOCK_RPMA_MR_LOCAL, NULL, MOCK_FLAGS, &tmpl);
+	int ret4 = rpma_op_template_new(MOCK_CONN, RPMA_OP_TEMPLATE_READ,
+			MOCK_RPMA_MR_LOCAL, MOCK_RPMA_MR_REMOTE, 0, &tmpl);
+	int ret5 = rpma_op_template_new(MOCK_CONN, RPMA_OP_TEMPLATE_READ,
+			MOCK_RPMA_MR_LOCAL, MOCK_RPMA_MR_REMOTE, MOCK_FLAGS,
+			NULL);
+	int ret6 = rpma_op_template_new(MOCK_CONN,
+			(enum rpma_op_template_type)(-1), MOCK_RPMA_MR_LOCAL,
+			MOCK_RPMA_MR_REMOTE, MOCK_FLAGS, &tmpl);
+
+	/* verify the results */
+	assert_int_equal(ret1, RPMA_E_INVAL);
+	assert_int_equal(ret2, RPMA_E_INVAL);
+	assert_int_equal(ret3, RPMA_E_INVAL);
+	assert_int_equal(ret4, RPMA_E_INVAL);
+	assert_int_equal(ret5, RPMA_E_INVAL);
+	assert_int_equal(ret6, RPMA_E_INVAL);
+	assert_null(tmpl);
+}
+
+/*
+ * new__get_ibv_qp_E_NOSUPP -- the connection works in a thread-safe mode
+ */
+static void
+new__get_ibv_qp_E_NOSUPP(void **unused)
+{
+	/* configure mocks */
+	will_return(rpma_conn_get_ibv_qp, RPMA_E_NOSUPP);
+
+	/* run test */
+	struct rpma_op_template *tmpl = NULL;
+	int ret = rpma_op_template_new(MOCK_CONN, RPMA_OP_TEMPLATE_WRITE,
+			MOCK_RPMA_MR_LOCAL, MOCK_RPMA_MR_REMOTE,
+			RPMA_F_COMPLETION_ALWAYS, &tmpl);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NOSUPP);
+	assert_null(tmpl);
+}
+
+/*
+ * new__malloc_ERRNO -- malloc() fails with MOCK_ERRNO
+ */
+static void
+new__malloc_ERRNO(void **unused)
+{
+	/* configure mocks */
+	will_return(rpma_conn_get_ibv_qp, MOCK_OK);
+	will_return(__wrap__test_malloc, MOCK_ERRNO);
+
+	/* run test */
+	struct rpma_op_template *tmpl = NULL;
+	int ret = rpma_op_template_new(MOCK_CONN, RPMA_OP_TEMPLATE_READ,
+			MOCK_RPMA_MR_LOCAL, MOCK_RPMA_MR_REMOTE,
+			RPMA_F_COMPLETION_ALWAYS, &tmpl);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NOMEM);
+	assert_null(tmpl);
+}
+
+/*
+ * test_lifecycle -- happy day scenario
+ */
+static void
+test_lifecycle(void **unused)
+{
+	/*
+	 * the thing is done by setup__op_template_read/write() and
+	 * teardown__op_template_delete()
+	 */
+}
+
+/*
+ * delete__tmpl_ptr_NULL -- NULL tmpl_ptr is invalid
+ */
+static void
+delete__tmpl_ptr_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_op_template_delete(NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * delete__tmpl_NULL -- NULL tmpl is valid - quick exit
+ */
+static void
+delete__tmpl_NULL(void **unused)
+{
+	/* run test */
+	struct rpma_op_template *tmpl = NULL;
+	int ret = rpma_op_template_delete(&tmpl);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+static const struct CMUnitTest tests_new_delete[] = {
+	/* rpma_op_template_new() unit tests */
+	cmocka_unit_test(new__invalid_args),
+	cmocka_unit_test(new__get_ibv_qp_E_NOSUPP),
+	cmocka_unit_test(new__malloc_ERRNO),
+
+	/* rpma_op_template_new()/delete() lifecycle */
+	cmocka_unit_test_setup_teardown(test_lifecycle,
+		setup__op_template_read, teardown__op_template_delete),
+	cmocka_unit_test_setup_teardown(test_lifecycle,
+		setup__op_template_write, teardown__op_template_delete),
+
+	/* rpma_op_template_delete() unit tests */
+	cmocka_unit_test(delete__tmpl_ptr_NULL),
+	cmocka_unit_test(delete__tmpl_NULL),
+
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_new_delete, NULL, NULL);
+}
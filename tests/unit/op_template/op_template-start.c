@@ -0,0 +1,120 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * op_template-start.c -- the rpma_op_template_start() unit tests
+ *
+ * APIs covered:
+ * - rpma_op_template_start()
+ */
+
+#include "op_template-common.h"
+
+/*
+ * start__invalid_args -- invalid combinations of the arguments
+ */
+static void
+start__invalid_args(void **tstate_ptr)
+{
+	struct op_template_test_state *tstate = *tstate_ptr;
+
+	/* run test */
+	int ret1 = rpma_op_template_start(NULL, MOCK_LOCAL_OFFSET,
+			MOCK_REMOTE_OFFSET, MOCK_LEN, MOCK_OP_CONTEXT);
+	int ret2 = rpma_op_template_start(tstate->tmpl, MOCK_LOCAL_OFFSET,
+			MOCK_REMOTE_OFFSET, 0, MOCK_OP_CONTEXT);
+	int ret3 = rpma_op_template_start(tstate->tmpl, MOCK_LOCAL_OFFSET,
+			MOCK_REMOTE_OFFSET, (size_t)UINT32_MAX + 1,
+			MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret1, RPMA_E_INVAL);
+	assert_int_equal(ret2, RPMA_E_INVAL);
+	assert_int_equal(ret3, RPMA_E_INVAL);
+}
+
+/*
+ * start__read -- the read template is started twice with different
+ * arguments
+ */
+static void
+start__read(void **tstate_ptr)
+{
+	struct op_template_test_state *tstate = *tstate_ptr;
+
+	/* configure mocks */
+	expect_post(IBV_WR_RDMA_READ, MOCK_LOCAL_OFFSET, MOCK_REMOTE_OFFSET,
+			MOCK_LEN, MOCK_OP_CONTEXT, MOCK_OK);
+	expect_value(rpma_conn_reads_posted, conn, MOCK_CONN);
+	expect_post(IBV_WR_RDMA_READ, 0, 0, 1, MOCK_OP_CONTEXT_2, MOCK_OK);
+	expect_value(rpma_conn_reads_posted, conn, MOCK_CONN);
+
+	/* run test */
+	int ret1 = rpma_op_template_start(tstate->tmpl, MOCK_LOCAL_OFFSET,
+			MOCK_REMOTE_OFFSET, MOCK_LEN, MOCK_OP_CONTEXT);
+	int ret2 = rpma_op_template_start(tstate->tmpl, 0, 0, 1,
+			MOCK_OP_CONTEXT_2);
+
+	/* verify the results */
+	assert_int_equal(ret1, MOCK_OK);
+	assert_int_equal(ret2, MOCK_OK);
+}
+
+/*
+ * start__write -- the write template does not affect the fencing
+ */
+static void
+start__write(void **tstate_ptr)
+{
+	struct op_template_test_state *tstate = *tstate_ptr;
+
+	/* configure mocks */
+	expect_post(IBV_WR_RDMA_WRITE, MOCK_LOCAL_OFFSET, MOCK_REMOTE_OFFSET,
+			MOCK_LEN, MOCK_OP_CONTEXT, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_op_template_start(tstate->tmpl, MOCK_LOCAL_OFFSET,
+			MOCK_REMOTE_OFFSET, MOCK_LEN, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * start__post_send_ERRNO -- ibv_post_send() fails with MOCK_ERRNO
+ */
+static void
+start__post_send_ERRNO(void **tstate_ptr)
+{
+	struct op_template_test_state *tstate = *tstate_ptr;
+
+	/* configure mocks */
+	expect_post(IBV_WR_RDMA_READ, MOCK_LOCAL_OFFSET, MOCK_REMOTE_OFFSET,
+			MOCK_LEN, MOCK_OP_CONTEXT, MOCK_ERRNO);
+
+	/* run test */
+	int ret = rpma_op_template_start(tstate->tmpl, MOCK_LOCAL_OFFSET,
+			MOCK_REMOTE_OFFSET, MOCK_LEN, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+}
+
+static const struct CMUnitTest tests_start[] = {
+	/* rpma_op_template_start() unit tests */
+	cmocka_unit_test_setup_teardown(start__invalid_args,
+		setup__op_template_read, teardown__op_template_delete),
+	cmocka_unit_test_setup_teardown(start__read,
+		setup__op_template_read, teardown__op_template_delete),
+	cmocka_unit_test_setup_teardown(start__write,
+		setup__op_template_write, teardown__op_template_delete),
+	cmocka_unit_test_setup_teardown(start__post_send_ERRNO,
+		setup__op_template_read, teardown__op_template_delete),
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_start, NULL, NULL);
+}
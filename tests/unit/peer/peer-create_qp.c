@@ -16,9 +16,13 @@
 #include "mocks-ibverbs.h"
 #include "mocks-rpma-conn_cfg.h"
 #include "mocks-rpma-cq.h"
+#include "mocks-rpma-srq.h"
 #include "peer.h"
 #include "peer-common.h"
 
+/* the CQ of the receives of the shared receive queue */
+#define MOCK_IBV_RCQ		(struct ibv_cq *)0xC4D1
+
 static struct conn_cfg_get_q_size_mock_args Get_sq_size = {
 	.cfg = MOCK_CONN_CFG_CUSTOM,
 	.q_size = MOCK_SQ_SIZE_CUSTOM
@@ -87,12 +91,14 @@ create_qp__rdma_create_qp_ERRNO(void **peer_ptr)
 	/* configure mock: */
 	will_return(rpma_conn_cfg_get_sq_size, &Get_sq_size);
 	will_return(rpma_conn_cfg_get_rq_size, &Get_rq_size);
+	will_return(rpma_conn_cfg_get_srq, NULL);
 	will_return(rpma_cq_get_ibv_cq, MOCK_IBV_CQ);
 	expect_value(rdma_create_qp, id, MOCK_CM_ID);
 	expect_value(rdma_create_qp, pd, MOCK_IBV_PD);
 	expect_value(rdma_create_qp, qp_init_attr->qp_context, NULL);
 	expect_value(rdma_create_qp, qp_init_attr->send_cq, MOCK_IBV_CQ);
 	expect_value(rdma_create_qp, qp_init_attr->recv_cq, MOCK_IBV_CQ);
+	expect_value(rdma_create_qp, qp_init_attr->srq, NULL);
 	expect_value(rdma_create_qp, qp_init_attr->cap.max_send_wr,
 		MOCK_SQ_SIZE_CUSTOM);
 	expect_value(rdma_create_qp, qp_init_attr->cap.max_recv_wr,
@@ -125,12 +131,14 @@ create_qp__success(void **peer_ptr)
 	/* configure mock: */
 	will_return(rpma_conn_cfg_get_sq_size, &Get_sq_size);
 	will_return(rpma_conn_cfg_get_rq_size, &Get_rq_size);
+	will_return(rpma_conn_cfg_get_srq, NULL);
 	will_return(rpma_cq_get_ibv_cq, MOCK_IBV_CQ);
 	expect_value(rdma_create_qp, id, MOCK_CM_ID);
 	expect_value(rdma_create_qp, pd, MOCK_IBV_PD);
 	expect_value(rdma_create_qp, qp_init_attr->qp_context, NULL);
 	expect_value(rdma_create_qp, qp_init_attr->send_cq, MOCK_IBV_CQ);
 	expect_value(rdma_create_qp, qp_init_attr->recv_cq, MOCK_IBV_CQ);
+	expect_value(rdma_create_qp, qp_init_attr->srq, NULL);
 	expect_value(rdma_create_qp, qp_init_attr->cap.max_send_wr,
 		MOCK_SQ_SIZE_CUSTOM);
 	expect_value(rdma_create_qp, qp_init_attr->cap.max_recv_wr,
@@ -152,6 +160,47 @@ create_qp__success(void **peer_ptr)
 	assert_int_equal(ret, 0);
 }
 
+/*
+ * create_qp__srq_success -- happy day scenario of a QP attached to an SRQ
+ */
+static void
+create_qp__srq_success(void **peer_ptr)
+{
+	struct rpma_peer *peer = *peer_ptr;
+
+	/* configure mock: */
+	will_return(rpma_conn_cfg_get_sq_size, &Get_sq_size);
+	will_return(rpma_conn_cfg_get_rq_size, &Get_rq_size);
+	will_return(rpma_conn_cfg_get_srq, MOCK_RPMA_SRQ);
+	will_return(rpma_cq_get_ibv_cq, MOCK_IBV_CQ);
+	will_return(rpma_cq_get_ibv_cq, MOCK_IBV_RCQ);
+	expect_value(rdma_create_qp, id, MOCK_CM_ID);
+	expect_value(rdma_create_qp, pd, MOCK_IBV_PD);
+	expect_value(rdma_create_qp, qp_init_attr->qp_context, NULL);
+	expect_value(rdma_create_qp, qp_init_attr->send_cq, MOCK_IBV_CQ);
+	expect_value(rdma_create_qp, qp_init_attr->recv_cq, MOCK_IBV_RCQ);
+	expect_value(rdma_create_qp, qp_init_attr->srq, MOCK_IBV_SRQ);
+	expect_value(rdma_create_qp, qp_init_attr->cap.max_send_wr,
+		MOCK_SQ_SIZE_CUSTOM);
+	/* a QP attached to an SRQ has no receive queue of its own */
+	expect_value(rdma_create_qp, qp_init_attr->cap.max_recv_wr, 0);
+	expect_value(rdma_create_qp, qp_init_attr->cap.max_send_sge,
+		RPMA_MAX_SGE);
+	expect_value(rdma_create_qp, qp_init_attr->cap.max_recv_sge,
+		RPMA_MAX_SGE);
+	expect_value(rdma_create_qp, qp_init_attr->cap.max_inline_data,
+		RPMA_MAX_INLINE_DATA);
+	will_return(rdma_create_qp, 0);
+
+	/* run test */
+	struct rdma_cm_id *id = MOCK_CM_ID;
+	struct rpma_cq *cq = MOCK_RPMA_CQ;
+	int ret = rpma_peer_create_qp(peer, id, cq, MOCK_CONN_CFG_CUSTOM);
+
+	/* verify the results */
+	assert_int_equal(ret, 0);
+}
+
 int
 main(int argc, char *argv[])
 {
@@ -167,6 +216,8 @@ main(int argc, char *argv[])
 				setup__peer, teardown__peer, &OdpCapable),
 		cmocka_unit_test_prestate_setup_teardown(create_qp__success,
 				setup__peer, teardown__peer, &OdpCapable),
+		cmocka_unit_test_prestate_setup_teardown(create_qp__srq_success,
+				setup__peer, teardown__peer, &OdpCapable),
 	};
 
 	return cmocka_run_group_tests(tests, NULL, NULL);
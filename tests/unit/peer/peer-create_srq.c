@@ -0,0 +1,80 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * peer-create_srq.c -- a peer unit test
+ *
+ * API covered:
+ * - rpma_peer_create_srq()
+ */
+
+#include <infiniband/verbs.h>
+
+#include "cmocka_headers.h"
+#include "mocks-ibverbs.h"
+#include "mocks-rpma-conn_cfg.h"
+#include "peer.h"
+#include "peer-common.h"
+#include "test-common.h"
+
+#define MOCK_SRQ_SIZE		(uint32_t)0x5A
+
+/*
+ * create_srq__ibv_create_srq_ERRNO -- ibv_create_srq() fails with MOCK_ERRNO
+ */
+static void
+create_srq__ibv_create_srq_ERRNO(void **peer_ptr)
+{
+	struct rpma_peer *peer = *peer_ptr;
+
+	/* configure mock: */
+	expect_value(ibv_create_srq, srq_init_attr->attr.max_wr,
+		MOCK_SRQ_SIZE);
+	will_return(ibv_create_srq, NULL);
+	will_return(ibv_create_srq, MOCK_ERRNO);
+
+	/* run test */
+	struct ibv_srq *ibv_srq = NULL;
+	int ret = rpma_peer_create_srq(peer, MOCK_SRQ_SIZE, &ibv_srq);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(ibv_srq);
+}
+
+/*
+ * create_srq__success -- happy day scenario
+ */
+static void
+create_srq__success(void **peer_ptr)
+{
+	struct rpma_peer *peer = *peer_ptr;
+
+	/* configure mock: */
+	expect_value(ibv_create_srq, srq_init_attr->attr.max_wr,
+		MOCK_SRQ_SIZE);
+	will_return(ibv_create_srq, MOCK_IBV_SRQ);
+
+	/* run test */
+	struct ibv_srq *ibv_srq = NULL;
+	int ret = rpma_peer_create_srq(peer, MOCK_SRQ_SIZE, &ibv_srq);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(ibv_srq, MOCK_IBV_SRQ);
+}
+
+int
+main(int argc, char *argv[])
+{
+	const struct CMUnitTest tests[] = {
+		/* rpma_peer_create_srq() unit tests */
+		cmocka_unit_test_prestate_setup_teardown(
+				create_srq__ibv_create_srq_ERRNO,
+				setup__peer, teardown__peer, &OdpCapable),
+		cmocka_unit_test_prestate_setup_teardown(create_srq__success,
+				setup__peer, teardown__peer, &OdpCapable),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
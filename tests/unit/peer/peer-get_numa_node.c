@@ -0,0 +1,86 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * peer-get_numa_node.c -- a peer unit test
+ *
+ * API covered:
+ * - rpma_peer_get_numa_node()
+ */
+
+#include <infiniband/verbs.h>
+
+#include "cmocka_headers.h"
+#include "mocks-ibverbs.h"
+#include "peer.h"
+#include "peer-common.h"
+#include "test-common.h"
+
+#define MOCK_NUMA_NODE		(-2) /* an impossible value */
+#define MOCK_IBDEV_PATH		"/nonexistent/infiniband/mock_0"
+
+/*
+ * get_numa_node__peer_NULL -- NULL peer is invalid
+ */
+static void
+get_numa_node__peer_NULL(void **unused)
+{
+	/* run test */
+	int node = MOCK_NUMA_NODE;
+	int ret = rpma_peer_get_numa_node(NULL, &node);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+	assert_int_equal(node, MOCK_NUMA_NODE);
+}
+
+/*
+ * get_numa_node__node_NULL -- NULL node is invalid
+ */
+static void
+get_numa_node__node_NULL(void **peer_ptr)
+{
+	struct rpma_peer *peer = *peer_ptr;
+
+	/* run test */
+	int ret = rpma_peer_get_numa_node(peer, NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * get_numa_node__unknown -- the NUMA node of a device without the sysfs
+ * entry is reported as RPMA_NUMA_NODE_ANY
+ */
+static void
+get_numa_node__unknown(void **peer_ptr)
+{
+	struct rpma_peer *peer = *peer_ptr;
+	strcpy(Ibv_device.ibdev_path, MOCK_IBDEV_PATH);
+
+	/* run test */
+	int node = MOCK_NUMA_NODE;
+	int ret = rpma_peer_get_numa_node(peer, &node);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(node, RPMA_NUMA_NODE_ANY);
+}
+
+int
+main(int argc, char *argv[])
+{
+	const struct CMUnitTest tests[] = {
+		/* rpma_peer_get_numa_node() unit tests */
+		cmocka_unit_test(get_numa_node__peer_NULL),
+		cmocka_unit_test_prestate_setup_teardown(
+				get_numa_node__node_NULL,
+				setup__peer, teardown__peer, &OdpCapable),
+		cmocka_unit_test_prestate_setup_teardown(
+				get_numa_node__unknown,
+				setup__peer, teardown__peer, &OdpCapable),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
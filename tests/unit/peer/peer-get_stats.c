@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * peer-get_stats.c -- a peer unit test
+ *
+ * API covered:
+ * - rpma_peer_get_stats()
+ */
+
+#include <infiniband/verbs.h>
+
+#include "cmocka_headers.h"
+#include "mocks-ibverbs.h"
+#include "mocks-rpma-stats.h"
+#include "peer.h"
+#include "peer-common.h"
+#include "test-common.h"
+
+/*
+ * get_stats__peer_NULL -- NULL peer is invalid
+ */
+static void
+get_stats__peer_NULL(void **unused)
+{
+	/* run test */
+	struct rpma_stats stats;
+	int ret = rpma_peer_get_stats(NULL, &stats);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * get_stats__stats_NULL -- NULL stats is invalid
+ */
+static void
+get_stats__stats_NULL(void **peer_ptr)
+{
+	struct rpma_peer *peer = *peer_ptr;
+
+	/* run test */
+	int ret = rpma_peer_get_stats(peer, NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * get_stats__success -- the statistics of the connections of the peer
+ * are summed up
+ */
+static void
+get_stats__success(void **peer_ptr)
+{
+	struct rpma_peer *peer = *peer_ptr;
+	struct rpma_stats stats;
+
+	/* configure mocks */
+	expect_value(rpma_stats_group_get, stats, &stats);
+
+	/* run test */
+	int ret = rpma_peer_get_stats(peer, &stats);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(stats.posts, 0);
+}
+
+int
+main(int argc, char *argv[])
+{
+	const struct CMUnitTest tests[] = {
+		/* rpma_peer_get_stats() unit tests */
+		cmocka_unit_test(get_stats__peer_NULL),
+		cmocka_unit_test_prestate_setup_teardown(
+				get_stats__stats_NULL,
+				setup__peer, teardown__peer, &OdpCapable),
+		cmocka_unit_test_prestate_setup_teardown(
+				get_stats__success,
+				setup__peer, teardown__peer, &OdpCapable),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -69,6 +69,15 @@ static struct prestate prestates[] = {
 		RPMA_MR_USAGE_RECV,
 			IBV_ACCESS_LOCAL_WRITE,
 				MOCK_ODP_CAPABLE},
+	/* 10-11) non-iWARP and iWARP are the same */
+	{IBV_TRANSPORT_IB,
+		RPMA_MR_USAGE_ATOMIC,
+			IBV_ACCESS_REMOTE_ATOMIC | IBV_ACCESS_LOCAL_WRITE,
+				MOCK_ODP_CAPABLE},
+	{IBV_TRANSPORT_IWARP,
+		RPMA_MR_USAGE_ATOMIC,
+			IBV_ACCESS_REMOTE_ATOMIC | IBV_ACCESS_LOCAL_WRITE,
+				MOCK_ODP_CAPABLE},
 };
 
 /*
@@ -272,6 +281,12 @@ main(int argc, char *argv[])
 		{ "mr_reg__USAGE_RECV_iWARP", mr_reg__success,
 				setup__peer_prestates,
 				teardown__peer_prestates, prestates + 9},
+		{ "mr_reg__USAGE_ATOMIC_IB", mr_reg__success,
+				setup__peer_prestates,
+				teardown__peer_prestates, prestates + 10},
+		{ "mr_reg__USAGE_ATOMIC_iWARP", mr_reg__success,
+				setup__peer_prestates,
+				teardown__peer_prestates, prestates + 11},
 		cmocka_unit_test_prestate_setup_teardown(
 				mr_reg__success_odp,
 				setup__peer, teardown__peer, &OdpCapable),
@@ -0,0 +1,323 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * progress-common.c -- the rpma_progress unit tests common functions
+ */
+
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+
+#include "progress-common.h"
+
+int Thread_run_on_create;
+
+/* the thread captured by pthread_create() */
+static struct {
+	void *(*start_routine)(void *);
+	void *arg;
+	int done;
+} Thread;
+
+/* the number of rpma_conn_completion_get() calls so far */
+static int Collected;
+
+/*
+ * progress_func -- the callback attached to the operations
+ */
+static void
+progress_func(const struct rpma_completion *cmpl, void *arg)
+{
+	assert_non_null(cmpl);
+	check_expected(arg);
+	/* all the completions of the batch are collected before */
+	check_expected(Collected);
+}
+
+struct rpma_progress_cb Cb = {progress_func, MOCK_ARG};
+struct rpma_progress_cb Cb_2 = {progress_func, MOCK_ARG_2};
+
+/*
+ * thread_run -- run the captured thread synchronously
+ */
+static void
+thread_run(void)
+{
+	assert_non_null(Thread.start_routine);
+	assert_false(Thread.done);
+
+	Collected = 0;
+	assert_null(Thread.start_routine(Thread.arg));
+	Thread.done = 1;
+}
+
+/*
+ * __wrap_pthread_create -- pthread_create() mock
+ */
+int
+__wrap_pthread_create(pthread_t *thread, const pthread_attr_t *attr,
+		void *(*start_routine)(void *), void *arg)
+{
+	assert_non_null(thread);
+	assert_null(attr);
+	assert_non_null(start_routine);
+
+	int ret = mock_type(int);
+	if (ret)
+		return ret;
+
+	*thread = MOCK_THREAD;
+	Thread.start_routine = start_routine;
+	Thread.arg = arg;
+	Thread.done = 0;
+
+	if (Thread_run_on_create)
+		thread_run();
+
+	return 0;
+}
+
+/*
+ * __wrap_pthread_join -- pthread_join() mock; the thread which has not run
+ * yet is run synchronously
+ */
+int
+__wrap_pthread_join(pthread_t thread, void **retval)
+{
+	assert_true(pthread_equal(thread, MOCK_THREAD));
+	assert_null(retval);
+
+	int ret = mock_type(int);
+	if (ret)
+		return ret;
+
+	if (!Thread.done)
+		thread_run();
+
+	return 0;
+}
+
+/*
+ * __wrap_eventfd -- eventfd() mock
+ */
+int
+__wrap_eventfd(unsigned initval, int flags)
+{
+	assert_int_equal(initval, 0);
+	assert_int_equal(flags, EFD_CLOEXEC);
+
+	errno = mock_type(int);
+	if (errno)
+		return -1;
+
+	return MOCK_WAKE_FD;
+}
+
+/*
+ * __wrap_eventfd_write -- eventfd_write() mock
+ */
+int
+__wrap_eventfd_write(int fd, eventfd_t value)
+{
+	assert_int_equal(fd, MOCK_WAKE_FD);
+	assert_int_equal(value, 1);
+
+	errno = mock_type(int);
+	if (errno)
+		return -1;
+
+	return 0;
+}
+
+int __real_close(int fd);
+
+/*
+ * __wrap_close -- close() mock
+ */
+int
+__wrap_close(int fd)
+{
+	if (fd != MOCK_WAKE_FD)
+		return __real_close(fd);
+
+	errno = mock_type(int);
+	if (errno)
+		return -1;
+
+	return 0;
+}
+
+/*
+ * __wrap_poll -- poll() mock; the file descriptor reported ready is taken
+ * from the mock values
+ */
+int
+__wrap_poll(struct pollfd *fds, nfds_t nfds, int timeout)
+{
+	assert_int_equal(nfds, 2);
+	assert_int_equal(timeout, -1);
+	assert_int_equal(fds[0].fd, MOCK_COMPLETION_FD);
+	assert_int_equal(fds[1].fd, MOCK_WAKE_FD);
+
+	int ready = mock_type(int);
+	if (ready == MOCK_POLL_ERROR) {
+		errno = mock_type(int);
+		return -1;
+	}
+
+	fds[0].revents = 0;
+	fds[1].revents = 0;
+	fds[ready].revents = POLLIN;
+
+	return 1;
+}
+
+/*
+ * rpma_conn_get_completion_fd -- rpma_conn_get_completion_fd() mock
+ */
+int
+rpma_conn_get_completion_fd(const struct rpma_conn *conn, int *fd)
+{
+	assert_ptr_equal(conn, MOCK_CONN);
+	assert_non_null(fd);
+
+	int ret = mock_type(int);
+	if (ret == MOCK_OK)
+		*fd = MOCK_COMPLETION_FD;
+
+	return ret;
+}
+
+/*
+ * rpma_conn_completion_wait -- rpma_conn_completion_wait() mock
+ */
+int
+rpma_conn_completion_wait(struct rpma_conn *conn)
+{
+	assert_ptr_equal(conn, MOCK_CONN);
+
+	return mock_type(int);
+}
+
+/*
+ * rpma_conn_completion_get -- rpma_conn_completion_get() mock
+ */
+int
+rpma_conn_completion_get(struct rpma_conn *conn,
+		struct rpma_completion *cmpl)
+{
+	assert_ptr_equal(conn, MOCK_CONN);
+	assert_non_null(cmpl);
+
+	++Collected;
+
+	int ret = mock_type(int);
+	if (ret == MOCK_OK)
+		cmpl->op_context = mock_type(void *);
+
+	return ret;
+}
+
+/*
+ * expect_completion -- expect a completion of the operation with the cb
+ * attached which is dispatched after the collected completions
+ */
+void
+expect_completion(struct rpma_progress_cb *cb, int collected)
+{
+	will_return(rpma_conn_completion_get, MOCK_OK);
+	will_return(rpma_conn_completion_get, cb);
+	if (cb == NULL)
+		return;
+
+	expect_value(progress_func, arg, cb->arg);
+	expect_value(progress_func, Collected, collected);
+}
+
+/*
+ * progress_new -- create a progress thread of MOCK_CONN
+ */
+void
+progress_new(enum rpma_progress_mode mode,
+		struct rpma_progress **progress_ptr)
+{
+	/* configure mocks */
+	if (mode == RPMA_PROGRESS_EVENT_DRIVEN) {
+		will_return(rpma_conn_get_completion_fd, MOCK_OK);
+		will_return(__wrap_eventfd, MOCK_OK);
+	}
+	will_return_count(__wrap__test_malloc, MOCK_OK, 2);
+	will_return(__wrap_pthread_create, MOCK_OK);
+
+	/* run test */
+	*progress_ptr = NULL;
+	int ret = rpma_progress_new(MOCK_CONN, mode, MOCK_BATCH, progress_ptr);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_non_null(*progress_ptr);
+}
+
+/*
+ * setup__progress_new -- prepare a valid busy-polling progress thread
+ */
+int
+setup__progress_new(void **pstate_ptr)
+{
+	static struct progress_test_state pstate = {0};
+
+	Thread_run_on_create = 0;
+	pstate.mode = RPMA_PROGRESS_BUSY_POLL;
+	progress_new(pstate.mode, &pstate.progress);
+
+	*pstate_ptr = &pstate;
+
+	return 0;
+}
+
+/*
+ * setup__progress_new_event -- prepare a valid event-driven progress thread
+ */
+int
+setup__progress_new_event(void **pstate_ptr)
+{
+	static struct progress_test_state pstate = {0};
+
+	Thread_run_on_create = 0;
+	pstate.mode = RPMA_PROGRESS_EVENT_DRIVEN;
+	progress_new(pstate.mode, &pstate.progress);
+
+	*pstate_ptr = &pstate;
+
+	return 0;
+}
+
+/*
+ * teardown__progress_delete -- stop the progress thread which has not run
+ * yet; it finds the CQ empty
+ */
+int
+teardown__progress_delete(void **pstate_ptr)
+{
+	struct progress_test_state *pstate = *pstate_ptr;
+
+	/* configure mocks */
+	if (Thread.arg == pstate->progress && !Thread.done)
+		will_return(rpma_conn_completion_get, RPMA_E_NO_COMPLETION);
+	if (pstate->mode == RPMA_PROGRESS_EVENT_DRIVEN)
+		will_return(__wrap_eventfd_write, MOCK_OK);
+	will_return(__wrap_pthread_join, MOCK_OK);
+	if (pstate->mode == RPMA_PROGRESS_EVENT_DRIVEN)
+		will_return(__wrap_close, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_progress_delete(&pstate->progress);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_null(pstate->progress);
+
+	return 0;
+}
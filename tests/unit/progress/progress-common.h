@@ -0,0 +1,48 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * progress-common.h -- the rpma_progress unit tests common definitions
+ */
+
+#ifndef PROGRESS_COMMON_H
+#define PROGRESS_COMMON_H
+
+#include "cmocka_headers.h"
+#include "librpma.h"
+#include "test-common.h"
+
+#define MOCK_WAKE_FD		0x00FB
+#define MOCK_THREAD		(pthread_t)0xC7C7
+#define MOCK_ARG		(void *)0xC0A0
+#define MOCK_ARG_2		(void *)0xC0A1
+#define MOCK_BATCH		2
+#define MOCK_MODE_INVALID	(enum rpma_progress_mode)(-1)
+
+/* the file descriptor reported ready by poll(2) */
+#define MOCK_POLL_COMPLETION	0
+#define MOCK_POLL_WAKE		1
+#define MOCK_POLL_ERROR		(-1)
+
+struct progress_test_state {
+	struct rpma_progress *progress;
+	enum rpma_progress_mode mode;
+};
+
+/* the callbacks attached to the operations */
+extern struct rpma_progress_cb Cb;
+extern struct rpma_progress_cb Cb_2;
+
+/* the thread is run synchronously inside pthread_create() */
+extern int Thread_run_on_create;
+
+int setup__progress_new(void **pstate_ptr);
+int setup__progress_new_event(void **pstate_ptr);
+int teardown__progress_delete(void **pstate_ptr);
+
+void progress_new(enum rpma_progress_mode mode,
+		struct rpma_progress **progress_ptr);
+
+void expect_completion(struct rpma_progress_cb *cb, int collected);
+
+#endif /* PROGRESS_COMMON_H */
@@ -0,0 +1,307 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * progress-new_delete.c -- the rpma_progress_new/delete() unit tests
+ *
+ * APIs covered:
+ * - rpma_progress_new()
+ * - rpma_progress_delete()
+ */
+
+#include "progress-common.h"
+
+/*
+ * new__invalid_args -- invalid combinations of the arguments
+ */
+static void
+new__invalid_args(void **unused)
+{
+	/* run test */
+	struct rpma_progress *progress = NULL;
+	int ret1 = rpma_progress_new(NULL, RPMA_PROGRESS_BUSY_POLL,
+			MOCK_BATCH, &progress);
+	int ret2 = rpma_progress_new(MOCK_CONN, RPMA_PROGRESS_BUSY_POLL,
+			0, &progress);
+	int ret3 = rpma_progress_new(MOCK_CONN, RPMA_PROGRESS_BUSY_POLL,
+			MOCK_BATCH, NULL);
+	int ret4 = rpma_progress_new(MOCK_CONN, MOCK_MODE_INVALID,
+			MOCK_BATCH, &progress);
+
+	/* verify the results */
+	assert_int_equal(ret1, RPMA_E_INVAL);
+	assert_int_equal(ret2, RPMA_E_INVAL);
+	assert_int_equal(ret3, RPMA_E_INVAL);
+	assert_int_equal(ret4, RPMA_E_INVAL);
+	assert_null(progress);
+}
+
+/*
+ * new__get_completion_fd_E_INVAL -- rpma_conn_get_completion_fd() fails
+ * with RPMA_E_INVAL
+ */
+static void
+new__get_completion_fd_E_INVAL(void **unused)
+{
+	/* configure mocks */
+	will_return(rpma_conn_get_completion_fd, RPMA_E_INVAL);
+
+	/* run test */
+	struct rpma_progress *progress = NULL;
+	int ret = rpma_progress_new(MOCK_CONN, RPMA_PROGRESS_EVENT_DRIVEN,
+			MOCK_BATCH, &progress);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+	assert_null(progress);
+}
+
+/*
+ * new__malloc_ERRNO -- malloc() fails with MOCK_ERRNO
+ */
+static void
+new__malloc_ERRNO(void **unused)
+{
+	/* configure mocks */
+	will_return(__wrap__test_malloc, MOCK_ERRNO);
+
+	/* run test */
+	struct rpma_progress *progress = NULL;
+	int ret = rpma_progress_new(MOCK_CONN, RPMA_PROGRESS_BUSY_POLL,
+			MOCK_BATCH, &progress);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NOMEM);
+	assert_null(progress);
+}
+
+/*
+ * new__malloc_ERRNO_2 -- malloc() of the completions fails with MOCK_ERRNO
+ */
+static void
+new__malloc_ERRNO_2(void **unused)
+{
+	/* configure mocks */
+	will_return(__wrap__test_malloc, MOCK_OK);
+	will_return(__wrap__test_malloc, MOCK_ERRNO);
+
+	/* run test */
+	struct rpma_progress *progress = NULL;
+	int ret = rpma_progress_new(MOCK_CONN, RPMA_PROGRESS_BUSY_POLL,
+			MOCK_BATCH, &progress);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NOMEM);
+	assert_null(progress);
+}
+
+/*
+ * new__eventfd_ERRNO -- eventfd() fails with MOCK_ERRNO
+ */
+static void
+new__eventfd_ERRNO(void **unused)
+{
+	/* configure mocks */
+	will_return(rpma_conn_get_completion_fd, MOCK_OK);
+	will_return_count(__wrap__test_malloc, MOCK_OK, 2);
+	will_return(__wrap_eventfd, MOCK_ERRNO);
+
+	/* run test */
+	struct rpma_progress *progress = NULL;
+	int ret = rpma_progress_new(MOCK_CONN, RPMA_PROGRESS_EVENT_DRIVEN,
+			MOCK_BATCH, &progress);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(progress);
+}
+
+/*
+ * new__pthread_create_ERRNO -- pthread_create() fails with MOCK_ERRNO
+ */
+static void
+new__pthread_create_ERRNO(void **unused)
+{
+	/* configure mocks */
+	will_return_count(__wrap__test_malloc, MOCK_OK, 2);
+	will_return(__wrap_pthread_create, MOCK_ERRNO);
+
+	/* run test */
+	struct rpma_progress *progress = NULL;
+	int ret = rpma_progress_new(MOCK_CONN, RPMA_PROGRESS_BUSY_POLL,
+			MOCK_BATCH, &progress);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(progress);
+}
+
+/*
+ * new__pthread_create_ERRNO_event -- pthread_create() fails with MOCK_ERRNO
+ * and the eventfd(2) is closed
+ */
+static void
+new__pthread_create_ERRNO_event(void **unused)
+{
+	/* configure mocks */
+	will_return(rpma_conn_get_completion_fd, MOCK_OK);
+	will_return_count(__wrap__test_malloc, MOCK_OK, 2);
+	will_return(__wrap_eventfd, MOCK_OK);
+	will_return(__wrap_pthread_create, MOCK_ERRNO);
+	will_return(__wrap_close, MOCK_OK);
+
+	/* run test */
+	struct rpma_progress *progress = NULL;
+	int ret = rpma_progress_new(MOCK_CONN, RPMA_PROGRESS_EVENT_DRIVEN,
+			MOCK_BATCH, &progress);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(progress);
+}
+
+/*
+ * test_lifecycle -- happy day scenario
+ */
+static void
+test_lifecycle(void **unused)
+{
+	/*
+	 * the thing is done by setup__progress_new*() and
+	 * teardown__progress_delete()
+	 */
+}
+
+/*
+ * delete__progress_ptr_NULL -- NULL progress_ptr is invalid
+ */
+static void
+delete__progress_ptr_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_progress_delete(NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * delete__progress_NULL -- NULL progress is valid - quick exit
+ */
+static void
+delete__progress_NULL(void **unused)
+{
+	/* run test */
+	struct rpma_progress *progress = NULL;
+	int ret = rpma_progress_delete(&progress);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * delete__eventfd_write_ERRNO -- eventfd_write() fails with MOCK_ERRNO
+ */
+static void
+delete__eventfd_write_ERRNO(void **unused)
+{
+	struct progress_test_state *pstate;
+
+	/* WA for cmocka/issues#47 */
+	assert_int_equal(setup__progress_new_event((void **)&pstate), 0);
+
+	/* configure mocks */
+	will_return(__wrap_eventfd_write, MOCK_ERRNO);
+
+	/* run test */
+	int ret = rpma_progress_delete(&pstate->progress);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_non_null(pstate->progress);
+
+	/* the thread can be stopped again */
+	assert_int_equal(teardown__progress_delete((void **)&pstate), 0);
+}
+
+/*
+ * delete__pthread_join_ERRNO -- pthread_join() fails with MOCK_ERRNO
+ */
+static void
+delete__pthread_join_ERRNO(void **unused)
+{
+	struct progress_test_state *pstate;
+
+	/* WA for cmocka/issues#47 */
+	assert_int_equal(setup__progress_new((void **)&pstate), 0);
+
+	/* configure mocks */
+	will_return(__wrap_pthread_join, MOCK_ERRNO);
+
+	/* run test */
+	int ret = rpma_progress_delete(&pstate->progress);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_non_null(pstate->progress);
+
+	/* the thread can be stopped again */
+	assert_int_equal(teardown__progress_delete((void **)&pstate), 0);
+}
+
+/*
+ * delete__close_ERRNO -- close() fails with MOCK_ERRNO
+ */
+static void
+delete__close_ERRNO(void **unused)
+{
+	struct progress_test_state *pstate;
+
+	/* WA for cmocka/issues#47 */
+	assert_int_equal(setup__progress_new_event((void **)&pstate), 0);
+
+	/* configure mocks */
+	will_return(__wrap_eventfd_write, MOCK_OK);
+	will_return(__wrap_pthread_join, MOCK_OK);
+	will_return(rpma_conn_completion_get, RPMA_E_NO_COMPLETION);
+	will_return(__wrap_close, MOCK_ERRNO);
+
+	/* run test */
+	int ret = rpma_progress_delete(&pstate->progress);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(pstate->progress);
+}
+
+static const struct CMUnitTest tests_new_delete[] = {
+	/* rpma_progress_new() unit tests */
+	cmocka_unit_test(new__invalid_args),
+	cmocka_unit_test(new__get_completion_fd_E_INVAL),
+	cmocka_unit_test(new__malloc_ERRNO),
+	cmocka_unit_test(new__malloc_ERRNO_2),
+	cmocka_unit_test(new__eventfd_ERRNO),
+	cmocka_unit_test(new__pthread_create_ERRNO),
+	cmocka_unit_test(new__pthread_create_ERRNO_event),
+
+	/* rpma_progress_new()/delete() lifecycle */
+	cmocka_unit_test_setup_teardown(test_lifecycle,
+		setup__progress_new, teardown__progress_delete),
+	cmocka_unit_test_setup_teardown(test_lifecycle,
+		setup__progress_new_event, teardown__progress_delete),
+
+	/* rpma_progress_delete() unit tests */
+	cmocka_unit_test(delete__progress_ptr_NULL),
+	cmocka_unit_test(delete__progress_NULL),
+	cmocka_unit_test(delete__eventfd_write_ERRNO),
+	cmocka_unit_test(delete__pthread_join_ERRNO),
+	cmocka_unit_test(delete__close_ERRNO),
+
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_new_delete, NULL, NULL);
+}
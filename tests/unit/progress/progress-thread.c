@@ -0,0 +1,230 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * progress-thread.c -- the progress thread unit tests
+ *
+ * The thread is run synchronously either by the pthread_create() mock
+ * (it stops only on a failure) or by the pthread_join() mock (it only
+ * drains the CQ).
+ *
+ * APIs covered:
+ * - rpma_progress_new()
+ * - rpma_progress_delete()
+ */
+
+#include <errno.h>
+
+#include "progress-common.h"
+
+/*
+ * progress_delete -- delete the progress thread and check the error
+ * it has stopped with
+ */
+static void
+progress_delete(struct rpma_progress **progress_ptr,
+		enum rpma_progress_mode mode, int error)
+{
+	/* configure mocks */
+	if (mode == RPMA_PROGRESS_EVENT_DRIVEN)
+		will_return(__wrap_eventfd_write, MOCK_OK);
+	will_return(__wrap_pthread_join, MOCK_OK);
+	if (mode == RPMA_PROGRESS_EVENT_DRIVEN)
+		will_return(__wrap_close, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_progress_delete(progress_ptr);
+
+	/* verify the results */
+	assert_int_equal(ret, error);
+	assert_null(*progress_ptr);
+}
+
+/*
+ * drain__batches -- the completions already in the CQ are dispatched
+ * in batches when the thread is stopped
+ */
+static void
+drain__batches(void **pstate_ptr)
+{
+	struct progress_test_state *pstate = *pstate_ptr;
+
+	/* configure mocks */
+	expect_completion(&Cb, 2);
+	expect_completion(&Cb_2, 2);
+	expect_completion(NULL, 4);
+	will_return(rpma_conn_completion_get, RPMA_E_NO_COMPLETION);
+
+	/* run test & verify the results */
+	progress_delete(&pstate->progress, pstate->mode, MOCK_OK);
+}
+
+/*
+ * drain__completion_get_E_PROVIDER -- rpma_conn_completion_get() fails
+ * with RPMA_E_PROVIDER while the CQ is drained
+ */
+static void
+drain__completion_get_E_PROVIDER(void **pstate_ptr)
+{
+	struct progress_test_state *pstate = *pstate_ptr;
+
+	/* configure mocks */
+	expect_completion(&Cb, 2);
+	will_return(rpma_conn_completion_get, RPMA_E_PROVIDER);
+
+	/* run test & verify the results */
+	progress_delete(&pstate->progress, pstate->mode, RPMA_E_PROVIDER);
+}
+
+/*
+ * busy__batches -- the busy-polling thread dispatches the completions
+ * in batches and polls an empty CQ again
+ */
+static void
+busy__batches(void **unused)
+{
+	/* configure mocks */
+	Thread_run_on_create = 1;
+	expect_completion(&Cb, 2);
+	expect_completion(&Cb_2, 2);
+	will_return(rpma_conn_completion_get, RPMA_E_NO_COMPLETION);
+	expect_completion(&Cb_2, 5);
+	will_return(rpma_conn_completion_get, RPMA_E_NO_COMPLETION);
+	expect_completion(NULL, 6);
+	will_return(rpma_conn_completion_get, RPMA_E_PROVIDER);
+
+	/* run test */
+	struct rpma_progress *progress = NULL;
+	progress_new(RPMA_PROGRESS_BUSY_POLL, &progress);
+
+	/* verify the results */
+	progress_delete(&progress, RPMA_PROGRESS_BUSY_POLL, RPMA_E_PROVIDER);
+}
+
+/*
+ * busy__completion_get_E_UNKNOWN -- the completions collected before
+ * rpma_conn_completion_get() fails are dispatched
+ */
+static void
+busy__completion_get_E_UNKNOWN(void **unused)
+{
+	/* configure mocks */
+	Thread_run_on_create = 1;
+	expect_completion(&Cb, 2);
+	will_return(rpma_conn_completion_get, RPMA_E_UNKNOWN);
+
+	/* run test */
+	struct rpma_progress *progress = NULL;
+	progress_new(RPMA_PROGRESS_BUSY_POLL, &progress);
+
+	/* verify the results */
+	progress_delete(&progress, RPMA_PROGRESS_BUSY_POLL, RPMA_E_UNKNOWN);
+}
+
+/*
+ * event__wait -- the event-driven thread waits for a completion only
+ * when the CQ is drained
+ */
+static void
+event__wait(void **unused)
+{
+	/* configure mocks */
+	Thread_run_on_create = 1;
+	/* a full batch - no waiting */
+	expect_completion(&Cb, 2);
+	expect_completion(&Cb_2, 2);
+	/* an empty CQ */
+	will_return(rpma_conn_completion_get, RPMA_E_NO_COMPLETION);
+	will_return(__wrap_poll, MOCK_POLL_COMPLETION);
+	will_return(rpma_conn_completion_wait, MOCK_OK);
+	/* a partial batch */
+	expect_completion(&Cb, 5);
+	will_return(rpma_conn_completion_get, RPMA_E_NO_COMPLETION);
+	will_return(__wrap_poll, MOCK_POLL_COMPLETION);
+	will_return(rpma_conn_completion_wait, RPMA_E_NO_COMPLETION);
+	will_return(rpma_conn_completion_get, RPMA_E_NO_COMPLETION);
+	/* interrupted and woken up */
+	will_return(__wrap_poll, MOCK_POLL_ERROR);
+	will_return(__wrap_poll, EINTR);
+	will_return(rpma_conn_completion_get, RPMA_E_NO_COMPLETION);
+	will_return(__wrap_poll, MOCK_POLL_WAKE);
+	will_return(rpma_conn_completion_get, RPMA_E_PROVIDER);
+
+	/* run test */
+	struct rpma_progress *progress = NULL;
+	progress_new(RPMA_PROGRESS_EVENT_DRIVEN, &progress);
+
+	/* verify the results */
+	progress_delete(&progress, RPMA_PROGRESS_EVENT_DRIVEN,
+			RPMA_E_PROVIDER);
+}
+
+/*
+ * event__poll_ERRNO -- poll() fails with MOCK_ERRNO
+ */
+static void
+event__poll_ERRNO(void **unused)
+{
+	/* configure mocks */
+	Thread_run_on_create = 1;
+	will_return(rpma_conn_completion_get, RPMA_E_NO_COMPLETION);
+	will_return(__wrap_poll, MOCK_POLL_ERROR);
+	will_return(__wrap_poll, MOCK_ERRNO);
+
+	/* run test */
+	struct rpma_progress *progress = NULL;
+	progress_new(RPMA_PROGRESS_EVENT_DRIVEN, &progress);
+
+	/* verify the results */
+	progress_delete(&progress, RPMA_PROGRESS_EVENT_DRIVEN,
+			RPMA_E_PROVIDER);
+}
+
+/*
+ * event__completion_wait_E_PROVIDER -- rpma_conn_completion_wait() fails
+ * with RPMA_E_PROVIDER
+ */
+static void
+event__completion_wait_E_PROVIDER(void **unused)
+{
+	/* configure mocks */
+	Thread_run_on_create = 1;
+	will_return(rpma_conn_completion_get, RPMA_E_NO_COMPLETION);
+	will_return(__wrap_poll, MOCK_POLL_COMPLETION);
+	will_return(rpma_conn_completion_wait, RPMA_E_PROVIDER);
+
+	/* run test */
+	struct rpma_progress *progress = NULL;
+	progress_new(RPMA_PROGRESS_EVENT_DRIVEN, &progress);
+
+	/* verify the results */
+	progress_delete(&progress, RPMA_PROGRESS_EVENT_DRIVEN,
+			RPMA_E_PROVIDER);
+}
+
+static const struct CMUnitTest tests_thread[] = {
+	/* draining the CQ when the thread is stopped */
+	cmocka_unit_test_setup_teardown(drain__batches,
+		setup__progress_new, NULL),
+	cmocka_unit_test_setup_teardown(drain__batches,
+		setup__progress_new_event, NULL),
+	cmocka_unit_test_setup_teardown(drain__completion_get_E_PROVIDER,
+		setup__progress_new, NULL),
+
+	/* the busy-polling thread */
+	cmocka_unit_test(busy__batches),
+	cmocka_unit_test(busy__completion_get_E_UNKNOWN),
+
+	/* the event-driven thread */
+	cmocka_unit_test(event__wait),
+	cmocka_unit_test(event__poll_ERRNO),
+	cmocka_unit_test(event__completion_wait_E_PROVIDER),
+
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_thread, NULL, NULL);
+}
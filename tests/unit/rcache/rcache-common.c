@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * rcache-common.c -- the rpma_rcache unit tests common functions
+ */
+
+#include "mocks-unistd.h"
+#include "rcache-common.h"
+
+void *Posted_ctx;
+
+/*
+ * rpma_read -- rpma_read() mock
+ */
+int
+rpma_read(struct rpma_conn *conn,
+		struct rpma_mr_local *dst, size_t dst_offset,
+		const struct rpma_mr_remote *src,  size_t src_offset,
+		size_t len, int flags, const void *op_context)
+{
+	assert_ptr_equal(conn, MOCK_CONN);
+	assert_ptr_equal(dst, MOCK_RPMA_MR_LOCAL);
+	assert_ptr_equal(src, MOCK_RPMA_MR_REMOTE);
+	assert_int_equal(flags, RPMA_F_COMPLETION_ALWAYS);
+	assert_non_null(op_context);
+	check_expected(dst_offset);
+	check_expected(src_offset);
+	check_expected(len);
+
+	Posted_ctx = (void *)op_context;
+
+	return mock_type(int);
+}
+
+/*
+ * rpma_mr_remote_get_size -- rpma_mr_remote_get_size() mock
+ */
+int
+rpma_mr_remote_get_size(const struct rpma_mr_remote *mr, size_t *size)
+{
+	assert_ptr_equal(mr, MOCK_RPMA_MR_REMOTE);
+	assert_non_null(size);
+
+	*size = MOCK_SRC_SIZE;
+
+	return 0;
+}
+
+/*
+ * setup__rcache_new -- prepare a valid read cache
+ */
+int
+setup__rcache_new(void **rstate_ptr)
+{
+	static struct rcache_test_state rstate = {0};
+
+	/* configure mocks */
+	will_return(__wrap_sysconf, MOCK_OK);
+	will_return(__wrap_mmap, MOCK_OK);
+	will_return(__wrap_mmap, &rstate.allocated_arena);
+	expect_value(rpma_mr_reg, peer, MOCK_PEER);
+	expect_value(rpma_mr_reg, size, MOCK_ARENA_SIZE);
+	expect_value(rpma_mr_reg, usage, RPMA_MR_USAGE_READ_DST);
+	will_return(rpma_mr_reg, &rstate.allocated_arena.addr);
+	will_return(rpma_mr_reg, MOCK_RPMA_MR_LOCAL);
+	will_return_count(__wrap__test_malloc, MOCK_OK, 2);
+
+	/* run test */
+	rstate.rcache = NULL;
+	int ret = rpma_rcache_new(MOCK_PEER, MOCK_CONN, MOCK_RPMA_MR_REMOTE,
+			MOCK_VERSION_OFFSET, MOCK_BLOCK_SIZE, MOCK_BLOCKS,
+			MOCK_DEPTH, &rstate.rcache);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_non_null(rstate.rcache);
+	assert_int_equal(rstate.allocated_arena.len, PAGESIZE);
+
+	*rstate_ptr = &rstate;
+
+	return 0;
+}
+
+/*
+ * teardown__rcache_delete -- delete the read cache
+ */
+int
+teardown__rcache_delete(void **rstate_ptr)
+{
+	struct rcache_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	expect_value(rpma_mr_dereg, *mr_ptr, MOCK_RPMA_MR_LOCAL);
+	will_return(rpma_mr_dereg, MOCK_OK);
+	will_return(__wrap_munmap, &rstate->allocated_arena);
+	will_return(__wrap_munmap, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_rcache_delete(&rstate->rcache);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_null(rstate->rcache);
+
+	return 0;
+}
+
+/*
+ * rcache_expect_read -- expect a read to the arena
+ */
+void
+rcache_expect_read(size_t dst_offset, size_t src_offset, size_t len,
+		int result)
+{
+	expect_value(rpma_read, dst_offset, dst_offset);
+	expect_value(rpma_read, src_offset, src_offset);
+	expect_value(rpma_read, len, len);
+	will_return(rpma_read, result);
+}
+
+/*
+ * rcache_complete -- pass the completion of a posted read to the cache
+ */
+int
+rcache_complete(struct rpma_rcache *rcache, void *ctx,
+		enum ibv_wc_status status)
+{
+	struct rpma_completion cmpl = {0};
+	cmpl.op_context = ctx;
+	cmpl.op = RPMA_OP_READ;
+	cmpl.op_status = status;
+
+	return rpma_rcache_process(rcache, &cmpl);
+}
@@ -0,0 +1,49 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * rcache-common.h -- the rpma_rcache unit tests common definitions
+ */
+
+#ifndef RCACHE_COMMON_H
+#define RCACHE_COMMON_H
+
+#include "cmocka_headers.h"
+#include "librpma.h"
+#include "mocks-stdlib.h"
+#include "test-common.h"
+
+#define MOCK_RPMA_MR_REMOTE	((struct rpma_mr_remote *)0xC412)
+#define MOCK_SRC_SIZE		(size_t)4096
+#define MOCK_VERSION_OFFSET	(MOCK_SRC_SIZE - 8)
+
+#define MOCK_BLOCK_SIZE		64
+#define MOCK_BLOCKS		16 /* 4 ways of 4 sets */
+#define MOCK_SETS		4
+#define MOCK_DEPTH		2
+#define MOCK_VERSION_SLOT	(MOCK_BLOCKS * MOCK_BLOCK_SIZE)
+#define MOCK_ARENA_SIZE		(MOCK_VERSION_SLOT + 8)
+
+#define MOCK_OP_CONTEXT_2	(void *)0xC418
+
+struct rcache_test_state {
+	struct rpma_rcache *rcache;
+	struct mmap_args allocated_arena;
+};
+
+/* get the block of the arena of the given index */
+#define ARENA_BLOCK(rstate, block) \
+	((char *)(rstate)->allocated_arena.addr + (block) * MOCK_BLOCK_SIZE)
+
+/* the op_context of the most recently posted read */
+extern void *Posted_ctx;
+
+int setup__rcache_new(void **rstate_ptr);
+int teardown__rcache_delete(void **rstate_ptr);
+
+void rcache_expect_read(size_t dst_offset, size_t src_offset, size_t len,
+		int result);
+int rcache_complete(struct rpma_rcache *rcache, void *ctx,
+		enum ibv_wc_status status);
+
+#endif /* RCACHE_COMMON_H */
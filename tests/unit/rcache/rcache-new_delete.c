@@ -0,0 +1,305 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * rcache-new_delete.c -- the rpma_rcache_new/delete() unit tests
+ *
+ * APIs covered:
+ * - rpma_rcache_new()
+ * - rpma_rcache_delete()
+ */
+
+#include "mocks-unistd.h"
+#include "rcache-common.h"
+
+/*
+ * configure_mr_reg -- configure the mocks of rpma_mr_reg()
+ */
+static void
+configure_mr_reg(struct mmap_args *allocated_arena, int ret)
+{
+	will_return(__wrap_sysconf, MOCK_OK);
+	will_return(__wrap_mmap, MOCK_OK);
+	will_return(__wrap_mmap, allocated_arena);
+	expect_value(rpma_mr_reg, peer, MOCK_PEER);
+	expect_value(rpma_mr_reg, size, MOCK_ARENA_SIZE);
+	expect_value(rpma_mr_reg, usage, RPMA_MR_USAGE_READ_DST);
+	will_return(rpma_mr_reg, &allocated_arena->addr);
+	if (ret == MOCK_OK) {
+		will_return(rpma_mr_reg, MOCK_RPMA_MR_LOCAL);
+	} else {
+		will_return(rpma_mr_reg, NULL);
+		will_return(rpma_mr_reg, ret);
+	}
+}
+
+/*
+ * new__invalid_args -- invalid combinations of the arguments
+ */
+static void
+new__invalid_args(void **unused)
+{
+	struct rpma_rcache *rcache = NULL;
+	struct {
+		struct rpma_peer *peer;
+		struct rpma_conn *conn;
+		struct rpma_mr_remote *src;
+		size_t version_offset;
+		size_t block_size;
+		uint32_t blocks;
+		uint32_t depth;
+		struct rpma_rcache **rcache_ptr;
+	} args[] = {
+		{NULL, MOCK_CONN, MOCK_RPMA_MR_REMOTE, MOCK_VERSION_OFFSET,
+			MOCK_BLOCK_SIZE, MOCK_BLOCKS, MOCK_DEPTH, &rcache},
+		{MOCK_PEER, NULL, MOCK_RPMA_MR_REMOTE, MOCK_VERSION_OFFSET,
+			MOCK_BLOCK_SIZE, MOCK_BLOCKS, MOCK_DEPTH, &rcache},
+		{MOCK_PEER, MOCK_CONN, NULL, MOCK_VERSION_OFFSET,
+			MOCK_BLOCK_SIZE, MOCK_BLOCKS, MOCK_DEPTH, &rcache},
+		{MOCK_PEER, MOCK_CONN, MOCK_RPMA_MR_REMOTE, MOCK_VERSION_OFFSET,
+			0, MOCK_BLOCKS, MOCK_DEPTH, &rcache},
+		{MOCK_PEER, MOCK_CONN, MOCK_RPMA_MR_REMOTE, MOCK_VERSION_OFFSET,
+			MOCK_BLOCK_SIZE, 0, MOCK_DEPTH, &rcache},
+		{MOCK_PEER, MOCK_CONN, MOCK_RPMA_MR_REMOTE, MOCK_VERSION_OFFSET,
+			MOCK_BLOCK_SIZE, MOCK_BLOCKS, 0, &rcache},
+		/* the version word is not aligned */
+		{MOCK_PEER, MOCK_CONN, MOCK_RPMA_MR_REMOTE, 4, MOCK_BLOCK_SIZE,
+			MOCK_BLOCKS, MOCK_DEPTH, &rcache},
+		/* the version word does not fit in the region */
+		{MOCK_PEER, MOCK_CONN, MOCK_RPMA_MR_REMOTE, MOCK_SRC_SIZE,
+			MOCK_BLOCK_SIZE, MOCK_BLOCKS, MOCK_DEPTH, &rcache},
+		/* the size of the arena overflows */
+		{MOCK_PEER, MOCK_CONN, MOCK_RPMA_MR_REMOTE, MOCK_VERSION_OFFSET,
+			SIZE_MAX, MOCK_BLOCKS, MOCK_DEPTH, &rcache},
+		{MOCK_PEER, MOCK_CONN, MOCK_RPMA_MR_REMOTE, MOCK_VERSION_OFFSET,
+			MOCK_BLOCK_SIZE, MOCK_BLOCKS, MOCK_DEPTH, NULL},
+	};
+
+	for (size_t i = 0; i < sizeof(args) / sizeof(args[0]); ++i) {
+		/* run test */
+		int ret = rpma_rcache_new(args[i].peer, args[i].conn,
+				args[i].src, args[i].version_offset,
+				args[i].block_size, args[i].blocks,
+				args[i].depth, args[i].rcache_ptr);
+
+		/* verify the results */
+		assert_int_equal(ret, RPMA_E_INVAL);
+		assert_null(rcache);
+	}
+}
+
+/*
+ * new__sysconf_ERRNO -- sysconf() fails with MOCK_ERRNO
+ */
+static void
+new__sysconf_ERRNO(void **unused)
+{
+	/* configure mocks */
+	will_return(__wrap_sysconf, MOCK_ERRNO);
+
+	/* run test */
+	struct rpma_rcache *rcache = NULL;
+	int ret = rpma_rcache_new(MOCK_PEER, MOCK_CONN, MOCK_RPMA_MR_REMOTE,
+			MOCK_VERSION_OFFSET, MOCK_BLOCK_SIZE, MOCK_BLOCKS,
+			MOCK_DEPTH, &rcache);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(rcache);
+}
+
+/*
+ * new__mmap_ERRNO -- mmap() fails with MOCK_ERRNO
+ */
+static void
+new__mmap_ERRNO(void **unused)
+{
+	/* configure mocks */
+	will_return(__wrap_sysconf, MOCK_OK);
+	will_return(__wrap_mmap, MOCK_ERRNO);
+
+	/* run test */
+	struct rpma_rcache *rcache = NULL;
+	int ret = rpma_rcache_new(MOCK_PEER, MOCK_CONN, MOCK_RPMA_MR_REMOTE,
+			MOCK_VERSION_OFFSET, MOCK_BLOCK_SIZE, MOCK_BLOCKS,
+			MOCK_DEPTH, &rcache);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NOMEM);
+	assert_null(rcache);
+}
+
+/*
+ * new__mr_reg_E_PROVIDER -- rpma_mr_reg() fails with RPMA_E_PROVIDER
+ */
+static void
+new__mr_reg_E_PROVIDER(void **unused)
+{
+	struct mmap_args allocated_arena = {0};
+
+	/* configure mocks */
+	configure_mr_reg(&allocated_arena, RPMA_E_PROVIDER);
+	will_return(__wrap_munmap, &allocated_arena);
+	will_return(__wrap_munmap, MOCK_OK);
+
+	/* run test */
+	struct rpma_rcache *rcache = NULL;
+	int ret = rpma_rcache_new(MOCK_PEER, MOCK_CONN, MOCK_RPMA_MR_REMOTE,
+			MOCK_VERSION_OFFSET, MOCK_BLOCK_SIZE, MOCK_BLOCKS,
+			MOCK_DEPTH, &rcache);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(rcache);
+}
+
+/*
+ * new__malloc_ERRNO -- malloc() fails with MOCK_ERRNO
+ */
+static void
+new__malloc_ERRNO(void **unused)
+{
+	/* each of the two malloc() calls fails in turn */
+	for (int i = 0; i < 2; ++i) {
+		struct mmap_args allocated_arena = {0};
+
+		/* configure mocks */
+		configure_mr_reg(&allocated_arena, MOCK_OK);
+		for (int j = 0; j < i; ++j)
+			will_return(__wrap__test_malloc, MOCK_OK);
+		will_return(__wrap__test_malloc, MOCK_ERRNO);
+		expect_value(rpma_mr_dereg, *mr_ptr, MOCK_RPMA_MR_LOCAL);
+		will_return(rpma_mr_dereg, MOCK_OK);
+		will_return(__wrap_munmap, &allocated_arena);
+		will_return(__wrap_munmap, MOCK_OK);
+
+		/* run test */
+		struct rpma_rcache *rcache = NULL;
+		int ret = rpma_rcache_new(MOCK_PEER, MOCK_CONN,
+				MOCK_RPMA_MR_REMOTE, MOCK_VERSION_OFFSET,
+				MOCK_BLOCK_SIZE, MOCK_BLOCKS, MOCK_DEPTH,
+				&rcache);
+
+		/* verify the results */
+		assert_int_equal(ret, RPMA_E_NOMEM);
+		assert_null(rcache);
+	}
+}
+
+/*
+ * test_lifecycle -- happy day scenario
+ */
+static void
+test_lifecycle(void **unused)
+{
+	/*
+	 * the thing is done by setup__rcache_new() and
+	 * teardown__rcache_delete()
+	 */
+}
+
+/*
+ * delete__rcache_ptr_NULL -- NULL rcache_ptr is invalid
+ */
+static void
+delete__rcache_ptr_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_rcache_delete(NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * delete__rcache_NULL -- NULL rcache is valid - quick exit
+ */
+static void
+delete__rcache_NULL(void **unused)
+{
+	/* run test */
+	struct rpma_rcache *rcache = NULL;
+	int ret = rpma_rcache_delete(&rcache);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * delete__mr_dereg_E_PROVIDER -- rpma_mr_dereg() fails with
+ * RPMA_E_PROVIDER
+ */
+static void
+delete__mr_dereg_E_PROVIDER(void **unused)
+{
+	struct rcache_test_state *rstate;
+
+	/* WA for cmocka/issues#47 */
+	assert_int_equal(setup__rcache_new((void **)&rstate), 0);
+
+	/* configure mocks */
+	expect_value(rpma_mr_dereg, *mr_ptr, MOCK_RPMA_MR_LOCAL);
+	will_return(rpma_mr_dereg, RPMA_E_PROVIDER);
+	will_return(rpma_mr_dereg, MOCK_ERRNO);
+	will_return(__wrap_munmap, &rstate->allocated_arena);
+	will_return(__wrap_munmap, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_rcache_delete(&rstate->rcache);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(rstate->rcache);
+}
+
+/*
+ * delete__munmap_ERRNO -- munmap() fails with MOCK_ERRNO
+ */
+static void
+delete__munmap_ERRNO(void **unused)
+{
+	struct rcache_test_state *rstate;
+
+	/* WA for cmocka/issues#47 */
+	assert_int_equal(setup__rcache_new((void **)&rstate), 0);
+
+	/* configure mocks */
+	expect_value(rpma_mr_dereg, *mr_ptr, MOCK_RPMA_MR_LOCAL);
+	will_return(rpma_mr_dereg, MOCK_OK);
+	will_return(__wrap_munmap, &rstate->allocated_arena);
+	will_return(__wrap_munmap, MOCK_ERRNO);
+
+	/* run test */
+	int ret = rpma_rcache_delete(&rstate->rcache);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(rstate->rcache);
+}
+
+static const struct CMUnitTest tests_new_delete[] = {
+	/* rpma_rcache_new() unit tests */
+	cmocka_unit_test(new__invalid_args),
+	cmocka_unit_test(new__sysconf_ERRNO),
+	cmocka_unit_test(new__mmap_ERRNO),
+	cmocka_unit_test(new__mr_reg_E_PROVIDER),
+	cmocka_unit_test(new__malloc_ERRNO),
+
+	/* rpma_rcache_new()/delete() lifecycle */
+	cmocka_unit_test_setup_teardown(test_lifecycle,
+		setup__rcache_new, teardown__rcache_delete),
+
+	/* rpma_rcache_delete() unit tests */
+	cmocka_unit_test(delete__rcache_ptr_NULL),
+	cmocka_unit_test(delete__rcache_NULL),
+	cmocka_unit_test(delete__mr_dereg_E_PROVIDER),
+	cmocka_unit_test(delete__munmap_ERRNO),
+
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_new_delete, NULL, NULL);
+}
@@ -0,0 +1,363 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * rcache-read_submit.c -- the rpma_rcache_read/submit() unit tests
+ *
+ * APIs covered:
+ * - rpma_rcache_read()
+ * - rpma_rcache_submit()
+ */
+
+#include <string.h>
+
+#include "rcache-common.h"
+
+static char Dst[2 * MOCK_BLOCK_SIZE];
+
+/*
+ * fill_block -- fill the block of the arena as if it has been read
+ * from the remote block of the given tag
+ */
+static void
+fill_block(struct rcache_test_state *rstate, uint32_t block, size_t tag)
+{
+	memset(ARENA_BLOCK(rstate, block), (int)(tag + 1), MOCK_BLOCK_SIZE);
+}
+
+/*
+ * fetch_block -- read the remote block of the given tag expecting it
+ * to miss and to be fetched to the given block of the arena
+ */
+static void
+fetch_block(struct rcache_test_state *rstate, size_t tag, uint32_t block)
+{
+	int ret = rpma_rcache_read(rstate->rcache, Dst,
+			tag * MOCK_BLOCK_SIZE, MOCK_BLOCK_SIZE,
+			MOCK_OP_CONTEXT);
+	assert_int_equal(ret, MOCK_OK);
+
+	rcache_expect_read(block * MOCK_BLOCK_SIZE, tag * MOCK_BLOCK_SIZE,
+			MOCK_BLOCK_SIZE, MOCK_OK);
+	ret = rpma_rcache_submit(rstate->rcache);
+	assert_int_equal(ret, MOCK_OK);
+
+	fill_block(rstate, block, tag);
+	ret = rcache_complete(rstate->rcache, Posted_ctx, IBV_WC_SUCCESS);
+	assert_int_equal(ret, MOCK_OK);
+
+	struct rpma_completion cmpl = {0};
+	ret = rpma_rcache_next(rstate->rcache, &cmpl);
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(cmpl.op_status, IBV_WC_SUCCESS);
+}
+
+/*
+ * read__invalid_args -- invalid combinations of the arguments
+ */
+static void
+read__invalid_args(void **rstate_ptr)
+{
+	struct rcache_test_state *rstate = *rstate_ptr;
+	struct {
+		struct rpma_rcache *rcache;
+		void *dst;
+		size_t src_offset;
+		size_t len;
+	} args[] = {
+		{NULL, Dst, 0, MOCK_BLOCK_SIZE},
+		{rstate->rcache, NULL, 0, MOCK_BLOCK_SIZE},
+		{rstate->rcache, Dst, 0, 0},
+		/* the data does not fit in the region */
+		{rstate->rcache, Dst, MOCK_SRC_SIZE - 8, 16},
+		{rstate->rcache, Dst, MOCK_SRC_SIZE + 1, 1},
+		/* the data spans more blocks than the number of sets */
+		{rstate->rcache, Dst, 8, MOCK_SETS * MOCK_BLOCK_SIZE},
+	};
+
+	for (size_t i = 0; i < sizeof(args) / sizeof(args[0]); ++i) {
+		/* run test */
+		int ret = rpma_rcache_read(args[i].rcache, args[i].dst,
+				args[i].src_offset, args[i].len,
+				MOCK_OP_CONTEXT);
+
+		/* verify the results */
+		assert_int_equal(ret, RPMA_E_INVAL);
+	}
+}
+
+/*
+ * read__miss_hit -- the missing blocks are read at once and the following
+ * read of them is served from the cache
+ */
+static void
+read__miss_hit(void **rstate_ptr)
+{
+	struct rcache_test_state *rstate = *rstate_ptr;
+	struct rpma_completion cmpl = {0};
+
+	/* run test - the data spans the two first blocks */
+	int ret = rpma_rcache_read(rstate->rcache, Dst, 16, 100,
+			MOCK_OP_CONTEXT);
+	assert_int_equal(ret, MOCK_OK);
+	ret = rpma_rcache_next(rstate->rcache, &cmpl);
+	assert_int_equal(ret, RPMA_E_NO_COMPLETION);
+
+	rcache_expect_read(0, 0, 2 * MOCK_BLOCK_SIZE, MOCK_OK);
+	ret = rpma_rcache_submit(rstate->rcache);
+	assert_int_equal(ret, MOCK_OK);
+
+	fill_block(rstate, 0, 0);
+	fill_block(rstate, 1, 1);
+	ret = rcache_complete(rstate->rcache, Posted_ctx, IBV_WC_SUCCESS);
+	assert_int_equal(ret, MOCK_OK);
+
+	/* verify the results */
+	ret = rpma_rcache_next(rstate->rcache, &cmpl);
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(cmpl.op_context, MOCK_OP_CONTEXT);
+	assert_int_equal(cmpl.op, RPMA_OP_READ);
+	assert_int_equal(cmpl.op_status, IBV_WC_SUCCESS);
+	assert_memory_equal(Dst, ARENA_BLOCK(rstate, 0) + 16, 100);
+
+	/* run test - the second block is cached now */
+	memset(Dst, 0, sizeof(Dst));
+	ret = rpma_rcache_read(rstate->rcache, Dst, MOCK_BLOCK_SIZE,
+			MOCK_BLOCK_SIZE, MOCK_OP_CONTEXT_2);
+	assert_int_equal(ret, MOCK_OK);
+	ret = rpma_rcache_submit(rstate->rcache);
+	assert_int_equal(ret, MOCK_OK);
+
+	/* verify the results */
+	ret = rpma_rcache_next(rstate->rcache, &cmpl);
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(cmpl.op_context, MOCK_OP_CONTEXT_2);
+	assert_int_equal(cmpl.op_status, IBV_WC_SUCCESS);
+	assert_memory_equal(Dst, ARENA_BLOCK(rstate, 1), MOCK_BLOCK_SIZE);
+	ret = rpma_rcache_next(rstate->rcache, &cmpl);
+	assert_int_equal(ret, RPMA_E_NO_COMPLETION);
+}
+
+/*
+ * read__shared_miss -- the block missed by two reads is read only once
+ */
+static void
+read__shared_miss(void **rstate_ptr)
+{
+	struct rcache_test_state *rstate = *rstate_ptr;
+	char dst2[8];
+
+	/* run test */
+	int ret = rpma_rcache_read(rstate->rcache, Dst, 0, 8,
+			MOCK_OP_CONTEXT);
+	assert_int_equal(ret, MOCK_OK);
+	ret = rpma_rcache_read(rstate->rcache, dst2, 8, 8,
+			MOCK_OP_CONTEXT_2);
+	assert_int_equal(ret, MOCK_OK);
+
+	rcache_expect_read(0, 0, MOCK_BLOCK_SIZE, MOCK_OK);
+	ret = rpma_rcache_submit(rstate->rcache);
+	assert_int_equal(ret, MOCK_OK);
+
+	fill_block(rstate, 0, 0);
+	ret = rcache_complete(rstate->rcache, Posted_ctx, IBV_WC_SUCCESS);
+	assert_int_equal(ret, MOCK_OK);
+
+	/* verify the results */
+	struct rpma_completion cmpl = {0};
+	ret = rpma_rcache_next(rstate->rcache, &cmpl);
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(cmpl.op_context, MOCK_OP_CONTEXT);
+	assert_memory_equal(Dst, ARENA_BLOCK(rstate, 0), 8);
+	ret = rpma_rcache_next(rstate->rcache, &cmpl);
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(cmpl.op_context, MOCK_OP_CONTEXT_2);
+	assert_memory_equal(dst2, ARENA_BLOCK(rstate, 0) + 8, 8);
+}
+
+/*
+ * read__depth_E_AGAIN -- no more than depth reads can be in progress
+ */
+static void
+read__depth_E_AGAIN(void **rstate_ptr)
+{
+	struct rcache_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	for (int i = 0; i < MOCK_DEPTH; ++i) {
+		int ret = rpma_rcache_read(rstate->rcache, Dst, 0, 8,
+				MOCK_OP_CONTEXT);
+		assert_int_equal(ret, MOCK_OK);
+	}
+
+	/* run test */
+	int ret = rpma_rcache_read(rstate->rcache, Dst, 0, 8,
+			MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_AGAIN);
+
+	/* complete the reads so the cache can be deleted */
+	rcache_expect_read(0, 0, MOCK_BLOCK_SIZE, MOCK_OK);
+	ret = rpma_rcache_submit(rstate->rcache);
+	assert_int_equal(ret, MOCK_OK);
+	ret = rcache_complete(rstate->rcache, Posted_ctx, IBV_WC_SUCCESS);
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * read__evict_lru -- the least recently used block of the set is evicted
+ */
+static void
+read__evict_lru(void **rstate_ptr)
+{
+	struct rcache_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks - the tags 0, 4, 8 and 12 share the first set */
+	for (size_t tag = 0; tag < 4 * MOCK_SETS; tag += MOCK_SETS)
+		fetch_block(rstate, tag, (uint32_t)tag);
+
+	/* the block of the tag 0 is used again */
+	int ret = rpma_rcache_read(rstate->rcache, Dst, 0, 8,
+			MOCK_OP_CONTEXT);
+	assert_int_equal(ret, MOCK_OK);
+	struct rpma_completion cmpl = {0};
+	ret = rpma_rcache_next(rstate->rcache, &cmpl);
+	assert_int_equal(ret, MOCK_OK);
+
+	/* run test - the block of the tag 4 is the least recently used one */
+	fetch_block(rstate, 4 * MOCK_SETS, MOCK_SETS);
+
+	/* verify the results - the tag 0 is still cached */
+	ret = rpma_rcache_read(rstate->rcache, Dst, 0, 8,
+			MOCK_OP_CONTEXT);
+	assert_int_equal(ret, MOCK_OK);
+	ret = rpma_rcache_next(rstate->rcache, &cmpl);
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * submit__sorted -- the misses are read in the order of the remote
+ * offsets and only the adjacent ones are read at once
+ */
+static void
+submit__sorted(void **rstate_ptr)
+{
+	struct rcache_test_state *rstate = *rstate_ptr;
+	char dst2[8];
+
+	/* configure mocks */
+	int ret = rpma_rcache_read(rstate->rcache, Dst, 2 * MOCK_BLOCK_SIZE,
+			8, MOCK_OP_CONTEXT);
+	assert_int_equal(ret, MOCK_OK);
+	ret = rpma_rcache_read(rstate->rcache, dst2, 0, 8,
+			MOCK_OP_CONTEXT_2);
+	assert_int_equal(ret, MOCK_OK);
+	rcache_expect_read(0, 0, MOCK_BLOCK_SIZE, MOCK_OK);
+	rcache_expect_read(2 * MOCK_BLOCK_SIZE, 2 * MOCK_BLOCK_SIZE,
+			MOCK_BLOCK_SIZE, MOCK_OK);
+
+	/* run test */
+	ret = rpma_rcache_submit(rstate->rcache);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+
+	/* the block read last completes the read issued first */
+	ret = rcache_complete(rstate->rcache, Posted_ctx, IBV_WC_SUCCESS);
+	assert_int_equal(ret, MOCK_OK);
+	struct rpma_completion cmpl = {0};
+	ret = rpma_rcache_next(rstate->rcache, &cmpl);
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(cmpl.op_context, MOCK_OP_CONTEXT);
+	ret = rpma_rcache_next(rstate->rcache, &cmpl);
+	assert_int_equal(ret, RPMA_E_NO_COMPLETION);
+}
+
+/*
+ * submit__read_E_PROVIDER -- rpma_read() fails with RPMA_E_PROVIDER
+ */
+static void
+submit__read_E_PROVIDER(void **rstate_ptr)
+{
+	struct rcache_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	int ret = rpma_rcache_read(rstate->rcache, Dst, 0, 8,
+			MOCK_OP_CONTEXT);
+	assert_int_equal(ret, MOCK_OK);
+	rcache_expect_read(0, 0, MOCK_BLOCK_SIZE, RPMA_E_PROVIDER);
+
+	/* run test */
+	ret = rpma_rcache_submit(rstate->rcache);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	struct rpma_completion cmpl = {0};
+	ret = rpma_rcache_next(rstate->rcache, &cmpl);
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(cmpl.op_context, MOCK_OP_CONTEXT);
+	assert_int_equal(cmpl.op_status, IBV_WC_GENERAL_ERR);
+
+	/* the block has not been cached */
+	fetch_block(rstate, 0, 0);
+}
+
+/*
+ * submit__nothing -- nothing is read when there are no misses
+ */
+static void
+submit__nothing(void **rstate_ptr)
+{
+	struct rcache_test_state *rstate = *rstate_ptr;
+
+	/* run test */
+	int ret = rpma_rcache_submit(rstate->rcache);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * submit__rcache_NULL -- NULL rcache is invalid
+ */
+static void
+submit__rcache_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_rcache_submit(NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+static const struct CMUnitTest tests_read_submit[] = {
+	/* rpma_rcache_read() unit tests */
+	cmocka_unit_test_setup_teardown(read__invalid_args,
+		setup__rcache_new, teardown__rcache_delete),
+	cmocka_unit_test_setup_teardown(read__miss_hit,
+		setup__rcache_new, teardown__rcache_delete),
+	cmocka_unit_test_setup_teardown(read__shared_miss,
+		setup__rcache_new, teardown__rcache_delete),
+	cmocka_unit_test_setup_teardown(read__depth_E_AGAIN,
+		setup__rcache_new, teardown__rcache_delete),
+	cmocka_unit_test_setup_teardown(read__evict_lru,
+		setup__rcache_new, teardown__rcache_delete),
+
+	/* rpma_rcache_submit() unit tests */
+	cmocka_unit_test_setup_teardown(submit__sorted,
+		setup__rcache_new, teardown__rcache_delete),
+	cmocka_unit_test_setup_teardown(submit__read_E_PROVIDER,
+		setup__rcache_new, teardown__rcache_delete),
+	cmocka_unit_test_setup_teardown(submit__nothing,
+		setup__rcache_new, teardown__rcache_delete),
+	cmocka_unit_test(submit__rcache_NULL),
+
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_read_submit, NULL, NULL);
+}
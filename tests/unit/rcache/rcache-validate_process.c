@@ -0,0 +1,452 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * rcache-validate_process.c -- the rpma_rcache_validate/invalidate/process/
+ * next() unit tests
+ *
+ * APIs covered:
+ * - rpma_rcache_validate()
+ * - rpma_rcache_invalidate()
+ * - rpma_rcache_process()
+ * - rpma_rcache_next()
+ */
+
+#include <string.h>
+
+#include "rcache-common.h"
+
+static char Dst[MOCK_BLOCK_SIZE];
+
+/*
+ * cache_block -- cache the first block of the region
+ */
+static void
+cache_block(struct rcache_test_state *rstate)
+{
+	int ret = rpma_rcache_read(rstate->rcache, Dst, 0, 8,
+			MOCK_OP_CONTEXT);
+	assert_int_equal(ret, MOCK_OK);
+	rcache_expect_read(0, 0, MOCK_BLOCK_SIZE, MOCK_OK);
+	ret = rpma_rcache_submit(rstate->rcache);
+	assert_int_equal(ret, MOCK_OK);
+	ret = rcache_complete(rstate->rcache, Posted_ctx, IBV_WC_SUCCESS);
+	assert_int_equal(ret, MOCK_OK);
+
+	struct rpma_completion cmpl = {0};
+	ret = rpma_rcache_next(rstate->rcache, &cmpl);
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * read_block -- read the first block of the region and check whether it is
+ * served from the cache
+ */
+static void
+read_block(struct rcache_test_state *rstate, int cached)
+{
+	int ret = rpma_rcache_read(rstate->rcache, Dst, 0, 8,
+			MOCK_OP_CONTEXT);
+	assert_int_equal(ret, MOCK_OK);
+
+	struct rpma_completion cmpl = {0};
+	ret = rpma_rcache_next(rstate->rcache, &cmpl);
+	assert_int_equal(ret, cached ? MOCK_OK : RPMA_E_NO_COMPLETION);
+	if (cached)
+		return;
+
+	/* complete the read of the miss */
+	rcache_expect_read(0, 0, MOCK_BLOCK_SIZE, MOCK_OK);
+	ret = rpma_rcache_submit(rstate->rcache);
+	assert_int_equal(ret, MOCK_OK);
+	ret = rcache_complete(rstate->rcache, Posted_ctx, IBV_WC_SUCCESS);
+	assert_int_equal(ret, MOCK_OK);
+	ret = rpma_rcache_next(rstate->rcache, &cmpl);
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * validate_version -- read the version word of the given value
+ */
+static int
+validate_version(struct rcache_test_state *rstate, uint64_t version)
+{
+	rcache_expect_read(MOCK_VERSION_SLOT, MOCK_VERSION_OFFSET, 8, MOCK_OK);
+	int ret = rpma_rcache_validate(rstate->rcache);
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(Posted_ctx, rstate->rcache);
+
+	memcpy(ARENA_BLOCK(rstate, 0) + MOCK_VERSION_SLOT, &version,
+			sizeof(version));
+
+	return rcache_complete(rstate->rcache, Posted_ctx, IBV_WC_SUCCESS);
+}
+
+/*
+ * validate__rcache_NULL -- NULL rcache is invalid
+ */
+static void
+validate__rcache_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_rcache_validate(NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * validate__read_E_PROVIDER -- rpma_read() fails with RPMA_E_PROVIDER
+ */
+static void
+validate__read_E_PROVIDER(void **rstate_ptr)
+{
+	struct rcache_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	rcache_expect_read(MOCK_VERSION_SLOT, MOCK_VERSION_OFFSET, 8,
+			RPMA_E_PROVIDER);
+
+	/* run test */
+	int ret = rpma_rcache_validate(rstate->rcache);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+}
+
+/*
+ * validate__in_flight_E_AGAIN -- the version word is being read already
+ */
+static void
+validate__in_flight_E_AGAIN(void **rstate_ptr)
+{
+	struct rcache_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	rcache_expect_read(MOCK_VERSION_SLOT, MOCK_VERSION_OFFSET, 8, MOCK_OK);
+	int ret = rpma_rcache_validate(rstate->rcache);
+	assert_int_equal(ret, MOCK_OK);
+
+	/* run test */
+	ret = rpma_rcache_validate(rstate->rcache);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_AGAIN);
+}
+
+/*
+ * validate__version_unchanged -- the cached blocks are kept as long as
+ * the version does not change
+ */
+static void
+validate__version_unchanged(void **rstate_ptr)
+{
+	struct rcache_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	assert_int_equal(validate_version(rstate, 1), MOCK_OK);
+	cache_block(rstate);
+
+	/* run test */
+	int ret = validate_version(rstate, 1);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	read_block(rstate, 1);
+}
+
+/*
+ * validate__version_changed -- the cached blocks are dropped when
+ * the version changes
+ */
+static void
+validate__version_changed(void **rstate_ptr)
+{
+	struct rcache_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	assert_int_equal(validate_version(rstate, 1), MOCK_OK);
+	cache_block(rstate);
+
+	/* run test */
+	int ret = validate_version(rstate, 2);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	read_block(rstate, 0);
+	read_block(rstate, 1);
+}
+
+/*
+ * validate__first_version -- the blocks cached before the first validation
+ * are dropped
+ */
+static void
+validate__first_version(void **rstate_ptr)
+{
+	struct rcache_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	cache_block(rstate);
+
+	/* run test */
+	int ret = validate_version(rstate, 0);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	read_block(rstate, 0);
+}
+
+/*
+ * validate__fetch_in_flight -- the block posted after the version word
+ * is kept when the version changes
+ */
+static void
+validate__fetch_in_flight(void **rstate_ptr)
+{
+	struct rcache_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	assert_int_equal(validate_version(rstate, 1), MOCK_OK);
+	rcache_expect_read(MOCK_VERSION_SLOT, MOCK_VERSION_OFFSET, 8, MOCK_OK);
+	int ret = rpma_rcache_validate(rstate->rcache);
+	assert_int_equal(ret, MOCK_OK);
+	ret = rpma_rcache_read(rstate->rcache, Dst, 0, 8, MOCK_OP_CONTEXT);
+	assert_int_equal(ret, MOCK_OK);
+	rcache_expect_read(0, 0, MOCK_BLOCK_SIZE, MOCK_OK);
+	ret = rpma_rcache_submit(rstate->rcache);
+	assert_int_equal(ret, MOCK_OK);
+	void *fetch_ctx = Posted_ctx;
+
+	/* run test */
+	uint64_t version = 2;
+	memcpy(ARENA_BLOCK(rstate, 0) + MOCK_VERSION_SLOT, &version,
+			sizeof(version));
+	ret = rcache_complete(rstate->rcache, rstate->rcache, IBV_WC_SUCCESS);
+	assert_int_equal(ret, MOCK_OK);
+	ret = rcache_complete(rstate->rcache, fetch_ctx, IBV_WC_SUCCESS);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	struct rpma_completion cmpl = {0};
+	ret = rpma_rcache_next(rstate->rcache, &cmpl);
+	assert_int_equal(ret, MOCK_OK);
+	read_block(rstate, 1);
+}
+
+/*
+ * process__invalid_args -- NULL rcache or cmpl is invalid
+ */
+static void
+process__invalid_args(void **rstate_ptr)
+{
+	struct rcache_test_state *rstate = *rstate_ptr;
+	struct rpma_completion cmpl = {0};
+
+	/* run test */
+	int ret1 = rpma_rcache_process(NULL, &cmpl);
+	int ret2 = rpma_rcache_process(rstate->rcache, NULL);
+
+	/* verify the results */
+	assert_int_equal(ret1, RPMA_E_INVAL);
+	assert_int_equal(ret2, RPMA_E_INVAL);
+}
+
+/*
+ * process__foreign -- the completion does not come from the cache
+ */
+static void
+process__foreign(void **rstate_ptr)
+{
+	struct rcache_test_state *rstate = *rstate_ptr;
+
+	/* run test */
+	int ret1 = rcache_complete(rstate->rcache, MOCK_OP_CONTEXT,
+			IBV_WC_SUCCESS);
+	/* the version word is not being read */
+	int ret2 = rcache_complete(rstate->rcache, rstate->rcache,
+			IBV_WC_SUCCESS);
+
+	/* verify the results */
+	assert_int_equal(ret1, RPMA_E_INVAL);
+	assert_int_equal(ret2, RPMA_E_INVAL);
+}
+
+/*
+ * process__block_not_fetched -- the completion of the block which is not
+ * being read
+ */
+static void
+process__block_not_fetched(void **rstate_ptr)
+{
+	struct rcache_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	cache_block(rstate);
+
+	/* run test */
+	int ret = rcache_complete(rstate->rcache, Posted_ctx, IBV_WC_SUCCESS);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * process__read_failed -- the failed read of a block is reported by
+ * the read waiting for it
+ */
+static void
+process__read_failed(void **rstate_ptr)
+{
+	struct rcache_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	int ret = rpma_rcache_read(rstate->rcache, Dst, 0, 8,
+			MOCK_OP_CONTEXT);
+	assert_int_equal(ret, MOCK_OK);
+	rcache_expect_read(0, 0, MOCK_BLOCK_SIZE, MOCK_OK);
+	ret = rpma_rcache_submit(rstate->rcache);
+	assert_int_equal(ret, MOCK_OK);
+
+	/* run test */
+	ret = rcache_complete(rstate->rcache, Posted_ctx,
+			IBV_WC_REM_ACCESS_ERR);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	struct rpma_completion cmpl = {0};
+	ret = rpma_rcache_next(rstate->rcache, &cmpl);
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(cmpl.op_context, MOCK_OP_CONTEXT);
+	assert_int_equal(cmpl.op_status, IBV_WC_REM_ACCESS_ERR);
+	read_block(rstate, 0);
+}
+
+/*
+ * process__version_failed -- the failed read of the version word
+ */
+static void
+process__version_failed(void **rstate_ptr)
+{
+	struct rcache_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	rcache_expect_read(MOCK_VERSION_SLOT, MOCK_VERSION_OFFSET, 8, MOCK_OK);
+	int ret = rpma_rcache_validate(rstate->rcache);
+	assert_int_equal(ret, MOCK_OK);
+
+	/* run test */
+	ret = rcache_complete(rstate->rcache, Posted_ctx,
+			IBV_WC_REM_ACCESS_ERR);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_int_equal(validate_version(rstate, 1), MOCK_OK);
+}
+
+/*
+ * invalidate__invalid_args -- invalid combinations of the arguments
+ */
+static void
+invalidate__invalid_args(void **rstate_ptr)
+{
+	struct rcache_test_state *rstate = *rstate_ptr;
+
+	/* run test */
+	int ret1 = rpma_rcache_invalidate(NULL, 0, 8);
+	int ret2 = rpma_rcache_invalidate(rstate->rcache, 0, 0);
+	int ret3 = rpma_rcache_invalidate(rstate->rcache, MOCK_SRC_SIZE, 8);
+
+	/* verify the results */
+	assert_int_equal(ret1, RPMA_E_INVAL);
+	assert_int_equal(ret2, RPMA_E_INVAL);
+	assert_int_equal(ret3, RPMA_E_INVAL);
+}
+
+/*
+ * invalidate__success -- only the blocks of the range are dropped
+ */
+static void
+invalidate__success(void **rstate_ptr)
+{
+	struct rcache_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	cache_block(rstate);
+	int ret = rpma_rcache_invalidate(rstate->rcache, MOCK_BLOCK_SIZE,
+			MOCK_BLOCK_SIZE);
+	assert_int_equal(ret, MOCK_OK);
+	read_block(rstate, 1);
+
+	/* run test */
+	ret = rpma_rcache_invalidate(rstate->rcache, MOCK_BLOCK_SIZE - 1, 2);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	read_block(rstate, 0);
+}
+
+/*
+ * next__invalid_args -- NULL rcache or cmpl is invalid
+ */
+static void
+next__invalid_args(void **rstate_ptr)
+{
+	struct rcache_test_state *rstate = *rstate_ptr;
+	struct rpma_completion cmpl = {0};
+
+	/* run test */
+	int ret1 = rpma_rcache_next(NULL, &cmpl);
+	int ret2 = rpma_rcache_next(rstate->rcache, NULL);
+
+	/* verify the results */
+	assert_int_equal(ret1, RPMA_E_INVAL);
+	assert_int_equal(ret2, RPMA_E_INVAL);
+}
+
+static const struct CMUnitTest tests_validate_process[] = {
+	/* rpma_rcache_validate() unit tests */
+	cmocka_unit_test(validate__rcache_NULL),
+	cmocka_unit_test_setup_teardown(validate__read_E_PROVIDER,
+		setup__rcache_new, teardown__rcache_delete),
+	cmocka_unit_test_setup_teardown(validate__in_flight_E_AGAIN,
+		setup__rcache_new, teardown__rcache_delete),
+	cmocka_unit_test_setup_teardown(validate__version_unchanged,
+		setup__rcache_new, teardown__rcache_delete),
+	cmocka_unit_test_setup_teardown(validate__version_changed,
+		setup__rcache_new, teardown__rcache_delete),
+	cmocka_unit_test_setup_teardown(validate__first_version,
+		setup__rcache_new, teardown__rcache_delete),
+	cmocka_unit_test_setup_teardown(validate__fetch_in_flight,
+		setup__rcache_new, teardown__rcache_delete),
+
+	/* rpma_rcache_process() unit tests */
+	cmocka_unit_test_setup_teardown(process__invalid_args,
+		setup__rcache_new, teardown__rcache_delete),
+	cmocka_unit_test_setup_teardown(process__foreign,
+		setup__rcache_new, teardown__rcache_delete),
+	cmocka_unit_test_setup_teardown(process__block_not_fetched,
+		setup__rcache_new, teardown__rcache_delete),
+	cmocka_unit_test_setup_teardown(process__read_failed,
+		setup__rcache_new, teardown__rcache_delete),
+	cmocka_unit_test_setup_teardown(process__version_failed,
+		setup__rcache_new, teardown__rcache_delete),
+
+	/* rpma_rcache_invalidate() unit tests */
+	cmocka_unit_test_setup_teardown(invalidate__invalid_args,
+		setup__rcache_new, teardown__rcache_delete),
+	cmocka_unit_test_setup_teardown(invalidate__success,
+		setup__rcache_new, teardown__rcache_delete),
+
+	/* rpma_rcache_next() unit tests */
+	cmocka_unit_test_setup_teardown(next__invalid_args,
+		setup__rcache_new, teardown__rcache_delete),
+
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_validate_process, NULL, NULL);
+}
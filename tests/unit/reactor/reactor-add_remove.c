@@ -0,0 +1,294 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * reactor-add_remove.c -- the rpma_reactor_add/remove_conn/ep() unit tests
+ *
+ * APIs covered:
+ * - rpma_reactor_add_conn()
+ * - rpma_reactor_remove_conn()
+ * - rpma_reactor_add_ep()
+ * - rpma_reactor_remove_ep()
+ */
+
+#include <sys/epoll.h>
+
+#include "reactor-common.h"
+
+/*
+ * add_conn__invalid_args -- invalid combinations of the arguments
+ */
+static void
+add_conn__invalid_args(void **rstate_ptr)
+{
+	struct reactor_test_state *rstate = *rstate_ptr;
+
+	/* run test */
+	int ret1 = rpma_reactor_add_conn(NULL, MOCK_CONN, conn_event_func,
+			completion_func, MOCK_ARG);
+	int ret2 = rpma_reactor_add_conn(rstate->reactor, NULL,
+			conn_event_func, completion_func, MOCK_ARG);
+	int ret3 = rpma_reactor_add_conn(rstate->reactor, MOCK_CONN, NULL,
+			NULL, MOCK_ARG);
+
+	/* verify the results */
+	assert_int_equal(ret1, RPMA_E_INVAL);
+	assert_int_equal(ret2, RPMA_E_INVAL);
+	assert_int_equal(ret3, RPMA_E_INVAL);
+}
+
+/*
+ * add_conn__already_registered -- a connection cannot be registered twice
+ */
+static void
+add_conn__already_registered(void **rstate_ptr)
+{
+	struct reactor_test_state *rstate = *rstate_ptr;
+	assert_int_equal(reactor_add_conn(rstate->reactor), MOCK_OK);
+
+	/* run test */
+	int ret = rpma_reactor_add_conn(rstate->reactor, MOCK_CONN,
+			conn_event_func, NULL, MOCK_ARG);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * add_conn__malloc_ERRNO -- malloc() of the completion source fails
+ * so the event source is unregistered
+ */
+static void
+add_conn__malloc_ERRNO(void **rstate_ptr)
+{
+	struct reactor_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	will_return(__wrap__test_malloc, MOCK_OK);
+	reactor_expect_epoll_ctl(EPOLL_CTL_ADD, MOCK_EVENT_FD, MOCK_OK);
+	will_return(__wrap__test_malloc, MOCK_ERRNO);
+	reactor_expect_epoll_ctl(EPOLL_CTL_DEL, MOCK_EVENT_FD, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_reactor_add_conn(rstate->reactor, MOCK_CONN,
+			conn_event_func, completion_func, MOCK_ARG);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NOMEM);
+
+	/* the connection can be registered again */
+	assert_int_equal(reactor_add_conn(rstate->reactor), MOCK_OK);
+}
+
+/*
+ * add_conn__epoll_ctl_ERRNO -- epoll_ctl() fails with MOCK_ERRNO
+ */
+static void
+add_conn__epoll_ctl_ERRNO(void **rstate_ptr)
+{
+	struct reactor_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	will_return(__wrap__test_malloc, MOCK_OK);
+	reactor_expect_epoll_ctl(EPOLL_CTL_ADD, MOCK_EVENT_FD, MOCK_ERRNO);
+
+	/* run test */
+	int ret = rpma_reactor_add_conn(rstate->reactor, MOCK_CONN,
+			conn_event_func, completion_func, MOCK_ARG);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+
+	/* the connection is not registered */
+	ret = rpma_reactor_remove_conn(rstate->reactor, MOCK_CONN);
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * add_conn__completions_only -- only the completion fd is registered
+ */
+static void
+add_conn__completions_only(void **rstate_ptr)
+{
+	struct reactor_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	will_return(__wrap__test_malloc, MOCK_OK);
+	reactor_expect_epoll_ctl(EPOLL_CTL_ADD, MOCK_COMPLETION_FD, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_reactor_add_conn(rstate->reactor, MOCK_CONN, NULL,
+			completion_func, MOCK_ARG);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+
+	reactor_expect_epoll_ctl(EPOLL_CTL_DEL, MOCK_COMPLETION_FD, MOCK_OK);
+	ret = rpma_reactor_remove_conn(rstate->reactor, MOCK_CONN);
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * remove_conn__invalid_args -- invalid combinations of the arguments
+ */
+static void
+remove_conn__invalid_args(void **rstate_ptr)
+{
+	struct reactor_test_state *rstate = *rstate_ptr;
+
+	/* run test */
+	int ret1 = rpma_reactor_remove_conn(NULL, MOCK_CONN);
+	int ret2 = rpma_reactor_remove_conn(rstate->reactor, NULL);
+	/* the connection is not registered */
+	int ret3 = rpma_reactor_remove_conn(rstate->reactor, MOCK_CONN);
+
+	/* verify the results */
+	assert_int_equal(ret1, RPMA_E_INVAL);
+	assert_int_equal(ret2, RPMA_E_INVAL);
+	assert_int_equal(ret3, RPMA_E_INVAL);
+}
+
+/*
+ * remove_conn__success -- both the fds of the connection are unregistered
+ */
+static void
+remove_conn__success(void **rstate_ptr)
+{
+	struct reactor_test_state *rstate = *rstate_ptr;
+	assert_int_equal(reactor_add_conn(rstate->reactor), MOCK_OK);
+
+	/* configure mocks */
+	reactor_expect_epoll_ctl(EPOLL_CTL_DEL, MOCK_COMPLETION_FD, MOCK_OK);
+	reactor_expect_epoll_ctl(EPOLL_CTL_DEL, MOCK_EVENT_FD, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_reactor_remove_conn(rstate->reactor, MOCK_CONN);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	ret = rpma_reactor_remove_conn(rstate->reactor, MOCK_CONN);
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * add_ep__invalid_args -- invalid combinations of the arguments
+ */
+static void
+add_ep__invalid_args(void **rstate_ptr)
+{
+	struct reactor_test_state *rstate = *rstate_ptr;
+
+	/* run test */
+	int ret1 = rpma_reactor_add_ep(NULL, MOCK_EP, MOCK_CONN_CFG,
+			conn_req_func, MOCK_ARG);
+	int ret2 = rpma_reactor_add_ep(rstate->reactor, NULL, MOCK_CONN_CFG,
+			conn_req_func, MOCK_ARG);
+	int ret3 = rpma_reactor_add_ep(rstate->reactor, MOCK_EP,
+			MOCK_CONN_CFG, NULL, MOCK_ARG);
+
+	/* verify the results */
+	assert_int_equal(ret1, RPMA_E_INVAL);
+	assert_int_equal(ret2, RPMA_E_INVAL);
+	assert_int_equal(ret3, RPMA_E_INVAL);
+}
+
+/*
+ * add_ep__malloc_ERRNO -- malloc() fails with MOCK_ERRNO
+ */
+static void
+add_ep__malloc_ERRNO(void **rstate_ptr)
+{
+	struct reactor_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	will_return(__wrap__test_malloc, MOCK_ERRNO);
+
+	/* run test */
+	int ret = rpma_reactor_add_ep(rstate->reactor, MOCK_EP, MOCK_CONN_CFG,
+			conn_req_func, MOCK_ARG);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NOMEM);
+}
+
+/*
+ * add_ep__success -- the endpoint is registered once
+ */
+static void
+add_ep__success(void **rstate_ptr)
+{
+	struct reactor_test_state *rstate = *rstate_ptr;
+
+	/* run test */
+	int ret = reactor_add_ep(rstate->reactor);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	ret = rpma_reactor_add_ep(rstate->reactor, MOCK_EP, MOCK_CONN_CFG,
+			conn_req_func, MOCK_ARG);
+	assert_int_equal(ret, RPMA_E_INVAL);
+
+	reactor_expect_epoll_ctl(EPOLL_CTL_DEL, MOCK_EP_FD, MOCK_OK);
+	ret = rpma_reactor_remove_ep(rstate->reactor, MOCK_EP);
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * remove_ep__invalid_args -- invalid combinations of the arguments
+ */
+static void
+remove_ep__invalid_args(void **rstate_ptr)
+{
+	struct reactor_test_state *rstate = *rstate_ptr;
+
+	/* run test */
+	int ret1 = rpma_reactor_remove_ep(NULL, MOCK_EP);
+	int ret2 = rpma_reactor_remove_ep(rstate->reactor, NULL);
+	/* the endpoint is not registered */
+	int ret3 = rpma_reactor_remove_ep(rstate->reactor, MOCK_EP);
+
+	/* verify the results */
+	assert_int_equal(ret1, RPMA_E_INVAL);
+	assert_int_equal(ret2, RPMA_E_INVAL);
+	assert_int_equal(ret3, RPMA_E_INVAL);
+}
+
+static const struct CMUnitTest tests_add_remove[] = {
+	/* rpma_reactor_add_conn() unit tests */
+	cmocka_unit_test_setup_teardown(add_conn__invalid_args,
+		setup__reactor_new, teardown__reactor_delete),
+	cmocka_unit_test_setup_teardown(add_conn__already_registered,
+		setup__reactor_new, teardown__reactor_delete),
+	cmocka_unit_test_setup_teardown(add_conn__malloc_ERRNO,
+		setup__reactor_new, teardown__reactor_delete),
+	cmocka_unit_test_setup_teardown(add_conn__epoll_ctl_ERRNO,
+		setup__reactor_new, teardown__reactor_delete),
+	cmocka_unit_test_setup_teardown(add_conn__completions_only,
+		setup__reactor_new, teardown__reactor_delete),
+
+	/* rpma_reactor_remove_conn() unit tests */
+	cmocka_unit_test_setup_teardown(remove_conn__invalid_args,
+		setup__reactor_new, teardown__reactor_delete),
+	cmocka_unit_test_setup_teardown(remove_conn__success,
+		setup__reactor_new, teardown__reactor_delete),
+
+	/* rpma_reactor_add_ep() unit tests */
+	cmocka_unit_test_setup_teardown(add_ep__invalid_args,
+		setup__reactor_new, teardown__reactor_delete),
+	cmocka_unit_test_setup_teardown(add_ep__malloc_ERRNO,
+		setup__reactor_new, teardown__reactor_delete),
+	cmocka_unit_test_setup_teardown(add_ep__success,
+		setup__reactor_new, teardown__reactor_delete),
+
+	/* rpma_reactor_remove_ep() unit tests */
+	cmocka_unit_test_setup_teardown(remove_ep__invalid_args,
+		setup__reactor_new, teardown__reactor_delete),
+
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_add_remove, NULL, NULL);
+}
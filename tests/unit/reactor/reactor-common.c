@@ -0,0 +1,353 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * reactor-common.c -- the rpma_reactor unit tests common functions
+ */
+
+#include <errno.h>
+#include <sys/epoll.h>
+
+#include "reactor-common.h"
+
+/* the data of the registered file descriptors */
+#define MOCK_FDS_MAX	4
+static struct {
+	int fd;
+	void *ptr;
+} Registered[MOCK_FDS_MAX];
+
+/*
+ * registered_find -- find the slot of the file descriptor
+ */
+static int
+registered_find(int fd)
+{
+	for (int i = 0; i < MOCK_FDS_MAX; ++i) {
+		if (Registered[i].ptr && Registered[i].fd == fd)
+			return i;
+	}
+
+	return -1;
+}
+
+/*
+ * __wrap_epoll_create1 -- epoll_create1() mock
+ */
+int
+__wrap_epoll_create1(int flags)
+{
+	assert_int_equal(flags, EPOLL_CLOEXEC);
+
+	errno = mock_type(int);
+	if (errno)
+		return -1;
+
+	return MOCK_EPFD;
+}
+
+/*
+ * __wrap_epoll_ctl -- epoll_ctl() mock
+ */
+int
+__wrap_epoll_ctl(int epfd, int op, int fd, struct epoll_event *event)
+{
+	assert_int_equal(epfd, MOCK_EPFD);
+	check_expected(op);
+	check_expected(fd);
+
+	errno = mock_type(int);
+	if (errno)
+		return -1;
+
+	int i = registered_find(fd);
+	if (op == EPOLL_CTL_ADD) {
+		assert_int_equal(i, -1);
+		assert_int_equal(event->events, EPOLLIN);
+		for (i = 0; Registered[i].ptr; ++i)
+			assert_true(i + 1 < MOCK_FDS_MAX);
+		Registered[i].fd = fd;
+		Registered[i].ptr = event->data.ptr;
+	} else {
+		assert_int_equal(op, EPOLL_CTL_DEL);
+		assert_int_not_equal(i, -1);
+		Registered[i].ptr = NULL;
+	}
+
+	return 0;
+}
+
+/*
+ * __wrap_epoll_wait -- epoll_wait() mock; the file descriptors reported
+ * ready are taken from the mock values
+ */
+int
+__wrap_epoll_wait(int epfd, struct epoll_event *events, int maxevents,
+		int timeout)
+{
+	assert_int_equal(epfd, MOCK_EPFD);
+	assert_true(maxevents > 0);
+	check_expected(timeout);
+
+	int n = mock_type(int);
+	if (n < 0) {
+		errno = mock_type(int);
+		return -1;
+	}
+
+	assert_true(n <= maxevents);
+	for (int i = 0; i < n; ++i) {
+		int slot = registered_find(mock_type(int));
+		assert_int_not_equal(slot, -1);
+		events[i].events = EPOLLIN;
+		events[i].data.ptr = Registered[slot].ptr;
+	}
+
+	return n;
+}
+
+int __real_close(int fd);
+
+/*
+ * __wrap_close -- close() mock
+ */
+int
+__wrap_close(int fd)
+{
+	if (fd != MOCK_EPFD)
+		return __real_close(fd);
+
+	/* closing the epoll(7) instance unregisters all the fds */
+	for (int i = 0; i < MOCK_FDS_MAX; ++i)
+		Registered[i].ptr = NULL;
+
+	errno = mock_type(int);
+	if (errno)
+		return -1;
+
+	return 0;
+}
+
+/*
+ * rpma_conn_get_event_fd -- rpma_conn_get_event_fd() mock
+ */
+int
+rpma_conn_get_event_fd(const struct rpma_conn *conn, int *fd)
+{
+	assert_ptr_equal(conn, MOCK_CONN);
+	assert_non_null(fd);
+
+	*fd = MOCK_EVENT_FD;
+
+	return 0;
+}
+
+/*
+ * rpma_conn_get_completion_fd -- rpma_conn_get_completion_fd() mock
+ */
+int
+rpma_conn_get_completion_fd(const struct rpma_conn *conn, int *fd)
+{
+	assert_ptr_equal(conn, MOCK_CONN);
+	assert_non_null(fd);
+
+	*fd = MOCK_COMPLETION_FD;
+
+	return 0;
+}
+
+/*
+ * rpma_ep_get_fd -- rpma_ep_get_fd() mock
+ */
+int
+rpma_ep_get_fd(const struct rpma_ep *ep, int *fd)
+{
+	assert_ptr_equal(ep, MOCK_EP);
+	assert_non_null(fd);
+
+	*fd = MOCK_EP_FD;
+
+	return 0;
+}
+
+/*
+ * rpma_conn_next_event -- rpma_conn_next_event() mock
+ */
+int
+rpma_conn_next_event(struct rpma_conn *conn, enum rpma_conn_event *event)
+{
+	assert_ptr_equal(conn, MOCK_CONN);
+	assert_non_null(event);
+
+	int ret = mock_type(int);
+	if (ret == MOCK_OK)
+		*event = mock_type(enum rpma_conn_event);
+
+	return ret;
+}
+
+/*
+ * rpma_ep_next_conn_req -- rpma_ep_next_conn_req() mock
+ */
+int
+rpma_ep_next_conn_req(struct rpma_ep *ep, const struct rpma_conn_cfg *cfg,
+		struct rpma_conn_req **req_ptr)
+{
+	assert_ptr_equal(ep, MOCK_EP);
+	assert_ptr_equal(cfg, MOCK_CONN_CFG);
+	assert_non_null(req_ptr);
+
+	int ret = mock_type(int);
+	if (ret == MOCK_OK)
+		*req_ptr = MOCK_CONN_REQ;
+
+	return ret;
+}
+
+/*
+ * rpma_conn_completion_wait -- rpma_conn_completion_wait() mock
+ */
+int
+rpma_conn_completion_wait(struct rpma_conn *conn)
+{
+	assert_ptr_equal(conn, MOCK_CONN);
+
+	return mock_type(int);
+}
+
+/*
+ * rpma_conn_completion_get -- rpma_conn_completion_get() mock
+ */
+int
+rpma_conn_completion_get(struct rpma_conn *conn,
+		struct rpma_completion *cmpl)
+{
+	assert_ptr_equal(conn, MOCK_CONN);
+	assert_non_null(cmpl);
+
+	int ret = mock_type(int);
+	if (ret == MOCK_OK)
+		cmpl->op_context = mock_type(void *);
+
+	return ret;
+}
+
+/*
+ * conn_event_func -- the callback of the events of the connection
+ */
+void
+conn_event_func(struct rpma_conn *conn, enum rpma_conn_event event,
+		void *arg)
+{
+	assert_ptr_equal(conn, MOCK_CONN);
+	assert_ptr_equal(arg, MOCK_ARG);
+	check_expected(event);
+}
+
+/*
+ * completion_func -- the callback of the completions of the connection
+ */
+void
+completion_func(struct rpma_conn *conn, const struct rpma_completion *cmpl,
+		void *arg)
+{
+	assert_ptr_equal(conn, MOCK_CONN);
+	assert_ptr_equal(arg, MOCK_ARG);
+	check_expected(cmpl->op_context);
+}
+
+/*
+ * conn_req_func -- the callback of the incoming connection requests
+ */
+void
+conn_req_func(struct rpma_ep *ep, struct rpma_conn_req *req, void *arg)
+{
+	assert_ptr_equal(ep, MOCK_EP);
+	assert_ptr_equal(arg, MOCK_ARG);
+	assert_ptr_equal(req, MOCK_CONN_REQ);
+	function_called();
+}
+
+/*
+ * setup__reactor_new -- prepare a valid reactor
+ */
+int
+setup__reactor_new(void **rstate_ptr)
+{
+	static struct reactor_test_state rstate = {0};
+
+	/* configure mocks */
+	will_return(__wrap_epoll_create1, MOCK_OK);
+	will_return(__wrap__test_malloc, MOCK_OK);
+
+	/* run test */
+	rstate.reactor = NULL;
+	int ret = rpma_reactor_new(MOCK_BATCH, &rstate.reactor);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_non_null(rstate.reactor);
+
+	*rstate_ptr = &rstate;
+
+	return 0;
+}
+
+/*
+ * teardown__reactor_delete -- delete the reactor
+ */
+int
+teardown__reactor_delete(void **rstate_ptr)
+{
+	struct reactor_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	will_return(__wrap_close, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_reactor_delete(&rstate->reactor);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_null(rstate->reactor);
+
+	return 0;
+}
+
+/*
+ * reactor_expect_epoll_ctl -- expect epoll_ctl() of the file descriptor
+ */
+void
+reactor_expect_epoll_ctl(int op, int fd, int err)
+{
+	expect_value(__wrap_epoll_ctl, op, op);
+	expect_value(__wrap_epoll_ctl, fd, fd);
+	will_return(__wrap_epoll_ctl, err);
+}
+
+/*
+ * reactor_add_conn -- register MOCK_CONN with both the callbacks
+ */
+int
+reactor_add_conn(struct rpma_reactor *reactor)
+{
+	will_return_count(__wrap__test_malloc, MOCK_OK, 2);
+	reactor_expect_epoll_ctl(EPOLL_CTL_ADD, MOCK_EVENT_FD, MOCK_OK);
+	reactor_expect_epoll_ctl(EPOLL_CTL_ADD, MOCK_COMPLETION_FD, MOCK_OK);
+
+	return rpma_reactor_add_conn(reactor, MOCK_CONN, conn_event_func,
+			completion_func, MOCK_ARG);
+}
+
+/*
+ * reactor_add_ep -- register MOCK_EP
+ */
+int
+reactor_add_ep(struct rpma_reactor *reactor)
+{
+	will_return(__wrap__test_malloc, MOCK_OK);
+	reactor_expect_epoll_ctl(EPOLL_CTL_ADD, MOCK_EP_FD, MOCK_OK);
+
+	return rpma_reactor_add_ep(reactor, MOCK_EP, MOCK_CONN_CFG,
+			conn_req_func, MOCK_ARG);
+}
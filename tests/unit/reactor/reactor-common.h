@@ -0,0 +1,44 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * reactor-common.h -- the rpma_reactor unit tests common definitions
+ */
+
+#ifndef REACTOR_COMMON_H
+#define REACTOR_COMMON_H
+
+#include "cmocka_headers.h"
+#include "librpma.h"
+#include "test-common.h"
+
+#define MOCK_EPFD		0x00EF
+#define MOCK_EVENT_FD		0x00FD
+#define MOCK_EP_FD		0x00FC
+#define MOCK_EP			(struct rpma_ep *)0xC0E0
+#define MOCK_CONN_CFG		(struct rpma_conn_cfg *)0xC0CF
+#define MOCK_CONN_REQ		(struct rpma_conn_req *)0xC0C0
+#define MOCK_ARG		(void *)0xC0A0
+#define MOCK_BATCH		4
+#define MOCK_OP_CONTEXT_2	(void *)0xC418
+
+struct reactor_test_state {
+	struct rpma_reactor *reactor;
+};
+
+int setup__reactor_new(void **rstate_ptr);
+int teardown__reactor_delete(void **rstate_ptr);
+
+void reactor_expect_epoll_ctl(int op, int fd, int err);
+
+void conn_event_func(struct rpma_conn *conn, enum rpma_conn_event event,
+		void *arg);
+void completion_func(struct rpma_conn *conn,
+		const struct rpma_completion *cmpl, void *arg);
+void conn_req_func(struct rpma_ep *ep, struct rpma_conn_req *req,
+		void *arg);
+
+int reactor_add_conn(struct rpma_reactor *reactor);
+int reactor_add_ep(struct rpma_reactor *reactor);
+
+#endif /* REACTOR_COMMON_H */
@@ -0,0 +1,376 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * reactor-dispatch.c -- the rpma_reactor_dispatch() unit tests
+ *
+ * API covered:
+ * - rpma_reactor_dispatch()
+ */
+
+#include <errno.h>
+#include <sys/epoll.h>
+
+#include "reactor-common.h"
+
+/*
+ * expect_epoll_wait -- expect epoll_wait() reporting the fd ready
+ * (-1 means none)
+ */
+static void
+expect_epoll_wait(int timeout, int fd)
+{
+	expect_value(__wrap_epoll_wait, timeout, timeout);
+	if (fd == -1) {
+		will_return(__wrap_epoll_wait, 0);
+		return;
+	}
+
+	will_return(__wrap_epoll_wait, 1);
+	will_return(__wrap_epoll_wait, fd);
+}
+
+/*
+ * expect_completion -- expect a completion of the op_context
+ */
+static void
+expect_completion(void *op_context)
+{
+	will_return(rpma_conn_completion_get, MOCK_OK);
+	will_return(rpma_conn_completion_get, op_context);
+	expect_value(completion_func, cmpl->op_context, op_context);
+}
+
+/*
+ * setup__conn -- prepare a reactor with MOCK_CONN and MOCK_EP registered
+ */
+static int
+setup__conn(void **rstate_ptr)
+{
+	assert_int_equal(setup__reactor_new(rstate_ptr), 0);
+	struct reactor_test_state *rstate = *rstate_ptr;
+
+	assert_int_equal(reactor_add_conn(rstate->reactor), MOCK_OK);
+	assert_int_equal(reactor_add_ep(rstate->reactor), MOCK_OK);
+
+	return 0;
+}
+
+/*
+ * dispatch__invalid_args -- NULL reactor is invalid
+ */
+static void
+dispatch__invalid_args(void **unused)
+{
+	/* run test */
+	int ret = rpma_reactor_dispatch(NULL, MOCK_TIMEOUT_MS, NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * dispatch__timeout -- nothing is ready
+ */
+static void
+dispatch__timeout(void **rstate_ptr)
+{
+	struct reactor_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	expect_epoll_wait(MOCK_TIMEOUT_MS, -1);
+
+	/* run test */
+	uint32_t dispatched = 1;
+	int ret = rpma_reactor_dispatch(rstate->reactor, MOCK_TIMEOUT_MS,
+			&dispatched);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(dispatched, 0);
+}
+
+/*
+ * dispatch__epoll_wait_ERRNO -- epoll_wait() fails with MOCK_ERRNO
+ * or it is interrupted
+ */
+static void
+dispatch__epoll_wait_ERRNO(void **rstate_ptr)
+{
+	struct reactor_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	expect_value(__wrap_epoll_wait, timeout, MOCK_TIMEOUT_MS);
+	will_return(__wrap_epoll_wait, -1);
+	will_return(__wrap_epoll_wait, MOCK_ERRNO);
+	expect_value(__wrap_epoll_wait, timeout, MOCK_TIMEOUT_MS);
+	will_return(__wrap_epoll_wait, -1);
+	will_return(__wrap_epoll_wait, EINTR);
+
+	/* run test */
+	int ret1 = rpma_reactor_dispatch(rstate->reactor, MOCK_TIMEOUT_MS,
+			NULL);
+	uint32_t dispatched = 1;
+	int ret2 = rpma_reactor_dispatch(rstate->reactor, MOCK_TIMEOUT_MS,
+			&dispatched);
+
+	/* verify the results */
+	assert_int_equal(ret1, RPMA_E_PROVIDER);
+	assert_int_equal(ret2, MOCK_OK);
+	assert_int_equal(dispatched, 0);
+}
+
+/*
+ * dispatch__conn_event -- the event of the connection is passed
+ * to the callback
+ */
+static void
+dispatch__conn_event(void **rstate_ptr)
+{
+	struct reactor_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	expect_epoll_wait(MOCK_TIMEOUT_MS, MOCK_EVENT_FD);
+	will_return(rpma_conn_next_event, MOCK_OK);
+	will_return(rpma_conn_next_event, RPMA_CONN_ESTABLISHED);
+	expect_value(conn_event_func, event, RPMA_CONN_ESTABLISHED);
+
+	/* run test */
+	uint32_t dispatched = 0;
+	int ret = rpma_reactor_dispatch(rstate->reactor, MOCK_TIMEOUT_MS,
+			&dispatched);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(dispatched, 1);
+}
+
+/*
+ * dispatch__conn_event_E_NO_EVENT -- a spurious wakeup is not an error
+ */
+static void
+dispatch__conn_event_E_NO_EVENT(void **rstate_ptr)
+{
+	struct reactor_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	expect_epoll_wait(MOCK_TIMEOUT_MS, MOCK_EVENT_FD);
+	will_return(rpma_conn_next_event, RPMA_E_NO_EVENT);
+
+	/* run test */
+	uint32_t dispatched = 1;
+	int ret = rpma_reactor_dispatch(rstate->reactor, MOCK_TIMEOUT_MS,
+			&dispatched);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(dispatched, 0);
+}
+
+/*
+ * dispatch__conn_req -- the incoming connection request is passed
+ * to the callback
+ */
+static void
+dispatch__conn_req(void **rstate_ptr)
+{
+	struct reactor_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	expect_epoll_wait(MOCK_TIMEOUT_MS, MOCK_EP_FD);
+	will_return(rpma_ep_next_conn_req, MOCK_OK);
+	expect_function_call(conn_req_func);
+
+	/* run test */
+	uint32_t dispatched = 0;
+	int ret = rpma_reactor_dispatch(rstate->reactor, MOCK_TIMEOUT_MS,
+			&dispatched);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(dispatched, 1);
+}
+
+/*
+ * dispatch__completions -- the CQ is drained
+ */
+static void
+dispatch__completions(void **rstate_ptr)
+{
+	struct reactor_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	expect_epoll_wait(MOCK_TIMEOUT_MS, MOCK_COMPLETION_FD);
+	will_return(rpma_conn_completion_wait, MOCK_OK);
+	expect_completion(MOCK_OP_CONTEXT);
+	expect_completion(MOCK_OP_CONTEXT_2);
+	will_return(rpma_conn_completion_get, RPMA_E_NO_COMPLETION);
+
+	/* run test */
+	uint32_t dispatched = 0;
+	int ret = rpma_reactor_dispatch(rstate->reactor, MOCK_TIMEOUT_MS,
+			&dispatched);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(dispatched, 2);
+
+	/* the CQ is empty so the next dispatch waits */
+	expect_epoll_wait(MOCK_TIMEOUT_MS, -1);
+	ret = rpma_reactor_dispatch(rstate->reactor, MOCK_TIMEOUT_MS, NULL);
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * dispatch__batch_exhausted -- the CQ which may hold more completions
+ * is drained by the next dispatch without waiting
+ */
+static void
+dispatch__batch_exhausted(void **rstate_ptr)
+{
+	struct reactor_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	expect_epoll_wait(MOCK_TIMEOUT_MS, MOCK_COMPLETION_FD);
+	will_return(rpma_conn_completion_wait, MOCK_OK);
+	for (int i = 0; i < MOCK_BATCH; ++i)
+		expect_completion(MOCK_OP_CONTEXT);
+
+	/* run test */
+	uint32_t dispatched = 0;
+	int ret = rpma_reactor_dispatch(rstate->reactor, MOCK_TIMEOUT_MS,
+			&dispatched);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(dispatched, MOCK_BATCH);
+
+	expect_epoll_wait(0, -1);
+	expect_completion(MOCK_OP_CONTEXT_2);
+	will_return(rpma_conn_completion_get, RPMA_E_NO_COMPLETION);
+	ret = rpma_reactor_dispatch(rstate->reactor, MOCK_TIMEOUT_MS,
+			&dispatched);
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(dispatched, 1);
+
+	expect_epoll_wait(MOCK_TIMEOUT_MS, -1);
+	ret = rpma_reactor_dispatch(rstate->reactor, MOCK_TIMEOUT_MS, NULL);
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * dispatch__completion_wait_E_PROVIDER -- the failure of a source does not
+ * stop handling the other ones
+ */
+static void
+dispatch__completion_wait_E_PROVIDER(void **rstate_ptr)
+{
+	struct reactor_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	expect_value(__wrap_epoll_wait, timeout, MOCK_TIMEOUT_MS);
+	will_return(__wrap_epoll_wait, 2);
+	will_return(__wrap_epoll_wait, MOCK_COMPLETION_FD);
+	will_return(__wrap_epoll_wait, MOCK_EVENT_FD);
+	will_return(rpma_conn_completion_wait, RPMA_E_PROVIDER);
+	will_return(rpma_conn_next_event, MOCK_OK);
+	will_return(rpma_conn_next_event, RPMA_CONN_CLOSED);
+	expect_value(conn_event_func, event, RPMA_CONN_CLOSED);
+
+	/* run test */
+	uint32_t dispatched = 0;
+	int ret = rpma_reactor_dispatch(rstate->reactor, MOCK_TIMEOUT_MS,
+			&dispatched);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_int_equal(dispatched, 1);
+}
+
+/*
+ * completion_func_remove -- the callback which unregisters its own
+ * connection
+ */
+static void
+completion_func_remove(struct rpma_conn *conn,
+		const struct rpma_completion *cmpl, void *arg)
+{
+	struct rpma_reactor *reactor = arg;
+	assert_ptr_equal(cmpl->op_context, MOCK_OP_CONTEXT);
+
+	/* the reactor cannot be dispatched nor deleted from a callback */
+	assert_int_equal(rpma_reactor_dispatch(reactor, 0, NULL),
+			RPMA_E_INVAL);
+	assert_int_equal(rpma_reactor_delete(&reactor), RPMA_E_INVAL);
+
+	reactor_expect_epoll_ctl(EPOLL_CTL_DEL, MOCK_COMPLETION_FD, MOCK_OK);
+	assert_int_equal(rpma_reactor_remove_conn(reactor, conn), MOCK_OK);
+}
+
+/*
+ * dispatch__remove_in_callback -- the connection unregistered by its own
+ * callback is not drained any further
+ */
+static void
+dispatch__remove_in_callback(void **rstate_ptr)
+{
+	struct reactor_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	will_return(__wrap__test_malloc, MOCK_OK);
+	reactor_expect_epoll_ctl(EPOLL_CTL_ADD, MOCK_COMPLETION_FD, MOCK_OK);
+	assert_int_equal(rpma_reactor_add_conn(rstate->reactor, MOCK_CONN,
+			NULL, completion_func_remove, rstate->reactor),
+			MOCK_OK);
+	expect_epoll_wait(MOCK_TIMEOUT_MS, MOCK_COMPLETION_FD);
+	will_return(rpma_conn_completion_wait, MOCK_OK);
+	will_return(rpma_conn_completion_get, MOCK_OK);
+	will_return(rpma_conn_completion_get, MOCK_OP_CONTEXT);
+
+	/* run test */
+	uint32_t dispatched = 0;
+	int ret = rpma_reactor_dispatch(rstate->reactor, MOCK_TIMEOUT_MS,
+			&dispatched);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(dispatched, 1);
+	ret = rpma_reactor_remove_conn(rstate->reactor, MOCK_CONN);
+	assert_int_equal(ret, RPMA_E_INVAL);
+
+	/* nothing is hot anymore */
+	expect_epoll_wait(MOCK_TIMEOUT_MS, -1);
+	ret = rpma_reactor_dispatch(rstate->reactor, MOCK_TIMEOUT_MS, NULL);
+	assert_int_equal(ret, MOCK_OK);
+}
+
+static const struct CMUnitTest tests_dispatch[] = {
+	/* rpma_reactor_dispatch() unit tests */
+	cmocka_unit_test(dispatch__invalid_args),
+	cmocka_unit_test_setup_teardown(dispatch__timeout,
+		setup__conn, teardown__reactor_delete),
+	cmocka_unit_test_setup_teardown(dispatch__epoll_wait_ERRNO,
+		setup__conn, teardown__reactor_delete),
+	cmocka_unit_test_setup_teardown(dispatch__conn_event,
+		setup__conn, teardown__reactor_delete),
+	cmocka_unit_test_setup_teardown(dispatch__conn_event_E_NO_EVENT,
+		setup__conn, teardown__reactor_delete),
+	cmocka_unit_test_setup_teardown(dispatch__conn_req,
+		setup__conn, teardown__reactor_delete),
+	cmocka_unit_test_setup_teardown(dispatch__completions,
+		setup__conn, teardown__reactor_delete),
+	cmocka_unit_test_setup_teardown(dispatch__batch_exhausted,
+		setup__conn, teardown__reactor_delete),
+	cmocka_unit_test_setup_teardown(dispatch__completion_wait_E_PROVIDER,
+		setup__conn, teardown__reactor_delete),
+	cmocka_unit_test_setup_teardown(dispatch__remove_in_callback,
+		setup__reactor_new, teardown__reactor_delete),
+
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_dispatch, NULL, NULL);
+}
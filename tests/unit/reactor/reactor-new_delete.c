@@ -0,0 +1,201 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * reactor-new_delete.c -- the rpma_reactor_new/delete() unit tests
+ *
+ * APIs covered:
+ * - rpma_reactor_new()
+ * - rpma_reactor_delete()
+ * - rpma_reactor_get_fd()
+ */
+
+#include "reactor-common.h"
+
+/*
+ * new__invalid_args -- invalid combinations of the arguments
+ */
+static void
+new__invalid_args(void **unused)
+{
+	/* run test */
+	struct rpma_reactor *reactor = NULL;
+	int ret1 = rpma_reactor_new(0, &reactor);
+	int ret2 = rpma_reactor_new(MOCK_BATCH, NULL);
+
+	/* verify the results */
+	assert_int_equal(ret1, RPMA_E_INVAL);
+	assert_int_equal(ret2, RPMA_E_INVAL);
+	assert_null(reactor);
+}
+
+/*
+ * new__epoll_create1_ERRNO -- epoll_create1() fails with MOCK_ERRNO
+ */
+static void
+new__epoll_create1_ERRNO(void **unused)
+{
+	/* configure mocks */
+	will_return(__wrap_epoll_create1, MOCK_ERRNO);
+
+	/* run test */
+	struct rpma_reactor *reactor = NULL;
+	int ret = rpma_reactor_new(MOCK_BATCH, &reactor);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(reactor);
+}
+
+/*
+ * new__malloc_ERRNO -- malloc() fails with MOCK_ERRNO
+ */
+static void
+new__malloc_ERRNO(void **unused)
+{
+	/* configure mocks */
+	will_return(__wrap_epoll_create1, MOCK_OK);
+	will_return(__wrap__test_malloc, MOCK_ERRNO);
+	will_return(__wrap_close, MOCK_OK);
+
+	/* run test */
+	struct rpma_reactor *reactor = NULL;
+	int ret = rpma_reactor_new(MOCK_BATCH, &reactor);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NOMEM);
+	assert_null(reactor);
+}
+
+/*
+ * test_lifecycle -- happy day scenario
+ */
+static void
+test_lifecycle(void **rstate_ptr)
+{
+	struct reactor_test_state *rstate = *rstate_ptr;
+
+	/* run test */
+	int fd = -1;
+	int ret = rpma_reactor_get_fd(rstate->reactor, &fd);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(fd, MOCK_EPFD);
+}
+
+/*
+ * get_fd__invalid_args -- invalid combinations of the arguments
+ */
+static void
+get_fd__invalid_args(void **rstate_ptr)
+{
+	struct reactor_test_state *rstate = *rstate_ptr;
+
+	/* run test */
+	int fd = -1;
+	int ret1 = rpma_reactor_get_fd(NULL, &fd);
+	int ret2 = rpma_reactor_get_fd(rstate->reactor, NULL);
+
+	/* verify the results */
+	assert_int_equal(ret1, RPMA_E_INVAL);
+	assert_int_equal(ret2, RPMA_E_INVAL);
+	assert_int_equal(fd, -1);
+}
+
+/*
+ * delete__reactor_ptr_NULL -- NULL reactor_ptr is invalid
+ */
+static void
+delete__reactor_ptr_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_reactor_delete(NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * delete__reactor_NULL -- NULL reactor is valid - quick exit
+ */
+static void
+delete__reactor_NULL(void **unused)
+{
+	/* run test */
+	struct rpma_reactor *reactor = NULL;
+	int ret = rpma_reactor_delete(&reactor);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * delete__close_ERRNO -- close() fails with MOCK_ERRNO
+ */
+static void
+delete__close_ERRNO(void **unused)
+{
+	struct reactor_test_state *rstate;
+
+	/* WA for cmocka/issues#47 */
+	assert_int_equal(setup__reactor_new((void **)&rstate), 0);
+
+	/* configure mocks */
+	will_return(__wrap_close, MOCK_ERRNO);
+
+	/* run test */
+	int ret = rpma_reactor_delete(&rstate->reactor);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(rstate->reactor);
+}
+
+/*
+ * delete__registered -- the registered sources are released
+ */
+static void
+delete__registered(void **unused)
+{
+	struct reactor_test_state *rstate;
+
+	/* WA for cmocka/issues#47 */
+	assert_int_equal(setup__reactor_new((void **)&rstate), 0);
+
+	/* configure mocks */
+	assert_int_equal(reactor_add_conn(rstate->reactor), MOCK_OK);
+	assert_int_equal(reactor_add_ep(rstate->reactor), MOCK_OK);
+
+	/* run test */
+	assert_int_equal(teardown__reactor_delete((void **)&rstate), 0);
+}
+
+static const struct CMUnitTest tests_new_delete[] = {
+	/* rpma_reactor_new() unit tests */
+	cmocka_unit_test(new__invalid_args),
+	cmocka_unit_test(new__epoll_create1_ERRNO),
+	cmocka_unit_test(new__malloc_ERRNO),
+
+	/* rpma_reactor_new()/delete() lifecycle */
+	cmocka_unit_test_setup_teardown(test_lifecycle,
+		setup__reactor_new, teardown__reactor_delete),
+
+	/* rpma_reactor_get_fd() unit tests */
+	cmocka_unit_test_setup_teardown(get_fd__invalid_args,
+		setup__reactor_new, teardown__reactor_delete),
+
+	/* rpma_reactor_delete() unit tests */
+	cmocka_unit_test(delete__reactor_ptr_NULL),
+	cmocka_unit_test(delete__reactor_NULL),
+	cmocka_unit_test(delete__close_ERRNO),
+	cmocka_unit_test(delete__registered),
+
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_new_delete, NULL, NULL);
+}
@@ -0,0 +1,194 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * recv_ring-common.c -- the rpma_recv_ring unit tests common functions
+ */
+
+#include "mocks-ibverbs.h"
+#include "mocks-rpma-srq.h"
+#include "mocks-unistd.h"
+#include "recv_ring-common.h"
+
+uint64_t Posted_wr_ids[MOCK_SLOTS];
+
+/*
+ * chain_verify -- verify the chain of the posted work requests,
+ * remember their wr_ids and return the length of the chain
+ */
+static int
+chain_verify(struct ibv_recv_wr *wr, struct ibv_recv_wr **bad_wr)
+{
+	assert_non_null(wr);
+	assert_non_null(bad_wr);
+
+	int n = 0;
+	for (struct ibv_recv_wr *w = wr; w != NULL; w = w->next) {
+		assert_true(n < MOCK_SLOTS);
+		assert_int_equal(w->num_sge, 1);
+		assert_int_equal(w->sg_list->length, MOCK_SLOT_SIZE);
+		/* the mock of rpma_mr_recv_wr() stores the offset as addr */
+		assert_int_equal(w->sg_list->addr % MOCK_SLOT_SIZE, 0);
+		Posted_wr_ids[n++] = w->wr_id;
+	}
+
+	return n;
+}
+
+/*
+ * chain_bad_wr -- set bad_wr to the first work request which has not been
+ * posted
+ */
+static void
+chain_bad_wr(struct ibv_recv_wr *wr, struct ibv_recv_wr **bad_wr,
+		int posted)
+{
+	while (posted--)
+		wr = wr->next;
+	*bad_wr = wr;
+}
+
+/*
+ * post_recv_chain_mock -- ibv_post_recv() mock accepting a chain
+ */
+int
+post_recv_chain_mock(struct ibv_qp *qp, struct ibv_recv_wr *wr,
+		struct ibv_recv_wr **bad_wr)
+{
+	assert_ptr_equal(qp, MOCK_QP);
+
+	int n = chain_verify(wr, bad_wr);
+	check_expected(n);
+
+	int ret = mock_type(int);
+	if (ret) /* the number of work requests posted before the failure */
+		chain_bad_wr(wr, bad_wr, mock_type(int));
+
+	return ret;
+}
+
+/*
+ * post_srq_recv_chain_mock -- ibv_post_srq_recv() mock accepting a chain
+ */
+int
+post_srq_recv_chain_mock(struct ibv_srq *srq, struct ibv_recv_wr *wr,
+		struct ibv_recv_wr **bad_wr)
+{
+	assert_ptr_equal(srq, MOCK_IBV_SRQ);
+
+	int n = chain_verify(wr, bad_wr);
+	check_expected(n);
+
+	int ret = mock_type(int);
+	if (ret) /* the number of work requests posted before the failure */
+		chain_bad_wr(wr, bad_wr, mock_type(int));
+
+	return ret;
+}
+
+/*
+ * recv_ring_new -- create the ring posting either to the connection or
+ * to the shared receive queue
+ */
+static int
+recv_ring_new(void **rstate_ptr, struct rpma_conn *conn,
+		struct rpma_srq *srq)
+{
+	static struct recv_ring_test_state rstate = {0};
+
+	/* configure mocks */
+	if (conn)
+		will_return(rpma_conn_get_ibv_qp, MOCK_OK);
+	will_return(__wrap_sysconf, MOCK_OK);
+	will_return(__wrap_mmap, MOCK_OK);
+	will_return(__wrap_mmap, &rstate.allocated_slab);
+	expect_value(rpma_mr_reg, peer, MOCK_PEER);
+	expect_value(rpma_mr_reg, size, MOCK_SLAB_SIZE);
+	expect_value(rpma_mr_reg, usage, RPMA_MR_USAGE_RECV);
+	will_return(rpma_mr_reg, &rstate.allocated_slab.addr);
+	will_return(rpma_mr_reg, MOCK_RPMA_MR_LOCAL);
+	will_return_count(__wrap__test_malloc, MOCK_OK, 2);
+	if (conn) {
+		expect_value(post_recv_chain_mock, n, MOCK_SLOTS);
+		will_return(post_recv_chain_mock, MOCK_OK);
+	} else {
+		expect_value(post_srq_recv_chain_mock, n, MOCK_SLOTS);
+		will_return(post_srq_recv_chain_mock, MOCK_OK);
+	}
+
+	/* run test */
+	rstate.ring = NULL;
+	int ret = rpma_recv_ring_new(MOCK_PEER, conn, srq, MOCK_SLOTS,
+			MOCK_SLOT_SIZE, MOCK_BATCH, &rstate.ring);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_non_null(rstate.ring);
+	assert_int_equal(rstate.allocated_slab.len, PAGESIZE);
+
+	*rstate_ptr = &rstate;
+
+	return 0;
+}
+
+/*
+ * setup__recv_ring_new -- prepare a valid ring posting to a connection
+ */
+int
+setup__recv_ring_new(void **rstate_ptr)
+{
+	return recv_ring_new(rstate_ptr, MOCK_CONN, NULL);
+}
+
+/*
+ * setup__recv_ring_new_srq -- prepare a valid ring posting to a shared
+ * receive queue
+ */
+int
+setup__recv_ring_new_srq(void **rstate_ptr)
+{
+	return recv_ring_new(rstate_ptr, NULL, MOCK_RPMA_SRQ);
+}
+
+/*
+ * teardown__recv_ring_delete -- delete the ring
+ */
+int
+teardown__recv_ring_delete(void **rstate_ptr)
+{
+	struct recv_ring_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	expect_value(rpma_mr_dereg, *mr_ptr, MOCK_RPMA_MR_LOCAL);
+	will_return(rpma_mr_dereg, MOCK_OK);
+	will_return(__wrap_munmap, &rstate->allocated_slab);
+	will_return(__wrap_munmap, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_recv_ring_delete(&rstate->ring);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_null(rstate->ring);
+
+	return 0;
+}
+
+/*
+ * group_setup_recv_ring -- prepare resources for all tests in the group
+ */
+int
+group_setup_recv_ring(void **unused)
+{
+	/*
+	 * ibv_post_recv() and ibv_post_srq_recv() are static inline functions
+	 * calling the provider's callbacks so the callbacks are replaced
+	 * with the mocks.
+	 */
+	MOCK_VERBS->ops.post_recv = post_recv_chain_mock;
+	MOCK_VERBS->ops.post_srq_recv = post_srq_recv_chain_mock;
+	Ibv_qp.context = MOCK_VERBS;
+	Ibv_srq.context = MOCK_VERBS;
+
+	return 0;
+}
@@ -0,0 +1,42 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * recv_ring-common.h -- the rpma_recv_ring unit tests common definitions
+ */
+
+#ifndef RECV_RING_COMMON_H
+#define RECV_RING_COMMON_H
+
+#include <infiniband/verbs.h>
+
+#include "cmocka_headers.h"
+#include "librpma.h"
+#include "mocks-stdlib.h"
+#include "test-common.h"
+
+#define MOCK_SLOTS		8
+#define MOCK_SLOT_SIZE		64
+#define MOCK_BATCH		4
+#define MOCK_SLAB_SIZE		(MOCK_SLOTS * MOCK_SLOT_SIZE)
+#define MOCK_QP_NUM		(uint32_t)0x0D1C
+
+struct recv_ring_test_state {
+	struct rpma_recv_ring *ring;
+	struct mmap_args allocated_slab;
+};
+
+/* wr_ids (op_contexts) of the work requests posted most recently */
+extern uint64_t Posted_wr_ids[MOCK_SLOTS];
+
+int post_recv_chain_mock(struct ibv_qp *qp, struct ibv_recv_wr *wr,
+		struct ibv_recv_wr **bad_wr);
+int post_srq_recv_chain_mock(struct ibv_srq *srq, struct ibv_recv_wr *wr,
+		struct ibv_recv_wr **bad_wr);
+
+int setup__recv_ring_new(void **rstate_ptr);
+int setup__recv_ring_new_srq(void **rstate_ptr);
+int teardown__recv_ring_delete(void **rstate_ptr);
+int group_setup_recv_ring(void **unused);
+
+#endif /* RECV_RING_COMMON_H */
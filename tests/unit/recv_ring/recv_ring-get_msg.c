@@ -0,0 +1,144 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * recv_ring-get_msg.c -- the rpma_recv_ring_get_msg() unit tests
+ *
+ * API covered:
+ * - rpma_recv_ring_get_msg()
+ */
+
+#include "mocks-ibverbs.h"
+#include "recv_ring-common.h"
+
+#define MOCK_BYTE_LEN	(uint32_t)0x2A
+#define MOCK_IMM	(uint32_t)0x0BAD
+#define MOCK_WC_FLAGS	IBV_WC_WITH_IMM
+
+/*
+ * get_msg__ring_NULL -- NULL ring is invalid
+ */
+static void
+get_msg__ring_NULL(void **unused)
+{
+	/* run test */
+	struct rpma_completion cmpl = {0};
+	struct rpma_recv_msg msg = {0};
+	int ret = rpma_recv_ring_get_msg(NULL, &cmpl, &msg);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * get_msg__cmpl_NULL -- NULL cmpl is invalid
+ */
+static void
+get_msg__cmpl_NULL(void **rstate_ptr)
+{
+	struct recv_ring_test_state *rstate = *rstate_ptr;
+
+	/* run test */
+	struct rpma_recv_msg msg = {0};
+	int ret = rpma_recv_ring_get_msg(rstate->ring, NULL, &msg);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * get_msg__msg_NULL -- NULL msg is invalid
+ */
+static void
+get_msg__msg_NULL(void **rstate_ptr)
+{
+	struct recv_ring_test_state *rstate = *rstate_ptr;
+
+	/* run test */
+	struct rpma_completion cmpl = {0};
+	int ret = rpma_recv_ring_get_msg(rstate->ring, &cmpl, NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * get_msg__foreign_op_context -- the completion does not come from
+ * the ring
+ */
+static void
+get_msg__foreign_op_context(void **rstate_ptr)
+{
+	struct recv_ring_test_state *rstate = *rstate_ptr;
+	void *op_contexts[] = {
+		NULL,
+		MOCK_OP_CONTEXT,
+		/* a misaligned pointer to the first work request */
+		(void *)(uintptr_t)(Posted_wr_ids[0] + 1),
+	};
+
+	for (size_t i = 0; i < sizeof(op_contexts) / sizeof(op_contexts[0]);
+			++i) {
+		/* run test */
+		struct rpma_completion cmpl = {0};
+		cmpl.op_context = op_contexts[i];
+		struct rpma_recv_msg msg = {0};
+		int ret = rpma_recv_ring_get_msg(rstate->ring, &cmpl, &msg);
+
+		/* verify the results */
+		assert_int_equal(ret, RPMA_E_INVAL);
+	}
+}
+
+/*
+ * get_msg__success -- translate completions of all the slots
+ */
+static void
+get_msg__success(void **rstate_ptr)
+{
+	struct recv_ring_test_state *rstate = *rstate_ptr;
+
+	for (uint32_t i = 0; i < MOCK_SLOTS; ++i) {
+		/* run test */
+		struct rpma_completion cmpl = {0};
+		cmpl.op = RPMA_OP_RECV;
+		cmpl.op_context = (void *)(uintptr_t)Posted_wr_ids[i];
+		cmpl.byte_len = MOCK_BYTE_LEN;
+		cmpl.imm = MOCK_IMM;
+		cmpl.flags = MOCK_WC_FLAGS;
+		cmpl.qp_num = MOCK_QP_NUM;
+		struct rpma_recv_msg msg = {0};
+		int ret = rpma_recv_ring_get_msg(rstate->ring, &cmpl, &msg);
+
+		/* verify the results */
+		assert_int_equal(ret, MOCK_OK);
+		assert_int_equal(msg.slot, i);
+		assert_ptr_equal(msg.ptr, (char *)rstate->allocated_slab.addr +
+				i * MOCK_SLOT_SIZE);
+		assert_int_equal(msg.len, MOCK_BYTE_LEN);
+		assert_int_equal(msg.imm, MOCK_IMM);
+		assert_int_equal(msg.flags, MOCK_WC_FLAGS);
+		assert_int_equal(msg.qp_num, MOCK_QP_NUM);
+	}
+}
+
+static const struct CMUnitTest tests_get_msg[] = {
+	/* rpma_recv_ring_get_msg() unit tests */
+	cmocka_unit_test(get_msg__ring_NULL),
+	cmocka_unit_test_setup_teardown(get_msg__cmpl_NULL,
+		setup__recv_ring_new, teardown__recv_ring_delete),
+	cmocka_unit_test_setup_teardown(get_msg__msg_NULL,
+		setup__recv_ring_new, teardown__recv_ring_delete),
+	cmocka_unit_test_setup_teardown(get_msg__foreign_op_context,
+		setup__recv_ring_new, teardown__recv_ring_delete),
+	cmocka_unit_test_setup_teardown(get_msg__success,
+		setup__recv_ring_new, teardown__recv_ring_delete),
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_get_msg,
+			group_setup_recv_ring, NULL);
+}
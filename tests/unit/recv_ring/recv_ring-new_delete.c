@@ -0,0 +1,463 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * recv_ring-new_delete.c -- the rpma_recv_ring_new/delete() unit tests
+ *
+ * APIs covered:
+ * - rpma_recv_ring_new()
+ * - rpma_recv_ring_delete()
+ */
+
+#include <string.h>
+
+#include "mocks-ibverbs.h"
+#include "mocks-rpma-srq.h"
+#include "mocks-unistd.h"
+#include "recv_ring-common.h"
+
+/*
+ * new__invalid_args -- invalid combinations of the arguments
+ */
+static void
+new__invalid_args(void **unused)
+{
+	struct rpma_recv_ring *ring = NULL;
+	struct {
+		struct rpma_peer *peer;
+		struct rpma_conn *conn;
+		struct rpma_srq *srq;
+		uint32_t slots;
+		size_t slot_size;
+		uint32_t batch;
+		struct rpma_recv_ring **ring_ptr;
+	} args[] = {
+		/* peer == NULL */
+		{NULL, MOCK_CONN, NULL, MOCK_SLOTS, MOCK_SLOT_SIZE,
+			MOCK_BATCH, &ring},
+		/* conn == NULL && srq == NULL */
+		{MOCK_PEER, NULL, NULL, MOCK_SLOTS, MOCK_SLOT_SIZE,
+			MOCK_BATCH, &ring},
+		/* conn != NULL && srq != NULL */
+		{MOCK_PEER, MOCK_CONN, MOCK_RPMA_SRQ, MOCK_SLOTS,
+			MOCK_SLOT_SIZE, MOCK_BATCH, &ring},
+		/* slots == 0 */
+		{MOCK_PEER, MOCK_CONN, NULL, 0, MOCK_SLOT_SIZE,
+			MOCK_BATCH, &ring},
+		/* slot_size == 0 */
+		{MOCK_PEER, MOCK_CONN, NULL, MOCK_SLOTS, 0,
+			MOCK_BATCH, &ring},
+		/* slot_size > UINT32_MAX */
+		{MOCK_PEER, MOCK_CONN, NULL, MOCK_SLOTS,
+			(size_t)UINT32_MAX + 1, MOCK_BATCH, &ring},
+		/* batch == 0 */
+		{MOCK_PEER, MOCK_CONN, NULL, MOCK_SLOTS, MOCK_SLOT_SIZE,
+			0, &ring},
+		/* batch > slots */
+		{MOCK_PEER, MOCK_CONN, NULL, MOCK_SLOTS, MOCK_SLOT_SIZE,
+			MOCK_SLOTS + 1, &ring},
+		/* ring_ptr == NULL */
+		{MOCK_PEER, MOCK_CONN, NULL, MOCK_SLOTS, MOCK_SLOT_SIZE,
+			MOCK_BATCH, NULL},
+	};
+
+	for (size_t i = 0; i < sizeof(args) / sizeof(args[0]); ++i) {
+		/* run test */
+		int ret = rpma_recv_ring_new(args[i].peer, args[i].conn,
+				args[i].srq, args[i].slots, args[i].slot_size,
+				args[i].batch, args[i].ring_ptr);
+
+		/* verify the results */
+		assert_int_equal(ret, RPMA_E_INVAL);
+		assert_null(ring);
+	}
+}
+
+/*
+ * new__conn_mt_E_NOSUPP -- a connection working in a thread-safe mode
+ * is not supported
+ */
+static void
+new__conn_mt_E_NOSUPP(void **unused)
+{
+	/* configure mocks */
+	will_return(rpma_conn_get_ibv_qp, RPMA_E_NOSUPP);
+
+	/* run test */
+	struct rpma_recv_ring *ring = NULL;
+	int ret = rpma_recv_ring_new(MOCK_PEER, MOCK_CONN, NULL, MOCK_SLOTS,
+			MOCK_SLOT_SIZE, MOCK_BATCH, &ring);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NOSUPP);
+	assert_null(ring);
+}
+
+/*
+ * new__sysconf_ERRNO -- sysconf() fails with MOCK_ERRNO
+ */
+static void
+new__sysconf_ERRNO(void **unused)
+{
+	/* configure mocks */
+	will_return(rpma_conn_get_ibv_qp, MOCK_OK);
+	will_return(__wrap_sysconf, MOCK_ERRNO);
+
+	/* run test */
+	struct rpma_recv_ring *ring = NULL;
+	int ret = rpma_recv_ring_new(MOCK_PEER, MOCK_CONN, NULL, MOCK_SLOTS,
+			MOCK_SLOT_SIZE, MOCK_BATCH, &ring);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(ring);
+}
+
+/*
+ * new__mmap_ERRNO -- mmap() fails with MOCK_ERRNO
+ */
+static void
+new__mmap_ERRNO(void **unused)
+{
+	/* configure mocks */
+	will_return(rpma_conn_get_ibv_qp, MOCK_OK);
+	will_return(__wrap_sysconf, MOCK_OK);
+	will_return(__wrap_mmap, MOCK_ERRNO);
+
+	/* run test */
+	struct rpma_recv_ring *ring = NULL;
+	int ret = rpma_recv_ring_new(MOCK_PEER, MOCK_CONN, NULL, MOCK_SLOTS,
+			MOCK_SLOT_SIZE, MOCK_BATCH, &ring);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NOMEM);
+	assert_null(ring);
+}
+
+/*
+ * new__mr_reg_E_PROVIDER -- rpma_mr_reg() fails with RPMA_E_PROVIDER
+ */
+static void
+new__mr_reg_E_PROVIDER(void **unused)
+{
+	struct mmap_args allocated_slab = {0};
+
+	/* configure mocks */
+	will_return(rpma_conn_get_ibv_qp, MOCK_OK);
+	will_return(__wrap_sysconf, MOCK_OK);
+	will_return(__wrap_mmap, MOCK_OK);
+	will_return(__wrap_mmap, &allocated_slab);
+	expect_value(rpma_mr_reg, peer, MOCK_PEER);
+	expect_value(rpma_mr_reg, size, MOCK_SLAB_SIZE);
+	expect_value(rpma_mr_reg, usage, RPMA_MR_USAGE_RECV);
+	will_return(rpma_mr_reg, &allocated_slab.addr);
+	will_return(rpma_mr_reg, NULL);
+	will_return(rpma_mr_reg, RPMA_E_PROVIDER);
+	will_return(__wrap_munmap, &allocated_slab);
+	will_return(__wrap_munmap, MOCK_OK);
+
+	/* run test */
+	struct rpma_recv_ring *ring = NULL;
+	int ret = rpma_recv_ring_new(MOCK_PEER, MOCK_CONN, NULL, MOCK_SLOTS,
+			MOCK_SLOT_SIZE, MOCK_BATCH, &ring);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(ring);
+}
+
+/*
+ * new__malloc_ERRNO -- malloc() fails with MOCK_ERRNO
+ */
+static void
+new__malloc_ERRNO(void **unused)
+{
+	/* the first or the second malloc() fails */
+	for (int i = 0; i < 2; ++i) {
+		struct mmap_args allocated_slab = {0};
+
+		/* configure mocks */
+		will_return(rpma_conn_get_ibv_qp, MOCK_OK);
+		will_return(__wrap_sysconf, MOCK_OK);
+		will_return(__wrap_mmap, MOCK_OK);
+		will_return(__wrap_mmap, &allocated_slab);
+		expect_value(rpma_mr_reg, peer, MOCK_PEER);
+		expect_value(rpma_mr_reg, size, MOCK_SLAB_SIZE);
+		expect_value(rpma_mr_reg, usage, RPMA_MR_USAGE_RECV);
+		will_return(rpma_mr_reg, &allocated_slab.addr);
+		will_return(rpma_mr_reg, MOCK_RPMA_MR_LOCAL);
+		if (i == 1)
+			will_return(__wrap__test_malloc, MOCK_OK);
+		will_return(__wrap__test_malloc, MOCK_ERRNO);
+		expect_value(rpma_mr_dereg, *mr_ptr, MOCK_RPMA_MR_LOCAL);
+		will_return(rpma_mr_dereg, MOCK_OK);
+		will_return(__wrap_munmap, &allocated_slab);
+		will_return(__wrap_munmap, MOCK_OK);
+
+		/* run test */
+		struct rpma_recv_ring *ring = NULL;
+		int ret = rpma_recv_ring_new(MOCK_PEER, MOCK_CONN, NULL,
+				MOCK_SLOTS, MOCK_SLOT_SIZE, MOCK_BATCH, &ring);
+
+		/* verify the results */
+		assert_int_equal(ret, RPMA_E_NOMEM);
+		assert_null(ring);
+	}
+}
+
+/*
+ * new__post_recv_ERRNO -- ibv_post_recv() fails with MOCK_ERRNO
+ */
+static void
+new__post_recv_ERRNO(void **unused)
+{
+	struct mmap_args allocated_slab = {0};
+
+	/* configure mocks */
+	will_return(rpma_conn_get_ibv_qp, MOCK_OK);
+	will_return(__wrap_sysconf, MOCK_OK);
+	will_return(__wrap_mmap, MOCK_OK);
+	will_return(__wrap_mmap, &allocated_slab);
+	expect_value(rpma_mr_reg, peer, MOCK_PEER);
+	expect_value(rpma_mr_reg, size, MOCK_SLAB_SIZE);
+	expect_value(rpma_mr_reg, usage, RPMA_MR_USAGE_RECV);
+	will_return(rpma_mr_reg, &allocated_slab.addr);
+	will_return(rpma_mr_reg, MOCK_RPMA_MR_LOCAL);
+	will_return_count(__wrap__test_malloc, MOCK_OK, 2);
+	expect_value(post_recv_chain_mock, n, MOCK_SLOTS);
+	will_return(post_recv_chain_mock, MOCK_ERRNO);
+	will_return(post_recv_chain_mock, 0);
+	expect_value(rpma_mr_dereg, *mr_ptr, MOCK_RPMA_MR_LOCAL);
+	will_return(rpma_mr_dereg, MOCK_OK);
+	will_return(__wrap_munmap, &allocated_slab);
+	will_return(__wrap_munmap, MOCK_OK);
+
+	/* run test */
+	struct rpma_recv_ring *ring = NULL;
+	int ret = rpma_recv_ring_new(MOCK_PEER, MOCK_CONN, NULL, MOCK_SLOTS,
+			MOCK_SLOT_SIZE, MOCK_BATCH, &ring);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(ring);
+}
+
+/*
+ * recv_ring_new_post_failed -- create the ring with ibv_post_recv()
+ * failing after posting the given number of work requests
+ */
+static void
+recv_ring_new_post_failed(struct recv_ring_test_state *rstate, int posted)
+{
+	/* configure mocks */
+	will_return(rpma_conn_get_ibv_qp, MOCK_OK);
+	will_return(__wrap_sysconf, MOCK_OK);
+	will_return(__wrap_mmap, MOCK_OK);
+	will_return(__wrap_mmap, &rstate->allocated_slab);
+	expect_value(rpma_mr_reg, peer, MOCK_PEER);
+	expect_value(rpma_mr_reg, size, MOCK_SLAB_SIZE);
+	expect_value(rpma_mr_reg, usage, RPMA_MR_USAGE_RECV);
+	will_return(rpma_mr_reg, &rstate->allocated_slab.addr);
+	will_return(rpma_mr_reg, MOCK_RPMA_MR_LOCAL);
+	will_return_count(__wrap__test_malloc, MOCK_OK, 2);
+	expect_value(post_recv_chain_mock, n, MOCK_SLOTS);
+	will_return(post_recv_chain_mock, MOCK_ERRNO);
+	will_return(post_recv_chain_mock, posted);
+
+	/* run test */
+	rstate->ring = NULL;
+	int ret = rpma_recv_ring_new(MOCK_PEER, MOCK_CONN, NULL, MOCK_SLOTS,
+			MOCK_SLOT_SIZE, MOCK_BATCH, &rstate->ring);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_non_null(rstate->ring);
+}
+
+/*
+ * new__post_recv_partial -- ibv_post_recv() posts only a part of the slots
+ * so the ring is kept and the rest of the slots can be re-posted
+ */
+static void
+new__post_recv_partial(void **unused)
+{
+	struct recv_ring_test_state rstate = {0};
+	uint64_t wr_ids[MOCK_SLOTS];
+
+	recv_ring_new_post_failed(&rstate, MOCK_BATCH);
+	memcpy(wr_ids, Posted_wr_ids, sizeof(wr_ids));
+
+	/* configure mocks */
+	expect_value(post_recv_chain_mock, n, MOCK_SLOTS - MOCK_BATCH);
+	will_return(post_recv_chain_mock, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_recv_ring_repost(rstate.ring);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	for (uint32_t i = 0; i < MOCK_SLOTS - MOCK_BATCH; ++i)
+		assert_int_equal(Posted_wr_ids[i], wr_ids[i + MOCK_BATCH]);
+
+	void *rstate_ptr = &rstate;
+	assert_int_equal(teardown__recv_ring_delete(&rstate_ptr), 0);
+}
+
+/*
+ * new__post_recv_bad_wr_unknown -- ibv_post_recv() fails without pointing
+ * out the first rejected work request so none of the slots is re-posted
+ */
+static void
+new__post_recv_bad_wr_unknown(void **unused)
+{
+	struct recv_ring_test_state rstate = {0};
+
+	/* bad_wr is set to NULL */
+	recv_ring_new_post_failed(&rstate, MOCK_SLOTS);
+
+	/* run test */
+	int ret = rpma_recv_ring_repost(rstate.ring);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+
+	void *rstate_ptr = &rstate;
+	assert_int_equal(teardown__recv_ring_delete(&rstate_ptr), 0);
+}
+
+/*
+ * test_lifecycle -- happy day scenario (a connection)
+ */
+static void
+test_lifecycle(void **unused)
+{
+	/*
+	 * the thing is done by setup__recv_ring_new() and
+	 * teardown__recv_ring_delete()
+	 */
+}
+
+/*
+ * test_lifecycle_srq -- happy day scenario (a shared receive queue)
+ */
+static void
+test_lifecycle_srq(void **unused)
+{
+	/*
+	 * the thing is done by setup__recv_ring_new_srq() and
+	 * teardown__recv_ring_delete()
+	 */
+}
+
+/*
+ * delete__ring_ptr_NULL -- NULL ring_ptr is invalid
+ */
+static void
+delete__ring_ptr_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_recv_ring_delete(NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * delete__ring_NULL -- NULL ring is valid - quick exit
+ */
+static void
+delete__ring_NULL(void **unused)
+{
+	/* run test */
+	struct rpma_recv_ring *ring = NULL;
+	int ret = rpma_recv_ring_delete(&ring);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * delete__mr_dereg_E_PROVIDER -- rpma_mr_dereg() fails with
+ * RPMA_E_PROVIDER
+ */
+static void
+delete__mr_dereg_E_PROVIDER(void **unused)
+{
+	struct recv_ring_test_state *rstate;
+
+	/* WA for cmocka/issues#47 */
+	assert_int_equal(setup__recv_ring_new((void **)&rstate), 0);
+
+	/* configure mocks */
+	expect_value(rpma_mr_dereg, *mr_ptr, MOCK_RPMA_MR_LOCAL);
+	will_return(rpma_mr_dereg, RPMA_E_PROVIDER);
+	will_return(rpma_mr_dereg, MOCK_ERRNO);
+	will_return(__wrap_munmap, &rstate->allocated_slab);
+	will_return(__wrap_munmap, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_recv_ring_delete(&rstate->ring);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(rstate->ring);
+}
+
+/*
+ * delete__munmap_ERRNO -- munmap() fails with MOCK_ERRNO
+ */
+static void
+delete__munmap_ERRNO(void **unused)
+{
+	struct recv_ring_test_state *rstate;
+
+	/* WA for cmocka/issues#47 */
+	assert_int_equal(setup__recv_ring_new((void **)&rstate), 0);
+
+	/* configure mocks */
+	expect_value(rpma_mr_dereg, *mr_ptr, MOCK_RPMA_MR_LOCAL);
+	will_return(rpma_mr_dereg, MOCK_OK);
+	will_return(__wrap_munmap, &rstate->allocated_slab);
+	will_return(__wrap_munmap, MOCK_ERRNO);
+
+	/* run test */
+	int ret = rpma_recv_ring_delete(&rstate->ring);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(rstate->ring);
+}
+
+static const struct CMUnitTest tests_new_delete[] = {
+	/* rpma_recv_ring_new() unit tests */
+	cmocka_unit_test(new__invalid_args),
+	cmocka_unit_test(new__conn_mt_E_NOSUPP),
+	cmocka_unit_test(new__sysconf_ERRNO),
+	cmocka_unit_test(new__mmap_ERRNO),
+	cmocka_unit_test(new__mr_reg_E_PROVIDER),
+	cmocka_unit_test(new__malloc_ERRNO),
+	cmocka_unit_test(new__post_recv_ERRNO),
+	cmocka_unit_test(new__post_recv_partial),
+	cmocka_unit_test(new__post_recv_bad_wr_unknown),
+
+	/* rpma_recv_ring_new()/delete() lifecycle */
+	cmocka_unit_test_setup_teardown(test_lifecycle,
+		setup__recv_ring_new, teardown__recv_ring_delete),
+	cmocka_unit_test_setup_teardown(test_lifecycle_srq,
+		setup__recv_ring_new_srq, teardown__recv_ring_delete),
+
+	/* rpma_recv_ring_delete() unit tests */
+	cmocka_unit_test(delete__ring_ptr_NULL),
+	cmocka_unit_test(delete__ring_NULL),
+	cmocka_unit_test(delete__mr_dereg_E_PROVIDER),
+	cmocka_unit_test(delete__munmap_ERRNO),
+
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_new_delete,
+			group_setup_recv_ring, NULL);
+}
@@ -0,0 +1,239 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * recv_ring-release.c -- the rpma_recv_ring_release/repost() unit tests
+ *
+ * APIs covered:
+ * - rpma_recv_ring_release()
+ * - rpma_recv_ring_repost()
+ */
+
+#include "mocks-ibverbs.h"
+#include "recv_ring-common.h"
+
+/*
+ * deliver -- get the message of the given slot out of the ring
+ */
+static void
+deliver(struct recv_ring_test_state *rstate, uint32_t slot,
+		struct rpma_recv_msg *msg)
+{
+	struct rpma_completion cmpl = {0};
+	cmpl.op = RPMA_OP_RECV;
+	cmpl.op_context = (void *)(uintptr_t)Posted_wr_ids[slot];
+	assert_int_equal(rpma_recv_ring_get_msg(rstate->ring, &cmpl, msg),
+			MOCK_OK);
+}
+
+/*
+ * release__ring_NULL -- NULL ring is invalid
+ */
+static void
+release__ring_NULL(void **unused)
+{
+	/* run test */
+	struct rpma_recv_msg msg = {0};
+	int ret = rpma_recv_ring_release(NULL, &msg);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * release__msg_NULL -- NULL msg is invalid
+ */
+static void
+release__msg_NULL(void **rstate_ptr)
+{
+	struct recv_ring_test_state *rstate = *rstate_ptr;
+
+	/* run test */
+	int ret = rpma_recv_ring_release(rstate->ring, NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * release__not_delivered -- the slot is not held by the application
+ */
+static void
+release__not_delivered(void **rstate_ptr)
+{
+	struct recv_ring_test_state *rstate = *rstate_ptr;
+	struct rpma_recv_msg msg = {0};
+
+	/* a slot still posted */
+	msg.slot = 0;
+	assert_int_equal(rpma_recv_ring_release(rstate->ring, &msg),
+			RPMA_E_INVAL);
+
+	/* a slot out of the ring */
+	msg.slot = MOCK_SLOTS;
+	assert_int_equal(rpma_recv_ring_release(rstate->ring, &msg),
+			RPMA_E_INVAL);
+
+	/* a slot released twice */
+	deliver(rstate, 1, &msg);
+	assert_int_equal(rpma_recv_ring_release(rstate->ring, &msg),
+			MOCK_OK);
+	assert_int_equal(rpma_recv_ring_release(rstate->ring, &msg),
+			RPMA_E_INVAL);
+}
+
+/*
+ * release__batch -- the released slots are re-posted in a single chain
+ * as soon as the batch is complete
+ */
+static void
+release__batch(void **rstate_ptr)
+{
+	struct recv_ring_test_state *rstate = *rstate_ptr;
+	uint64_t wr_ids[MOCK_BATCH];
+	struct rpma_recv_msg msg;
+
+	for (uint32_t i = 0; i < MOCK_BATCH; ++i) {
+		wr_ids[i] = Posted_wr_ids[i];
+		deliver(rstate, i, &msg);
+
+		/* configure mocks */
+		if (i == MOCK_BATCH - 1) {
+			expect_value(post_recv_chain_mock, n, MOCK_BATCH);
+			will_return(post_recv_chain_mock, MOCK_OK);
+		}
+
+		/* run test */
+		int ret = rpma_recv_ring_release(rstate->ring, &msg);
+
+		/* verify the results */
+		assert_int_equal(ret, MOCK_OK);
+	}
+
+	/* the slots are posted in the order of releasing */
+	for (uint32_t i = 0; i < MOCK_BATCH; ++i)
+		assert_int_equal(Posted_wr_ids[i], wr_ids[i]);
+}
+
+/*
+ * release__post_recv_ERRNO -- ibv_post_recv() accepts only a part of
+ * the chain so the rest stays released
+ */
+static void
+release__post_recv_ERRNO(void **rstate_ptr)
+{
+	struct recv_ring_test_state *rstate = *rstate_ptr;
+	uint64_t wr_ids[MOCK_SLOTS];
+	memcpy(wr_ids, Posted_wr_ids, sizeof(wr_ids));
+	struct rpma_recv_msg msg;
+
+	for (uint32_t i = 0; i < MOCK_BATCH - 1; ++i) {
+		deliver(rstate, i, &msg);
+		assert_int_equal(rpma_recv_ring_release(rstate->ring, &msg),
+				MOCK_OK);
+	}
+	deliver(rstate, MOCK_BATCH - 1, &msg);
+
+	/* configure mocks */
+	expect_value(post_recv_chain_mock, n, MOCK_BATCH);
+	will_return(post_recv_chain_mock, MOCK_ERRNO);
+	will_return(post_recv_chain_mock, 1);
+
+	/* run test */
+	int ret = rpma_recv_ring_release(rstate->ring, &msg);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+
+	/* configure mocks */
+	expect_value(post_recv_chain_mock, n, MOCK_BATCH - 1);
+	will_return(post_recv_chain_mock, MOCK_OK);
+
+	/* run test */
+	ret = rpma_recv_ring_repost(rstate->ring);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	for (uint32_t i = 0; i < MOCK_BATCH - 1; ++i)
+		assert_int_equal(Posted_wr_ids[i], wr_ids[i + 1]);
+}
+
+/*
+ * repost__ring_NULL -- NULL ring is invalid
+ */
+static void
+repost__ring_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_recv_ring_repost(NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * repost__nothing_released -- no slot to re-post - quick exit
+ */
+static void
+repost__nothing_released(void **rstate_ptr)
+{
+	struct recv_ring_test_state *rstate = *rstate_ptr;
+
+	/* run test */
+	int ret = rpma_recv_ring_repost(rstate->ring);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * repost__below_batch -- the released slots are re-posted before
+ * the batch is complete
+ */
+static void
+repost__below_batch(void **rstate_ptr)
+{
+	struct recv_ring_test_state *rstate = *rstate_ptr;
+	struct rpma_recv_msg msg;
+
+	deliver(rstate, 0, &msg);
+	assert_int_equal(rpma_recv_ring_release(rstate->ring, &msg), MOCK_OK);
+
+	/* configure mocks */
+	expect_value(post_srq_recv_chain_mock, n, 1);
+	will_return(post_srq_recv_chain_mock, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_recv_ring_repost(rstate->ring);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+static const struct CMUnitTest tests_release[] = {
+	/* rpma_recv_ring_release() unit tests */
+	cmocka_unit_test(release__ring_NULL),
+	cmocka_unit_test_setup_teardown(release__msg_NULL,
+		setup__recv_ring_new, teardown__recv_ring_delete),
+	cmocka_unit_test_setup_teardown(release__not_delivered,
+		setup__recv_ring_new, teardown__recv_ring_delete),
+	cmocka_unit_test_setup_teardown(release__batch,
+		setup__recv_ring_new, teardown__recv_ring_delete),
+	cmocka_unit_test_setup_teardown(release__post_recv_ERRNO,
+		setup__recv_ring_new, teardown__recv_ring_delete),
+
+	/* rpma_recv_ring_repost() unit tests */
+	cmocka_unit_test(repost__ring_NULL),
+	cmocka_unit_test_setup_teardown(repost__nothing_released,
+		setup__recv_ring_new, teardown__recv_ring_delete),
+	cmocka_unit_test_setup_teardown(repost__below_batch,
+		setup__recv_ring_new_srq, teardown__recv_ring_delete),
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_release,
+			group_setup_recv_ring, NULL);
+}
@@ -0,0 +1,169 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * repl-common.c -- the rpma_repl unit tests common functions
+ */
+
+#include "repl-common.h"
+
+struct rpma_conn *const Conns[MOCK_MEMBERS] = {
+	(struct rpma_conn *)0xC004,
+	(struct rpma_conn *)0xC005,
+	(struct rpma_conn *)0xC006,
+};
+
+struct rpma_mr_remote *const Dsts[MOCK_MEMBERS] = {
+	(struct rpma_mr_remote *)0xC412,
+	(struct rpma_mr_remote *)0xC422,
+	(struct rpma_mr_remote *)0xC432,
+};
+
+void *Write_ctx[MOCK_MEMBERS];
+void *Flush_ctx[MOCK_MEMBERS];
+
+/*
+ * member_of -- get the index of the member of the connection
+ */
+static uint32_t
+member_of(const struct rpma_conn *conn)
+{
+	uintptr_t member = (uintptr_t)conn - (uintptr_t)Conns[0];
+	assert_true(member < MOCK_MEMBERS);
+
+	return (uint32_t)member;
+}
+
+/*
+ * rpma_write -- rpma_write() mock
+ */
+int
+rpma_write(struct rpma_conn *conn,
+		struct rpma_mr_remote *dst, size_t dst_offset,
+		const struct rpma_mr_local *src,  size_t src_offset,
+		size_t len, int flags, const void *op_context)
+{
+	uint32_t member = member_of(conn);
+	check_expected(member);
+	assert_ptr_equal(dst, Dsts[member]);
+	assert_int_equal(dst_offset, MOCK_REMOTE_OFFSET);
+	assert_ptr_equal(src, MOCK_RPMA_MR_LOCAL);
+	assert_int_equal(src_offset, MOCK_LOCAL_OFFSET);
+	assert_int_equal(len, MOCK_LEN);
+	assert_int_equal(flags, RPMA_F_COMPLETION_ON_ERROR);
+	assert_non_null(op_context);
+
+	Write_ctx[member] = (void *)op_context;
+
+	return mock_type(int);
+}
+
+/*
+ * rpma_flush -- rpma_flush() mock
+ */
+int
+rpma_flush(struct rpma_conn *conn,
+		struct rpma_mr_remote *dst, size_t dst_offset, size_t len,
+		enum rpma_flush_type type, int flags, const void *op_context)
+{
+	uint32_t member = member_of(conn);
+	check_expected(member);
+	assert_ptr_equal(dst, Dsts[member]);
+	assert_int_equal(dst_offset, MOCK_REMOTE_OFFSET);
+	assert_int_equal(len, MOCK_LEN);
+	assert_int_equal(type, MOCK_FLUSH_TYPE);
+	assert_int_equal(flags, RPMA_F_COMPLETION_ALWAYS);
+	assert_non_null(op_context);
+
+	Flush_ctx[member] = (void *)op_context;
+
+	return mock_type(int);
+}
+
+/*
+ * setup__repl_new -- prepare a valid replication group
+ */
+int
+setup__repl_new(void **rstate_ptr)
+{
+	static struct repl_test_state rstate = {0};
+
+	/* configure mocks */
+	will_return_count(__wrap__test_malloc, MOCK_OK, 2);
+
+	/* run test */
+	rstate.repl = NULL;
+	int ret = rpma_repl_new(Conns, Dsts, MOCK_MEMBERS, MOCK_QUORUM,
+			MOCK_DEPTH, &rstate.repl);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_non_null(rstate.repl);
+
+	*rstate_ptr = &rstate;
+
+	return 0;
+}
+
+/*
+ * teardown__repl_delete -- delete the replication group
+ */
+int
+teardown__repl_delete(void **rstate_ptr)
+{
+	struct repl_test_state *rstate = *rstate_ptr;
+
+	/* run test */
+	int ret = rpma_repl_delete(&rstate->repl);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_null(rstate->repl);
+
+	return 0;
+}
+
+/*
+ * repl_expect_write -- configure the mocks for posting the write and
+ * the flush to the member
+ */
+void
+repl_expect_write(uint32_t member, int write_result, int flush_result)
+{
+	expect_value(rpma_write, member, member);
+	will_return(rpma_write, write_result);
+	if (write_result != MOCK_OK)
+		return;
+
+	expect_value(rpma_flush, member, member);
+	will_return(rpma_flush, flush_result);
+}
+
+/*
+ * repl_post -- initiate the replicated write posted successfully
+ * to all the members
+ */
+int
+repl_post(struct rpma_repl *repl, const void *op_context)
+{
+	for (uint32_t i = 0; i < MOCK_MEMBERS; ++i)
+		repl_expect_write(i, MOCK_OK, MOCK_OK);
+
+	return rpma_repl_write(repl, MOCK_REMOTE_OFFSET, MOCK_RPMA_MR_LOCAL,
+			MOCK_LOCAL_OFFSET, MOCK_LEN, MOCK_FLUSH_TYPE,
+			op_context);
+}
+
+/*
+ * repl_complete -- pass the completion of a member to the group
+ */
+int
+repl_complete(struct rpma_repl *repl, void *ctx, enum ibv_wc_status status)
+{
+	struct rpma_completion cmpl = {0};
+	cmpl.op_context = ctx;
+	cmpl.op = RPMA_OP_FLUSH;
+	cmpl.op_status = status;
+
+	return rpma_repl_process(repl, &cmpl);
+}
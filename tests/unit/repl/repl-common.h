@@ -0,0 +1,43 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * repl-common.h -- the rpma_repl unit tests common definitions
+ */
+
+#ifndef REPL_COMMON_H
+#define REPL_COMMON_H
+
+#include "cmocka_headers.h"
+#include "librpma.h"
+#include "mocks-stdlib.h"
+#include "test-common.h"
+
+#define MOCK_REMOTE_OFFSET	(size_t)0xC414
+#define MOCK_FLUSH_TYPE		RPMA_FLUSH_TYPE_PERSISTENT
+#define MOCK_OP_CONTEXT_2	(void *)0xC418
+
+#define MOCK_MEMBERS		3
+#define MOCK_QUORUM		2
+#define MOCK_DEPTH		2
+
+struct repl_test_state {
+	struct rpma_repl *repl;
+};
+
+extern struct rpma_conn *const Conns[MOCK_MEMBERS];
+extern struct rpma_mr_remote *const Dsts[MOCK_MEMBERS];
+
+/* the op_contexts of the most recently posted writes and flushes */
+extern void *Write_ctx[MOCK_MEMBERS];
+extern void *Flush_ctx[MOCK_MEMBERS];
+
+int setup__repl_new(void **rstate_ptr);
+int teardown__repl_delete(void **rstate_ptr);
+
+void repl_expect_write(uint32_t member, int write_result, int flush_result);
+int repl_post(struct rpma_repl *repl, const void *op_context);
+int repl_complete(struct rpma_repl *repl, void *ctx,
+		enum ibv_wc_status status);
+
+#endif /* REPL_COMMON_H */
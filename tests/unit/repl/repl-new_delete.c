@@ -0,0 +1,147 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * repl-new_delete.c -- the rpma_repl_new/delete() unit tests
+ *
+ * APIs covered:
+ * - rpma_repl_new()
+ * - rpma_repl_delete()
+ */
+
+#include "repl-common.h"
+
+/*
+ * new__invalid_args -- invalid combinations of the arguments
+ */
+static void
+new__invalid_args(void **unused)
+{
+	struct rpma_conn *const conns_NULL[MOCK_MEMBERS] =
+		{Conns[0], NULL, Conns[2]};
+	struct rpma_mr_remote *const dsts_NULL[MOCK_MEMBERS] =
+		{Dsts[0], Dsts[1], NULL};
+	struct rpma_repl *repl = NULL;
+	struct {
+		struct rpma_conn *const *conns;
+		struct rpma_mr_remote *const *dsts;
+		uint32_t members;
+		uint32_t quorum;
+		uint32_t depth;
+		struct rpma_repl **repl_ptr;
+	} args[] = {
+		{NULL, Dsts, MOCK_MEMBERS, MOCK_QUORUM, MOCK_DEPTH, &repl},
+		{Conns, NULL, MOCK_MEMBERS, MOCK_QUORUM, MOCK_DEPTH, &repl},
+		/* one of the connections is NULL */
+		{conns_NULL, Dsts, MOCK_MEMBERS, MOCK_QUORUM, MOCK_DEPTH,
+			&repl},
+		/* one of the remote memory regions is NULL */
+		{Conns, dsts_NULL, MOCK_MEMBERS, MOCK_QUORUM, MOCK_DEPTH,
+			&repl},
+		{Conns, Dsts, 0, 0, MOCK_DEPTH, &repl},
+		{Conns, Dsts, MOCK_MEMBERS, 0, MOCK_DEPTH, &repl},
+		/* quorum > members */
+		{Conns, Dsts, MOCK_MEMBERS, MOCK_MEMBERS + 1, MOCK_DEPTH,
+			&repl},
+		{Conns, Dsts, MOCK_MEMBERS, MOCK_QUORUM, 0, &repl},
+		/* members * depth is too big */
+		{Conns, Dsts, MOCK_MEMBERS, MOCK_QUORUM, UINT32_MAX, &repl},
+		{Conns, Dsts, MOCK_MEMBERS, MOCK_QUORUM, MOCK_DEPTH, NULL},
+	};
+
+	for (size_t i = 0; i < sizeof(args) / sizeof(args[0]); ++i) {
+		/* run test */
+		int ret = rpma_repl_new(args[i].conns, args[i].dsts,
+				args[i].members, args[i].quorum,
+				args[i].depth, args[i].repl_ptr);
+
+		/* verify the results */
+		assert_int_equal(ret, RPMA_E_INVAL);
+		assert_null(repl);
+	}
+}
+
+/*
+ * new__malloc_ERRNO -- malloc() fails with MOCK_ERRNO
+ */
+static void
+new__malloc_ERRNO(void **unused)
+{
+	/* each of the two malloc() calls fails in turn */
+	for (int i = 0; i < 2; ++i) {
+		/* configure mocks */
+		for (int j = 0; j < i; ++j)
+			will_return(__wrap__test_malloc, MOCK_OK);
+		will_return(__wrap__test_malloc, MOCK_ERRNO);
+
+		/* run test */
+		struct rpma_repl *repl = NULL;
+		int ret = rpma_repl_new(Conns, Dsts, MOCK_MEMBERS,
+				MOCK_QUORUM, MOCK_DEPTH, &repl);
+
+		/* verify the results */
+		assert_int_equal(ret, RPMA_E_NOMEM);
+		assert_null(repl);
+	}
+}
+
+/*
+ * test_lifecycle -- happy day scenario
+ */
+static void
+test_lifecycle(void **unused)
+{
+	/*
+	 * The thing is done by setup__repl_new()
+	 * and teardown__repl_delete().
+	 */
+}
+
+/*
+ * delete__repl_ptr_NULL -- NULL repl_ptr is invalid
+ */
+static void
+delete__repl_ptr_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_repl_delete(NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * delete__repl_NULL -- NULL repl is valid - quick exit
+ */
+static void
+delete__repl_NULL(void **unused)
+{
+	/* run test */
+	struct rpma_repl *repl = NULL;
+	int ret = rpma_repl_delete(&repl);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+static const struct CMUnitTest tests_new_delete[] = {
+	/* rpma_repl_new() unit tests */
+	cmocka_unit_test(new__invalid_args),
+	cmocka_unit_test(new__malloc_ERRNO),
+
+	/* rpma_repl_new()/delete() lifecycle */
+	cmocka_unit_test_setup_teardown(test_lifecycle,
+		setup__repl_new, teardown__repl_delete),
+
+	/* rpma_repl_delete() unit tests */
+	cmocka_unit_test(delete__repl_ptr_NULL),
+	cmocka_unit_test(delete__repl_NULL),
+
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_new_delete, NULL, NULL);
+}
@@ -0,0 +1,311 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * repl-process_next.c -- the rpma_repl_process/next/get_slowest() unit tests
+ *
+ * APIs covered:
+ * - rpma_repl_process()
+ * - rpma_repl_next()
+ * - rpma_repl_get_slowest()
+ */
+
+#include <string.h>
+
+#include "repl-common.h"
+
+/*
+ * process__invalid_args -- NULL repl or cmpl is invalid
+ */
+static void
+process__invalid_args(void **rstate_ptr)
+{
+	struct repl_test_state *rstate = *rstate_ptr;
+	struct rpma_completion cmpl = {0};
+
+	/* run test */
+	int ret1 = rpma_repl_process(NULL, &cmpl);
+	int ret2 = rpma_repl_process(rstate->repl, NULL);
+
+	/* verify the results */
+	assert_int_equal(ret1, RPMA_E_INVAL);
+	assert_int_equal(ret2, RPMA_E_INVAL);
+}
+
+/*
+ * process__foreign -- the completion does not come from the group
+ */
+static void
+process__foreign(void **rstate_ptr)
+{
+	struct repl_test_state *rstate = *rstate_ptr;
+
+	/* run test */
+	int ret = repl_complete(rstate->repl, MOCK_OP_CONTEXT, IBV_WC_SUCCESS);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * process__not_pending -- the member has completed the write already
+ */
+static void
+process__not_pending(void **rstate_ptr)
+{
+	struct repl_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	assert_int_equal(repl_post(rstate->repl, MOCK_OP_CONTEXT), MOCK_OK);
+	assert_int_equal(repl_complete(rstate->repl, Flush_ctx[0],
+			IBV_WC_SUCCESS), MOCK_OK);
+
+	/* run test */
+	int ret = repl_complete(rstate->repl, Flush_ctx[0], IBV_WC_SUCCESS);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * process__quorum -- the write is finished when the quorum of the members
+ * have flushed it and the remaining member falls behind
+ */
+static void
+process__quorum(void **rstate_ptr)
+{
+	struct repl_test_state *rstate = *rstate_ptr;
+	struct rpma_completion cmpl = {0};
+	uint32_t member;
+	uint32_t behind;
+
+	/* configure mocks */
+	assert_int_equal(repl_post(rstate->repl, MOCK_OP_CONTEXT), MOCK_OK);
+
+	/* run test */
+	int ret = repl_complete(rstate->repl, Flush_ctx[0], IBV_WC_SUCCESS);
+	assert_int_equal(ret, MOCK_OK);
+	ret = rpma_repl_next(rstate->repl, &cmpl);
+	assert_int_equal(ret, RPMA_E_NO_COMPLETION);
+	ret = repl_complete(rstate->repl, Flush_ctx[2], IBV_WC_SUCCESS);
+	assert_int_equal(ret, MOCK_OK);
+
+	/* verify the results */
+	ret = rpma_repl_next(rstate->repl, &cmpl);
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(cmpl.op_context, MOCK_OP_CONTEXT);
+	assert_int_equal(cmpl.op, RPMA_OP_FLUSH);
+	assert_int_equal(cmpl.op_status, IBV_WC_SUCCESS);
+	ret = rpma_repl_next(rstate->repl, &cmpl);
+	assert_int_equal(ret, RPMA_E_NO_COMPLETION);
+
+	ret = rpma_repl_get_slowest(rstate->repl, &member, &behind);
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(member, 1);
+	assert_int_equal(behind, 1);
+
+	/* the slowest member catches up */
+	ret = repl_complete(rstate->repl, Flush_ctx[1], IBV_WC_SUCCESS);
+	assert_int_equal(ret, MOCK_OK);
+	ret = rpma_repl_get_slowest(rstate->repl, &member, &behind);
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(behind, 0);
+}
+
+/*
+ * process__flush_failed -- the failed flushes count against the quorum
+ */
+static void
+process__flush_failed(void **rstate_ptr)
+{
+	struct repl_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	assert_int_equal(repl_post(rstate->repl, MOCK_OP_CONTEXT), MOCK_OK);
+
+	/* run test */
+	int ret = repl_complete(rstate->repl, Flush_ctx[0],
+			IBV_WC_REM_ACCESS_ERR);
+	assert_int_equal(ret, MOCK_OK);
+	ret = repl_complete(rstate->repl, Flush_ctx[1], IBV_WC_SUCCESS);
+	assert_int_equal(ret, MOCK_OK);
+	struct rpma_completion cmpl = {0};
+	ret = rpma_repl_next(rstate->repl, &cmpl);
+	assert_int_equal(ret, RPMA_E_NO_COMPLETION);
+	ret = repl_complete(rstate->repl, Flush_ctx[2], IBV_WC_RETRY_EXC_ERR);
+	assert_int_equal(ret, MOCK_OK);
+
+	/* verify the results */
+	ret = rpma_repl_next(rstate->repl, &cmpl);
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(cmpl.op_context, MOCK_OP_CONTEXT);
+	assert_int_equal(cmpl.op_status, IBV_WC_REM_ACCESS_ERR);
+}
+
+/*
+ * process__write_failed -- the failed write of a member is reported
+ * instead of the failure of the flush following it
+ */
+static void
+process__write_failed(void **rstate_ptr)
+{
+	struct repl_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	assert_int_equal(repl_post(rstate->repl, MOCK_OP_CONTEXT), MOCK_OK);
+
+	/* run test */
+	int ret = repl_complete(rstate->repl, Write_ctx[0],
+			IBV_WC_REM_ACCESS_ERR);
+	assert_int_equal(ret, MOCK_OK);
+	struct rpma_completion cmpl = {0};
+	ret = rpma_repl_next(rstate->repl, &cmpl);
+	assert_int_equal(ret, RPMA_E_NO_COMPLETION);
+	ret = repl_complete(rstate->repl, Flush_ctx[0], IBV_WC_WR_FLUSH_ERR);
+	assert_int_equal(ret, MOCK_OK);
+	ret = repl_complete(rstate->repl, Flush_ctx[1], IBV_WC_WR_FLUSH_ERR);
+	assert_int_equal(ret, MOCK_OK);
+
+	/* verify the results */
+	ret = rpma_repl_next(rstate->repl, &cmpl);
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(cmpl.op_status, IBV_WC_REM_ACCESS_ERR);
+	ret = repl_complete(rstate->repl, Flush_ctx[2], IBV_WC_SUCCESS);
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * process__in_order -- the writes are reported in the order they have been
+ * initiated and the slot of a write is kept until all the members have
+ * completed it
+ */
+static void
+process__in_order(void **rstate_ptr)
+{
+	struct repl_test_state *rstate = *rstate_ptr;
+	struct rpma_completion cmpl = {0};
+	void *first[MOCK_MEMBERS];
+
+	/* configure mocks */
+	assert_int_equal(repl_post(rstate->repl, MOCK_OP_CONTEXT), MOCK_OK);
+	memcpy(first, Flush_ctx, sizeof(first));
+	assert_int_equal(repl_post(rstate->repl, MOCK_OP_CONTEXT_2), MOCK_OK);
+
+	/* run test - the second write gets its quorum first */
+	for (uint32_t i = 0; i < MOCK_QUORUM; ++i)
+		assert_int_equal(repl_complete(rstate->repl, Flush_ctx[i],
+				IBV_WC_SUCCESS), MOCK_OK);
+	int ret = rpma_repl_next(rstate->repl, &cmpl);
+	assert_int_equal(ret, RPMA_E_NO_COMPLETION);
+	for (uint32_t i = 0; i < MOCK_QUORUM; ++i)
+		assert_int_equal(repl_complete(rstate->repl, first[i],
+				IBV_WC_SUCCESS), MOCK_OK);
+
+	/* verify the results */
+	ret = rpma_repl_next(rstate->repl, &cmpl);
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(cmpl.op_context, MOCK_OP_CONTEXT);
+	ret = rpma_repl_next(rstate->repl, &cmpl);
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(cmpl.op_context, MOCK_OP_CONTEXT_2);
+
+	/* the slots are kept until the last member completes the writes */
+	ret = rpma_repl_write(rstate->repl, MOCK_REMOTE_OFFSET,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET, MOCK_LEN,
+			MOCK_FLUSH_TYPE, MOCK_OP_CONTEXT);
+	assert_int_equal(ret, RPMA_E_AGAIN);
+	assert_int_equal(repl_complete(rstate->repl, first[MOCK_QUORUM],
+			IBV_WC_SUCCESS), MOCK_OK);
+	assert_int_equal(repl_post(rstate->repl, MOCK_OP_CONTEXT), MOCK_OK);
+}
+
+/*
+ * next__invalid_args -- NULL repl or cmpl is invalid
+ */
+static void
+next__invalid_args(void **rstate_ptr)
+{
+	struct repl_test_state *rstate = *rstate_ptr;
+	struct rpma_completion cmpl = {0};
+
+	/* run test */
+	int ret1 = rpma_repl_next(NULL, &cmpl);
+	int ret2 = rpma_repl_next(rstate->repl, NULL);
+
+	/* verify the results */
+	assert_int_equal(ret1, RPMA_E_INVAL);
+	assert_int_equal(ret2, RPMA_E_INVAL);
+}
+
+/*
+ * next__no_writes -- there is nothing to report
+ */
+static void
+next__no_writes(void **rstate_ptr)
+{
+	struct repl_test_state *rstate = *rstate_ptr;
+	struct rpma_completion cmpl = {0};
+
+	/* run test */
+	int ret = rpma_repl_next(rstate->repl, &cmpl);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NO_COMPLETION);
+}
+
+/*
+ * get_slowest__invalid_args -- NULL repl, member or behind is invalid
+ */
+static void
+get_slowest__invalid_args(void **rstate_ptr)
+{
+	struct repl_test_state *rstate = *rstate_ptr;
+	uint32_t member;
+	uint32_t behind;
+
+	/* run test */
+	int ret1 = rpma_repl_get_slowest(NULL, &member, &behind);
+	int ret2 = rpma_repl_get_slowest(rstate->repl, NULL, &behind);
+	int ret3 = rpma_repl_get_slowest(rstate->repl, &member, NULL);
+
+	/* verify the results */
+	assert_int_equal(ret1, RPMA_E_INVAL);
+	assert_int_equal(ret2, RPMA_E_INVAL);
+	assert_int_equal(ret3, RPMA_E_INVAL);
+}
+
+static const struct CMUnitTest tests_process_next[] = {
+	/* rpma_repl_process() unit tests */
+	cmocka_unit_test_setup_teardown(process__invalid_args,
+		setup__repl_new, teardown__repl_delete),
+	cmocka_unit_test_setup_teardown(process__foreign,
+		setup__repl_new, teardown__repl_delete),
+	cmocka_unit_test_setup_teardown(process__not_pending,
+		setup__repl_new, teardown__repl_delete),
+	cmocka_unit_test_setup_teardown(process__quorum,
+		setup__repl_new, teardown__repl_delete),
+	cmocka_unit_test_setup_teardown(process__flush_failed,
+		setup__repl_new, teardown__repl_delete),
+	cmocka_unit_test_setup_teardown(process__write_failed,
+		setup__repl_new, teardown__repl_delete),
+	cmocka_unit_test_setup_teardown(process__in_order,
+		setup__repl_new, teardown__repl_delete),
+
+	/* rpma_repl_next() unit tests */
+	cmocka_unit_test_setup_teardown(next__invalid_args,
+		setup__repl_new, teardown__repl_delete),
+	cmocka_unit_test_setup_teardown(next__no_writes,
+		setup__repl_new, teardown__repl_delete),
+
+	/* rpma_repl_get_slowest() unit tests */
+	cmocka_unit_test_setup_teardown(get_slowest__invalid_args,
+		setup__repl_new, teardown__repl_delete),
+
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_process_next, NULL, NULL);
+}
@@ -0,0 +1,298 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * repl-write.c -- the rpma_repl_write() unit tests
+ *
+ * API covered:
+ * - rpma_repl_write()
+ */
+
+#include "repl-common.h"
+
+/*
+ * write__invalid_args -- invalid combinations of the arguments
+ */
+static void
+write__invalid_args(void **rstate_ptr)
+{
+	struct repl_test_state *rstate = *rstate_ptr;
+
+	/* run test */
+	int ret1 = rpma_repl_write(NULL, MOCK_REMOTE_OFFSET,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET, MOCK_LEN,
+			MOCK_FLUSH_TYPE, MOCK_OP_CONTEXT);
+	int ret2 = rpma_repl_write(rstate->repl, MOCK_REMOTE_OFFSET,
+			NULL, MOCK_LOCAL_OFFSET, MOCK_LEN,
+			MOCK_FLUSH_TYPE, MOCK_OP_CONTEXT);
+	int ret3 = rpma_repl_write(rstate->repl, MOCK_REMOTE_OFFSET,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET, 0,
+			MOCK_FLUSH_TYPE, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret1, RPMA_E_INVAL);
+	assert_int_equal(ret2, RPMA_E_INVAL);
+	assert_int_equal(ret3, RPMA_E_INVAL);
+}
+
+/*
+ * write__success -- the write and the flush are posted to all the members
+ */
+static void
+write__success(void **rstate_ptr)
+{
+	struct repl_test_state *rstate = *rstate_ptr;
+
+	/* run test */
+	int ret = repl_post(rstate->repl, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	for (uint32_t i = 0; i < MOCK_MEMBERS; ++i) {
+		assert_ptr_not_equal(Write_ctx[i], Flush_ctx[i]);
+		for (uint32_t j = 0; j < i; ++j)
+			assert_ptr_not_equal(Flush_ctx[i], Flush_ctx[j]);
+	}
+
+	struct rpma_completion cmpl = {0};
+	ret = rpma_repl_next(rstate->repl, &cmpl);
+	assert_int_equal(ret, RPMA_E_NO_COMPLETION);
+}
+
+/*
+ * write__depth_E_AGAIN -- no more than depth writes can be in progress
+ */
+static void
+write__depth_E_AGAIN(void **rstate_ptr)
+{
+	struct repl_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	for (int i = 0; i < MOCK_DEPTH; ++i)
+		assert_int_equal(repl_post(rstate->repl, MOCK_OP_CONTEXT),
+				MOCK_OK);
+
+	/* run test */
+	int ret = rpma_repl_write(rstate->repl, MOCK_REMOTE_OFFSET,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET, MOCK_LEN,
+			MOCK_FLUSH_TYPE, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_AGAIN);
+}
+
+/*
+ * write__all_failed -- posting fails for all the members so the write
+ * is withdrawn
+ */
+static void
+write__all_failed(void **rstate_ptr)
+{
+	struct repl_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	repl_expect_write(0, RPMA_E_PROVIDER, MOCK_OK);
+	repl_expect_write(1, RPMA_E_NOSUPP, MOCK_OK);
+	repl_expect_write(2, RPMA_E_PROVIDER, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_repl_write(rstate->repl, MOCK_REMOTE_OFFSET,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET, MOCK_LEN,
+			MOCK_FLUSH_TYPE, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	struct rpma_completion cmpl = {0};
+	ret = rpma_repl_next(rstate->repl, &cmpl);
+	assert_int_equal(ret, RPMA_E_NO_COMPLETION);
+
+	/* the slot of the write is free */
+	for (int i = 0; i < MOCK_DEPTH; ++i)
+		assert_int_equal(repl_post(rstate->repl, MOCK_OP_CONTEXT),
+				MOCK_OK);
+}
+
+/*
+ * write__all_failed_unflushed -- the write withdrawn after it has been
+ * posted without its flush to a member keeps its slot until the member
+ * completes a later write
+ */
+static void
+write__all_failed_unflushed(void **rstate_ptr)
+{
+	struct repl_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	repl_expect_write(0, RPMA_E_PROVIDER, MOCK_OK);
+	repl_expect_write(1, MOCK_OK, RPMA_E_NOSUPP);
+	repl_expect_write(2, RPMA_E_PROVIDER, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_repl_write(rstate->repl, MOCK_REMOTE_OFFSET,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET, MOCK_LEN,
+			MOCK_FLUSH_TYPE, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	struct rpma_completion cmpl = {0};
+	ret = rpma_repl_next(rstate->repl, &cmpl);
+	assert_int_equal(ret, RPMA_E_NO_COMPLETION);
+
+	/* the slot of the write is still taken */
+	assert_int_equal(repl_post(rstate->repl, MOCK_OP_CONTEXT_2), MOCK_OK);
+	ret = rpma_repl_write(rstate->repl, MOCK_REMOTE_OFFSET,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET, MOCK_LEN,
+			MOCK_FLUSH_TYPE, MOCK_OP_CONTEXT);
+	assert_int_equal(ret, RPMA_E_AGAIN);
+
+	/* the later completion of the member releases it */
+	assert_int_equal(repl_complete(rstate->repl, Flush_ctx[1],
+			IBV_WC_SUCCESS), MOCK_OK);
+	assert_int_equal(repl_complete(rstate->repl, Flush_ctx[0],
+			IBV_WC_SUCCESS), MOCK_OK);
+	ret = rpma_repl_next(rstate->repl, &cmpl);
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(cmpl.op_context, MOCK_OP_CONTEXT_2);
+	assert_int_equal(cmpl.op_status, IBV_WC_SUCCESS);
+	assert_int_equal(repl_post(rstate->repl, MOCK_OP_CONTEXT), MOCK_OK);
+}
+
+/*
+ * write__flush_failed -- the write posted without its flush counts against
+ * the quorum once even if it completes with an error later on
+ */
+static void
+write__flush_failed(void **rstate_ptr)
+{
+	struct repl_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	repl_expect_write(0, MOCK_OK, MOCK_OK);
+	repl_expect_write(1, MOCK_OK, RPMA_E_PROVIDER);
+	repl_expect_write(2, MOCK_OK, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_repl_write(rstate->repl, MOCK_REMOTE_OFFSET,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET, MOCK_LEN,
+			MOCK_FLUSH_TYPE, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(repl_complete(rstate->repl, Write_ctx[1],
+			IBV_WC_REM_ACCESS_ERR), MOCK_OK);
+	/* the write has been released already */
+	assert_int_equal(repl_complete(rstate->repl, Write_ctx[1],
+			IBV_WC_REM_ACCESS_ERR), RPMA_E_INVAL);
+	assert_int_equal(repl_complete(rstate->repl, Flush_ctx[0],
+			IBV_WC_SUCCESS), MOCK_OK);
+	struct rpma_completion cmpl = {0};
+	ret = rpma_repl_next(rstate->repl, &cmpl);
+	assert_int_equal(ret, RPMA_E_NO_COMPLETION);
+
+	assert_int_equal(repl_complete(rstate->repl, Flush_ctx[2],
+			IBV_WC_SUCCESS), MOCK_OK);
+	ret = rpma_repl_next(rstate->repl, &cmpl);
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(cmpl.op_context, MOCK_OP_CONTEXT);
+	assert_int_equal(cmpl.op_status, IBV_WC_SUCCESS);
+
+	/* all the slots are free */
+	for (int i = 0; i < MOCK_DEPTH; ++i)
+		assert_int_equal(repl_post(rstate->repl, MOCK_OP_CONTEXT),
+				MOCK_OK);
+}
+
+/*
+ * write__some_failed -- the failure of posting to a member counts against
+ * the quorum
+ */
+static void
+write__some_failed(void **rstate_ptr)
+{
+	struct repl_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	repl_expect_write(0, MOCK_OK, MOCK_OK);
+	repl_expect_write(1, MOCK_OK, RPMA_E_PROVIDER);
+	repl_expect_write(2, MOCK_OK, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_repl_write(rstate->repl, MOCK_REMOTE_OFFSET,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET, MOCK_LEN,
+			MOCK_FLUSH_TYPE, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(repl_complete(rstate->repl, Flush_ctx[0],
+			IBV_WC_SUCCESS), MOCK_OK);
+	struct rpma_completion cmpl = {0};
+	ret = rpma_repl_next(rstate->repl, &cmpl);
+	assert_int_equal(ret, RPMA_E_NO_COMPLETION);
+
+	assert_int_equal(repl_complete(rstate->repl, Flush_ctx[2],
+			IBV_WC_SUCCESS), MOCK_OK);
+	ret = rpma_repl_next(rstate->repl, &cmpl);
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(cmpl.op_context, MOCK_OP_CONTEXT);
+	assert_int_equal(cmpl.op_status, IBV_WC_SUCCESS);
+}
+
+/*
+ * write__quorum_lost -- posting fails for so many members that the quorum
+ * cannot be reached
+ */
+static void
+write__quorum_lost(void **rstate_ptr)
+{
+	struct repl_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	repl_expect_write(0, RPMA_E_PROVIDER, MOCK_OK);
+	repl_expect_write(1, MOCK_OK, MOCK_OK);
+	repl_expect_write(2, RPMA_E_PROVIDER, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_repl_write(rstate->repl, MOCK_REMOTE_OFFSET,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET, MOCK_LEN,
+			MOCK_FLUSH_TYPE, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	struct rpma_completion cmpl = {0};
+	ret = rpma_repl_next(rstate->repl, &cmpl);
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(cmpl.op_context, MOCK_OP_CONTEXT);
+	assert_int_equal(cmpl.op_status, IBV_WC_GENERAL_ERR);
+
+	/* the member which has been posted to still completes the write */
+	assert_int_equal(repl_complete(rstate->repl, Flush_ctx[1],
+			IBV_WC_SUCCESS), MOCK_OK);
+}
+
+static const struct CMUnitTest tests_write[] = {
+	/* rpma_repl_write() unit tests */
+	cmocka_unit_test_setup_teardown(write__invalid_args,
+		setup__repl_new, teardown__repl_delete),
+	cmocka_unit_test_setup_teardown(write__success,
+		setup__repl_new, teardown__repl_delete),
+	cmocka_unit_test_setup_teardown(write__depth_E_AGAIN,
+		setup__repl_new, teardown__repl_delete),
+	cmocka_unit_test_setup_teardown(write__all_failed,
+		setup__repl_new, teardown__repl_delete),
+	cmocka_unit_test_setup_teardown(write__all_failed_unflushed,
+		setup__repl_new, teardown__repl_delete),
+	cmocka_unit_test_setup_teardown(write__flush_failed,
+		setup__repl_new, teardown__repl_delete),
+	cmocka_unit_test_setup_teardown(write__some_failed,
+		setup__repl_new, teardown__repl_delete),
+	cmocka_unit_test_setup_teardown(write__quorum_lost,
+		setup__repl_new, teardown__repl_delete),
+
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_write, NULL, NULL);
+}
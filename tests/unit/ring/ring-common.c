@@ -0,0 +1,273 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * ring-common.c -- the rpma_ring unit tests common functions
+ */
+
+#include <string.h>
+
+#include "ring-common.h"
+#include "conn.h"
+#include "cq.h"
+#include "mr.h"
+
+static struct ibv_context Ring_context;
+static struct ibv_qp Ring_qp = {.context = &Ring_context};
+
+/*
+ * ring_post_send -- ibv_post_send() mock checking the chain of work requests
+ */
+static int
+ring_post_send(struct ibv_qp *qp, struct ibv_send_wr *wr,
+		struct ibv_send_wr **bad_wr)
+{
+	assert_ptr_equal(qp, &Ring_qp);
+	assert_non_null(wr);
+	assert_non_null(bad_wr);
+
+	int fail_at = mock_type(int);
+	if (fail_at == MOCK_POST_FAIL_ALL)
+		return MOCK_ERRNO;
+
+	for (int i = 0; wr != NULL; wr = wr->next, ++i) {
+		if (i == fail_at) {
+			*bad_wr = wr;
+			return MOCK_ERRNO;
+		}
+
+		check_expected(wr->opcode);
+		check_expected(wr->wr_id);
+	}
+
+	return 0;
+}
+
+/*
+ * rpma_conn_get_ibv_qp -- rpma_conn_get_ibv_qp() mock
+ */
+int
+rpma_conn_get_ibv_qp(const struct rpma_conn *conn, struct ibv_qp **qp_ptr)
+{
+	assert_ptr_equal(conn, MOCK_CONN);
+	assert_non_null(qp_ptr);
+
+	int ret = mock_type(int);
+	if (ret == MOCK_OK)
+		*qp_ptr = &Ring_qp;
+
+	return ret;
+}
+
+/*
+ * rpma_conn_reads_posted -- rpma_conn_reads_posted() mock
+ */
+void
+rpma_conn_reads_posted(struct rpma_conn *conn)
+{
+	check_expected(conn);
+}
+
+/*
+ * rpma_conn_get_cq -- rpma_conn_get_cq() mock
+ */
+int
+rpma_conn_get_cq(const struct rpma_conn *conn, struct rpma_cq **cq_ptr)
+{
+	assert_ptr_equal(conn, MOCK_CONN);
+	assert_non_null(cq_ptr);
+
+	int ret = mock_type(int);
+	if (ret == MOCK_OK)
+		*cq_ptr = MOCK_RPMA_CQ;
+
+	return ret;
+}
+
+/*
+ * rpma_cq_get_completions -- rpma_cq_get_completions() mock; the number
+ * of the completions and their op_contexts are taken from the mock values
+ */
+int
+rpma_cq_get_completions(struct rpma_cq *cq, struct ibv_wc *wcs,
+		struct rpma_completion *cmpls, int num_entries, int *num)
+{
+	assert_ptr_equal(cq, MOCK_RPMA_CQ);
+	assert_non_null(wcs);
+	assert_non_null(cmpls);
+	assert_int_equal(num_entries, MOCK_CQ_ENTRIES);
+	assert_non_null(num);
+
+	int ret = mock_type(int);
+	*num = mock_type(int);
+	for (int i = 0; i < *num; ++i) {
+		memset(&cmpls[i], 0, sizeof(cmpls[i]));
+		cmpls[i].op_context = mock_type(void *);
+	}
+
+	return ret;
+}
+
+/*
+ * rpma_mr_read_wr -- rpma_mr_read_wr() mock
+ */
+void
+rpma_mr_read_wr(struct ibv_send_wr *wr, struct ibv_sge *sge,
+	struct rpma_mr_local *dst, size_t dst_offset,
+	const struct rpma_mr_remote *src,  size_t src_offset,
+	size_t len, int flags, const void *op_context)
+{
+	assert_ptr_equal(dst, MOCK_RPMA_MR_LOCAL);
+	assert_int_equal(dst_offset, MOCK_LOCAL_OFFSET);
+	assert_ptr_equal(src, MOCK_RPMA_MR_REMOTE);
+	assert_int_equal(src_offset, MOCK_REMOTE_OFFSET);
+	assert_int_equal(len, MOCK_LEN);
+	assert_int_equal(flags, RPMA_F_COMPLETION_ALWAYS);
+
+	memset(wr, 0, sizeof(*wr));
+	wr->wr_id = (uint64_t)op_context;
+	wr->opcode = IBV_WR_RDMA_READ;
+	wr->sg_list = sge;
+	wr->num_sge = 1;
+}
+
+/*
+ * rpma_mr_write_wr -- rpma_mr_write_wr() mock
+ */
+int
+rpma_mr_write_wr(struct ibv_send_wr *wr, struct ibv_sge *sge,
+	struct rpma_mr_remote *dst, size_t dst_offset,
+	const struct rpma_mr_local *src,  size_t src_offset,
+	size_t len, int flags, enum ibv_wr_opcode operation,
+	uint32_t imm, const void *op_context, bool fence)
+{
+	assert_ptr_equal(dst, MOCK_RPMA_MR_REMOTE);
+	assert_int_equal(dst_offset, MOCK_REMOTE_OFFSET);
+	assert_ptr_equal(src, MOCK_RPMA_MR_LOCAL);
+	assert_int_equal(src_offset, MOCK_LOCAL_OFFSET);
+	assert_int_equal(len, MOCK_LEN);
+	assert_int_equal(flags, RPMA_F_COMPLETION_ALWAYS);
+	assert_int_equal(imm, operation == IBV_WR_RDMA_WRITE_WITH_IMM ?
+			MOCK_IMM_DATA : 0);
+	assert_false(fence);
+
+	memset(wr, 0, sizeof(*wr));
+	wr->wr_id = (uint64_t)op_context;
+	wr->opcode = operation;
+	wr->sg_list = sge;
+	wr->num_sge = 1;
+
+	return 0;
+}
+
+/*
+ * rpma_mr_send_wr -- rpma_mr_send_wr() mock
+ */
+int
+rpma_mr_send_wr(struct ibv_send_wr *wr, struct ibv_sge *sge,
+	const struct rpma_mr_local *src,  size_t offset,
+	size_t len, int flags, enum ibv_wr_opcode operation,
+	uint32_t imm, const void *op_context)
+{
+	assert_ptr_equal(src, MOCK_RPMA_MR_LOCAL);
+	assert_int_equal(offset, MOCK_LOCAL_OFFSET);
+	assert_int_equal(len, MOCK_LEN);
+	assert_int_equal(flags, RPMA_F_COMPLETION_ALWAYS);
+	assert_int_equal(imm, operation == IBV_WR_SEND_WITH_IMM ?
+			MOCK_IMM_DATA : 0);
+
+	memset(wr, 0, sizeof(*wr));
+	wr->wr_id = (uint64_t)op_context;
+	wr->opcode = operation;
+	wr->sg_list = sge;
+	wr->num_sge = 1;
+
+	return 0;
+}
+
+/*
+ * ring_fill_sqe -- fill the descriptor of a valid operation
+ */
+void
+ring_fill_sqe(struct rpma_ring_sqe *sqe, enum rpma_ring_opcode opcode,
+		void *user_data)
+{
+	sqe->opcode = opcode;
+	sqe->flags = RPMA_F_COMPLETION_ALWAYS;
+	sqe->local = MOCK_RPMA_MR_LOCAL;
+	sqe->local_offset = MOCK_LOCAL_OFFSET;
+	sqe->remote = MOCK_RPMA_MR_REMOTE;
+	sqe->remote_offset = MOCK_REMOTE_OFFSET;
+	sqe->len = MOCK_LEN;
+	sqe->imm = (opcode == RPMA_RING_OP_WRITE_WITH_IMM ||
+			opcode == RPMA_RING_OP_SEND_WITH_IMM) ?
+			MOCK_IMM_DATA : 0;
+	sqe->user_data = user_data;
+}
+
+/*
+ * expect_post -- expect a single ibv_post_send() call failing at
+ * the fail_at work request of the chain (MOCK_POST_OK means no failure)
+ */
+void
+expect_post(int fail_at)
+{
+	will_return(ring_post_send, fail_at);
+}
+
+/*
+ * expect_posted -- expect the work request in the posted chain
+ */
+void
+expect_posted(enum ibv_wr_opcode opcode, void *user_data)
+{
+	expect_value(ring_post_send, wr->opcode, opcode);
+	expect_value(ring_post_send, wr->wr_id, (uint64_t)user_data);
+}
+
+/*
+ * setup__ring_new -- prepare a valid ring
+ */
+int
+setup__ring_new(void **rstate_ptr)
+{
+	static struct ring_test_state rstate = {0};
+
+	Ring_context.ops.post_send = ring_post_send;
+
+	/* configure mocks */
+	will_return(rpma_conn_get_ibv_qp, MOCK_OK);
+	will_return(rpma_conn_get_cq, MOCK_OK);
+	will_return_count(__wrap__test_malloc, MOCK_OK, RING_NEW_ALLOCS);
+
+	/* run test */
+	rstate.ring = NULL;
+	int ret = rpma_ring_new(MOCK_CONN, MOCK_SQ_ENTRIES, MOCK_CQ_ENTRIES,
+			&rstate.ring);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_non_null(rstate.ring);
+
+	*rstate_ptr = &rstate;
+
+	return 0;
+}
+
+/*
+ * teardown__ring_delete -- delete the ring
+ */
+int
+teardown__ring_delete(void **rstate_ptr)
+{
+	struct ring_test_state *rstate = *rstate_ptr;
+
+	/* run test */
+	int ret = rpma_ring_delete(&rstate->ring);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_null(rstate->ring);
+
+	return 0;
+}
@@ -0,0 +1,42 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * ring-common.h -- the rpma_ring unit tests common definitions
+ */
+
+#ifndef RING_COMMON_H
+#define RING_COMMON_H
+
+#include "cmocka_headers.h"
+#include "librpma.h"
+#include "test-common.h"
+
+#define MOCK_RPMA_CQ		(struct rpma_cq *)0xC301
+#define MOCK_RPMA_MR_REMOTE	(struct rpma_mr_remote *)0xC412
+#define MOCK_REMOTE_OFFSET	(size_t)0xC413
+#define MOCK_SQ_ENTRIES		3 /* rounded up to 4 */
+#define MOCK_SQ_SIZE		4
+#define MOCK_CQ_ENTRIES		4
+#define MOCK_USER_DATA(i)	(void *)(uintptr_t)(0xD000 + (i))
+
+/* the ring allocates: itself, sqes, wrs, sges, cqes and wcs */
+#define RING_NEW_ALLOCS		6
+
+/* the post_send() mock fails without pointing the failed work request */
+#define MOCK_POST_FAIL_ALL	(-2)
+#define MOCK_POST_OK		(-1)
+
+struct ring_test_state {
+	struct rpma_ring *ring;
+};
+
+int setup__ring_new(void **rstate_ptr);
+int teardown__ring_delete(void **rstate_ptr);
+
+void ring_fill_sqe(struct rpma_ring_sqe *sqe, enum rpma_ring_opcode opcode,
+		void *user_data);
+void expect_post(int fail_at);
+void expect_posted(enum ibv_wr_opcode opcode, void *user_data);
+
+#endif /* RING_COMMON_H */
@@ -0,0 +1,197 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * ring-cqes.c -- the rpma_ring_peek_cqes/cq_advance() unit tests
+ *
+ * APIs covered:
+ * - rpma_ring_peek_cqes()
+ * - rpma_ring_cq_advance()
+ */
+
+#include "ring-common.h"
+
+/*
+ * expect_completions -- expect a batch of num completions
+ */
+static void
+expect_completions(int ret, int num)
+{
+	will_return(rpma_cq_get_completions, ret);
+	will_return(rpma_cq_get_completions, num);
+	for (int i = 0; i < num; ++i)
+		will_return(rpma_cq_get_completions, MOCK_USER_DATA(i));
+}
+
+/*
+ * peek_cqes__invalid_args -- invalid combinations of the arguments
+ */
+static void
+peek_cqes__invalid_args(void **rstate_ptr)
+{
+	struct ring_test_state *rstate = *rstate_ptr;
+
+	/* run test */
+	struct rpma_completion *cqes = NULL;
+	uint32_t num = 0;
+	int ret1 = rpma_ring_peek_cqes(NULL, &cqes, &num);
+	int ret2 = rpma_ring_peek_cqes(rstate->ring, NULL, &num);
+	int ret3 = rpma_ring_peek_cqes(rstate->ring, &cqes, NULL);
+
+	/* verify the results */
+	assert_int_equal(ret1, RPMA_E_INVAL);
+	assert_int_equal(ret2, RPMA_E_INVAL);
+	assert_int_equal(ret3, RPMA_E_INVAL);
+	assert_null(cqes);
+	assert_int_equal(num, 0);
+}
+
+/*
+ * peek_cqes__get_completions_fail -- rpma_cq_get_completions() fails
+ * without any completion collected
+ */
+static void
+peek_cqes__get_completions_fail(void **rstate_ptr)
+{
+	struct ring_test_state *rstate = *rstate_ptr;
+	int errors[] = {
+		RPMA_E_NO_COMPLETION,
+		RPMA_E_PROVIDER,
+		RPMA_E_UNKNOWN,
+		RPMA_E_NOSUPP
+	};
+
+	for (int i = 0; i < 4; ++i) {
+		/* configure mocks */
+		expect_completions(errors[i], 0);
+
+		/* run test */
+		struct rpma_completion *cqes = NULL;
+		uint32_t num = 0;
+		int ret = rpma_ring_peek_cqes(rstate->ring, &cqes, &num);
+
+		/* verify the results */
+		assert_int_equal(ret, errors[i]);
+		assert_null(cqes);
+		assert_int_equal(num, 0);
+	}
+}
+
+/*
+ * peek_cqes__E_NOSUPP_partial -- the supported completions of a batch
+ * are handed over anyway
+ */
+static void
+peek_cqes__E_NOSUPP_partial(void **rstate_ptr)
+{
+	struct ring_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	expect_completions(RPMA_E_NOSUPP, 2);
+
+	/* run test */
+	struct rpma_completion *cqes = NULL;
+	uint32_t num = 0;
+	int ret = rpma_ring_peek_cqes(rstate->ring, &cqes, &num);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(num, 2);
+	assert_ptr_equal(cqes[0].op_context, MOCK_USER_DATA(0));
+	assert_ptr_equal(cqes[1].op_context, MOCK_USER_DATA(1));
+}
+
+/*
+ * peek_cqes__advance -- the ring is refilled only when all
+ * the completions have been consumed
+ */
+static void
+peek_cqes__advance(void **rstate_ptr)
+{
+	struct ring_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	expect_completions(MOCK_OK, 3);
+
+	/* run test */
+	struct rpma_completion *cqes = NULL;
+	uint32_t num = 0;
+	int ret = rpma_ring_peek_cqes(rstate->ring, &cqes, &num);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(num, 3);
+	for (uint32_t i = 0; i < num; ++i)
+		assert_ptr_equal(cqes[i].op_context, MOCK_USER_DATA(i));
+
+	/* run test - no polling */
+	assert_int_equal(rpma_ring_cq_advance(rstate->ring, 2), MOCK_OK);
+	ret = rpma_ring_peek_cqes(rstate->ring, &cqes, &num);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(num, 1);
+	assert_ptr_equal(cqes[0].op_context, MOCK_USER_DATA(2));
+
+	/* configure mocks */
+	expect_completions(MOCK_OK, 1);
+
+	/* run test - the ring is refilled */
+	assert_int_equal(rpma_ring_cq_advance(rstate->ring, 1), MOCK_OK);
+	ret = rpma_ring_peek_cqes(rstate->ring, &cqes, &num);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(num, 1);
+	assert_ptr_equal(cqes[0].op_context, MOCK_USER_DATA(0));
+}
+
+/*
+ * cq_advance__invalid_args -- invalid combinations of the arguments
+ */
+static void
+cq_advance__invalid_args(void **rstate_ptr)
+{
+	struct ring_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	expect_completions(MOCK_OK, 2);
+
+	/* run test */
+	struct rpma_completion *cqes = NULL;
+	uint32_t num = 0;
+	assert_int_equal(rpma_ring_peek_cqes(rstate->ring, &cqes, &num),
+			MOCK_OK);
+	int ret1 = rpma_ring_cq_advance(NULL, 1);
+	int ret2 = rpma_ring_cq_advance(rstate->ring, 3);
+
+	/* verify the results */
+	assert_int_equal(ret1, RPMA_E_INVAL);
+	assert_int_equal(ret2, RPMA_E_INVAL);
+	assert_int_equal(rpma_ring_cq_advance(rstate->ring, 0), MOCK_OK);
+	assert_int_equal(rpma_ring_cq_advance(rstate->ring, 2), MOCK_OK);
+}
+
+static const struct CMUnitTest tests_cqes[] = {
+	/* rpma_ring_peek_cqes() unit tests */
+	cmocka_unit_test_setup_teardown(peek_cqes__invalid_args,
+		setup__ring_new, teardown__ring_delete),
+	cmocka_unit_test_setup_teardown(peek_cqes__get_completions_fail,
+		setup__ring_new, teardown__ring_delete),
+	cmocka_unit_test_setup_teardown(peek_cqes__E_NOSUPP_partial,
+		setup__ring_new, teardown__ring_delete),
+	cmocka_unit_test_setup_teardown(peek_cqes__advance,
+		setup__ring_new, teardown__ring_delete),
+
+	/* rpma_ring_cq_advance() unit tests */
+	cmocka_unit_test_setup_teardown(cq_advance__invalid_args,
+		setup__ring_new, teardown__ring_delete),
+
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_cqes, NULL, NULL);
+}
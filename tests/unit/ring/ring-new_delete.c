@@ -0,0 +1,168 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * ring-new_delete.c -- the rpma_ring_new/delete() unit tests
+ *
+ * APIs covered:
+ * - rpma_ring_new()
+ * - rpma_ring_delete()
+ */
+
+#include "ring-common.h"
+
+/*
+ * new__invalid_args -- invalid combinations of the arguments
+ */
+static void
+new__invalid_args(void **unused)
+{
+	/* run test */
+	struct rpma_ring *ring = NULL;
+	int ret1 = rpma_ring_new(NULL, MOCK_SQ_ENTRIES, MOCK_CQ_ENTRIES,
+			&ring);
+	int ret2 = rpma_ring_new(MOCK_CONN, 0, MOCK_CQ_ENTRIES, &ring);
+	int ret3 = rpma_ring_new(MOCK_CONN, (1 << 16) + 1, MOCK_CQ_ENTRIES,
+			&ring);
+	int ret4 = rpma_ring_new(MOCK_CONN, MOCK_SQ_ENTRIES, 0, &ring);
+	int ret5 = rpma_ring_new(MOCK_CONN, MOCK_SQ_ENTRIES, (1 << 16) + 1,
+			&ring);
+	int ret6 = rpma_ring_new(MOCK_CONN, MOCK_SQ_ENTRIES, MOCK_CQ_ENTRIES,
+			NULL);
+
+	/* verify the results */
+	assert_int_equal(ret1, RPMA_E_INVAL);
+	assert_int_equal(ret2, RPMA_E_INVAL);
+	assert_int_equal(ret3, RPMA_E_INVAL);
+	assert_int_equal(ret4, RPMA_E_INVAL);
+	assert_int_equal(ret5, RPMA_E_INVAL);
+	assert_int_equal(ret6, RPMA_E_INVAL);
+	assert_null(ring);
+}
+
+/*
+ * new__get_ibv_qp_E_NOSUPP -- the connection works in a thread-safe mode
+ */
+static void
+new__get_ibv_qp_E_NOSUPP(void **unused)
+{
+	/* configure mocks */
+	will_return(rpma_conn_get_ibv_qp, RPMA_E_NOSUPP);
+
+	/* run test */
+	struct rpma_ring *ring = NULL;
+	int ret = rpma_ring_new(MOCK_CONN, MOCK_SQ_ENTRIES, MOCK_CQ_ENTRIES,
+			&ring);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NOSUPP);
+	assert_null(ring);
+}
+
+/*
+ * new__get_cq_E_NOSUPP -- the connection routes its completions
+ */
+static void
+new__get_cq_E_NOSUPP(void **unused)
+{
+	/* configure mocks */
+	will_return(rpma_conn_get_ibv_qp, MOCK_OK);
+	will_return(rpma_conn_get_cq, RPMA_E_NOSUPP);
+
+	/* run test */
+	struct rpma_ring *ring = NULL;
+	int ret = rpma_ring_new(MOCK_CONN, MOCK_SQ_ENTRIES, MOCK_CQ_ENTRIES,
+			&ring);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NOSUPP);
+	assert_null(ring);
+}
+
+/*
+ * new__malloc_ERRNO -- any of the malloc() calls fails with MOCK_ERRNO
+ */
+static void
+new__malloc_ERRNO(void **unused)
+{
+	for (int i = 0; i < RING_NEW_ALLOCS; ++i) {
+		/* configure mocks */
+		will_return(rpma_conn_get_ibv_qp, MOCK_OK);
+		will_return(rpma_conn_get_cq, MOCK_OK);
+		if (i > 0)
+			will_return_count(__wrap__test_malloc, MOCK_OK, i);
+		will_return(__wrap__test_malloc, MOCK_ERRNO);
+
+		/* run test */
+		struct rpma_ring *ring = NULL;
+		int ret = rpma_ring_new(MOCK_CONN, MOCK_SQ_ENTRIES,
+				MOCK_CQ_ENTRIES, &ring);
+
+		/* verify the results */
+		assert_int_equal(ret, RPMA_E_NOMEM);
+		assert_null(ring);
+	}
+}
+
+/*
+ * test_lifecycle -- happy day scenario
+ */
+static void
+test_lifecycle(void **unused)
+{
+	/*
+	 * the thing is done by setup__ring_new() and
+	 * teardown__ring_delete()
+	 */
+}
+
+/*
+ * delete__ring_ptr_NULL -- NULL ring_ptr is invalid
+ */
+static void
+delete__ring_ptr_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_ring_delete(NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * delete__ring_NULL -- NULL ring is valid - quick exit
+ */
+static void
+delete__ring_NULL(void **unused)
+{
+	/* run test */
+	struct rpma_ring *ring = NULL;
+	int ret = rpma_ring_delete(&ring);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+static const struct CMUnitTest tests_new_delete[] = {
+	/* rpma_ring_new() unit tests */
+	cmocka_unit_test(new__invalid_args),
+	cmocka_unit_test(new__get_ibv_qp_E_NOSUPP),
+	cmocka_unit_test(new__get_cq_E_NOSUPP),
+	cmocka_unit_test(new__malloc_ERRNO),
+
+	/* rpma_ring_new()/delete() lifecycle */
+	cmocka_unit_test_setup_teardown(test_lifecycle,
+		setup__ring_new, teardown__ring_delete),
+
+	/* rpma_ring_delete() unit tests */
+	cmocka_unit_test(delete__ring_ptr_NULL),
+	cmocka_unit_test(delete__ring_NULL),
+
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_new_delete, NULL, NULL);
+}
@@ -0,0 +1,294 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * ring-submit.c -- the rpma_ring_get_sqe/submit() unit tests
+ *
+ * APIs covered:
+ * - rpma_ring_get_sqe()
+ * - rpma_ring_submit()
+ */
+
+#include "ring-common.h"
+
+/*
+ * ring_get_sqe -- get and fill the next descriptor
+ */
+static struct rpma_ring_sqe *
+ring_get_sqe(struct rpma_ring *ring, enum rpma_ring_opcode opcode,
+		void *user_data)
+{
+	struct rpma_ring_sqe *sqe = NULL;
+	assert_int_equal(rpma_ring_get_sqe(ring, &sqe), MOCK_OK);
+	assert_non_null(sqe);
+	ring_fill_sqe(sqe, opcode, user_data);
+
+	return sqe;
+}
+
+/*
+ * get_sqe__invalid_args -- invalid combinations of the arguments
+ */
+static void
+get_sqe__invalid_args(void **rstate_ptr)
+{
+	struct ring_test_state *rstate = *rstate_ptr;
+
+	/* run test */
+	struct rpma_ring_sqe *sqe = NULL;
+	int ret1 = rpma_ring_get_sqe(NULL, &sqe);
+	int ret2 = rpma_ring_get_sqe(rstate->ring, NULL);
+
+	/* verify the results */
+	assert_int_equal(ret1, RPMA_E_INVAL);
+	assert_int_equal(ret2, RPMA_E_INVAL);
+	assert_null(sqe);
+}
+
+/*
+ * get_sqe__full -- the submission ring holds the rounded-up number
+ * of the descriptors
+ */
+static void
+get_sqe__full(void **rstate_ptr)
+{
+	struct ring_test_state *rstate = *rstate_ptr;
+	struct rpma_ring_sqe *sqes[MOCK_SQ_SIZE];
+
+	/* run test */
+	for (int i = 0; i < MOCK_SQ_SIZE; ++i)
+		sqes[i] = ring_get_sqe(rstate->ring, RPMA_RING_OP_READ,
+				MOCK_USER_DATA(i));
+
+	struct rpma_ring_sqe *sqe = NULL;
+	int ret = rpma_ring_get_sqe(rstate->ring, &sqe);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_AGAIN);
+	assert_null(sqe);
+	for (int i = 1; i < MOCK_SQ_SIZE; ++i)
+		assert_ptr_equal(sqes[i], sqes[i - 1] + 1);
+}
+
+/*
+ * submit__ring_NULL -- NULL ring is invalid
+ */
+static void
+submit__ring_NULL(void **unused)
+{
+	/* run test */
+	uint32_t submitted = 0;
+	int ret = rpma_ring_submit(NULL, &submitted);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * submit__empty -- nothing to submit
+ */
+static void
+submit__empty(void **rstate_ptr)
+{
+	struct ring_test_state *rstate = *rstate_ptr;
+
+	/* run test */
+	uint32_t submitted = 1;
+	int ret = rpma_ring_submit(rstate->ring, &submitted);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(submitted, 0);
+}
+
+/*
+ * submit__chain -- all the descriptors are posted as a single chain
+ * and the ring can be reused afterwards
+ */
+static void
+submit__chain(void **rstate_ptr)
+{
+	struct ring_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	ring_get_sqe(rstate->ring, RPMA_RING_OP_READ, MOCK_USER_DATA(0));
+	ring_get_sqe(rstate->ring, RPMA_RING_OP_WRITE, MOCK_USER_DATA(1));
+	ring_get_sqe(rstate->ring, RPMA_RING_OP_WRITE_WITH_IMM,
+			MOCK_USER_DATA(2));
+	ring_get_sqe(rstate->ring, RPMA_RING_OP_SEND, MOCK_USER_DATA(3));
+	expect_post(MOCK_POST_OK);
+	expect_posted(IBV_WR_RDMA_READ, MOCK_USER_DATA(0));
+	expect_posted(IBV_WR_RDMA_WRITE, MOCK_USER_DATA(1));
+	expect_posted(IBV_WR_RDMA_WRITE_WITH_IMM, MOCK_USER_DATA(2));
+	expect_posted(IBV_WR_SEND, MOCK_USER_DATA(3));
+	expect_value(rpma_conn_reads_posted, conn, MOCK_CONN);
+
+	/* run test */
+	uint32_t submitted = 0;
+	int ret = rpma_ring_submit(rstate->ring, &submitted);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(submitted, 4);
+
+	/* configure mocks */
+	ring_get_sqe(rstate->ring, RPMA_RING_OP_SEND_WITH_IMM,
+			MOCK_USER_DATA(4));
+	expect_post(MOCK_POST_OK);
+	expect_posted(IBV_WR_SEND_WITH_IMM, MOCK_USER_DATA(4));
+
+	/* run test */
+	ret = rpma_ring_submit(rstate->ring, NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * submit__invalid_sqe -- the descriptors preceding an invalid one are
+ * posted and the invalid one is dropped
+ */
+static void
+submit__invalid_sqe(void **rstate_ptr)
+{
+	struct ring_test_state *rstate = *rstate_ptr;
+	struct rpma_ring_sqe invalid[6];
+
+	for (int i = 0; i < 6; ++i)
+		ring_fill_sqe(&invalid[i], RPMA_RING_OP_WRITE,
+				MOCK_USER_DATA(1));
+	invalid[0].flags = 0;
+	invalid[1].len = (size_t)UINT32_MAX + 1;
+	invalid[2].opcode = (enum rpma_ring_opcode)(-1);
+	invalid[3].remote = NULL;
+	invalid[4].opcode = RPMA_RING_OP_SEND;
+	invalid[4].local = NULL;
+	invalid[5].opcode = RPMA_RING_OP_READ;
+	invalid[5].local = NULL;
+
+	for (int i = 0; i < 6; ++i) {
+		/* configure mocks */
+		ring_get_sqe(rstate->ring, RPMA_RING_OP_READ,
+				MOCK_USER_DATA(0));
+		*ring_get_sqe(rstate->ring, RPMA_RING_OP_WRITE,
+				MOCK_USER_DATA(1)) = invalid[i];
+		ring_get_sqe(rstate->ring, RPMA_RING_OP_SEND,
+				MOCK_USER_DATA(2));
+		expect_post(MOCK_POST_OK);
+		expect_posted(IBV_WR_RDMA_READ, MOCK_USER_DATA(0));
+		expect_value(rpma_conn_reads_posted, conn, MOCK_CONN);
+
+		/* run test */
+		uint32_t submitted = 0;
+		int ret = rpma_ring_submit(rstate->ring, &submitted);
+
+		/* verify the results */
+		assert_int_equal(ret, RPMA_E_INVAL);
+		assert_int_equal(submitted, 1);
+
+		/* configure mocks */
+		expect_post(MOCK_POST_OK);
+		expect_posted(IBV_WR_SEND, MOCK_USER_DATA(2));
+
+		/* run test */
+		ret = rpma_ring_submit(rstate->ring, &submitted);
+
+		/* verify the results */
+		assert_int_equal(ret, MOCK_OK);
+		assert_int_equal(submitted, 1);
+	}
+}
+
+/*
+ * submit__post_send_ERRNO -- ibv_post_send() fails at the second work
+ * request and the remaining descriptors are posted again
+ */
+static void
+submit__post_send_ERRNO(void **rstate_ptr)
+{
+	struct ring_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	ring_get_sqe(rstate->ring, RPMA_RING_OP_READ, MOCK_USER_DATA(0));
+	ring_get_sqe(rstate->ring, RPMA_RING_OP_WRITE, MOCK_USER_DATA(1));
+	ring_get_sqe(rstate->ring, RPMA_RING_OP_SEND, MOCK_USER_DATA(2));
+	expect_post(1);
+	expect_posted(IBV_WR_RDMA_READ, MOCK_USER_DATA(0));
+	expect_value(rpma_conn_reads_posted, conn, MOCK_CONN);
+
+	/* run test */
+	uint32_t submitted = 0;
+	int ret = rpma_ring_submit(rstate->ring, &submitted);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_int_equal(submitted, 1);
+
+	/* configure mocks */
+	expect_post(MOCK_POST_OK);
+	expect_posted(IBV_WR_RDMA_WRITE, MOCK_USER_DATA(1));
+	expect_posted(IBV_WR_SEND, MOCK_USER_DATA(2));
+
+	/* run test */
+	ret = rpma_ring_submit(rstate->ring, &submitted);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(submitted, 2);
+}
+
+/*
+ * submit__post_send_ERRNO_no_bad_wr -- ibv_post_send() fails without
+ * pointing the failed work request so all the descriptors stay in the ring
+ */
+static void
+submit__post_send_ERRNO_no_bad_wr(void **rstate_ptr)
+{
+	struct ring_test_state *rstate = *rstate_ptr;
+
+	/* configure mocks */
+	for (int i = 0; i < MOCK_SQ_SIZE; ++i)
+		ring_get_sqe(rstate->ring, RPMA_RING_OP_READ,
+				MOCK_USER_DATA(i));
+	expect_post(MOCK_POST_FAIL_ALL);
+
+	/* run test */
+	uint32_t submitted = 1;
+	int ret = rpma_ring_submit(rstate->ring, &submitted);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_int_equal(submitted, 0);
+
+	struct rpma_ring_sqe *sqe = NULL;
+	assert_int_equal(rpma_ring_get_sqe(rstate->ring, &sqe), RPMA_E_AGAIN);
+}
+
+static const struct CMUnitTest tests_submit[] = {
+	/* rpma_ring_get_sqe() unit tests */
+	cmocka_unit_test_setup_teardown(get_sqe__invalid_args,
+		setup__ring_new, teardown__ring_delete),
+	cmocka_unit_test_setup_teardown(get_sqe__full,
+		setup__ring_new, teardown__ring_delete),
+
+	/* rpma_ring_submit() unit tests */
+	cmocka_unit_test(submit__ring_NULL),
+	cmocka_unit_test_setup_teardown(submit__empty,
+		setup__ring_new, teardown__ring_delete),
+	cmocka_unit_test_setup_teardown(submit__chain,
+		setup__ring_new, teardown__ring_delete),
+	cmocka_unit_test_setup_teardown(submit__invalid_sqe,
+		setup__ring_new, teardown__ring_delete),
+	cmocka_unit_test_setup_teardown(submit__post_send_ERRNO,
+		setup__ring_new, teardown__ring_delete),
+	cmocka_unit_test_setup_teardown(submit__post_send_ERRNO_no_bad_wr,
+		setup__ring_new, teardown__ring_delete),
+
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_submit, NULL, NULL);
+}
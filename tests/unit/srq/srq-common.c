@@ -0,0 +1,61 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * srq-common.c -- the rpma_srq unit tests common functions
+ */
+
+#include "mocks-ibverbs.h"
+#include "mocks-rpma-cq.h"
+#include "srq-common.h"
+
+/*
+ * setup__srq_new -- prepare a valid rpma_srq object
+ */
+int
+setup__srq_new(void **srq_ptr)
+{
+	/* configure mocks */
+	expect_value(rpma_peer_create_srq, size, MOCK_SRQ_SIZE);
+	will_return(rpma_peer_create_srq, MOCK_IBV_SRQ);
+	expect_value(rpma_cq_new, cqe, MOCK_SRQ_SIZE);
+	expect_value(rpma_cq_new, comp_vector, 0);
+	will_return(rpma_cq_new, MOCK_RPMA_CQ);
+	will_return(__wrap__test_malloc, MOCK_OK);
+
+	/* run test */
+	struct rpma_srq *srq = NULL;
+	int ret = rpma_srq_new(MOCK_PEER, MOCK_SRQ_SIZE, &srq);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_non_null(srq);
+
+	*srq_ptr = srq;
+
+	return 0;
+}
+
+/*
+ * teardown__srq_delete -- delete the rpma_srq object
+ */
+int
+teardown__srq_delete(void **srq_ptr)
+{
+	struct rpma_srq *srq = *srq_ptr;
+
+	/* configure mocks */
+	will_return(ibv_destroy_srq, MOCK_OK);
+	will_return(rpma_cq_delete, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_srq_delete(&srq);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_null(srq);
+
+	*srq_ptr = NULL;
+
+	return 0;
+}
@@ -0,0 +1,20 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * srq-common.h -- the rpma_srq unit tests common definitions
+ */
+
+#ifndef SRQ_COMMON_H
+#define SRQ_COMMON_H
+
+#include "cmocka_headers.h"
+#include "test-common.h"
+#include "srq.h"
+
+#define MOCK_SRQ_SIZE		(uint32_t)0x5A
+
+int setup__srq_new(void **srq_ptr);
+int teardown__srq_delete(void **srq_ptr);
+
+#endif /* SRQ_COMMON_H */
@@ -0,0 +1,219 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * srq-completion.c -- the shared receive queue completion unit tests
+ *
+ * APIs covered:
+ * - rpma_srq_get_completion_fd()
+ * - rpma_srq_completion_wait()
+ * - rpma_srq_completion_get()
+ */
+
+#include <string.h>
+
+#include "mocks-rpma-cq.h"
+#include "srq-common.h"
+
+/*
+ * get_completion_fd__srq_NULL -- NULL srq is invalid
+ */
+static void
+get_completion_fd__srq_NULL(void **unused)
+{
+	/* run test */
+	int fd = 0;
+	int ret = rpma_srq_get_completion_fd(NULL, &fd);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+	assert_int_equal(fd, 0);
+}
+
+/*
+ * get_completion_fd__fd_NULL -- NULL fd is invalid
+ */
+static void
+get_completion_fd__fd_NULL(void **srq_ptr)
+{
+	struct rpma_srq *srq = *srq_ptr;
+
+	/* run test */
+	int ret = rpma_srq_get_completion_fd(srq, NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * get_completion_fd__success -- happy day scenario
+ */
+static void
+get_completion_fd__success(void **srq_ptr)
+{
+	struct rpma_srq *srq = *srq_ptr;
+
+	/* configure mocks */
+	will_return(rpma_cq_get_fd, MOCK_COMPLETION_FD);
+
+	/* run test */
+	int fd = 0;
+	int ret = rpma_srq_get_completion_fd(srq, &fd);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(fd, MOCK_COMPLETION_FD);
+}
+
+/*
+ * completion_wait__srq_NULL -- NULL srq is invalid
+ */
+static void
+completion_wait__srq_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_srq_completion_wait(NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * completion_wait__E_NO_COMPLETION -- rpma_cq_wait() fails with
+ * RPMA_E_NO_COMPLETION
+ */
+static void
+completion_wait__E_NO_COMPLETION(void **srq_ptr)
+{
+	struct rpma_srq *srq = *srq_ptr;
+
+	/* configure mocks */
+	will_return(rpma_cq_wait, RPMA_E_NO_COMPLETION);
+
+	/* run test */
+	int ret = rpma_srq_completion_wait(srq);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NO_COMPLETION);
+}
+
+/*
+ * completion_wait__success -- happy day scenario
+ */
+static void
+completion_wait__success(void **srq_ptr)
+{
+	struct rpma_srq *srq = *srq_ptr;
+
+	/* configure mocks */
+	will_return(rpma_cq_wait, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_srq_completion_wait(srq);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * completion_get__srq_NULL -- NULL srq is invalid
+ */
+static void
+completion_get__srq_NULL(void **unused)
+{
+	/* run test */
+	struct rpma_completion cmpl;
+	int ret = rpma_srq_completion_get(NULL, &cmpl);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * completion_get__cmpl_NULL -- NULL cmpl is invalid
+ */
+static void
+completion_get__cmpl_NULL(void **srq_ptr)
+{
+	struct rpma_srq *srq = *srq_ptr;
+
+	/* run test */
+	int ret = rpma_srq_completion_get(srq, NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * completion_get__E_NO_COMPLETION -- rpma_cq_get_completion() fails with
+ * RPMA_E_NO_COMPLETION
+ */
+static void
+completion_get__E_NO_COMPLETION(void **srq_ptr)
+{
+	struct rpma_srq *srq = *srq_ptr;
+
+	/* configure mocks */
+	will_return(rpma_cq_get_completion, RPMA_E_NO_COMPLETION);
+
+	/* run test */
+	struct rpma_completion cmpl;
+	int ret = rpma_srq_completion_get(srq, &cmpl);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NO_COMPLETION);
+}
+
+/*
+ * completion_get__success -- happy day scenario
+ */
+static void
+completion_get__success(void **srq_ptr)
+{
+	struct rpma_srq *srq = *srq_ptr;
+
+	/* configure mocks */
+	will_return(rpma_cq_get_completion, MOCK_OK);
+
+	/* run test */
+	struct rpma_completion cmpl;
+	int ret = rpma_srq_completion_get(srq, &cmpl);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_memory_equal(&cmpl, MOCK_COMPLETION,
+		sizeof(struct rpma_completion));
+}
+
+static const struct CMUnitTest tests_completion[] = {
+	/* rpma_srq_get_completion_fd() unit tests */
+	cmocka_unit_test(get_completion_fd__srq_NULL),
+	cmocka_unit_test_setup_teardown(get_completion_fd__fd_NULL,
+		setup__srq_new, teardown__srq_delete),
+	cmocka_unit_test_setup_teardown(get_completion_fd__success,
+		setup__srq_new, teardown__srq_delete),
+
+	/* rpma_srq_completion_wait() unit tests */
+	cmocka_unit_test(completion_wait__srq_NULL),
+	cmocka_unit_test_setup_teardown(completion_wait__E_NO_COMPLETION,
+		setup__srq_new, teardown__srq_delete),
+	cmocka_unit_test_setup_teardown(completion_wait__success,
+		setup__srq_new, teardown__srq_delete),
+
+	/* rpma_srq_completion_get() unit tests */
+	cmocka_unit_test(completion_get__srq_NULL),
+	cmocka_unit_test_setup_teardown(completion_get__cmpl_NULL,
+		setup__srq_new, teardown__srq_delete),
+	cmocka_unit_test_setup_teardown(completion_get__E_NO_COMPLETION,
+		setup__srq_new, teardown__srq_delete),
+	cmocka_unit_test_setup_teardown(completion_get__success,
+		setup__srq_new, teardown__srq_delete),
+
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_completion, NULL, NULL);
+}
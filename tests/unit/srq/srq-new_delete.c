@@ -0,0 +1,242 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * srq-new_delete.c -- the rpma_srq_new/delete() unit tests
+ *
+ * APIs covered:
+ * - rpma_srq_new()
+ * - rpma_srq_delete()
+ */
+
+#include "mocks-ibverbs.h"
+#include "mocks-rpma-cq.h"
+#include "srq-common.h"
+
+/*
+ * new__peer_NULL -- NULL peer is invalid
+ */
+static void
+new__peer_NULL(void **unused)
+{
+	/* run test */
+	struct rpma_srq *srq = NULL;
+	int ret = rpma_srq_new(NULL, MOCK_SRQ_SIZE, &srq);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+	assert_null(srq);
+}
+
+/*
+ * new__size_0 -- 0 size is invalid
+ */
+static void
+new__size_0(void **unused)
+{
+	/* run test */
+	struct rpma_srq *srq = NULL;
+	int ret = rpma_srq_new(MOCK_PEER, 0, &srq);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+	assert_null(srq);
+}
+
+/*
+ * new__srq_ptr_NULL -- NULL srq_ptr is invalid
+ */
+static void
+new__srq_ptr_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_srq_new(MOCK_PEER, MOCK_SRQ_SIZE, NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * new__create_srq_E_PROVIDER -- rpma_peer_create_srq() fails with
+ * RPMA_E_PROVIDER
+ */
+static void
+new__create_srq_E_PROVIDER(void **unused)
+{
+	/* configure mocks */
+	expect_value(rpma_peer_create_srq, size, MOCK_SRQ_SIZE);
+	will_return(rpma_peer_create_srq, NULL);
+	will_return(rpma_peer_create_srq, RPMA_E_PROVIDER);
+
+	/* run test */
+	struct rpma_srq *srq = NULL;
+	int ret = rpma_srq_new(MOCK_PEER, MOCK_SRQ_SIZE, &srq);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(srq);
+}
+
+/*
+ * new__cq_new_E_PROVIDER -- rpma_cq_new() fails with RPMA_E_PROVIDER
+ */
+static void
+new__cq_new_E_PROVIDER(void **unused)
+{
+	/* configure mocks */
+	expect_value(rpma_peer_create_srq, size, MOCK_SRQ_SIZE);
+	will_return(rpma_peer_create_srq, MOCK_IBV_SRQ);
+	expect_value(rpma_cq_new, cqe, MOCK_SRQ_SIZE);
+	expect_value(rpma_cq_new, comp_vector, 0);
+	will_return(rpma_cq_new, NULL);
+	will_return(rpma_cq_new, RPMA_E_PROVIDER);
+	will_return(rpma_cq_new, MOCK_ERRNO);
+	will_return(ibv_destroy_srq, MOCK_OK);
+
+	/* run test */
+	struct rpma_srq *srq = NULL;
+	int ret = rpma_srq_new(MOCK_PEER, MOCK_SRQ_SIZE, &srq);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(srq);
+}
+
+/*
+ * new__malloc_ERRNO -- malloc() fails with MOCK_ERRNO
+ */
+static void
+new__malloc_ERRNO(void **unused)
+{
+	/* configure mocks */
+	expect_value(rpma_peer_create_srq, size, MOCK_SRQ_SIZE);
+	will_return(rpma_peer_create_srq, MOCK_IBV_SRQ);
+	expect_value(rpma_cq_new, cqe, MOCK_SRQ_SIZE);
+	expect_value(rpma_cq_new, comp_vector, 0);
+	will_return(rpma_cq_new, MOCK_RPMA_CQ);
+	will_return(__wrap__test_malloc, MOCK_ERRNO);
+	will_return(rpma_cq_delete, MOCK_OK);
+	will_return(ibv_destroy_srq, MOCK_OK);
+
+	/* run test */
+	struct rpma_srq *srq = NULL;
+	int ret = rpma_srq_new(MOCK_PEER, MOCK_SRQ_SIZE, &srq);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NOMEM);
+	assert_null(srq);
+}
+
+/*
+ * test_lifecycle -- happy day scenario
+ */
+static void
+test_lifecycle(void **unused)
+{
+	/*
+	 * the thing is done by setup__srq_new() and teardown__srq_delete()
+	 */
+}
+
+/*
+ * delete__srq_ptr_NULL -- NULL srq_ptr is invalid
+ */
+static void
+delete__srq_ptr_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_srq_delete(NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * delete__srq_NULL -- NULL srq is valid - quick exit
+ */
+static void
+delete__srq_NULL(void **unused)
+{
+	/* run test */
+	struct rpma_srq *srq = NULL;
+	int ret = rpma_srq_delete(&srq);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * delete__destroy_srq_ERRNO -- ibv_destroy_srq() fails with MOCK_ERRNO
+ */
+static void
+delete__destroy_srq_ERRNO(void **unused)
+{
+	struct rpma_srq *srq = NULL;
+
+	/* WA for cmocka/issues#47 */
+	assert_int_equal(setup__srq_new((void **)&srq), 0);
+
+	/* configure mocks */
+	will_return(ibv_destroy_srq, MOCK_ERRNO);
+	will_return(rpma_cq_delete, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_srq_delete(&srq);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(srq);
+}
+
+/*
+ * delete__cq_delete_E_PROVIDER -- rpma_cq_delete() fails with
+ * RPMA_E_PROVIDER
+ */
+static void
+delete__cq_delete_E_PROVIDER(void **unused)
+{
+	struct rpma_srq *srq = NULL;
+
+	/* WA for cmocka/issues#47 */
+	assert_int_equal(setup__srq_new((void **)&srq), 0);
+
+	/* configure mocks */
+	will_return(ibv_destroy_srq, MOCK_OK);
+	will_return(rpma_cq_delete, RPMA_E_PROVIDER);
+	will_return(rpma_cq_delete, MOCK_ERRNO);
+
+	/* run test */
+	int ret = rpma_srq_delete(&srq);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(srq);
+}
+
+static const struct CMUnitTest tests_new_delete[] = {
+	/* rpma_srq_new() unit tests */
+	cmocka_unit_test(new__peer_NULL),
+	cmocka_unit_test(new__size_0),
+	cmocka_unit_test(new__srq_ptr_NULL),
+	cmocka_unit_test(new__create_srq_E_PROVIDER),
+	cmocka_unit_test(new__cq_new_E_PROVIDER),
+	cmocka_unit_test(new__malloc_ERRNO),
+
+	/* rpma_srq_new()/delete() lifecycle */
+	cmocka_unit_test_setup_teardown(test_lifecycle,
+		setup__srq_new, teardown__srq_delete),
+
+	/* rpma_srq_delete() unit tests */
+	cmocka_unit_test(delete__srq_ptr_NULL),
+	cmocka_unit_test(delete__srq_NULL),
+	cmocka_unit_test(delete__destroy_srq_ERRNO),
+	cmocka_unit_test(delete__cq_delete_E_PROVIDER),
+
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_new_delete, NULL, NULL);
+}
@@ -0,0 +1,122 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * srq-recv.c -- the rpma_srq_recv() unit tests
+ *
+ * API covered:
+ * - rpma_srq_recv()
+ */
+
+#include "mocks-ibverbs.h"
+#include "srq-common.h"
+
+#define MOCK_SRQ		(struct rpma_srq *)0x5A9C
+
+/*
+ * recv__srq_NULL -- NULL srq is invalid
+ */
+static void
+recv__srq_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_srq_recv(NULL, MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_LEN, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * recv__dst_NULL_offset_not_NULL -- NULL dst and not NULL offset
+ * is invalid
+ */
+static void
+recv__dst_NULL_offset_not_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_srq_recv(MOCK_SRQ, NULL, MOCK_LOCAL_OFFSET, 0,
+			MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * recv__dst_NULL_len_not_NULL -- NULL dst and not NULL len is invalid
+ */
+static void
+recv__dst_NULL_len_not_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_srq_recv(MOCK_SRQ, NULL, 0, MOCK_LEN,
+			MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * recv__success -- happy day scenario
+ */
+static void
+recv__success(void **srq_ptr)
+{
+	struct rpma_srq *srq = *srq_ptr;
+
+	/* configure mocks */
+	expect_value(rpma_mr_srq_recv, srq, MOCK_IBV_SRQ);
+	expect_value(rpma_mr_srq_recv, dst, MOCK_RPMA_MR_LOCAL);
+	expect_value(rpma_mr_srq_recv, offset, MOCK_LOCAL_OFFSET);
+	expect_value(rpma_mr_srq_recv, len, MOCK_LEN);
+	expect_value(rpma_mr_srq_recv, op_context, MOCK_OP_CONTEXT);
+	will_return(rpma_mr_srq_recv, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_srq_recv(srq, MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_LEN, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * recv__E_PROVIDER -- rpma_mr_srq_recv() fails with RPMA_E_PROVIDER
+ */
+static void
+recv__E_PROVIDER(void **srq_ptr)
+{
+	struct rpma_srq *srq = *srq_ptr;
+
+	/* configure mocks */
+	expect_value(rpma_mr_srq_recv, srq, MOCK_IBV_SRQ);
+	expect_value(rpma_mr_srq_recv, dst, NULL);
+	expect_value(rpma_mr_srq_recv, offset, 0);
+	expect_value(rpma_mr_srq_recv, len, 0);
+	expect_value(rpma_mr_srq_recv, op_context, MOCK_OP_CONTEXT);
+	will_return(rpma_mr_srq_recv, RPMA_E_PROVIDER);
+
+	/* run test */
+	int ret = rpma_srq_recv(srq, NULL, 0, 0, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+}
+
+static const struct CMUnitTest tests_recv[] = {
+	/* rpma_srq_recv() unit tests */
+	cmocka_unit_test(recv__srq_NULL),
+	cmocka_unit_test(recv__dst_NULL_offset_not_NULL),
+	cmocka_unit_test(recv__dst_NULL_len_not_NULL),
+	cmocka_unit_test_setup_teardown(recv__success,
+		setup__srq_new, teardown__srq_delete),
+	cmocka_unit_test_setup_teardown(recv__E_PROVIDER,
+		setup__srq_new, teardown__srq_delete),
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_recv, NULL, NULL);
+}
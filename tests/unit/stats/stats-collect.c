@@ -0,0 +1,243 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * stats-collect.c -- the statistics collecting unit tests
+ *
+ * APIs covered:
+ * - rpma_conn_stats_posting()
+ * - rpma_conn_stats_posted()
+ * - rpma_conn_stats_polled()
+ * - rpma_conn_stats_woken()
+ * - rpma_conn_stats_get()
+ */
+
+#include "stats-common.h"
+
+/*
+ * posted__counters -- only the successfully posted operations are counted
+ */
+static void
+posted__counters(void **sstate_ptr)
+{
+	struct stats_test_state *sstate = *sstate_ptr;
+
+	/* run test */
+	stats_post(sstate->stats, RPMA_OP_READ, MOCK_LEN,
+			RPMA_F_COMPLETION_ALWAYS, MOCK_OK);
+	stats_post(sstate->stats, RPMA_OP_FLUSH, MOCK_LEN,
+			RPMA_F_COMPLETION_ON_ERROR, MOCK_OK);
+	stats_post(sstate->stats, RPMA_OP_SEND, MOCK_LEN,
+			RPMA_F_COMPLETION_ALWAYS, RPMA_E_PROVIDER);
+
+	/* verify the results */
+	struct rpma_stats snapshot;
+	rpma_conn_stats_get(sstate->stats, &snapshot);
+	assert_int_equal(snapshot.posts, 3);
+	assert_int_equal(snapshot.ops[RPMA_OP_READ], 1);
+	assert_int_equal(snapshot.bytes[RPMA_OP_READ], MOCK_LEN);
+	assert_int_equal(snapshot.ops[RPMA_OP_FLUSH], 1);
+	assert_int_equal(snapshot.bytes[RPMA_OP_FLUSH], MOCK_LEN);
+	assert_int_equal(snapshot.ops[RPMA_OP_SEND], 0);
+	assert_int_equal(snapshot.bytes[RPMA_OP_SEND], 0);
+}
+
+/*
+ * polled__counters -- the results of the polling are counted
+ */
+static void
+polled__counters(void **sstate_ptr)
+{
+	struct stats_test_state *sstate = *sstate_ptr;
+	struct rpma_completion cmpl = {0};
+
+	/* run test */
+	rpma_conn_stats_polled(sstate->stats, &cmpl, RPMA_E_NO_COMPLETION);
+	rpma_conn_stats_polled(sstate->stats, &cmpl, RPMA_E_NO_COMPLETION);
+	rpma_conn_stats_polled(sstate->stats, &cmpl, RPMA_E_PROVIDER);
+	rpma_conn_stats_polled(sstate->stats, &cmpl, RPMA_E_NOSUPP);
+	stats_complete(sstate->stats, RPMA_OP_WRITE, IBV_WC_SUCCESS);
+	stats_complete(sstate->stats, RPMA_OP_WRITE, IBV_WC_REM_ACCESS_ERR);
+	stats_complete(sstate->stats, RPMA_OP_WRITE, IBV_WC_WR_FLUSH_ERR);
+
+	/* verify the results */
+	struct rpma_stats snapshot;
+	rpma_conn_stats_get(sstate->stats, &snapshot);
+	assert_int_equal(snapshot.empty_polls, 2);
+	assert_int_equal(snapshot.cqes, 4);
+	assert_int_equal(snapshot.error_cqes, 2);
+	assert_int_equal(snapshot.flushed_cqes, 1);
+}
+
+/*
+ * woken__counters -- only the successful wake-ups are counted
+ */
+static void
+woken__counters(void **sstate_ptr)
+{
+	struct stats_test_state *sstate = *sstate_ptr;
+
+	/* run test */
+	rpma_conn_stats_woken(sstate->stats, MOCK_OK);
+	rpma_conn_stats_woken(sstate->stats, RPMA_E_NO_COMPLETION);
+	rpma_conn_stats_woken(sstate->stats, MOCK_OK);
+
+	/* verify the results */
+	struct rpma_stats snapshot;
+	rpma_conn_stats_get(sstate->stats, &snapshot);
+	assert_int_equal(snapshot.cq_wakeups, 2);
+}
+
+/*
+ * latency__disabled -- the latency is not collected if it is not requested
+ */
+static void
+latency__disabled(void **sstate_ptr)
+{
+	struct stats_test_state *sstate = *sstate_ptr;
+	assert_false(rpma_conn_stats_latency(sstate->stats));
+
+	/* run test */
+	stats_post(sstate->stats, RPMA_OP_READ, MOCK_LEN,
+			RPMA_F_COMPLETION_ALWAYS, MOCK_OK);
+	stats_complete(sstate->stats, RPMA_OP_READ, IBV_WC_SUCCESS);
+
+	/* verify the results */
+	struct rpma_stats snapshot;
+	rpma_conn_stats_get(sstate->stats, &snapshot);
+	assert_int_equal(stats_latency_samples(&snapshot, RPMA_OP_READ), 0);
+}
+
+/*
+ * latency__matched -- the completions are matched with the signaled
+ * operations of the respective queue in the posting order
+ */
+static void
+latency__matched(void **sstate_ptr)
+{
+	struct stats_test_state *sstate = *sstate_ptr;
+
+	/* run test */
+	stats_post(sstate->stats, RPMA_OP_WRITE, MOCK_LEN,
+			RPMA_F_COMPLETION_ON_ERROR, MOCK_OK);
+	stats_post(sstate->stats, RPMA_OP_RECV, MOCK_LEN,
+			RPMA_F_COMPLETION_ALWAYS, MOCK_OK);
+	stats_post(sstate->stats, RPMA_OP_FLUSH, MOCK_LEN,
+			RPMA_F_COMPLETION_ALWAYS, MOCK_OK);
+	stats_post(sstate->stats, RPMA_OP_SEND, MOCK_LEN,
+			RPMA_F_COMPLETION_ALWAYS, MOCK_OK);
+	/* a flush may be completed as a read (APM) */
+	stats_complete(sstate->stats, RPMA_OP_READ, IBV_WC_SUCCESS);
+	stats_complete(sstate->stats, RPMA_OP_RECV_RDMA_WITH_IMM,
+			IBV_WC_SUCCESS);
+	stats_complete(sstate->stats, RPMA_OP_SEND, IBV_WC_SUCCESS);
+
+	/* verify the results */
+	struct rpma_stats snapshot;
+	rpma_conn_stats_get(sstate->stats, &snapshot);
+	assert_int_equal(stats_latency_samples(&snapshot, RPMA_OP_WRITE), 0);
+	assert_int_equal(stats_latency_samples(&snapshot, RPMA_OP_READ), 0);
+	assert_int_equal(stats_latency_samples(&snapshot, RPMA_OP_FLUSH), 1);
+	assert_int_equal(stats_latency_samples(&snapshot, RPMA_OP_RECV), 1);
+	assert_int_equal(stats_latency_samples(&snapshot, RPMA_OP_SEND), 1);
+	assert_true(snapshot.ticks_per_sec > 0);
+}
+
+/*
+ * latency__post_failed -- the timestamp of the operation which has not been
+ * posted is dropped
+ */
+static void
+latency__post_failed(void **sstate_ptr)
+{
+	struct stats_test_state *sstate = *sstate_ptr;
+
+	/* run test */
+	stats_post(sstate->stats, RPMA_OP_WRITE, MOCK_LEN,
+			RPMA_F_COMPLETION_ALWAYS, RPMA_E_PROVIDER);
+	stats_post(sstate->stats, RPMA_OP_READ, MOCK_LEN,
+			RPMA_F_COMPLETION_ALWAYS, MOCK_OK);
+	stats_complete(sstate->stats, RPMA_OP_READ, IBV_WC_SUCCESS);
+
+	/* verify the results */
+	struct rpma_stats snapshot;
+	rpma_conn_stats_get(sstate->stats, &snapshot);
+	assert_int_equal(stats_latency_samples(&snapshot, RPMA_OP_WRITE), 0);
+	assert_int_equal(stats_latency_samples(&snapshot, RPMA_OP_READ), 1);
+}
+
+/*
+ * latency__lost_error -- the latency is not collected any longer after
+ * a failed completion
+ */
+static void
+latency__lost_error(void **sstate_ptr)
+{
+	struct stats_test_state *sstate = *sstate_ptr;
+
+	/* run test */
+	stats_post(sstate->stats, RPMA_OP_READ, MOCK_LEN,
+			RPMA_F_COMPLETION_ALWAYS, MOCK_OK);
+	stats_complete(sstate->stats, RPMA_OP_READ, IBV_WC_REM_ACCESS_ERR);
+	stats_post(sstate->stats, RPMA_OP_READ, MOCK_LEN,
+			RPMA_F_COMPLETION_ALWAYS, MOCK_OK);
+	stats_complete(sstate->stats, RPMA_OP_READ, IBV_WC_SUCCESS);
+
+	/* verify the results */
+	struct rpma_stats snapshot;
+	rpma_conn_stats_get(sstate->stats, &snapshot);
+	assert_int_equal(snapshot.ops[RPMA_OP_READ], 2);
+	assert_int_equal(stats_latency_samples(&snapshot, RPMA_OP_READ), 0);
+}
+
+/*
+ * latency__lost_full -- the latency is not collected any longer if there
+ * are more signaled operations in flight than the FIFO can hold
+ */
+static void
+latency__lost_full(void **sstate_ptr)
+{
+	struct stats_test_state *sstate = *sstate_ptr;
+
+	/* run test (the SQ FIFO holds 4 operations) */
+	for (int i = 0; i < 5; ++i)
+		stats_post(sstate->stats, RPMA_OP_READ, MOCK_LEN,
+				RPMA_F_COMPLETION_ALWAYS, MOCK_OK);
+	for (int i = 0; i < 5; ++i)
+		stats_complete(sstate->stats, RPMA_OP_READ, IBV_WC_SUCCESS);
+
+	/* verify the results */
+	struct rpma_stats snapshot;
+	rpma_conn_stats_get(sstate->stats, &snapshot);
+	assert_int_equal(snapshot.ops[RPMA_OP_READ], 5);
+	assert_int_equal(snapshot.cqes, 5);
+	assert_int_equal(stats_latency_samples(&snapshot, RPMA_OP_READ), 0);
+}
+
+int
+main(int argc, char *argv[])
+{
+	const struct CMUnitTest tests[] = {
+		/* the counters */
+		cmocka_unit_test_setup_teardown(posted__counters,
+			setup__conn_stats, teardown__conn_stats),
+		cmocka_unit_test_setup_teardown(polled__counters,
+			setup__conn_stats, teardown__conn_stats),
+		cmocka_unit_test_setup_teardown(woken__counters,
+			setup__conn_stats, teardown__conn_stats),
+
+		/* the latency */
+		cmocka_unit_test_setup_teardown(latency__disabled,
+			setup__conn_stats, teardown__conn_stats),
+		cmocka_unit_test_setup_teardown(latency__matched,
+			setup__conn_stats_latency, teardown__conn_stats),
+		cmocka_unit_test_setup_teardown(latency__post_failed,
+			setup__conn_stats_latency, teardown__conn_stats),
+		cmocka_unit_test_setup_teardown(latency__lost_error,
+			setup__conn_stats_latency, teardown__conn_stats),
+		cmocka_unit_test_setup_teardown(latency__lost_full,
+			setup__conn_stats_latency, teardown__conn_stats),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
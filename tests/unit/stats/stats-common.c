@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * stats-common.c -- the statistics unit tests common functions
+ */
+
+#include "stats-common.h"
+
+static struct stats_test_state Sstate;
+
+/*
+ * setup__stats_group -- prepare the statistics of a peer
+ */
+int
+setup__stats_group(void **sstate_ptr)
+{
+	rpma_stats_group_init(&Sstate.group);
+	Sstate.stats = NULL;
+
+	*sstate_ptr = &Sstate;
+
+	return 0;
+}
+
+/*
+ * teardown__stats_group -- release the statistics of a peer
+ */
+int
+teardown__stats_group(void **sstate_ptr)
+{
+	struct stats_test_state *sstate = *sstate_ptr;
+
+	rpma_stats_group_fini(&sstate->group);
+	*sstate_ptr = NULL;
+
+	return 0;
+}
+
+/*
+ * conn_stats_new -- prepare the statistics of a connection of a peer
+ */
+static int
+conn_stats_new(void **sstate_ptr, int flags, int mallocs)
+{
+	setup__stats_group(sstate_ptr);
+	struct stats_test_state *sstate = *sstate_ptr;
+
+	/* configure mocks */
+	for (int i = 0; i < mallocs; ++i)
+		will_return(__wrap__test_malloc, MOCK_OK);
+
+	/* prepare an object */
+	int ret = rpma_conn_stats_new(&sstate->group, flags, false,
+			MOCK_SQ_ENTRIES, MOCK_RQ_ENTRIES, &sstate->stats);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_non_null(sstate->stats);
+
+	return 0;
+}
+
+/*
+ * setup__conn_stats -- prepare the statistics of a connection collecting
+ * only the counters
+ */
+int
+setup__conn_stats(void **sstate_ptr)
+{
+	return conn_stats_new(sstate_ptr, RPMA_STATS_COUNTERS, 1);
+}
+
+/*
+ * setup__conn_stats_latency -- prepare the statistics of a connection
+ * collecting also the latency
+ */
+int
+setup__conn_stats_latency(void **sstate_ptr)
+{
+	return conn_stats_new(sstate_ptr,
+			RPMA_STATS_COUNTERS | RPMA_STATS_LATENCY, 3);
+}
+
+/*
+ * teardown__conn_stats -- delete the statistics of a connection
+ */
+int
+teardown__conn_stats(void **sstate_ptr)
+{
+	struct stats_test_state *sstate = *sstate_ptr;
+
+	/* delete the object */
+	int ret = rpma_conn_stats_delete(&sstate->stats);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_null(sstate->stats);
+
+	return teardown__stats_group(sstate_ptr);
+}
+
+/*
+ * stats_post -- post an operation (as the connection does)
+ */
+void
+stats_post(struct rpma_conn_stats *stats, enum rpma_op op, size_t len,
+		int flags, int ret)
+{
+	rpma_conn_stats_posting(stats, op, flags);
+	rpma_conn_stats_posted(stats, op, len, flags, ret);
+}
+
+/*
+ * stats_complete -- collect a completion of an operation
+ */
+void
+stats_complete(struct rpma_conn_stats *stats, enum rpma_op op,
+		enum ibv_wc_status status)
+{
+	struct rpma_completion cmpl = {0};
+	cmpl.op = op;
+	cmpl.op_status = status;
+
+	rpma_conn_stats_polled(stats, &cmpl, MOCK_OK);
+}
+
+/*
+ * stats_latency_samples -- count the samples of the latency histogram
+ */
+uint64_t
+stats_latency_samples(const struct rpma_stats *stats, enum rpma_op op)
+{
+	uint64_t samples = 0;
+	for (int i = 0; i < RPMA_STATS_HIST_BUCKETS; ++i)
+		samples += stats->latency[op][i];
+
+	return samples;
+}
@@ -0,0 +1,38 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * stats-common.h -- the statistics unit tests common definitions
+ */
+
+#ifndef STATS_COMMON_H
+#define STATS_COMMON_H 1
+
+#include "cmocka_headers.h"
+#include "librpma.h"
+#include "stats.h"
+#include "test-common.h"
+
+#define MOCK_SQ_ENTRIES		3
+#define MOCK_RQ_ENTRIES		2
+
+/* all the resources used between setup__conn_stats and teardown__conn_stats */
+struct stats_test_state {
+	struct rpma_stats_group group;
+	struct rpma_conn_stats *stats;
+};
+
+int setup__stats_group(void **sstate_ptr);
+int teardown__stats_group(void **sstate_ptr);
+int setup__conn_stats(void **sstate_ptr);
+int setup__conn_stats_latency(void **sstate_ptr);
+int teardown__conn_stats(void **sstate_ptr);
+
+void stats_post(struct rpma_conn_stats *stats, enum rpma_op op, size_t len,
+		int flags, int ret);
+void stats_complete(struct rpma_conn_stats *stats, enum rpma_op op,
+		enum ibv_wc_status status);
+uint64_t stats_latency_samples(const struct rpma_stats *stats,
+		enum rpma_op op);
+
+#endif /* STATS_COMMON_H */
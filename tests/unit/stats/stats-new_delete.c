@@ -0,0 +1,232 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * stats-new_delete.c -- the statistics new/delete unit tests
+ *
+ * APIs covered:
+ * - rpma_stats_group_init()
+ * - rpma_stats_group_fini()
+ * - rpma_stats_group_get()
+ * - rpma_conn_stats_new()
+ * - rpma_conn_stats_delete()
+ * - rpma_conn_stats_latency()
+ */
+
+#include "stats-common.h"
+
+/*
+ * new__malloc_ERRNO -- malloc() fails with MOCK_ERRNO
+ */
+static void
+new__malloc_ERRNO(void **sstate_ptr)
+{
+	struct stats_test_state *sstate = *sstate_ptr;
+
+	/* configure mocks */
+	will_return(__wrap__test_malloc, MOCK_ERRNO);
+
+	/* run test */
+	int ret = rpma_conn_stats_new(&sstate->group, RPMA_STATS_COUNTERS,
+			false, MOCK_SQ_ENTRIES, MOCK_RQ_ENTRIES,
+			&sstate->stats);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NOMEM);
+	assert_null(sstate->stats);
+}
+
+/*
+ * new__sq_malloc_ERRNO -- malloc() of the SQ FIFO fails with MOCK_ERRNO
+ */
+static void
+new__sq_malloc_ERRNO(void **sstate_ptr)
+{
+	struct stats_test_state *sstate = *sstate_ptr;
+
+	/* configure mocks */
+	will_return(__wrap__test_malloc, MOCK_OK);
+	will_return(__wrap__test_malloc, MOCK_ERRNO);
+
+	/* run test */
+	int ret = rpma_conn_stats_new(&sstate->group, RPMA_STATS_LATENCY,
+			false, MOCK_SQ_ENTRIES, MOCK_RQ_ENTRIES,
+			&sstate->stats);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NOMEM);
+	assert_null(sstate->stats);
+}
+
+/*
+ * new__rq_malloc_ERRNO -- malloc() of the RQ FIFO fails with MOCK_ERRNO
+ */
+static void
+new__rq_malloc_ERRNO(void **sstate_ptr)
+{
+	struct stats_test_state *sstate = *sstate_ptr;
+
+	/* configure mocks */
+	will_return(__wrap__test_malloc, MOCK_OK);
+	will_return(__wrap__test_malloc, MOCK_OK);
+	will_return(__wrap__test_malloc, MOCK_ERRNO);
+
+	/* run test */
+	int ret = rpma_conn_stats_new(&sstate->group, RPMA_STATS_LATENCY,
+			false, MOCK_SQ_ENTRIES, MOCK_RQ_ENTRIES,
+			&sstate->stats);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NOMEM);
+	assert_null(sstate->stats);
+}
+
+/*
+ * new__shared -- the latency is not collected by a connection shared between
+ * threads
+ */
+static void
+new__shared(void **sstate_ptr)
+{
+	struct stats_test_state *sstate = *sstate_ptr;
+
+	/* configure mocks (no FIFO is allocated) */
+	will_return(__wrap__test_malloc, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_conn_stats_new(&sstate->group,
+			RPMA_STATS_COUNTERS | RPMA_STATS_LATENCY, true,
+			MOCK_SQ_ENTRIES, MOCK_RQ_ENTRIES, &sstate->stats);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_false(rpma_conn_stats_latency(sstate->stats));
+
+	/* the counters are collected anyway */
+	stats_post(sstate->stats, RPMA_OP_READ, MOCK_LEN,
+			RPMA_F_COMPLETION_ALWAYS, MOCK_OK);
+	stats_complete(sstate->stats, RPMA_OP_READ, IBV_WC_SUCCESS);
+	struct rpma_stats snapshot;
+	rpma_conn_stats_get(sstate->stats, &snapshot);
+	assert_int_equal(snapshot.ops[RPMA_OP_READ], 1);
+	assert_int_equal(snapshot.cqes, 1);
+	assert_int_equal(stats_latency_samples(&snapshot, RPMA_OP_READ), 0);
+
+	/* cleanup */
+	ret = rpma_conn_stats_delete(&sstate->stats);
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * delete__stats_ptr_NULL -- NULL stats_ptr is invalid
+ */
+static void
+delete__stats_ptr_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_conn_stats_delete(NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * delete__stats_NULL -- NULL stats is valid - quick exit
+ */
+static void
+delete__stats_NULL(void **unused)
+{
+	/* run test */
+	struct rpma_conn_stats *stats = NULL;
+	int ret = rpma_conn_stats_delete(&stats);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * test_lifecycle - happy day scenario
+ */
+static void
+test_lifecycle(void **sstate_ptr)
+{
+	/*
+	 * The thing is done by setup__conn_stats_latency() and
+	 * teardown__conn_stats().
+	 */
+	struct stats_test_state *sstate = *sstate_ptr;
+	assert_true(rpma_conn_stats_latency(sstate->stats));
+}
+
+/*
+ * group__sum -- the group sums up the statistics of both the live and
+ * the deleted connections
+ */
+static void
+group__sum(void **sstate_ptr)
+{
+	struct stats_test_state *sstate = *sstate_ptr;
+	struct rpma_conn_stats *stats[3];
+
+	/* prepare the connections */
+	for (int i = 0; i < 3; ++i) {
+		will_return(__wrap__test_malloc, MOCK_OK);
+		int ret = rpma_conn_stats_new(&sstate->group,
+				RPMA_STATS_COUNTERS, false, MOCK_SQ_ENTRIES,
+				MOCK_RQ_ENTRIES, &stats[i]);
+		assert_int_equal(ret, MOCK_OK);
+		stats_post(stats[i], RPMA_OP_WRITE, MOCK_LEN,
+				RPMA_F_COMPLETION_ALWAYS, MOCK_OK);
+	}
+
+	/* delete the middle, the first and the last of the connections */
+	int order[] = {1, 0, 2};
+	for (int i = 0; i < 3; ++i) {
+		/* run test */
+		struct rpma_stats snapshot;
+		rpma_stats_group_get(&sstate->group, &snapshot);
+
+		/* verify the results */
+		assert_int_equal(snapshot.ops[RPMA_OP_WRITE], 3);
+		assert_int_equal(snapshot.bytes[RPMA_OP_WRITE], 3 * MOCK_LEN);
+		assert_int_equal(snapshot.posts, 3);
+
+		int ret = rpma_conn_stats_delete(&stats[order[i]]);
+		assert_int_equal(ret, MOCK_OK);
+	}
+
+	struct rpma_stats snapshot;
+	rpma_stats_group_get(&sstate->group, &snapshot);
+	assert_int_equal(snapshot.posts, 3);
+	assert_null(sstate->group.conns);
+}
+
+int
+main(int argc, char *argv[])
+{
+	const struct CMUnitTest tests[] = {
+		/* rpma_conn_stats_new() unit tests */
+		cmocka_unit_test_setup_teardown(new__malloc_ERRNO,
+			setup__stats_group, teardown__stats_group),
+		cmocka_unit_test_setup_teardown(new__sq_malloc_ERRNO,
+			setup__stats_group, teardown__stats_group),
+		cmocka_unit_test_setup_teardown(new__rq_malloc_ERRNO,
+			setup__stats_group, teardown__stats_group),
+		cmocka_unit_test_setup_teardown(new__shared,
+			setup__stats_group, teardown__stats_group),
+
+		/* rpma_conn_stats_delete() unit tests */
+		cmocka_unit_test(delete__stats_ptr_NULL),
+		cmocka_unit_test(delete__stats_NULL),
+
+		/* rpma_conn_stats_new()/_delete() lifecycle */
+		cmocka_unit_test_setup_teardown(test_lifecycle,
+			setup__conn_stats_latency, teardown__conn_stats),
+
+		/* rpma_stats_group_get() unit tests */
+		cmocka_unit_test_setup_teardown(group__sum,
+			setup__stats_group, teardown__stats_group),
+	};
+
+	return cmocka_run_group_tests(tests, NULL, NULL);
+}
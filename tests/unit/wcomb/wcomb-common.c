@@ -0,0 +1,157 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * wcomb-common.c -- the rpma_wcomb unit tests common functions
+ */
+
+#include <time.h>
+
+#include "mocks-unistd.h"
+#include "wcomb-common.h"
+
+void *Posted_ctx;
+struct timespec Mock_time;
+
+/*
+ * rpma_write -- rpma_write() mock
+ */
+int
+rpma_write(struct rpma_conn *conn,
+		struct rpma_mr_remote *dst, size_t dst_offset,
+		const struct rpma_mr_local *src,  size_t src_offset,
+		size_t len, int flags, const void *op_context)
+{
+	assert_ptr_equal(conn, MOCK_CONN);
+	assert_ptr_equal(dst, MOCK_RPMA_MR_REMOTE);
+	assert_ptr_equal(src, MOCK_RPMA_MR_LOCAL);
+	assert_int_equal(flags, RPMA_F_COMPLETION_ALWAYS);
+	assert_non_null(op_context);
+	check_expected(dst_offset);
+	check_expected(src_offset);
+	check_expected(len);
+
+	Posted_ctx = (void *)op_context;
+
+	return mock_type(int);
+}
+
+/*
+ * rpma_flush -- rpma_flush() mock
+ */
+int
+rpma_flush(struct rpma_conn *conn,
+		struct rpma_mr_remote *dst, size_t dst_offset, size_t len,
+		enum rpma_flush_type type, int flags, const void *op_context)
+{
+	assert_ptr_equal(conn, MOCK_CONN);
+	assert_ptr_equal(dst, MOCK_RPMA_MR_REMOTE);
+	check_expected(dst_offset);
+	check_expected(len);
+	check_expected(type);
+	check_expected(flags);
+	check_expected_ptr(op_context);
+
+	return mock_type(int);
+}
+
+/*
+ * __wrap_clock_gettime -- clock_gettime() mock
+ */
+int
+__wrap_clock_gettime(clockid_t clock_id, struct timespec *tp)
+{
+	assert_int_equal(clock_id, CLOCK_MONOTONIC);
+	assert_non_null(tp);
+
+	*tp = Mock_time;
+
+	return 0;
+}
+
+/*
+ * setup__wcomb_new -- prepare a valid write-combining layer
+ */
+int
+setup__wcomb_new(void **wstate_ptr)
+{
+	static struct wcomb_test_state wstate = {0};
+
+	/* configure mocks */
+	will_return(__wrap_sysconf, MOCK_OK);
+	will_return(__wrap_mmap, MOCK_OK);
+	will_return(__wrap_mmap, &wstate.allocated_slab);
+	expect_value(rpma_mr_reg, peer, MOCK_PEER);
+	expect_value(rpma_mr_reg, size, MOCK_SLAB_SIZE);
+	expect_value(rpma_mr_reg, usage, RPMA_MR_USAGE_WRITE_SRC);
+	will_return(rpma_mr_reg, &wstate.allocated_slab.addr);
+	will_return(rpma_mr_reg, MOCK_RPMA_MR_LOCAL);
+	will_return_count(__wrap__test_malloc, MOCK_OK, 2);
+
+	/* run test */
+	wstate.wcomb = NULL;
+	int ret = rpma_wcomb_new(MOCK_PEER, MOCK_CONN, MOCK_RPMA_MR_REMOTE,
+			MOCK_BUFS, MOCK_BUF_SIZE, &wstate.wcomb);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_non_null(wstate.wcomb);
+	assert_int_equal(wstate.allocated_slab.len, PAGESIZE);
+
+	Mock_time.tv_sec = 0;
+	Mock_time.tv_nsec = 0;
+
+	*wstate_ptr = &wstate;
+
+	return 0;
+}
+
+/*
+ * teardown__wcomb_delete -- delete the write-combining layer
+ */
+int
+teardown__wcomb_delete(void **wstate_ptr)
+{
+	struct wcomb_test_state *wstate = *wstate_ptr;
+
+	/* configure mocks */
+	expect_value(rpma_mr_dereg, *mr_ptr, MOCK_RPMA_MR_LOCAL);
+	will_return(rpma_mr_dereg, MOCK_OK);
+	will_return(__wrap_munmap, &wstate->allocated_slab);
+	will_return(__wrap_munmap, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_wcomb_delete(&wstate->wcomb);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_null(wstate->wcomb);
+
+	return 0;
+}
+
+/*
+ * wcomb_expect_post -- expect a write of the given staging buffer
+ */
+void
+wcomb_expect_post(uint32_t buf, size_t dst_offset, size_t len, int result)
+{
+	expect_value(rpma_write, dst_offset, dst_offset);
+	expect_value(rpma_write, src_offset, buf * MOCK_BUF_SIZE);
+	expect_value(rpma_write, len, len);
+	will_return(rpma_write, result);
+}
+
+/*
+ * wcomb_complete -- pass the completion of a posted buffer to the layer
+ */
+int
+wcomb_complete(struct rpma_wcomb *wcomb, void *ctx, enum ibv_wc_status status)
+{
+	struct rpma_completion cmpl = {0};
+	cmpl.op_context = ctx;
+	cmpl.op = RPMA_OP_WRITE;
+	cmpl.op_status = status;
+
+	return rpma_wcomb_process(wcomb, &cmpl);
+}
@@ -0,0 +1,48 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * wcomb-common.h -- the rpma_wcomb unit tests common definitions
+ */
+
+#ifndef WCOMB_COMMON_H
+#define WCOMB_COMMON_H
+
+#include "cmocka_headers.h"
+#include "librpma.h"
+#include "mocks-stdlib.h"
+#include "test-common.h"
+
+#define MOCK_RPMA_MR_REMOTE	((struct rpma_mr_remote *)0xC412)
+#define MOCK_REMOTE_OFFSET	(size_t)0xC414
+
+#define MOCK_BUFS		2
+#define MOCK_BUF_SIZE		64
+#define MOCK_SLAB_SIZE		(MOCK_BUFS * MOCK_BUF_SIZE)
+#define MOCK_WRITE_LEN		16
+#define MOCK_TIMEOUT_US		100
+
+struct wcomb_test_state {
+	struct rpma_wcomb *wcomb;
+	struct mmap_args allocated_slab;
+};
+
+/* get the staging buffer of the given index */
+#define STAGING_BUF(wstate, buf) \
+	((char *)(wstate)->allocated_slab.addr + (buf) * MOCK_BUF_SIZE)
+
+/* the op_context of the most recently posted buffer */
+extern void *Posted_ctx;
+
+/* the time returned by the next clock_gettime() call */
+extern struct timespec Mock_time;
+
+int setup__wcomb_new(void **wstate_ptr);
+int teardown__wcomb_delete(void **wstate_ptr);
+
+void wcomb_expect_post(uint32_t buf, size_t dst_offset, size_t len,
+		int result);
+int wcomb_complete(struct rpma_wcomb *wcomb, void *ctx,
+		enum ibv_wc_status status);
+
+#endif /* WCOMB_COMMON_H */
@@ -0,0 +1,384 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * wcomb-flush_process.c -- the rpma_wcomb_post/flush/process() and timeout
+ * unit tests
+ *
+ * APIs covered:
+ * - rpma_wcomb_post()
+ * - rpma_wcomb_flush()
+ * - rpma_wcomb_process()
+ * - rpma_wcomb_set_timeout()
+ * - rpma_wcomb_progress()
+ */
+
+#include "wcomb-common.h"
+
+static char Src[MOCK_WRITE_LEN];
+
+/*
+ * gather -- gather a single write in the open buffer
+ */
+static void
+gather(struct wcomb_test_state *wstate)
+{
+	int ret = rpma_wcomb_write(wstate->wcomb, MOCK_REMOTE_OFFSET, Src,
+			MOCK_WRITE_LEN);
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * expect_flush -- configure the mocks of rpma_flush()
+ */
+static void
+expect_flush(int result)
+{
+	expect_value(rpma_flush, dst_offset, MOCK_REMOTE_OFFSET);
+	expect_value(rpma_flush, len, MOCK_WRITE_LEN);
+	expect_value(rpma_flush, type, RPMA_FLUSH_TYPE_VISIBILITY);
+	expect_value(rpma_flush, flags, RPMA_F_COMPLETION_ALWAYS);
+	expect_value(rpma_flush, op_context, MOCK_OP_CONTEXT);
+	will_return(rpma_flush, result);
+}
+
+/*
+ * flush -- flush the range of the single write
+ */
+static int
+flush(struct rpma_wcomb *wcomb)
+{
+	return rpma_wcomb_flush(wcomb, MOCK_REMOTE_OFFSET, MOCK_WRITE_LEN,
+			RPMA_FLUSH_TYPE_VISIBILITY, RPMA_F_COMPLETION_ALWAYS,
+			MOCK_OP_CONTEXT);
+}
+
+/*
+ * post__wcomb_NULL -- NULL wcomb is invalid
+ */
+static void
+post__wcomb_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_wcomb_post(NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * post__nothing_open -- there is nothing to be posted
+ */
+static void
+post__nothing_open(void **wstate_ptr)
+{
+	struct wcomb_test_state *wstate = *wstate_ptr;
+
+	/* run test */
+	int ret = rpma_wcomb_post(wstate->wcomb);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * flush__invalid_args -- NULL wcomb or no flags are invalid
+ */
+static void
+flush__invalid_args(void **wstate_ptr)
+{
+	struct wcomb_test_state *wstate = *wstate_ptr;
+
+	/* run test */
+	int ret1 = flush(NULL);
+	int ret2 = rpma_wcomb_flush(wstate->wcomb, MOCK_REMOTE_OFFSET,
+			MOCK_WRITE_LEN, RPMA_FLUSH_TYPE_VISIBILITY, 0,
+			MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret1, RPMA_E_INVAL);
+	assert_int_equal(ret2, RPMA_E_INVAL);
+}
+
+/*
+ * flush__success -- the open buffer is posted before the flush
+ */
+static void
+flush__success(void **wstate_ptr)
+{
+	struct wcomb_test_state *wstate = *wstate_ptr;
+	gather(wstate);
+
+	/* configure mocks */
+	wcomb_expect_post(0, MOCK_REMOTE_OFFSET, MOCK_WRITE_LEN, MOCK_OK);
+	expect_flush(MOCK_OK);
+
+	/* run test */
+	int ret = flush(wstate->wcomb);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(wcomb_complete(wstate->wcomb, Posted_ctx,
+			IBV_WC_SUCCESS), MOCK_OK);
+}
+
+/*
+ * flush__nothing_open -- only the flush is posted
+ */
+static void
+flush__nothing_open(void **wstate_ptr)
+{
+	struct wcomb_test_state *wstate = *wstate_ptr;
+
+	/* configure mocks */
+	expect_flush(RPMA_E_NOSUPP);
+
+	/* run test */
+	int ret = flush(wstate->wcomb);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NOSUPP);
+}
+
+/*
+ * flush__post_E_PROVIDER -- the flush is not posted if posting the open
+ * buffer fails
+ */
+static void
+flush__post_E_PROVIDER(void **wstate_ptr)
+{
+	struct wcomb_test_state *wstate = *wstate_ptr;
+	gather(wstate);
+
+	/* configure mocks */
+	wcomb_expect_post(0, MOCK_REMOTE_OFFSET, MOCK_WRITE_LEN,
+			RPMA_E_PROVIDER);
+
+	/* run test */
+	int ret = flush(wstate->wcomb);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	wcomb_expect_post(0, MOCK_REMOTE_OFFSET, MOCK_WRITE_LEN, MOCK_OK);
+	assert_int_equal(rpma_wcomb_post(wstate->wcomb), MOCK_OK);
+	assert_int_equal(wcomb_complete(wstate->wcomb, Posted_ctx,
+			IBV_WC_SUCCESS), MOCK_OK);
+}
+
+/*
+ * process__invalid_args -- NULL wcomb or cmpl is invalid
+ */
+static void
+process__invalid_args(void **wstate_ptr)
+{
+	struct wcomb_test_state *wstate = *wstate_ptr;
+	struct rpma_completion cmpl = {0};
+
+	/* run test */
+	int ret1 = rpma_wcomb_process(NULL, &cmpl);
+	int ret2 = rpma_wcomb_process(wstate->wcomb, NULL);
+
+	/* verify the results */
+	assert_int_equal(ret1, RPMA_E_INVAL);
+	assert_int_equal(ret2, RPMA_E_INVAL);
+}
+
+/*
+ * process__foreign -- the completions which do not come from the layer
+ * are rejected
+ */
+static void
+process__foreign(void **wstate_ptr)
+{
+	struct wcomb_test_state *wstate = *wstate_ptr;
+
+	/* nothing has been posted */
+	int ret = wcomb_complete(wstate->wcomb, STAGING_BUF(wstate, 0),
+			IBV_WC_SUCCESS);
+	assert_int_equal(ret, RPMA_E_INVAL);
+
+	/* the open buffer has not been posted */
+	gather(wstate);
+	ret = wcomb_complete(wstate->wcomb, STAGING_BUF(wstate, 0),
+			IBV_WC_SUCCESS);
+	assert_int_equal(ret, RPMA_E_INVAL);
+
+	/* not a staging buffer */
+	void *ctxs[] = {
+		MOCK_OP_CONTEXT,
+		STAGING_BUF(wstate, 0) + 1,
+		STAGING_BUF(wstate, MOCK_BUFS),
+	};
+	for (size_t i = 0; i < sizeof(ctxs) / sizeof(ctxs[0]); ++i) {
+		ret = wcomb_complete(wstate->wcomb, ctxs[i], IBV_WC_SUCCESS);
+		assert_int_equal(ret, RPMA_E_INVAL);
+	}
+
+	wcomb_expect_post(0, MOCK_REMOTE_OFFSET, MOCK_WRITE_LEN, MOCK_OK);
+	assert_int_equal(rpma_wcomb_post(wstate->wcomb), MOCK_OK);
+	assert_int_equal(wcomb_complete(wstate->wcomb, Posted_ctx,
+			IBV_WC_SUCCESS), MOCK_OK);
+}
+
+/*
+ * process__failed -- the failed write is reported and its buffer
+ * is released
+ */
+static void
+process__failed(void **wstate_ptr)
+{
+	struct wcomb_test_state *wstate = *wstate_ptr;
+
+	for (int i = 0; i < MOCK_BUFS + 1; ++i) {
+		gather(wstate);
+		wcomb_expect_post(0, MOCK_REMOTE_OFFSET, MOCK_WRITE_LEN,
+				MOCK_OK);
+		assert_int_equal(rpma_wcomb_post(wstate->wcomb), MOCK_OK);
+
+		/* run test */
+		int ret = wcomb_complete(wstate->wcomb, Posted_ctx,
+				IBV_WC_REM_ACCESS_ERR);
+
+		/* verify the results */
+		assert_int_equal(ret, RPMA_E_PROVIDER);
+	}
+}
+
+/*
+ * timeout__wcomb_NULL -- NULL wcomb is invalid
+ */
+static void
+timeout__wcomb_NULL(void **unused)
+{
+	/* run test */
+	int ret1 = rpma_wcomb_set_timeout(NULL, MOCK_TIMEOUT_US);
+	int ret2 = rpma_wcomb_progress(NULL);
+
+	/* verify the results */
+	assert_int_equal(ret1, RPMA_E_INVAL);
+	assert_int_equal(ret2, RPMA_E_INVAL);
+}
+
+/*
+ * progress__disabled -- the open buffer is not posted without a timeout
+ */
+static void
+progress__disabled(void **wstate_ptr)
+{
+	struct wcomb_test_state *wstate = *wstate_ptr;
+	gather(wstate);
+	Mock_time.tv_sec = 3600;
+
+	/* run test */
+	int ret = rpma_wcomb_progress(wstate->wcomb);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	wcomb_expect_post(0, MOCK_REMOTE_OFFSET, MOCK_WRITE_LEN, MOCK_OK);
+	assert_int_equal(rpma_wcomb_post(wstate->wcomb), MOCK_OK);
+	assert_int_equal(wcomb_complete(wstate->wcomb, Posted_ctx,
+			IBV_WC_SUCCESS), MOCK_OK);
+}
+
+/*
+ * progress__expired -- the open buffer is posted once it gets older than
+ * the timeout
+ */
+static void
+progress__expired(void **wstate_ptr)
+{
+	struct wcomb_test_state *wstate = *wstate_ptr;
+	assert_int_equal(rpma_wcomb_set_timeout(wstate->wcomb,
+			MOCK_TIMEOUT_US), MOCK_OK);
+	Mock_time.tv_sec = 1;
+	Mock_time.tv_nsec = 999999000;
+	gather(wstate);
+
+	/* run test */
+	Mock_time.tv_sec = 2;
+	Mock_time.tv_nsec = (MOCK_TIMEOUT_US - 2) * 1000;
+	int ret = rpma_wcomb_progress(wstate->wcomb);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+
+	/* configure mocks */
+	wcomb_expect_post(0, MOCK_REMOTE_OFFSET, MOCK_WRITE_LEN, MOCK_OK);
+
+	/* run test */
+	Mock_time.tv_nsec += 1000;
+	ret = rpma_wcomb_progress(wstate->wcomb);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(wcomb_complete(wstate->wcomb, Posted_ctx,
+			IBV_WC_SUCCESS), MOCK_OK);
+}
+
+/*
+ * write__expired -- the write gathered in the expired buffer posts it
+ */
+static void
+write__expired(void **wstate_ptr)
+{
+	struct wcomb_test_state *wstate = *wstate_ptr;
+	assert_int_equal(rpma_wcomb_set_timeout(wstate->wcomb,
+			MOCK_TIMEOUT_US), MOCK_OK);
+	gather(wstate);
+
+	/* configure mocks */
+	wcomb_expect_post(0, MOCK_REMOTE_OFFSET, 2 * MOCK_WRITE_LEN, MOCK_OK);
+
+	/* run test */
+	Mock_time.tv_nsec = MOCK_TIMEOUT_US * 1000;
+	int ret = rpma_wcomb_write(wstate->wcomb,
+			MOCK_REMOTE_OFFSET + MOCK_WRITE_LEN, Src,
+			MOCK_WRITE_LEN);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_int_equal(wcomb_complete(wstate->wcomb, Posted_ctx,
+			IBV_WC_SUCCESS), MOCK_OK);
+}
+
+static const struct CMUnitTest tests_flush_process[] = {
+	/* rpma_wcomb_post() unit tests */
+	cmocka_unit_test(post__wcomb_NULL),
+	cmocka_unit_test_setup_teardown(post__nothing_open,
+		setup__wcomb_new, teardown__wcomb_delete),
+
+	/* rpma_wcomb_flush() unit tests */
+	cmocka_unit_test_setup_teardown(flush__invalid_args,
+		setup__wcomb_new, teardown__wcomb_delete),
+	cmocka_unit_test_setup_teardown(flush__success,
+		setup__wcomb_new, teardown__wcomb_delete),
+	cmocka_unit_test_setup_teardown(flush__nothing_open,
+		setup__wcomb_new, teardown__wcomb_delete),
+	cmocka_unit_test_setup_teardown(flush__post_E_PROVIDER,
+		setup__wcomb_new, teardown__wcomb_delete),
+
+	/* rpma_wcomb_process() unit tests */
+	cmocka_unit_test_setup_teardown(process__invalid_args,
+		setup__wcomb_new, teardown__wcomb_delete),
+	cmocka_unit_test_setup_teardown(process__foreign,
+		setup__wcomb_new, teardown__wcomb_delete),
+	cmocka_unit_test_setup_teardown(process__failed,
+		setup__wcomb_new, teardown__wcomb_delete),
+
+	/* rpma_wcomb_set_timeout()/progress() unit tests */
+	cmocka_unit_test(timeout__wcomb_NULL),
+	cmocka_unit_test_setup_teardown(progress__disabled,
+		setup__wcomb_new, teardown__wcomb_delete),
+	cmocka_unit_test_setup_teardown(progress__expired,
+		setup__wcomb_new, teardown__wcomb_delete),
+	cmocka_unit_test_setup_teardown(write__expired,
+		setup__wcomb_new, teardown__wcomb_delete),
+
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_flush_process, NULL, NULL);
+}
@@ -0,0 +1,290 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * wcomb-new_delete.c -- the rpma_wcomb_new/delete() unit tests
+ *
+ * APIs covered:
+ * - rpma_wcomb_new()
+ * - rpma_wcomb_delete()
+ */
+
+#include "mocks-unistd.h"
+#include "wcomb-common.h"
+
+/*
+ * configure_mr_reg -- configure the mocks of rpma_mr_reg()
+ */
+static void
+configure_mr_reg(struct mmap_args *allocated_slab, int ret)
+{
+	will_return(__wrap_sysconf, MOCK_OK);
+	will_return(__wrap_mmap, MOCK_OK);
+	will_return(__wrap_mmap, allocated_slab);
+	expect_value(rpma_mr_reg, peer, MOCK_PEER);
+	expect_value(rpma_mr_reg, size, MOCK_SLAB_SIZE);
+	expect_value(rpma_mr_reg, usage, RPMA_MR_USAGE_WRITE_SRC);
+	will_return(rpma_mr_reg, &allocated_slab->addr);
+	if (ret == MOCK_OK) {
+		will_return(rpma_mr_reg, MOCK_RPMA_MR_LOCAL);
+	} else {
+		will_return(rpma_mr_reg, NULL);
+		will_return(rpma_mr_reg, ret);
+	}
+}
+
+/*
+ * new__invalid_args -- invalid combinations of the arguments
+ */
+static void
+new__invalid_args(void **unused)
+{
+	struct rpma_wcomb *wcomb = NULL;
+	struct {
+		struct rpma_peer *peer;
+		struct rpma_conn *conn;
+		struct rpma_mr_remote *dst;
+		uint32_t bufs;
+		size_t buf_size;
+		struct rpma_wcomb **wcomb_ptr;
+	} args[] = {
+		{NULL, MOCK_CONN, MOCK_RPMA_MR_REMOTE, MOCK_BUFS,
+			MOCK_BUF_SIZE, &wcomb},
+		{MOCK_PEER, NULL, MOCK_RPMA_MR_REMOTE, MOCK_BUFS,
+			MOCK_BUF_SIZE, &wcomb},
+		{MOCK_PEER, MOCK_CONN, NULL, MOCK_BUFS, MOCK_BUF_SIZE,
+			&wcomb},
+		{MOCK_PEER, MOCK_CONN, MOCK_RPMA_MR_REMOTE, 0, MOCK_BUF_SIZE,
+			&wcomb},
+		{MOCK_PEER, MOCK_CONN, MOCK_RPMA_MR_REMOTE, MOCK_BUFS, 0,
+			&wcomb},
+		/* the size of the staging buffers overflows */
+		{MOCK_PEER, MOCK_CONN, MOCK_RPMA_MR_REMOTE, MOCK_BUFS,
+			SIZE_MAX, &wcomb},
+		{MOCK_PEER, MOCK_CONN, MOCK_RPMA_MR_REMOTE, MOCK_BUFS,
+			MOCK_BUF_SIZE, NULL},
+	};
+
+	for (size_t i = 0; i < sizeof(args) / sizeof(args[0]); ++i) {
+		/* run test */
+		int ret = rpma_wcomb_new(args[i].peer, args[i].conn,
+				args[i].dst, args[i].bufs, args[i].buf_size,
+				args[i].wcomb_ptr);
+
+		/* verify the results */
+		assert_int_equal(ret, RPMA_E_INVAL);
+		assert_null(wcomb);
+	}
+}
+
+/*
+ * new__sysconf_ERRNO -- sysconf() fails with MOCK_ERRNO
+ */
+static void
+new__sysconf_ERRNO(void **unused)
+{
+	/* configure mocks */
+	will_return(__wrap_sysconf, MOCK_ERRNO);
+
+	/* run test */
+	struct rpma_wcomb *wcomb = NULL;
+	int ret = rpma_wcomb_new(MOCK_PEER, MOCK_CONN, MOCK_RPMA_MR_REMOTE,
+			MOCK_BUFS, MOCK_BUF_SIZE, &wcomb);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(wcomb);
+}
+
+/*
+ * new__mmap_ERRNO -- mmap() fails with MOCK_ERRNO
+ */
+static void
+new__mmap_ERRNO(void **unused)
+{
+	/* configure mocks */
+	will_return(__wrap_sysconf, MOCK_OK);
+	will_return(__wrap_mmap, MOCK_ERRNO);
+
+	/* run test */
+	struct rpma_wcomb *wcomb = NULL;
+	int ret = rpma_wcomb_new(MOCK_PEER, MOCK_CONN, MOCK_RPMA_MR_REMOTE,
+			MOCK_BUFS, MOCK_BUF_SIZE, &wcomb);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NOMEM);
+	assert_null(wcomb);
+}
+
+/*
+ * new__mr_reg_E_PROVIDER -- rpma_mr_reg() fails with RPMA_E_PROVIDER
+ */
+static void
+new__mr_reg_E_PROVIDER(void **unused)
+{
+	struct mmap_args allocated_slab = {0};
+
+	/* configure mocks */
+	configure_mr_reg(&allocated_slab, RPMA_E_PROVIDER);
+	will_return(__wrap_munmap, &allocated_slab);
+	will_return(__wrap_munmap, MOCK_OK);
+
+	/* run test */
+	struct rpma_wcomb *wcomb = NULL;
+	int ret = rpma_wcomb_new(MOCK_PEER, MOCK_CONN, MOCK_RPMA_MR_REMOTE,
+			MOCK_BUFS, MOCK_BUF_SIZE, &wcomb);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(wcomb);
+}
+
+/*
+ * new__malloc_ERRNO -- malloc() fails with MOCK_ERRNO
+ */
+static void
+new__malloc_ERRNO(void **unused)
+{
+	/* each of the two malloc() calls fails in turn */
+	for (int i = 0; i < 2; ++i) {
+		struct mmap_args allocated_slab = {0};
+
+		/* configure mocks */
+		configure_mr_reg(&allocated_slab, MOCK_OK);
+		for (int j = 0; j < i; ++j)
+			will_return(__wrap__test_malloc, MOCK_OK);
+		will_return(__wrap__test_malloc, MOCK_ERRNO);
+		expect_value(rpma_mr_dereg, *mr_ptr, MOCK_RPMA_MR_LOCAL);
+		will_return(rpma_mr_dereg, MOCK_OK);
+		will_return(__wrap_munmap, &allocated_slab);
+		will_return(__wrap_munmap, MOCK_OK);
+
+		/* run test */
+		struct rpma_wcomb *wcomb = NULL;
+		int ret = rpma_wcomb_new(MOCK_PEER, MOCK_CONN,
+				MOCK_RPMA_MR_REMOTE, MOCK_BUFS, MOCK_BUF_SIZE,
+				&wcomb);
+
+		/* verify the results */
+		assert_int_equal(ret, RPMA_E_NOMEM);
+		assert_null(wcomb);
+	}
+}
+
+/*
+ * test_lifecycle -- happy day scenario
+ */
+static void
+test_lifecycle(void **unused)
+{
+	/*
+	 * the thing is done by setup__wcomb_new() and
+	 * teardown__wcomb_delete()
+	 */
+}
+
+/*
+ * delete__wcomb_ptr_NULL -- NULL wcomb_ptr is invalid
+ */
+static void
+delete__wcomb_ptr_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_wcomb_delete(NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * delete__wcomb_NULL -- NULL wcomb is valid - quick exit
+ */
+static void
+delete__wcomb_NULL(void **unused)
+{
+	/* run test */
+	struct rpma_wcomb *wcomb = NULL;
+	int ret = rpma_wcomb_delete(&wcomb);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * delete__mr_dereg_E_PROVIDER -- rpma_mr_dereg() fails with
+ * RPMA_E_PROVIDER
+ */
+static void
+delete__mr_dereg_E_PROVIDER(void **unused)
+{
+	struct wcomb_test_state *wstate;
+
+	/* WA for cmocka/issues#47 */
+	assert_int_equal(setup__wcomb_new((void **)&wstate), 0);
+
+	/* configure mocks */
+	expect_value(rpma_mr_dereg, *mr_ptr, MOCK_RPMA_MR_LOCAL);
+	will_return(rpma_mr_dereg, RPMA_E_PROVIDER);
+	will_return(rpma_mr_dereg, MOCK_ERRNO);
+	will_return(__wrap_munmap, &wstate->allocated_slab);
+	will_return(__wrap_munmap, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_wcomb_delete(&wstate->wcomb);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(wstate->wcomb);
+}
+
+/*
+ * delete__munmap_ERRNO -- munmap() fails with MOCK_ERRNO
+ */
+static void
+delete__munmap_ERRNO(void **unused)
+{
+	struct wcomb_test_state *wstate;
+
+	/* WA for cmocka/issues#47 */
+	assert_int_equal(setup__wcomb_new((void **)&wstate), 0);
+
+	/* configure mocks */
+	expect_value(rpma_mr_dereg, *mr_ptr, MOCK_RPMA_MR_LOCAL);
+	will_return(rpma_mr_dereg, MOCK_OK);
+	will_return(__wrap_munmap, &wstate->allocated_slab);
+	will_return(__wrap_munmap, MOCK_ERRNO);
+
+	/* run test */
+	int ret = rpma_wcomb_delete(&wstate->wcomb);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(wstate->wcomb);
+}
+
+static const struct CMUnitTest tests_new_delete[] = {
+	/* rpma_wcomb_new() unit tests */
+	cmocka_unit_test(new__invalid_args),
+	cmocka_unit_test(new__sysconf_ERRNO),
+	cmocka_unit_test(new__mmap_ERRNO),
+	cmocka_unit_test(new__mr_reg_E_PROVIDER),
+	cmocka_unit_test(new__malloc_ERRNO),
+
+	/* rpma_wcomb_new()/delete() lifecycle */
+	cmocka_unit_test_setup_teardown(test_lifecycle,
+		setup__wcomb_new, teardown__wcomb_delete),
+
+	/* rpma_wcomb_delete() unit tests */
+	cmocka_unit_test(delete__wcomb_ptr_NULL),
+	cmocka_unit_test(delete__wcomb_NULL),
+	cmocka_unit_test(delete__mr_dereg_E_PROVIDER),
+	cmocka_unit_test(delete__munmap_ERRNO),
+
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_new_delete, NULL, NULL);
+}
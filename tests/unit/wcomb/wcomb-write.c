@@ -0,0 +1,332 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * wcomb-write.c -- the rpma_wcomb_write() unit tests
+ *
+ * API covered:
+ * - rpma_wcomb_write()
+ */
+
+#include <string.h>
+
+#include "wcomb-common.h"
+
+#define OFF	MOCK_REMOTE_OFFSET
+
+static char Src_a[MOCK_BUF_SIZE];
+static char Src_b[MOCK_BUF_SIZE];
+
+/*
+ * setup__wcomb_write -- prepare the layer and the source data
+ */
+static int
+setup__wcomb_write(void **wstate_ptr)
+{
+	memset(Src_a, 'a', MOCK_BUF_SIZE);
+	memset(Src_b, 'b', MOCK_BUF_SIZE);
+
+	return setup__wcomb_new(wstate_ptr);
+}
+
+/*
+ * write__invalid_args -- invalid combinations of the arguments
+ */
+static void
+write__invalid_args(void **wstate_ptr)
+{
+	struct wcomb_test_state *wstate = *wstate_ptr;
+	struct {
+		struct rpma_wcomb *wcomb;
+		const void *src;
+		size_t len;
+	} args[] = {
+		{NULL, Src_a, MOCK_WRITE_LEN},
+		{wstate->wcomb, NULL, MOCK_WRITE_LEN},
+		{wstate->wcomb, Src_a, 0},
+		/* longer than the staging buffer */
+		{wstate->wcomb, Src_a, MOCK_BUF_SIZE + 1},
+	};
+
+	for (size_t i = 0; i < sizeof(args) / sizeof(args[0]); ++i) {
+		/* run test */
+		int ret = rpma_wcomb_write(args[i].wcomb, OFF, args[i].src,
+				args[i].len);
+
+		/* verify the results */
+		assert_int_equal(ret, RPMA_E_INVAL);
+	}
+}
+
+/*
+ * write__contiguous -- the adjoining writes are gathered in a single
+ * RDMA write
+ */
+static void
+write__contiguous(void **wstate_ptr)
+{
+	struct wcomb_test_state *wstate = *wstate_ptr;
+
+	/* run test */
+	for (size_t i = 0; i < 3; ++i) {
+		int ret = rpma_wcomb_write(wstate->wcomb,
+				OFF + i * MOCK_WRITE_LEN,
+				(i % 2) ? Src_b : Src_a, MOCK_WRITE_LEN);
+		assert_int_equal(ret, MOCK_OK);
+	}
+
+	/* configure mocks */
+	wcomb_expect_post(0, OFF, 3 * MOCK_WRITE_LEN, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_wcomb_post(wstate->wcomb);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(Posted_ctx, STAGING_BUF(wstate, 0));
+	char *buf = STAGING_BUF(wstate, 0);
+	assert_memory_equal(buf, Src_a, MOCK_WRITE_LEN);
+	assert_memory_equal(buf + MOCK_WRITE_LEN, Src_b, MOCK_WRITE_LEN);
+	assert_memory_equal(buf + 2 * MOCK_WRITE_LEN, Src_a, MOCK_WRITE_LEN);
+	assert_int_equal(wcomb_complete(wstate->wcomb, Posted_ctx,
+			IBV_WC_SUCCESS), MOCK_OK);
+}
+
+/*
+ * write__overlap -- the overlapping write replaces the data gathered
+ * earlier
+ */
+static void
+write__overlap(void **wstate_ptr)
+{
+	struct wcomb_test_state *wstate = *wstate_ptr;
+	size_t half = MOCK_WRITE_LEN / 2;
+
+	/* run test */
+	int ret = rpma_wcomb_write(wstate->wcomb, OFF, Src_a, MOCK_WRITE_LEN);
+	assert_int_equal(ret, MOCK_OK);
+	ret = rpma_wcomb_write(wstate->wcomb, OFF + half, Src_b,
+			MOCK_WRITE_LEN);
+	assert_int_equal(ret, MOCK_OK);
+
+	/* configure mocks */
+	wcomb_expect_post(0, OFF, half + MOCK_WRITE_LEN, MOCK_OK);
+
+	/* run test */
+	ret = rpma_wcomb_post(wstate->wcomb);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	char *buf = STAGING_BUF(wstate, 0);
+	assert_memory_equal(buf, Src_a, half);
+	assert_memory_equal(buf + half, Src_b, MOCK_WRITE_LEN);
+	assert_int_equal(wcomb_complete(wstate->wcomb, Posted_ctx,
+			IBV_WC_SUCCESS), MOCK_OK);
+}
+
+/*
+ * write__not_mergeable -- a write leaving a hole, preceding the window
+ * or exceeding it posts the open buffer and starts a new one
+ */
+static void
+write__not_mergeable(void **wstate_ptr)
+{
+	struct wcomb_test_state *wstate = *wstate_ptr;
+	/* the window is gathered up to 8 bytes before its end */
+	size_t filled = MOCK_BUF_SIZE - 8;
+	size_t offsets[] = {
+		/* leaves a hole */
+		OFF + MOCK_WRITE_LEN + 1,
+		/* precedes the window */
+		OFF - MOCK_WRITE_LEN,
+		/* overlaps the gathered data but exceeds the window */
+		OFF + filled - 4,
+	};
+
+	for (size_t i = 0; i < sizeof(offsets) / sizeof(offsets[0]); ++i) {
+		/* run test */
+		int ret = rpma_wcomb_write(wstate->wcomb, OFF, Src_a,
+				MOCK_WRITE_LEN);
+		assert_int_equal(ret, MOCK_OK);
+		if (i == 2) {
+			ret = rpma_wcomb_write(wstate->wcomb,
+					OFF + MOCK_WRITE_LEN, Src_a,
+					filled - MOCK_WRITE_LEN);
+			assert_int_equal(ret, MOCK_OK);
+		}
+
+		/* configure mocks */
+		wcomb_expect_post(0, OFF, i == 2 ? filled : MOCK_WRITE_LEN,
+				MOCK_OK);
+
+		/* run test */
+		ret = rpma_wcomb_write(wstate->wcomb, offsets[i], Src_b,
+				MOCK_WRITE_LEN);
+
+		/* verify the results */
+		assert_int_equal(ret, MOCK_OK);
+		void *first = Posted_ctx;
+		wcomb_expect_post(1, offsets[i], MOCK_WRITE_LEN, MOCK_OK);
+		assert_int_equal(rpma_wcomb_post(wstate->wcomb), MOCK_OK);
+		assert_memory_equal(STAGING_BUF(wstate, 1), Src_b,
+				MOCK_WRITE_LEN);
+
+		/* the first buffer is released last so it is reused first */
+		assert_int_equal(wcomb_complete(wstate->wcomb, Posted_ctx,
+				IBV_WC_SUCCESS), MOCK_OK);
+		assert_int_equal(wcomb_complete(wstate->wcomb, first,
+				IBV_WC_SUCCESS), MOCK_OK);
+	}
+}
+
+/*
+ * write__full -- the full buffer is posted at once
+ */
+static void
+write__full(void **wstate_ptr)
+{
+	struct wcomb_test_state *wstate = *wstate_ptr;
+	size_t writes = MOCK_BUF_SIZE / MOCK_WRITE_LEN;
+
+	/* run test */
+	for (size_t i = 0; i < writes - 1; ++i) {
+		int ret = rpma_wcomb_write(wstate->wcomb,
+				OFF + i * MOCK_WRITE_LEN, Src_a,
+				MOCK_WRITE_LEN);
+		assert_int_equal(ret, MOCK_OK);
+	}
+
+	/* configure mocks */
+	wcomb_expect_post(0, OFF, MOCK_BUF_SIZE, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_wcomb_write(wstate->wcomb,
+			OFF + (writes - 1) * MOCK_WRITE_LEN, Src_a,
+			MOCK_WRITE_LEN);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_memory_equal(STAGING_BUF(wstate, 0), Src_a, MOCK_BUF_SIZE);
+
+	/* nothing is left to be posted */
+	assert_int_equal(rpma_wcomb_post(wstate->wcomb), MOCK_OK);
+	assert_int_equal(wcomb_complete(wstate->wcomb, Posted_ctx,
+			IBV_WC_SUCCESS), MOCK_OK);
+}
+
+/*
+ * write__no_free_buf -- no staging buffer is free
+ */
+static void
+write__no_free_buf(void **wstate_ptr)
+{
+	struct wcomb_test_state *wstate = *wstate_ptr;
+
+	/* both the buffers are posted */
+	for (uint32_t i = 0; i < MOCK_BUFS; ++i) {
+		wcomb_expect_post(i, OFF + i * MOCK_BUF_SIZE, MOCK_BUF_SIZE,
+				MOCK_OK);
+		int ret = rpma_wcomb_write(wstate->wcomb,
+				OFF + i * MOCK_BUF_SIZE, Src_a,
+				MOCK_BUF_SIZE);
+		assert_int_equal(ret, MOCK_OK);
+	}
+
+	/* run test */
+	int ret = rpma_wcomb_write(wstate->wcomb, OFF, Src_b,
+			MOCK_WRITE_LEN);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_AGAIN);
+
+	/* the released buffer is reused */
+	assert_int_equal(wcomb_complete(wstate->wcomb, STAGING_BUF(wstate, 1),
+			IBV_WC_SUCCESS), MOCK_OK);
+	ret = rpma_wcomb_write(wstate->wcomb, OFF, Src_b, MOCK_WRITE_LEN);
+	assert_int_equal(ret, MOCK_OK);
+	wcomb_expect_post(1, OFF, MOCK_WRITE_LEN, MOCK_OK);
+	assert_int_equal(rpma_wcomb_post(wstate->wcomb), MOCK_OK);
+
+	assert_int_equal(wcomb_complete(wstate->wcomb, STAGING_BUF(wstate, 0),
+			IBV_WC_SUCCESS), MOCK_OK);
+	assert_int_equal(wcomb_complete(wstate->wcomb, STAGING_BUF(wstate, 1),
+			IBV_WC_SUCCESS), MOCK_OK);
+}
+
+/*
+ * write__post_E_PROVIDER -- posting the open buffer fails so the write
+ * is not gathered and the open buffer is kept
+ */
+static void
+write__post_E_PROVIDER(void **wstate_ptr)
+{
+	struct wcomb_test_state *wstate = *wstate_ptr;
+
+	int ret = rpma_wcomb_write(wstate->wcomb, OFF, Src_a, MOCK_WRITE_LEN);
+	assert_int_equal(ret, MOCK_OK);
+
+	/* configure mocks */
+	wcomb_expect_post(0, OFF, MOCK_WRITE_LEN, RPMA_E_PROVIDER);
+
+	/* run test */
+	ret = rpma_wcomb_write(wstate->wcomb, OFF + 2 * MOCK_WRITE_LEN,
+			Src_b, MOCK_WRITE_LEN);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	wcomb_expect_post(0, OFF, MOCK_WRITE_LEN, MOCK_OK);
+	assert_int_equal(rpma_wcomb_post(wstate->wcomb), MOCK_OK);
+	assert_int_equal(wcomb_complete(wstate->wcomb, Posted_ctx,
+			IBV_WC_SUCCESS), MOCK_OK);
+}
+
+/*
+ * write__full_E_PROVIDER -- posting the full buffer fails but the write
+ * is gathered
+ */
+static void
+write__full_E_PROVIDER(void **wstate_ptr)
+{
+	struct wcomb_test_state *wstate = *wstate_ptr;
+
+	/* configure mocks */
+	wcomb_expect_post(0, OFF, MOCK_BUF_SIZE, RPMA_E_PROVIDER);
+
+	/* run test */
+	int ret = rpma_wcomb_write(wstate->wcomb, OFF, Src_a, MOCK_BUF_SIZE);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	wcomb_expect_post(0, OFF, MOCK_BUF_SIZE, MOCK_OK);
+	assert_int_equal(rpma_wcomb_post(wstate->wcomb), MOCK_OK);
+	assert_int_equal(wcomb_complete(wstate->wcomb, Posted_ctx,
+			IBV_WC_SUCCESS), MOCK_OK);
+}
+
+static const struct CMUnitTest tests_write[] = {
+	/* rpma_wcomb_write() unit tests */
+	cmocka_unit_test_setup_teardown(write__invalid_args,
+		setup__wcomb_write, teardown__wcomb_delete),
+	cmocka_unit_test_setup_teardown(write__contiguous,
+		setup__wcomb_write, teardown__wcomb_delete),
+	cmocka_unit_test_setup_teardown(write__overlap,
+		setup__wcomb_write, teardown__wcomb_delete),
+	cmocka_unit_test_setup_teardown(write__not_mergeable,
+		setup__wcomb_write, teardown__wcomb_delete),
+	cmocka_unit_test_setup_teardown(write__full,
+		setup__wcomb_write, teardown__wcomb_delete),
+	cmocka_unit_test_setup_teardown(write__no_free_buf,
+		setup__wcomb_write, teardown__wcomb_delete),
+	cmocka_unit_test_setup_teardown(write__post_E_PROVIDER,
+		setup__wcomb_write, teardown__wcomb_delete),
+	cmocka_unit_test_setup_teardown(write__full_E_PROVIDER,
+		setup__wcomb_write, teardown__wcomb_delete),
+
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_write, NULL, NULL);
+}
@@ -0,0 +1,168 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * xfer-common.c -- the rpma_xfer unit tests common functions
+ */
+
+#include "conn.h"
+#include "xfer-common.h"
+
+void *Chunk_ctx;
+
+/*
+ * rpma_conn_get_max_msg_sz -- rpma_conn_get_max_msg_sz() mock
+ */
+int
+rpma_conn_get_max_msg_sz(const struct rpma_conn *conn, uint32_t *max_msg_sz)
+{
+	assert_ptr_equal(conn, MOCK_CONN);
+	assert_non_null(max_msg_sz);
+
+	int ret = mock_type(int);
+	if (ret)
+		return ret;
+
+	*max_msg_sz = mock_type(uint32_t);
+
+	return 0;
+}
+
+/*
+ * xfer_expect_max_msg_sz -- configure the mocks for querying the maximum
+ * message size of the port
+ */
+void
+xfer_expect_max_msg_sz(uint32_t max_msg_sz)
+{
+	will_return(rpma_conn_get_max_msg_sz, MOCK_OK);
+	will_return(rpma_conn_get_max_msg_sz, max_msg_sz);
+}
+
+/*
+ * rpma_read -- rpma_read() mock
+ */
+int
+rpma_read(struct rpma_conn *conn,
+		struct rpma_mr_local *dst, size_t dst_offset,
+		const struct rpma_mr_remote *src,  size_t src_offset,
+		size_t len, int flags, const void *op_context)
+{
+	assert_ptr_equal(conn, MOCK_CONN);
+	assert_ptr_equal(dst, MOCK_RPMA_MR_LOCAL);
+	assert_ptr_equal(src, MOCK_RPMA_MR_REMOTE);
+	assert_int_equal(flags, RPMA_F_COMPLETION_ALWAYS);
+	assert_non_null(op_context);
+	check_expected(dst_offset);
+	check_expected(src_offset);
+	check_expected(len);
+
+	Chunk_ctx = (void *)op_context;
+
+	return mock_type(int);
+}
+
+/*
+ * rpma_write -- rpma_write() mock
+ */
+int
+rpma_write(struct rpma_conn *conn,
+		struct rpma_mr_remote *dst, size_t dst_offset,
+		const struct rpma_mr_local *src,  size_t src_offset,
+		size_t len, int flags, const void *op_context)
+{
+	assert_ptr_equal(conn, MOCK_CONN);
+	assert_ptr_equal(dst, MOCK_RPMA_MR_REMOTE);
+	assert_ptr_equal(src, MOCK_RPMA_MR_LOCAL);
+	assert_int_equal(flags, RPMA_F_COMPLETION_ALWAYS);
+	assert_non_null(op_context);
+	check_expected(dst_offset);
+	check_expected(src_offset);
+	check_expected(len);
+
+	Chunk_ctx = (void *)op_context;
+
+	return mock_type(int);
+}
+
+/*
+ * setup__xfer_new -- prepare a valid segmented transfer engine
+ */
+int
+setup__xfer_new(void **xstate_ptr)
+{
+	static struct xfer_test_state xstate = {0};
+
+	/* configure mocks */
+	xfer_expect_max_msg_sz(MOCK_MAX_MSG_SZ);
+	will_return_count(__wrap__test_malloc, MOCK_OK, 2);
+
+	/* run test */
+	xstate.xfer = NULL;
+	int ret = rpma_xfer_new(MOCK_CONN, MOCK_CHUNK_SIZE, MOCK_INFLIGHT,
+			&xstate.xfer);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_non_null(xstate.xfer);
+
+	*xstate_ptr = &xstate;
+
+	return 0;
+}
+
+/*
+ * teardown__xfer_delete -- delete the segmented transfer engine
+ */
+int
+teardown__xfer_delete(void **xstate_ptr)
+{
+	struct xfer_test_state *xstate = *xstate_ptr;
+
+	/* run test */
+	int ret = rpma_xfer_delete(&xstate->xfer);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_null(xstate->xfer);
+
+	return 0;
+}
+
+/*
+ * xfer_expect_chunk -- configure the mocks for posting the chunk
+ * of the given offset within the transfer
+ */
+void
+xfer_expect_chunk(enum rpma_op op, size_t offset, size_t len, int result)
+{
+	if (op == RPMA_OP_READ) {
+		expect_value(rpma_read, dst_offset, MOCK_LOCAL_OFFSET + offset);
+		expect_value(rpma_read, src_offset,
+				MOCK_REMOTE_OFFSET + offset);
+		expect_value(rpma_read, len, len);
+		will_return(rpma_read, result);
+	} else {
+		expect_value(rpma_write, dst_offset,
+				MOCK_REMOTE_OFFSET + offset);
+		expect_value(rpma_write, src_offset,
+				MOCK_LOCAL_OFFSET + offset);
+		expect_value(rpma_write, len, len);
+		will_return(rpma_write, result);
+	}
+}
+
+/*
+ * xfer_complete -- pass the completion of a chunk to the engine
+ */
+int
+xfer_complete(struct rpma_xfer *xfer, void *ctx, enum ibv_wc_status status)
+{
+	struct rpma_completion cmpl = {0};
+	cmpl.op_context = ctx;
+	cmpl.op = RPMA_OP_READ;
+	cmpl.op_status = status;
+	cmpl.qp_num = MOCK_QP_NUM;
+
+	return rpma_xfer_process(xfer, &cmpl);
+}
@@ -0,0 +1,45 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * xfer-common.h -- the rpma_xfer unit tests common definitions
+ */
+
+#ifndef XFER_COMMON_H
+#define XFER_COMMON_H
+
+#include "cmocka_headers.h"
+#include "librpma.h"
+#include "mocks-stdlib.h"
+#include "test-common.h"
+
+#define MOCK_RPMA_MR_REMOTE	((struct rpma_mr_remote *)0xC412)
+#define MOCK_REMOTE_OFFSET	(size_t)0xC414
+
+#define MOCK_CHUNK_SIZE		16
+#define MOCK_INFLIGHT		2
+/* a transfer of three chunks, the last one shorter */
+#define MOCK_XFER_LEN		(2 * MOCK_CHUNK_SIZE + 4)
+#define MOCK_QP_NUM		0x0D15
+/* big enough not to lower any chunk size */
+#define MOCK_MAX_MSG_SZ		(uint32_t)(1U << 31)
+#define MOCK_OP_CONTEXT_2	(void *)0xC418
+
+struct xfer_test_state {
+	struct rpma_xfer *xfer;
+};
+
+/* the op_context of the most recently posted chunk */
+extern void *Chunk_ctx;
+
+void xfer_expect_max_msg_sz(uint32_t max_msg_sz);
+
+int setup__xfer_new(void **xstate_ptr);
+int teardown__xfer_delete(void **xstate_ptr);
+
+void xfer_expect_chunk(enum rpma_op op, size_t offset, size_t len,
+		int result);
+int xfer_complete(struct rpma_xfer *xfer, void *ctx,
+		enum ibv_wc_status status);
+
+#endif /* XFER_COMMON_H */
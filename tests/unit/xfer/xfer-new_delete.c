@@ -0,0 +1,227 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * xfer-new_delete.c -- the rpma_xfer_new/delete() unit tests
+ *
+ * APIs covered:
+ * - rpma_xfer_new()
+ * - rpma_xfer_delete()
+ */
+
+#include "xfer-common.h"
+
+/*
+ * new__invalid_args -- invalid combinations of the arguments
+ */
+static void
+new__invalid_args(void **unused)
+{
+	struct rpma_xfer *xfer = NULL;
+	struct {
+		struct rpma_conn *conn;
+		size_t chunk_size;
+		uint32_t inflight;
+		struct rpma_xfer **xfer_ptr;
+	} args[] = {
+		/* conn == NULL */
+		{NULL, MOCK_CHUNK_SIZE, MOCK_INFLIGHT, &xfer},
+		/* chunk_size too big */
+		{MOCK_CONN, (size_t)RPMA_XFER_CHUNK_SIZE_MAX + 1,
+			MOCK_INFLIGHT, &xfer},
+		/* inflight == 0 */
+		{MOCK_CONN, MOCK_CHUNK_SIZE, 0, &xfer},
+		/* xfer_ptr == NULL */
+		{MOCK_CONN, MOCK_CHUNK_SIZE, MOCK_INFLIGHT, NULL},
+	};
+
+	for (size_t i = 0; i < sizeof(args) / sizeof(args[0]); ++i) {
+		/* run test */
+		int ret = rpma_xfer_new(args[i].conn, args[i].chunk_size,
+				args[i].inflight, args[i].xfer_ptr);
+
+		/* verify the results */
+		assert_int_equal(ret, RPMA_E_INVAL);
+		assert_null(xfer);
+	}
+}
+
+/*
+ * new__malloc_ERRNO -- malloc() fails with MOCK_ERRNO
+ */
+static void
+new__malloc_ERRNO(void **unused)
+{
+	/* each of the two malloc() calls fails in turn */
+	for (int i = 0; i < 2; ++i) {
+		/* configure mocks */
+		xfer_expect_max_msg_sz(MOCK_MAX_MSG_SZ);
+		for (int j = 0; j < i; ++j)
+			will_return(__wrap__test_malloc, MOCK_OK);
+		will_return(__wrap__test_malloc, MOCK_ERRNO);
+
+		/* run test */
+		struct rpma_xfer *xfer = NULL;
+		int ret = rpma_xfer_new(MOCK_CONN, MOCK_CHUNK_SIZE,
+				MOCK_INFLIGHT, &xfer);
+
+		/* verify the results */
+		assert_int_equal(ret, RPMA_E_NOMEM);
+		assert_null(xfer);
+	}
+}
+
+/*
+ * new__get_max_msg_sz_E_PROVIDER -- rpma_conn_get_max_msg_sz() fails
+ * with RPMA_E_PROVIDER
+ */
+static void
+new__get_max_msg_sz_E_PROVIDER(void **unused)
+{
+	/* configure mocks */
+	will_return(rpma_conn_get_max_msg_sz, RPMA_E_PROVIDER);
+
+	/* run test */
+	struct rpma_xfer *xfer = NULL;
+	int ret = rpma_xfer_new(MOCK_CONN, MOCK_CHUNK_SIZE, MOCK_INFLIGHT,
+			&xfer);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+	assert_null(xfer);
+}
+
+/*
+ * new__chunk_size_max_msg_sz -- the chunk size is lowered to the maximum
+ * message size of the port
+ */
+static void
+new__chunk_size_max_msg_sz(void **unused)
+{
+	/* configure mocks */
+	xfer_expect_max_msg_sz(MOCK_CHUNK_SIZE / 2);
+	will_return_count(__wrap__test_malloc, MOCK_OK, 2);
+
+	/* run test */
+	struct rpma_xfer *xfer = NULL;
+	int ret = rpma_xfer_new(MOCK_CONN, MOCK_CHUNK_SIZE, 1, &xfer);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_non_null(xfer);
+
+	/* configure mocks */
+	xfer_expect_chunk(RPMA_OP_READ, 0, MOCK_CHUNK_SIZE / 2, MOCK_OK);
+
+	/* run test */
+	ret = rpma_xfer_read(xfer, MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_RPMA_MR_REMOTE, MOCK_REMOTE_OFFSET,
+			MOCK_CHUNK_SIZE, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+
+	ret = rpma_xfer_delete(&xfer);
+	assert_int_equal(ret, MOCK_OK);
+	assert_null(xfer);
+}
+
+/*
+ * new__chunk_size_default -- chunk_size == 0 stands for the default size
+ */
+static void
+new__chunk_size_default(void **unused)
+{
+	/* configure mocks */
+	xfer_expect_max_msg_sz(MOCK_MAX_MSG_SZ);
+	will_return_count(__wrap__test_malloc, MOCK_OK, 2);
+
+	/* run test */
+	struct rpma_xfer *xfer = NULL;
+	int ret = rpma_xfer_new(MOCK_CONN, 0, 1, &xfer);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+	assert_non_null(xfer);
+
+	/* configure mocks */
+	xfer_expect_chunk(RPMA_OP_READ, 0, RPMA_XFER_CHUNK_SIZE_DEFAULT,
+			MOCK_OK);
+
+	/* run test */
+	ret = rpma_xfer_read(xfer, MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_RPMA_MR_REMOTE, MOCK_REMOTE_OFFSET,
+			(size_t)RPMA_XFER_CHUNK_SIZE_DEFAULT + 1,
+			MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+
+	ret = rpma_xfer_delete(&xfer);
+	assert_int_equal(ret, MOCK_OK);
+	assert_null(xfer);
+}
+
+/*
+ * test_lifecycle -- happy day scenario
+ */
+static void
+test_lifecycle(void **unused)
+{
+	/*
+	 * The thing is done by setup__xfer_new()
+	 * and teardown__xfer_delete().
+	 */
+}
+
+/*
+ * delete__xfer_ptr_NULL -- NULL xfer_ptr is invalid
+ */
+static void
+delete__xfer_ptr_NULL(void **unused)
+{
+	/* run test */
+	int ret = rpma_xfer_delete(NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * delete__xfer_NULL -- NULL xfer is valid - quick exit
+ */
+static void
+delete__xfer_NULL(void **unused)
+{
+	/* run test */
+	struct rpma_xfer *xfer = NULL;
+	int ret = rpma_xfer_delete(&xfer);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+static const struct CMUnitTest tests_new_delete[] = {
+	/* rpma_xfer_new() unit tests */
+	cmocka_unit_test(new__invalid_args),
+	cmocka_unit_test(new__get_max_msg_sz_E_PROVIDER),
+	cmocka_unit_test(new__malloc_ERRNO),
+	cmocka_unit_test(new__chunk_size_max_msg_sz),
+	cmocka_unit_test(new__chunk_size_default),
+
+	/* rpma_xfer_new()/delete() lifecycle */
+	cmocka_unit_test_setup_teardown(test_lifecycle,
+		setup__xfer_new, teardown__xfer_delete),
+
+	/* rpma_xfer_delete() unit tests */
+	cmocka_unit_test(delete__xfer_ptr_NULL),
+	cmocka_unit_test(delete__xfer_NULL),
+
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_new_delete, NULL, NULL);
+}
@@ -0,0 +1,242 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * xfer-process_next.c -- the rpma_xfer_process/next() unit tests
+ *
+ * APIs covered:
+ * - rpma_xfer_process()
+ * - rpma_xfer_next()
+ */
+
+#include "xfer-common.h"
+
+/*
+ * process__invalid_args -- NULL xfer or cmpl is invalid
+ */
+static void
+process__invalid_args(void **xstate_ptr)
+{
+	struct xfer_test_state *xstate = *xstate_ptr;
+	struct rpma_completion cmpl = {0};
+
+	/* run test */
+	int ret = rpma_xfer_process(NULL, &cmpl);
+	assert_int_equal(ret, RPMA_E_INVAL);
+	ret = rpma_xfer_process(xstate->xfer, NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * process__foreign -- a completion not coming from the engine is invalid
+ */
+static void
+process__foreign(void **xstate_ptr)
+{
+	struct xfer_test_state *xstate = *xstate_ptr;
+
+	/* run test */
+	int ret = xfer_complete(xstate->xfer, MOCK_OP_CONTEXT,
+			IBV_WC_SUCCESS);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * process__not_pending -- a completion of a slot with no chunk in flight
+ * is invalid
+ */
+static void
+process__not_pending(void **xstate_ptr)
+{
+	struct xfer_test_state *xstate = *xstate_ptr;
+
+	/* configure mocks */
+	xfer_expect_chunk(RPMA_OP_READ, 0, MOCK_CHUNK_SIZE, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_xfer_read(xstate->xfer,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_RPMA_MR_REMOTE, MOCK_REMOTE_OFFSET,
+			MOCK_CHUNK_SIZE, MOCK_OP_CONTEXT);
+	assert_int_equal(ret, MOCK_OK);
+	ret = xfer_complete(xstate->xfer, Chunk_ctx, IBV_WC_SUCCESS);
+	assert_int_equal(ret, MOCK_OK);
+	ret = xfer_complete(xstate->xfer, Chunk_ctx, IBV_WC_SUCCESS);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * next__invalid_args -- NULL xfer or cmpl is invalid
+ */
+static void
+next__invalid_args(void **xstate_ptr)
+{
+	struct xfer_test_state *xstate = *xstate_ptr;
+	struct rpma_completion cmpl;
+
+	/* run test */
+	int ret = rpma_xfer_next(NULL, &cmpl);
+	assert_int_equal(ret, RPMA_E_INVAL);
+	ret = rpma_xfer_next(xstate->xfer, NULL);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_INVAL);
+}
+
+/*
+ * next__empty -- no transfer, no completion
+ */
+static void
+next__empty(void **xstate_ptr)
+{
+	struct xfer_test_state *xstate = *xstate_ptr;
+	struct rpma_completion cmpl;
+
+	/* run test */
+	int ret = rpma_xfer_next(xstate->xfer, &cmpl);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_NO_COMPLETION);
+}
+
+/*
+ * process_next__pipeline -- every completed chunk makes room for the next
+ * one and a single completion is reported per transfer
+ */
+static void
+process_next__pipeline(void **xstate_ptr)
+{
+	struct xfer_test_state *xstate = *xstate_ptr;
+	struct rpma_completion cmpl;
+
+	/* configure mocks */
+	xfer_expect_chunk(RPMA_OP_READ, 0, MOCK_CHUNK_SIZE, MOCK_OK);
+	xfer_expect_chunk(RPMA_OP_READ, MOCK_CHUNK_SIZE, MOCK_CHUNK_SIZE,
+			MOCK_OK);
+
+	/* run test */
+	int ret = rpma_xfer_read(xstate->xfer,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_RPMA_MR_REMOTE, MOCK_REMOTE_OFFSET,
+			MOCK_XFER_LEN, MOCK_OP_CONTEXT);
+	assert_int_equal(ret, MOCK_OK);
+	void *read_ctx = Chunk_ctx;
+
+	ret = rpma_xfer_write(xstate->xfer,
+			MOCK_RPMA_MR_REMOTE, MOCK_REMOTE_OFFSET,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_CHUNK_SIZE, MOCK_OP_CONTEXT_2);
+	assert_int_equal(ret, MOCK_OK);
+
+	/* the first chunk makes room for the last chunk of the read */
+	xfer_expect_chunk(RPMA_OP_READ, 2 * MOCK_CHUNK_SIZE,
+			MOCK_XFER_LEN - 2 * MOCK_CHUNK_SIZE, MOCK_OK);
+	ret = xfer_complete(xstate->xfer, read_ctx, IBV_WC_SUCCESS);
+	assert_int_equal(ret, MOCK_OK);
+
+	/* the second chunk makes room for the write */
+	xfer_expect_chunk(RPMA_OP_WRITE, 0, MOCK_CHUNK_SIZE, MOCK_OK);
+	ret = xfer_complete(xstate->xfer, read_ctx, IBV_WC_SUCCESS);
+	assert_int_equal(ret, MOCK_OK);
+	void *write_ctx = Chunk_ctx;
+	assert_ptr_not_equal(write_ctx, read_ctx);
+
+	ret = rpma_xfer_next(xstate->xfer, &cmpl);
+	assert_int_equal(ret, RPMA_E_NO_COMPLETION);
+
+	ret = xfer_complete(xstate->xfer, read_ctx, IBV_WC_SUCCESS);
+	assert_int_equal(ret, MOCK_OK);
+	ret = xfer_complete(xstate->xfer, write_ctx, IBV_WC_SUCCESS);
+	assert_int_equal(ret, MOCK_OK);
+
+	/* verify the results */
+	ret = rpma_xfer_next(xstate->xfer, &cmpl);
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(cmpl.op_context, MOCK_OP_CONTEXT);
+	assert_int_equal(cmpl.op, RPMA_OP_READ);
+	assert_int_equal(cmpl.op_status, IBV_WC_SUCCESS);
+	assert_int_equal(cmpl.byte_len, 0);
+	assert_int_equal(cmpl.qp_num, MOCK_QP_NUM);
+
+	ret = rpma_xfer_next(xstate->xfer, &cmpl);
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(cmpl.op_context, MOCK_OP_CONTEXT_2);
+	assert_int_equal(cmpl.op, RPMA_OP_WRITE);
+	assert_int_equal(cmpl.op_status, IBV_WC_SUCCESS);
+
+	ret = rpma_xfer_next(xstate->xfer, &cmpl);
+	assert_int_equal(ret, RPMA_E_NO_COMPLETION);
+}
+
+/*
+ * process_next__failed_chunk -- a failed chunk fails the transfer and
+ * its remaining chunks are not posted
+ */
+static void
+process_next__failed_chunk(void **xstate_ptr)
+{
+	struct xfer_test_state *xstate = *xstate_ptr;
+	struct rpma_completion cmpl;
+
+	/* configure mocks */
+	xfer_expect_chunk(RPMA_OP_WRITE, 0, MOCK_CHUNK_SIZE, MOCK_OK);
+	xfer_expect_chunk(RPMA_OP_WRITE, MOCK_CHUNK_SIZE, MOCK_CHUNK_SIZE,
+			MOCK_OK);
+
+	/* run test */
+	int ret = rpma_xfer_write(xstate->xfer,
+			MOCK_RPMA_MR_REMOTE, MOCK_REMOTE_OFFSET,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_XFER_LEN, MOCK_OP_CONTEXT);
+	assert_int_equal(ret, MOCK_OK);
+
+	ret = xfer_complete(xstate->xfer, Chunk_ctx, IBV_WC_REM_ACCESS_ERR);
+	assert_int_equal(ret, MOCK_OK);
+	ret = rpma_xfer_next(xstate->xfer, &cmpl);
+	assert_int_equal(ret, RPMA_E_NO_COMPLETION);
+	ret = xfer_complete(xstate->xfer, Chunk_ctx, IBV_WC_WR_FLUSH_ERR);
+	assert_int_equal(ret, MOCK_OK);
+
+	/* verify the results */
+	ret = rpma_xfer_next(xstate->xfer, &cmpl);
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(cmpl.op_context, MOCK_OP_CONTEXT);
+	assert_int_equal(cmpl.op, RPMA_OP_WRITE);
+	assert_int_equal(cmpl.op_status, IBV_WC_REM_ACCESS_ERR);
+}
+
+static const struct CMUnitTest tests_process_next[] = {
+	/* rpma_xfer_process() unit tests */
+	cmocka_unit_test_setup_teardown(process__invalid_args,
+		setup__xfer_new, teardown__xfer_delete),
+	cmocka_unit_test_setup_teardown(process__foreign,
+		setup__xfer_new, teardown__xfer_delete),
+	cmocka_unit_test_setup_teardown(process__not_pending,
+		setup__xfer_new, teardown__xfer_delete),
+
+	/* rpma_xfer_next() unit tests */
+	cmocka_unit_test_setup_teardown(next__invalid_args,
+		setup__xfer_new, teardown__xfer_delete),
+	cmocka_unit_test_setup_teardown(next__empty,
+		setup__xfer_new, teardown__xfer_delete),
+
+	/* rpma_xfer_process()/next() scenarios */
+	cmocka_unit_test_setup_teardown(process_next__pipeline,
+		setup__xfer_new, teardown__xfer_delete),
+	cmocka_unit_test_setup_teardown(process_next__failed_chunk,
+		setup__xfer_new, teardown__xfer_delete),
+
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_process_next, NULL, NULL);
+}
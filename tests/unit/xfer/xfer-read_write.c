@@ -0,0 +1,250 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * xfer-read_write.c -- the rpma_xfer_read/write() unit tests
+ *
+ * APIs covered:
+ * - rpma_xfer_read()
+ * - rpma_xfer_write()
+ */
+
+#include "xfer-common.h"
+
+/*
+ * read__invalid_args -- invalid combinations of the arguments
+ */
+static void
+read__invalid_args(void **xstate_ptr)
+{
+	struct xfer_test_state *xstate = *xstate_ptr;
+
+	struct {
+		struct rpma_xfer *xfer;
+		struct rpma_mr_local *dst;
+		const struct rpma_mr_remote *src;
+		size_t len;
+	} args[] = {
+		{NULL, MOCK_RPMA_MR_LOCAL, MOCK_RPMA_MR_REMOTE, MOCK_XFER_LEN},
+		{xstate->xfer, NULL, MOCK_RPMA_MR_REMOTE, MOCK_XFER_LEN},
+		{xstate->xfer, MOCK_RPMA_MR_LOCAL, NULL, MOCK_XFER_LEN},
+		{xstate->xfer, MOCK_RPMA_MR_LOCAL, MOCK_RPMA_MR_REMOTE, 0},
+	};
+
+	for (size_t i = 0; i < sizeof(args) / sizeof(args[0]); ++i) {
+		/* run test */
+		int ret = rpma_xfer_read(args[i].xfer,
+				args[i].dst, MOCK_LOCAL_OFFSET,
+				args[i].src, MOCK_REMOTE_OFFSET,
+				args[i].len, MOCK_OP_CONTEXT);
+
+		/* verify the results */
+		assert_int_equal(ret, RPMA_E_INVAL);
+	}
+}
+
+/*
+ * write__invalid_args -- invalid combinations of the arguments
+ */
+static void
+write__invalid_args(void **xstate_ptr)
+{
+	struct xfer_test_state *xstate = *xstate_ptr;
+
+	struct {
+		struct rpma_xfer *xfer;
+		struct rpma_mr_remote *dst;
+		const struct rpma_mr_local *src;
+		size_t len;
+	} args[] = {
+		{NULL, MOCK_RPMA_MR_REMOTE, MOCK_RPMA_MR_LOCAL, MOCK_XFER_LEN},
+		{xstate->xfer, NULL, MOCK_RPMA_MR_LOCAL, MOCK_XFER_LEN},
+		{xstate->xfer, MOCK_RPMA_MR_REMOTE, NULL, MOCK_XFER_LEN},
+		{xstate->xfer, MOCK_RPMA_MR_REMOTE, MOCK_RPMA_MR_LOCAL, 0},
+	};
+
+	for (size_t i = 0; i < sizeof(args) / sizeof(args[0]); ++i) {
+		/* run test */
+		int ret = rpma_xfer_write(args[i].xfer,
+				args[i].dst, MOCK_REMOTE_OFFSET,
+				args[i].src, MOCK_LOCAL_OFFSET,
+				args[i].len, MOCK_OP_CONTEXT);
+
+		/* verify the results */
+		assert_int_equal(ret, RPMA_E_INVAL);
+	}
+}
+
+/*
+ * read__single_chunk -- a transfer not longer than a chunk is posted
+ * as a single read
+ */
+static void
+read__single_chunk(void **xstate_ptr)
+{
+	struct xfer_test_state *xstate = *xstate_ptr;
+
+	/* configure mocks */
+	xfer_expect_chunk(RPMA_OP_READ, 0, MOCK_CHUNK_SIZE, MOCK_OK);
+
+	/* run test */
+	int ret = rpma_xfer_read(xstate->xfer,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_RPMA_MR_REMOTE, MOCK_REMOTE_OFFSET,
+			MOCK_CHUNK_SIZE, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * write__inflight_limit -- no more than the inflight chunks are posted
+ */
+static void
+write__inflight_limit(void **xstate_ptr)
+{
+	struct xfer_test_state *xstate = *xstate_ptr;
+
+	/* configure mocks */
+	xfer_expect_chunk(RPMA_OP_WRITE, 0, MOCK_CHUNK_SIZE, MOCK_OK);
+	xfer_expect_chunk(RPMA_OP_WRITE, MOCK_CHUNK_SIZE, MOCK_CHUNK_SIZE,
+			MOCK_OK);
+
+	/* run test */
+	int ret = rpma_xfer_write(xstate->xfer,
+			MOCK_RPMA_MR_REMOTE, MOCK_REMOTE_OFFSET,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_XFER_LEN, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+
+	/* the next transfer is queued only */
+	ret = rpma_xfer_write(xstate->xfer,
+			MOCK_RPMA_MR_REMOTE, MOCK_REMOTE_OFFSET,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_XFER_LEN, MOCK_OP_CONTEXT_2);
+	assert_int_equal(ret, MOCK_OK);
+}
+
+/*
+ * write__queue_full -- no more than the inflight transfers are queued
+ */
+static void
+write__queue_full(void **xstate_ptr)
+{
+	struct xfer_test_state *xstate = *xstate_ptr;
+
+	/* configure mocks */
+	xfer_expect_chunk(RPMA_OP_WRITE, 0, MOCK_CHUNK_SIZE, MOCK_OK);
+	xfer_expect_chunk(RPMA_OP_WRITE, MOCK_CHUNK_SIZE, MOCK_CHUNK_SIZE,
+			MOCK_OK);
+
+	/* run test */
+	for (int i = 0; i < MOCK_INFLIGHT; ++i) {
+		int ret = rpma_xfer_write(xstate->xfer,
+				MOCK_RPMA_MR_REMOTE, MOCK_REMOTE_OFFSET,
+				MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+				MOCK_XFER_LEN, MOCK_OP_CONTEXT);
+		assert_int_equal(ret, MOCK_OK);
+	}
+
+	int ret = rpma_xfer_write(xstate->xfer,
+			MOCK_RPMA_MR_REMOTE, MOCK_REMOTE_OFFSET,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_XFER_LEN, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_AGAIN);
+}
+
+/*
+ * read__post_E_PROVIDER -- a transfer whose first chunk cannot be posted
+ * is withdrawn
+ */
+static void
+read__post_E_PROVIDER(void **xstate_ptr)
+{
+	struct xfer_test_state *xstate = *xstate_ptr;
+
+	/* configure mocks */
+	xfer_expect_chunk(RPMA_OP_READ, 0, MOCK_CHUNK_SIZE, RPMA_E_PROVIDER);
+
+	/* run test */
+	int ret = rpma_xfer_read(xstate->xfer,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_RPMA_MR_REMOTE, MOCK_REMOTE_OFFSET,
+			MOCK_XFER_LEN, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, RPMA_E_PROVIDER);
+
+	struct rpma_completion cmpl;
+	ret = rpma_xfer_next(xstate->xfer, &cmpl);
+	assert_int_equal(ret, RPMA_E_NO_COMPLETION);
+}
+
+/*
+ * read__post_E_PROVIDER_partial -- a transfer whose later chunk cannot be
+ * posted fails when its posted chunks complete
+ */
+static void
+read__post_E_PROVIDER_partial(void **xstate_ptr)
+{
+	struct xfer_test_state *xstate = *xstate_ptr;
+
+	/* configure mocks */
+	xfer_expect_chunk(RPMA_OP_READ, 0, MOCK_CHUNK_SIZE, MOCK_OK);
+	xfer_expect_chunk(RPMA_OP_READ, MOCK_CHUNK_SIZE, MOCK_CHUNK_SIZE,
+			RPMA_E_PROVIDER);
+
+	/* run test */
+	int ret = rpma_xfer_read(xstate->xfer,
+			MOCK_RPMA_MR_LOCAL, MOCK_LOCAL_OFFSET,
+			MOCK_RPMA_MR_REMOTE, MOCK_REMOTE_OFFSET,
+			MOCK_XFER_LEN, MOCK_OP_CONTEXT);
+
+	/* verify the results */
+	assert_int_equal(ret, MOCK_OK);
+
+	struct rpma_completion cmpl;
+	ret = rpma_xfer_next(xstate->xfer, &cmpl);
+	assert_int_equal(ret, RPMA_E_NO_COMPLETION);
+
+	ret = xfer_complete(xstate->xfer, Chunk_ctx, IBV_WC_SUCCESS);
+	assert_int_equal(ret, MOCK_OK);
+
+	ret = rpma_xfer_next(xstate->xfer, &cmpl);
+	assert_int_equal(ret, MOCK_OK);
+	assert_ptr_equal(cmpl.op_context, MOCK_OP_CONTEXT);
+	assert_int_equal(cmpl.op, RPMA_OP_READ);
+	assert_int_equal(cmpl.op_status, IBV_WC_GENERAL_ERR);
+}
+
+static const struct CMUnitTest tests_read_write[] = {
+	/* rpma_xfer_read() unit tests */
+	cmocka_unit_test_setup_teardown(read__invalid_args,
+		setup__xfer_new, teardown__xfer_delete),
+	cmocka_unit_test_setup_teardown(read__single_chunk,
+		setup__xfer_new, teardown__xfer_delete),
+	cmocka_unit_test_setup_teardown(read__post_E_PROVIDER,
+		setup__xfer_new, teardown__xfer_delete),
+	cmocka_unit_test_setup_teardown(read__post_E_PROVIDER_partial,
+		setup__xfer_new, teardown__xfer_delete),
+
+	/* rpma_xfer_write() unit tests */
+	cmocka_unit_test_setup_teardown(write__invalid_args,
+		setup__xfer_new, teardown__xfer_delete),
+	cmocka_unit_test_setup_teardown(write__inflight_limit,
+		setup__xfer_new, teardown__xfer_delete),
+	cmocka_unit_test_setup_teardown(write__queue_full,
+		setup__xfer_new, teardown__xfer_delete),
+
+	cmocka_unit_test(NULL)
+};
+
+int
+main(int argc, char *argv[])
+{
+	return cmocka_run_group_tests(tests_read_write, NULL, NULL);
+}
@@ -0,0 +1,330 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * bench-common.c -- the rpma-bench functions shared by the client and
+ * the server
+ */
+
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench.h"
+
+static const char *Op_names[BENCH_OP_NUM] = {
+	[BENCH_OP_READ] = "read",
+	[BENCH_OP_WRITE] = "write",
+	[BENCH_OP_ATOMIC_WRITE] = "atomic_write",
+	[BENCH_OP_FLUSH] = "flush",
+	[BENCH_OP_SEND] = "send",
+	[BENCH_OP_WRITE_IMM] = "write_imm",
+	[BENCH_OP_MSGR] = "msgr",
+};
+
+/* the reported latency percentiles */
+static const double Pctls[] = {99.0, 99.9, 99.99, 99.999};
+
+/* the columns of the standardized format (see csv2standardized.py) */
+static const char *Columns[] = {
+	"threads", "iodepth", "bs", "ops",
+	"lat_min", "lat_max", "lat_avg", "lat_stdev",
+	"lat_pctl_99.0", "lat_pctl_99.9", "lat_pctl_99.99", "lat_pctl_99.999",
+	"bw_avg", "iops_avg",
+};
+
+#define COLUMNS_NUM	(sizeof(Columns) / sizeof(Columns[0]))
+
+/*
+ * bench_malloc_aligned -- allocate a page-aligned and zeroed chunk of memory
+ */
+void *
+bench_malloc_aligned(size_t size)
+{
+	long pagesize = sysconf(_SC_PAGESIZE);
+	if (pagesize < 0) {
+		perror("sysconf");
+		return NULL;
+	}
+
+	void *mem;
+	int ret = posix_memalign(&mem, (size_t)pagesize, size);
+	if (ret) {
+		(void) fprintf(stderr, "posix_memalign: %s\n", strerror(ret));
+		return NULL;
+	}
+
+	memset(mem, 0, size);
+
+	return mem;
+}
+
+/*
+ * bench_op_name -- get a name of the operation
+ */
+const char *
+bench_op_name(enum bench_op op)
+{
+	if (op >= BENCH_OP_NUM)
+		return "unknown";
+
+	return Op_names[op];
+}
+
+/*
+ * bench_op_from_str -- parse a name of the operation
+ */
+int
+bench_op_from_str(const char *str, enum bench_op *op)
+{
+	for (unsigned i = 0; i < BENCH_OP_NUM; ++i) {
+		if (strcmp(str, Op_names[i]) == 0) {
+			*op = (enum bench_op)i;
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+/*
+ * bench_op_is_messaging -- the operation requires the server to reply
+ */
+bool
+bench_op_is_messaging(enum bench_op op)
+{
+	return op == BENCH_OP_SEND || op == BENCH_OP_WRITE_IMM ||
+		op == BENCH_OP_MSGR;
+}
+
+/*
+ * bench_parse_size -- parse a size with an optional K, M or G suffix
+ */
+int
+bench_parse_size(const char *str, uint64_t *size)
+{
+	char *end = NULL;
+
+	errno = 0;
+	unsigned long long value = strtoull(str, &end, 10);
+	if (errno || end == str || str[0] == '-' || value > (UINT64_MAX >> 30))
+		return -1;
+
+	switch (*end) {
+	case 'G':
+		value <<= 10;
+		/* fall-through */
+	case 'M':
+		value <<= 10;
+		/* fall-through */
+	case 'K':
+		value <<= 10;
+		++end;
+		break;
+	default:
+		break;
+	}
+
+	if (*end != '\0' || value == 0)
+		return -1;
+
+	*size = value;
+
+	return 0;
+}
+
+/*
+ * bench_list_parse -- parse a comma-separated list of sizes
+ */
+int
+bench_list_parse(const char *str, struct bench_list *list)
+{
+	char buf[256];
+	char *saveptr = NULL;
+	uint64_t value;
+
+	if (strlen(str) >= sizeof(buf))
+		return -1;
+
+	strcpy(buf, str);
+	list->num = 0;
+
+	for (char *token = strtok_r(buf, ",", &saveptr); token != NULL;
+			token = strtok_r(NULL, ",", &saveptr)) {
+		if (list->num == BENCH_LIST_MAX)
+			return -1;
+
+		if (bench_parse_size(token, &value) || value > UINT32_MAX)
+			return -1;
+
+		list->values[list->num++] = (uint32_t)value;
+	}
+
+	return list->num ? 0 : -1;
+}
+
+/*
+ * cmp_u64 -- compare two uint64_t values (for qsort(3))
+ */
+static int
+cmp_u64(const void *a, const void *b)
+{
+	uint64_t va = *(const uint64_t *)a;
+	uint64_t vb = *(const uint64_t *)b;
+
+	return (va > vb) - (va < vb);
+}
+
+/*
+ * bench_result_calc -- calculate the latency statistics (the latency array
+ * gets sorted), the bandwidth and the number of operations per second
+ */
+void
+bench_result_calc(struct bench_result *res, uint64_t *lat_ns,
+		uint64_t lat_num, uint64_t elapsed_ns)
+{
+	double sum = 0.0;
+	double sum_sq = 0.0;
+
+	res->ops = lat_num;
+	if (lat_num == 0 || elapsed_ns == 0)
+		return;
+
+	qsort(lat_ns, (size_t)lat_num, sizeof(uint64_t), cmp_u64);
+
+	for (uint64_t i = 0; i < lat_num; ++i) {
+		double lat = (double)lat_ns[i];
+		sum += lat;
+		sum_sq += lat * lat;
+	}
+
+	double avg = sum / (double)lat_num;
+	double var = 0.0;
+	if (lat_num > 1) {
+		var = (sum_sq - sum * avg) / (double)(lat_num - 1);
+		if (var < 0.0)
+			var = 0.0;
+	}
+
+	res->lat_min = (double)lat_ns[0] / 1000.0;
+	res->lat_max = (double)lat_ns[lat_num - 1] / 1000.0;
+	res->lat_avg = avg / 1000.0;
+	res->lat_stdev = sqrt(var) / 1000.0;
+
+	for (unsigned i = 0; i < sizeof(Pctls) / sizeof(Pctls[0]); ++i) {
+		/* the nearest-rank method */
+		uint64_t rank = (uint64_t)ceil(Pctls[i] / 100.0 *
+				(double)lat_num);
+		if (rank == 0)
+			rank = 1;
+		res->lat_pctl[i] = (double)lat_ns[rank - 1] / 1000.0;
+	}
+
+	/* bits per nanosecond is Gb/s */
+	res->bw_avg = (double)lat_num * (double)res->bs * 8.0 /
+			(double)elapsed_ns;
+	res->iops_avg = (double)lat_num * 1e9 / (double)elapsed_ns;
+}
+
+/*
+ * bench_output_open -- open the output file (stdout if NULL); the output
+ * is a JSON array of records if the path ends with ".json" and a CSV file
+ * otherwise
+ */
+int
+bench_output_open(const char *path, struct bench_output *out)
+{
+	out->rows = 0;
+	out->json = false;
+
+	if (path == NULL) {
+		out->file = stdout;
+	} else {
+		size_t len = strlen(path);
+		out->json = (len >= 5 && strcmp(path + len - 5, ".json") == 0);
+		out->file = fopen(path, "w");
+		if (out->file == NULL) {
+			perror(path);
+			return -1;
+		}
+	}
+
+	if (out->json) {
+		(void) fprintf(out->file, "[");
+	} else {
+		for (unsigned i = 0; i < COLUMNS_NUM; ++i)
+			(void) fprintf(out->file, "%s%s", i ? "," : "",
+					Columns[i]);
+		(void) fprintf(out->file, "\n");
+	}
+
+	return 0;
+}
+
+/*
+ * output_field -- write a single field of a row
+ */
+static void
+output_field(struct bench_output *out, unsigned col, const char *value)
+{
+	if (col)
+		(void) fprintf(out->file, out->json ? ", " : ",");
+
+	if (out->json)
+		(void) fprintf(out->file, "\"%s\": ", Columns[col]);
+
+	(void) fprintf(out->file, "%s", value);
+}
+
+/*
+ * bench_output_row -- write the results of a single run
+ */
+void
+bench_output_row(struct bench_output *out, const struct bench_result *res)
+{
+	double values[] = {
+		res->lat_min, res->lat_max, res->lat_avg, res->lat_stdev,
+		res->lat_pctl[0], res->lat_pctl[1], res->lat_pctl[2],
+		res->lat_pctl[3], res->bw_avg, res->iops_avg
+	};
+	char buf[32];
+	unsigned col = 0;
+
+	if (out->json)
+		(void) fprintf(out->file, "%s{", out->rows ? ", " : "");
+
+	(void) snprintf(buf, sizeof(buf), "%u", res->threads);
+	output_field(out, col++, buf);
+	(void) snprintf(buf, sizeof(buf), "%u", res->iodepth);
+	output_field(out, col++, buf);
+	(void) snprintf(buf, sizeof(buf), "%u", res->bs);
+	output_field(out, col++, buf);
+	(void) snprintf(buf, sizeof(buf), "%lu", (unsigned long)res->ops);
+	output_field(out, col++, buf);
+
+	for (unsigned i = 0; i < sizeof(values) / sizeof(values[0]); ++i) {
+		(void) snprintf(buf, sizeof(buf), "%.2f", values[i]);
+		output_field(out, col++, buf);
+	}
+
+	(void) fprintf(out->file, out->json ? "}" : "\n");
+	(void) fflush(out->file);
+	out->rows++;
+}
+
+/*
+ * bench_output_close -- finish and close the output file
+ */
+int
+bench_output_close(struct bench_output *out)
+{
+	if (out->json)
+		(void) fprintf(out->file, "]\n");
+
+	if (out->file == stdout)
+		return fflush(stdout) ? -1 : 0;
+
+	return fclose(out->file) ? -1 : 0;
+}
@@ -0,0 +1,112 @@
+/* SPDX-License-Identifier: BSD-3-Clause */
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * bench.h -- the rpma-bench definitions shared by the client and the server
+ */
+
+#ifndef RPMA_BENCH_H
+#define RPMA_BENCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/* the maximum number of operations in flight per connection */
+#define BENCH_IODEPTH_MAX	128
+
+/* the maximum number of values of a comma-separated list */
+#define BENCH_LIST_MAX		32
+
+/* the maximum size of the server's memory region descriptor */
+#define BENCH_DESCRIPTOR_MAX	24
+
+/*
+ * the messenger's credits (iodepth requests plus the credit reserved by
+ * the messenger) and the size of its buffers (the payload plus the room for
+ * the batch and the message headers)
+ */
+#define BENCH_MSGR_CREDITS(iodepth)	((uint32_t)(iodepth) + 1)
+#define BENCH_MSGR_BUF_SIZE(bs)		((size_t)(bs) + 64)
+
+/*
+ * the slot of an operation is stored in its op_context (shifted by one since
+ * NULL is not a valid op_context for all of the operations)
+ */
+#define BENCH_SLOT_TO_CTX(slot)	((void *)((uintptr_t)(slot) + 1))
+#define BENCH_CTX_TO_SLOT(ctx)	((uint32_t)((uintptr_t)(ctx) - 1))
+
+enum bench_op {
+	BENCH_OP_READ,
+	BENCH_OP_WRITE,
+	BENCH_OP_ATOMIC_WRITE,
+	BENCH_OP_FLUSH,		/* write + flush (APM) */
+	BENCH_OP_SEND,		/* send + echo (ping-pong) */
+	BENCH_OP_WRITE_IMM,	/* write with immediate + reply (ping-pong) */
+	BENCH_OP_MSGR,		/* messenger's request + response */
+	BENCH_OP_NUM
+};
+
+/* the client's parameters sent via the connection's private data */
+struct bench_client_pdata {
+	uint8_t op;
+	uint8_t busy_wait;
+	uint16_t iodepth;
+	uint32_t bs;
+};
+
+/* the server's memory region sent via the connection's private data */
+struct bench_server_pdata {
+	uint8_t mr_desc_size;
+	char descriptor[BENCH_DESCRIPTOR_MAX];
+};
+
+struct bench_list {
+	uint32_t values[BENCH_LIST_MAX];
+	unsigned num;
+};
+
+/* the standardized results of a single run (see tools/perf/lib) */
+struct bench_result {
+	unsigned threads;
+	unsigned iodepth;
+	uint32_t bs;		/* [B] */
+	uint64_t ops;
+	double lat_min;		/* [usec] */
+	double lat_max;
+	double lat_avg;
+	double lat_stdev;
+	double lat_pctl[4];	/* 99.0, 99.9, 99.99, 99.999 */
+	double bw_avg;		/* [Gb/s] */
+	double iops_avg;	/* [1/s] */
+};
+
+struct bench_output {
+	FILE *file;
+	bool json;
+	unsigned rows;
+};
+
+void *bench_malloc_aligned(size_t size);
+
+const char *bench_op_name(enum bench_op op);
+
+int bench_op_from_str(const char *str, enum bench_op *op);
+
+bool bench_op_is_messaging(enum bench_op op);
+
+int bench_parse_size(const char *str, uint64_t *size);
+
+int bench_list_parse(const char *str, struct bench_list *list);
+
+void bench_result_calc(struct bench_result *res, uint64_t *lat_ns,
+		uint64_t lat_num, uint64_t elapsed_ns);
+
+int bench_output_open(const char *path, struct bench_output *out);
+
+void bench_output_row(struct bench_output *out,
+		const struct bench_result *res);
+
+int bench_output_close(struct bench_output *out);
+
+#endif /* RPMA_BENCH_H */
@@ -0,0 +1,800 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * client.c -- the rpma-bench client
+ *
+ * The client runs the chosen operation for each combination of the block
+ * sizes, the iodepths and the numbers of threads. Each of the threads uses
+ * its own connection and keeps up to iodepth operations in flight. The latency
+ * of an operation is measured from posting it until its completion is
+ * collected. The results are written in the standardized format of
+ * tools/perf.
+ *
+ * Please see README.md for details.
+ */
+
+#include <errno.h>
+#include <getopt.h>
+#include <librpma.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "bench.h"
+
+#define USAGE_STR "usage: %s <server_address> <port> [--op <op>] " \
+	"[--bs <list>] [--iodepth <list>] [--threads <list>] [--ops <n>] " \
+	"[--warmup <n>] [--event] [--output <file.csv|file.json>]\n" \
+	"ops: read, write, atomic_write, flush, send, write_imm, msgr\n"
+
+#define BS_DEFAULT		4096
+#define OPS_DEFAULT		10000
+#define WARMUP_DEFAULT		1000
+#define THREADS_MAX		64
+
+/* the completions which are not measured (e.g. of the messages sent) */
+#define CTX_AUX			((void *)(~(uintptr_t)0))
+
+struct client_cfg {
+	const char *addr;
+	const char *port;
+	enum bench_op op;
+	bool busy_wait;
+	uint64_t ops;
+	uint64_t warmup;
+	struct bench_list bs;
+	struct bench_list iodepth;
+	struct bench_list threads;
+	const char *output;
+};
+
+/* the gate the threads wait at to start all at once */
+struct client_start {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	int state;
+};
+
+#define START_WAIT	0
+#define START_GO	1
+#define START_ABORT	2
+
+struct client_thread {
+	const struct client_cfg *cfg;
+	struct client_start *start;
+	unsigned id;
+	uint32_t bs;
+	uint32_t iodepth;
+
+	struct rpma_conn *conn;
+	struct rpma_mr_remote *dst_mr;
+	size_t dst_size;
+
+	/* the local buffer: the receive slots followed by the send slots */
+	void *buf;
+	struct rpma_mr_local *mr;
+
+	struct rpma_msgr *msgr;	/* the messenger (msgr only) */
+
+	uint64_t start_ns[BENCH_IODEPTH_MAX];
+	uint64_t *lat_ns;	/* cfg->ops latencies */
+	uint64_t elapsed_ns;
+	int ret;
+};
+
+static const struct option Options[] = {
+	{"op", required_argument, NULL, 'o'},
+	{"bs", required_argument, NULL, 'b'},
+	{"iodepth", required_argument, NULL, 'd'},
+	{"threads", required_argument, NULL, 't'},
+	{"ops", required_argument, NULL, 'n'},
+	{"warmup", required_argument, NULL, 'w'},
+	{"event", no_argument, NULL, 'e'},
+	{"output", required_argument, NULL, 'O'},
+	{"help", no_argument, NULL, 'h'},
+	{NULL, 0, NULL, 0}
+};
+
+/*
+ * now_ns -- get the monotonic time in nanoseconds
+ */
+static inline uint64_t
+now_ns(void)
+{
+	struct timespec ts;
+
+	(void) clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/*
+ * client_start_wait -- wait until the gate opens; returns non-zero if
+ * the run has been aborted
+ */
+static int
+client_start_wait(struct client_start *start)
+{
+	int state;
+
+	pthread_mutex_lock(&start->lock);
+	while ((state = start->state) == START_WAIT)
+		pthread_cond_wait(&start->cond, &start->lock);
+	pthread_mutex_unlock(&start->lock);
+
+	return state == START_ABORT;
+}
+
+/*
+ * client_start_set -- open the gate or abort the run
+ */
+static void
+client_start_set(struct client_start *start, int state)
+{
+	pthread_mutex_lock(&start->lock);
+	start->state = state;
+	pthread_cond_broadcast(&start->cond);
+	pthread_mutex_unlock(&start->lock);
+}
+
+/*
+ * client_post -- post the operation of the slot
+ */
+static int
+client_post(struct client_thread *th, uint32_t slot)
+{
+	const struct client_cfg *cfg = th->cfg;
+	void *ctx = BENCH_SLOT_TO_CTX(slot);
+	size_t bs = th->bs;
+	size_t src_offset = slot * bs;
+	size_t send_offset = (th->iodepth + slot) * bs;
+	size_t dst_offset = ((th->id * th->iodepth + slot) %
+			(th->dst_size / bs)) * bs;
+	int ret;
+
+	th->start_ns[slot] = now_ns();
+
+	switch (cfg->op) {
+	case BENCH_OP_READ:
+		return rpma_read(th->conn, th->mr, src_offset, th->dst_mr,
+				dst_offset, bs, RPMA_F_COMPLETION_ALWAYS, ctx);
+	case BENCH_OP_WRITE:
+		return rpma_write(th->conn, th->dst_mr, dst_offset, th->mr,
+				src_offset, bs, RPMA_F_COMPLETION_ALWAYS, ctx);
+	case BENCH_OP_ATOMIC_WRITE:
+		return rpma_write_atomic(th->conn, th->dst_mr, dst_offset,
+				th->mr, src_offset, RPMA_F_COMPLETION_ALWAYS,
+				ctx);
+	case BENCH_OP_FLUSH:
+		ret = rpma_write(th->conn, th->dst_mr, dst_offset, th->mr,
+				src_offset, bs, RPMA_F_COMPLETION_ON_ERROR,
+				CTX_AUX);
+		if (ret)
+			return ret;
+		return rpma_flush(th->conn, th->dst_mr, dst_offset, bs,
+				RPMA_FLUSH_TYPE_VISIBILITY,
+				RPMA_F_COMPLETION_ALWAYS, ctx);
+	case BENCH_OP_SEND:
+		/* the reply is received into the slot's receive buffer */
+		ret = rpma_recv(th->conn, th->mr, src_offset, bs, ctx);
+		if (ret)
+			return ret;
+		return rpma_send(th->conn, th->mr, send_offset, bs,
+				RPMA_F_COMPLETION_ALWAYS, CTX_AUX);
+	case BENCH_OP_WRITE_IMM:
+		ret = rpma_recv(th->conn, th->mr, src_offset, bs, ctx);
+		if (ret)
+			return ret;
+		return rpma_write_with_imm(th->conn, th->dst_mr, dst_offset,
+				th->mr, send_offset, bs,
+				RPMA_F_COMPLETION_ALWAYS, slot, CTX_AUX);
+	default:
+		return RPMA_E_INVAL;
+	}
+}
+
+/*
+ * client_completion_get -- get the next completion either busy-waiting or
+ * waiting for the completion event
+ */
+static int
+client_completion_get(struct rpma_conn *conn, bool busy_wait,
+		struct rpma_completion *cmpl)
+{
+	int ret;
+
+	while ((ret = rpma_conn_completion_get(conn, cmpl)) ==
+			RPMA_E_NO_COMPLETION) {
+		if (busy_wait)
+			continue;
+
+		ret = rpma_conn_completion_wait(conn);
+		if (ret && ret != RPMA_E_NO_COMPLETION)
+			return ret;
+	}
+
+	return ret;
+}
+
+/*
+ * client_thread_run -- run the operations and measure their latencies
+ */
+static void *
+client_thread_run(void *arg)
+{
+	struct client_thread *th = arg;
+	const struct client_cfg *cfg = th->cfg;
+	uint64_t total = cfg->warmup + cfg->ops;
+	uint64_t posted = 0;
+	uint64_t done = 0;
+	uint64_t begin_ns = 0;
+	uint64_t end_ns = 0;
+	struct rpma_completion cmpl;
+	int ret = 0;
+
+	/* all of the threads start at once */
+	if (client_start_wait(th->start))
+		goto out;
+
+	if (cfg->warmup == 0)
+		begin_ns = now_ns();
+
+	for (uint32_t slot = 0; slot < th->iodepth && posted < total;
+			++slot, ++posted) {
+		ret = client_post(th, slot);
+		if (ret)
+			goto out;
+	}
+
+	while (done < total) {
+		ret = client_completion_get(th->conn, cfg->busy_wait, &cmpl);
+		if (ret)
+			goto out;
+
+		if (cmpl.op_status != IBV_WC_SUCCESS) {
+			(void) fprintf(stderr, "operation failed: %s\n",
+				ibv_wc_status_str(cmpl.op_status));
+			ret = -1;
+			goto out;
+		}
+
+		if (cmpl.op_context == CTX_AUX)
+			continue;
+
+		uint32_t slot = BENCH_CTX_TO_SLOT(cmpl.op_context);
+		end_ns = now_ns();
+		if (done >= cfg->warmup)
+			th->lat_ns[done - cfg->warmup] =
+				end_ns - th->start_ns[slot];
+
+		if (++done == cfg->warmup)
+			begin_ns = end_ns;
+
+		if (posted < total) {
+			ret = client_post(th, slot);
+			if (ret)
+				goto out;
+			++posted;
+		}
+	}
+
+	th->elapsed_ns = end_ns - begin_ns;
+
+out:
+	th->ret = ret;
+
+	return NULL;
+}
+
+/*
+ * client_msgr_run -- keep up to iodepth requests of the messenger in flight
+ * and measure their latencies till the responses are read
+ */
+static void *
+client_msgr_run(void *arg)
+{
+	struct client_thread *th = arg;
+	const struct client_cfg *cfg = th->cfg;
+	uint64_t total = cfg->warmup + cfg->ops;
+	uint64_t posted = 0;
+	uint64_t done = 0;
+	uint64_t begin_ns = 0;
+	uint64_t end_ns = 0;
+	struct rpma_completion cmpl;
+	struct rpma_msgr_msg msg;
+	uint64_t corr_id;
+	int ret = 0;
+
+	/* all of the threads start at once */
+	if (client_start_wait(th->start))
+		goto out;
+
+	if (cfg->warmup == 0)
+		begin_ns = now_ns();
+
+	while (done < total) {
+		/*
+		 * The server responds in order so the correlation IDs
+		 * in flight are iodepth consecutive numbers at most.
+		 */
+		while (posted < total && posted - done < th->iodepth) {
+			uint64_t start_ns = now_ns();
+			ret = rpma_msgr_request(th->msgr, th->buf, th->bs,
+					&corr_id);
+			if (ret == RPMA_E_AGAIN)
+				break;
+			if (ret)
+				goto out;
+
+			th->start_ns[corr_id % th->iodepth] = start_ns;
+			++posted;
+		}
+
+		/* the rest is sent once the server returns the credits */
+		ret = rpma_msgr_flush(th->msgr);
+		if (ret && ret != RPMA_E_AGAIN)
+			goto out;
+
+		ret = client_completion_get(th->conn, cfg->busy_wait, &cmpl);
+		if (ret)
+			goto out;
+
+		if (cmpl.op_status != IBV_WC_SUCCESS) {
+			(void) fprintf(stderr, "operation failed: %s\n",
+				ibv_wc_status_str(cmpl.op_status));
+			ret = -1;
+			goto out;
+		}
+
+		ret = rpma_msgr_process(th->msgr, &cmpl);
+		if (ret)
+			goto out;
+
+		while ((ret = rpma_msgr_next(th->msgr, &msg)) == 0) {
+			end_ns = now_ns();
+			if (done >= cfg->warmup)
+				th->lat_ns[done - cfg->warmup] = end_ns -
+					th->start_ns[msg.corr_id % th->iodepth];
+
+			if (++done == cfg->warmup)
+				begin_ns = end_ns;
+		}
+		if (ret != RPMA_E_NO_COMPLETION)
+			goto out;
+
+		ret = 0;
+	}
+
+	th->elapsed_ns = end_ns - begin_ns;
+
+out:
+	th->ret = ret;
+
+	return NULL;
+}
+
+/*
+ * client_thread_connect -- establish the thread's connection and prepare
+ * its memory regions
+ */
+static int
+client_thread_connect(struct rpma_peer *peer, struct rpma_conn_cfg *cfg,
+		struct client_thread *th)
+{
+	const struct client_cfg *ccfg = th->cfg;
+	struct bench_client_pdata params;
+	struct rpma_conn_private_data pdata;
+	struct rpma_conn_req *req = NULL;
+	enum rpma_conn_event conn_event = RPMA_CONN_UNDEFINED;
+	size_t size = 2 * (size_t)th->iodepth * th->bs;
+	int ret;
+
+	memset(&params, 0, sizeof(params));
+	params.op = (uint8_t)ccfg->op;
+	params.busy_wait = ccfg->busy_wait;
+	params.iodepth = (uint16_t)th->iodepth;
+	params.bs = th->bs;
+	pdata.ptr = &params;
+	pdata.len = sizeof(params);
+
+	th->buf = bench_malloc_aligned(size);
+	if (th->buf == NULL)
+		return -1;
+
+	ret = rpma_mr_reg(peer, th->buf, size,
+			RPMA_MR_USAGE_READ_DST | RPMA_MR_USAGE_WRITE_SRC |
+			RPMA_MR_USAGE_SEND | RPMA_MR_USAGE_RECV, &th->mr);
+	if (ret)
+		return ret;
+
+	ret = rpma_conn_req_new(peer, ccfg->addr, ccfg->port, cfg, &req);
+	if (ret)
+		return ret;
+
+	ret = rpma_conn_req_connect(&req, &pdata, &th->conn);
+	if (ret) {
+		if (req)
+			(void) rpma_conn_req_delete(&req);
+		return ret;
+	}
+
+	/* wait for the connection to establish */
+	ret = rpma_conn_next_event(th->conn, &conn_event);
+	if (!ret && conn_event != RPMA_CONN_ESTABLISHED) {
+		(void) fprintf(stderr,
+			"rpma_conn_next_event returned an unexpected event: %s\n",
+			rpma_utils_conn_event_2str(conn_event));
+		ret = -1;
+	}
+	if (ret) {
+		(void) rpma_conn_delete(&th->conn);
+		return ret;
+	}
+
+	/* obtain the server's memory region */
+	ret = rpma_conn_get_private_data(th->conn, &pdata);
+	if (ret || pdata.len < sizeof(struct bench_server_pdata)) {
+		(void) fprintf(stderr, "no memory region received\n");
+		return -1;
+	}
+
+	struct bench_server_pdata *server_pdata = pdata.ptr;
+	ret = rpma_mr_remote_from_descriptor(server_pdata->descriptor,
+			server_pdata->mr_desc_size, &th->dst_mr);
+	if (ret)
+		return ret;
+
+	ret = rpma_mr_remote_get_size(th->dst_mr, &th->dst_size);
+	if (ret)
+		return ret;
+
+	if (th->dst_size < th->bs) {
+		(void) fprintf(stderr,
+			"the server's memory is too small (%zu < %u)\n",
+			th->dst_size, th->bs);
+		return -1;
+	}
+
+	if (ccfg->op == BENCH_OP_MSGR)
+		return rpma_msgr_new(peer, th->conn,
+				BENCH_MSGR_CREDITS(th->iodepth),
+				BENCH_MSGR_BUF_SIZE(th->bs), &th->msgr);
+
+	return 0;
+}
+
+/*
+ * client_thread_disconnect -- close the thread's connection and release its
+ * resources
+ */
+static int
+client_thread_disconnect(struct client_thread *th)
+{
+	enum rpma_conn_event conn_event = RPMA_CONN_UNDEFINED;
+	int ret = 0;
+
+	if (th->conn) {
+		ret |= rpma_conn_disconnect(th->conn);
+		if (ret == 0)
+			ret |= rpma_conn_next_event(th->conn, &conn_event);
+		ret |= rpma_conn_delete(&th->conn);
+	}
+	if (th->msgr)
+		ret |= rpma_msgr_delete(&th->msgr);
+	if (th->dst_mr)
+		ret |= rpma_mr_remote_delete(&th->dst_mr);
+	if (th->mr)
+		ret |= rpma_mr_dereg(&th->mr);
+	free(th->buf);
+	th->buf = NULL;
+
+	return ret;
+}
+
+/*
+ * client_run -- run a single combination of the parameters
+ */
+static int
+client_run(const struct client_cfg *cfg, struct rpma_peer *peer,
+		uint32_t bs, uint32_t iodepth, uint32_t threads,
+		struct bench_result *res)
+{
+	struct rpma_conn_cfg *conn_cfg = NULL;
+	struct client_start start = {
+		.lock = PTHREAD_MUTEX_INITIALIZER,
+		.cond = PTHREAD_COND_INITIALIZER,
+		.state = START_WAIT
+	};
+	unsigned started = 0;
+	uint64_t elapsed_ns = 0;
+	int ret;
+
+	struct client_thread *ths = calloc(threads, sizeof(*ths));
+	uint64_t *lat_ns = calloc(threads * cfg->ops, sizeof(*lat_ns));
+	if (ths == NULL || lat_ns == NULL) {
+		ret = -1;
+		goto err_free;
+	}
+
+	/*
+	 * up to two work requests and completions per slot or a send and
+	 * a receive per credit of the messenger
+	 */
+	uint32_t rq_size = iodepth;
+	if (cfg->op == BENCH_OP_MSGR)
+		rq_size = BENCH_MSGR_CREDITS(iodepth);
+
+	ret = rpma_conn_cfg_new(&conn_cfg);
+	if (ret)
+		goto err_free;
+	ret = rpma_conn_cfg_set_sq_size(conn_cfg, 2 * iodepth);
+	if (!ret)
+		ret = rpma_conn_cfg_set_rq_size(conn_cfg, rq_size);
+	if (!ret)
+		ret = rpma_conn_cfg_set_cq_size(conn_cfg, 2 * rq_size);
+	if (ret)
+		goto err_cfg_delete;
+
+	for (unsigned i = 0; i < threads; ++i) {
+		struct client_thread *th = &ths[i];
+		th->cfg = cfg;
+		th->start = &start;
+		th->id = i;
+		th->bs = bs;
+		th->iodepth = iodepth;
+		th->lat_ns = &lat_ns[i * cfg->ops];
+
+		ret = client_thread_connect(peer, conn_cfg, th);
+		if (ret)
+			goto err_disconnect;
+	}
+
+	pthread_t *tids = calloc(threads, sizeof(*tids));
+	if (tids == NULL) {
+		ret = -1;
+		goto err_disconnect;
+	}
+
+	void *(*run)(void *) = cfg->op == BENCH_OP_MSGR ?
+			client_msgr_run : client_thread_run;
+
+	for (; started < threads; ++started) {
+		errno = pthread_create(&tids[started], NULL, run,
+				&ths[started]);
+		if (errno) {
+			perror("pthread_create");
+			ret = -1;
+			break;
+		}
+	}
+
+	/* do not run at all if not all of the threads have started */
+	client_start_set(&start, started == threads ? START_GO : START_ABORT);
+
+	for (unsigned i = 0; i < started; ++i) {
+		(void) pthread_join(tids[i], NULL);
+		if (!ret && ths[i].ret)
+			ret = ths[i].ret;
+		if (ths[i].elapsed_ns > elapsed_ns)
+			elapsed_ns = ths[i].elapsed_ns;
+	}
+	free(tids);
+
+	if (!ret) {
+		res->threads = threads;
+		res->iodepth = iodepth;
+		res->bs = bs;
+		bench_result_calc(res, lat_ns, threads * cfg->ops, elapsed_ns);
+	}
+
+err_disconnect:
+	for (unsigned i = 0; i < threads; ++i)
+		(void) client_thread_disconnect(&ths[i]);
+
+err_cfg_delete:
+	(void) rpma_conn_cfg_delete(&conn_cfg);
+
+err_free:
+	free(lat_ns);
+	free(ths);
+
+	return ret;
+}
+
+/*
+ * parse_count -- parse a number of operations
+ */
+static int
+parse_count(const char *str, uint64_t *count)
+{
+	char *end = NULL;
+
+	errno = 0;
+	unsigned long long value = strtoull(str, &end, 10);
+	if (errno || end == str || *end != '\0' || str[0] == '-') {
+		(void) fprintf(stderr, "invalid number: %s\n", str);
+		return -1;
+	}
+
+	*count = value;
+
+	return 0;
+}
+
+/*
+ * client_parse_args -- parse the command line arguments
+ */
+static int
+client_parse_args(int argc, char *argv[], struct client_cfg *cfg)
+{
+	const char *bs = NULL;
+	int opt;
+
+	memset(cfg, 0, sizeof(*cfg));
+	cfg->op = BENCH_OP_READ;
+	cfg->busy_wait = true;
+	cfg->ops = OPS_DEFAULT;
+	cfg->warmup = WARMUP_DEFAULT;
+	cfg->iodepth.values[0] = 1;
+	cfg->iodepth.num = 1;
+	cfg->threads.values[0] = 1;
+	cfg->threads.num = 1;
+
+	while ((opt = getopt_long(argc, argv, "o:b:d:t:n:w:eO:h", Options,
+			NULL)) != -1) {
+		switch (opt) {
+		case 'o':
+			if (bench_op_from_str(optarg, &cfg->op)) {
+				(void) fprintf(stderr, "invalid op: %s\n",
+						optarg);
+				return -1;
+			}
+			break;
+		case 'b':
+			bs = optarg;
+			break;
+		case 'd':
+			if (bench_list_parse(optarg, &cfg->iodepth)) {
+				(void) fprintf(stderr,
+						"invalid iodepth: %s\n",
+						optarg);
+				return -1;
+			}
+			break;
+		case 't':
+			if (bench_list_parse(optarg, &cfg->threads)) {
+				(void) fprintf(stderr,
+						"invalid threads: %s\n",
+						optarg);
+				return -1;
+			}
+			break;
+		case 'n':
+			if (parse_count(optarg, &cfg->ops))
+				return -1;
+			break;
+		case 'w':
+			if (parse_count(optarg, &cfg->warmup))
+				return -1;
+			break;
+		case 'e':
+			cfg->busy_wait = false;
+			break;
+		case 'O':
+			cfg->output = optarg;
+			break;
+		default:
+			return -1;
+		}
+	}
+
+	if (argc - optind < 2 || cfg->ops == 0)
+		return -1;
+
+	cfg->addr = argv[optind];
+	cfg->port = argv[optind + 1];
+
+	if (bs == NULL) {
+		/* the atomic write always transfers 8 bytes */
+		cfg->bs.values[0] = cfg->op == BENCH_OP_ATOMIC_WRITE ?
+				RPMA_ATOMIC_WRITE_ALIGNMENT : BS_DEFAULT;
+		cfg->bs.num = 1;
+	} else if (bench_list_parse(bs, &cfg->bs)) {
+		(void) fprintf(stderr, "invalid bs: %s\n", bs);
+		return -1;
+	}
+
+	for (unsigned i = 0; i < cfg->bs.num; ++i) {
+		if (cfg->op == BENCH_OP_ATOMIC_WRITE &&
+				cfg->bs.values[i] !=
+				RPMA_ATOMIC_WRITE_ALIGNMENT) {
+			(void) fprintf(stderr,
+				"atomic_write requires bs = %d\n",
+				RPMA_ATOMIC_WRITE_ALIGNMENT);
+			return -1;
+		}
+	}
+
+	for (unsigned i = 0; i < cfg->iodepth.num; ++i) {
+		if (cfg->iodepth.values[i] > BENCH_IODEPTH_MAX) {
+			(void) fprintf(stderr, "iodepth > %d\n",
+					BENCH_IODEPTH_MAX);
+			return -1;
+		}
+	}
+
+	for (unsigned i = 0; i < cfg->threads.num; ++i) {
+		if (cfg->threads.values[i] > THREADS_MAX) {
+			(void) fprintf(stderr, "threads > %d\n", THREADS_MAX);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+int
+main(int argc, char *argv[])
+{
+	struct client_cfg cfg;
+	struct bench_output out;
+	struct ibv_context *dev = NULL;
+	struct rpma_peer *peer = NULL;
+	int ret;
+
+	if (client_parse_args(argc, argv, &cfg)) {
+		(void) fprintf(stderr, USAGE_STR, argv[0]);
+		return -1;
+	}
+
+	/*
+	 * lookup an ibv_context via the address and create a new peer using it
+	 */
+	ret = rpma_utils_get_ibv_context(cfg.addr,
+			RPMA_UTIL_IBV_CONTEXT_REMOTE, &dev);
+	if (ret)
+		return -1;
+
+	ret = rpma_peer_new(dev, &peer);
+	if (ret)
+		return -1;
+
+	ret = bench_output_open(cfg.output, &out);
+	if (ret)
+		goto err_peer_delete;
+
+	for (unsigned t = 0; t < cfg.threads.num && !ret; ++t) {
+		for (unsigned d = 0; d < cfg.iodepth.num && !ret; ++d) {
+			for (unsigned b = 0; b < cfg.bs.num && !ret; ++b) {
+				struct bench_result res;
+				memset(&res, 0, sizeof(res));
+
+				ret = client_run(&cfg, peer, cfg.bs.values[b],
+						cfg.iodepth.values[d],
+						cfg.threads.values[t], &res);
+				if (ret) {
+					(void) fprintf(stderr,
+						"%s bs=%u iodepth=%u threads=%u failed\n",
+						bench_op_name(cfg.op),
+						cfg.bs.values[b],
+						cfg.iodepth.values[d],
+						cfg.threads.values[t]);
+					break;
+				}
+
+				bench_output_row(&out, &res);
+			}
+		}
+	}
+
+	if (bench_output_close(&out) && !ret)
+		ret = -1;
+
+err_peer_delete:
+	(void) rpma_peer_delete(&peer);
+
+	return ret ? -1 : 0;
+}
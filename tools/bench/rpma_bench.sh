@@ -0,0 +1,113 @@
+#!/usr/bin/env bash
+# SPDX-License-Identifier: BSD-3-Clause
+# Copyright 2021, Intel Corporation
+
+#
+# rpma_bench.sh -- run a single rpma-bench series on a single host
+#
+# Usage: rpma_bench.sh <server_ip> <op> <lat|bw>
+#
+# where <op> is one of: read, write, atomic_write, flush, send, write_imm,
+# msgr.
+#
+# The server is started locally, so <server_ip> has to be an address of
+# a local RDMA-capable (e.g. SoftRoCE) network interface. The arguments and
+# the OUTPUT_FILE and BUSY_WAIT_POLLING variables follow the interface used
+# by tools/perf/report_bench.py.
+#
+# The optional environment variables:
+# - BIN_DIR - a directory of rpma-bench-server and rpma-bench-client
+#             (default: the current directory)
+# - PORT - a port to use (default: 7204)
+# - OUTPUT_FILE - a CSV or JSON output file
+#                 (default: rpma_bench_<op>_<lat|bw>.csv)
+# - BUSY_WAIT_POLLING - 1 - busy-wait for the completions (default),
+#                       0 - wait for the completion events
+# - BS, IODEPTH, THREADS - comma-separated lists overwriting the defaults
+# - OPS, WARMUP - a number of the measured and the warm-up operations
+# - SERVER_SIZE - a size of the server's memory (default: 64M)
+#
+
+function usage()
+{
+	echo "Error: $1"
+	echo
+	echo "Usage: $0 <server_ip> <op> <lat|bw>"
+	echo "ops: read, write, atomic_write, flush, send, write_imm, msgr"
+	exit 1
+}
+
+SERVER_IP=$1
+OP=$2
+MODE=$3
+
+[ -z "$MODE" ] && usage "missing required argument(s)"
+
+BIN_DIR=${BIN_DIR-.}
+PORT=${PORT-7204}
+OUTPUT_FILE=${OUTPUT_FILE-rpma_bench_${OP}_${MODE}.csv}
+BUSY_WAIT_POLLING=${BUSY_WAIT_POLLING-1}
+SERVER_SIZE=${SERVER_SIZE-64M}
+
+SERVER=$BIN_DIR/rpma-bench-server
+CLIENT=$BIN_DIR/rpma-bench-client
+
+[ -x "$SERVER" ] || usage "$SERVER not found (set BIN_DIR)"
+[ -x "$CLIENT" ] || usage "$CLIENT not found (set BIN_DIR)"
+
+case $OP in
+atomic_write)
+	BS_LIST=8
+	;;
+*)
+	BS_LIST=256,1024,4096,16384,65536
+	;;
+esac
+
+case $MODE in
+lat)
+	IODEPTH_LIST=1
+	THREADS_LIST=1
+	;;
+bw)
+	IODEPTH_LIST=2,8,32
+	THREADS_LIST=1,2,4
+	;;
+*)
+	usage "unknown mode: $MODE"
+	;;
+esac
+
+BS_LIST=${BS-$BS_LIST}
+IODEPTH_LIST=${IODEPTH-$IODEPTH_LIST}
+THREADS_LIST=${THREADS-$THREADS_LIST}
+
+CLIENT_ARGS="--op $OP --bs $BS_LIST --iodepth $IODEPTH_LIST"
+CLIENT_ARGS="$CLIENT_ARGS --threads $THREADS_LIST --output $OUTPUT_FILE"
+[ -n "$OPS" ] && CLIENT_ARGS="$CLIENT_ARGS --ops $OPS"
+[ -n "$WARMUP" ] && CLIENT_ARGS="$CLIENT_ARGS --warmup $WARMUP"
+[ "$BUSY_WAIT_POLLING" == "0" ] && CLIENT_ARGS="$CLIENT_ARGS --event"
+
+echo "Starting the server ..."
+$SERVER $SERVER_IP $PORT --size $SERVER_SIZE &
+SERVER_PID=$!
+sleep 1
+
+if ! kill -0 $SERVER_PID 2>/dev/null; then
+	echo "Error: the server failed to start"
+	exit 1
+fi
+
+echo "Running: $CLIENT $SERVER_IP $PORT $CLIENT_ARGS"
+$CLIENT $SERVER_IP $PORT $CLIENT_ARGS
+RV=$?
+
+kill $SERVER_PID
+wait $SERVER_PID 2>/dev/null
+
+if [ $RV -ne 0 ]; then
+	echo "Error: rpma-bench $OP $MODE FAILED!"
+	exit $RV
+fi
+
+echo "Results: $OUTPUT_FILE"
@@ -0,0 +1,77 @@
+#!/usr/bin/env bash
+# SPDX-License-Identifier: BSD-3-Clause
+# Copyright 2021, Intel Corporation
+
+#
+# run-all-on-SoftRoCE.sh - run all of the rpma-bench series on SoftRoCE
+#
+# Usage: run-all-on-SoftRoCE.sh <binary-bench-directory> [IP_address] [port]
+#
+# The results are stored in the binary-bench-directory as
+# rpma_bench_<op>_<lat|bw>_<busy-wait|event>.json files.
+#
+
+BIN_DIR=$1
+IP_ADDRESS=$2
+PORT=$3
+
+OPS_LIST="read write atomic_write flush send write_imm msgr"
+STATE_OK="state ACTIVE physical_state LINK_UP"
+
+if [ "$BIN_DIR" == "" ]; then
+	echo "Error: missing required argument"
+	echo "Usage: run-all-on-SoftRoCE.sh <binary-bench-directory> [IP_address] [port]"
+	exit 1
+fi
+
+SCRIPT_DIR=$(dirname $0)
+$SCRIPT_DIR/../config_softroce.sh verify
+[ $? -ne 0 ] && exit 1
+
+if [ "$IP_ADDRESS" == "" ]; then
+	NETDEV=$(rdma link show | grep -e "$STATE_OK" | head -n1 | cut -d' ' -f8)
+	IP_ADDRESS=$(ip address show dev $NETDEV | grep -e inet | grep -v -e inet6 | cut -d' ' -f6 | cut -d/ -f1)
+fi
+
+if [ "$PORT" == "" ]; then
+	PORT="7204"
+fi
+
+echo "Running rpma-bench for IP address $IP_ADDRESS and port $PORT"
+echo
+
+# SoftRoCE is slow, so keep the number of operations moderate
+export OPS=${OPS-2000}
+export WARMUP=${WARMUP-200}
+export BIN_DIR
+export PORT
+
+N_FAILED=0
+FAILED=""
+
+for OP in $OPS_LIST; do
+	for MODE in lat bw; do
+		for BUSY_WAIT_POLLING in 1 0; do
+			[ $BUSY_WAIT_POLLING -eq 1 ] && WAIT=busy-wait || WAIT=event
+			NAME=${OP}_${MODE}_${WAIT}
+
+			echo "*** Running rpma-bench: $NAME"
+			BUSY_WAIT_POLLING=$BUSY_WAIT_POLLING \
+			OUTPUT_FILE=$BIN_DIR/rpma_bench_$NAME.json \
+				$SCRIPT_DIR/rpma_bench.sh $IP_ADDRESS $OP $MODE
+			if [ $? -ne 0 ]; then
+				N_FAILED=$(($N_FAILED + 1))
+				FAILED="$FAILED$NAME\n"
+			fi
+			echo
+		done
+	done
+done
+
+if [ $N_FAILED -gt 0 ]; then
+	echo "$N_FAILED rpma-bench series failed:"
+	echo -e "$FAILED"
+	exit 1
+fi
+
+echo "All rpma-bench series succeeded"
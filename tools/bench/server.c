@@ -0,0 +1,501 @@
+// SPDX-License-Identifier: BSD-3-Clause
+/* Copyright 2021, Intel Corporation */
+
+/*
+ * server.c -- the rpma-bench server
+ *
+ * The server registers a single memory region being the target of all of
+ * the remote memory accesses and serves each of the connections in a separate
+ * thread. For the messaging operations (send, write_imm and msgr) it replies
+ * to each of the received messages. It runs until it is killed.
+ *
+ * Please see README.md for details.
+ */
+
+#include <errno.h>
+#include <getopt.h>
+#include <librpma.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "bench.h"
+
+#define USAGE_STR "usage: %s <server_address> <port> [--size <size>]\n"
+
+#define SIZE_DEFAULT		(64 << 20) /* 64 MiB */
+
+/* the number of empty polls before checking for the connection's events */
+#define BUSY_WAIT_EVENT_CHECK	4096
+
+struct server_conn {
+	struct rpma_conn *conn;
+	struct bench_client_pdata params;
+
+	/*
+	 * the messaging buffer: the receive slots followed by the send slots
+	 * (or the payload of the responses of the messenger)
+	 */
+	void *buf;
+	struct rpma_mr_local *mr;
+
+	/* the messenger and the requests waiting for their responses */
+	struct rpma_msgr *msgr;
+	uint64_t corr_ids[BENCH_IODEPTH_MAX];
+	uint32_t corr_head;
+	uint32_t corr_num;
+};
+
+static const struct option Options[] = {
+	{"size", required_argument, NULL, 's'},
+	{"help", no_argument, NULL, 'h'},
+	{NULL, 0, NULL, 0}
+};
+
+/*
+ * server_conn_delete -- release the resources of the connection
+ */
+static void
+server_conn_delete(struct server_conn *sc)
+{
+	if (sc->conn)
+		(void) rpma_conn_delete(&sc->conn);
+	if (sc->msgr)
+		(void) rpma_msgr_delete(&sc->msgr);
+	if (sc->mr)
+		(void) rpma_mr_dereg(&sc->mr);
+	free(sc->buf);
+	free(sc);
+}
+
+/*
+ * server_reply -- repost the receive and reply to the received message
+ */
+static int
+server_reply(struct server_conn *sc, const struct rpma_completion *cmpl)
+{
+	uint32_t slot = BENCH_CTX_TO_SLOT(cmpl->op_context);
+	size_t bs = sc->params.bs;
+	int ret;
+
+	if (slot >= sc->params.iodepth)
+		return RPMA_E_INVAL;
+
+	ret = rpma_recv(sc->conn, sc->mr, slot * bs, bs, cmpl->op_context);
+	if (ret)
+		return ret;
+
+	/* the send completions are requested only to free the send queue */
+	if (sc->params.op == BENCH_OP_SEND)
+		return rpma_send(sc->conn, sc->mr,
+				(sc->params.iodepth + slot) * bs, bs,
+				RPMA_F_COMPLETION_ALWAYS, NULL);
+
+	return rpma_send(sc->conn, NULL, 0, 0, RPMA_F_COMPLETION_ALWAYS, NULL);
+}
+
+/*
+ * server_msgr_reply -- process the completion of the messenger and respond
+ * to the received requests as long as the client has the credits for them
+ */
+static int
+server_msgr_reply(struct server_conn *sc, const struct rpma_completion *cmpl)
+{
+	struct rpma_msgr_msg msg;
+	int ret;
+
+	ret = rpma_msgr_process(sc->msgr, cmpl);
+	if (ret)
+		return ret;
+
+	/* the payload does not matter so only the correlation IDs are kept */
+	while (sc->corr_num < BENCH_IODEPTH_MAX &&
+			(ret = rpma_msgr_next(sc->msgr, &msg)) == 0) {
+		sc->corr_ids[(sc->corr_head + sc->corr_num) %
+				BENCH_IODEPTH_MAX] = msg.corr_id;
+		sc->corr_num++;
+	}
+	if (ret && ret != RPMA_E_NO_COMPLETION)
+		return ret;
+
+	while (sc->corr_num) {
+		ret = rpma_msgr_respond(sc->msgr, sc->corr_ids[sc->corr_head],
+				sc->buf, sc->params.bs);
+		if (ret == RPMA_E_AGAIN)
+			break;
+		if (ret)
+			return ret;
+
+		sc->corr_head = (sc->corr_head + 1) % BENCH_IODEPTH_MAX;
+		sc->corr_num--;
+	}
+
+	/* the rest is sent once the client returns the credits */
+	ret = rpma_msgr_flush(sc->msgr);
+
+	return ret == RPMA_E_AGAIN ? 0 : ret;
+}
+
+/*
+ * server_reply_loop -- reply to the received messages until the connection
+ * gets closed
+ */
+static int
+server_reply_loop(struct server_conn *sc)
+{
+	struct rpma_completion cmpl;
+	struct pollfd fds[2];
+	unsigned empty = 0;
+	int ret;
+
+	ret = rpma_conn_get_event_fd(sc->conn, &fds[0].fd);
+	if (ret)
+		return ret;
+	ret = rpma_conn_get_completion_fd(sc->conn, &fds[1].fd);
+	if (ret)
+		return ret;
+	fds[0].events = POLLIN;
+	fds[1].events = POLLIN;
+
+	for (;;) {
+		ret = rpma_conn_completion_get(sc->conn, &cmpl);
+		if (ret == RPMA_E_NO_COMPLETION) {
+			if (sc->params.busy_wait &&
+					++empty % BUSY_WAIT_EVENT_CHECK)
+				continue;
+
+			/*
+			 * In the busy-wait mode only the connection's events
+			 * are checked. Otherwise, wait for either
+			 * a connection's event or a completion.
+			 */
+			fds[0].revents = 0;
+			fds[1].revents = 0;
+			if (sc->params.busy_wait)
+				ret = poll(fds, 1, 0);
+			else
+				ret = poll(fds, 2, -1);
+			if (ret < 0) {
+				if (errno == EINTR)
+					continue;
+				perror("poll");
+				return -1;
+			}
+
+			/* the connection is being closed */
+			if (fds[0].revents)
+				return 0;
+
+			if (fds[1].revents) {
+				ret = rpma_conn_completion_wait(sc->conn);
+				if (ret && ret != RPMA_E_NO_COMPLETION)
+					return ret;
+			}
+			continue;
+		} else if (ret) {
+			return ret;
+		}
+
+		/* the receives are flushed when the connection is closed */
+		if (cmpl.op_status != IBV_WC_SUCCESS)
+			return 0;
+
+		/* the messenger consumes all of the completions */
+		if (sc->msgr)
+			ret = server_msgr_reply(sc, &cmpl);
+		else if (cmpl.op != RPMA_OP_SEND)
+			ret = server_reply(sc, &cmpl);
+		if (ret)
+			return ret;
+	}
+}
+
+/*
+ * server_conn_thread -- serve the connection until it gets closed
+ */
+static void *
+server_conn_thread(void *arg)
+{
+	struct server_conn *sc = arg;
+	enum rpma_conn_event conn_event = RPMA_CONN_UNDEFINED;
+
+	if (bench_op_is_messaging((enum bench_op)sc->params.op)) {
+		if (server_reply_loop(sc))
+			(void) fprintf(stderr,
+				"replying to the messages failed\n");
+	}
+
+	/* wait for the connection to be closed */
+	int ret = rpma_conn_next_event(sc->conn, &conn_event);
+	if (!ret && conn_event != RPMA_CONN_CLOSED) {
+		(void) fprintf(stderr,
+			"rpma_conn_next_event returned an unexpected event: %s\n",
+			rpma_utils_conn_event_2str(conn_event));
+	}
+
+	(void) rpma_conn_disconnect(sc->conn);
+	server_conn_delete(sc);
+
+	return NULL;
+}
+
+/*
+ * server_params_valid -- validate the benchmark parameters of the client
+ */
+static int
+server_params_valid(const struct bench_client_pdata *params)
+{
+	return params->op < BENCH_OP_NUM && params->iodepth > 0 &&
+		params->iodepth <= BENCH_IODEPTH_MAX && params->bs > 0;
+}
+
+/*
+ * server_handle_req -- set up the connection, accept it and start
+ * a thread serving it (the connection request is consumed in any case)
+ */
+static int
+server_handle_req(struct rpma_peer *peer, struct rpma_conn_req *req,
+		struct rpma_conn_private_data *pdata)
+{
+	struct rpma_conn_private_data req_pdata;
+	enum rpma_conn_event conn_event = RPMA_CONN_UNDEFINED;
+	pthread_t thread;
+	int ret;
+
+	struct server_conn *sc = calloc(1, sizeof(*sc));
+	if (sc == NULL) {
+		(void) rpma_conn_req_delete(&req);
+		return -1;
+	}
+
+	ret = rpma_conn_req_get_private_data(req, &req_pdata);
+	if (ret || req_pdata.len < sizeof(sc->params)) {
+		(void) fprintf(stderr, "no benchmark parameters received\n");
+		ret = -1;
+		goto err_req_delete;
+	}
+
+	memcpy(&sc->params, req_pdata.ptr, sizeof(sc->params));
+	if (!server_params_valid(&sc->params)) {
+		(void) fprintf(stderr, "invalid benchmark parameters\n");
+		ret = -1;
+		goto err_req_delete;
+	}
+
+	if (sc->params.op == BENCH_OP_MSGR) {
+		/* the payload of the responses */
+		sc->buf = bench_malloc_aligned(sc->params.bs);
+		if (sc->buf == NULL) {
+			ret = -1;
+			goto err_req_delete;
+		}
+	} else if (bench_op_is_messaging((enum bench_op)sc->params.op)) {
+		/*
+		 * the receives have to be posted before the connection
+		 * is accepted
+		 */
+		size_t slots_size = (size_t)sc->params.iodepth * sc->params.bs;
+
+		sc->buf = bench_malloc_aligned(2 * slots_size);
+		if (sc->buf == NULL) {
+			ret = -1;
+			goto err_req_delete;
+		}
+
+		ret = rpma_mr_reg(peer, sc->buf, 2 * slots_size,
+				RPMA_MR_USAGE_RECV | RPMA_MR_USAGE_SEND,
+				&sc->mr);
+		if (ret)
+			goto err_req_delete;
+
+		for (uint32_t slot = 0; slot < sc->params.iodepth; ++slot) {
+			ret = rpma_conn_req_recv(req, sc->mr,
+					slot * sc->params.bs, sc->params.bs,
+					BENCH_SLOT_TO_CTX(slot));
+			if (ret)
+				goto err_req_delete;
+		}
+	}
+
+	ret = rpma_conn_req_connect(&req, pdata, &sc->conn);
+	if (ret)
+		goto err_req_delete;
+
+	/*
+	 * The messenger posts its receives right after the connection is
+	 * accepted. A request coming before is retried by the client's RDMA
+	 * device until they are posted (rnr_retry_count).
+	 */
+	if (sc->params.op == BENCH_OP_MSGR) {
+		ret = rpma_msgr_new(peer, sc->conn,
+				BENCH_MSGR_CREDITS(sc->params.iodepth),
+				BENCH_MSGR_BUF_SIZE(sc->params.bs), &sc->msgr);
+		if (ret)
+			goto err_conn_delete;
+	}
+
+	/* wait for the connection to be established */
+	ret = rpma_conn_next_event(sc->conn, &conn_event);
+	if (!ret && conn_event != RPMA_CONN_ESTABLISHED) {
+		(void) fprintf(stderr,
+			"rpma_conn_next_event returned an unexpected event: %s\n",
+			rpma_utils_conn_event_2str(conn_event));
+		ret = -1;
+	}
+	if (ret)
+		goto err_conn_delete;
+
+	errno = pthread_create(&thread, NULL, server_conn_thread, sc);
+	if (errno) {
+		perror("pthread_create");
+		ret = -1;
+		goto err_conn_disconnect;
+	}
+
+	(void) pthread_detach(thread);
+
+	return 0;
+
+err_conn_disconnect:
+	(void) rpma_conn_disconnect(sc->conn);
+
+err_conn_delete:
+	server_conn_delete(sc);
+	return ret;
+
+err_req_delete:
+	if (req)
+		(void) rpma_conn_req_delete(&req);
+	server_conn_delete(sc);
+
+	return ret;
+}
+
+int
+main(int argc, char *argv[])
+{
+	uint64_t size = SIZE_DEFAULT;
+	int opt;
+
+	while ((opt = getopt_long(argc, argv, "s:h", Options, NULL)) != -1) {
+		switch (opt) {
+		case 's':
+			if (bench_parse_size(optarg, &size)) {
+				(void) fprintf(stderr, "invalid size: %s\n",
+						optarg);
+				return -1;
+			}
+			break;
+		default:
+			(void) fprintf(stderr, USAGE_STR, argv[0]);
+			return opt == 'h' ? 0 : -1;
+		}
+	}
+
+	if (argc - optind < 2) {
+		(void) fprintf(stderr, USAGE_STR, argv[0]);
+		return -1;
+	}
+
+	char *addr = argv[optind];
+	char *port = argv[optind + 1];
+	int ret;
+
+	/* resources */
+	struct ibv_context *dev = NULL;
+	struct rpma_peer *peer = NULL;
+	struct rpma_mr_local *mr = NULL;
+	struct rpma_conn_cfg *cfg = NULL;
+	struct rpma_ep *ep = NULL;
+	struct rpma_conn_req *req = NULL;
+	struct bench_server_pdata server_pdata;
+	size_t mr_desc_size;
+
+	void *mr_ptr = bench_malloc_aligned((size_t)size);
+	if (mr_ptr == NULL)
+		return -1;
+
+	/*
+	 * lookup an ibv_context via the address and create a new peer using it
+	 */
+	ret = rpma_utils_get_ibv_context(addr, RPMA_UTIL_IBV_CONTEXT_LOCAL,
+			&dev);
+	if (ret)
+		goto err_free;
+
+	ret = rpma_peer_new(dev, &peer);
+	if (ret)
+		goto err_free;
+
+	/* register the memory being the target of all of the operations */
+	ret = rpma_mr_reg(peer, mr_ptr, (size_t)size,
+			RPMA_MR_USAGE_READ_SRC | RPMA_MR_USAGE_WRITE_DST |
+			RPMA_MR_USAGE_FLUSH_TYPE_VISIBILITY, &mr);
+	if (ret)
+		goto err_peer_delete;
+
+	/* get the memory region's descriptor */
+	ret = rpma_mr_get_descriptor_size(mr, &mr_desc_size);
+	if (ret)
+		goto err_mr_dereg;
+	if (mr_desc_size > BENCH_DESCRIPTOR_MAX) {
+		(void) fprintf(stderr, "the descriptor is too big (%zu)\n",
+				mr_desc_size);
+		ret = -1;
+		goto err_mr_dereg;
+	}
+
+	server_pdata.mr_desc_size = (uint8_t)mr_desc_size;
+	ret = rpma_mr_get_descriptor(mr, server_pdata.descriptor);
+	if (ret)
+		goto err_mr_dereg;
+
+	struct rpma_conn_private_data pdata;
+	pdata.ptr = &server_pdata;
+	pdata.len = sizeof(server_pdata);
+
+	/* the queues have to fit the maximum iodepth (and its credits) */
+	ret = rpma_conn_cfg_new(&cfg);
+	if (ret)
+		goto err_mr_dereg;
+	ret = rpma_conn_cfg_set_sq_size(cfg,
+			BENCH_MSGR_CREDITS(BENCH_IODEPTH_MAX));
+	if (!ret)
+		ret = rpma_conn_cfg_set_rq_size(cfg,
+				BENCH_MSGR_CREDITS(BENCH_IODEPTH_MAX));
+	if (!ret)
+		ret = rpma_conn_cfg_set_cq_size(cfg,
+				2 * BENCH_MSGR_CREDITS(BENCH_IODEPTH_MAX));
+	if (ret)
+		goto err_cfg_delete;
+
+	/* start a listening endpoint at addr:port */
+	ret = rpma_ep_listen(peer, addr, port, &ep);
+	if (ret)
+		goto err_cfg_delete;
+
+	(void) fprintf(stderr, "rpma-bench server listening at %s:%s\n",
+			addr, port);
+
+	/* serve the incoming connections until the server is killed */
+	while ((ret = rpma_ep_next_conn_req(ep, cfg, &req)) == 0)
+		(void) server_handle_req(peer, req, &pdata);
+
+	(void) rpma_ep_shutdown(&ep);
+
+err_cfg_delete:
+	(void) rpma_conn_cfg_delete(&cfg);
+
+err_mr_dereg:
+	(void) rpma_mr_dereg(&mr);
+
+err_peer_delete:
+	(void) rpma_peer_delete(&peer);
+
+err_free:
+	free(mr_ptr);
+
+	return ret ? -1 : 0;
+}
@@ -113,12 +113,12 @@ for file in $FILES ; do
 	if ! grep -q "SPDX-License-Identifier: $LICENSE" $src_path; then
 		echo "error: no $LICENSE SPDX tag in file: $src_path" >&2
 		RV=1
-	elif [[ $file == *.c ]]; then
+	elif [[ $file == *.c || $file == *.cpp ]]; then
 		if ! grep -q -e "\/\/ SPDX-License-Identifier: $LICENSE" $src_path; then
 			echo "error: wrong format of SPDX tag in the file: $src_path" >&2
 			RV=1
 		fi
-	elif [[ $file == *.h ]]; then
+	elif [[ $file == *.h || $file == *.hpp ]]; then
 		if ! grep -q -e "\/\* SPDX-License-Identifier: $LICENSE \*\/" $src_path; then
 			echo "error: wrong format of SPDX tag in the file: $src_path" >&2
 			RV=1